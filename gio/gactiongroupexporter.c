@@ -28,6 +28,7 @@
 #include "gdbusconnection.h"
 #include "gactiongroup.h"
 #include "gdbuserror.h"
+#include "gdbusprivate.h"
 
 /**
  * SECTION:gactiongroupexporter
@@ -246,7 +247,7 @@ g_action_group_exporter_set_events (GActionGroupExporter *exporter,
     {
       GSource *source;
 
-      source = g_idle_source_new ();
+      source = _g_dbus_export_source_new ();
       exporter->pending_source = source;
       g_source_set_callback (source, g_action_group_exporter_dispatch_events, exporter, NULL);
       g_source_set_name (source, "[gio] g_action_group_exporter_dispatch_events");
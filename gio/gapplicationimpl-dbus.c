@@ -41,6 +41,13 @@
 #ifdef G_OS_UNIX
 #include "gunixinputstream.h"
 #include "gunixfdlist.h"
+#include "gunixsocketaddress.h"
+#include "gdbusserver.h"
+#include "gdbusauthobserver.h"
+#include "gcredentials.h"
+#include "gsocket.h"
+#include "gsocketconnection.h"
+#include <unistd.h>
 #endif
 
 /* DBus Interface definition {{{1 */
@@ -121,6 +128,12 @@ struct _GApplicationImpl
   gboolean         primary;
   gboolean         busy;
   GApplication    *app;
+
+  /* Peer-to-peer fast path, see "Peer connections" below */
+  GDBusConnection *peer;              /* remote: connection to the primary */
+  GDBusServer     *peer_server;       /* primary: listening socket */
+  gchar           *peer_socket_path;  /* primary: its path, to remove it */
+  GHashTable      *peer_connections;  /* primary: GDBusConnection -> PeerConnection */
 };
 
 
@@ -304,6 +317,38 @@ g_application_impl_method_call (GDBusConnection       *connection,
     g_assert_not_reached ();
 }
 
+static void
+ensure_interface_info (void)
+{
+  if (org_gtk_Application == NULL)
+    {
+      GError *error = NULL;
+      GDBusNodeInfo *info;
+
+      info = g_dbus_node_info_new_for_xml (org_gtk_Application_xml, &error);
+      if G_UNLIKELY (info == NULL)
+        g_error ("%s", error->message);
+      org_gtk_Application = g_dbus_node_info_lookup_interface (info, "org.gtk.Application");
+      g_assert (org_gtk_Application != NULL);
+      g_dbus_interface_info_ref (org_gtk_Application);
+      g_dbus_node_info_unref (info);
+
+      info = g_dbus_node_info_new_for_xml (org_freedesktop_Application_xml, &error);
+      if G_UNLIKELY (info == NULL)
+        g_error ("%s", error->message);
+      org_freedesktop_Application = g_dbus_node_info_lookup_interface (info, "org.freedesktop.Application");
+      g_assert (org_freedesktop_Application != NULL);
+      g_dbus_interface_info_ref (org_freedesktop_Application);
+      g_dbus_node_info_unref (info);
+    }
+}
+
+static const GDBusInterfaceVTable application_vtable = {
+  g_application_impl_method_call,
+  g_application_impl_get_property,
+  NULL /* set_property */
+};
+
 static gchar *
 application_path_from_appid (const gchar *appid)
 {
@@ -326,6 +371,285 @@ application_path_from_appid (const gchar *appid)
   return appid_path;
 }
 
+#ifdef G_OS_UNIX
+/* Peer connections
+ *
+ * Starting a remote instance through the bus means registering objects
+ * and asking for the application's name, only to find out that it's
+ * taken. To make that cheaper, the primary instance of a unique
+ * application with G_APPLICATION_PEER_SOCKET also listens on a unix
+ * socket in a private directory under $XDG_RUNTIME_DIR, named after the
+ * session bus and the application ID. New instances with the same flag
+ * try that socket first, and if the primary answers, they send their
+ * requests to it directly instead of through the bus.
+ *
+ * The directory is only used if it belongs to the user and nobody else
+ * can access it, and both ends also check that the other one is run by
+ * the same user.
+ */
+static gchar *
+get_peer_socket_path (const gchar *appid,
+                      gboolean     create_dir)
+{
+  const gchar *runtime_dir;
+  const gchar *bus_address;
+  GStatBuf buf;
+  gchar *checksum;
+  gchar *path;
+  gchar *dir;
+  gchar *key;
+
+  runtime_dir = g_getenv ("XDG_RUNTIME_DIR");
+  if (runtime_dir == NULL || !g_path_is_absolute (runtime_dir))
+    return NULL;
+
+  dir = g_build_filename (runtime_dir, "gapplication", NULL);
+  if (create_dir)
+    g_mkdir (dir, 0700);
+
+  if (g_lstat (dir, &buf) != 0 ||
+      !S_ISDIR (buf.st_mode) ||
+      buf.st_uid != getuid () ||
+      (buf.st_mode & (S_IRWXG | S_IRWXO)) != 0)
+    {
+      g_free (dir);
+      return NULL;
+    }
+
+  /* Separate sessions of the same user have separate primaries */
+  bus_address = g_getenv ("DBUS_SESSION_BUS_ADDRESS");
+  key = g_strconcat (bus_address ? bus_address : "", "\n", appid, NULL);
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA256, key, -1);
+  path = g_build_filename (dir, checksum, NULL);
+  g_free (checksum);
+  g_free (key);
+  g_free (dir);
+
+  return path;
+}
+
+static gboolean
+is_same_user (GCredentials *credentials)
+{
+  GCredentials *own;
+  gboolean same_user;
+
+  if (credentials == NULL)
+    return FALSE;
+
+  own = g_credentials_new ();
+  same_user = g_credentials_is_same_user (credentials, own, NULL);
+  g_object_unref (own);
+
+  return same_user;
+}
+
+static gboolean
+peer_allow_mechanism_cb (GDBusAuthObserver *observer,
+                         const gchar       *mechanism,
+                         gpointer           user_data)
+{
+  return g_strcmp0 (mechanism, "EXTERNAL") == 0;
+}
+
+static gboolean
+peer_authorize_cb (GDBusAuthObserver *observer,
+                   GIOStream         *stream,
+                   GCredentials      *credentials,
+                   gpointer           user_data)
+{
+  return is_same_user (credentials);
+}
+
+typedef struct
+{
+  GDBusConnection *connection;
+  guint            object_id;
+  guint            fdo_object_id;
+  guint            actions_id;
+  gulong           closed_id;
+} PeerConnection;
+
+static void
+peer_connection_free (gpointer data)
+{
+  PeerConnection *peer = data;
+
+  if (peer->object_id)
+    g_dbus_connection_unregister_object (peer->connection, peer->object_id);
+  if (peer->fdo_object_id)
+    g_dbus_connection_unregister_object (peer->connection, peer->fdo_object_id);
+  if (peer->actions_id)
+    g_dbus_connection_unexport_action_group (peer->connection, peer->actions_id);
+
+  g_signal_handler_disconnect (peer->connection, peer->closed_id);
+  g_dbus_connection_close (peer->connection, NULL, NULL, NULL);
+  g_object_unref (peer->connection);
+
+  g_slice_free (PeerConnection, peer);
+}
+
+static void
+peer_connection_closed_cb (GDBusConnection *connection,
+                           gboolean         remote_peer_vanished,
+                           GError          *error,
+                           gpointer         user_data)
+{
+  GApplicationImpl *impl = user_data;
+
+  g_hash_table_remove (impl->peer_connections, connection);
+}
+
+static gboolean
+peer_new_connection_cb (GDBusServer     *server,
+                        GDBusConnection *connection,
+                        gpointer         user_data)
+{
+  GApplicationImpl *impl = user_data;
+  PeerConnection *peer;
+
+  /* Remote instances only need the application and action group
+   * interfaces, not whatever the application exports in dbus_register.
+   */
+  peer = g_slice_new0 (PeerConnection);
+  peer->connection = g_object_ref (connection);
+  peer->object_id = g_dbus_connection_register_object (connection, impl->object_path,
+                                                       org_gtk_Application, &application_vtable,
+                                                       impl, NULL, NULL);
+  peer->fdo_object_id = g_dbus_connection_register_object (connection, impl->object_path,
+                                                           org_freedesktop_Application, &application_vtable,
+                                                           impl, NULL, NULL);
+  peer->actions_id = g_dbus_connection_export_action_group (connection, impl->object_path,
+                                                            impl->exported_actions, NULL);
+  peer->closed_id = g_signal_connect (connection, "closed",
+                                      G_CALLBACK (peer_connection_closed_cb), impl);
+  g_hash_table_insert (impl->peer_connections, connection, peer);
+
+  if (g_dbus_connection_is_closed (connection))
+    g_hash_table_remove (impl->peer_connections, connection);
+
+  return TRUE;
+}
+
+/* Failing to listen isn't an error: remote instances will just go
+ * through the bus.
+ */
+static void
+g_application_impl_start_peer_server (GApplicationImpl *impl)
+{
+  GDBusAuthObserver *observer;
+  gchar *address;
+  gchar *escaped;
+  gchar *path;
+  gchar *guid;
+
+  path = get_peer_socket_path (impl->bus_name, TRUE);
+  if (path == NULL)
+    return;
+
+  /* We own the bus name, so a socket that is still there was left
+   * behind by a primary instance that didn't exit cleanly.
+   */
+  g_unlink (path);
+
+  escaped = g_dbus_address_escape_value (path);
+  address = g_strconcat ("unix:path=", escaped, NULL);
+  guid = g_dbus_generate_guid ();
+  observer = g_dbus_auth_observer_new ();
+  g_signal_connect (observer, "allow-mechanism", G_CALLBACK (peer_allow_mechanism_cb), NULL);
+  g_signal_connect (observer, "authorize-authenticated-peer", G_CALLBACK (peer_authorize_cb), NULL);
+
+  impl->peer_server = g_dbus_server_new_sync (address, G_DBUS_SERVER_FLAGS_NONE, guid,
+                                              observer, NULL, NULL);
+
+  if (impl->peer_server != NULL)
+    {
+      g_chmod (path, 0700);
+      impl->peer_socket_path = g_strdup (path);
+      impl->peer_connections = g_hash_table_new_full (NULL, NULL, NULL, peer_connection_free);
+      g_signal_connect (impl->peer_server, "new-connection",
+                        G_CALLBACK (peer_new_connection_cb), impl);
+      g_dbus_server_start (impl->peer_server);
+    }
+
+  g_object_unref (observer);
+  g_free (guid);
+  g_free (address);
+  g_free (escaped);
+  g_free (path);
+}
+
+static void
+g_application_impl_stop_peer_server (GApplicationImpl *impl)
+{
+  if (impl->peer_server)
+    {
+      g_dbus_server_stop (impl->peer_server);
+      g_signal_handlers_disconnect_by_func (impl->peer_server, peer_new_connection_cb, impl);
+      g_clear_object (&impl->peer_server);
+    }
+
+  if (impl->peer_socket_path)
+    {
+      g_unlink (impl->peer_socket_path);
+      g_clear_pointer (&impl->peer_socket_path, g_free);
+    }
+
+  g_clear_pointer (&impl->peer_connections, g_hash_table_unref);
+}
+
+/* Returns a connection to the primary instance of @appid, or %NULL if
+ * there is none that we can reach directly.
+ */
+static GDBusConnection *
+connect_to_primary (const gchar  *appid,
+                    GCancellable *cancellable)
+{
+  GDBusConnection *connection = NULL;
+  GSocketConnection *stream;
+  GCredentials *credentials;
+  GSocketAddress *address;
+  GSocket *socket;
+  gchar *path;
+
+  path = get_peer_socket_path (appid, FALSE);
+  if (path == NULL)
+    return NULL;
+
+  socket = g_socket_new (G_SOCKET_FAMILY_UNIX, G_SOCKET_TYPE_STREAM,
+                         G_SOCKET_PROTOCOL_DEFAULT, NULL);
+  if (socket == NULL)
+    {
+      g_free (path);
+      return NULL;
+    }
+
+  address = g_unix_socket_address_new (path);
+  g_free (path);
+
+  if (!g_socket_connect (socket, address, cancellable, NULL))
+    goto out;
+
+  /* Make sure that the primary is really ours before sending anything */
+  credentials = g_socket_get_credentials (socket, NULL);
+  if (is_same_user (credentials))
+    {
+      stream = g_socket_connection_factory_create_connection (socket);
+      connection = g_dbus_connection_new_sync (G_IO_STREAM (stream), NULL,
+                                               G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+                                               NULL, cancellable, NULL);
+      g_object_unref (stream);
+    }
+  g_clear_object (&credentials);
+
+ out:
+  g_object_unref (address);
+  g_object_unref (socket);
+
+  return connection;
+}
+#endif /* G_OS_UNIX */
+
 /* Attempt to become the primary instance.
  *
  * Returns %TRUE if everything went OK, regardless of if we became the
@@ -340,36 +664,11 @@ g_application_impl_attempt_primary (GApplicationImpl  *impl,
                                     GCancellable      *cancellable,
                                     GError           **error)
 {
-  const static GDBusInterfaceVTable vtable = {
-    g_application_impl_method_call,
-    g_application_impl_get_property,
-    NULL /* set_property */
-  };
   GApplicationClass *app_class = G_APPLICATION_GET_CLASS (impl->app);
   GVariant *reply;
   guint32 rval;
 
-  if (org_gtk_Application == NULL)
-    {
-      GError *error = NULL;
-      GDBusNodeInfo *info;
-
-      info = g_dbus_node_info_new_for_xml (org_gtk_Application_xml, &error);
-      if G_UNLIKELY (info == NULL)
-        g_error ("%s", error->message);
-      org_gtk_Application = g_dbus_node_info_lookup_interface (info, "org.gtk.Application");
-      g_assert (org_gtk_Application != NULL);
-      g_dbus_interface_info_ref (org_gtk_Application);
-      g_dbus_node_info_unref (info);
-
-      info = g_dbus_node_info_new_for_xml (org_freedesktop_Application_xml, &error);
-      if G_UNLIKELY (info == NULL)
-        g_error ("%s", error->message);
-      org_freedesktop_Application = g_dbus_node_info_lookup_interface (info, "org.freedesktop.Application");
-      g_assert (org_freedesktop_Application != NULL);
-      g_dbus_interface_info_ref (org_freedesktop_Application);
-      g_dbus_node_info_unref (info);
-    }
+  ensure_interface_info ();
 
   /* We could possibly have been D-Bus activated as a result of incoming
    * requests on either the application or actiongroup interfaces.
@@ -386,13 +685,13 @@ g_application_impl_attempt_primary (GApplicationImpl  *impl,
    * for the same reason.
    */
   impl->object_id = g_dbus_connection_register_object (impl->session_bus, impl->object_path,
-                                                       org_gtk_Application, &vtable, impl, NULL, error);
+                                                       org_gtk_Application, &application_vtable, impl, NULL, error);
 
   if (impl->object_id == 0)
     return FALSE;
 
   impl->fdo_object_id = g_dbus_connection_register_object (impl->session_bus, impl->object_path,
-                                                           org_freedesktop_Application, &vtable, impl, NULL, error);
+                                                           org_freedesktop_Application, &application_vtable, impl, NULL, error);
 
   if (impl->fdo_object_id == 0)
     return FALSE;
@@ -455,6 +754,10 @@ g_application_impl_stop_primary (GApplicationImpl *impl)
 {
   GApplicationClass *app_class = G_APPLICATION_GET_CLASS (impl->app);
 
+#ifdef G_OS_UNIX
+  g_application_impl_stop_peer_server (impl);
+#endif
+
   app_class->dbus_unregister (impl->app,
                               impl->session_bus,
                               impl->object_path);
@@ -506,6 +809,16 @@ g_application_impl_destroy (GApplicationImpl *impl)
   if (impl->session_bus)
     g_object_unref (impl->session_bus);
 
+  if (impl->peer)
+    {
+      /* closing drops whatever hasn't been written yet, unlike just
+       * dropping our reference to the shared session bus connection
+       */
+      g_dbus_connection_flush_sync (impl->peer, NULL, NULL);
+      g_dbus_connection_close_sync (impl->peer, NULL, NULL);
+      g_object_unref (impl->peer);
+    }
+
   g_free (impl->object_path);
 
   g_slice_free (GApplicationImpl, impl);
@@ -547,6 +860,34 @@ g_application_impl_register (GApplication        *application,
 
   impl->object_path = application_path_from_appid (appid);
 
+#ifdef G_OS_UNIX
+  /* If the primary instance is already running, send requests to it
+   * directly.  Services have to own the bus name, so they can't take
+   * this path.
+   */
+  if (impl->bus_name != NULL &&
+      (flags & G_APPLICATION_PEER_SOCKET) &&
+      (~flags & G_APPLICATION_IS_SERVICE))
+    {
+      impl->peer = connect_to_primary (appid, cancellable);
+
+      if (impl->peer != NULL)
+        {
+          actions = g_dbus_action_group_get (impl->peer, NULL, impl->object_path);
+          if (g_dbus_action_group_sync (actions, cancellable, NULL))
+            {
+              *remote_actions = G_REMOTE_ACTION_GROUP (actions);
+              return impl;
+            }
+
+          /* Something's wrong with the primary; try the bus instead */
+          g_object_unref (actions);
+          g_dbus_connection_close_sync (impl->peer, NULL, NULL);
+          g_clear_object (&impl->peer);
+        }
+    }
+#endif
+
   /* Only try to be the primary instance if
    * G_APPLICATION_IS_LAUNCHER was not specified.
    */
@@ -559,7 +900,13 @@ g_application_impl_register (GApplication        *application,
         }
 
       if (impl->primary)
-        return impl;
+        {
+#ifdef G_OS_UNIX
+          if (impl->bus_name != NULL && (flags & G_APPLICATION_PEER_SOCKET))
+            g_application_impl_start_peer_server (impl);
+#endif
+          return impl;
+        }
 
       /* We didn't make it.  Drop our service-side stuff. */
       g_application_impl_stop_primary (impl);
@@ -593,12 +940,34 @@ g_application_impl_register (GApplication        *application,
   return impl;
 }
 
+/* The connection to forward requests to the primary instance on, and
+ * the name to send them to.
+ */
+static GDBusConnection *
+get_primary_connection (GApplicationImpl  *impl,
+                        const gchar      **bus_name)
+{
+  if (impl->peer)
+    {
+      /* there are no names on a peer-to-peer connection */
+      *bus_name = NULL;
+      return impl->peer;
+    }
+
+  *bus_name = impl->bus_name;
+  return impl->session_bus;
+}
+
 void
 g_application_impl_activate (GApplicationImpl *impl,
                              GVariant         *platform_data)
 {
-  g_dbus_connection_call (impl->session_bus,
-                          impl->bus_name,
+  GDBusConnection *connection;
+  const gchar *bus_name;
+
+  connection = get_primary_connection (impl, &bus_name);
+  g_dbus_connection_call (connection,
+                          bus_name,
                           impl->object_path,
                           "org.gtk.Application",
                           "Activate",
@@ -613,6 +982,8 @@ g_application_impl_open (GApplicationImpl  *impl,
                          const gchar       *hint,
                          GVariant          *platform_data)
 {
+  GDBusConnection *connection;
+  const gchar *bus_name;
   GVariantBuilder builder;
   gint i;
 
@@ -628,8 +999,9 @@ g_application_impl_open (GApplicationImpl  *impl,
   g_variant_builder_add (&builder, "s", hint);
   g_variant_builder_add_value (&builder, platform_data);
 
-  g_dbus_connection_call (impl->session_bus,
-                          impl->bus_name,
+  connection = get_primary_connection (impl, &bus_name);
+  g_dbus_connection_call (connection,
+                          bus_name,
                           impl->object_path,
                           "org.gtk.Application",
                           "Open",
@@ -708,10 +1080,14 @@ g_application_impl_command_line (GApplicationImpl    *impl,
     g_application_impl_cmdline_method_call
   };
   const gchar *object_path = "/org/gtk/Application/CommandLine";
+  GDBusConnection *connection;
+  const gchar *bus_name;
   GMainContext *context;
   CommandLineData data;
   guint object_id;
 
+  connection = get_primary_connection (impl, &bus_name);
+
   context = g_main_context_new ();
   data.loop = g_main_loop_new (context, FALSE);
   g_main_context_push_thread_default (context);
@@ -730,7 +1106,7 @@ g_application_impl_command_line (GApplicationImpl    *impl,
       g_dbus_node_info_unref (info);
     }
 
-  object_id = g_dbus_connection_register_object (impl->session_bus, object_path,
+  object_id = g_dbus_connection_register_object (connection, object_path,
                                                  org_gtk_private_CommandLine,
                                                  &vtable, &data, NULL, NULL);
   /* In theory we should try other paths... */
@@ -748,7 +1124,7 @@ g_application_impl_command_line (GApplicationImpl    *impl,
     g_unix_fd_list_append (fd_list, 0, &error);
     g_assert_no_error (error);
 
-    g_dbus_connection_call_with_unix_fd_list (impl->session_bus, impl->bus_name, impl->object_path,
+    g_dbus_connection_call_with_unix_fd_list (connection, bus_name, impl->object_path,
                                               "org.gtk.Application", "CommandLine",
                                               g_variant_new ("(o^aay@a{sv})", object_path, arguments, platform_data),
                                               G_VARIANT_TYPE ("(i)"), 0, G_MAXINT, fd_list, NULL,
@@ -756,7 +1132,7 @@ g_application_impl_command_line (GApplicationImpl    *impl,
     g_object_unref (fd_list);
   }
 #else
-  g_dbus_connection_call (impl->session_bus, impl->bus_name, impl->object_path,
+  g_dbus_connection_call (connection, bus_name, impl->object_path,
                           "org.gtk.Application", "CommandLine",
                           g_variant_new ("(o^aay@a{sv})", object_path, arguments, platform_data),
                           G_VARIANT_TYPE ("(i)"), 0, G_MAXINT, NULL,
@@ -777,6 +1153,9 @@ g_application_impl_flush (GApplicationImpl *impl)
 {
   if (impl->session_bus)
     g_dbus_connection_flush_sync (impl->session_bus, NULL, NULL);
+
+  if (impl->peer)
+    g_dbus_connection_flush_sync (impl->peer, NULL, NULL);
 }
 
 GDBusConnection *
@@ -0,0 +1,409 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gbase64converter.h"
+
+#include "gioerror.h"
+#include "gioenums.h"
+#include "gioenumtypes.h"
+#include "glibintl.h"
+
+
+enum {
+  PROP_0,
+  PROP_MODE,
+  PROP_BREAK_LINES
+};
+
+/**
+ * SECTION:gbase64converter
+ * @short_description: Base-64 encoder and decoder
+ * @include: gio/gio.h
+ *
+ * #GBase64Converter is an implementation of #GConverter that encodes
+ * data to Base-64 or decodes it back, using g_base64_encode_step() and
+ * g_base64_decode_step(). Put it in a #GConverterInputStream or
+ * #GConverterOutputStream to handle payloads of any size without
+ * having them in memory at once.
+ *
+ * Like g_base64_decode(), decoding skips characters that are not part
+ * of the Base-64 alphabet, such as line breaks.
+ *
+ * Since: 2.54
+ */
+
+static void g_base64_converter_iface_init          (GConverterIface *iface);
+
+/**
+ * GBase64Converter:
+ *
+ * Base-64 encoding and decoding.
+ *
+ * Since: 2.54
+ */
+struct _GBase64Converter
+{
+  GObject parent_instance;
+
+  GBase64ConverterMode mode;
+  gboolean break_lines;
+  gint state;
+  guint save;
+};
+
+G_DEFINE_TYPE_WITH_CODE (GBase64Converter, g_base64_converter, G_TYPE_OBJECT,
+			 G_IMPLEMENT_INTERFACE (G_TYPE_CONVERTER,
+						g_base64_converter_iface_init))
+
+static void
+g_base64_converter_set_property (GObject      *object,
+				 guint         prop_id,
+				 const GValue *value,
+				 GParamSpec   *pspec)
+{
+  GBase64Converter *conv;
+
+  conv = G_BASE64_CONVERTER (object);
+
+  switch (prop_id)
+    {
+    case PROP_MODE:
+      conv->mode = g_value_get_enum (value);
+      break;
+
+    case PROP_BREAK_LINES:
+      conv->break_lines = g_value_get_boolean (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+g_base64_converter_get_property (GObject    *object,
+				 guint       prop_id,
+				 GValue     *value,
+				 GParamSpec *pspec)
+{
+  GBase64Converter *conv;
+
+  conv = G_BASE64_CONVERTER (object);
+
+  switch (prop_id)
+    {
+    case PROP_MODE:
+      g_value_set_enum (value, conv->mode);
+      break;
+
+    case PROP_BREAK_LINES:
+      g_value_set_boolean (value, conv->break_lines);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+g_base64_converter_init (GBase64Converter *conv)
+{
+}
+
+static void
+g_base64_converter_class_init (GBase64ConverterClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->get_property = g_base64_converter_get_property;
+  gobject_class->set_property = g_base64_converter_set_property;
+
+  /**
+   * GBase64Converter:mode:
+   *
+   * Whether the converter encodes or decodes.
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class,
+				   PROP_MODE,
+				   g_param_spec_enum ("mode",
+						      P_("mode"),
+						      P_("Whether to encode or decode"),
+						      G_TYPE_BASE64_CONVERTER_MODE,
+						      G_BASE64_CONVERTER_ENCODE,
+						      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+						      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GBase64Converter:break-lines:
+   *
+   * Whether the encoder breaks its output into lines, as
+   * g_base64_encode_step() does when asked to. Decoding accepts
+   * line breaks either way.
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class,
+				   PROP_BREAK_LINES,
+				   g_param_spec_boolean ("break-lines",
+							 P_("break lines"),
+							 P_("Whether to break encoded output into lines"),
+							 FALSE,
+							 G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+							 G_PARAM_STATIC_STRINGS));
+}
+
+/**
+ * g_base64_converter_new:
+ * @mode: whether to encode or decode
+ *
+ * Creates a new #GBase64Converter.
+ *
+ * Returns: a new #GBase64Converter
+ *
+ * Since: 2.54
+ */
+GBase64Converter *
+g_base64_converter_new (GBase64ConverterMode mode)
+{
+  return g_object_new (G_TYPE_BASE64_CONVERTER,
+		       "mode", mode,
+		       NULL);
+}
+
+/**
+ * g_base64_converter_get_mode:
+ * @converter: a #GBase64Converter
+ *
+ * Gets the #GBase64Converter:mode property.
+ *
+ * Returns: whether @converter encodes or decodes
+ *
+ * Since: 2.54
+ */
+GBase64ConverterMode
+g_base64_converter_get_mode (GBase64Converter *converter)
+{
+  g_return_val_if_fail (G_IS_BASE64_CONVERTER (converter), G_BASE64_CONVERTER_ENCODE);
+
+  return converter->mode;
+}
+
+/**
+ * g_base64_converter_get_break_lines:
+ * @converter: a #GBase64Converter
+ *
+ * Gets the #GBase64Converter:break-lines property.
+ *
+ * Returns: whether encoded output is broken into lines
+ *
+ * Since: 2.54
+ */
+gboolean
+g_base64_converter_get_break_lines (GBase64Converter *converter)
+{
+  g_return_val_if_fail (G_IS_BASE64_CONVERTER (converter), FALSE);
+
+  return converter->break_lines;
+}
+
+static void
+g_base64_converter_reset (GConverter *converter)
+{
+  GBase64Converter *conv = G_BASE64_CONVERTER (converter);
+
+  conv->state = 0;
+  conv->save = 0;
+}
+
+/* The output g_base64_encode_step() may need for @len bytes, as given
+ * in its documentation
+ */
+static gsize
+encode_bound (gsize    len,
+              gboolean break_lines)
+{
+  gsize bound;
+
+  bound = (len / 3 + 1) * 4 + 4;
+  if (break_lines)
+    bound += bound / 72 + 1;
+
+  return bound;
+}
+
+static GConverterResult
+g_base64_converter_encode (GBase64Converter *conv,
+			   const guchar     *inbuf,
+			   gsize             inbuf_size,
+			   gchar            *outbuf,
+			   gsize             outbuf_size,
+			   GConverterFlags   flags,
+			   gsize            *bytes_read,
+			   gsize            *bytes_written,
+			   GError          **error)
+{
+  gsize close_size = conv->break_lines ? 5 : 4;
+  gsize len;
+
+  /* as much input as is sure to fit */
+  len = outbuf_size / 4 * 3;
+  if (conv->break_lines)
+    len = len / 73 * 72;
+  len = MIN (len, inbuf_size);
+  while (len > 0 && encode_bound (len, conv->break_lines) > outbuf_size)
+    len -= MIN (len, 3);
+
+  if (len == 0 && inbuf_size > 0)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE,
+			   _("Not enough space in destination"));
+      return G_CONVERTER_ERROR;
+    }
+
+  *bytes_read = len;
+  *bytes_written = 0;
+  if (len > 0)
+    *bytes_written = g_base64_encode_step (inbuf, len, conv->break_lines,
+					   outbuf, &conv->state, (gint *) &conv->save);
+
+  if (len < inbuf_size)
+    return G_CONVERTER_CONVERTED;
+
+  if (flags & G_CONVERTER_INPUT_AT_END)
+    {
+      if (outbuf_size - *bytes_written < close_size)
+	{
+	  if (*bytes_written > 0)
+	    return G_CONVERTER_CONVERTED;
+
+	  g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE,
+			       _("Not enough space in destination"));
+	  return G_CONVERTER_ERROR;
+	}
+
+      *bytes_written += g_base64_encode_close (conv->break_lines,
+					       outbuf + *bytes_written,
+					       &conv->state, (gint *) &conv->save);
+      return G_CONVERTER_FINISHED;
+    }
+
+  /* Up to two bytes stay behind until the end of the input, since
+   * writing them out earlier would mean padding in the middle
+   */
+  if (flags & G_CONVERTER_FLUSH)
+    return G_CONVERTER_FLUSHED;
+
+  if (len == 0)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT,
+			   _("Need more input"));
+      return G_CONVERTER_ERROR;
+    }
+
+  return G_CONVERTER_CONVERTED;
+}
+
+static GConverterResult
+g_base64_converter_decode (GBase64Converter *conv,
+			   const gchar      *inbuf,
+			   gsize             inbuf_size,
+			   guchar           *outbuf,
+			   gsize             outbuf_size,
+			   GConverterFlags   flags,
+			   gsize            *bytes_read,
+			   gsize            *bytes_written,
+			   GError          **error)
+{
+  gsize len;
+
+  /* g_base64_decode_step() needs len / 4 * 3 + 3 bytes */
+  len = inbuf_size;
+  if (outbuf_size < 3)
+    len = 0;
+  else if ((outbuf_size - 3) / 3 < len / 4)
+    len = (outbuf_size - 3) / 3 * 4;
+
+  if (len == 0 && inbuf_size > 0)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE,
+			   _("Not enough space in destination"));
+      return G_CONVERTER_ERROR;
+    }
+
+  *bytes_read = len;
+  *bytes_written = 0;
+  if (len > 0)
+    *bytes_written = g_base64_decode_step (inbuf, len, outbuf,
+					   &conv->state, &conv->save);
+
+  if (len < inbuf_size)
+    return G_CONVERTER_CONVERTED;
+
+  /* like g_base64_decode(), a truncated last group is dropped */
+  if (flags & G_CONVERTER_INPUT_AT_END)
+    {
+      g_base64_converter_reset (G_CONVERTER (conv));
+      return G_CONVERTER_FINISHED;
+    }
+
+  if (flags & G_CONVERTER_FLUSH)
+    return G_CONVERTER_FLUSHED;
+
+  if (len == 0)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT,
+			   _("Need more input"));
+      return G_CONVERTER_ERROR;
+    }
+
+  return G_CONVERTER_CONVERTED;
+}
+
+static GConverterResult
+g_base64_converter_convert (GConverter      *converter,
+			    const void      *inbuf,
+			    gsize            inbuf_size,
+			    void            *outbuf,
+			    gsize            outbuf_size,
+			    GConverterFlags  flags,
+			    gsize           *bytes_read,
+			    gsize           *bytes_written,
+			    GError         **error)
+{
+  GBase64Converter *conv = G_BASE64_CONVERTER (converter);
+
+  if (conv->mode == G_BASE64_CONVERTER_ENCODE)
+    return g_base64_converter_encode (conv, inbuf, inbuf_size,
+				      outbuf, outbuf_size, flags,
+				      bytes_read, bytes_written, error);
+  else
+    return g_base64_converter_decode (conv, inbuf, inbuf_size,
+				      outbuf, outbuf_size, flags,
+				      bytes_read, bytes_written, error);
+}
+
+static void
+g_base64_converter_iface_init (GConverterIface *iface)
+{
+  iface->convert = g_base64_converter_convert;
+  iface->reset = g_base64_converter_reset;
+}
@@ -0,0 +1,55 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_BASE64_CONVERTER_H__
+#define __G_BASE64_CONVERTER_H__
+
+#if !defined (__GIO_GIO_H_INSIDE__) && !defined (GIO_COMPILATION)
+#error "Only <gio/gio.h> can be included directly."
+#endif
+
+#include <gio/gconverter.h>
+
+G_BEGIN_DECLS
+
+#define G_TYPE_BASE64_CONVERTER         (g_base64_converter_get_type ())
+#define G_BASE64_CONVERTER(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), G_TYPE_BASE64_CONVERTER, GBase64Converter))
+#define G_BASE64_CONVERTER_CLASS(k)     (G_TYPE_CHECK_CLASS_CAST((k), G_TYPE_BASE64_CONVERTER, GBase64ConverterClass))
+#define G_IS_BASE64_CONVERTER(o)        (G_TYPE_CHECK_INSTANCE_TYPE ((o), G_TYPE_BASE64_CONVERTER))
+#define G_IS_BASE64_CONVERTER_CLASS(k)  (G_TYPE_CHECK_CLASS_TYPE ((k), G_TYPE_BASE64_CONVERTER))
+#define G_BASE64_CONVERTER_GET_CLASS(o) (G_TYPE_INSTANCE_GET_CLASS ((o), G_TYPE_BASE64_CONVERTER, GBase64ConverterClass))
+
+typedef struct _GBase64ConverterClass   GBase64ConverterClass;
+
+struct _GBase64ConverterClass
+{
+  GObjectClass parent_class;
+};
+
+GLIB_AVAILABLE_IN_2_54
+GType                 g_base64_converter_get_type        (void) G_GNUC_CONST;
+
+GLIB_AVAILABLE_IN_2_54
+GBase64Converter     *g_base64_converter_new             (GBase64ConverterMode  mode);
+
+GLIB_AVAILABLE_IN_2_54
+GBase64ConverterMode  g_base64_converter_get_mode        (GBase64Converter     *converter);
+GLIB_AVAILABLE_IN_2_54
+gboolean              g_base64_converter_get_break_lines (GBase64Converter     *converter);
+
+G_END_DECLS
+
+#endif /* __G_BASE64_CONVERTER_H__ */
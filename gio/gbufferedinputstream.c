@@ -30,6 +30,11 @@
 #include <string.h>
 #include "glibintl.h"
 
+#ifdef G_OS_UNIX
+#include <fcntl.h>
+#include "gfiledescriptorbased.h"
+#endif
+
 
 /**
  * SECTION:gbufferedinputstream
@@ -51,22 +56,35 @@
  * buffered input stream's buffer, use
  * g_buffered_input_stream_set_buffer_size(). Note that the buffer's size
  * cannot be reduced below the size of the data within the buffer.
+ *
+ * Alternatively, g_buffered_input_stream_set_adaptive() lets the stream
+ * pick the buffer size itself, based on how much data the base stream
+ * delivers.
  */
 
 
 #define DEFAULT_BUFFER_SIZE 4096
 
+/* Adaptive mode doubles the buffer after this many consecutive fills
+ * that got as much data as they asked for, up to the maximum size.
+ */
+#define ADAPTIVE_FULL_FILLS 2
+#define ADAPTIVE_MAX_BUFFER_SIZE (1024 * 1024)
+
 struct _GBufferedInputStreamPrivate {
   guint8 *buffer;
   gsize   len;
   gsize   pos;
   gsize   end;
   GAsyncReadyCallback outstanding_callback;
+  guint   adaptive : 1;
+  guint   full_fills;
 };
 
 enum {
   PROP_0,
-  PROP_BUFSIZE
+  PROP_BUFSIZE,
+  PROP_ADAPTIVE
 };
 
 static void g_buffered_input_stream_set_property  (GObject      *object,
@@ -170,7 +188,22 @@ g_buffered_input_stream_class_init (GBufferedInputStreamClass *klass)
                                                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT |
                                                       G_PARAM_STATIC_NAME|G_PARAM_STATIC_NICK|G_PARAM_STATIC_BLURB));
 
-
+  /**
+   * GBufferedInputStream:adaptive:
+   *
+   * Whether the buffer size adapts to the base stream.
+   * See g_buffered_input_stream_set_adaptive().
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (object_class,
+                                   PROP_ADAPTIVE,
+                                   g_param_spec_boolean ("adaptive",
+                                                         P_("Adaptive"),
+                                                         P_("Whether the buffer size adapts to the base stream"),
+                                                         FALSE,
+                                                         G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                                                         G_PARAM_STATIC_STRINGS));
 }
 
 /**
@@ -239,6 +272,101 @@ g_buffered_input_stream_set_buffer_size (GBufferedInputStream *stream,
   g_object_notify (G_OBJECT (stream), "buffer-size");
 }
 
+/**
+ * g_buffered_input_stream_get_adaptive:
+ * @stream: a #GBufferedInputStream
+ *
+ * Checks whether the buffer size of @stream adapts to the base stream.
+ *
+ * Returns: %TRUE if @stream is in adaptive mode
+ *
+ * Since: 2.54
+ */
+gboolean
+g_buffered_input_stream_get_adaptive (GBufferedInputStream *stream)
+{
+  g_return_val_if_fail (G_IS_BUFFERED_INPUT_STREAM (stream), FALSE);
+
+  return stream->priv->adaptive;
+}
+
+/**
+ * g_buffered_input_stream_set_adaptive:
+ * @stream: a #GBufferedInputStream
+ * @adaptive: whether the buffer size should adapt
+ *
+ * Sets whether the buffer size of @stream adapts to the base stream.
+ *
+ * In adaptive mode, the buffer grows whenever the base stream keeps
+ * filling it completely, which is the case for fast local files and
+ * busy sockets; it is doubled every few such reads, up to 1 megabyte.
+ * It never shrinks.  Reads that are larger than the buffer always go
+ * straight to the base stream.
+ *
+ * If the base stream is a #GFileDescriptorBased (as local files are),
+ * enabling adaptive mode also tells the kernel that the file will be
+ * read sequentially, so that it reads ahead more aggressively.
+ *
+ * Since: 2.54
+ */
+void
+g_buffered_input_stream_set_adaptive (GBufferedInputStream *stream,
+                                      gboolean              adaptive)
+{
+  GBufferedInputStreamPrivate *priv;
+
+  g_return_if_fail (G_IS_BUFFERED_INPUT_STREAM (stream));
+
+  priv = stream->priv;
+  adaptive = adaptive != FALSE;
+
+  if (priv->adaptive == adaptive)
+    return;
+
+  priv->adaptive = adaptive;
+  priv->full_fills = 0;
+
+#if defined(G_OS_UNIX) && defined(HAVE_POSIX_FADVISE)
+  {
+    GInputStream *base_stream = G_FILTER_INPUT_STREAM (stream)->base_stream;
+
+    /* Only a hint, so errors (such as ESPIPE for sockets) don't matter */
+    if (G_IS_FILE_DESCRIPTOR_BASED (base_stream))
+      posix_fadvise (g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (base_stream)),
+                     0, 0, adaptive ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_NORMAL);
+  }
+#endif
+
+  g_object_notify (G_OBJECT (stream), "adaptive");
+}
+
+/* Called after each fill that asked for @requested bytes and got @nread */
+static void
+adapt_buffer_size (GBufferedInputStream *stream,
+                   gsize                 requested,
+                   gssize                nread)
+{
+  GBufferedInputStreamPrivate *priv = stream->priv;
+
+  if (!priv->adaptive || priv->len >= ADAPTIVE_MAX_BUFFER_SIZE)
+    return;
+
+  /* Short reads mean the base stream can't keep up with a bigger
+   * buffer anyway; small requests say nothing either way.
+   */
+  if (nread <= 0 || (gsize) nread < requested || requested < priv->len / 2)
+    {
+      priv->full_fills = 0;
+      return;
+    }
+
+  if (++priv->full_fills < ADAPTIVE_FULL_FILLS)
+    return;
+
+  priv->full_fills = 0;
+  g_buffered_input_stream_set_buffer_size (stream, MIN (priv->len * 2, ADAPTIVE_MAX_BUFFER_SIZE));
+}
+
 static void
 g_buffered_input_stream_set_property (GObject      *object,
                                       guint         prop_id,
@@ -255,6 +383,10 @@ g_buffered_input_stream_set_property (GObject      *object,
       g_buffered_input_stream_set_buffer_size (bstream, g_value_get_uint (value));
       break;
 
+    case PROP_ADAPTIVE:
+      g_buffered_input_stream_set_adaptive (bstream, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -279,6 +411,10 @@ g_buffered_input_stream_get_property (GObject    *object,
       g_value_set_uint (value, priv->len);
       break;
 
+    case PROP_ADAPTIVE:
+      g_value_set_boolean (value, priv->adaptive);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -677,6 +813,8 @@ g_buffered_input_stream_real_fill (GBufferedInputStream  *stream,
   if (nread > 0)
     priv->end += nread;
 
+  adapt_buffer_size (stream, count, nread);
+
   return nread;
 }
 
@@ -1045,6 +1183,8 @@ fill_async_callback (GObject      *source_object,
       g_assert_cmpint (priv->end + res, <=, priv->len);
       priv->end += res;
 
+      adapt_buffer_size (stream, GPOINTER_TO_SIZE (g_task_get_task_data (task)), res);
+
       g_task_return_int (task, res);
     }
 
@@ -1080,6 +1220,7 @@ g_buffered_input_stream_real_fill_async (GBufferedInputStream *stream,
 
   task = g_task_new (stream, cancellable, callback, user_data);
   g_task_set_source_tag (task, g_buffered_input_stream_real_fill_async);
+  g_task_set_task_data (task, GSIZE_TO_POINTER (count), NULL);
 
   base_stream = G_FILTER_INPUT_STREAM (stream)->base_stream;
   g_input_stream_read_async (base_stream,
@@ -95,6 +95,11 @@ gsize         g_buffered_input_stream_get_buffer_size (GBufferedInputStream  *st
 GLIB_AVAILABLE_IN_ALL
 void          g_buffered_input_stream_set_buffer_size (GBufferedInputStream  *stream,
 						       gsize                  size);
+GLIB_AVAILABLE_IN_2_54
+gboolean      g_buffered_input_stream_get_adaptive    (GBufferedInputStream  *stream);
+GLIB_AVAILABLE_IN_2_54
+void          g_buffered_input_stream_set_adaptive    (GBufferedInputStream  *stream,
+                                                       gboolean               adaptive);
 GLIB_AVAILABLE_IN_ALL
 gsize         g_buffered_input_stream_get_available   (GBufferedInputStream  *stream);
 GLIB_AVAILABLE_IN_ALL
@@ -47,21 +47,33 @@
  * buffered output stream's buffer, use 
  * g_buffered_output_stream_set_buffer_size(). Note that the buffer's 
  * size cannot be reduced below the size of the data within the buffer.
+ *
+ * Alternatively, g_buffered_output_stream_set_adaptive() lets the
+ * stream pick the buffer size itself, based on how it is written to.
  **/
 
 #define DEFAULT_BUFFER_SIZE 4096
 
+/* Adaptive mode doubles the buffer after this many consecutive writes
+ * that found it full, up to the maximum size.
+ */
+#define ADAPTIVE_FULL_FLUSHES 2
+#define ADAPTIVE_MAX_BUFFER_SIZE (1024 * 1024)
+
 struct _GBufferedOutputStreamPrivate {
   guint8 *buffer; 
   gsize   len;
   goffset pos;
   gboolean auto_grow;
+  gboolean adaptive;
+  guint    full_flushes;
 };
 
 enum {
   PROP_0,
   PROP_BUFSIZE,
-  PROP_AUTO_GROW
+  PROP_AUTO_GROW,
+  PROP_ADAPTIVE
 };
 
 static void     g_buffered_output_stream_set_property (GObject      *object,
@@ -167,6 +179,23 @@ g_buffered_output_stream_class_init (GBufferedOutputStreamClass *klass)
                                                          G_PARAM_READWRITE|
                                                          G_PARAM_STATIC_NAME|G_PARAM_STATIC_NICK|G_PARAM_STATIC_BLURB));
 
+  /**
+   * GBufferedOutputStream:adaptive:
+   *
+   * Whether the buffer size adapts to the writes.
+   * See g_buffered_output_stream_set_adaptive().
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (object_class,
+                                   PROP_ADAPTIVE,
+                                   g_param_spec_boolean ("adaptive",
+                                                         P_("Adaptive"),
+                                                         P_("Whether the buffer size adapts to the writes"),
+                                                         FALSE,
+                                                         G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                                                         G_PARAM_STATIC_STRINGS));
+
 }
 
 /**
@@ -269,6 +298,60 @@ g_buffered_output_stream_set_auto_grow (GBufferedOutputStream *stream,
     }
 }
 
+/**
+ * g_buffered_output_stream_get_adaptive:
+ * @stream: a #GBufferedOutputStream.
+ *
+ * Checks whether the buffer size of @stream adapts to the writes.
+ *
+ * Returns: %TRUE if @stream is in adaptive mode
+ *
+ * Since: 2.54
+ **/
+gboolean
+g_buffered_output_stream_get_adaptive (GBufferedOutputStream *stream)
+{
+  g_return_val_if_fail (G_IS_BUFFERED_OUTPUT_STREAM (stream), FALSE);
+
+  return stream->priv->adaptive;
+}
+
+/**
+ * g_buffered_output_stream_set_adaptive:
+ * @stream: a #GBufferedOutputStream.
+ * @adaptive: whether the buffer size should adapt
+ *
+ * Sets whether the buffer size of @stream adapts to the writes.
+ *
+ * In adaptive mode, the buffer grows whenever writes keep filling it
+ * up completely; it is doubled every few such writes, up to 1
+ * megabyte.  It never shrinks.  Writes that are at least as large as
+ * the buffer go straight to the base stream instead of being copied,
+ * after flushing whatever was buffered before them.
+ *
+ * This has no effect while #GBufferedOutputStream:auto-grow is set.
+ *
+ * Since: 2.54
+ **/
+void
+g_buffered_output_stream_set_adaptive (GBufferedOutputStream *stream,
+                                       gboolean               adaptive)
+{
+  GBufferedOutputStreamPrivate *priv;
+
+  g_return_if_fail (G_IS_BUFFERED_OUTPUT_STREAM (stream));
+
+  priv = stream->priv;
+  adaptive = adaptive != FALSE;
+
+  if (priv->adaptive != adaptive)
+    {
+      priv->adaptive = adaptive;
+      priv->full_flushes = 0;
+      g_object_notify (G_OBJECT (stream), "adaptive");
+    }
+}
+
 static void
 g_buffered_output_stream_set_property (GObject      *object,
                                        guint         prop_id,
@@ -289,6 +372,10 @@ g_buffered_output_stream_set_property (GObject      *object,
       g_buffered_output_stream_set_auto_grow (stream, g_value_get_boolean (value));
       break;
 
+    case PROP_ADAPTIVE:
+      g_buffered_output_stream_set_adaptive (stream, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -318,6 +405,10 @@ g_buffered_output_stream_get_property (GObject    *object,
       g_value_set_boolean (value, priv->auto_grow);
       break;
 
+    case PROP_ADAPTIVE:
+      g_value_set_boolean (value, priv->adaptive);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -454,6 +545,16 @@ g_buffered_output_stream_write  (GOutputStream *stream,
 
   n = priv->len - priv->pos;
 
+  if (priv->adaptive && !priv->auto_grow && count >= priv->len)
+    {
+      /* Large write, shortcut buffer */
+      if (priv->pos > 0 && !flush_buffer (bstream, cancellable, error))
+        return -1;
+
+      return g_output_stream_write (G_FILTER_OUTPUT_STREAM (stream)->base_stream,
+                                    buffer, count, cancellable, error);
+    }
+
   if (priv->auto_grow && n < count)
     {
       new_size = MAX (priv->len * 2, priv->len + count);
@@ -465,6 +566,14 @@ g_buffered_output_stream_write  (GOutputStream *stream,
       
       if (res == FALSE)
 	return -1;
+
+      if (priv->adaptive && priv->len < ADAPTIVE_MAX_BUFFER_SIZE &&
+          ++priv->full_flushes >= ADAPTIVE_FULL_FLUSHES)
+        {
+          /* The buffer is empty now, so growing it is cheap */
+          priv->full_flushes = 0;
+          g_buffered_output_stream_set_buffer_size (bstream, MIN (priv->len * 2, ADAPTIVE_MAX_BUFFER_SIZE));
+        }
     }
 
   n = priv->len - priv->pos;
@@ -488,6 +597,7 @@ g_buffered_output_stream_flush (GOutputStream  *stream,
   bstream = G_BUFFERED_OUTPUT_STREAM (stream);
   base_stream = G_FILTER_OUTPUT_STREAM (stream)->base_stream;
 
+  bstream->priv->full_flushes = 0;
   res = flush_buffer (bstream, cancellable, error);
 
   if (res == FALSE)
@@ -80,6 +80,11 @@ gboolean       g_buffered_output_stream_get_auto_grow   (GBufferedOutputStream *
 GLIB_AVAILABLE_IN_ALL
 void           g_buffered_output_stream_set_auto_grow   (GBufferedOutputStream *stream,
 							 gboolean               auto_grow);
+GLIB_AVAILABLE_IN_2_54
+gboolean       g_buffered_output_stream_get_adaptive    (GBufferedOutputStream *stream);
+GLIB_AVAILABLE_IN_2_54
+void           g_buffered_output_stream_set_adaptive    (GBufferedOutputStream *stream,
+                                                         gboolean               adaptive);
 
 G_END_DECLS
 
@@ -0,0 +1,181 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gbufferpool.h"
+
+/*
+ * A process-wide pool of read buffers, shared by all streams.
+ *
+ * Buffers come in power-of-two size classes between 1 KiB and 64 KiB,
+ * and each class keeps at most MAX_CACHED_BYTES of idle buffers around
+ * for reuse.  Larger requests are served by g_malloc() directly.
+ *
+ * Every buffer is preceded by a small header recording its class, so
+ * that it can find its way back to the right free list when the #GBytes
+ * wrapping it is released, possibly from another thread.
+ */
+
+#define MIN_BUFFER_SHIFT 10
+#define MAX_BUFFER_SHIFT 16
+#define N_SIZE_CLASSES   (MAX_BUFFER_SHIFT - MIN_BUFFER_SHIFT + 1)
+#define MAX_CACHED_BYTES (1 << 20)
+#define UNPOOLED         G_MAXUINT
+
+typedef union
+{
+  struct
+  {
+    guint size_class;
+    gsize size;
+  } h;
+
+  /* keep the buffer that follows suitably aligned */
+  gint64   align_int;
+  gdouble  align_double;
+  gpointer align_pointer;
+} BufferHeader;
+
+typedef struct
+{
+  GMutex        lock;
+  BufferHeader *free_list;
+  gsize         n_free;
+} SizeClass;
+
+static SizeClass size_classes[N_SIZE_CLASSES];
+
+static guint
+get_size_class (gsize size)
+{
+  guint i;
+
+  for (i = 0; i < N_SIZE_CLASSES; i++)
+    if (size <= ((gsize) 1 << (MIN_BUFFER_SHIFT + i)))
+      return i;
+
+  return UNPOOLED;
+}
+
+/*
+ * _g_buffer_pool_alloc:
+ * @size: the number of bytes needed
+ *
+ * Takes a buffer of at least @size bytes from the pool, allocating a
+ * new one if there is no idle buffer of the right size class.
+ *
+ * Returns: a buffer, to be released with _g_buffer_pool_free() or
+ *   handed over to _g_buffer_pool_bytes_new_take()
+ */
+gpointer
+_g_buffer_pool_alloc (gsize size)
+{
+  BufferHeader *header = NULL;
+  guint size_class;
+
+  size_class = get_size_class (size);
+
+  if (size_class != UNPOOLED)
+    {
+      SizeClass *sc = &size_classes[size_class];
+
+      size = (gsize) 1 << (MIN_BUFFER_SHIFT + size_class);
+
+      g_mutex_lock (&sc->lock);
+      if (sc->free_list)
+        {
+          header = sc->free_list;
+          sc->free_list = *(BufferHeader **) (header + 1);
+          sc->n_free--;
+        }
+      g_mutex_unlock (&sc->lock);
+    }
+
+  if (header == NULL)
+    {
+      header = g_malloc (sizeof (BufferHeader) + size);
+      header->h.size_class = size_class;
+      header->h.size = size;
+    }
+
+  return header + 1;
+}
+
+/*
+ * _g_buffer_pool_free:
+ * @buffer: a buffer returned by _g_buffer_pool_alloc()
+ *
+ * Returns @buffer to the pool, or frees it if the pool already caches
+ * enough buffers of its size class.
+ */
+void
+_g_buffer_pool_free (gpointer buffer)
+{
+  BufferHeader *header = (BufferHeader *) buffer - 1;
+
+  if (header->h.size_class != UNPOOLED)
+    {
+      SizeClass *sc = &size_classes[header->h.size_class];
+
+      g_mutex_lock (&sc->lock);
+      if ((sc->n_free + 1) * header->h.size <= MAX_CACHED_BYTES)
+        {
+          *(BufferHeader **) buffer = sc->free_list;
+          sc->free_list = header;
+          sc->n_free++;
+          header = NULL;
+        }
+      g_mutex_unlock (&sc->lock);
+    }
+
+  g_free (header);
+}
+
+/*
+ * _g_buffer_pool_bytes_new_take:
+ * @buffer: (transfer full): a buffer returned by _g_buffer_pool_alloc()
+ * @length: the number of valid bytes at the start of @buffer
+ *
+ * Wraps the first @length bytes of @buffer in a #GBytes which returns
+ * @buffer to the pool when it is released. Short contents are copied
+ * into a right-sized #GBytes instead, and @buffer is returned to the
+ * pool immediately, so that a few bytes never pin a whole buffer.
+ *
+ * Returns: (transfer full): a new #GBytes
+ */
+GBytes *
+_g_buffer_pool_bytes_new_take (gpointer buffer,
+                               gsize    length)
+{
+  BufferHeader *header = (BufferHeader *) buffer - 1;
+  GBytes *bytes;
+
+  g_return_val_if_fail (length <= header->h.size, NULL);
+
+  if (length > header->h.size / 4)
+    return g_bytes_new_with_free_func (buffer, length,
+                                       _g_buffer_pool_free, buffer);
+
+  if (length == 0)
+    bytes = g_bytes_new_static ("", 0);
+  else
+    bytes = g_bytes_new (buffer, length);
+
+  _g_buffer_pool_free (buffer);
+
+  return bytes;
+}
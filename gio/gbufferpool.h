@@ -0,0 +1,31 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_BUFFER_POOL_H__
+#define __G_BUFFER_POOL_H__
+
+#include <gio/giotypes.h>
+
+G_BEGIN_DECLS
+
+gpointer _g_buffer_pool_alloc          (gsize     size);
+void     _g_buffer_pool_free           (gpointer  buffer);
+GBytes * _g_buffer_pool_bytes_new_take (gpointer  buffer,
+                                        gsize     length);
+
+G_END_DECLS
+
+#endif /* __G_BUFFER_POOL_H__ */
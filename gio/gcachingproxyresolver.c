@@ -0,0 +1,454 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <glib.h>
+
+#include "gcachingproxyresolver.h"
+
+#include "gcancellable.h"
+#include "gnetworkingprivate.h"
+#include "gtask.h"
+
+/* Proxy configuration rarely changes, but when it does the change
+ * should be picked up reasonably quickly.
+ */
+#define DEFAULT_TTL         60
+
+#define DEFAULT_MAX_ENTRIES 128
+
+typedef struct {
+  gchar *key;
+  gchar **proxies;
+  gint64 expiry;    /* monotonic time */
+  GList lru_link;
+} CacheEntry;
+
+/* A lookup that has been sent to the backend; further asynchronous
+ * lookups for the same key wait for it instead of sending their own.
+ */
+typedef struct {
+  GCachingProxyResolver *resolver;
+  gchar *key;
+  GList *waiters;  /* of GTask, owned */
+} InFlightLookup;
+
+typedef struct {
+  InFlightLookup *in_flight;  /* NULL once the task has been returned */
+  GSource *cancelled_source;
+} Waiter;
+
+static void g_caching_proxy_resolver_iface_init (GProxyResolverInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (GCachingProxyResolver, g_caching_proxy_resolver, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_PROXY_RESOLVER,
+                                                g_caching_proxy_resolver_iface_init))
+
+/* Results are cached per scheme, host and port. The destination URIs
+ * built by GProxyAddressEnumerator have nothing else in them, and the
+ * proxy configurations GIO knows about don't depend on anything else.
+ * URIs that can't be parsed are used as they are.
+ */
+static gchar *
+make_key (const gchar *uri)
+{
+  gchar *scheme, *host, *key;
+  guint16 port;
+
+  scheme = g_uri_parse_scheme (uri);
+  if (scheme == NULL)
+    return g_strdup (uri);
+
+  if (!_g_uri_parse_authority (uri, &host, &port, NULL))
+    {
+      g_free (scheme);
+      return g_strdup (uri);
+    }
+
+  key = g_strdup_printf ("%s://%s:%u", scheme, host, port);
+  g_free (scheme);
+  g_free (host);
+
+  return g_ascii_strdown (key, -1);
+}
+
+static void
+cache_entry_free (CacheEntry *entry)
+{
+  g_strfreev (entry->proxies);
+  g_free (entry->key);
+  g_slice_free (CacheEntry, entry);
+}
+
+/* Must be called with the lock held */
+static void
+cache_remove (GCachingProxyResolver *self,
+              CacheEntry            *entry)
+{
+  g_queue_unlink (&self->lru, &entry->lru_link);
+  g_hash_table_remove (self->cache, entry->key);
+}
+
+/* Returns a copy of the cached proxies for @key, or %NULL */
+static gchar **
+cache_lookup (GCachingProxyResolver *self,
+              const gchar           *key)
+{
+  CacheEntry *entry;
+  gchar **proxies = NULL;
+
+  g_mutex_lock (&self->lock);
+
+  entry = g_hash_table_lookup (self->cache, key);
+  if (entry != NULL && entry->expiry <= g_get_monotonic_time ())
+    {
+      cache_remove (self, entry);
+      entry = NULL;
+    }
+
+  if (entry != NULL)
+    {
+      g_queue_unlink (&self->lru, &entry->lru_link);
+      g_queue_push_head_link (&self->lru, &entry->lru_link);
+      proxies = g_strdupv (entry->proxies);
+    }
+
+  g_mutex_unlock (&self->lock);
+
+  return proxies;
+}
+
+/* Only successful lookups are cached; failures are retried next time */
+static void
+cache_insert (GCachingProxyResolver *self,
+              const gchar           *key,
+              gchar                **proxies)
+{
+  CacheEntry *entry;
+
+  if (proxies == NULL)
+    return;
+
+  entry = g_slice_new0 (CacheEntry);
+  entry->key = g_strdup (key);
+  entry->proxies = g_strdupv (proxies);
+  entry->expiry = g_get_monotonic_time () + (gint64) self->ttl * G_USEC_PER_SEC;
+  entry->lru_link.data = entry;
+
+  g_mutex_lock (&self->lock);
+
+  if (g_hash_table_contains (self->cache, key))
+    cache_remove (self, g_hash_table_lookup (self->cache, key));
+
+  g_hash_table_insert (self->cache, entry->key, entry);
+  g_queue_push_head_link (&self->lru, &entry->lru_link);
+
+  while (self->lru.length > self->max_entries)
+    cache_remove (self, g_queue_peek_tail (&self->lru));
+
+  g_mutex_unlock (&self->lock);
+}
+
+static gboolean
+g_caching_proxy_resolver_is_supported (GProxyResolver *resolver)
+{
+  GCachingProxyResolver *self = G_CACHING_PROXY_RESOLVER (resolver);
+
+  return g_proxy_resolver_is_supported (self->backend);
+}
+
+/* Synchronous lookups are not coalesced; they go straight to the backend
+ * on a cache miss.
+ */
+static gchar **
+g_caching_proxy_resolver_lookup (GProxyResolver  *resolver,
+                                 const gchar     *uri,
+                                 GCancellable    *cancellable,
+                                 GError         **error)
+{
+  GCachingProxyResolver *self = G_CACHING_PROXY_RESOLVER (resolver);
+  gchar **proxies;
+  gchar *key;
+
+  key = make_key (uri);
+  proxies = cache_lookup (self, key);
+  if (proxies == NULL)
+    {
+      proxies = g_proxy_resolver_lookup (self->backend, uri, cancellable, error);
+      cache_insert (self, key, proxies);
+    }
+  g_free (key);
+
+  return proxies;
+}
+
+static void
+waiter_free (Waiter *waiter)
+{
+  if (waiter->cancelled_source != NULL)
+    g_source_unref (waiter->cancelled_source);
+  g_slice_free (Waiter, waiter);
+}
+
+static void
+in_flight_lookup_free (InFlightLookup *in_flight)
+{
+  g_assert (in_flight->waiters == NULL);
+
+  g_object_unref (in_flight->resolver);
+  g_free (in_flight->key);
+  g_slice_free (InFlightLookup, in_flight);
+}
+
+static gboolean
+waiter_cancelled_cb (gpointer user_data)
+{
+  GTask *task = user_data;
+  GCachingProxyResolver *self = g_task_get_source_object (task);
+  Waiter *waiter = g_task_get_task_data (task);
+  gboolean was_waiting = FALSE;
+
+  /* The lookup carries on for the remaining waiters, if any, and the
+   * result still ends up in the cache.
+   */
+  g_mutex_lock (&self->lock);
+  if (waiter->in_flight != NULL)
+    {
+      waiter->in_flight->waiters = g_list_remove (waiter->in_flight->waiters, task);
+      waiter->in_flight = NULL;
+      was_waiting = TRUE;
+    }
+  g_mutex_unlock (&self->lock);
+
+  if (was_waiting)
+    {
+      g_task_return_error_if_cancelled (task);
+      g_object_unref (task);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+backend_lookup_done (GObject      *source,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+  InFlightLookup *in_flight = user_data;
+  GCachingProxyResolver *self = in_flight->resolver;
+  GError *error = NULL;
+  gchar **proxies;
+  GList *waiters, *l;
+
+  proxies = g_proxy_resolver_lookup_finish (self->backend, result, &error);
+
+  cache_insert (self, in_flight->key, proxies);
+
+  g_mutex_lock (&self->lock);
+  g_hash_table_remove (self->in_flight, in_flight->key);
+  waiters = in_flight->waiters;
+  in_flight->waiters = NULL;
+  for (l = waiters; l != NULL; l = l->next)
+    {
+      Waiter *waiter = g_task_get_task_data (l->data);
+
+      waiter->in_flight = NULL;
+    }
+  g_mutex_unlock (&self->lock);
+
+  for (l = waiters; l != NULL; l = l->next)
+    {
+      GTask *task = l->data;
+      Waiter *waiter = g_task_get_task_data (task);
+
+      if (waiter->cancelled_source != NULL)
+        g_source_destroy (waiter->cancelled_source);
+
+      if (proxies != NULL)
+        g_task_return_pointer (task, g_strdupv (proxies), (GDestroyNotify) g_strfreev);
+      else
+        g_task_return_error (task, g_error_copy (error));
+    }
+  g_list_free_full (waiters, g_object_unref);
+
+  g_strfreev (proxies);
+  g_clear_error (&error);
+  in_flight_lookup_free (in_flight);
+}
+
+static void
+g_caching_proxy_resolver_lookup_async (GProxyResolver      *resolver,
+                                       const gchar         *uri,
+                                       GCancellable        *cancellable,
+                                       GAsyncReadyCallback  callback,
+                                       gpointer             user_data)
+{
+  GCachingProxyResolver *self = G_CACHING_PROXY_RESOLVER (resolver);
+  InFlightLookup *in_flight;
+  gboolean start_lookup = FALSE;
+  gchar **proxies;
+  Waiter *waiter;
+  GTask *task;
+  gchar *key;
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_caching_proxy_resolver_lookup_async);
+
+  key = make_key (uri);
+  proxies = cache_lookup (self, key);
+  if (proxies != NULL)
+    {
+      g_task_return_pointer (task, proxies, (GDestroyNotify) g_strfreev);
+      g_object_unref (task);
+      g_free (key);
+      return;
+    }
+
+  waiter = g_slice_new0 (Waiter);
+  g_task_set_task_data (task, waiter, (GDestroyNotify) waiter_free);
+
+  g_mutex_lock (&self->lock);
+
+  in_flight = g_hash_table_lookup (self->in_flight, key);
+  if (in_flight == NULL)
+    {
+      in_flight = g_slice_new0 (InFlightLookup);
+      in_flight->resolver = g_object_ref (self);
+      in_flight->key = g_strdup (key);
+      g_hash_table_insert (self->in_flight, in_flight->key, in_flight);
+      start_lookup = TRUE;
+    }
+
+  waiter->in_flight = in_flight;
+  in_flight->waiters = g_list_prepend (in_flight->waiters, task);
+
+  if (cancellable != NULL)
+    {
+      waiter->cancelled_source = g_cancellable_source_new (cancellable);
+      g_task_attach_source (task, waiter->cancelled_source, waiter_cancelled_cb);
+    }
+
+  g_mutex_unlock (&self->lock);
+
+  /* The backend lookup is shared between all waiters, so it is not
+   * cancelled along with any one of them.
+   */
+  if (start_lookup)
+    g_proxy_resolver_lookup_async (self->backend, uri, NULL,
+                                   backend_lookup_done, in_flight);
+
+  g_free (key);
+}
+
+static gchar **
+g_caching_proxy_resolver_lookup_finish (GProxyResolver  *resolver,
+                                        GAsyncResult    *result,
+                                        GError         **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, resolver), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static void
+g_caching_proxy_resolver_init (GCachingProxyResolver *self)
+{
+  g_mutex_init (&self->lock);
+  self->cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                       NULL, (GDestroyNotify) cache_entry_free);
+  self->in_flight = g_hash_table_new (g_str_hash, g_str_equal);
+}
+
+static void
+g_caching_proxy_resolver_finalize (GObject *object)
+{
+  GCachingProxyResolver *self = G_CACHING_PROXY_RESOLVER (object);
+
+  /* in-flight lookups hold a reference on us */
+  g_assert (g_hash_table_size (self->in_flight) == 0);
+
+  g_hash_table_unref (self->in_flight);
+  g_hash_table_unref (self->cache);
+  g_clear_object (&self->backend);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (g_caching_proxy_resolver_parent_class)->finalize (object);
+}
+
+static void
+g_caching_proxy_resolver_class_init (GCachingProxyResolverClass *caching_class)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (caching_class);
+
+  object_class->finalize = g_caching_proxy_resolver_finalize;
+}
+
+static void
+g_caching_proxy_resolver_iface_init (GProxyResolverInterface *iface)
+{
+  iface->is_supported  = g_caching_proxy_resolver_is_supported;
+  iface->lookup        = g_caching_proxy_resolver_lookup;
+  iface->lookup_async  = g_caching_proxy_resolver_lookup_async;
+  iface->lookup_finish = g_caching_proxy_resolver_lookup_finish;
+}
+
+/**
+ * g_proxy_resolver_new_caching:
+ * @resolver: the #GProxyResolver to do the actual lookups with,
+ *     typically the one returned by g_proxy_resolver_get_default()
+ * @ttl: how long to keep results for, in seconds, or 0 for a default
+ *     of one minute
+ * @max_entries: the maximum number of results to keep, or 0 for a
+ *     default size
+ *
+ * Creates a #GProxyResolver that caches the results of lookups done
+ * with @resolver. This is worthwhile when many connections are made,
+ * since with some resolvers each lookup is a round trip to another
+ * process.
+ *
+ * Results are cached per URI scheme, host and port, so the proxy
+ * configuration must not depend on anything else in the URI, such as
+ * its path; this is the case for all the URIs #GSocketClient looks up.
+ * Failed lookups are not cached. Changes to the system proxy
+ * configuration are picked up once cached results expire.
+ *
+ * Concurrent asynchronous lookups for the same destination share a
+ * single lookup on @resolver.
+ *
+ * Use the returned resolver with g_socket_client_set_proxy_resolver().
+ *
+ * Returns: (transfer full): a new caching #GProxyResolver
+ *
+ * Since: 2.54
+ */
+GProxyResolver *
+g_proxy_resolver_new_caching (GProxyResolver *resolver,
+                              guint           ttl,
+                              guint           max_entries)
+{
+  GCachingProxyResolver *self;
+
+  g_return_val_if_fail (G_IS_PROXY_RESOLVER (resolver), NULL);
+
+  self = g_object_new (G_TYPE_CACHING_PROXY_RESOLVER, NULL);
+  self->backend = g_object_ref (resolver);
+  self->ttl = ttl > 0 ? ttl : DEFAULT_TTL;
+  self->max_entries = max_entries > 0 ? max_entries : DEFAULT_MAX_ENTRIES;
+
+  return G_PROXY_RESOLVER (self);
+}
@@ -0,0 +1,691 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <glib.h>
+
+#include "gcachingresolver.h"
+#include "gthreadedresolver.h"
+
+#include "gcancellable.h"
+#include "ginetaddress.h"
+#include "gioerror.h"
+#include "gtask.h"
+
+/* How long results are kept when the backend can't tell us their
+ * time to live; getaddrinfo() doesn't report TTLs.
+ */
+#define DEFAULT_TTL      60
+/* How long "not found" answers are kept */
+#define NEGATIVE_TTL     20
+/* Upper bound for TTLs coming from DNS */
+#define MAX_TTL          (24 * 60 * 60)
+
+#define DEFAULT_MAX_ENTRIES 512
+
+typedef enum {
+  LOOKUP_BY_NAME,
+  LOOKUP_BY_ADDRESS,
+  LOOKUP_RECORDS
+} LookupType;
+
+typedef struct {
+  gchar *key;
+  LookupType type;
+  gpointer result;  /* NULL for a negative entry */
+  GError *error;    /* set for a negative entry */
+  gint64 expiry;    /* monotonic time */
+  GList lru_link;
+} CacheEntry;
+
+/* A lookup that has been sent to the backend; further asynchronous
+ * lookups for the same key wait for it instead of sending their own.
+ */
+typedef struct {
+  GCachingResolver *resolver;
+  gchar *key;
+  LookupType type;
+  gchar *name;
+  GInetAddress *address;
+  GResolverRecordType record_type;
+  GList *waiters;  /* of GTask, owned */
+} InFlightLookup;
+
+typedef struct {
+  InFlightLookup *in_flight;  /* NULL once the task has been returned */
+  GSource *cancelled_source;
+} Waiter;
+
+G_DEFINE_TYPE (GCachingResolver, g_caching_resolver, G_TYPE_RESOLVER)
+
+static gchar *
+make_key (LookupType           type,
+          const gchar         *name,
+          GInetAddress        *address,
+          GResolverRecordType  record_type)
+{
+  gchar *key, *str;
+
+  /* DNS names are case-insensitive */
+  if (address != NULL)
+    str = g_inet_address_to_string (address);
+  else
+    str = g_ascii_strdown (name, -1);
+
+  key = g_strdup_printf ("%d:%d:%s", type,
+                         type == LOOKUP_RECORDS ? (gint) record_type : 0,
+                         str);
+  g_free (str);
+
+  return key;
+}
+
+static void
+free_records (GList *records)
+{
+  g_list_free_full (records, (GDestroyNotify) g_variant_unref);
+}
+
+static GDestroyNotify
+result_free_func (LookupType type)
+{
+  switch (type)
+    {
+    case LOOKUP_BY_NAME:
+      return (GDestroyNotify) g_resolver_free_addresses;
+    case LOOKUP_BY_ADDRESS:
+      return g_free;
+    case LOOKUP_RECORDS:
+      return (GDestroyNotify) free_records;
+    }
+  g_return_val_if_reached (NULL);
+}
+
+static gpointer
+copy_result (LookupType type,
+             gpointer   result)
+{
+  switch (type)
+    {
+    case LOOKUP_BY_NAME:
+      return g_list_copy_deep (result, (GCopyFunc) g_object_ref, NULL);
+    case LOOKUP_BY_ADDRESS:
+      return g_strdup (result);
+    case LOOKUP_RECORDS:
+      return g_list_copy_deep (result, (GCopyFunc) g_variant_ref, NULL);
+    }
+  g_return_val_if_reached (NULL);
+}
+
+static void
+cache_entry_free (CacheEntry *entry)
+{
+  if (entry->result != NULL)
+    result_free_func (entry->type) (entry->result);
+  g_clear_error (&entry->error);
+  g_free (entry->key);
+  g_slice_free (CacheEntry, entry);
+}
+
+/* Must be called with the lock held */
+static void
+cache_remove (GCachingResolver *self,
+              CacheEntry       *entry)
+{
+  g_queue_unlink (&self->lru, &entry->lru_link);
+  g_hash_table_remove (self->cache, entry->key);
+}
+
+/* Returns %TRUE if @key was in the cache, in which case either @result
+ * is set to a copy of the cached result, or @error is set.
+ */
+static gboolean
+cache_lookup (GCachingResolver  *self,
+              const gchar       *key,
+              gpointer          *result,
+              GError           **error)
+{
+  CacheEntry *entry;
+  gboolean found = FALSE;
+
+  g_mutex_lock (&self->lock);
+
+  entry = g_hash_table_lookup (self->cache, key);
+  if (entry != NULL && entry->expiry <= g_get_monotonic_time ())
+    {
+      cache_remove (self, entry);
+      entry = NULL;
+    }
+
+  if (entry != NULL)
+    {
+      g_queue_unlink (&self->lru, &entry->lru_link);
+      g_queue_push_head_link (&self->lru, &entry->lru_link);
+
+      if (entry->result != NULL)
+        *result = copy_result (entry->type, entry->result);
+      else
+        g_propagate_error (error, g_error_copy (entry->error));
+      found = TRUE;
+    }
+
+  g_mutex_unlock (&self->lock);
+
+  return found;
+}
+
+/* Remembers the outcome of a backend lookup. Only positive results
+ * and definite "not found" answers are cached; anything else, like a
+ * temporary failure or a cancellation, will be retried next time.
+ */
+static void
+cache_insert (GCachingResolver *self,
+              const gchar      *key,
+              LookupType        type,
+              gpointer          result,
+              const GError     *error,
+              guint32           ttl)
+{
+  CacheEntry *entry;
+
+  if (result == NULL)
+    {
+      if (!g_error_matches (error, G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND))
+        return;
+      ttl = NEGATIVE_TTL;
+    }
+  if (ttl == 0)
+    return;
+
+  entry = g_slice_new0 (CacheEntry);
+  entry->key = g_strdup (key);
+  entry->type = type;
+  if (result != NULL)
+    entry->result = copy_result (type, result);
+  else
+    entry->error = g_error_copy (error);
+  entry->expiry = g_get_monotonic_time () + (gint64) MIN (ttl, MAX_TTL) * G_USEC_PER_SEC;
+  entry->lru_link.data = entry;
+
+  g_mutex_lock (&self->lock);
+
+  if (g_hash_table_contains (self->cache, key))
+    cache_remove (self, g_hash_table_lookup (self->cache, key));
+
+  g_hash_table_insert (self->cache, entry->key, entry);
+  g_queue_push_head_link (&self->lru, &entry->lru_link);
+
+  while (self->lru.length > self->max_entries)
+    cache_remove (self, g_queue_peek_tail (&self->lru));
+
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+g_caching_resolver_reload (GResolver *resolver)
+{
+  GCachingResolver *self = G_CACHING_RESOLVER (resolver);
+
+  /* The network configuration changed; the results may be stale */
+  g_mutex_lock (&self->lock);
+  g_queue_init (&self->lru);
+  g_hash_table_remove_all (self->cache);
+  g_mutex_unlock (&self->lock);
+}
+
+/* Synchronous lookups are not coalesced; they go straight to the backend
+ * on a cache miss.
+ */
+static gpointer
+lookup_sync (GCachingResolver     *self,
+             LookupType            type,
+             const gchar          *name,
+             GInetAddress         *address,
+             GResolverRecordType   record_type,
+             GCancellable         *cancellable,
+             GError              **error)
+{
+  GError *local_error = NULL;
+  gpointer result = NULL;
+  guint32 ttl = DEFAULT_TTL;
+  gchar *key;
+
+  key = make_key (type, name, address, record_type);
+  if (cache_lookup (self, key, &result, error))
+    {
+      g_free (key);
+      return result;
+    }
+
+  switch (type)
+    {
+    case LOOKUP_BY_NAME:
+      result = g_resolver_lookup_by_name (self->backend, name, cancellable, &local_error);
+      break;
+    case LOOKUP_BY_ADDRESS:
+      result = g_resolver_lookup_by_address (self->backend, address, cancellable, &local_error);
+      break;
+    case LOOKUP_RECORDS:
+      if (G_IS_THREADED_RESOLVER (self->backend))
+        result = _g_threaded_resolver_lookup_records_with_ttl (G_THREADED_RESOLVER (self->backend),
+                                                               name, record_type, &ttl,
+                                                               cancellable, &local_error);
+      else
+        result = g_resolver_lookup_records (self->backend, name, record_type,
+                                            cancellable, &local_error);
+      break;
+    }
+
+  cache_insert (self, key, type, result, local_error, ttl);
+  g_free (key);
+
+  if (local_error != NULL)
+    g_propagate_error (error, local_error);
+
+  return result;
+}
+
+static void
+waiter_free (Waiter *waiter)
+{
+  if (waiter->cancelled_source != NULL)
+    g_source_unref (waiter->cancelled_source);
+  g_slice_free (Waiter, waiter);
+}
+
+static void
+in_flight_lookup_free (InFlightLookup *in_flight)
+{
+  g_assert (in_flight->waiters == NULL);
+
+  g_object_unref (in_flight->resolver);
+  g_free (in_flight->key);
+  g_free (in_flight->name);
+  g_clear_object (&in_flight->address);
+  g_slice_free (InFlightLookup, in_flight);
+}
+
+static gboolean
+waiter_cancelled_cb (gpointer user_data)
+{
+  GTask *task = user_data;
+  GCachingResolver *self = g_task_get_source_object (task);
+  Waiter *waiter = g_task_get_task_data (task);
+  gboolean was_waiting = FALSE;
+
+  /* The lookup carries on for the remaining waiters, if any, and the
+   * result still ends up in the cache.
+   */
+  g_mutex_lock (&self->lock);
+  if (waiter->in_flight != NULL)
+    {
+      waiter->in_flight->waiters = g_list_remove (waiter->in_flight->waiters, task);
+      waiter->in_flight = NULL;
+      was_waiting = TRUE;
+    }
+  g_mutex_unlock (&self->lock);
+
+  if (was_waiting)
+    {
+      g_task_return_error_if_cancelled (task);
+      g_object_unref (task);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+backend_lookup_done (GObject      *source,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+  InFlightLookup *in_flight = user_data;
+  GCachingResolver *self = in_flight->resolver;
+  GError *error = NULL;
+  gpointer lookup_result = NULL;
+  guint32 ttl = DEFAULT_TTL;
+  GList *waiters, *l;
+
+  switch (in_flight->type)
+    {
+    case LOOKUP_BY_NAME:
+      lookup_result = g_resolver_lookup_by_name_finish (self->backend, result, &error);
+      break;
+    case LOOKUP_BY_ADDRESS:
+      lookup_result = g_resolver_lookup_by_address_finish (self->backend, result, &error);
+      break;
+    case LOOKUP_RECORDS:
+      lookup_result = g_resolver_lookup_records_finish (self->backend, result, &error);
+      if (lookup_result != NULL && G_IS_THREADED_RESOLVER (self->backend))
+        ttl = _g_threaded_resolver_get_records_ttl (result);
+      break;
+    }
+
+  cache_insert (self, in_flight->key, in_flight->type, lookup_result, error, ttl);
+
+  g_mutex_lock (&self->lock);
+  g_hash_table_remove (self->in_flight, in_flight->key);
+  waiters = in_flight->waiters;
+  in_flight->waiters = NULL;
+  for (l = waiters; l != NULL; l = l->next)
+    {
+      Waiter *waiter = g_task_get_task_data (l->data);
+
+      waiter->in_flight = NULL;
+    }
+  g_mutex_unlock (&self->lock);
+
+  for (l = waiters; l != NULL; l = l->next)
+    {
+      GTask *task = l->data;
+      Waiter *waiter = g_task_get_task_data (task);
+
+      if (waiter->cancelled_source != NULL)
+        g_source_destroy (waiter->cancelled_source);
+
+      if (lookup_result != NULL)
+        g_task_return_pointer (task,
+                               copy_result (in_flight->type, lookup_result),
+                               result_free_func (in_flight->type));
+      else
+        g_task_return_error (task, g_error_copy (error));
+    }
+  g_list_free_full (waiters, g_object_unref);
+
+  if (lookup_result != NULL)
+    result_free_func (in_flight->type) (lookup_result);
+  g_clear_error (&error);
+  in_flight_lookup_free (in_flight);
+}
+
+static void
+lookup_async (GCachingResolver     *self,
+              LookupType            type,
+              const gchar          *name,
+              GInetAddress         *address,
+              GResolverRecordType   record_type,
+              GCancellable         *cancellable,
+              gpointer              source_tag,
+              GAsyncReadyCallback   callback,
+              gpointer              user_data)
+{
+  InFlightLookup *in_flight;
+  gboolean start_lookup = FALSE;
+  GError *error = NULL;
+  gpointer result = NULL;
+  Waiter *waiter;
+  GTask *task;
+  gchar *key;
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, source_tag);
+
+  key = make_key (type, name, address, record_type);
+  if (cache_lookup (self, key, &result, &error))
+    {
+      if (result != NULL)
+        g_task_return_pointer (task, result, result_free_func (type));
+      else
+        g_task_return_error (task, error);
+      g_object_unref (task);
+      g_free (key);
+      return;
+    }
+
+  waiter = g_slice_new0 (Waiter);
+  g_task_set_task_data (task, waiter, (GDestroyNotify) waiter_free);
+
+  g_mutex_lock (&self->lock);
+
+  in_flight = g_hash_table_lookup (self->in_flight, key);
+  if (in_flight == NULL)
+    {
+      in_flight = g_slice_new0 (InFlightLookup);
+      in_flight->resolver = g_object_ref (self);
+      in_flight->key = g_strdup (key);
+      in_flight->type = type;
+      in_flight->name = g_strdup (name);
+      in_flight->address = address ? g_object_ref (address) : NULL;
+      in_flight->record_type = record_type;
+      g_hash_table_insert (self->in_flight, in_flight->key, in_flight);
+      start_lookup = TRUE;
+    }
+
+  waiter->in_flight = in_flight;
+  in_flight->waiters = g_list_prepend (in_flight->waiters, task);
+
+  if (cancellable != NULL)
+    {
+      waiter->cancelled_source = g_cancellable_source_new (cancellable);
+      g_task_attach_source (task, waiter->cancelled_source, waiter_cancelled_cb);
+    }
+
+  g_mutex_unlock (&self->lock);
+
+  /* The backend lookup is shared between all waiters, so it is not
+   * cancelled along with any one of them.
+   */
+  if (start_lookup)
+    {
+      switch (type)
+        {
+        case LOOKUP_BY_NAME:
+          g_resolver_lookup_by_name_async (self->backend, name, NULL,
+                                           backend_lookup_done, in_flight);
+          break;
+        case LOOKUP_BY_ADDRESS:
+          g_resolver_lookup_by_address_async (self->backend, address, NULL,
+                                              backend_lookup_done, in_flight);
+          break;
+        case LOOKUP_RECORDS:
+          g_resolver_lookup_records_async (self->backend, name, record_type, NULL,
+                                           backend_lookup_done, in_flight);
+          break;
+        }
+    }
+
+  g_free (key);
+}
+
+static gpointer
+lookup_finish (GResolver     *resolver,
+               GAsyncResult  *result,
+               GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, resolver), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static GList *
+lookup_by_name (GResolver     *resolver,
+                const gchar   *hostname,
+                GCancellable  *cancellable,
+                GError       **error)
+{
+  return lookup_sync (G_CACHING_RESOLVER (resolver), LOOKUP_BY_NAME,
+                      hostname, NULL, 0, cancellable, error);
+}
+
+static void
+lookup_by_name_async (GResolver           *resolver,
+                      const gchar         *hostname,
+                      GCancellable        *cancellable,
+                      GAsyncReadyCallback  callback,
+                      gpointer             user_data)
+{
+  lookup_async (G_CACHING_RESOLVER (resolver), LOOKUP_BY_NAME,
+                hostname, NULL, 0, cancellable,
+                lookup_by_name_async, callback, user_data);
+}
+
+static GList *
+lookup_by_name_finish (GResolver     *resolver,
+                       GAsyncResult  *result,
+                       GError       **error)
+{
+  return lookup_finish (resolver, result, error);
+}
+
+static gchar *
+lookup_by_address (GResolver     *resolver,
+                   GInetAddress  *address,
+                   GCancellable  *cancellable,
+                   GError       **error)
+{
+  return lookup_sync (G_CACHING_RESOLVER (resolver), LOOKUP_BY_ADDRESS,
+                      NULL, address, 0, cancellable, error);
+}
+
+static void
+lookup_by_address_async (GResolver           *resolver,
+                         GInetAddress        *address,
+                         GCancellable        *cancellable,
+                         GAsyncReadyCallback  callback,
+                         gpointer             user_data)
+{
+  lookup_async (G_CACHING_RESOLVER (resolver), LOOKUP_BY_ADDRESS,
+                NULL, address, 0, cancellable,
+                lookup_by_address_async, callback, user_data);
+}
+
+static gchar *
+lookup_by_address_finish (GResolver     *resolver,
+                          GAsyncResult  *result,
+                          GError       **error)
+{
+  return lookup_finish (resolver, result, error);
+}
+
+static GList *
+lookup_records (GResolver            *resolver,
+                const gchar          *rrname,
+                GResolverRecordType   record_type,
+                GCancellable         *cancellable,
+                GError              **error)
+{
+  return lookup_sync (G_CACHING_RESOLVER (resolver), LOOKUP_RECORDS,
+                      rrname, NULL, record_type, cancellable, error);
+}
+
+static void
+lookup_records_async (GResolver           *resolver,
+                      const gchar         *rrname,
+                      GResolverRecordType  record_type,
+                      GCancellable        *cancellable,
+                      GAsyncReadyCallback  callback,
+                      gpointer             user_data)
+{
+  lookup_async (G_CACHING_RESOLVER (resolver), LOOKUP_RECORDS,
+                rrname, NULL, record_type, cancellable,
+                lookup_records_async, callback, user_data);
+}
+
+static GList *
+lookup_records_finish (GResolver     *resolver,
+                       GAsyncResult  *result,
+                       GError       **error)
+{
+  return lookup_finish (resolver, result, error);
+}
+
+static void
+g_caching_resolver_init (GCachingResolver *self)
+{
+  g_mutex_init (&self->lock);
+  self->cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                       NULL, (GDestroyNotify) cache_entry_free);
+  self->in_flight = g_hash_table_new (g_str_hash, g_str_equal);
+}
+
+static void
+g_caching_resolver_finalize (GObject *object)
+{
+  GCachingResolver *self = G_CACHING_RESOLVER (object);
+
+  /* in-flight lookups hold a reference on us */
+  g_assert (g_hash_table_size (self->in_flight) == 0);
+
+  g_hash_table_unref (self->in_flight);
+  g_hash_table_unref (self->cache);
+  g_clear_object (&self->backend);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (g_caching_resolver_parent_class)->finalize (object);
+}
+
+static void
+g_caching_resolver_class_init (GCachingResolverClass *caching_class)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (caching_class);
+  GResolverClass *resolver_class = G_RESOLVER_CLASS (caching_class);
+
+  object_class->finalize = g_caching_resolver_finalize;
+
+  resolver_class->reload                   = g_caching_resolver_reload;
+  resolver_class->lookup_by_name           = lookup_by_name;
+  resolver_class->lookup_by_name_async     = lookup_by_name_async;
+  resolver_class->lookup_by_name_finish    = lookup_by_name_finish;
+  resolver_class->lookup_by_address        = lookup_by_address;
+  resolver_class->lookup_by_address_async  = lookup_by_address_async;
+  resolver_class->lookup_by_address_finish = lookup_by_address_finish;
+  resolver_class->lookup_records           = lookup_records;
+  resolver_class->lookup_records_async     = lookup_records_async;
+  resolver_class->lookup_records_finish    = lookup_records_finish;
+}
+
+/**
+ * g_resolver_new_caching:
+ * @resolver: the #GResolver to do the actual lookups with, typically
+ *     the one returned by g_resolver_get_default()
+ * @max_entries: the maximum number of results to keep, or 0 for a
+ *     default size
+ *
+ * Creates a #GResolver that caches the results of lookups done with
+ * @resolver. Records looked up in DNS are kept for as long as their
+ * time to live allows; other results, such as the addresses returned
+ * by g_resolver_lookup_by_name(), which the system resolver doesn't
+ * report a time to live for, are kept for one minute. Lookups that
+ * failed with %G_RESOLVER_ERROR_NOT_FOUND are cached briefly too.
+ * The cache is flushed when the system resolver configuration
+ * changes.
+ *
+ * Concurrent asynchronous lookups of the same name share a single
+ * lookup on @resolver.
+ *
+ * To make all of GIO use the cache, pass the returned resolver to
+ * g_resolver_set_default().
+ *
+ * Returns: (transfer full): a new caching #GResolver
+ *
+ * Since: 2.54
+ */
+GResolver *
+g_resolver_new_caching (GResolver *resolver,
+                        guint      max_entries)
+{
+  GCachingResolver *self;
+
+  g_return_val_if_fail (G_IS_RESOLVER (resolver), NULL);
+
+  self = g_object_new (G_TYPE_CACHING_RESOLVER, NULL);
+  self->backend = g_object_ref (resolver);
+  self->max_entries = max_entries > 0 ? max_entries : DEFAULT_MAX_ENTRIES;
+
+  return G_RESOLVER (self);
+}
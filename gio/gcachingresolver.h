@@ -0,0 +1,49 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_CACHING_RESOLVER_H__
+#define __G_CACHING_RESOLVER_H__
+
+#include <gio/gresolver.h>
+
+G_BEGIN_DECLS
+
+#define G_TYPE_CACHING_RESOLVER         (g_caching_resolver_get_type ())
+#define G_CACHING_RESOLVER(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), G_TYPE_CACHING_RESOLVER, GCachingResolver))
+#define G_IS_CACHING_RESOLVER(o)        (G_TYPE_CHECK_INSTANCE_TYPE ((o), G_TYPE_CACHING_RESOLVER))
+
+typedef struct {
+  GResolver parent_instance;
+
+  GResolver *backend;
+  guint max_entries;
+
+  GMutex lock;
+  GHashTable *cache;      /* key -> CacheEntry */
+  GQueue lru;             /* of CacheEntry, most recently used first */
+  GHashTable *in_flight;  /* key -> InFlightLookup */
+} GCachingResolver;
+
+typedef struct {
+  GResolverClass parent_class;
+
+} GCachingResolverClass;
+
+GType g_caching_resolver_get_type (void) G_GNUC_CONST;
+
+G_END_DECLS
+
+#endif /* __G_CACHING_RESOLVER_H__ */
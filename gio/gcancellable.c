@@ -23,6 +23,7 @@
 #include <gioerror.h>
 #include "glib-private.h"
 #include "gcancellable.h"
+#include "gioprivate.h"
 #include "glibintl.h"
 
 
@@ -46,9 +47,20 @@ struct _GCancellablePrivate
   guint cancelled : 1;
   guint cancelled_running : 1;
   guint cancelled_running_waiting : 1;
+  guint deadline_expired : 1;
+
+  gint64 deadline;  /* monotonic time, or -1 */
 
   guint fd_refcount;
   GWakeup *wakeup;
+
+  /* All protected by cancellable_mutex. Children are held weakly and
+   * unlink themselves on dispose; each child holds a ref on @parent.
+   */
+  GCancellable *parent;
+  GCancellable *first_child;
+  GCancellable *prev_sibling;
+  GCancellable *next_sibling;
 };
 
 static guint signals[LAST_SIGNAL] = { 0 };
@@ -59,6 +71,35 @@ static GPrivate current_cancellable;
 static GMutex cancellable_mutex;
 static GCond cancellable_cond;
 
+static void
+g_cancellable_dispose (GObject *object)
+{
+  GCancellablePrivate *priv = G_CANCELLABLE (object)->priv;
+  GCancellable *parent;
+
+  g_mutex_lock (&cancellable_mutex);
+
+  parent = priv->parent;
+  if (parent != NULL)
+    {
+      if (priv->prev_sibling != NULL)
+        priv->prev_sibling->priv->next_sibling = priv->next_sibling;
+      else
+        parent->priv->first_child = priv->next_sibling;
+      if (priv->next_sibling != NULL)
+        priv->next_sibling->priv->prev_sibling = priv->prev_sibling;
+
+      priv->parent = priv->prev_sibling = priv->next_sibling = NULL;
+    }
+
+  g_mutex_unlock (&cancellable_mutex);
+
+  if (parent != NULL)
+    g_object_unref (parent);
+
+  G_OBJECT_CLASS (g_cancellable_parent_class)->dispose (object);
+}
+
 static void
 g_cancellable_finalize (GObject *object)
 {
@@ -75,6 +116,7 @@ g_cancellable_class_init (GCancellableClass *klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 
+  gobject_class->dispose = g_cancellable_dispose;
   gobject_class->finalize = g_cancellable_finalize;
 
   /**
@@ -148,6 +190,7 @@ static void
 g_cancellable_init (GCancellable *cancellable)
 {
   cancellable->priv = g_cancellable_get_instance_private (cancellable);
+  cancellable->priv->deadline = -1;
 }
 
 /**
@@ -170,6 +213,170 @@ g_cancellable_new (void)
   return g_object_new (G_TYPE_CANCELLABLE, NULL);
 }
 
+/**
+ * g_cancellable_new_with_parent:
+ * @parent: the parent #GCancellable
+ *
+ * Creates a new #GCancellable object that is cancelled whenever
+ * @parent is. If @parent is already cancelled, the new cancellable
+ * starts out cancelled too.
+ *
+ * Cancellation only propagates downward: cancelling the returned
+ * cancellable does not affect @parent or its other children, and
+ * g_cancellable_reset() on @parent does not reset its children.
+ *
+ * This is cheaper than forwarding cancellation with a
+ * #GCancellable::cancelled handler, and it is race-free. The child
+ * holds a reference on @parent for as long as it is alive. It also
+ * inherits the deadline of @parent, if it has one; see
+ * g_cancellable_new_with_deadline().
+ *
+ * Returns: a #GCancellable.
+ *
+ * Since: 2.54
+ **/
+GCancellable *
+g_cancellable_new_with_parent (GCancellable *parent)
+{
+  GCancellable *cancellable;
+  GCancellablePrivate *priv;
+
+  g_return_val_if_fail (G_IS_CANCELLABLE (parent), NULL);
+
+  cancellable = g_object_new (G_TYPE_CANCELLABLE, NULL);
+  priv = cancellable->priv;
+
+  g_mutex_lock (&cancellable_mutex);
+
+  priv->parent = g_object_ref (parent);
+  priv->next_sibling = parent->priv->first_child;
+  if (priv->next_sibling != NULL)
+    priv->next_sibling->priv->prev_sibling = cancellable;
+  parent->priv->first_child = cancellable;
+
+  /* Nothing can be connected to us yet, so there is no signal to emit */
+  priv->cancelled = parent->priv->cancelled;
+  priv->deadline_expired = parent->priv->deadline_expired;
+  priv->deadline = parent->priv->deadline;
+
+  g_mutex_unlock (&cancellable_mutex);
+
+  return cancellable;
+}
+
+/**
+ * g_cancellable_new_with_deadline:
+ * @deadline: the monotonic time, in microseconds, at which the
+ *   cancellable expires
+ *
+ * Creates a new #GCancellable object that cancels itself once
+ * g_get_monotonic_time() reaches @deadline.
+ *
+ * No timer is involved. Rather, the deadline is enforced wherever the
+ * cancellable is checked or waited on. g_cancellable_is_cancelled()
+ * notices expiry and cancels the cancellable. #GSources created with
+ * g_cancellable_source_new() trigger at @deadline. The blocking GIO
+ * calls that poll on the cancellable, such as
+ * g_socket_condition_timed_wait() and blocking #GSocket and
+ * #GUnixInputStream I/O, bound their poll by it. So timing out an
+ * operation costs no additional #GSource.
+ *
+ * When the cancellable is cancelled because @deadline passed,
+ * g_cancellable_set_error_if_cancelled() reports
+ * %G_IO_ERROR_TIMED_OUT rather than %G_IO_ERROR_CANCELLED.
+ *
+ * Code that passes the fd from g_cancellable_make_pollfd() to
+ * g_poll() itself should limit its timeout to the deadline
+ * returned by g_cancellable_get_deadline().
+ *
+ * Returns: a #GCancellable.
+ *
+ * Since: 2.54
+ **/
+GCancellable *
+g_cancellable_new_with_deadline (gint64 deadline)
+{
+  GCancellable *cancellable;
+
+  g_return_val_if_fail (deadline >= 0, NULL);
+
+  cancellable = g_object_new (G_TYPE_CANCELLABLE, NULL);
+  cancellable->priv->deadline = deadline;
+
+  return cancellable;
+}
+
+/**
+ * g_cancellable_get_deadline:
+ * @cancellable: (nullable): a #GCancellable or %NULL
+ *
+ * Gets the deadline of @cancellable, as set by
+ * g_cancellable_new_with_deadline() or inherited with
+ * g_cancellable_new_with_parent().
+ *
+ * Returns: the monotonic time at which @cancellable expires, or -1 if
+ *   it does not have a deadline
+ *
+ * Since: 2.54
+ **/
+gint64
+g_cancellable_get_deadline (GCancellable *cancellable)
+{
+  if (cancellable == NULL)
+    return -1;
+
+  g_return_val_if_fail (G_IS_CANCELLABLE (cancellable), -1);
+
+  return cancellable->priv->deadline;
+}
+
+/* Returns @timeout (in milliseconds, or -1 for none) shortened so that
+ * a poll with it wakes up no later than @cancellable's deadline.
+ */
+gint64
+g_cancellable_get_poll_timeout (GCancellable *cancellable,
+                                gint64        timeout)
+{
+  gint64 remaining;
+
+  if (cancellable == NULL || cancellable->priv->deadline < 0)
+    return timeout;
+
+  remaining = cancellable->priv->deadline - g_get_monotonic_time ();
+  if (remaining <= 0)
+    return 0;
+
+  /* Round up, so we don't wake up just short of the deadline */
+  remaining = (remaining + 999) / 1000;
+  if (remaining > G_MAXINT)
+    remaining = G_MAXINT;
+
+  if (timeout < 0 || remaining < timeout)
+    return remaining;
+
+  return timeout;
+}
+
+/**
+ * g_cancellable_get_parent:
+ * @cancellable: a #GCancellable object
+ *
+ * Gets the cancellable that @cancellable was created from with
+ * g_cancellable_new_with_parent(), if any.
+ *
+ * Returns: (nullable) (transfer none): the parent of @cancellable,
+ *   or %NULL
+ *
+ * Since: 2.54
+ **/
+GCancellable *
+g_cancellable_get_parent (GCancellable *cancellable)
+{
+  g_return_val_if_fail (G_IS_CANCELLABLE (cancellable), NULL);
+
+  return cancellable->priv->parent;
+}
+
 /**
  * g_cancellable_push_current:
  * @cancellable: a #GCancellable object
@@ -275,11 +482,69 @@ g_cancellable_reset (GCancellable *cancellable)
         GLIB_PRIVATE_CALL (g_wakeup_acknowledge) (priv->wakeup);
 
       priv->cancelled = FALSE;
+      priv->deadline_expired = FALSE;
     }
 
   g_mutex_unlock (&cancellable_mutex);
 }
 
+static void
+cancel_internal (GCancellable *cancellable,
+                 gboolean      deadline_expired)
+{
+  GCancellablePrivate *priv;
+  GCancellable *child;
+  GSList *children = NULL, *l;
+
+  if (cancellable == NULL ||
+      cancellable->priv->cancelled)
+    return;
+
+  priv = cancellable->priv;
+
+  g_mutex_lock (&cancellable_mutex);
+
+  if (priv->cancelled)
+    {
+      g_mutex_unlock (&cancellable_mutex);
+      return;
+    }
+
+  priv->cancelled = TRUE;
+  priv->deadline_expired = deadline_expired;
+  priv->cancelled_running = TRUE;
+
+  if (priv->wakeup)
+    GLIB_PRIVATE_CALL (g_wakeup_signal) (priv->wakeup);
+
+  g_mutex_unlock (&cancellable_mutex);
+
+  g_object_ref (cancellable);
+  g_signal_emit (cancellable, signals[CANCELLED], 0);
+
+  g_mutex_lock (&cancellable_mutex);
+
+  priv->cancelled_running = FALSE;
+  if (priv->cancelled_running_waiting)
+    g_cond_broadcast (&cancellable_cond);
+  priv->cancelled_running_waiting = FALSE;
+
+  /* Children that are being disposed concurrently are still linked
+   * until they take the lock, so they have a reference left for us
+   * to take.
+   */
+  for (child = priv->first_child; child != NULL; child = child->priv->next_sibling)
+    children = g_slist_prepend (children, g_object_ref (child));
+
+  g_mutex_unlock (&cancellable_mutex);
+
+  for (l = children; l != NULL; l = l->next)
+    cancel_internal (l->data, deadline_expired);
+  g_slist_free_full (children, g_object_unref);
+
+  g_object_unref (cancellable);
+}
+
 /**
  * g_cancellable_is_cancelled:
  * @cancellable: (nullable): a #GCancellable or %NULL
@@ -292,7 +557,20 @@ g_cancellable_reset (GCancellable *cancellable)
 gboolean
 g_cancellable_is_cancelled (GCancellable *cancellable)
 {
-  return cancellable != NULL && cancellable->priv->cancelled;
+  if (cancellable == NULL)
+    return FALSE;
+
+  if (cancellable->priv->cancelled)
+    return TRUE;
+
+  if (cancellable->priv->deadline >= 0 &&
+      g_get_monotonic_time () >= cancellable->priv->deadline)
+    {
+      cancel_internal (cancellable, TRUE);
+      return TRUE;
+    }
+
+  return FALSE;
 }
 
 /**
@@ -303,6 +581,10 @@ g_cancellable_is_cancelled (GCancellable *cancellable)
  * If the @cancellable is cancelled, sets the error to notify
  * that the operation was cancelled.
  *
+ * The error is %G_IO_ERROR_CANCELLED, or %G_IO_ERROR_TIMED_OUT if
+ * @cancellable was cancelled because its deadline passed (see
+ * g_cancellable_new_with_deadline()).
+ *
  * Returns: %TRUE if @cancellable was cancelled, %FALSE if it was not
  */
 gboolean
@@ -311,10 +593,16 @@ g_cancellable_set_error_if_cancelled (GCancellable  *cancellable,
 {
   if (g_cancellable_is_cancelled (cancellable))
     {
-      g_set_error_literal (error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_CANCELLED,
-                           _("Operation was cancelled"));
+      if (cancellable->priv->deadline_expired)
+        g_set_error_literal (error,
+                             G_IO_ERROR,
+                             G_IO_ERROR_TIMED_OUT,
+                             _("Operation timed out"));
+      else
+        g_set_error_literal (error,
+                             G_IO_ERROR,
+                             G_IO_ERROR_CANCELLED,
+                             _("Operation was cancelled"));
       return TRUE;
     }
 
@@ -471,6 +759,10 @@ g_cancellable_release_fd (GCancellable *cancellable)
  *
  * If @cancellable is %NULL, this function returns immediately for convenience.
  *
+ * Any cancellables created from @cancellable with
+ * g_cancellable_new_with_parent() are cancelled as well, after
+ * #GCancellable::cancelled has been emitted on @cancellable.
+ *
  * The convention within GIO is that cancelling an asynchronous
  * operation causes it to complete asynchronously. That is, if you
  * cancel the operation from the same thread in which it is running,
@@ -480,43 +772,7 @@ g_cancellable_release_fd (GCancellable *cancellable)
 void
 g_cancellable_cancel (GCancellable *cancellable)
 {
-  GCancellablePrivate *priv;
-
-  if (cancellable == NULL ||
-      cancellable->priv->cancelled)
-    return;
-
-  priv = cancellable->priv;
-
-  g_mutex_lock (&cancellable_mutex);
-
-  if (priv->cancelled)
-    {
-      g_mutex_unlock (&cancellable_mutex);
-      return;
-    }
-
-  priv->cancelled = TRUE;
-  priv->cancelled_running = TRUE;
-
-  if (priv->wakeup)
-    GLIB_PRIVATE_CALL (g_wakeup_signal) (priv->wakeup);
-
-  g_mutex_unlock (&cancellable_mutex);
-
-  g_object_ref (cancellable);
-  g_signal_emit (cancellable, signals[CANCELLED], 0);
-
-  g_mutex_lock (&cancellable_mutex);
-
-  priv->cancelled_running = FALSE;
-  if (priv->cancelled_running_waiting)
-    g_cond_broadcast (&cancellable_cond);
-  priv->cancelled_running_waiting = FALSE;
-
-  g_mutex_unlock (&cancellable_mutex);
-
-  g_object_unref (cancellable);
+  cancel_internal (cancellable, FALSE);
 }
 
 /**
@@ -661,6 +917,9 @@ cancellable_source_dispatch (GSource     *source,
   GCancellableSourceFunc func = (GCancellableSourceFunc)callback;
   GCancellableSource *cancellable_source = (GCancellableSource *)source;
 
+  /* If we were woken by the deadline, this is what cancels */
+  g_cancellable_is_cancelled (cancellable_source->cancellable);
+
   g_source_set_ready_time (source, -1);
   return (*func) (cancellable_source->cancellable, user_data);
 }
@@ -752,6 +1011,8 @@ g_cancellable_source_new (GCancellable *cancellable)
                           source);
       if (g_cancellable_is_cancelled (cancellable))
         g_source_set_ready_time (source, 0);
+      else if (cancellable->priv->deadline >= 0)
+        g_source_set_ready_time (source, cancellable->priv->deadline);
     }
 
   return source;
@@ -72,6 +72,14 @@ GType         g_cancellable_get_type               (void) G_GNUC_CONST;
 
 GLIB_AVAILABLE_IN_ALL
 GCancellable *g_cancellable_new                    (void);
+GLIB_AVAILABLE_IN_2_54
+GCancellable *g_cancellable_new_with_parent        (GCancellable  *parent);
+GLIB_AVAILABLE_IN_2_54
+GCancellable *g_cancellable_get_parent             (GCancellable  *cancellable);
+GLIB_AVAILABLE_IN_2_54
+GCancellable *g_cancellable_new_with_deadline      (gint64         deadline);
+GLIB_AVAILABLE_IN_2_54
+gint64        g_cancellable_get_deadline           (GCancellable  *cancellable);
 
 /* These are only safe to call inside a cancellable op */
 GLIB_AVAILABLE_IN_ALL
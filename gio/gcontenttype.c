@@ -612,6 +612,113 @@ g_content_type_from_mime_type (const gchar *mime_type)
   return umime;
 }
 
+/* Matching a name against the globs ends with an fnmatch() of it
+ * against every pattern that isn't a plain literal or suffix, which is
+ * most of the cost of guessing from the name; and get_content_type() in
+ * glocalfileinfo.c guesses twice for names that need sniffing.  So the
+ * results are kept for the most recently looked up names.
+ *
+ * Entries go when the mime database is reloaded.  xdgmime only checks
+ * for that when it is called, so an entry older than that check
+ * interval is looked up again instead of being used.
+ */
+#define NAME_CACHE_SIZE 1024
+#define NAME_CACHE_MAX_AGE (5 * G_USEC_PER_SEC)
+
+typedef struct {
+  char *name;
+  GList link;
+  gint64 time;
+  int n_mimetypes;
+  const char *mimetypes[10];  /* interned */
+} NameCacheEntry;
+
+static GHashTable *name_cache;  /* name -> NameCacheEntry, protected by gio_xdgmime */
+static GQueue name_cache_lru = G_QUEUE_INIT;
+
+static void
+name_cache_entry_free (gpointer data)
+{
+  NameCacheEntry *entry = data;
+
+  g_queue_unlink (&name_cache_lru, &entry->link);
+  g_free (entry->name);
+  g_slice_free (NameCacheEntry, entry);
+}
+
+/* Called by xdgmime with gio_xdgmime held */
+static void
+name_cache_reload (void *user_data)
+{
+  g_hash_table_remove_all (name_cache);
+}
+
+/* Holds gio_xdgmime; like xdg_mime_get_mime_types_from_file_name() */
+static int
+get_mime_types_from_file_name (const char  *name,
+                               const char  *mimetypes[],
+                               int          n_mimetypes)
+{
+  NameCacheEntry *entry;
+  gint64 now;
+  int i;
+
+  if (name_cache == NULL)
+    {
+      name_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                          NULL, name_cache_entry_free);
+      xdg_mime_register_reload_callback (name_cache_reload, NULL, NULL);
+    }
+
+  now = g_get_monotonic_time ();
+  entry = g_hash_table_lookup (name_cache, name);
+
+  if (entry == NULL || now - entry->time > NAME_CACHE_MAX_AGE)
+    {
+      const char *found[10];
+      int n_found;
+
+      n_found = xdg_mime_get_mime_types_from_file_name (name, found, G_N_ELEMENTS (found));
+
+      /* The lookup may have reloaded the database, which empties the cache */
+      entry = g_hash_table_lookup (name_cache, name);
+      if (entry == NULL)
+        {
+          if (g_hash_table_size (name_cache) >= NAME_CACHE_SIZE)
+            {
+              NameCacheEntry *oldest = g_queue_peek_tail (&name_cache_lru);
+              g_hash_table_remove (name_cache, oldest->name);
+            }
+
+          entry = g_slice_new (NameCacheEntry);
+          entry->name = g_strdup (name);
+          entry->link.data = entry;
+          entry->link.prev = entry->link.next = NULL;
+          g_hash_table_insert (name_cache, entry->name, entry);
+        }
+      else
+        g_queue_unlink (&name_cache_lru, &entry->link);
+
+      entry->time = now;
+      entry->n_mimetypes = n_found;
+      for (i = 0; i < n_found; i++)
+        entry->mimetypes[i] = g_intern_string (found[i]);
+
+      g_queue_push_head_link (&name_cache_lru, &entry->link);
+    }
+  else
+    {
+      g_queue_unlink (&name_cache_lru, &entry->link);
+      g_queue_push_head_link (&name_cache_lru, &entry->link);
+    }
+
+  n_mimetypes = MIN (n_mimetypes, entry->n_mimetypes);
+  for (i = 0; i < n_mimetypes; i++)
+    mimetypes[i] = entry->mimetypes[i];
+
+  return n_mimetypes;
+}
+
 /**
  * g_content_type_guess:
  * @filename: (nullable): a string, or %NULL
@@ -668,7 +775,7 @@ g_content_type_guess (const gchar  *filename,
       else
         {
           basename = g_path_get_basename (filename);
-          n_name_mimetypes = xdg_mime_get_mime_types_from_file_name (basename, name_mimetypes, 10);
+          n_name_mimetypes = get_mime_types_from_file_name (basename, name_mimetypes, 10);
           g_free (basename);
         }
     }
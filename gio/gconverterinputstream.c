@@ -43,7 +43,10 @@
  * #GPollableInputStream.
  **/
 
-#define INITIAL_BUFFER_SIZE 4096
+/* Large enough that converters like zlib see big runs of input per
+ * call, which matters more for their throughput than the memory does
+ */
+#define INITIAL_BUFFER_SIZE (64 * 1024)
 
 typedef struct {
   char *data;
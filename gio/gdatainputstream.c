@@ -621,6 +621,13 @@ g_data_input_stream_read_uint64 (GDataInputStream  *stream,
   return 0;
 }
 
+/* Looks for the first newline at or after *checked_out in the buffer.
+ *
+ * The bytes before *checked_out are known not to contain a newline, so
+ * on subsequent calls after a fill only the new data gets scanned.  The
+ * actual searching is done with memchr(), which is vectorised in any
+ * libc worth its salt; this matters when parsing large streams.
+ */
 static gssize
 scan_for_newline (GDataInputStream *stream,
 		  gsize            *checked_out,
@@ -629,96 +636,148 @@ scan_for_newline (GDataInputStream *stream,
 {
   GBufferedInputStream *bstream;
   GDataInputStreamPrivate *priv;
-  const char *buffer;
-  gsize start, end, peeked;
-  int i;
-  gssize found_pos;
-  int newline_len;
-  gsize available, checked;
+  const char *buffer, *p, *end, *lf, *cr;
+  gsize start, available;
   gboolean last_saw_cr;
 
   priv = stream->priv;
   
   bstream = G_BUFFERED_INPUT_STREAM (stream);
 
-  checked = *checked_out;
+  start = *checked_out;
   last_saw_cr = *last_saw_cr_out;
-  found_pos = -1;
-  newline_len = 0;
   
-  start = checked;
-  buffer = (const char*)g_buffered_input_stream_peek_buffer (bstream, &available) + start;
-  end = available;
-  peeked = end - start;
+  buffer = (const char*)g_buffered_input_stream_peek_buffer (bstream, &available);
+  p = buffer + start;
+  end = buffer + available;
 
-  for (i = 0; checked < available && i < peeked; i++)
+  if (p >= end)
+    return -1;
+
+  switch (priv->newline_type)
     {
-      switch (priv->newline_type)
-	{
-	case G_DATA_STREAM_NEWLINE_TYPE_LF:
-	  if (buffer[i] == 10)
-	    {
-	      found_pos = start + i;
-	      newline_len = 1;
-	    }
-	  break;
-	case G_DATA_STREAM_NEWLINE_TYPE_CR:
-	  if (buffer[i] == 13)
-	    {
-	      found_pos = start + i;
-	      newline_len = 1;
-	    }
-	  break;
-	case G_DATA_STREAM_NEWLINE_TYPE_CR_LF:
-	  if (last_saw_cr && buffer[i] == 10)
-	    {
-	      found_pos = start + i - 1;
-	      newline_len = 2;
-	    }
-	  break;
-	default:
-	case G_DATA_STREAM_NEWLINE_TYPE_ANY:
-	  if (buffer[i] == 10) /* LF */
-	    {
-	      if (last_saw_cr)
-		{
-		  /* CR LF */
-		  found_pos = start + i - 1;
-		  newline_len = 2;
-		}
-	      else
-		{
-		  /* LF */
-		  found_pos = start + i;
-		  newline_len = 1;
-		}
-	    }
-	  else if (last_saw_cr)
-	    {
-	      /* Last was cr, this is not LF, end is CR */
-	      found_pos = start + i - 1;
-	      newline_len = 1;
-	    }
-	  /* Don't check for CR here, instead look at last_saw_cr on next byte */
-	  break;
-	}
-	
-      last_saw_cr = (buffer[i] == 13);
+    case G_DATA_STREAM_NEWLINE_TYPE_LF:
+      lf = memchr (p, 10, end - p);
+      if (lf)
+        {
+          *newline_len_out = 1;
+          return lf - buffer;
+        }
+      break;
+
+    case G_DATA_STREAM_NEWLINE_TYPE_CR:
+      cr = memchr (p, 13, end - p);
+      if (cr)
+        {
+          *newline_len_out = 1;
+          return cr - buffer;
+        }
+      break;
+
+    case G_DATA_STREAM_NEWLINE_TYPE_CR_LF:
+      if (last_saw_cr && *p == 10)
+        {
+          *newline_len_out = 2;
+          return start - 1;
+        }
+
+      while ((lf = memchr (p, 10, end - p)) != NULL)
+        {
+          if (lf > buffer + start && lf[-1] == 13)
+            {
+              *newline_len_out = 2;
+              return lf - 1 - buffer;
+            }
+          p = lf + 1;
+        }
+      break;
+
+    default:
+    case G_DATA_STREAM_NEWLINE_TYPE_ANY:
+      if (last_saw_cr)
+        {
+          /* A CR at the end of the previous scan: CR LF or just CR */
+          *newline_len_out = (*p == 10) ? 2 : 1;
+          return start - 1;
+        }
+
+      lf = memchr (p, 10, end - p);
+      cr = memchr (p, 13, (lf ? lf : end) - p);
+
+      if (cr)
+        {
+          /* We only know what kind of newline this is once we see the
+           * next byte, so if it's not there yet wait for the next fill.
+           */
+          if (cr + 1 < end)
+            {
+              *newline_len_out = (cr[1] == 10) ? 2 : 1;
+              return cr - buffer;
+            }
+        }
+      else if (lf)
+        {
+          *newline_len_out = 1;
+          return lf - buffer;
+        }
+      break;
+    }
 
-      if (found_pos != -1)
+  *checked_out = available;
+  *last_saw_cr_out = (end[-1] == 13);
+  return -1;
+}
+
+/* Fills the buffer until it contains a complete line, returning its
+ * length in @found_pos and the length of the newline that terminated
+ * it in @newline_len.  Returns %FALSE on error or if the stream ended
+ * without any more data.
+ */
+static gboolean
+fill_line (GDataInputStream  *stream,
+           gsize             *found_pos,
+           int               *newline_len,
+           GCancellable      *cancellable,
+           GError           **error)
+{
+  GBufferedInputStream *bstream;
+  gsize checked;
+  gboolean last_saw_cr;
+  gssize pos;
+  gssize res;
+
+  bstream = G_BUFFERED_INPUT_STREAM (stream);
+
+  *newline_len = 0;
+  checked = 0;
+  last_saw_cr = FALSE;
+
+  while ((pos = scan_for_newline (stream, &checked, &last_saw_cr, newline_len)) == -1)
+    {
+      if (g_buffered_input_stream_get_available (bstream) ==
+	  g_buffered_input_stream_get_buffer_size (bstream))
+	g_buffered_input_stream_set_buffer_size (bstream,
+						 2 * g_buffered_input_stream_get_buffer_size (bstream));
+
+      res = g_buffered_input_stream_fill (bstream, -1, cancellable, error);
+      if (res < 0)
+	return FALSE;
+      if (res == 0)
 	{
-	  *newline_len_out = newline_len;
-	  return found_pos;
+	  /* End of stream */
+	  if (g_buffered_input_stream_get_available (bstream) == 0)
+	    return FALSE;
+
+	  pos = g_buffered_input_stream_get_available (bstream);
+	  *newline_len = 0;
+	  break;
 	}
     }
 
-  checked = end;
+  *found_pos = pos;
 
-  *checked_out = checked;
-  *last_saw_cr_out = last_saw_cr;
-  return -1;
+  return TRUE;
 }
-		  
 
 /**
  * g_data_input_stream_read_line:
@@ -748,48 +807,18 @@ g_data_input_stream_read_line (GDataInputStream  *stream,
 			       GCancellable      *cancellable,
 			       GError           **error)
 {
-  GBufferedInputStream *bstream;
-  gsize checked;
-  gboolean last_saw_cr;
-  gssize found_pos;
+  gsize found_pos;
   gssize res;
   int newline_len;
   char *line;
   
   g_return_val_if_fail (G_IS_DATA_INPUT_STREAM (stream), NULL);  
 
-  bstream = G_BUFFERED_INPUT_STREAM (stream);
-
-  newline_len = 0;
-  checked = 0;
-  last_saw_cr = FALSE;
-
-  while ((found_pos = scan_for_newline (stream, &checked, &last_saw_cr, &newline_len)) == -1)
+  if (!fill_line (stream, &found_pos, &newline_len, cancellable, error))
     {
-      if (g_buffered_input_stream_get_available (bstream) ==
-	  g_buffered_input_stream_get_buffer_size (bstream))
-	g_buffered_input_stream_set_buffer_size (bstream,
-						 2 * g_buffered_input_stream_get_buffer_size (bstream));
-
-      res = g_buffered_input_stream_fill (bstream, -1, cancellable, error);
-      if (res < 0)
-	return NULL;
-      if (res == 0)
-	{
-	  /* End of stream */
-	  if (g_buffered_input_stream_get_available (bstream) == 0)
-	    {
-	      if (length)
-		*length = 0;
-	      return NULL;
-	    }
-	  else
-	    {
-	      found_pos = checked;
-	      newline_len = 0;
-	      break;
-	    }
-	}
+      if (length)
+        *length = 0;
+      return NULL;
     }
 
   line = g_malloc (found_pos + newline_len + 1);
@@ -806,6 +835,66 @@ g_data_input_stream_read_line (GDataInputStream  *stream,
   return line;
 }
 
+/**
+ * g_data_input_stream_read_line_borrowed:
+ * @stream: a given #GDataInputStream.
+ * @length: (out): a #gsize to get the length of the line read in.
+ * @cancellable: (nullable): optional #GCancellable object, %NULL to ignore.
+ * @error: #GError for error reporting.
+ *
+ * Reads a line from the data input stream, like
+ * g_data_input_stream_read_line(), but without copying it: the
+ * returned pointer points directly into the buffer of @stream.
+ *
+ * The line is not nul-terminated; use @length to find out where it
+ * ends.  It stays valid only until the next operation on @stream (or
+ * on its base stream), so this is meant for parsers that process each
+ * line right away, where it avoids an allocation for every line.
+ *
+ * Returns: (nullable) (transfer none) (array length=length) (element-type guint8):
+ *  the line that was read in (without the newlines).  On an error, it
+ *  will return %NULL and @error will be set.  If there's no content to
+ *  read, it will still return %NULL, but @error won't be set.
+ *
+ * Since: 2.54
+ **/
+const char *
+g_data_input_stream_read_line_borrowed (GDataInputStream  *stream,
+                                        gsize             *length,
+                                        GCancellable      *cancellable,
+                                        GError           **error)
+{
+  GBufferedInputStream *bstream;
+  const char *line;
+  gsize found_pos;
+  gsize available;
+  gssize res;
+  int newline_len;
+
+  g_return_val_if_fail (G_IS_DATA_INPUT_STREAM (stream), NULL);
+  g_return_val_if_fail (length != NULL, NULL);
+
+  bstream = G_BUFFERED_INPUT_STREAM (stream);
+
+  if (!fill_line (stream, &found_pos, &newline_len, cancellable, error))
+    {
+      *length = 0;
+      return NULL;
+    }
+
+  line = g_buffered_input_stream_peek_buffer (bstream, &available);
+
+  /* The line is entirely in the buffer, so this only advances the
+   * read position and leaves the data in place until the next fill.
+   */
+  res = g_input_stream_skip (G_INPUT_STREAM (stream), found_pos + newline_len, NULL, NULL);
+  g_warn_if_fail (res == found_pos + newline_len);
+
+  *length = found_pos;
+
+  return line;
+}
+
 /**
  * g_data_input_stream_read_line_utf8:
  * @stream: a given #GDataInputStream.
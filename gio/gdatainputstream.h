@@ -114,6 +114,11 @@ char *                 g_data_input_stream_read_line            (GDataInputStrea
                                                                  gsize                   *length,
                                                                  GCancellable            *cancellable,
                                                                  GError                 **error);
+GLIB_AVAILABLE_IN_2_54
+const char *           g_data_input_stream_read_line_borrowed   (GDataInputStream        *stream,
+                                                                 gsize                   *length,
+                                                                 GCancellable            *cancellable,
+                                                                 GError                 **error);
 GLIB_AVAILABLE_IN_2_30
 char *                 g_data_input_stream_read_line_utf8       (GDataInputStream        *stream,
 								 gsize                   *length,
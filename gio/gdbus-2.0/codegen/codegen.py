@@ -29,10 +29,11 @@ from . import dbustypes
 
 class CodeGenerator:
     def __init__(self, ifaces, namespace, interface_prefix, generate_objmanager,
-                 generate_autocleanup, docbook_gen, h, c, header_name):
+                 generate_autocleanup, generate_fast_marshalling, docbook_gen, h, c, header_name):
         self.docbook_gen = docbook_gen
         self.generate_objmanager = generate_objmanager
         self.generate_autocleanup = generate_autocleanup
+        self.generate_fast_marshalling = generate_fast_marshalling
         self.ifaces = ifaces
         self.h = h
         self.c = c
@@ -54,6 +55,27 @@ class CodeGenerator:
 
     # ----------------------------------------------------------------------------------------------------
 
+    # With --c-generate-fast-marshalling, argument tuples are built from
+    # the typed g_variant_new_*() constructors instead of having
+    # g_variant_new() parse a format string at run time.  This declares
+    # and fills the _children array that fast_tuple() refers to, so it
+    # must be written after the other declarations of the function.
+    def write_fast_tuple_children(self, args, prefix):
+        if len(args) == 0:
+            return
+        self.c.write('  GVariant *_children[%d];\n'%(len(args)))
+        n = 0
+        for a in args:
+            self.c.write('  _children[%d] = %s;\n'%(n, a.gvariant_new%(prefix + a.name)))
+            n += 1
+
+    def fast_tuple(self, args):
+        if len(args) == 0:
+            return 'g_variant_new_tuple (NULL, 0)'
+        return 'g_variant_new_tuple (_children, %d)'%(len(args))
+
+    # ----------------------------------------------------------------------------------------------------
+
     def generate_intro(self):
         self.c.write('/*\n'
                      ' * Generated by gdbus-codegen %s. DO NOT EDIT.\n'
@@ -1368,19 +1390,25 @@ class CodeGenerator:
                          '    GAsyncReadyCallback callback,\n'
                          '    gpointer user_data)\n'
                          '{\n')
+            if self.generate_fast_marshalling:
+                self.write_fast_tuple_children(m.in_args, 'arg_')
             if unix_fd:
                 self.c.write('  g_dbus_proxy_call_with_unix_fd_list (G_DBUS_PROXY (proxy),\n')
             else:
                 self.c.write('  g_dbus_proxy_call (G_DBUS_PROXY (proxy),\n')
-            self.c.write('    "%s",\n'
-                         '    g_variant_new ("('%(m.name))
-            for a in m.in_args:
-                self.c.write('%s'%(a.format_in))
-            self.c.write(')"')
-            for a in m.in_args:
-                self.c.write(',\n                   arg_%s'%(a.name))
-            self.c.write('),\n'
-                         '    G_DBUS_CALL_FLAGS_NONE,\n'
+            if self.generate_fast_marshalling:
+                self.c.write('    "%s",\n'
+                             '    %s,\n'%(m.name, self.fast_tuple(m.in_args)))
+            else:
+                self.c.write('    "%s",\n'
+                             '    g_variant_new ("('%(m.name))
+                for a in m.in_args:
+                    self.c.write('%s'%(a.format_in))
+                self.c.write(')"')
+                for a in m.in_args:
+                    self.c.write(',\n                   arg_%s'%(a.name))
+                self.c.write('),\n')
+            self.c.write('    G_DBUS_CALL_FLAGS_NONE,\n'
                          '    -1,\n')
             if unix_fd:
                 self.c.write('    fd_list,\n')
@@ -1480,19 +1508,25 @@ class CodeGenerator:
                          '    GError **error)\n'
                          '{\n'
                          '  GVariant *_ret;\n')
+            if self.generate_fast_marshalling:
+                self.write_fast_tuple_children(m.in_args, 'arg_')
             if unix_fd:
                 self.c.write('  _ret = g_dbus_proxy_call_with_unix_fd_list_sync (G_DBUS_PROXY (proxy),\n')
             else:
                 self.c.write('  _ret = g_dbus_proxy_call_sync (G_DBUS_PROXY (proxy),\n')
-            self.c.write('    "%s",\n'
-                         '    g_variant_new ("('%(m.name))
-            for a in m.in_args:
-                self.c.write('%s'%(a.format_in))
-            self.c.write(')"')
-            for a in m.in_args:
-                self.c.write(',\n                   arg_%s'%(a.name))
-            self.c.write('),\n'
-                         '    G_DBUS_CALL_FLAGS_NONE,\n'
+            if self.generate_fast_marshalling:
+                self.c.write('    "%s",\n'
+                             '    %s,\n'%(m.name, self.fast_tuple(m.in_args)))
+            else:
+                self.c.write('    "%s",\n'
+                             '    g_variant_new ("('%(m.name))
+                for a in m.in_args:
+                    self.c.write('%s'%(a.format_in))
+                self.c.write(')"')
+                for a in m.in_args:
+                    self.c.write(',\n                   arg_%s'%(a.name))
+                self.c.write('),\n')
+            self.c.write('    G_DBUS_CALL_FLAGS_NONE,\n'
                          '    -1,\n')
             if unix_fd:
                 self.c.write('    fd_list,\n'
@@ -1549,21 +1583,26 @@ class CodeGenerator:
             self.c.write(')\n'
                          '{\n')
 
+            if self.generate_fast_marshalling:
+                self.write_fast_tuple_children(m.out_args, '')
             if unix_fd:
-                self.c.write('  g_dbus_method_invocation_return_value_with_unix_fd_list (invocation,\n'
-                             '    g_variant_new ("(')
+                self.c.write('  g_dbus_method_invocation_return_value_with_unix_fd_list (invocation,\n')
             else:
-                self.c.write('  g_dbus_method_invocation_return_value (invocation,\n'
-                             '    g_variant_new ("(')
-            for a in m.out_args:
-                self.c.write('%s'%(a.format_in))
-            self.c.write(')"')
-            for a in m.out_args:
-                self.c.write(',\n                   %s'%(a.name))
+                self.c.write('  g_dbus_method_invocation_return_value (invocation,\n')
+            if self.generate_fast_marshalling:
+                self.c.write('    %s'%(self.fast_tuple(m.out_args)))
+            else:
+                self.c.write('    g_variant_new ("(')
+                for a in m.out_args:
+                    self.c.write('%s'%(a.format_in))
+                self.c.write(')"')
+                for a in m.out_args:
+                    self.c.write(',\n                   %s'%(a.name))
+                self.c.write(')')
             if unix_fd:
-                self.c.write('),\n    fd_list);\n')
+                self.c.write(',\n    fd_list);\n')
             else:
-                self.c.write('));\n')
+                self.c.write(');\n')
             self.c.write('}\n'
                          '\n')
 
@@ -2082,6 +2121,37 @@ class CodeGenerator:
 
     # ---------------------------------------------------------------------------------------------------
 
+    # With --c-generate-fast-marshalling, skeletons turn their stored
+    # property values into GVariants with a switch over the property
+    # id, rather than looking up the GParamSpec and copying the value
+    # out through g_object_get_property() for every Get(), GetAll() and
+    # PropertiesChanged.  Numbers and booleans use the typed
+    # constructors; other types keep the conversion rules of
+    # g_dbus_gvalue_to_gvariant(), e.g. for %NULL strings.
+    def generate_skeleton_fast_property_to_variant(self, i):
+        self.c.write('/* must hold skeleton->priv->lock */\n'
+                     'static GVariant *\n'
+                     '_%s_skeleton_property_to_variant (%sSkeleton *skeleton, guint prop_id)\n'
+                     '{\n'
+                     '  const GValue *value = &skeleton->priv->properties[prop_id - 1];\n'
+                     '  switch (prop_id)\n'
+                     '    {\n'
+                     %(i.name_lower, i.camel_name))
+        n = 1
+        for p in i.properties:
+            self.c.write('    case %d:\n'%(n))
+            if p.arg.gtype == 'G_TYPE_STRING' or p.arg.gtype == 'G_TYPE_STRV' or p.arg.gtype == 'G_TYPE_VARIANT':
+                self.c.write('      return g_dbus_gvalue_to_gvariant (value, G_VARIANT_TYPE ("%s"));\n'%(p.arg.signature))
+            else:
+                self.c.write('      return g_variant_ref_sink (%s);\n'%(p.arg.gvariant_new%('%s (value)'%(p.arg.gvalue_get))))
+            n += 1
+        self.c.write('    default:\n'
+                     '      g_assert_not_reached ();\n'
+                     '      return NULL;\n'
+                     '    }\n'
+                     '}\n'
+                     '\n')
+
     def generate_skeleton(self, i):
         # class boilerplate
         self.c.write('/* ------------------------------------------------------------------------ */\n'
@@ -2188,41 +2258,70 @@ class CodeGenerator:
         self.c.write('}\n'
                      '\n')
 
-        self.c.write('static GVariant *\n'
-                     '_%s_skeleton_handle_get_property (\n'
-                     '  GDBusConnection *connection G_GNUC_UNUSED,\n'
-                     '  const gchar *sender G_GNUC_UNUSED,\n'
-                     '  const gchar *object_path G_GNUC_UNUSED,\n'
-                     '  const gchar *interface_name G_GNUC_UNUSED,\n'
-                     '  const gchar *property_name,\n'
-                     '  GError **error,\n'
-                     '  gpointer user_data)\n'
-                     '{\n'
-                     '  %sSkeleton *skeleton = %s%s_SKELETON (user_data);\n'
-                     '  GValue value = G_VALUE_INIT;\n'
-                     '  GParamSpec *pspec;\n'
-                     '  _ExtendedGDBusPropertyInfo *info;\n'
-                     '  GVariant *ret;\n'
-                     %(i.name_lower, i.camel_name, i.ns_upper, i.name_upper))
-        self.c.write('  ret = NULL;\n'
-                     '  info = (_ExtendedGDBusPropertyInfo *) g_dbus_interface_info_lookup_property ((GDBusInterfaceInfo *) &_%s_interface_info.parent_struct, property_name);\n'
-                     '  g_assert (info != NULL);\n'
-                     '  pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (skeleton), info->hyphen_name);\n'
-                     '  if (pspec == NULL)\n'
-                     '    {\n'
-                     '      g_set_error (error, G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS, "No property with name %%s", property_name);\n'
-                     '    }\n'
-                     '  else\n'
-                     '    {\n'
-                     '      g_value_init (&value, pspec->value_type);\n'
-                     '      g_object_get_property (G_OBJECT (skeleton), info->hyphen_name, &value);\n'
-                     '      ret = g_dbus_gvalue_to_gvariant (&value, G_VARIANT_TYPE (info->parent_struct.signature));\n'
-                     '      g_value_unset (&value);\n'
-                     '    }\n'
-                     '  return ret;\n'
-                     '}\n'
-                     '\n'
-                     %(i.name_lower))
+        if self.generate_fast_marshalling and len(i.properties) > 0:
+            self.generate_skeleton_fast_property_to_variant(i)
+            self.c.write('static GVariant *\n'
+                         '_%s_skeleton_handle_get_property (\n'
+                         '  GDBusConnection *connection G_GNUC_UNUSED,\n'
+                         '  const gchar *sender G_GNUC_UNUSED,\n'
+                         '  const gchar *object_path G_GNUC_UNUSED,\n'
+                         '  const gchar *interface_name G_GNUC_UNUSED,\n'
+                         '  const gchar *property_name,\n'
+                         '  GError **error G_GNUC_UNUSED,\n'
+                         '  gpointer user_data)\n'
+                         '{\n'
+                         '  %sSkeleton *skeleton = %s%s_SKELETON (user_data);\n'
+                         '  _ExtendedGDBusPropertyInfo *info;\n'
+                         '  GVariant *ret;\n'
+                         '  guint n;\n'
+                         %(i.name_lower, i.camel_name, i.ns_upper, i.name_upper))
+            self.c.write('  info = (_ExtendedGDBusPropertyInfo *) g_dbus_interface_info_lookup_property ((GDBusInterfaceInfo *) &_%s_interface_info.parent_struct, property_name);\n'
+                         '  g_assert (info != NULL);\n'
+                         '  for (n = 0; _%s_property_info_pointers[n] != info; n++)\n'
+                         '    ;\n'
+                         '  g_mutex_lock (&skeleton->priv->lock);\n'
+                         '  ret = _%s_skeleton_property_to_variant (skeleton, n + 1);\n'
+                         '  g_mutex_unlock (&skeleton->priv->lock);\n'
+                         '  return ret;\n'
+                         '}\n'
+                         '\n'
+                         %(i.name_lower, i.name_lower, i.name_lower))
+        else:
+            self.c.write('static GVariant *\n'
+                         '_%s_skeleton_handle_get_property (\n'
+                         '  GDBusConnection *connection G_GNUC_UNUSED,\n'
+                         '  const gchar *sender G_GNUC_UNUSED,\n'
+                         '  const gchar *object_path G_GNUC_UNUSED,\n'
+                         '  const gchar *interface_name G_GNUC_UNUSED,\n'
+                         '  const gchar *property_name,\n'
+                         '  GError **error,\n'
+                         '  gpointer user_data)\n'
+                         '{\n'
+                         '  %sSkeleton *skeleton = %s%s_SKELETON (user_data);\n'
+                         '  GValue value = G_VALUE_INIT;\n'
+                         '  GParamSpec *pspec;\n'
+                         '  _ExtendedGDBusPropertyInfo *info;\n'
+                         '  GVariant *ret;\n'
+                         %(i.name_lower, i.camel_name, i.ns_upper, i.name_upper))
+            self.c.write('  ret = NULL;\n'
+                         '  info = (_ExtendedGDBusPropertyInfo *) g_dbus_interface_info_lookup_property ((GDBusInterfaceInfo *) &_%s_interface_info.parent_struct, property_name);\n'
+                         '  g_assert (info != NULL);\n'
+                         '  pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (skeleton), info->hyphen_name);\n'
+                         '  if (pspec == NULL)\n'
+                         '    {\n'
+                         '      g_set_error (error, G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS, "No property with name %%s", property_name);\n'
+                         '    }\n'
+                         '  else\n'
+                         '    {\n'
+                         '      g_value_init (&value, pspec->value_type);\n'
+                         '      g_object_get_property (G_OBJECT (skeleton), info->hyphen_name, &value);\n'
+                         '      ret = g_dbus_gvalue_to_gvariant (&value, G_VARIANT_TYPE (info->parent_struct.signature));\n'
+                         '      g_value_unset (&value);\n'
+                         '    }\n'
+                         '  return ret;\n'
+                         '}\n'
+                         '\n'
+                         %(i.name_lower))
 
         self.c.write('static gboolean\n'
                      '_%s_skeleton_handle_set_property (\n'
@@ -2295,32 +2394,58 @@ class CodeGenerator:
                      '{\n'
                      '  %sSkeleton *skeleton = %s%s_SKELETON (_skeleton);\n'
                      %(i.name_lower, i.camel_name, i.ns_upper, i.name_upper))
-        self.c.write('\n'
-                     '  GVariantBuilder builder;\n'
-                     '  guint n;\n'
-                     '  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));\n'
-                     '  if (_%s_interface_info.parent_struct.properties == NULL)\n'
-                     '    goto out;\n'
-                     '  for (n = 0; _%s_interface_info.parent_struct.properties[n] != NULL; n++)\n'
-                     '    {\n'
-                     '      GDBusPropertyInfo *info = _%s_interface_info.parent_struct.properties[n];\n'
-                     '      if (info->flags & G_DBUS_PROPERTY_INFO_FLAGS_READABLE)\n'
-                     '        {\n'
-                     '          GVariant *value;\n'
-                     '          value = _%s_skeleton_handle_get_property (g_dbus_interface_skeleton_get_connection (G_DBUS_INTERFACE_SKELETON (skeleton)), NULL, g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (skeleton)), "%s", info->name, NULL, skeleton);\n'
-                     '          if (value != NULL)\n'
-                     '            {\n'
-                     '              g_variant_take_ref (value);\n'
-                     '              g_variant_builder_add (&builder, "{sv}", info->name, value);\n'
-                     '              g_variant_unref (value);\n'
-                     '            }\n'
-                     '        }\n'
-                     '    }\n'
-                     'out:\n'
-                     '  return g_variant_builder_end (&builder);\n'
-                     '}\n'
-                     '\n'
-                     %(i.name_lower, i.name_lower, i.name_lower, i.name_lower, i.name))
+        if self.generate_fast_marshalling and len(i.properties) > 0:
+            self.c.write('\n'
+                         '  GVariantBuilder builder;\n'
+                         '  guint n;\n'
+                         '  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));\n'
+                         '  g_mutex_lock (&skeleton->priv->lock);\n'
+                         '  for (n = 0; n < %d; n++)\n'
+                         '    {\n'
+                         '      const GDBusPropertyInfo *info = &_%s_property_info_pointers[n]->parent_struct;\n'
+                         '      if (info->flags & G_DBUS_PROPERTY_INFO_FLAGS_READABLE)\n'
+                         '        {\n'
+                         '          GVariant *value;\n'
+                         '          value = _%s_skeleton_property_to_variant (skeleton, n + 1);\n'
+                         '          if (value != NULL)\n'
+                         '            {\n'
+                         '              g_variant_builder_add_value (&builder, g_variant_new_dict_entry (g_variant_new_string (info->name), g_variant_new_variant (value)));\n'
+                         '              g_variant_unref (value);\n'
+                         '            }\n'
+                         '        }\n'
+                         '    }\n'
+                         '  g_mutex_unlock (&skeleton->priv->lock);\n'
+                         '  return g_variant_builder_end (&builder);\n'
+                         '}\n'
+                         '\n'
+                         %(len(i.properties), i.name_lower, i.name_lower))
+        else:
+            self.c.write('\n'
+                         '  GVariantBuilder builder;\n'
+                         '  guint n;\n'
+                         '  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));\n'
+                         '  if (_%s_interface_info.parent_struct.properties == NULL)\n'
+                         '    goto out;\n'
+                         '  for (n = 0; _%s_interface_info.parent_struct.properties[n] != NULL; n++)\n'
+                         '    {\n'
+                         '      GDBusPropertyInfo *info = _%s_interface_info.parent_struct.properties[n];\n'
+                         '      if (info->flags & G_DBUS_PROPERTY_INFO_FLAGS_READABLE)\n'
+                         '        {\n'
+                         '          GVariant *value;\n'
+                         '          value = _%s_skeleton_handle_get_property (g_dbus_interface_skeleton_get_connection (G_DBUS_INTERFACE_SKELETON (skeleton)), NULL, g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (skeleton)), "%s", info->name, NULL, skeleton);\n'
+                         '          if (value != NULL)\n'
+                         '            {\n'
+                         '              g_variant_take_ref (value);\n'
+                         '              g_variant_builder_add (&builder, "{sv}", info->name, value);\n'
+                         '              g_variant_unref (value);\n'
+                         '            }\n'
+                         '        }\n'
+                         '    }\n'
+                         'out:\n'
+                         '  return g_variant_builder_end (&builder);\n'
+                         '}\n'
+                         '\n'
+                         %(i.name_lower, i.name_lower, i.name_lower, i.name_lower, i.name))
 
         if len(i.properties) > 0:
             self.c.write('static gboolean _%s_emit_changed (gpointer user_data);\n'
@@ -2336,12 +2461,16 @@ class CodeGenerator:
                          '  gboolean emit_changed = FALSE;\n'
                          '\n'
                          '  g_mutex_lock (&skeleton->priv->lock);\n'
+                         '#if GLIB_VERSION_MAX_ALLOWED >= GLIB_VERSION_2_54\n'
+                         '  emit_changed = skeleton->priv->changed_properties != NULL;\n'
+                         '#else\n'
                          '  if (skeleton->priv->changed_properties_idle_source != NULL)\n'
                          '    {\n'
                          '      g_source_destroy (skeleton->priv->changed_properties_idle_source);\n'
                          '      skeleton->priv->changed_properties_idle_source = NULL;\n'
                          '      emit_changed = TRUE;\n'
                          '    }\n'
+                         '#endif\n'
                          '  g_mutex_unlock (&skeleton->priv->lock);\n'
                          '\n'
                          '  if (emit_changed)\n'
@@ -2361,16 +2490,22 @@ class CodeGenerator:
                          '  %sSkeleton *skeleton = %s%s_SKELETON (object);\n\n'
                          '  GList      *connections, *l;\n'
                          '  GVariant   *signal_variant;\n'
-                         '  connections = g_dbus_interface_skeleton_get_connections (G_DBUS_INTERFACE_SKELETON (skeleton));\n'
                          %(i.camel_name, i.ns_upper, i.name_upper))
-            self.c.write('\n'
-                         '  signal_variant = g_variant_ref_sink (g_variant_new ("(')
-            for a in s.args:
-                self.c.write('%s'%(a.format_in))
-            self.c.write(')"')
-            for a in s.args:
-                self.c.write(',\n                   arg_%s'%(a.name))
-            self.c.write('));\n')
+            if self.generate_fast_marshalling:
+                self.write_fast_tuple_children(s.args, 'arg_')
+            self.c.write('  connections = g_dbus_interface_skeleton_get_connections (G_DBUS_INTERFACE_SKELETON (skeleton));\n')
+            if self.generate_fast_marshalling:
+                self.c.write('\n'
+                             '  signal_variant = g_variant_ref_sink (%s);\n'%(self.fast_tuple(s.args)))
+            else:
+                self.c.write('\n'
+                             '  signal_variant = g_variant_ref_sink (g_variant_new ("(')
+                for a in s.args:
+                    self.c.write('%s'%(a.format_in))
+                self.c.write(')"')
+                for a in s.args:
+                    self.c.write(',\n                   arg_%s'%(a.name))
+                self.c.write('));\n')
 
             self.c.write('  for (l = connections; l != NULL; l = l->next)\n'
                          '    {\n'
@@ -2450,6 +2585,10 @@ class CodeGenerator:
                          '{\n'
                          '  %sSkeleton *skeleton = %s%s_SKELETON (user_data);\n'
                          %(i.name_lower, i.camel_name, i.ns_upper, i.name_upper))
+            if self.generate_fast_marshalling:
+                to_variant = '_%s_skeleton_property_to_variant (skeleton, cp->prop_id)'%(i.name_lower)
+            else:
+                to_variant = 'g_dbus_gvalue_to_gvariant (cur_value, G_VARIANT_TYPE (cp->info->parent_struct.signature))'
             self.c.write('  GList *l;\n'
                          '  GVariantBuilder builder;\n'
                          '  GVariantBuilder invalidated_builder;\n'
@@ -2467,7 +2606,7 @@ class CodeGenerator:
                          '      cur_value = &skeleton->priv->properties[cp->prop_id - 1];\n'
                          '      if (!_g_value_equal (cur_value, &cp->orig_value))\n'
                          '        {\n'
-                         '          variant = g_dbus_gvalue_to_gvariant (cur_value, G_VARIANT_TYPE (cp->info->parent_struct.signature));\n'
+                         '          variant = %s;\n'
                          '          g_variant_builder_add (&builder, "{sv}", cp->info->parent_struct.name, variant);\n'
                          '          g_variant_unref (variant);\n'
                          '          num_changes++;\n'
@@ -2500,7 +2639,7 @@ class CodeGenerator:
                          '      g_variant_builder_clear (&builder);\n'
                          '      g_variant_builder_clear (&invalidated_builder);\n'
                          '    }\n'
-                         %(i.name))
+                         %(to_variant, i.name))
             self.c.write('  g_list_free_full (skeleton->priv->changed_properties, (GDestroyNotify) _changed_property_free);\n')
             self.c.write('  skeleton->priv->changed_properties = NULL;\n')
             self.c.write('  skeleton->priv->changed_properties_idle_source = NULL;\n')
@@ -2547,6 +2686,17 @@ class CodeGenerator:
                          '  GParamSpec *pspec G_GNUC_UNUSED)\n'
                          '{\n'
                          '  %sSkeleton *skeleton = %s%s_SKELETON (object);\n'
+                         '#if GLIB_VERSION_MAX_ALLOWED >= GLIB_VERSION_2_54\n'
+                         '  gboolean schedule_flush;\n'
+                         '  /* Let GDBusInterfaceSkeleton coalesce the emission with those of other\n'
+                         '   * objects, subject to g_dbus_interface_skeleton_set_flush_interval()\n'
+                         '   */\n'
+                         '  g_mutex_lock (&skeleton->priv->lock);\n'
+                         '  schedule_flush = skeleton->priv->changed_properties != NULL;\n'
+                         '  g_mutex_unlock (&skeleton->priv->lock);\n'
+                         '  if (schedule_flush)\n'
+                         '    g_dbus_interface_skeleton_schedule_flush (G_DBUS_INTERFACE_SKELETON (skeleton));\n'
+                         '#else\n'
                          '  g_mutex_lock (&skeleton->priv->lock);\n'
                          '  if (skeleton->priv->changed_properties != NULL &&\n'
                          '      skeleton->priv->changed_properties_idle_source == NULL)\n'
@@ -2559,6 +2709,7 @@ class CodeGenerator:
                          '      g_source_unref (skeleton->priv->changed_properties_idle_source);\n'
                          '    }\n'
                          '  g_mutex_unlock (&skeleton->priv->lock);\n'
+                         '#endif\n'
                          '}\n'
                          '\n'
                          %(i.name_lower, i.camel_name, i.ns_upper, i.name_upper, i.name_lower, i.name_lower))
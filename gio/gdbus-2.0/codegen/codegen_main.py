@@ -159,6 +159,8 @@ def codegen_main():
                           help='Generate C code in OUTFILES.[ch]')
     arg_parser.add_option('', '--c-generate-autocleanup', type='choice', choices=['none', 'objects', 'all'], default='objects',
                              help='Generate autocleanup support')
+    arg_parser.add_option('', '--c-generate-fast-marshalling', action='store_true',
+                            help='Build GVariants with typed constructors instead of format strings when generating C code')
     arg_parser.add_option('', '--generate-docbook', metavar='OUTFILES',
                           help='Generate Docbook in OUTFILES-org.Project.IFace.xml')
     arg_parser.add_option('', '--annotate', nargs=3, action='append', metavar='WHAT KEY VALUE',
@@ -197,6 +199,7 @@ def codegen_main():
                                     opts.interface_prefix,
                                     opts.c_generate_object_manager,
                                     opts.c_generate_autocleanup,
+                                    opts.c_generate_fast_marshalling,
                                     docbook_gen,
                                     h, c,
                                     header_name)
@@ -54,6 +54,8 @@ class Arg:
         self.format_out = '@' + self.signature
         self.gvariant_get = 'XXX'
         self.gvalue_get = 'g_value_get_variant'
+        # typed constructor for --c-generate-fast-marshalling, %s is the C value
+        self.gvariant_new = '%s'
         if not utils.lookup_annotation(self.annotations, 'org.gtk.GDBus.C.ForceGVariant'):
             if self.signature == 'b':
                 self.ctype_in_g  = 'gboolean '
@@ -65,6 +67,7 @@ class Arg:
                 self.format_out = 'b'
                 self.gvariant_get = 'g_variant_get_boolean'
                 self.gvalue_get = 'g_value_get_boolean'
+                self.gvariant_new = 'g_variant_new_boolean (%s)'
             elif self.signature == 'y':
                 self.ctype_in_g  = 'guchar '
                 self.ctype_in  = 'guchar '
@@ -75,6 +78,7 @@ class Arg:
                 self.format_out = 'y'
                 self.gvariant_get = 'g_variant_get_byte'
                 self.gvalue_get = 'g_value_get_uchar'
+                self.gvariant_new = 'g_variant_new_byte (%s)'
             elif self.signature == 'n':
                 self.ctype_in_g  = 'gint '
                 self.ctype_in  = 'gint16 '
@@ -85,6 +89,7 @@ class Arg:
                 self.format_out = 'n'
                 self.gvariant_get = 'g_variant_get_int16'
                 self.gvalue_get = 'g_value_get_int'
+                self.gvariant_new = 'g_variant_new_int16 (%s)'
             elif self.signature == 'q':
                 self.ctype_in_g  = 'guint '
                 self.ctype_in  = 'guint16 '
@@ -95,6 +100,7 @@ class Arg:
                 self.format_out = 'q'
                 self.gvariant_get = 'g_variant_get_uint16'
                 self.gvalue_get = 'g_value_get_uint'
+                self.gvariant_new = 'g_variant_new_uint16 (%s)'
             elif self.signature == 'i':
                 self.ctype_in_g  = 'gint '
                 self.ctype_in  = 'gint '
@@ -105,6 +111,7 @@ class Arg:
                 self.format_out = 'i'
                 self.gvariant_get = 'g_variant_get_int32'
                 self.gvalue_get = 'g_value_get_int'
+                self.gvariant_new = 'g_variant_new_int32 (%s)'
             elif self.signature == 'u':
                 self.ctype_in_g  = 'guint '
                 self.ctype_in  = 'guint '
@@ -115,6 +122,7 @@ class Arg:
                 self.format_out = 'u'
                 self.gvariant_get = 'g_variant_get_uint32'
                 self.gvalue_get = 'g_value_get_uint'
+                self.gvariant_new = 'g_variant_new_uint32 (%s)'
             elif self.signature == 'x':
                 self.ctype_in_g  = 'gint64 '
                 self.ctype_in  = 'gint64 '
@@ -125,6 +133,7 @@ class Arg:
                 self.format_out = 'x'
                 self.gvariant_get = 'g_variant_get_int64'
                 self.gvalue_get = 'g_value_get_int64'
+                self.gvariant_new = 'g_variant_new_int64 (%s)'
             elif self.signature == 't':
                 self.ctype_in_g  = 'guint64 '
                 self.ctype_in  = 'guint64 '
@@ -135,6 +144,7 @@ class Arg:
                 self.format_out = 't'
                 self.gvariant_get = 'g_variant_get_uint64'
                 self.gvalue_get = 'g_value_get_uint64'
+                self.gvariant_new = 'g_variant_new_uint64 (%s)'
             elif self.signature == 'd':
                 self.ctype_in_g  = 'gdouble '
                 self.ctype_in  = 'gdouble '
@@ -145,6 +155,7 @@ class Arg:
                 self.format_out = 'd'
                 self.gvariant_get = 'g_variant_get_double'
                 self.gvalue_get = 'g_value_get_double'
+                self.gvariant_new = 'g_variant_new_double (%s)'
             elif self.signature == 's':
                 self.ctype_in_g  = 'const gchar *'
                 self.ctype_in  = 'const gchar *'
@@ -156,6 +167,7 @@ class Arg:
                 self.format_out = 's'
                 self.gvariant_get = 'g_variant_get_string'
                 self.gvalue_get = 'g_value_get_string'
+                self.gvariant_new = 'g_variant_new_string (%s)'
             elif self.signature == 'o':
                 self.ctype_in_g  = 'const gchar *'
                 self.ctype_in  = 'const gchar *'
@@ -167,6 +179,7 @@ class Arg:
                 self.format_out = 'o'
                 self.gvariant_get = 'g_variant_get_string'
                 self.gvalue_get = 'g_value_get_string'
+                self.gvariant_new = 'g_variant_new_object_path (%s)'
             elif self.signature == 'g':
                 self.ctype_in_g  = 'const gchar *'
                 self.ctype_in  = 'const gchar *'
@@ -178,6 +191,7 @@ class Arg:
                 self.format_out = 'g'
                 self.gvariant_get = 'g_variant_get_string'
                 self.gvalue_get = 'g_value_get_string'
+                self.gvariant_new = 'g_variant_new_signature (%s)'
             elif self.signature == 'ay':
                 self.ctype_in_g  = 'const gchar *'
                 self.ctype_in  = 'const gchar *'
@@ -189,6 +203,7 @@ class Arg:
                 self.format_out = '^ay'
                 self.gvariant_get = 'g_variant_get_bytestring'
                 self.gvalue_get = 'g_value_get_string'
+                self.gvariant_new = 'g_variant_new_bytestring (%s)'
             elif self.signature == 'as':
                 self.ctype_in_g  = 'const gchar *const *'
                 self.ctype_in  = 'const gchar *const *'
@@ -200,6 +215,7 @@ class Arg:
                 self.format_out = '^as'
                 self.gvariant_get = 'g_variant_get_strv'
                 self.gvalue_get = 'g_value_get_boxed'
+                self.gvariant_new = 'g_variant_new_strv (%s, -1)'
             elif self.signature == 'ao':
                 self.ctype_in_g  = 'const gchar *const *'
                 self.ctype_in  = 'const gchar *const *'
@@ -211,6 +227,7 @@ class Arg:
                 self.format_out = '^ao'
                 self.gvariant_get = 'g_variant_get_objv'
                 self.gvalue_get = 'g_value_get_boxed'
+                self.gvariant_new = 'g_variant_new_objv (%s, -1)'
             elif self.signature == 'aay':
                 self.ctype_in_g  = 'const gchar *const *'
                 self.ctype_in  = 'const gchar *const *'
@@ -222,6 +239,7 @@ class Arg:
                 self.format_out = '^aay'
                 self.gvariant_get = 'g_variant_get_bytestring_array'
                 self.gvalue_get = 'g_value_get_boxed'
+                self.gvariant_new = 'g_variant_new_bytestring_array (%s, -1)'
 
 class Method:
     def __init__(self, name):
@@ -33,8 +33,9 @@
 #include "gcredentials.h"
 #include "gdbusprivate.h"
 #include "giostream.h"
-#include "gdatainputstream.h"
 #include "gdataoutputstream.h"
+#include "gsocketconnection.h"
+#include "gsocket.h"
 
 #ifdef G_OS_UNIX
 #include "gnetworking.h"
@@ -270,32 +271,6 @@ _g_dbus_auth_new (GIOStream *stream)
 }
 
 /* ---------------------------------------------------------------------------------------------------- */
-/* like g_data_input_stream_read_line() but sets error if there's no content to read */
-static gchar *
-_my_g_data_input_stream_read_line (GDataInputStream  *dis,
-                                   gsize             *out_line_length,
-                                   GCancellable      *cancellable,
-                                   GError           **error)
-{
-  gchar *ret;
-
-  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-
-  ret = g_data_input_stream_read_line (dis,
-                                       out_line_length,
-                                       cancellable,
-                                       error);
-  if (ret == NULL && error != NULL && *error == NULL)
-    {
-      g_set_error_literal (error,
-                           G_IO_ERROR,
-                           G_IO_ERROR_FAILED,
-                           _("Unexpected lack of content trying to read a line"));
-    }
-
-  return ret;
-}
-
 /* This function is to avoid situations like this
  *
  * BEGIN\r\nl\0\0\1...
@@ -363,6 +338,101 @@ _my_g_input_stream_read_line_safe (GInputStream  *i,
   return NULL;
 }
 
+/* Reads a line like _my_g_input_stream_read_line_safe() - that is,
+ * without consuming anything after the terminating \r\n - but for
+ * sockets peeks at whatever has arrived and then consumes up to the
+ * end of the line in one go, instead of doing one read per byte.
+ *
+ * This is what allows the peer to pipeline commands (and the first
+ * D-Bus message) after the line we're waiting for.
+ */
+static gchar *
+read_line (GIOStream     *stream,
+           gsize         *out_line_length,
+           GCancellable  *cancellable,
+           GError       **error)
+{
+  GSocket *socket;
+  GInputStream *input;
+  GString *str;
+  gchar buf[256];
+
+  input = g_io_stream_get_input_stream (stream);
+  if (!G_IS_SOCKET_CONNECTION (stream))
+    return _my_g_input_stream_read_line_safe (input, out_line_length, cancellable, error);
+
+  socket = g_socket_connection_get_socket (G_SOCKET_CONNECTION (stream));
+  str = g_string_new (NULL);
+  while (TRUE)
+    {
+      GInputVector vector = { buf, sizeof buf };
+      GError *local_error = NULL;
+      gint flags = G_SOCKET_MSG_PEEK;
+      gboolean found_end;
+      gssize num_peeked;
+      gsize num_to_read;
+      gssize n;
+
+      num_peeked = g_socket_receive_message (socket, NULL, &vector, 1,
+                                             NULL, NULL, &flags,
+                                             cancellable, &local_error);
+      if (num_peeked < 0)
+        {
+          if (g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+            {
+              g_error_free (local_error);
+              if (!g_socket_condition_wait (socket, G_IO_IN, cancellable, error))
+                goto fail;
+              continue;
+            }
+          g_propagate_error (error, local_error);
+          goto fail;
+        }
+      if (num_peeked == 0)
+        {
+          g_set_error_literal (error,
+                               G_IO_ERROR,
+                               G_IO_ERROR_FAILED,
+                               _("Unexpected lack of content trying to read a line"));
+          goto fail;
+        }
+
+      found_end = FALSE;
+      num_to_read = num_peeked;
+      for (n = 0; n < num_peeked; n++)
+        {
+          if (buf[n] == 0x0a &&
+              ((n > 0 && buf[n - 1] == 0x0d) ||
+               (n == 0 && str->len > 0 && str->str[str->len - 1] == 0x0d)))
+            {
+              found_end = TRUE;
+              num_to_read = n + 1;
+              break;
+            }
+        }
+
+      /* the data is already there, so this doesn't block */
+      if (!g_input_stream_read_all (input, buf, num_to_read, NULL, cancellable, error))
+        goto fail;
+      g_string_append_len (str, buf, num_to_read);
+
+      if (found_end)
+        {
+          g_string_set_size (str, str->len - 2);
+          break;
+        }
+    }
+
+  if (out_line_length != NULL)
+    *out_line_length = str->len;
+  return g_string_free (str, FALSE);
+
+ fail:
+  g_assert (error == NULL || *error != NULL);
+  g_string_free (str, TRUE);
+  return NULL;
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 static void
@@ -589,7 +659,6 @@ _g_dbus_auth_run_client (GDBusAuth     *auth,
                          GError       **error)
 {
   gchar *s;
-  GDataInputStream *dis;
   GDataOutputStream *dos;
   GCredentials *credentials;
   gchar *ret_guid;
@@ -600,6 +669,7 @@ _g_dbus_auth_run_client (GDBusAuth     *auth,
   GDBusAuthMechanism *mech;
   ClientState state;
   GDBusCapabilityFlags negotiated_capabilities;
+  gboolean sent_begin;
 
   debug_print ("CLIENT: initiating");
 
@@ -611,14 +681,11 @@ _g_dbus_auth_run_client (GDBusAuth     *auth,
   mech = NULL;
   negotiated_capabilities = 0;
   credentials = NULL;
+  sent_begin = FALSE;
 
-  dis = G_DATA_INPUT_STREAM (g_data_input_stream_new (g_io_stream_get_input_stream (auth->priv->stream)));
   dos = G_DATA_OUTPUT_STREAM (g_data_output_stream_new (g_io_stream_get_output_stream (auth->priv->stream)));
-  g_filter_input_stream_set_close_base_stream (G_FILTER_INPUT_STREAM (dis), FALSE);
   g_filter_output_stream_set_close_base_stream (G_FILTER_OUTPUT_STREAM (dos), FALSE);
 
-  g_data_input_stream_set_newline_type (dis, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
-
 #ifdef G_OS_UNIX
   if (G_IS_UNIX_CONNECTION (auth->priv->stream))
     {
@@ -652,14 +719,47 @@ _g_dbus_auth_run_client (GDBusAuth     *auth,
       debug_print ("CLIENT: didn't send any credentials");
     }
 
-  /* TODO: to reduce roundtrips, try to pick an auth mechanism to start with */
+  /* If we sent credentials, EXTERNAL is what almost every server will
+   * accept, so try it straight away instead of asking for the list of
+   * mechanisms first - this saves a round trip. If the server rejects
+   * it, the REJECTED reply carries the list and we carry on from there.
+   */
+  if (credentials != NULL && find_mech_by_name (auth, "EXTERNAL") != (GType) 0)
+    {
+      static const gchar * const external_only[] = { "EXTERNAL", NULL };
+      GError *local_error = NULL;
+
+      mech = client_choose_mech_and_send_initial_response (auth,
+                                                           credentials,
+                                                           external_only,
+                                                           attempted_auth_mechs,
+                                                           dos,
+                                                           cancellable,
+                                                           &local_error);
+      if (mech == NULL && !g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_FAILED))
+        {
+          g_propagate_error (error, local_error);
+          goto out;
+        }
+      g_clear_error (&local_error);
+    }
 
-  /* Get list of supported authentication mechanisms */
-  s = "AUTH\r\n";
-  debug_print ("CLIENT: writing '%s'", s);
-  if (!g_data_output_stream_put_string (dos, s, cancellable, error))
-    goto out;
-  state = CLIENT_STATE_WAITING_FOR_REJECT;
+  if (mech != NULL)
+    {
+      if (_g_dbus_auth_mechanism_client_get_state (mech) == G_DBUS_AUTH_MECHANISM_STATE_WAITING_FOR_DATA)
+        state = CLIENT_STATE_WAITING_FOR_DATA;
+      else
+        state = CLIENT_STATE_WAITING_FOR_OK;
+    }
+  else
+    {
+      /* Get list of supported authentication mechanisms */
+      s = "AUTH\r\n";
+      debug_print ("CLIENT: writing '%s'", s);
+      if (!g_data_output_stream_put_string (dos, s, cancellable, error))
+        goto out;
+      state = CLIENT_STATE_WAITING_FOR_REJECT;
+    }
 
   while (TRUE)
     {
@@ -667,7 +767,7 @@ _g_dbus_auth_run_client (GDBusAuth     *auth,
         {
         case CLIENT_STATE_WAITING_FOR_REJECT:
           debug_print ("CLIENT: WaitingForReject");
-          line = _my_g_data_input_stream_read_line (dis, &line_length, cancellable, error);
+          line = read_line (auth->priv->stream, &line_length, cancellable, error);
           if (line == NULL)
             goto out;
           debug_print ("CLIENT: WaitingForReject, read '%s'", line);
@@ -692,6 +792,7 @@ _g_dbus_auth_run_client (GDBusAuth     *auth,
 #endif
             }
           g_free (line);
+          g_clear_object (&mech);
           mech = client_choose_mech_and_send_initial_response (auth,
                                                                credentials,
                                                                (const gchar* const *) supported_auth_mechs,
@@ -709,7 +810,7 @@ _g_dbus_auth_run_client (GDBusAuth     *auth,
 
         case CLIENT_STATE_WAITING_FOR_OK:
           debug_print ("CLIENT: WaitingForOK");
-          line = _my_g_data_input_stream_read_line (dis, &line_length, cancellable, error);
+          line = read_line (auth->priv->stream, &line_length, cancellable, error);
           if (line == NULL)
             goto out;
           debug_print ("CLIENT: WaitingForOK, read '%s'", line);
@@ -730,7 +831,16 @@ _g_dbus_auth_run_client (GDBusAuth     *auth,
 
               if (offered_capabilities & G_DBUS_CAPABILITY_FLAGS_UNIX_FD_PASSING)
                 {
-                  s = "NEGOTIATE_UNIX_FD\r\n";
+                  /* BEGIN is sent whatever the answer is, so send it along
+                   * right away. It is only pipelined on sockets, where
+                   * read_line() is guaranteed not to read past the
+                   * answer into the first message the server sends.
+                   */
+                  sent_begin = G_IS_SOCKET_CONNECTION (auth->priv->stream);
+                  if (sent_begin)
+                    s = "NEGOTIATE_UNIX_FD\r\nBEGIN\r\n";
+                  else
+                    s = "NEGOTIATE_UNIX_FD\r\n";
                   debug_print ("CLIENT: writing '%s'", s);
                   if (!g_data_output_stream_put_string (dos, s, cancellable, error))
                     goto out;
@@ -765,7 +875,7 @@ _g_dbus_auth_run_client (GDBusAuth     *auth,
 
         case CLIENT_STATE_WAITING_FOR_AGREE_UNIX_FD:
           debug_print ("CLIENT: WaitingForAgreeUnixFD");
-          line = _my_g_data_input_stream_read_line (dis, &line_length, cancellable, error);
+          line = read_line (auth->priv->stream, &line_length, cancellable, error);
           if (line == NULL)
             goto out;
           debug_print ("CLIENT: WaitingForAgreeUnixFD, read='%s'", line);
@@ -773,10 +883,13 @@ _g_dbus_auth_run_client (GDBusAuth     *auth,
             {
               g_free (line);
               negotiated_capabilities |= G_DBUS_CAPABILITY_FLAGS_UNIX_FD_PASSING;
-              s = "BEGIN\r\n";
-              debug_print ("CLIENT: writing '%s'", s);
-              if (!g_data_output_stream_put_string (dos, s, cancellable, error))
-                goto out;
+              if (!sent_begin)
+                {
+                  s = "BEGIN\r\n";
+                  debug_print ("CLIENT: writing '%s'", s);
+                  if (!g_data_output_stream_put_string (dos, s, cancellable, error))
+                    goto out;
+                }
               /* and we're done! */
               goto out;
             }
@@ -784,10 +897,13 @@ _g_dbus_auth_run_client (GDBusAuth     *auth,
             {
               //g_strstrip (line + 5); g_debug ("bah, no unix_fd: '%s'", line + 5);
               g_free (line);
-              s = "BEGIN\r\n";
-              debug_print ("CLIENT: writing '%s'", s);
-              if (!g_data_output_stream_put_string (dos, s, cancellable, error))
-                goto out;
+              if (!sent_begin)
+                {
+                  s = "BEGIN\r\n";
+                  debug_print ("CLIENT: writing '%s'", s);
+                  if (!g_data_output_stream_put_string (dos, s, cancellable, error))
+                    goto out;
+                }
               /* and we're done! */
               goto out;
             }
@@ -806,7 +922,7 @@ _g_dbus_auth_run_client (GDBusAuth     *auth,
 
         case CLIENT_STATE_WAITING_FOR_DATA:
           debug_print ("CLIENT: WaitingForData");
-          line = _my_g_data_input_stream_read_line (dis, &line_length, cancellable, error);
+          line = read_line (auth->priv->stream, &line_length, cancellable, error);
           if (line == NULL)
             goto out;
           debug_print ("CLIENT: WaitingForData, read='%s'", line);
@@ -881,7 +997,6 @@ _g_dbus_auth_run_client (GDBusAuth     *auth,
     g_object_unref (mech);
   g_ptr_array_unref (attempted_auth_mechs);
   g_strfreev (supported_auth_mechs);
-  g_object_unref (dis);
   g_object_unref (dos);
 
   /* ensure return value is NULL if error is set */
@@ -958,7 +1073,6 @@ _g_dbus_auth_run_server (GDBusAuth              *auth,
 {
   gboolean ret;
   ServerState state;
-  GDataInputStream *dis;
   GDataOutputStream *dos;
   GError *local_error;
   guchar byte;
@@ -974,7 +1088,6 @@ _g_dbus_auth_run_server (GDBusAuth              *auth,
   _g_dbus_auth_add_mechs (auth, observer);
 
   ret = FALSE;
-  dis = NULL;
   dos = NULL;
   mech = NULL;
   negotiated_capabilities = 0;
@@ -990,13 +1103,9 @@ _g_dbus_auth_run_server (GDBusAuth              *auth,
       goto out;
     }
 
-  dis = G_DATA_INPUT_STREAM (g_data_input_stream_new (g_io_stream_get_input_stream (auth->priv->stream)));
   dos = G_DATA_OUTPUT_STREAM (g_data_output_stream_new (g_io_stream_get_output_stream (auth->priv->stream)));
-  g_filter_input_stream_set_close_base_stream (G_FILTER_INPUT_STREAM (dis), FALSE);
   g_filter_output_stream_set_close_base_stream (G_FILTER_OUTPUT_STREAM (dos), FALSE);
 
-  g_data_input_stream_set_newline_type (dis, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
-
   /* first read the NUL-byte (TODO: read credentials if using a unix domain socket) */
 #ifdef G_OS_UNIX
   if (G_IS_UNIX_CONNECTION (auth->priv->stream))
@@ -1013,24 +1122,14 @@ _g_dbus_auth_run_server (GDBusAuth              *auth,
     }
   else
     {
-      local_error = NULL;
-      byte = g_data_input_stream_read_byte (dis, cancellable, &local_error);
-      byte = byte; /* To avoid -Wunused-but-set-variable */
-      if (local_error != NULL)
-        {
-          g_propagate_error (error, local_error);
-          goto out;
-        }
+      if (!g_input_stream_read_all (g_io_stream_get_input_stream (auth->priv->stream),
+                                    &byte, 1, NULL, cancellable, error))
+        goto out;
     }
 #else
-  local_error = NULL;
-  byte = g_data_input_stream_read_byte (dis, cancellable, &local_error);
-  byte = byte; /* To avoid -Wunused-but-set-variable */
-  if (local_error != NULL)
-    {
-      g_propagate_error (error, local_error);
-      goto out;
-    }
+  if (!g_input_stream_read_all (g_io_stream_get_input_stream (auth->priv->stream),
+                                &byte, 1, NULL, cancellable, error))
+    goto out;
 #endif
   if (credentials != NULL)
     {
@@ -1053,7 +1152,7 @@ _g_dbus_auth_run_server (GDBusAuth              *auth,
         {
         case SERVER_STATE_WAITING_FOR_AUTH:
           debug_print ("SERVER: WaitingForAuth");
-          line = _my_g_data_input_stream_read_line (dis, &line_length, cancellable, error);
+          line = read_line (auth->priv->stream, &line_length, cancellable, error);
           debug_print ("SERVER: WaitingForAuth, read '%s'", line);
           if (line == NULL)
             goto out;
@@ -1252,7 +1351,7 @@ _g_dbus_auth_run_server (GDBusAuth              *auth,
 
         case SERVER_STATE_WAITING_FOR_DATA:
           debug_print ("SERVER: WaitingForData");
-          line = _my_g_data_input_stream_read_line (dis, &line_length, cancellable, error);
+          line = read_line (auth->priv->stream, &line_length, cancellable, error);
           debug_print ("SERVER: WaitingForData, read '%s'", line);
           if (line == NULL)
             goto out;
@@ -1291,17 +1390,7 @@ _g_dbus_auth_run_server (GDBusAuth              *auth,
 
         case SERVER_STATE_WAITING_FOR_BEGIN:
           debug_print ("SERVER: WaitingForBegin");
-          /* Use extremely slow (but reliable) line reader - this basically
-           * does a recvfrom() system call per character
-           *
-           * (the problem with using GDataInputStream's read_line is that because of
-           * buffering it might start reading into the first D-Bus message that
-           * appears after "BEGIN\r\n"....)
-           */
-          line = _my_g_input_stream_read_line_safe (g_io_stream_get_input_stream (auth->priv->stream),
-                                                    &line_length,
-                                                    cancellable,
-                                                    error);
+          line = read_line (auth->priv->stream, &line_length, cancellable, error);
           debug_print ("SERVER: WaitingForBegin, read '%s'", line);
           if (line == NULL)
             goto out;
@@ -1357,8 +1446,6 @@ _g_dbus_auth_run_server (GDBusAuth              *auth,
  out:
   if (mech != NULL)
     g_object_unref (mech);
-  if (dis != NULL)
-    g_object_unref (dis);
   if (dos != NULL)
     g_object_unref (dos);
 
@@ -437,7 +437,8 @@ struct _GDBusConnection
   /* Maps used for managing signal subscription, protected by @lock */
   GHashTable *map_rule_to_signal_data;                      /* match rule (gchar*)    -> SignalData */
   GHashTable *map_id_to_signal_data;                        /* id (guint)             -> SignalData */
-  GHashTable *map_sender_unique_name_to_signal_data_array;  /* unique sender (gchar*) -> GPtrArray* of SignalData */
+  GHashTable *map_sender_unique_name_to_signal_data_index;  /* unique sender (gchar*) -> GHashTable* of SignalDataBucket */
+  guint64 signal_data_serial;                               /* order of creation of SignalData */
 
   /* Maps used for managing exported objects and subtrees,
    * protected by @lock
@@ -520,6 +521,7 @@ static void schedule_method_call (GDBusConnection            *connection,
                                   GVariant                   *parameters,
                                   const GDBusInterfaceVTable *vtable,
                                   GMainContext               *main_context,
+                                  GThreadPool                *thread_pool,
                                   gpointer                    user_data);
 
 #define _G_ENSURE_LOCK(name) do {                                       \
@@ -683,7 +685,7 @@ g_dbus_connection_finalize (GObject *object)
 
   g_hash_table_unref (connection->map_rule_to_signal_data);
   g_hash_table_unref (connection->map_id_to_signal_data);
-  g_hash_table_unref (connection->map_sender_unique_name_to_signal_data_array);
+  g_hash_table_unref (connection->map_sender_unique_name_to_signal_data_index);
 
   g_hash_table_unref (connection->map_id_to_ei);
   g_hash_table_unref (connection->map_object_path_to_eo);
@@ -1072,10 +1074,10 @@ g_dbus_connection_init (GDBusConnection *connection)
                                                           g_str_equal);
   connection->map_id_to_signal_data = g_hash_table_new (g_direct_hash,
                                                         g_direct_equal);
-  connection->map_sender_unique_name_to_signal_data_array = g_hash_table_new_full (g_str_hash,
+  connection->map_sender_unique_name_to_signal_data_index = g_hash_table_new_full (g_str_hash,
                                                                                    g_str_equal,
                                                                                    g_free,
-                                                                                   (GDestroyNotify) g_ptr_array_unref);
+                                                                                   (GDestroyNotify) g_hash_table_unref);
 
   connection->map_object_path_to_eo = g_hash_table_new_full (g_str_hash,
                                                              g_str_equal,
@@ -1588,6 +1590,7 @@ g_dbus_connection_send_message_unlocked (GDBusConnection   *connection,
 {
   guchar *blob;
   gsize blob_size;
+  GArray *extents;
   guint32 serial_to_use;
   gboolean ret;
 
@@ -1600,6 +1603,7 @@ g_dbus_connection_send_message_unlocked (GDBusConnection   *connection,
 
   ret = FALSE;
   blob = NULL;
+  extents = NULL;
 
   if (out_serial != NULL)
     *out_serial = 0;
@@ -1614,10 +1618,11 @@ g_dbus_connection_send_message_unlocked (GDBusConnection   *connection,
                        error))
     goto out;
 
-  blob = g_dbus_message_to_blob (message,
-                                 &blob_size,
-                                 connection->capabilities,
-                                 error);
+  blob = _g_dbus_message_to_blob_with_extents (message,
+                                               &blob_size,
+                                               connection->capabilities,
+                                               &extents,
+                                               error);
   if (blob == NULL)
     goto out;
 
@@ -1668,13 +1673,18 @@ g_dbus_connection_send_message_unlocked (GDBusConnection   *connection,
   _g_dbus_worker_send_message (connection->worker,
                                message,
                                (gchar*) blob,
-                               blob_size);
-  blob = NULL; /* since _g_dbus_worker_send_message() steals the blob */
+                               blob_size,
+                               extents);
+  /* since _g_dbus_worker_send_message() steals the blob and extents */
+  blob = NULL;
+  extents = NULL;
 
   ret = TRUE;
 
  out:
   g_free (blob);
+  if (extents != NULL)
+    g_array_unref (extents);
 
   return ret;
 }
@@ -3226,8 +3236,21 @@ typedef struct
   gchar *arg0;
   GDBusSignalFlags flags;
   GArray *subscribers;
+  guint64 serial;
 } SignalData;
 
+/* Subscriptions for the same sender are indexed by object path and
+ * member, either of which may be %NULL for "any". An incoming signal
+ * then only needs to look at four buckets: (path, member), (path, any),
+ * (any, member) and (any, any).
+ */
+typedef struct
+{
+  gchar *object_path;
+  gchar *member;
+  GPtrArray *signal_data_array;
+} SignalDataBucket;
+
 typedef struct
 {
   GDBusSignalCallback callback;
@@ -3251,6 +3274,103 @@ signal_data_free (SignalData *signal_data)
   g_free (signal_data);
 }
 
+static guint
+signal_data_bucket_hash (gconstpointer key)
+{
+  const SignalDataBucket *bucket = key;
+  guint hash;
+
+  hash = bucket->object_path != NULL ? g_str_hash (bucket->object_path) : 0;
+  if (bucket->member != NULL)
+    hash = hash * 31 + g_str_hash (bucket->member);
+
+  return hash;
+}
+
+static gboolean
+signal_data_bucket_equal (gconstpointer a,
+                          gconstpointer b)
+{
+  const SignalDataBucket *bucket_a = a;
+  const SignalDataBucket *bucket_b = b;
+
+  return g_strcmp0 (bucket_a->object_path, bucket_b->object_path) == 0 &&
+         g_strcmp0 (bucket_a->member, bucket_b->member) == 0;
+}
+
+static void
+signal_data_bucket_free (SignalDataBucket *bucket)
+{
+  g_free (bucket->object_path);
+  g_free (bucket->member);
+  g_ptr_array_unref (bucket->signal_data_array);
+  g_slice_free (SignalDataBucket, bucket);
+}
+
+/* must hold lock when calling this */
+static void
+add_signal_data_to_index (GDBusConnection *connection,
+                          SignalData      *signal_data)
+{
+  GHashTable *index;
+  SignalDataBucket lookup;
+  SignalDataBucket *bucket;
+
+  index = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_index,
+                               signal_data->sender_unique_name);
+  if (index == NULL)
+    {
+      index = g_hash_table_new_full (signal_data_bucket_hash,
+                                     signal_data_bucket_equal,
+                                     (GDestroyNotify) signal_data_bucket_free,
+                                     NULL);
+      g_hash_table_insert (connection->map_sender_unique_name_to_signal_data_index,
+                           g_strdup (signal_data->sender_unique_name),
+                           index);
+    }
+
+  lookup.object_path = signal_data->object_path;
+  lookup.member = signal_data->member;
+  bucket = g_hash_table_lookup (index, &lookup);
+  if (bucket == NULL)
+    {
+      bucket = g_slice_new (SignalDataBucket);
+      bucket->object_path = g_strdup (signal_data->object_path);
+      bucket->member = g_strdup (signal_data->member);
+      bucket->signal_data_array = g_ptr_array_new ();
+      g_hash_table_add (index, bucket);
+    }
+  g_ptr_array_add (bucket->signal_data_array, signal_data);
+}
+
+/* must hold lock when calling this (except if connection->finalizing is TRUE) */
+static void
+remove_signal_data_from_index (GDBusConnection *connection,
+                               SignalData      *signal_data)
+{
+  GHashTable *index;
+  SignalDataBucket lookup;
+  SignalDataBucket *bucket;
+
+  index = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_index,
+                               signal_data->sender_unique_name);
+  g_return_if_fail (index != NULL);
+
+  lookup.object_path = signal_data->object_path;
+  lookup.member = signal_data->member;
+  bucket = g_hash_table_lookup (index, &lookup);
+  g_return_if_fail (bucket != NULL);
+  g_warn_if_fail (g_ptr_array_remove (bucket->signal_data_array, signal_data));
+
+  if (bucket->signal_data_array->len == 0)
+    {
+      g_hash_table_remove (index, bucket);
+      if (g_hash_table_size (index) == 0)
+        g_warn_if_fail (g_hash_table_remove (connection->map_sender_unique_name_to_signal_data_index,
+                                             signal_data->sender_unique_name));
+    }
+}
+
 static gchar *
 args_to_rule (const gchar      *sender,
               const gchar      *interface_name,
@@ -3437,7 +3557,6 @@ g_dbus_connection_signal_subscribe (GDBusConnection     *connection,
   gchar *rule;
   SignalData *signal_data;
   SignalSubscriber subscriber;
-  GPtrArray *signal_data_array;
   const gchar *sender_unique_name;
 
   /* Right now we abort if AddMatch() fails since it can only fail with the bus being in
@@ -3502,6 +3621,7 @@ g_dbus_connection_signal_subscribe (GDBusConnection     *connection,
   signal_data->arg0                  = g_strdup (arg0);
   signal_data->flags                 = flags;
   signal_data->subscribers           = g_array_new (FALSE, FALSE, sizeof (SignalSubscriber));
+  signal_data->serial                = connection->signal_data_serial++;
   g_array_append_val (signal_data->subscribers, subscriber);
 
   g_hash_table_insert (connection->map_rule_to_signal_data,
@@ -3519,16 +3639,7 @@ g_dbus_connection_signal_subscribe (GDBusConnection     *connection,
         add_match_rule (connection, signal_data->rule);
     }
 
-  signal_data_array = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_array,
-                                           signal_data->sender_unique_name);
-  if (signal_data_array == NULL)
-    {
-      signal_data_array = g_ptr_array_new ();
-      g_hash_table_insert (connection->map_sender_unique_name_to_signal_data_array,
-                           g_strdup (signal_data->sender_unique_name),
-                           signal_data_array);
-    }
-  g_ptr_array_add (signal_data_array, signal_data);
+  add_signal_data_to_index (connection, signal_data);
 
  out:
   g_hash_table_insert (connection->map_id_to_signal_data,
@@ -3550,7 +3661,6 @@ unsubscribe_id_internal (GDBusConnection *connection,
                          GArray          *out_removed_subscribers)
 {
   SignalData *signal_data;
-  GPtrArray *signal_data_array;
   guint n;
 
   signal_data = g_hash_table_lookup (connection->map_id_to_signal_data,
@@ -3578,16 +3688,7 @@ unsubscribe_id_internal (GDBusConnection *connection,
         {
           g_warn_if_fail (g_hash_table_remove (connection->map_rule_to_signal_data, signal_data->rule));
 
-          signal_data_array = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_array,
-                                                   signal_data->sender_unique_name);
-          g_warn_if_fail (signal_data_array != NULL);
-          g_warn_if_fail (g_ptr_array_remove (signal_data_array, signal_data));
-
-          if (signal_data_array->len == 0)
-            {
-              g_warn_if_fail (g_hash_table_remove (connection->map_sender_unique_name_to_signal_data_array,
-                                                   signal_data->sender_unique_name));
-            }
+          remove_signal_data_from_index (connection, signal_data);
 
           /* remove the match rule from the bus unless NameLost or NameAcquired (see subscribe()) */
           if ((connection->flags & G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION) &&
@@ -3774,10 +3875,21 @@ path_rule_matches (const gchar *path_a,
   return memcmp (path_a, path_b, MIN (len_a, len_b)) == 0;
 }
 
+/* called in GDBusWorker thread WITH lock held */
+static gint
+signal_data_compare_serial (gconstpointer a,
+                            gconstpointer b)
+{
+  const SignalData *signal_data_a = *(SignalData * const *) a;
+  const SignalData *signal_data_b = *(SignalData * const *) b;
+
+  return signal_data_a->serial < signal_data_b->serial ? -1 : 1;
+}
+
 /* called in GDBusWorker thread WITH lock held */
 static void
 schedule_callbacks (GDBusConnection *connection,
-                    GPtrArray       *signal_data_array,
+                    GHashTable      *index,
                     GDBusMessage    *message,
                     const gchar     *sender)
 {
@@ -3786,6 +3898,9 @@ schedule_callbacks (GDBusConnection *connection,
   const gchar *member;
   const gchar *path;
   const gchar *arg0;
+  SignalDataBucket *buckets[4];
+  guint n_buckets;
+  GPtrArray *signal_data_array;
 
   interface = NULL;
   member = NULL;
@@ -3811,9 +3926,42 @@ schedule_callbacks (GDBusConnection *connection,
            arg0);
 #endif
 
-  /* TODO: if this is slow, then we can change signal_data_array into
-   *       map_object_path_to_signal_data_array or something.
+  /* look at the four buckets that can match, keeping the order in
+   * which subscriptions were made if more than one has any
    */
+  signal_data_array = NULL;
+  n_buckets = 0;
+  for (n = 0; n < 4; n++)
+    {
+      SignalDataBucket lookup;
+
+      /* 0: (path, member), 1: (path, any), 2: (any, member), 3: (any, any) */
+      lookup.object_path = (n & 2) ? NULL : (gchar *) path;
+      lookup.member = (n & 1) ? NULL : (gchar *) member;
+
+      /* don't look at a wildcard bucket twice */
+      if ((lookup.object_path == NULL && !(n & 2)) ||
+          (lookup.member == NULL && !(n & 1)))
+        continue;
+
+      buckets[n_buckets] = g_hash_table_lookup (index, &lookup);
+      if (buckets[n_buckets] != NULL)
+        n_buckets++;
+    }
+
+  if (n_buckets == 0)
+    return;
+  else if (n_buckets == 1)
+    signal_data_array = g_ptr_array_ref (buckets[0]->signal_data_array);
+  else
+    {
+      signal_data_array = g_ptr_array_new ();
+      for (n = 0; n < n_buckets; n++)
+        for (m = 0; m < buckets[n]->signal_data_array->len; m++)
+          g_ptr_array_add (signal_data_array, buckets[n]->signal_data_array->pdata[m]);
+      g_ptr_array_sort (signal_data_array, signal_data_compare_serial);
+    }
+
   for (n = 0; n < signal_data_array->len; n++)
     {
       SignalData *signal_data = signal_data_array->pdata[n];
@@ -3876,6 +4024,8 @@ schedule_callbacks (GDBusConnection *connection,
           g_source_unref (idle_source);
         }
     }
+
+  g_ptr_array_unref (signal_data_array);
 }
 
 /* called in GDBusWorker thread with lock held */
@@ -3883,7 +4033,7 @@ static void
 distribute_signals (GDBusConnection *connection,
                     GDBusMessage    *message)
 {
-  GPtrArray *signal_data_array;
+  GHashTable *index;
   const gchar *sender;
 
   sender = g_dbus_message_get_sender (message);
@@ -3906,15 +4056,15 @@ distribute_signals (GDBusConnection *connection,
   /* collect subscribers that match on sender */
   if (sender != NULL)
     {
-      signal_data_array = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_array, sender);
-      if (signal_data_array != NULL)
-        schedule_callbacks (connection, signal_data_array, message, sender);
+      index = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_index, sender);
+      if (index != NULL)
+        schedule_callbacks (connection, index, message, sender);
     }
 
   /* collect subscribers not matching on sender */
-  signal_data_array = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_array, "");
-  if (signal_data_array != NULL)
-    schedule_callbacks (connection, signal_data_array, message, sender);
+  index = g_hash_table_lookup (connection->map_sender_unique_name_to_signal_data_index, "");
+  if (index != NULL)
+    schedule_callbacks (connection, index, message, sender);
 }
 
 /* ---------------------------------------------------------------------------------------------------- */
@@ -4023,8 +4173,10 @@ typedef struct
   gchar                      *interface_name;
   GDBusInterfaceVTable       *vtable;
   GDBusInterfaceInfo         *interface_info;
+  InfoCacheEntry             *interface_info_cache;
 
   GMainContext               *context;
+  GThreadPool                *thread_pool;
   gpointer                    user_data;
   GDestroyNotify              user_data_free_func;
 } ExportedInterface;
@@ -4033,6 +4185,9 @@ typedef struct
 static void
 exported_interface_free (ExportedInterface *ei)
 {
+  if (ei->thread_pool != NULL)
+    g_thread_pool_free (ei->thread_pool, FALSE, FALSE);
+
   g_dbus_interface_info_cache_release (ei->interface_info);
   g_dbus_interface_info_unref ((GDBusInterfaceInfo *) ei->interface_info);
 
@@ -4084,6 +4239,68 @@ has_object_been_unregistered (GDBusConnection  *connection,
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+typedef struct
+{
+  GSourceFunc    func;
+  gpointer       data;
+  GDestroyNotify notify;
+} ThreadPoolCall;
+
+/* the registration id whose thread pool the current thread belongs to */
+static GPrivate thread_pool_registration_id;
+
+/* called in a thread of the thread pool of an exported object - no locks held */
+static void
+thread_pool_call_func (gpointer pool_data,
+                       gpointer user_data)
+{
+  ThreadPoolCall *call = pool_data;
+
+  g_private_set (&thread_pool_registration_id, user_data);
+  call->func (call->data);
+  call->notify (call->data);
+  g_private_set (&thread_pool_registration_id, NULL);
+
+  g_slice_free (ThreadPoolCall, call);
+}
+
+/* Calls @func in @thread_pool if it is not %NULL, otherwise in an idle
+ * handler in @main_context.
+ *
+ * called in any thread with connection's lock held
+ */
+static void
+schedule_call (GMainContext   *main_context,
+               GThreadPool    *thread_pool,
+               GSourceFunc     func,
+               gpointer        data,
+               GDestroyNotify  notify,
+               const gchar    *name)
+{
+  GSource *idle_source;
+
+  if (thread_pool != NULL)
+    {
+      ThreadPoolCall *call;
+
+      call = g_slice_new (ThreadPoolCall);
+      call->func = func;
+      call->data = data;
+      call->notify = notify;
+      g_thread_pool_push (thread_pool, call, NULL);
+      return;
+    }
+
+  idle_source = g_idle_source_new ();
+  g_source_set_priority (idle_source, G_PRIORITY_DEFAULT);
+  g_source_set_callback (idle_source, func, data, notify);
+  g_source_set_name (idle_source, name);
+  g_source_attach (idle_source, main_context);
+  g_source_unref (idle_source);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
 typedef struct
 {
   GDBusConnection *connection;
@@ -4223,15 +4440,16 @@ validate_and_maybe_schedule_property_getset (GDBusConnection            *connect
                                              guint                       subtree_registration_id,
                                              gboolean                    is_get,
                                              GDBusInterfaceInfo         *interface_info,
+                                             InfoCacheEntry             *interface_info_cache,
                                              const GDBusInterfaceVTable *vtable,
                                              GMainContext               *main_context,
+                                             GThreadPool                *thread_pool,
                                              gpointer                    user_data)
 {
   gboolean handled;
   const char *interface_name;
   const char *property_name;
   const GDBusPropertyInfo *property_info;
-  GSource *idle_source;
   PropertyData *property_data;
   GDBusMessage *reply;
 
@@ -4256,8 +4474,10 @@ validate_and_maybe_schedule_property_getset (GDBusConnection            *connect
    */
   property_info = NULL;
 
-  /* TODO: the cost of this is O(n) - it might be worth caching the result */
-  property_info = g_dbus_interface_info_lookup_property (interface_info, property_name);
+  if (interface_info_cache != NULL)
+    property_info = _g_dbus_info_cache_entry_lookup_property (interface_info_cache, property_name);
+  else
+    property_info = g_dbus_interface_info_lookup_property (interface_info, property_name);
   if (property_info == NULL)
     {
       reply = g_dbus_message_new_method_error (message,
@@ -4327,7 +4547,7 @@ validate_and_maybe_schedule_property_getset (GDBusConnection            *connect
         {
           schedule_method_call (connection, message, registration_id, subtree_registration_id,
                                 interface_info, NULL, property_info, g_dbus_message_get_body (message),
-                                vtable, main_context, user_data);
+                                vtable, main_context, thread_pool, user_data);
           handled = TRUE;
           goto out;
         }
@@ -4338,7 +4558,7 @@ validate_and_maybe_schedule_property_getset (GDBusConnection            *connect
         {
           schedule_method_call (connection, message, registration_id, subtree_registration_id,
                                 interface_info, NULL, property_info, g_dbus_message_get_body (message),
-                                vtable, main_context, user_data);
+                                vtable, main_context, thread_pool, user_data);
           handled = TRUE;
           goto out;
         }
@@ -4356,18 +4576,18 @@ validate_and_maybe_schedule_property_getset (GDBusConnection            *connect
   property_data->registration_id = registration_id;
   property_data->subtree_registration_id = subtree_registration_id;
 
-  idle_source = g_idle_source_new ();
-  g_source_set_priority (idle_source, G_PRIORITY_DEFAULT);
-  g_source_set_callback (idle_source,
-                         is_get ? invoke_get_property_in_idle_cb : invoke_set_property_in_idle_cb,
-                         property_data,
-                         (GDestroyNotify) property_data_free);
   if (is_get)
-    g_source_set_name (idle_source, "[gio] invoke_get_property_in_idle_cb");
+    schedule_call (main_context, thread_pool,
+                   invoke_get_property_in_idle_cb,
+                   property_data,
+                   (GDestroyNotify) property_data_free,
+                   "[gio] invoke_get_property_in_idle_cb");
   else
-    g_source_set_name (idle_source, "[gio] invoke_set_property_in_idle_cb");
-  g_source_attach (idle_source, main_context);
-  g_source_unref (idle_source);
+    schedule_call (main_context, thread_pool,
+                   invoke_set_property_in_idle_cb,
+                   property_data,
+                   (GDestroyNotify) property_data_free,
+                   "[gio] invoke_set_property_in_idle_cb");
 
   handled = TRUE;
 
@@ -4424,8 +4644,10 @@ handle_getset_property (GDBusConnection *connection,
                                                          0,
                                                          is_get,
                                                          ei->interface_info,
+                                                         ei->interface_info_cache,
                                                          ei->vtable,
                                                          ei->context,
+                                                         ei->thread_pool,
                                                          ei->user_data);
  out:
   return handled;
@@ -4543,10 +4765,10 @@ validate_and_maybe_schedule_property_get_all (GDBusConnection            *connec
                                               GDBusInterfaceInfo         *interface_info,
                                               const GDBusInterfaceVTable *vtable,
                                               GMainContext               *main_context,
+                                              GThreadPool                *thread_pool,
                                               gpointer                    user_data)
 {
   gboolean handled;
-  GSource *idle_source;
   PropertyGetAllData *property_get_all_data;
 
   handled = FALSE;
@@ -4562,7 +4784,7 @@ validate_and_maybe_schedule_property_get_all (GDBusConnection            *connec
     {
       schedule_method_call (connection, message, registration_id, subtree_registration_id,
                             interface_info, NULL, NULL, g_dbus_message_get_body (message),
-                            vtable, main_context, user_data);
+                            vtable, main_context, thread_pool, user_data);
       handled = TRUE;
       goto out;
     }
@@ -4577,15 +4799,11 @@ validate_and_maybe_schedule_property_get_all (GDBusConnection            *connec
   property_get_all_data->registration_id = registration_id;
   property_get_all_data->subtree_registration_id = subtree_registration_id;
 
-  idle_source = g_idle_source_new ();
-  g_source_set_priority (idle_source, G_PRIORITY_DEFAULT);
-  g_source_set_callback (idle_source,
-                         invoke_get_all_properties_in_idle_cb,
-                         property_get_all_data,
-                         (GDestroyNotify) property_get_all_data_free);
-  g_source_set_name (idle_source, "[gio] invoke_get_all_properties_in_idle_cb");
-  g_source_attach (idle_source, main_context);
-  g_source_unref (idle_source);
+  schedule_call (main_context, thread_pool,
+                 invoke_get_all_properties_in_idle_cb,
+                 property_get_all_data,
+                 (GDestroyNotify) property_get_all_data_free,
+                 "[gio] invoke_get_all_properties_in_idle_cb");
 
   handled = TRUE;
 
@@ -4633,6 +4851,7 @@ handle_get_all_properties (GDBusConnection *connection,
                                                           ei->interface_info,
                                                           ei->vtable,
                                                           ei->context,
+                                                          ei->thread_pool,
                                                           ei->user_data);
  out:
   return handled;
@@ -4691,6 +4910,13 @@ introspect_append_header (GString *s)
   g_string_append (s, introspect_header);
 }
 
+static gint
+compare_node_names (gconstpointer a,
+                    gconstpointer b)
+{
+  return strcmp (*(const gchar **) a, *(const gchar **) b);
+}
+
 static void
 maybe_add_path (const gchar *path, gsize path_len, const gchar *object_path, GHashTable *set)
 {
@@ -4752,6 +4978,9 @@ g_dbus_connection_list_registered_unlocked (GDBusConnection *connection,
   g_hash_table_unref (set);
   g_list_free (keys);
 
+  /* don't let introspection output depend on the hash table layout */
+  g_ptr_array_sort (p, compare_node_names);
+
   g_ptr_array_add (p, NULL);
   ret = (gchar **) g_ptr_array_free (p, FALSE);
   return ret;
@@ -4872,10 +5101,10 @@ schedule_method_call (GDBusConnection            *connection,
                       GVariant                   *parameters,
                       const GDBusInterfaceVTable *vtable,
                       GMainContext               *main_context,
+                      GThreadPool                *thread_pool,
                       gpointer                    user_data)
 {
   GDBusMethodInvocation *invocation;
-  GSource *idle_source;
 
   invocation = _g_dbus_method_invocation_new (g_dbus_message_get_sender (message),
                                               g_dbus_message_get_path (message),
@@ -4894,15 +5123,11 @@ schedule_method_call (GDBusConnection            *connection,
   g_object_set_data (G_OBJECT (invocation), "g-dbus-registration-id", GUINT_TO_POINTER (registration_id));
   g_object_set_data (G_OBJECT (invocation), "g-dbus-subtree-registration-id", GUINT_TO_POINTER (subtree_registration_id));
 
-  idle_source = g_idle_source_new ();
-  g_source_set_priority (idle_source, G_PRIORITY_DEFAULT);
-  g_source_set_callback (idle_source,
-                         call_in_idle_cb,
-                         invocation,
-                         g_object_unref);
-  g_source_set_name (idle_source, "[gio] call_in_idle_cb");
-  g_source_attach (idle_source, main_context);
-  g_source_unref (idle_source);
+  schedule_call (main_context, thread_pool,
+                 call_in_idle_cb,
+                 invocation,
+                 g_object_unref,
+                 "[gio] call_in_idle_cb");
 }
 
 /* called in GDBusWorker thread with connection's lock held */
@@ -4912,8 +5137,10 @@ validate_and_maybe_schedule_method_call (GDBusConnection            *connection,
                                          guint                       registration_id,
                                          guint                       subtree_registration_id,
                                          GDBusInterfaceInfo         *interface_info,
+                                         InfoCacheEntry             *interface_info_cache,
                                          const GDBusInterfaceVTable *vtable,
                                          GMainContext               *main_context,
+                                         GThreadPool                *thread_pool,
                                          gpointer                    user_data)
 {
   GDBusMethodInfo *method_info;
@@ -4924,8 +5151,10 @@ validate_and_maybe_schedule_method_call (GDBusConnection            *connection,
 
   handled = FALSE;
 
-  /* TODO: the cost of this is O(n) - it might be worth caching the result */
-  method_info = g_dbus_interface_info_lookup_method (interface_info, g_dbus_message_get_member (message));
+  if (interface_info_cache != NULL)
+    method_info = _g_dbus_info_cache_entry_lookup_method (interface_info_cache, g_dbus_message_get_member (message));
+  else
+    method_info = g_dbus_interface_info_lookup_method (interface_info, g_dbus_message_get_member (message));
 
   /* if the method doesn't exist, return the org.freedesktop.DBus.Error.UnknownMethod
    * error to the caller
@@ -4981,7 +5210,7 @@ validate_and_maybe_schedule_method_call (GDBusConnection            *connection,
   /* schedule the call in idle */
   schedule_method_call (connection, message, registration_id, subtree_registration_id,
                         interface_info, method_info, NULL, parameters,
-                        vtable, main_context, user_data);
+                        vtable, main_context, thread_pool, user_data);
   g_variant_unref (parameters);
   handled = TRUE;
 
@@ -5026,8 +5255,10 @@ obj_message_func (GDBusConnection *connection,
                                                              ei->id,
                                                              0,
                                                              ei->interface_info,
+                                                             ei->interface_info_cache,
                                                              ei->vtable,
                                                              ei->context,
+                                                             ei->thread_pool,
                                                              ei->user_data);
           goto out;
         }
@@ -5066,6 +5297,15 @@ obj_message_func (GDBusConnection *connection,
   return handled;
 }
 
+static guint register_object_internal (GDBusConnection             *connection,
+                                       const gchar                 *object_path,
+                                       GDBusInterfaceInfo          *interface_info,
+                                       const GDBusInterfaceVTable  *vtable,
+                                       gint                         max_threads,
+                                       gpointer                     user_data,
+                                       GDestroyNotify               user_data_free_func,
+                                       GError                     **error);
+
 /**
  * g_dbus_connection_register_object:
  * @connection: a #GDBusConnection
@@ -5129,17 +5369,89 @@ g_dbus_connection_register_object (GDBusConnection             *connection,
                                    GDestroyNotify               user_data_free_func,
                                    GError                     **error)
 {
-  ExportedObject *eo;
-  ExportedInterface *ei;
-  guint ret;
+  g_return_val_if_fail (G_IS_DBUS_CONNECTION (connection), 0);
+  g_return_val_if_fail (object_path != NULL && g_variant_is_object_path (object_path), 0);
+  g_return_val_if_fail (interface_info != NULL, 0);
+  g_return_val_if_fail (g_dbus_is_interface_name (interface_info->name), 0);
+  g_return_val_if_fail (error == NULL || *error == NULL, 0);
+  g_return_val_if_fail (check_initialized (connection), 0);
+
+  return register_object_internal (connection, object_path, interface_info, vtable,
+                                   0, user_data, user_data_free_func, error);
+}
 
+/**
+ * g_dbus_connection_register_object_in_thread_pool:
+ * @connection: a #GDBusConnection
+ * @object_path: the object path to register at
+ * @interface_info: introspection data for the interface
+ * @vtable: (nullable): a #GDBusInterfaceVTable to call into or %NULL
+ * @max_threads: the maximum number of threads to call @vtable in,
+ *     or -1 for no limit
+ * @user_data: (nullable): data to pass to functions in @vtable
+ * @user_data_free_func: function to call when the object path is unregistered
+ * @error: return location for error or %NULL
+ *
+ * Like g_dbus_connection_register_object(), except that the functions
+ * in @vtable are called in a pool of up to @max_threads threads,
+ * straight from the thread that reads messages off @connection. No
+ * main context is involved, so method calls from many peers can be
+ * handled in parallel.
+ *
+ * Calls may happen concurrently, so @vtable and @user_data must be
+ * thread-safe. Calls are not guaranteed to happen in the order the
+ * messages were received. @user_data_free_func is still called in the
+ * [thread-default main context][g-main-context-push-thread-default]
+ * of the thread you are calling this method from.
+ *
+ * g_dbus_connection_unregister_object() waits for calls that are
+ * already running or queued to finish, unless it is called from one
+ * of them.
+ *
+ * Returns: 0 if @error is set, otherwise a registration id (never 0)
+ *     that can be used with g_dbus_connection_unregister_object()
+ *
+ * Since: 2.54
+ */
+guint
+g_dbus_connection_register_object_in_thread_pool (GDBusConnection             *connection,
+                                                  const gchar                 *object_path,
+                                                  GDBusInterfaceInfo          *interface_info,
+                                                  const GDBusInterfaceVTable  *vtable,
+                                                  gint                         max_threads,
+                                                  gpointer                     user_data,
+                                                  GDestroyNotify               user_data_free_func,
+                                                  GError                     **error)
+{
   g_return_val_if_fail (G_IS_DBUS_CONNECTION (connection), 0);
   g_return_val_if_fail (object_path != NULL && g_variant_is_object_path (object_path), 0);
   g_return_val_if_fail (interface_info != NULL, 0);
   g_return_val_if_fail (g_dbus_is_interface_name (interface_info->name), 0);
+  g_return_val_if_fail (max_threads == -1 || max_threads > 0, 0);
   g_return_val_if_fail (error == NULL || *error == NULL, 0);
   g_return_val_if_fail (check_initialized (connection), 0);
 
+  return register_object_internal (connection, object_path, interface_info, vtable,
+                                   max_threads, user_data, user_data_free_func, error);
+}
+
+/* called in any thread, @max_threads is 0 if calls should go to the
+ * thread-default main context
+ */
+static guint
+register_object_internal (GDBusConnection             *connection,
+                          const gchar                 *object_path,
+                          GDBusInterfaceInfo          *interface_info,
+                          const GDBusInterfaceVTable  *vtable,
+                          gint                         max_threads,
+                          gpointer                     user_data,
+                          GDestroyNotify               user_data_free_func,
+                          GError                     **error)
+{
+  ExportedObject *eo;
+  ExportedInterface *ei;
+  guint ret;
+
   ret = 0;
 
   CONNECTION_LOCK (connection);
@@ -5176,9 +5488,15 @@ g_dbus_connection_register_object (GDBusConnection             *connection,
   ei->user_data_free_func = user_data_free_func;
   ei->vtable = _g_dbus_interface_vtable_copy (vtable);
   ei->interface_info = g_dbus_interface_info_ref (interface_info);
-  g_dbus_interface_info_cache_build (ei->interface_info);
+  ei->interface_info_cache = _g_dbus_interface_info_cache_build_entry (ei->interface_info);
   ei->interface_name = g_strdup (interface_info->name);
   ei->context = g_main_context_ref_thread_default ();
+  if (max_threads != 0)
+    ei->thread_pool = g_thread_pool_new (thread_pool_call_func,
+                                         GUINT_TO_POINTER (ei->id),
+                                         max_threads,
+                                         FALSE,
+                                         NULL);
 
   g_hash_table_insert (eo->map_if_name_to_ei,
                        (gpointer) ei->interface_name,
@@ -5214,11 +5532,13 @@ g_dbus_connection_unregister_object (GDBusConnection *connection,
   ExportedInterface *ei;
   ExportedObject *eo;
   gboolean ret;
+  gboolean wait_for_thread_pool;
 
   g_return_val_if_fail (G_IS_DBUS_CONNECTION (connection), FALSE);
   g_return_val_if_fail (check_initialized (connection), FALSE);
 
   ret = FALSE;
+  wait_for_thread_pool = FALSE;
 
   CONNECTION_LOCK (connection);
 
@@ -5230,7 +5550,20 @@ g_dbus_connection_unregister_object (GDBusConnection *connection,
   eo = ei->eo;
 
   g_warn_if_fail (g_hash_table_remove (connection->map_id_to_ei, GUINT_TO_POINTER (ei->id)));
-  g_warn_if_fail (g_hash_table_remove (eo->map_if_name_to_ei, ei->interface_name));
+
+  /* Calls in the thread pool may still be using @ei, so wait for them
+   * to finish (without the lock, they need it) before freeing it. We
+   * can't do that from one of the calls themselves.
+   */
+  if (ei->thread_pool != NULL &&
+      g_private_get (&thread_pool_registration_id) != GUINT_TO_POINTER (ei->id))
+    {
+      g_warn_if_fail (g_hash_table_steal (eo->map_if_name_to_ei, ei->interface_name));
+      wait_for_thread_pool = TRUE;
+    }
+  else
+    g_warn_if_fail (g_hash_table_remove (eo->map_if_name_to_ei, ei->interface_name));
+
   /* unregister object path if we have no more exported interfaces */
   if (g_hash_table_size (eo->map_if_name_to_ei) == 0)
     g_warn_if_fail (g_hash_table_remove (connection->map_object_path_to_eo,
@@ -5241,6 +5574,16 @@ g_dbus_connection_unregister_object (GDBusConnection *connection,
  out:
   CONNECTION_UNLOCK (connection);
 
+  if (wait_for_thread_pool)
+    {
+      g_thread_pool_free (ei->thread_pool, FALSE, TRUE);
+      ei->thread_pool = NULL;
+
+      CONNECTION_LOCK (connection);
+      exported_interface_free (ei);
+      CONNECTION_UNLOCK (connection);
+    }
+
   return ret;
 }
 
@@ -6552,8 +6895,10 @@ handle_subtree_method_invocation (GDBusConnection *connection,
                                                          0,
                                                          es->id,
                                                          interface_info,
+                                                         NULL,
                                                          interface_vtable,
                                                          es->context,
+                                                         NULL,
                                                          interface_user_data);
       CONNECTION_UNLOCK (connection);
     }
@@ -6618,8 +6963,10 @@ handle_subtree_method_invocation (GDBusConnection *connection,
                                                                  es->id,
                                                                  is_property_get,
                                                                  interface_info,
+                                                                 NULL,
                                                                  interface_vtable,
                                                                  es->context,
+                                                                 NULL,
                                                                  interface_user_data);
           CONNECTION_UNLOCK (connection);
         }
@@ -6633,6 +6980,7 @@ handle_subtree_method_invocation (GDBusConnection *connection,
                                                                   interface_info,
                                                                   interface_vtable,
                                                                   es->context,
+                                                                  NULL,
                                                                   interface_user_data);
           CONNECTION_UNLOCK (connection);
         }
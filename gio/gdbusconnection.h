@@ -409,6 +409,15 @@ guint            g_dbus_connection_register_object_with_closures (GDBusConnectio
                                                                   GClosure                *get_property_closure,
                                                                   GClosure                *set_property_closure,
                                                                   GError                 **error);
+GLIB_AVAILABLE_IN_2_54
+guint            g_dbus_connection_register_object_in_thread_pool (GDBusConnection            *connection,
+                                                                   const gchar                *object_path,
+                                                                   GDBusInterfaceInfo         *interface_info,
+                                                                   const GDBusInterfaceVTable *vtable,
+                                                                   gint                        max_threads,
+                                                                   gpointer                    user_data,
+                                                                   GDestroyNotify              user_data_free_func,
+                                                                   GError                    **error);
 GLIB_AVAILABLE_IN_ALL
 gboolean         g_dbus_connection_unregister_object          (GDBusConnection            *connection,
                                                                guint                       registration_id);
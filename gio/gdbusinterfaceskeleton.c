@@ -50,6 +50,14 @@ struct _GDBusInterfaceSkeletonPrivate
   GSList                     *connections;   /* List of ConnectionData */
   gchar                      *object_path;   /* The object path for this skeleton */
   GDBusInterfaceVTable       *hooked_vtable;
+
+  /* for g_dbus_interface_skeleton_schedule_flush(), protected by
+   * the flush_sources lock
+   */
+  GMainContext               *context;
+  gboolean                    flush_scheduled;
+  guint                       flush_interval;
+  gint64                      last_flush_time;
 };
 
 typedef struct
@@ -118,6 +126,8 @@ g_dbus_interface_skeleton_finalize (GObject *object)
 
   g_mutex_clear (&interface->priv->lock);
 
+  g_main_context_unref (interface->priv->context);
+
   G_OBJECT_CLASS (g_dbus_interface_skeleton_parent_class)->finalize (object);
 }
 
@@ -259,6 +269,7 @@ g_dbus_interface_skeleton_init (GDBusInterfaceSkeleton *interface)
 {
   interface->priv = g_dbus_interface_skeleton_get_instance_private (interface);
   g_mutex_init (&interface->priv->lock);
+  interface->priv->context = g_main_context_ref_thread_default ();
 }
 
 /* ---------------------------------------------------------------------------------------------------- */
@@ -396,6 +407,295 @@ g_dbus_interface_skeleton_flush (GDBusInterfaceSkeleton *interface_)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+/* Flushes scheduled with g_dbus_interface_skeleton_schedule_flush() are
+ * done by a single source per main context, so that changes to any
+ * number of skeletons go out in one main loop iteration.
+ */
+typedef struct
+{
+  GSource    source;
+  GPtrArray *pending;  /* of owned GDBusInterfaceSkeleton*, in order of scheduling */
+} FlushSource;
+
+G_LOCK_DEFINE_STATIC (flush_sources);
+static GHashTable *flush_sources = NULL;  /* GMainContext* -> FlushSource* */
+static guint flush_freeze_count = 0;
+
+/* must hold the flush_sources lock */
+static gint64
+flush_due_time_locked (GDBusInterfaceSkeleton *interface_)
+{
+  if (interface_->priv->flush_interval == 0 || interface_->priv->last_flush_time == 0)
+    return 0;
+  return interface_->priv->last_flush_time + (gint64) interface_->priv->flush_interval * 1000;
+}
+
+/* must hold the flush_sources lock */
+static void
+flush_source_update_ready_time_locked (FlushSource *flush_source)
+{
+  gint64 ready_time;
+  guint n;
+
+  ready_time = -1;
+  if (flush_freeze_count == 0)
+    {
+      for (n = 0; n < flush_source->pending->len; n++)
+        {
+          gint64 due_time = flush_due_time_locked (flush_source->pending->pdata[n]);
+          if (ready_time == -1 || due_time < ready_time)
+            ready_time = due_time;
+        }
+    }
+
+  g_source_set_ready_time (&flush_source->source, ready_time);
+}
+
+static gboolean
+flush_source_dispatch (GSource     *source,
+                       GSourceFunc  callback,
+                       gpointer     user_data)
+{
+  FlushSource *flush_source = (FlushSource *) source;
+  GPtrArray *due;
+  GPtrArray *not_due;
+  gboolean ret;
+  gint64 now;
+  guint n;
+
+  now = g_source_get_time (source);
+  due = g_ptr_array_new_with_free_func (g_object_unref);
+
+  G_LOCK (flush_sources);
+
+  if (flush_freeze_count == 0)
+    {
+      not_due = g_ptr_array_new ();
+      for (n = 0; n < flush_source->pending->len; n++)
+        {
+          GDBusInterfaceSkeleton *interface_ = flush_source->pending->pdata[n];
+
+          if (flush_due_time_locked (interface_) <= now)
+            {
+              interface_->priv->flush_scheduled = FALSE;
+              interface_->priv->last_flush_time = now;
+              g_ptr_array_add (due, interface_);
+            }
+          else
+            g_ptr_array_add (not_due, interface_);
+        }
+      g_ptr_array_unref (flush_source->pending);
+      flush_source->pending = not_due;
+    }
+
+  if (flush_source->pending->len == 0)
+    {
+      g_hash_table_remove (flush_sources, g_source_get_context (source));
+      ret = G_SOURCE_REMOVE;
+    }
+  else
+    {
+      flush_source_update_ready_time_locked (flush_source);
+      ret = G_SOURCE_CONTINUE;
+    }
+
+  G_UNLOCK (flush_sources);
+
+  for (n = 0; n < due->len; n++)
+    g_dbus_interface_skeleton_flush (due->pdata[n]);
+  g_ptr_array_unref (due);
+
+  return ret;
+}
+
+static void
+flush_source_finalize (GSource *source)
+{
+  FlushSource *flush_source = (FlushSource *) source;
+
+  g_ptr_array_free (flush_source->pending, TRUE);
+}
+
+static GSourceFuncs flush_source_funcs = {
+  NULL, /* prepare */
+  NULL, /* check */
+  flush_source_dispatch,
+  flush_source_finalize
+};
+
+/**
+ * g_dbus_interface_skeleton_schedule_flush:
+ * @interface_: A #GDBusInterfaceSkeleton.
+ *
+ * Arranges for g_dbus_interface_skeleton_flush() to be called on
+ * @interface_ from the [thread-default main context][g-main-context-push-thread-default]
+ * that was in use when @interface_ was created. Calling this again
+ * before that has happened does nothing.
+ *
+ * Flushes of all skeletons using the same main context are done
+ * together from a single source. They are held back while
+ * g_dbus_interface_skeleton_freeze_scheduled_flushes() is in effect,
+ * and limited to one per the interval set with
+ * g_dbus_interface_skeleton_set_flush_interval().
+ *
+ * Code generated by [gdbus-codegen][gdbus-codegen] uses this to emit
+ * the `org.freedesktop.DBus.Properties::PropertiesChanged` signal.
+ *
+ * This function can be called from any thread.
+ *
+ * Since: 2.54
+ */
+void
+g_dbus_interface_skeleton_schedule_flush (GDBusInterfaceSkeleton *interface_)
+{
+  FlushSource *flush_source;
+
+  g_return_if_fail (G_IS_DBUS_INTERFACE_SKELETON (interface_));
+
+  G_LOCK (flush_sources);
+
+  if (interface_->priv->flush_scheduled)
+    goto out;
+  interface_->priv->flush_scheduled = TRUE;
+
+  if (flush_sources == NULL)
+    flush_sources = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_source_unref);
+
+  flush_source = g_hash_table_lookup (flush_sources, interface_->priv->context);
+  if (flush_source == NULL)
+    {
+      flush_source = (FlushSource *) g_source_new (&flush_source_funcs, sizeof (FlushSource));
+      flush_source->pending = g_ptr_array_new ();
+      g_source_set_priority (&flush_source->source, G_PRIORITY_DEFAULT);
+      g_source_set_name (&flush_source->source, "[gio] flush_source_dispatch");
+      g_source_set_ready_time (&flush_source->source, -1);
+      g_source_attach (&flush_source->source, interface_->priv->context);
+      g_hash_table_insert (flush_sources, interface_->priv->context, flush_source);
+    }
+
+  g_ptr_array_add (flush_source->pending, g_object_ref (interface_));
+  flush_source_update_ready_time_locked (flush_source);
+
+ out:
+  G_UNLOCK (flush_sources);
+}
+
+/**
+ * g_dbus_interface_skeleton_set_flush_interval:
+ * @interface_: A #GDBusInterfaceSkeleton.
+ * @interval: The minimum time between scheduled flushes, in milliseconds.
+ *
+ * Limits the flushes scheduled with
+ * g_dbus_interface_skeleton_schedule_flush() to one per @interval
+ * milliseconds. Until the next flush, further changes are coalesced,
+ * so that e.g. a property changing many times a second leads to at most
+ * one `PropertiesChanged` signal per @interval.
+ *
+ * The default of 0 flushes as soon as possible.
+ *
+ * Since: 2.54
+ */
+void
+g_dbus_interface_skeleton_set_flush_interval (GDBusInterfaceSkeleton *interface_,
+                                              guint                   interval)
+{
+  FlushSource *flush_source;
+
+  g_return_if_fail (G_IS_DBUS_INTERFACE_SKELETON (interface_));
+
+  G_LOCK (flush_sources);
+  interface_->priv->flush_interval = interval;
+  if (interface_->priv->flush_scheduled)
+    {
+      flush_source = g_hash_table_lookup (flush_sources, interface_->priv->context);
+      flush_source_update_ready_time_locked (flush_source);
+    }
+  G_UNLOCK (flush_sources);
+}
+
+/**
+ * g_dbus_interface_skeleton_get_flush_interval:
+ * @interface_: A #GDBusInterfaceSkeleton.
+ *
+ * Gets the interval set with g_dbus_interface_skeleton_set_flush_interval().
+ *
+ * Returns: The minimum time between scheduled flushes, in milliseconds.
+ *
+ * Since: 2.54
+ */
+guint
+g_dbus_interface_skeleton_get_flush_interval (GDBusInterfaceSkeleton *interface_)
+{
+  guint ret;
+
+  g_return_val_if_fail (G_IS_DBUS_INTERFACE_SKELETON (interface_), 0);
+
+  G_LOCK (flush_sources);
+  ret = interface_->priv->flush_interval;
+  G_UNLOCK (flush_sources);
+
+  return ret;
+}
+
+/**
+ * g_dbus_interface_skeleton_freeze_scheduled_flushes:
+ *
+ * Holds back all flushes scheduled with
+ * g_dbus_interface_skeleton_schedule_flush(), in every thread, until
+ * g_dbus_interface_skeleton_thaw_scheduled_flushes() is called.
+ *
+ * This is useful when updating many objects at once: their changes
+ * are then emitted together, with one `PropertiesChanged` signal per
+ * interface and object, once everything has been updated.
+ *
+ * Calls can be nested.
+ *
+ * Since: 2.54
+ */
+void
+g_dbus_interface_skeleton_freeze_scheduled_flushes (void)
+{
+  G_LOCK (flush_sources);
+  flush_freeze_count++;
+  G_UNLOCK (flush_sources);
+}
+
+/**
+ * g_dbus_interface_skeleton_thaw_scheduled_flushes:
+ *
+ * Reverts the effect of a previous call to
+ * g_dbus_interface_skeleton_freeze_scheduled_flushes(). Once every
+ * freeze has been thawed, the flushes that were held back are done.
+ *
+ * Since: 2.54
+ */
+void
+g_dbus_interface_skeleton_thaw_scheduled_flushes (void)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  G_LOCK (flush_sources);
+
+  if (G_UNLIKELY (flush_freeze_count == 0))
+    {
+      G_UNLOCK (flush_sources);
+      g_critical ("g_dbus_interface_skeleton_thaw_scheduled_flushes() called without a matching freeze");
+      return;
+    }
+
+  if (--flush_freeze_count == 0 && flush_sources != NULL)
+    {
+      g_hash_table_iter_init (&iter, flush_sources);
+      while (g_hash_table_iter_next (&iter, NULL, &value))
+        flush_source_update_ready_time_locked (value);
+    }
+
+  G_UNLOCK (flush_sources);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
 static GDBusInterfaceInfo *
 _g_dbus_interface_skeleton_get_info (GDBusInterface *interface_)
 {
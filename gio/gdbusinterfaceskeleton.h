@@ -100,6 +100,17 @@ GLIB_AVAILABLE_IN_ALL
 GVariant                    *g_dbus_interface_skeleton_get_properties  (GDBusInterfaceSkeleton      *interface_);
 GLIB_AVAILABLE_IN_ALL
 void                         g_dbus_interface_skeleton_flush           (GDBusInterfaceSkeleton      *interface_);
+GLIB_AVAILABLE_IN_2_54
+void                         g_dbus_interface_skeleton_schedule_flush  (GDBusInterfaceSkeleton      *interface_);
+GLIB_AVAILABLE_IN_2_54
+void                    g_dbus_interface_skeleton_set_flush_interval   (GDBusInterfaceSkeleton      *interface_,
+                                                                        guint                        interval);
+GLIB_AVAILABLE_IN_2_54
+guint                   g_dbus_interface_skeleton_get_flush_interval   (GDBusInterfaceSkeleton      *interface_);
+GLIB_AVAILABLE_IN_2_54
+void                    g_dbus_interface_skeleton_freeze_scheduled_flushes (void);
+GLIB_AVAILABLE_IN_2_54
+void                    g_dbus_interface_skeleton_thaw_scheduled_flushes   (void);
 
 GLIB_AVAILABLE_IN_ALL
 gboolean                     g_dbus_interface_skeleton_export          (GDBusInterfaceSkeleton      *interface_,
@@ -24,6 +24,7 @@
 #include <string.h>
 
 #include "gdbusintrospection.h"
+#include "gdbusprivate.h"
 
 #include "glibintl.h"
 
@@ -1874,19 +1875,19 @@ g_dbus_annotation_info_lookup (GDBusAnnotationInfo **annotations,
 
 G_LOCK_DEFINE_STATIC (info_cache_lock);
 
-typedef struct
+struct InfoCacheEntry
 {
   gint use_count;
 
   /* gchar* -> GDBusMethodInfo* */
   GHashTable *method_name_to_data;
 
-  /* gchar* -> GDBusMethodInfo* */
+  /* gchar* -> GDBusSignalInfo* */
   GHashTable *signal_name_to_data;
 
-  /* gchar* -> GDBusMethodInfo* */
+  /* gchar* -> GDBusPropertyInfo* */
   GHashTable *property_name_to_data;
-} InfoCacheEntry;
+};
 
 static void
 info_cache_free (InfoCacheEntry *cache)
@@ -2084,6 +2085,24 @@ g_dbus_interface_info_lookup_property (GDBusInterfaceInfo *info,
  */
 void
 g_dbus_interface_info_cache_build (GDBusInterfaceInfo *info)
+{
+  _g_dbus_interface_info_cache_build_entry (info);
+}
+
+/*
+ * _g_dbus_interface_info_cache_build_entry:
+ * @info: A #GDBusInterfaceInfo.
+ *
+ * Like g_dbus_interface_info_cache_build() but also returns the cache
+ * entry. The entry is immutable and stays valid until the matching
+ * g_dbus_interface_info_cache_release() so it can be used with
+ * _g_dbus_info_cache_entry_lookup_method() and friends without taking
+ * any lock.
+ *
+ * Returns: (transfer none): The cache entry for @info.
+ */
+InfoCacheEntry *
+_g_dbus_interface_info_cache_build_entry (GDBusInterfaceInfo *info)
 {
   InfoCacheEntry *cache;
   guint n;
@@ -2111,6 +2130,28 @@ g_dbus_interface_info_cache_build (GDBusInterfaceInfo *info)
   g_hash_table_insert (info_cache, info, cache);
  out:
   G_UNLOCK (info_cache_lock);
+  return cache;
+}
+
+GDBusMethodInfo *
+_g_dbus_info_cache_entry_lookup_method (InfoCacheEntry *cache,
+                                        const gchar    *name)
+{
+  return g_hash_table_lookup (cache->method_name_to_data, name);
+}
+
+GDBusSignalInfo *
+_g_dbus_info_cache_entry_lookup_signal (InfoCacheEntry *cache,
+                                        const gchar    *name)
+{
+  return g_hash_table_lookup (cache->signal_name_to_data, name);
+}
+
+GDBusPropertyInfo *
+_g_dbus_info_cache_entry_lookup_property (InfoCacheEntry *cache,
+                                          const gchar    *name)
+{
+  return g_hash_table_lookup (cache->property_name_to_data, name);
 }
 
 /**
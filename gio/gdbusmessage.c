@@ -62,8 +62,23 @@ struct _GMemoryBuffer
   gsize pos;
   gchar *data;
   GDataStreamByteOrder byte_order;
+  GBytes *bytes;
+  GArray *extents;
+  gsize extents_len;
 };
 
+/* If a GMemoryBuffer has @bytes (holding @data), values at least this
+ * big are sliced out of it instead of being copied.  Smaller ones are
+ * cheaper to copy, and copying them avoids keeping the whole message
+ * alive just for a small value.
+ *
+ * Likewise, if it has @extents, arrays of at least this size that are
+ * written to it are recorded there (as #GDBusMessageExtent) instead of
+ * being copied into @data.  @extents_len is their total size, so offsets
+ * in the serialised message are positions in @data plus @extents_len.
+ */
+#define ZERO_COPY_MIN_SIZE 256
+
 static gboolean
 g_memory_buffer_is_byteswapped (GMemoryBuffer *mbuf)
 {
@@ -74,6 +89,34 @@ g_memory_buffer_is_byteswapped (GMemoryBuffer *mbuf)
 #endif
 }
 
+static gboolean
+g_memory_buffer_can_slice (GMemoryBuffer  *mbuf,
+                           gconstpointer   data,
+                           gsize           size,
+                           gsize           alignment)
+{
+  return mbuf->bytes != NULL &&
+         size >= ZERO_COPY_MIN_SIZE &&
+         (GPOINTER_TO_SIZE (data) & (alignment - 1)) == 0;
+}
+
+/* returns a floating GVariant sharing @size bytes at @data */
+static GVariant *
+g_memory_buffer_slice_value (GMemoryBuffer       *mbuf,
+                             const GVariantType  *type,
+                             gconstpointer        data,
+                             gsize                size)
+{
+  GVariant *value;
+  GBytes *slice;
+
+  slice = g_bytes_new_from_bytes (mbuf->bytes, (const gchar *) data - mbuf->data, size);
+  value = g_variant_new_from_bytes (type, slice, TRUE);
+  g_bytes_unref (slice);
+
+  return value;
+}
+
 static guchar
 g_memory_buffer_read_byte (GMemoryBuffer  *mbuf)
 {
@@ -1565,7 +1608,10 @@ parse_value_from_blob (GMemoryBuffer       *buf,
           v = read_string (buf, (gsize) len, &local_error);
           if (v == NULL)
             goto fail;
-          ret = g_variant_new_string (v);
+          if (g_memory_buffer_can_slice (buf, v, len, 1) && memchr (v, '\0', len) == NULL)
+            ret = g_memory_buffer_slice_value (buf, type, v, len + 1);
+          else
+            ret = g_variant_new_string (v);
         }
       break;
 
@@ -1588,7 +1634,10 @@ parse_value_from_blob (GMemoryBuffer       *buf,
                            v);
               goto fail;
             }
-          ret = g_variant_new_object_path (v);
+          if (g_memory_buffer_can_slice (buf, v, len, 1) && memchr (v, '\0', len) == NULL)
+            ret = g_memory_buffer_slice_value (buf, type, v, len + 1);
+          else
+            ret = g_variant_new_object_path (v);
         }
       break;
 
@@ -1684,7 +1733,11 @@ parse_value_from_blob (GMemoryBuffer       *buf,
               if (array_data == NULL)
                 goto fail;
 
-              ret = g_variant_new_fixed_array (element_type, array_data, array_len / fixed_size, fixed_size);
+              if (!g_memory_buffer_is_byteswapped (buf) &&
+                  g_memory_buffer_can_slice (buf, array_data, array_len, fixed_size))
+                ret = g_memory_buffer_slice_value (buf, type, array_data, array_len);
+              else
+                ret = g_variant_new_fixed_array (element_type, array_data, array_len / fixed_size, fixed_size);
 
               if (g_memory_buffer_is_byteswapped (buf))
                 {
@@ -1986,27 +2039,12 @@ g_dbus_message_bytes_needed (guchar  *blob,
 
 /* ---------------------------------------------------------------------------------------------------- */
 
-/**
- * g_dbus_message_new_from_blob:
- * @blob: (array length=blob_len) (element-type guint8): A blob represent a binary D-Bus message.
- * @blob_len: The length of @blob.
- * @capabilities: A #GDBusCapabilityFlags describing what protocol features are supported.
- * @error: Return location for error or %NULL.
- *
- * Creates a new #GDBusMessage from the data stored at @blob. The byte
- * order that the message was in can be retrieved using
- * g_dbus_message_get_byte_order().
- *
- * Returns: A new #GDBusMessage or %NULL if @error is set. Free with
- * g_object_unref().
- *
- * Since: 2.26
- */
-GDBusMessage *
-g_dbus_message_new_from_blob (guchar                *blob,
-                              gsize                  blob_len,
-                              GDBusCapabilityFlags   capabilities,
-                              GError               **error)
+static GDBusMessage *
+message_new_from_buffer (guchar                *blob,
+                         gsize                  blob_len,
+                         GBytes                *bytes,
+                         GDBusCapabilityFlags   capabilities,
+                         GError               **error)
 {
   gboolean ret;
   GMemoryBuffer mbuf;
@@ -2023,15 +2061,12 @@ g_dbus_message_new_from_blob (guchar                *blob,
 
   ret = FALSE;
 
-  g_return_val_if_fail (blob != NULL, NULL);
-  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-  g_return_val_if_fail (blob_len >= 12, NULL);
-
   message = g_dbus_message_new ();
 
   memset (&mbuf, 0, sizeof (mbuf));
   mbuf.data = (gchar *)blob;
   mbuf.len = mbuf.valid_len = blob_len;
+  mbuf.bytes = bytes;
 
   endianness = g_memory_buffer_read_byte (&mbuf);
   switch (endianness)
@@ -2190,6 +2225,69 @@ g_dbus_message_new_from_blob (guchar                *blob,
     }
 }
 
+/**
+ * g_dbus_message_new_from_blob:
+ * @blob: (array length=blob_len) (element-type guint8): A blob represent a binary D-Bus message.
+ * @blob_len: The length of @blob.
+ * @capabilities: A #GDBusCapabilityFlags describing what protocol features are supported.
+ * @error: Return location for error or %NULL.
+ *
+ * Creates a new #GDBusMessage from the data stored at @blob. The byte
+ * order that the message was in can be retrieved using
+ * g_dbus_message_get_byte_order().
+ *
+ * Returns: A new #GDBusMessage or %NULL if @error is set. Free with
+ * g_object_unref().
+ *
+ * Since: 2.26
+ */
+GDBusMessage *
+g_dbus_message_new_from_blob (guchar                *blob,
+                              gsize                  blob_len,
+                              GDBusCapabilityFlags   capabilities,
+                              GError               **error)
+{
+  g_return_val_if_fail (blob != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+  g_return_val_if_fail (blob_len >= 12, NULL);
+
+  return message_new_from_buffer (blob, blob_len, NULL, capabilities, error);
+}
+
+/**
+ * g_dbus_message_new_from_bytes:
+ * @bytes: A #GBytes holding a binary D-Bus message.
+ * @capabilities: A #GDBusCapabilityFlags describing what protocol features are supported.
+ * @error: Return location for error or %NULL.
+ *
+ * Like g_dbus_message_new_from_blob(), but large strings, object paths
+ * and arrays of fixed-size numbers in the message body are not copied:
+ * the resulting #GVariant values refer to the data in @bytes (and keep
+ * it alive) instead.  Arrays are still copied if the message is not in
+ * host byte order.
+ *
+ * Returns: A new #GDBusMessage or %NULL if @error is set. Free with
+ * g_object_unref().
+ *
+ * Since: 2.54
+ */
+GDBusMessage *
+g_dbus_message_new_from_bytes (GBytes                *bytes,
+                               GDBusCapabilityFlags   capabilities,
+                               GError               **error)
+{
+  gconstpointer blob;
+  gsize blob_len;
+
+  g_return_val_if_fail (bytes != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  blob = g_bytes_get_data (bytes, &blob_len);
+  g_return_val_if_fail (blob_len >= 12, NULL);
+
+  return message_new_from_buffer ((guchar *) blob, blob_len, bytes, capabilities, error);
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 static gsize
@@ -2201,7 +2299,7 @@ ensure_output_padding (GMemoryBuffer  *mbuf,
   gsize padding_needed;
   guint n;
 
-  offset = mbuf->pos;
+  offset = mbuf->pos + mbuf->extents_len;
   wanted_offset = ((offset + padding_size - 1) / padding_size) * padding_size;
   padding_needed = wanted_offset - offset;
 
@@ -2393,7 +2491,7 @@ append_value_to_blob (GVariant            *value,
              * Thus, we need to count how much padding the first element
              * contributes and subtract that from the array length.
              */
-            array_payload_begin_offset = mbuf->valid_len;
+            array_payload_begin_offset = mbuf->valid_len + mbuf->extents_len;
 
             element_type = g_variant_type_element (type);
             fixed_size = get_type_fixed_size (element_type);
@@ -2421,7 +2519,17 @@ append_value_to_blob (GVariant            *value,
                 array_payload_begin_offset += ensure_output_padding (mbuf, fixed_size);
 
                 array_len = g_variant_get_size (use_value);
-                g_memory_buffer_write (mbuf, g_variant_get_data (use_value), array_len);
+                if (mbuf->extents != NULL && array_len >= ZERO_COPY_MIN_SIZE)
+                  {
+                    GDBusMessageExtent extent;
+
+                    extent.offset = mbuf->valid_len;
+                    extent.bytes = g_variant_get_data_as_bytes (use_value);
+                    g_array_append_val (mbuf->extents, extent);
+                    mbuf->extents_len += array_len;
+                  }
+                else
+                  g_memory_buffer_write (mbuf, g_variant_get_data (use_value), array_len);
                 g_variant_unref (use_value);
               }
             else
@@ -2451,7 +2559,7 @@ append_value_to_blob (GVariant            *value,
               }
 
             cur_offset = mbuf->valid_len;
-            array_len = cur_offset - array_payload_begin_offset;
+            array_len = cur_offset + mbuf->extents_len - array_payload_begin_offset;
             mbuf->pos = array_len_offset;
 
             g_memory_buffer_put_uint32 (mbuf, array_len);
@@ -2567,27 +2675,20 @@ append_body_to_blob (GVariant       *value,
 
 /* ---------------------------------------------------------------------------------------------------- */
 
-/**
- * g_dbus_message_to_blob:
- * @message: A #GDBusMessage.
- * @out_size: Return location for size of generated blob.
- * @capabilities: A #GDBusCapabilityFlags describing what protocol features are supported.
- * @error: Return location for error.
- *
- * Serializes @message to a blob. The byte order returned by
- * g_dbus_message_get_byte_order() will be used.
- *
- * Returns: (array length=out_size) (transfer full): A pointer to a
- * valid binary D-Bus message of @out_size bytes generated by @message
- * or %NULL if @error is set. Free with g_free().
- *
- * Since: 2.26
- */
-guchar *
-g_dbus_message_to_blob (GDBusMessage          *message,
-                        gsize                 *out_size,
-                        GDBusCapabilityFlags   capabilities,
-                        GError               **error)
+static void
+message_extent_clear (gpointer data)
+{
+  GDBusMessageExtent *extent = data;
+
+  g_bytes_unref (extent->bytes);
+}
+
+static guchar *
+message_to_buffer (GDBusMessage          *message,
+                   gsize                 *out_size,
+                   GDBusCapabilityFlags   capabilities,
+                   GArray               **out_extents,
+                   GError               **error)
 {
   GMemoryBuffer mbuf;
   guchar *ret;
@@ -2609,14 +2710,16 @@ g_dbus_message_to_blob (GDBusMessage          *message,
 
   ret = NULL;
 
-  g_return_val_if_fail (G_IS_DBUS_MESSAGE (message), NULL);
-  g_return_val_if_fail (out_size != NULL, NULL);
-  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-
   memset (&mbuf, 0, sizeof (mbuf));
   mbuf.len = MIN_ARRAY_SIZE;
   mbuf.data = g_malloc (mbuf.len);
 
+  if (out_extents != NULL)
+    {
+      mbuf.extents = g_array_new (FALSE, FALSE, sizeof (GDBusMessageExtent));
+      g_array_set_clear_func (mbuf.extents, message_extent_clear);
+    }
+
   mbuf.byte_order = G_DATA_STREAM_BYTE_ORDER_HOST_ENDIAN;
   switch (message->byte_order)
     {
@@ -2687,6 +2790,7 @@ g_dbus_message_to_blob (GDBusMessage          *message,
   ensure_output_padding (&mbuf, 8);
 
   body_start_offset = mbuf.valid_len;
+  g_assert (mbuf.extents_len == 0);
 
   signature = g_dbus_message_get_header (message, G_DBUS_MESSAGE_HEADER_FIELD_SIGNATURE);
   signature_str = NULL;
@@ -2735,7 +2839,7 @@ g_dbus_message_to_blob (GDBusMessage          *message,
 
   /* OK, we're done writing the message - set the body length */
   size = mbuf.valid_len;
-  body_size = size - body_start_offset;
+  body_size = size + mbuf.extents_len - body_start_offset;
 
   mbuf.pos = body_len_offset;
 
@@ -2744,13 +2848,81 @@ g_dbus_message_to_blob (GDBusMessage          *message,
   *out_size = size;
   ret = (guchar *)mbuf.data;
 
+  if (out_extents != NULL)
+    {
+      *out_extents = mbuf.extents;
+      mbuf.extents = NULL;
+    }
+
  out:
   if (ret == NULL)
     g_free (mbuf.data);
+  if (mbuf.extents != NULL)
+    g_array_unref (mbuf.extents);
 
   return ret;
 }
 
+/**
+ * g_dbus_message_to_blob:
+ * @message: A #GDBusMessage.
+ * @out_size: Return location for size of generated blob.
+ * @capabilities: A #GDBusCapabilityFlags describing what protocol features are supported.
+ * @error: Return location for error.
+ *
+ * Serializes @message to a blob. The byte order returned by
+ * g_dbus_message_get_byte_order() will be used.
+ *
+ * Returns: (array length=out_size) (transfer full): A pointer to a
+ * valid binary D-Bus message of @out_size bytes generated by @message
+ * or %NULL if @error is set. Free with g_free().
+ *
+ * Since: 2.26
+ */
+guchar *
+g_dbus_message_to_blob (GDBusMessage          *message,
+                        gsize                 *out_size,
+                        GDBusCapabilityFlags   capabilities,
+                        GError               **error)
+{
+  g_return_val_if_fail (G_IS_DBUS_MESSAGE (message), NULL);
+  g_return_val_if_fail (out_size != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  return message_to_buffer (message, out_size, capabilities, NULL, error);
+}
+
+/* < internal >
+ * _g_dbus_message_to_blob_with_extents:
+ * @message: A #GDBusMessage.
+ * @out_size: Return location for size of generated blob.
+ * @capabilities: A #GDBusCapabilityFlags describing what protocol features are supported.
+ * @out_extents: (out): Return location for a #GArray of #GDBusMessageExtent.
+ * @error: Return location for error.
+ *
+ * Like g_dbus_message_to_blob(), but large arrays of fixed-size numbers
+ * in the body are not copied into the blob.  Instead, they are returned
+ * in @out_extents.  Each extent holds the data that goes before the
+ * byte at its offset in the blob, so the message is the blob with all
+ * extents inserted.  The body length in the header includes them.
+ *
+ * Returns: the blob, or %NULL if @error is set. Free with g_free().
+ */
+guchar *
+_g_dbus_message_to_blob_with_extents (GDBusMessage          *message,
+                                      gsize                 *out_size,
+                                      GDBusCapabilityFlags   capabilities,
+                                      GArray               **out_extents,
+                                      GError               **error)
+{
+  g_return_val_if_fail (G_IS_DBUS_MESSAGE (message), NULL);
+  g_return_val_if_fail (out_size != NULL, NULL);
+  g_return_val_if_fail (out_extents != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  return message_to_buffer (message, out_size, capabilities, out_extents, error);
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 static guint32
@@ -54,7 +54,9 @@ typedef enum
   PREVIOUS_CALL_VANISHED,
 } PreviousCall;
 
-typedef struct
+typedef struct _Client Client;
+
+struct _Client
 {
   volatile gint             ref_count;
   guint                     id;
@@ -75,7 +77,16 @@ typedef struct
 
   gboolean                  cancelled;
   gboolean                  initialized;
-} Client;
+
+  /* Names watched together with g_bus_watch_names_on_connection()
+   * get a Client each, with @parent pointing to a Client for the whole
+   * group.  Only the group subscribes to NameOwnerChanged, and it looks
+   * up the member to update in @members_by_name.
+   */
+  Client                   *parent;
+  GPtrArray                *members;
+  GHashTable               *members_by_name;
+};
 
 /* Must be accessed atomically. */
 static volatile guint next_global_id = 1;
@@ -103,11 +114,17 @@ client_unref (Client *client)
             g_signal_handler_disconnect (client->connection, client->disconnected_signal_handler_id);
           g_object_unref (client->connection);
         }
+      if (client->members != NULL)
+        g_ptr_array_unref (client->members);
+      if (client->members_by_name != NULL)
+        g_hash_table_unref (client->members_by_name);
       g_free (client->name);
       g_free (client->name_owner);
       g_main_context_unref (client->main_context);
       if (client->user_data_free_func != NULL)
         client->user_data_free_func (client->user_data);
+      if (client->parent != NULL)
+        client_unref (client->parent);
       g_free (client);
     }
 }
@@ -266,11 +283,48 @@ on_connection_disconnected (GDBusConnection *connection,
   client->name_owner_changed_subscription_id = 0;
   client->connection = NULL;
 
-  call_vanished_handler (client, FALSE);
+  if (client->members != NULL)
+    {
+      guint i;
+
+      for (i = 0; i < client->members->len; i++)
+        {
+          Client *member = client->members->pdata[i];
+
+          g_clear_object (&member->connection);
+          call_vanished_handler (member, FALSE);
+        }
+    }
+  else
+    call_vanished_handler (client, FALSE);
 }
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+static void
+update_name_owner (Client      *client,
+                   const gchar *old_owner,
+                   const gchar *new_owner)
+{
+  if (!client->initialized)
+    return;
+
+  if ((old_owner != NULL && strlen (old_owner) > 0) && client->name_owner != NULL)
+    {
+      g_free (client->name_owner);
+      client->name_owner = NULL;
+      call_vanished_handler (client, FALSE);
+    }
+
+  if (new_owner != NULL && strlen (new_owner) > 0)
+    {
+      g_warn_if_fail (client->name_owner == NULL);
+      g_free (client->name_owner);
+      client->name_owner = g_strdup (new_owner);
+      call_appeared_handler (client);
+    }
+}
+
 static void
 on_name_owner_changed (GDBusConnection *connection,
                        const gchar      *sender_name,
@@ -285,13 +339,10 @@ on_name_owner_changed (GDBusConnection *connection,
   const gchar *old_owner;
   const gchar *new_owner;
 
-  if (!client->initialized)
-    goto out;
-
   if (g_strcmp0 (object_path, "/org/freedesktop/DBus") != 0 ||
       g_strcmp0 (interface_name, "org.freedesktop.DBus") != 0 ||
       g_strcmp0 (sender_name, "org.freedesktop.DBus") != 0)
-    goto out;
+    return;
 
   g_variant_get (parameters,
                  "(&s&s&s)",
@@ -299,27 +350,17 @@ on_name_owner_changed (GDBusConnection *connection,
                  &old_owner,
                  &new_owner);
 
-  /* we only care about a specific name */
-  if (g_strcmp0 (name, client->name) != 0)
-    goto out;
-
-  if ((old_owner != NULL && strlen (old_owner) > 0) && client->name_owner != NULL)
+  if (client->members_by_name != NULL)
     {
-      g_free (client->name_owner);
-      client->name_owner = NULL;
-      call_vanished_handler (client, FALSE);
-    }
-
-  if (new_owner != NULL && strlen (new_owner) > 0)
-    {
-      g_warn_if_fail (client->name_owner == NULL);
-      g_free (client->name_owner);
-      client->name_owner = g_strdup (new_owner);
-      call_appeared_handler (client);
+      client = g_hash_table_lookup (client->members_by_name, name);
+      if (client == NULL)
+        return;
     }
+  /* we only care about a specific name */
+  else if (g_strcmp0 (name, client->name) != 0)
+    return;
 
- out:
-  ;
+  update_name_owner (client, old_owner, new_owner);
 }
 
 /* ---------------------------------------------------------------------------------------------------- */
@@ -435,44 +476,207 @@ start_service_by_name_cb (GObject      *source_object,
   client_unref (client);
 }
 
+static void
+invoke_start_service_by_name (Client *client)
+{
+  g_dbus_connection_call (client->connection,
+                          "org.freedesktop.DBus",  /* bus name */
+                          "/org/freedesktop/DBus", /* object path */
+                          "org.freedesktop.DBus",  /* interface name */
+                          "StartServiceByName",    /* method name */
+                          g_variant_new ("(su)", client->name, 0),
+                          G_VARIANT_TYPE ("(u)"),
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1,
+                          NULL,
+                          (GAsyncReadyCallback) start_service_by_name_cb,
+                          client_ref (client));
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
+/* Finds the longest namespace containing all of @names, for a single
+ * arg0namespace match rule.  Returns %NULL if there is none.
+ */
+static gchar *
+get_common_namespace (const gchar * const *names)
+{
+  gsize len;
+  guint i;
+
+  if (names[0] == NULL || names[0][0] == ':')
+    return NULL;
+
+  len = strlen (names[0]);
+  for (i = 1; names[i] != NULL; i++)
+    {
+      gsize j;
+
+      if (names[i][0] == ':')
+        return NULL;
+
+      /* shorten to the last complete element both names share */
+      for (j = 0; j < len && names[i][j] == names[0][j]; j++)
+        ;
+      if (j < len || (names[i][j] != '\0' && names[i][j] != '.'))
+        {
+          while (j > 0 && names[0][j] != '.')
+            j--;
+        }
+      len = j;
+    }
+
+  if (len == 0)
+    return NULL;
+
+  return g_strndup (names[0], len);
+}
+
 static void
-has_connection (Client *client)
+list_names_cb (GObject      *source_object,
+               GAsyncResult *res,
+               gpointer      user_data)
 {
+  Client *client = user_data;
+  GHashTable *owned = NULL;
+  GVariant *result;
+  guint i;
+
+  result = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object),
+                                          res,
+                                          NULL);
+  if (result != NULL)
+    {
+      GVariantIter *iter;
+      const gchar *name;
+
+      owned = g_hash_table_new (g_str_hash, g_str_equal);
+      g_variant_get (result, "(as)", &iter);
+      while (g_variant_iter_next (iter, "&s", &name))
+        g_hash_table_add (owned, (gpointer) name);
+      g_variant_iter_free (iter);
+    }
+
+  if (client->members != NULL && client->connection != NULL)
+    {
+      for (i = 0; i < client->members->len; i++)
+        {
+          Client *member = client->members->pdata[i];
+
+          /* Only names that have an owner need a round trip to find
+           * out who it is; if ListNames failed, ask about all of them.
+           */
+          if (owned == NULL || g_hash_table_contains (owned, member->name))
+            invoke_get_name_owner (member);
+          else
+            {
+              call_vanished_handler (member, FALSE);
+              member->initialized = TRUE;
+            }
+        }
+    }
+
+  if (owned != NULL)
+    g_hash_table_unref (owned);
+  if (result != NULL)
+    g_variant_unref (result);
+  client_unref (client);
+}
+
+static void
+group_has_connection (Client *client)
+{
+  const gchar **names;
+  gchar *name_space;
+  guint i;
+
   /* listen for disconnection */
   client->disconnected_signal_handler_id = g_signal_connect (client->connection,
                                                              "closed",
                                                              G_CALLBACK (on_connection_disconnected),
                                                              client);
 
-  /* start listening to NameOwnerChanged messages immediately */
+  names = g_new (const gchar *, client->members->len + 1);
+  for (i = 0; i < client->members->len; i++)
+    {
+      Client *member = client->members->pdata[i];
+
+      member->connection = g_object_ref (client->connection);
+      names[i] = member->name;
+    }
+  names[i] = NULL;
+
+  /* one match rule for all the names */
+  name_space = get_common_namespace (names);
   client->name_owner_changed_subscription_id = g_dbus_connection_signal_subscribe (client->connection,
                                                                                    "org.freedesktop.DBus",  /* name */
                                                                                    "org.freedesktop.DBus",  /* if */
                                                                                    "NameOwnerChanged",      /* signal */
                                                                                    "/org/freedesktop/DBus", /* path */
-                                                                                   client->name,
-                                                                                   G_DBUS_SIGNAL_FLAGS_NONE,
+                                                                                   name_space,
+                                                                                   name_space != NULL ?
+                                                                                     G_DBUS_SIGNAL_FLAGS_MATCH_ARG0_NAMESPACE :
+                                                                                     G_DBUS_SIGNAL_FLAGS_NONE,
                                                                                    on_name_owner_changed,
                                                                                    client,
                                                                                    NULL);
+  g_free (name_space);
+  g_free (names);
 
   if (client->flags & G_BUS_NAME_WATCHER_FLAGS_AUTO_START)
     {
+      for (i = 0; i < client->members->len; i++)
+        invoke_start_service_by_name (client->members->pdata[i]);
+    }
+  else
+    {
+      /* find out which of the names have an owner in one call */
       g_dbus_connection_call (client->connection,
                               "org.freedesktop.DBus",  /* bus name */
                               "/org/freedesktop/DBus", /* object path */
                               "org.freedesktop.DBus",  /* interface name */
-                              "StartServiceByName",    /* method name */
-                              g_variant_new ("(su)", client->name, 0),
-                              G_VARIANT_TYPE ("(u)"),
+                              "ListNames",             /* method name */
+                              NULL,
+                              G_VARIANT_TYPE ("(as)"),
                               G_DBUS_CALL_FLAGS_NONE,
                               -1,
                               NULL,
-                              (GAsyncReadyCallback) start_service_by_name_cb,
+                              (GAsyncReadyCallback) list_names_cb,
                               client_ref (client));
     }
+}
+
+static void
+has_connection (Client *client)
+{
+  if (client->members != NULL)
+    {
+      group_has_connection (client);
+      return;
+    }
+
+  /* listen for disconnection */
+  client->disconnected_signal_handler_id = g_signal_connect (client->connection,
+                                                             "closed",
+                                                             G_CALLBACK (on_connection_disconnected),
+                                                             client);
+
+  /* start listening to NameOwnerChanged messages immediately */
+  client->name_owner_changed_subscription_id = g_dbus_connection_signal_subscribe (client->connection,
+                                                                                   "org.freedesktop.DBus",  /* name */
+                                                                                   "org.freedesktop.DBus",  /* if */
+                                                                                   "NameOwnerChanged",      /* signal */
+                                                                                   "/org/freedesktop/DBus", /* path */
+                                                                                   client->name,
+                                                                                   G_DBUS_SIGNAL_FLAGS_NONE,
+                                                                                   on_name_owner_changed,
+                                                                                   client,
+                                                                                   NULL);
+
+  if (client->flags & G_BUS_NAME_WATCHER_FLAGS_AUTO_START)
+    {
+      invoke_start_service_by_name (client);
+    }
   else
     {
       /* check owner */
@@ -491,7 +695,15 @@ connection_get_cb (GObject      *source_object,
   client->connection = g_bus_get_finish (res, NULL);
   if (client->connection == NULL)
     {
-      call_vanished_handler (client, FALSE);
+      if (client->members != NULL)
+        {
+          guint i;
+
+          for (i = 0; i < client->members->len; i++)
+            call_vanished_handler (client->members->pdata[i], FALSE);
+        }
+      else
+        call_vanished_handler (client, FALSE);
       goto out;
     }
 
@@ -651,6 +863,175 @@ guint g_bus_watch_name_on_connection (GDBusConnection          *connection,
   return client->id;
 }
 
+static Client *
+group_client_new (const gchar * const       *names,
+                  GBusNameWatcherFlags       flags,
+                  GBusNameAppearedCallback   name_appeared_handler,
+                  GBusNameVanishedCallback   name_vanished_handler,
+                  gpointer                   user_data,
+                  GDestroyNotify             user_data_free_func)
+{
+  Client *client;
+  guint i;
+
+  client = g_new0 (Client, 1);
+  client->ref_count = 1;
+  client->id = g_atomic_int_add (&next_global_id, 1); /* TODO: uh oh, handle overflow */
+  client->flags = flags;
+  client->user_data = user_data;
+  client->user_data_free_func = user_data_free_func;
+  client->main_context = g_main_context_ref_thread_default ();
+  client->members = g_ptr_array_new_with_free_func ((GDestroyNotify) client_unref);
+  client->members_by_name = g_hash_table_new (g_str_hash, g_str_equal);
+
+  for (i = 0; names[i] != NULL; i++)
+    {
+      Client *member;
+
+      if (g_hash_table_contains (client->members_by_name, names[i]))
+        continue;
+
+      member = g_new0 (Client, 1);
+      member->ref_count = 1;
+      member->name = g_strdup (names[i]);
+      member->flags = flags;
+      member->name_appeared_handler = name_appeared_handler;
+      member->name_vanished_handler = name_vanished_handler;
+      member->user_data = user_data;
+      member->main_context = g_main_context_ref (client->main_context);
+      member->parent = client_ref (client);
+
+      g_ptr_array_add (client->members, member);
+      g_hash_table_insert (client->members_by_name, member->name, member);
+    }
+
+  if (map_id_to_client == NULL)
+    map_id_to_client = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  g_hash_table_insert (map_id_to_client,
+                       GUINT_TO_POINTER (client->id),
+                       client);
+
+  return client;
+}
+
+static gboolean
+validate_names (const gchar * const *names)
+{
+  guint i;
+
+  for (i = 0; names[i] != NULL; i++)
+    {
+      if (!g_dbus_is_name (names[i]))
+        return FALSE;
+    }
+
+  return i > 0;
+}
+
+/**
+ * g_bus_watch_names:
+ * @bus_type: The type of bus to watch the names on.
+ * @names: (array zero-terminated=1): A %NULL-terminated array of names
+ *     (well-known or unique) to watch.
+ * @flags: Flags from the #GBusNameWatcherFlags enumeration.
+ * @name_appeared_handler: (nullable): Handler to invoke when one of @names is known to exist or %NULL.
+ * @name_vanished_handler: (nullable): Handler to invoke when one of @names is known to not exist or %NULL.
+ * @user_data: User data to pass to handlers.
+ * @user_data_free_func: (nullable): Function for freeing @user_data or %NULL.
+ *
+ * Like g_bus_watch_name(), but watches several names at once.  The
+ * handlers are called with the name that appeared or vanished, and
+ * the guarantees of g_bus_watch_name() hold for each name separately.
+ *
+ * This is a lot cheaper than watching each name on its own: a single
+ * match rule is used for all the names, and unless
+ * %G_BUS_NAME_WATCHER_FLAGS_AUTO_START is given, the owner is only
+ * looked up for names that currently have one.
+ *
+ * Returns: An identifier (never 0) that an be used with
+ * g_bus_unwatch_name() to stop watching all of the names.
+ *
+ * Since: 2.54
+ */
+guint
+g_bus_watch_names (GBusType                  bus_type,
+                   const gchar * const      *names,
+                   GBusNameWatcherFlags      flags,
+                   GBusNameAppearedCallback  name_appeared_handler,
+                   GBusNameVanishedCallback  name_vanished_handler,
+                   gpointer                  user_data,
+                   GDestroyNotify            user_data_free_func)
+{
+  Client *client;
+  guint id;
+
+  g_return_val_if_fail (names != NULL && validate_names (names), 0);
+
+  G_LOCK (lock);
+
+  client = group_client_new (names, flags,
+                             name_appeared_handler, name_vanished_handler,
+                             user_data, user_data_free_func);
+  id = client->id;
+
+  g_bus_get (bus_type,
+             NULL,
+             connection_get_cb,
+             client_ref (client));
+
+  G_UNLOCK (lock);
+
+  return id;
+}
+
+/**
+ * g_bus_watch_names_on_connection:
+ * @connection: A #GDBusConnection.
+ * @names: (array zero-terminated=1): A %NULL-terminated array of names
+ *     (well-known or unique) to watch.
+ * @flags: Flags from the #GBusNameWatcherFlags enumeration.
+ * @name_appeared_handler: (nullable): Handler to invoke when one of @names is known to exist or %NULL.
+ * @name_vanished_handler: (nullable): Handler to invoke when one of @names is known to not exist or %NULL.
+ * @user_data: User data to pass to handlers.
+ * @user_data_free_func: (nullable): Function for freeing @user_data or %NULL.
+ *
+ * Like g_bus_watch_names() but takes a #GDBusConnection instead of a
+ * #GBusType.
+ *
+ * Returns: An identifier (never 0) that an be used with
+ * g_bus_unwatch_name() to stop watching all of the names.
+ *
+ * Since: 2.54
+ */
+guint
+g_bus_watch_names_on_connection (GDBusConnection          *connection,
+                                 const gchar * const      *names,
+                                 GBusNameWatcherFlags      flags,
+                                 GBusNameAppearedCallback  name_appeared_handler,
+                                 GBusNameVanishedCallback  name_vanished_handler,
+                                 gpointer                  user_data,
+                                 GDestroyNotify            user_data_free_func)
+{
+  Client *client;
+
+  g_return_val_if_fail (G_IS_DBUS_CONNECTION (connection), 0);
+  g_return_val_if_fail (names != NULL && validate_names (names), 0);
+
+  G_LOCK (lock);
+
+  client = group_client_new (names, flags,
+                             name_appeared_handler, name_vanished_handler,
+                             user_data, user_data_free_func);
+  client->connection = g_object_ref (connection);
+
+  G_UNLOCK (lock);
+
+  has_connection (client);
+
+  return client->id;
+}
+
 typedef struct {
   GClosure *name_appeared_closure;
   GClosure *name_vanished_closure;
@@ -839,12 +1220,28 @@ g_bus_unwatch_name (guint watcher_id)
   client->cancelled = TRUE;
   g_warn_if_fail (g_hash_table_remove (map_id_to_client, GUINT_TO_POINTER (watcher_id)));
 
+  /* the members keep the group alive until they are done */
+  if (client->members != NULL)
+    {
+      guint i;
+
+      for (i = 0; i < client->members->len; i++)
+        ((Client *) client->members->pdata[i])->cancelled = TRUE;
+    }
+
  out:
   G_UNLOCK (lock);
 
   /* do callback without holding lock */
   if (client != NULL)
     {
+      if (client->members != NULL)
+        {
+          g_hash_table_unref (client->members_by_name);
+          client->members_by_name = NULL;
+          g_ptr_array_unref (client->members);
+          client->members = NULL;
+        }
       client_unref (client);
     }
 }
@@ -94,6 +94,22 @@ guint g_bus_watch_name_on_connection_with_closures (
                                       GBusNameWatcherFlags      flags,
                                       GClosure                 *name_appeared_closure,
                                       GClosure                 *name_vanished_closure);
+GLIB_AVAILABLE_IN_2_54
+guint g_bus_watch_names              (GBusType                  bus_type,
+                                      const gchar * const      *names,
+                                      GBusNameWatcherFlags      flags,
+                                      GBusNameAppearedCallback  name_appeared_handler,
+                                      GBusNameVanishedCallback  name_vanished_handler,
+                                      gpointer                  user_data,
+                                      GDestroyNotify            user_data_free_func);
+GLIB_AVAILABLE_IN_2_54
+guint g_bus_watch_names_on_connection (GDBusConnection          *connection,
+                                      const gchar * const      *names,
+                                      GBusNameWatcherFlags      flags,
+                                      GBusNameAppearedCallback  name_appeared_handler,
+                                      GBusNameVanishedCallback  name_vanished_handler,
+                                      gpointer                  user_data,
+                                      GDestroyNotify            user_data_free_func);
 GLIB_AVAILABLE_IN_ALL
 void  g_bus_unwatch_name             (guint                     watcher_id);
 
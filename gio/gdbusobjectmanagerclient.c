@@ -34,6 +34,7 @@
 #include "gdbusobjectproxy.h"
 #include "gdbusproxy.h"
 #include "gdbusinterface.h"
+#include "gdbuserror.h"
 
 #include "glibintl.h"
 
@@ -187,6 +188,11 @@ static void process_get_all_result (GDBusObjectManagerClient *manager,
                                     GVariant          *value,
                                     const gchar       *name_owner);
 
+static gboolean get_managed_objects (GDBusObjectManagerClient  *manager,
+                                     const gchar               *name_owner,
+                                     GCancellable              *cancellable,
+                                     GError                   **error);
+
 static void
 g_dbus_object_manager_client_finalize (GObject *object)
 {
@@ -1279,7 +1285,6 @@ on_notify_g_name_owner (GObject    *object,
   if (new_name_owner != NULL)
     {
       GError *error;
-      GVariant *value;
 
       //g_debug ("repopulating for %s", new_name_owner);
 
@@ -1287,14 +1292,7 @@ on_notify_g_name_owner (GObject    *object,
       subscribe_signals (manager,
                          new_name_owner);
       error = NULL;
-      value = g_dbus_proxy_call_sync (manager->priv->control_proxy,
-                                      "GetManagedObjects",
-                                      NULL, /* parameters */
-                                      G_DBUS_CALL_FLAGS_NONE,
-                                      -1,
-                                      NULL,
-                                      &error);
-      if (value == NULL)
+      if (!get_managed_objects (manager, new_name_owner, NULL, &error))
         {
           maybe_unsubscribe_signals (manager);
           g_warning ("Error calling GetManagedObjects() when name owner %s for name %s came back: %s",
@@ -1303,11 +1301,6 @@ on_notify_g_name_owner (GObject    *object,
                      error->message);
           g_error_free (error);
         }
-      else
-        {
-          process_get_all_result (manager, value, new_name_owner);
-          g_variant_unref (value);
-        }
 
       /* do the :name-owner notify *AFTER* emitting ::object-proxy-added signals - this
        * way the user knows that the signals were emitted because the name owner came back
@@ -1322,6 +1315,92 @@ on_notify_g_name_owner (GObject    *object,
   g_object_unref (manager);
 }
 
+/* number of objects to ask for per GetManagedObjectsPaged() call */
+#define GET_MANAGED_OBJECTS_PAGE_SIZE 1024
+
+static gboolean
+get_managed_objects (GDBusObjectManagerClient  *manager,
+                     const gchar               *name_owner,
+                     GCancellable              *cancellable,
+                     GError                   **error)
+{
+  GVariant *value;
+  gchar *start_after;
+  GError *local_error;
+
+  if (manager->priv->flags & G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_GET_OBJECTS_PAGED)
+    {
+      start_after = g_strdup ("");
+      do
+        {
+          gchar *next_start_after;
+
+          local_error = NULL;
+          value = g_dbus_connection_call_sync (manager->priv->connection,
+                                               name_owner,
+                                               manager->priv->object_path,
+                                               "org.gtk.GDBus.PagedObjectManager",
+                                               "GetManagedObjectsPaged",
+                                               g_variant_new ("(su)", start_after,
+                                                              GET_MANAGED_OBJECTS_PAGE_SIZE),
+                                               G_VARIANT_TYPE ("(a{oa{sa{sv}}}s)"),
+                                               G_DBUS_CALL_FLAGS_NONE,
+                                               -1,
+                                               cancellable,
+                                               &local_error);
+          if (value == NULL)
+            {
+              gboolean unsupported;
+
+              /* the remote object manager is not a GDBusObjectManagerServer
+               * (or an older one) - get everything in one go instead
+               */
+              unsupported = *start_after == '\0' &&
+                            (g_error_matches (local_error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD) ||
+                             g_error_matches (local_error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_INTERFACE));
+              g_free (start_after);
+              if (unsupported)
+                {
+                  g_error_free (local_error);
+                  goto not_paged;
+                }
+              g_propagate_error (error, local_error);
+              return FALSE;
+            }
+
+          g_free (start_after);
+          g_variant_get_child (value, 1, "s", &next_start_after);
+          start_after = next_start_after;
+
+          /* each page is processed as it arrives so only one page is
+           * held in memory at any time
+           */
+          process_get_all_result (manager, value, name_owner);
+          g_variant_unref (value);
+        }
+      while (*start_after != '\0');
+      g_free (start_after);
+
+      return TRUE;
+    }
+
+ not_paged:
+  value = g_dbus_proxy_call_sync (manager->priv->control_proxy,
+                                  "GetManagedObjects",
+                                  NULL, /* parameters */
+                                  G_DBUS_CALL_FLAGS_NONE,
+                                  -1,
+                                  cancellable,
+                                  error);
+  if (value == NULL)
+    return FALSE;
+
+  process_get_all_result (manager, value, name_owner);
+  g_variant_unref (value);
+
+  return TRUE;
+}
+
 static gboolean
 initable_init (GInitable     *initable,
                GCancellable  *cancellable,
@@ -1329,7 +1408,6 @@ initable_init (GInitable     *initable,
 {
   GDBusObjectManagerClient *manager = G_DBUS_OBJECT_MANAGER_CLIENT (initable);
   gboolean ret;
-  GVariant *value;
   GDBusProxyFlags proxy_flags;
 
   ret = FALSE;
@@ -1379,14 +1457,7 @@ initable_init (GInitable     *initable,
       /* yay, we can get the objects */
       subscribe_signals (manager,
                          manager->priv->name_owner);
-      value = g_dbus_proxy_call_sync (manager->priv->control_proxy,
-                                      "GetManagedObjects",
-                                      NULL, /* parameters */
-                                      G_DBUS_CALL_FLAGS_NONE,
-                                      -1,
-                                      cancellable,
-                                      error);
-      if (value == NULL)
+      if (!get_managed_objects (manager, manager->priv->name_owner, cancellable, error))
         {
           maybe_unsubscribe_signals (manager);
           g_warn_if_fail (g_signal_handlers_disconnect_by_func (manager->priv->control_proxy,
@@ -1396,9 +1467,6 @@ initable_init (GInitable     *initable,
           manager->priv->control_proxy = NULL;
           goto out;
         }
-
-      process_get_all_result (manager, value, manager->priv->name_owner);
-      g_variant_unref (value);
     }
 
   ret = TRUE;
@@ -48,6 +48,19 @@
  * clients can keep caches up to date by only listening to D-Bus
  * signals.
  *
+ * Since GLib 2.54 the object manager also implements the
+ * `org.gtk.GDBus.PagedObjectManager` interface next to
+ * `org.freedesktop.DBus.ObjectManager`. Its single method,
+ * `GetManagedObjectsPaged`, takes an object path to start after (or
+ * the empty string) and a maximum number of objects (or 0 for a
+ * default), and returns the same `a{oa{sa{sv}}}` dictionary as
+ * `GetManagedObjects` restricted to the next objects in object path
+ * order, along with the object path to pass in the next call (or the
+ * empty string when there are no more objects). This lets clients
+ * such as #GDBusObjectManagerClient with
+ * %G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_GET_OBJECTS_PAGED synchronize
+ * very large object trees without exceeding the message size limit.
+ *
  * The recommended path to export an object manager at is the path form of the
  * well-known name of a D-Bus service, or below. For example, if a D-Bus service
  * is available at the well-known name `net.example.ExampleService1`, the object
@@ -69,6 +82,7 @@ typedef struct
   GDBusObjectManagerServer *manager;
   GHashTable *map_iface_name_to_iface;
   gboolean exported;
+  GSequenceIter *sorted_iter;
 } RegistrationData;
 
 static void registration_data_free (RegistrationData *data);
@@ -95,7 +109,10 @@ struct _GDBusObjectManagerServerPrivate
   gchar *object_path;
   gchar *object_path_ending_in_slash;
   GHashTable *map_object_path_to_data;
+  /* object paths (owned) in the order used for paging */
+  GSequence *sorted_object_paths;
   guint manager_reg_id;
+  guint paged_manager_reg_id;
 };
 
 enum
@@ -124,6 +141,7 @@ g_dbus_object_manager_server_finalize (GObject *object)
       g_object_unref (manager->priv->connection);
     }
   g_hash_table_unref (manager->priv->map_object_path_to_data);
+  g_sequence_free (manager->priv->sorted_object_paths);
   g_free (manager->priv->object_path);
   g_free (manager->priv->object_path_ending_in_slash);
 
@@ -244,6 +262,7 @@ g_dbus_object_manager_server_init (GDBusObjectManagerServer *manager)
                                                                   g_str_equal,
                                                                   g_free,
                                                                   (GDestroyNotify) registration_data_free);
+  manager->priv->sorted_object_paths = g_sequence_new (g_free);
 }
 
 /**
@@ -454,6 +473,7 @@ registration_data_free (RegistrationData *data)
   g_signal_handlers_disconnect_by_func (data->object, G_CALLBACK (on_interface_removed), data);
   g_object_unref (data->object);
   g_hash_table_destroy (data->map_iface_name_to_iface);
+  g_sequence_remove (data->sorted_iter);
   g_free (data);
 }
 
@@ -518,6 +538,10 @@ g_dbus_object_manager_server_export_unlocked (GDBusObjectManagerServer  *manager
   g_hash_table_insert (manager->priv->map_object_path_to_data,
                        g_strdup (object_path),
                        data);
+  data->sorted_iter = g_sequence_insert_sorted (manager->priv->sorted_object_paths,
+                                                g_strdup (object_path),
+                                                (GCompareDataFunc) g_strcmp0,
+                                                NULL);
 }
 
 /**
@@ -824,6 +848,120 @@ static const GDBusInterfaceInfo manager_interface_info =
   (GDBusAnnotationInfo **) NULL
 };
 
+/* ---------- */
+
+static const GDBusArgInfo paged_manager_get_page_method_info_in_arg0 =
+{
+  -1,
+  "start_after",
+  "s",
+  (GDBusAnnotationInfo**) NULL,
+};
+
+static const GDBusArgInfo paged_manager_get_page_method_info_in_arg1 =
+{
+  -1,
+  "max_objects",
+  "u",
+  (GDBusAnnotationInfo**) NULL,
+};
+
+static const GDBusArgInfo * const paged_manager_get_page_method_info_in_arg_pointers[] =
+{
+  &paged_manager_get_page_method_info_in_arg0,
+  &paged_manager_get_page_method_info_in_arg1,
+  NULL
+};
+
+static const GDBusArgInfo paged_manager_get_page_method_info_out_arg1 =
+{
+  -1,
+  "next_start_after",
+  "s",
+  (GDBusAnnotationInfo**) NULL,
+};
+
+static const GDBusArgInfo * const paged_manager_get_page_method_info_out_arg_pointers[] =
+{
+  &manager_get_all_method_info_out_arg0,
+  &paged_manager_get_page_method_info_out_arg1,
+  NULL
+};
+
+static const GDBusMethodInfo paged_manager_get_page_method_info =
+{
+  -1,
+  "GetManagedObjectsPaged",
+  (GDBusArgInfo**) &paged_manager_get_page_method_info_in_arg_pointers,
+  (GDBusArgInfo**) &paged_manager_get_page_method_info_out_arg_pointers,
+  (GDBusAnnotationInfo**) NULL
+};
+
+static const GDBusMethodInfo * const paged_manager_method_info_pointers[] =
+{
+  &paged_manager_get_page_method_info,
+  NULL
+};
+
+static const GDBusInterfaceInfo paged_manager_interface_info =
+{
+  -1,
+  "org.gtk.GDBus.PagedObjectManager",
+  (GDBusMethodInfo **) paged_manager_method_info_pointers,
+  (GDBusSignalInfo **) NULL,
+  (GDBusPropertyInfo **) NULL,
+  (GDBusAnnotationInfo **) NULL
+};
+
+/* number of objects returned by GetManagedObjectsPaged() if the caller passes 0 */
+#define DEFAULT_PAGE_SIZE 256
+
+static gint
+compare_strings (gconstpointer a,
+                 gconstpointer b,
+                 gpointer      user_data)
+{
+  return g_strcmp0 (*(const gchar **) a, *(const gchar **) b);
+}
+
+/* must hold manager->priv->lock */
+static void
+add_managed_object (GVariantBuilder  *array_builder,
+                    RegistrationData *data)
+{
+  GVariantBuilder interfaces_builder;
+  GDBusInterfaceSkeleton *iface;
+  const gchar *iter_object_path;
+  const gchar **names;
+  guint n_names;
+  guint n;
+
+  /* list the interfaces by name, rather than in hash table order, so
+   * that the reply doesn't change from one call to the next
+   */
+  names = (const gchar **) g_hash_table_get_keys_as_array (data->map_iface_name_to_iface, &n_names);
+  g_qsort_with_data (names, n_names, sizeof (const gchar *), compare_strings, NULL);
+
+  g_variant_builder_init (&interfaces_builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+  for (n = 0; n < n_names; n++)
+    {
+      GVariant *properties;
+
+      iface = g_hash_table_lookup (data->map_iface_name_to_iface, names[n]);
+      properties = g_dbus_interface_skeleton_get_properties (iface);
+      g_variant_builder_add (&interfaces_builder, "{s@a{sv}}",
+                             g_dbus_interface_skeleton_get_info (iface)->name,
+                             properties);
+      g_variant_unref (properties);
+    }
+  g_free (names);
+  iter_object_path = g_dbus_object_get_object_path (G_DBUS_OBJECT (data->object));
+  g_variant_builder_add (array_builder,
+                         "{oa{sa{sv}}}",
+                         iter_object_path,
+                         &interfaces_builder);
+}
+
 static void
 manager_method_call (GDBusConnection       *connection,
                      const gchar           *sender,
@@ -836,43 +974,67 @@ manager_method_call (GDBusConnection       *connection,
 {
   GDBusObjectManagerServer *manager = G_DBUS_OBJECT_MANAGER_SERVER (user_data);
   GVariantBuilder array_builder;
-  GHashTableIter object_iter;
   RegistrationData *data;
 
   g_mutex_lock (&manager->priv->lock);
 
   if (g_strcmp0 (method_name, "GetManagedObjects") == 0)
     {
+      GSequenceIter *iter;
+
       g_variant_builder_init (&array_builder, G_VARIANT_TYPE ("a{oa{sa{sv}}}"));
-      g_hash_table_iter_init (&object_iter, manager->priv->map_object_path_to_data);
-      while (g_hash_table_iter_next (&object_iter, NULL, (gpointer) &data))
+      for (iter = g_sequence_get_begin_iter (manager->priv->sorted_object_paths);
+           !g_sequence_iter_is_end (iter);
+           iter = g_sequence_iter_next (iter))
         {
-          GVariantBuilder interfaces_builder;
-          GHashTableIter interface_iter;
-          GDBusInterfaceSkeleton *iface;
-          const gchar *iter_object_path;
-
-          g_variant_builder_init (&interfaces_builder, G_VARIANT_TYPE ("a{sa{sv}}"));
-          g_hash_table_iter_init (&interface_iter, data->map_iface_name_to_iface);
-          while (g_hash_table_iter_next (&interface_iter, NULL, (gpointer) &iface))
-            {
-              GVariant *properties = g_dbus_interface_skeleton_get_properties (iface);
-              g_variant_builder_add (&interfaces_builder, "{s@a{sv}}",
-                                     g_dbus_interface_skeleton_get_info (iface)->name,
-                                     properties);
-              g_variant_unref (properties);
-            }
-          iter_object_path = g_dbus_object_get_object_path (G_DBUS_OBJECT (data->object));
-          g_variant_builder_add (&array_builder,
-                                 "{oa{sa{sv}}}",
-                                 iter_object_path,
-                                 &interfaces_builder);
+          data = g_hash_table_lookup (manager->priv->map_object_path_to_data, g_sequence_get (iter));
+          add_managed_object (&array_builder, data);
         }
 
       g_dbus_method_invocation_return_value (invocation,
                                              g_variant_new ("(a{oa{sa{sv}}})",
                                                             &array_builder));
     }
+  else if (g_strcmp0 (method_name, "GetManagedObjectsPaged") == 0)
+    {
+      const gchar *start_after;
+      const gchar *next_start_after;
+      guint max_objects;
+      guint n;
+      GSequenceIter *iter;
+
+      g_variant_get (parameters, "(&su)", &start_after, &max_objects);
+      if (max_objects == 0)
+        max_objects = DEFAULT_PAGE_SIZE;
+
+      /* skip everything up to and including @start_after - the object
+       * there may have been removed since the previous page was built
+       */
+      iter = g_sequence_search (manager->priv->sorted_object_paths,
+                                (gpointer) start_after,
+                                (GCompareDataFunc) g_strcmp0,
+                                NULL);
+      while (!g_sequence_iter_is_end (iter) &&
+             g_strcmp0 (g_sequence_get (iter), start_after) <= 0)
+        iter = g_sequence_iter_next (iter);
+
+      g_variant_builder_init (&array_builder, G_VARIANT_TYPE ("a{oa{sa{sv}}}"));
+      next_start_after = "";
+      for (n = 0; n < max_objects && !g_sequence_iter_is_end (iter); n++)
+        {
+          next_start_after = g_sequence_get (iter);
+          data = g_hash_table_lookup (manager->priv->map_object_path_to_data, next_start_after);
+          add_managed_object (&array_builder, data);
+          iter = g_sequence_iter_next (iter);
+        }
+      if (g_sequence_iter_is_end (iter))
+        next_start_after = "";
+
+      g_dbus_method_invocation_return_value (invocation,
+                                             g_variant_new ("(a{oa{sa{sv}}}s)",
+                                                            &array_builder,
+                                                            next_start_after));
+    }
   else
     {
       g_dbus_method_invocation_return_error (invocation,
@@ -1085,6 +1247,7 @@ export_all (GDBusObjectManagerServer *manager)
 
   error = NULL;
   g_warn_if_fail (manager->priv->manager_reg_id == 0);
+  g_warn_if_fail (manager->priv->paged_manager_reg_id == 0);
   manager->priv->manager_reg_id = g_dbus_connection_register_object (manager->priv->connection,
                                                                      manager->priv->object_path,
                                                                      (GDBusInterfaceInfo *) &manager_interface_info,
@@ -1100,6 +1263,26 @@ export_all (GDBusObjectManagerServer *manager)
                  error->message);
       g_error_free (error);
     }
+  else
+    {
+      error = NULL;
+      manager->priv->paged_manager_reg_id =
+        g_dbus_connection_register_object (manager->priv->connection,
+                                           manager->priv->object_path,
+                                           (GDBusInterfaceInfo *) &paged_manager_interface_info,
+                                           &manager_interface_vtable,
+                                           manager,
+                                           NULL, /* user_data_free_func */
+                                           &error);
+      if (manager->priv->paged_manager_reg_id == 0)
+        {
+          g_warning ("%s: Error registering paged manager at %s: %s",
+                     G_STRLOC,
+                     manager->priv->object_path,
+                     error->message);
+          g_error_free (error);
+        }
+    }
 
   g_hash_table_iter_init (&iter, manager->priv->map_object_path_to_data);
   while (g_hash_table_iter_next (&iter, (gpointer) &object_path, (gpointer) &data))
@@ -1142,6 +1325,12 @@ unexport_all (GDBusObjectManagerServer *manager, gboolean only_manager)
                                                            manager->priv->manager_reg_id));
       manager->priv->manager_reg_id = 0;
     }
+  if (manager->priv->paged_manager_reg_id > 0)
+    {
+      g_warn_if_fail (g_dbus_connection_unregister_object (manager->priv->connection,
+                                                           manager->priv->paged_manager_reg_id));
+      manager->priv->paged_manager_reg_id = 0;
+    }
   if (only_manager)
     goto out;
 
@@ -22,6 +22,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
 #include "giotypes.h"
 #include "gsocket.h"
@@ -238,6 +239,7 @@ ensure_required_types (void)
 typedef struct
 {
   volatile gint refcount;
+  guint index;
   GThread *thread;
   GMainContext *context;
   GMainLoop *loop;
@@ -252,54 +254,106 @@ gdbus_shared_thread_func (gpointer user_data)
   g_main_loop_run (data->loop);
   g_main_context_pop_thread_default (data->context);
 
-  release_required_types ();
+  if (data->index == 0)
+    release_required_types ();
 
   return NULL;
 }
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+/* The workers of all connections are normally run in a single "gdbus"
+ * thread. G_DBUS_WORKER_THREADS can be set to spread them over several
+ * threads instead; each worker stays in the thread it started in, so
+ * messages on a connection are still handled in order.
+ */
+#define MAX_SHARED_THREADS 64
+
+G_LOCK_DEFINE_STATIC (shared_threads);
+static SharedThreadData *shared_threads[MAX_SHARED_THREADS];
+static guint n_shared_threads;
+static guint max_shared_threads;
+
+static SharedThreadData *
+shared_thread_data_new (guint index)
+{
+  SharedThreadData *data;
+  gchar *name;
+
+  data = g_new0 (SharedThreadData, 1);
+  data->refcount = 0;
+  data->index = index;
+
+  if (index == 0)
+    name = g_strdup ("gdbus");
+  else
+    name = g_strdup_printf ("gdbus-%u", index);
+
+  data->context = g_main_context_new ();
+  data->loop = g_main_loop_new (data->context, FALSE);
+  data->thread = g_thread_new (name,
+                               gdbus_shared_thread_func,
+                               data);
+  g_free (name);
+
+  return data;
+}
+
 static SharedThreadData *
 _g_dbus_shared_thread_ref (void)
 {
-  static gsize shared_thread_data = 0;
   SharedThreadData *ret;
+  guint n;
 
-  if (g_once_init_enter (&shared_thread_data))
+  G_LOCK (shared_threads);
+
+  if (max_shared_threads == 0)
     {
-      SharedThreadData *data;
-
-      data = g_new0 (SharedThreadData, 1);
-      data->refcount = 0;
-      
-      data->context = g_main_context_new ();
-      data->loop = g_main_loop_new (data->context, FALSE);
-      data->thread = g_thread_new ("gdbus",
-                                   gdbus_shared_thread_func,
-                                   data);
-      /* We can cast between gsize and gpointer safely */
-      g_once_init_leave (&shared_thread_data, (gsize) data);
+      const gchar *threads;
+
+      max_shared_threads = 1;
+      threads = g_getenv ("G_DBUS_WORKER_THREADS");
+      if (threads != NULL)
+        max_shared_threads = CLAMP (g_ascii_strtoull (threads, NULL, 10), 1, MAX_SHARED_THREADS);
+    }
+
+  /* use the least busy thread, or start another one if they are all busy */
+  ret = NULL;
+  for (n = 0; n < n_shared_threads; n++)
+    {
+      if (ret == NULL || g_atomic_int_get (&shared_threads[n]->refcount) < g_atomic_int_get (&ret->refcount))
+        ret = shared_threads[n];
+    }
+
+  if (ret == NULL || (g_atomic_int_get (&ret->refcount) > 0 && n_shared_threads < max_shared_threads))
+    {
+      ret = shared_thread_data_new (n_shared_threads);
+      shared_threads[n_shared_threads++] = ret;
     }
 
-  ret = (SharedThreadData*) shared_thread_data;
   g_atomic_int_inc (&ret->refcount);
+
+  G_UNLOCK (shared_threads);
+
   return ret;
 }
 
 static void
 _g_dbus_shared_thread_unref (SharedThreadData *data)
 {
-  /* TODO: actually destroy the shared thread here */
-#if 0
   g_assert (data != NULL);
+
+  /* the count is what _g_dbus_shared_thread_ref() balances the load by */
   if (g_atomic_int_dec_and_test (&data->refcount))
     {
+      /* TODO: actually destroy the shared thread here */
+#if 0
       g_main_loop_quit (data->loop);
       //g_thread_join (data->thread);
       g_main_loop_unref (data->loop);
       g_main_context_unref (data->context);
-    }
 #endif
+    }
 }
 
 /* ---------------------------------------------------------------------------------------------------- */
@@ -311,6 +365,11 @@ typedef enum {
     PENDING_CLOSE
 } OutputPending;
 
+/* received messages at least this big are parsed from their own buffer,
+ * see _g_dbus_worker_do_read_cb()
+ */
+#define READ_BUFFER_HANDOVER_SIZE 4096
+
 struct GDBusWorker
 {
   volatile gint                       ref_count;
@@ -360,6 +419,10 @@ struct GDBusWorker
   GQueue                             *write_queue;
   /* protected by write_lock */
   guint64                             write_num_messages_written;
+  /* number of messages in the write that is in progress, if any;
+   * protected by write_lock
+   */
+  guint                               write_num_messages_in_flight;
   /* number of messages we'd written out last time we flushed;
    * protected by write_lock
    */
@@ -714,18 +777,40 @@ _g_dbus_worker_do_read_cb (GInputStream  *input_stream,
       else
         {
           GDBusMessage *message;
+          GBytes *bytes = NULL;
+          const gchar *blob;
           error = NULL;
 
           /* TODO: use connection->priv->auth to decode the message */
 
-          message = g_dbus_message_new_from_blob ((guchar *) worker->read_buffer,
-                                                  worker->read_buffer_cur_size,
-                                                  worker->capabilities,
-                                                  &error);
+          /* Big messages take the read buffer with them, so that large
+           * values in the body can refer to it instead of being copied.
+           * A new buffer is allocated for the next message.
+           */
+          if (worker->read_buffer_cur_size >= READ_BUFFER_HANDOVER_SIZE)
+            {
+              bytes = g_bytes_new_take (worker->read_buffer, worker->read_buffer_cur_size);
+              worker->read_buffer = NULL;
+              worker->read_buffer_allocated_size = 0;
+
+              blob = g_bytes_get_data (bytes, NULL);
+              message = g_dbus_message_new_from_bytes (bytes,
+                                                       worker->capabilities,
+                                                       &error);
+            }
+          else
+            {
+              blob = worker->read_buffer;
+              message = g_dbus_message_new_from_blob ((guchar *) worker->read_buffer,
+                                                      worker->read_buffer_cur_size,
+                                                      worker->capabilities,
+                                                      &error);
+            }
+
           if (message == NULL)
             {
               gchar *s;
-              s = _g_dbus_hexdump (worker->read_buffer, worker->read_buffer_cur_size, 2);
+              s = _g_dbus_hexdump (blob, worker->read_buffer_cur_size, 2);
               g_warning ("Error decoding D-Bus message of %" G_GSIZE_FORMAT " bytes\n"
                          "The error is: %s\n"
                          "The payload is as follows:\n"
@@ -736,6 +821,8 @@ _g_dbus_worker_do_read_cb (GInputStream  *input_stream,
               g_free (s);
               _g_dbus_worker_emit_disconnected (worker, FALSE, error);
               g_error_free (error);
+              if (bytes != NULL)
+                g_bytes_unref (bytes);
               goto out;
             }
 
@@ -761,7 +848,7 @@ _g_dbus_worker_do_read_cb (GInputStream  *input_stream,
               g_free (s);
               if (G_UNLIKELY (_g_dbus_debug_payload ()))
                 {
-                  s = _g_dbus_hexdump (worker->read_buffer, worker->read_buffer_cur_size, 2);
+                  s = _g_dbus_hexdump (blob, worker->read_buffer_cur_size, 2);
                   g_print ("%s\n", s);
                   g_free (s);
                 }
@@ -771,6 +858,9 @@ _g_dbus_worker_do_read_cb (GInputStream  *input_stream,
           /* yay, got a message, go deliver it */
           _g_dbus_worker_queue_or_deliver_received_message (worker, message);
 
+          if (bytes != NULL)
+            g_bytes_unref (bytes);
+
           /* start reading another message! */
           worker->read_buffer_bytes_wanted = 0;
           worker->read_buffer_cur_size = 0;
@@ -853,17 +943,139 @@ _g_dbus_worker_do_initial_read (gpointer data)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+/* sendmsg() refuses more than IOV_MAX vectors at a time */
+#if defined (IOV_MAX) && IOV_MAX < 1024
+#define MAX_WRITE_VECTORS IOV_MAX
+#else
+#define MAX_WRITE_VECTORS 1024
+#endif
+
+/* maximum number of queued messages sent in a single write, see
+ * G_DBUS_WRITE_BATCH_SIZE
+ */
+static guint _gdbus_write_batch_size = 64;
+
+/* milliseconds that exported menus and action groups wait to batch up
+ * changes, see G_DBUS_EXPORT_LATENCY
+ */
+static guint _gdbus_export_latency = 0;
+
 struct _MessageToWriteData
 {
   GDBusWorker  *worker;
   GDBusMessage *message;
   gchar        *blob;
   gsize         blob_size;
+  GArray       *extents;
+
+  /* the whole message: the blob, with the extents in between */
+  GOutputVector *vectors;
+  guint          n_vectors;
+  gsize          size;
+
+  /* messages written out in the same go as this one; their vectors
+   * are appended to ours, so @n_vectors and @size cover all of them
+   */
+  GPtrArray     *batch;
+  guint          n_message_vectors;
+  gsize          message_size;
+
+  /* whether the message-about-to-be-sent filters have been run */
+  gboolean       filtered;
+
+  /* vectors before this one have been written, and this one up to
+   * total_written
+   */
+  guint          cur_vector;
+  gsize          cur_vector_start;
 
   gsize         total_written;
   GTask        *task;
 };
 
+static void
+message_to_write_data_set_blob (MessageToWriteData *data,
+                                gchar              *blob,
+                                gsize               blob_size,
+                                GArray             *extents)
+{
+  gsize blob_offset;
+  guint n;
+
+  g_free (data->blob);
+  if (data->extents != NULL)
+    g_array_unref (data->extents);
+  g_free (data->vectors);
+
+  data->blob = blob;
+  data->blob_size = blob_size;
+  data->extents = extents;
+  data->vectors = g_new (GOutputVector, 2 * (extents ? extents->len : 0) + 1);
+  data->n_vectors = 0;
+  data->size = blob_size;
+
+  blob_offset = 0;
+  for (n = 0; extents != NULL && n < extents->len; n++)
+    {
+      GDBusMessageExtent *extent = &g_array_index (extents, GDBusMessageExtent, n);
+      GOutputVector *vector;
+
+      if (extent->offset > blob_offset)
+        {
+          vector = &data->vectors[data->n_vectors++];
+          vector->buffer = blob + blob_offset;
+          vector->size = extent->offset - blob_offset;
+          blob_offset = extent->offset;
+        }
+
+      vector = &data->vectors[data->n_vectors++];
+      vector->buffer = g_bytes_get_data (extent->bytes, &vector->size);
+      data->size += vector->size;
+    }
+
+  if (blob_size > blob_offset)
+    {
+      data->vectors[data->n_vectors].buffer = blob + blob_offset;
+      data->vectors[data->n_vectors].size = blob_size - blob_offset;
+      data->n_vectors++;
+    }
+
+  data->n_message_vectors = data->n_vectors;
+  data->message_size = data->size;
+}
+
+/* takes ownership of @other, which is written out right after @data */
+static void
+message_to_write_data_append (MessageToWriteData *data,
+                              MessageToWriteData *other)
+{
+  g_assert (other->batch == NULL);
+
+  data->vectors = g_renew (GOutputVector, data->vectors, data->n_vectors + other->n_vectors);
+  memcpy (data->vectors + data->n_vectors, other->vectors, other->n_vectors * sizeof (GOutputVector));
+  data->n_vectors += other->n_vectors;
+  data->size += other->size;
+
+  if (data->batch == NULL)
+    data->batch = g_ptr_array_new_with_free_func ((GDestroyNotify) message_to_write_data_free);
+  g_ptr_array_add (data->batch, other);
+}
+
+/* returns TRUE once everything has been written */
+static gboolean
+message_to_write_data_advance (MessageToWriteData *data,
+                               gsize               bytes_written)
+{
+  data->total_written += bytes_written;
+  g_assert (data->total_written <= data->size);
+
+  while (data->cur_vector < data->n_vectors &&
+         data->total_written >= data->cur_vector_start + data->vectors[data->cur_vector].size)
+    data->cur_vector_start += data->vectors[data->cur_vector++].size;
+
+  return data->total_written == data->size;
+}
+
 static void
 message_to_write_data_free (MessageToWriteData *data)
 {
@@ -871,6 +1083,11 @@ message_to_write_data_free (MessageToWriteData *data)
   if (data->message)
     g_object_unref (data->message);
   g_free (data->blob);
+  if (data->extents != NULL)
+    g_array_unref (data->extents);
+  g_free (data->vectors);
+  if (data->batch != NULL)
+    g_ptr_array_unref (data->batch);
   g_slice_free (MessageToWriteData, data);
 }
 
@@ -912,9 +1129,7 @@ write_message_async_cb (GObject      *source_object,
 
   write_message_print_transport_debug (bytes_written, data);
 
-  data->total_written += bytes_written;
-  g_assert (data->total_written <= data->blob_size);
-  if (data->total_written == data->blob_size)
+  if (message_to_write_data_advance (data, bytes_written))
     {
       g_task_return_boolean (task, TRUE);
       g_object_unref (task);
@@ -953,6 +1168,8 @@ static void
 write_message_continue_writing (MessageToWriteData *data)
 {
   GOutputStream *ostream;
+  const GOutputVector *cur_vector;
+  gsize cur_vector_written;
 #ifdef G_OS_UNIX
   GTask *task;
   GUnixFDList *fd_list;
@@ -971,24 +1188,34 @@ write_message_continue_writing (MessageToWriteData *data)
 #endif
 
   g_assert (!g_output_stream_has_pending (ostream));
-  g_assert_cmpint (data->total_written, <, data->blob_size);
+  g_assert_cmpint (data->total_written, <, data->size);
+
+  cur_vector = &data->vectors[data->cur_vector];
+  cur_vector_written = data->total_written - data->cur_vector_start;
 
   if (FALSE)
     {
     }
 #ifdef G_OS_UNIX
-  else if (G_IS_SOCKET_OUTPUT_STREAM (ostream) && data->total_written == 0)
+  else if (G_IS_SOCKET_OUTPUT_STREAM (ostream))
     {
-      GOutputVector vector;
+      GOutputVector *vectors;
+      guint n_vectors;
       GSocketControlMessage *control_message;
       gssize bytes_written;
       GError *error;
 
-      vector.buffer = data->blob;
-      vector.size = data->blob_size;
+      /* everything that is left, in one go */
+      n_vectors = MIN (data->n_vectors - data->cur_vector, MAX_WRITE_VECTORS);
+      vectors = g_newa (GOutputVector, n_vectors);
+      memcpy (vectors, cur_vector, n_vectors * sizeof (GOutputVector));
+      vectors[0].buffer = (const gchar *) vectors[0].buffer + cur_vector_written;
+      vectors[0].size -= cur_vector_written;
 
+      /* the file descriptors go with the first byte of the message */
       control_message = NULL;
-      if (fd_list != NULL && g_unix_fd_list_get_length (fd_list) > 0)
+      if (data->total_written == 0 &&
+          fd_list != NULL && g_unix_fd_list_get_length (fd_list) > 0)
         {
           if (!(data->worker->capabilities & G_DBUS_CAPABILITY_FLAGS_UNIX_FD_PASSING))
             {
@@ -1005,8 +1232,8 @@ write_message_continue_writing (MessageToWriteData *data)
       error = NULL;
       bytes_written = g_socket_send_message (data->worker->socket,
                                              NULL, /* address */
-                                             &vector,
-                                             1,
+                                             vectors,
+                                             n_vectors,
                                              control_message != NULL ? &control_message : NULL,
                                              control_message != NULL ? 1 : 0,
                                              G_SOCKET_MSG_NONE,
@@ -1041,9 +1268,7 @@ write_message_continue_writing (MessageToWriteData *data)
 
       write_message_print_transport_debug (bytes_written, data);
 
-      data->total_written += bytes_written;
-      g_assert (data->total_written <= data->blob_size);
-      if (data->total_written == data->blob_size)
+      if (message_to_write_data_advance (data, bytes_written))
         {
           g_task_return_boolean (task, TRUE);
           g_object_unref (task);
@@ -1069,8 +1294,8 @@ write_message_continue_writing (MessageToWriteData *data)
 #endif
 
       g_output_stream_write_async (ostream,
-                                   (const gchar *) data->blob + data->total_written,
-                                   data->blob_size - data->total_written,
+                                   (const gchar *) cur_vector->buffer + cur_vector_written,
+                                   cur_vector->size - cur_vector_written,
                                    G_PRIORITY_DEFAULT,
                                    data->worker->cancellable,
                                    write_message_async_cb,
@@ -1096,6 +1321,8 @@ write_message_async (GDBusWorker         *worker,
   data->task = g_task_new (NULL, NULL, callback, user_data);
   g_task_set_source_tag (data->task, write_message_async);
   data->total_written = 0;
+  data->cur_vector = 0;
+  data->cur_vector_start = 0;
   write_message_continue_writing (data);
 }
 
@@ -1220,13 +1447,22 @@ message_written_unlocked (GDBusWorker *worker,
       g_print ("========================================================================\n"
                "GDBus-debug:Message:\n"
                "  >>>> SENT D-Bus message (%" G_GSIZE_FORMAT " bytes)\n",
-               message_data->blob_size);
+               message_data->message_size);
       s = g_dbus_message_print (message_data->message, 2);
       g_print ("%s", s);
       g_free (s);
       if (G_UNLIKELY (_g_dbus_debug_payload ()))
         {
-          s = _g_dbus_hexdump (message_data->blob, message_data->blob_size, 2);
+          GString *payload;
+          guint n;
+
+          payload = g_string_sized_new (message_data->message_size);
+          for (n = 0; n < message_data->n_message_vectors; n++)
+            g_string_append_len (payload,
+                                 message_data->vectors[n].buffer,
+                                 message_data->vectors[n].size);
+          s = _g_dbus_hexdump (payload->str, payload->len, 2);
+          g_string_free (payload, TRUE);
           g_print ("%s\n", s);
           g_free (s);
         }
@@ -1256,7 +1492,8 @@ prepare_flush_unlocked (GDBusWorker *worker)
       FlushData *f = l->data;
       ll = l->next;
 
-      if (f->number_to_wait_for == worker->write_num_messages_written)
+      /* messages are written in batches, so we may have gone past it */
+      if (f->number_to_wait_for <= worker->write_num_messages_written)
         {
           flushers = g_list_append (flushers, f);
           worker->write_pending_flushes = g_list_delete_link (worker->write_pending_flushes, l);
@@ -1311,6 +1548,14 @@ write_message_cb (GObject       *source_object,
     }
 
   message_written_unlocked (data->worker, data);
+  if (data->batch != NULL)
+    {
+      guint n;
+
+      for (n = 0; n < data->batch->len; n++)
+        message_written_unlocked (data->worker, data->batch->pdata[n]);
+    }
+  data->worker->write_num_messages_in_flight = 0;
 
   g_mutex_unlock (&data->worker->write_lock);
 
@@ -1384,6 +1629,77 @@ iostream_close_cb (GObject      *source_object,
   _g_dbus_worker_unref (worker);
 }
 
+/* called in private thread shared by all GDBusConnection instances
+ *
+ * write-lock is not held on entry
+ *
+ * Runs the message-about-to-be-sent filters on @data, re-encoding
+ * the message if they changed it. Returns %FALSE if they dropped it.
+ */
+static gboolean
+message_to_write_data_run_filters (GDBusWorker        *worker,
+                                   MessageToWriteData *data)
+{
+  GDBusMessage *old_message;
+  guchar *new_blob;
+  gsize new_blob_size;
+  GArray *new_extents;
+  GError *error;
+
+  if (data->filtered)
+    return TRUE;
+  data->filtered = TRUE;
+
+  old_message = data->message;
+  data->message = _g_dbus_worker_emit_message_about_to_be_sent (worker, data->message);
+  if (data->message == old_message)
+    {
+      /* filters had no effect - do nothing */
+    }
+  else if (data->message == NULL)
+    {
+      /* filters dropped message */
+      return FALSE;
+    }
+  else
+    {
+      /* filters altered the message -> reencode */
+      error = NULL;
+      new_blob = _g_dbus_message_to_blob_with_extents (data->message,
+                                                       &new_blob_size,
+                                                       worker->capabilities,
+                                                       &new_extents,
+                                                       &error);
+      if (new_blob == NULL)
+        {
+          /* if filter make the GDBusMessage unencodeable, just complain on stderr and send
+           * the old message instead
+           */
+          g_warning ("Error encoding GDBusMessage with serial %d altered by filter function: %s",
+                     g_dbus_message_get_serial (data->message),
+                     error->message);
+          g_error_free (error);
+        }
+      else
+        message_to_write_data_set_blob (data, (gchar *) new_blob, new_blob_size, new_extents);
+    }
+
+  return TRUE;
+}
+
+static gboolean
+message_to_write_data_has_fds (MessageToWriteData *data)
+{
+#ifdef G_OS_UNIX
+  GUnixFDList *fd_list;
+
+  fd_list = g_dbus_message_get_unix_fd_list (data->message);
+  return fd_list != NULL && g_unix_fd_list_get_length (fd_list) > 0;
+#else
+  return FALSE;
+#endif
+}
+
 /* called in private thread shared by all GDBusConnection instances
  *
  * write-lock is not held on entry
@@ -1394,6 +1710,7 @@ continue_writing (GDBusWorker *worker)
 {
   MessageToWriteData *data;
   FlushAsyncData *flush_async_data;
+  GPtrArray *batch;
 
  write_next:
   /* we mustn't try to write two things at once */
@@ -1403,6 +1720,7 @@ continue_writing (GDBusWorker *worker)
 
   data = NULL;
   flush_async_data = NULL;
+  batch = NULL;
 
   /* if we want to close the connection, that takes precedence */
   if (worker->pending_close_attempts != NULL)
@@ -1428,7 +1746,24 @@ continue_writing (GDBusWorker *worker)
           data = g_queue_pop_head (worker->write_queue);
 
           if (data != NULL)
-            worker->output_pending = PENDING_WRITE;
+            {
+              MessageToWriteData *next;
+
+              worker->output_pending = PENDING_WRITE;
+
+              /* Take whatever else is queued up too, so that it all goes
+               * out in a single write. File descriptors arrive along with
+               * the first byte of a write, so only the first message of
+               * a batch may carry any.
+               */
+              batch = g_ptr_array_new ();
+              g_ptr_array_add (batch, data);
+              while (batch->len < _gdbus_write_batch_size &&
+                     (next = g_queue_peek_head (worker->write_queue)) != NULL &&
+                     !message_to_write_data_has_fds (next))
+                g_ptr_array_add (batch, g_queue_pop_head (worker->write_queue));
+              worker->write_num_messages_in_flight = batch->len;
+            }
         }
     }
 
@@ -1448,53 +1783,49 @@ continue_writing (GDBusWorker *worker)
       start_flush (flush_async_data);
       g_assert (data == NULL);
     }
-  else if (data != NULL)
+  else if (batch != NULL)
     {
-      GDBusMessage *old_message;
-      guchar *new_blob;
-      gsize new_blob_size;
-      GError *error;
+      guint n_dropped;
+      guint n;
 
-      old_message = data->message;
-      data->message = _g_dbus_worker_emit_message_about_to_be_sent (worker, data->message);
-      if (data->message == old_message)
-        {
-          /* filters had no effect - do nothing */
-        }
-      else if (data->message == NULL)
+      data = NULL;
+      n_dropped = 0;
+      for (n = 0; n < batch->len; n++)
         {
-          /* filters dropped message */
-          g_mutex_lock (&worker->write_lock);
-          worker->output_pending = PENDING_NONE;
-          g_mutex_unlock (&worker->write_lock);
-          message_to_write_data_free (data);
-          goto write_next;
-        }
-      else
-        {
-          /* filters altered the message -> reencode */
-          error = NULL;
-          new_blob = g_dbus_message_to_blob (data->message,
-                                             &new_blob_size,
-                                             worker->capabilities,
-                                             &error);
-          if (new_blob == NULL)
+          MessageToWriteData *next = batch->pdata[n];
+
+          if (!message_to_write_data_run_filters (worker, next))
             {
-              /* if filter make the GDBusMessage unencodeable, just complain on stderr and send
-               * the old message instead
-               */
-              g_warning ("Error encoding GDBusMessage with serial %d altered by filter function: %s",
-                         g_dbus_message_get_serial (data->message),
-                         error->message);
-              g_error_free (error);
+              message_to_write_data_free (next);
+              n_dropped++;
             }
-          else
+          else if (data == NULL)
+            data = next;
+          else if (message_to_write_data_has_fds (next))
             {
-              g_free (data->blob);
-              data->blob = (gchar *) new_blob;
-              data->blob_size = new_blob_size;
+              /* a filter attached file descriptors; send this one
+               * and everything after it separately
+               */
+              break;
             }
+          else
+            message_to_write_data_append (data, next);
+        }
+
+      if (n_dropped > 0 || n < batch->len)
+        {
+          g_mutex_lock (&worker->write_lock);
+          worker->write_num_messages_in_flight -= n_dropped + (batch->len - n);
+          while (batch->len > n)
+            g_queue_push_head (worker->write_queue, g_ptr_array_remove_index (batch, batch->len - 1));
+          if (data == NULL)
+            worker->output_pending = PENDING_NONE;
+          g_mutex_unlock (&worker->write_lock);
         }
+      g_ptr_array_unref (batch);
+
+      if (data == NULL)
+        goto write_next;
 
       write_message_async (worker,
                            data,
@@ -1581,7 +1912,7 @@ schedule_pending_close (GDBusWorker *worker)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
-/* can be called from any thread - steals blob
+/* can be called from any thread - steals blob and extents
  *
  * write_lock is not held on entry
  * output_pending may be anything
@@ -1590,7 +1921,8 @@ void
 _g_dbus_worker_send_message (GDBusWorker    *worker,
                              GDBusMessage   *message,
                              gchar          *blob,
-                             gsize           blob_len)
+                             gsize           blob_len,
+                             GArray         *extents)
 {
   MessageToWriteData *data;
 
@@ -1601,8 +1933,7 @@ _g_dbus_worker_send_message (GDBusWorker    *worker,
   data = g_slice_new0 (MessageToWriteData);
   data->worker = _g_dbus_worker_ref (worker);
   data->message = g_object_ref (message);
-  data->blob = blob; /* steal! */
-  data->blob_size = blob_len;
+  message_to_write_data_set_blob (data, blob, blob_len, extents); /* steal! */
 
   g_mutex_lock (&worker->write_lock);
   schedule_writing_unlocked (worker, data, NULL, NULL);
@@ -1748,7 +2079,7 @@ _g_dbus_worker_flush_sync (GDBusWorker    *worker,
    * flush operation that follows it
    */
   if (worker->output_pending == PENDING_WRITE)
-    pending_writes += 1;
+    pending_writes += worker->write_num_messages_in_flight;
 
   if (pending_writes > 0 ||
       worker->write_num_messages_written != worker->write_num_messages_flushed)
@@ -1888,6 +2219,7 @@ _g_dbus_debug_print_unlock (void)
  *
  *  - registering the G_DBUS_ERROR error domain
  *  - parses the G_DBUS_DEBUG environment variable
+ *  - parses the G_DBUS_WRITE_BATCH_SIZE environment variable
  */
 void
 _g_dbus_initialize (void)
@@ -1898,6 +2230,8 @@ _g_dbus_initialize (void)
     {
       volatile GQuark g_dbus_error_domain;
       const gchar *debug;
+      const gchar *batch_size;
+      const gchar *export_latency;
 
       g_dbus_error_domain = G_DBUS_ERROR;
       (g_dbus_error_domain); /* To avoid -Wunused-but-set-variable */
@@ -1923,6 +2257,14 @@ _g_dbus_initialize (void)
             _gdbus_debug_flags |= G_DBUS_DEBUG_MESSAGE;
         }
 
+      batch_size = g_getenv ("G_DBUS_WRITE_BATCH_SIZE");
+      if (batch_size != NULL)
+        _gdbus_write_batch_size = CLAMP (g_ascii_strtoull (batch_size, NULL, 10), 1, G_MAXUINT);
+
+      export_latency = g_getenv ("G_DBUS_EXPORT_LATENCY");
+      if (export_latency != NULL)
+        _gdbus_export_latency = MIN (g_ascii_strtoull (export_latency, NULL, 10), G_MAXUINT);
+
       /* Work-around for https://bugzilla.gnome.org/show_bug.cgi?id=627724 */
       ensure_required_types ();
 
@@ -1932,6 +2274,23 @@ _g_dbus_initialize (void)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+/* Creates the source that the menu and action group exporters use to
+ * send out the changes that have queued up: an idle source by default,
+ * or a timeout if G_DBUS_EXPORT_LATENCY is set.
+ */
+GSource *
+_g_dbus_export_source_new (void)
+{
+  _g_dbus_initialize ();
+
+  if (_gdbus_export_latency > 0)
+    return g_timeout_source_new (_gdbus_export_latency);
+
+  return g_idle_source_new ();
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
 GVariantType *
 _g_dbus_compute_complete_signature (GDBusArgInfo **args)
 {
@@ -2133,7 +2492,7 @@ write_message_print_transport_debug (gssize bytes_written,
            "       size %" G_GSIZE_FORMAT " from offset %" G_GSIZE_FORMAT " on a %s\n",
            bytes_written,
            g_dbus_message_get_serial (data->message),
-           data->blob_size,
+           data->size,
            data->total_written,
            g_type_name (G_TYPE_FROM_INSTANCE (g_io_stream_get_output_stream (data->worker->stream))));
   _g_dbus_debug_print_unlock ();
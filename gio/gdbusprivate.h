@@ -57,11 +57,12 @@ GDBusWorker *_g_dbus_worker_new          (GIOStream                          *st
                                           GDBusWorkerDisconnectedCallback     disconnected_callback,
                                           gpointer                            user_data);
 
-/* can be called from any thread - steals blob */
+/* can be called from any thread - steals blob and extents */
 void         _g_dbus_worker_send_message (GDBusWorker    *worker,
                                           GDBusMessage   *message,
                                           gchar          *blob,
-                                          gsize           blob_len);
+                                          gsize           blob_len,
+                                          GArray         *extents);
 
 /* can be called from any thread */
 void         _g_dbus_worker_stop         (GDBusWorker    *worker);
@@ -95,6 +96,8 @@ gboolean _g_dbus_debug_address (void);
 void     _g_dbus_debug_print_lock (void);
 void     _g_dbus_debug_print_unlock (void);
 
+GSource *_g_dbus_export_source_new (void);
+
 gboolean _g_dbus_address_parse_entry (const gchar  *address_entry,
                                       gchar       **out_transport_name,
                                       GHashTable  **out_key_value_pairs,
@@ -104,6 +107,21 @@ GVariantType * _g_dbus_compute_complete_signature (GDBusArgInfo **args);
 
 gchar *_g_dbus_hexdump (const gchar *data, gsize len, guint indent);
 
+/* data that goes before the byte at @offset of a serialised message,
+ * see _g_dbus_message_to_blob_with_extents()
+ */
+typedef struct
+{
+  gsize   offset;
+  GBytes *bytes;
+} GDBusMessageExtent;
+
+guchar *_g_dbus_message_to_blob_with_extents (GDBusMessage          *message,
+                                              gsize                 *out_size,
+                                              GDBusCapabilityFlags   capabilities,
+                                              GArray               **out_extents,
+                                              GError               **error);
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 #ifdef G_OS_WIN32
@@ -141,6 +159,17 @@ void _g_dbus_object_proxy_add_interface (GDBusObjectProxy *proxy,
 void _g_dbus_object_proxy_remove_interface (GDBusObjectProxy *proxy,
                                             const gchar      *interface_name);
 
+/* Implemented in gdbusintrospection.c */
+typedef struct InfoCacheEntry InfoCacheEntry;
+
+InfoCacheEntry    *_g_dbus_interface_info_cache_build_entry  (GDBusInterfaceInfo *info);
+GDBusMethodInfo   *_g_dbus_info_cache_entry_lookup_method    (InfoCacheEntry     *cache,
+                                                              const gchar        *name);
+GDBusSignalInfo   *_g_dbus_info_cache_entry_lookup_signal    (InfoCacheEntry     *cache,
+                                                              const gchar        *name);
+GDBusPropertyInfo *_g_dbus_info_cache_entry_lookup_property  (InfoCacheEntry     *cache,
+                                                              const gchar        *name);
+
 /* Implemented in gdbusconnection.c */
 GDBusConnection *_g_bus_get_singleton_if_exists (GBusType bus_type);
 
@@ -142,8 +142,13 @@ struct _GDBusProxyPrivate
   /* gchar* -> GVariant*, protected by properties_lock */
   GHashTable *properties;
 
+  /* gchar* set of properties fetched on demand, protected by properties_lock */
+  GHashTable *requested_properties;
+
   /* mutable, protected by properties_lock */
   GDBusInterfaceInfo *expected_interface;
+  /* lookup cache for expected_interface, protected by properties_lock */
+  InfoCacheEntry *expected_interface_cache;
 
   guint properties_changed_subscription_id;
   guint signals_subscription_id;
@@ -232,6 +237,8 @@ g_dbus_proxy_finalize (GObject *object)
   g_free (proxy->priv->interface_name);
   if (proxy->priv->properties != NULL)
     g_hash_table_unref (proxy->priv->properties);
+  if (proxy->priv->requested_properties != NULL)
+    g_hash_table_unref (proxy->priv->requested_properties);
 
   if (proxy->priv->expected_interface != NULL)
     {
@@ -639,6 +646,10 @@ g_dbus_proxy_init (GDBusProxy *proxy)
                                                    g_str_equal,
                                                    g_free,
                                                    (GDestroyNotify) g_variant_unref);
+  proxy->priv->requested_properties = g_hash_table_new_full (g_str_hash,
+                                                             g_str_equal,
+                                                             g_free,
+                                                             NULL);
 }
 
 /* ---------------------------------------------------------------------------------------------------- */
@@ -705,19 +716,84 @@ lookup_property_info (GDBusProxy  *proxy,
   if (proxy->priv->expected_interface == NULL)
     goto out;
 
-  info = g_dbus_interface_info_lookup_property (proxy->priv->expected_interface, property_name);
+  info = _g_dbus_info_cache_entry_lookup_property (proxy->priv->expected_interface_cache, property_name);
 
  out:
   return info;
 }
 
+static void insert_property_checked (GDBusProxy  *proxy,
+                                     gchar       *property_name,
+                                     GVariant    *value);
+
+/* must hold properties_lock; the lock is dropped while the remote
+ * object is queried and the value comes back borrowed from the cache
+ */
+static GVariant *
+get_property_on_demand (GDBusProxy  *proxy,
+                        const gchar *property_name)
+{
+  gchar *name_owner;
+  GVariant *result;
+  GVariant *value;
+
+  if (proxy->priv->name_owner == NULL && proxy->priv->name != NULL)
+    return NULL;
+
+  /* Only ask once; after this the property is tracked through
+   * PropertiesChanged like any other cached property.  If the remote
+   * object doesn't have it, the miss is remembered too.
+   */
+  g_hash_table_add (proxy->priv->requested_properties, g_strdup (property_name));
+  name_owner = g_strdup (proxy->priv->name_owner);
+
+  G_UNLOCK (properties_lock);
+  result = g_dbus_connection_call_sync (proxy->priv->connection,
+                                        name_owner,
+                                        proxy->priv->object_path,
+                                        "org.freedesktop.DBus.Properties",
+                                        "Get",
+                                        g_variant_new ("(ss)", proxy->priv->interface_name, property_name),
+                                        G_VARIANT_TYPE ("(v)"),
+                                        G_DBUS_CALL_FLAGS_NONE,
+                                        g_dbus_proxy_get_default_timeout (proxy),
+                                        NULL,         /* GCancellable */
+                                        NULL);        /* GError */
+  G_LOCK (properties_lock);
+
+  g_free (name_owner);
+
+  if (result == NULL)
+    return NULL;
+
+  /* A PropertiesChanged signal processed while the lock was dropped
+   * carries a newer value than our reply, so prefer that
+   */
+  value = g_hash_table_lookup (proxy->priv->properties, property_name);
+  if (value == NULL &&
+      g_hash_table_contains (proxy->priv->requested_properties, property_name))
+    {
+      g_variant_get (result, "(v)", &value);
+      insert_property_checked (proxy,
+                               g_strdup (property_name), /* adopts string */
+                               value); /* adopts value */
+      value = g_hash_table_lookup (proxy->priv->properties, property_name);
+    }
+  g_variant_unref (result);
+
+  return value;
+}
+
 /**
  * g_dbus_proxy_get_cached_property:
  * @proxy: A #GDBusProxy.
  * @property_name: Property name.
  *
  * Looks up the value for a property from the cache. This call does no
- * blocking IO.
+ * blocking IO, unless @proxy was constructed with
+ * %G_DBUS_PROXY_FLAGS_GET_PROPERTIES_ON_DEMAND and @property_name has
+ * not been looked up before, in which case the value is fetched
+ * synchronously from the remote object and cached.
  *
  * If @proxy has an expected interface (see
  * #GDBusProxy:g-interface-info) and @property_name is referenced by
@@ -742,6 +818,10 @@ g_dbus_proxy_get_cached_property (GDBusProxy   *proxy,
   G_LOCK (properties_lock);
 
   value = g_hash_table_lookup (proxy->priv->properties, property_name);
+  if (value == NULL &&
+      (proxy->priv->flags & G_DBUS_PROXY_FLAGS_GET_PROPERTIES_ON_DEMAND) &&
+      !g_hash_table_contains (proxy->priv->requested_properties, property_name))
+    value = get_property_on_demand (proxy, property_name);
   if (value == NULL)
     goto out;
 
@@ -891,7 +971,7 @@ on_signal_received (GDBusConnection *connection,
   if (proxy->priv->expected_interface != NULL)
     {
       const GDBusSignalInfo *info;
-      info = g_dbus_interface_info_lookup_signal (proxy->priv->expected_interface, signal_name);
+      info = _g_dbus_info_cache_entry_lookup_signal (proxy->priv->expected_interface_cache, signal_name);
       if (info != NULL)
         {
           GVariantType *expected_type;
@@ -937,7 +1017,7 @@ insert_property_checked (GDBusProxy  *proxy,
   if (proxy->priv->expected_interface != NULL)
     {
       const GDBusPropertyInfo *info;
-      info = g_dbus_interface_info_lookup_property (proxy->priv->expected_interface, property_name);
+      info = _g_dbus_info_cache_entry_lookup_property (proxy->priv->expected_interface_cache, property_name);
       /* Only check known properties */
       if (info != NULL)
         {
@@ -1092,9 +1172,19 @@ on_properties_changed (GDBusConnection *connection,
   g_variant_iter_init (&iter, changed_properties);
   while (g_variant_iter_next (&iter, "{sv}", &key, &value))
     {
-      insert_property_checked (proxy,
-			       key, /* adopts string */
-			       value); /* adopts value */
+      /* When loading on demand, only track what has been asked for */
+      if ((proxy->priv->flags & G_DBUS_PROXY_FLAGS_GET_PROPERTIES_ON_DEMAND) &&
+          !g_hash_table_contains (proxy->priv->requested_properties, key))
+        {
+          g_free (key);
+          g_variant_unref (value);
+        }
+      else
+        {
+          insert_property_checked (proxy,
+                                   key, /* adopts string */
+                                   value); /* adopts value */
+        }
       emit_g_signal = TRUE;
     }
 
@@ -1129,6 +1219,7 @@ on_properties_changed (GDBusConnection *connection,
       for (n = 0; invalidated_properties[n] != NULL; n++)
         {
           g_hash_table_remove (proxy->priv->properties, invalidated_properties[n]);
+          g_hash_table_remove (proxy->priv->requested_properties, invalidated_properties[n]);
         }
     }
 
@@ -1336,6 +1427,7 @@ on_name_owner_changed (GDBusConnection *connection,
 
           /* ... throw out the properties ... */
           g_hash_table_remove_all (proxy->priv->properties);
+          g_hash_table_remove_all (proxy->priv->requested_properties);
 
           G_UNLOCK (properties_lock);
 
@@ -1348,6 +1440,7 @@ on_name_owner_changed (GDBusConnection *connection,
         }
       else
         {
+          g_hash_table_remove_all (proxy->priv->requested_properties);
           G_UNLOCK (properties_lock);
         }
       g_object_notify (G_OBJECT (proxy), "g-name-owner");
@@ -1363,12 +1456,14 @@ on_name_owner_changed (GDBusConnection *connection,
           goto out;
         }
 
-      if (proxy->priv->flags & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES)
+      if (proxy->priv->flags & (G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES |
+                                G_DBUS_PROXY_FLAGS_GET_PROPERTIES_ON_DEMAND))
         {
           g_free (proxy->priv->name_owner);
           proxy->priv->name_owner = g_strdup (new_owner);
 
           g_hash_table_remove_all (proxy->priv->properties);
+          g_hash_table_remove_all (proxy->priv->requested_properties);
           G_UNLOCK (properties_lock);
           g_object_notify (G_OBJECT (proxy), "g-name-owner");
         }
@@ -1463,9 +1558,12 @@ async_init_data_set_name_owner (GTask       *task,
 
   get_all = TRUE;
 
-  if (proxy->priv->flags & G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES)
+  if (proxy->priv->flags & (G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES |
+                            G_DBUS_PROXY_FLAGS_GET_PROPERTIES_ON_DEMAND))
     {
-      /* Don't load properties if the API user doesn't want them */
+      /* Don't load properties if the API user doesn't want them, or
+       * wants them fetched one at a time when first looked at
+       */
       get_all = FALSE;
     }
   else if (name_owner == NULL && proxy->priv->name != NULL)
@@ -2493,8 +2591,9 @@ g_dbus_proxy_set_interface_info (GDBusProxy         *proxy,
       g_dbus_interface_info_unref (proxy->priv->expected_interface);
     }
   proxy->priv->expected_interface = info != NULL ? g_dbus_interface_info_ref (info) : NULL;
+  proxy->priv->expected_interface_cache = NULL;
   if (proxy->priv->expected_interface != NULL)
-    g_dbus_interface_info_cache_build (proxy->priv->expected_interface);
+    proxy->priv->expected_interface_cache = _g_dbus_interface_info_cache_build_entry (proxy->priv->expected_interface);
 
   G_UNLOCK (properties_lock);
 }
@@ -2604,7 +2703,7 @@ lookup_method_info (GDBusProxy  *proxy,
   if (proxy->priv->expected_interface == NULL)
     goto out;
 
-  info = g_dbus_interface_info_lookup_method (proxy->priv->expected_interface, method_name);
+  info = _g_dbus_info_cache_entry_lookup_method (proxy->priv->expected_interface_cache, method_name);
 
 out:
   return info;
@@ -144,6 +144,7 @@ typedef struct
   GHashTable                 *mime_tweaks;
   GHashTable                 *memory_index;
   GHashTable                 *memory_implementations;
+  GVariant                   *search_cache;
 } DesktopFileDir;
 
 static DesktopFileDir *desktop_file_dirs;
@@ -1031,27 +1032,391 @@ memory_index_new (void)
   return g_hash_table_new_full (g_str_hash, g_str_equal, g_free, memory_index_entry_free);
 }
 
+/* Search cache
+ *
+ * Building the search index means loading every desktop file in the
+ * directory, so the result is saved in the user's cache directory and
+ * mapped from there the next time, for as long as the desktop files
+ * (and the locale) stay the same.
+ *
+ * The cache is a GVariant of type SEARCH_CACHE_TYPE:
+ *
+ *   - a stamp identifying the contents it was built from
+ *   - the sorted names of the applications in the directory
+ *   - the search tokens, sorted, each with (application, category)
+ *     pairs, where application is an index into the names
+ *   - the implemented interfaces, sorted, with application indices
+ *
+ * It includes applications that are masked by other directories;
+ * those are filtered out at lookup time, as the other directories can
+ * change independently.
+ */
+
+#define SEARCH_CACHE_VERSION "1"
+#define SEARCH_CACHE_TYPE "(sasa(sa(uu))a(sau))"
+
+/* One cache per directory and locale */
+static gchar *
+desktop_file_dir_get_search_cache_filename (DesktopFileDir *dir)
+{
+  gchar *languages;
+  gchar *key;
+  gchar *hash;
+  gchar *filename;
+
+  languages = g_strjoinv (":", (gchar **) g_get_language_names ());
+  key = g_strconcat (dir->path, "\n", languages, NULL);
+  hash = g_compute_checksum_for_string (G_CHECKSUM_SHA256, key, -1);
+  filename = g_build_filename (g_get_user_cache_dir (), "gio", "desktop-search", hash, NULL);
+  g_free (hash);
+  g_free (key);
+  g_free (languages);
+
+  return filename;
+}
+
+static gint
+compare_strings (gconstpointer a,
+                 gconstpointer b)
+{
+  return strcmp (*(const gchar **) a, *(const gchar **) b);
+}
+
+/* Returns the keys of @table, sorted, in a %NULL-terminated array */
+static const gchar **
+get_sorted_keys (GHashTable *table,
+                 guint      *n_keys)
+{
+  const gchar **keys;
+
+  keys = (const gchar **) g_hash_table_get_keys_as_array (table, n_keys);
+  qsort (keys, *n_keys, sizeof (gchar *), compare_strings);
+
+  return keys;
+}
+
+/* Identifies the desktop files the index is built from by name, size,
+ * mtime and inode, along with the locale the values are taken in.
+ */
+static gchar *
+desktop_file_dir_get_search_cache_stamp (DesktopFileDir *dir)
+{
+  const gchar * const *languages;
+  const gchar **app_names;
+  GChecksum *checksum;
+  gchar *stamp;
+  guint n_apps;
+  guint i;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, (const guchar *) SEARCH_CACHE_VERSION G_STRINGIFY (G_BYTE_ORDER), -1);
+
+  languages = g_get_language_names ();
+  for (i = 0; languages[i]; i++)
+    g_checksum_update (checksum, (const guchar *) languages[i], strlen (languages[i]) + 1);
+
+  app_names = get_sorted_keys (dir->app_names, &n_apps);
+  for (i = 0; i < n_apps; i++)
+    {
+      const gchar *path = g_hash_table_lookup (dir->app_names, app_names[i]);
+      GStatBuf buf;
+
+      g_checksum_update (checksum, (const guchar *) app_names[i], strlen (app_names[i]) + 1);
+
+      if (g_stat (path, &buf) == 0)
+        {
+          guint64 values[3] = { buf.st_mtime, buf.st_size, buf.st_ino };
+
+          g_checksum_update (checksum, (const guchar *) values, sizeof values);
+        }
+    }
+  g_free (app_names);
+
+  stamp = g_strdup (g_checksum_get_string (checksum));
+  g_checksum_free (checksum);
+
+  return stamp;
+}
+
+static gboolean
+desktop_file_dir_load_search_cache (DesktopFileDir *dir,
+                                    const gchar    *stamp)
+{
+  GMappedFile *mapped;
+  const gchar *cached_stamp;
+  gchar *filename;
+  GVariant *cache;
+  GBytes *bytes;
+
+  filename = desktop_file_dir_get_search_cache_filename (dir);
+  mapped = g_mapped_file_new (filename, FALSE, NULL);
+  g_free (filename);
+
+  if (mapped == NULL)
+    return FALSE;
+
+  bytes = g_mapped_file_get_bytes (mapped);
+  g_mapped_file_unref (mapped);
+
+  /* Not trusted: it is just a file in the cache directory */
+  cache = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (SEARCH_CACHE_TYPE), bytes, FALSE));
+  g_bytes_unref (bytes);
+
+  g_variant_get_child (cache, 0, "&s", &cached_stamp);
+  if (!g_str_equal (cached_stamp, stamp))
+    {
+      g_variant_unref (cache);
+      return FALSE;
+    }
+
+  dir->search_cache = cache;
+
+  return TRUE;
+}
+
+static GVariant *
+memory_index_serialise (MemoryIndex *mi,
+                        GHashTable  *app_indices,
+                        gboolean     with_category)
+{
+  const gchar **tokens;
+  GVariantBuilder builder;
+  guint n_tokens;
+  guint i;
+
+  g_variant_builder_init (&builder, with_category ? G_VARIANT_TYPE ("a(sa(uu))") : G_VARIANT_TYPE ("a(sau)"));
+
+  tokens = get_sorted_keys (mi, &n_tokens);
+  for (i = 0; i < n_tokens; i++)
+    {
+      MemoryIndexEntry *mie;
+
+      g_variant_builder_open (&builder, with_category ? G_VARIANT_TYPE ("(sa(uu))") : G_VARIANT_TYPE ("(sau)"));
+      g_variant_builder_add (&builder, "s", tokens[i]);
+      g_variant_builder_open (&builder, with_category ? G_VARIANT_TYPE ("a(uu)") : G_VARIANT_TYPE ("au"));
+
+      for (mie = g_hash_table_lookup (mi, tokens[i]); mie; mie = mie->next)
+        {
+          guint index = GPOINTER_TO_UINT (g_hash_table_lookup (app_indices, mie->app_name)) - 1;
+
+          if (with_category)
+            g_variant_builder_add (&builder, "(uu)", index, (guint32) mie->match_category);
+          else
+            g_variant_builder_add (&builder, "u", index);
+        }
+
+      g_variant_builder_close (&builder);
+      g_variant_builder_close (&builder);
+    }
+  g_free (tokens);
+
+  return g_variant_builder_end (&builder);
+}
+
+static void
+desktop_file_dir_save_search_cache (DesktopFileDir *dir,
+                                    const gchar    *stamp)
+{
+  GHashTable *app_indices;
+  const gchar **app_names;
+  gchar *filename;
+  gchar *dirname;
+  GVariant *cache;
+  guint n_apps;
+  guint i;
+
+  app_names = get_sorted_keys (dir->app_names, &n_apps);
+
+  /* 1-based, so that lookups of missing names are distinguishable */
+  app_indices = g_hash_table_new (g_str_hash, g_str_equal);
+  for (i = 0; i < n_apps; i++)
+    g_hash_table_insert (app_indices, (gpointer) app_names[i], GUINT_TO_POINTER (i + 1));
+
+  cache = g_variant_ref_sink (g_variant_new ("(s^as@a(sa(uu))@a(sau))",
+                                             stamp, app_names,
+                                             memory_index_serialise (dir->memory_index, app_indices, TRUE),
+                                             memory_index_serialise (dir->memory_implementations, app_indices, FALSE)));
+
+  filename = desktop_file_dir_get_search_cache_filename (dir);
+  dirname = g_path_get_dirname (filename);
+
+  /* This is only a cache: if it cannot be written, we just build the
+   * index again next time.
+   */
+  if (g_mkdir_with_parents (dirname, 0700) == 0)
+    g_file_set_contents (filename, g_variant_get_data (cache), g_variant_get_size (cache), NULL);
+
+  g_free (dirname);
+  g_free (filename);
+  g_variant_unref (cache);
+  g_hash_table_unref (app_indices);
+  g_free (app_names);
+}
+
+/* Finds the first entry in a sorted cache table whose key is not less
+ * than @key.
+ */
+static gsize
+search_cache_table_lower_bound (GVariant    *table,
+                                const gchar *key)
+{
+  gsize lo = 0, hi = g_variant_n_children (table);
+
+  while (lo < hi)
+    {
+      gsize mid = lo + (hi - lo) / 2;
+      const gchar *mid_key;
+      GVariant *entry;
+      gint cmp;
+
+      entry = g_variant_get_child_value (table, mid);
+      g_variant_get_child (entry, 0, "&s", &mid_key);
+      cmp = strcmp (mid_key, key);
+      g_variant_unref (entry);
+
+      if (cmp < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+/* Maps an application index from the cache to the app_names key for
+ * that application, or %NULL if it is no longer there or masked.
+ */
+static const gchar *
+desktop_file_dir_search_cache_get_app (DesktopFileDir *dir,
+                                       GVariant       *apps,
+                                       guint32         index)
+{
+  const gchar *app_name;
+  gpointer key;
+
+  if (index >= g_variant_n_children (apps))
+    return NULL;
+
+  g_variant_get_child (apps, index, "&s", &app_name);
+
+  if (!g_hash_table_lookup_extended (dir->app_names, app_name, &key, NULL) ||
+      desktop_file_dir_app_name_is_masked (dir, key))
+    return NULL;
+
+  return key;
+}
+
+static void
+desktop_file_dir_search_cache_search (DesktopFileDir *dir,
+                                      const gchar    *search_token)
+{
+  GVariant *apps, *tokens;
+  gsize n_tokens;
+  gsize i;
+
+  apps = g_variant_get_child_value (dir->search_cache, 1);
+  tokens = g_variant_get_child_value (dir->search_cache, 2);
+  n_tokens = g_variant_n_children (tokens);
+
+  /* The tokens with @search_token as a prefix are all together */
+  for (i = search_cache_table_lower_bound (tokens, search_token); i < n_tokens; i++)
+    {
+      const gchar *token;
+      GVariantIter *iter;
+      guint32 index, category;
+
+      g_variant_get_child (tokens, i, "(&sa(uu))", &token, &iter);
+
+      if (!g_str_has_prefix (token, search_token))
+        {
+          g_variant_iter_free (iter);
+          break;
+        }
+
+      while (g_variant_iter_next (iter, "(uu)", &index, &category))
+        {
+          const gchar *app_name = desktop_file_dir_search_cache_get_app (dir, apps, index);
+
+          if (app_name)
+            add_token_result (app_name, category);
+        }
+
+      g_variant_iter_free (iter);
+    }
+
+  g_variant_unref (tokens);
+  g_variant_unref (apps);
+}
+
+static void
+desktop_file_dir_search_cache_get_implementations (DesktopFileDir  *dir,
+                                                   GList          **results,
+                                                   const gchar     *interface)
+{
+  GVariant *apps, *implementations;
+  gsize i;
+
+  apps = g_variant_get_child_value (dir->search_cache, 1);
+  implementations = g_variant_get_child_value (dir->search_cache, 3);
+
+  i = search_cache_table_lower_bound (implementations, interface);
+  if (i < g_variant_n_children (implementations))
+    {
+      const gchar *name;
+      GVariantIter *iter;
+      guint32 index;
+
+      g_variant_get_child (implementations, i, "(&sau)", &name, &iter);
+
+      while (g_str_equal (name, interface) && g_variant_iter_next (iter, "u", &index))
+        {
+          const gchar *app_name = desktop_file_dir_search_cache_get_app (dir, apps, index);
+
+          if (app_name)
+            *results = g_list_prepend (*results, g_strdup (app_name));
+        }
+
+      g_variant_iter_free (iter);
+    }
+
+  g_variant_unref (implementations);
+  g_variant_unref (apps);
+}
+
 static void
 desktop_file_dir_unindexed_setup_search (DesktopFileDir *dir)
 {
   GHashTableIter iter;
   gpointer app, path;
-
-  dir->memory_index = memory_index_new ();
-  dir->memory_implementations = memory_index_new ();
+  gchar *stamp;
 
   /* Nothing to search? */
   if (dir->app_names == NULL)
-    return;
+    {
+      dir->memory_index = memory_index_new ();
+      dir->memory_implementations = memory_index_new ();
+      return;
+    }
+
+  stamp = desktop_file_dir_get_search_cache_stamp (dir);
 
+  if (desktop_file_dir_load_search_cache (dir, stamp))
+    {
+      g_free (stamp);
+      return;
+    }
+
+  dir->memory_index = memory_index_new ();
+  dir->memory_implementations = memory_index_new ();
+
+  /* Masked applications are indexed too, for the sake of the cache;
+   * they are skipped when searching.
+   */
   g_hash_table_iter_init (&iter, dir->app_names);
   while (g_hash_table_iter_next (&iter, &app, &path))
     {
       GKeyFile *key_file;
 
-      if (desktop_file_dir_app_name_is_masked (dir, app))
-        continue;
-
       key_file = g_key_file_new ();
 
       if (g_key_file_load_from_file (key_file, path, G_KEY_FILE_NONE, NULL) &&
@@ -1102,6 +1467,9 @@ desktop_file_dir_unindexed_setup_search (DesktopFileDir *dir)
 
       g_key_file_free (key_file);
     }
+
+  desktop_file_dir_save_search_cache (dir, stamp);
+  g_free (stamp);
 }
 
 static void
@@ -1111,9 +1479,15 @@ desktop_file_dir_unindexed_search (DesktopFileDir  *dir,
   GHashTableIter iter;
   gpointer key, value;
 
-  if (!dir->memory_index)
+  if (!dir->memory_index && !dir->search_cache)
     desktop_file_dir_unindexed_setup_search (dir);
 
+  if (dir->search_cache)
+    {
+      desktop_file_dir_search_cache_search (dir, search_token);
+      return;
+    }
+
   g_hash_table_iter_init (&iter, dir->memory_index);
   while (g_hash_table_iter_next (&iter, &key, &value))
     {
@@ -1122,11 +1496,9 @@ desktop_file_dir_unindexed_search (DesktopFileDir  *dir,
       if (!g_str_has_prefix (key, search_token))
         continue;
 
-      while (mie)
-        {
+      for (; mie; mie = mie->next)
+        if (!desktop_file_dir_app_name_is_masked (dir, mie->app_name))
           add_token_result (mie->app_name, mie->match_category);
-          mie = mie->next;
-        }
     }
 }
 
@@ -1211,11 +1583,18 @@ desktop_file_dir_unindexed_get_implementations (DesktopFileDir  *dir,
 {
   MemoryIndexEntry *mie;
 
-  if (!dir->memory_index)
+  if (!dir->memory_index && !dir->search_cache)
     desktop_file_dir_unindexed_setup_search (dir);
 
+  if (dir->search_cache)
+    {
+      desktop_file_dir_search_cache_get_implementations (dir, results, interface);
+      return;
+    }
+
   for (mie = g_hash_table_lookup (dir->memory_implementations, interface); mie; mie = mie->next)
-    *results = g_list_prepend (*results, g_strdup (mie->app_name));
+    if (!desktop_file_dir_app_name_is_masked (dir, mie->app_name))
+      *results = g_list_prepend (*results, g_strdup (mie->app_name));
 }
 
 /* DesktopFileDir "API" {{{2 */
@@ -1307,6 +1686,8 @@ desktop_file_dir_reset (DesktopFileDir *dir)
       dir->memory_implementations = NULL;
     }
 
+  g_clear_pointer (&dir->search_cache, g_variant_unref);
+
   dir->is_setup = FALSE;
 }
 
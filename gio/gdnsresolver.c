@@ -0,0 +1,1375 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <glib.h>
+#include "glibintl.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "gdnsresolver.h"
+#include "gnetworkingprivate.h"
+
+#include "gcancellable.h"
+#include "ginetaddress.h"
+#include "ginetsocketaddress.h"
+#include "gioerror.h"
+#include "gsocket.h"
+#include "gsocketclient.h"
+#include "gsocketconnectable.h"
+#include "gsocketconnection.h"
+#include "gtask.h"
+
+#ifdef G_OS_UNIX
+
+/* GDnsResolver does asynchronous lookups by talking to the name
+ * servers from resolv.conf itself, from the caller's main context,
+ * rather than blocking a thread in getaddrinfo() or res_query() for
+ * each of them. Synchronous lookups are left to GThreadedResolver.
+ *
+ * It only implements the parts of the system resolver that matter for
+ * a stub resolver: the hosts file, the name servers, the search list
+ * and the ndots, timeout and attempts options. It does not use NSS, so
+ * names that only other NSS modules (mDNS, LDAP, ...) know about are
+ * not found.
+ */
+
+#define HOSTS_PATH "/etc/hosts"
+
+#define DNS_PORT        53
+#define DNS_HEADER_SIZE 12
+#define DNS_MAX_NAME    255
+#define DNS_MAX_UDP     512
+
+#define DNS_TYPE_A      1
+#define DNS_TYPE_PTR    12
+#define DNS_TYPE_AAAA   28
+#define DNS_CLASS_IN    1
+
+#define DNS_RCODE_NOERROR  0
+#define DNS_RCODE_FORMERR  1
+#define DNS_RCODE_SERVFAIL 2
+#define DNS_RCODE_NXDOMAIN 3
+#define DNS_RCODE_NOTIMP   4
+#define DNS_RCODE_REFUSED  5
+
+/* The limits from resolv.conf(5) */
+#define MAX_NAMESERVERS 3
+#define MAX_NDOTS       15
+#define MAX_TIMEOUT     30
+#define MAX_ATTEMPTS    5
+
+struct _DnsConfig {
+  gint ref_count;
+  GPtrArray *nameservers;  /* of GSocketAddress */
+  gchar **search;
+  guint ndots;
+  guint timeout;           /* in seconds, per attempt */
+  guint attempts;
+};
+
+static DnsConfig *
+dns_config_ref (DnsConfig *config)
+{
+  g_atomic_int_inc (&config->ref_count);
+  return config;
+}
+
+static void
+dns_config_unref (DnsConfig *config)
+{
+  if (g_atomic_int_dec_and_test (&config->ref_count))
+    {
+      g_ptr_array_unref (config->nameservers);
+      g_strfreev (config->search);
+      g_slice_free (DnsConfig, config);
+    }
+}
+
+static void
+parse_options (DnsConfig    *config,
+               gchar       **options)
+{
+  gint i;
+
+  for (i = 0; options[i] != NULL; i++)
+    {
+      if (g_str_has_prefix (options[i], "ndots:"))
+        config->ndots = MIN (atoi (options[i] + 6), MAX_NDOTS);
+      else if (g_str_has_prefix (options[i], "timeout:"))
+        config->timeout = CLAMP (atoi (options[i] + 8), 1, MAX_TIMEOUT);
+      else if (g_str_has_prefix (options[i], "attempts:"))
+        config->attempts = CLAMP (atoi (options[i] + 9), 1, MAX_ATTEMPTS);
+    }
+}
+
+static DnsConfig *
+dns_config_load (void)
+{
+  DnsConfig *config;
+  gchar *contents = NULL;
+  gchar **lines;
+  gint i;
+
+  config = g_slice_new0 (DnsConfig);
+  config->ref_count = 1;
+  config->nameservers = g_ptr_array_new_with_free_func (g_object_unref);
+  config->ndots = 1;
+  config->timeout = 5;
+  config->attempts = 2;
+
+  if (g_file_get_contents (_PATH_RESCONF, &contents, NULL, NULL))
+    {
+      lines = g_strsplit (contents, "\n", -1);
+      for (i = 0; lines[i] != NULL; i++)
+        {
+          gchar **words, **args;
+          gint n_args;
+
+          lines[i][strcspn (lines[i], "#;")] = '\0';
+          words = g_strsplit_set (g_strstrip (lines[i]), " \t", -1);
+          if (words[0] == NULL)
+            {
+              g_strfreev (words);
+              continue;
+            }
+
+          /* drop the empty strings between runs of blanks */
+          for (args = words + 1, n_args = 0; args[n_args] != NULL; )
+            {
+              if (*args[n_args] == '\0')
+                {
+                  g_free (args[n_args]);
+                  memmove (args + n_args, args + n_args + 1,
+                           sizeof (gchar *) * g_strv_length (args + n_args));
+                }
+              else
+                n_args++;
+            }
+
+          if (strcmp (words[0], "nameserver") == 0 && n_args >= 1 &&
+              config->nameservers->len < MAX_NAMESERVERS)
+            {
+              GInetAddress *address;
+
+              address = g_inet_address_new_from_string (args[0]);
+              if (address != NULL)
+                {
+                  g_ptr_array_add (config->nameservers,
+                                   g_inet_socket_address_new (address, DNS_PORT));
+                  g_object_unref (address);
+                }
+            }
+          else if (strcmp (words[0], "domain") == 0 && n_args >= 1)
+            {
+              g_strfreev (config->search);
+              config->search = g_new0 (gchar *, 2);
+              config->search[0] = g_strdup (args[0]);
+            }
+          else if (strcmp (words[0], "search") == 0 && n_args >= 1)
+            {
+              g_strfreev (config->search);
+              config->search = g_strdupv (args);
+            }
+          else if (strcmp (words[0], "options") == 0)
+            parse_options (config, args);
+
+          g_strfreev (words);
+        }
+      g_strfreev (lines);
+      g_free (contents);
+    }
+
+  /* Like the system resolver, fall back to a local name server */
+  if (config->nameservers->len == 0)
+    {
+      GInetAddress *loopback;
+
+      loopback = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+      g_ptr_array_add (config->nameservers,
+                       g_inet_socket_address_new (loopback, DNS_PORT));
+      g_object_unref (loopback);
+    }
+
+  if (config->search == NULL)
+    config->search = g_new0 (gchar *, 1);
+
+  return config;
+}
+
+/* Hosts file */
+
+static gboolean
+hostname_equal (const gchar *a,
+                const gchar *b)
+{
+  gsize len_a = strlen (a), len_b = strlen (b);
+
+  /* ignore a trailing dot on either side */
+  if (len_a > 0 && a[len_a - 1] == '.')
+    len_a--;
+  if (len_b > 0 && b[len_b - 1] == '.')
+    len_b--;
+
+  return len_a == len_b && g_ascii_strncasecmp (a, b, len_a) == 0;
+}
+
+/* Looks @hostname up in the hosts file, or if @address is given, looks
+ * up its first name there instead.
+ */
+static gboolean
+lookup_hosts_file (const gchar   *hostname,
+                   GInetAddress  *address,
+                   GList        **out_addresses,
+                   gchar        **out_name)
+{
+  gchar *contents;
+  gchar **lines;
+  GList *addresses = NULL;
+  gchar *name = NULL;
+  gint i, j;
+
+  if (!g_file_get_contents (HOSTS_PATH, &contents, NULL, NULL))
+    return FALSE;
+
+  lines = g_strsplit (contents, "\n", -1);
+  for (i = 0; lines[i] != NULL && name == NULL; i++)
+    {
+      GInetAddress *line_address;
+      gchar **words;
+
+      lines[i][strcspn (lines[i], "#")] = '\0';
+      words = g_strsplit_set (g_strstrip (lines[i]), " \t", -1);
+      line_address = words[0] ? g_inet_address_new_from_string (words[0]) : NULL;
+      if (line_address == NULL)
+        {
+          g_strfreev (words);
+          continue;
+        }
+
+      for (j = 1; words[j] != NULL; j++)
+        {
+          if (*words[j] == '\0')
+            continue;
+
+          if (address != NULL)
+            {
+              if (g_inet_address_equal (address, line_address))
+                name = g_strdup (words[j]);
+              break;
+            }
+          else if (hostname_equal (hostname, words[j]))
+            {
+              addresses = g_list_prepend (addresses, g_object_ref (line_address));
+              break;
+            }
+        }
+
+      g_object_unref (line_address);
+      g_strfreev (words);
+    }
+  g_strfreev (lines);
+  g_free (contents);
+
+  if (out_addresses)
+    *out_addresses = g_list_reverse (addresses);
+  if (out_name)
+    *out_name = name;
+
+  return addresses != NULL || name != NULL;
+}
+
+/* Messages */
+
+static inline guint16
+get16 (const guchar *p)
+{
+  return (p[0] << 8) | p[1];
+}
+
+static void
+append16 (GByteArray *array,
+          guint16     value)
+{
+  guint8 bytes[2] = { value >> 8, value & 0xff };
+
+  g_byte_array_append (array, bytes, 2);
+}
+
+static GByteArray *
+build_query (const gchar  *name,
+             guint16       type,
+             GError      **error)
+{
+  GByteArray *packet;
+  const gchar *p;
+  guint16 id;
+
+  packet = g_byte_array_sized_new (DNS_HEADER_SIZE + strlen (name) + 6);
+
+  id = g_random_int_range (0, 0x10000);
+  append16 (packet, id);
+  append16 (packet, 0x0100);  /* standard query, recursion desired */
+  append16 (packet, 1);       /* one question */
+  append16 (packet, 0);
+  append16 (packet, 0);
+  append16 (packet, 0);
+
+  for (p = name; *p != '\0'; )
+    {
+      gsize len = strcspn (p, ".");
+      guint8 len_byte = len;
+
+      if (len == 0 || len > 63)
+        goto invalid;
+
+      g_byte_array_append (packet, &len_byte, 1);
+      g_byte_array_append (packet, (const guint8 *) p, len);
+
+      p += len;
+      if (*p == '.')
+        p++;
+    }
+  g_byte_array_append (packet, (const guint8 *) "", 1);
+
+  if (packet->len - DNS_HEADER_SIZE > DNS_MAX_NAME || p == name)
+    goto invalid;
+
+  append16 (packet, type);
+  append16 (packet, DNS_CLASS_IN);
+
+  return packet;
+
+ invalid:
+  g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                       _("Invalid hostname"));
+  g_byte_array_unref (packet);
+  return NULL;
+}
+
+/* Checks that @answer is a response to @query, and if so returns the
+ * offset of its answer section. The name servers copy the question into
+ * the response, so @query's question section has to be there verbatim,
+ * apart from the case of the name.
+ */
+static gssize
+check_response (GByteArray   *query,
+                const guchar *answer,
+                gsize         len)
+{
+  gsize question_len = query->len - DNS_HEADER_SIZE;
+  gsize i;
+
+  if (len < DNS_HEADER_SIZE + question_len)
+    return -1;
+
+  if (memcmp (answer, query->data, 2) != 0 ||  /* id */
+      (answer[2] & 0x80) == 0 ||                /* not a response */
+      get16 (answer + 4) != 1)                  /* one question */
+    return -1;
+
+  for (i = DNS_HEADER_SIZE; i < query->len - 4; i++)
+    if (g_ascii_tolower (answer[i]) != g_ascii_tolower (query->data[i]))
+      return -1;
+  if (memcmp (answer + i, query->data + i, 4) != 0)
+    return -1;
+
+  return query->len;
+}
+
+/* Queries: one question, sent to the name servers in turn over UDP
+ * until one of them answers, and repeated over TCP if the answer is
+ * truncated.
+ */
+
+typedef struct _DnsQuery DnsQuery;
+
+typedef void (* DnsQueryCallback) (DnsQuery *query,
+                                   gpointer  user_data);
+
+struct _DnsQuery {
+  DnsConfig *config;
+  GMainContext *context;
+  GCancellable *cancellable;
+
+  GByteArray *packet;
+
+  guint n_sent;
+  GSocketAddress *server;
+  GSocket *socket;
+  GSource *read_source;
+  GSource *timeout_source;
+
+  GSocketConnection *connection;
+  GByteArray *tcp_request;
+  guint8 tcp_length[2];
+
+  /* the result */
+  guchar *answer;
+  gsize answer_len;
+  gsize answer_offset;
+  guint rcode;
+  GError *error;
+
+  DnsQueryCallback callback;
+  gpointer user_data;
+};
+
+static void
+dns_query_clear_udp (DnsQuery *query)
+{
+  if (query->read_source)
+    {
+      g_source_destroy (query->read_source);
+      g_source_unref (query->read_source);
+      query->read_source = NULL;
+    }
+  if (query->timeout_source)
+    {
+      g_source_destroy (query->timeout_source);
+      g_source_unref (query->timeout_source);
+      query->timeout_source = NULL;
+    }
+  g_clear_object (&query->socket);
+}
+
+static void
+dns_query_free (DnsQuery *query)
+{
+  dns_query_clear_udp (query);
+  g_clear_object (&query->server);
+  g_clear_object (&query->connection);
+  if (query->tcp_request)
+    g_byte_array_unref (query->tcp_request);
+  g_byte_array_unref (query->packet);
+  g_free (query->answer);
+  g_clear_error (&query->error);
+  g_clear_object (&query->cancellable);
+  g_main_context_unref (query->context);
+  dns_config_unref (query->config);
+  g_slice_free (DnsQuery, query);
+}
+
+static DnsQuery *
+dns_query_new (DnsConfig         *config,
+               const gchar       *name,
+               guint16            type,
+               GCancellable      *cancellable,
+               DnsQueryCallback   callback,
+               gpointer           user_data,
+               GError           **error)
+{
+  DnsQuery *query;
+  GByteArray *packet;
+
+  packet = build_query (name, type, error);
+  if (packet == NULL)
+    return NULL;
+
+  query = g_slice_new0 (DnsQuery);
+  query->config = dns_config_ref (config);
+  query->context = g_main_context_ref_thread_default ();
+  query->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+  query->packet = packet;
+  query->callback = callback;
+  query->user_data = user_data;
+
+  return query;
+}
+
+/* Takes ownership of @error */
+static void
+dns_query_complete (DnsQuery *query,
+                    GError   *error)
+{
+  dns_query_clear_udp (query);
+
+  if (error != NULL &&
+      !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED) &&
+      error->domain != G_RESOLVER_ERROR)
+    {
+      query->error = g_error_new (G_RESOLVER_ERROR, G_RESOLVER_ERROR_TEMPORARY_FAILURE,
+                                  "%s", error->message);
+      g_error_free (error);
+    }
+  else
+    query->error = error;
+
+  query->callback (query, query->user_data);
+}
+
+static gboolean
+is_from_server (DnsQuery       *query,
+                GSocketAddress *address)
+{
+  GInetSocketAddress *a = G_INET_SOCKET_ADDRESS (query->server);
+  GInetSocketAddress *b;
+
+  if (!G_IS_INET_SOCKET_ADDRESS (address))
+    return FALSE;
+  b = G_INET_SOCKET_ADDRESS (address);
+
+  return g_inet_socket_address_get_port (a) == g_inet_socket_address_get_port (b) &&
+         g_inet_address_equal (g_inet_socket_address_get_address (a),
+                               g_inet_socket_address_get_address (b));
+}
+
+static void dns_query_send (DnsQuery *query);
+static void dns_query_send_tcp (DnsQuery *query);
+
+/* Takes ownership of @answer */
+static void
+dns_query_got_answer (DnsQuery *query,
+                      guchar   *answer,
+                      gsize     len,
+                      gsize     offset)
+{
+  guint rcode = answer[3] & 0x0f;
+
+  /* Let the next server have a go, like the system resolver does */
+  if (rcode == DNS_RCODE_SERVFAIL ||
+      rcode == DNS_RCODE_NOTIMP ||
+      rcode == DNS_RCODE_REFUSED)
+    {
+      g_free (answer);
+      dns_query_send (query);
+      return;
+    }
+
+  query->answer = answer;
+  query->answer_len = len;
+  query->answer_offset = offset;
+  query->rcode = rcode;
+  dns_query_complete (query, NULL);
+}
+
+static gboolean
+dns_query_udp_readable (GSocket      *socket,
+                        GIOCondition  condition,
+                        gpointer      user_data)
+{
+  DnsQuery *query = user_data;
+  guchar buffer[DNS_MAX_UDP];
+  GError *error = NULL;
+
+  if (g_cancellable_set_error_if_cancelled (query->cancellable, &error))
+    {
+      dns_query_complete (query, error);
+      return G_SOURCE_REMOVE;
+    }
+
+  while (TRUE)
+    {
+      GSocketAddress *from = NULL;
+      gboolean expected;
+      gssize len, offset;
+
+      len = g_socket_receive_from (socket, &from, (gchar *) buffer, sizeof buffer,
+                                   NULL, &error);
+      if (len < 0)
+        {
+          if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+            {
+              g_error_free (error);
+              return G_SOURCE_CONTINUE;
+            }
+
+          /* e.g. an ICMP port unreachable; try the next server */
+          g_error_free (error);
+          dns_query_send (query);
+          return G_SOURCE_REMOVE;
+        }
+
+      expected = from != NULL && is_from_server (query, from);
+      g_clear_object (&from);
+      if (!expected)
+        continue;
+
+      offset = check_response (query->packet, buffer, len);
+      if (offset < 0)
+        continue;
+
+      if (buffer[2] & 0x02)
+        dns_query_send_tcp (query);
+      else
+        dns_query_got_answer (query, g_memdup (buffer, len), len, offset);
+      return G_SOURCE_REMOVE;
+    }
+}
+
+static gboolean
+dns_query_timed_out (gpointer user_data)
+{
+  DnsQuery *query = user_data;
+
+  dns_query_send (query);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+dns_query_send (DnsQuery *query)
+{
+  guint n_servers = query->config->nameservers->len;
+
+  dns_query_clear_udp (query);
+  g_clear_object (&query->server);
+
+  while (query->n_sent < n_servers * query->config->attempts)
+    {
+      GSocketFamily family;
+
+      query->server = g_object_ref (query->config->nameservers->pdata[query->n_sent % n_servers]);
+      query->n_sent++;
+
+      /* a new socket, and so a new random port, for every attempt */
+      family = g_socket_address_get_family (query->server);
+      query->socket = g_socket_new (family, G_SOCKET_TYPE_DATAGRAM,
+                                    G_SOCKET_PROTOCOL_UDP, NULL);
+      if (query->socket != NULL &&
+          g_socket_send_to (query->socket, query->server,
+                            (const gchar *) query->packet->data, query->packet->len,
+                            NULL, NULL) == query->packet->len)
+        {
+          g_socket_set_blocking (query->socket, FALSE);
+
+          query->read_source = g_socket_create_source (query->socket, G_IO_IN,
+                                                       query->cancellable);
+          g_source_set_callback (query->read_source,
+                                 (GSourceFunc) dns_query_udp_readable, query, NULL);
+          g_source_attach (query->read_source, query->context);
+
+          query->timeout_source = g_timeout_source_new (query->config->timeout * 1000);
+          g_source_set_callback (query->timeout_source, dns_query_timed_out, query, NULL);
+          g_source_attach (query->timeout_source, query->context);
+          return;
+        }
+
+      g_clear_object (&query->socket);
+      g_clear_object (&query->server);
+    }
+
+  dns_query_complete (query,
+                      g_error_new_literal (G_RESOLVER_ERROR,
+                                           G_RESOLVER_ERROR_TEMPORARY_FAILURE,
+                                           _("No response from any DNS server")));
+}
+
+static void
+dns_query_tcp_read_answer_cb (GObject      *source,
+                              GAsyncResult *result,
+                              gpointer      user_data)
+{
+  DnsQuery *query = user_data;
+  GError *error = NULL;
+  gsize len = get16 (query->tcp_length);
+  gsize bytes_read;
+  gssize offset;
+
+  if (!g_input_stream_read_all_finish (G_INPUT_STREAM (source), result, &bytes_read, &error))
+    {
+      g_free (query->answer);
+      query->answer = NULL;
+      dns_query_complete (query, error);
+      return;
+    }
+
+  offset = bytes_read == len ? check_response (query->packet, query->answer, len) : -1;
+  if (offset < 0)
+    {
+      g_free (query->answer);
+      query->answer = NULL;
+      dns_query_complete (query,
+                          g_error_new_literal (G_RESOLVER_ERROR,
+                                               G_RESOLVER_ERROR_TEMPORARY_FAILURE,
+                                               _("Invalid response from DNS server")));
+      return;
+    }
+
+  dns_query_got_answer (query, g_steal_pointer (&query->answer), len, offset);
+}
+
+static void
+dns_query_tcp_read_length_cb (GObject      *source,
+                              GAsyncResult *result,
+                              gpointer      user_data)
+{
+  DnsQuery *query = user_data;
+  GError *error = NULL;
+  gsize bytes_read;
+  gsize len;
+
+  if (!g_input_stream_read_all_finish (G_INPUT_STREAM (source), result, &bytes_read, &error))
+    {
+      dns_query_complete (query, error);
+      return;
+    }
+
+  len = get16 (query->tcp_length);
+  if (bytes_read < 2 || len < DNS_HEADER_SIZE)
+    {
+      dns_query_complete (query,
+                          g_error_new_literal (G_RESOLVER_ERROR,
+                                               G_RESOLVER_ERROR_TEMPORARY_FAILURE,
+                                               _("Invalid response from DNS server")));
+      return;
+    }
+
+  query->answer = g_malloc (len);
+  g_input_stream_read_all_async (G_INPUT_STREAM (source), query->answer, len,
+                                 G_PRIORITY_DEFAULT, query->cancellable,
+                                 dns_query_tcp_read_answer_cb, query);
+}
+
+static void
+dns_query_tcp_written_cb (GObject      *source,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  DnsQuery *query = user_data;
+  GError *error = NULL;
+
+  if (!g_output_stream_write_all_finish (G_OUTPUT_STREAM (source), result, NULL, &error))
+    {
+      dns_query_complete (query, error);
+      return;
+    }
+
+  g_input_stream_read_all_async (g_io_stream_get_input_stream (G_IO_STREAM (query->connection)),
+                                 query->tcp_length, 2,
+                                 G_PRIORITY_DEFAULT, query->cancellable,
+                                 dns_query_tcp_read_length_cb, query);
+}
+
+static void
+dns_query_tcp_connected_cb (GObject      *source,
+                            GAsyncResult *result,
+                            gpointer      user_data)
+{
+  DnsQuery *query = user_data;
+  GError *error = NULL;
+
+  query->connection = g_socket_client_connect_finish (G_SOCKET_CLIENT (source), result, &error);
+  if (query->connection == NULL)
+    {
+      dns_query_complete (query, error);
+      return;
+    }
+
+  /* over TCP, the message is preceded by its length */
+  query->tcp_request = g_byte_array_sized_new (query->packet->len + 2);
+  append16 (query->tcp_request, query->packet->len);
+  g_byte_array_append (query->tcp_request, query->packet->data, query->packet->len);
+
+  g_output_stream_write_all_async (g_io_stream_get_output_stream (G_IO_STREAM (query->connection)),
+                                   query->tcp_request->data, query->tcp_request->len,
+                                   G_PRIORITY_DEFAULT, query->cancellable,
+                                   dns_query_tcp_written_cb, query);
+}
+
+static void
+dns_query_send_tcp (DnsQuery *query)
+{
+  GSocketClient *client;
+
+  dns_query_clear_udp (query);
+
+  client = g_socket_client_new ();
+  g_socket_client_set_enable_proxy (client, FALSE);
+  g_socket_client_set_timeout (client, query->config->timeout);
+  g_socket_client_connect_async (client, G_SOCKET_CONNECTABLE (query->server),
+                                 query->cancellable,
+                                 dns_query_tcp_connected_cb, query);
+  g_object_unref (client);
+}
+
+/* Lookups: what the GResolver methods ask for, made of one or two
+ * queries per name tried.
+ */
+
+typedef enum {
+  DNS_LOOKUP_BY_NAME,
+  DNS_LOOKUP_BY_ADDRESS,
+  DNS_LOOKUP_RECORDS
+} DnsLookupType;
+
+typedef struct {
+  DnsLookupType type;
+  DnsConfig *config;
+  gchar *name;              /* what the caller asked for */
+  GResolverRecordType record_type;
+
+  gchar **candidates;       /* the names to try, in order */
+  guint next_candidate;
+  guint n_pending;
+
+  GList *addresses[2];      /* AAAA, A */
+  gchar *hostname;
+  GList *records;
+  GError *error;
+} DnsLookup;
+
+static void
+free_records (GList *records)
+{
+  g_list_free_full (records, (GDestroyNotify) g_variant_unref);
+}
+
+static void
+dns_lookup_free (DnsLookup *lookup)
+{
+  g_resolver_free_addresses (lookup->addresses[0]);
+  g_resolver_free_addresses (lookup->addresses[1]);
+  free_records (lookup->records);
+  g_free (lookup->hostname);
+  g_clear_error (&lookup->error);
+  g_strfreev (lookup->candidates);
+  g_free (lookup->name);
+  dns_config_unref (lookup->config);
+  g_slice_free (DnsLookup, lookup);
+}
+
+/* The search list is only applied to host names, as getaddrinfo()
+ * does; res_query(), which GThreadedResolver uses for records,
+ * doesn't apply it either.
+ */
+static gchar **
+build_candidates (DnsConfig   *config,
+                  const gchar *name)
+{
+  GPtrArray *candidates;
+  const gchar *p;
+  guint n_dots = 0;
+  gint i;
+
+  candidates = g_ptr_array_new ();
+
+  for (p = name; *p; p++)
+    if (*p == '.')
+      n_dots++;
+
+  if (g_str_has_suffix (name, ".") || n_dots >= config->ndots)
+    g_ptr_array_add (candidates, g_strdup (name));
+
+  if (!g_str_has_suffix (name, "."))
+    {
+      for (i = 0; config->search[i] != NULL; i++)
+        g_ptr_array_add (candidates, g_strconcat (name, ".", config->search[i], NULL));
+
+      if (n_dots < config->ndots)
+        g_ptr_array_add (candidates, g_strdup (name));
+    }
+
+  g_ptr_array_add (candidates, NULL);
+  return (gchar **) g_ptr_array_free (candidates, FALSE);
+}
+
+static gchar *
+reverse_name (GInetAddress *address)
+{
+  const guint8 *bytes = g_inet_address_to_bytes (address);
+  GString *name;
+  gint i;
+
+  name = g_string_new (NULL);
+  if (g_inet_address_get_family (address) == G_SOCKET_FAMILY_IPV4)
+    {
+      for (i = 3; i >= 0; i--)
+        g_string_append_printf (name, "%u.", bytes[i]);
+      g_string_append (name, "in-addr.arpa");
+    }
+  else
+    {
+      for (i = 15; i >= 0; i--)
+        g_string_append_printf (name, "%x.%x.", bytes[i] & 0xf, bytes[i] >> 4);
+      g_string_append (name, "ip6.arpa");
+    }
+
+  return g_string_free (name, FALSE);
+}
+
+/* Collects the A/AAAA or PTR records that answer @query */
+static void
+parse_answers (DnsQuery  *query,
+               guint16    type,
+               GList    **addresses,
+               gchar    **hostname)
+{
+  const guchar *answer = query->answer;
+  const guchar *end = answer + query->answer_len;
+  const guchar *p = answer + query->answer_offset;
+  guint count = get16 (answer + 6);
+  gchar namebuf[1024];
+  GList *list = NULL;
+
+  while (count-- > 0 && p < end)
+    {
+      guint16 rr_type, rr_class, rdlength;
+      gint n;
+
+      n = dn_expand (answer, end, p, namebuf, sizeof namebuf);
+      if (n < 0 || end - (p + n) < 10)
+        break;
+      p += n;
+
+      rr_type = get16 (p);
+      rr_class = get16 (p + 2);
+      rdlength = get16 (p + 8);
+      p += 10;
+      if (end - p < rdlength)
+        break;
+
+      /* CNAMEs are skipped; recursive servers include their targets */
+      if (rr_type == type && rr_class == DNS_CLASS_IN)
+        {
+          if (type == DNS_TYPE_A && rdlength == 4)
+            list = g_list_prepend (list, g_inet_address_new_from_bytes (p, G_SOCKET_FAMILY_IPV4));
+          else if (type == DNS_TYPE_AAAA && rdlength == 16)
+            list = g_list_prepend (list, g_inet_address_new_from_bytes (p, G_SOCKET_FAMILY_IPV6));
+          else if (type == DNS_TYPE_PTR && *hostname == NULL &&
+                   dn_expand (answer, end, p, namebuf, sizeof namebuf) > 0)
+            *hostname = g_strdup (namebuf);
+        }
+
+      p += rdlength;
+    }
+
+  if (addresses)
+    *addresses = g_list_concat (*addresses, g_list_reverse (list));
+}
+
+static void dns_lookup_try_next (GTask *task);
+
+static void
+dns_lookup_query_done (DnsQuery *query,
+                       gpointer  user_data)
+{
+  GTask *task = user_data;
+  DnsLookup *lookup = g_task_get_task_data (task);
+
+  lookup->n_pending--;
+
+  if (query->error != NULL)
+    {
+      if (lookup->error == NULL)
+        lookup->error = g_steal_pointer (&query->error);
+    }
+  else if (query->rcode == DNS_RCODE_NOERROR || query->rcode == DNS_RCODE_NXDOMAIN)
+    {
+      guint16 type = get16 (query->packet->data + query->packet->len - 4);
+
+      switch (lookup->type)
+        {
+        case DNS_LOOKUP_BY_NAME:
+          if (query->rcode == DNS_RCODE_NOERROR)
+            parse_answers (query, type,
+                           &lookup->addresses[type == DNS_TYPE_AAAA ? 0 : 1], NULL);
+          break;
+
+        case DNS_LOOKUP_BY_ADDRESS:
+          if (query->rcode == DNS_RCODE_NOERROR)
+            parse_answers (query, type, NULL, &lookup->hostname);
+          break;
+
+        case DNS_LOOKUP_RECORDS:
+          {
+            guint32 ttl;
+
+            /* the same answer parsing as for res_query() */
+            lookup->records =
+              _g_resolver_records_from_res_query (lookup->name, type,
+                                                  query->answer,
+                                                  query->rcode == DNS_RCODE_NOERROR ? (gint) query->answer_len : -1,
+                                                  HOST_NOT_FOUND, &ttl,
+                                                  lookup->error ? NULL : &lookup->error);
+          }
+          break;
+        }
+    }
+  else if (lookup->error == NULL)
+    {
+      g_set_error (&lookup->error, G_RESOLVER_ERROR, G_RESOLVER_ERROR_INTERNAL,
+                   _("Error resolving “%s”"), lookup->name);
+    }
+
+  dns_query_free (query);
+
+  if (lookup->n_pending == 0)
+    dns_lookup_try_next (task);
+
+  g_object_unref (task);
+}
+
+static gboolean
+dns_lookup_start_queries (GTask        *task,
+                          const gchar  *name,
+                          GError      **error)
+{
+  DnsLookup *lookup = g_task_get_task_data (task);
+  DnsQuery *queries[2] = { NULL, NULL };
+  guint16 types[2];
+  guint n_queries, i;
+
+  switch (lookup->type)
+    {
+    case DNS_LOOKUP_BY_NAME:
+      /* both at once, like the system resolver */
+      types[0] = DNS_TYPE_AAAA;
+      types[1] = DNS_TYPE_A;
+      n_queries = 2;
+      break;
+    case DNS_LOOKUP_BY_ADDRESS:
+      types[0] = DNS_TYPE_PTR;
+      n_queries = 1;
+      break;
+    case DNS_LOOKUP_RECORDS:
+    default:
+      types[0] = _g_resolver_record_type_to_rrtype (lookup->record_type);
+      n_queries = 1;
+      break;
+    }
+
+  for (i = 0; i < n_queries; i++)
+    {
+      queries[i] = dns_query_new (lookup->config, name, types[i],
+                                  g_task_get_cancellable (task),
+                                  dns_lookup_query_done, task, error);
+      if (queries[i] == NULL)
+        {
+          if (i > 0)
+            dns_query_free (queries[0]);
+          return FALSE;
+        }
+    }
+
+  lookup->n_pending = n_queries;
+  for (i = 0; i < n_queries; i++)
+    {
+      g_object_ref (task);
+      dns_query_send (queries[i]);
+    }
+
+  return TRUE;
+}
+
+static void
+dns_lookup_try_next (GTask *task)
+{
+  DnsLookup *lookup = g_task_get_task_data (task);
+  GError *error = NULL;
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  /* An answer from either query wins over an error from the other */
+  switch (lookup->type)
+    {
+    case DNS_LOOKUP_BY_NAME:
+      if (lookup->addresses[0] != NULL || lookup->addresses[1] != NULL)
+        {
+          GList *addresses;
+
+          addresses = g_list_concat (lookup->addresses[0], lookup->addresses[1]);
+          lookup->addresses[0] = lookup->addresses[1] = NULL;
+          g_task_return_pointer (task, addresses, (GDestroyNotify) g_resolver_free_addresses);
+          return;
+        }
+      break;
+
+    case DNS_LOOKUP_BY_ADDRESS:
+      if (lookup->hostname != NULL)
+        {
+          g_task_return_pointer (task, g_steal_pointer (&lookup->hostname), g_free);
+          return;
+        }
+      break;
+
+    case DNS_LOOKUP_RECORDS:
+      if (lookup->n_pending == 0 && lookup->next_candidate > 0)
+        {
+          if (lookup->error != NULL)
+            g_task_return_error (task, g_steal_pointer (&lookup->error));
+          else
+            g_task_return_pointer (task, g_steal_pointer (&lookup->records),
+                                   (GDestroyNotify) free_records);
+          return;
+        }
+      break;
+    }
+
+  if (lookup->error != NULL)
+    {
+      g_task_return_error (task, g_steal_pointer (&lookup->error));
+      return;
+    }
+
+  if (lookup->candidates[lookup->next_candidate] != NULL)
+    {
+      const gchar *name = lookup->candidates[lookup->next_candidate++];
+
+      if (!dns_lookup_start_queries (task, name, &error))
+        g_task_return_error (task, error);
+      return;
+    }
+
+  if (lookup->type == DNS_LOOKUP_BY_NAME)
+    {
+      g_task_return_new_error (task, G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND,
+                               _("Error resolving “%s”: %s"),
+                               lookup->name, gai_strerror (EAI_NONAME));
+    }
+  else
+    {
+      g_task_return_new_error (task, G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND,
+                               _("Error reverse-resolving “%s”: %s"),
+                               lookup->name, gai_strerror (EAI_NONAME));
+    }
+}
+
+static DnsConfig *
+get_config (GDnsResolver *self)
+{
+  DnsConfig *config;
+
+  g_mutex_lock (&self->lock);
+  if (self->config == NULL)
+    self->config = dns_config_load ();
+  config = dns_config_ref (self->config);
+  g_mutex_unlock (&self->lock);
+
+  return config;
+}
+
+static void
+dns_lookup_async (GDnsResolver        *self,
+                  DnsLookupType        type,
+                  const gchar         *name,
+                  GResolverRecordType  record_type,
+                  GCancellable        *cancellable,
+                  gpointer             source_tag,
+                  GAsyncReadyCallback  callback,
+                  gpointer             user_data)
+{
+  DnsLookup *lookup;
+  GTask *task;
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, source_tag);
+
+  lookup = g_slice_new0 (DnsLookup);
+  lookup->type = type;
+  lookup->config = get_config (self);
+  lookup->name = g_strdup (name);
+  lookup->record_type = record_type;
+  if (type == DNS_LOOKUP_BY_NAME)
+    lookup->candidates = build_candidates (lookup->config, name);
+  else if (type == DNS_LOOKUP_BY_ADDRESS)
+    {
+      GInetAddress *address = g_inet_address_new_from_string (name);
+
+      lookup->candidates = g_new0 (gchar *, 2);
+      lookup->candidates[0] = reverse_name (address);
+      g_object_unref (address);
+    }
+  else
+    {
+      lookup->candidates = g_new0 (gchar *, 2);
+      lookup->candidates[0] = g_strdup (name);
+    }
+  g_task_set_task_data (task, lookup, (GDestroyNotify) dns_lookup_free);
+
+  dns_lookup_try_next (task);
+  g_object_unref (task);
+}
+
+static void
+lookup_by_name_async (GResolver           *resolver,
+                      const gchar         *hostname,
+                      GCancellable        *cancellable,
+                      GAsyncReadyCallback  callback,
+                      gpointer             user_data)
+{
+  GList *addresses;
+
+  if (lookup_hosts_file (hostname, NULL, &addresses, NULL))
+    {
+      GTask *task;
+
+      task = g_task_new (resolver, cancellable, callback, user_data);
+      g_task_set_source_tag (task, lookup_by_name_async);
+      g_task_return_pointer (task, addresses, (GDestroyNotify) g_resolver_free_addresses);
+      g_object_unref (task);
+      return;
+    }
+
+  dns_lookup_async (G_DNS_RESOLVER (resolver), DNS_LOOKUP_BY_NAME, hostname, 0,
+                    cancellable, lookup_by_name_async, callback, user_data);
+}
+
+static GList *
+lookup_by_name_finish (GResolver     *resolver,
+                       GAsyncResult  *result,
+                       GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, resolver), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static void
+lookup_by_address_async (GResolver           *resolver,
+                         GInetAddress        *address,
+                         GCancellable        *cancellable,
+                         GAsyncReadyCallback  callback,
+                         gpointer             user_data)
+{
+  gchar *name;
+
+  if (lookup_hosts_file (NULL, address, NULL, &name))
+    {
+      GTask *task;
+
+      task = g_task_new (resolver, cancellable, callback, user_data);
+      g_task_set_source_tag (task, lookup_by_address_async);
+      g_task_return_pointer (task, name, g_free);
+      g_object_unref (task);
+      return;
+    }
+
+  name = g_inet_address_to_string (address);
+  dns_lookup_async (G_DNS_RESOLVER (resolver), DNS_LOOKUP_BY_ADDRESS, name, 0,
+                    cancellable, lookup_by_address_async, callback, user_data);
+  g_free (name);
+}
+
+static gchar *
+lookup_by_address_finish (GResolver     *resolver,
+                          GAsyncResult  *result,
+                          GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, resolver), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static void
+lookup_records_async (GResolver           *resolver,
+                      const gchar         *rrname,
+                      GResolverRecordType  record_type,
+                      GCancellable        *cancellable,
+                      GAsyncReadyCallback  callback,
+                      gpointer             user_data)
+{
+  dns_lookup_async (G_DNS_RESOLVER (resolver), DNS_LOOKUP_RECORDS, rrname, record_type,
+                    cancellable, lookup_records_async, callback, user_data);
+}
+
+static GList *
+lookup_records_finish (GResolver     *resolver,
+                       GAsyncResult  *result,
+                       GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, resolver), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static void
+g_dns_resolver_reload (GResolver *resolver)
+{
+  GDnsResolver *self = G_DNS_RESOLVER (resolver);
+
+  /* resolv.conf changed; reread it for the next lookup */
+  g_mutex_lock (&self->lock);
+  g_clear_pointer (&self->config, dns_config_unref);
+  g_mutex_unlock (&self->lock);
+}
+
+G_DEFINE_TYPE (GDnsResolver, g_dns_resolver, G_TYPE_THREADED_RESOLVER)
+
+static void
+g_dns_resolver_init (GDnsResolver *self)
+{
+  g_mutex_init (&self->lock);
+}
+
+static void
+g_dns_resolver_finalize (GObject *object)
+{
+  GDnsResolver *self = G_DNS_RESOLVER (object);
+
+  g_clear_pointer (&self->config, dns_config_unref);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (g_dns_resolver_parent_class)->finalize (object);
+}
+
+static void
+g_dns_resolver_class_init (GDnsResolverClass *dns_class)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (dns_class);
+  GResolverClass *resolver_class = G_RESOLVER_CLASS (dns_class);
+
+  object_class->finalize = g_dns_resolver_finalize;
+
+  /* the synchronous methods are inherited from GThreadedResolver */
+  resolver_class->reload                   = g_dns_resolver_reload;
+  resolver_class->lookup_by_name_async     = lookup_by_name_async;
+  resolver_class->lookup_by_name_finish    = lookup_by_name_finish;
+  resolver_class->lookup_by_address_async  = lookup_by_address_async;
+  resolver_class->lookup_by_address_finish = lookup_by_address_finish;
+  resolver_class->lookup_records_async     = lookup_records_async;
+  resolver_class->lookup_records_finish    = lookup_records_finish;
+}
+
+#endif /* G_OS_UNIX */
+
+/**
+ * g_resolver_new_dns:
+ *
+ * Creates a #GResolver whose asynchronous lookups, such as
+ * g_resolver_lookup_by_name_async(), talk to the DNS servers
+ * configured in resolv.conf directly from the thread-default main
+ * context, instead of tying up a worker thread in the system resolver
+ * for each lookup. This keeps a slow or unreachable DNS server from
+ * exhausting the thread pool that #GTask uses.
+ *
+ * The hosts file, the search list and the ndots, timeout and attempts
+ * options are honoured, but other sources of the system's name service
+ * switch, such as mDNS, are not consulted. Synchronous lookups behave
+ * exactly as with the default resolver.
+ *
+ * On platforms other than UNIX, this returns a resolver that behaves
+ * like the default one.
+ *
+ * To make all of GIO use it, pass it to g_resolver_set_default().
+ *
+ * Returns: (transfer full): a new #GResolver
+ *
+ * Since: 2.54
+ */
+GResolver *
+g_resolver_new_dns (void)
+{
+#ifdef G_OS_UNIX
+  return g_object_new (G_TYPE_DNS_RESOLVER, NULL);
+#else
+  return g_object_new (G_TYPE_THREADED_RESOLVER, NULL);
+#endif
+}
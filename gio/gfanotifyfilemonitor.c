@@ -0,0 +1,375 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/fanotify.h>
+
+#include "glocalfilemonitor.h"
+#include "giomodule.h"
+#include "glib-private.h"
+#include "glib-unix.h"
+
+/* A recursive directory monitor on top of fanotify.
+ *
+ * inotify needs a watch for every directory in the tree, which for
+ * large trees means walking all of it up front and running into
+ * max_user_watches.  A fanotify filesystem mark instead reports the
+ * directory entry changes on the whole filesystem through one fd, and
+ * with FAN_REPORT_DFID_NAME (Linux 5.9) each event carries a handle
+ * of the parent directory and the name of the entry.  The handle is
+ * resolved to a path, and events outside of the monitored directory
+ * are dropped.
+ *
+ * Filesystem marks and resolving handles need CAP_SYS_ADMIN and
+ * CAP_DAC_READ_SEARCH, so this is mostly useful to system services
+ * such as indexers; is_supported() fails for everyone else.
+ */
+
+#define FANOTIFY_INIT_FLAGS (FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK | FAN_REPORT_DFID_NAME)
+#define FANOTIFY_MASK (FAN_CREATE | FAN_DELETE | FAN_MOVED_FROM | FAN_MOVED_TO | \
+                       FAN_MODIFY | FAN_CLOSE_WRITE | FAN_ATTRIB | FAN_ONDIR)
+
+#define G_TYPE_FANOTIFY_FILE_MONITOR  (g_fanotify_file_monitor_get_type ())
+#define G_FANOTIFY_FILE_MONITOR(inst) (G_TYPE_CHECK_INSTANCE_CAST ((inst), \
+                                       G_TYPE_FANOTIFY_FILE_MONITOR, GFanotifyFileMonitor))
+
+typedef struct _GFanotifyFileMonitor       GFanotifyFileMonitor;
+typedef GLocalFileMonitorClass             GFanotifyFileMonitorClass;
+
+GType g_fanotify_file_monitor_get_type (void);
+
+/* Shared between the monitor and its source in the worker context, so
+ * that it stays around until any dispatch in progress is done.
+ */
+typedef struct
+{
+  gint ref_count;
+
+  gint fanotify_fd;
+  gint mount_fd;  /* any fd on the filesystem, for open_by_handle_at() */
+  gchar *realpath;  /* the directory, as the kernel reports it */
+  GFileMonitorSource *fms;
+} FanotifyWatch;
+
+struct _GFanotifyFileMonitor
+{
+  GLocalFileMonitor parent_instance;
+
+  FanotifyWatch *watch;
+  GSource *source;
+};
+
+G_DEFINE_TYPE_WITH_CODE (GFanotifyFileMonitor, g_fanotify_file_monitor, G_TYPE_LOCAL_FILE_MONITOR,
+                         g_io_extension_point_implement (G_RECURSIVE_FILE_MONITOR_EXTENSION_POINT_NAME,
+                                                         g_define_type_id, "fanotify", 20))
+
+static FanotifyWatch *
+fanotify_watch_ref (FanotifyWatch *watch)
+{
+  g_atomic_int_inc (&watch->ref_count);
+
+  return watch;
+}
+
+static void
+fanotify_watch_unref (gpointer data)
+{
+  FanotifyWatch *watch = data;
+
+  if (!g_atomic_int_dec_and_test (&watch->ref_count))
+    return;
+
+  if (watch->fanotify_fd != -1)
+    close (watch->fanotify_fd);
+  if (watch->mount_fd != -1)
+    close (watch->mount_fd);
+  g_free (watch->realpath);
+  g_source_unref ((GSource *) watch->fms);
+  g_slice_free (FanotifyWatch, watch);
+}
+
+/* Returns the path of @name inside the directory @handle refers to,
+ * relative to the monitored directory, or %NULL if it is not below it.
+ */
+static gchar *
+fanotify_watch_get_child (FanotifyWatch     *watch,
+                          struct file_handle *handle,
+                          const gchar       *name)
+{
+  gchar proc_path[64];
+  gchar dir[PATH_MAX];
+  const gchar *relative_dir;
+  gsize realpath_len;
+  ssize_t len;
+  gint fd;
+
+  fd = open_by_handle_at (watch->mount_fd, handle, O_PATH | O_CLOEXEC);
+  if (fd == -1)
+    return NULL;  /* typically ESTALE, the directory is gone already */
+
+  g_snprintf (proc_path, sizeof proc_path, "/proc/self/fd/%d", fd);
+  len = readlink (proc_path, dir, sizeof dir - 1);
+  close (fd);
+  if (len <= 0)
+    return NULL;
+  dir[len] = '\0';
+
+  realpath_len = strlen (watch->realpath);
+  if (strcmp (watch->realpath, "/") == 0)
+    relative_dir = dir + 1;
+  else if (strncmp (dir, watch->realpath, realpath_len) == 0 && dir[realpath_len] == '\0')
+    relative_dir = dir + realpath_len;
+  else if (strncmp (dir, watch->realpath, realpath_len) == 0 && dir[realpath_len] == '/')
+    relative_dir = dir + realpath_len + 1;
+  else
+    return NULL;
+
+  if (relative_dir[0] == '\0')
+    return g_strdup (name);
+
+  return g_strconcat (relative_dir, "/", name, NULL);
+}
+
+static void
+fanotify_watch_handle_event (FanotifyWatch                  *watch,
+                             struct fanotify_event_metadata *event,
+                             gint64                          now)
+{
+  struct fanotify_event_info_fid *fid = NULL;
+  struct file_handle *handle;
+  const gchar *name;
+  gchar *child;
+  gsize offset;
+
+  for (offset = event->metadata_len; offset < event->event_len; )
+    {
+      struct fanotify_event_info_header *header;
+
+      header = (struct fanotify_event_info_header *) ((gchar *) event + offset);
+      if (header->len == 0)
+        break;
+
+      if (header->info_type == FAN_EVENT_INFO_TYPE_DFID_NAME)
+        {
+          fid = (struct fanotify_event_info_fid *) header;
+          break;
+        }
+
+      offset += header->len;
+    }
+
+  if (fid == NULL)
+    return;
+
+  handle = (struct file_handle *) fid->handle;
+  name = (const gchar *) handle->f_handle + handle->handle_bytes;
+
+  /* Events on the directory itself rather than an entry in it */
+  if (strcmp (name, ".") == 0)
+    return;
+
+  child = fanotify_watch_get_child (watch, handle, name);
+  if (child == NULL)
+    return;
+
+  if (event->mask & FAN_CREATE)
+    g_file_monitor_source_handle_event (watch->fms, G_FILE_MONITOR_EVENT_CREATED, child, NULL, NULL, now);
+  if (event->mask & FAN_MOVED_TO)
+    g_file_monitor_source_handle_event (watch->fms, G_FILE_MONITOR_EVENT_MOVED_IN, child, NULL, NULL, now);
+  if (event->mask & FAN_MODIFY)
+    g_file_monitor_source_handle_event (watch->fms, G_FILE_MONITOR_EVENT_CHANGED, child, NULL, NULL, now);
+  if (event->mask & FAN_ATTRIB)
+    g_file_monitor_source_handle_event (watch->fms, G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED, child, NULL, NULL, now);
+  if (event->mask & FAN_CLOSE_WRITE)
+    g_file_monitor_source_handle_event (watch->fms, G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT, child, NULL, NULL, now);
+  if (event->mask & FAN_MOVED_FROM)
+    g_file_monitor_source_handle_event (watch->fms, G_FILE_MONITOR_EVENT_MOVED_OUT, child, NULL, NULL, now);
+  if (event->mask & FAN_DELETE)
+    g_file_monitor_source_handle_event (watch->fms, G_FILE_MONITOR_EVENT_DELETED, child, NULL, NULL, now);
+
+  g_free (child);
+}
+
+/* Runs in the worker context */
+static gboolean
+fanotify_watch_dispatch (gint          fd,
+                         GIOCondition  condition,
+                         gpointer      user_data)
+{
+  FanotifyWatch *watch = user_data;
+  struct fanotify_event_metadata *event;
+  gchar buffer[16384] __attribute__ ((aligned (__alignof__ (struct fanotify_event_metadata))));
+  ssize_t len;
+  gint64 now;
+
+  while ((len = read (fd, buffer, sizeof buffer)) > 0)
+    {
+      now = g_get_monotonic_time ();
+
+      for (event = (struct fanotify_event_metadata *) buffer;
+           FAN_EVENT_OK (event, len);
+           event = FAN_EVENT_NEXT (event, len))
+        {
+          if (event->vers != FANOTIFY_METADATA_VERSION)
+            return G_SOURCE_REMOVE;
+
+          /* Like for an inotify overflow, the best we can do is tell
+           * that something about the directory changed.
+           */
+          if (event->mask & FAN_Q_OVERFLOW)
+            g_file_monitor_source_handle_event (watch->fms, G_FILE_MONITOR_EVENT_CHANGED,
+                                                NULL, NULL, NULL, now);
+          else
+            fanotify_watch_handle_event (watch, event, now);
+
+          if (event->fd >= 0)
+            close (event->fd);
+        }
+    }
+
+  if (len == -1 && errno != EAGAIN && errno != EINTR)
+    return G_SOURCE_REMOVE;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+g_fanotify_file_monitor_is_supported (void)
+{
+  static gsize supported = 0;
+
+  if (g_once_init_enter (&supported))
+    {
+      gint fd;
+
+      fd = fanotify_init (FANOTIFY_INIT_FLAGS, O_RDONLY | O_CLOEXEC);
+      if (fd != -1)
+        close (fd);
+
+      g_once_init_leave (&supported, fd != -1 ? 1 : 2);
+    }
+
+  return supported == 1;
+}
+
+static void
+g_fanotify_file_monitor_start (GLocalFileMonitor  *local_monitor,
+                               const gchar        *dirname,
+                               const gchar        *basename,
+                               const gchar        *filename,
+                               GFileMonitorSource *source)
+{
+  GFanotifyFileMonitor *fanotify_monitor = G_FANOTIFY_FILE_MONITOR (local_monitor);
+  FanotifyWatch *watch;
+  gchar *resolved;
+  gint errsv;
+
+  /* Only directories get here, see g_local_file_monitor_new_for_path() */
+  g_assert (basename == NULL);
+
+  watch = g_slice_new0 (FanotifyWatch);
+  watch->ref_count = 1;
+  watch->mount_fd = -1;
+  watch->fms = (GFileMonitorSource *) g_source_ref ((GSource *) source);
+
+  resolved = realpath (dirname, NULL);
+  watch->realpath = g_strdup (resolved ? resolved : dirname);
+  free (resolved);
+
+  watch->fanotify_fd = fanotify_init (FANOTIFY_INIT_FLAGS, O_RDONLY | O_CLOEXEC);
+  if (watch->fanotify_fd == -1)
+    goto fail;
+
+  if (fanotify_mark (watch->fanotify_fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM,
+                     FANOTIFY_MASK, AT_FDCWD, dirname) == -1)
+    goto fail;
+
+  watch->mount_fd = open (dirname, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (watch->mount_fd == -1)
+    goto fail;
+
+  fanotify_monitor->watch = watch;
+
+  fanotify_monitor->source = g_unix_fd_source_new (watch->fanotify_fd, G_IO_IN);
+  g_source_set_callback (fanotify_monitor->source, (GSourceFunc) fanotify_watch_dispatch,
+                         fanotify_watch_ref (watch), fanotify_watch_unref);
+  g_source_set_name (fanotify_monitor->source, "[gio] fanotify file monitor");
+  g_source_attach (fanotify_monitor->source, GLIB_PRIVATE_CALL (g_get_worker_context) ());
+
+  return;
+
+fail:
+  /* Like a missing directory with inotify, there will just be no events */
+  errsv = errno;
+  g_warning ("Unable to monitor “%s” with fanotify: %s", dirname, g_strerror (errsv));
+  fanotify_watch_unref (watch);
+}
+
+static gboolean
+g_fanotify_file_monitor_cancel (GFileMonitor *monitor)
+{
+  GFanotifyFileMonitor *fanotify_monitor = G_FANOTIFY_FILE_MONITOR (monitor);
+
+  if (fanotify_monitor->source)
+    {
+      g_source_destroy (fanotify_monitor->source);
+      g_source_unref (fanotify_monitor->source);
+      fanotify_monitor->source = NULL;
+    }
+
+  g_clear_pointer (&fanotify_monitor->watch, fanotify_watch_unref);
+
+  return TRUE;
+}
+
+static void
+g_fanotify_file_monitor_finalize (GObject *object)
+{
+  GFanotifyFileMonitor *fanotify_monitor = G_FANOTIFY_FILE_MONITOR (object);
+
+  /* must surely have been cancelled already */
+  g_assert (!fanotify_monitor->watch);
+
+  G_OBJECT_CLASS (g_fanotify_file_monitor_parent_class)->finalize (object);
+}
+
+static void
+g_fanotify_file_monitor_init (GFanotifyFileMonitor *monitor)
+{
+}
+
+static void
+g_fanotify_file_monitor_class_init (GFanotifyFileMonitorClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GFileMonitorClass *file_monitor_class = G_FILE_MONITOR_CLASS (klass);
+  GLocalFileMonitorClass *local_file_monitor_class = G_LOCAL_FILE_MONITOR_CLASS (klass);
+
+  local_file_monitor_class->is_supported = g_fanotify_file_monitor_is_supported;
+  local_file_monitor_class->start = g_fanotify_file_monitor_start;
+  file_monitor_class->cancel = g_fanotify_file_monitor_cancel;
+
+  gobject_class->finalize = g_fanotify_file_monitor_finalize;
+}
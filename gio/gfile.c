@@ -30,7 +30,7 @@
 #define BTRFS_IOC_CLONE _IOW(BTRFS_IOCTL_MAGIC, 9, int)
 #endif
 
-#ifdef HAVE_SPLICE
+#if defined (HAVE_SPLICE) || defined (HAVE_COPY_FILE_RANGE)
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -1587,6 +1587,44 @@ g_file_read (GFile         *file,
   return (* iface->read_fn) (file, cancellable, error);
 }
 
+/**
+ * g_file_read_mapped:
+ * @file: #GFile to read
+ * @cancellable: (nullable): a #GCancellable
+ * @error: a #GError, or %NULL
+ *
+ * Opens a file for reading, like g_file_read(), but for regular local
+ * files serves the stream from a read-only memory mapping of the file
+ * instead of read() calls. Reads, skips and seeks on the returned
+ * stream then never enter the kernel, and g_input_stream_read_bytes()
+ * returns a reference to the mapped memory without copying it.
+ *
+ * The mapping is hinted for sequential access. Files that are not
+ * local, are not regular files (such as pipes or devices), or that
+ * cannot be mapped are opened exactly as g_file_read() would.
+ *
+ * As with g_mapped_file_new(), the file must not be truncated by
+ * another process while the stream is in use, or reading from the
+ * stream may crash.
+ *
+ * Returns: (transfer full): #GFileInputStream or %NULL on error.
+ *     Free the returned object with g_object_unref().
+ *
+ * Since: 2.54
+ */
+GFileInputStream *
+g_file_read_mapped (GFile         *file,
+                    GCancellable  *cancellable,
+                    GError       **error)
+{
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+
+  if (G_IS_LOCAL_FILE (file))
+    return _g_local_file_read_mapped (G_LOCAL_FILE (file), cancellable, error);
+
+  return g_file_read (file, cancellable, error);
+}
+
 /**
  * g_file_append_to:
  * @file: input #GFile
@@ -3008,7 +3046,10 @@ btrfs_reflink_with_progress (GInputStream           *in,
   if (progress_callback)
     source_size = g_file_info_get_size (info);
 
-  /* Btrfs clone ioctl properties:
+  /* BTRFS_IOC_CLONE is the same request as the generic FICLONE, so
+   * this reflinks on XFS and other filesystems too.
+   *
+   * Btrfs clone ioctl properties:
    *  - Works at the inode level
    *  - Doesn't work with directories
    *  - Always follows symlinks (source and destination)
@@ -3046,6 +3087,88 @@ btrfs_reflink_with_progress (GInputStream           *in,
 }
 #endif
 
+#ifdef HAVE_COPY_FILE_RANGE
+/* Large enough for few syscalls, small enough to keep progress and
+ * cancellation responsive; the kernel may copy less per call anyway.
+ */
+#define COPY_FILE_RANGE_CHUNK_SIZE (1024 * 1024 * 16)
+
+static gboolean
+copy_file_range_with_progress (GInputStream           *in,
+                               GOutputStream          *out,
+                               GCancellable           *cancellable,
+                               GFileProgressCallback   progress_callback,
+                               gpointer                progress_callback_data,
+                               GError                **error)
+{
+  goffset total_size;
+  loff_t offset_in;
+  loff_t offset_out;
+  int fd_in, fd_out;
+
+  fd_in = g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (in));
+  fd_out = g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (out));
+
+  total_size = 0;
+  /* avoid performance impact of querying total size when it's not needed */
+  if (progress_callback)
+    {
+      struct stat sbuf;
+
+      if (fstat (fd_in, &sbuf) == 0)
+        total_size = sbuf.st_size;
+    }
+
+  offset_in = offset_out = 0;
+  while (TRUE)
+    {
+      ssize_t n_copied;
+
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        return FALSE;
+
+      n_copied = copy_file_range (fd_in, &offset_in, fd_out, &offset_out,
+                                  COPY_FILE_RANGE_CHUNK_SIZE, 0);
+      if (n_copied == 0)
+        break;
+
+      if (n_copied < 0)
+        {
+          int errsv = errno;
+
+          if (errsv == EINTR)
+            continue;
+
+          /* Not implemented by this kernel or these filesystems (e.g.
+           * across mounts before Linux 5.3, or for special files); the
+           * caller falls back to splicing, which starts over from the
+           * beginning regardless of what we have copied so far.
+           */
+          if (errsv == ENOSYS || errsv == EXDEV || errsv == EINVAL ||
+              errsv == EOPNOTSUPP || errsv == EBADF)
+            g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                                 "copy_file_range() not supported");
+          else
+            g_set_error (error, G_IO_ERROR,
+                         g_io_error_from_errno (errsv),
+                         _("Error copying file: %s"),
+                         g_strerror (errsv));
+
+          return FALSE;
+        }
+
+      if (progress_callback)
+        progress_callback (offset_in, total_size, progress_callback_data);
+    }
+
+  /* Make sure we send full copied size */
+  if (progress_callback)
+    progress_callback (offset_in, total_size, progress_callback_data);
+
+  return TRUE;
+}
+#endif
+
 static gboolean
 file_copy_fallback (GFile                  *source,
                     GFile                  *destination,
@@ -3210,6 +3333,33 @@ file_copy_fallback (GFile                  *source,
     }
 #endif
 
+#ifdef HAVE_COPY_FILE_RANGE
+  if (G_IS_FILE_DESCRIPTOR_BASED (in) && G_IS_FILE_DESCRIPTOR_BASED (out))
+    {
+      GError *copy_file_range_err = NULL;
+
+      if (!copy_file_range_with_progress (in, out, cancellable,
+                                          progress_callback, progress_callback_data,
+                                          &copy_file_range_err))
+        {
+          if (g_error_matches (copy_file_range_err, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+            {
+              g_clear_error (&copy_file_range_err);
+            }
+          else
+            {
+              g_propagate_error (error, copy_file_range_err);
+              goto out;
+            }
+        }
+      else
+        {
+          ret = TRUE;
+          goto out;
+        }
+    }
+#endif
+
 #ifdef HAVE_SPLICE
   if (G_IS_FILE_DESCRIPTOR_BASED (in) && G_IS_FILE_DESCRIPTOR_BASED (out))
     {
@@ -6219,6 +6369,7 @@ typedef struct {
   GFile *source;
   GFile *destination;
   GFileCopyFlags flags;
+  guint max_workers;  /* g_file_copy_tree_async() only */
   GFileProgressCallback progress_cb;
   gpointer progress_cb_data;
 } CopyAsyncData;
@@ -6334,6 +6485,668 @@ g_file_real_copy_finish (GFile        *file,
 }
 
 
+/********************************************
+ *   Recursive operations                   *
+ ********************************************/
+
+/* A tree operation walks a directory on a private #GThreadPool. Each
+ * directory is a TreeNode; enumerating it and copying or deleting each
+ * of its entries are separate work items, so enumeration of one
+ * directory overlaps with data transfer out of others. The stat
+ * information for each entry comes from the enumerator.
+ *
+ * A node's @pending count covers its own enumeration plus every entry
+ * found in it; whichever item drops it to zero finishes the directory
+ * (applying its attributes, or deleting it) and then releases the
+ * parent, so directories are always finished after their contents.
+ */
+
+#define TREE_OP_PROGRESS_INTERVAL (100 * G_TIME_SPAN_MILLISECOND)
+
+typedef enum {
+  TREE_OP_COPY,
+  TREE_OP_DELETE
+} TreeOpType;
+
+typedef struct _TreeNode TreeNode;
+
+struct _TreeNode {
+  TreeNode *parent;
+  GFile *source;
+  GFile *destination;  /* NULL when deleting */
+  gint pending;        /* atomic */
+};
+
+typedef struct {
+  TreeOpType type;
+  GFileCopyFlags flags;
+  GCancellable *cancellable;  /* cancelled on the first error */
+  GThreadPool *pool;
+  gboolean want_progress;
+
+  GMutex mutex;
+  GCond cond;
+  guint outstanding;     /* items pushed to @pool and not yet done */
+  GError *error;
+  goffset bytes_done;
+  goffset bytes_total;
+} TreeOp;
+
+typedef struct {
+  TreeOp *op;
+  TreeNode *node;
+  GFile *source;         /* NULL to enumerate @node itself */
+  GFile *destination;
+  goffset copied;
+} TreeItem;
+
+static void
+tree_op_set_error (TreeOp *op,
+                   GError *error)
+{
+  g_mutex_lock (&op->mutex);
+  if (op->error == NULL)
+    {
+      op->error = error;
+      error = NULL;
+    }
+  g_mutex_unlock (&op->mutex);
+
+  if (error != NULL)
+    g_error_free (error);
+
+  g_cancellable_cancel (op->cancellable);
+}
+
+static void
+tree_op_push (TreeOp   *op,
+              TreeNode *node,
+              GFile    *source,
+              GFile    *destination)
+{
+  TreeItem *item;
+
+  item = g_slice_new0 (TreeItem);
+  item->op = op;
+  item->node = node;
+  item->source = source;
+  item->destination = destination;
+
+  g_mutex_lock (&op->mutex);
+  op->outstanding++;
+  g_mutex_unlock (&op->mutex);
+
+  g_thread_pool_push (op->pool, item, NULL);
+}
+
+static TreeNode *
+tree_node_new (TreeNode *parent,
+               GFile    *source,
+               GFile    *destination)
+{
+  TreeNode *node;
+
+  node = g_slice_new (TreeNode);
+  node->parent = parent;
+  node->source = source;
+  node->destination = destination;
+  node->pending = 1;
+
+  if (parent != NULL)
+    g_atomic_int_inc (&parent->pending);
+
+  return node;
+}
+
+static void
+tree_node_unref (TreeOp   *op,
+                 TreeNode *node)
+{
+  GError *error = NULL;
+  TreeNode *parent;
+
+  while (node != NULL && g_atomic_int_dec_and_test (&node->pending))
+    {
+      parent = node->parent;
+
+      if (!g_cancellable_is_cancelled (op->cancellable))
+        {
+          if (op->type == TREE_OP_COPY)
+            {
+              /* Failing to copy metadata is not a hard error, just
+               * like for g_file_copy()
+               */
+              g_file_copy_attributes (node->source, node->destination,
+                                      op->flags | G_FILE_COPY_NOFOLLOW_SYMLINKS,
+                                      op->cancellable, NULL);
+            }
+          else if (!g_file_delete (node->source, op->cancellable, &error))
+            tree_op_set_error (op, error);
+        }
+
+      g_object_unref (node->source);
+      g_clear_object (&node->destination);
+      g_slice_free (TreeNode, node);
+
+      node = parent;
+    }
+}
+
+static gboolean
+tree_op_make_directory (TreeOp   *op,
+                        TreeNode *node,
+                        GError  **error)
+{
+  GError *my_error = NULL;
+
+  if (g_file_make_directory (node->destination, op->cancellable, &my_error))
+    return TRUE;
+
+  /* Merge into an existing directory only when asked to overwrite */
+  if (g_error_matches (my_error, G_IO_ERROR, G_IO_ERROR_EXISTS) &&
+      (op->flags & G_FILE_COPY_OVERWRITE) &&
+      g_file_query_file_type (node->destination,
+                              G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                              op->cancellable) == G_FILE_TYPE_DIRECTORY)
+    {
+      g_error_free (my_error);
+      return TRUE;
+    }
+
+  g_propagate_error (error, my_error);
+  return FALSE;
+}
+
+static void
+tree_op_enumerate (TreeOp   *op,
+                   TreeNode *node)
+{
+  GFileEnumerator *enumerator = NULL;
+  GFileInfo *info;
+  GFile *child;
+  GError *error = NULL;
+
+  if (op->type == TREE_OP_COPY &&
+      !tree_op_make_directory (op, node, &error))
+    goto out;
+
+  enumerator = g_file_enumerate_children (node->source,
+                                          G_FILE_ATTRIBUTE_STANDARD_NAME ","
+                                          G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                                          G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                          op->cancellable, &error);
+  if (enumerator == NULL)
+    goto out;
+
+  while (g_file_enumerator_iterate (enumerator, &info, &child,
+                                    op->cancellable, &error) &&
+         info != NULL)
+    {
+      GFile *destination = NULL;
+
+      if (op->type == TREE_OP_COPY)
+        destination = g_file_get_child (node->destination,
+                                        g_file_info_get_name (info));
+
+      if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+        {
+          TreeNode *child_node;
+
+          child_node = tree_node_new (node, g_object_ref (child), destination);
+          tree_op_push (op, child_node, NULL, NULL);
+        }
+      else
+        {
+          if (op->want_progress)
+            {
+              g_mutex_lock (&op->mutex);
+              op->bytes_total += g_file_info_get_size (info);
+              g_mutex_unlock (&op->mutex);
+            }
+
+          g_atomic_int_inc (&node->pending);
+          tree_op_push (op, node, g_object_ref (child), destination);
+        }
+    }
+
+ out:
+  if (error != NULL)
+    tree_op_set_error (op, error);
+  g_clear_object (&enumerator);
+  tree_node_unref (op, node);
+}
+
+static void
+tree_op_copy_progress (goffset  current_num_bytes,
+                       goffset  total_num_bytes,
+                       gpointer user_data)
+{
+  TreeItem *item = user_data;
+  TreeOp *op = item->op;
+
+  g_mutex_lock (&op->mutex);
+  op->bytes_done += current_num_bytes - item->copied;
+  g_mutex_unlock (&op->mutex);
+
+  item->copied = current_num_bytes;
+}
+
+static void
+tree_op_worker (gpointer data,
+                gpointer user_data)
+{
+  TreeItem *item = data;
+  TreeOp *op = user_data;
+  GError *error = NULL;
+  gboolean ok;
+
+  if (item->source == NULL)
+    tree_op_enumerate (op, item->node);
+  else
+    {
+      if (g_cancellable_is_cancelled (op->cancellable))
+        ok = TRUE;
+      else if (op->type == TREE_OP_COPY)
+        ok = g_file_copy (item->source, item->destination,
+                          op->flags | G_FILE_COPY_NOFOLLOW_SYMLINKS,
+                          op->cancellable,
+                          op->want_progress ? tree_op_copy_progress : NULL, item,
+                          &error);
+      else
+        ok = g_file_delete (item->source, op->cancellable, &error);
+
+      if (!ok)
+        tree_op_set_error (op, error);
+
+      g_object_unref (item->source);
+      g_clear_object (&item->destination);
+      tree_node_unref (op, item->node);
+    }
+
+  g_slice_free (TreeItem, item);
+
+  g_mutex_lock (&op->mutex);
+  if (--op->outstanding == 0)
+    g_cond_broadcast (&op->cond);
+  g_mutex_unlock (&op->mutex);
+}
+
+static gboolean
+tree_op_run (TreeOpType              type,
+             GFile                  *source,
+             GFile                  *destination,
+             GFileCopyFlags          flags,
+             guint                   max_workers,
+             GCancellable           *cancellable,
+             GFileProgressCallback   progress_callback,
+             gpointer                progress_callback_data,
+             GError                **error)
+{
+  TreeOp op = { 0, };
+  GFileType file_type;
+  goffset bytes_done, bytes_total;
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return FALSE;
+
+  file_type = g_file_query_file_type (source,
+                                      (type == TREE_OP_DELETE ||
+                                       (flags & G_FILE_COPY_NOFOLLOW_SYMLINKS)) ?
+                                      G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS : 0,
+                                      cancellable);
+
+  /* Anything but a directory (including a missing source, so that the
+   * error comes from the real operation) needs no walking.
+   */
+  if (file_type != G_FILE_TYPE_DIRECTORY)
+    {
+      if (type == TREE_OP_DELETE)
+        return g_file_delete (source, cancellable, error);
+      else
+        return g_file_copy (source, destination, flags, cancellable,
+                            progress_callback, progress_callback_data,
+                            error);
+    }
+
+  if (max_workers == 0)
+    max_workers = g_get_num_processors ();
+
+  op.type = type;
+  op.flags = flags;
+  op.cancellable = cancellable ? g_cancellable_new_with_parent (cancellable) : g_cancellable_new ();
+  op.want_progress = progress_callback != NULL;
+  g_mutex_init (&op.mutex);
+  g_cond_init (&op.cond);
+  op.pool = g_thread_pool_new (tree_op_worker, &op, max_workers, FALSE, NULL);
+
+  tree_op_push (&op, tree_node_new (NULL, g_object_ref (source),
+                                    destination ? g_object_ref (destination) : NULL),
+                NULL, NULL);
+
+  /* Progress is reported from the calling thread, at most every
+   * TREE_OP_PROGRESS_INTERVAL, rather than from the workers.
+   */
+  g_mutex_lock (&op.mutex);
+  while (op.outstanding > 0)
+    {
+      if (progress_callback == NULL)
+        {
+          g_cond_wait (&op.cond, &op.mutex);
+          continue;
+        }
+
+      g_cond_wait_until (&op.cond, &op.mutex,
+                         g_get_monotonic_time () + TREE_OP_PROGRESS_INTERVAL);
+
+      bytes_done = op.bytes_done;
+      bytes_total = op.bytes_total;
+      g_mutex_unlock (&op.mutex);
+      progress_callback (bytes_done, bytes_total, progress_callback_data);
+      g_mutex_lock (&op.mutex);
+    }
+  g_mutex_unlock (&op.mutex);
+
+  g_thread_pool_free (op.pool, FALSE, TRUE);
+
+  if (op.error == NULL && progress_callback != NULL)
+    progress_callback (op.bytes_done, op.bytes_total, progress_callback_data);
+
+  g_mutex_clear (&op.mutex);
+  g_cond_clear (&op.cond);
+  g_object_unref (op.cancellable);
+
+  if (op.error != NULL)
+    {
+      g_propagate_error (error, op.error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * g_file_copy_tree:
+ * @source: input #GFile
+ * @destination: destination #GFile
+ * @flags: set of #GFileCopyFlags
+ * @max_workers: the maximum number of files to work on at once, or 0
+ *     for one per processor
+ * @cancellable: (nullable): optional #GCancellable object,
+ *     %NULL to ignore
+ * @progress_callback: (nullable) (scope call): function to callback with
+ *     progress information, or %NULL if progress information is not needed
+ * @progress_callback_data: (closure): user data to pass to @progress_callback
+ * @error: #GError to set on error, or %NULL
+ *
+ * Copies @source to @destination like g_file_copy(), except that if
+ * @source is a directory, its whole contents are copied too.
+ *
+ * The tree is walked by up to @max_workers threads at once:
+ * directories are enumerated while files found earlier are still being
+ * copied. Each file is copied with g_file_copy(), and symbolic links
+ * below @source are always copied as links. A directory's attributes
+ * are copied only after all of its contents are, so that its
+ * modification time and permissions are those of @source.
+ *
+ * If #G_FILE_COPY_OVERWRITE is specified, copying into existing
+ * directories merges with their contents and overwrites files.
+ * Otherwise an existing directory at the destination is an error.
+ *
+ * If @progress_callback is not %NULL, it is called periodically in the
+ * calling thread, with the number of bytes copied so far and the total
+ * size of the files found so far. Both counts grow as the tree is
+ * walked. It is called once more with the final totals when the
+ * copy succeeds.
+ *
+ * The first error encountered stops the operation and is returned.
+ * Files and directories copied before it are left in place.
+ *
+ * Returns: %TRUE on success, %FALSE otherwise.
+ *
+ * Since: 2.54
+ */
+gboolean
+g_file_copy_tree (GFile                  *source,
+                  GFile                  *destination,
+                  GFileCopyFlags          flags,
+                  guint                   max_workers,
+                  GCancellable           *cancellable,
+                  GFileProgressCallback   progress_callback,
+                  gpointer                progress_callback_data,
+                  GError                **error)
+{
+  g_return_val_if_fail (G_IS_FILE (source), FALSE);
+  g_return_val_if_fail (G_IS_FILE (destination), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  return tree_op_run (TREE_OP_COPY, source, destination, flags, max_workers,
+                      cancellable, progress_callback, progress_callback_data,
+                      error);
+}
+
+static void
+copy_tree_async_thread (GTask        *task,
+                        gpointer      source,
+                        gpointer      task_data,
+                        GCancellable *cancellable)
+{
+  CopyAsyncData *data = task_data;
+  GError *error = NULL;
+
+  if (g_file_copy_tree (data->source,
+                        data->destination,
+                        data->flags,
+                        data->max_workers,
+                        cancellable,
+                        (data->progress_cb != NULL) ? copy_async_progress_callback : NULL,
+                        task,
+                        &error))
+    g_task_return_boolean (task, TRUE);
+  else
+    g_task_return_error (task, error);
+}
+
+/**
+ * g_file_copy_tree_async: (skip)
+ * @source: input #GFile
+ * @destination: destination #GFile
+ * @flags: set of #GFileCopyFlags
+ * @max_workers: the maximum number of files to work on at once, or 0
+ *     for one per processor
+ * @io_priority: the [I/O priority][io-priority] of the request
+ * @cancellable: (nullable): optional #GCancellable object,
+ *     %NULL to ignore
+ * @progress_callback: (nullable): function to callback with progress
+ *     information, or %NULL if progress information is not needed
+ * @progress_callback_data: (closure): user data to pass to @progress_callback
+ * @callback: a #GAsyncReadyCallback to call when the request is satisfied
+ * @user_data: the data to pass to callback function
+ *
+ * Asynchronously copies @source and, if it is a directory, its
+ * contents to @destination. For details of the behaviour, see
+ * g_file_copy_tree().
+ *
+ * If @progress_callback is not %NULL, then that function that will be
+ * called just like in g_file_copy_tree(). The callback will run in the
+ * default main context of the thread calling g_file_copy_tree_async()
+ * — the same context as @callback is run in.
+ *
+ * When the operation is finished, @callback will be called. You can
+ * then call g_file_copy_tree_finish() to get the result of the
+ * operation.
+ *
+ * Since: 2.54
+ */
+void
+g_file_copy_tree_async (GFile                  *source,
+                        GFile                  *destination,
+                        GFileCopyFlags          flags,
+                        guint                   max_workers,
+                        int                     io_priority,
+                        GCancellable           *cancellable,
+                        GFileProgressCallback   progress_callback,
+                        gpointer                progress_callback_data,
+                        GAsyncReadyCallback     callback,
+                        gpointer                user_data)
+{
+  GTask *task;
+  CopyAsyncData *data;
+
+  g_return_if_fail (G_IS_FILE (source));
+  g_return_if_fail (G_IS_FILE (destination));
+
+  data = g_slice_new (CopyAsyncData);
+  data->source = g_object_ref (source);
+  data->destination = g_object_ref (destination);
+  data->flags = flags;
+  data->max_workers = max_workers;
+  data->progress_cb = progress_callback;
+  data->progress_cb_data = progress_callback_data;
+
+  task = g_task_new (source, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_file_copy_tree_async);
+  g_task_set_task_data (task, data, (GDestroyNotify)copy_async_data_free);
+  g_task_set_priority (task, io_priority);
+  g_task_run_in_thread (task, copy_tree_async_thread);
+  g_object_unref (task);
+}
+
+/**
+ * g_file_copy_tree_finish:
+ * @file: input #GFile
+ * @res: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes copying a file tree started with g_file_copy_tree_async().
+ *
+ * Returns: %TRUE on success, %FALSE on error.
+ *
+ * Since: 2.54
+ */
+gboolean
+g_file_copy_tree_finish (GFile         *file,
+                         GAsyncResult  *res,
+                         GError       **error)
+{
+  g_return_val_if_fail (G_IS_FILE (file), FALSE);
+  g_return_val_if_fail (g_task_is_valid (res, file), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (res), error);
+}
+
+/**
+ * g_file_delete_tree:
+ * @file: input #GFile
+ * @max_workers: the maximum number of files to work on at once, or 0
+ *     for one per processor
+ * @cancellable: (nullable): optional #GCancellable object,
+ *     %NULL to ignore
+ * @error: a #GError, or %NULL
+ *
+ * Deletes @file like g_file_delete(), except that if @file is a
+ * directory, its contents are deleted first.
+ *
+ * The tree is walked by up to @max_workers threads at once, and each
+ * directory is deleted as soon as it is empty. Symbolic links are
+ * deleted, never followed.
+ *
+ * The first error encountered stops the operation and is returned.
+ * Whatever was deleted before it stays deleted.
+ *
+ * Returns: %TRUE if the file was deleted. %FALSE otherwise.
+ *
+ * Since: 2.54
+ */
+gboolean
+g_file_delete_tree (GFile         *file,
+                    guint          max_workers,
+                    GCancellable  *cancellable,
+                    GError       **error)
+{
+  g_return_val_if_fail (G_IS_FILE (file), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  return tree_op_run (TREE_OP_DELETE, file, NULL, 0, max_workers,
+                      cancellable, NULL, NULL, error);
+}
+
+static void
+delete_tree_async_thread (GTask        *task,
+                          gpointer      object,
+                          gpointer      task_data,
+                          GCancellable *cancellable)
+{
+  GError *error = NULL;
+
+  if (g_file_delete_tree (G_FILE (object), GPOINTER_TO_UINT (task_data),
+                          cancellable, &error))
+    g_task_return_boolean (task, TRUE);
+  else
+    g_task_return_error (task, error);
+}
+
+/**
+ * g_file_delete_tree_async:
+ * @file: input #GFile
+ * @max_workers: the maximum number of files to work on at once, or 0
+ *     for one per processor
+ * @io_priority: the [I/O priority][io-priority] of the request
+ * @cancellable: (nullable): optional #GCancellable object,
+ *     %NULL to ignore
+ * @callback: a #GAsyncReadyCallback to call
+ *     when the request is satisfied
+ * @user_data: the data to pass to callback function
+ *
+ * Asynchronously deletes @file and, if it is a directory, its
+ * contents. For details of the behaviour, see g_file_delete_tree().
+ *
+ * Since: 2.54
+ */
+void
+g_file_delete_tree_async (GFile               *file,
+                          guint                max_workers,
+                          int                  io_priority,
+                          GCancellable        *cancellable,
+                          GAsyncReadyCallback  callback,
+                          gpointer             user_data)
+{
+  GTask *task;
+
+  g_return_if_fail (G_IS_FILE (file));
+
+  task = g_task_new (file, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_file_delete_tree_async);
+  g_task_set_task_data (task, GUINT_TO_POINTER (max_workers), NULL);
+  g_task_set_priority (task, io_priority);
+  g_task_run_in_thread (task, delete_tree_async_thread);
+  g_object_unref (task);
+}
+
+/**
+ * g_file_delete_tree_finish:
+ * @file: input #GFile
+ * @result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes deleting a file tree started with g_file_delete_tree_async().
+ *
+ * Returns: %TRUE if the file was deleted. %FALSE otherwise.
+ *
+ * Since: 2.54
+ */
+gboolean
+g_file_delete_tree_finish (GFile         *file,
+                           GAsyncResult  *result,
+                           GError       **error)
+{
+  g_return_val_if_fail (G_IS_FILE (file), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, file), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+
 /********************************************
  *   Default VFS operations                 *
  ********************************************/
@@ -653,6 +653,10 @@ GLIB_AVAILABLE_IN_ALL
 GFileInputStream *      g_file_read                       (GFile                      *file,
 							   GCancellable               *cancellable,
 							   GError                    **error);
+GLIB_AVAILABLE_IN_2_54
+GFileInputStream *      g_file_read_mapped                (GFile                      *file,
+							   GCancellable               *cancellable,
+							   GError                    **error);
 GLIB_AVAILABLE_IN_ALL
 void                    g_file_read_async                 (GFile                      *file,
 							   int                         io_priority,
@@ -910,6 +914,46 @@ GLIB_AVAILABLE_IN_ALL
 gboolean                g_file_copy_finish                (GFile                      *file,
 							   GAsyncResult               *res,
 							   GError                    **error);
+GLIB_AVAILABLE_IN_2_54
+gboolean                g_file_copy_tree                  (GFile                      *source,
+							   GFile                      *destination,
+							   GFileCopyFlags              flags,
+							   guint                       max_workers,
+							   GCancellable               *cancellable,
+							   GFileProgressCallback       progress_callback,
+							   gpointer                    progress_callback_data,
+							   GError                    **error);
+GLIB_AVAILABLE_IN_2_54
+void                    g_file_copy_tree_async            (GFile                      *source,
+							   GFile                      *destination,
+							   GFileCopyFlags              flags,
+							   guint                       max_workers,
+							   int                         io_priority,
+							   GCancellable               *cancellable,
+							   GFileProgressCallback       progress_callback,
+							   gpointer                    progress_callback_data,
+							   GAsyncReadyCallback         callback,
+							   gpointer                    user_data);
+GLIB_AVAILABLE_IN_2_54
+gboolean                g_file_copy_tree_finish           (GFile                      *file,
+							   GAsyncResult               *res,
+							   GError                    **error);
+GLIB_AVAILABLE_IN_2_54
+gboolean                g_file_delete_tree                (GFile                      *file,
+							   guint                       max_workers,
+							   GCancellable               *cancellable,
+							   GError                    **error);
+GLIB_AVAILABLE_IN_2_54
+void                    g_file_delete_tree_async          (GFile                      *file,
+							   guint                       max_workers,
+							   int                         io_priority,
+							   GCancellable               *cancellable,
+							   GAsyncReadyCallback         callback,
+							   gpointer                    user_data);
+GLIB_AVAILABLE_IN_2_54
+gboolean                g_file_delete_tree_finish         (GFile                      *file,
+							   GAsyncResult               *result,
+							   GError                    **error);
 GLIB_AVAILABLE_IN_ALL
 gboolean                g_file_move                       (GFile                      *source,
 							   GFile                      *destination,
@@ -25,6 +25,7 @@
 #include "gasyncresult.h"
 #include "gasynchelper.h"
 #include "gioerror.h"
+#include "gfileinfo-priv.h"
 #include "glibintl.h"
 
 struct _GFileEnumeratorPrivate {
@@ -94,6 +95,10 @@ static void     g_file_enumerator_real_close_async       (GFileEnumerator      *
 static gboolean g_file_enumerator_real_close_finish      (GFileEnumerator      *enumerator,
 							  GAsyncResult         *res,
 							  GError              **error);
+static GFileInfoList *g_file_enumerator_real_next_info_list (GFileEnumerator   *enumerator,
+                                                             guint              max_files,
+                                                             GCancellable      *cancellable,
+                                                             GError           **error);
 
 static void
 g_file_enumerator_set_property (GObject      *object,
@@ -156,6 +161,7 @@ g_file_enumerator_class_init (GFileEnumeratorClass *klass)
   klass->next_files_finish = g_file_enumerator_real_next_files_finish;
   klass->close_async = g_file_enumerator_real_close_async;
   klass->close_finish = g_file_enumerator_real_close_finish;
+  klass->next_info_list = g_file_enumerator_real_next_info_list;
 
   g_object_class_install_property
     (gobject_class, PROP_CONTAINER,
@@ -241,6 +247,85 @@ g_file_enumerator_next_file (GFileEnumerator *enumerator,
   
   return info;
 }
+
+/**
+ * g_file_enumerator_next_info_list:
+ * @enumerator: a #GFileEnumerator.
+ * @max_files: the maximum number of files to return, greater than 0
+ * @cancellable: (nullable): optional #GCancellable object, %NULL to ignore.
+ * @error: location to store the error occurring, or %NULL to ignore
+ *
+ * Returns the next files in the enumerated object as a #GFileInfoList,
+ * which holds the name, type, size, modification time and unix mode
+ * of each of them without creating a #GFileInfo per file.  Will block
+ * until the information is available.
+ *
+ * Of these attributes, only the ones matching the attribute string
+ * that was passed when the #GFileEnumerator was created are set; other
+ * attributes in that string are not available through the list.  Some
+ * enumerators, such as the one for local files, can then skip most of
+ * the work g_file_enumerator_next_file() would do for each file.
+ *
+ * As with g_file_enumerator_next_files_async(), if an error occurs
+ * after some files have been returned, it is reported by the next
+ * call.
+ *
+ * Returns: (nullable) (transfer full): a #GFileInfoList with between
+ *     1 and @max_files entries, or %NULL on error or at the end of the
+ *     enumerator.  Free the returned list with g_file_info_list_unref().
+ *
+ * Since: 2.54
+ **/
+GFileInfoList *
+g_file_enumerator_next_info_list (GFileEnumerator  *enumerator,
+                                  guint             max_files,
+                                  GCancellable     *cancellable,
+                                  GError          **error)
+{
+  GFileEnumeratorClass *class;
+  GFileInfoList *list;
+
+  g_return_val_if_fail (G_IS_FILE_ENUMERATOR (enumerator), NULL);
+  g_return_val_if_fail (max_files > 0, NULL);
+
+  if (enumerator->priv->closed)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_CLOSED,
+                           _("Enumerator is closed"));
+      return NULL;
+    }
+
+  if (enumerator->priv->pending)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_PENDING,
+                           _("File enumerator has outstanding operation"));
+      return NULL;
+    }
+
+  if (enumerator->priv->outstanding_error)
+    {
+      g_propagate_error (error, enumerator->priv->outstanding_error);
+      enumerator->priv->outstanding_error = NULL;
+      return NULL;
+    }
+
+  class = G_FILE_ENUMERATOR_GET_CLASS (enumerator);
+
+  if (cancellable)
+    g_cancellable_push_current (cancellable);
+
+  enumerator->priv->pending = TRUE;
+  list = (* class->next_info_list) (enumerator, max_files, cancellable, error);
+  enumerator->priv->pending = FALSE;
+
+  if (cancellable)
+    g_cancellable_pop_current (cancellable);
+
+  if (list != NULL && g_file_info_list_get_length (list) == 0)
+    g_clear_pointer (&list, g_file_info_list_unref);
+
+  return list;
+}
   
 /**
  * g_file_enumerator_close:
@@ -792,6 +877,51 @@ next_files_thread (GTask        *task,
     g_task_return_pointer (task, files, (GDestroyNotify)next_async_op_free);
 }
 
+static GFileInfoList *
+g_file_enumerator_real_next_info_list (GFileEnumerator  *enumerator,
+                                       guint             max_files,
+                                       GCancellable     *cancellable,
+                                       GError          **error)
+{
+  GFileEnumeratorClass *class;
+  GFileInfoList *list;
+  GError *my_error = NULL;
+  GFileInfo *info;
+  guint i;
+
+  class = G_FILE_ENUMERATOR_GET_CLASS (enumerator);
+  list = _g_file_info_list_new ();
+
+  for (i = 0; i < max_files; i++)
+    {
+      info = class->next_file (enumerator, cancellable, &my_error);
+      if (info == NULL)
+        break;
+
+      _g_file_info_list_append_info (list, info);
+      g_object_unref (info);
+    }
+
+  if (my_error == NULL)
+    return list;
+
+  if (i > 0)
+    {
+      /* Like next_files_thread(), return the error on the next call */
+      if (g_error_matches (my_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_error_free (my_error);
+      else
+        enumerator->priv->outstanding_error = my_error;
+
+      return list;
+    }
+
+  g_file_info_list_unref (list);
+  g_propagate_error (error, my_error);
+
+  return NULL;
+}
+
 static void
 g_file_enumerator_real_next_files_async (GFileEnumerator     *enumerator,
 					 int                  num_files,
@@ -83,9 +83,13 @@ struct _GFileEnumeratorClass
                                      GAsyncResult         *result,
                                      GError              **error);
 
+  GFileInfoList * (* next_info_list) (GFileEnumerator    *enumerator,
+                                      guint               max_files,
+                                      GCancellable       *cancellable,
+                                      GError            **error);
+
   /*< private >*/
   /* Padding for future expansion */
-  void (*_g_reserved1) (void);
   void (*_g_reserved2) (void);
   void (*_g_reserved3) (void);
   void (*_g_reserved4) (void);
@@ -101,6 +105,11 @@ GLIB_AVAILABLE_IN_ALL
 GFileInfo *g_file_enumerator_next_file         (GFileEnumerator      *enumerator,
 						GCancellable         *cancellable,
 						GError              **error);
+GLIB_AVAILABLE_IN_2_54
+GFileInfoList *g_file_enumerator_next_info_list (GFileEnumerator    *enumerator,
+                                                 guint               max_files,
+                                                 GCancellable       *cancellable,
+                                                 GError            **error);
 GLIB_AVAILABLE_IN_ALL
 gboolean   g_file_enumerator_close             (GFileEnumerator      *enumerator,
 						GCancellable         *cancellable,
@@ -138,5 +138,21 @@ void               _g_file_info_set_attribute_stringv_by_id     (GFileInfo
                                                                  guint32                attribute,
 							         char                 **attr_value);
 
+#define FILE_INFO_LIST_HAS_TYPE  (1 << 0)
+#define FILE_INFO_LIST_HAS_SIZE  (1 << 1)
+#define FILE_INFO_LIST_HAS_MTIME (1 << 2)
+#define FILE_INFO_LIST_HAS_MODE  (1 << 3)
+
+GFileInfoList *    _g_file_info_list_new                        (void);
+void               _g_file_info_list_append                     (GFileInfoList         *list,
+                                                                 const char            *name,
+                                                                 guint                  fields,
+                                                                 GFileType              type,
+                                                                 goffset                size,
+                                                                 gint64                 mtime,
+                                                                 guint32                mode);
+void               _g_file_info_list_append_info                (GFileInfoList         *list,
+                                                                 GFileInfo             *info);
+
 
 #endif /* __G_FILE_INFO_PRIV_H__ */
@@ -2185,6 +2185,365 @@ g_file_info_set_sort_order (GFileInfo *info,
 }
 
 
+/**
+ * GFileInfoList:
+ *
+ * A #GFileInfoList holds the most commonly needed attributes of a batch
+ * of files compactly, as returned by g_file_enumerator_next_info_list().
+ * The entries share their storage, so reading a large directory does
+ * not need a #GFileInfo object, and a hash table of attributes, per
+ * file.
+ *
+ * Each entry always has a name.  The file type, size, modification
+ * time and unix mode are available for entries whose #GFileEnumerator
+ * was asked for %G_FILE_ATTRIBUTE_STANDARD_TYPE,
+ * %G_FILE_ATTRIBUTE_STANDARD_SIZE, %G_FILE_ATTRIBUTE_TIME_MODIFIED and
+ * %G_FILE_ATTRIBUTE_UNIX_MODE respectively; use
+ * g_file_info_list_get_info() to tell those that were not set apart
+ * from zero values.
+ *
+ * Since: 2.54
+ */
+
+typedef struct {
+  const char *name;
+  goffset size;
+  gint64 mtime;
+  guint32 mode;
+  guint8 type;
+  guint8 fields;
+} FileInfoRecord;
+
+struct _GFileInfoList {
+  gint ref_count;
+
+  GArray *records;
+  GStringChunk *names;
+};
+
+G_DEFINE_BOXED_TYPE (GFileInfoList, g_file_info_list,
+                     g_file_info_list_ref,
+                     g_file_info_list_unref)
+
+GFileInfoList *
+_g_file_info_list_new (void)
+{
+  GFileInfoList *list;
+
+  list = g_slice_new (GFileInfoList);
+  list->ref_count = 1;
+  list->records = g_array_new (FALSE, FALSE, sizeof (FileInfoRecord));
+  list->names = g_string_chunk_new (4096);
+
+  return list;
+}
+
+/* @fields is a combination of the FILE_INFO_LIST_HAS_* flags, telling
+ * which of the other values are set.
+ */
+void
+_g_file_info_list_append (GFileInfoList *list,
+                          const char    *name,
+                          guint          fields,
+                          GFileType      type,
+                          goffset        size,
+                          gint64         mtime,
+                          guint32        mode)
+{
+  FileInfoRecord record;
+
+  record.name = g_string_chunk_insert (list->names, name);
+  record.fields = fields;
+  record.type = type;
+  record.size = size;
+  record.mtime = mtime;
+  record.mode = mode;
+
+  g_array_append_val (list->records, record);
+}
+
+void
+_g_file_info_list_append_info (GFileInfoList *list,
+                               GFileInfo     *info)
+{
+  GFileAttributeValue *value;
+  const char *name;
+  guint fields = 0;
+  GFileType type = G_FILE_TYPE_UNKNOWN;
+  goffset size = 0;
+  gint64 mtime = 0;
+  guint32 mode = 0;
+
+  name = g_file_info_get_name (info);
+  if (name == NULL)
+    return;
+
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_TYPE);
+  if (value)
+    {
+      fields |= FILE_INFO_LIST_HAS_TYPE;
+      type = _g_file_attribute_value_get_uint32 (value);
+    }
+
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_SIZE);
+  if (value)
+    {
+      fields |= FILE_INFO_LIST_HAS_SIZE;
+      size = _g_file_attribute_value_get_uint64 (value);
+    }
+
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_TIME_MODIFIED);
+  if (value)
+    {
+      fields |= FILE_INFO_LIST_HAS_MTIME;
+      mtime = _g_file_attribute_value_get_uint64 (value) * G_USEC_PER_SEC;
+      value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_TIME_MODIFIED_USEC);
+      mtime += _g_file_attribute_value_get_uint32 (value);
+    }
+
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_UNIX_MODE);
+  if (value)
+    {
+      fields |= FILE_INFO_LIST_HAS_MODE;
+      mode = _g_file_attribute_value_get_uint32 (value);
+    }
+
+  _g_file_info_list_append (list, name, fields, type, size, mtime, mode);
+}
+
+/**
+ * g_file_info_list_ref:
+ * @list: a #GFileInfoList
+ *
+ * Increases the reference count of @list.
+ *
+ * Returns: (transfer full): @list
+ *
+ * Since: 2.54
+ */
+GFileInfoList *
+g_file_info_list_ref (GFileInfoList *list)
+{
+  g_return_val_if_fail (list != NULL, NULL);
+
+  g_atomic_int_inc (&list->ref_count);
+
+  return list;
+}
+
+/**
+ * g_file_info_list_unref:
+ * @list: (transfer full): a #GFileInfoList
+ *
+ * Decreases the reference count of @list, freeing it once it drops
+ * to zero.  Names returned by g_file_info_list_get_name() are no
+ * longer valid after that.
+ *
+ * Since: 2.54
+ */
+void
+g_file_info_list_unref (GFileInfoList *list)
+{
+  g_return_if_fail (list != NULL);
+
+  if (g_atomic_int_dec_and_test (&list->ref_count))
+    {
+      g_array_unref (list->records);
+      g_string_chunk_free (list->names);
+      g_slice_free (GFileInfoList, list);
+    }
+}
+
+/**
+ * g_file_info_list_get_length:
+ * @list: a #GFileInfoList
+ *
+ * Gets the number of entries in @list.
+ *
+ * Returns: the number of entries
+ *
+ * Since: 2.54
+ */
+guint
+g_file_info_list_get_length (GFileInfoList *list)
+{
+  g_return_val_if_fail (list != NULL, 0);
+
+  return list->records->len;
+}
+
+static const FileInfoRecord *
+g_file_info_list_get_record (GFileInfoList *list,
+                             guint          index_)
+{
+  g_return_val_if_fail (list != NULL, NULL);
+  g_return_val_if_fail (index_ < list->records->len, NULL);
+
+  return &g_array_index (list->records, FileInfoRecord, index_);
+}
+
+/**
+ * g_file_info_list_get_name:
+ * @list: a #GFileInfoList
+ * @index_: the index of an entry in @list
+ *
+ * Gets the name of the file at @index_, like g_file_info_get_name().
+ *
+ * Returns: (type filename): the file's name, owned by @list
+ *
+ * Since: 2.54
+ */
+const char *
+g_file_info_list_get_name (GFileInfoList *list,
+                           guint          index_)
+{
+  const FileInfoRecord *record;
+
+  record = g_file_info_list_get_record (list, index_);
+  g_return_val_if_fail (record != NULL, NULL);
+
+  return record->name;
+}
+
+/**
+ * g_file_info_list_get_file_type:
+ * @list: a #GFileInfoList
+ * @index_: the index of an entry in @list
+ *
+ * Gets the type of the file at @index_, like
+ * g_file_info_get_file_type().
+ *
+ * Returns: the file's #GFileType, or %G_FILE_TYPE_UNKNOWN if not set
+ *
+ * Since: 2.54
+ */
+GFileType
+g_file_info_list_get_file_type (GFileInfoList *list,
+                                guint          index_)
+{
+  const FileInfoRecord *record;
+
+  record = g_file_info_list_get_record (list, index_);
+  g_return_val_if_fail (record != NULL, G_FILE_TYPE_UNKNOWN);
+
+  return record->type;
+}
+
+/**
+ * g_file_info_list_get_size:
+ * @list: a #GFileInfoList
+ * @index_: the index of an entry in @list
+ *
+ * Gets the size of the file at @index_, like g_file_info_get_size().
+ *
+ * Returns: the file's size, or 0 if not set
+ *
+ * Since: 2.54
+ */
+goffset
+g_file_info_list_get_size (GFileInfoList *list,
+                           guint          index_)
+{
+  const FileInfoRecord *record;
+
+  record = g_file_info_list_get_record (list, index_);
+  g_return_val_if_fail (record != NULL, 0);
+
+  return record->size;
+}
+
+/**
+ * g_file_info_list_get_modification_time:
+ * @list: a #GFileInfoList
+ * @index_: the index of an entry in @list
+ *
+ * Gets the modification time of the file at @index_, like
+ * g_file_info_get_modification_time().
+ *
+ * Returns: the file's modification time, in microseconds since
+ *     January 1, 1970 UTC, or 0 if not set
+ *
+ * Since: 2.54
+ */
+gint64
+g_file_info_list_get_modification_time (GFileInfoList *list,
+                                        guint          index_)
+{
+  const FileInfoRecord *record;
+
+  record = g_file_info_list_get_record (list, index_);
+  g_return_val_if_fail (record != NULL, 0);
+
+  return record->mtime;
+}
+
+/**
+ * g_file_info_list_get_unix_mode:
+ * @list: a #GFileInfoList
+ * @index_: the index of an entry in @list
+ *
+ * Gets the mode of the file at @index_, as in
+ * %G_FILE_ATTRIBUTE_UNIX_MODE.
+ *
+ * Returns: the file's mode, or 0 if not set
+ *
+ * Since: 2.54
+ */
+guint32
+g_file_info_list_get_unix_mode (GFileInfoList *list,
+                                guint          index_)
+{
+  const FileInfoRecord *record;
+
+  record = g_file_info_list_get_record (list, index_);
+  g_return_val_if_fail (record != NULL, 0);
+
+  return record->mode;
+}
+
+/**
+ * g_file_info_list_get_info:
+ * @list: a #GFileInfoList
+ * @index_: the index of an entry in @list
+ *
+ * Creates a #GFileInfo holding the attributes that are set for the
+ * entry at @index_.
+ *
+ * Returns: (transfer full): a new #GFileInfo
+ *
+ * Since: 2.54
+ */
+GFileInfo *
+g_file_info_list_get_info (GFileInfoList *list,
+                           guint          index_)
+{
+  const FileInfoRecord *record;
+  GFileInfo *info;
+
+  record = g_file_info_list_get_record (list, index_);
+  g_return_val_if_fail (record != NULL, NULL);
+
+  info = g_file_info_new ();
+  g_file_info_set_name (info, record->name);
+
+  if (record->fields & FILE_INFO_LIST_HAS_TYPE)
+    g_file_info_set_file_type (info, record->type);
+  if (record->fields & FILE_INFO_LIST_HAS_SIZE)
+    g_file_info_set_size (info, record->size);
+  if (record->fields & FILE_INFO_LIST_HAS_MTIME)
+    {
+      _g_file_info_set_attribute_uint64_by_id (info, G_FILE_ATTRIBUTE_ID_TIME_MODIFIED,
+                                               record->mtime / G_USEC_PER_SEC);
+      _g_file_info_set_attribute_uint32_by_id (info, G_FILE_ATTRIBUTE_ID_TIME_MODIFIED_USEC,
+                                               record->mtime % G_USEC_PER_SEC);
+    }
+  if (record->fields & FILE_INFO_LIST_HAS_MODE)
+    _g_file_info_set_attribute_uint32_by_id (info, G_FILE_ATTRIBUTE_ID_UNIX_MODE,
+                                             record->mode);
+
+  return info;
+}
+
 typedef struct {
   guint32 id;
   guint32 mask;
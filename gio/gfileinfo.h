@@ -1074,6 +1074,35 @@ GLIB_AVAILABLE_IN_ALL
 void              g_file_info_set_sort_order         (GFileInfo         *info,
 						      gint32             sort_order);
 
+#define G_TYPE_FILE_INFO_LIST (g_file_info_list_get_type ())
+GLIB_AVAILABLE_IN_2_54
+GType              g_file_info_list_get_type              (void) G_GNUC_CONST;
+
+GLIB_AVAILABLE_IN_2_54
+GFileInfoList *    g_file_info_list_ref                   (GFileInfoList *list);
+GLIB_AVAILABLE_IN_2_54
+void               g_file_info_list_unref                 (GFileInfoList *list);
+GLIB_AVAILABLE_IN_2_54
+guint              g_file_info_list_get_length            (GFileInfoList *list);
+GLIB_AVAILABLE_IN_2_54
+const char *       g_file_info_list_get_name              (GFileInfoList *list,
+                                                           guint          index_);
+GLIB_AVAILABLE_IN_2_54
+GFileType          g_file_info_list_get_file_type         (GFileInfoList *list,
+                                                           guint          index_);
+GLIB_AVAILABLE_IN_2_54
+goffset            g_file_info_list_get_size              (GFileInfoList *list,
+                                                           guint          index_);
+GLIB_AVAILABLE_IN_2_54
+gint64             g_file_info_list_get_modification_time (GFileInfoList *list,
+                                                           guint          index_);
+GLIB_AVAILABLE_IN_2_54
+guint32            g_file_info_list_get_unix_mode         (GFileInfoList *list,
+                                                           guint          index_);
+GLIB_AVAILABLE_IN_2_54
+GFileInfo *        g_file_info_list_get_info              (GFileInfoList *list,
+                                                           guint          index_);
+
 #define G_TYPE_FILE_ATTRIBUTE_MATCHER (g_file_attribute_matcher_get_type ())
 GLIB_AVAILABLE_IN_ALL
 GType g_file_attribute_matcher_get_type (void) G_GNUC_CONST;
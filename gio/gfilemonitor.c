@@ -65,6 +65,7 @@ enum
 };
 
 static guint g_file_monitor_changed_signal;
+static guint g_file_monitor_changes_signal;
 
 static void
 g_file_monitor_set_property (GObject      *object,
@@ -124,6 +125,25 @@ g_file_monitor_dispose (GObject *object)
   G_OBJECT_CLASS (g_file_monitor_parent_class)->dispose (object);
 }
 
+static void
+g_file_monitor_real_changes (GFileMonitor             *monitor,
+                             const GFileMonitorChange *changes,
+                             guint                     n_changes)
+{
+  guint i;
+
+  /* Most users only care for one of the two signals, so avoid the
+   * per-event emissions entirely if nobody is listening to them.
+   */
+  if (G_FILE_MONITOR_GET_CLASS (monitor)->changed == NULL &&
+      !g_signal_has_handler_pending (monitor, g_file_monitor_changed_signal, 0, TRUE))
+    return;
+
+  for (i = 0; i < n_changes && !monitor->priv->cancelled; i++)
+    g_signal_emit (monitor, g_file_monitor_changed_signal, 0,
+                   changes[i].file, changes[i].other_file, changes[i].event_type);
+}
+
 static void
 g_file_monitor_init (GFileMonitor *monitor)
 {
@@ -140,6 +160,8 @@ g_file_monitor_class_init (GFileMonitorClass *klass)
   object_class->get_property = g_file_monitor_get_property;
   object_class->set_property = g_file_monitor_set_property;
 
+  klass->changes = g_file_monitor_real_changes;
+
   /**
    * GFileMonitor::changed:
    * @monitor: a #GFileMonitor.
@@ -185,6 +207,36 @@ g_file_monitor_class_init (GFileMonitorClass *klass)
                                                 G_TYPE_NONE, 3,
                                                 G_TYPE_FILE, G_TYPE_FILE, G_TYPE_FILE_MONITOR_EVENT);
 
+  /**
+   * GFileMonitor::changes:
+   * @monitor: a #GFileMonitor.
+   * @changes: (array length=n_changes): the #GFileMonitorChange<!-- -->s
+   * @n_changes: the length of @changes
+   *
+   * Emitted once for each group of changes that the monitor delivers
+   * together, typically all the events that arrived since the last
+   * main loop iteration.  The changes are as described for
+   * #GFileMonitor::changed, in the order they happened.
+   *
+   * Processing a burst of events from this signal is a lot cheaper
+   * than handling one #GFileMonitor::changed emission each.  The
+   * default handler emits #GFileMonitor::changed for each of the
+   * changes, but only if something is connected to it.
+   *
+   * Backends that do not batch their events emit this signal for
+   * each event on its own.  See also %G_FILE_MONITOR_COALESCE_EVENTS.
+   *
+   * Since: 2.54
+   **/
+  g_file_monitor_changes_signal = g_signal_new (I_("changes"),
+                                                G_TYPE_FILE_MONITOR,
+                                                G_SIGNAL_RUN_LAST,
+                                                G_STRUCT_OFFSET (GFileMonitorClass, changes),
+                                                NULL, NULL,
+                                                NULL,
+                                                G_TYPE_NONE, 2,
+                                                G_TYPE_POINTER, G_TYPE_UINT);
+
   g_object_class_install_property (object_class, PROP_RATE_LIMIT,
                                    g_param_spec_int ("rate-limit",
                                                      P_("Rate limit"),
@@ -287,5 +339,40 @@ g_file_monitor_emit_event (GFileMonitor      *monitor,
   if (monitor->priv->cancelled)
     return;
 
-  g_signal_emit (monitor, g_file_monitor_changed_signal, 0, child, other_file, event_type);
+  if (g_signal_has_handler_pending (monitor, g_file_monitor_changes_signal, 0, TRUE) ||
+      G_FILE_MONITOR_GET_CLASS (monitor)->changes != g_file_monitor_real_changes)
+    {
+      GFileMonitorChange change = { child, other_file, event_type };
+
+      g_signal_emit (monitor, g_file_monitor_changes_signal, 0, &change, 1);
+    }
+  else
+    g_signal_emit (monitor, g_file_monitor_changed_signal, 0, child, other_file, event_type);
+}
+
+/**
+ * g_file_monitor_emit_events:
+ * @monitor: a #GFileMonitor.
+ * @changes: (array length=n_changes): the changes to report
+ * @n_changes: the length of @changes
+ *
+ * Emits the #GFileMonitor::changes signal for a group of changes,
+ * which in turn emits #GFileMonitor::changed for each of them.
+ * Should be called from file monitor implementations only, with the
+ * same restrictions as g_file_monitor_emit_event().
+ *
+ * Since: 2.54
+ **/
+void
+g_file_monitor_emit_events (GFileMonitor             *monitor,
+                            const GFileMonitorChange *changes,
+                            guint                     n_changes)
+{
+  g_return_if_fail (G_IS_FILE_MONITOR (monitor));
+  g_return_if_fail (changes != NULL || n_changes == 0);
+
+  if (monitor->priv->cancelled || n_changes == 0)
+    return;
+
+  g_signal_emit (monitor, g_file_monitor_changes_signal, 0, changes, n_changes);
 }
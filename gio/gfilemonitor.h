@@ -38,6 +38,25 @@ G_BEGIN_DECLS
 
 typedef struct _GFileMonitorClass       GFileMonitorClass;
 typedef struct _GFileMonitorPrivate	GFileMonitorPrivate;
+typedef struct _GFileMonitorChange      GFileMonitorChange;
+
+/**
+ * GFileMonitorChange:
+ * @file: the #GFile that changed
+ * @other_file: (nullable): the other #GFile involved in the event, as
+ *   for #GFileMonitor::changed
+ * @event_type: the #GFileMonitorEvent
+ *
+ * A single change, as delivered by #GFileMonitor::changes.
+ *
+ * Since: 2.54
+ */
+struct _GFileMonitorChange
+{
+  GFile             *file;
+  GFile             *other_file;
+  GFileMonitorEvent  event_type;
+};
 
 /**
  * GFileMonitor:
@@ -65,9 +84,13 @@ struct _GFileMonitorClass
   /* Virtual Table */
   gboolean (* cancel)  (GFileMonitor      *monitor);
 
+  /* Signals */
+  void     (* changes) (GFileMonitor             *monitor,
+                        const GFileMonitorChange *changes,
+                        guint                     n_changes);
+
   /*< private >*/
   /* Padding for future expansion */
-  void (*_g_reserved1) (void);
   void (*_g_reserved2) (void);
   void (*_g_reserved3) (void);
   void (*_g_reserved4) (void);
@@ -92,6 +115,10 @@ void     g_file_monitor_emit_event     (GFileMonitor      *monitor,
                                         GFile             *child,
                                         GFile             *other_file,
                                         GFileMonitorEvent  event_type);
+GLIB_AVAILABLE_IN_2_54
+void     g_file_monitor_emit_events    (GFileMonitor             *monitor,
+                                        const GFileMonitorChange *changes,
+                                        guint                     n_changes);
 
 G_END_DECLS
 
@@ -29,6 +29,7 @@
 #include "gasyncresult.h"
 #include "gioerror.h"
 #include "gpollableinputstream.h"
+#include "gbufferpool.h"
 
 /**
  * SECTION:ginputstream
@@ -306,6 +307,11 @@ g_input_stream_read_all (GInputStream  *stream,
  *
  * On error %NULL is returned and @error is set accordingly.
  *
+ * Streams that already hold their data in memory can implement the
+ * #GInputStreamClass.read_bytes virtual function to return a reference
+ * to that memory instead of copying it; all other streams fall back to
+ * g_input_stream_read() into a newly allocated buffer.
+ *
  * Returns: a new #GBytes, or %NULL on error
  *
  * Since: 2.34
@@ -316,9 +322,44 @@ g_input_stream_read_bytes (GInputStream  *stream,
 			   GCancellable  *cancellable,
 			   GError       **error)
 {
+  GInputStreamClass *class;
   guchar *buf;
   gssize nread;
 
+  g_return_val_if_fail (G_IS_INPUT_STREAM (stream), NULL);
+
+  class = G_INPUT_STREAM_GET_CLASS (stream);
+
+  if (class->read_bytes != NULL)
+    {
+      GBytes *bytes;
+
+      if (count == 0)
+        return g_bytes_new_static ("", 0);
+
+      if (((gssize) count) < 0)
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                       _("Too large count value passed to %s"), G_STRFUNC);
+          return NULL;
+        }
+
+      if (!g_input_stream_set_pending (stream, error))
+        return NULL;
+
+      if (cancellable)
+        g_cancellable_push_current (cancellable);
+
+      bytes = class->read_bytes (stream, count, cancellable, error);
+
+      if (cancellable)
+        g_cancellable_pop_current (cancellable);
+
+      g_input_stream_clear_pending (stream);
+
+      return bytes;
+    }
+
   buf = g_malloc (count);
   nread = g_input_stream_read (stream, buf, count, cancellable, error);
   if (nread == -1)
@@ -876,6 +917,73 @@ read_bytes_callback (GObject      *stream,
   g_object_unref (task);
 }
 
+static void read_bytes_pollable (GPollableInputStream *stream,
+                                 GTask                *task);
+
+static gboolean
+read_bytes_pollable_ready (GPollableInputStream *stream,
+                           gpointer              user_data)
+{
+  GTask *task = user_data;
+
+  read_bytes_pollable (stream, task);
+  return FALSE;
+}
+
+static void
+read_bytes_pollable (GPollableInputStream *stream,
+                     GTask                *task)
+{
+  gsize count = GPOINTER_TO_SIZE (g_task_get_task_data (task));
+  GError *error = NULL;
+  GSource *source;
+  gpointer buf;
+  gssize nread;
+
+  if (g_cancellable_set_error_if_cancelled (g_task_get_cancellable (task), &error))
+    {
+      g_input_stream_clear_pending (G_INPUT_STREAM (stream));
+      g_task_return_error (task, error);
+      return;
+    }
+
+  /* Only take a buffer from the pool once there is data to put in it,
+   * so that streams waiting for input do not pin any memory.
+   */
+  if (g_pollable_input_stream_is_readable (stream))
+    {
+      buf = _g_buffer_pool_alloc (count);
+      nread = G_POLLABLE_INPUT_STREAM_GET_INTERFACE (stream)->
+        read_nonblocking (stream, buf, count, &error);
+
+      if (nread >= 0)
+        {
+          g_input_stream_clear_pending (G_INPUT_STREAM (stream));
+          g_task_return_pointer (task,
+                                 _g_buffer_pool_bytes_new_take (buf, nread),
+                                 (GDestroyNotify)g_bytes_unref);
+          return;
+        }
+
+      _g_buffer_pool_free (buf);
+
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+        {
+          g_input_stream_clear_pending (G_INPUT_STREAM (stream));
+          g_task_return_error (task, error);
+          return;
+        }
+
+      g_clear_error (&error);
+    }
+
+  source = g_pollable_input_stream_create_source (stream,
+                                                  g_task_get_cancellable (task));
+  g_task_attach_source (task, source,
+                        (GSourceFunc) read_bytes_pollable_ready);
+  g_source_unref (source);
+}
+
 /**
  * g_input_stream_read_bytes_async:
  * @stream: A #GInputStream.
@@ -906,6 +1014,11 @@ read_bytes_callback (GObject      *stream,
  * value) will be executed before an outstanding request with lower
  * priority. Default priority is %G_PRIORITY_DEFAULT.
  *
+ * For pollable streams such as socket streams, no memory is allocated
+ * while waiting: the data is read into a buffer from a pool shared by
+ * all streams once @stream becomes readable. This makes it cheap to
+ * keep a read outstanding on a large number of mostly idle streams.
+ *
  * Since: 2.34
  **/
 void
@@ -916,12 +1029,36 @@ g_input_stream_read_bytes_async (GInputStream          *stream,
 				 GAsyncReadyCallback    callback,
 				 gpointer               user_data)
 {
+  GInputStreamClass *class;
   GTask *task;
   guchar *buf;
 
   task = g_task_new (stream, cancellable, callback, user_data);
   g_task_set_source_tag (task, g_input_stream_read_bytes_async);
 
+  class = G_INPUT_STREAM_GET_CLASS (stream);
+
+  /* Streams whose default read_async would poll anyway are read directly
+   * into a pooled buffer once they become readable.
+   */
+  if (class->read_async == g_input_stream_real_read_async &&
+      !g_input_stream_async_read_is_via_threads (stream) &&
+      (gssize) count > 0)
+    {
+      GError *error = NULL;
+
+      g_task_set_priority (task, io_priority);
+      g_task_set_task_data (task, GSIZE_TO_POINTER (count), NULL);
+
+      if (g_input_stream_set_pending (stream, &error))
+        read_bytes_pollable (G_POLLABLE_INPUT_STREAM (stream), task);
+      else
+        g_task_return_error (task, error);
+
+      g_object_unref (task);
+      return;
+    }
+
   buf = g_malloc (count);
   g_task_set_task_data (task, buf, NULL);
 
@@ -100,9 +100,14 @@ struct _GInputStreamClass
                              GAsyncResult        *result,
                              GError             **error);
 
+  /* Sync ops: (optional in derived classes) */
+  GBytes * (* read_bytes)   (GInputStream        *stream,
+                             gsize                count,
+                             GCancellable        *cancellable,
+                             GError             **error);
+
   /*< private >*/
   /* Padding for future expansion */
-  void (*_g_reserved1) (void);
   void (*_g_reserved2) (void);
   void (*_g_reserved3) (void);
   void (*_g_reserved4) (void);
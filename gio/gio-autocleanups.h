@@ -67,6 +67,7 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC(GFile, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GFileAttributeInfoList, g_file_attribute_info_list_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GFileIcon, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GFileInfo, g_object_unref)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GFileInfoList, g_file_info_list_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GFileInputStream, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GFileIOStream, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GFileMonitor, g_object_unref)
@@ -34,6 +34,7 @@
 #include <gio/gapplicationcommandline.h>
 #include <gio/gasyncinitable.h>
 #include <gio/gasyncresult.h>
+#include <gio/gbase64converter.h>
 #include <gio/gbufferedinputstream.h>
 #include <gio/gbufferedoutputstream.h>
 #include <gio/gbytesicon.h>
@@ -144,6 +145,7 @@
 #include <gio/gtlsfiledatabase.h>
 #include <gio/gtlsinteraction.h>
 #include <gio/gtlsserverconnection.h>
+#include <gio/gtlssessioncache.h>
 #include <gio/gtlspassword.h>
 #include <gio/gvfs.h>
 #include <gio/gvolume.h>
@@ -336,6 +336,16 @@ typedef enum {
  *   monitored directory.  This causes %G_FILE_MONITOR_EVENT_RENAMED,
  *   %G_FILE_MONITOR_EVENT_MOVED_IN and %G_FILE_MONITOR_EVENT_MOVED_OUT
  *   events to be emitted when possible.  Since: 2.46.
+ * @G_FILE_MONITOR_WATCH_RECURSIVE: Watch for changes anywhere below a
+ *   monitored directory, not just to its direct children; the child
+ *   of each event can then be at any depth.  Only some backends
+ *   support this, for the others creating the monitor fails with
+ *   %G_IO_ERROR_NOT_SUPPORTED.  Since: 2.54.
+ * @G_FILE_MONITOR_COALESCE_EVENTS: Of the events for a file that are
+ *   delivered together, only report the last %G_FILE_MONITOR_EVENT_CHANGED,
+ *   %G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED and
+ *   %G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT event.  Useful to keep
+ *   bursts of changes cheap; see #GFileMonitor::changes.  Since: 2.54.
  *
  * Flags used to set what a #GFileMonitor will watch for.
  */
@@ -344,7 +354,9 @@ typedef enum {
   G_FILE_MONITOR_WATCH_MOUNTS     = (1 << 0),
   G_FILE_MONITOR_SEND_MOVED       = (1 << 1),
   G_FILE_MONITOR_WATCH_HARD_LINKS = (1 << 2),
-  G_FILE_MONITOR_WATCH_MOVES      = (1 << 3)
+  G_FILE_MONITOR_WATCH_MOVES      = (1 << 3),
+  G_FILE_MONITOR_WATCH_RECURSIVE  = (1 << 4),
+  G_FILE_MONITOR_COALESCE_EVENTS  = (1 << 5)
 } GFileMonitorFlags;
 
 
@@ -894,6 +906,20 @@ typedef enum {
   G_ZLIB_COMPRESSOR_FORMAT_RAW
 } GZlibCompressorFormat;
 
+/**
+ * GBase64ConverterMode:
+ * @G_BASE64_CONVERTER_ENCODE: encode binary data to Base-64 text
+ * @G_BASE64_CONVERTER_DECODE: decode Base-64 text to binary data
+ *
+ * Used to select the direction of a #GBase64Converter.
+ *
+ * Since: 2.54
+ */
+typedef enum {
+  G_BASE64_CONVERTER_ENCODE,
+  G_BASE64_CONVERTER_DECODE
+} GBase64ConverterMode;
+
 /**
  * GUnixSocketAddressType:
  * @G_UNIX_SOCKET_ADDRESS_INVALID: invalid
@@ -994,6 +1020,11 @@ typedef enum
  * do not ask the bus to launch an owner during proxy initialization, but allow it to be
  * autostarted by a method call. This flag is only meaningful in proxies for well-known names,
  * and only if %G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START is not also specified.
+ * @G_DBUS_PROXY_FLAGS_GET_PROPERTIES_ON_DEMAND: Don't load all properties at
+ * construction time. Instead each property is retrieved the first time it
+ * is looked up with g_dbus_proxy_get_cached_property(), and from then on
+ * kept up to date through the `PropertiesChanged` D-Bus signal. Properties
+ * that have never been looked up are not cached. Since: 2.54.
  *
  * Flags used when constructing an instance of a #GDBusProxy derived class.
  *
@@ -1006,7 +1037,8 @@ typedef enum
   G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS = (1<<1),
   G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START = (1<<2),
   G_DBUS_PROXY_FLAGS_GET_INVALIDATED_PROPERTIES = (1<<3),
-  G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START_AT_CONSTRUCTION = (1<<4)
+  G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START_AT_CONSTRUCTION = (1<<4),
+  G_DBUS_PROXY_FLAGS_GET_PROPERTIES_ON_DEMAND = (1<<5)
 } GDBusProxyFlags;
 
 /**
@@ -1467,6 +1499,12 @@ typedef enum
  * @G_APPLICATION_CAN_OVERRIDE_APP_ID: Allow users to override the
  *     application ID from the command line with `--gapplication-app-id`.
  *     Since: 2.48
+ * @G_APPLICATION_PEER_SOCKET: Let remote instances reach the primary
+ *     instance through a private socket in `$XDG_RUNTIME_DIR` rather than
+ *     through the session bus. This saves every remote instance the cost
+ *     of registering on the bus, but the bus policy no longer applies to
+ *     what they send, so only set it if that is acceptable for the
+ *     application. It has to be set in both instances. Since: 2.54
  *
  * Flags used to define the behaviour of a #GApplication.
  *
@@ -1484,7 +1522,9 @@ typedef enum
 
   G_APPLICATION_NON_UNIQUE =           (1 << 5),
 
-  G_APPLICATION_CAN_OVERRIDE_APP_ID =  (1 << 6)
+  G_APPLICATION_CAN_OVERRIDE_APP_ID =  (1 << 6),
+
+  G_APPLICATION_PEER_SOCKET =          (1 << 7)
 } GApplicationFlags;
 
 /**
@@ -1589,6 +1629,23 @@ typedef enum {
   G_TLS_REHANDSHAKE_UNSAFELY
 } GTlsRehandshakeMode;
 
+/**
+ * GTlsOffloadCipher:
+ * @G_TLS_OFFLOAD_CIPHER_AES_128_GCM: AES with a 128-bit key in GCM mode
+ * @G_TLS_OFFLOAD_CIPHER_AES_256_GCM: AES with a 256-bit key in GCM mode
+ * @G_TLS_OFFLOAD_CIPHER_CHACHA20_POLY1305: ChaCha20 with Poly1305
+ *
+ * The record ciphers a #GTlsConnection can hand off to the kernel. See
+ * g_tls_connection_offload().
+ *
+ * Since: 2.54
+ */
+typedef enum {
+  G_TLS_OFFLOAD_CIPHER_AES_128_GCM,
+  G_TLS_OFFLOAD_CIPHER_AES_256_GCM,
+  G_TLS_OFFLOAD_CIPHER_CHACHA20_POLY1305
+} GTlsOffloadCipher;
+
 /**
  * GTlsPasswordFlags:
  * @G_TLS_PASSWORD_NONE: No flags
@@ -1656,6 +1713,12 @@ typedef enum
  *   manager is for a well-known name, then request the bus to launch
  *   an owner for the name if no-one owns the name. This flag can only
  *   be used in managers for well-known names.
+ * @G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_GET_OBJECTS_PAGED: Retrieve the remote
+ *   objects in several smaller messages using the
+ *   `org.gtk.GDBus.PagedObjectManager` interface implemented by
+ *   #GDBusObjectManagerServer, falling back to a single
+ *   `GetManagedObjects` call if the remote object manager doesn't
+ *   implement it. Since: 2.54.
  *
  * Flags used when constructing a #GDBusObjectManagerClient.
  *
@@ -1664,7 +1727,8 @@ typedef enum
 typedef enum
 {
   G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_NONE = 0,
-  G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_DO_NOT_AUTO_START = (1<<0)
+  G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_DO_NOT_AUTO_START = (1<<0),
+  G_DBUS_OBJECT_MANAGER_CLIENT_FLAGS_GET_OBJECTS_PAGED = (1<<1)
 } GDBusObjectManagerClientFlags;
 
 /**
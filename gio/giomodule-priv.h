@@ -26,7 +26,7 @@
 G_BEGIN_DECLS
 
 void _g_io_modules_ensure_extension_points_registered (void);
-void _g_io_modules_ensure_loaded                      (void);
+void _g_io_modules_ensure_extension_point_loaded      (const char *extension_point);
 
 typedef gboolean (*GIOModuleVerifyFunc) (gpointer);
 gpointer _g_io_module_get_default (const gchar         *extension_point,
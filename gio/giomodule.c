@@ -113,7 +113,10 @@
  *  points they implement, GIO makes use of a caching mechanism,
  *  see [gio-querymodules][gio-querymodules].
  *  You are expected to run this command after installing a
- *  GIO module.
+ *  GIO module. Modules that are missing from the cache are opened
+ *  to call their g_io_module_query() function, if they have one,
+ *  but are only initialized once one of their extension points is
+ *  used.
  *
  *  The `GIO_EXTRA_MODULES` environment variable can be used to
  *  specify additional directories to automatically load modules
@@ -414,6 +417,45 @@ is_valid_module_name (const gchar        *basename,
  *
  * Since: 2.30
  **/
+static void
+add_lazy_load_module (GIOModule  *module,
+                      char      **extension_points)
+{
+  GIOExtensionPoint *extension_point;
+  int i;
+
+  for (i = 0; extension_points[i] != NULL; i++)
+    {
+      extension_point = g_io_extension_point_register (extension_points[i]);
+      extension_point->lazy_load_modules =
+        g_list_prepend (extension_point->lazy_load_modules, module);
+    }
+}
+
+/* Asks a module which extension points it implements, without
+ * initializing it. Returns %NULL if the module can't be opened or
+ * doesn't export g_io_module_query().
+ */
+static char **
+query_module (const char *path)
+{
+  char **(* query) (void);
+  char **extension_points = NULL;
+  GModule *library;
+
+  library = g_module_open (path, G_MODULE_BIND_LAZY | G_MODULE_BIND_LOCAL);
+  if (!library)
+    return NULL;
+
+  if (g_module_symbol (library, "g_io_module_query", (gpointer) &query) &&
+      query != NULL)
+    extension_points = query ();
+
+  g_module_close (library);
+
+  return extension_points;
+}
+
 void
 g_io_modules_scan_all_in_directory_with_scope (const char     *dirname,
                                                GIOModuleScope *scope)
@@ -488,11 +530,9 @@ g_io_modules_scan_all_in_directory_with_scope (const char     *dirname,
     {
       if (is_valid_module_name (name, scope))
 	{
-	  GIOExtensionPoint *extension_point;
 	  GIOModule *module;
 	  gchar *path;
 	  char **extension_points;
-	  int i;
 
 	  path = g_build_filename (dirname, name, NULL);
 	  module = g_io_module_new (path);
@@ -503,14 +543,16 @@ g_io_modules_scan_all_in_directory_with_scope (const char     *dirname,
 	      statbuf.st_ctime <= cache_mtime)
 	    {
 	      /* Lazy load/init the library when first required */
-	      for (i = 0; extension_points[i] != NULL; i++)
-		{
-		  extension_point =
-		    g_io_extension_point_register (extension_points[i]);
-		  extension_point->lazy_load_modules =
-		    g_list_prepend (extension_point->lazy_load_modules,
-				    module);
-		}
+	      add_lazy_load_module (module, extension_points);
+	    }
+	  else if ((extension_points = query_module (path)) != NULL)
+	    {
+	      /* Not in the cache, but the module can tell us which
+	       * extension points it implements without being initialized,
+	       * so it can still be loaded lazily.
+	       */
+	      add_lazy_load_module (module, extension_points);
+	      g_strfreev (extension_points);
 	    }
 	  else
 	    {
@@ -723,7 +765,7 @@ _g_io_module_get_default_type (const gchar *extension_point,
       default_modules = g_hash_table_new (g_str_hash, g_str_equal);
     }
 
-  _g_io_modules_ensure_loaded ();
+  _g_io_modules_ensure_extension_point_loaded (extension_point);
   ep = g_io_extension_point_lookup (extension_point);
 
   if (!ep)
@@ -847,7 +889,7 @@ _g_io_module_get_default (const gchar         *extension_point,
       default_modules = g_hash_table_new (g_str_hash, g_str_equal);
     }
 
-  _g_io_modules_ensure_loaded ();
+  _g_io_modules_ensure_extension_point_loaded (extension_point);
   ep = g_io_extension_point_lookup (extension_point);
 
   if (!ep)
@@ -900,6 +942,7 @@ G_LOCK_DEFINE_STATIC (loaded_dirs);
 
 extern GType g_fen_file_monitor_get_type (void);
 extern GType g_inotify_file_monitor_get_type (void);
+extern GType g_fanotify_file_monitor_get_type (void);
 extern GType g_kqueue_file_monitor_get_type (void);
 extern GType g_win32_file_monitor_get_type (void);
 
@@ -993,6 +1036,9 @@ _g_io_modules_ensure_extension_points_registered (void)
       ep = g_io_extension_point_register (G_NFS_FILE_MONITOR_EXTENSION_POINT_NAME);
       g_io_extension_point_set_required_type (ep, G_TYPE_LOCAL_FILE_MONITOR);
 
+      ep = g_io_extension_point_register (G_RECURSIVE_FILE_MONITOR_EXTENSION_POINT_NAME);
+      g_io_extension_point_set_required_type (ep, G_TYPE_LOCAL_FILE_MONITOR);
+
       ep = g_io_extension_point_register (G_VOLUME_MONITOR_EXTENSION_POINT_NAME);
       g_io_extension_point_set_required_type (ep, G_TYPE_VOLUME_MONITOR);
       
@@ -1057,15 +1103,91 @@ get_gio_module_dir (void)
   return module_dir;
 }
 
-void
-_g_io_modules_ensure_loaded (void)
+/* The implementations built into GIO, and the extension point each one
+ * implements. Their types are only registered once something looks at
+ * that extension point, so that programs don't pay for the ones they
+ * don't use. Entries without an extension point are always registered.
+ */
+typedef struct {
+  const gchar *extension_point;
+  GType (* get_type) (void);
+} BuiltinExtension;
+
+static const BuiltinExtension builtin_extensions[] = {
+  { G_SETTINGS_BACKEND_EXTENSION_POINT_NAME, g_null_settings_backend_get_type },
+  { G_SETTINGS_BACKEND_EXTENSION_POINT_NAME, g_memory_settings_backend_get_type },
+#if defined(HAVE_INOTIFY_INIT1)
+  { G_LOCAL_FILE_MONITOR_EXTENSION_POINT_NAME, g_inotify_file_monitor_get_type },
+#endif
+#if defined(HAVE_FANOTIFY)
+  { G_RECURSIVE_FILE_MONITOR_EXTENSION_POINT_NAME, g_fanotify_file_monitor_get_type },
+#endif
+#if defined(HAVE_KQUEUE)
+  { G_LOCAL_FILE_MONITOR_EXTENSION_POINT_NAME, g_kqueue_file_monitor_get_type },
+#endif
+#if defined(HAVE_FEN)
+  { G_LOCAL_FILE_MONITOR_EXTENSION_POINT_NAME, g_fen_file_monitor_get_type },
+#endif
+#ifdef G_OS_WIN32
+  { G_NATIVE_VOLUME_MONITOR_EXTENSION_POINT_NAME, _g_win32_volume_monitor_get_type },
+  { G_LOCAL_FILE_MONITOR_EXTENSION_POINT_NAME, g_win32_file_monitor_get_type },
+  { G_SETTINGS_BACKEND_EXTENSION_POINT_NAME, g_registry_backend_get_type },
+#endif
+#ifdef HAVE_COCOA
+  { G_SETTINGS_BACKEND_EXTENSION_POINT_NAME, g_nextstep_settings_backend_get_type },
+  { NULL, g_osx_app_info_get_type },
+#endif
+#ifdef G_OS_UNIX
+  { G_NATIVE_VOLUME_MONITOR_EXTENSION_POINT_NAME, _g_unix_volume_monitor_get_type },
+  { G_NOTIFICATION_BACKEND_EXTENSION_POINT_NAME, g_fdo_notification_backend_get_type },
+  { G_NOTIFICATION_BACKEND_EXTENSION_POINT_NAME, g_gtk_notification_backend_get_type },
+  { G_NOTIFICATION_BACKEND_EXTENSION_POINT_NAME, g_portal_notification_backend_get_type },
+  { G_NETWORK_MONITOR_EXTENSION_POINT_NAME, g_network_monitor_portal_get_type },
+  { G_PROXY_RESOLVER_EXTENSION_POINT_NAME, g_proxy_resolver_portal_get_type },
+#endif
+#if HAVE_MAC_OS_X_VERSION_MIN_REQUIRED >= 1090
+  { G_NOTIFICATION_BACKEND_EXTENSION_POINT_NAME, g_cocoa_notification_backend_get_type },
+#endif
+#ifdef G_OS_WIN32
+  { G_VFS_EXTENSION_POINT_NAME, _g_winhttp_vfs_get_type },
+#endif
+  { G_VFS_EXTENSION_POINT_NAME, _g_local_vfs_get_type },
+  { G_PROXY_RESOLVER_EXTENSION_POINT_NAME, _g_dummy_proxy_resolver_get_type },
+  { G_PROXY_EXTENSION_POINT_NAME, _g_http_proxy_get_type },
+  { G_PROXY_EXTENSION_POINT_NAME, _g_https_proxy_get_type },
+  { G_PROXY_EXTENSION_POINT_NAME, _g_socks4a_proxy_get_type },
+  { G_PROXY_EXTENSION_POINT_NAME, _g_socks4_proxy_get_type },
+  { G_PROXY_EXTENSION_POINT_NAME, _g_socks5_proxy_get_type },
+  { G_TLS_BACKEND_EXTENSION_POINT_NAME, _g_dummy_tls_backend_get_type },
+  { G_NETWORK_MONITOR_EXTENSION_POINT_NAME, g_network_monitor_base_get_type },
+#ifdef HAVE_NETLINK
+  { G_NETWORK_MONITOR_EXTENSION_POINT_NAME, _g_network_monitor_netlink_get_type },
+  { G_NETWORK_MONITOR_EXTENSION_POINT_NAME, _g_network_monitor_nm_get_type },
+#endif
+};
+
+static void
+ensure_builtin_extensions (const char *extension_point)
+{
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (builtin_extensions); i++)
+    {
+      const BuiltinExtension *builtin = &builtin_extensions[i];
+
+      if (builtin->extension_point == NULL ||
+          strcmp (builtin->extension_point, extension_point) == 0)
+        g_type_ensure (builtin->get_type ());
+    }
+}
+
+static void
+ensure_module_dirs_scanned (void)
 {
   static gboolean loaded_dirs = FALSE;
   const char *module_path;
   GIOModuleScope *scope;
 
-  _g_io_modules_ensure_extension_points_registered ();
-  
   G_LOCK (loaded_dirs);
 
   if (!loaded_dirs)
@@ -1099,60 +1221,29 @@ _g_io_modules_ensure_loaded (void)
       g_free (module_dir);
 
       g_io_module_scope_free (scope);
-
-      /* Initialize types from built-in "modules" */
-      g_type_ensure (g_null_settings_backend_get_type ());
-      g_type_ensure (g_memory_settings_backend_get_type ());
-#if defined(HAVE_INOTIFY_INIT1)
-      g_type_ensure (g_inotify_file_monitor_get_type ());
-#endif
-#if defined(HAVE_KQUEUE)
-      g_type_ensure (g_kqueue_file_monitor_get_type ());
-#endif
-#if defined(HAVE_FEN)
-      g_type_ensure (g_fen_file_monitor_get_type ());
-#endif
-#ifdef G_OS_WIN32
-      g_type_ensure (_g_win32_volume_monitor_get_type ());
-      g_type_ensure (g_win32_file_monitor_get_type ());
-      g_type_ensure (g_registry_backend_get_type ());
-#endif
-#ifdef HAVE_COCOA
-      g_type_ensure (g_nextstep_settings_backend_get_type ());
-      g_type_ensure (g_osx_app_info_get_type ());
-#endif
-#ifdef G_OS_UNIX
-      g_type_ensure (_g_unix_volume_monitor_get_type ());
-      g_type_ensure (g_fdo_notification_backend_get_type ());
-      g_type_ensure (g_gtk_notification_backend_get_type ());
-      g_type_ensure (g_portal_notification_backend_get_type ());
-      g_type_ensure (g_network_monitor_portal_get_type ());
-      g_type_ensure (g_proxy_resolver_portal_get_type ());
-#endif
-#if HAVE_MAC_OS_X_VERSION_MIN_REQUIRED >= 1090
-      g_type_ensure (g_cocoa_notification_backend_get_type ());
-#endif
-#ifdef G_OS_WIN32
-      g_type_ensure (_g_winhttp_vfs_get_type ());
-#endif
-      g_type_ensure (_g_local_vfs_get_type ());
-      g_type_ensure (_g_dummy_proxy_resolver_get_type ());
-      g_type_ensure (_g_http_proxy_get_type ());
-      g_type_ensure (_g_https_proxy_get_type ());
-      g_type_ensure (_g_socks4a_proxy_get_type ());
-      g_type_ensure (_g_socks4_proxy_get_type ());
-      g_type_ensure (_g_socks5_proxy_get_type ());
-      g_type_ensure (_g_dummy_tls_backend_get_type ());
-      g_type_ensure (g_network_monitor_base_get_type ());
-#ifdef HAVE_NETLINK
-      g_type_ensure (_g_network_monitor_netlink_get_type ());
-      g_type_ensure (_g_network_monitor_nm_get_type ());
-#endif
     }
 
   G_UNLOCK (loaded_dirs);
 }
 
+/*
+ * _g_io_modules_ensure_extension_point_loaded:
+ * @extension_point: the name of an extension point
+ *
+ * Makes sure that the implementations of @extension_point are
+ * available: the module directories are scanned (which loads modules
+ * lazily, see g_io_modules_scan_all_in_directory()), and the types of
+ * the implementations of @extension_point built into GIO are
+ * registered.
+ */
+void
+_g_io_modules_ensure_extension_point_loaded (const char *extension_point)
+{
+  _g_io_modules_ensure_extension_points_registered ();
+  ensure_module_dirs_scanned ();
+  ensure_builtin_extensions (extension_point);
+}
+
 static void
 g_io_extension_point_free (GIOExtensionPoint *ep)
 {
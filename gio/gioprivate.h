@@ -23,17 +23,37 @@
 #include "goutputstream.h"
 #include "gsocketconnection.h"
 #include "gsocketaddress.h"
+#include "gsocketlistener.h"
 
 G_BEGIN_DECLS
 
 gboolean g_input_stream_async_read_is_via_threads (GInputStream *stream);
 gboolean g_input_stream_async_close_is_via_threads (GInputStream *stream);
 gboolean g_output_stream_async_write_is_via_threads (GOutputStream *stream);
+gboolean g_output_stream_async_writev_is_via_threads (GOutputStream *stream);
 gboolean g_output_stream_async_close_is_via_threads (GOutputStream *stream);
 
+gint64 g_cancellable_get_poll_timeout (GCancellable *cancellable,
+                                       gint64        timeout);
+
 void g_socket_connection_set_cached_remote_address (GSocketConnection *connection,
                                                     GSocketAddress    *address);
 
+GSocket *g_socket_accept_nonblocking (GSocket  *socket,
+                                      GError  **error);
+gssize   g_socket_send_vectors_with_blocking (GSocket              *socket,
+                                              const GOutputVector  *vectors,
+                                              gint                  num_vectors,
+                                              gboolean              blocking,
+                                              GCancellable         *cancellable,
+                                              GError              **error);
+
+GPtrArray *g_socket_listener_get_sockets        (GSocketListener *listener);
+GObject   *g_socket_listener_get_source_object  (GSocketListener *listener,
+                                                 GSocket         *socket);
+void       g_socket_listener_add_shard_socket   (GSocketListener *listener,
+                                                 GSocket         *socket);
+
 
 G_END_DECLS
 
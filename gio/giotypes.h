@@ -33,6 +33,7 @@ typedef struct _GAppLaunchContext             GAppLaunchContext;
 typedef struct _GAppInfo                      GAppInfo; /* Dummy typedef */
 typedef struct _GAsyncResult                  GAsyncResult; /* Dummy typedef */
 typedef struct _GAsyncInitable                GAsyncInitable;
+typedef struct _GBase64Converter              GBase64Converter;
 typedef struct _GBufferedInputStream          GBufferedInputStream;
 typedef struct _GBufferedOutputStream         GBufferedOutputStream;
 typedef struct _GCancellable                  GCancellable;
@@ -90,6 +91,7 @@ typedef struct _GFileInfo                     GFileInfo;
  * Determines if a string matches a file attribute.
  **/
 typedef struct _GFileAttributeMatcher         GFileAttributeMatcher;
+typedef struct _GFileInfoList                 GFileInfoList;
 typedef struct _GFileAttributeInfo            GFileAttributeInfo;
 typedef struct _GFileAttributeInfoList        GFileAttributeInfoList;
 typedef struct _GFileDescriptorBased          GFileDescriptorBased;
@@ -643,6 +645,25 @@ typedef struct _GSubprocess                   GSubprocess;
  */
 typedef struct _GSubprocessLauncher           GSubprocessLauncher;
 
+/**
+ * GSubprocessOutputFunc:
+ * @subprocess: the #GSubprocess the data was read from
+ * @bytes: the data that was read, never empty
+ * @is_stderr: %TRUE if @bytes came from the stderr pipe, %FALSE if it
+ *     came from the stdout pipe
+ * @user_data: user data passed to g_subprocess_communicate_stream()
+ *
+ * The type of the function called by g_subprocess_communicate_stream()
+ * for each chunk of output as it arrives.  Take a reference on @bytes
+ * to keep it.
+ *
+ * Since: 2.54
+ */
+typedef void (*GSubprocessOutputFunc) (GSubprocess *subprocess,
+                                       GBytes      *bytes,
+                                       gboolean     is_stderr,
+                                       gpointer     user_data);
+
 G_END_DECLS
 
 #endif /* __GIO_TYPES_H__ */
@@ -0,0 +1,539 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "giouring.h"
+#include "gcancellable.h"
+#include "gioerror.h"
+#include "gtask.h"
+#include "glibintl.h"
+
+/* Asynchronous reads and writes on local files normally run the
+ * blocking call in a GTask worker thread. With GIO_USE_IO_URING=1 in
+ * the environment, and a kernel that supports it, they are instead
+ * submitted to an io_uring that belongs to the GMainContext of the
+ * task, and completed from a GSource watching the ring; no thread is
+ * involved.
+ *
+ * Reads and writes use the current file position (offset -1), like
+ * read() and write() do, so mixing them with synchronous calls and
+ * seeks on the same stream keeps working. GIO never has more than one
+ * operation pending on a stream, so the position is well defined.
+ */
+
+#if defined (HAVE_LINUX_IO_URING_H)
+#include <linux/io_uring.h>
+#endif
+
+#if defined (HAVE_LINUX_IO_URING_H) && defined (IORING_FEAT_RW_CUR_POS)
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "glib-unix.h"
+
+#define RING_ENTRIES 256
+
+typedef struct {
+  GSource source;
+  GMainContext *context;
+
+  gint fd;
+  gpointer fd_tag;
+
+  /* Protects the submission queue; tasks may be started from a thread
+   * other than the one running the context.
+   */
+  GMutex lock;
+
+  guint *sq_head;
+  guint *sq_tail;
+  guint *sq_mask;
+  guint *sq_array;
+  guint sq_entries;
+  struct io_uring_sqe *sqes;
+
+  guint *cq_head;
+  guint *cq_tail;
+  guint *cq_mask;
+  struct io_uring_cqe *cqes;
+
+  gpointer sq_ring;
+  gsize sq_ring_size;
+  gpointer cq_ring;
+  gsize cq_ring_size;
+  gsize sqes_size;
+} IoUring;
+
+typedef struct {
+  GTask *task;
+  IoUring *ring;
+  GSource *cancel_source;
+  guint8 opcode;
+} IoUringOp;
+
+/* The contexts that have a ring, and their rings */
+G_LOCK_DEFINE_STATIC (rings);
+static GHashTable *rings;
+
+static gint
+io_uring_setup (guint                   entries,
+                struct io_uring_params *params)
+{
+  return syscall (__NR_io_uring_setup, entries, params);
+}
+
+static gint
+io_uring_enter (gint  fd,
+                guint to_submit)
+{
+  return syscall (__NR_io_uring_enter, fd, to_submit, 0, 0, NULL, 0);
+}
+
+static gboolean
+probe_ring (void)
+{
+  struct io_uring_params params;
+  gint fd;
+
+  memset (&params, 0, sizeof params);
+  fd = io_uring_setup (1, &params);
+  if (fd < 0)
+    return FALSE;
+  close (fd);
+
+  /* Without this, offset -1 doesn't mean the current position */
+  return (params.features & IORING_FEAT_RW_CUR_POS) != 0;
+}
+
+gboolean
+_g_io_uring_is_enabled (void)
+{
+  static gsize enabled = 0;
+
+  if (g_once_init_enter (&enabled))
+    {
+      gboolean result;
+
+      result = g_strcmp0 (g_getenv ("GIO_USE_IO_URING"), "1") == 0 && probe_ring ();
+      g_once_init_leave (&enabled, result ? 2 : 1);
+    }
+
+  return enabled == 2;
+}
+
+static gboolean
+io_uring_source_prepare (GSource *source,
+                         gint    *timeout)
+{
+  IoUring *ring = (IoUring *) source;
+
+  *timeout = -1;
+
+  return *ring->cq_head != (guint) g_atomic_int_get ((gint *) ring->cq_tail);
+}
+
+static gboolean
+io_uring_source_check (GSource *source)
+{
+  gint timeout;
+
+  return io_uring_source_prepare (source, &timeout);
+}
+
+static void io_uring_op_complete (IoUringOp *op,
+                                  gint       result);
+
+static gboolean
+io_uring_source_dispatch (GSource     *source,
+                          GSourceFunc  callback,
+                          gpointer     user_data)
+{
+  IoUring *ring = (IoUring *) source;
+  guint head, tail;
+
+  head = *ring->cq_head;
+  tail = g_atomic_int_get ((gint *) ring->cq_tail);
+
+  while (head != tail)
+    {
+      struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+      IoUringOp *op = GSIZE_TO_POINTER ((gsize) cqe->user_data);
+      gint result = cqe->res;
+
+      /* Hand the entry back before completing, which may submit more */
+      head++;
+      g_atomic_int_set ((gint *) ring->cq_head, head);
+
+      /* cancellation requests have no operation of their own */
+      if (op != NULL)
+        io_uring_op_complete (op, result);
+
+      tail = g_atomic_int_get ((gint *) ring->cq_tail);
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+io_uring_source_finalize (GSource *source)
+{
+  IoUring *ring = (IoUring *) source;
+
+  G_LOCK (rings);
+  if (rings && g_hash_table_lookup (rings, ring->context) == ring)
+    g_hash_table_remove (rings, ring->context);
+  G_UNLOCK (rings);
+
+  munmap (ring->sqes, ring->sqes_size);
+  if (ring->cq_ring != ring->sq_ring)
+    munmap (ring->cq_ring, ring->cq_ring_size);
+  munmap (ring->sq_ring, ring->sq_ring_size);
+  close (ring->fd);
+  g_mutex_clear (&ring->lock);
+}
+
+static GSourceFuncs io_uring_source_funcs = {
+  io_uring_source_prepare,
+  io_uring_source_check,
+  io_uring_source_dispatch,
+  io_uring_source_finalize
+};
+
+static IoUring *
+io_uring_new (GMainContext *context)
+{
+  struct io_uring_params params;
+  gpointer sq_ring, cq_ring, sqes;
+  gsize sq_ring_size, cq_ring_size, sqes_size;
+  IoUring *ring;
+  gint fd;
+
+  memset (&params, 0, sizeof params);
+  fd = io_uring_setup (RING_ENTRIES, &params);
+  if (fd < 0)
+    return NULL;
+
+  sq_ring_size = params.sq_off.array + params.sq_entries * sizeof (guint);
+  cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof (struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP)
+    sq_ring_size = cq_ring_size = MAX (sq_ring_size, cq_ring_size);
+  sqes_size = params.sq_entries * sizeof (struct io_uring_sqe);
+
+  sq_ring = mmap (NULL, sq_ring_size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (sq_ring == MAP_FAILED)
+    goto fail;
+
+  if (params.features & IORING_FEAT_SINGLE_MMAP)
+    cq_ring = sq_ring;
+  else
+    {
+      cq_ring = mmap (NULL, cq_ring_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+      if (cq_ring == MAP_FAILED)
+        {
+          munmap (sq_ring, sq_ring_size);
+          goto fail;
+        }
+    }
+
+  sqes = mmap (NULL, sqes_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED)
+    {
+      if (cq_ring != sq_ring)
+        munmap (cq_ring, cq_ring_size);
+      munmap (sq_ring, sq_ring_size);
+      goto fail;
+    }
+
+  ring = (IoUring *) g_source_new (&io_uring_source_funcs, sizeof (IoUring));
+  g_source_set_name ((GSource *) ring, "GIO io_uring");
+  g_mutex_init (&ring->lock);
+  ring->context = context;
+  ring->fd = fd;
+
+  ring->sq_ring = sq_ring;
+  ring->sq_ring_size = sq_ring_size;
+  ring->cq_ring = cq_ring;
+  ring->cq_ring_size = cq_ring_size;
+  ring->sqes = sqes;
+  ring->sqes_size = sqes_size;
+
+  ring->sq_head = (guint *) ((guint8 *) sq_ring + params.sq_off.head);
+  ring->sq_tail = (guint *) ((guint8 *) sq_ring + params.sq_off.tail);
+  ring->sq_mask = (guint *) ((guint8 *) sq_ring + params.sq_off.ring_mask);
+  ring->sq_array = (guint *) ((guint8 *) sq_ring + params.sq_off.array);
+  ring->sq_entries = params.sq_entries;
+
+  ring->cq_head = (guint *) ((guint8 *) cq_ring + params.cq_off.head);
+  ring->cq_tail = (guint *) ((guint8 *) cq_ring + params.cq_off.tail);
+  ring->cq_mask = (guint *) ((guint8 *) cq_ring + params.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe *) ((guint8 *) cq_ring + params.cq_off.cqes);
+
+  ring->fd_tag = g_source_add_unix_fd ((GSource *) ring, fd, G_IO_IN);
+  g_source_attach ((GSource *) ring, context);
+
+  return ring;
+
+ fail:
+  close (fd);
+  return NULL;
+}
+
+/* Returns the ring of @context, creating it if needed, with a
+ * reference for the caller.
+ */
+static IoUring *
+io_uring_get (GMainContext *context)
+{
+  IoUring *ring;
+
+  if (context == NULL)
+    context = g_main_context_default ();
+
+  G_LOCK (rings);
+  if (rings == NULL)
+    rings = g_hash_table_new (NULL, NULL);
+
+  ring = g_hash_table_lookup (rings, context);
+  if (ring == NULL || g_source_is_destroyed ((GSource *) ring))
+    {
+      ring = io_uring_new (context);
+      if (ring != NULL)
+        {
+          g_hash_table_insert (rings, context, ring);
+
+          /* the context keeps the ring alive from now on */
+          g_source_unref ((GSource *) ring);
+        }
+    }
+
+  if (ring != NULL)
+    g_source_ref ((GSource *) ring);
+  G_UNLOCK (rings);
+
+  return ring;
+}
+
+/* Queues a submission and tells the kernel about it */
+static gboolean
+io_uring_submit (IoUring       *ring,
+                 guint8         opcode,
+                 gint           fd,
+                 gconstpointer  addr,
+                 gsize          len,
+                 gpointer       user_data)
+{
+  struct io_uring_sqe *sqe;
+  guint head, tail, index;
+  gint ret;
+
+  g_mutex_lock (&ring->lock);
+
+  head = g_atomic_int_get ((gint *) ring->sq_head);
+  tail = *ring->sq_tail;
+  if (tail - head >= ring->sq_entries)
+    {
+      g_mutex_unlock (&ring->lock);
+      return FALSE;
+    }
+
+  index = tail & *ring->sq_mask;
+  sqe = &ring->sqes[index];
+  memset (sqe, 0, sizeof *sqe);
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->off = (guint64) -1;
+  sqe->addr = (gsize) addr;
+  sqe->len = MIN (len, G_MAXINT32);
+  sqe->user_data = (gsize) user_data;
+
+  ring->sq_array[index] = index;
+  g_atomic_int_set ((gint *) ring->sq_tail, tail + 1);
+
+  do
+    ret = io_uring_enter (ring->fd, 1);
+  while (ret < 0 && errno == EINTR);
+
+  /* Nobody else touches the tail while we hold the lock, and the kernel
+   * only looks at it from io_uring_enter(), so the entry can be taken
+   * back if the kernel refused it.
+   */
+  if (ret < 1)
+    g_atomic_int_set ((gint *) ring->sq_tail, tail);
+
+  g_mutex_unlock (&ring->lock);
+
+  return ret >= 1;
+}
+
+static void
+io_uring_op_free (IoUringOp *op)
+{
+  if (op->cancel_source)
+    {
+      g_source_destroy (op->cancel_source);
+      g_source_unref (op->cancel_source);
+    }
+  g_source_unref ((GSource *) op->ring);
+  g_object_unref (op->task);
+  g_slice_free (IoUringOp, op);
+}
+
+static void
+io_uring_op_complete (IoUringOp *op,
+                      gint       result)
+{
+  if (g_task_return_error_if_cancelled (op->task))
+    ;
+  else if (result < 0 && op->opcode == IORING_OP_READ)
+    g_task_return_new_error (op->task, G_IO_ERROR,
+                             g_io_error_from_errno (-result),
+                             _("Error reading from file: %s"),
+                             g_strerror (-result));
+  else if (result < 0)
+    g_task_return_new_error (op->task, G_IO_ERROR,
+                             g_io_error_from_errno (-result),
+                             _("Error writing to file: %s"),
+                             g_strerror (-result));
+  else
+    g_task_return_int (op->task, result);
+
+  io_uring_op_free (op);
+}
+
+static gboolean
+io_uring_op_cancelled (GCancellable *cancellable,
+                       gpointer      user_data)
+{
+  IoUringOp *op = user_data;
+
+  /* The operation itself still completes, with -ECANCELED or with its
+   * result if it was too late; the buffer is only released then.
+   */
+  io_uring_submit (op->ring, IORING_OP_ASYNC_CANCEL, -1, op, 0, NULL);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+io_uring_start (GTask         *task,
+                guint8         opcode,
+                gint           fd,
+                gconstpointer  buffer,
+                gsize          count)
+{
+  GCancellable *cancellable = g_task_get_cancellable (task);
+  IoUring *ring;
+  IoUringOp *op;
+
+  if (!_g_io_uring_is_enabled ())
+    return FALSE;
+
+  ring = io_uring_get (g_task_get_context (task));
+  if (ring == NULL)
+    return FALSE;
+
+  op = g_slice_new0 (IoUringOp);
+  op->task = g_object_ref (task);
+  op->ring = ring;
+  op->opcode = opcode;
+
+  if (cancellable)
+    {
+      op->cancel_source = g_cancellable_source_new (cancellable);
+      g_source_set_priority (op->cancel_source, g_task_get_priority (task));
+      g_source_set_callback (op->cancel_source, (GSourceFunc) io_uring_op_cancelled, op, NULL);
+      g_source_attach (op->cancel_source, ring->context);
+    }
+
+  if (!io_uring_submit (ring, opcode, fd, buffer, count, op))
+    {
+      io_uring_op_free (op);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*
+ * _g_io_uring_read:
+ * @task: the #GTask of the read
+ * @fd: the file descriptor to read from
+ * @buffer: where to read to
+ * @count: how much to read
+ *
+ * Starts reading from @fd at its current position, and returns the
+ * number of bytes read in @task when done.
+ *
+ * Returns: %FALSE if io_uring can't be used, and @task was left alone
+ */
+gboolean
+_g_io_uring_read (GTask       *task,
+                  gint         fd,
+                  gpointer     buffer,
+                  gsize        count)
+{
+  return io_uring_start (task, IORING_OP_READ, fd, buffer, count);
+}
+
+/*
+ * _g_io_uring_write:
+ *
+ * Like _g_io_uring_read(), but writes @buffer to @fd.
+ */
+gboolean
+_g_io_uring_write (GTask         *task,
+                   gint           fd,
+                   gconstpointer  buffer,
+                   gsize          count)
+{
+  return io_uring_start (task, IORING_OP_WRITE, fd, buffer, count);
+}
+
+#else /* !io_uring */
+
+gboolean
+_g_io_uring_is_enabled (void)
+{
+  return FALSE;
+}
+
+gboolean
+_g_io_uring_read (GTask       *task,
+                  gint         fd,
+                  gpointer     buffer,
+                  gsize        count)
+{
+  return FALSE;
+}
+
+gboolean
+_g_io_uring_write (GTask         *task,
+                   gint           fd,
+                   gconstpointer  buffer,
+                   gsize          count)
+{
+  return FALSE;
+}
+
+#endif
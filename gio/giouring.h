@@ -0,0 +1,37 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_IO_URING_H__
+#define __G_IO_URING_H__
+
+#include <gio/giotypes.h>
+
+G_BEGIN_DECLS
+
+gboolean _g_io_uring_is_enabled (void);
+
+gboolean _g_io_uring_read       (GTask         *task,
+                                 gint           fd,
+                                 gpointer       buffer,
+                                 gsize          count);
+gboolean _g_io_uring_write      (GTask         *task,
+                                 gint           fd,
+                                 gconstpointer  buffer,
+                                 gsize          count);
+
+G_END_DECLS
+
+#endif /* __G_IO_URING_H__ */
@@ -41,6 +41,11 @@
 
 typedef GSettingsBackendClass GKeyfileSettingsBackendClass;
 
+enum {
+  PROP_0,
+  PROP_WRITE_DELAY
+};
+
 typedef struct
 {
   GSettingsBackend   parent_instance;
@@ -59,6 +64,20 @@ typedef struct
   guint8             digest[32];
   GFile             *dir;
   GFileMonitor      *dir_monitor;
+
+  /* identity of the file as we last wrote or read it, to tell our own
+   * changes apart from somebody else's without reading it back
+   */
+  gboolean           stamp_valid;
+  guint64            stamp_inode;
+  guint64            stamp_mtime;
+  goffset            stamp_size;
+
+  /* write coalescing: changes made since the last write to disk */
+  guint              write_delay;
+  GMainContext      *main_context;
+  GSource           *write_source;
+  GHashTable        *dirty;
 } GKeyfileSettingsBackend;
 
 static GType g_keyfile_settings_backend_get_type (void);
@@ -81,21 +100,148 @@ compute_checksum (guint8        *digest,
   g_assert (len == 32);
 }
 
+static gboolean
+query_stamp (GKeyfileSettingsBackend *kfsb,
+             guint64                 *inode,
+             guint64                 *mtime,
+             goffset                 *size)
+{
+  GFileInfo *info;
+  gboolean valid;
+
+  info = g_file_query_info (kfsb->file,
+                            G_FILE_ATTRIBUTE_UNIX_INODE ","
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC ","
+                            G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                            G_FILE_QUERY_INFO_NONE, NULL, NULL);
+
+  if (info == NULL)
+    return FALSE;
+
+  /* without an inode number, an external rewrite within the same
+   * microsecond and of the same size would go unnoticed
+   */
+  valid = g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_UNIX_INODE) &&
+          g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+
+  if (valid)
+    {
+      *inode = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_UNIX_INODE);
+      *mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC +
+               g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+      *size = g_file_info_get_size (info);
+    }
+
+  g_object_unref (info);
+
+  return valid;
+}
+
+static void
+update_stamp (GKeyfileSettingsBackend *kfsb)
+{
+  kfsb->stamp_valid = query_stamp (kfsb, &kfsb->stamp_inode,
+                                   &kfsb->stamp_mtime, &kfsb->stamp_size);
+}
+
 static void
 g_keyfile_settings_backend_keyfile_write (GKeyfileSettingsBackend *kfsb)
 {
+  guint8 digest[32];
   gchar *contents;
   gsize length;
 
   contents = g_key_file_to_data (kfsb->keyfile, &length, NULL);
-  g_file_replace_contents (kfsb->file, contents, length, NULL, FALSE,
-                           G_FILE_CREATE_REPLACE_DESTINATION,
-                           NULL, NULL, NULL);
+  compute_checksum (digest, contents, length);
+
+  /* Nothing to do if this is exactly what we last read or wrote, eg.
+   * after setting a key back to its previous value.
+   */
+  if (memcmp (kfsb->digest, digest, sizeof digest) != 0)
+    {
+      /* replace_contents() writes a temporary file and renames it over
+       * the old one, so readers never see a partial file
+       */
+      if (g_file_replace_contents (kfsb->file, contents, length, NULL, FALSE,
+                                   G_FILE_CREATE_REPLACE_DESTINATION,
+                                   NULL, NULL, NULL))
+        update_stamp (kfsb);
+      else
+        kfsb->stamp_valid = FALSE;
+
+      memcpy (kfsb->digest, digest, sizeof digest);
+    }
 
-  compute_checksum (kfsb->digest, contents, length);
   g_free (contents);
 }
 
+static void
+g_keyfile_settings_backend_flush (GKeyfileSettingsBackend *kfsb)
+{
+  if (kfsb->write_source == NULL)
+    return;
+
+  g_source_destroy (kfsb->write_source);
+  g_source_unref (kfsb->write_source);
+  kfsb->write_source = NULL;
+
+  g_hash_table_remove_all (kfsb->dirty);
+
+  g_keyfile_settings_backend_keyfile_write (kfsb);
+}
+
+static gboolean
+g_keyfile_settings_backend_write_timeout (gpointer user_data)
+{
+  GKeyfileSettingsBackend *kfsb = user_data;
+
+  g_keyfile_settings_backend_flush (kfsb);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+remove_dirty_below (gpointer key,
+                    gpointer value,
+                    gpointer user_data)
+{
+  return g_str_has_prefix (key, user_data);
+}
+
+/* Called after @key was changed in the in-memory keyfile: writes it out
+ * now, or remembers the change and makes sure a write is scheduled.
+ * The remembered changes are replayed on top of the file if somebody
+ * else modifies it before we got around to writing.
+ */
+static void
+g_keyfile_settings_backend_keyfile_changed (GKeyfileSettingsBackend *kfsb,
+                                            const gchar             *key,
+                                            GVariant                *value)
+{
+  if (kfsb->write_delay == 0)
+    {
+      g_keyfile_settings_backend_keyfile_write (kfsb);
+      return;
+    }
+
+  /* resetting a path supersedes earlier changes below it */
+  if (g_str_has_suffix (key, "/"))
+    g_hash_table_foreach_remove (kfsb->dirty, remove_dirty_below, (gpointer) key);
+
+  g_hash_table_insert (kfsb->dirty, g_strdup (key),
+                       value ? g_variant_ref_sink (value) : NULL);
+
+  if (kfsb->write_source == NULL)
+    {
+      kfsb->write_source = g_timeout_source_new (kfsb->write_delay);
+      g_source_set_callback (kfsb->write_source,
+                             g_keyfile_settings_backend_write_timeout,
+                             kfsb, NULL);
+      g_source_attach (kfsb->write_source, kfsb->main_context);
+    }
+}
+
 static gboolean
 group_name_matches (const gchar *group_name,
                     const gchar *prefix)
@@ -173,6 +319,13 @@ path_is_valid (GKeyfileSettingsBackend *kfsb,
   return convert_path (kfsb, path, NULL, NULL);
 }
 
+static void
+dirty_value_free (gpointer data)
+{
+  if (data != NULL)
+    g_variant_unref (data);
+}
+
 static GVariant *
 get_from_keyfile (GKeyfileSettingsBackend *kfsb,
                   const GVariantType      *type,
@@ -246,6 +399,26 @@ set_to_keyfile (GKeyfileSettingsBackend *kfsb,
   return FALSE;
 }
 
+/* Reapplies the changes that are not on disk yet to a freshly loaded
+ * keyfile.  Resets of whole paths go first so that they don't undo
+ * later writes below them.
+ */
+static void
+g_keyfile_settings_backend_replay_dirty (GKeyfileSettingsBackend *kfsb)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+  gint pass;
+
+  for (pass = 0; pass < 2; pass++)
+    {
+      g_hash_table_iter_init (&iter, kfsb->dirty);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        if (g_str_has_suffix (key, "/") == (pass == 0))
+          set_to_keyfile (kfsb, key, value);
+    }
+}
+
 static GVariant *
 g_keyfile_settings_backend_read (GSettingsBackend   *backend,
                                  const gchar        *key,
@@ -277,6 +450,9 @@ g_keyfile_settings_backend_write_one (gpointer key,
   success = set_to_keyfile (data->kfsb, key, value);
   g_assert (success);
 
+  if (data->kfsb->write_delay > 0)
+    g_keyfile_settings_backend_keyfile_changed (data->kfsb, key, value);
+
   return FALSE;
 }
 
@@ -306,7 +482,9 @@ g_keyfile_settings_backend_write_tree (GSettingsBackend *backend,
     return FALSE;
 
   g_tree_foreach (tree, g_keyfile_settings_backend_write_one, &data);
-  g_keyfile_settings_backend_keyfile_write (data.kfsb);
+
+  if (data.kfsb->write_delay == 0)
+    g_keyfile_settings_backend_keyfile_write (data.kfsb);
 
   g_settings_backend_changed_tree (backend, tree, origin_tag);
 
@@ -330,7 +508,7 @@ g_keyfile_settings_backend_write (GSettingsBackend *backend,
   if (success)
     {
       g_settings_backend_changed (backend, key, origin_tag);
-      g_keyfile_settings_backend_keyfile_write (kfsb);
+      g_keyfile_settings_backend_keyfile_changed (kfsb, key, value);
     }
 
   return success;
@@ -344,11 +522,17 @@ g_keyfile_settings_backend_reset (GSettingsBackend *backend,
   GKeyfileSettingsBackend *kfsb = G_KEYFILE_SETTINGS_BACKEND (backend);
 
   if (set_to_keyfile (kfsb, key, NULL))
-    g_keyfile_settings_backend_keyfile_write (kfsb);
+    g_keyfile_settings_backend_keyfile_changed (kfsb, key, NULL);
 
   g_settings_backend_changed (backend, key, origin_tag);
 }
 
+static void
+g_keyfile_settings_backend_sync (GSettingsBackend *backend)
+{
+  g_keyfile_settings_backend_flush (G_KEYFILE_SETTINGS_BACKEND (backend));
+}
+
 static gboolean
 g_keyfile_settings_backend_get_writable (GSettingsBackend *backend,
                                          const gchar      *name)
@@ -430,6 +614,16 @@ g_keyfile_settings_backend_keyfile_reload (GKeyfileSettingsBackend *kfsb)
   guint8 digest[32];
   gchar *contents;
   gsize length;
+  guint64 inode, mtime;
+  goffset size;
+
+  /* Most change notifications are about our own writes: don't read
+   * the file back if it is still the one we wrote.
+   */
+  if (kfsb->stamp_valid && query_stamp (kfsb, &inode, &mtime, &size) &&
+      inode == kfsb->stamp_inode && mtime == kfsb->stamp_mtime &&
+      size == kfsb->stamp_size)
+    return;
 
   contents = NULL;
   length = 0;
@@ -453,10 +647,12 @@ g_keyfile_settings_backend_keyfile_reload (GKeyfileSettingsBackend *kfsb)
                                    G_KEY_FILE_KEEP_COMMENTS |
                                    G_KEY_FILE_KEEP_TRANSLATIONS, NULL);
 
+      kfsb->keyfile = keyfiles[1];
+      g_keyfile_settings_backend_replay_dirty (kfsb);
+
       keyfile_to_tree (kfsb, tree, keyfiles[0], FALSE);
       keyfile_to_tree (kfsb, tree, keyfiles[1], TRUE);
       g_key_file_free (keyfiles[0]);
-      kfsb->keyfile = keyfiles[1];
 
       if (g_tree_nnodes (tree) > 0)
         g_settings_backend_changed_tree (&kfsb->parent_instance, tree, NULL);
@@ -466,6 +662,8 @@ g_keyfile_settings_backend_keyfile_reload (GKeyfileSettingsBackend *kfsb)
       memcpy (kfsb->digest, digest, sizeof digest);
     }
 
+  update_stamp (kfsb);
+
   g_free (contents);
 }
 
@@ -499,6 +697,10 @@ g_keyfile_settings_backend_finalize (GObject *object)
 {
   GKeyfileSettingsBackend *kfsb = G_KEYFILE_SETTINGS_BACKEND (object);
 
+  g_keyfile_settings_backend_flush (kfsb);
+  g_hash_table_unref (kfsb->dirty);
+  g_main_context_unref (kfsb->main_context);
+
   g_key_file_free (kfsb->keyfile);
   g_object_unref (kfsb->permission);
 
@@ -517,9 +719,54 @@ g_keyfile_settings_backend_finalize (GObject *object)
     ->finalize (object);
 }
 
+static void
+g_keyfile_settings_backend_set_property (GObject      *object,
+                                         guint         prop_id,
+                                         const GValue *value,
+                                         GParamSpec   *pspec)
+{
+  GKeyfileSettingsBackend *kfsb = G_KEYFILE_SETTINGS_BACKEND (object);
+
+  switch (prop_id)
+    {
+    case PROP_WRITE_DELAY:
+      kfsb->write_delay = g_value_get_uint (value);
+      if (kfsb->write_delay == 0)
+        g_keyfile_settings_backend_flush (kfsb);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+g_keyfile_settings_backend_get_property (GObject    *object,
+                                         guint       prop_id,
+                                         GValue     *value,
+                                         GParamSpec *pspec)
+{
+  GKeyfileSettingsBackend *kfsb = G_KEYFILE_SETTINGS_BACKEND (object);
+
+  switch (prop_id)
+    {
+    case PROP_WRITE_DELAY:
+      g_value_set_uint (value, kfsb->write_delay);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
 static void
 g_keyfile_settings_backend_init (GKeyfileSettingsBackend *kfsb)
 {
+  kfsb->main_context = g_main_context_ref_thread_default ();
+  kfsb->dirty = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                       g_free, dirty_value_free);
 }
 
 static void
@@ -528,6 +775,8 @@ g_keyfile_settings_backend_class_init (GKeyfileSettingsBackendClass *class)
   GObjectClass *object_class = G_OBJECT_CLASS (class);
 
   object_class->finalize = g_keyfile_settings_backend_finalize;
+  object_class->set_property = g_keyfile_settings_backend_set_property;
+  object_class->get_property = g_keyfile_settings_backend_get_property;
 
   class->read = g_keyfile_settings_backend_read;
   class->write = g_keyfile_settings_backend_write;
@@ -535,10 +784,22 @@ g_keyfile_settings_backend_class_init (GKeyfileSettingsBackendClass *class)
   class->reset = g_keyfile_settings_backend_reset;
   class->get_writable = g_keyfile_settings_backend_get_writable;
   class->get_permission = g_keyfile_settings_backend_get_permission;
+  class->sync = g_keyfile_settings_backend_sync;
   /* No need to implement subscribed/unsubscribe: the only point would be to
    * stop monitoring the file when there's no GSettings anymore, which is no
    * big win.
    */
+
+  /*
+   * The delay, in milliseconds, before changes are written to disk.
+   * Changes made in the meantime are written together.  0 means that
+   * every change is written immediately.
+   */
+  g_object_class_install_property (object_class, PROP_WRITE_DELAY,
+    g_param_spec_uint ("write-delay", "Write delay",
+                       "Delay in milliseconds before writing changes to disk",
+                       0, G_MAXUINT, 0,
+                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -619,6 +880,15 @@ dir_changed (GFileMonitor       *monitor,
  * characters in your path names or '=' in your key names you may be in
  * trouble.
  *
+ * By default every change is written to the keyfile right away.  To
+ * save rewriting the file once per key when many are changed in quick
+ * succession, set the "write-delay" property (in milliseconds, since
+ * 2.54) on the returned backend with g_object_set().  Changes are then
+ * collected and written together once the delay has passed, when
+ * g_settings_sync() is called on the default backend, or when the
+ * backend is finalized.  Writes are dispatched in the thread-default
+ * main context of the thread that created the backend.
+ *
  * Returns: (transfer full): a keyfile-backed #GSettingsBackend
  **/
 GSettingsBackend *
@@ -72,12 +72,17 @@ typedef struct
   char *preproc_options;
 
   GString *string;  /* non-NULL when accepting text */
+
+  GPtrArray *jobs;  /* of FileJob, in document order */
 } ParseState;
 
 static gchar **sourcedirs = NULL;
 static gchar *xmllint = NULL;
 static gchar *gdk_pixbuf_pixdata = NULL;
 
+/* resource path → position in the access profile, starting at 1 */
+static GHashTable *access_order = NULL;
+
 static void
 file_data_free (FileData *data)
 {
@@ -197,6 +202,227 @@ find_file (const gchar *filename)
     return NULL;
 }
 
+/* Preprocessing, reading and compressing the files is done after
+ * parsing, on a pool of threads; the table is still filled in while
+ * parsing so that the output doesn't depend on the order the jobs
+ * finish in.
+ */
+typedef struct
+{
+  FileData *data;
+  gchar *real_file;
+  gboolean xml_stripblanks;
+  gboolean to_pixdata;
+  gboolean compressed;
+
+  GError *error;
+} FileJob;
+
+static void
+file_job_free (FileJob *job)
+{
+  g_free (job->real_file);
+  g_clear_error (&job->error);
+  g_free (job);
+}
+
+static gboolean
+process_file (FileJob  *job,
+              GError  **error)
+{
+  FileData *data = job->data;
+  gchar *real_file = g_strdup (job->real_file);
+  GError *my_error = NULL;
+  char *tmp_file = NULL;
+  char *tmp_file2 = NULL;
+  gboolean success = FALSE;
+
+  if (job->xml_stripblanks)
+    {
+      int fd;
+      GSubprocess *proc;
+
+      tmp_file = g_strdup ("resource-XXXXXXXX");
+      if ((fd = g_mkstemp (tmp_file)) == -1)
+        {
+          int errsv = errno;
+
+          g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                       _("Failed to create temp file: %s"),
+                       g_strerror (errsv));
+          g_free (tmp_file);
+          tmp_file = NULL;
+          goto cleanup;
+        }
+      close (fd);
+
+      proc = g_subprocess_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE, error,
+                               xmllint, "--nonet", "--noblanks", "--output", tmp_file, real_file, NULL);
+      g_free (real_file);
+      real_file = NULL;
+
+      if (!proc)
+        goto cleanup;
+
+      if (!g_subprocess_wait_check (proc, NULL, error))
+        {
+          g_object_unref (proc);
+          goto cleanup;
+        }
+
+      g_object_unref (proc);
+
+      real_file = g_strdup (tmp_file);
+    }
+
+  if (job->to_pixdata)
+    {
+      int fd;
+      GSubprocess *proc;
+
+      tmp_file2 = g_strdup ("resource-XXXXXXXX");
+      if ((fd = g_mkstemp (tmp_file2)) == -1)
+        {
+          int errsv = errno;
+
+          g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                       _("Failed to create temp file: %s"),
+                       g_strerror (errsv));
+          g_free (tmp_file2);
+          tmp_file2 = NULL;
+          goto cleanup;
+        }
+      close (fd);
+
+      proc = g_subprocess_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE, error,
+                               gdk_pixbuf_pixdata, real_file, tmp_file2, NULL);
+      g_free (real_file);
+      real_file = NULL;
+
+      if (!proc)
+        goto cleanup;
+
+      if (!g_subprocess_wait_check (proc, NULL, error))
+        {
+          g_object_unref (proc);
+          goto cleanup;
+        }
+
+      g_object_unref (proc);
+
+      real_file = g_strdup (tmp_file2);
+    }
+
+  if (!g_file_get_contents (real_file, &data->content, &data->size, &my_error))
+    {
+      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                   _("Error reading file %s: %s"),
+                   real_file, my_error->message);
+      g_clear_error (&my_error);
+      goto cleanup;
+    }
+  /* Include zero termination in content_size for uncompressed files (but not in size) */
+  data->content_size = data->size + 1;
+
+  if (job->compressed)
+    {
+      GOutputStream *out = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
+      GZlibCompressor *compressor =
+        g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 9);
+      GOutputStream *out2 = g_converter_output_stream_new (out, G_CONVERTER (compressor));
+
+      if (!g_output_stream_write_all (out2, data->content, data->size,
+                                      NULL, NULL, NULL) ||
+          !g_output_stream_close (out2, NULL, NULL))
+        {
+          g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                       _("Error compressing file %s"),
+                       real_file);
+          g_object_unref (compressor);
+          g_object_unref (out);
+          g_object_unref (out2);
+          goto cleanup;
+        }
+
+      g_free (data->content);
+      data->content_size = g_memory_output_stream_get_size (G_MEMORY_OUTPUT_STREAM (out));
+      data->content = g_memory_output_stream_steal_data (G_MEMORY_OUTPUT_STREAM (out));
+
+      g_object_unref (compressor);
+      g_object_unref (out);
+      g_object_unref (out2);
+
+      data->flags |= G_RESOURCE_FLAGS_COMPRESSED;
+    }
+
+  success = TRUE;
+
+ cleanup:
+  g_free (real_file);
+
+  if (tmp_file)
+    {
+      unlink (tmp_file);
+      g_free (tmp_file);
+    }
+
+  if (tmp_file2)
+    {
+      unlink (tmp_file2);
+      g_free (tmp_file2);
+    }
+
+  return success;
+}
+
+static void
+process_file_job (gpointer data,
+                  gpointer user_data)
+{
+  FileJob *job = data;
+
+  process_file (job, &job->error);
+}
+
+/* Runs all the jobs, and reports the first error in document order,
+ * which is the one a serial run would have stopped at.
+ */
+static gboolean
+process_file_jobs (GPtrArray  *jobs,
+                   GError    **error)
+{
+  GThreadPool *pool;
+  guint i;
+
+  if (jobs->len > 1)
+    {
+      pool = g_thread_pool_new (process_file_job, NULL,
+                                MIN (g_get_num_processors (), jobs->len),
+                                FALSE, NULL);
+
+      for (i = 0; i < jobs->len; i++)
+        g_thread_pool_push (pool, jobs->pdata[i], NULL);
+
+      g_thread_pool_free (pool, FALSE, TRUE);
+    }
+  else if (jobs->len == 1)
+    process_file_job (jobs->pdata[0], NULL);
+
+  for (i = 0; i < jobs->len; i++)
+    {
+      FileJob *job = jobs->pdata[i];
+
+      if (job->error != NULL)
+        {
+          g_propagate_error (error, job->error);
+          job->error = NULL;
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
 static void
 end_element (GMarkupParseContext  *context,
 	     const gchar          *element_name,
@@ -204,7 +430,6 @@ end_element (GMarkupParseContext  *context,
 	     GError              **error)
 {
   ParseState *state = user_data;
-  GError *my_error = NULL;
 
   if (strcmp (element_name, "gresource") == 0)
     {
@@ -218,8 +443,7 @@ end_element (GMarkupParseContext  *context,
       gchar *real_file = NULL;
       gchar *key;
       FileData *data = NULL;
-      char *tmp_file = NULL;
-      char *tmp_file2 = NULL;
+      FileJob *job;
 
       file = state->string->str;
       key = file;
@@ -269,6 +493,10 @@ end_element (GMarkupParseContext  *context,
       if (!state->collect_data)
         goto done;
 
+      job = g_new0 (FileJob, 1);
+      job->data = data;
+      job->compressed = state->compressed;
+
       if (state->preproc_options)
         {
           gchar **options;
@@ -289,131 +517,28 @@ end_element (GMarkupParseContext  *context,
                   g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
                                _("Unknown processing option “%s”"), options[i]);
                   g_strfreev (options);
+                  file_job_free (job);
                   goto cleanup;
                 }
             }
           g_strfreev (options);
 
-          if (xml_stripblanks && xmllint != NULL)
+          if (to_pixdata && gdk_pixbuf_pixdata == NULL)
             {
-              int fd;
-	      GSubprocess *proc;
-
-              tmp_file = g_strdup ("resource-XXXXXXXX");
-              if ((fd = g_mkstemp (tmp_file)) == -1)
-                {
-                  int errsv = errno;
-
-                  g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
-                               _("Failed to create temp file: %s"),
-                              g_strerror (errsv));
-                  g_free (tmp_file);
-                  tmp_file = NULL;
-                  goto cleanup;
-                }
-              close (fd);
-
-              proc = g_subprocess_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE, error,
-                                       xmllint, "--nonet", "--noblanks", "--output", tmp_file, real_file, NULL);
-              g_free (real_file);
-	      real_file = NULL;
-
-	      if (!proc)
-		goto cleanup;
-
-	      if (!g_subprocess_wait_check (proc, NULL, error))
-		{
-		  g_object_unref (proc);
-                  goto cleanup;
-                }
-
-	      g_object_unref (proc);
-
-              real_file = g_strdup (tmp_file);
+              g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                                   "to-pixbuf preprocessing requested but GDK_PIXBUF_PIXDATA "
+                                   "not set and gdk-pixbuf-pixdata not found in path");
+              file_job_free (job);
+              goto cleanup;
             }
 
-          if (to_pixdata)
-            {
-              int fd;
-	      GSubprocess *proc;
-
-              if (gdk_pixbuf_pixdata == NULL)
-                {
-                  g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_FAILED,
-                                       "to-pixbuf preprocessing requested but GDK_PIXBUF_PIXDATA "
-                                       "not set and gdk-pixbuf-pixdata not found in path");
-                  goto cleanup;
-                }
-
-              tmp_file2 = g_strdup ("resource-XXXXXXXX");
-              if ((fd = g_mkstemp (tmp_file2)) == -1)
-                {
-                  int errsv = errno;
-
-                  g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
-                               _("Failed to create temp file: %s"),
-			       g_strerror (errsv));
-                  g_free (tmp_file2);
-                  tmp_file2 = NULL;
-                  goto cleanup;
-                }
-              close (fd);
-
-              proc = g_subprocess_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE, error,
-                                       gdk_pixbuf_pixdata, real_file, tmp_file2, NULL);
-              g_free (real_file);
-              real_file = NULL;
-
-	      if (!g_subprocess_wait_check (proc, NULL, error))
-		{
-		  g_object_unref (proc);
-                  goto cleanup;
-		}
-
-	      g_object_unref (proc);
-
-              real_file = g_strdup (tmp_file2);
-            }
-	}
-
-      if (!g_file_get_contents (real_file, &data->content, &data->size, &my_error))
-	{
-	  g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
-		       _("Error reading file %s: %s"),
-		       real_file, my_error->message);
-	  g_clear_error (&my_error);
-	  goto cleanup;
-	}
-      /* Include zero termination in content_size for uncompressed files (but not in size) */
-      data->content_size = data->size + 1;
-
-      if (state->compressed)
-	{
-	  GOutputStream *out = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
-	  GZlibCompressor *compressor =
-	    g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 9);
-	  GOutputStream *out2 = g_converter_output_stream_new (out, G_CONVERTER (compressor));
-
-	  if (!g_output_stream_write_all (out2, data->content, data->size,
-					  NULL, NULL, NULL) ||
-	      !g_output_stream_close (out2, NULL, NULL))
-	    {
-	      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
-			   _("Error compressing file %s"),
-			   real_file);
-	      goto cleanup;
-	    }
-
-	  g_free (data->content);
-	  data->content_size = g_memory_output_stream_get_size (G_MEMORY_OUTPUT_STREAM (out));
-	  data->content = g_memory_output_stream_steal_data (G_MEMORY_OUTPUT_STREAM (out));
-
-	  g_object_unref (compressor);
-	  g_object_unref (out);
-	  g_object_unref (out2);
+          job->xml_stripblanks = xml_stripblanks && xmllint != NULL;
+          job->to_pixdata = to_pixdata;
+        }
 
-	  data->flags |= G_RESOURCE_FLAGS_COMPRESSED;
-	}
+      job->real_file = real_file;
+      real_file = NULL;
+      g_ptr_array_add (state->jobs, job);
 
 done:
       g_hash_table_insert (state->table, key, data);
@@ -431,18 +556,6 @@ done:
 
       g_free (real_file);
 
-      if (tmp_file)
-        {
-          unlink (tmp_file);
-          g_free (tmp_file);
-        }
-
-      if (tmp_file2)
-        {
-          unlink (tmp_file2);
-          g_free (tmp_file2);
-        }
-
       if (data != NULL)
         file_data_free (data);
     }
@@ -495,6 +608,7 @@ parse_resource_file (const gchar *filename,
 
   state.collect_data = collect_data;
   state.table = g_hash_table_ref (files);
+  state.jobs = g_ptr_array_new_with_free_func ((GDestroyNotify) file_job_free);
 
   context = g_markup_parse_context_new (&parser,
 					G_MARKUP_TREAT_CDATA_AS_TEXT |
@@ -502,7 +616,8 @@ parse_resource_file (const gchar *filename,
 					&state, NULL);
 
   if (!g_markup_parse_context_parse (context, contents, size, &error) ||
-      !g_markup_parse_context_end_parse (context, &error))
+      !g_markup_parse_context_end_parse (context, &error) ||
+      !process_file_jobs (state.jobs, &error))
     {
       g_printerr ("%s: %s.\n", filename, error->message);
       g_clear_error (&error);
@@ -529,6 +644,8 @@ parse_resource_file (const gchar *filename,
 	  item = gvdb_hash_table_insert (table, key);
 	  gvdb_item_set_parent (item,
 				get_parent (table, mykey, key_len));
+	  if (access_order != NULL)
+	    gvdb_item_set_order (item, GPOINTER_TO_UINT (g_hash_table_lookup (access_order, key)));
 
 	  g_free (mykey);
 
@@ -548,6 +665,7 @@ parse_resource_file (const gchar *filename,
 	}
     }
 
+  g_ptr_array_unref (state.jobs);
   g_hash_table_unref (state.table);
   g_markup_parse_context_free (context);
   g_free (contents);
@@ -555,6 +673,40 @@ parse_resource_file (const gchar *filename,
   return table;
 }
 
+/* The access profile lists one resource path per line, in the order
+ * they are first used, as written to G_RESOURCE_ACCESS_LOG.
+ */
+static gboolean
+load_access_profile (const gchar  *filename,
+                     GError      **error)
+{
+  gchar *contents;
+  gchar **lines;
+  guint order = 0;
+  gint i;
+
+  if (!g_file_get_contents (filename, &contents, NULL, error))
+    return FALSE;
+
+  access_order = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  lines = g_strsplit (contents, "\n", -1);
+  for (i = 0; lines[i] != NULL; i++)
+    {
+      gchar *path = g_strstrip (lines[i]);
+
+      if (*path == '\0' || g_hash_table_contains (access_order, path))
+        continue;
+
+      g_hash_table_insert (access_order, g_strdup (path), GUINT_TO_POINTER (++order));
+    }
+
+  g_strfreev (lines);
+  g_free (contents);
+
+  return TRUE;
+}
+
 static gboolean
 write_to_file (GHashTable   *table,
 	       const gchar  *filename,
@@ -656,6 +808,7 @@ main (int argc, char **argv)
   gboolean generate_dependencies = FALSE;
   gboolean generate_phony_targets = FALSE;
   char *dependency_file = NULL;
+  char *access_profile = NULL;
   char *c_name = NULL;
   char *c_name_no_underscores;
   const char *linkage = "extern";
@@ -670,6 +823,7 @@ main (int argc, char **argv)
     { "generate-dependencies", 0, 0, G_OPTION_ARG_NONE, &generate_dependencies, N_("Generate dependency list"), NULL },
     { "dependency-file", 0, 0, G_OPTION_ARG_FILENAME, &dependency_file, N_("name of the dependency file to generate"), N_("FILE") },
     { "generate-phony-targets", 0, 0, G_OPTION_ARG_NONE, &generate_phony_targets, N_("Include phony targets in the generated dependency file"), NULL },
+    { "access-profile", 0, 0, G_OPTION_ARG_FILENAME, &access_profile, N_("Store files in the order they are listed in FILE"), N_("FILE") },
     { "manual-register", 0, 0, G_OPTION_ARG_NONE, &manual_register, N_("Don’t automatically create and register resource"), NULL },
     { "internal", 0, 0, G_OPTION_ARG_NONE, &internal, N_("Don’t export functions; declare them G_GNUC_INTERNAL"), NULL },
     { "c-name", 0, 0, G_OPTION_ARG_STRING, &c_name, N_("C identifier name used for the generated source code"), NULL },
@@ -783,6 +937,14 @@ main (int argc, char **argv)
         { }
     }
 
+  if (access_profile != NULL && !load_access_profile (access_profile, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_free (target);
+      g_free (c_name);
+      return 1;
+    }
+
   files = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)file_data_free);
 
   if ((table = parse_resource_file (srcfile, !generate_dependencies, files)) == NULL)
@@ -1090,6 +1252,9 @@ main (int argc, char **argv)
   g_hash_table_destroy (table);
   g_free (xmllint);
   g_free (c_name);
+  g_free (access_profile);
+  if (access_order != NULL)
+    g_hash_table_unref (access_order);
 
   return 0;
 }
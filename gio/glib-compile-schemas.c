@@ -1261,18 +1261,15 @@ parse_state_start_enum (ParseState   *state,
 
 /* Start element {{{2 */
 static void
-start_element (GMarkupParseContext  *context,
-               const gchar          *element_name,
-               const gchar         **attribute_names,
-               const gchar         **attribute_values,
-               gpointer              user_data,
-               GError              **error)
+start_element (ParseState    *state,
+               const GSList  *element_stack,
+               const gchar   *element_name,
+               const gchar  **attribute_names,
+               const gchar  **attribute_values,
+               GError       **error)
 {
-  ParseState *state = user_data;
-  const GSList *element_stack;
   const gchar *container;
 
-  element_stack = g_markup_parse_context_get_element_stack (context);
   container = element_stack->next ? element_stack->next->data : NULL;
 
 #define COLLECT(first, ...) \
@@ -1524,12 +1521,10 @@ schema_state_end (SchemaState **state_ptr,
 }
 
 static void
-end_element (GMarkupParseContext  *context,
-             const gchar          *element_name,
-             gpointer              user_data,
-             GError              **error)
+end_element (ParseState   *state,
+             const gchar  *element_name,
+             GError      **error)
 {
-  ParseState *state = user_data;
 
   if (strcmp (element_name, "schemalist") == 0)
     {
@@ -1567,13 +1562,12 @@ end_element (GMarkupParseContext  *context,
 }
 /* Text {{{2 */
 static void
-text (GMarkupParseContext  *context,
-      const gchar          *text,
-      gsize                 text_len,
-      gpointer              user_data,
-      GError              **error)
+text (ParseState    *state,
+      const GSList  *element_stack,
+      const gchar   *text,
+      gsize          text_len,
+      GError       **error)
 {
-  ParseState *state = user_data;
 
   if (state->string)
     {
@@ -1602,7 +1596,7 @@ text (GMarkupParseContext  *context,
           {
             g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
                          _("text may not appear inside <%s>"),
-                         g_markup_parse_context_get_element (context));
+                         element_stack ? (const gchar *) element_stack->data : NULL);
             break;
           }
     }
@@ -1739,14 +1733,223 @@ write_to_file (GHashTable   *schema_table,
 }
 
 /* Parser driver {{{1 */
+
+/* The files are read and tokenised on a pool of threads, recording the
+ * parser callbacks for each file.  The recorded events are then played
+ * back through the functions above in the original file order, since
+ * schemas can refer to enums and schemas from earlier files.  This
+ * gives the same tables (and error messages) as parsing serially.
+ */
+typedef enum
+{
+  PARSE_EVENT_START_ELEMENT,
+  PARSE_EVENT_END_ELEMENT,
+  PARSE_EVENT_TEXT
+} ParseEventType;
+
+typedef struct
+{
+  ParseEventType type;
+  gint line, col;
+
+  gchar *element_name;
+  gchar **attribute_names;
+  gchar **attribute_values;
+
+  gchar *text;
+  gsize text_len;
+} ParseEvent;
+
+typedef struct
+{
+  const gchar *filename;
+
+  GArray *events;       /* of ParseEvent */
+
+  /* an error reading or parsing the file, if any, which happened
+   * after all the events */
+  GError *error;
+  gboolean read_failed;
+  gint line, col;
+} ParsedFile;
+
+static void
+parse_event_clear (gpointer data)
+{
+  ParseEvent *event = data;
+
+  g_free (event->element_name);
+  g_strfreev (event->attribute_names);
+  g_strfreev (event->attribute_values);
+  g_free (event->text);
+}
+
+static ParseEvent *
+record_event (GMarkupParseContext *context,
+              ParsedFile          *file,
+              ParseEventType       type)
+{
+  ParseEvent *event;
+
+  g_array_set_size (file->events, file->events->len + 1);
+  event = &g_array_index (file->events, ParseEvent, file->events->len - 1);
+  event->type = type;
+  g_markup_parse_context_get_position (context, &event->line, &event->col);
+
+  return event;
+}
+
+static void
+record_start_element (GMarkupParseContext  *context,
+                      const gchar          *element_name,
+                      const gchar         **attribute_names,
+                      const gchar         **attribute_values,
+                      gpointer              user_data,
+                      GError              **error)
+{
+  ParseEvent *event;
+
+  event = record_event (context, user_data, PARSE_EVENT_START_ELEMENT);
+  event->element_name = g_strdup (element_name);
+  event->attribute_names = g_strdupv ((gchar **) attribute_names);
+  event->attribute_values = g_strdupv ((gchar **) attribute_values);
+}
+
+static void
+record_end_element (GMarkupParseContext  *context,
+                    const gchar          *element_name,
+                    gpointer              user_data,
+                    GError              **error)
+{
+  ParseEvent *event;
+
+  event = record_event (context, user_data, PARSE_EVENT_END_ELEMENT);
+  event->element_name = g_strdup (element_name);
+}
+
+static void
+record_text (GMarkupParseContext  *context,
+             const gchar          *text,
+             gsize                 text_len,
+             gpointer              user_data,
+             GError              **error)
+{
+  ParseEvent *event;
+
+  event = record_event (context, user_data, PARSE_EVENT_TEXT);
+  event->text = g_strndup (text, text_len);
+  event->text_len = text_len;
+}
+
+static void
+tokenise_gschema_file (gpointer data,
+                       gpointer user_data)
+{
+  GMarkupParser parser = { record_start_element, record_end_element, record_text };
+  ParsedFile *file = data;
+  GMarkupParseContext *context;
+  gchar *contents;
+  gsize size;
+
+  if (!g_file_get_contents (file->filename, &contents, &size, &file->error))
+    {
+      file->read_failed = TRUE;
+      return;
+    }
+
+  context = g_markup_parse_context_new (&parser,
+                                        G_MARKUP_TREAT_CDATA_AS_TEXT |
+                                        G_MARKUP_PREFIX_ERROR_POSITION |
+                                        G_MARKUP_IGNORE_QUALIFIED,
+                                        file, NULL);
+
+  if (!g_markup_parse_context_parse (context, contents, size, &file->error) ||
+      !g_markup_parse_context_end_parse (context, &file->error))
+    g_markup_parse_context_get_position (context, &file->line, &file->col);
+
+  g_markup_parse_context_free (context);
+  g_free (contents);
+}
+
+/* Feeds the recorded events of @file to the parser functions, stopping
+ * at the first error like GMarkup would.
+ */
+static gboolean
+replay_gschema_file (ParsedFile  *file,
+                     ParseState  *state,
+                     gint        *line,
+                     gint        *col,
+                     GError     **error)
+{
+  GSList *element_stack = NULL;
+  GError *tmp_error = NULL;
+  guint i;
+
+  for (i = 0; i < file->events->len; i++)
+    {
+      ParseEvent *event = &g_array_index (file->events, ParseEvent, i);
+
+      switch (event->type)
+        {
+        case PARSE_EVENT_START_ELEMENT:
+          element_stack = g_slist_prepend (element_stack, event->element_name);
+          start_element (state, element_stack, event->element_name,
+                         (const gchar **) event->attribute_names,
+                         (const gchar **) event->attribute_values,
+                         &tmp_error);
+          break;
+
+        case PARSE_EVENT_END_ELEMENT:
+          end_element (state, event->element_name, &tmp_error);
+          element_stack = g_slist_delete_link (element_stack, element_stack);
+          break;
+
+        case PARSE_EVENT_TEXT:
+          text (state, element_stack, event->text, event->text_len, &tmp_error);
+          break;
+        }
+
+      if (tmp_error != NULL)
+        {
+          /* GMarkup doesn't add the position to end element errors */
+          if (event->type != PARSE_EVENT_END_ELEMENT)
+            g_prefix_error (&tmp_error, _("Error on line %d char %d: "),
+                            event->line, event->col);
+
+          *line = event->line;
+          *col = event->col;
+          g_propagate_error (error, tmp_error);
+          g_slist_free (element_stack);
+
+          return FALSE;
+        }
+    }
+
+  g_slist_free (element_stack);
+
+  if (file->error != NULL)
+    {
+      *line = file->line;
+      *col = file->col;
+      g_propagate_error (error, file->error);
+      file->error = NULL;
+
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 static GHashTable *
 parse_gschema_files (gchar    **files,
                      gboolean   strict)
 {
-  GMarkupParser parser = { start_element, end_element, text };
   ParseState state = { 0, };
-  const gchar *filename;
+  ParsedFile *parsed;
+  GThreadPool *pool;
   GError *error = NULL;
+  guint n_files;
+  guint i;
 
   state.strict = strict;
 
@@ -1759,29 +1962,35 @@ parse_gschema_files (gchar    **files,
   state.schema_table = g_hash_table_new_full (g_str_hash, g_str_equal,
                                               g_free, schema_state_free);
 
-  while ((filename = *files++) != NULL)
+  n_files = g_strv_length (files);
+  parsed = g_new0 (ParsedFile, n_files);
+
+  pool = g_thread_pool_new (tokenise_gschema_file, NULL,
+                            MAX (MIN (g_get_num_processors (), n_files), 1),
+                            FALSE, NULL);
+
+  for (i = 0; i < n_files; i++)
+    {
+      parsed[i].filename = files[i];
+      parsed[i].events = g_array_new (FALSE, TRUE, sizeof (ParseEvent));
+      g_array_set_clear_func (parsed[i].events, parse_event_clear);
+      g_thread_pool_push (pool, &parsed[i], NULL);
+    }
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+
+  for (i = 0; i < n_files; i++)
     {
-      GMarkupParseContext *context;
-      gchar *contents;
-      gsize size;
+      const gchar *filename = parsed[i].filename;
       gint line, col;
 
-      if (!g_file_get_contents (filename, &contents, &size, &error))
+      if (parsed[i].read_failed)
         {
-          fprintf (stderr, "%s\n", error->message);
-          g_clear_error (&error);
+          fprintf (stderr, "%s\n", parsed[i].error->message);
           continue;
         }
 
-      context = g_markup_parse_context_new (&parser,
-                                            G_MARKUP_TREAT_CDATA_AS_TEXT |
-                                            G_MARKUP_PREFIX_ERROR_POSITION |
-                                            G_MARKUP_IGNORE_QUALIFIED,
-                                            &state, NULL);
-
-
-      if (!g_markup_parse_context_parse (context, contents, size, &error) ||
-          !g_markup_parse_context_end_parse (context, &error))
+      if (!replay_gschema_file (&parsed[i], &state, &line, &col, &error))
         {
           GSList *item;
 
@@ -1796,7 +2005,6 @@ parse_gschema_files (gchar    **files,
             g_hash_table_remove (state.enum_table, item->data);
 
           /* let them know */
-          g_markup_parse_context_get_position (context, &line, &col);
           fprintf (stderr, "%s:%d:%d  %s.  ", filename, line, col, error->message);
           g_clear_error (&error);
 
@@ -1807,25 +2015,33 @@ parse_gschema_files (gchar    **files,
               g_hash_table_unref (state.schema_table);
               g_hash_table_unref (state.flags_table);
               g_hash_table_unref (state.enum_table);
-
-              g_free (contents);
-
-              return NULL;
+              state.schema_table = NULL;
             }
           else
             fprintf (stderr, _("This entire file has been ignored.\n"));
         }
 
       /* cleanup */
-      g_free (contents);
-      g_markup_parse_context_free (context);
       g_slist_free (state.this_file_schemas);
       g_slist_free (state.this_file_flagss);
       g_slist_free (state.this_file_enums);
       state.this_file_schemas = NULL;
       state.this_file_flagss = NULL;
       state.this_file_enums = NULL;
+
+      if (state.schema_table == NULL)
+        break;
+    }
+
+  for (i = 0; i < n_files; i++)
+    {
+      g_array_unref (parsed[i].events);
+      g_clear_error (&parsed[i].error);
     }
+  g_free (parsed);
+
+  if (state.schema_table == NULL)
+    return NULL;
 
   g_hash_table_unref (state.flags_table);
   g_hash_table_unref (state.enum_table);
@@ -25,6 +25,8 @@
 #include "gliststore.h"
 #include "glistmodel.h"
 
+#include <string.h>
+
 /**
  * SECTION:gliststore
  * @title: GListStore
@@ -36,6 +38,17 @@
  *
  * It provides insertions, deletions, and lookups in logarithmic time
  * with a fast path for the common case of iterating the list linearly.
+ *
+ * A store created with g_list_store_new_indexed() keeps its items in an
+ * array instead: lookups take constant time at any position, while
+ * insertions and deletions take time linear in the number of items
+ * after them.  This suits large lists that are read at random and
+ * mostly changed at the end, or in a few big batches.
+ *
+ * Several changes can be reported as a single
+ * #GListModel::items-changed by bracketing them with
+ * g_list_store_freeze_items_changed() and
+ * g_list_store_thaw_items_changed().
  */
 
 /**
@@ -50,17 +63,27 @@ struct _GListStore
   GObject parent_instance;
 
   GType item_type;
-  GSequence *items;
+  gboolean indexed;
+  GSequence *items;   /* unless indexed */
+  GPtrArray *array;   /* if indexed */
 
   /* cache */
   guint last_position;
   GSequenceIter *last_iter;
+
+  /* the change held back by g_list_store_freeze_items_changed() */
+  guint freeze_count;
+  gboolean have_pending;
+  guint pending_position;
+  guint pending_removed;
+  guint pending_added;
 };
 
 enum
 {
   PROP_0,
   PROP_ITEM_TYPE,
+  PROP_INDEXED,
   N_PROPERTIES
 };
 
@@ -82,15 +105,96 @@ g_list_store_items_changed (GListStore *store,
       store->last_position = -1u;
     }
 
+  if (store->freeze_count > 0)
+    {
+      guint start, end;
+
+      if (removed == 0 && added == 0)
+        return;
+
+      if (!store->have_pending)
+        {
+          store->have_pending = TRUE;
+          store->pending_position = position;
+          store->pending_removed = removed;
+          store->pending_added = added;
+          return;
+        }
+
+      /* Grow the pending change to cover this one too.  Before the
+       * change, [start, end) in the current list held what is now
+       * [start, end - pending_added + pending_removed) in the list as
+       * it was when it was frozen.
+       */
+      start = MIN (store->pending_position, position);
+      end = MAX (store->pending_position + store->pending_added, position + removed);
+
+      store->pending_removed = end - store->pending_added + store->pending_removed - start;
+      store->pending_added = end - removed + added - start;
+      store->pending_position = start;
+      return;
+    }
+
   g_list_model_items_changed (G_LIST_MODEL (store), position, removed, added);
 }
 
+static guint
+g_list_store_length (GListStore *store)
+{
+  if (store->indexed)
+    return store->array->len;
+  else
+    return g_sequence_get_length (store->items);
+}
+
+typedef struct
+{
+  GCompareDataFunc compare_func;
+  gpointer         user_data;
+} SortData;
+
+/* for sorting arrays of pointers to items */
+static gint
+g_list_store_compare_indirect (gconstpointer a,
+                               gconstpointer b,
+                               gpointer      user_data)
+{
+  SortData *data = user_data;
+
+  return data->compare_func (*(gpointer *) a, *(gpointer *) b, data->user_data);
+}
+
+/* Finds where @item goes in the sorted array of an indexed store:
+ * after every item that does not compare greater than it.
+ */
+static guint
+g_list_store_search_sorted (GListStore       *store,
+                            gpointer          item,
+                            GCompareDataFunc  compare_func,
+                            gpointer          user_data)
+{
+  guint lo = 0, hi = store->array->len;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (compare_func (g_ptr_array_index (store->array, mid), item, user_data) > 0)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+
+  return lo;
+}
+
 static void
 g_list_store_dispose (GObject *object)
 {
   GListStore *store = G_LIST_STORE (object);
 
   g_clear_pointer (&store->items, g_sequence_free);
+  g_clear_pointer (&store->array, g_ptr_array_unref);
 
   G_OBJECT_CLASS (g_list_store_parent_class)->dispose (object);
 }
@@ -109,6 +213,10 @@ g_list_store_get_property (GObject    *object,
       g_value_set_gtype (value, store->item_type);
       break;
 
+    case PROP_INDEXED:
+      g_value_set_boolean (value, store->indexed);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -131,16 +239,34 @@ g_list_store_set_property (GObject      *object,
                     g_type_name (store->item_type));
       break;
 
+    case PROP_INDEXED: /* construct-only */
+      store->indexed = g_value_get_boolean (value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
 }
 
+static void
+g_list_store_constructed (GObject *object)
+{
+  GListStore *store = G_LIST_STORE (object);
+
+  if (store->indexed)
+    store->array = g_ptr_array_new_with_free_func (g_object_unref);
+  else
+    store->items = g_sequence_new (g_object_unref);
+
+  G_OBJECT_CLASS (g_list_store_parent_class)->constructed (object);
+}
+
 static void
 g_list_store_class_init (GListStoreClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
+  object_class->constructed = g_list_store_constructed;
   object_class->dispose = g_list_store_dispose;
   object_class->get_property = g_list_store_get_property;
   object_class->set_property = g_list_store_set_property;
@@ -156,6 +282,18 @@ g_list_store_class_init (GListStoreClass *klass)
   g_object_class_install_property (object_class, PROP_ITEM_TYPE,
     g_param_spec_gtype ("item-type", "", "", G_TYPE_OBJECT,
                         G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GListStore:indexed:
+   *
+   * Whether the items are kept in an array, for constant time access
+   * at any position.  See g_list_store_new_indexed().
+   *
+   * Since: 2.54
+   **/
+  g_object_class_install_property (object_class, PROP_INDEXED,
+    g_param_spec_boolean ("indexed", "", "", FALSE,
+                          G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static GType
@@ -171,7 +309,7 @@ g_list_store_get_n_items (GListModel *list)
 {
   GListStore *store = G_LIST_STORE (list);
 
-  return g_sequence_get_length (store->items);
+  return g_list_store_length (store);
 }
 
 static gpointer
@@ -181,6 +319,14 @@ g_list_store_get_item (GListModel *list,
   GListStore *store = G_LIST_STORE (list);
   GSequenceIter *it = NULL;
 
+  if (store->indexed)
+    {
+      if (position >= store->array->len)
+        return NULL;
+
+      return g_object_ref (g_ptr_array_index (store->array, position));
+    }
+
   if (store->last_position != -1u)
     {
       if (store->last_position == position + 1)
@@ -214,7 +360,6 @@ g_list_store_iface_init (GListModelInterface *iface)
 static void
 g_list_store_init (GListStore *store)
 {
-  store->items = g_sequence_new (g_object_unref);
   store->last_position = -1u;
 }
 
@@ -241,6 +386,32 @@ g_list_store_new (GType item_type)
                        NULL);
 }
 
+/**
+ * g_list_store_new_indexed:
+ * @item_type: the #GType of items in the list
+ *
+ * Creates a new #GListStore with items of type @item_type, which keeps
+ * its items in an array.
+ *
+ * g_list_model_get_item() on such a store takes constant time at any
+ * position, but inserting or removing an item takes time proportional
+ * to the number of items after it.  Prefer g_list_store_splice() and
+ * g_list_store_merge_sorted() over repeated single insertions.
+ *
+ * Returns: a new #GListStore
+ * Since: 2.54
+ */
+GListStore *
+g_list_store_new_indexed (GType item_type)
+{
+  g_return_val_if_fail (g_type_is_a (item_type, G_TYPE_OBJECT), NULL);
+
+  return g_object_new (G_TYPE_LIST_STORE,
+                       "item-type", item_type,
+                       "indexed", TRUE,
+                       NULL);
+}
+
 /**
  * g_list_store_insert:
  * @store: a #GListStore
@@ -267,10 +438,20 @@ g_list_store_insert (GListStore *store,
 
   g_return_if_fail (G_IS_LIST_STORE (store));
   g_return_if_fail (g_type_is_a (G_OBJECT_TYPE (item), store->item_type));
-  g_return_if_fail (position <= g_sequence_get_length (store->items));
 
-  it = g_sequence_get_iter_at_pos (store->items, position);
-  g_sequence_insert_before (it, g_object_ref (item));
+  if (store->indexed)
+    {
+      g_return_if_fail (position <= store->array->len);
+
+      g_ptr_array_insert (store->array, position, g_object_ref (item));
+    }
+  else
+    {
+      g_return_if_fail (position <= g_sequence_get_length (store->items));
+
+      it = g_sequence_get_iter_at_pos (store->items, position);
+      g_sequence_insert_before (it, g_object_ref (item));
+    }
 
   g_list_store_items_changed (store, position, 0, 1);
 }
@@ -308,8 +489,16 @@ g_list_store_insert_sorted (GListStore       *store,
   g_return_val_if_fail (g_type_is_a (G_OBJECT_TYPE (item), store->item_type), 0);
   g_return_val_if_fail (compare_func != NULL, 0);
 
-  it = g_sequence_insert_sorted (store->items, g_object_ref (item), compare_func, user_data);
-  position = g_sequence_iter_get_position (it);
+  if (store->indexed)
+    {
+      position = g_list_store_search_sorted (store, item, compare_func, user_data);
+      g_ptr_array_insert (store->array, position, g_object_ref (item));
+    }
+  else
+    {
+      it = g_sequence_insert_sorted (store->items, g_object_ref (item), compare_func, user_data);
+      position = g_sequence_iter_get_position (it);
+    }
 
   g_list_store_items_changed (store, position, 0, 1);
 
@@ -336,9 +525,16 @@ g_list_store_sort (GListStore       *store,
   g_return_if_fail (G_IS_LIST_STORE (store));
   g_return_if_fail (compare_func != NULL);
 
-  g_sequence_sort (store->items, compare_func, user_data);
+  if (store->indexed)
+    {
+      SortData data = { compare_func, user_data };
+
+      g_ptr_array_sort_with_data (store->array, g_list_store_compare_indirect, &data);
+    }
+  else
+    g_sequence_sort (store->items, compare_func, user_data);
 
-  n_items = g_sequence_get_length (store->items);
+  n_items = g_list_store_length (store);
   g_list_store_items_changed (store, 0, n_items, n_items);
 }
 
@@ -365,8 +561,11 @@ g_list_store_append (GListStore *store,
   g_return_if_fail (G_IS_LIST_STORE (store));
   g_return_if_fail (g_type_is_a (G_OBJECT_TYPE (item), store->item_type));
 
-  n_items = g_sequence_get_length (store->items);
-  g_sequence_append (store->items, g_object_ref (item));
+  n_items = g_list_store_length (store);
+  if (store->indexed)
+    g_ptr_array_add (store->array, g_object_ref (item));
+  else
+    g_sequence_append (store->items, g_object_ref (item));
 
   g_list_store_items_changed (store, n_items, 0, 1);
 }
@@ -392,10 +591,20 @@ g_list_store_remove (GListStore *store,
 
   g_return_if_fail (G_IS_LIST_STORE (store));
 
-  it = g_sequence_get_iter_at_pos (store->items, position);
-  g_return_if_fail (!g_sequence_iter_is_end (it));
+  if (store->indexed)
+    {
+      g_return_if_fail (position < store->array->len);
+
+      g_ptr_array_remove_index (store->array, position);
+    }
+  else
+    {
+      it = g_sequence_get_iter_at_pos (store->items, position);
+      g_return_if_fail (!g_sequence_iter_is_end (it));
+
+      g_sequence_remove (it);
+    }
 
-  g_sequence_remove (it);
   g_list_store_items_changed (store, position, 1, 0);
 }
 
@@ -414,9 +623,12 @@ g_list_store_remove_all (GListStore *store)
 
   g_return_if_fail (G_IS_LIST_STORE (store));
 
-  n_items = g_sequence_get_length (store->items);
-  g_sequence_remove_range (g_sequence_get_begin_iter (store->items),
-                           g_sequence_get_end_iter (store->items));
+  n_items = g_list_store_length (store);
+  if (store->indexed)
+    g_ptr_array_set_size (store->array, 0);
+  else
+    g_sequence_remove_range (g_sequence_get_begin_iter (store->items),
+                             g_sequence_get_end_iter (store->items));
 
   g_list_store_items_changed (store, 0, n_items, 0);
 }
@@ -452,44 +664,224 @@ g_list_store_splice (GListStore *store,
                      gpointer   *additions,
                      guint       n_additions)
 {
-  GSequenceIter *it;
   guint n_items;
+  guint i;
 
   g_return_if_fail (G_IS_LIST_STORE (store));
   g_return_if_fail (position + n_removals >= position); /* overflow */
 
-  n_items = g_sequence_get_length (store->items);
+  n_items = g_list_store_length (store);
   g_return_if_fail (position + n_removals <= n_items);
 
-  it = g_sequence_get_iter_at_pos (store->items, position);
+  for (i = 0; i < n_additions; i++)
+    {
+      if G_UNLIKELY (!g_type_is_a (G_OBJECT_TYPE (additions[i]), store->item_type))
+        {
+          g_critical ("%s: item %d is a %s instead of a %s.",
+                      G_STRFUNC, i, G_OBJECT_TYPE_NAME (additions[i]), g_type_name (store->item_type));
+          return;
+        }
+    }
 
-  if (n_removals)
+  if (store->indexed)
     {
-      GSequenceIter *end;
+      GPtrArray *array = store->array;
 
-      end = g_sequence_iter_move (it, n_removals);
-      g_sequence_remove_range (it, end);
+      if (n_removals)
+        g_ptr_array_remove_range (array, position, n_removals);
 
-      it = end;
+      if (n_additions)
+        {
+          guint old_len = array->len;
+
+          g_ptr_array_set_size (array, old_len + n_additions);
+          memmove (array->pdata + position + n_additions,
+                   array->pdata + position,
+                   (old_len - position) * sizeof (gpointer));
+          for (i = 0; i < n_additions; i++)
+            array->pdata[position + i] = g_object_ref (additions[i]);
+        }
     }
-
-  if (n_additions)
+  else
     {
-      gint i;
+      GSequenceIter *it;
+
+      it = g_sequence_get_iter_at_pos (store->items, position);
+
+      if (n_removals)
+        {
+          GSequenceIter *end;
+
+          end = g_sequence_iter_move (it, n_removals);
+          g_sequence_remove_range (it, end);
 
-      it = g_sequence_iter_next (it);
+          it = end;
+        }
+
+      /* each item goes in front of the one that was at @position */
       for (i = 0; i < n_additions; i++)
+        g_sequence_insert_before (it, g_object_ref (additions[i]));
+    }
+
+  g_list_store_items_changed (store, position, n_removals, n_additions);
+}
+
+/**
+ * g_list_store_merge_sorted:
+ * @store: a #GListStore
+ * @additions: (array length=n_additions) (element-type GObject): the items to add
+ * @n_additions: the number of items to add
+ * @compare_func: (scope call): pairwise comparison function for sorting
+ * @user_data: (closure): user data for @compare_func
+ *
+ * Inserts all of @additions into @store, each at a position determined
+ * by @compare_func, as g_list_store_insert_sorted() would.  @additions
+ * need not be sorted, and is not modified.
+ *
+ * As with g_list_store_insert_sorted(), the list must already be
+ * sorted.  Items comparing equal keep their relative order, with the
+ * ones already in @store first.
+ *
+ * This is much faster than inserting the items one at a time, and
+ * emits #GListModel::items-changed only once, for the range from the
+ * first to the last added item.
+ *
+ * This function takes a ref on each item in @additions.
+ *
+ * Since: 2.54
+ */
+void
+g_list_store_merge_sorted (GListStore        *store,
+                           gpointer          *additions,
+                           guint              n_additions,
+                           GCompareDataFunc   compare_func,
+                           gpointer           user_data)
+{
+  SortData data = { compare_func, user_data };
+  gpointer *sorted;
+  guint first, last;
+  guint i;
+
+  g_return_if_fail (G_IS_LIST_STORE (store));
+  g_return_if_fail (additions != NULL || n_additions == 0);
+  g_return_if_fail (compare_func != NULL);
+
+  for (i = 0; i < n_additions; i++)
+    {
+      if G_UNLIKELY (!g_type_is_a (G_OBJECT_TYPE (additions[i]), store->item_type))
+        {
+          g_critical ("%s: item %d is a %s instead of a %s.",
+                      G_STRFUNC, i, G_OBJECT_TYPE_NAME (additions[i]), g_type_name (store->item_type));
+          return;
+        }
+    }
+
+  if (n_additions == 0)
+    return;
+
+  /* g_qsort_with_data() is stable */
+  sorted = g_memdup (additions, n_additions * sizeof (gpointer));
+  g_qsort_with_data (sorted, n_additions, sizeof (gpointer),
+                     g_list_store_compare_indirect, &data);
+
+  if (store->indexed)
+    {
+      GPtrArray *array = store->array;
+      guint src, dest;
+
+      /* Merge from the back, so that nothing is overwritten before it
+       * has been moved.
+       */
+      src = array->len;
+      g_ptr_array_set_size (array, array->len + n_additions);
+      dest = array->len;
+      i = n_additions;
+      last = 0;
+
+      while (i > 0)
         {
-          if G_UNLIKELY (!g_type_is_a (G_OBJECT_TYPE (additions[i]), store->item_type))
+          if (src > 0 && compare_func (array->pdata[src - 1], sorted[i - 1], user_data) > 0)
+            array->pdata[--dest] = array->pdata[--src];
+          else
             {
-              g_critical ("%s: item %d is a %s instead of a %s.  GListStore is now in an undefined state.",
-                          G_STRFUNC, i, G_OBJECT_TYPE_NAME (additions[i]), g_type_name (store->item_type));
-              return;
+              array->pdata[--dest] = g_object_ref (sorted[--i]);
+              if (i == n_additions - 1)
+                last = dest;
             }
-
-          it = g_sequence_insert_before (it, g_object_ref (additions[i]));
         }
+      first = dest;
+    }
+  else
+    {
+      GSequenceIter *it;
+
+      /* Each item goes after the previous one */
+      it = g_sequence_insert_sorted (store->items, g_object_ref (sorted[0]), compare_func, user_data);
+      first = g_sequence_iter_get_position (it);
+      for (i = 1; i < n_additions; i++)
+        it = g_sequence_insert_sorted (store->items, g_object_ref (sorted[i]), compare_func, user_data);
+      last = g_sequence_iter_get_position (it);
     }
 
-  g_list_store_items_changed (store, position, n_removals, n_additions);
+  g_free (sorted);
+
+  g_list_store_items_changed (store, first,
+                              last + 1 - first - n_additions,
+                              last + 1 - first);
+}
+
+/**
+ * g_list_store_freeze_items_changed:
+ * @store: a #GListStore
+ *
+ * Holds back #GListModel::items-changed on @store until
+ * g_list_store_thaw_items_changed() is called, and then emits it once
+ * for a range covering all the changes made in between.
+ *
+ * This lets a burst of changes be made with the functions that change
+ * a single item, while consumers of the model see one change.  The
+ * range can be much larger than the items actually changed, though, if
+ * the changes are far apart.
+ *
+ * Calls can be nested; the signal is emitted when the last freeze is
+ * thawed.  While frozen, g_list_model_get_n_items() and
+ * g_list_model_get_item() already reflect the changes, so @store
+ * should not be given to code that expects it to be consistent with
+ * the signals it has seen until it is thawed.
+ *
+ * Since: 2.54
+ */
+void
+g_list_store_freeze_items_changed (GListStore *store)
+{
+  g_return_if_fail (G_IS_LIST_STORE (store));
+
+  store->freeze_count++;
+}
+
+/**
+ * g_list_store_thaw_items_changed:
+ * @store: a #GListStore
+ *
+ * Reverts the effect of a previous call to
+ * g_list_store_freeze_items_changed(), emitting
+ * #GListModel::items-changed for the changes made since if it was the
+ * last one.
+ *
+ * Since: 2.54
+ */
+void
+g_list_store_thaw_items_changed (GListStore *store)
+{
+  g_return_if_fail (G_IS_LIST_STORE (store));
+  g_return_if_fail (store->freeze_count > 0);
+
+  if (--store->freeze_count > 0 || !store->have_pending)
+    return;
+
+  store->have_pending = FALSE;
+  g_list_model_items_changed (G_LIST_MODEL (store),
+                              store->pending_position,
+                              store->pending_removed,
+                              store->pending_added);
 }
@@ -38,6 +38,9 @@ G_DECLARE_FINAL_TYPE(GListStore, g_list_store, G, LIST_STORE, GObject)
 GLIB_AVAILABLE_IN_2_44
 GListStore *            g_list_store_new                                (GType       item_type);
 
+GLIB_AVAILABLE_IN_2_54
+GListStore *            g_list_store_new_indexed                        (GType       item_type);
+
 GLIB_AVAILABLE_IN_2_44
 void                    g_list_store_insert                             (GListStore *store,
                                                                          guint       position,
@@ -72,6 +75,19 @@ void                    g_list_store_splice                             (GListSt
                                                                          gpointer   *additions,
                                                                          guint       n_additions);
 
+GLIB_AVAILABLE_IN_2_54
+void                    g_list_store_merge_sorted                       (GListStore       *store,
+                                                                         gpointer         *additions,
+                                                                         guint             n_additions,
+                                                                         GCompareDataFunc  compare_func,
+                                                                         gpointer          user_data);
+
+GLIB_AVAILABLE_IN_2_54
+void                    g_list_store_freeze_items_changed               (GListStore *store);
+
+GLIB_AVAILABLE_IN_2_54
+void                    g_list_store_thaw_items_changed                 (GListStore *store);
+
 G_END_DECLS
 
 #endif /* __G_LIST_STORE_H__ */
@@ -1378,14 +1378,16 @@ g_local_file_set_attributes_from_info (GFile                *file,
   return res && chained_res;
 }
 
-static GFileInputStream *
-g_local_file_read (GFile         *file,
-		   GCancellable  *cancellable,
-		   GError       **error)
+/* Opens @file for reading and fills in @buf; returns -1 with @error
+ * set on failure, including when @file is a directory.
+ */
+static int
+g_local_file_open_for_reading (GFile           *file,
+                               GLocalFileStat  *buf,
+                               GError         **error)
 {
   GLocalFile *local = G_LOCAL_FILE (file);
   int fd, ret;
-  GLocalFileStat buf;
   
   fd = g_open (local->filename, O_RDONLY|O_BINARY, 0);
   if (fd == -1)
@@ -1395,35 +1397,86 @@ g_local_file_read (GFile         *file,
 #ifdef G_OS_WIN32
       if (errsv == EACCES)
 	{
-	  ret = _stati64 (local->filename, &buf);
-	  if (ret == 0 && S_ISDIR (buf.st_mode))
+	  ret = _stati64 (local->filename, buf);
+	  if (ret == 0 && S_ISDIR (buf->st_mode))
             errsv = EISDIR;
 	}
 #endif
       g_set_io_error (error,
 		      _("Error opening file %s: %s"),
                       file, errsv);
-      return NULL;
+      return -1;
     }
 
 #ifdef G_OS_WIN32
-  ret = _fstati64 (fd, &buf);
+  ret = _fstati64 (fd, buf);
 #else
-  ret = fstat (fd, &buf);
+  ret = fstat (fd, buf);
 #endif
 
-  if (ret == 0 && S_ISDIR (buf.st_mode))
+  if (ret != 0)
+    buf->st_mode = 0;
+
+  if (ret == 0 && S_ISDIR (buf->st_mode))
     {
       (void) g_close (fd, NULL);
       g_set_io_error (error,
 		      _("Error opening file %s: %s"),
                       file, EISDIR);
-      return NULL;
+      return -1;
     }
+
+  return fd;
+}
+
+static GFileInputStream *
+g_local_file_read (GFile         *file,
+		   GCancellable  *cancellable,
+		   GError       **error)
+{
+  GLocalFileStat buf;
+  int fd;
+
+  fd = g_local_file_open_for_reading (file, &buf, error);
+  if (fd == -1)
+    return NULL;
   
   return _g_local_file_input_stream_new (fd);
 }
 
+GFileInputStream *
+_g_local_file_read_mapped (GLocalFile    *local,
+                           GCancellable  *cancellable,
+                           GError       **error)
+{
+  GLocalFileStat buf;
+  GMappedFile *mapped;
+  GFileInputStream *stream;
+  int fd;
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return NULL;
+
+  fd = g_local_file_open_for_reading (G_FILE (local), &buf, error);
+  if (fd == -1)
+    return NULL;
+
+  /* Pipes, devices and the like can't be mapped usefully, and a
+   * mapping failure is not worth reporting when read() still works
+   */
+  if (!S_ISREG (buf.st_mode))
+    return _g_local_file_input_stream_new (fd);
+
+  mapped = g_mapped_file_new_from_fd (fd, FALSE, NULL);
+  if (mapped == NULL)
+    return _g_local_file_input_stream_new (fd);
+
+  stream = _g_local_file_input_stream_new_mapped (fd, mapped);
+  g_mapped_file_unref (mapped);
+
+  return stream;
+}
+
 static GFileOutputStream *
 g_local_file_append_to (GFile             *file,
 			GFileCreateFlags   flags,
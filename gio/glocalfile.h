@@ -46,6 +46,10 @@ GFile * _g_local_file_new      (const char *filename);
 
 const char * _g_local_file_get_filename (GLocalFile *file);
 
+GFileInputStream * _g_local_file_read_mapped (GLocalFile    *local,
+                                              GCancellable  *cancellable,
+                                              GError       **error);
+
 gboolean g_local_file_is_remote (const gchar *filename);
 
 GFile * g_local_file_new_from_dirname_and_basename (const char *dirname,
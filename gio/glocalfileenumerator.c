@@ -21,10 +21,13 @@
 #include "config.h"
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <glocalfileenumerator.h>
 #include <glocalfileinfo.h>
 #include <glocalfile.h>
 #include <gioerror.h>
+#include <gcancellable.h>
+#include "gfileinfo-priv.h"
 #include <string.h>
 #include <stdlib.h>
 #include "glibintl.h"
@@ -39,13 +42,47 @@
 #ifndef USE_GDIR
 
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <dirent.h>
 #include <errno.h>
 
+#if defined (__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef __NR_getdents64
+/* glibc's readdir() only asks the kernel for 32KiB of entries at a
+ * time; for directories with millions of entries fewer, larger reads
+ * add up.
+ */
+#define USE_GETDENTS64
+#define GETDENTS_BUFFER_SIZE (256 * 1024)
+
+struct linux_dirent64
+{
+  guint64 d_ino;
+  gint64 d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[];
+};
+#endif
+
+/* Chunks with at least this many entries that need a stat() have their
+ * infos looked up by several threads at once.
+ */
+#define PARALLEL_STAT_THRESHOLD 256
+#define PARALLEL_STAT_MAX_THREADS 8
+
 typedef struct {
   char *name;
   long inode;
   GFileType type;
+
+  /* Looked up ahead of time, see prefetch_infos() */
+  GFileInfo *info;
+  GError *error;
 } DirEntry;
 
 #endif
@@ -70,6 +107,12 @@ struct _GLocalFileEnumerator
   DirEntry *entries;
   int entries_pos;
   gboolean at_end;
+  GError *list_error;  /* see g_local_file_enumerator_next_info_list() */
+#ifdef USE_GETDENTS64
+  char *dirent_buf;
+  gssize dirent_buf_len;
+  gssize dirent_buf_pos;
+#endif
 #endif
   
   gboolean follow_symlinks;
@@ -84,21 +127,43 @@ static GFileInfo *g_local_file_enumerator_next_file (GFileEnumerator  *enumerato
 static gboolean   g_local_file_enumerator_close     (GFileEnumerator  *enumerator,
 						     GCancellable     *cancellable,
 						     GError          **error);
+#ifndef USE_GDIR
+static GFileInfoList *g_local_file_enumerator_next_info_list (GFileEnumerator  *enumerator,
+                                                              guint             max_files,
+                                                              GCancellable     *cancellable,
+                                                              GError          **error);
+#endif
 
 
+#ifndef USE_GDIR
 static void
-free_entries (GLocalFileEnumerator *local)
+clear_entries (GLocalFileEnumerator *local)
 {
-#ifndef USE_GDIR
   int i;
 
+  for (i = 0; local->entries[i].name != NULL; i++)
+    {
+      g_free (local->entries[i].name);
+      g_clear_object (&local->entries[i].info);
+      g_clear_error (&local->entries[i].error);
+    }
+}
+#endif
+
+static void
+free_entries (GLocalFileEnumerator *local)
+{
+#ifndef USE_GDIR
   if (local->entries != NULL)
     {
-      for (i = 0; local->entries[i].name != NULL; i++)
-	g_free (local->entries[i].name);
-      
+      clear_entries (local);
       g_free (local->entries);
     }
+
+  g_clear_error (&local->list_error);
+#ifdef USE_GETDENTS64
+  g_free (local->dirent_buf);
+#endif
 #endif
 }
 
@@ -140,6 +205,9 @@ g_local_file_enumerator_class_init (GLocalFileEnumeratorClass *klass)
 
   enumerator_class->next_file = g_local_file_enumerator_next_file;
   enumerator_class->close_fn = g_local_file_enumerator_close;
+#ifndef USE_GDIR
+  enumerator_class->next_info_list = g_local_file_enumerator_next_info_list;
+#endif
 }
 
 static void
@@ -264,6 +332,49 @@ _g_local_file_enumerator_new (GLocalFile *file,
   return G_FILE_ENUMERATOR (local);
 }
 
+/* Looks up the info for one entry; @file_type is what the directory
+ * entry said, if anything.  Called from worker threads too, see
+ * prefetch_infos().
+ */
+static GFileInfo *
+get_entry_info (GLocalFileEnumerator  *local,
+                const char            *filename,
+                GFileType              file_type,
+                GError               **error)
+{
+  GFileInfo *info;
+  char *path;
+
+  path = g_build_filename (local->filename, filename, NULL);
+  if (file_type == G_FILE_TYPE_UNKNOWN ||
+      (file_type == G_FILE_TYPE_SYMBOLIC_LINK && !(local->flags & G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS)))
+    {
+      info = _g_local_file_info_get (filename, path,
+                                     local->matcher,
+                                     local->flags,
+                                     &local->parent_info,
+                                     error); 
+    }
+  else
+    {
+      info = _g_local_file_info_get (filename, path,
+                                     local->reduced_matcher,
+                                     local->flags,
+                                     &local->parent_info,
+                                     error); 
+      if (info)
+        {
+          _g_local_file_info_get_nostat (info, filename, path, local->matcher);
+          g_file_info_set_file_type (info, file_type);
+          if (file_type == G_FILE_TYPE_SYMBOLIC_LINK)
+            g_file_info_set_is_symlink (info, TRUE);
+        }
+    }
+  g_free (path);
+
+  return info;
+}
+
 #ifndef USE_GDIR
 static int
 sort_by_inode (const void *_a, const void *_b)
@@ -299,11 +410,207 @@ file_type_from_dirent (char d_type)
 }
 #endif
 
-static const char *
-next_file_helper (GLocalFileEnumerator *local, GFileType *file_type)
+/* Returns the next entry other than "." and "..", or %FALSE at the end
+ * of the directory (or on error, which readdir() doesn't tell apart
+ * either).  @name is only valid until the next call.
+ */
+static gboolean
+read_dirent (GLocalFileEnumerator  *local,
+             const char           **name,
+             long                  *inode,
+             GFileType             *file_type)
 {
+#ifdef USE_GETDENTS64
+  struct linux_dirent64 *entry;
+
+  do
+    {
+      if (local->dirent_buf_pos >= local->dirent_buf_len)
+        {
+          if (local->dirent_buf == NULL)
+            local->dirent_buf = g_malloc (GETDENTS_BUFFER_SIZE);
+
+          do
+            local->dirent_buf_len = syscall (__NR_getdents64, dirfd (local->dir),
+                                             local->dirent_buf, GETDENTS_BUFFER_SIZE);
+          while (local->dirent_buf_len < 0 && errno == EINTR);
+
+          local->dirent_buf_pos = 0;
+          if (local->dirent_buf_len <= 0)
+            return FALSE;
+        }
+
+      entry = (struct linux_dirent64 *) (local->dirent_buf + local->dirent_buf_pos);
+      local->dirent_buf_pos += entry->d_reclen;
+    }
+  while (0 == strcmp (entry->d_name, ".") ||
+         0 == strcmp (entry->d_name, ".."));
+
+  *name = entry->d_name;
+  *inode = entry->d_ino;
+  *file_type = file_type_from_dirent (entry->d_type);
+
+  return TRUE;
+#else
   struct dirent *entry;
-  const char *filename;
+
+  entry = readdir (local->dir);
+  while (entry 
+         && (0 == strcmp (entry->d_name, ".") ||
+             0 == strcmp (entry->d_name, "..")))
+    entry = readdir (local->dir);
+
+  if (entry == NULL)
+    return FALSE;
+
+  *name = entry->d_name;
+  *inode = entry->d_ino;
+#if HAVE_STRUCT_DIRENT_D_TYPE
+  *file_type = file_type_from_dirent (entry->d_type);
+#else
+  *file_type = G_FILE_TYPE_UNKNOWN;
+#endif
+
+  return TRUE;
+#endif
+}
+
+static gboolean
+entry_needs_stat (GLocalFileEnumerator *local,
+                  DirEntry             *entry)
+{
+  if (entry->type == G_FILE_TYPE_UNKNOWN ||
+      (entry->type == G_FILE_TYPE_SYMBOLIC_LINK && !(local->flags & G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS)))
+    return local->matcher != NULL;
+
+  return local->reduced_matcher != NULL;
+}
+
+typedef struct {
+  GLocalFileEnumerator *local;
+  GCancellable *cancellable;
+  volatile gint next;
+  gint n_entries;
+
+  GMutex lock;
+  GCond cond;
+  gint n_running;
+} PrefetchData;
+
+/* Runs in the calling thread and in up to PARALLEL_STAT_MAX_THREADS - 1
+ * workers, each taking the next entry until none are left.
+ */
+static void
+prefetch_run (PrefetchData *data)
+{
+  GLocalFileEnumerator *local = data->local;
+  gint i;
+
+  while ((i = g_atomic_int_add (&data->next, 1)) < data->n_entries)
+    {
+      DirEntry *entry = &local->entries[i];
+
+      /* Entries left alone are looked up by next_file() as usual */
+      if (g_cancellable_is_cancelled (data->cancellable))
+        break;
+
+      entry->info = get_entry_info (local, entry->name, entry->type, &entry->error);
+    }
+}
+
+static void
+prefetch_worker (gpointer item,
+                 gpointer user_data)
+{
+  PrefetchData *data = item;
+
+  prefetch_run (data);
+
+  g_mutex_lock (&data->lock);
+  if (--data->n_running == 0)
+    g_cond_signal (&data->cond);
+  g_mutex_unlock (&data->lock);
+}
+
+static GThreadPool *
+get_prefetch_pool (void)
+{
+  static gsize pool = 0;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *p;
+
+      p = g_thread_pool_new (prefetch_worker, NULL,
+                             MIN (g_get_num_processors (), PARALLEL_STAT_MAX_THREADS) - 1,
+                             FALSE, NULL);
+      g_once_init_leave (&pool, (gsize) p);
+    }
+
+  return (GThreadPool *) pool;
+}
+
+/* Looking up the infos is mostly waiting for stat() and friends, which
+ * for large directories (and especially on network filesystems) goes a
+ * lot faster with several requests in flight.  Only worth it when most
+ * of a full chunk needs a stat at all.
+ */
+static void
+prefetch_infos (GLocalFileEnumerator *local,
+                int                   n_entries,
+                GCancellable         *cancellable)
+{
+  PrefetchData data;
+  GThreadPool *pool;
+  int i, n_stat, n_workers;
+
+  if (g_get_num_processors () < 2)
+    return;
+
+  n_stat = 0;
+  for (i = 0; i < n_entries; i++)
+    if (entry_needs_stat (local, &local->entries[i]))
+      n_stat++;
+
+  if (n_stat < PARALLEL_STAT_THRESHOLD)
+    return;
+
+  pool = get_prefetch_pool ();
+  if (pool == NULL)
+    return;
+
+  data.local = local;
+  data.cancellable = cancellable;
+  data.next = 0;
+  data.n_entries = n_entries;
+  g_mutex_init (&data.lock);
+  g_cond_init (&data.cond);
+
+  n_workers = g_thread_pool_get_max_threads (pool);
+  data.n_running = n_workers;
+  for (i = 0; i < n_workers; i++)
+    g_thread_pool_push (pool, &data, NULL);
+
+  prefetch_run (&data);
+
+  g_mutex_lock (&data.lock);
+  while (data.n_running > 0)
+    g_cond_wait (&data.cond, &data.lock);
+  g_mutex_unlock (&data.lock);
+
+  g_mutex_clear (&data.lock);
+  g_cond_clear (&data.cond);
+}
+
+static const char *
+next_file_helper (GLocalFileEnumerator  *local,
+                  GFileType             *file_type,
+                  GFileInfo            **info,
+                  GError               **error,
+                  gboolean               prefetch,
+                  GCancellable          *cancellable)
+{
+  DirEntry *entry;
   int i;
 
   if (local->at_end)
@@ -313,50 +620,42 @@ next_file_helper (GLocalFileEnumerator *local, GFileType *file_type)
       (local->entries[local->entries_pos].name == NULL))
     {
       if (local->entries == NULL)
-	local->entries = g_new (DirEntry, CHUNK_SIZE + 1);
+	local->entries = g_new0 (DirEntry, CHUNK_SIZE + 1);
       else
 	{
 	  /* Restart by clearing old names */
-	  for (i = 0; local->entries[i].name != NULL; i++)
-	    g_free (local->entries[i].name);
+	  clear_entries (local);
 	}
       
       for (i = 0; i < CHUNK_SIZE; i++)
 	{
-	  entry = readdir (local->dir);
-	  while (entry 
-		 && (0 == strcmp (entry->d_name, ".") ||
-		     0 == strcmp (entry->d_name, "..")))
-	    entry = readdir (local->dir);
-
-	  if (entry)
-	    {
-	      local->entries[i].name = g_strdup (entry->d_name);
-	      local->entries[i].inode = entry->d_ino;
-#if HAVE_STRUCT_DIRENT_D_TYPE
-              local->entries[i].type = file_type_from_dirent (entry->d_type);
-#else
-              local->entries[i].type = G_FILE_TYPE_UNKNOWN;
-#endif
-	    }
-	  else
+	  const char *name;
+
+	  if (!read_dirent (local, &name, &local->entries[i].inode, &local->entries[i].type))
 	    break;
+
+	  local->entries[i].name = g_strdup (name);
 	}
       local->entries[i].name = NULL;
       local->entries_pos = 0;
       
       qsort (local->entries, i, sizeof (DirEntry), sort_by_inode);
+
+      if (prefetch)
+        prefetch_infos (local, i, cancellable);
     }
 
-  filename = local->entries[local->entries_pos].name;
-  if (filename == NULL)
+  entry = &local->entries[local->entries_pos];
+  if (entry->name == NULL)
     local->at_end = TRUE;
     
-  *file_type = local->entries[local->entries_pos].type;
+  *file_type = entry->type;
+  *info = g_steal_pointer (&entry->info);
+  *error = g_steal_pointer (&entry->error);
 
   local->entries_pos++;
 
-  return filename;
+  return entry->name;
 }
 
 #endif
@@ -368,7 +667,6 @@ g_local_file_enumerator_next_file (GFileEnumerator  *enumerator,
 {
   GLocalFileEnumerator *local = G_LOCAL_FILE_ENUMERATOR (enumerator);
   const char *filename;
-  char *path;
   GFileInfo *info;
   GError *my_error;
   GFileType file_type;
@@ -381,43 +679,21 @@ g_local_file_enumerator_next_file (GFileEnumerator  *enumerator,
 
  next_file:
 
+  info = NULL;
+  my_error = NULL;
+
 #ifdef USE_GDIR
   filename = g_dir_read_name (local->dir);
   file_type = G_FILE_TYPE_UNKNOWN;
 #else
-  filename = next_file_helper (local, &file_type);
+  filename = next_file_helper (local, &file_type, &info, &my_error, TRUE, cancellable);
 #endif
 
   if (filename == NULL)
     return NULL;
 
-  my_error = NULL;
-  path = g_build_filename (local->filename, filename, NULL);
-  if (file_type == G_FILE_TYPE_UNKNOWN ||
-      (file_type == G_FILE_TYPE_SYMBOLIC_LINK && !(local->flags & G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS)))
-    {
-      info = _g_local_file_info_get (filename, path,
-                                     local->matcher,
-                                     local->flags,
-                                     &local->parent_info,
-                                     &my_error); 
-    }
-  else
-    {
-      info = _g_local_file_info_get (filename, path,
-                                     local->reduced_matcher,
-                                     local->flags,
-                                     &local->parent_info,
-                                     &my_error); 
-      if (info)
-        {
-          _g_local_file_info_get_nostat (info, filename, path, local->matcher);
-          g_file_info_set_file_type (info, file_type);
-          if (file_type == G_FILE_TYPE_SYMBOLIC_LINK)
-            g_file_info_set_is_symlink (info, TRUE);
-        }
-    }
-  g_free (path);
+  if (info == NULL && my_error == NULL)
+    info = get_entry_info (local, filename, file_type, &my_error);
 
   if (info == NULL)
     {
@@ -437,6 +713,183 @@ g_local_file_enumerator_next_file (GFileEnumerator  *enumerator,
   return info;
 }
 
+#ifndef USE_GDIR
+static GFileType
+file_type_from_mode (mode_t mode)
+{
+  if (S_ISREG (mode))
+    return G_FILE_TYPE_REGULAR;
+  else if (S_ISDIR (mode))
+    return G_FILE_TYPE_DIRECTORY;
+  else if (S_ISLNK (mode))
+    return G_FILE_TYPE_SYMBOLIC_LINK;
+  else
+    return G_FILE_TYPE_SPECIAL;
+}
+
+/* Only the attributes a #GFileInfoList can hold are looked up, straight
+ * from the directory entry and at most one stat(), which skips the
+ * xattr, content type, icon and ownership work
+ * _g_local_file_info_get() would do.
+ */
+static GFileInfoList *
+g_local_file_enumerator_next_info_list (GFileEnumerator  *enumerator,
+                                        guint             max_files,
+                                        GCancellable     *cancellable,
+                                        GError          **error)
+{
+  GLocalFileEnumerator *local = G_LOCAL_FILE_ENUMERATOR (enumerator);
+  gboolean want_type, want_size, want_mtime, want_mode;
+  GFileInfoList *list;
+  GError *my_error = NULL;
+
+  if (local->list_error != NULL)
+    {
+      g_propagate_error (error, g_steal_pointer (&local->list_error));
+      return NULL;
+    }
+
+  want_type = _g_file_attribute_matcher_matches_id (local->matcher, G_FILE_ATTRIBUTE_ID_STANDARD_TYPE);
+  want_size = _g_file_attribute_matcher_matches_id (local->matcher, G_FILE_ATTRIBUTE_ID_STANDARD_SIZE);
+  want_mtime = _g_file_attribute_matcher_matches_id (local->matcher, G_FILE_ATTRIBUTE_ID_TIME_MODIFIED);
+  want_mode = _g_file_attribute_matcher_matches_id (local->matcher, G_FILE_ATTRIBUTE_ID_UNIX_MODE);
+
+  list = _g_file_info_list_new ();
+
+  while (g_file_info_list_get_length (list) < max_files)
+    {
+      const char *filename;
+      GFileType file_type;
+      GFileInfo *info = NULL;
+      struct stat statbuf;
+      gboolean stat_ok;
+      guint fields = 0;
+      char *path;
+
+      if (g_cancellable_set_error_if_cancelled (cancellable, &my_error))
+        break;
+
+      filename = next_file_helper (local, &file_type, &info, &my_error, FALSE, cancellable);
+      if (filename == NULL)
+        break;
+
+      /* Already looked up by an earlier g_file_enumerator_next_file() */
+      if (info != NULL)
+        {
+          _g_file_info_list_append_info (list, info);
+          g_object_unref (info);
+          continue;
+        }
+      if (g_error_matches (my_error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+        {
+          g_clear_error (&my_error);
+          continue;
+        }
+      if (my_error != NULL)
+        break;
+
+      if (!want_size && !want_mtime && !want_mode &&
+          (!want_type ||
+           (file_type != G_FILE_TYPE_UNKNOWN &&
+            (file_type != G_FILE_TYPE_SYMBOLIC_LINK || (local->flags & G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS)))))
+        {
+          _g_file_info_list_append (list, filename,
+                                    want_type ? FILE_INFO_LIST_HAS_TYPE : 0,
+                                    file_type, 0, 0, 0);
+          continue;
+        }
+
+      path = g_build_filename (local->filename, filename, NULL);
+      stat_ok = g_lstat (path, &statbuf) == 0;
+      if (stat_ok && S_ISLNK (statbuf.st_mode) &&
+          !(local->flags & G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS))
+        {
+          struct stat target_statbuf;
+
+          /* Report broken links as symlinks */
+          if (stat (path, &target_statbuf) == 0)
+            statbuf = target_statbuf;
+        }
+
+      if (!stat_ok)
+        {
+          int errsv = errno;
+
+          /* Removed since it was read from the directory */
+          if (errsv == ENOENT)
+            {
+              g_free (path);
+              continue;
+            }
+
+          /* Don't bail out on EACCES, like _g_local_file_info_get() */
+          if (errsv != EACCES)
+            {
+              char *display_name = g_filename_display_name (path);
+              g_set_error (&my_error, G_IO_ERROR,
+                           g_io_error_from_errno (errsv),
+                           _("Error when getting information for file “%s”: %s"),
+                           display_name, g_strerror (errsv));
+              g_free (display_name);
+              g_free (path);
+              break;
+            }
+        }
+      g_free (path);
+
+      if (stat_ok)
+        {
+          gint64 mtime;
+
+          file_type = file_type_from_mode (statbuf.st_mode);
+
+          mtime = (gint64) statbuf.st_mtime * G_USEC_PER_SEC;
+#if defined (HAVE_STRUCT_STAT_ST_MTIMENSEC)
+          mtime += statbuf.st_mtimensec / 1000;
+#elif defined (HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC)
+          mtime += statbuf.st_mtim.tv_nsec / 1000;
+#endif
+
+          if (want_size)
+            fields |= FILE_INFO_LIST_HAS_SIZE;
+          if (want_mtime)
+            fields |= FILE_INFO_LIST_HAS_MTIME;
+          if (want_mode)
+            fields |= FILE_INFO_LIST_HAS_MODE;
+
+          if (want_type)
+            fields |= FILE_INFO_LIST_HAS_TYPE;
+
+          _g_file_info_list_append (list, filename, fields, file_type,
+                                    statbuf.st_size, mtime, statbuf.st_mode);
+        }
+      else
+        _g_file_info_list_append (list, filename,
+                                  want_type && file_type != G_FILE_TYPE_UNKNOWN ? FILE_INFO_LIST_HAS_TYPE : 0,
+                                  file_type, 0, 0, 0);
+    }
+
+  if (my_error == NULL)
+    return list;
+
+  if (g_file_info_list_get_length (list) > 0)
+    {
+      /* Return what we have, and the error on the next call */
+      if (g_error_matches (my_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_error_free (my_error);
+      else
+        local->list_error = my_error;
+
+      return list;
+    }
+
+  g_file_info_list_unref (list);
+  g_propagate_error (error, my_error);
+
+  return NULL;
+}
+#endif
+
 static gboolean
 g_local_file_enumerator_close (GFileEnumerator  *enumerator,
 			       GCancellable     *cancellable,
@@ -24,6 +24,7 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <string.h>
 
 #include <glib.h>
 #include <glib/gstdio.h>
@@ -31,6 +32,8 @@
 #include "gioerror.h"
 #include "glocalfileinputstream.h"
 #include "glocalfileinfo.h"
+#include "giouring.h"
+#include "gtask.h"
 #include "glibintl.h"
 
 #ifdef G_OS_UNIX
@@ -46,6 +49,12 @@
 struct _GLocalFileInputStreamPrivate {
   int fd;
   guint do_close : 1;
+
+  /* Set when the stream serves its data from a mapping of the file;
+   * @pos is then the stream position and the fd offset is unused.
+   */
+  GBytes *mapped;
+  goffset pos;
 };
 
 #ifdef G_OS_UNIX
@@ -86,8 +95,19 @@ static GFileInfo *g_local_file_input_stream_query_info (GFileInputStream  *strea
 							const char        *attributes,
 							GCancellable      *cancellable,
 							GError           **error);
+static GBytes *   g_local_file_input_stream_read_bytes (GInputStream      *stream,
+							gsize              count,
+							GCancellable      *cancellable,
+							GError           **error);
 #ifdef G_OS_UNIX
 static int        g_local_file_input_stream_get_fd     (GFileDescriptorBased *stream);
+static void       g_local_file_input_stream_read_async (GInputStream      *stream,
+							void              *buffer,
+							gsize              count,
+							int                io_priority,
+							GCancellable      *cancellable,
+							GAsyncReadyCallback callback,
+							gpointer           user_data);
 #endif
 
 void
@@ -97,19 +117,41 @@ _g_local_file_input_stream_set_do_close (GLocalFileInputStream *in,
   in->priv->do_close = do_close;
 }
 
+static void
+g_local_file_input_stream_finalize (GObject *object)
+{
+  GLocalFileInputStream *file;
+
+  file = G_LOCAL_FILE_INPUT_STREAM (object);
+
+  g_clear_pointer (&file->priv->mapped, g_bytes_unref);
+
+  G_OBJECT_CLASS (g_local_file_input_stream_parent_class)->finalize (object);
+}
+
 static void
 g_local_file_input_stream_class_init (GLocalFileInputStreamClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   GInputStreamClass *stream_class = G_INPUT_STREAM_CLASS (klass);
   GFileInputStreamClass *file_stream_class = G_FILE_INPUT_STREAM_CLASS (klass);
 
+  gobject_class->finalize = g_local_file_input_stream_finalize;
+
   stream_class->read_fn = g_local_file_input_stream_read;
   stream_class->skip = g_local_file_input_stream_skip;
   stream_class->close_fn = g_local_file_input_stream_close;
+  stream_class->read_bytes = g_local_file_input_stream_read_bytes;
   file_stream_class->tell = g_local_file_input_stream_tell;
   file_stream_class->can_seek = g_local_file_input_stream_can_seek;
   file_stream_class->seek = g_local_file_input_stream_seek;
   file_stream_class->query_info = g_local_file_input_stream_query_info;
+
+#ifdef G_OS_UNIX
+  /* Otherwise the default implementation runs read_fn in a thread */
+  if (_g_io_uring_is_enabled ())
+    stream_class->read_async = g_local_file_input_stream_read_async;
+#endif
 }
 
 #ifdef G_OS_UNIX
@@ -138,6 +180,32 @@ _g_local_file_input_stream_new (int fd)
   return G_FILE_INPUT_STREAM (stream);
 }
 
+/*
+ * _g_local_file_input_stream_new_mapped:
+ * @fd: a file descriptor open for reading
+ * @mapped: a #GMappedFile of the regular file @fd refers to
+ *
+ * Creates a stream that serves reads, skips and seeks by copying out
+ * of @mapped, and g_input_stream_read_bytes() without copying at all.
+ * @fd is still owned by the stream and used for query_info() and
+ * g_file_descriptor_based_get_fd(); its file offset is not updated.
+ */
+GFileInputStream *
+_g_local_file_input_stream_new_mapped (int          fd,
+                                       GMappedFile *mapped)
+{
+  GLocalFileInputStream *stream;
+
+  stream = g_object_new (G_TYPE_LOCAL_FILE_INPUT_STREAM, NULL);
+  stream->priv->fd = fd;
+  stream->priv->mapped = g_mapped_file_get_bytes (mapped);
+  stream->priv->pos = 0;
+
+  g_mapped_file_advise (mapped, G_MAPPED_FILE_ADVICE_SEQUENTIAL, 0, 0);
+
+  return G_FILE_INPUT_STREAM (stream);
+}
+
 static gssize
 g_local_file_input_stream_read (GInputStream  *stream,
 				void          *buffer,
@@ -150,6 +218,25 @@ g_local_file_input_stream_read (GInputStream  *stream,
 
   file = G_LOCAL_FILE_INPUT_STREAM (stream);
 
+  if (file->priv->mapped != NULL)
+    {
+      const guint8 *data;
+      gsize size;
+
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        return -1;
+
+      data = g_bytes_get_data (file->priv->mapped, &size);
+      if (file->priv->pos >= (goffset) size)
+        return 0;
+
+      count = MIN (count, size - file->priv->pos);
+      memcpy (buffer, data + file->priv->pos, count);
+      file->priv->pos += count;
+
+      return count;
+    }
+
   res = -1;
   while (1)
     {
@@ -175,6 +262,91 @@ g_local_file_input_stream_read (GInputStream  *stream,
   return res;
 }
 
+#ifdef G_OS_UNIX
+static void
+g_local_file_input_stream_read_async (GInputStream        *stream,
+				      void                *buffer,
+				      gsize                count,
+				      int                  io_priority,
+				      GCancellable        *cancellable,
+				      GAsyncReadyCallback  callback,
+				      gpointer             user_data)
+{
+  GLocalFileInputStream *file;
+  GTask *task;
+  gboolean submitted;
+
+  file = G_LOCAL_FILE_INPUT_STREAM (stream);
+
+  /* A mapped stream has no meaningful fd offset to read from */
+  if (file->priv->mapped != NULL)
+    {
+      G_INPUT_STREAM_CLASS (g_local_file_input_stream_parent_class)->read_async (stream, buffer, count,
+										 io_priority, cancellable,
+										 callback, user_data);
+      return;
+    }
+
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_local_file_input_stream_read_async);
+  g_task_set_priority (task, io_priority);
+
+  submitted = _g_io_uring_read (task, file->priv->fd, buffer, count);
+  g_object_unref (task);
+
+  if (!submitted)
+    G_INPUT_STREAM_CLASS (g_local_file_input_stream_parent_class)->read_async (stream, buffer, count,
+									       io_priority, cancellable,
+									       callback, user_data);
+}
+#endif
+
+static GBytes *
+g_local_file_input_stream_read_bytes (GInputStream  *stream,
+				      gsize          count,
+				      GCancellable  *cancellable,
+				      GError       **error)
+{
+  GLocalFileInputStream *file;
+  GBytes *bytes;
+  gsize size;
+  guchar *buf;
+  gssize nread;
+
+  file = G_LOCAL_FILE_INPUT_STREAM (stream);
+
+  if (file->priv->mapped != NULL)
+    {
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        return NULL;
+
+      size = g_bytes_get_size (file->priv->mapped);
+      if (file->priv->pos >= (goffset) size)
+        return g_bytes_new_static ("", 0);
+
+      count = MIN (count, size - file->priv->pos);
+      bytes = g_bytes_new_from_bytes (file->priv->mapped, file->priv->pos, count);
+      file->priv->pos += count;
+
+      return bytes;
+    }
+
+  buf = g_malloc (count);
+  nread = g_local_file_input_stream_read (stream, buf, count, cancellable, error);
+  if (nread == -1)
+    {
+      g_free (buf);
+      return NULL;
+    }
+  else if (nread == 0)
+    {
+      g_free (buf);
+      return g_bytes_new_static ("", 0);
+    }
+
+  return g_bytes_new_take (buf, nread);
+}
+
 static gssize
 g_local_file_input_stream_skip (GInputStream  *stream,
 				gsize          count,
@@ -188,6 +360,20 @@ g_local_file_input_stream_skip (GInputStream  *stream,
   
   if (g_cancellable_set_error_if_cancelled (cancellable, error))
     return -1;
+
+  if (file->priv->mapped != NULL)
+    {
+      gsize size;
+
+      size = g_bytes_get_size (file->priv->mapped);
+      if (file->priv->pos >= (goffset) size)
+        return 0;
+
+      count = MIN (count, size - file->priv->pos);
+      file->priv->pos += count;
+
+      return count;
+    }
   
   start = lseek (file->priv->fd, 0, SEEK_CUR);
   if (start == -1)
@@ -268,6 +454,9 @@ g_local_file_input_stream_tell (GFileInputStream *stream)
   off_t pos;
 
   file = G_LOCAL_FILE_INPUT_STREAM (stream);
+
+  if (file->priv->mapped != NULL)
+    return file->priv->pos;
   
   pos = lseek (file->priv->fd, 0, SEEK_CUR);
 
@@ -284,6 +473,9 @@ g_local_file_input_stream_can_seek (GFileInputStream *stream)
   off_t pos;
 
   file = G_LOCAL_FILE_INPUT_STREAM (stream);
+
+  if (file->priv->mapped != NULL)
+    return TRUE;
   
   pos = lseek (file->priv->fd, 0, SEEK_CUR);
 
@@ -322,6 +514,42 @@ g_local_file_input_stream_seek (GFileInputStream  *stream,
 
   file = G_LOCAL_FILE_INPUT_STREAM (stream);
 
+  if (file->priv->mapped != NULL)
+    {
+      goffset base;
+
+      switch (type)
+        {
+        default:
+        case G_SEEK_CUR:
+          base = file->priv->pos;
+          break;
+        case G_SEEK_SET:
+          base = 0;
+          break;
+        case G_SEEK_END:
+          base = g_bytes_get_size (file->priv->mapped);
+          break;
+        }
+
+      /* Like lseek(), seeking past the end is allowed and reads
+       * there return end-of-file
+       */
+      if ((offset < 0 && base + offset < 0) ||
+          (offset > 0 && base > G_MAXINT64 - offset))
+        {
+          g_set_error (error, G_IO_ERROR,
+                       g_io_error_from_errno (EINVAL),
+                       _("Error seeking in file: %s"),
+                       g_strerror (EINVAL));
+          return FALSE;
+        }
+
+      file->priv->pos = base + offset;
+
+      return TRUE;
+    }
+
   pos = lseek (file->priv->fd, offset, seek_type_to_lseek (type));
 
   if (pos == (off_t)-1)
@@ -52,6 +52,8 @@ struct _GLocalFileInputStreamClass
 GType              _g_local_file_input_stream_get_type (void) G_GNUC_CONST;
 
 GFileInputStream *_g_local_file_input_stream_new          (int                    fd);
+GFileInputStream *_g_local_file_input_stream_new_mapped   (int                    fd,
+							   GMappedFile           *mapped);
 void              _g_local_file_input_stream_set_do_close (GLocalFileInputStream *in,
 							   gboolean               do_close);
 
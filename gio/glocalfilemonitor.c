@@ -219,6 +219,26 @@ g_file_monitor_source_remove_pending_change (GFileMonitorSource *fms,
   g_sequence_remove (iter);
 }
 
+/* @child is a basename, or for recursive monitors possibly a path
+ * relative to the directory
+ */
+static GFile *
+g_file_monitor_source_get_child (GFileMonitorSource *fms,
+                                 const gchar        *child)
+{
+  GFile *file;
+  gchar *path;
+
+  if (!strchr (child, '/'))
+    return g_local_file_new_from_dirname_and_basename (fms->dirname, child);
+
+  path = g_build_filename (fms->dirname, child, NULL);
+  file = _g_local_file_new (path);
+  g_free (path);
+
+  return file;
+}
+
 static void
 g_file_monitor_source_queue_event (GFileMonitorSource *fms,
                                    GFileMonitorEvent   event_type,
@@ -230,7 +250,7 @@ g_file_monitor_source_queue_event (GFileMonitorSource *fms,
   event = g_slice_new (QueuedEvent);
   event->event_type = event_type;
   if (child)
-    event->child = g_local_file_new_from_dirname_and_basename (fms->dirname, child);
+    event->child = g_file_monitor_source_get_child (fms, child);
   else if (fms->dirname)
     event->child = _g_local_file_new (fms->dirname);
   else if (fms->filename)
@@ -331,6 +351,30 @@ is_basename (const gchar *name)
   return !strchr (name, '/');
 }
 
+static gboolean
+is_child (GFileMonitorSource *fms,
+          const gchar        *name)
+{
+  gchar **components;
+  gboolean result;
+  gint i;
+
+  if (is_basename (name))
+    return TRUE;
+
+  if (!(fms->flags & G_FILE_MONITOR_WATCH_RECURSIVE) || name[0] == '/')
+    return FALSE;
+
+  components = g_strsplit (name, "/", -1);
+  result = TRUE;
+  for (i = 0; components[i]; i++)
+    if (!components[i][0] || !is_basename (components[i]))
+      result = FALSE;
+  g_strfreev (components);
+
+  return result;
+}
+
 gboolean
 g_file_monitor_source_handle_event (GFileMonitorSource *fms,
                                     GFileMonitorEvent   event_type,
@@ -341,8 +385,8 @@ g_file_monitor_source_handle_event (GFileMonitorSource *fms,
 {
   gboolean interesting = TRUE;
 
-  g_assert (!child || is_basename (child));
-  g_assert (!rename_to || is_basename (rename_to));
+  g_assert (!child || is_child (fms, child));
+  g_assert (!rename_to || is_child (fms, rename_to));
 
   if (fms->basename && (!child || !g_str_equal (child, fms->basename))
                     && (!rename_to || !g_str_equal (rename_to, fms->basename)))
@@ -398,7 +442,7 @@ g_file_monitor_source_handle_event (GFileMonitorSource *fms,
         {
           GFile *other;
 
-          other = g_local_file_new_from_dirname_and_basename (fms->dirname, rename_to);
+          other = g_file_monitor_source_get_child (fms, rename_to);
           g_file_monitor_source_file_changes_done (fms, rename_to);
           g_file_monitor_source_send_event (fms, G_FILE_MONITOR_EVENT_RENAMED, child, other);
           g_object_unref (other);
@@ -407,7 +451,7 @@ g_file_monitor_source_handle_event (GFileMonitorSource *fms,
         {
           GFile *other;
 
-          other = g_local_file_new_from_dirname_and_basename (fms->dirname, rename_to);
+          other = g_file_monitor_source_get_child (fms, rename_to);
           g_file_monitor_source_file_changes_done (fms, rename_to);
           g_file_monitor_source_send_event (fms, G_FILE_MONITOR_EVENT_MOVED, child, other);
           g_object_unref (other);
@@ -477,6 +521,44 @@ g_file_monitor_source_set_rate_limit (GFileMonitorSource *fms,
   return changed;
 }
 
+/* Drops all but the last CHANGED, ATTRIBUTE_CHANGED and
+ * CHANGES_DONE_HINT event for each file from @queue.
+ */
+static void
+g_file_monitor_source_coalesce_events (GQueue *queue)
+{
+  GHashTable *seen;
+  GList *l, *prev;
+
+  seen = g_hash_table_new (g_file_hash, (GEqualFunc) g_file_equal);
+
+  for (l = queue->tail; l; l = prev)
+    {
+      QueuedEvent *event = l->data;
+      guint kinds, kind;
+
+      prev = l->prev;
+
+      if (event->event_type != G_FILE_MONITOR_EVENT_CHANGED &&
+          event->event_type != G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED &&
+          event->event_type != G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT)
+        continue;
+
+      kind = 1u << event->event_type;
+      kinds = GPOINTER_TO_UINT (g_hash_table_lookup (seen, event->child));
+
+      if (kinds & kind)
+        {
+          g_queue_delete_link (queue, l);
+          queued_event_free (event);
+        }
+      else
+        g_hash_table_insert (seen, event->child, GUINT_TO_POINTER (kinds | kind));
+    }
+
+  g_hash_table_unref (seen);
+}
+
 static gboolean
 g_file_monitor_source_dispatch (GSource     *source,
                                 GSourceFunc  callback,
@@ -485,6 +567,8 @@ g_file_monitor_source_dispatch (GSource     *source,
   GFileMonitorSource *fms = (GFileMonitorSource *) source;
   QueuedEvent *event;
   GQueue event_queue;
+  GArray *changes;
+  GList *l;
   gint64 now;
 
   /* make sure the monitor still exists */
@@ -538,16 +622,31 @@ g_file_monitor_source_dispatch (GSource     *source,
 
   g_mutex_unlock (&fms->lock);
 
-  /* We now have our list of events to deliver */
-  while ((event = g_queue_pop_head (&event_queue)))
+  if (fms->flags & G_FILE_MONITOR_COALESCE_EVENTS)
+    g_file_monitor_source_coalesce_events (&event_queue);
+
+  /* We now have our list of events to deliver, all in one go */
+  changes = g_array_sized_new (FALSE, FALSE, sizeof (GFileMonitorChange), event_queue.length);
+
+  for (l = event_queue.head; l; l = l->next)
     {
-      /* an event handler could destroy 'instance', so check each time */
-      if (fms->instance)
-        g_file_monitor_emit_event (fms->instance, event->child, event->other, event->event_type);
+      GFileMonitorChange change;
 
-      queued_event_free (event);
+      event = l->data;
+      change.file = event->child;
+      change.other_file = event->other;
+      change.event_type = event->event_type;
+      g_array_append_val (changes, change);
     }
 
+  if (fms->instance)
+    g_file_monitor_emit_events (fms->instance, (GFileMonitorChange *) changes->data, changes->len);
+
+  g_array_unref (changes);
+
+  while ((event = g_queue_pop_head (&event_queue)))
+    queued_event_free (event);
+
   return TRUE;
 }
 
@@ -819,11 +918,28 @@ static void g_local_file_monitor_class_init (GLocalFileMonitorClass *class)
 }
 
 static GLocalFileMonitor *
-g_local_file_monitor_new (gboolean   is_remote_fs,
-                          GError   **error)
+g_local_file_monitor_new (gboolean            is_remote_fs,
+                          GFileMonitorFlags   flags,
+                          GError            **error)
 {
   GType type = G_TYPE_INVALID;
 
+  if (flags & G_FILE_MONITOR_WATCH_RECURSIVE)
+    {
+      type = _g_io_module_get_default_type (G_RECURSIVE_FILE_MONITOR_EXTENSION_POINT_NAME,
+                                            NULL,
+                                            G_STRUCT_OFFSET (GLocalFileMonitorClass, is_supported));
+
+      if (type == G_TYPE_INVALID)
+        {
+          g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                               _("Recursive file monitoring is not supported"));
+          return NULL;
+        }
+
+      return g_object_new (type, NULL);
+    }
+
   if (is_remote_fs)
     type = _g_io_module_get_default_type (G_NFS_FILE_MONITOR_EXTENSION_POINT_NAME,
                                           "GIO_USE_FILE_MONITOR",
@@ -853,9 +969,13 @@ g_local_file_monitor_new_for_path (const gchar        *pathname,
   GLocalFileMonitor *monitor;
   gboolean is_remote_fs;
 
+  /* Only directories have anything below them */
+  if (!is_directory)
+    flags &= ~G_FILE_MONITOR_WATCH_RECURSIVE;
+
   is_remote_fs = g_local_file_is_remote (pathname);
 
-  monitor = g_local_file_monitor_new (is_remote_fs, error);
+  monitor = g_local_file_monitor_new (is_remote_fs, flags, error);
 
   if (monitor)
     g_local_file_monitor_start (monitor, pathname, is_directory, flags, g_main_context_get_thread_default ());
@@ -874,9 +994,13 @@ g_local_file_monitor_new_in_worker (const gchar           *pathname,
   GLocalFileMonitor *monitor;
   gboolean is_remote_fs;
 
+  /* Only directories have anything below them */
+  if (!is_directory)
+    flags &= ~G_FILE_MONITOR_WATCH_RECURSIVE;
+
   is_remote_fs = g_local_file_is_remote (pathname);
 
-  monitor = g_local_file_monitor_new (is_remote_fs, error);
+  monitor = g_local_file_monitor_new (is_remote_fs, flags, error);
 
   if (monitor)
     {
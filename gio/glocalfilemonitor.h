@@ -35,6 +35,7 @@ G_BEGIN_DECLS
 
 #define G_LOCAL_FILE_MONITOR_EXTENSION_POINT_NAME "gio-local-file-monitor"
 #define G_NFS_FILE_MONITOR_EXTENSION_POINT_NAME   "gio-nfs-file-monitor"
+#define G_RECURSIVE_FILE_MONITOR_EXTENSION_POINT_NAME "gio-recursive-file-monitor"
 
 typedef struct _GLocalFileMonitor      GLocalFileMonitor;
 typedef struct _GLocalFileMonitorClass GLocalFileMonitorClass;
@@ -34,6 +34,8 @@
 #include "glocalfileoutputstream.h"
 #include "gfileinfo.h"
 #include "glocalfileinfo.h"
+#include "giouring.h"
+#include "gtask.h"
 
 #ifdef G_OS_UNIX
 #include <unistd.h>
@@ -113,6 +115,13 @@ static gboolean   g_local_file_output_stream_truncate     (GFileOutputStream  *s
 							   GError            **error);
 #ifdef G_OS_UNIX
 static int        g_local_file_output_stream_get_fd       (GFileDescriptorBased *stream);
+static void       g_local_file_output_stream_write_async  (GOutputStream        *stream,
+							   const void           *buffer,
+							   gsize                 count,
+							   int                   io_priority,
+							   GCancellable         *cancellable,
+							   GAsyncReadyCallback   callback,
+							   gpointer              user_data);
 #endif
 
 static void
@@ -148,6 +157,12 @@ g_local_file_output_stream_class_init (GLocalFileOutputStreamClass *klass)
   file_stream_class->seek = g_local_file_output_stream_seek;
   file_stream_class->can_truncate = g_local_file_output_stream_can_truncate;
   file_stream_class->truncate_fn = g_local_file_output_stream_truncate;
+
+#ifdef G_OS_UNIX
+  /* Otherwise the default implementation runs write_fn in a thread */
+  if (_g_io_uring_is_enabled ())
+    stream_class->write_async = g_local_file_output_stream_write_async;
+#endif
 }
 
 #ifdef G_OS_UNIX
@@ -201,6 +216,36 @@ g_local_file_output_stream_write (GOutputStream  *stream,
   return res;
 }
 
+#ifdef G_OS_UNIX
+static void
+g_local_file_output_stream_write_async (GOutputStream       *stream,
+					const void          *buffer,
+					gsize                count,
+					int                  io_priority,
+					GCancellable        *cancellable,
+					GAsyncReadyCallback  callback,
+					gpointer             user_data)
+{
+  GLocalFileOutputStream *file;
+  GTask *task;
+  gboolean submitted;
+
+  file = G_LOCAL_FILE_OUTPUT_STREAM (stream);
+
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_local_file_output_stream_write_async);
+  g_task_set_priority (task, io_priority);
+
+  submitted = _g_io_uring_write (task, file->priv->fd, buffer, count);
+  g_object_unref (task);
+
+  if (!submitted)
+    G_OUTPUT_STREAM_CLASS (g_local_file_output_stream_parent_class)->write_async (stream, buffer, count,
+										  io_priority, cancellable,
+										  callback, user_data);
+}
+#endif
+
 void
 _g_local_file_output_stream_set_do_close (GLocalFileOutputStream *out,
 					  gboolean do_close)
@@ -42,6 +42,12 @@
  *
  * As of GLib 2.34, #GMemoryOutputStream trivially implements
  * #GPollableOutputStream: it always polls as ready.
+ *
+ * As of GLib 2.54, a stream created with
+ * g_memory_output_stream_new_chunked() keeps its data in a list of
+ * fixed-size blocks instead of one growing buffer, so large outputs are
+ * never copied while they grow. The blocks can be handed over without
+ * copying with g_memory_output_stream_steal_as_bytes_list().
  */
 
 #define MIN_ARRAY_SIZE  16
@@ -52,7 +58,8 @@ enum {
   PROP_SIZE,
   PROP_DATA_SIZE,
   PROP_REALLOC_FUNCTION,
-  PROP_DESTROY_FUNCTION
+  PROP_DESTROY_FUNCTION,
+  PROP_CHUNK_SIZE
 };
 
 struct _GMemoryOutputStreamPrivate
@@ -65,6 +72,12 @@ struct _GMemoryOutputStreamPrivate
 
   GReallocFunc   realloc_fn;
   GDestroyNotify destroy;
+
+  /* In chunked mode @data is unused and @len is the total size of
+   * @chunks, each of which is @chunk_size bytes.
+   */
+  gsize          chunk_size;
+  GPtrArray     *chunks;
 };
 
 static void     g_memory_output_stream_set_property (GObject      *object,
@@ -76,6 +89,7 @@ static void     g_memory_output_stream_get_property (GObject      *object,
                                                      GValue       *value,
                                                      GParamSpec   *pspec);
 static void     g_memory_output_stream_finalize     (GObject      *object);
+static void     g_memory_output_stream_constructed  (GObject      *object);
 
 static gssize   g_memory_output_stream_write       (GOutputStream *stream,
                                                     const void    *buffer,
@@ -134,6 +148,7 @@ g_memory_output_stream_class_init (GMemoryOutputStreamClass *klass)
   gobject_class->set_property = g_memory_output_stream_set_property;
   gobject_class->get_property = g_memory_output_stream_get_property;
   gobject_class->finalize     = g_memory_output_stream_finalize;
+  gobject_class->constructed  = g_memory_output_stream_constructed;
 
   ostream_class = G_OUTPUT_STREAM_CLASS (klass);
 
@@ -218,6 +233,24 @@ g_memory_output_stream_class_init (GMemoryOutputStreamClass *klass)
                                                          P_("Function called with the buffer as argument when the stream is destroyed."),
                                                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
                                                          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GMemoryOutputStream:chunk-size:
+   *
+   * If non-zero, the stream stores its data in blocks of this many
+   * bytes rather than in a single buffer. See
+   * g_memory_output_stream_new_chunked().
+   *
+   * Since: 2.54
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_CHUNK_SIZE,
+                                   g_param_spec_ulong ("chunk-size",
+                                                       P_("Chunk Size"),
+                                                       P_("Size of the blocks the data is stored in, or 0 for a single buffer."),
+                                                       0, G_MAXULONG, 0,
+                                                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+                                                       G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -253,6 +286,9 @@ g_memory_output_stream_set_property (GObject      *object,
     case PROP_DESTROY_FUNCTION:
       priv->destroy = g_value_get_pointer (value);
       break;
+    case PROP_CHUNK_SIZE:
+      priv->chunk_size = g_value_get_ulong (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -288,6 +324,9 @@ g_memory_output_stream_get_property (GObject      *object,
     case PROP_DESTROY_FUNCTION:
       g_value_set_pointer (value, priv->destroy);
       break;
+    case PROP_CHUNK_SIZE:
+      g_value_set_ulong (value, priv->chunk_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -306,9 +345,36 @@ g_memory_output_stream_finalize (GObject *object)
   if (priv->destroy)
     priv->destroy (priv->data);
 
+  if (priv->chunks)
+    g_ptr_array_unref (priv->chunks);
+
   G_OBJECT_CLASS (g_memory_output_stream_parent_class)->finalize (object);
 }
 
+static void
+g_memory_output_stream_constructed (GObject *object)
+{
+  GMemoryOutputStream        *stream;
+  GMemoryOutputStreamPrivate *priv;
+
+  stream = G_MEMORY_OUTPUT_STREAM (object);
+  priv = stream->priv;
+
+  if (priv->chunk_size > 0)
+    {
+      g_warn_if_fail (priv->data == NULL);
+
+      /* Chunked streams always grow, and manage their own memory */
+      priv->data = NULL;
+      priv->len = 0;
+      priv->realloc_fn = g_realloc;
+      priv->destroy = g_free;
+      priv->chunks = g_ptr_array_new_with_free_func (g_free);
+    }
+
+  G_OBJECT_CLASS (g_memory_output_stream_parent_class)->constructed (object);
+}
+
 static void
 g_memory_output_stream_seekable_iface_init (GSeekableIface *iface)
 {
@@ -413,6 +479,82 @@ g_memory_output_stream_new_resizable (void)
   return g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
 }
 
+/**
+ * g_memory_output_stream_new_chunked:
+ * @chunk_size: the size of each block of storage, in bytes
+ *
+ * Creates a new resizable #GMemoryOutputStream that stores its data in
+ * blocks of @chunk_size bytes allocated with g_malloc(), rather than in
+ * a single buffer that is reallocated as it grows. Growing the stream
+ * never copies data that was already written.
+ *
+ * Such a stream can seek and truncate like any resizable stream, but
+ * has no contiguous buffer: g_memory_output_stream_get_data() returns
+ * %NULL, and g_memory_output_stream_steal_data() and
+ * g_memory_output_stream_steal_as_bytes() join the blocks into a new
+ * buffer. Use g_memory_output_stream_steal_as_bytes_list() to take the
+ * blocks without copying them.
+ *
+ * Returns: (transfer full): a new #GMemoryOutputStream
+ *
+ * Since: 2.54
+ */
+GOutputStream *
+g_memory_output_stream_new_chunked (gsize chunk_size)
+{
+  g_return_val_if_fail (chunk_size > 0, NULL);
+
+  return g_object_new (G_TYPE_MEMORY_OUTPUT_STREAM,
+                       "chunk-size", (gulong) chunk_size,
+                       NULL);
+}
+
+/* Copies the written part of a chunked stream into one new buffer */
+static gpointer
+chunks_join (GMemoryOutputStreamPrivate *priv)
+{
+  guint8 *data;
+  gsize offset, n;
+  guint i;
+
+  data = g_malloc (priv->valid_len);
+
+  for (i = 0, offset = 0; offset < priv->valid_len; i++, offset += n)
+    {
+      n = MIN (priv->chunk_size, priv->valid_len - offset);
+      memcpy (data + offset, priv->chunks->pdata[i], n);
+    }
+
+  return data;
+}
+
+/* Allocates zeroed blocks until the stream can hold @size bytes */
+static gboolean
+chunks_ensure (GMemoryOutputStream  *ostream,
+               gsize                 size,
+               GError              **error)
+{
+  GMemoryOutputStreamPrivate *priv = ostream->priv;
+
+  if (size > G_MAXSIZE - priv->chunk_size)
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_NO_SPACE,
+                           _("Amount of memory required to process the write is "
+                             "larger than available address space"));
+      return FALSE;
+    }
+
+  while (priv->len < size)
+    {
+      g_ptr_array_add (priv->chunks, g_malloc0 (priv->chunk_size));
+      priv->len += priv->chunk_size;
+    }
+
+  return TRUE;
+}
+
 /**
  * g_memory_output_stream_get_data:
  * @ostream: a #GMemoryOutputStream
@@ -422,6 +564,9 @@ g_memory_output_stream_new_resizable (void)
  * Note that the returned pointer may become invalid on the next
  * write or truncate operation on the stream.
  *
+ * Streams created with g_memory_output_stream_new_chunked() have no
+ * single buffer, and always return %NULL.
+ *
  * Returns: (transfer none): pointer to the stream's data, or %NULL if the data
  *    has been stolen
  **/
@@ -506,6 +651,14 @@ g_memory_output_stream_steal_data (GMemoryOutputStream *ostream)
   g_return_val_if_fail (G_IS_MEMORY_OUTPUT_STREAM (ostream), NULL);
   g_return_val_if_fail (g_output_stream_is_closed (G_OUTPUT_STREAM (ostream)), NULL);
 
+  if (ostream->priv->chunks != NULL)
+    {
+      data = chunks_join (ostream->priv);
+      g_ptr_array_set_size (ostream->priv->chunks, 0);
+      ostream->priv->len = 0;
+      return data;
+    }
+
   data = ostream->priv->data;
   ostream->priv->data = NULL;
 
@@ -531,6 +684,10 @@ g_memory_output_stream_steal_as_bytes (GMemoryOutputStream *ostream)
   g_return_val_if_fail (G_IS_MEMORY_OUTPUT_STREAM (ostream), NULL);
   g_return_val_if_fail (g_output_stream_is_closed (G_OUTPUT_STREAM (ostream)), NULL);
 
+  if (ostream->priv->chunks != NULL)
+    return g_bytes_new_take (g_memory_output_stream_steal_data (ostream),
+                             ostream->priv->valid_len);
+
   result = g_bytes_new_with_free_func (ostream->priv->data,
                                        ostream->priv->valid_len,
                                        ostream->priv->destroy,
@@ -540,6 +697,71 @@ g_memory_output_stream_steal_as_bytes (GMemoryOutputStream *ostream)
   return result;
 }
 
+/**
+ * g_memory_output_stream_steal_as_bytes_list:
+ * @ostream: a #GMemoryOutputStream
+ *
+ * Takes the data written to @ostream so far, as a list of #GBytes that
+ * refer to the stream's own storage rather than to a copy of it: one
+ * per block for streams created with
+ * g_memory_output_stream_new_chunked(), or a single one otherwise.
+ *
+ * Unlike g_memory_output_stream_steal_as_bytes(), a resizable @ostream
+ * does not have to be closed first. Afterwards it is empty and
+ * positioned at the start, so it can be used to build the next piece
+ * of output. A fixed-size stream must be closed, as its buffer cannot
+ * be replaced.
+ *
+ * Returns: (transfer full) (element-type GBytes): the stream's data,
+ *     or %NULL if nothing was written
+ *
+ * Since: 2.54
+ **/
+GList *
+g_memory_output_stream_steal_as_bytes_list (GMemoryOutputStream *ostream)
+{
+  GMemoryOutputStreamPrivate *priv;
+  GList *list = NULL;
+  gsize offset, n;
+  guint i;
+
+  g_return_val_if_fail (G_IS_MEMORY_OUTPUT_STREAM (ostream), NULL);
+  g_return_val_if_fail (ostream->priv->realloc_fn != NULL ||
+                        g_output_stream_is_closed (G_OUTPUT_STREAM (ostream)), NULL);
+
+  priv = ostream->priv;
+
+  if (priv->chunks != NULL)
+    {
+      for (i = 0, offset = 0; offset < priv->valid_len; i++, offset += n)
+        {
+          n = MIN (priv->chunk_size, priv->valid_len - offset);
+          list = g_list_prepend (list, g_bytes_new_take (priv->chunks->pdata[i], n));
+          priv->chunks->pdata[i] = NULL;
+        }
+      list = g_list_reverse (list);
+
+      /* also drops blocks that were only reserved */
+      g_ptr_array_set_size (priv->chunks, 0);
+      priv->len = 0;
+    }
+  else if (priv->data != NULL && priv->valid_len > 0)
+    {
+      list = g_list_prepend (NULL,
+                             g_bytes_new_with_free_func (priv->data,
+                                                         priv->valid_len,
+                                                         priv->destroy,
+                                                         priv->data));
+      priv->data = NULL;
+      priv->len = 0;
+    }
+
+  priv->pos = 0;
+  priv->valid_len = 0;
+
+  return list;
+}
+
 static gboolean
 array_resize (GMemoryOutputStream  *ostream,
               gsize                 size,
@@ -596,6 +818,41 @@ array_resize (GMemoryOutputStream  *ostream,
   return TRUE;
 }
 
+/**
+ * g_memory_output_stream_reserve:
+ * @ostream: a #GMemoryOutputStream
+ * @size: the number of bytes the stream should be able to hold
+ * @error: a #GError location to store the error occurring, or %NULL to
+ *     ignore
+ *
+ * Grows the storage of a resizable @ostream to at least @size bytes in
+ * one step, so that writing up to @size bytes does not reallocate.
+ * This is useful when the final size of the output is known up front.
+ * It never shrinks the storage, and does not change the data size or
+ * position of the stream.
+ *
+ * Returns: %TRUE on success, %FALSE if @ostream is fixed-size and
+ *     smaller than @size or the memory could not be allocated
+ *
+ * Since: 2.54
+ **/
+gboolean
+g_memory_output_stream_reserve (GMemoryOutputStream  *ostream,
+                                gsize                 size,
+                                GError              **error)
+{
+  g_return_val_if_fail (G_IS_MEMORY_OUTPUT_STREAM (ostream), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  if (size <= ostream->priv->len)
+    return TRUE;
+
+  if (ostream->priv->chunks != NULL)
+    return chunks_ensure (ostream, size, error);
+
+  return array_resize (ostream, size, FALSE, error);
+}
+
 static gsize
 g_nearest_pow (gsize num)
 {
@@ -625,6 +882,33 @@ g_memory_output_stream_write (GOutputStream  *stream,
   if (count == 0)
     return 0;
 
+  if (priv->chunks != NULL)
+    {
+      gsize offset, n;
+
+      if (priv->pos + count < priv->pos)
+        goto overflow;
+
+      if (!chunks_ensure (ostream, priv->pos + count, error))
+        return -1;
+
+      for (offset = 0; offset < count; offset += n)
+        {
+          gsize chunk = (priv->pos + offset) / priv->chunk_size;
+          gsize chunk_offset = (priv->pos + offset) % priv->chunk_size;
+
+          n = MIN (count - offset, priv->chunk_size - chunk_offset);
+          memcpy ((guint8 *) priv->chunks->pdata[chunk] + chunk_offset,
+                  (const guint8 *) buffer + offset, n);
+        }
+
+      priv->pos += count;
+      if (priv->pos > priv->valid_len)
+        priv->valid_len = priv->pos;
+
+      return count;
+    }
+
   /* Check for address space overflow, but only if the buffer is resizable.
      Otherwise we just do a short write and don't worry. */
   if (priv->realloc_fn && priv->pos + count < priv->pos)
@@ -823,6 +1107,28 @@ g_memory_output_stream_truncate (GSeekable     *seekable,
                                  GError       **error)
 {
   GMemoryOutputStream *ostream = G_MEMORY_OUTPUT_STREAM (seekable);
+  GMemoryOutputStreamPrivate *priv = ostream->priv;
+
+  if (priv->chunks != NULL)
+    {
+      gsize n_chunks = (offset + priv->chunk_size - 1) / priv->chunk_size;
+
+      if ((gsize) offset < priv->len)
+        {
+          /* Keep the bytes past the end zeroed, as for a single buffer */
+          g_ptr_array_set_size (priv->chunks, n_chunks);
+          priv->len = n_chunks * priv->chunk_size;
+          if (offset % priv->chunk_size != 0)
+            memset ((guint8 *) priv->chunks->pdata[n_chunks - 1] + offset % priv->chunk_size,
+                    0, priv->chunk_size - offset % priv->chunk_size);
+        }
+      else if (!chunks_ensure (ostream, offset, error))
+        return FALSE;
+
+      priv->valid_len = offset;
+
+      return TRUE;
+    }
 
   if (!array_resize (ostream, offset, FALSE, error))
     return FALSE;
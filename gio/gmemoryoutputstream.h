@@ -90,6 +90,8 @@ GOutputStream *g_memory_output_stream_new           (gpointer             data,
                                                      GDestroyNotify       destroy_function);
 GLIB_AVAILABLE_IN_2_36
 GOutputStream *g_memory_output_stream_new_resizable (void);
+GLIB_AVAILABLE_IN_2_54
+GOutputStream *g_memory_output_stream_new_chunked   (gsize                chunk_size);
 GLIB_AVAILABLE_IN_ALL
 gpointer       g_memory_output_stream_get_data      (GMemoryOutputStream *ostream);
 GLIB_AVAILABLE_IN_ALL
@@ -102,6 +104,13 @@ gpointer       g_memory_output_stream_steal_data    (GMemoryOutputStream *ostrea
 GLIB_AVAILABLE_IN_2_34
 GBytes *       g_memory_output_stream_steal_as_bytes (GMemoryOutputStream *ostream);
 
+GLIB_AVAILABLE_IN_2_54
+GList *        g_memory_output_stream_steal_as_bytes_list (GMemoryOutputStream *ostream);
+GLIB_AVAILABLE_IN_2_54
+gboolean       g_memory_output_stream_reserve        (GMemoryOutputStream  *ostream,
+                                                      gsize                 size,
+                                                      GError              **error);
+
 G_END_DECLS
 
 #endif /* __G_MEMORY_OUTPUT_STREAM_H__ */
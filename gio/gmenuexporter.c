@@ -25,6 +25,7 @@
 #include "gdbusintrospection.h"
 #include "gdbusnamewatching.h"
 #include "gdbuserror.h"
+#include "gdbusprivate.h"
 
 /**
  * SECTION:gmenuexporter
@@ -85,6 +86,8 @@ org_gtk_Menus_get_interface (void)
 /* {{{1 Forward declarations */
 typedef struct _GMenuExporterMenu                           GMenuExporterMenu;
 typedef struct _GMenuExporterLink                           GMenuExporterLink;
+typedef struct _GMenuExporterItem                           GMenuExporterItem;
+typedef struct _GMenuExporterChange                         GMenuExporterChange;
 typedef struct _GMenuExporterGroup                          GMenuExporterGroup;
 typedef struct _GMenuExporterRemote                         GMenuExporterRemote;
 typedef struct _GMenuExporterWatch                          GMenuExporterWatch;
@@ -101,12 +104,16 @@ static void                     g_menu_exporter_group_remove_menu      (GMenuExp
 static GMenuExporterGroup *     g_menu_exporter_create_group           (GMenuExporter      *exporter);
 static GMenuExporterGroup *     g_menu_exporter_lookup_group           (GMenuExporter      *exporter,
                                                                         guint               group_id);
-static void                     g_menu_exporter_report                 (GMenuExporter      *exporter,
-                                                                        GVariant           *report);
+static void                     g_menu_exporter_queue_change           (GMenuExporter      *exporter,
+                                                                        guint               group_id,
+                                                                        guint               menu_id,
+                                                                        guint               position,
+                                                                        guint               removed,
+                                                                        GPtrArray          *added);
 static void                     g_menu_exporter_remove_group           (GMenuExporter      *exporter,
                                                                         guint               id);
 
-/* {{{1 GMenuExporterLink, GMenuExporterMenu */
+/* {{{1 GMenuExporterLink, GMenuExporterItem, GMenuExporterMenu */
 
 struct _GMenuExporterMenu
 {
@@ -115,7 +122,7 @@ struct _GMenuExporterMenu
 
   GMenuModel *model;
   gulong      handler_id;
-  GSequence  *item_links;
+  GSequence  *items;
 };
 
 struct _GMenuExporterLink
@@ -125,6 +132,16 @@ struct _GMenuExporterLink
   GMenuExporterLink *next;
 };
 
+/* The items of a #GMenuModel don't change without an items-changed
+ * signal replacing them, so their descriptions can be kept around for
+ * every subscriber and change report that needs them.
+ */
+struct _GMenuExporterItem
+{
+  GMenuExporterLink *links;
+  GVariant          *description;  /* a{sv}, built on first use */
+};
+
 static void
 g_menu_exporter_menu_free (GMenuExporterMenu *menu)
 {
@@ -133,8 +150,8 @@ g_menu_exporter_menu_free (GMenuExporterMenu *menu)
   if (menu->handler_id != 0)
     g_signal_handler_disconnect (menu->model, menu->handler_id);
 
-  if (menu->item_links != NULL)
-    g_sequence_free (menu->item_links);
+  if (menu->items != NULL)
+    g_sequence_free (menu->items);
 
   g_object_unref (menu->model);
 
@@ -158,6 +175,19 @@ g_menu_exporter_link_free (gpointer data)
     }
 }
 
+static void
+g_menu_exporter_item_free (gpointer data)
+{
+  GMenuExporterItem *item = data;
+
+  g_menu_exporter_link_free (item->links);
+
+  if (item->description)
+    g_variant_unref (item->description);
+
+  g_slice_free (GMenuExporterItem, item);
+}
+
 static GMenuExporterLink *
 g_menu_exporter_menu_create_links (GMenuExporterMenu *menu,
                                    gint               position)
@@ -196,17 +226,24 @@ g_menu_exporter_menu_create_links (GMenuExporterMenu *menu,
   return list;
 }
 
+/* Returns the (cached) description of the item at @position in @iter */
 static GVariant *
 g_menu_exporter_menu_describe_item (GMenuExporterMenu *menu,
+                                    GSequenceIter     *iter,
                                     gint               position)
 {
   GMenuAttributeIter *attr_iter;
   GVariantBuilder builder;
-  GSequenceIter *iter;
+  GMenuExporterItem *item;
   GMenuExporterLink *link;
   const char *name;
   GVariant *value;
 
+  item = g_sequence_get (iter);
+
+  if (item->description != NULL)
+    return item->description;
+
   g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
 
   attr_iter = g_menu_model_iterate_item_attributes (menu->model, position);
@@ -217,25 +254,27 @@ g_menu_exporter_menu_describe_item (GMenuExporterMenu *menu,
     }
   g_object_unref (attr_iter);
 
-  iter = g_sequence_get_iter_at_pos (menu->item_links, position);
-  for (link = g_sequence_get (iter); link; link = link->next)
+  for (link = item->links; link; link = link->next)
     g_variant_builder_add (&builder, "{sv}", link->name,
                            g_variant_new ("(uu)", g_menu_exporter_group_get_id (link->menu->group), link->menu->id));
 
-  return g_variant_builder_end (&builder);
+  item->description = g_variant_ref_sink (g_variant_builder_end (&builder));
+
+  return item->description;
 }
 
 static GVariant *
 g_menu_exporter_menu_list (GMenuExporterMenu *menu)
 {
   GVariantBuilder builder;
-  gint i, n;
+  GSequenceIter *iter;
+  gint i;
 
   g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
 
-  n = g_sequence_get_length (menu->item_links);
-  for (i = 0; i < n; i++)
-    g_variant_builder_add_value (&builder, g_menu_exporter_menu_describe_item (menu, i));
+  iter = g_sequence_get_begin_iter (menu->items);
+  for (i = 0; !g_sequence_iter_is_end (iter); i++, iter = g_sequence_iter_next (iter))
+    g_variant_builder_add_value (&builder, g_menu_exporter_menu_describe_item (menu, iter, i));
 
   return g_variant_builder_end (&builder);
 }
@@ -249,34 +288,39 @@ g_menu_exporter_menu_items_changed (GMenuModel *model,
 {
   GMenuExporterMenu *menu = user_data;
   GSequenceIter *point;
+  GSequenceIter *iter;
   gint i;
 
   g_assert (menu->model == model);
-  g_assert (menu->item_links != NULL);
-  g_assert (position + removed <= g_sequence_get_length (menu->item_links));
+  g_assert (menu->items != NULL);
+  g_assert (position + removed <= g_sequence_get_length (menu->items));
 
-  point = g_sequence_get_iter_at_pos (menu->item_links, position + removed);
-  g_sequence_remove_range (g_sequence_get_iter_at_pos (menu->item_links, position), point);
+  point = g_sequence_get_iter_at_pos (menu->items, position + removed);
+  g_sequence_remove_range (g_sequence_get_iter_at_pos (menu->items, position), point);
 
   for (i = position; i < position + added; i++)
-    g_sequence_insert_before (point, g_menu_exporter_menu_create_links (menu, i));
+    {
+      GMenuExporterItem *item;
+
+      item = g_slice_new (GMenuExporterItem);
+      item->links = g_menu_exporter_menu_create_links (menu, i);
+      item->description = NULL;
+      g_sequence_insert_before (point, item);
+    }
 
   if (g_menu_exporter_group_is_subscribed (menu->group))
     {
-      GVariantBuilder builder;
+      GPtrArray *descriptions;
 
-      g_variant_builder_init (&builder, G_VARIANT_TYPE ("(uuuuaa{sv})"));
-      g_variant_builder_add (&builder, "u", g_menu_exporter_group_get_id (menu->group));
-      g_variant_builder_add (&builder, "u", menu->id);
-      g_variant_builder_add (&builder, "u", position);
-      g_variant_builder_add (&builder, "u", removed);
+      descriptions = g_ptr_array_new_full (added, (GDestroyNotify) g_variant_unref);
 
-      g_variant_builder_open (&builder, G_VARIANT_TYPE ("aa{sv}"));
-      for (i = position; i < position + added; i++)
-        g_variant_builder_add_value (&builder, g_menu_exporter_menu_describe_item (menu, i));
-      g_variant_builder_close (&builder);
+      iter = g_sequence_get_iter_at_pos (menu->items, position);
+      for (i = position; i < position + added; i++, iter = g_sequence_iter_next (iter))
+        g_ptr_array_add (descriptions, g_variant_ref (g_menu_exporter_menu_describe_item (menu, iter, i)));
 
-      g_menu_exporter_report (g_menu_exporter_group_get_exporter (menu->group), g_variant_builder_end (&builder));
+      g_menu_exporter_queue_change (g_menu_exporter_group_get_exporter (menu->group),
+                                    g_menu_exporter_group_get_id (menu->group), menu->id,
+                                    position, removed, descriptions);
     }
 }
 
@@ -285,13 +329,13 @@ g_menu_exporter_menu_prepare (GMenuExporterMenu *menu)
 {
   gint n_items;
 
-  g_assert (menu->item_links == NULL);
+  g_assert (menu->items == NULL);
 
   if (g_menu_model_is_mutable (menu->model))
     menu->handler_id = g_signal_connect (menu->model, "items-changed",
                                          G_CALLBACK (g_menu_exporter_menu_items_changed), menu);
 
-  menu->item_links = g_sequence_new (g_menu_exporter_link_free);
+  menu->items = g_sequence_new (g_menu_exporter_item_free);
 
   n_items = g_menu_model_get_n_items (menu->model);
   if (n_items)
@@ -377,7 +421,7 @@ g_menu_exporter_group_subscribe (GMenuExporterGroup *group,
       guint id = GPOINTER_TO_INT (key);
       GMenuExporterMenu *menu = val;
 
-      if (!g_sequence_is_empty (menu->item_links))
+      if (!g_sequence_is_empty (menu->items))
         {
           g_variant_builder_open (builder, G_VARIANT_TYPE ("(uuaa{sv})"));
           g_variant_builder_add (builder, "u", group->id);
@@ -557,8 +601,32 @@ struct _GMenuExporter
 
   GMenuExporterMenu *root;
   GHashTable *remotes;
+
+  GMainContext *context;
+  GQueue pending_changes;  /* of GMenuExporterChange, oldest first */
+  GSource *pending_source;
+};
+
+/* One entry of a Changed signal, waiting to be sent */
+struct _GMenuExporterChange
+{
+  guint      group_id;
+  guint      menu_id;
+  guint      position;
+  guint      removed;
+  GPtrArray *added;  /* of a{sv} item descriptions */
 };
 
+static void
+g_menu_exporter_change_free (gpointer data)
+{
+  GMenuExporterChange *change = data;
+
+  g_ptr_array_unref (change->added);
+
+  g_slice_free (GMenuExporterChange, change);
+}
+
 static void
 g_menu_exporter_name_vanished (GDBusConnection *connection,
                                const gchar     *name,
@@ -629,15 +697,38 @@ g_menu_exporter_unsubscribe (GMenuExporter *exporter,
     g_hash_table_remove (exporter->remotes, sender);
 }
 
-static void
-g_menu_exporter_report (GMenuExporter *exporter,
-                        GVariant      *report)
+static gboolean
+g_menu_exporter_dispatch_changes (gpointer user_data)
 {
+  GMenuExporter *exporter = user_data;
+  GMenuExporterChange *change;
   GVariantBuilder builder;
+  guint i;
+
+  exporter->pending_source = NULL;
+
+  if (g_queue_is_empty (&exporter->pending_changes))
+    return G_SOURCE_REMOVE;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("(a(uuuuaa{sv}))"));
+  g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(uuuuaa{sv})"));
+
+  while ((change = g_queue_pop_head (&exporter->pending_changes)))
+    {
+      g_variant_builder_open (&builder, G_VARIANT_TYPE ("(uuuuaa{sv})"));
+      g_variant_builder_add (&builder, "u", change->group_id);
+      g_variant_builder_add (&builder, "u", change->menu_id);
+      g_variant_builder_add (&builder, "u", change->position);
+      g_variant_builder_add (&builder, "u", change->removed);
+      g_variant_builder_open (&builder, G_VARIANT_TYPE ("aa{sv}"));
+      for (i = 0; i < change->added->len; i++)
+        g_variant_builder_add_value (&builder, change->added->pdata[i]);
+      g_variant_builder_close (&builder);
+      g_variant_builder_close (&builder);
+
+      g_menu_exporter_change_free (change);
+    }
 
-  g_variant_builder_init (&builder, G_VARIANT_TYPE_TUPLE);
-  g_variant_builder_open (&builder, G_VARIANT_TYPE_ARRAY);
-  g_variant_builder_add_value (&builder, report);
   g_variant_builder_close (&builder);
 
   g_dbus_connection_emit_signal (exporter->connection,
@@ -646,6 +737,82 @@ g_menu_exporter_report (GMenuExporter *exporter,
                                  "org.gtk.Menus", "Changed",
                                  g_variant_builder_end (&builder),
                                  NULL);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+g_menu_exporter_flush_changes (GMenuExporter *exporter)
+{
+  if (exporter->pending_source)
+    {
+      g_source_destroy (exporter->pending_source);
+      g_menu_exporter_dispatch_changes (exporter);
+      g_assert (exporter->pending_source == NULL);
+    }
+}
+
+/* Queues a change to be sent with the next Changed signal.  If it only
+ * touches items that the previous change added to the same menu, the
+ * two are merged, so that a burst of updates to one place in a menu
+ * goes out as a single change.  Takes ownership of @added.
+ */
+static void
+g_menu_exporter_queue_change (GMenuExporter *exporter,
+                              guint          group_id,
+                              guint          menu_id,
+                              guint          position,
+                              guint          removed,
+                              GPtrArray     *added)
+{
+  GMenuExporterChange *last;
+
+  last = g_queue_peek_tail (&exporter->pending_changes);
+
+  if (last != NULL &&
+      last->group_id == group_id && last->menu_id == menu_id &&
+      last->position <= position &&
+      position + removed <= last->position + last->added->len)
+    {
+      guint offset = position - last->position;
+      guint i;
+
+      if (removed > 0)
+        g_ptr_array_remove_range (last->added, offset, removed);
+
+      for (i = 0; i < added->len; i++)
+        g_ptr_array_insert (last->added, offset + i, g_variant_ref (added->pdata[i]));
+
+      g_ptr_array_unref (added);
+
+      /* e.g. an item that was added and removed again */
+      if (last->removed == 0 && last->added->len == 0)
+        g_menu_exporter_change_free (g_queue_pop_tail (&exporter->pending_changes));
+    }
+  else
+    {
+      GMenuExporterChange *change;
+
+      change = g_slice_new (GMenuExporterChange);
+      change->group_id = group_id;
+      change->menu_id = menu_id;
+      change->position = position;
+      change->removed = removed;
+      change->added = added;
+      g_queue_push_tail (&exporter->pending_changes, change);
+    }
+
+  if (exporter->pending_source == NULL)
+    {
+      GSource *source;
+
+      source = _g_dbus_export_source_new ();
+      exporter->pending_source = source;
+      g_source_set_callback (source, g_menu_exporter_dispatch_changes, exporter, NULL);
+      g_source_set_name (source, "[gio] g_menu_exporter_dispatch_changes");
+      g_source_attach (source, exporter->context);
+      g_source_unref (source);
+    }
 }
 
 static void
@@ -690,10 +857,16 @@ g_menu_exporter_free (gpointer user_data)
 {
   GMenuExporter *exporter = user_data;
 
+  if (exporter->pending_source)
+    g_source_destroy (exporter->pending_source);
+  g_queue_foreach (&exporter->pending_changes, (GFunc) g_menu_exporter_change_free, NULL);
+  g_queue_clear (&exporter->pending_changes);
+
   g_menu_exporter_menu_free (exporter->root);
   g_hash_table_unref (exporter->remotes);
   g_hash_table_unref (exporter->groups);
   g_object_unref (exporter->connection);
+  g_main_context_unref (exporter->context);
   g_free (exporter->object_path);
 
   g_slice_free (GMenuExporter, exporter);
@@ -712,6 +885,11 @@ g_menu_exporter_method_call (GDBusConnection       *connection,
   GMenuExporter *exporter = user_data;
   GVariant *group_ids;
 
+  /* Send out anything that happened before the call, so that a new
+   * subscriber doesn't get changes that are already in its reply.
+   */
+  g_menu_exporter_flush_changes (exporter);
+
   group_ids = g_variant_get_child_value (parameters, 0);
 
   if (g_str_equal (method_name, "Start"))
@@ -779,6 +957,7 @@ g_dbus_connection_export_menu_model (GDBusConnection  *connection,
     }
 
   exporter->connection = g_object_ref (connection);
+  exporter->context = g_main_context_ref_thread_default ();
   exporter->object_path = g_strdup (object_path);
   exporter->groups = g_hash_table_new (NULL, NULL);
   exporter->remotes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_menu_exporter_remote_free);
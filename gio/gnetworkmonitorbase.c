@@ -18,6 +18,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "gnetworkmonitorbase.h"
 #include "ginetaddress.h"
 #include "ginetaddressmask.h"
@@ -43,9 +45,25 @@ enum
   PROP_CONNECTIVITY
 };
 
+/* Networks are kept in a path-compressed binary trie per address
+ * family, so that reachability checks cost O(address length) rather
+ * than O(number of routes). Each node covers the first @length bits of
+ * @prefix; nodes without a @network are just branch points.
+ */
+typedef struct _NetworkNode NetworkNode;
+struct _NetworkNode
+{
+  guint8            prefix[16];
+  guint             length;
+  GInetAddressMask *network;
+  NetworkNode      *child[2];
+};
+
 struct _GNetworkMonitorBasePrivate
 {
-  GPtrArray    *networks;
+  NetworkNode  *ipv4_networks;
+  NetworkNode  *ipv6_networks;
+  guint         n_networks;
   gboolean      have_ipv4_default_route;
   gboolean      have_ipv6_default_route;
   gboolean      is_available;
@@ -75,7 +93,6 @@ static void
 g_network_monitor_base_init (GNetworkMonitorBase *monitor)
 {
   monitor->priv = g_network_monitor_base_get_instance_private (monitor);
-  monitor->priv->networks = g_ptr_array_new_with_free_func (g_object_unref);
   monitor->priv->context = g_main_context_get_thread_default ();
   if (monitor->priv->context)
     g_main_context_ref (monitor->priv->context);
@@ -139,12 +156,199 @@ g_network_monitor_base_get_property (GObject    *object,
 
 }
 
+static inline guint
+get_bit (const guint8 *bytes,
+         guint         bit)
+{
+  return (bytes[bit / 8] >> (7 - bit % 8)) & 1;
+}
+
+/* Returns the number of leading bits (at most @max) that @a and @b
+ * have in common.
+ */
+static guint
+common_prefix_length (const guint8 *a,
+                      const guint8 *b,
+                      guint         max)
+{
+  guint i = 0;
+
+  while (i + 8 <= max && a[i / 8] == b[i / 8])
+    i += 8;
+  while (i < max && get_bit (a, i) == get_bit (b, i))
+    i++;
+
+  return i;
+}
+
+static NetworkNode *
+network_node_new (const guint8     *bytes,
+                  guint             length,
+                  GInetAddressMask *network)
+{
+  NetworkNode *node;
+
+  node = g_slice_new0 (NetworkNode);
+  memcpy (node->prefix, bytes, (length + 7) / 8);
+  node->length = length;
+  if (network)
+    node->network = g_object_ref (network);
+
+  return node;
+}
+
+static void
+network_node_free (NetworkNode *node)
+{
+  if (!node)
+    return;
+
+  network_node_free (node->child[0]);
+  network_node_free (node->child[1]);
+  g_clear_object (&node->network);
+  g_slice_free (NetworkNode, node);
+}
+
+/* Returns FALSE if an equal network was already present */
+static gboolean
+network_node_insert (NetworkNode      **slot,
+                     const guint8      *bytes,
+                     guint              length,
+                     GInetAddressMask  *network)
+{
+  NetworkNode *node, *branch;
+  guint common;
+
+  while ((node = *slot) != NULL)
+    {
+      common = common_prefix_length (node->prefix, bytes, MIN (node->length, length));
+
+      if (common == node->length)
+        {
+          if (length == node->length)
+            {
+              if (node->network)
+                return FALSE;
+              node->network = g_object_ref (network);
+              return TRUE;
+            }
+
+          slot = &node->child[get_bit (bytes, node->length)];
+          continue;
+        }
+
+      /* @network diverges from (or is a prefix of) @node, so a new
+       * node has to be spliced in above it.
+       */
+      if (common == length)
+        {
+          branch = network_node_new (bytes, length, network);
+          branch->child[get_bit (node->prefix, length)] = node;
+        }
+      else
+        {
+          branch = network_node_new (bytes, common, NULL);
+          branch->child[get_bit (node->prefix, common)] = node;
+          branch->child[get_bit (bytes, common)] = network_node_new (bytes, length, network);
+        }
+      *slot = branch;
+      return TRUE;
+    }
+
+  *slot = network_node_new (bytes, length, network);
+  return TRUE;
+}
+
+/* Removes *@slot if it no longer carries a network and doesn't have
+ * two children to separate.
+ */
+static void
+network_node_collapse (NetworkNode **slot)
+{
+  NetworkNode *node = *slot;
+
+  if (node->network || (node->child[0] && node->child[1]))
+    return;
+
+  *slot = node->child[0] ? node->child[0] : node->child[1];
+  g_slice_free (NetworkNode, node);
+}
+
+/* Returns FALSE if there was no such network */
+static gboolean
+network_node_remove (NetworkNode  **slot,
+                     const guint8  *bytes,
+                     guint          length)
+{
+  NetworkNode **parent_slot = NULL;
+  NetworkNode *node;
+
+  while ((node = *slot) != NULL)
+    {
+      if (node->length > length ||
+          common_prefix_length (node->prefix, bytes, node->length) < node->length)
+        return FALSE;
+      if (node->length == length)
+        break;
+
+      parent_slot = slot;
+      slot = &node->child[get_bit (bytes, node->length)];
+    }
+
+  if (!node || !node->network)
+    return FALSE;
+
+  g_clear_object (&node->network);
+  network_node_collapse (slot);
+  if (parent_slot)
+    network_node_collapse (parent_slot);
+
+  return TRUE;
+}
+
+/* Returns TRUE if some network contains the @length-bit address @bytes */
+static gboolean
+network_node_matches (NetworkNode  *node,
+                      const guint8 *bytes,
+                      guint         length)
+{
+  while (node)
+    {
+      if (common_prefix_length (node->prefix, bytes, node->length) < node->length)
+        return FALSE;
+      if (node->network)
+        return TRUE;
+      if (node->length == length)
+        return FALSE;
+
+      node = node->child[get_bit (bytes, node->length)];
+    }
+
+  return FALSE;
+}
+
+static NetworkNode **
+get_network_root (GNetworkMonitorBase *monitor,
+                  GSocketFamily        family)
+{
+  switch (family)
+    {
+    case G_SOCKET_FAMILY_IPV4:
+      return &monitor->priv->ipv4_networks;
+    case G_SOCKET_FAMILY_IPV6:
+      return &monitor->priv->ipv6_networks;
+    default:
+      return NULL;
+    }
+}
+
 static void
 g_network_monitor_base_finalize (GObject *object)
 {
   GNetworkMonitorBase *monitor = G_NETWORK_MONITOR_BASE (object);
 
-  g_ptr_array_free (monitor->priv->networks, TRUE);
+  network_node_free (monitor->priv->ipv4_networks);
+  network_node_free (monitor->priv->ipv6_networks);
   if (monitor->priv->network_changed_source)
     {
       g_source_destroy (monitor->priv->network_changed_source);
@@ -175,19 +379,18 @@ g_network_monitor_base_can_reach_sockaddr (GNetworkMonitorBase *base,
                                            GSocketAddress *sockaddr)
 {
   GInetAddress *iaddr;
-  int i;
+  NetworkNode **root;
 
   if (!G_IS_INET_SOCKET_ADDRESS (sockaddr))
     return FALSE;
 
   iaddr = g_inet_socket_address_get_address (G_INET_SOCKET_ADDRESS (sockaddr));
-  for (i = 0; i < base->priv->networks->len; i++)
-    {
-      if (g_inet_address_mask_matches (base->priv->networks->pdata[i], iaddr))
-        return TRUE;
-    }
+  root = get_network_root (base, g_inet_address_get_family (iaddr));
+  if (!root)
+    return FALSE;
 
-  return FALSE;
+  return network_node_matches (*root, g_inet_address_to_bytes (iaddr),
+                               g_inet_address_get_native_size (iaddr) * 8);
 }
 
 static gboolean
@@ -200,7 +403,7 @@ g_network_monitor_base_can_reach (GNetworkMonitor      *monitor,
   GSocketAddressEnumerator *enumerator;
   GSocketAddress *addr;
 
-  if (base->priv->networks->len == 0)
+  if (base->priv->n_networks == 0)
     {
       g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NETWORK_UNREACHABLE,
                            _("Network unreachable"));
@@ -304,7 +507,7 @@ g_network_monitor_base_can_reach_async (GNetworkMonitor     *monitor,
   task = g_task_new (monitor, cancellable, callback, user_data);
   g_task_set_source_tag (task, g_network_monitor_base_can_reach_async);
 
-  if (G_NETWORK_MONITOR_BASE (monitor)->priv->networks->len == 0)
+  if (G_NETWORK_MONITOR_BASE (monitor)->priv->n_networks == 0)
     {
       g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NETWORK_UNREACHABLE,
                                _("Network unreachable"));
@@ -426,15 +629,18 @@ void
 g_network_monitor_base_add_network (GNetworkMonitorBase *monitor,
                                     GInetAddressMask    *network)
 {
-  int i;
+  NetworkNode **root;
 
-  for (i = 0; i < monitor->priv->networks->len; i++)
-    {
-      if (g_inet_address_mask_equal (monitor->priv->networks->pdata[i], network))
-        return;
-    }
+  root = get_network_root (monitor, g_inet_address_mask_get_family (network));
+  g_return_if_fail (root != NULL);
 
-  g_ptr_array_add (monitor->priv->networks, g_object_ref (network));
+  if (!network_node_insert (root,
+                            g_inet_address_to_bytes (g_inet_address_mask_get_address (network)),
+                            g_inet_address_mask_get_length (network),
+                            network))
+    return;
+
+  monitor->priv->n_networks++;
   if (g_inet_address_mask_get_length (network) == 0)
     {
       switch (g_inet_address_mask_get_family (network))
@@ -473,33 +679,33 @@ void
 g_network_monitor_base_remove_network (GNetworkMonitorBase *monitor,
                                        GInetAddressMask    *network)
 {
-  int i;
+  NetworkNode **root;
 
-  for (i = 0; i < monitor->priv->networks->len; i++)
-    {
-      if (g_inet_address_mask_equal (monitor->priv->networks->pdata[i], network))
-        {
-          g_ptr_array_remove_index_fast (monitor->priv->networks, i);
+  root = get_network_root (monitor, g_inet_address_mask_get_family (network));
+  g_return_if_fail (root != NULL);
 
-          if (g_inet_address_mask_get_length (network) == 0)
-            {
-              switch (g_inet_address_mask_get_family (network))
-                {
-                case G_SOCKET_FAMILY_IPV4:
-                  monitor->priv->have_ipv4_default_route = FALSE;
-                  break;
-                case G_SOCKET_FAMILY_IPV6:
-                  monitor->priv->have_ipv6_default_route = FALSE;
-                  break;
-                default:
-                  break;
-                }
-            }
+  if (!network_node_remove (root,
+                            g_inet_address_to_bytes (g_inet_address_mask_get_address (network)),
+                            g_inet_address_mask_get_length (network)))
+    return;
 
-          queue_network_changed (monitor);
-          return;
+  monitor->priv->n_networks--;
+  if (g_inet_address_mask_get_length (network) == 0)
+    {
+      switch (g_inet_address_mask_get_family (network))
+        {
+        case G_SOCKET_FAMILY_IPV4:
+          monitor->priv->have_ipv4_default_route = FALSE;
+          break;
+        case G_SOCKET_FAMILY_IPV6:
+          monitor->priv->have_ipv6_default_route = FALSE;
+          break;
+        default:
+          break;
         }
     }
+
+  queue_network_changed (monitor);
 }
 
 /**
@@ -518,7 +724,11 @@ g_network_monitor_base_set_networks (GNetworkMonitorBase  *monitor,
 {
   int i;
 
-  g_ptr_array_set_size (monitor->priv->networks, 0);
+  network_node_free (monitor->priv->ipv4_networks);
+  network_node_free (monitor->priv->ipv6_networks);
+  monitor->priv->ipv4_networks = NULL;
+  monitor->priv->ipv6_networks = NULL;
+  monitor->priv->n_networks = 0;
   monitor->priv->have_ipv4_default_route = FALSE;
   monitor->priv->have_ipv6_default_route = FALSE;
 
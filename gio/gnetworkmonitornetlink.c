@@ -50,6 +50,7 @@ struct _GNetworkMonitorNetlinkPrivate
   GPtrArray *dump_networks;
 };
 
+static gboolean read_netlink_message  (GNetworkMonitorNetlink  *nl);
 static gboolean read_netlink_messages (GSocket             *socket,
                                        GIOCondition         condition,
                                        gpointer             user_data);
@@ -100,7 +101,8 @@ g_network_monitor_netlink_initable_init (GInitable     *initable,
 
   snl.nl_family = AF_NETLINK;
   snl.nl_pid = snl.nl_pad = 0;
-  snl.nl_groups = RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE;
+  snl.nl_groups = RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE | RTMGRP_LINK |
+                  RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
   if (bind (sockfd, (struct sockaddr *)&snl, sizeof (snl)) != 0)
     {
       int errsv = errno;
@@ -138,7 +140,7 @@ g_network_monitor_netlink_initable_init (GInitable     *initable,
    */
   while (nl->priv->dump_networks)
     {
-      if (!read_netlink_messages (NULL, G_IO_IN, nl))
+      if (!read_netlink_message (nl))
         break;
     }
 
@@ -286,11 +288,8 @@ finish_dump (GNetworkMonitorNetlink *nl)
 }
 
 static gboolean
-read_netlink_messages (GSocket      *socket,
-                       GIOCondition  condition,
-                       gpointer      user_data)
+read_netlink_message (GNetworkMonitorNetlink *nl)
 {
-  GNetworkMonitorNetlink *nl = user_data;
   GInputVector iv;
   gssize len;
   gint flags;
@@ -401,10 +400,31 @@ read_netlink_messages (GSocket      *socket,
                 add_network (nl, rtmsg->rtm_family, rtmsg->rtm_dst_len, dest);
               else
                 remove_network (nl, rtmsg->rtm_family, rtmsg->rtm_dst_len, dest);
-              queue_request_dump (nl);
             }
           break;
 
+        case RTM_NEWLINK:
+        case RTM_DELLINK:
+          {
+            struct ifinfomsg *ifi = NLMSG_DATA (msg);
+
+            /* Route changes are applied as they arrive, but the kernel
+             * flushes IPv4 routes without notification when their
+             * interface goes down, so resynchronise in that case.
+             */
+            if (msg->nlmsg_type == RTM_DELLINK || !(ifi->ifi_flags & IFF_UP))
+              queue_request_dump (nl);
+          }
+          break;
+
+        case RTM_NEWADDR:
+          break;
+
+        case RTM_DELADDR:
+          /* Likewise for routes through a removed address */
+          queue_request_dump (nl);
+          break;
+
         case NLMSG_DONE:
           finish_dump (nl);
           goto done;
@@ -434,6 +454,33 @@ read_netlink_messages (GSocket      *socket,
   return retval;
 }
 
+/* Upper bound on the datagrams handled per main loop dispatch, so that
+ * a flood of route changes can't starve other sources.
+ */
+#define MAX_MESSAGES_PER_DISPATCH 64
+
+static gboolean
+read_netlink_messages (GSocket      *socket,
+                       GIOCondition  condition,
+                       gpointer      user_data)
+{
+  GNetworkMonitorNetlink *nl = user_data;
+  guint i;
+
+  /* Drain everything already queued in one go; the resulting
+   * network-changed notifications are coalesced by the base class.
+   */
+  for (i = 0; i < MAX_MESSAGES_PER_DISPATCH; i++)
+    {
+      if (!read_netlink_message (nl))
+        return FALSE;
+      if (!(g_socket_condition_check (nl->priv->sock, G_IO_IN) & G_IO_IN))
+        break;
+    }
+
+  return TRUE;
+}
+
 static void
 g_network_monitor_netlink_finalize (GObject *object)
 {
@@ -72,6 +72,21 @@ static void     g_output_stream_real_write_async   (GOutputStream             *s
 static gssize   g_output_stream_real_write_finish  (GOutputStream             *stream,
 						    GAsyncResult              *result,
 						    GError                   **error);
+static gssize   g_output_stream_real_writev        (GOutputStream             *stream,
+                                                    const GOutputVector       *vectors,
+                                                    gsize                      n_vectors,
+                                                    GCancellable              *cancellable,
+                                                    GError                   **error);
+static void     g_output_stream_real_writev_async  (GOutputStream             *stream,
+                                                    const GOutputVector       *vectors,
+                                                    gsize                      n_vectors,
+                                                    int                        io_priority,
+                                                    GCancellable              *cancellable,
+                                                    GAsyncReadyCallback        callback,
+                                                    gpointer                   data);
+static gssize   g_output_stream_real_writev_finish (GOutputStream             *stream,
+                                                    GAsyncResult              *result,
+                                                    GError                   **error);
 static void     g_output_stream_real_splice_async  (GOutputStream             *stream,
 						    GInputStream              *source,
 						    GOutputStreamSpliceFlags   flags,
@@ -134,6 +149,9 @@ g_output_stream_class_init (GOutputStreamClass *klass)
   
   klass->write_async = g_output_stream_real_write_async;
   klass->write_finish = g_output_stream_real_write_finish;
+  klass->writev_fn = g_output_stream_real_writev;
+  klass->writev_async = g_output_stream_real_writev_async;
+  klass->writev_finish = g_output_stream_real_writev_finish;
   klass->splice_async = g_output_stream_real_splice_async;
   klass->splice_finish = g_output_stream_real_splice_finish;
   klass->flush_async = g_output_stream_real_flush_async;
@@ -299,6 +317,221 @@ g_output_stream_write_all (GOutputStream  *stream,
   return TRUE;
 }
 
+static gboolean
+output_vectors_get_size (const GOutputVector  *vectors,
+                         gsize                 n_vectors,
+                         gsize                *size,
+                         const gchar          *caller,
+                         GError              **error)
+{
+  gsize total = 0;
+  gsize i;
+
+  for (i = 0; i < n_vectors; i++)
+    {
+      if (vectors[i].size > (gsize) G_MAXSSIZE - total)
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                       _("Sum of vectors passed to %s too large"), caller);
+          return FALSE;
+        }
+
+      total += vectors[i].size;
+    }
+
+  *size = total;
+  return TRUE;
+}
+
+/* Drops the first @n_bytes from the array of vectors, updating the
+ * first remaining vector in place if it was only partially consumed.
+ */
+static void
+output_vectors_advance (GOutputVector **vectors,
+                        gsize          *n_vectors,
+                        gsize           n_bytes)
+{
+  while (*n_vectors > 0 && n_bytes >= (*vectors)[0].size)
+    {
+      n_bytes -= (*vectors)[0].size;
+      (*vectors)++;
+      (*n_vectors)--;
+    }
+
+  if (*n_vectors > 0 && n_bytes > 0)
+    {
+      (*vectors)[0].buffer = (const guint8 *) (*vectors)[0].buffer + n_bytes;
+      (*vectors)[0].size -= n_bytes;
+    }
+}
+
+/**
+ * g_output_stream_writev:
+ * @stream: a #GOutputStream.
+ * @vectors: (array length=n_vectors): the buffers containing the data to write.
+ * @n_vectors: the number of vectors to write
+ * @cancellable: (nullable): optional cancellable object
+ * @error: location to store the error occurring, or %NULL to ignore
+ *
+ * Tries to write the bytes contained in the @n_vectors @vectors into the
+ * stream. Will block during the operation.
+ *
+ * If @n_vectors is 0 or the sum of all bytes in @vectors is 0, returns 0
+ * and does nothing. A sum of bytes larger than %G_MAXSSIZE will cause a
+ * %G_IO_ERROR_INVALID_ARGUMENT error.
+ *
+ * On success, the number of bytes written to the stream is returned.
+ * As with g_output_stream_write(), it is not an error if this is less
+ * than the sum of the vector sizes; the data is consumed in order, so
+ * everything up to that offset has been written. Streams that can
+ * gather the vectors into a single system call (such as sockets and
+ * UNIX file descriptors) do so; other streams fall back to writing the
+ * vectors one after another.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by
+ * triggering the cancellable object from another thread. If the operation
+ * was cancelled, the error %G_IO_ERROR_CANCELLED will be returned. If an
+ * operation was partially finished when the operation was cancelled the
+ * partial result will be returned, without an error.
+ *
+ * On error -1 is returned and @error is set accordingly.
+ *
+ * Virtual: writev_fn
+ *
+ * Returns: Number of bytes written, or -1 on error
+ *
+ * Since: 2.54
+ */
+gssize
+g_output_stream_writev (GOutputStream        *stream,
+                        const GOutputVector  *vectors,
+                        gsize                 n_vectors,
+                        GCancellable         *cancellable,
+                        GError              **error)
+{
+  GOutputStreamClass *class;
+  gsize size;
+  gssize res;
+
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), -1);
+  g_return_val_if_fail (vectors != NULL || n_vectors == 0, -1);
+  g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), -1);
+  g_return_val_if_fail (error == NULL || *error == NULL, -1);
+
+  if (!output_vectors_get_size (vectors, n_vectors, &size, G_STRFUNC, error))
+    return -1;
+
+  if (size == 0)
+    return 0;
+
+  class = G_OUTPUT_STREAM_GET_CLASS (stream);
+
+  if (class->writev_fn == NULL)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           _("Output stream doesn’t implement writev"));
+      return -1;
+    }
+
+  if (!g_output_stream_set_pending (stream, error))
+    return -1;
+
+  if (cancellable)
+    g_cancellable_push_current (cancellable);
+
+  res = class->writev_fn (stream, vectors, n_vectors, cancellable, error);
+
+  if (cancellable)
+    g_cancellable_pop_current (cancellable);
+
+  g_output_stream_clear_pending (stream);
+
+  return res;
+}
+
+/**
+ * g_output_stream_writev_all:
+ * @stream: a #GOutputStream.
+ * @vectors: (array length=n_vectors): the buffers containing the data to write.
+ * @n_vectors: the number of vectors to write
+ * @bytes_written: (out) (optional): location to store the number of bytes
+ *     that were written to the stream
+ * @cancellable: (nullable): optional #GCancellable object, %NULL to ignore.
+ * @error: location to store the error occurring, or %NULL to ignore
+ *
+ * Tries to write the bytes contained in the @n_vectors @vectors into the
+ * stream. Will block during the operation.
+ *
+ * This function is similar to g_output_stream_writev(), except it tries to
+ * write as many bytes as requested, only stopping on an error.
+ *
+ * On a successful write of all @n_vectors vectors, %TRUE is returned, and
+ * @bytes_written is set to the sum of all the sizes of @vectors.
+ *
+ * If there is an error during the operation %FALSE is returned and @error
+ * is set to indicate the error status.
+ *
+ * As a special exception to the normal conventions for functions that
+ * use #GError, if this function returns %FALSE (and sets @error) then
+ * @bytes_written will be set to the number of bytes that were
+ * successfully written before the error was encountered.  This
+ * functionality is only available from C. If you need it from another
+ * language then you must write your own loop around
+ * g_output_stream_writev().
+ *
+ * The content of the individual elements of @vectors might be changed by
+ * this function.
+ *
+ * Returns: %TRUE on success, %FALSE if there was an error
+ *
+ * Since: 2.54
+ */
+gboolean
+g_output_stream_writev_all (GOutputStream  *stream,
+                            GOutputVector  *vectors,
+                            gsize           n_vectors,
+                            gsize          *bytes_written,
+                            GCancellable   *cancellable,
+                            GError        **error)
+{
+  gsize _bytes_written = 0;
+  gsize to_write;
+  gssize res;
+
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
+  g_return_val_if_fail (vectors != NULL || n_vectors == 0, FALSE);
+
+  if (bytes_written)
+    *bytes_written = 0;
+
+  if (!output_vectors_get_size (vectors, n_vectors, &to_write, G_STRFUNC, error))
+    return FALSE;
+
+  while (to_write > 0)
+    {
+      res = g_output_stream_writev (stream, vectors, n_vectors,
+                                    cancellable, error);
+      if (res == -1)
+        {
+          if (bytes_written)
+            *bytes_written = _bytes_written;
+          return FALSE;
+        }
+
+      if (res == 0)
+        g_warning ("Write returned zero without error");
+
+      _bytes_written += res;
+      to_write -= res;
+      output_vectors_advance (&vectors, &n_vectors, res);
+    }
+
+  if (bytes_written)
+    *bytes_written = _bytes_written;
+
+  return TRUE;
+}
+
 /**
  * g_output_stream_printf:
  * @stream: a #GOutputStream.
@@ -1060,6 +1293,349 @@ g_output_stream_write_all_finish (GOutputStream  *stream,
   return g_task_propagate_boolean (task, error);
 }
 
+static void
+async_ready_writev_callback_wrapper (GObject      *source_object,
+                                     GAsyncResult *res,
+                                     gpointer      user_data)
+{
+  GOutputStream *stream = G_OUTPUT_STREAM (source_object);
+  GOutputStreamClass *class;
+  GTask *task = user_data;
+  gssize nwrote;
+  GError *error = NULL;
+
+  g_output_stream_clear_pending (stream);
+
+  if (g_async_result_legacy_propagate_error (res, &error))
+    nwrote = -1;
+  else
+    {
+      class = G_OUTPUT_STREAM_GET_CLASS (stream);
+      nwrote = class->writev_finish (stream, res, &error);
+    }
+
+  if (nwrote >= 0)
+    g_task_return_int (task, nwrote);
+  else
+    g_task_return_error (task, error);
+  g_object_unref (task);
+}
+
+/**
+ * g_output_stream_writev_async:
+ * @stream: A #GOutputStream.
+ * @vectors: (array length=n_vectors): the buffers containing the data to write.
+ * @n_vectors: the number of vectors to write
+ * @io_priority: the I/O priority of the request.
+ * @cancellable: (nullable): optional #GCancellable object, %NULL to ignore.
+ * @callback: (scope async): callback to call when the request is satisfied
+ * @user_data: (closure): the data to pass to callback function
+ *
+ * Request an asynchronous write of the bytes contained in @n_vectors
+ * @vectors into the stream. When the operation is finished @callback
+ * will be called. You can then call g_output_stream_writev_finish() to
+ * get the result of the operation.
+ *
+ * During an async request no other sync and async calls are allowed,
+ * and will result in %G_IO_ERROR_PENDING errors.
+ *
+ * On success, the number of bytes written will be passed to the
+ * @callback. It is not an error if this is not the same as the
+ * requested size, as it can happen e.g. on a partial I/O error,
+ * but generally we try to write as many bytes as requested.
+ *
+ * You are guaranteed that this method will never fail with
+ * %G_IO_ERROR_WOULD_BLOCK — if @stream can't accept more data, the
+ * method will just wait until this changes.
+ *
+ * The asynchronous methods have a default fallback that uses threads
+ * or, for pollable streams, g_pollable_output_stream_writev_nonblocking()
+ * to implement asynchronicity, so they are optional for inheriting
+ * classes. However, if you override one you must override all.
+ *
+ * For the synchronous, blocking version of this function, see
+ * g_output_stream_writev().
+ *
+ * Note that no copy of @vectors will be made, so it must stay valid
+ * until @callback is called.
+ *
+ * Since: 2.54
+ */
+void
+g_output_stream_writev_async (GOutputStream        *stream,
+                              const GOutputVector  *vectors,
+                              gsize                 n_vectors,
+                              int                   io_priority,
+                              GCancellable         *cancellable,
+                              GAsyncReadyCallback   callback,
+                              gpointer              user_data)
+{
+  GOutputStreamClass *class;
+  GError *error = NULL;
+  GTask *task;
+  gsize size;
+
+  g_return_if_fail (G_IS_OUTPUT_STREAM (stream));
+  g_return_if_fail (vectors != NULL || n_vectors == 0);
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_output_stream_writev_async);
+  g_task_set_priority (task, io_priority);
+
+  if (!output_vectors_get_size (vectors, n_vectors, &size, G_STRFUNC, &error))
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  if (size == 0)
+    {
+      g_task_return_int (task, 0);
+      g_object_unref (task);
+      return;
+    }
+
+  if (!g_output_stream_set_pending (stream, &error))
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  class = G_OUTPUT_STREAM_GET_CLASS (stream);
+
+  class->writev_async (stream, vectors, n_vectors, io_priority, cancellable,
+                       async_ready_writev_callback_wrapper, task);
+}
+
+/**
+ * g_output_stream_writev_finish:
+ * @stream: a #GOutputStream.
+ * @result: a #GAsyncResult.
+ * @error: a #GError location to store the error occurring, or %NULL to
+ * ignore.
+ *
+ * Finishes a stream writev operation.
+ *
+ * Returns: a #gssize containing the number of bytes written to the stream.
+ *
+ * Since: 2.54
+ */
+gssize
+g_output_stream_writev_finish (GOutputStream  *stream,
+                               GAsyncResult   *result,
+                               GError        **error)
+{
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), -1);
+  g_return_val_if_fail (g_task_is_valid (result, stream), -1);
+  g_return_val_if_fail (g_async_result_is_tagged (result, g_output_stream_writev_async), -1);
+
+  /* @result is always the GTask created by g_output_stream_writev_async();
+   * we called class->writev_finish() from async_ready_writev_callback_wrapper.
+   */
+  return g_task_propagate_int (G_TASK (result), error);
+}
+
+typedef struct
+{
+  GOutputVector *vectors;
+  gsize n_vectors;
+  gsize to_write;
+  gsize bytes_written;
+} AsyncWritevAll;
+
+static void
+free_async_writev_all (gpointer data)
+{
+  g_slice_free (AsyncWritevAll, data);
+}
+
+static void
+writev_all_callback (GObject      *stream,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+  GTask *task = user_data;
+  AsyncWritevAll *data = g_task_get_task_data (task);
+
+  if (result)
+    {
+      GError *error = NULL;
+      gssize nwritten;
+
+      nwritten = g_output_stream_writev_finish (G_OUTPUT_STREAM (stream), result, &error);
+
+      if (nwritten == -1)
+        {
+          g_task_return_error (task, error);
+          g_object_unref (task);
+          return;
+        }
+
+      g_assert_cmpint (nwritten, <=, data->to_write);
+      g_warn_if_fail (nwritten > 0);
+
+      data->to_write -= nwritten;
+      data->bytes_written += nwritten;
+      output_vectors_advance (&data->vectors, &data->n_vectors, nwritten);
+    }
+
+  if (data->to_write == 0)
+    {
+      g_task_return_boolean (task, TRUE);
+      g_object_unref (task);
+    }
+
+  else
+    g_output_stream_writev_async (G_OUTPUT_STREAM (stream),
+                                  data->vectors,
+                                  data->n_vectors,
+                                  g_task_get_priority (task),
+                                  g_task_get_cancellable (task),
+                                  writev_all_callback, task);
+}
+
+static void
+writev_all_async_thread (GTask        *task,
+                         gpointer      source_object,
+                         gpointer      task_data,
+                         GCancellable *cancellable)
+{
+  GOutputStream *stream = source_object;
+  AsyncWritevAll *data = task_data;
+  GError *error = NULL;
+
+  if (g_output_stream_writev_all (stream, data->vectors, data->n_vectors,
+                                  &data->bytes_written,
+                                  g_task_get_cancellable (task), &error))
+    g_task_return_boolean (task, TRUE);
+  else
+    g_task_return_error (task, error);
+}
+
+/**
+ * g_output_stream_writev_all_async:
+ * @stream: A #GOutputStream
+ * @vectors: (array length=n_vectors): the buffers containing the data to write.
+ * @n_vectors: the number of vectors to write
+ * @io_priority: the I/O priority of the request
+ * @cancellable: (nullable): optional #GCancellable object, %NULL to ignore
+ * @callback: (scope async): callback to call when the request is satisfied
+ * @user_data: (closure): the data to pass to callback function
+ *
+ * Request an asynchronous write of the bytes contained in the @n_vectors
+ * @vectors into the stream. When the operation is finished @callback
+ * will be called. You can then call g_output_stream_writev_all_finish()
+ * to get the result of the operation.
+ *
+ * This is the asynchronous version of g_output_stream_writev_all().
+ *
+ * Any outstanding I/O request with higher priority (lower numerical
+ * value) will be executed before an outstanding request with lower
+ * priority. Default priority is %G_PRIORITY_DEFAULT.
+ *
+ * Note that no copy of @vectors will be made, so it must stay valid
+ * until @callback is called. The content of the individual elements
+ * of @vectors might be changed by this function.
+ *
+ * Since: 2.54
+ */
+void
+g_output_stream_writev_all_async (GOutputStream       *stream,
+                                  GOutputVector       *vectors,
+                                  gsize                n_vectors,
+                                  int                  io_priority,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+  AsyncWritevAll *data;
+  GError *error = NULL;
+  GTask *task;
+
+  g_return_if_fail (G_IS_OUTPUT_STREAM (stream));
+  g_return_if_fail (vectors != NULL || n_vectors == 0);
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  task = g_task_new (stream, cancellable, callback, user_data);
+  data = g_slice_new0 (AsyncWritevAll);
+  data->vectors = vectors;
+  data->n_vectors = n_vectors;
+
+  g_task_set_source_tag (task, g_output_stream_writev_all_async);
+  g_task_set_task_data (task, data, free_async_writev_all);
+  g_task_set_priority (task, io_priority);
+
+  if (!output_vectors_get_size (vectors, n_vectors, &data->to_write,
+                                G_STRFUNC, &error))
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  /* If async writes are going to be handled via the threadpool anyway
+   * then we may as well do it with a single dispatch instead of
+   * bouncing in and out.
+   */
+  if (g_output_stream_async_writev_is_via_threads (stream))
+    {
+      g_task_run_in_thread (task, writev_all_async_thread);
+      g_object_unref (task);
+    }
+  else
+    writev_all_callback (G_OBJECT (stream), NULL, task);
+}
+
+/**
+ * g_output_stream_writev_all_finish:
+ * @stream: a #GOutputStream
+ * @result: a #GAsyncResult
+ * @bytes_written: (out) (optional): location to store the number of bytes
+ *     that were written to the stream
+ * @error: a #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Finishes an asynchronous stream write operation started with
+ * g_output_stream_writev_all_async().
+ *
+ * As a special exception to the normal conventions for functions that
+ * use #GError, if this function returns %FALSE (and sets @error) then
+ * @bytes_written will be set to the number of bytes that were
+ * successfully written before the error was encountered.  This
+ * functionality is only available from C.  If you need it from another
+ * language then you must write your own loop around
+ * g_output_stream_writev_async().
+ *
+ * Returns: %TRUE on success, %FALSE if there was an error
+ *
+ * Since: 2.54
+ */
+gboolean
+g_output_stream_writev_all_finish (GOutputStream  *stream,
+                                   GAsyncResult   *result,
+                                   gsize          *bytes_written,
+                                   GError        **error)
+{
+  GTask *task;
+
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, stream), FALSE);
+  g_return_val_if_fail (g_async_result_is_tagged (result, g_output_stream_writev_all_async), FALSE);
+
+  task = G_TASK (result);
+
+  if (bytes_written)
+    {
+      AsyncWritevAll *data = (AsyncWritevAll *)g_task_get_task_data (task);
+
+      *bytes_written = data->bytes_written;
+    }
+
+  return g_task_propagate_boolean (task, error);
+}
+
 static void
 write_bytes_callback (GObject      *stream,
                       GAsyncResult *result,
@@ -1711,6 +2287,28 @@ g_output_stream_async_write_is_via_threads (GOutputStream *stream)
         g_pollable_output_stream_can_poll (G_POLLABLE_OUTPUT_STREAM (stream))));
 }
 
+/*< internal >
+ * g_output_stream_async_writev_is_via_threads:
+ * @stream: a #GOutputStream.
+ *
+ * Checks if an output stream's writev_async function uses threads.
+ *
+ * Returns: %TRUE if @stream's writev_async function uses threads.
+ **/
+gboolean
+g_output_stream_async_writev_is_via_threads (GOutputStream *stream)
+{
+  GOutputStreamClass *class;
+
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
+
+  class = G_OUTPUT_STREAM_GET_CLASS (stream);
+
+  return (class->writev_async == g_output_stream_real_writev_async &&
+      !(G_IS_POLLABLE_OUTPUT_STREAM (stream) &&
+        g_pollable_output_stream_can_poll (G_POLLABLE_OUTPUT_STREAM (stream))));
+}
+
 /*< internal >
  * g_output_stream_async_close_is_via_threads:
  * @stream: output stream
@@ -1851,6 +2449,168 @@ g_output_stream_real_write_finish (GOutputStream  *stream,
   return g_task_propagate_int (G_TASK (result), error);
 }
 
+static gssize
+g_output_stream_real_writev (GOutputStream        *stream,
+                             const GOutputVector  *vectors,
+                             gsize                 n_vectors,
+                             GCancellable         *cancellable,
+                             GError              **error)
+{
+  GOutputStreamClass *class;
+  gsize total = 0;
+  gsize i;
+
+  class = G_OUTPUT_STREAM_GET_CLASS (stream);
+
+  for (i = 0; i < n_vectors; i++)
+    {
+      GError *my_error = NULL;
+      gssize res;
+
+      if (vectors[i].size == 0)
+        continue;
+
+      res = class->write_fn (stream, vectors[i].buffer, vectors[i].size,
+                             cancellable, &my_error);
+      if (res == -1)
+        {
+          /* Report what was already written, as write_fn does for a
+           * partial I/O error; the error will recur on the next call.
+           */
+          if (total > 0)
+            {
+              g_error_free (my_error);
+              break;
+            }
+
+          g_propagate_error (error, my_error);
+          return -1;
+        }
+
+      total += res;
+
+      if ((gsize) res < vectors[i].size)
+        break;
+    }
+
+  return total;
+}
+
+typedef struct {
+  const GOutputVector *vectors;
+  gsize                n_vectors;
+} WritevData;
+
+static void
+free_writev_data (WritevData *op)
+{
+  g_slice_free (WritevData, op);
+}
+
+static void
+writev_async_thread (GTask        *task,
+                     gpointer      source_object,
+                     gpointer      task_data,
+                     GCancellable *cancellable)
+{
+  GOutputStream *stream = source_object;
+  WritevData *op = task_data;
+  GOutputStreamClass *class;
+  GError *error = NULL;
+  gssize count_written;
+
+  class = G_OUTPUT_STREAM_GET_CLASS (stream);
+  count_written = class->writev_fn (stream, op->vectors, op->n_vectors,
+                                    cancellable, &error);
+  if (count_written == -1)
+    g_task_return_error (task, error);
+  else
+    g_task_return_int (task, count_written);
+}
+
+static void writev_async_pollable (GPollableOutputStream *stream,
+                                   GTask                 *task);
+
+static gboolean
+writev_async_pollable_ready (GPollableOutputStream *stream,
+                             gpointer               user_data)
+{
+  GTask *task = user_data;
+
+  writev_async_pollable (stream, task);
+  return FALSE;
+}
+
+static void
+writev_async_pollable (GPollableOutputStream *stream,
+                       GTask                 *task)
+{
+  GError *error = NULL;
+  WritevData *op = g_task_get_task_data (task);
+  gssize count_written;
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  count_written = G_POLLABLE_OUTPUT_STREAM_GET_INTERFACE (stream)->
+    writev_nonblocking (stream, op->vectors, op->n_vectors, &error);
+
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+    {
+      GSource *source;
+
+      g_error_free (error);
+
+      source = g_pollable_output_stream_create_source (stream,
+                                                       g_task_get_cancellable (task));
+      g_task_attach_source (task, source,
+                            (GSourceFunc) writev_async_pollable_ready);
+      g_source_unref (source);
+      return;
+    }
+
+  if (count_written == -1)
+    g_task_return_error (task, error);
+  else
+    g_task_return_int (task, count_written);
+}
+
+static void
+g_output_stream_real_writev_async (GOutputStream        *stream,
+                                   const GOutputVector  *vectors,
+                                   gsize                 n_vectors,
+                                   int                   io_priority,
+                                   GCancellable         *cancellable,
+                                   GAsyncReadyCallback   callback,
+                                   gpointer              user_data)
+{
+  GTask *task;
+  WritevData *op;
+
+  op = g_slice_new0 (WritevData);
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_check_cancellable (task, FALSE);
+  g_task_set_task_data (task, op, (GDestroyNotify) free_writev_data);
+  op->vectors = vectors;
+  op->n_vectors = n_vectors;
+
+  if (!g_output_stream_async_writev_is_via_threads (stream))
+    writev_async_pollable (G_POLLABLE_OUTPUT_STREAM (stream), task);
+  else
+    g_task_run_in_thread (task, writev_async_thread);
+  g_object_unref (task);
+}
+
+static gssize
+g_output_stream_real_writev_finish (GOutputStream  *stream,
+                                    GAsyncResult   *result,
+                                    GError        **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, stream), -1);
+
+  return g_task_propagate_int (G_TASK (result), error);
+}
+
 typedef struct {
   GInputStream *source;
   GOutputStreamSpliceFlags flags;
@@ -119,11 +119,24 @@ struct _GOutputStreamClass
                                  GAsyncResult             *result,
                                  GError                  **error);
 
+  gssize      (* writev_fn)     (GOutputStream            *stream,
+                                 const GOutputVector      *vectors,
+                                 gsize                     n_vectors,
+                                 GCancellable             *cancellable,
+                                 GError                  **error);
+  void        (* writev_async)  (GOutputStream            *stream,
+                                 const GOutputVector      *vectors,
+                                 gsize                     n_vectors,
+                                 int                       io_priority,
+                                 GCancellable             *cancellable,
+                                 GAsyncReadyCallback       callback,
+                                 gpointer                  user_data);
+  gssize      (* writev_finish) (GOutputStream            *stream,
+                                 GAsyncResult             *result,
+                                 GError                  **error);
+
   /*< private >*/
   /* Padding for future expansion */
-  void (*_g_reserved1) (void);
-  void (*_g_reserved2) (void);
-  void (*_g_reserved3) (void);
   void (*_g_reserved4) (void);
   void (*_g_reserved5) (void);
   void (*_g_reserved6) (void);
@@ -147,6 +160,19 @@ gboolean g_output_stream_write_all     (GOutputStream             *stream,
 					gsize                     *bytes_written,
 					GCancellable              *cancellable,
 					GError                   **error);
+GLIB_AVAILABLE_IN_2_54
+gssize   g_output_stream_writev        (GOutputStream             *stream,
+                                        const GOutputVector       *vectors,
+                                        gsize                      n_vectors,
+                                        GCancellable              *cancellable,
+                                        GError                   **error);
+GLIB_AVAILABLE_IN_2_54
+gboolean g_output_stream_writev_all    (GOutputStream             *stream,
+                                        GOutputVector             *vectors,
+                                        gsize                      n_vectors,
+                                        gsize                     *bytes_written,
+                                        GCancellable              *cancellable,
+                                        GError                   **error);
 GLIB_AVAILABLE_IN_2_40
 gboolean g_output_stream_printf        (GOutputStream             *stream,
                                         gsize                     *bytes_written,
@@ -208,6 +234,34 @@ gboolean g_output_stream_write_all_finish (GOutputStream          *stream,
                                            gsize                  *bytes_written,
                                            GError                **error);
 
+GLIB_AVAILABLE_IN_2_54
+void     g_output_stream_writev_async  (GOutputStream             *stream,
+                                        const GOutputVector       *vectors,
+                                        gsize                      n_vectors,
+                                        int                        io_priority,
+                                        GCancellable              *cancellable,
+                                        GAsyncReadyCallback        callback,
+                                        gpointer                   user_data);
+GLIB_AVAILABLE_IN_2_54
+gssize   g_output_stream_writev_finish (GOutputStream             *stream,
+                                        GAsyncResult              *result,
+                                        GError                   **error);
+
+GLIB_AVAILABLE_IN_2_54
+void     g_output_stream_writev_all_async (GOutputStream          *stream,
+                                           GOutputVector          *vectors,
+                                           gsize                   n_vectors,
+                                           int                     io_priority,
+                                           GCancellable           *cancellable,
+                                           GAsyncReadyCallback     callback,
+                                           gpointer                user_data);
+
+GLIB_AVAILABLE_IN_2_54
+gboolean g_output_stream_writev_all_finish (GOutputStream         *stream,
+                                            GAsyncResult          *result,
+                                            gsize                 *bytes_written,
+                                            GError               **error);
+
 GLIB_AVAILABLE_IN_2_34
 void     g_output_stream_write_bytes_async  (GOutputStream             *stream,
 					     GBytes                    *bytes,
@@ -46,12 +46,17 @@ static gssize   g_pollable_output_stream_default_write_nonblocking (GPollableOut
 								    const void             *buffer,
 								    gsize                   count,
 								    GError                **error);
+static gssize   g_pollable_output_stream_default_writev_nonblocking (GPollableOutputStream  *stream,
+								     const GOutputVector    *vectors,
+								     gsize                   n_vectors,
+								     GError                **error);
 
 static void
 g_pollable_output_stream_default_init (GPollableOutputStreamInterface *iface)
 {
   iface->can_poll          = g_pollable_output_stream_default_can_poll;
   iface->write_nonblocking = g_pollable_output_stream_default_write_nonblocking;
+  iface->writev_nonblocking = g_pollable_output_stream_default_writev_nonblocking;
 }
 
 static gboolean
@@ -218,3 +223,115 @@ g_pollable_output_stream_write_nonblocking (GPollableOutputStream  *stream,
 
   return res;
 }
+
+static gssize
+g_pollable_output_stream_default_writev_nonblocking (GPollableOutputStream  *stream,
+						     const GOutputVector    *vectors,
+						     gsize                   n_vectors,
+						     GError                **error)
+{
+  GPollableOutputStreamInterface *iface = G_POLLABLE_OUTPUT_STREAM_GET_INTERFACE (stream);
+  gsize total = 0;
+  gsize i;
+
+  for (i = 0; i < n_vectors; i++)
+    {
+      GError *my_error = NULL;
+      gssize res;
+
+      if (vectors[i].size == 0)
+        continue;
+
+      res = iface->write_nonblocking (stream, vectors[i].buffer,
+                                      vectors[i].size, &my_error);
+      if (res == -1)
+        {
+          /* Anything already written is a short write, not an error */
+          if (total > 0)
+            {
+              g_error_free (my_error);
+              break;
+            }
+
+          g_propagate_error (error, my_error);
+          return -1;
+        }
+
+      total += res;
+
+      if ((gsize) res < vectors[i].size)
+        break;
+    }
+
+  return total;
+}
+
+/**
+ * g_pollable_output_stream_writev_nonblocking:
+ * @stream: a #GPollableOutputStream
+ * @vectors: (array length=n_vectors): the buffers containing the data to write.
+ * @n_vectors: the number of vectors to write
+ * @cancellable: (nullable): a #GCancellable, or %NULL
+ * @error: #GError for error reporting, or %NULL to ignore.
+ *
+ * Attempts to write the bytes contained in the @n_vectors @vectors to
+ * @stream, as with g_output_stream_writev(). If @stream is not currently
+ * writable, this will immediately return %G_IO_ERROR_WOULD_BLOCK, and you
+ * can use g_pollable_output_stream_create_source() to create a #GSource
+ * that will be triggered when @stream is writable.
+ *
+ * Note that since this method never blocks, you cannot actually
+ * use @cancellable to cancel it. However, it will return an error
+ * if @cancellable has already been cancelled when you call, which
+ * may happen if you call this method after a source triggers due
+ * to having been cancelled.
+ *
+ * Virtual: writev_nonblocking
+ * Returns: the number of bytes written, or -1 on error (including
+ *   %G_IO_ERROR_WOULD_BLOCK).
+ *
+ * Since: 2.54
+ */
+gssize
+g_pollable_output_stream_writev_nonblocking (GPollableOutputStream  *stream,
+					     const GOutputVector    *vectors,
+					     gsize                   n_vectors,
+					     GCancellable           *cancellable,
+					     GError                **error)
+{
+  gsize size = 0;
+  gsize i;
+  gssize res;
+
+  g_return_val_if_fail (G_IS_POLLABLE_OUTPUT_STREAM (stream), -1);
+  g_return_val_if_fail (vectors != NULL || n_vectors == 0, -1);
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return -1;
+
+  for (i = 0; i < n_vectors; i++)
+    {
+      if (vectors[i].size > (gsize) G_MAXSSIZE - size)
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                       _("Sum of vectors passed to %s too large"), G_STRFUNC);
+          return -1;
+        }
+
+      size += vectors[i].size;
+    }
+
+  if (size == 0)
+    return 0;
+
+  if (cancellable)
+    g_cancellable_push_current (cancellable);
+
+  res = G_POLLABLE_OUTPUT_STREAM_GET_INTERFACE (stream)->
+    writev_nonblocking (stream, vectors, n_vectors, error);
+
+  if (cancellable)
+    g_cancellable_pop_current (cancellable);
+
+  return res;
+}
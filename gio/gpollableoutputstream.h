@@ -49,6 +49,8 @@ typedef struct _GPollableOutputStreamInterface GPollableOutputStreamInterface;
  * @create_source: Creates a #GSource to poll the stream
  * @write_nonblocking: Does a non-blocking write or returns
  *   %G_IO_ERROR_WOULD_BLOCK
+ * @writev_nonblocking: Does a vectored non-blocking write, or returns
+ *   %G_IO_ERROR_WOULD_BLOCK. Since 2.54.
  *
  * The interface for pollable output streams.
  *
@@ -61,6 +63,10 @@ typedef struct _GPollableOutputStreamInterface GPollableOutputStreamInterface;
  * implementation may return %TRUE when the stream is not actually
  * writable.
  *
+ * The default implementation of @writev_nonblocking calls
+ * g_pollable_output_stream_write_nonblocking() for each vector, until
+ * one of them is written only partially.
+ *
  * Since: 2.28
  */
 struct _GPollableOutputStreamInterface
@@ -77,6 +83,10 @@ struct _GPollableOutputStreamInterface
 				     const void             *buffer,
 				     gsize                   count,
 				     GError                **error);
+  gssize       (*writev_nonblocking) (GPollableOutputStream  *stream,
+				      const GOutputVector    *vectors,
+				      gsize                   n_vectors,
+				      GError                **error);
 };
 
 GLIB_AVAILABLE_IN_ALL
@@ -97,6 +107,12 @@ gssize   g_pollable_output_stream_write_nonblocking (GPollableOutputStream  *str
 						     gsize                   count,
 						     GCancellable           *cancellable,
 						     GError                **error);
+GLIB_AVAILABLE_IN_2_54
+gssize   g_pollable_output_stream_writev_nonblocking (GPollableOutputStream  *stream,
+						      const GOutputVector    *vectors,
+						      gsize                   n_vectors,
+						      GCancellable           *cancellable,
+						      GError                **error);
 
 G_END_DECLS
 
@@ -67,7 +67,7 @@ g_proxy_get_default_for_protocol (const gchar *protocol)
   GIOExtension *extension;
 
   /* Ensure proxy modules loaded */
-  _g_io_modules_ensure_loaded ();
+  _g_io_modules_ensure_extension_point_loaded (G_PROXY_EXTENSION_POINT_NAME);
 
   ep = g_io_extension_point_lookup (G_PROXY_EXTENSION_POINT_NAME);
 
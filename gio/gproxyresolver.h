@@ -71,6 +71,11 @@ GType		g_proxy_resolver_get_type       (void) G_GNUC_CONST;
 GLIB_AVAILABLE_IN_ALL
 GProxyResolver *g_proxy_resolver_get_default    (void);
 
+GLIB_AVAILABLE_IN_2_54
+GProxyResolver *g_proxy_resolver_new_caching    (GProxyResolver       *resolver,
+						 guint                 ttl,
+						 guint                 max_entries);
+
 GLIB_AVAILABLE_IN_ALL
 gboolean        g_proxy_resolver_is_supported   (GProxyResolver       *resolver);
 GLIB_AVAILABLE_IN_ALL
@@ -119,6 +119,11 @@ GLIB_AVAILABLE_IN_ALL
 GResolver *g_resolver_get_default               (void);
 GLIB_AVAILABLE_IN_ALL
 void       g_resolver_set_default               (GResolver            *resolver);
+GLIB_AVAILABLE_IN_2_54
+GResolver *g_resolver_new_caching               (GResolver            *resolver,
+                                                 guint                 max_entries);
+GLIB_AVAILABLE_IN_2_54
+GResolver *g_resolver_new_dns                   (void);
 
 GLIB_AVAILABLE_IN_ALL
 GList     *g_resolver_lookup_by_name            (GResolver            *resolver,
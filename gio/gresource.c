@@ -32,13 +32,41 @@
 #include <gio/gzlibdecompressor.h>
 #include <gio/gconverterinputstream.h>
 
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#endif
+
 struct _GResource
 {
   int ref_count;
 
   GvdbTable *table;
+
+  /* Recently used decompressed files, keyed by the address of their
+   * compressed data in @table, most recently used first in cache_lru.
+   */
+  GMutex cache_lock;
+  GHashTable *cache;
+  GQueue cache_lru;
+  gsize cache_size;
 };
 
+/* Upper bound on the memory used for decompressed files per resource.
+ * Files bigger than a quarter of that are never cached.
+ */
+#define RESOURCE_CACHE_SIZE (1024 * 1024)
+#define RESOURCE_CACHE_MAX_ENTRY (RESOURCE_CACHE_SIZE / 4)
+
+typedef struct
+{
+  GList link;
+  gconstpointer key;
+  GBytes *bytes;
+} CacheEntry;
+
 static void register_lazy_static_resources (void);
 
 G_DEFINE_BOXED_TYPE (GResource, g_resource, g_resource_ref, g_resource_unref)
@@ -163,6 +191,12 @@ G_DEFINE_BOXED_TYPE (GResource, g_resource, g_resource_ref, g_resource_unref)
  * the slash should ideally be absolute, but this is not strictly required.  It is possible to overlay the
  * location of a single resource with an individual file.
  *
+ * Since GLib 2.54, setting the `G_RESOURCE_ACCESS_LOG` environment variable to a filename makes GResource
+ * append the path of every file that is read with g_resource_lookup_data() or g_resource_open_stream() to that
+ * file, once per path, in the order they are first used.  The result can be passed to the `--access-profile`
+ * option of [glib-compile-resources][glib-compile-resources] to store the files used at startup next to each
+ * other, and g_resources_prefetch() can be used to read them in ahead of time.
+ *
  * Since: 2.32
  */
 
@@ -478,6 +512,18 @@ g_resource_unref (GResource *resource)
 {
   if (g_atomic_int_dec_and_test (&resource->ref_count))
     {
+      CacheEntry *entry;
+
+      while ((entry = g_queue_peek_head (&resource->cache_lru)))
+        {
+          g_queue_unlink (&resource->cache_lru, &entry->link);
+          g_bytes_unref (entry->bytes);
+          g_slice_free (CacheEntry, entry);
+        }
+      if (resource->cache)
+        g_hash_table_unref (resource->cache);
+      g_mutex_clear (&resource->cache_lock);
+
       gvdb_table_unref (resource->table);
       g_free (resource);
     }
@@ -494,9 +540,11 @@ g_resource_new_from_table (GvdbTable *table)
 {
   GResource *resource;
 
-  resource = g_new (GResource, 1);
+  resource = g_new0 (GResource, 1);
   resource->ref_count = 1;
   resource->table = table;
+  g_mutex_init (&resource->cache_lock);
+  g_queue_init (&resource->cache_lru);
 
   return resource;
 }
@@ -632,6 +680,115 @@ gboolean do_lookup (GResource             *resource,
   return res;
 }
 
+G_LOCK_DEFINE_STATIC (access_log);
+
+static void
+resource_log_access (const gchar *path)
+{
+  static gsize initialised;
+  static FILE *access_log;
+  static GHashTable *logged;
+
+  if (g_once_init_enter (&initialised))
+    {
+      const gchar *filename = g_getenv ("G_RESOURCE_ACCESS_LOG");
+
+      if (filename != NULL)
+        {
+          access_log = g_fopen (filename, "a");
+          if (access_log == NULL)
+            g_warning ("Failed to open G_RESOURCE_ACCESS_LOG file '%s'", filename);
+          else
+            logged = g_hash_table_new (g_str_hash, g_str_equal);
+        }
+
+      g_once_init_leave (&initialised, 1);
+    }
+
+  if (access_log == NULL)
+    return;
+
+  G_LOCK (access_log);
+
+  if (!g_hash_table_contains (logged, path))
+    {
+      g_hash_table_add (logged, g_strdup (path));
+      fprintf (access_log, "%s\n", path);
+      fflush (access_log);
+    }
+
+  G_UNLOCK (access_log);
+}
+
+static GBytes *
+resource_cache_lookup (GResource     *resource,
+                       gconstpointer  key)
+{
+  CacheEntry *entry = NULL;
+
+  g_mutex_lock (&resource->cache_lock);
+
+  if (resource->cache)
+    entry = g_hash_table_lookup (resource->cache, key);
+
+  if (entry)
+    {
+      g_queue_unlink (&resource->cache_lru, &entry->link);
+      g_queue_push_head_link (&resource->cache_lru, &entry->link);
+    }
+
+  g_mutex_unlock (&resource->cache_lock);
+
+  return entry ? g_bytes_ref (entry->bytes) : NULL;
+}
+
+static void
+resource_cache_insert (GResource     *resource,
+                       gconstpointer  key,
+                       GBytes        *bytes)
+{
+  CacheEntry *entry;
+  gsize size;
+
+  size = g_bytes_get_size (bytes);
+  if (size > RESOURCE_CACHE_MAX_ENTRY)
+    return;
+
+  g_mutex_lock (&resource->cache_lock);
+
+  if (resource->cache == NULL)
+    resource->cache = g_hash_table_new (NULL, NULL);
+
+  /* Somebody else decompressed it at the same time */
+  if (g_hash_table_contains (resource->cache, key))
+    {
+      g_mutex_unlock (&resource->cache_lock);
+      return;
+    }
+
+  while (resource->cache_size + size > RESOURCE_CACHE_SIZE)
+    {
+      CacheEntry *old = g_queue_peek_tail (&resource->cache_lru);
+
+      g_queue_unlink (&resource->cache_lru, &old->link);
+      g_hash_table_remove (resource->cache, old->key);
+      resource->cache_size -= g_bytes_get_size (old->bytes);
+      g_bytes_unref (old->bytes);
+      g_slice_free (CacheEntry, old);
+    }
+
+  entry = g_slice_new (CacheEntry);
+  entry->link.data = entry;
+  entry->link.prev = entry->link.next = NULL;
+  entry->key = key;
+  entry->bytes = g_bytes_ref (bytes);
+  g_queue_push_head_link (&resource->cache_lru, &entry->link);
+  g_hash_table_insert (resource->cache, (gpointer) key, entry);
+  resource->cache_size += size;
+
+  g_mutex_unlock (&resource->cache_lock);
+}
+
 /**
  * g_resource_open_stream:
  * @resource: A #GResource
@@ -663,6 +820,8 @@ g_resource_open_stream (GResource             *resource,
   if (!do_lookup (resource, path, lookup_flags, NULL, &flags, &data, &data_size, error))
     return NULL;
 
+  resource_log_access (path);
+
   stream = g_memory_input_stream_new_from_data (data, data_size, NULL);
   g_object_set_data_full (G_OBJECT (stream), "g-resource",
                           g_resource_ref (resource),
@@ -700,7 +859,9 @@ g_resource_open_stream (GResource             *resource,
  * For uncompressed resource files this is a pointer directly into
  * the resource bundle, which is typically in some readonly data section
  * in the program binary. For compressed files we allocate memory on
- * the heap and automatically uncompress the data.
+ * the heap and automatically uncompress the data. Recently used files
+ * that are small enough are kept uncompressed, so looking them up
+ * again returns the same data without decompressing it again.
  *
  * @lookup_flags controls the behaviour of the lookup.
  *
@@ -723,6 +884,8 @@ g_resource_lookup_data (GResource             *resource,
   if (!do_lookup (resource, path, lookup_flags, &size, &flags, &data, &data_size, error))
     return NULL;
 
+  resource_log_access (path);
+
   if (flags & G_RESOURCE_FLAGS_COMPRESSED)
     {
       char *uncompressed, *d;
@@ -730,10 +893,14 @@ g_resource_lookup_data (GResource             *resource,
       GConverterResult res;
       gsize d_size, s_size;
       gsize bytes_read, bytes_written;
+      GZlibDecompressor *decompressor;
+      GBytes *bytes;
 
+      bytes = resource_cache_lookup (resource, data);
+      if (bytes != NULL)
+        return bytes;
 
-      GZlibDecompressor *decompressor =
-        g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB);
+      decompressor = g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB);
 
       uncompressed = g_malloc (size + 1);
 
@@ -773,7 +940,10 @@ g_resource_lookup_data (GResource             *resource,
 
       g_object_unref (decompressor);
 
-      return g_bytes_new_take (uncompressed, size);
+      bytes = g_bytes_new_take (uncompressed, size);
+      resource_cache_insert (resource, data, bytes);
+
+      return bytes;
     }
   else
     return g_bytes_new_with_free_func (data, data_size, (GDestroyNotify)g_resource_unref, g_resource_ref (resource));
@@ -868,6 +1038,166 @@ g_resource_enumerate_children (GResource             *resource,
   return children;
 }
 
+typedef struct
+{
+  const guint8 *start;
+  const guint8 *end;
+} PrefetchRange;
+
+/* Adds the data of the file at @path, or of all files below it if it
+ * is a directory, to @ranges.
+ */
+static gboolean
+collect_prefetch_ranges (GResource   *resource,
+                         const gchar *path,
+                         GArray      *ranges)
+{
+  const void *data;
+  gsize data_size;
+  gchar *path_with_slash;
+  gchar **children;
+  gsize path_len;
+  gint i;
+
+  if (*path == '\0')
+    return FALSE;
+
+  path_len = strlen (path);
+
+  if (path[path_len - 1] != '/' &&
+      do_lookup (resource, path, 0, NULL, NULL, &data, &data_size, NULL))
+    {
+      PrefetchRange range = { data, (const guint8 *) data + data_size };
+
+      g_array_append_val (ranges, range);
+      return TRUE;
+    }
+
+  if (path[path_len - 1] != '/')
+    path_with_slash = g_strconcat (path, "/", NULL);
+  else
+    path_with_slash = g_strdup (path);
+
+  children = gvdb_table_list (resource->table, path_with_slash);
+
+  if (children != NULL)
+    {
+      for (i = 0; children[i] != NULL; i++)
+        {
+          gchar *child = g_strconcat (path_with_slash, children[i], NULL);
+          collect_prefetch_ranges (resource, child, ranges);
+          g_free (child);
+        }
+
+      g_strfreev (children);
+    }
+
+  g_free (path_with_slash);
+
+  return children != NULL;
+}
+
+static gint
+prefetch_range_compare (gconstpointer a,
+                        gconstpointer b)
+{
+  const PrefetchRange *ra = a, *rb = b;
+
+  return ra->start < rb->start ? -1 : ra->start > rb->start;
+}
+
+static void
+prefetch_ranges (GArray *ranges)
+{
+#if defined (HAVE_MMAP) && defined (POSIX_MADV_WILLNEED)
+  gsize page_size;
+  guintptr start = 0, end = 0;
+  guint i;
+
+  page_size = sysconf (_SC_PAGESIZE);
+
+  /* Files are mostly stored next to each other, so merge them into as
+   * few calls as possible.
+   */
+  g_array_sort (ranges, prefetch_range_compare);
+
+  for (i = 0; i < ranges->len; i++)
+    {
+      PrefetchRange *range = &g_array_index (ranges, PrefetchRange, i);
+      guintptr range_start = GPOINTER_TO_SIZE (range->start) & ~(page_size - 1);
+      guintptr range_end = GPOINTER_TO_SIZE (range->end);
+
+      if (end != 0 && range_start <= end)
+        {
+          end = MAX (end, range_end);
+          continue;
+        }
+
+      /* failure is harmless: the hint is just not applied */
+      if (end != 0)
+        posix_madvise (GSIZE_TO_POINTER (start), end - start, POSIX_MADV_WILLNEED);
+
+      start = range_start;
+      end = range_end;
+    }
+
+  if (end != 0)
+    posix_madvise (GSIZE_TO_POINTER (start), end - start, POSIX_MADV_WILLNEED);
+#endif
+}
+
+/**
+ * g_resource_prefetch:
+ * @resource: A #GResource
+ * @path: A pathname inside the resource
+ * @lookup_flags: A #GResourceLookupFlags
+ * @error: return location for a #GError, or %NULL
+ *
+ * Tells the operating system that the file at @path in @resource, or
+ * all the files below @path if it is a directory, are going to be used
+ * soon, so that it can start reading them in from disk.
+ *
+ * This is only a hint, which makes sense for resources that are mapped
+ * from a file or linked into the program, and most useful when the
+ * files were laid out by their access order using the
+ * `--access-profile` option of
+ * [glib-compile-resources][glib-compile-resources]. It does nothing on
+ * platforms without posix_madvise().
+ *
+ * If @path does not exist in @resource,
+ * %G_RESOURCE_ERROR_NOT_FOUND will be returned.
+ *
+ * @lookup_flags controls the behaviour of the lookup.
+ *
+ * Returns: %TRUE if @path was found. %FALSE if there were errors
+ *
+ * Since: 2.54
+ **/
+gboolean
+g_resource_prefetch (GResource             *resource,
+                     const gchar           *path,
+                     GResourceLookupFlags   lookup_flags,
+                     GError               **error)
+{
+  GArray *ranges;
+
+  ranges = g_array_new (FALSE, FALSE, sizeof (PrefetchRange));
+
+  if (!collect_prefetch_ranges (resource, path, ranges))
+    {
+      g_array_unref (ranges);
+      g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND,
+                   _("The resource at “%s” does not exist"),
+                   path);
+      return FALSE;
+    }
+
+  prefetch_ranges (ranges);
+  g_array_unref (ranges);
+
+  return TRUE;
+}
+
 static GRWLock resources_lock;
 static GList *registered_resources;
 
@@ -875,23 +1205,284 @@ static GList *registered_resources;
    lock, but all other accesses are done under the write lock */
 static GStaticResource *lazy_register_resources;
 
+/* Each entry of registered_resources is one of these.  @dirs is the
+ * list of all directories contained in the resource, computed once at
+ * registration time, or %NULL if the resource does not have the
+ * directory structure glib-compile-resources generates, in which case
+ * it has to be consulted for every path.
+ */
+typedef struct
+{
+  GResource *resource;
+  gchar    **dirs;
+} RegisteredResource;
+
+/* The global lookups don't walk registered_resources.  Instead, every
+ * change to the registered set builds an immutable index which maps
+ * each directory to the resources containing it, in lookup order, so
+ * that finding a file only has to look at the bundles that can
+ * possibly contain it.
+ *
+ * The current index is published in resources_index and readers take
+ * a reference on it without taking resources_lock.  To make that safe,
+ * readers bump resources_index_readers for the short time between
+ * loading the pointer and taking their reference.  A writer replacing
+ * the index can only drop its reference to the old one once that
+ * counter has been seen at zero; until then the old index is kept on
+ * retired_indexes.
+ */
+typedef struct
+{
+  gint ref_count;
+
+  /* gchar* directory → GPtrArray of GResource* */
+  GHashTable *dirs;
+
+  /* resources that can contain anything, in lookup order */
+  GPtrArray *unindexed;
+
+  /* all resources, in lookup order */
+  GPtrArray *resources;
+} ResourcesIndex;
+
+static ResourcesIndex *resources_index;
+static gint resources_index_readers;
+static GSList *retired_indexes;
+
+static void
+collect_resource_dirs (GvdbTable   *table,
+                       const gchar *dir,
+                       GPtrArray   *dirs)
+{
+  gchar **children;
+  gint i;
+
+  children = gvdb_table_list (table, dir);
+  if (children == NULL)
+    return;
+
+  g_ptr_array_add (dirs, g_strdup (dir));
+
+  for (i = 0; children[i] != NULL; i++)
+    {
+      gsize len = strlen (children[i]);
+
+      if (len > 0 && children[i][len - 1] == '/')
+        {
+          gchar *child_dir = g_strconcat (dir, children[i], NULL);
+          collect_resource_dirs (table, child_dir, dirs);
+          g_free (child_dir);
+        }
+    }
+
+  g_strfreev (children);
+}
+
+static gchar **
+get_resource_dirs (GResource *resource)
+{
+  GPtrArray *dirs;
+
+  dirs = g_ptr_array_new ();
+  collect_resource_dirs (resource->table, "/", dirs);
+
+  if (dirs->len == 0)
+    {
+      g_ptr_array_free (dirs, TRUE);
+      return NULL;
+    }
+
+  g_ptr_array_add (dirs, NULL);
+
+  return (gchar **) g_ptr_array_free (dirs, FALSE);
+}
+
+static void
+resources_index_unref (ResourcesIndex *index)
+{
+  if (g_atomic_int_dec_and_test (&index->ref_count))
+    {
+      g_hash_table_unref (index->dirs);
+      g_ptr_array_unref (index->unindexed);
+      g_ptr_array_unref (index->resources);
+      g_slice_free (ResourcesIndex, index);
+    }
+}
+
+static ResourcesIndex *
+resources_index_new (GList *list)
+{
+  ResourcesIndex *index;
+  GList *l;
+
+  index = g_slice_new (ResourcesIndex);
+  index->ref_count = 1;
+  index->dirs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                       (GDestroyNotify) g_ptr_array_unref);
+  index->unindexed = g_ptr_array_new ();
+  index->resources = g_ptr_array_new_with_free_func ((GDestroyNotify) g_resource_unref);
+
+  /* Create all the directories first so that indexed resources
+   * appearing after an unindexed one still get added behind it.
+   */
+  for (l = list; l != NULL; l = l->next)
+    {
+      RegisteredResource *entry = l->data;
+      gint i;
+
+      if (entry->dirs == NULL)
+        continue;
+
+      for (i = 0; entry->dirs[i] != NULL; i++)
+        if (!g_hash_table_contains (index->dirs, entry->dirs[i]))
+          g_hash_table_insert (index->dirs, g_strdup (entry->dirs[i]), g_ptr_array_new ());
+    }
+
+  for (l = list; l != NULL; l = l->next)
+    {
+      RegisteredResource *entry = l->data;
+
+      g_ptr_array_add (index->resources, g_resource_ref (entry->resource));
+
+      if (entry->dirs != NULL)
+        {
+          gint i;
+
+          for (i = 0; entry->dirs[i] != NULL; i++)
+            g_ptr_array_add (g_hash_table_lookup (index->dirs, entry->dirs[i]), entry->resource);
+        }
+      else
+        {
+          GHashTableIter iter;
+          gpointer value;
+
+          g_hash_table_iter_init (&iter, index->dirs);
+          while (g_hash_table_iter_next (&iter, NULL, &value))
+            g_ptr_array_add (value, entry->resource);
+
+          g_ptr_array_add (index->unindexed, entry->resource);
+        }
+    }
+
+  return index;
+}
+
+/* Must be called with the writer lock held, after any change to
+ * registered_resources.
+ */
+static void
+resources_index_update_unlocked (void)
+{
+  ResourcesIndex *old_index;
+
+  old_index = g_atomic_pointer_get (&resources_index);
+  g_atomic_pointer_set (&resources_index,
+                        registered_resources ? resources_index_new (registered_resources) : NULL);
+
+  if (old_index != NULL)
+    retired_indexes = g_slist_prepend (retired_indexes, old_index);
+
+  /* Everybody who could have seen a retired index has their reference
+   * by now.
+   */
+  if (g_atomic_int_get (&resources_index_readers) == 0)
+    {
+      g_slist_free_full (retired_indexes, (GDestroyNotify) resources_index_unref);
+      retired_indexes = NULL;
+    }
+}
+
+static ResourcesIndex *
+resources_index_get (void)
+{
+  ResourcesIndex *index;
+
+  register_lazy_static_resources ();
+
+  g_atomic_int_inc (&resources_index_readers);
+  index = g_atomic_pointer_get (&resources_index);
+  if (index != NULL)
+    g_atomic_int_inc (&index->ref_count);
+  g_atomic_int_add (&resources_index_readers, -1);
+
+  return index;
+}
+
+/* Returns the resources which may contain @dir (including the trailing
+ * slash), in the order they have to be consulted.
+ */
+static GPtrArray *
+resources_index_lookup_dir (ResourcesIndex *index,
+                            const gchar    *dir)
+{
+  GPtrArray *resources;
+
+  resources = g_hash_table_lookup (index->dirs, dir);
+  if (resources == NULL)
+    resources = index->unindexed;
+
+  return resources;
+}
+
+/* Same as resources_index_lookup_dir(), for the file at @path */
+static GPtrArray *
+resources_index_lookup_path (ResourcesIndex *index,
+                             const gchar    *path)
+{
+  GPtrArray *resources;
+  const gchar *slash;
+  gsize len;
+  gchar *dir;
+
+  /* do_lookup() ignores a trailing slash */
+  len = strlen (path);
+  if (len > 0 && path[len - 1] == '/')
+    len--;
+
+  slash = g_strrstr_len (path, len, "/");
+  if (slash == NULL)
+    return index->unindexed;
+
+  dir = g_strndup (path, slash - path + 1);
+  resources = resources_index_lookup_dir (index, dir);
+  g_free (dir);
+
+  return resources;
+}
+
 static void
 g_resources_register_unlocked (GResource *resource)
 {
-  registered_resources = g_list_prepend (registered_resources, g_resource_ref (resource));
+  RegisteredResource *entry;
+
+  entry = g_slice_new (RegisteredResource);
+  entry->resource = g_resource_ref (resource);
+  entry->dirs = get_resource_dirs (resource);
+
+  registered_resources = g_list_prepend (registered_resources, entry);
 }
 
 static void
 g_resources_unregister_unlocked (GResource *resource)
 {
-  if (g_list_find (registered_resources, resource) == NULL)
+  GList *l;
+
+  for (l = registered_resources; l != NULL; l = l->next)
+    if (((RegisteredResource *) l->data)->resource == resource)
+      break;
+
+  if (l == NULL)
     {
       g_warning ("Tried to remove not registered resource");
     }
   else
     {
-      registered_resources = g_list_remove (registered_resources, resource);
-      g_resource_unref (resource);
+      RegisteredResource *entry = l->data;
+
+      registered_resources = g_list_delete_link (registered_resources, l);
+      g_strfreev (entry->dirs);
+      g_resource_unref (entry->resource);
+      g_slice_free (RegisteredResource, entry);
     }
 }
 
@@ -910,6 +1501,7 @@ g_resources_register (GResource *resource)
 {
   g_rw_lock_writer_lock (&resources_lock);
   g_resources_register_unlocked (resource);
+  resources_index_update_unlocked ();
   g_rw_lock_writer_unlock (&resources_lock);
 }
 
@@ -926,6 +1518,7 @@ g_resources_unregister (GResource *resource)
 {
   g_rw_lock_writer_lock (&resources_lock);
   g_resources_unregister_unlocked (resource);
+  resources_index_update_unlocked ();
   g_rw_lock_writer_unlock (&resources_lock);
 }
 
@@ -952,19 +1545,20 @@ g_resources_open_stream (const gchar           *path,
                          GError               **error)
 {
   GInputStream *res = NULL;
-  GList *l;
+  ResourcesIndex *index;
+  GPtrArray *resources;
   GInputStream *stream;
+  guint i = 0;
 
   if (g_resource_find_overlay (path, open_overlay_stream, &res))
     return res;
 
-  register_lazy_static_resources ();
-
-  g_rw_lock_reader_lock (&resources_lock);
+  index = resources_index_get ();
+  resources = index ? resources_index_lookup_path (index, path) : NULL;
 
-  for (l = registered_resources; l != NULL; l = l->next)
+  for (i = 0; resources != NULL && i < resources->len; i++)
     {
-      GResource *r = l->data;
+      GResource *r = resources->pdata[i];
       GError *my_error = NULL;
 
       stream = g_resource_open_stream (r, path, lookup_flags, &my_error);
@@ -982,12 +1576,13 @@ g_resources_open_stream (const gchar           *path,
         }
     }
 
-  if (l == NULL)
+  if (resources == NULL || i == resources->len)
     g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND,
                  _("The resource at “%s” does not exist"),
                  path);
 
-  g_rw_lock_reader_unlock (&resources_lock);
+  if (index != NULL)
+    resources_index_unref (index);
 
   return res;
 }
@@ -1024,19 +1619,20 @@ g_resources_lookup_data (const gchar           *path,
                          GError               **error)
 {
   GBytes *res = NULL;
-  GList *l;
+  ResourcesIndex *index;
+  GPtrArray *resources;
   GBytes *data;
+  guint i = 0;
 
   if (g_resource_find_overlay (path, get_overlay_bytes, &res))
     return res;
 
-  register_lazy_static_resources ();
-
-  g_rw_lock_reader_lock (&resources_lock);
+  index = resources_index_get ();
+  resources = index ? resources_index_lookup_path (index, path) : NULL;
 
-  for (l = registered_resources; l != NULL; l = l->next)
+  for (i = 0; resources != NULL && i < resources->len; i++)
     {
-      GResource *r = l->data;
+      GResource *r = resources->pdata[i];
       GError *my_error = NULL;
 
       data = g_resource_lookup_data (r, path, lookup_flags, &my_error);
@@ -1054,12 +1650,13 @@ g_resources_lookup_data (const gchar           *path,
         }
     }
 
-  if (l == NULL)
+  if (resources == NULL || i == resources->len)
     g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND,
                  _("The resource at “%s” does not exist"),
                  path);
 
-  g_rw_lock_reader_unlock (&resources_lock);
+  if (index != NULL)
+    resources_index_unref (index);
 
   return res;
 }
@@ -1087,9 +1684,11 @@ g_resources_enumerate_children (const gchar           *path,
                                 GError               **error)
 {
   GHashTable *hash = NULL;
-  GList *l;
+  ResourcesIndex *index;
+  GPtrArray *resources = NULL;
   char **children;
-  int i;
+  guint i;
+  int j;
 
   /* This will enumerate actual files found in overlay directories but
    * will not enumerate the overlays themselves.  For example, if we
@@ -1102,13 +1701,25 @@ g_resources_enumerate_children (const gchar           *path,
    */
   g_resource_find_overlay (path, enumerate_overlay_dir, &hash);
 
-  register_lazy_static_resources ();
+  index = resources_index_get ();
 
-  g_rw_lock_reader_lock (&resources_lock);
+  if (index != NULL && *path != '\0')
+    {
+      gsize path_len = strlen (path);
 
-  for (l = registered_resources; l != NULL; l = l->next)
+      if (path[path_len - 1] != '/')
+        {
+          gchar *path_with_slash = g_strconcat (path, "/", NULL);
+          resources = resources_index_lookup_dir (index, path_with_slash);
+          g_free (path_with_slash);
+        }
+      else
+        resources = resources_index_lookup_dir (index, path);
+    }
+
+  for (i = 0; resources != NULL && i < resources->len; i++)
     {
-      GResource *r = l->data;
+      GResource *r = resources->pdata[i];
 
       children = g_resource_enumerate_children (r, path, 0, NULL);
 
@@ -1118,13 +1729,14 @@ g_resources_enumerate_children (const gchar           *path,
             /* note: keep in sync with same line above */
             hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
-          for (i = 0; children[i] != NULL; i++)
-            g_hash_table_add (hash, children[i]);
+          for (j = 0; children[j] != NULL; j++)
+            g_hash_table_add (hash, children[j]);
           g_free (children);
         }
     }
 
-  g_rw_lock_reader_unlock (&resources_lock);
+  if (index != NULL)
+    resources_index_unref (index);
 
   if (hash == NULL)
     {
@@ -1170,16 +1782,17 @@ g_resources_get_info (const gchar           *path,
                       GError               **error)
 {
   gboolean res = FALSE;
-  GList *l;
+  ResourcesIndex *index;
+  GPtrArray *resources;
   gboolean r_res;
+  guint i = 0;
 
-  register_lazy_static_resources ();
-
-  g_rw_lock_reader_lock (&resources_lock);
+  index = resources_index_get ();
+  resources = index ? resources_index_lookup_path (index, path) : NULL;
 
-  for (l = registered_resources; l != NULL; l = l->next)
+  for (i = 0; resources != NULL && i < resources->len; i++)
     {
-      GResource *r = l->data;
+      GResource *r = resources->pdata[i];
       GError *my_error = NULL;
 
       r_res = g_resource_get_info (r, path, lookup_flags, size, flags, &my_error);
@@ -1197,16 +1810,62 @@ g_resources_get_info (const gchar           *path,
         }
     }
 
-  if (l == NULL)
+  if (resources == NULL || i == resources->len)
     g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND,
                  _("The resource at “%s” does not exist"),
                  path);
 
-  g_rw_lock_reader_unlock (&resources_lock);
+  if (index != NULL)
+    resources_index_unref (index);
 
   return res;
 }
 
+/**
+ * g_resources_prefetch:
+ * @path: A pathname inside the resource
+ * @lookup_flags: A #GResourceLookupFlags
+ * @error: return location for a #GError, or %NULL
+ *
+ * Does the same as g_resource_prefetch() for the file or directory at
+ * @path in all the globally registered resources.
+ *
+ * @lookup_flags controls the behaviour of the lookup.
+ *
+ * Returns: %TRUE if @path was found. %FALSE if there were errors
+ *
+ * Since: 2.54
+ **/
+gboolean
+g_resources_prefetch (const gchar           *path,
+                      GResourceLookupFlags   lookup_flags,
+                      GError               **error)
+{
+  ResourcesIndex *index;
+  gboolean found = FALSE;
+  GArray *ranges;
+  guint i;
+
+  index = resources_index_get ();
+  ranges = g_array_new (FALSE, FALSE, sizeof (PrefetchRange));
+
+  for (i = 0; index != NULL && i < index->resources->len; i++)
+    found |= collect_prefetch_ranges (index->resources->pdata[i], path, ranges);
+
+  if (found)
+    prefetch_ranges (ranges);
+  else
+    g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND,
+                 _("The resource at “%s” does not exist"),
+                 path);
+
+  g_array_unref (ranges);
+  if (index != NULL)
+    resources_index_unref (index);
+
+  return found;
+}
+
 /* This code is to handle registration of resources very early, from a constructor.
  * At that point we'd like to do minimal work, to avoid ordering issues. For instance,
  * we're not allowed to use g_malloc, as the user need to be able to call g_mem_set_vtable
@@ -1231,6 +1890,7 @@ static void
 register_lazy_static_resources_unlocked (void)
 {
   GStaticResource *list;
+  gboolean changed = FALSE;
 
   do
     list = lazy_register_resources;
@@ -1244,11 +1904,15 @@ register_lazy_static_resources_unlocked (void)
         {
           g_resources_register_unlocked (resource);
           g_atomic_pointer_set (&list->resource, resource);
+          changed = TRUE;
         }
       g_bytes_unref (bytes);
 
       list = list->next;
     }
+
+  if (changed)
+    resources_index_update_unlocked ();
 }
 
 static void
@@ -1314,6 +1978,7 @@ g_static_resource_fini (GStaticResource *static_resource)
     {
       g_atomic_pointer_set (&static_resource->resource, NULL);
       g_resources_unregister_unlocked (resource);
+      resources_index_update_unlocked ();
       g_resource_unref (resource);
     }
 
@@ -93,6 +93,11 @@ gboolean      g_resource_get_info            (GResource             *resource,
 					      gsize                 *size,
 					      guint32               *flags,
 					      GError               **error);
+GLIB_AVAILABLE_IN_2_54
+gboolean      g_resource_prefetch            (GResource             *resource,
+					      const char            *path,
+					      GResourceLookupFlags   lookup_flags,
+					      GError               **error);
 
 GLIB_AVAILABLE_IN_2_32
 void          g_resources_register           (GResource             *resource);
@@ -116,6 +121,10 @@ gboolean      g_resources_get_info           (const char            *path,
 					      gsize                 *size,
 					      guint32               *flags,
 					      GError               **error);
+GLIB_AVAILABLE_IN_2_54
+gboolean      g_resources_prefetch           (const char            *path,
+					      GResourceLookupFlags   lookup_flags,
+					      GError               **error);
 
 
 GLIB_AVAILABLE_IN_2_32
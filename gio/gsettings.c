@@ -339,6 +339,16 @@ struct _GSettingsPrivate
   gchar *path;
 
   GDelayedSettingsBackend *delayed;
+
+  /* key name -> GVariant, as returned by g_settings_get_value() */
+  GHashTable *value_cache;
+
+  /* while frozen, changed keys are collected here (as a set of
+   * quarks) and announced in one change-event on thaw
+   */
+  guint freeze_count;
+  GHashTable *pending_keys;
+  gboolean pending_all;
 };
 
 enum
@@ -413,6 +423,62 @@ g_settings_real_writable_change_event (GSettings *settings,
   return FALSE;
 }
 
+/* The value cache is only used by the thread that owns the main
+ * context of @settings.  That is where change notifications are
+ * delivered, so reads can't race with the invalidation.
+ */
+static gboolean
+g_settings_cache_usable (GSettings *settings)
+{
+  return g_main_context_is_owner (settings->priv->main_context);
+}
+
+static void
+g_settings_cache_invalidate (GSettings    *settings,
+                             const GQuark *keys,
+                             gint          n_keys)
+{
+  gint i;
+
+  if (settings->priv->value_cache == NULL)
+    return;
+
+  if (keys == NULL)
+    {
+      g_hash_table_remove_all (settings->priv->value_cache);
+      return;
+    }
+
+  for (i = 0; i < n_keys; i++)
+    g_hash_table_remove (settings->priv->value_cache, g_quark_to_string (keys[i]));
+}
+
+/* All value change notifications for @settings go through here */
+static void
+g_settings_emit_change_event (GSettings    *settings,
+                              const GQuark *keys,
+                              gint          n_keys)
+{
+  gboolean ignore_this;
+  gint i;
+
+  g_settings_cache_invalidate (settings, keys, n_keys);
+
+  if (settings->priv->freeze_count > 0)
+    {
+      if (keys == NULL)
+        settings->priv->pending_all = TRUE;
+      else if (!settings->priv->pending_all)
+        for (i = 0; i < n_keys; i++)
+          g_hash_table_add (settings->priv->pending_keys, GUINT_TO_POINTER (keys[i]));
+
+      return;
+    }
+
+  g_signal_emit (settings, g_settings_signals[SIGNAL_CHANGE_EVENT],
+                 0, keys, n_keys, &ignore_this);
+}
+
 static void
 settings_backend_changed (GObject             *target,
                           GSettingsBackend    *backend,
@@ -420,7 +486,6 @@ settings_backend_changed (GObject             *target,
                           gpointer             origin_tag)
 {
   GSettings *settings = G_SETTINGS (target);
-  gboolean ignore_this;
   gint i;
 
   /* We used to assert here:
@@ -443,8 +508,7 @@ settings_backend_changed (GObject             *target,
       GQuark quark;
 
       quark = g_quark_from_string (key + i);
-      g_signal_emit (settings, g_settings_signals[SIGNAL_CHANGE_EVENT],
-                     0, &quark, 1, &ignore_this);
+      g_settings_emit_change_event (settings, &quark, 1);
     }
 }
 
@@ -455,11 +519,9 @@ settings_backend_path_changed (GObject          *target,
                                gpointer          origin_tag)
 {
   GSettings *settings = G_SETTINGS (target);
-  gboolean ignore_this;
 
   if (g_str_has_prefix (settings->priv->path, path))
-    g_signal_emit (settings, g_settings_signals[SIGNAL_CHANGE_EVENT],
-                   0, NULL, 0, &ignore_this);
+    g_settings_emit_change_event (settings, NULL, 0);
 }
 
 static void
@@ -470,7 +532,6 @@ settings_backend_keys_changed (GObject             *target,
                                const gchar * const *items)
 {
   GSettings *settings = G_SETTINGS (target);
-  gboolean ignore_this;
   gint i;
 
   for (i = 0; settings->priv->path[i] &&
@@ -478,8 +539,11 @@ settings_backend_keys_changed (GObject             *target,
 
   if (path[i] == '\0')
     {
-      GQuark quarks[256];
-      gint j, l = 0;
+      GArray *quarks;
+      gint j;
+
+      /* a whole applied batch of changes can arrive at once */
+      quarks = g_array_new (FALSE, FALSE, sizeof (GQuark));
 
       for (j = 0; items[j]; j++)
          {
@@ -490,17 +554,17 @@ settings_backend_keys_changed (GObject             *target,
 
            if (settings->priv->path[i + k] == '\0' &&
                g_settings_schema_has_key (settings->priv->schema, item + k))
-             quarks[l++] = g_quark_from_string (item + k);
+             {
+               GQuark quark = g_quark_from_string (item + k);
 
-           /* "256 quarks ought to be enough for anybody!"
-            * If this bites you, I'm sorry.  Please file a bug.
-            */
-           g_assert (l < 256);
+               g_array_append_val (quarks, quark);
+             }
          }
 
-      if (l > 0)
-        g_signal_emit (settings, g_settings_signals[SIGNAL_CHANGE_EVENT],
-                       0, quarks, l, &ignore_this);
+      if (quarks->len > 0)
+        g_settings_emit_change_event (settings, (GQuark *) quarks->data, quarks->len);
+
+      g_array_unref (quarks);
     }
 }
 
@@ -517,8 +581,14 @@ settings_backend_writable_changed (GObject          *target,
 
   if (settings->priv->path[i] == '\0' &&
       g_settings_schema_has_key (settings->priv->schema, key + i))
-    g_signal_emit (settings, g_settings_signals[SIGNAL_WRITABLE_CHANGE_EVENT],
-                   0, g_quark_from_string (key + i), &ignore_this);
+    {
+      GQuark quark = g_quark_from_string (key + i);
+
+      /* a locked key reads back differently */
+      g_settings_cache_invalidate (settings, &quark, 1);
+      g_signal_emit (settings, g_settings_signals[SIGNAL_WRITABLE_CHANGE_EVENT],
+                     0, quark, &ignore_this);
+    }
 }
 
 static void
@@ -530,8 +600,11 @@ settings_backend_path_writable_changed (GObject          *target,
   gboolean ignore_this;
 
   if (g_str_has_prefix (settings->priv->path, path))
-    g_signal_emit (settings, g_settings_signals[SIGNAL_WRITABLE_CHANGE_EVENT],
-                   0, (GQuark) 0, &ignore_this);
+    {
+      g_settings_cache_invalidate (settings, NULL, 0);
+      g_signal_emit (settings, g_settings_signals[SIGNAL_WRITABLE_CHANGE_EVENT],
+                     0, (GQuark) 0, &ignore_this);
+    }
 }
 
 /* Properties, Construction, Destruction {{{1 */
@@ -692,6 +765,9 @@ g_settings_finalize (GObject *object)
                                   settings->priv->path);
   g_main_context_unref (settings->priv->main_context);
   g_object_unref (settings->priv->backend);
+  if (settings->priv->value_cache)
+    g_hash_table_unref (settings->priv->value_cache);
+  g_hash_table_unref (settings->priv->pending_keys);
   g_settings_schema_unref (settings->priv->schema);
   g_free (settings->priv->path);
 
@@ -703,6 +779,7 @@ g_settings_init (GSettings *settings)
 {
   settings->priv = g_settings_get_instance_private (settings);
   settings->priv->main_context = g_main_context_ref_thread_default ();
+  settings->priv->pending_keys = g_hash_table_new (NULL, NULL);
 }
 
 static void
@@ -1144,6 +1221,10 @@ g_settings_write_to_backend (GSettings          *settings,
   success = g_settings_backend_write (settings->priv->backend, path, value, NULL);
   g_free (path);
 
+  /* Don't rely on the backend notifying before we next read */
+  if (g_settings_cache_usable (settings) && settings->priv->value_cache != NULL)
+    g_hash_table_remove (settings->priv->value_cache, key->name);
+
   return success;
 }
 
@@ -1196,10 +1277,19 @@ g_settings_get_value (GSettings   *settings,
 {
   GSettingsSchemaKey skey;
   GVariant *value;
+  gboolean use_cache;
 
   g_return_val_if_fail (G_IS_SETTINGS (settings), NULL);
   g_return_val_if_fail (key != NULL, NULL);
 
+  use_cache = g_settings_cache_usable (settings);
+  if (use_cache && settings->priv->value_cache != NULL)
+    {
+      value = g_hash_table_lookup (settings->priv->value_cache, key);
+      if (value != NULL)
+        return g_variant_ref (value);
+    }
+
   g_settings_schema_key_init (&skey, settings->priv->schema, key);
   value = g_settings_read_from_backend (settings, &skey, FALSE, FALSE);
 
@@ -1211,6 +1301,15 @@ g_settings_get_value (GSettings   *settings,
 
   g_settings_schema_key_clear (&skey);
 
+  if (use_cache)
+    {
+      if (settings->priv->value_cache == NULL)
+        settings->priv->value_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                             g_free, (GDestroyNotify) g_variant_unref);
+
+      g_hash_table_insert (settings->priv->value_cache, g_strdup (key), g_variant_ref (value));
+    }
+
   return value;
 }
 
@@ -2281,6 +2380,80 @@ g_settings_apply (GSettings *settings)
     }
 }
 
+/**
+ * g_settings_freeze_changes:
+ * @settings: a #GSettings object
+ *
+ * Holds back change notifications for @settings until
+ * g_settings_thaw_changes() is called, so that a burst of changes,
+ * whether made through @settings or by somebody else, is announced in
+ * a single #GSettings::change-event listing all affected keys (and
+ * then one #GSettings::changed per key) instead of one per write.
+ *
+ * Calls nest; notifications are released when the last freeze is
+ * thawed. Values read while frozen are always up to date: only the
+ * signals are delayed. Writability change notifications are not
+ * affected.
+ *
+ * Since: 2.54
+ */
+void
+g_settings_freeze_changes (GSettings *settings)
+{
+  g_return_if_fail (G_IS_SETTINGS (settings));
+
+  settings->priv->freeze_count++;
+}
+
+/**
+ * g_settings_thaw_changes:
+ * @settings: a #GSettings object
+ *
+ * Reverts the effect of a previous call to g_settings_freeze_changes().
+ * When the last freeze is thawed, everything that changed in between
+ * is announced in one #GSettings::change-event.
+ *
+ * Since: 2.54
+ */
+void
+g_settings_thaw_changes (GSettings *settings)
+{
+  GHashTableIter iter;
+  gpointer quark;
+  GArray *keys;
+
+  g_return_if_fail (G_IS_SETTINGS (settings));
+  g_return_if_fail (settings->priv->freeze_count > 0);
+
+  if (--settings->priv->freeze_count > 0)
+    return;
+
+  if (settings->priv->pending_all)
+    {
+      settings->priv->pending_all = FALSE;
+      g_hash_table_remove_all (settings->priv->pending_keys);
+      g_settings_emit_change_event (settings, NULL, 0);
+      return;
+    }
+
+  if (g_hash_table_size (settings->priv->pending_keys) == 0)
+    return;
+
+  keys = g_array_sized_new (FALSE, FALSE, sizeof (GQuark),
+                            g_hash_table_size (settings->priv->pending_keys));
+  g_hash_table_iter_init (&iter, settings->priv->pending_keys);
+  while (g_hash_table_iter_next (&iter, &quark, NULL))
+    {
+      GQuark q = GPOINTER_TO_UINT (quark);
+
+      g_array_append_val (keys, q);
+    }
+  g_hash_table_remove_all (settings->priv->pending_keys);
+
+  g_settings_emit_change_event (settings, (GQuark *) keys->data, keys->len);
+  g_array_unref (keys);
+}
+
 /**
  * g_settings_revert:
  * @settings: a #GSettings instance
@@ -2348,6 +2521,9 @@ g_settings_reset (GSettings *settings,
 
   path = g_strconcat (settings->priv->path, key, NULL);
   g_settings_backend_reset (settings->priv->backend, path, NULL);
+
+  if (g_settings_cache_usable (settings) && settings->priv->value_cache != NULL)
+    g_hash_table_remove (settings->priv->value_cache, key);
   g_free (path);
 }
 
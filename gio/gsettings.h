@@ -217,6 +217,10 @@ GLIB_AVAILABLE_IN_ALL
 void                    g_settings_revert                               (GSettings          *settings);
 GLIB_AVAILABLE_IN_ALL
 gboolean                g_settings_get_has_unapplied                    (GSettings          *settings);
+GLIB_AVAILABLE_IN_2_54
+void                    g_settings_freeze_changes                       (GSettings          *settings);
+GLIB_AVAILABLE_IN_2_54
+void                    g_settings_thaw_changes                         (GSettings          *settings);
 GLIB_AVAILABLE_IN_ALL
 void                    g_settings_sync                                 (void);
 
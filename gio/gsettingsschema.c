@@ -154,6 +154,11 @@ struct _GSettingsSchema
 
   GSettingsSchema *extends;
 
+  /* interned key name -> parsed GSettingsSchemaKey, see
+   * g_settings_schema_key_init()
+   */
+  GHashTable *keys;
+
   gint ref_count;
 };
 
@@ -187,13 +192,57 @@ struct _GSettingsSchemaSource
   GSettingsSchemaSource *parent;
   gchar *directory;
   GvdbTable *table;
+  gsize table_opened;
   GHashTable **text_tables;
 
+  /* schema id -> GSettingsSchema, for the default sources only: they
+   * live as long as the process, so the schemas can be shared by all
+   * GSettings objects instead of being looked up again for each one
+   */
+  GHashTable *schemas;
+
   gint ref_count;
 };
 
 static GSettingsSchemaSource *schema_sources;
 
+/* protects GSettingsSchemaSource.schemas, GSettingsSchema.keys and
+ * GSettingsSchema.items
+ */
+G_LOCK_DEFINE_STATIC (schema_cache);
+
+/* The default sources open their gschemas.compiled on first use, so
+ * that directories which are never looked at cost no more than a stat().
+ * A file that can't be opened by then acts as an empty source.
+ */
+static GvdbTable *
+g_settings_schema_source_get_table (GSettingsSchemaSource *source)
+{
+  if (g_once_init_enter (&source->table_opened))
+    {
+      gchar *filename;
+
+      filename = g_build_filename (source->directory, "gschemas.compiled", NULL);
+      source->table = gvdb_table_new (filename, TRUE, NULL);
+      g_free (filename);
+
+      g_once_init_leave (&source->table_opened, TRUE);
+    }
+
+  return source->table;
+}
+
+static GvdbTable *
+g_settings_schema_source_get_schema_table (GSettingsSchemaSource *source,
+                                           const gchar           *schema_id)
+{
+  GvdbTable *table;
+
+  table = g_settings_schema_source_get_table (source);
+
+  return table ? gvdb_table_get_table (table, schema_id) : NULL;
+}
+
 /**
  * g_settings_schema_source_ref:
  * @source: a #GSettingsSchemaSource
@@ -230,7 +279,8 @@ g_settings_schema_source_unref (GSettingsSchemaSource *source)
 
       if (source->parent)
         g_settings_schema_source_unref (source->parent);
-      gvdb_table_unref (source->table);
+      if (source->table)
+        gvdb_table_unref (source->table);
       g_free (source->directory);
 
       if (source->text_tables)
@@ -240,6 +290,9 @@ g_settings_schema_source_unref (GSettingsSchemaSource *source)
           g_free (source->text_tables);
         }
 
+      if (source->schemas)
+        g_hash_table_unref (source->schemas);
+
       g_slice_free (GSettingsSchemaSource, source);
     }
 }
@@ -299,11 +352,11 @@ g_settings_schema_source_new_from_directory (const gchar            *directory,
   if (table == NULL)
     return NULL;
 
-  source = g_slice_new (GSettingsSchemaSource);
+  source = g_slice_new0 (GSettingsSchemaSource);
   source->directory = g_strdup (directory);
   source->parent = parent ? g_settings_schema_source_ref (parent) : NULL;
-  source->text_tables = NULL;
   source->table = table;
+  source->table_opened = TRUE;
   source->ref_count = 1;
 
   return source;
@@ -313,12 +366,26 @@ static void
 try_prepend_dir (const gchar *directory)
 {
   GSettingsSchemaSource *source;
+  gchar *filename;
 
-  source = g_settings_schema_source_new_from_directory (directory, schema_sources, TRUE, NULL);
+  filename = g_build_filename (directory, "gschemas.compiled", NULL);
 
-  /* If we successfully created it then prepend it to the global list */
-  if (source != NULL)
-    schema_sources = source;
+  /* If the file is there then prepend it to the global list; it is
+   * only opened when first needed
+   */
+  if (g_file_test (filename, G_FILE_TEST_IS_REGULAR))
+    {
+      source = g_slice_new0 (GSettingsSchemaSource);
+      source->directory = g_strdup (directory);
+      source->parent = schema_sources;
+      source->schemas = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                               (GDestroyNotify) g_settings_schema_unref);
+      source->ref_count = 1;
+
+      schema_sources = source;
+    }
+
+  g_free (filename);
 }
 
 static void
@@ -411,18 +478,29 @@ g_settings_schema_source_lookup (GSettingsSchemaSource *source,
                                  gboolean               recursive)
 {
   GSettingsSchema *schema;
-  GvdbTable *table;
+  GvdbTable *table = NULL;
   const gchar *extends;
 
   g_return_val_if_fail (source != NULL, NULL);
   g_return_val_if_fail (schema_id != NULL, NULL);
 
-  table = gvdb_table_get_table (source->table, schema_id);
+  for (; source; source = recursive ? source->parent : NULL)
+    {
+      if (source->schemas)
+        {
+          G_LOCK (schema_cache);
+          schema = g_hash_table_lookup (source->schemas, schema_id);
+          if (schema)
+            g_settings_schema_ref (schema);
+          G_UNLOCK (schema_cache);
+
+          if (schema)
+            return schema;
+        }
 
-  if (table == NULL && recursive)
-    for (source = source->parent; source; source = source->parent)
-      if ((table = gvdb_table_get_table (source->table, schema_id)))
+      if ((table = g_settings_schema_source_get_schema_table (source, schema_id)))
         break;
+    }
 
   if (table == NULL)
     return NULL;
@@ -446,6 +524,26 @@ g_settings_schema_source_lookup (GSettingsSchemaSource *source,
         g_warning ("Schema '%s' extends schema '%s' but we could not find it", schema_id, extends);
     }
 
+  if (source->schemas)
+    {
+      GSettingsSchema *cached;
+
+      /* somebody else may have been quicker */
+      G_LOCK (schema_cache);
+      cached = g_hash_table_lookup (source->schemas, schema_id);
+      if (cached)
+        g_settings_schema_ref (cached);
+      else
+        g_hash_table_insert (source->schemas, schema->id, g_settings_schema_ref (schema));
+      G_UNLOCK (schema_cache);
+
+      if (cached)
+        {
+          g_settings_schema_unref (schema);
+          schema = cached;
+        }
+    }
+
   return schema;
 }
 
@@ -770,10 +868,12 @@ g_settings_schema_source_list_schemas (GSettingsSchemaSource   *source,
 
   for (s = source; s; s = s->parent)
     {
+      GvdbTable *source_table;
       gchar **list;
       gint i;
 
-      list = gvdb_table_list (s->table, "");
+      source_table = g_settings_schema_source_get_table (s);
+      list = source_table ? gvdb_table_list (source_table, "") : NULL;
 
       /* empty schema cache file? */
       if (list == NULL)
@@ -786,7 +886,7 @@ g_settings_schema_source_list_schemas (GSettingsSchemaSource   *source,
             {
               GvdbTable *table;
 
-              table = gvdb_table_get_table (s->table, list[i]);
+              table = gvdb_table_get_table (source_table, list[i]);
               g_assert (table != NULL);
 
               if (gvdb_table_has_value (table, ".path"))
@@ -921,6 +1021,8 @@ g_settings_schema_unref (GSettingsSchema *schema)
 
       g_settings_schema_source_unref (schema->source);
       gvdb_table_unref (schema->table);
+      if (schema->keys)
+        g_hash_table_unref (schema->keys);
       g_free (schema->items);
       g_free (schema->id);
 
@@ -1101,6 +1203,8 @@ const GQuark *
 g_settings_schema_list (GSettingsSchema *schema,
                         gint            *n_items)
 {
+  G_LOCK (schema_cache);
+
   if (schema->items == NULL)
     {
       GSettingsSchema *s;
@@ -1146,7 +1250,7 @@ g_settings_schema_list (GSettingsSchema *schema,
             child_table = NULL;
 
             for (source = schema->source; source; source = source->parent)
-              if ((child_table = gvdb_table_get_table (source->table, g_variant_get_string (child_schema, NULL))))
+              if ((child_table = g_settings_schema_source_get_schema_table (source, g_variant_get_string (child_schema, NULL))))
                 break;
 
             g_variant_unref (child_schema);
@@ -1197,6 +1301,8 @@ g_settings_schema_list (GSettingsSchema *schema,
       g_hash_table_unref (items);
     }
 
+  G_UNLOCK (schema_cache);
+
   *n_items = schema->n_items;
   return schema->items;
 }
@@ -1227,10 +1333,13 @@ endian_fixup (GVariant **value)
 #endif
 }
 
-void
-g_settings_schema_key_init (GSettingsSchemaKey *key,
-                            GSettingsSchema    *schema,
-                            const gchar        *name)
+/* Parses the description of @name into @key, without taking a reference
+ * on @schema
+ */
+static void
+g_settings_schema_key_parse (GSettingsSchemaKey *key,
+                             GSettingsSchema    *schema,
+                             const gchar        *name)
 {
   GVariantIter *iter;
   GVariant *data;
@@ -1240,7 +1349,7 @@ g_settings_schema_key_init (GSettingsSchemaKey *key,
 
   iter = g_settings_schema_get_value (schema, name);
 
-  key->schema = g_settings_schema_ref (schema);
+  key->schema = schema;
   key->default_value = g_variant_iter_next_value (iter);
   endian_fixup (&key->default_value);
   key->type = g_variant_get_type (key->default_value);
@@ -1287,6 +1396,70 @@ g_settings_schema_key_init (GSettingsSchemaKey *key,
   g_variant_iter_free (iter);
 }
 
+static void
+parsed_key_free (gpointer data)
+{
+  GSettingsSchemaKey *key = data;
+
+  if (key->minimum)
+    g_variant_unref (key->minimum);
+
+  if (key->maximum)
+    g_variant_unref (key->maximum);
+
+  g_variant_unref (key->default_value);
+
+  g_slice_free (GSettingsSchemaKey, key);
+}
+
+/* Keys are initialised very often (for every g_settings_get() and
+ * friends), so each key is only parsed once per schema and then copied.
+ */
+void
+g_settings_schema_key_init (GSettingsSchemaKey *key,
+                            GSettingsSchema    *schema,
+                            const gchar        *name)
+{
+  GSettingsSchemaKey *parsed;
+
+  name = g_intern_string (name);
+
+  G_LOCK (schema_cache);
+  parsed = schema->keys ? g_hash_table_lookup (schema->keys, name) : NULL;
+  G_UNLOCK (schema_cache);
+
+  if (parsed == NULL)
+    {
+      GSettingsSchemaKey *other;
+
+      parsed = g_slice_new (GSettingsSchemaKey);
+      g_settings_schema_key_parse (parsed, schema, name);
+
+      G_LOCK (schema_cache);
+      if (schema->keys == NULL)
+        schema->keys = g_hash_table_new_full (NULL, NULL, NULL, parsed_key_free);
+
+      other = g_hash_table_lookup (schema->keys, name);
+      if (other == NULL)
+        g_hash_table_insert (schema->keys, (gpointer) name, parsed);
+      G_UNLOCK (schema_cache);
+
+      if (other != NULL)
+        {
+          parsed_key_free (parsed);
+          parsed = other;
+        }
+    }
+
+  *key = *parsed;
+  key->schema = g_settings_schema_ref (schema);
+  g_variant_ref (key->default_value);
+  if (key->minimum)
+    g_variant_ref (key->minimum);
+  if (key->maximum)
+    g_variant_ref (key->maximum);
+}
+
 void
 g_settings_schema_key_clear (GSettingsSchemaKey *key)
 {
@@ -65,6 +65,7 @@
 #include "gsocketcontrolmessage.h"
 #include "gcredentials.h"
 #include "gcredentialsprivate.h"
+#include "gioprivate.h"
 #include "glibintl.h"
 
 #ifdef G_OS_WIN32
@@ -222,7 +223,13 @@ enum
   PROP_TTL,
   PROP_BROADCAST,
   PROP_MULTICAST_LOOPBACK,
-  PROP_MULTICAST_TTL
+  PROP_MULTICAST_TTL,
+  PROP_TCP_NODELAY,
+  PROP_TCP_QUICKACK,
+  PROP_TCP_NOTSENT_LOWAT,
+  PROP_BUSY_POLL,
+  PROP_SEND_BUFFER_SIZE,
+  PROP_RECEIVE_BUFFER_SIZE
 };
 
 /* Size of the receiver cache for g_socket_receive_from() */
@@ -744,6 +751,30 @@ g_socket_get_property (GObject    *object,
 	g_value_set_uint (value, g_socket_get_multicast_ttl (socket));
 	break;
 
+      case PROP_TCP_NODELAY:
+	g_value_set_boolean (value, g_socket_get_tcp_nodelay (socket));
+	break;
+
+      case PROP_TCP_QUICKACK:
+	g_value_set_boolean (value, g_socket_get_tcp_quickack (socket));
+	break;
+
+      case PROP_TCP_NOTSENT_LOWAT:
+	g_value_set_uint (value, g_socket_get_tcp_notsent_lowat (socket));
+	break;
+
+      case PROP_BUSY_POLL:
+	g_value_set_uint (value, g_socket_get_busy_poll (socket));
+	break;
+
+      case PROP_SEND_BUFFER_SIZE:
+	g_value_set_uint (value, g_socket_get_send_buffer_size (socket));
+	break;
+
+      case PROP_RECEIVE_BUFFER_SIZE:
+	g_value_set_uint (value, g_socket_get_receive_buffer_size (socket));
+	break;
+
       default:
 	G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -807,6 +838,30 @@ g_socket_set_property (GObject      *object,
 	g_socket_set_multicast_ttl (socket, g_value_get_uint (value));
 	break;
 
+      case PROP_TCP_NODELAY:
+	g_socket_set_tcp_nodelay (socket, g_value_get_boolean (value));
+	break;
+
+      case PROP_TCP_QUICKACK:
+	g_socket_set_tcp_quickack (socket, g_value_get_boolean (value));
+	break;
+
+      case PROP_TCP_NOTSENT_LOWAT:
+	g_socket_set_tcp_notsent_lowat (socket, g_value_get_uint (value));
+	break;
+
+      case PROP_BUSY_POLL:
+	g_socket_set_busy_poll (socket, g_value_get_uint (value));
+	break;
+
+      case PROP_SEND_BUFFER_SIZE:
+	g_socket_set_send_buffer_size (socket, g_value_get_uint (value));
+	break;
+
+      case PROP_RECEIVE_BUFFER_SIZE:
+	g_socket_set_receive_buffer_size (socket, g_value_get_uint (value));
+	break;
+
       default:
 	G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -1034,6 +1089,103 @@ g_socket_class_init (GSocketClass *klass)
 						      0, G_MAXUINT, 1,
 						      G_PARAM_READWRITE |
 						      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocket:tcp-nodelay:
+   *
+   * Whether Nagle's algorithm is disabled, so that small writes are
+   * sent immediately. See g_socket_set_tcp_nodelay().
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class, PROP_TCP_NODELAY,
+				   g_param_spec_boolean ("tcp-nodelay",
+							 P_("TCP no delay"),
+							 P_("Whether small writes are sent immediately"),
+							 FALSE,
+							 G_PARAM_READWRITE |
+							 G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocket:tcp-quickack:
+   *
+   * Whether received data is acknowledged immediately. See
+   * g_socket_set_tcp_quickack().
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class, PROP_TCP_QUICKACK,
+				   g_param_spec_boolean ("tcp-quickack",
+							 P_("TCP quick ACK"),
+							 P_("Whether received data is acknowledged immediately"),
+							 FALSE,
+							 G_PARAM_READWRITE |
+							 G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocket:tcp-notsent-lowat:
+   *
+   * The maximum number of bytes of unsent data for the socket to poll
+   * writable, or 0 for the system default. See
+   * g_socket_set_tcp_notsent_lowat().
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class, PROP_TCP_NOTSENT_LOWAT,
+				   g_param_spec_uint ("tcp-notsent-lowat",
+						      P_("TCP not sent low-water mark"),
+						      P_("The limit on unsent data for the socket to be writable"),
+						      0, G_MAXUINT, 0,
+						      G_PARAM_READWRITE |
+						      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocket:busy-poll:
+   *
+   * The time in microseconds to busy-poll for received packets, or 0
+   * to not busy-poll. See g_socket_set_busy_poll().
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class, PROP_BUSY_POLL,
+				   g_param_spec_uint ("busy-poll",
+						      P_("Busy poll"),
+						      P_("The time in microseconds to busy-poll for received packets"),
+						      0, G_MAXUINT, 0,
+						      G_PARAM_READWRITE |
+						      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocket:send-buffer-size:
+   *
+   * The size of the kernel send buffer in bytes. See
+   * g_socket_set_send_buffer_size().
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class, PROP_SEND_BUFFER_SIZE,
+				   g_param_spec_uint ("send-buffer-size",
+						      P_("Send buffer size"),
+						      P_("The size of the kernel send buffer"),
+						      0, G_MAXUINT, 0,
+						      G_PARAM_READWRITE |
+						      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocket:receive-buffer-size:
+   *
+   * The size of the kernel receive buffer in bytes. See
+   * g_socket_set_receive_buffer_size().
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class, PROP_RECEIVE_BUFFER_SIZE,
+				   g_param_spec_uint ("receive-buffer-size",
+						      P_("Receive buffer size"),
+						      P_("The size of the kernel receive buffer"),
+						      0, G_MAXUINT, 0,
+						      G_PARAM_READWRITE |
+						      G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -1825,6 +1977,320 @@ g_socket_set_multicast_ttl (GSocket  *socket,
   g_object_notify (G_OBJECT (socket), "multicast-ttl");
 }
 
+static gint
+get_int_option (GSocket     *socket,
+                gint         level,
+                gint         optname,
+                const gchar *name)
+{
+  GError *error = NULL;
+  gint value;
+
+  if (!g_socket_get_option (socket, level, optname, &value, &error))
+    {
+      g_warning ("error getting %s: %s", name, error->message);
+      g_error_free (error);
+      return 0;
+    }
+
+  return value;
+}
+
+static void
+set_int_option (GSocket     *socket,
+                gint         level,
+                gint         optname,
+                gint         value,
+                const gchar *name)
+{
+  GError *error = NULL;
+
+  if (!g_socket_set_option (socket, level, optname, value, &error))
+    {
+      g_warning ("error setting %s: %s", name, error->message);
+      g_error_free (error);
+      return;
+    }
+
+  g_object_notify (G_OBJECT (socket), name);
+}
+
+/**
+ * g_socket_get_tcp_nodelay:
+ * @socket: a #GSocket.
+ *
+ * Gets whether Nagle's algorithm is disabled on @socket; see
+ * g_socket_set_tcp_nodelay().
+ *
+ * Returns: %TRUE if small writes are sent immediately
+ *
+ * Since: 2.54
+ */
+gboolean
+g_socket_get_tcp_nodelay (GSocket *socket)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), FALSE);
+
+  return !!get_int_option (socket, IPPROTO_TCP, TCP_NODELAY, "tcp-nodelay");
+}
+
+/**
+ * g_socket_set_tcp_nodelay:
+ * @socket: a TCP #GSocket.
+ * @nodelay: whether to disable Nagle's algorithm
+ *
+ * Sets whether data written to @socket is sent immediately, even if
+ * it only fills a small packet and earlier data has not been
+ * acknowledged yet (the `TCP_NODELAY` option). By default, small
+ * writes are coalesced, which saves bandwidth but adds latency to
+ * request/response protocols.
+ *
+ * Since: 2.54
+ */
+void
+g_socket_set_tcp_nodelay (GSocket  *socket,
+                          gboolean  nodelay)
+{
+  g_return_if_fail (G_IS_SOCKET (socket));
+
+  set_int_option (socket, IPPROTO_TCP, TCP_NODELAY, !!nodelay, "tcp-nodelay");
+}
+
+/**
+ * g_socket_get_tcp_quickack:
+ * @socket: a #GSocket.
+ *
+ * Gets whether @socket is currently in quick acknowledgement mode;
+ * see g_socket_set_tcp_quickack().
+ *
+ * Returns: %TRUE if received data is acknowledged immediately
+ *
+ * Since: 2.54
+ */
+gboolean
+g_socket_get_tcp_quickack (GSocket *socket)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), FALSE);
+
+#ifdef TCP_QUICKACK
+  return !!get_int_option (socket, IPPROTO_TCP, TCP_QUICKACK, "tcp-quickack");
+#else
+  return FALSE;
+#endif
+}
+
+/**
+ * g_socket_set_tcp_quickack:
+ * @socket: a TCP #GSocket.
+ * @quickack: whether to acknowledge received data immediately
+ *
+ * Sets whether @socket acknowledges received data immediately rather
+ * than delaying the acknowledgement in the hope of sending it along
+ * with some data (the `TCP_QUICKACK` option).
+ *
+ * This is not permanent: the kernel switches back to delayed
+ * acknowledgements according to its own heuristics, so protocols that
+ * depend on it typically set it again after each receive.
+ *
+ * This is only supported on Linux; elsewhere it does nothing.
+ *
+ * Since: 2.54
+ */
+void
+g_socket_set_tcp_quickack (GSocket  *socket,
+                           gboolean  quickack)
+{
+  g_return_if_fail (G_IS_SOCKET (socket));
+
+#ifdef TCP_QUICKACK
+  set_int_option (socket, IPPROTO_TCP, TCP_QUICKACK, !!quickack, "tcp-quickack");
+#endif
+}
+
+/**
+ * g_socket_get_tcp_notsent_lowat:
+ * @socket: a #GSocket.
+ *
+ * Gets the limit on unsent data set with
+ * g_socket_set_tcp_notsent_lowat().
+ *
+ * Returns: the limit in bytes, or 0 if the system default is used
+ *
+ * Since: 2.54
+ */
+guint
+g_socket_get_tcp_notsent_lowat (GSocket *socket)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), 0);
+
+#ifdef TCP_NOTSENT_LOWAT
+  return get_int_option (socket, IPPROTO_TCP, TCP_NOTSENT_LOWAT, "tcp-notsent-lowat");
+#else
+  return 0;
+#endif
+}
+
+/**
+ * g_socket_set_tcp_notsent_lowat:
+ * @socket: a TCP #GSocket.
+ * @lowat: the limit in bytes, or 0 for the system default
+ *
+ * Limits the amount of data written to @socket that the kernel holds
+ * without having sent it yet (the `TCP_NOTSENT_LOWAT` option): the
+ * socket only polls writable while less than @lowat bytes are waiting
+ * to be sent. This keeps the send buffer from filling up with data
+ * that could still have been replaced by more urgent data, without
+ * limiting the amount of data in flight. The system default is
+ * normally to have no limit.
+ *
+ * This is only supported on Linux and macOS; elsewhere it does
+ * nothing.
+ *
+ * Since: 2.54
+ */
+void
+g_socket_set_tcp_notsent_lowat (GSocket *socket,
+                                guint    lowat)
+{
+  g_return_if_fail (G_IS_SOCKET (socket));
+
+#ifdef TCP_NOTSENT_LOWAT
+  set_int_option (socket, IPPROTO_TCP, TCP_NOTSENT_LOWAT,
+                  MIN (lowat, G_MAXINT), "tcp-notsent-lowat");
+#endif
+}
+
+/**
+ * g_socket_get_busy_poll:
+ * @socket: a #GSocket.
+ *
+ * Gets the busy polling timeout set with g_socket_set_busy_poll().
+ *
+ * Returns: the timeout in microseconds, or 0 if busy polling is disabled
+ *
+ * Since: 2.54
+ */
+guint
+g_socket_get_busy_poll (GSocket *socket)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), 0);
+
+#ifdef SO_BUSY_POLL
+  return get_int_option (socket, SOL_SOCKET, SO_BUSY_POLL, "busy-poll");
+#else
+  return 0;
+#endif
+}
+
+/**
+ * g_socket_set_busy_poll:
+ * @socket: a #GSocket.
+ * @usec: the busy polling timeout in microseconds, or 0 to disable it
+ *
+ * Sets how long a blocking receive on @socket busy-polls the network
+ * device for new packets before sleeping (the `SO_BUSY_POLL`
+ * option). This trades CPU time for lower receive latency, and needs
+ * a network driver that supports it.
+ *
+ * This is only supported on Linux; elsewhere it does nothing.
+ *
+ * Since: 2.54
+ */
+void
+g_socket_set_busy_poll (GSocket *socket,
+                        guint    usec)
+{
+  g_return_if_fail (G_IS_SOCKET (socket));
+
+#ifdef SO_BUSY_POLL
+  set_int_option (socket, SOL_SOCKET, SO_BUSY_POLL, MIN (usec, G_MAXINT), "busy-poll");
+#endif
+}
+
+/**
+ * g_socket_get_send_buffer_size:
+ * @socket: a #GSocket.
+ *
+ * Gets the size of the kernel send buffer of @socket; see
+ * g_socket_set_send_buffer_size().
+ *
+ * Returns: the send buffer size in bytes
+ *
+ * Since: 2.54
+ */
+guint
+g_socket_get_send_buffer_size (GSocket *socket)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), 0);
+
+  return get_int_option (socket, SOL_SOCKET, SO_SNDBUF, "send-buffer-size");
+}
+
+/**
+ * g_socket_set_send_buffer_size:
+ * @socket: a #GSocket.
+ * @size: the send buffer size in bytes
+ *
+ * Sets the size of the kernel send buffer of @socket (the `SO_SNDBUF`
+ * option). Setting it disables the automatic tuning of the buffer
+ * size that some platforms do.
+ *
+ * The kernel may adjust @size: Linux, for example, doubles it to make
+ * room for its own bookkeeping, and g_socket_get_send_buffer_size()
+ * returns the adjusted value.
+ *
+ * Since: 2.54
+ */
+void
+g_socket_set_send_buffer_size (GSocket *socket,
+                               guint    size)
+{
+  g_return_if_fail (G_IS_SOCKET (socket));
+
+  set_int_option (socket, SOL_SOCKET, SO_SNDBUF, MIN (size, G_MAXINT), "send-buffer-size");
+}
+
+/**
+ * g_socket_get_receive_buffer_size:
+ * @socket: a #GSocket.
+ *
+ * Gets the size of the kernel receive buffer of @socket; see
+ * g_socket_set_receive_buffer_size().
+ *
+ * Returns: the receive buffer size in bytes
+ *
+ * Since: 2.54
+ */
+guint
+g_socket_get_receive_buffer_size (GSocket *socket)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), 0);
+
+  return get_int_option (socket, SOL_SOCKET, SO_RCVBUF, "receive-buffer-size");
+}
+
+/**
+ * g_socket_set_receive_buffer_size:
+ * @socket: a #GSocket.
+ * @size: the receive buffer size in bytes
+ *
+ * Sets the size of the kernel receive buffer of @socket (the
+ * `SO_RCVBUF` option), which also bounds the TCP receive window. As
+ * with g_socket_set_send_buffer_size(), this disables automatic
+ * tuning and the kernel may adjust the value. For a TCP socket that is
+ * going to use a large window, set it before connecting or listening.
+ *
+ * Since: 2.54
+ */
+void
+g_socket_set_receive_buffer_size (GSocket *socket,
+                                  guint    size)
+{
+  g_return_if_fail (G_IS_SOCKET (socket));
+
+  set_int_option (socket, SOL_SOCKET, SO_RCVBUF, MIN (size, G_MAXINT), "receive-buffer-size");
+}
+
 /**
  * g_socket_get_family:
  * @socket: a #GSocket.
@@ -2128,7 +2594,11 @@ g_socket_bind (GSocket         *socket,
    */
   g_socket_set_option (socket, SOL_SOCKET, SO_REUSEADDR, so_reuseaddr, NULL);
 #ifdef SO_REUSEPORT
-  g_socket_set_option (socket, SOL_SOCKET, SO_REUSEPORT, so_reuseport, NULL);
+  /* SO_REUSEPORT is off by default; don't turn it off if the caller
+   * asked for it explicitly, e.g. to share a TCP port between threads.
+   */
+  if (so_reuseport)
+    g_socket_set_option (socket, SOL_SOCKET, SO_REUSEPORT, TRUE, NULL);
 #endif
 
   if (bind (socket->priv->fd, (struct sockaddr *) &addr,
@@ -2408,38 +2878,18 @@ g_socket_speaks_ipv4 (GSocket *socket)
     }
 }
 
-/**
- * g_socket_accept:
- * @socket: a #GSocket.
- * @cancellable: (nullable): a %GCancellable or %NULL
- * @error: #GError for error reporting, or %NULL to ignore.
- *
- * Accept incoming connections on a connection-based socket. This removes
- * the first outstanding connection request from the listening socket and
- * creates a #GSocket object for it.
- *
- * The @socket must be bound to a local address with g_socket_bind() and
- * must be listening for incoming connections (g_socket_listen()).
- *
- * If there are no outstanding connections then the operation will block
- * or return %G_IO_ERROR_WOULD_BLOCK if non-blocking I/O is enabled.
- * To be notified of an incoming connection, wait for the %G_IO_IN condition.
- *
- * Returns: (transfer full): a new #GSocket, or %NULL on error.
- *     Free the returned object with g_object_unref().
- *
- * Since: 2.22
- */
-GSocket *
-g_socket_accept (GSocket       *socket,
-		 GCancellable  *cancellable,
-		 GError       **error)
+static GSocket *
+accept_internal (GSocket       *socket,
+                 gboolean       blocking,
+                 GCancellable  *cancellable,
+                 GError       **error)
 {
   GSocket *new_socket;
+#ifndef G_OS_WIN32
+  gboolean cloexec = FALSE;
+#endif
   gint ret;
 
-  g_return_val_if_fail (G_IS_SOCKET (socket), NULL);
-
   if (!check_socket (socket, error))
     return NULL;
 
@@ -2450,7 +2900,16 @@ g_socket_accept (GSocket       *socket,
     {
       win32_unset_event_mask (socket, FD_ACCEPT);
 
-      if ((ret = accept (socket->priv->fd, NULL, 0)) < 0)
+#if defined(HAVE_ACCEPT4) && defined(SOCK_CLOEXEC)
+      ret = accept4 (socket->priv->fd, NULL, 0, SOCK_CLOEXEC | SOCK_NONBLOCK);
+      if (ret >= 0)
+        cloexec = TRUE;
+      /* It's possible that libc has accept4() but the kernel does not */
+      else if (errno == ENOSYS || errno == EINVAL)
+#endif
+        ret = accept (socket->priv->fd, NULL, 0);
+
+      if (ret < 0)
 	{
 	  int errsv = get_socket_errno ();
 
@@ -2464,7 +2923,7 @@ g_socket_accept (GSocket       *socket,
               errsv == EAGAIN)
 #endif
             {
-              if (socket->priv->blocking)
+              if (blocking)
                 {
                   if (!g_socket_condition_wait (socket,
                                                 G_IO_IN, cancellable, error))
@@ -2493,7 +2952,7 @@ g_socket_accept (GSocket       *socket,
     /* We always want to set close-on-exec to protect users. If you
        need to so some weird inheritance to exec you can re-enable this
        using lower level hacks with g_socket_get_fd(). */
-    flags = fcntl (ret, F_GETFD, 0);
+    flags = cloexec ? FD_CLOEXEC : fcntl (ret, F_GETFD, 0);
     if (flags != -1 &&
 	(flags & FD_CLOEXEC) == 0)
       {
@@ -2518,6 +2977,59 @@ g_socket_accept (GSocket       *socket,
   return new_socket;
 }
 
+/**
+ * g_socket_accept:
+ * @socket: a #GSocket.
+ * @cancellable: (nullable): a %GCancellable or %NULL
+ * @error: #GError for error reporting, or %NULL to ignore.
+ *
+ * Accept incoming connections on a connection-based socket. This removes
+ * the first outstanding connection request from the listening socket and
+ * creates a #GSocket object for it.
+ *
+ * The @socket must be bound to a local address with g_socket_bind() and
+ * must be listening for incoming connections (g_socket_listen()).
+ *
+ * If there are no outstanding connections then the operation will block
+ * or return %G_IO_ERROR_WOULD_BLOCK if non-blocking I/O is enabled.
+ * To be notified of an incoming connection, wait for the %G_IO_IN condition.
+ *
+ * Returns: (transfer full): a new #GSocket, or %NULL on error.
+ *     Free the returned object with g_object_unref().
+ *
+ * Since: 2.22
+ */
+GSocket *
+g_socket_accept (GSocket       *socket,
+		 GCancellable  *cancellable,
+		 GError       **error)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), NULL);
+
+  return accept_internal (socket, socket->priv->blocking, cancellable, error);
+}
+
+/*
+ * g_socket_accept_nonblocking:
+ * @socket: a listening #GSocket.
+ * @error: #GError for error reporting, or %NULL to ignore.
+ *
+ * Like g_socket_accept(), but fails with %G_IO_ERROR_WOULD_BLOCK when
+ * there are no outstanding connections, whatever the blocking mode of
+ * @socket. This is used to drain the listen queue after @socket polled
+ * ready.
+ *
+ * Returns: (transfer full): a new #GSocket, or %NULL on error.
+ */
+GSocket *
+g_socket_accept_nonblocking (GSocket  *socket,
+                             GError  **error)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), NULL);
+
+  return accept_internal (socket, FALSE, NULL, error);
+}
+
 /**
  * g_socket_connect:
  * @socket: a #GSocket.
@@ -3821,9 +4333,10 @@ g_socket_condition_wait (GSocket       *socket,
  * on @socket. If the condition is met, %TRUE is returned.
  *
  * If @cancellable is cancelled before the condition is met, or if
- * @timeout (or the socket's #GSocket:timeout) is reached before the
- * condition is met, then %FALSE is returned and @error, if non-%NULL,
- * is set to the appropriate value (%G_IO_ERROR_CANCELLED or
+ * @timeout (or the socket's #GSocket:timeout, or the deadline of
+ * @cancellable; see g_cancellable_new_with_deadline()) is reached
+ * before the condition is met, then %FALSE is returned and @error, if
+ * non-%NULL, is set to the appropriate value (%G_IO_ERROR_CANCELLED or
  * %G_IO_ERROR_TIMED_OUT).
  *
  * If you don't want a timeout, use g_socket_condition_wait().
@@ -3861,6 +4374,8 @@ g_socket_condition_timed_wait (GSocket       *socket,
   else if (timeout != -1)
     timeout = timeout / 1000;
 
+  timeout = g_cancellable_get_poll_timeout (cancellable, timeout);
+
   start_time = g_get_monotonic_time ();
 
 #ifdef G_OS_WIN32
@@ -4298,6 +4813,39 @@ g_socket_send_message (GSocket                *socket,
                                              cancellable, error);
 }
 
+/*< internal >
+ * g_socket_send_vectors_with_blocking:
+ * @socket: a #GSocket
+ * @vectors: (array length=num_vectors): an array of #GOutputVector structs
+ * @num_vectors: the number of elements in @vectors
+ * @blocking: whether to do blocking or non-blocking I/O
+ * @cancellable: (nullable): a %GCancellable or %NULL
+ * @error: #GError for error reporting, or %NULL to ignore.
+ *
+ * Gathers @vectors into a single send on @socket's default receiver,
+ * like g_socket_send_message() without an address or control messages,
+ * except that the choice of blocking or non-blocking behavior is
+ * determined by the @blocking argument rather than by @socket's
+ * properties.
+ *
+ * Returns: Number of bytes written (which may be less than the sum of
+ * the vector sizes), or -1 on error
+ */
+gssize
+g_socket_send_vectors_with_blocking (GSocket              *socket,
+                                     const GOutputVector  *vectors,
+                                     gint                  num_vectors,
+                                     gboolean              blocking,
+                                     GCancellable         *cancellable,
+                                     GError              **error)
+{
+  return g_socket_send_message_with_timeout (socket, NULL,
+                                             (GOutputVector *) vectors, num_vectors,
+                                             NULL, 0, 0,
+                                             blocking ? -1 : 0,
+                                             cancellable, error);
+}
+
 static gssize
 g_socket_send_message_with_timeout (GSocket                *socket,
                                     GSocketAddress         *address,
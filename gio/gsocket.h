@@ -138,6 +138,36 @@ guint                  g_socket_get_multicast_ttl       (GSocket
 GLIB_AVAILABLE_IN_2_32
 void                   g_socket_set_multicast_ttl       (GSocket                 *socket,
                                                          guint                    ttl);
+GLIB_AVAILABLE_IN_2_54
+gboolean               g_socket_get_tcp_nodelay         (GSocket                 *socket);
+GLIB_AVAILABLE_IN_2_54
+void                   g_socket_set_tcp_nodelay         (GSocket                 *socket,
+                                                         gboolean                 nodelay);
+GLIB_AVAILABLE_IN_2_54
+gboolean               g_socket_get_tcp_quickack        (GSocket                 *socket);
+GLIB_AVAILABLE_IN_2_54
+void                   g_socket_set_tcp_quickack        (GSocket                 *socket,
+                                                         gboolean                 quickack);
+GLIB_AVAILABLE_IN_2_54
+guint                  g_socket_get_tcp_notsent_lowat   (GSocket                 *socket);
+GLIB_AVAILABLE_IN_2_54
+void                   g_socket_set_tcp_notsent_lowat   (GSocket                 *socket,
+                                                         guint                    lowat);
+GLIB_AVAILABLE_IN_2_54
+guint                  g_socket_get_busy_poll           (GSocket                 *socket);
+GLIB_AVAILABLE_IN_2_54
+void                   g_socket_set_busy_poll           (GSocket                 *socket,
+                                                         guint                    usec);
+GLIB_AVAILABLE_IN_2_54
+guint                  g_socket_get_send_buffer_size    (GSocket                 *socket);
+GLIB_AVAILABLE_IN_2_54
+void                   g_socket_set_send_buffer_size    (GSocket                 *socket,
+                                                         guint                    size);
+GLIB_AVAILABLE_IN_2_54
+guint                  g_socket_get_receive_buffer_size (GSocket                 *socket);
+GLIB_AVAILABLE_IN_2_54
+void                   g_socket_set_receive_buffer_size (GSocket                 *socket,
+                                                         guint                    size);
 GLIB_AVAILABLE_IN_ALL
 gboolean               g_socket_is_connected            (GSocket                 *socket);
 GLIB_AVAILABLE_IN_ALL
@@ -46,7 +46,9 @@
 #include <gio/gtcpwrapperconnection.h>
 #include <gio/gtlscertificate.h>
 #include <gio/gtlsclientconnection.h>
+#include <gio/gtlssessioncache.h>
 #include <gio/ginetaddress.h>
+#include "gnetworking.h"
 #include "glibintl.h"
 
 
@@ -93,9 +95,16 @@ enum
   PROP_ENABLE_PROXY,
   PROP_TLS,
   PROP_TLS_VALIDATION_FLAGS,
-  PROP_PROXY_RESOLVER
+  PROP_PROXY_RESOLVER,
+  PROP_CONNECTION_ATTEMPT_DELAY,
+  PROP_TCP_NODELAY,
+  PROP_TCP_FAST_OPEN,
+  PROP_TLS_SESSION_CACHE
 };
 
+/* The "Connection Attempt Delay" recommended by RFC 8305 */
+#define DEFAULT_CONNECTION_ATTEMPT_DELAY 250
+
 struct _GSocketClientPrivate
 {
   GSocketFamily family;
@@ -108,6 +117,10 @@ struct _GSocketClientPrivate
   gboolean tls;
   GTlsCertificateFlags tls_validation_flags;
   GProxyResolver *proxy_resolver;
+  guint connection_attempt_delay;
+  gboolean tcp_nodelay;
+  gboolean tcp_fast_open;
+  GTlsSessionCache *tls_session_cache;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GSocketClient, g_socket_client, G_TYPE_OBJECT)
@@ -149,6 +162,20 @@ create_socket (GSocketClient  *client,
   if (client->priv->timeout)
     g_socket_set_timeout (socket, client->priv->timeout);
 
+  if (client->priv->type == G_SOCKET_TYPE_STREAM &&
+      (family == G_SOCKET_FAMILY_IPV4 || family == G_SOCKET_FAMILY_IPV6))
+    {
+      if (client->priv->tcp_nodelay)
+        g_socket_set_tcp_nodelay (socket, TRUE);
+
+#ifdef TCP_FASTOPEN_CONNECT
+      /* Best effort: with an older kernel this fails, and we just do a
+       * regular connect */
+      if (client->priv->tcp_fast_open)
+        g_socket_set_option (socket, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, TRUE, NULL);
+#endif
+    }
+
   return socket;
 }
 
@@ -229,6 +256,7 @@ g_socket_client_finalize (GObject *object)
 
   g_clear_object (&client->priv->local_address);
   g_clear_object (&client->priv->proxy_resolver);
+  g_clear_object (&client->priv->tls_session_cache);
 
   G_OBJECT_CLASS (g_socket_client_parent_class)->finalize (object);
 
@@ -281,6 +309,22 @@ g_socket_client_get_property (GObject    *object,
 	g_value_set_object (value, g_socket_client_get_proxy_resolver (client));
 	break;
 
+      case PROP_CONNECTION_ATTEMPT_DELAY:
+	g_value_set_uint (value, client->priv->connection_attempt_delay);
+	break;
+
+      case PROP_TCP_NODELAY:
+	g_value_set_boolean (value, client->priv->tcp_nodelay);
+	break;
+
+      case PROP_TCP_FAST_OPEN:
+	g_value_set_boolean (value, client->priv->tcp_fast_open);
+	break;
+
+      case PROP_TLS_SESSION_CACHE:
+	g_value_set_object (value, client->priv->tls_session_cache);
+	break;
+
       default:
 	G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -332,6 +376,22 @@ g_socket_client_set_property (GObject      *object,
       g_socket_client_set_proxy_resolver (client, g_value_get_object (value));
       break;
 
+    case PROP_CONNECTION_ATTEMPT_DELAY:
+      g_socket_client_set_connection_attempt_delay (client, g_value_get_uint (value));
+      break;
+
+    case PROP_TCP_NODELAY:
+      g_socket_client_set_tcp_nodelay (client, g_value_get_boolean (value));
+      break;
+
+    case PROP_TCP_FAST_OPEN:
+      g_socket_client_set_tcp_fast_open (client, g_value_get_boolean (value));
+      break;
+
+    case PROP_TLS_SESSION_CACHE:
+      g_socket_client_set_tls_session_cache (client, g_value_get_object (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -560,6 +620,213 @@ g_socket_client_set_timeout (GSocketClient *client,
   g_object_notify (G_OBJECT (client), "timeout");
 }
 
+/**
+ * g_socket_client_get_connection_attempt_delay:
+ * @client: a #GSocketClient
+ *
+ * Gets the delay between concurrent connection attempts made by
+ * @client.
+ *
+ * See g_socket_client_set_connection_attempt_delay() for details.
+ *
+ * Returns: the delay in milliseconds
+ *
+ * Since: 2.54
+ */
+guint
+g_socket_client_get_connection_attempt_delay (GSocketClient *client)
+{
+  g_return_val_if_fail (G_IS_SOCKET_CLIENT (client), 0);
+
+  return client->priv->connection_attempt_delay;
+}
+
+/**
+ * g_socket_client_set_connection_attempt_delay:
+ * @client: a #GSocketClient
+ * @delay: the delay in milliseconds
+ *
+ * Sets how long the asynchronous connect functions such as
+ * g_socket_client_connect_async() wait for a connection attempt to
+ * one address to succeed before starting another attempt to the
+ * next address in parallel, as described in RFC 8305 ("Happy
+ * Eyeballs"). As soon as one attempt succeeds, the others are
+ * cancelled. The default is 250 milliseconds.
+ *
+ * This means that an address which does not respond at all, such as
+ * an IPv6 address on a network without working IPv6 routing, only
+ * delays the connection by @delay instead of by the full TCP
+ * connection timeout.
+ *
+ * If @delay is 0, addresses are tried one after another, the next
+ * one only being tried once the previous attempt has failed. The
+ * synchronous connect functions always behave this way.
+ *
+ * Since: 2.54
+ */
+void
+g_socket_client_set_connection_attempt_delay (GSocketClient *client,
+                                              guint          delay)
+{
+  g_return_if_fail (G_IS_SOCKET_CLIENT (client));
+
+  if (client->priv->connection_attempt_delay == delay)
+    return;
+
+  client->priv->connection_attempt_delay = delay;
+  g_object_notify (G_OBJECT (client), "connection-attempt-delay");
+}
+
+/**
+ * g_socket_client_get_tcp_nodelay:
+ * @client: a #GSocketClient
+ *
+ * Gets whether TCP connections made by @client have Nagle's algorithm
+ * disabled. See g_socket_client_set_tcp_nodelay().
+ *
+ * Returns: whether small writes are sent immediately
+ *
+ * Since: 2.54
+ */
+gboolean
+g_socket_client_get_tcp_nodelay (GSocketClient *client)
+{
+  g_return_val_if_fail (G_IS_SOCKET_CLIENT (client), FALSE);
+
+  return client->priv->tcp_nodelay;
+}
+
+/**
+ * g_socket_client_set_tcp_nodelay:
+ * @client: a #GSocketClient
+ * @nodelay: whether to disable Nagle's algorithm
+ *
+ * Sets whether TCP connections made by @client send small writes
+ * immediately, by calling g_socket_set_tcp_nodelay() on their sockets
+ * before connecting. This is what most request/response protocols
+ * want. The default is %FALSE.
+ *
+ * Since: 2.54
+ */
+void
+g_socket_client_set_tcp_nodelay (GSocketClient *client,
+                                 gboolean       nodelay)
+{
+  g_return_if_fail (G_IS_SOCKET_CLIENT (client));
+
+  nodelay = !!nodelay;
+  if (client->priv->tcp_nodelay == nodelay)
+    return;
+
+  client->priv->tcp_nodelay = nodelay;
+  g_object_notify (G_OBJECT (client), "tcp-nodelay");
+}
+
+/**
+ * g_socket_client_get_tcp_fast_open:
+ * @client: a #GSocketClient
+ *
+ * Gets whether @client uses TCP Fast Open. See
+ * g_socket_client_set_tcp_fast_open().
+ *
+ * Returns: whether TCP Fast Open is used
+ *
+ * Since: 2.54
+ */
+gboolean
+g_socket_client_get_tcp_fast_open (GSocketClient *client)
+{
+  g_return_val_if_fail (G_IS_SOCKET_CLIENT (client), FALSE);
+
+  return client->priv->tcp_fast_open;
+}
+
+/**
+ * g_socket_client_set_tcp_fast_open:
+ * @client: a #GSocketClient
+ * @fast_open: whether to use TCP Fast Open
+ *
+ * Sets whether TCP connections made by @client use TCP Fast Open
+ * (RFC 7413), which saves a round trip on connections to servers that
+ * were connected to before.
+ *
+ * When this is enabled and the server is known to support it, the
+ * connect functions such as g_socket_client_connect() return as soon
+ * as the socket is set up, and the first data written to the
+ * connection (for example a request, or a TLS handshake if
+ * #GSocketClient:tls is set) is sent together with the TCP SYN packet.
+ * A consequence is that errors such as the connection being refused
+ * are only reported by the first read or write. Otherwise the
+ * connection is made normally, and the server's Fast Open cookie is
+ * remembered for next time.
+ *
+ * This currently needs Linux 4.11 or later, with Fast Open enabled for
+ * clients in the `net.ipv4.tcp_fastopen` sysctl (which is the default);
+ * elsewhere connections are made normally. The default is %FALSE.
+ *
+ * Since: 2.54
+ */
+void
+g_socket_client_set_tcp_fast_open (GSocketClient *client,
+                                   gboolean       fast_open)
+{
+  g_return_if_fail (G_IS_SOCKET_CLIENT (client));
+
+  fast_open = !!fast_open;
+  if (client->priv->tcp_fast_open == fast_open)
+    return;
+
+  client->priv->tcp_fast_open = fast_open;
+  g_object_notify (G_OBJECT (client), "tcp-fast-open");
+}
+
+/**
+ * g_socket_client_get_tls_session_cache:
+ * @client: a #GSocketClient
+ *
+ * Gets the #GTlsSessionCache used by @client, if any. See
+ * g_socket_client_set_tls_session_cache().
+ *
+ * Returns: (nullable) (transfer none): the session cache, or %NULL
+ *
+ * Since: 2.54
+ */
+GTlsSessionCache *
+g_socket_client_get_tls_session_cache (GSocketClient *client)
+{
+  g_return_val_if_fail (G_IS_SOCKET_CLIENT (client), NULL);
+
+  return client->priv->tls_session_cache;
+}
+
+/**
+ * g_socket_client_set_tls_session_cache:
+ * @client: a #GSocketClient
+ * @cache: (nullable): a #GTlsSessionCache, or %NULL
+ *
+ * Sets the cache used to resume TLS sessions on connections made by
+ * @client when #GSocketClient:tls is set. Each successful handshake
+ * stores its session in @cache, and later connections to the same
+ * server try to resume it, which saves a round trip and the public
+ * key operations of a full handshake.
+ *
+ * The same cache can be shared between several clients. The default
+ * is %NULL, meaning sessions are only resumed if the TLS backend does
+ * so on its own.
+ *
+ * Since: 2.54
+ */
+void
+g_socket_client_set_tls_session_cache (GSocketClient    *client,
+                                       GTlsSessionCache *cache)
+{
+  g_return_if_fail (G_IS_SOCKET_CLIENT (client));
+  g_return_if_fail (cache == NULL || G_IS_TLS_SESSION_CACHE (cache));
+
+  if (g_set_object (&client->priv->tls_session_cache, cache))
+    g_object_notify (G_OBJECT (client), "tls-session-cache");
+}
+
 /**
  * g_socket_client_get_enable_proxy:
  * @client: a #GSocketClient.
@@ -923,6 +1190,105 @@ g_socket_client_class_init (GSocketClientClass *class)
                                                         G_PARAM_CONSTRUCT |
                                                         G_PARAM_READWRITE |
                                                         G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocketClient:connection-attempt-delay:
+   *
+   * The time in milliseconds to wait for a connection attempt before
+   * starting a parallel attempt to the next address, or 0 to only try
+   * addresses one after another. See
+   * g_socket_client_set_connection_attempt_delay().
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class, PROP_CONNECTION_ATTEMPT_DELAY,
+                                   g_param_spec_uint ("connection-attempt-delay",
+                                                      P_("Connection attempt delay"),
+                                                      P_("The delay in milliseconds before starting a parallel connection attempt, or 0 for none"),
+                                                      0, G_MAXUINT, DEFAULT_CONNECTION_ATTEMPT_DELAY,
+                                                      G_PARAM_CONSTRUCT |
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocketClient:tcp-nodelay:
+   *
+   * Whether TCP connections send small writes immediately. See
+   * g_socket_client_set_tcp_nodelay().
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class, PROP_TCP_NODELAY,
+                                   g_param_spec_boolean ("tcp-nodelay",
+                                                         P_("TCP no delay"),
+                                                         P_("Whether TCP connections send small writes immediately"),
+                                                         FALSE,
+                                                         G_PARAM_CONSTRUCT |
+                                                         G_PARAM_READWRITE |
+                                                         G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocketClient:tcp-fast-open:
+   *
+   * Whether TCP connections use TCP Fast Open. See
+   * g_socket_client_set_tcp_fast_open().
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class, PROP_TCP_FAST_OPEN,
+                                   g_param_spec_boolean ("tcp-fast-open",
+                                                         P_("TCP Fast Open"),
+                                                         P_("Whether TCP connections send data with the SYN packet"),
+                                                         FALSE,
+                                                         G_PARAM_CONSTRUCT |
+                                                         G_PARAM_READWRITE |
+                                                         G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocketClient:tls-session-cache:
+   *
+   * The cache used to resume TLS sessions. See
+   * g_socket_client_set_tls_session_cache().
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class, PROP_TLS_SESSION_CACHE,
+                                   g_param_spec_object ("tls-session-cache",
+                                                        P_("TLS session cache"),
+                                                        P_("The cache used to resume TLS sessions"),
+                                                        G_TYPE_TLS_SESSION_CACHE,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_STATIC_STRINGS));
+}
+
+/* Called before the handshake of a new TLS connection */
+static void
+g_socket_client_tls_resume_session (GSocketClient      *client,
+                                    GSocketConnectable *connectable,
+                                    GIOStream          *tlsconn)
+{
+  if (client->priv->tls_session_cache)
+    g_tls_session_cache_resume (client->priv->tls_session_cache, connectable,
+                                G_TLS_CLIENT_CONNECTION (tlsconn));
+}
+
+/* Called after the handshake of a TLS connection has finished. A failed
+ * handshake drops the stored session, in case it was the cause.
+ */
+static void
+g_socket_client_tls_update_session (GSocketClient      *client,
+                                    GSocketConnectable *connectable,
+                                    GIOStream          *tlsconn,
+                                    gboolean            success)
+{
+  if (!client->priv->tls_session_cache)
+    return;
+
+  if (success)
+    g_tls_session_cache_store (client->priv->tls_session_cache, connectable,
+                               G_TLS_CLIENT_CONNECTION (tlsconn));
+  else
+    g_tls_session_cache_remove (client->priv->tls_session_cache, connectable);
 }
 
 static void
@@ -1126,14 +1492,17 @@ g_socket_client_connect (GSocketClient       *client,
 	    {
 	      g_tls_client_connection_set_validation_flags (G_TLS_CLIENT_CONNECTION (tlsconn),
                                                             client->priv->tls_validation_flags);
+	      g_socket_client_tls_resume_session (client, connectable, tlsconn);
 	      g_socket_client_emit_event (client, G_SOCKET_CLIENT_TLS_HANDSHAKING, connectable, connection);
 	      if (g_tls_connection_handshake (G_TLS_CONNECTION (tlsconn),
 					      cancellable, &last_error))
 		{
+		  g_socket_client_tls_update_session (client, connectable, tlsconn, TRUE);
 		  g_socket_client_emit_event (client, G_SOCKET_CLIENT_TLS_HANDSHAKED, connectable, connection);
 		}
 	      else
 		{
+		  g_socket_client_tls_update_session (client, connectable, tlsconn, FALSE);
 		  g_object_unref (tlsconn);
 		  connection = NULL;
 		}
@@ -1332,29 +1701,123 @@ typedef struct
   GSocket *current_socket;
   GIOStream *connection;
 
+  /* Happy Eyeballs (RFC 8305): connection attempts still racing, the
+   * timer for starting the next one, and an address that was
+   * enumerated while a connection was already being set up
+   */
+  GSList *connection_attempts;
+  GSource *attempt_delay_source;
+  GSocketAddress *next_address;
+  gboolean enumerating;
+  gboolean enumeration_finished;
+  gboolean completed;
+
   GError *last_error;
 } GSocketClientAsyncConnectData;
 
+typedef struct
+{
+  GTask *task;
+  GSocketAddress *address;
+  GProxyAddress *proxy_addr;
+  GSocket *socket;
+  GIOStream *connection;
+  GCancellable *cancellable;
+  gulong cancelled_id;
+} ConnectionAttempt;
+
+static void
+connection_attempt_free (ConnectionAttempt *attempt)
+{
+  if (attempt->cancelled_id != 0)
+    g_cancellable_disconnect (g_task_get_cancellable (attempt->task),
+                              attempt->cancelled_id);
+  g_clear_object (&attempt->cancellable);
+  g_clear_object (&attempt->address);
+  g_clear_object (&attempt->proxy_addr);
+  g_clear_object (&attempt->socket);
+  g_clear_object (&attempt->connection);
+  g_object_unref (attempt->task);
+
+  g_slice_free (ConnectionAttempt, attempt);
+}
+
 static void
 g_socket_client_async_connect_data_free (GSocketClientAsyncConnectData *data)
 {
+  /* attempts and the delay source hold references on the task */
+  g_assert (data->connection_attempts == NULL);
+  g_assert (data->attempt_delay_source == NULL);
+
   g_clear_object (&data->connectable);
   g_clear_object (&data->enumerator);
   g_clear_object (&data->proxy_addr);
   g_clear_object (&data->current_addr);
   g_clear_object (&data->current_socket);
   g_clear_object (&data->connection);
+  g_clear_object (&data->next_address);
 
   g_clear_error (&data->last_error);
 
   g_slice_free (GSocketClientAsyncConnectData, data);
 }
 
+static void
+clear_connection_attempt_delay (GSocketClientAsyncConnectData *data)
+{
+  if (data->attempt_delay_source)
+    {
+      g_source_destroy (data->attempt_delay_source);
+      g_source_unref (data->attempt_delay_source);
+      data->attempt_delay_source = NULL;
+    }
+}
+
+/* Cancels all connection attempts that are still in progress; their
+ * callbacks notice that they are no longer in the list and just clean
+ * up after themselves.
+ */
+static void
+cancel_connection_attempts (GSocketClientAsyncConnectData *data)
+{
+  GSList *l;
+
+  for (l = data->connection_attempts; l != NULL; l = l->next)
+    {
+      ConnectionAttempt *attempt = l->data;
+
+      g_cancellable_cancel (attempt->cancellable);
+    }
+  g_slist_free (data->connection_attempts);
+  data->connection_attempts = NULL;
+
+  clear_connection_attempt_delay (data);
+}
+
+static gboolean
+g_socket_client_async_connect_cancelled (GSocketClientAsyncConnectData *data)
+{
+  if (data->completed)
+    return TRUE;
+
+  if (g_task_return_error_if_cancelled (data->task))
+    {
+      data->completed = TRUE;
+      cancel_connection_attempts (data);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
 static void
 g_socket_client_async_connect_complete (GSocketClientAsyncConnectData *data)
 {
   g_assert (data->connection);
 
+  data->completed = TRUE;
+  cancel_connection_attempts (data);
+
   if (!G_IS_SOCKET_CONNECTION (data->connection))
     {
       GSocketConnection *wrapper_connection;
@@ -1368,7 +1831,6 @@ g_socket_client_async_connect_complete (GSocketClientAsyncConnectData *data)
   g_socket_client_emit_event (data->client, G_SOCKET_CLIENT_COMPLETE, data->connectable, data->connection);
   g_task_return_pointer (data->task, data->connection, g_object_unref);
   data->connection = NULL;
-  g_object_unref (data->task);
 }
 
 
@@ -1388,17 +1850,71 @@ set_last_error (GSocketClientAsyncConnectData *data,
 static void
 enumerator_next_async (GSocketClientAsyncConnectData *data)
 {
-  /* We need to cleanup the state */
-  g_clear_object (&data->current_socket);
-  g_clear_object (&data->current_addr);
-  g_clear_object (&data->proxy_addr);
-  g_clear_object (&data->connection);
+  clear_connection_attempt_delay (data);
+  data->enumerating = TRUE;
 
   g_socket_client_emit_event (data->client, G_SOCKET_CLIENT_RESOLVING, data->connectable, NULL);
   g_socket_address_enumerator_next_async (data->enumerator,
 					  g_task_get_cancellable (data->task),
 					  g_socket_client_enumerator_callback,
-					  data);
+					  g_object_ref (data->task));
+}
+
+static void start_connection_attempt (GSocketClientAsyncConnectData *data,
+                                      GSocketAddress                *address);
+
+/* Called whenever an address turned out to be unusable: moves on to
+ * the next address, unless other attempts are still in progress or
+ * there is nothing left to try, in which case the operation fails.
+ */
+static void
+try_next_connection_or_finish (GSocketClientAsyncConnectData *data)
+{
+  g_clear_object (&data->current_socket);
+  g_clear_object (&data->current_addr);
+  g_clear_object (&data->proxy_addr);
+  g_clear_object (&data->connection);
+
+  if (g_socket_client_async_connect_cancelled (data))
+    return;
+
+  if (data->next_address)
+    {
+      GSocketAddress *address = data->next_address;
+
+      data->next_address = NULL;
+      start_connection_attempt (data, address);
+      return;
+    }
+
+  if (data->enumerating)
+    return;
+
+  if (!data->enumeration_finished)
+    {
+      enumerator_next_async (data);
+      return;
+    }
+
+  if (data->connection_attempts == NULL)
+    {
+      GError *error = NULL;
+
+      if (data->last_error)
+        {
+          error = data->last_error;
+          data->last_error = NULL;
+        }
+      else
+        {
+          g_set_error_literal (&error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                               _("Unknown error on connect"));
+        }
+
+      data->completed = TRUE;
+      g_socket_client_emit_event (data->client, G_SOCKET_CLIENT_COMPLETE, data->connectable, NULL);
+      g_task_return_error (data->task, error);
+    }
 }
 
 static void
@@ -1406,7 +1922,8 @@ g_socket_client_tls_handshake_callback (GObject      *object,
 					GAsyncResult *result,
 					gpointer      user_data)
 {
-  GSocketClientAsyncConnectData *data = user_data;
+  GTask *task = user_data;
+  GSocketClientAsyncConnectData *data = g_task_get_task_data (task);
 
   if (g_tls_connection_handshake_finish (G_TLS_CONNECTION (object),
 					 result,
@@ -1415,14 +1932,18 @@ g_socket_client_tls_handshake_callback (GObject      *object,
       g_object_unref (data->connection);
       data->connection = G_IO_STREAM (object);
 
+      g_socket_client_tls_update_session (data->client, data->connectable, data->connection, TRUE);
       g_socket_client_emit_event (data->client, G_SOCKET_CLIENT_TLS_HANDSHAKED, data->connectable, data->connection);
       g_socket_client_async_connect_complete (data);
     }
   else
     {
+      g_socket_client_tls_update_session (data->client, data->connectable, G_IO_STREAM (object), FALSE);
       g_object_unref (object);
-      enumerator_next_async (data);
+      try_next_connection_or_finish (data);
     }
+
+  g_object_unref (task);
 }
 
 static void
@@ -1443,16 +1964,17 @@ g_socket_client_tls_handshake (GSocketClientAsyncConnectData *data)
     {
       g_tls_client_connection_set_validation_flags (G_TLS_CLIENT_CONNECTION (tlsconn),
                                                     data->client->priv->tls_validation_flags);
+      g_socket_client_tls_resume_session (data->client, data->connectable, tlsconn);
       g_socket_client_emit_event (data->client, G_SOCKET_CLIENT_TLS_HANDSHAKING, data->connectable, G_IO_STREAM (tlsconn));
       g_tls_connection_handshake_async (G_TLS_CONNECTION (tlsconn),
 					G_PRIORITY_DEFAULT,
 					g_task_get_cancellable (data->task),
 					g_socket_client_tls_handshake_callback,
-					data);
+					g_object_ref (data->task));
     }
   else
     {
-      enumerator_next_async (data);
+      try_next_connection_or_finish (data);
     }
 }
 
@@ -1461,7 +1983,8 @@ g_socket_client_proxy_connect_callback (GObject      *object,
 					GAsyncResult *result,
 					gpointer      user_data)
 {
-  GSocketClientAsyncConnectData *data = user_data;
+  GTask *task = user_data;
+  GSocketClientAsyncConnectData *data = g_task_get_task_data (task);
 
   g_object_unref (data->connection);
   data->connection = g_proxy_connect_finish (G_PROXY (object),
@@ -1470,44 +1993,25 @@ g_socket_client_proxy_connect_callback (GObject      *object,
   if (data->connection)
     {
       g_socket_client_emit_event (data->client, G_SOCKET_CLIENT_PROXY_NEGOTIATED, data->connectable, data->connection);
+      g_socket_client_tls_handshake (data);
     }
   else
     {
-      enumerator_next_async (data);
-      return;
+      try_next_connection_or_finish (data);
     }
 
-  g_socket_client_tls_handshake (data);
+  g_object_unref (task);
 }
 
+/* Takes over the connected socket of the attempt that won the race and
+ * carries on with proxy negotiation and the TLS handshake, if any.
+ */
 static void
-g_socket_client_connected_callback (GObject      *source,
-				    GAsyncResult *result,
-				    gpointer      user_data)
+g_socket_client_connected (GSocketClientAsyncConnectData *data)
 {
-  GSocketClientAsyncConnectData *data = user_data;
-  GError *error = NULL;
   GProxy *proxy;
   const gchar *protocol;
 
-  if (g_task_return_error_if_cancelled (data->task))
-    {
-      g_object_unref (data->task);
-      return;
-    }
-
-  if (!g_socket_connection_connect_finish (G_SOCKET_CONNECTION (source),
-					   result, &error))
-    {
-      clarify_connect_error (error, data->connectable,
-			     data->current_addr);
-      set_last_error (data, error);
-
-      /* try next one */
-      enumerator_next_async (data);
-      return;
-    }
-
   g_socket_connection_set_cached_remote_address ((GSocketConnection*)data->connection, NULL);
   g_socket_client_emit_event (data->client, G_SOCKET_CLIENT_CONNECTED, data->connectable, data->connection);
 
@@ -1530,11 +2034,12 @@ g_socket_client_connected_callback (GObject      *source,
       g_critical ("Trying to proxy over non-TCP connection, this is "
           "most likely a bug in GLib IO library.");
 
+      g_clear_error (&data->last_error);
       g_set_error_literal (&data->last_error,
           G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
           _("Proxying over a non-TCP connection is not supported."));
 
-      enumerator_next_async (data);
+      try_next_connection_or_finish (data);
     }
   else if (g_hash_table_contains (data->client->priv->app_proxies, protocol))
     {
@@ -1550,7 +2055,7 @@ g_socket_client_connected_callback (GObject      *source,
                              data->proxy_addr,
                              g_task_get_cancellable (data->task),
                              g_socket_client_proxy_connect_callback,
-                             data);
+                             g_object_ref (data->task));
       g_object_unref (proxy);
     }
   else
@@ -1561,76 +2066,201 @@ g_socket_client_connected_callback (GObject      *source,
           _("Proxy protocol “%s” is not supported."),
           protocol);
 
-      enumerator_next_async (data);
+      try_next_connection_or_finish (data);
     }
 }
 
 static void
-g_socket_client_enumerator_callback (GObject      *object,
-				     GAsyncResult *result,
-				     gpointer      user_data)
+g_socket_client_connected_callback (GObject      *source,
+				    GAsyncResult *result,
+				    gpointer      user_data)
 {
-  GSocketClientAsyncConnectData *data = user_data;
-  GSocketAddress *address = NULL;
-  GSocket *socket;
+  ConnectionAttempt *attempt = user_data;
+  GSocketClientAsyncConnectData *data = g_task_get_task_data (attempt->task);
   GError *error = NULL;
 
-  if (g_task_return_error_if_cancelled (data->task))
+  if (!g_slist_find (data->connection_attempts, attempt))
     {
-      g_object_unref (data->task);
+      /* Another attempt won, or the whole operation is over */
+      g_socket_connection_connect_finish (G_SOCKET_CONNECTION (source),
+                                          result, NULL);
+      connection_attempt_free (attempt);
       return;
     }
 
-  address = g_socket_address_enumerator_next_finish (data->enumerator,
-						     result, &error);
-  if (address == NULL)
+  data->connection_attempts = g_slist_remove (data->connection_attempts, attempt);
+
+  if (g_socket_client_async_connect_cancelled (data))
     {
-      g_socket_client_emit_event (data->client, G_SOCKET_CLIENT_COMPLETE, data->connectable, NULL);
-      if (!error)
-	{
-	  if (data->last_error)
-	    {
-	      error = data->last_error;
-	      data->last_error = NULL;
-	    }
-	  else
-	    {
-	      g_set_error_literal (&error, G_IO_ERROR, G_IO_ERROR_FAILED,
-				   _("Unknown error on connect"));
-	    }
-	}
-      g_task_return_error (data->task, error);
-      g_object_unref (data->task);
+      connection_attempt_free (attempt);
       return;
     }
 
-  g_socket_client_emit_event (data->client, G_SOCKET_CLIENT_RESOLVED,
-			      data->connectable, NULL);
+  if (!g_socket_connection_connect_finish (G_SOCKET_CONNECTION (source),
+					   result, &error))
+    {
+      clarify_connect_error (error, data->connectable,
+			     attempt->address);
+      set_last_error (data, error);
 
-  if (G_IS_PROXY_ADDRESS (address) &&
-      data->client->priv->enable_proxy)
-    data->proxy_addr = g_object_ref (G_PROXY_ADDRESS (address));
+      /* try next one, without waiting for the delay to expire */
+      try_next_connection_or_finish (data);
+      connection_attempt_free (attempt);
+      return;
+    }
 
-  g_clear_error (&data->last_error);
+  /* We have a winner; the other attempts are no longer needed */
+  cancel_connection_attempts (data);
+
+  data->current_addr = g_steal_pointer (&attempt->address);
+  data->current_socket = g_steal_pointer (&attempt->socket);
+  data->proxy_addr = g_steal_pointer (&attempt->proxy_addr);
+  data->connection = g_steal_pointer (&attempt->connection);
+
+  g_socket_client_connected (data);
+  connection_attempt_free (attempt);
+}
+
+static gboolean
+on_connection_attempt_delay_reached (gpointer user_data)
+{
+  GSocketClientAsyncConnectData *data = g_task_get_task_data (user_data);
+
+  clear_connection_attempt_delay (data);
+
+  /* Only start another attempt if the previous ones are all still
+   * pending, and not already in the middle of setting one up
+   */
+  if (!data->enumerating &&
+      !data->enumeration_finished &&
+      data->next_address == NULL &&
+      data->connection == NULL)
+    enumerator_next_async (data);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+on_connection_cancelled (GCancellable *cancellable,
+                         gpointer      user_data)
+{
+  GCancellable *attempt_cancellable = user_data;
+
+  g_cancellable_cancel (attempt_cancellable);
+}
+
+/* Takes ownership of @address */
+static void
+start_connection_attempt (GSocketClientAsyncConnectData *data,
+                          GSocketAddress                *address)
+{
+  ConnectionAttempt *attempt;
+  GCancellable *cancellable;
+  GSocket *socket;
+  GError *error = NULL;
+  guint delay;
 
-  socket = create_socket (data->client, address, &data->last_error);
+  socket = create_socket (data->client, address, &error);
   if (socket == NULL)
     {
       g_object_unref (address);
-      enumerator_next_async (data);
+      set_last_error (data, error);
+      try_next_connection_or_finish (data);
       return;
     }
 
-  data->current_socket = socket;
-  data->current_addr = address;
-  data->connection = (GIOStream *) g_socket_connection_factory_create_connection (socket);
+  attempt = g_slice_new0 (ConnectionAttempt);
+  attempt->task = g_object_ref (data->task);
+  attempt->address = address;
+  if (G_IS_PROXY_ADDRESS (address) &&
+      data->client->priv->enable_proxy)
+    attempt->proxy_addr = g_object_ref (G_PROXY_ADDRESS (address));
+  attempt->socket = socket;
+  attempt->connection = (GIOStream *) g_socket_connection_factory_create_connection (socket);
 
-  g_socket_connection_set_cached_remote_address ((GSocketConnection*)data->connection, address);
-  g_socket_client_emit_event (data->client, G_SOCKET_CLIENT_CONNECTING, data->connectable, data->connection);
-  g_socket_connection_connect_async (G_SOCKET_CONNECTION (data->connection),
+  /* Each attempt gets its own cancellable so that the losers can be
+   * cancelled on their own
+   */
+  attempt->cancellable = g_cancellable_new ();
+  cancellable = g_task_get_cancellable (data->task);
+  if (cancellable)
+    attempt->cancelled_id = g_cancellable_connect (cancellable,
+                                                   G_CALLBACK (on_connection_cancelled),
+                                                   attempt->cancellable,
+                                                   NULL);
+
+  data->connection_attempts = g_slist_append (data->connection_attempts, attempt);
+
+  g_socket_connection_set_cached_remote_address ((GSocketConnection*)attempt->connection, address);
+  g_socket_client_emit_event (data->client, G_SOCKET_CLIENT_CONNECTING, data->connectable, attempt->connection);
+  g_socket_connection_connect_async (G_SOCKET_CONNECTION (attempt->connection),
 				     address,
-				     g_task_get_cancellable (data->task),
-				     g_socket_client_connected_callback, data);
+				     attempt->cancellable,
+				     g_socket_client_connected_callback, attempt);
+
+  delay = data->client->priv->connection_attempt_delay;
+  if (delay > 0 && !data->enumeration_finished)
+    {
+      clear_connection_attempt_delay (data);
+      data->attempt_delay_source = g_timeout_source_new (delay);
+      g_task_attach_source (data->task, data->attempt_delay_source,
+                            on_connection_attempt_delay_reached);
+    }
+}
+
+static void
+g_socket_client_enumerator_callback (GObject      *object,
+				     GAsyncResult *result,
+				     gpointer      user_data)
+{
+  GTask *task = user_data;
+  GSocketClientAsyncConnectData *data = g_task_get_task_data (task);
+  GSocketAddress *address = NULL;
+  GError *error = NULL;
+
+  data->enumerating = FALSE;
+
+  address = g_socket_address_enumerator_next_finish (data->enumerator,
+						     result, &error);
+
+  if (g_socket_client_async_connect_cancelled (data))
+    {
+      g_clear_object (&address);
+      g_clear_error (&error);
+      g_object_unref (task);
+      return;
+    }
+
+  if (address == NULL)
+    {
+      data->enumeration_finished = TRUE;
+      if (error)
+        set_last_error (data, error);
+
+      /* fails the operation, unless something is still in flight */
+      if (data->connection == NULL)
+        try_next_connection_or_finish (data);
+
+      g_object_unref (task);
+      return;
+    }
+
+  g_socket_client_emit_event (data->client, G_SOCKET_CLIENT_RESOLVED,
+			      data->connectable, NULL);
+
+  if (data->connection != NULL)
+    {
+      /* A connection is already being set up; only try this address
+       * if that fails
+       */
+      data->next_address = address;
+    }
+  else
+    {
+      start_connection_attempt (data, address);
+    }
+
+  g_object_unref (task);
 }
 
 /**
@@ -1683,6 +2313,7 @@ g_socket_client_connect_async (GSocketClient       *client,
   g_task_set_task_data (data->task, data, (GDestroyNotify)g_socket_client_async_connect_data_free);
 
   enumerator_next_async (data);
+  g_object_unref (data->task);
 }
 
 /**
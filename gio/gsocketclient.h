@@ -28,6 +28,7 @@
 #endif
 
 #include <gio/giotypes.h>
+#include <gio/gtlssessioncache.h>
 
 G_BEGIN_DECLS
 
@@ -99,6 +100,26 @@ guint                   g_socket_client_get_timeout                     (GSocket
 GLIB_AVAILABLE_IN_ALL
 void                    g_socket_client_set_timeout                     (GSocketClient        *client,
 									 guint                 timeout);
+GLIB_AVAILABLE_IN_2_54
+guint                   g_socket_client_get_connection_attempt_delay    (GSocketClient        *client);
+GLIB_AVAILABLE_IN_2_54
+void                    g_socket_client_set_connection_attempt_delay    (GSocketClient        *client,
+                                                                         guint                 delay);
+GLIB_AVAILABLE_IN_2_54
+gboolean                g_socket_client_get_tcp_nodelay                 (GSocketClient        *client);
+GLIB_AVAILABLE_IN_2_54
+void                    g_socket_client_set_tcp_nodelay                 (GSocketClient        *client,
+                                                                         gboolean              nodelay);
+GLIB_AVAILABLE_IN_2_54
+gboolean                g_socket_client_get_tcp_fast_open               (GSocketClient        *client);
+GLIB_AVAILABLE_IN_2_54
+void                    g_socket_client_set_tcp_fast_open               (GSocketClient        *client,
+                                                                         gboolean              fast_open);
+GLIB_AVAILABLE_IN_2_54
+GTlsSessionCache       *g_socket_client_get_tls_session_cache           (GSocketClient        *client);
+GLIB_AVAILABLE_IN_2_54
+void                    g_socket_client_set_tls_session_cache           (GSocketClient        *client,
+                                                                         GTlsSessionCache     *cache);
 GLIB_AVAILABLE_IN_ALL
 gboolean                g_socket_client_get_enable_proxy                (GSocketClient        *client);
 GLIB_AVAILABLE_IN_ALL
@@ -35,6 +35,8 @@
 #include <gio/gsocket.h>
 #include <gio/gsocketconnection.h>
 #include <gio/ginetsocketaddress.h>
+#include "gioprivate.h"
+#include "gnetworking.h"
 #include "glibintl.h"
 
 
@@ -59,7 +61,9 @@
 enum
 {
   PROP_0,
-  PROP_LISTEN_BACKLOG
+  PROP_LISTEN_BACKLOG,
+  PROP_ACCEPT_BATCH,
+  PROP_TCP_FAST_OPEN
 };
 
 enum
@@ -75,13 +79,33 @@ static GQuark source_quark = 0;
 struct _GSocketListenerPrivate
 {
   GPtrArray           *sockets;
+  GPtrArray           *shard_sockets;
   GMainContext        *main_context;
   int                 listen_backlog;
+  guint               accept_batch;
+  guint               tcp_fast_open;
+  GQueue              pending;
   guint               closed : 1;
 };
 
+/* A connection that was accepted as part of a batch, waiting for the
+ * next call to accept */
+typedef struct
+{
+  GSocket *socket;
+  GSocket *accept_socket;
+} PendingSocket;
+
 G_DEFINE_TYPE_WITH_PRIVATE (GSocketListener, g_socket_listener, G_TYPE_OBJECT)
 
+static void
+pending_socket_free (PendingSocket *pending)
+{
+  g_object_unref (pending->socket);
+  g_object_unref (pending->accept_socket);
+  g_slice_free (PendingSocket, pending);
+}
+
 static void
 g_socket_listener_finalize (GObject *object)
 {
@@ -96,6 +120,9 @@ g_socket_listener_finalize (GObject *object)
    * g_socket_listener_add_socket() was used).
    */
   g_ptr_array_free (listener->priv->sockets, TRUE);
+  g_ptr_array_free (listener->priv->shard_sockets, TRUE);
+  g_queue_foreach (&listener->priv->pending, (GFunc) pending_socket_free, NULL);
+  g_queue_clear (&listener->priv->pending);
 
   G_OBJECT_CLASS (g_socket_listener_parent_class)
     ->finalize (object);
@@ -115,6 +142,14 @@ g_socket_listener_get_property (GObject    *object,
         g_value_set_int (value, listener->priv->listen_backlog);
         break;
 
+      case PROP_ACCEPT_BATCH:
+        g_value_set_uint (value, listener->priv->accept_batch);
+        break;
+
+      case PROP_TCP_FAST_OPEN:
+        g_value_set_uint (value, listener->priv->tcp_fast_open);
+        break;
+
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -134,6 +169,14 @@ g_socket_listener_set_property (GObject      *object,
 	g_socket_listener_set_backlog (listener, g_value_get_int (value));
 	break;
 
+      case PROP_ACCEPT_BATCH:
+        g_socket_listener_set_accept_batch (listener, g_value_get_uint (value));
+        break;
+
+      case PROP_TCP_FAST_OPEN:
+        g_socket_listener_set_tcp_fast_open (listener, g_value_get_uint (value));
+        break;
+
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -156,6 +199,42 @@ g_socket_listener_class_init (GSocketListenerClass *klass)
                                                      10,
                                                      G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GSocketListener:accept-batch:
+   *
+   * The maximum number of connections to accept from a listening socket
+   * each time it becomes ready, or 0 to accept until its listen queue is
+   * empty. See g_socket_listener_set_accept_batch().
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class, PROP_ACCEPT_BATCH,
+                                   g_param_spec_uint ("accept-batch",
+                                                      P_("Accept batch"),
+                                                      P_("Connections to accept each time a socket is ready, or 0 for all"),
+                                                      0,
+                                                      G_MAXUINT,
+                                                      1,
+                                                      G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocketListener:tcp-fast-open:
+   *
+   * The maximum number of pending TCP Fast Open connections on each
+   * TCP socket, or 0 to not accept TCP Fast Open. See
+   * g_socket_listener_set_tcp_fast_open().
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class, PROP_TCP_FAST_OPEN,
+                                   g_param_spec_uint ("tcp-fast-open",
+                                                      P_("TCP Fast Open"),
+                                                      P_("The maximum number of pending TCP Fast Open connections, or 0 to disable it"),
+                                                      0,
+                                                      G_MAXINT,
+                                                      0,
+                                                      G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GSocketListener::event:
    * @listener: the #GSocketListener
@@ -188,7 +267,11 @@ g_socket_listener_init (GSocketListener *listener)
   listener->priv = g_socket_listener_get_instance_private (listener);
   listener->priv->sockets =
     g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+  listener->priv->shard_sockets =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
   listener->priv->listen_backlog = 10;
+  listener->priv->accept_batch = 1;
+  g_queue_init (&listener->priv->pending);
 }
 
 /**
@@ -208,6 +291,36 @@ g_socket_listener_new (void)
   return g_object_new (G_TYPE_SOCKET_LISTENER, NULL);
 }
 
+static void
+set_tcp_fast_open (GSocketListener *listener,
+                   GSocket         *socket)
+{
+#ifdef TCP_FASTOPEN
+  GSocketFamily family;
+
+  family = g_socket_get_family (socket);
+  if (g_socket_get_socket_type (socket) != G_SOCKET_TYPE_STREAM ||
+      (family != G_SOCKET_FAMILY_IPV4 && family != G_SOCKET_FAMILY_IPV6))
+    return;
+
+  /* Best effort, as with the listen backlog */
+  g_socket_set_option (socket, IPPROTO_TCP, TCP_FASTOPEN,
+                       listener->priv->tcp_fast_open, NULL);
+#endif
+}
+
+/* Applies the listener's settings to a socket it created, before
+ * binding it */
+static void
+prepare_socket (GSocketListener *listener,
+                GSocket         *socket)
+{
+  g_socket_set_listen_backlog (socket, listener->priv->listen_backlog);
+
+  if (listener->priv->tcp_fast_open != 0)
+    set_tcp_fast_open (listener, socket);
+}
+
 static gboolean
 check_listener (GSocketListener *listener,
 		GError **error)
@@ -334,7 +447,7 @@ g_socket_listener_add_address (GSocketListener  *listener,
   if (socket == NULL)
     return FALSE;
 
-  g_socket_set_listen_backlog (socket, listener->priv->listen_backlog);
+  prepare_socket (listener, socket);
 
   g_signal_emit (listener, signals[EVENT], 0,
                  G_SOCKET_LISTENER_BINDING, socket);
@@ -443,7 +556,7 @@ g_socket_listener_add_inet_port (GSocketListener  *listener,
       address = g_inet_socket_address_new (inet_address, port);
       g_object_unref (inet_address);
 
-      g_socket_set_listen_backlog (socket6, listener->priv->listen_backlog);
+      prepare_socket (listener, socket6);
 
       g_signal_emit (listener, signals[EVENT], 0,
                      G_SOCKET_LISTENER_BINDING, socket6);
@@ -509,8 +622,7 @@ g_socket_listener_add_inet_port (GSocketListener  *listener,
           address = g_inet_socket_address_new (inet_address, port);
           g_object_unref (inet_address);
 
-          g_socket_set_listen_backlog (socket4,
-                                       listener->priv->listen_backlog);
+          prepare_socket (listener, socket4);
 
           g_signal_emit (listener, signals[EVENT], 0,
                          G_SOCKET_LISTENER_BINDING, socket4);
@@ -618,6 +730,52 @@ free_sources (GList *sources)
     }
 }
 
+/* @accept_socket just polled ready, so pick up whatever else is in
+ * its listen queue now rather than going back to the main loop for
+ * each connection.
+ */
+static void
+accept_batch (GSocketListener *listener,
+              GSocket         *accept_socket)
+{
+  PendingSocket *pending;
+  GSocket *socket;
+  guint n;
+
+  for (n = 1; listener->priv->accept_batch == 0 || n < listener->priv->accept_batch; n++)
+    {
+      /* Errors other than G_IO_ERROR_WOULD_BLOCK will be reported
+       * by the next regular accept */
+      socket = g_socket_accept_nonblocking (accept_socket, NULL);
+      if (socket == NULL)
+        break;
+
+      pending = g_slice_new (PendingSocket);
+      pending->socket = socket;
+      pending->accept_socket = g_object_ref (accept_socket);
+      g_queue_push_tail (&listener->priv->pending, pending);
+    }
+}
+
+static GSocket *
+accept_pending (GSocketListener  *listener,
+                GObject         **source_object)
+{
+  PendingSocket *pending;
+  GSocket *socket;
+
+  pending = g_queue_pop_head (&listener->priv->pending);
+  if (pending == NULL)
+    return NULL;
+
+  socket = g_object_ref (pending->socket);
+  if (source_object)
+    *source_object = g_object_get_qdata (G_OBJECT (pending->accept_socket), source_quark);
+  pending_socket_free (pending);
+
+  return socket;
+}
+
 struct AcceptData {
   GMainLoop *loop;
   GSocket *socket;
@@ -675,6 +833,9 @@ g_socket_listener_accept_socket (GSocketListener  *listener,
   if (!check_listener (listener, error))
     return NULL;
 
+  if ((socket = accept_pending (listener, source_object)))
+    return socket;
+
   if (listener->priv->sockets->len == 1)
     {
       accept_socket = listener->priv->sockets->pdata[0];
@@ -707,6 +868,8 @@ g_socket_listener_accept_socket (GSocketListener  *listener,
   if (!(socket = g_socket_accept (accept_socket, cancellable, error)))
     return NULL;
 
+  accept_batch (listener, accept_socket);
+
   if (source_object)
     *source_object = g_object_get_qdata (G_OBJECT (accept_socket), source_quark);
 
@@ -771,6 +934,8 @@ accept_ready (GSocket      *accept_socket,
   socket = g_socket_accept (accept_socket, g_task_get_cancellable (task), &error);
   if (socket)
     {
+      accept_batch (g_task_get_source_object (task), accept_socket);
+
       source_object = g_object_get_qdata (G_OBJECT (accept_socket), source_quark);
       if (source_object)
 	g_object_set_qdata_full (G_OBJECT (task),
@@ -810,6 +975,8 @@ g_socket_listener_accept_socket_async (GSocketListener     *listener,
 {
   GTask *task;
   GList *sources;
+  GSocket *socket;
+  GObject *source_object = NULL;
   GError *error = NULL;
 
   task = g_task_new (listener, cancellable, callback, user_data);
@@ -822,6 +989,17 @@ g_socket_listener_accept_socket_async (GSocketListener     *listener,
       return;
     }
 
+  if ((socket = accept_pending (listener, &source_object)))
+    {
+      if (source_object)
+        g_object_set_qdata_full (G_OBJECT (task),
+                                 source_quark,
+                                 g_object_ref (source_object), g_object_unref);
+      g_task_return_pointer (task, socket, g_object_unref);
+      g_object_unref (task);
+      return;
+    }
+
   sources = add_sources (listener,
 			 accept_ready,
 			 task,
@@ -951,6 +1129,84 @@ g_socket_listener_set_backlog (GSocketListener *listener,
     }
 }
 
+/**
+ * g_socket_listener_set_accept_batch:
+ * @listener: a #GSocketListener
+ * @accept_batch: the maximum number of connections to accept at once,
+ *     or 0 for no limit
+ *
+ * Sets the maximum number of connections that @listener accepts from
+ * one of its sockets each time that socket becomes ready.
+ *
+ * With the default of 1, each call to g_socket_listener_accept() and
+ * friends waits for a socket to become ready and accepts a single
+ * connection from it. When the listener is handling many connections
+ * per second, it is more efficient to drain the listen queue in one go:
+ * with a larger value, up to @accept_batch connections are accepted
+ * (stopping early if the listen queue is empty), and the ones that are
+ * not returned right away are kept for subsequent accept calls, which
+ * then complete without waiting. A value of 0 accepts until the listen
+ * queue is empty.
+ *
+ * Since: 2.54
+ */
+void
+g_socket_listener_set_accept_batch (GSocketListener *listener,
+                                    guint            accept_batch)
+{
+  g_return_if_fail (G_IS_SOCKET_LISTENER (listener));
+
+  if (listener->priv->accept_batch == accept_batch)
+    return;
+
+  listener->priv->accept_batch = accept_batch;
+  g_object_notify (G_OBJECT (listener), "accept-batch");
+}
+
+/**
+ * g_socket_listener_set_tcp_fast_open:
+ * @listener: a #GSocketListener
+ * @queue_length: the maximum number of pending TCP Fast Open
+ *     connections per socket, or 0 to disable TCP Fast Open
+ *
+ * Sets whether the TCP sockets of @listener accept TCP Fast Open
+ * (RFC 7413) connections, whose first data arrives with the TCP SYN
+ * packet, saving a round trip for clients that connected before.
+ * @queue_length limits the number of such connections that can wait
+ * to be accepted, which bounds the resources an attacker can consume
+ * with spoofed SYN packets.
+ *
+ * This applies to the TCP sockets that are already in @listener as
+ * well as to the ones that are added later. It is currently supported
+ * on Linux, with server support enabled in the `net.ipv4.tcp_fastopen`
+ * sysctl, and elsewhere does nothing. The default is 0.
+ *
+ * Since: 2.54
+ */
+void
+g_socket_listener_set_tcp_fast_open (GSocketListener *listener,
+                                     guint            queue_length)
+{
+  guint i;
+
+  g_return_if_fail (G_IS_SOCKET_LISTENER (listener));
+
+  if (listener->priv->tcp_fast_open == queue_length)
+    return;
+
+  listener->priv->tcp_fast_open = queue_length;
+
+  if (!listener->priv->closed)
+    {
+      for (i = 0; i < listener->priv->sockets->len; i++)
+        set_tcp_fast_open (listener, listener->priv->sockets->pdata[i]);
+      for (i = 0; i < listener->priv->shard_sockets->len; i++)
+        set_tcp_fast_open (listener, listener->priv->shard_sockets->pdata[i]);
+    }
+
+  g_object_notify (G_OBJECT (listener), "tcp-fast-open");
+}
+
 /**
  * g_socket_listener_close:
  * @listener: a #GSocketListener
@@ -975,9 +1231,42 @@ g_socket_listener_close (GSocketListener *listener)
       socket = listener->priv->sockets->pdata[i];
       g_socket_close (socket, NULL);
     }
+  for (i = 0; i < listener->priv->shard_sockets->len; i++)
+    {
+      socket = listener->priv->shard_sockets->pdata[i];
+      g_socket_close (socket, NULL);
+    }
+  g_queue_foreach (&listener->priv->pending, (GFunc) pending_socket_free, NULL);
+  g_queue_clear (&listener->priv->pending);
   listener->priv->closed = TRUE;
 }
 
+/* Used by #GSocketService to serve the listener's sockets itself */
+GPtrArray *
+g_socket_listener_get_sockets (GSocketListener *listener)
+{
+  return listener->priv->sockets;
+}
+
+GObject *
+g_socket_listener_get_source_object (GSocketListener *listener,
+                                     GSocket         *socket)
+{
+  return g_object_get_qdata (G_OBJECT (socket), source_quark);
+}
+
+/* Adds @socket to the sockets that are closed along with the listener,
+ * without accepting connections from it */
+void
+g_socket_listener_add_shard_socket (GSocketListener *listener,
+                                    GSocket         *socket)
+{
+  if (listener->priv->closed)
+    g_socket_close (socket, NULL);
+
+  g_ptr_array_add (listener->priv->shard_sockets, g_object_ref (socket));
+}
+
 /**
  * g_socket_listener_add_any_inet_port:
  * @listener: a #GSocketListener
@@ -1175,7 +1464,7 @@ g_socket_listener_add_any_inet_port (GSocketListener  *listener,
   /* now we actually listen() the sockets and add them to the listener */
   if (socket6 != NULL)
     {
-      g_socket_set_listen_backlog (socket6, listener->priv->listen_backlog);
+      prepare_socket (listener, socket6);
 
       g_signal_emit (listener, signals[EVENT], 0,
                      G_SOCKET_LISTENER_LISTENING, socket6);
@@ -1202,7 +1491,7 @@ g_socket_listener_add_any_inet_port (GSocketListener  *listener,
 
    if (socket4 != NULL)
     {
-      g_socket_set_listen_backlog (socket4, listener->priv->listen_backlog);
+      prepare_socket (listener, socket4);
 
       g_signal_emit (listener, signals[EVENT], 0,
                      G_SOCKET_LISTENER_LISTENING, socket4);
@@ -88,6 +88,12 @@ GSocketListener *       g_socket_listener_new                           (void);
 GLIB_AVAILABLE_IN_ALL
 void                    g_socket_listener_set_backlog                   (GSocketListener     *listener,
 									 int                  listen_backlog);
+GLIB_AVAILABLE_IN_2_54
+void                    g_socket_listener_set_accept_batch              (GSocketListener     *listener,
+                                                                         guint                accept_batch);
+GLIB_AVAILABLE_IN_2_54
+void                    g_socket_listener_set_tcp_fast_open             (GSocketListener     *listener,
+                                                                         guint                queue_length);
 
 GLIB_AVAILABLE_IN_ALL
 gboolean                g_socket_listener_add_socket                    (GSocketListener     *listener,
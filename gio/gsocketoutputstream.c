@@ -33,6 +33,15 @@
 #include "gioerror.h"
 #include "glibintl.h"
 #include "gfiledescriptorbased.h"
+#include "gioprivate.h"
+#include "gtask.h"
+
+#if defined (HAVE_SENDFILE) && defined (HAVE_SYS_SENDFILE_H)
+#include <errno.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#define USE_SENDFILE 1
+#endif
 
 struct _GSocketOutputStreamPrivate
 {
@@ -132,6 +141,30 @@ g_socket_output_stream_write (GOutputStream  *stream,
 				      cancellable, error);
 }
 
+/* Vectors beyond this are left for the next call; sendmsg() fails
+ * outright with more than UIO_MAXIOV of them.
+ */
+#ifdef UIO_MAXIOV
+#define MAX_NUM_VECTORS UIO_MAXIOV
+#else
+#define MAX_NUM_VECTORS 1024
+#endif
+
+static gssize
+g_socket_output_stream_writev (GOutputStream        *stream,
+                               const GOutputVector  *vectors,
+                               gsize                 n_vectors,
+                               GCancellable         *cancellable,
+                               GError              **error)
+{
+  GSocketOutputStream *output_stream = G_SOCKET_OUTPUT_STREAM (stream);
+
+  return g_socket_send_vectors_with_blocking (output_stream->priv->socket,
+                                              vectors,
+                                              MIN (n_vectors, MAX_NUM_VECTORS),
+                                              TRUE, cancellable, error);
+}
+
 static gboolean
 g_socket_output_stream_pollable_is_writable (GPollableOutputStream *pollable)
 {
@@ -153,6 +186,20 @@ g_socket_output_stream_pollable_write_nonblocking (GPollableOutputStream  *polla
 				      NULL, error);
 }
 
+static gssize
+g_socket_output_stream_pollable_writev_nonblocking (GPollableOutputStream  *pollable,
+                                                    const GOutputVector    *vectors,
+                                                    gsize                   n_vectors,
+                                                    GError                **error)
+{
+  GSocketOutputStream *output_stream = G_SOCKET_OUTPUT_STREAM (pollable);
+
+  return g_socket_send_vectors_with_blocking (output_stream->priv->socket,
+                                              vectors,
+                                              MIN (n_vectors, MAX_NUM_VECTORS),
+                                              FALSE, NULL, error);
+}
+
 static GSource *
 g_socket_output_stream_pollable_create_source (GPollableOutputStream *pollable,
 					       GCancellable          *cancellable)
@@ -170,6 +217,220 @@ g_socket_output_stream_pollable_create_source (GPollableOutputStream *pollable,
   return pollable_source;
 }
 
+#ifdef USE_SENDFILE
+/* How much to hand to sendfile() per call; the kernel caps it anyway */
+#define SENDFILE_CHUNK_SIZE (1024 * 1024)
+
+/* Returns the descriptor of @source if the data can be sent straight
+ * from it to the socket, or -1 if it has to be copied.
+ */
+static int
+get_sendfile_fd (GInputStream *source)
+{
+  struct stat buf;
+  int fd;
+
+  if (!G_IS_FILE_DESCRIPTOR_BASED (source))
+    return -1;
+
+  /* sendfile() only reads from descriptors that can be mmap()ed */
+  fd = g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (source));
+  if (fstat (fd, &buf) != 0 || !S_ISREG (buf.st_mode))
+    return -1;
+
+  return fd;
+}
+
+/* Sends as much of @in_fd as it can without copying it through user
+ * space. It stops at the end of the file, or at the first problem of
+ * any kind; the copy loop of the parent class then takes over from the
+ * current file position, and reports any error in the usual way.
+ *
+ * Returns: %TRUE if the socket would block rather than anything else
+ */
+static gboolean
+send_file (GSocketOutputStream *stream,
+           int                  in_fd,
+           gsize               *bytes_sent,
+           GCancellable        *cancellable)
+{
+  int out_fd = g_socket_get_fd (stream->priv->socket);
+
+  while (!g_cancellable_is_cancelled (cancellable))
+    {
+      gssize n;
+
+      n = sendfile (out_fd, in_fd, NULL, SENDFILE_CHUNK_SIZE);
+      if (n > 0)
+        {
+          *bytes_sent += n;
+          continue;
+        }
+      else if (n < 0 && errno == EINTR)
+        continue;
+      else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return TRUE;
+
+      break;
+    }
+
+  return FALSE;
+}
+
+static gssize
+g_socket_output_stream_splice (GOutputStream             *stream,
+                               GInputStream              *source,
+                               GOutputStreamSpliceFlags   flags,
+                               GCancellable              *cancellable,
+                               GError                   **error)
+{
+  GSocketOutputStream *output_stream = G_SOCKET_OUTPUT_STREAM (stream);
+  GSocket *socket = output_stream->priv->socket;
+  gsize bytes_sent = 0;
+  gssize res;
+  int in_fd;
+
+  in_fd = get_sendfile_fd (source);
+  if (in_fd != -1 && g_input_stream_set_pending (source, NULL))
+    {
+      while (send_file (output_stream, in_fd, &bytes_sent, cancellable) &&
+             g_socket_get_blocking (socket))
+        {
+          gint64 timeout = g_socket_get_timeout (socket) * G_USEC_PER_SEC;
+
+          if (!g_socket_condition_timed_wait (socket, G_IO_OUT,
+                                              timeout ? timeout : -1,
+                                              cancellable, NULL))
+            break;
+        }
+
+      g_input_stream_clear_pending (source);
+    }
+
+  /* This copies whatever is left, which is usually nothing, and takes
+   * care of the flags.
+   */
+  res = G_OUTPUT_STREAM_CLASS (g_socket_output_stream_parent_class)->splice (stream, source, flags,
+                                                                           cancellable, error);
+  if (res == -1)
+    return -1;
+
+  return MIN (bytes_sent + res, G_MAXSSIZE);
+}
+
+typedef struct {
+  GInputStream *source;
+  GOutputStreamSpliceFlags flags;
+  int in_fd;
+  gsize bytes_sent;
+} SpliceData;
+
+static void
+splice_data_free (SpliceData *data)
+{
+  g_object_unref (data->source);
+  g_slice_free (SpliceData, data);
+}
+
+static void
+splice_async_parent_cb (GObject      *object,
+                        GAsyncResult *result,
+                        gpointer      user_data)
+{
+  GTask *task = user_data;
+  SpliceData *data = g_task_get_task_data (task);
+  GError *error = NULL;
+  gssize res;
+
+  res = G_OUTPUT_STREAM_CLASS (g_socket_output_stream_parent_class)->splice_finish (G_OUTPUT_STREAM (object),
+                                                                                  result, &error);
+  if (res == -1)
+    g_task_return_error (task, error);
+  else
+    g_task_return_int (task, MIN (data->bytes_sent + res, G_MAXSSIZE));
+
+  g_object_unref (task);
+}
+
+static void
+splice_async_finish_with_parent (GTask *task)
+{
+  SpliceData *data = g_task_get_task_data (task);
+
+  G_OUTPUT_STREAM_CLASS (g_socket_output_stream_parent_class)->splice_async (g_task_get_source_object (task),
+                                                                           data->source, data->flags,
+                                                                           g_task_get_priority (task),
+                                                                           g_task_get_cancellable (task),
+                                                                           splice_async_parent_cb, task);
+}
+
+static gboolean
+splice_async_send_file (GSocket      *socket,
+                        GIOCondition  condition,
+                        gpointer      user_data)
+{
+  GTask *task = user_data;
+  SpliceData *data = g_task_get_task_data (task);
+  GSocketOutputStream *output_stream = g_task_get_source_object (task);
+
+  if (send_file (output_stream, data->in_fd, &data->bytes_sent,
+                 g_task_get_cancellable (task)))
+    {
+      GSource *source;
+
+      source = g_socket_create_source (socket, G_IO_OUT, g_task_get_cancellable (task));
+      g_task_attach_source (task, source, (GSourceFunc) splice_async_send_file);
+      g_source_unref (source);
+
+      return G_SOURCE_REMOVE;
+    }
+
+  g_input_stream_clear_pending (data->source);
+  splice_async_finish_with_parent (task);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+g_socket_output_stream_splice_async (GOutputStream             *stream,
+                                     GInputStream              *source,
+                                     GOutputStreamSpliceFlags   flags,
+                                     int                        io_priority,
+                                     GCancellable              *cancellable,
+                                     GAsyncReadyCallback        callback,
+                                     gpointer                   user_data)
+{
+  GSocketOutputStream *output_stream = G_SOCKET_OUTPUT_STREAM (stream);
+  SpliceData *data;
+  GTask *task;
+
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_socket_output_stream_splice_async);
+  g_task_set_priority (task, io_priority);
+
+  data = g_slice_new0 (SpliceData);
+  data->source = g_object_ref (source);
+  data->flags = flags;
+  data->in_fd = get_sendfile_fd (source);
+  g_task_set_task_data (task, data, (GDestroyNotify) splice_data_free);
+
+  if (data->in_fd != -1 && g_input_stream_set_pending (source, NULL))
+    splice_async_send_file (output_stream->priv->socket, G_IO_OUT, task);
+  else
+    splice_async_finish_with_parent (task);
+}
+
+static gssize
+g_socket_output_stream_splice_finish (GOutputStream  *stream,
+                                      GAsyncResult   *result,
+                                      GError        **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, stream), -1);
+
+  return g_task_propagate_int (G_TASK (result), error);
+}
+#endif /* USE_SENDFILE */
+
 #ifdef G_OS_UNIX
 static int
 g_socket_output_stream_get_fd (GFileDescriptorBased *fd_based)
@@ -191,6 +452,12 @@ g_socket_output_stream_class_init (GSocketOutputStreamClass *klass)
   gobject_class->set_property = g_socket_output_stream_set_property;
 
   goutputstream_class->write_fn = g_socket_output_stream_write;
+  goutputstream_class->writev_fn = g_socket_output_stream_writev;
+#ifdef USE_SENDFILE
+  goutputstream_class->splice = g_socket_output_stream_splice;
+  goutputstream_class->splice_async = g_socket_output_stream_splice_async;
+  goutputstream_class->splice_finish = g_socket_output_stream_splice_finish;
+#endif
 
   g_object_class_install_property (gobject_class, PROP_SOCKET,
 				   g_param_spec_object ("socket",
@@ -214,6 +481,7 @@ g_socket_output_stream_pollable_iface_init (GPollableOutputStreamInterface *ifac
   iface->is_writable = g_socket_output_stream_pollable_is_writable;
   iface->create_source = g_socket_output_stream_pollable_create_source;
   iface->write_nonblocking = g_socket_output_stream_pollable_write_nonblocking;
+  iface->writev_nonblocking = g_socket_output_stream_pollable_writev_nonblocking;
 }
 
 static void
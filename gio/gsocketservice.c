@@ -54,6 +54,18 @@
  * service are thread-safe so these can be used from threads that
  * handle incoming clients.
  *
+ * A service that has to accept a very large number of connections
+ * per second can instead be split into several shards with
+ * g_socket_service_new_sharded() or the #GSocketService:shards
+ * property. Each TCP/IP address that is added to a sharded service is
+ * listened on by one socket per shard, using `SO_REUSEPORT` so that
+ * the kernel balances incoming connections between them, and each
+ * shard accepts connections in its own thread, with its own
+ * #GMainContext as the thread-default context. In that case
+ * #GSocketService::incoming is emitted in the shard threads, so its
+ * handlers must be thread-safe, and they must not drop the last
+ * reference to the service.
+ *
  * Since: 2.22
  */
 
@@ -63,15 +75,43 @@
 #include <gio/gio.h>
 #include "gsocketlistener.h"
 #include "gsocketconnection.h"
+#include "gioprivate.h"
+#include "gnetworking.h"
 #include "glibintl.h"
 
 struct _GSocketServicePrivate
 {
   GCancellable *cancellable;
+  guint n_shards;
+  GPtrArray *shards;
+  guint n_sharded_sockets;
   guint active : 1;
   guint outstanding_accept : 1;
 };
 
+typedef struct _GSocketServiceShard GSocketServiceShard;
+
+typedef struct
+{
+  GSocketServiceShard *shard;
+  GSocket *socket;
+  GObject *source_object;
+} GSocketServiceShardSocket;
+
+struct _GSocketServiceShard
+{
+  GSocketService *service;
+  GThread *thread;
+  GMainContext *context;
+  gint quit;
+
+  /* Protected by the "active" lock */
+  GPtrArray *sockets;
+
+  /* Only used from the shard thread */
+  GList *sources;
+};
+
 static guint g_socket_service_incoming_signal;
 
 G_LOCK_DEFINE_STATIC(active);
@@ -81,12 +121,17 @@ G_DEFINE_TYPE_WITH_PRIVATE (GSocketService, g_socket_service, G_TYPE_SOCKET_LIST
 enum
 {
   PROP_0,
-  PROP_ACTIVE
+  PROP_ACTIVE,
+  PROP_SHARDS
 };
 
 static void g_socket_service_ready (GObject      *object,
 				    GAsyncResult *result,
 				    gpointer      user_data);
+static gboolean g_socket_service_incoming (GSocketService    *service,
+                                           GSocketConnection *connection,
+                                           GObject           *source_object);
+static gboolean get_active                (GSocketService    *service);
 
 static gboolean
 g_socket_service_real_incoming (GSocketService    *service,
@@ -96,12 +141,338 @@ g_socket_service_real_incoming (GSocketService    *service,
   return FALSE;
 }
 
+static void
+shard_socket_free (GSocketServiceShardSocket *shard_socket)
+{
+  g_object_unref (shard_socket->socket);
+  if (shard_socket->source_object)
+    g_object_unref (shard_socket->source_object);
+  g_slice_free (GSocketServiceShardSocket, shard_socket);
+}
+
+static void
+shard_free_sources (GSocketServiceShard *shard)
+{
+  GSource *source;
+
+  while (shard->sources != NULL)
+    {
+      source = shard->sources->data;
+      shard->sources = g_list_delete_link (shard->sources, shard->sources);
+      g_source_destroy (source);
+      g_source_unref (source);
+    }
+}
+
+static gboolean
+shard_accept (GSocket      *socket,
+              GIOCondition  condition,
+              gpointer      user_data)
+{
+  GSocketServiceShardSocket *shard_socket = user_data;
+  GSocketService *service = shard_socket->shard->service;
+  GSocketConnection *connection;
+  GSocket *client;
+  GError *error = NULL;
+
+  /* Each socket only has one shard accepting from it, so drain its
+   * listen queue rather than polling again for every connection */
+  while (get_active (service))
+    {
+      client = g_socket_accept_nonblocking (socket, &error);
+      if (client == NULL)
+        {
+          if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+            g_warning ("fail: %s", error->message);
+          g_error_free (error);
+          break;
+        }
+
+      connection = g_socket_connection_factory_create_connection (client);
+      g_object_unref (client);
+
+      g_socket_service_incoming (service, connection, shard_socket->source_object);
+      g_object_unref (connection);
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+/* Runs in the shard thread */
+static gboolean
+shard_update (gpointer user_data)
+{
+  GSocketServiceShard *shard = user_data;
+  GSocketServiceShardSocket *shard_socket;
+  GSource *source;
+  guint i;
+
+  shard_free_sources (shard);
+
+  G_LOCK (active);
+
+  if (shard->service->priv->active)
+    {
+      for (i = 0; i < shard->sockets->len; i++)
+        {
+          shard_socket = shard->sockets->pdata[i];
+
+          source = g_socket_create_source (shard_socket->socket, G_IO_IN, NULL);
+          g_source_set_callback (source, (GSourceFunc) shard_accept,
+                                 shard_socket, NULL);
+          g_source_attach (source, shard->context);
+
+          shard->sources = g_list_prepend (shard->sources, source);
+        }
+    }
+
+  G_UNLOCK (active);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gpointer
+shard_thread (gpointer user_data)
+{
+  GSocketServiceShard *shard = user_data;
+
+  g_main_context_push_thread_default (shard->context);
+
+  while (!g_atomic_int_get (&shard->quit))
+    g_main_context_iteration (shard->context, TRUE);
+
+  shard_free_sources (shard);
+
+  g_main_context_pop_thread_default (shard->context);
+
+  return NULL;
+}
+
+static void
+shards_queue_update (GSocketService *service)
+{
+  GSocketServiceShard *shard;
+  GSource *source;
+  guint i;
+
+  if (service->priv->shards == NULL)
+    return;
+
+  /* Always go through an idle, so that a shard is never updated from
+   * inside its own accept callback */
+  for (i = 0; i < service->priv->shards->len; i++)
+    {
+      shard = service->priv->shards->pdata[i];
+
+      source = g_idle_source_new ();
+      g_source_set_priority (source, G_PRIORITY_DEFAULT);
+      g_source_set_callback (source, shard_update, shard, NULL);
+      g_source_attach (source, shard->context);
+      g_source_unref (source);
+    }
+}
+
+static void
+set_reuse_port (GSocket *socket)
+{
+#ifdef SO_REUSEPORT
+  /* If this fails, binding the sockets of the other shards will fail
+   * too, and that will be reported then */
+  g_socket_set_option (socket, SOL_SOCKET, SO_REUSEPORT, TRUE, NULL);
+#endif
+}
+
+static GSocket *
+clone_listening_socket (GSocket  *socket,
+                        GError  **error)
+{
+  GSocketAddress *address;
+  GSocket *clone;
+
+  address = g_socket_get_local_address (socket, error);
+  if (address == NULL)
+    return NULL;
+
+  clone = g_socket_new (g_socket_get_family (socket),
+                        g_socket_get_socket_type (socket),
+                        g_socket_get_protocol (socket),
+                        error);
+  if (clone != NULL)
+    {
+      gint value;
+
+      /* Copy the options that g_socket_listener_add_address() and
+       * friends may have set on @socket */
+#if defined (IPPROTO_IPV6) && defined (IPV6_V6ONLY)
+      if (g_socket_get_family (socket) == G_SOCKET_FAMILY_IPV6 &&
+          g_socket_get_option (socket, IPPROTO_IPV6, IPV6_V6ONLY, &value, NULL))
+        g_socket_set_option (clone, IPPROTO_IPV6, IPV6_V6ONLY, value, NULL);
+#endif
+
+#ifdef TCP_FASTOPEN
+      if (g_socket_get_option (socket, IPPROTO_TCP, TCP_FASTOPEN, &value, NULL) &&
+          value != 0)
+        g_socket_set_option (clone, IPPROTO_TCP, TCP_FASTOPEN, value, NULL);
+#endif
+
+      set_reuse_port (clone);
+      g_socket_set_listen_backlog (clone, g_socket_get_listen_backlog (socket));
+
+      if (!g_socket_bind (clone, address, TRUE, error) ||
+          !g_socket_listen (clone, error))
+        g_clear_object (&clone);
+    }
+
+  g_object_unref (address);
+
+  return clone;
+}
+
+static void
+shard_add_socket (GSocketServiceShard *shard,
+                  GSocket             *socket,
+                  GObject             *source_object)
+{
+  GSocketServiceShardSocket *shard_socket;
+
+  shard_socket = g_slice_new (GSocketServiceShardSocket);
+  shard_socket->shard = shard;
+  shard_socket->socket = g_object_ref (socket);
+  shard_socket->source_object = source_object ? g_object_ref (source_object) : NULL;
+
+  G_LOCK (active);
+  g_ptr_array_add (shard->sockets, shard_socket);
+  G_UNLOCK (active);
+}
+
+/* Gives each shard its own copy of the sockets that were added to the
+ * listener since last time. Only internet sockets can be shared with
+ * SO_REUSEPORT; everything else is served by the first shard alone. */
+static void
+shards_add_sockets (GSocketService *service)
+{
+  GSocketListener *listener = G_SOCKET_LISTENER (service);
+  GPtrArray *sockets;
+  GSocket *socket, *clone;
+  GSocketFamily family;
+  GObject *source_object;
+  GError *error = NULL;
+  guint i, j;
+
+  if (service->priv->shards == NULL)
+    return;
+
+  sockets = g_socket_listener_get_sockets (listener);
+
+  for (i = service->priv->n_sharded_sockets; i < sockets->len; i++)
+    {
+      socket = sockets->pdata[i];
+      source_object = g_socket_listener_get_source_object (listener, socket);
+      family = g_socket_get_family (socket);
+
+      shard_add_socket (service->priv->shards->pdata[0], socket, source_object);
+
+      if (family != G_SOCKET_FAMILY_IPV4 && family != G_SOCKET_FAMILY_IPV6)
+        continue;
+
+      for (j = 1; j < service->priv->shards->len; j++)
+        {
+          clone = clone_listening_socket (socket, &error);
+          if (clone == NULL)
+            {
+              g_warning ("fail: %s", error->message);
+              g_clear_error (&error);
+              break;
+            }
+
+          g_socket_listener_add_shard_socket (listener, clone);
+          shard_add_socket (service->priv->shards->pdata[j], clone, source_object);
+          g_object_unref (clone);
+        }
+    }
+
+  service->priv->n_sharded_sockets = sockets->len;
+}
+
+static void
+g_socket_service_event (GSocketListener      *listener,
+                        GSocketListenerEvent  event,
+                        GSocket              *socket,
+                        gpointer              user_data)
+{
+  GSocketService *service = G_SOCKET_SERVICE (listener);
+
+  /* The first socket for an address needs SO_REUSEPORT set before it
+   * is bound too, or the other shards can't bind to it */
+  if (event == G_SOCKET_LISTENER_BINDING && service->priv->n_shards > 1)
+    set_reuse_port (socket);
+}
+
 static void
 g_socket_service_init (GSocketService *service)
 {
   service->priv = g_socket_service_get_instance_private (service);
   service->priv->cancellable = g_cancellable_new ();
+  service->priv->n_shards = 1;
   service->priv->active = TRUE;
+
+  g_signal_connect (service, "event", G_CALLBACK (g_socket_service_event), NULL);
+}
+
+static void
+g_socket_service_constructed (GObject *object)
+{
+  GSocketService *service = G_SOCKET_SERVICE (object);
+  GSocketServiceShard *shard;
+  guint i;
+
+  if (service->priv->n_shards > 1)
+    {
+      service->priv->shards = g_ptr_array_new ();
+
+      for (i = 0; i < service->priv->n_shards; i++)
+        {
+          shard = g_slice_new0 (GSocketServiceShard);
+          shard->service = service;
+          shard->context = g_main_context_new ();
+          shard->sockets = g_ptr_array_new_with_free_func ((GDestroyNotify) shard_socket_free);
+          shard->thread = g_thread_new ("gsocketservice", shard_thread, shard);
+
+          g_ptr_array_add (service->priv->shards, shard);
+        }
+    }
+
+  G_OBJECT_CLASS (g_socket_service_parent_class)
+    ->constructed (object);
+}
+
+static void
+g_socket_service_dispose (GObject *object)
+{
+  GSocketService *service = G_SOCKET_SERVICE (object);
+  GSocketServiceShard *shard;
+  guint i;
+
+  if (service->priv->shards != NULL)
+    {
+      for (i = 0; i < service->priv->shards->len; i++)
+        {
+          shard = service->priv->shards->pdata[i];
+
+          g_atomic_int_set (&shard->quit, TRUE);
+          g_main_context_wakeup (shard->context);
+          g_thread_join (shard->thread);
+
+          g_main_context_unref (shard->context);
+          g_ptr_array_unref (shard->sockets);
+          g_slice_free (GSocketServiceShard, shard);
+        }
+
+      g_clear_pointer (&service->priv->shards, g_ptr_array_unref);
+    }
+
+  G_OBJECT_CLASS (g_socket_service_parent_class)
+    ->dispose (object);
 }
 
 static void
@@ -150,7 +521,11 @@ set_active (GSocketService *service, gboolean active)
       service->priv->active = active;
       notify = TRUE;
 
-      if (active)
+      if (service->priv->n_shards > 1)
+        {
+          /* The shards pick this up in shards_queue_update() below */
+        }
+      else if (active)
         {
           if (service->priv->outstanding_accept)
             g_cancellable_cancel (service->priv->cancellable);
@@ -166,6 +541,9 @@ set_active (GSocketService *service, gboolean active)
 
   G_UNLOCK (active);
 
+  if (notify && service->priv->n_shards > 1)
+    shards_queue_update (service);
+
   if (notify)
     g_object_notify (G_OBJECT (service), "active");
 }
@@ -183,6 +561,9 @@ g_socket_service_get_property (GObject    *object,
     case PROP_ACTIVE:
       g_value_set_boolean (value, get_active (service));
       break;
+    case PROP_SHARDS:
+      g_value_set_uint (value, service->priv->n_shards);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -202,6 +583,9 @@ g_socket_service_set_property (GObject      *object,
     case PROP_ACTIVE:
       set_active (service, g_value_get_boolean (value));
       break;
+    case PROP_SHARDS:
+      service->priv->n_shards = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -213,6 +597,13 @@ g_socket_service_changed (GSocketListener *listener)
 {
   GSocketService  *service = G_SOCKET_SERVICE (listener);
 
+  if (service->priv->n_shards > 1)
+    {
+      shards_add_sockets (service);
+      shards_queue_update (service);
+      return;
+    }
+
   G_LOCK (active);
 
   if (service->priv->active)
@@ -317,6 +708,8 @@ g_socket_service_class_init (GSocketServiceClass *class)
   GObjectClass *gobject_class = G_OBJECT_CLASS (class);
   GSocketListenerClass *listener_class = G_SOCKET_LISTENER_CLASS (class);
 
+  gobject_class->constructed = g_socket_service_constructed;
+  gobject_class->dispose = g_socket_service_dispose;
   gobject_class->finalize = g_socket_service_finalize;
   gobject_class->set_property = g_socket_service_set_property;
   gobject_class->get_property = g_socket_service_get_property;
@@ -362,6 +755,23 @@ g_socket_service_class_init (GSocketServiceClass *class)
                                                          P_("Whether the service is currently accepting connections"),
                                                          TRUE,
                                                          G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocketService:shards:
+   *
+   * The number of shards that the service is split into. If this is
+   * more than 1, each shard listens on its own `SO_REUSEPORT` copy of
+   * the service's TCP/IP sockets and accepts connections from it in a
+   * thread of its own. See the #GSocketService documentation.
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class, PROP_SHARDS,
+                                   g_param_spec_uint ("shards",
+                                                      P_("Shards"),
+                                                      P_("The number of threads accepting connections"),
+                                                      1, G_MAXINT, 1,
+                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -420,3 +830,28 @@ g_socket_service_new (void)
 {
   return g_object_new (G_TYPE_SOCKET_SERVICE, NULL);
 }
+
+/**
+ * g_socket_service_new_sharded:
+ * @n_shards: the number of shards, each with its own thread
+ *
+ * Creates a new #GSocketService that is split into @n_shards shards.
+ * Each TCP/IP address added to it is listened on by @n_shards sockets
+ * using `SO_REUSEPORT`, and each shard accepts connections on its
+ * sockets in its own thread, draining the listen queue every time a
+ * socket becomes ready. #GSocketService::incoming is emitted in the
+ * thread of the shard that accepted the connection.
+ *
+ * Returns: a new #GSocketService.
+ *
+ * Since: 2.54
+ */
+GSocketService *
+g_socket_service_new_sharded (guint n_shards)
+{
+  g_return_val_if_fail (n_shards > 0, NULL);
+
+  return g_object_new (G_TYPE_SOCKET_SERVICE,
+                       "shards", n_shards,
+                       NULL);
+}
@@ -80,6 +80,8 @@ GType           g_socket_service_get_type  (void);
 
 GLIB_AVAILABLE_IN_ALL
 GSocketService *g_socket_service_new       (void);
+GLIB_AVAILABLE_IN_2_54
+GSocketService *g_socket_service_new_sharded (guint n_shards);
 GLIB_AVAILABLE_IN_ALL
 void            g_socket_service_start     (GSocketService *service);
 GLIB_AVAILABLE_IN_ALL
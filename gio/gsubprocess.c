@@ -114,7 +114,7 @@
 #define HAVE_O_CLOEXEC 1
 #endif
 
-#define COMMUNICATE_READ_SIZE 4096
+#define COMMUNICATE_READ_SIZE 65536
 
 /* A GSubprocess can have two possible states: running and not.
  *
@@ -166,6 +166,9 @@ struct _GSubprocess
   GOutputStream *stdin_pipe;
   GInputStream  *stdout_pipe;
   GInputStream  *stderr_pipe;
+
+  /* chunk size for g_subprocess_communicate_stream() */
+  gsize read_size;
 };
 
 G_DEFINE_TYPE_WITH_CODE (GSubprocess, g_subprocess, G_TYPE_OBJECT,
@@ -580,6 +583,27 @@ initable_init (GInitable     *initable,
       g_source_unref (source);
     }
 
+  self->read_size = COMMUNICATE_READ_SIZE;
+
+#if defined (G_OS_UNIX) && defined (F_SETPIPE_SZ)
+  if (success && self->launcher && self->launcher->pipe_size > 0)
+    {
+      gint size = (gint) MIN (self->launcher->pipe_size, G_MAXINT);
+
+      /* Failures (eg: EPERM above /proc/sys/fs/pipe-max-size) leave
+       * the default capacity, which is fine.
+       */
+      for (i = 0; i < 3; i++)
+        if (pipe_fds[i] != -1)
+          {
+            gint result = fcntl (pipe_fds[i], F_SETPIPE_SZ, size);
+
+            if (i > 0 && result > 0)
+              self->read_size = MAX (self->read_size, (gsize) result);
+          }
+    }
+#endif
+
 #ifdef G_OS_UNIX
 out:
 #endif
@@ -1393,6 +1417,9 @@ typedef struct
   GMemoryOutputStream *stdout_buf;
   GMemoryOutputStream *stderr_buf;
 
+  GSubprocessOutputFunc output_func;
+  gpointer              output_data;
+
   GCancellable *cancellable;
   GSource      *cancellable_source;
 
@@ -1400,6 +1427,39 @@ typedef struct
   gboolean      reported_error;
 } CommunicateState;
 
+static void
+g_subprocess_communicate_op_done (GTask  *task,
+                                  GError *error)
+{
+  CommunicateState *state = g_task_get_task_data (task);
+
+  state->outstanding_ops--;
+
+  if (error)
+    {
+      /* Only report the first error we see.
+       *
+       * We might be seeing an error as a result of the cancellation
+       * done when the process quits.
+       */
+      if (!state->reported_error)
+        {
+          state->reported_error = TRUE;
+          g_cancellable_cancel (state->cancellable);
+          g_task_return_error (task, error);
+        }
+      else
+        g_error_free (error);
+    }
+  else if (state->outstanding_ops == 0)
+    {
+      g_task_return_boolean (task, TRUE);
+    }
+
+  /* And drop the original ref */
+  g_object_unref (task);
+}
+
 static void
 g_subprocess_communicate_made_progress (GObject      *source_object,
                                         GAsyncResult *result,
@@ -1418,8 +1478,6 @@ g_subprocess_communicate_made_progress (GObject      *source_object,
   state = g_task_get_task_data (task);
   source = source_object;
 
-  state->outstanding_ops--;
-
   if (source == subprocess->stdin_pipe ||
       source == state->stdout_buf ||
       source == state->stderr_buf)
@@ -1452,29 +1510,54 @@ g_subprocess_communicate_made_progress (GObject      *source_object,
     g_assert_not_reached ();
 
  out:
-  if (error)
+  g_subprocess_communicate_op_done (task, error);
+}
+
+/* With an output function, stdout and stderr are read in chunks which
+ * are handed over as they arrive, rather than spliced into memory
+ * streams.
+ */
+static void
+g_subprocess_communicate_read_done (GObject      *source_object,
+                                    GAsyncResult *result,
+                                    gpointer      user_data)
+{
+  GInputStream *stream = G_INPUT_STREAM (source_object);
+  GTask *task = user_data;
+  GSubprocess *subprocess;
+  CommunicateState *state;
+  GError *error = NULL;
+  GBytes *bytes;
+
+  subprocess = g_task_get_source_object (task);
+  state = g_task_get_task_data (task);
+
+  bytes = g_input_stream_read_bytes_finish (stream, result, &error);
+  if (bytes == NULL)
+    goto out;
+
+  if (g_bytes_get_size (bytes) == 0)
     {
-      /* Only report the first error we see.
-       *
-       * We might be seeing an error as a result of the cancellation
-       * done when the process quits.
-       */
-      if (!state->reported_error)
-        {
-          state->reported_error = TRUE;
-          g_cancellable_cancel (state->cancellable);
-          g_task_return_error (task, error);
-        }
-      else
-        g_error_free (error);
+      /* EOF */
+      g_input_stream_close (stream, NULL, &error);
     }
-  else if (state->outstanding_ops == 0)
+  else if (!state->reported_error)
     {
-      g_task_return_boolean (task, TRUE);
+      state->output_func (subprocess, bytes, stream == subprocess->stderr_pipe,
+                          state->output_data);
+      g_bytes_unref (bytes);
+
+      /* The next read takes over our ref on the task */
+      g_input_stream_read_bytes_async (stream, subprocess->read_size,
+                                       G_PRIORITY_DEFAULT, state->cancellable,
+                                       g_subprocess_communicate_read_done, task);
+      return;
     }
 
-  /* And drop the original ref */
-  g_object_unref (task);
+  g_bytes_unref (bytes);
+
+ out:
+  g_subprocess_communicate_op_done (task, error);
 }
 
 static gboolean
@@ -1507,12 +1590,14 @@ g_subprocess_communicate_state_free (gpointer data)
 }
 
 static CommunicateState *
-g_subprocess_communicate_internal (GSubprocess         *subprocess,
-                                   gboolean             add_nul,
-                                   GBytes              *stdin_buf,
-                                   GCancellable        *cancellable,
-                                   GAsyncReadyCallback  callback,
-                                   gpointer             user_data)
+g_subprocess_communicate_internal (GSubprocess           *subprocess,
+                                   gboolean               add_nul,
+                                   GBytes                *stdin_buf,
+                                   GSubprocessOutputFunc  output_func,
+                                   gpointer               output_data,
+                                   GCancellable          *cancellable,
+                                   GAsyncReadyCallback    callback,
+                                   gpointer               user_data)
 {
   CommunicateState *state;
   GTask *task;
@@ -1525,6 +1610,8 @@ g_subprocess_communicate_internal (GSubprocess         *subprocess,
 
   state->cancellable = g_cancellable_new ();
   state->add_nul = add_nul;
+  state->output_func = output_func;
+  state->output_data = output_data;
 
   if (cancellable)
     {
@@ -1545,7 +1632,14 @@ g_subprocess_communicate_internal (GSubprocess         *subprocess,
       state->outstanding_ops++;
     }
 
-  if (subprocess->stdout_pipe)
+  if (subprocess->stdout_pipe && output_func)
+    {
+      g_input_stream_read_bytes_async (subprocess->stdout_pipe, subprocess->read_size,
+                                       G_PRIORITY_DEFAULT, state->cancellable,
+                                       g_subprocess_communicate_read_done, g_object_ref (task));
+      state->outstanding_ops++;
+    }
+  else if (subprocess->stdout_pipe)
     {
       state->stdout_buf = (GMemoryOutputStream*)g_memory_output_stream_new_resizable ();
       g_output_stream_splice_async ((GOutputStream*)state->stdout_buf, subprocess->stdout_pipe,
@@ -1555,7 +1649,14 @@ g_subprocess_communicate_internal (GSubprocess         *subprocess,
       state->outstanding_ops++;
     }
 
-  if (subprocess->stderr_pipe)
+  if (subprocess->stderr_pipe && output_func)
+    {
+      g_input_stream_read_bytes_async (subprocess->stderr_pipe, subprocess->read_size,
+                                       G_PRIORITY_DEFAULT, state->cancellable,
+                                       g_subprocess_communicate_read_done, g_object_ref (task));
+      state->outstanding_ops++;
+    }
+  else if (subprocess->stderr_pipe)
     {
       state->stderr_buf = (GMemoryOutputStream*)g_memory_output_stream_new_resizable ();
       g_output_stream_splice_async ((GOutputStream*)state->stderr_buf, subprocess->stderr_pipe,
@@ -1645,7 +1746,7 @@ g_subprocess_communicate (GSubprocess   *subprocess,
   g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
   g_subprocess_sync_setup ();
-  g_subprocess_communicate_internal (subprocess, FALSE, stdin_buf, cancellable,
+  g_subprocess_communicate_internal (subprocess, FALSE, stdin_buf, NULL, NULL, cancellable,
                                      g_subprocess_sync_done, &result);
   g_subprocess_sync_complete (&result);
   success = g_subprocess_communicate_finish (subprocess, result, stdout_buf, stderr_buf, error);
@@ -1676,7 +1777,7 @@ g_subprocess_communicate_async (GSubprocess         *subprocess,
   g_return_if_fail (stdin_buf == NULL || (subprocess->flags & G_SUBPROCESS_FLAGS_STDIN_PIPE));
   g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 
-  g_subprocess_communicate_internal (subprocess, FALSE, stdin_buf, cancellable, callback, user_data);
+  g_subprocess_communicate_internal (subprocess, FALSE, stdin_buf, NULL, NULL, cancellable, callback, user_data);
 }
 
 /**
@@ -1755,7 +1856,7 @@ g_subprocess_communicate_utf8 (GSubprocess   *subprocess,
   stdin_bytes = g_bytes_new (stdin_buf, stdin_buf_len);
 
   g_subprocess_sync_setup ();
-  g_subprocess_communicate_internal (subprocess, TRUE, stdin_bytes, cancellable,
+  g_subprocess_communicate_internal (subprocess, TRUE, stdin_bytes, NULL, NULL, cancellable,
                                      g_subprocess_sync_done, &result);
   g_subprocess_sync_complete (&result);
   success = g_subprocess_communicate_utf8_finish (subprocess, result, stdout_buf, stderr_buf, error);
@@ -1794,7 +1895,7 @@ g_subprocess_communicate_utf8_async (GSubprocess         *subprocess,
     stdin_buf_len = strlen (stdin_buf);
   stdin_bytes = g_bytes_new (stdin_buf, stdin_buf_len);
 
-  g_subprocess_communicate_internal (subprocess, TRUE, stdin_bytes, cancellable, callback, user_data);
+  g_subprocess_communicate_internal (subprocess, TRUE, stdin_bytes, NULL, NULL, cancellable, callback, user_data);
 
   g_bytes_unref (stdin_bytes);
 }
@@ -1874,3 +1975,123 @@ g_subprocess_communicate_utf8_finish (GSubprocess   *subprocess,
   g_object_unref (result);
   return ret;
 }
+
+/**
+ * g_subprocess_communicate_stream:
+ * @subprocess: a #GSubprocess
+ * @stdin_buf: (nullable): data to send to the stdin of the subprocess, or %NULL
+ * @output_func: (scope call): function called with each chunk of output
+ * @output_data: (closure output_func): data to pass to @output_func
+ * @cancellable: a #GCancellable
+ * @error: a pointer to a %NULL #GError pointer, or %NULL
+ *
+ * Like g_subprocess_communicate(), but hands the output of the
+ * subprocess to @output_func as it arrives instead of collecting it,
+ * so that output of any size can be processed in constant memory.
+ *
+ * @output_func is called in the thread-default main context of the
+ * caller (a private one, in this synchronous version) with chunks of
+ * stdout and stderr in the order they were read from each pipe.  No
+ * order is kept between the two pipes.  The size of the chunks follows
+ * g_subprocess_launcher_set_pipe_size().
+ *
+ * Output that does not need to pass through this process at all is
+ * better sent straight from the child to its destination, with
+ * g_subprocess_launcher_set_stdout_file_path() or
+ * g_subprocess_launcher_take_stdout_fd() (eg: with the fd of a
+ * #GSocket).
+ *
+ * In case of any error (including cancellation), %FALSE will be
+ * returned with @error set, and @output_func will not be called again.
+ * Some output may already have been passed to it.
+ *
+ * Returns: %TRUE if successful
+ *
+ * Since: 2.54
+ **/
+gboolean
+g_subprocess_communicate_stream (GSubprocess           *subprocess,
+                                 GBytes                *stdin_buf,
+                                 GSubprocessOutputFunc  output_func,
+                                 gpointer               output_data,
+                                 GCancellable          *cancellable,
+                                 GError               **error)
+{
+  GAsyncResult *result = NULL;
+  gboolean success;
+
+  g_return_val_if_fail (G_IS_SUBPROCESS (subprocess), FALSE);
+  g_return_val_if_fail (stdin_buf == NULL || (subprocess->flags & G_SUBPROCESS_FLAGS_STDIN_PIPE), FALSE);
+  g_return_val_if_fail (output_func != NULL, FALSE);
+  g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  g_subprocess_sync_setup ();
+  g_subprocess_communicate_internal (subprocess, FALSE, stdin_buf, output_func, output_data,
+                                     cancellable, g_subprocess_sync_done, &result);
+  g_subprocess_sync_complete (&result);
+  success = g_subprocess_communicate_stream_finish (subprocess, result, error);
+  g_object_unref (result);
+
+  return success;
+}
+
+/**
+ * g_subprocess_communicate_stream_async:
+ * @subprocess: Self
+ * @stdin_buf: (nullable): Input data, or %NULL
+ * @output_func: Function called with each chunk of output
+ * @output_data: (closure output_func): Data to pass to @output_func
+ * @cancellable: (nullable): Cancellable
+ * @callback: Callback
+ * @user_data: User data
+ *
+ * Asynchronous version of g_subprocess_communicate_stream().  Complete
+ * invocation with g_subprocess_communicate_stream_finish().
+ *
+ * @output_func is called in the thread-default main context of the
+ * caller, and not after @callback.
+ *
+ * Since: 2.54
+ */
+void
+g_subprocess_communicate_stream_async (GSubprocess           *subprocess,
+                                       GBytes                *stdin_buf,
+                                       GSubprocessOutputFunc  output_func,
+                                       gpointer               output_data,
+                                       GCancellable          *cancellable,
+                                       GAsyncReadyCallback    callback,
+                                       gpointer               user_data)
+{
+  g_return_if_fail (G_IS_SUBPROCESS (subprocess));
+  g_return_if_fail (stdin_buf == NULL || (subprocess->flags & G_SUBPROCESS_FLAGS_STDIN_PIPE));
+  g_return_if_fail (output_func != NULL);
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  g_subprocess_communicate_internal (subprocess, FALSE, stdin_buf, output_func, output_data,
+                                     cancellable, callback, user_data);
+}
+
+/**
+ * g_subprocess_communicate_stream_finish:
+ * @subprocess: Self
+ * @result: Result
+ * @error: Error
+ *
+ * Complete an invocation of g_subprocess_communicate_stream_async().
+ *
+ * Returns: %TRUE if successful
+ *
+ * Since: 2.54
+ */
+gboolean
+g_subprocess_communicate_stream_finish (GSubprocess   *subprocess,
+                                        GAsyncResult  *result,
+                                        GError       **error)
+{
+  g_return_val_if_fail (G_IS_SUBPROCESS (subprocess), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, subprocess), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
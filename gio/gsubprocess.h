@@ -162,6 +162,27 @@ gboolean        g_subprocess_communicate_utf8_finish    (GSubprocess          *s
                                                          char                **stderr_buf,
                                                          GError              **error);
 
+GLIB_AVAILABLE_IN_2_54
+gboolean         g_subprocess_communicate_stream        (GSubprocess          *subprocess,
+                                                         GBytes               *stdin_buf,
+                                                         GSubprocessOutputFunc output_func,
+                                                         gpointer              output_data,
+                                                         GCancellable         *cancellable,
+                                                         GError              **error);
+GLIB_AVAILABLE_IN_2_54
+void            g_subprocess_communicate_stream_async   (GSubprocess          *subprocess,
+                                                         GBytes               *stdin_buf,
+                                                         GSubprocessOutputFunc output_func,
+                                                         gpointer              output_data,
+                                                         GCancellable         *cancellable,
+                                                         GAsyncReadyCallback   callback,
+                                                         gpointer              user_data);
+
+GLIB_AVAILABLE_IN_2_54
+gboolean        g_subprocess_communicate_stream_finish  (GSubprocess          *subprocess,
+                                                         GAsyncResult         *result,
+                                                         GError              **error);
+
 G_END_DECLS
 
 #endif /* __G_SUBPROCESS_H__ */
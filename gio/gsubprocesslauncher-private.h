@@ -31,6 +31,7 @@ struct _GSubprocessLauncher
   gboolean path_from_envp;
   char **envp;
   char *cwd;
+  gsize pipe_size;
 
 #ifdef G_OS_UNIX
   gint stdin_fd;
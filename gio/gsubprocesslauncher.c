@@ -344,6 +344,32 @@ g_subprocess_launcher_set_cwd (GSubprocessLauncher *self,
   self->cwd = g_strdup (cwd);
 }
 
+/**
+ * g_subprocess_launcher_set_pipe_size:
+ * @self: a #GSubprocessLauncher
+ * @size: the capacity in bytes, or 0 for the system default
+ *
+ * Sets the capacity of the pipes created for %G_SUBPROCESS_FLAGS_STDIN_PIPE,
+ * %G_SUBPROCESS_FLAGS_STDOUT_PIPE and %G_SUBPROCESS_FLAGS_STDERR_PIPE.
+ *
+ * A child that writes a lot of output blocks less often, and each read
+ * in the parent returns more data, when its pipes are larger than the
+ * default (usually 64 KiB).  g_subprocess_communicate_stream() also
+ * reads in chunks of this size.
+ *
+ * This is a hint.  The size is rounded up by the system, capped at
+ * the limit it allows to unprivileged processes, and ignored where
+ * pipe capacities cannot be changed (ie: outside of Linux).
+ *
+ * Since: 2.54
+ **/
+void
+g_subprocess_launcher_set_pipe_size (GSubprocessLauncher *self,
+                                     gsize                size)
+{
+  self->pipe_size = size;
+}
+
 /**
  * g_subprocess_launcher_set_flags:
  * @self: a #GSubprocessLauncher
@@ -76,6 +76,9 @@ void                    g_subprocess_launcher_set_cwd                   (GSubpro
 GLIB_AVAILABLE_IN_2_40
 void                    g_subprocess_launcher_set_flags                 (GSubprocessLauncher   *self,
                                                                          GSubprocessFlags       flags);
+GLIB_AVAILABLE_IN_2_54
+void                    g_subprocess_launcher_set_pipe_size             (GSubprocessLauncher   *self,
+                                                                         gsize                  size);
 
 /* Extended I/O control, only available on UNIX */
 #ifdef G_OS_UNIX
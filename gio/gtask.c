@@ -555,6 +555,7 @@ struct _GTask {
   gboolean completed;
 
   GTaskThreadFunc task_func;
+  GTaskExecutor *executor;
   GMutex lock;
   GCond cond;
   gboolean return_on_cancel;
@@ -572,6 +573,8 @@ struct _GTask {
   GDestroyNotify result_destroy;
   gboolean had_error;
   gboolean result_set;
+
+  GTask *next_completion;  /* protected by the completion_batches lock */
 };
 
 #define G_TASK_IS_THREADED(task) ((task)->task_func != NULL)
@@ -594,14 +597,40 @@ G_DEFINE_TYPE_WITH_CODE (GTask, g_task, G_TYPE_OBJECT,
                                                 g_task_async_result_iface_init);
                          g_task_thread_pool_init ();)
 
-static GThreadPool *task_pool;
-static GMutex task_pool_mutex;
+/**
+ * GTaskExecutor:
+ *
+ * An opaque structure representing a pool of threads on which #GTask
+ * runs its #GTaskThreadFunc. See g_task_set_executor().
+ *
+ * Since: 2.54
+ */
+struct _GTaskExecutor
+{
+  gchar *name;
+  gint base_size;
+
+  GThreadPool *pool;
+  GMutex mutex;
+  GSource *manager;  /* elastic executors only */
+  guint64 wait_time;
+  gint tasks_running;
+
+  gint ref_count;
+};
+
+G_DEFINE_BOXED_TYPE (GTaskExecutor, g_task_executor,
+                     g_task_executor_ref, g_task_executor_unref)
+
+static GTaskExecutor *default_executor;
 static GPrivate task_private = G_PRIVATE_INIT (NULL);
-static GSource *task_pool_manager;
-static guint64 task_wait_time;
-static gint tasks_running;
 
-/* When the task pool fills up and blocks, and the program keeps
+/* Held while an executor's manager source runs, and while it is
+ * destroyed, so that a manager never touches a freed executor.
+ */
+static GMutex executor_manager_lock;
+
+/* When an elastic executor fills up and blocks, and the program keeps
  * queueing more tasks, we will slowly add more threads to the pool
  * (in case the existing tasks are trying to queue subtasks of their
  * own) until tasks start completing again. These "overflow" threads
@@ -630,6 +659,7 @@ g_task_finalize (GObject *object)
 
   g_clear_object (&task->source_object);
   g_clear_object (&task->cancellable);
+  g_clear_pointer (&task->executor, g_task_executor_unref);
 
   if (task->context)
     g_main_context_unref (task->context);
@@ -971,6 +1001,36 @@ g_task_set_source_tag (GTask    *task,
   TRACE (GIO_TASK_SET_SOURCE_TAG (task, source_tag));
 }
 
+/**
+ * g_task_set_executor:
+ * @task: the #GTask
+ * @executor: (nullable): a #GTaskExecutor, or %NULL for the default one
+ *
+ * Sets the #GTaskExecutor whose threads g_task_run_in_thread() and
+ * g_task_run_in_thread_sync() will run @task on. If you do not call
+ * this, @task runs on the default executor shared by all of GIO.
+ *
+ * Tasks queued on the same executor are started in order of their
+ * g_task_set_priority() priority; tasks on different executors never
+ * wait for each other's threads.
+ *
+ * This must be called before @task is run in a thread.
+ *
+ * Since: 2.54
+ */
+void
+g_task_set_executor (GTask         *task,
+                     GTaskExecutor *executor)
+{
+  g_return_if_fail (G_IS_TASK (task));
+  g_return_if_fail (!G_TASK_IS_THREADED (task));
+
+  if (executor)
+    g_task_executor_ref (executor);
+  g_clear_pointer (&task->executor, g_task_executor_unref);
+  task->executor = executor;
+}
+
 /**
  * g_task_get_source_object:
  * @task: a #GTask
@@ -1037,6 +1097,25 @@ g_task_get_priority (GTask *task)
   return task->priority;
 }
 
+/**
+ * g_task_get_executor:
+ * @task: a #GTask
+ *
+ * Gets the #GTaskExecutor set with g_task_set_executor().
+ *
+ * Returns: (nullable) (transfer none): @task's #GTaskExecutor, or %NULL
+ *   if @task runs on the default executor
+ *
+ * Since: 2.54
+ */
+GTaskExecutor *
+g_task_get_executor (GTask *task)
+{
+  g_return_val_if_fail (G_IS_TASK (task), NULL);
+
+  return task->executor;
+}
+
 /**
  * g_task_get_context:
  * @task: a #GTask
@@ -1153,12 +1232,162 @@ g_task_return_now (GTask *task)
   g_main_context_pop_thread_default (task->context);
 }
 
+/* Tasks that cannot complete immediately are queued on a completion
+ * batch: a source holding an intrusive list of tasks, completed in one
+ * dispatch. Completing in an idle source of its own ran each task after
+ * every source attached before it returned (for instance progress
+ * updates sent with g_main_context_invoke() from the task's thread), so
+ * a batch only accepts more tasks as long as no other source has been
+ * attached to its context since it was. In the common case of many
+ * tasks returning in a row, that saves creating, attaching and
+ * destroying an idle source per task.
+ *
+ * @completion_batches maps each context to its open batches, at most
+ * one per priority. A batch is closed once it dispatches or stops
+ * being the last source attached.
+ */
+typedef struct
+{
+  GSource source;
+  GMainContext *context;  /* unowned; only used as a key */
+
+  GTask *head;
+  GTask *tail;
+} GTaskCompletionBatch;
+
+G_LOCK_DEFINE_STATIC (completion_batches);
+static GHashTable *completion_batches;  /* GMainContext -> GSList<GTaskCompletionBatch> */
+
+/* Holds completion_batches lock */
+static void
+completion_batch_close (GTaskCompletionBatch *batch)
+{
+  GSList *batches, *l;
+
+  batches = g_hash_table_lookup (completion_batches, batch->context);
+  l = g_slist_find (batches, batch);
+  if (l == NULL)
+    return;
+
+  batches = g_slist_delete_link (batches, l);
+  if (batches != NULL)
+    g_hash_table_replace (completion_batches, batch->context, batches);
+  else
+    g_hash_table_remove (completion_batches, batch->context);
+}
+
+static void g_task_complete_in_batch (GTask *task);
+
 static gboolean
-complete_in_idle_cb (gpointer task)
+completion_batch_dispatch (GSource     *source,
+                           GSourceFunc  callback,
+                           gpointer     user_data)
 {
-  g_task_return_now (task);
-  g_object_unref (task);
-  return FALSE;
+  GTaskCompletionBatch *batch = (GTaskCompletionBatch *) source;
+  GTask *task, *next;
+
+  G_LOCK (completion_batches);
+  completion_batch_close (batch);
+  task = batch->head;
+  batch->head = batch->tail = NULL;
+  G_UNLOCK (completion_batches);
+
+  for (; task != NULL; task = next)
+    {
+      next = task->next_completion;
+      task->next_completion = NULL;
+
+      /* A task can join a batch that is already due to dispatch in
+       * the iteration it was created in; it has to wait for the next.
+       */
+      if (task->creation_time >= g_source_get_time (source))
+        {
+          g_task_complete_in_batch (task);
+          continue;
+        }
+
+      g_task_return_now (task);
+      g_object_unref (task);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+completion_batch_finalize (GSource *source)
+{
+  GTaskCompletionBatch *batch = (GTaskCompletionBatch *) source;
+
+  /* Every queued task holds a ref on the context, so a batch can only
+   * be destroyed without dispatching once it is empty.
+   */
+  g_assert (batch->head == NULL);
+
+  G_LOCK (completion_batches);
+  completion_batch_close (batch);
+  G_UNLOCK (completion_batches);
+}
+
+static GSourceFuncs completion_batch_funcs = {
+  NULL,
+  NULL,
+  completion_batch_dispatch,
+  completion_batch_finalize
+};
+
+/* Steals the caller's reference on @task */
+static void
+g_task_complete_in_batch (GTask *task)
+{
+  GTaskCompletionBatch *batch = NULL;
+  GSList *batches, *l;
+  GSource *source;
+
+  G_LOCK (completion_batches);
+
+  if (completion_batches == NULL)
+    completion_batches = g_hash_table_new (NULL, NULL);
+
+  batches = g_hash_table_lookup (completion_batches, task->context);
+  for (l = batches; l != NULL; l = l->next)
+    {
+      if (g_source_get_priority (l->data) == task->priority)
+        {
+          batch = l->data;
+          break;
+        }
+    }
+
+  if (batch != NULL &&
+      GLIB_PRIVATE_CALL (g_main_context_peek_next_id) (task->context) ==
+      g_source_get_id ((GSource *) batch) + 1)
+    {
+      batch->tail->next_completion = task;
+      batch->tail = task;
+      G_UNLOCK (completion_batches);
+      return;
+    }
+
+  if (batch != NULL)
+    completion_batch_close (batch);
+
+  source = g_source_new (&completion_batch_funcs, sizeof (GTaskCompletionBatch));
+  batch = (GTaskCompletionBatch *) source;
+  batch->context = task->context;
+  batch->head = batch->tail = task;
+  g_source_set_name (source, "[gio] GTask completion batch");
+  g_source_set_priority (source, task->priority);
+  g_source_set_ready_time (source, 0);
+
+  /* The context owns the batch from here on */
+  g_source_attach (source, task->context);
+  g_source_unref (source);
+
+  batches = g_hash_table_lookup (completion_batches, task->context);
+  batches = g_slist_prepend (batches, batch);
+  g_hash_table_replace (completion_batches, task->context, batches);
+
+  G_UNLOCK (completion_batches);
 }
 
 typedef enum {
@@ -1207,10 +1436,7 @@ g_task_return (GTask           *task,
     }
 
   /* Otherwise, complete in the next iteration */
-  source = g_idle_source_new ();
-  g_source_set_name (source, "[gio] complete_in_idle_cb");
-  g_task_attach_source (task, source, complete_in_idle_cb);
-  g_source_unref (source);
+  g_task_complete_in_batch (task);
 }
 
 
@@ -1270,50 +1496,72 @@ g_task_thread_complete (GTask *task)
     g_task_return (task, G_TASK_RETURN_FROM_THREAD);
 }
 
+static GThreadPool *
+g_task_get_thread_pool (GTask *task)
+{
+  return task->executor ? task->executor->pool : default_executor->pool;
+}
+
 static gboolean
-task_pool_manager_timeout (gpointer user_data)
+executor_manager_timeout (gpointer user_data)
 {
-  g_mutex_lock (&task_pool_mutex);
-  g_thread_pool_set_max_threads (task_pool, tasks_running + 1, NULL);
-  g_source_set_ready_time (task_pool_manager, -1);
-  g_mutex_unlock (&task_pool_mutex);
+  GTaskExecutor *executor = user_data;
+
+  g_mutex_lock (&executor_manager_lock);
+  if (!g_source_is_destroyed (g_main_current_source ()))
+    {
+      g_mutex_lock (&executor->mutex);
+      g_thread_pool_set_max_threads (executor->pool, executor->tasks_running + 1, NULL);
+      g_source_set_ready_time (executor->manager, -1);
+      g_mutex_unlock (&executor->mutex);
+    }
+  g_mutex_unlock (&executor_manager_lock);
 
   return TRUE;
 }
 
 static void
-g_task_thread_setup (void)
+g_task_thread_setup (GTaskExecutor *executor)
 {
   g_private_set (&task_private, GUINT_TO_POINTER (TRUE));
-  g_mutex_lock (&task_pool_mutex);
-  tasks_running++;
-
-  if (tasks_running == G_TASK_POOL_SIZE)
-    task_wait_time = G_TASK_WAIT_TIME_BASE;
-  else if (tasks_running > G_TASK_POOL_SIZE && task_wait_time < G_TASK_WAIT_TIME_MAX)
-    task_wait_time *= G_TASK_WAIT_TIME_MULTIPLIER;
+  g_mutex_lock (&executor->mutex);
+  executor->tasks_running++;
 
-  if (tasks_running >= G_TASK_POOL_SIZE)
-    g_source_set_ready_time (task_pool_manager, g_get_monotonic_time () + task_wait_time);
+  if (executor->manager)
+    {
+      if (executor->tasks_running == executor->base_size)
+        executor->wait_time = G_TASK_WAIT_TIME_BASE;
+      else if (executor->tasks_running > executor->base_size &&
+               executor->wait_time < G_TASK_WAIT_TIME_MAX)
+        executor->wait_time *= G_TASK_WAIT_TIME_MULTIPLIER;
+
+      if (executor->tasks_running >= executor->base_size)
+        g_source_set_ready_time (executor->manager,
+                                 g_get_monotonic_time () + executor->wait_time);
+    }
 
-  g_mutex_unlock (&task_pool_mutex);
+  g_mutex_unlock (&executor->mutex);
 }
 
 static void
-g_task_thread_cleanup (void)
+g_task_thread_cleanup (GTaskExecutor *executor)
 {
   gint tasks_pending;
 
-  g_mutex_lock (&task_pool_mutex);
-  tasks_pending = g_thread_pool_unprocessed (task_pool);
+  g_mutex_lock (&executor->mutex);
+
+  if (executor->manager)
+    {
+      tasks_pending = g_thread_pool_unprocessed (executor->pool);
 
-  if (tasks_running > G_TASK_POOL_SIZE)
-    g_thread_pool_set_max_threads (task_pool, tasks_running - 1, NULL);
-  else if (tasks_running + tasks_pending < G_TASK_POOL_SIZE)
-    g_source_set_ready_time (task_pool_manager, -1);
+      if (executor->tasks_running > executor->base_size)
+        g_thread_pool_set_max_threads (executor->pool, executor->tasks_running - 1, NULL);
+      else if (executor->tasks_running + tasks_pending < executor->base_size)
+        g_source_set_ready_time (executor->manager, -1);
+    }
 
-  tasks_running--;
-  g_mutex_unlock (&task_pool_mutex);
+  executor->tasks_running--;
+  g_mutex_unlock (&executor->mutex);
   g_private_set (&task_private, GUINT_TO_POINTER (FALSE));
 }
 
@@ -1322,15 +1570,19 @@ g_task_thread_pool_thread (gpointer thread_data,
                            gpointer pool_data)
 {
   GTask *task = thread_data;
+  GTaskExecutor *executor = pool_data;
 
-  g_task_thread_setup ();
+  /* @task may hold the last reference to @executor */
+  g_task_executor_ref (executor);
+  g_task_thread_setup (executor);
 
   task->task_func (task, task->source_object, task->task_data,
                    task->cancellable);
   g_task_thread_complete (task);
   g_object_unref (task);
 
-  g_task_thread_cleanup ();
+  g_task_thread_cleanup (executor);
+  g_task_executor_unref (executor);
 }
 
 static void
@@ -1342,7 +1594,7 @@ task_thread_cancelled (GCancellable *cancellable,
   /* Move this task to the front of the queue - no need for
    * a complete resorting of the queue.
    */
-  g_thread_pool_move_to_front (task_pool, task);
+  g_thread_pool_move_to_front (g_task_get_thread_pool (task), task);
 
   g_mutex_lock (&task->lock);
   task->thread_cancelled = TRUE;
@@ -1389,7 +1641,7 @@ g_task_start_task_thread (GTask           *task,
         {
           task->thread_cancelled = task->thread_complete = TRUE;
           TRACE (GIO_TASK_AFTER_RUN_IN_THREAD (task, task->thread_cancelled));
-          g_thread_pool_push (task_pool, g_object_ref (task), NULL);
+          g_thread_pool_push (g_task_get_thread_pool (task), g_object_ref (task), NULL);
           return;
         }
 
@@ -1409,7 +1661,7 @@ g_task_start_task_thread (GTask           *task,
 
   if (g_private_get (&task_private))
     task->blocking_other_task = TRUE;
-  g_thread_pool_push (task_pool, g_object_ref (task), NULL);
+  g_thread_pool_push (g_task_get_thread_pool (task), g_object_ref (task), NULL);
 }
 
 /**
@@ -1420,6 +1672,9 @@ g_task_start_task_thread (GTask           *task,
  * Runs @task_func in another thread. When @task_func returns, @task's
  * #GAsyncReadyCallback will be invoked in @task's #GMainContext.
  *
+ * The thread is taken from @task's #GTaskExecutor; see
+ * g_task_set_executor().
+ *
  * This takes a ref on @task until the task completes.
  *
  * See #GTaskThreadFunc for more details about how @task_func is handled.
@@ -1471,6 +1726,12 @@ g_task_run_in_thread (GTask           *task,
  * have a callback, it will not be invoked when @task_func returns.
  * #GTask:completed will be set to %TRUE just before this function returns.
  *
+ * If @task's #GCancellable has a deadline (see
+ * g_cancellable_new_with_deadline()), it is cancelled when the
+ * deadline passes while waiting. If g_task_set_return_on_cancel() is
+ * in effect, this function then returns without waiting for
+ * @task_func.
+ *
  * Although GLib currently rate-limits the tasks queued via
  * g_task_run_in_thread_sync(), you should not assume that it will
  * always do this. If you have a very large number of tasks to run,
@@ -1483,6 +1744,8 @@ void
 g_task_run_in_thread_sync (GTask           *task,
                            GTaskThreadFunc  task_func)
 {
+  gint64 deadline;
+
   g_return_if_fail (G_IS_TASK (task));
 
   g_object_ref (task);
@@ -1490,8 +1753,22 @@ g_task_run_in_thread_sync (GTask           *task,
   task->synchronous = TRUE;
   g_task_start_task_thread (task, task_func);
 
+  deadline = g_cancellable_get_deadline (task->cancellable);
   while (!task->thread_complete)
-    g_cond_wait (&task->cond, &task->lock);
+    {
+      if (deadline < 0)
+        g_cond_wait (&task->cond, &task->lock);
+      else if (!g_cond_wait_until (&task->cond, &task->lock, deadline))
+        {
+          /* Let task_thread_cancelled() run, as if someone had
+           * cancelled the task at its deadline.
+           */
+          g_mutex_unlock (&task->lock);
+          if (g_cancellable_is_cancelled (task->cancellable))
+            deadline = -1;
+          g_mutex_lock (&task->lock);
+        }
+    }
 
   g_mutex_unlock (&task->lock);
 
@@ -1962,21 +2239,180 @@ GSourceFuncs trivial_source_funcs = {
   NULL
 };
 
+static GTaskExecutor *
+g_task_executor_new_internal (const gchar *name,
+                              gint         base_size,
+                              gboolean     elastic)
+{
+  GTaskExecutor *executor;
+
+  executor = g_slice_new0 (GTaskExecutor);
+  executor->ref_count = 1;
+  executor->name = g_strdup (name);
+  executor->base_size = base_size;
+  g_mutex_init (&executor->mutex);
+
+  executor->pool = g_thread_pool_new (g_task_thread_pool_thread, executor,
+                                      base_size, FALSE, NULL);
+  g_assert (executor->pool != NULL);
+
+  g_thread_pool_set_sort_function (executor->pool, g_task_compare_priority, NULL);
+
+  if (elastic)
+    {
+      executor->manager = g_source_new (&trivial_source_funcs, sizeof (GSource));
+      g_source_set_callback (executor->manager, executor_manager_timeout, executor, NULL);
+      g_source_set_ready_time (executor->manager, -1);
+      g_source_attach (executor->manager,
+                       GLIB_PRIVATE_CALL (g_get_worker_context ()));
+      g_source_unref (executor->manager);
+    }
+
+  return executor;
+}
+
 static void
 g_task_thread_pool_init (void)
 {
-  task_pool = g_thread_pool_new (g_task_thread_pool_thread, NULL,
-                                 G_TASK_POOL_SIZE, FALSE, NULL);
-  g_assert (task_pool != NULL);
+  default_executor = g_task_executor_new_internal (NULL, G_TASK_POOL_SIZE, TRUE);
+}
+
+/**
+ * g_task_executor_new_bounded:
+ * @name: a name for the executor, used to name its threads
+ * @n_threads: the number of threads, or 0 for one per processor
+ *
+ * Creates a #GTaskExecutor that never runs more than @n_threads tasks
+ * at once, which suits CPU-bound work. Once all of its threads are busy,
+ * further tasks wait in the queue, however long that takes.
+ *
+ * Tasks on a bounded executor must therefore not block waiting for
+ * other tasks queued on the same executor.
+ *
+ * Returns: (transfer full): a new #GTaskExecutor
+ *
+ * Since: 2.54
+ */
+GTaskExecutor *
+g_task_executor_new_bounded (const gchar *name,
+                             guint        n_threads)
+{
+  GTaskExecutor *executor;
+
+  g_return_val_if_fail (name != NULL, NULL);
+  g_return_val_if_fail (n_threads <= G_MAXINT, NULL);
+
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
 
-  g_thread_pool_set_sort_function (task_pool, g_task_compare_priority, NULL);
+  executor = g_task_executor_new_internal (name, n_threads, FALSE);
+  g_thread_pool_set_thread_name (executor->pool, name);
+
+  return executor;
+}
+
+/**
+ * g_task_executor_new_elastic:
+ * @name: a name for the executor, used to name its threads
+ * @n_threads: the number of threads to run tasks on before growing, or
+ *   0 for the same number as the default executor
+ *
+ * Creates a #GTaskExecutor for tasks which spend most of their time
+ * blocked, such as blocking I/O. It behaves like the default executor:
+ * when all of its @n_threads threads stay busy, it slowly adds more
+ * threads, so that tasks waiting on other tasks queued on it cannot
+ * starve it. The extra threads go away once tasks complete again.
+ *
+ * Returns: (transfer full): a new #GTaskExecutor
+ *
+ * Since: 2.54
+ */
+GTaskExecutor *
+g_task_executor_new_elastic (const gchar *name,
+                             guint        n_threads)
+{
+  GTaskExecutor *executor;
+
+  g_return_val_if_fail (name != NULL, NULL);
+  g_return_val_if_fail (n_threads <= G_MAXINT, NULL);
+
+  if (n_threads == 0)
+    n_threads = G_TASK_POOL_SIZE;
+
+  executor = g_task_executor_new_internal (name, n_threads, TRUE);
+  g_thread_pool_set_thread_name (executor->pool, name);
+
+  return executor;
+}
+
+/**
+ * g_task_executor_ref:
+ * @executor: a #GTaskExecutor
+ *
+ * Increases the reference count of @executor.
+ *
+ * Returns: @executor
+ *
+ * Since: 2.54
+ */
+GTaskExecutor *
+g_task_executor_ref (GTaskExecutor *executor)
+{
+  g_return_val_if_fail (executor != NULL, NULL);
+
+  g_atomic_int_inc (&executor->ref_count);
+
+  return executor;
+}
+
+/**
+ * g_task_executor_unref:
+ * @executor: a #GTaskExecutor
+ *
+ * Decreases the reference count of @executor. Queued and running tasks
+ * hold a reference on their executor, so its threads go away only once
+ * they are all done.
+ *
+ * Since: 2.54
+ */
+void
+g_task_executor_unref (GTaskExecutor *executor)
+{
+  g_return_if_fail (executor != NULL);
+
+  if (!g_atomic_int_dec_and_test (&executor->ref_count))
+    return;
+
+  if (executor->manager)
+    {
+      g_mutex_lock (&executor_manager_lock);
+      g_source_destroy (executor->manager);
+      g_mutex_unlock (&executor_manager_lock);
+    }
+
+  /* This may run on one of the pool's own threads, so do not wait */
+  g_thread_pool_free (executor->pool, FALSE, FALSE);
+  g_mutex_clear (&executor->mutex);
+  g_free (executor->name);
+  g_slice_free (GTaskExecutor, executor);
+}
+
+/**
+ * g_task_executor_get_name:
+ * @executor: a #GTaskExecutor
+ *
+ * Gets the name @executor was created with.
+ *
+ * Returns: @executor's name
+ *
+ * Since: 2.54
+ */
+const gchar *
+g_task_executor_get_name (GTaskExecutor *executor)
+{
+  g_return_val_if_fail (executor != NULL, NULL);
 
-  task_pool_manager = g_source_new (&trivial_source_funcs, sizeof (GSource));
-  g_source_set_callback (task_pool_manager, task_pool_manager_timeout, NULL, NULL);
-  g_source_set_ready_time (task_pool_manager, -1);
-  g_source_attach (task_pool_manager,
-                   GLIB_PRIVATE_CALL (g_get_worker_context ()));
-  g_source_unref (task_pool_manager);
+  return executor->name;
 }
 
 static void
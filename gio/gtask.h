@@ -35,6 +35,9 @@ G_BEGIN_DECLS
 #define G_TASK_GET_CLASS(o) (G_TYPE_INSTANCE_GET_CLASS ((o), G_TYPE_TASK, GTaskClass))
 
 typedef struct _GTaskClass   GTaskClass;
+typedef struct _GTaskExecutor GTaskExecutor;
+
+#define G_TYPE_TASK_EXECUTOR (g_task_executor_get_type ())
 
 GLIB_AVAILABLE_IN_2_36
 GType         g_task_get_type              (void) G_GNUC_CONST;
@@ -74,6 +77,9 @@ void          g_task_set_check_cancellable (GTask               *task,
 GLIB_AVAILABLE_IN_2_36
 void          g_task_set_source_tag        (GTask               *task,
                                             gpointer             source_tag);
+GLIB_AVAILABLE_IN_2_54
+void          g_task_set_executor          (GTask               *task,
+                                            GTaskExecutor       *executor);
 
 GLIB_AVAILABLE_IN_2_36
 gpointer      g_task_get_source_object     (GTask               *task);
@@ -81,6 +87,8 @@ GLIB_AVAILABLE_IN_2_36
 gpointer      g_task_get_task_data         (GTask               *task);
 GLIB_AVAILABLE_IN_2_36
 gint          g_task_get_priority          (GTask               *task);
+GLIB_AVAILABLE_IN_2_54
+GTaskExecutor *g_task_get_executor         (GTask               *task);
 GLIB_AVAILABLE_IN_2_36
 GMainContext *g_task_get_context           (GTask               *task);
 GLIB_AVAILABLE_IN_2_36
@@ -105,6 +113,22 @@ void          g_task_run_in_thread        (GTask           *task,
 GLIB_AVAILABLE_IN_2_36
 void          g_task_run_in_thread_sync   (GTask           *task,
                                            GTaskThreadFunc  task_func);
+
+GLIB_AVAILABLE_IN_2_54
+GType          g_task_executor_get_type    (void) G_GNUC_CONST;
+GLIB_AVAILABLE_IN_2_54
+GTaskExecutor *g_task_executor_new_bounded (const gchar     *name,
+                                            guint            n_threads);
+GLIB_AVAILABLE_IN_2_54
+GTaskExecutor *g_task_executor_new_elastic (const gchar     *name,
+                                            guint            n_threads);
+GLIB_AVAILABLE_IN_2_54
+GTaskExecutor *g_task_executor_ref         (GTaskExecutor   *executor);
+GLIB_AVAILABLE_IN_2_54
+void           g_task_executor_unref       (GTaskExecutor   *executor);
+GLIB_AVAILABLE_IN_2_54
+const gchar   *g_task_executor_get_name    (GTaskExecutor   *executor);
+
 GLIB_AVAILABLE_IN_2_36
 gboolean      g_task_set_return_on_cancel (GTask           *task,
                                            gboolean         return_on_cancel);
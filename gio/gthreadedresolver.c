@@ -31,6 +31,7 @@
 #include "gcancellable.h"
 #include "ginetaddress.h"
 #include "ginetsocketaddress.h"
+#include "gasyncresult.h"
 #include "gtask.h"
 #include "gsocketaddress.h"
 #include "gsrvtarget.h"
@@ -506,8 +507,8 @@ parse_res_txt (guchar  *answer,
   return record;
 }
 
-static gint
-g_resolver_record_type_to_rrtype (GResolverRecordType type)
+gint
+_g_resolver_record_type_to_rrtype (GResolverRecordType type)
 {
   switch (type)
   {
@@ -525,13 +526,15 @@ g_resolver_record_type_to_rrtype (GResolverRecordType type)
   g_return_val_if_reached (-1);
 }
 
-static GList *
-g_resolver_records_from_res_query (const gchar      *rrname,
-                                   gint              rrtype,
-                                   guchar           *answer,
-                                   gint              len,
-                                   gint              herr,
-                                   GError          **error)
+/* Also used by #GDnsResolver, which gets its answers by itself */
+GList *
+_g_resolver_records_from_res_query (const gchar      *rrname,
+                                    gint              rrtype,
+                                    guchar           *answer,
+                                    gint              len,
+                                    gint              herr,
+                                    guint32          *out_ttl,
+                                    GError          **error)
 {
   gint count;
   gchar namebuf[1024];
@@ -588,7 +591,6 @@ g_resolver_records_from_res_query (const gchar      *rrname,
       GETSHORT (type, p);
       GETSHORT (qclass, p);
       GETLONG  (ttl, p);
-      ttl = ttl; /* To avoid -Wunused-but-set-variable */
       GETSHORT (rdlength, p);
 
       if (type != rrtype || qclass != C_IN)
@@ -621,7 +623,10 @@ g_resolver_records_from_res_query (const gchar      *rrname,
         }
 
       if (record != NULL)
-        records = g_list_prepend (records, record);
+        {
+          records = g_list_prepend (records, record);
+          *out_ttl = MIN (*out_ttl, ttl);
+        }
     }
 
   if (records == NULL)
@@ -714,6 +719,7 @@ g_resolver_records_from_DnsQuery (const gchar  *rrname,
                                   WORD          dnstype,
                                   DNS_STATUS    status,
                                   DNS_RECORD   *results,
+                                  guint32      *out_ttl,
                                   GError      **error)
 {
   DNS_RECORD *rec;
@@ -769,7 +775,10 @@ g_resolver_records_from_DnsQuery (const gchar  *rrname,
           break;
         }
       if (record != NULL)
-        records = g_list_prepend (records, g_variant_ref_sink (record));
+        {
+          records = g_list_prepend (records, g_variant_ref_sink (record));
+          *out_ttl = MIN (*out_ttl, rec->dwTtl);
+        }
     }
 
   if (records == NULL)
@@ -788,6 +797,7 @@ g_resolver_records_from_DnsQuery (const gchar  *rrname,
 typedef struct {
   char *rrname;
   GResolverRecordType record_type;
+  guint32 ttl;  /* the smallest TTL of the returned records */
 } LookupRecordsData;
 
 static void
@@ -826,7 +836,7 @@ do_lookup_records (GTask         *task,
   GByteArray *answer;
   gint rrtype;
 
-  rrtype = g_resolver_record_type_to_rrtype (lrd->record_type);
+  rrtype = _g_resolver_record_type_to_rrtype (lrd->record_type);
   answer = g_byte_array_new ();
   for (;;)
     {
@@ -844,7 +854,8 @@ do_lookup_records (GTask         *task,
     }
 
   herr = h_errno;
-  records = g_resolver_records_from_res_query (lrd->rrname, rrtype, answer->data, len, herr, &error);
+  lrd->ttl = G_MAXUINT32;
+  records = _g_resolver_records_from_res_query (lrd->rrname, rrtype, answer->data, len, herr, &lrd->ttl, &error);
   g_byte_array_free (answer, TRUE);
 
 #else
@@ -855,7 +866,8 @@ do_lookup_records (GTask         *task,
 
   dnstype = g_resolver_record_type_to_dnstype (lrd->record_type);
   status = DnsQuery_A (lrd->rrname, dnstype, DNS_QUERY_STANDARD, NULL, &results, NULL);
-  records = g_resolver_records_from_DnsQuery (lrd->rrname, dnstype, status, results, &error);
+  lrd->ttl = G_MAXUINT32;
+  records = g_resolver_records_from_DnsQuery (lrd->rrname, dnstype, status, results, &lrd->ttl, &error);
   if (results != NULL)
     DnsRecordListFree (results, DnsFreeRecordList);
 
@@ -867,21 +879,25 @@ do_lookup_records (GTask         *task,
     g_task_return_error (task, error);
 }
 
-static GList *
-lookup_records (GResolver              *resolver,
-                const gchar            *rrname,
-                GResolverRecordType     record_type,
-                GCancellable           *cancellable,
-                GError                **error)
+/* Like lookup_records(), but also returns the time to live of the
+ * result, for #GCachingResolver.
+ */
+GList *
+_g_threaded_resolver_lookup_records_with_ttl (GThreadedResolver    *resolver,
+                                              const gchar          *rrname,
+                                              GResolverRecordType   record_type,
+                                              guint32              *out_ttl,
+                                              GCancellable         *cancellable,
+                                              GError              **error)
 {
   GTask *task;
   GList *records;
   LookupRecordsData *lrd;
 
   task = g_task_new (resolver, cancellable, NULL, NULL);
-  g_task_set_source_tag (task, lookup_records);
+  g_task_set_source_tag (task, _g_threaded_resolver_lookup_records_with_ttl);
 
-  lrd = g_slice_new (LookupRecordsData);
+  lrd = g_slice_new0 (LookupRecordsData);
   lrd->rrname = g_strdup (rrname);
   lrd->record_type = record_type;
   g_task_set_task_data (task, lrd, (GDestroyNotify) free_lookup_records_data);
@@ -889,11 +905,25 @@ lookup_records (GResolver              *resolver,
   g_task_set_return_on_cancel (task, TRUE);
   g_task_run_in_thread_sync (task, do_lookup_records);
   records = g_task_propagate_pointer (task, error);
+  if (records != NULL && out_ttl != NULL)
+    *out_ttl = lrd->ttl;
   g_object_unref (task);
 
   return records;
 }
 
+static GList *
+lookup_records (GResolver              *resolver,
+                const gchar            *rrname,
+                GResolverRecordType     record_type,
+                GCancellable           *cancellable,
+                GError                **error)
+{
+  return _g_threaded_resolver_lookup_records_with_ttl (G_THREADED_RESOLVER (resolver),
+                                                       rrname, record_type, NULL,
+                                                       cancellable, error);
+}
+
 static void
 lookup_records_async (GResolver           *resolver,
                       const char          *rrname,
@@ -908,7 +938,7 @@ lookup_records_async (GResolver           *resolver,
   task = g_task_new (resolver, cancellable, callback, user_data);
   g_task_set_source_tag (task, lookup_records_async);
 
-  lrd = g_slice_new (LookupRecordsData);
+  lrd = g_slice_new0 (LookupRecordsData);
   lrd->rrname = g_strdup (rrname);
   lrd->record_type = record_type;
   g_task_set_task_data (task, lrd, (GDestroyNotify) free_lookup_records_data);
@@ -928,6 +958,20 @@ lookup_records_finish (GResolver     *resolver,
   return g_task_propagate_pointer (G_TASK (result), error);
 }
 
+/* Gets the time to live of the records returned by a successful
+ * g_resolver_lookup_records_async() on a #GThreadedResolver, once
+ * @result has been finished.
+ */
+guint32
+_g_threaded_resolver_get_records_ttl (GAsyncResult *result)
+{
+  LookupRecordsData *lrd;
+
+  g_return_val_if_fail (g_async_result_is_tagged (result, lookup_records_async), 0);
+
+  lrd = g_task_get_task_data (G_TASK (result));
+  return lrd->ttl;
+}
 
 static void
 g_threaded_resolver_class_init (GThreadedResolverClass *threaded_class)
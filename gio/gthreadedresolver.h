@@ -44,6 +44,25 @@ typedef struct {
 GLIB_AVAILABLE_IN_ALL
 GType g_threaded_resolver_get_type (void) G_GNUC_CONST;
 
+GList   *_g_threaded_resolver_lookup_records_with_ttl (GThreadedResolver    *resolver,
+                                                       const gchar          *rrname,
+                                                       GResolverRecordType   record_type,
+                                                       guint32              *out_ttl,
+                                                       GCancellable         *cancellable,
+                                                       GError              **error);
+guint32  _g_threaded_resolver_get_records_ttl         (GAsyncResult         *result);
+
+#ifdef G_OS_UNIX
+gint     _g_resolver_record_type_to_rrtype            (GResolverRecordType   type);
+GList   *_g_resolver_records_from_res_query           (const gchar          *rrname,
+                                                       gint                  rrtype,
+                                                       guchar               *answer,
+                                                       gint                  len,
+                                                       gint                  herr,
+                                                       guint32              *out_ttl,
+                                                       GError              **error);
+#endif
+
 G_END_DECLS
 
 #endif /* __G_RESOLVER_H__ */
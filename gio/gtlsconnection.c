@@ -22,7 +22,9 @@
 #include "gtlsconnection.h"
 #include "gcancellable.h"
 #include "gioenumtypes.h"
+#include "gioerror.h"
 #include "gsocket.h"
+#include "gsocketconnection.h"
 #include "gtlsbackend.h"
 #include "gtlscertificate.h"
 #include "gtlsclientconnection.h"
@@ -30,6 +32,20 @@
 #include "gtlsinteraction.h"
 #include "glibintl.h"
 
+#ifdef HAVE_LINUX_TLS_H
+#include <string.h>
+#include <errno.h>
+#include <linux/tls.h>
+#include "gnetworking.h"
+
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#endif
+
 /**
  * SECTION:gtlsconnection
  * @short_description: TLS connection type
@@ -826,6 +842,210 @@ g_tls_connection_handshake_finish (GTlsConnection  *conn,
   return G_TLS_CONNECTION_GET_CLASS (conn)->handshake_finish (conn, result, error);
 }
 
+#ifdef HAVE_LINUX_TLS_H
+/* Loads one direction of @params into the kernel TLS layer of @fd */
+static gboolean
+set_offload_parameters (int                          fd,
+                        int                          direction,
+                        const GTlsOffloadParameters *params,
+                        GError                     **error)
+{
+  union {
+    struct tls_crypto_info info;
+    struct tls12_crypto_info_aes_gcm_128 aes_gcm_128;
+    struct tls12_crypto_info_aes_gcm_256 aes_gcm_256;
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+    struct tls12_crypto_info_chacha20_poly1305 chacha20_poly1305;
+#endif
+  } crypto;
+  socklen_t size;
+  int result, errsv;
+
+  memset (&crypto, 0, sizeof crypto);
+  crypto.info.version = params->version;
+
+  switch (params->cipher)
+    {
+    case G_TLS_OFFLOAD_CIPHER_AES_128_GCM:
+      crypto.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+      memcpy (crypto.aes_gcm_128.key, params->key, TLS_CIPHER_AES_GCM_128_KEY_SIZE);
+      memcpy (crypto.aes_gcm_128.salt, params->iv, TLS_CIPHER_AES_GCM_128_SALT_SIZE);
+      memcpy (crypto.aes_gcm_128.iv, params->iv + TLS_CIPHER_AES_GCM_128_SALT_SIZE,
+              TLS_CIPHER_AES_GCM_128_IV_SIZE);
+      memcpy (crypto.aes_gcm_128.rec_seq, params->rec_seq, TLS_CIPHER_AES_GCM_128_REC_SEQ_SIZE);
+      size = sizeof crypto.aes_gcm_128;
+      break;
+
+    case G_TLS_OFFLOAD_CIPHER_AES_256_GCM:
+      crypto.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+      memcpy (crypto.aes_gcm_256.key, params->key, TLS_CIPHER_AES_GCM_256_KEY_SIZE);
+      memcpy (crypto.aes_gcm_256.salt, params->iv, TLS_CIPHER_AES_GCM_256_SALT_SIZE);
+      memcpy (crypto.aes_gcm_256.iv, params->iv + TLS_CIPHER_AES_GCM_256_SALT_SIZE,
+              TLS_CIPHER_AES_GCM_256_IV_SIZE);
+      memcpy (crypto.aes_gcm_256.rec_seq, params->rec_seq, TLS_CIPHER_AES_GCM_256_REC_SEQ_SIZE);
+      size = sizeof crypto.aes_gcm_256;
+      break;
+
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+    case G_TLS_OFFLOAD_CIPHER_CHACHA20_POLY1305:
+      crypto.info.cipher_type = TLS_CIPHER_CHACHA20_POLY1305;
+      memcpy (crypto.chacha20_poly1305.key, params->key, TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE);
+      memcpy (crypto.chacha20_poly1305.iv, params->iv, TLS_CIPHER_CHACHA20_POLY1305_IV_SIZE);
+      memcpy (crypto.chacha20_poly1305.rec_seq, params->rec_seq,
+              TLS_CIPHER_CHACHA20_POLY1305_REC_SEQ_SIZE);
+      size = sizeof crypto.chacha20_poly1305;
+      break;
+#endif
+
+    default:
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           _("The kernel does not support this TLS cipher"));
+      return FALSE;
+    }
+
+  result = setsockopt (fd, SOL_TLS, direction, &crypto, size);
+  errsv = errno;
+
+  /* Don't leave the keys lying around on the stack */
+  memset (&crypto, 0, sizeof crypto);
+
+  if (result < 0)
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                   _("Could not hand the TLS connection off to the kernel: %s"),
+                   g_strerror (errsv));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+#endif
+
+/**
+ * g_tls_connection_offload:
+ * @conn: a #GTlsConnection that has completed its handshake
+ * @error: a #GError pointer, or %NULL
+ *
+ * Hands the record layer of @conn off to the kernel, so that data
+ * written to the returned connection is encrypted, and data read from
+ * it decrypted, by the operating system rather than by the TLS
+ * backend. The returned connection is the plain #GSocketConnection
+ * that @conn was created on. It can be used with zero-copy operations
+ * such as g_output_stream_splice() from a file, and avoids copying
+ * data through the TLS library.
+ *
+ * This is only possible if the base stream of @conn is a
+ * #GSocketConnection, the TLS backend can export its keys (see
+ * #GTlsConnectionClass.get_offload_parameters), the connection uses a
+ * cipher the kernel supports, and the kernel supports TLS offload (on
+ * Linux this needs the `tls` module). Otherwise
+ * %G_IO_ERROR_NOT_SUPPORTED is returned and @conn can still be used
+ * normally.
+ *
+ * The backend refuses to export its keys while it holds received data
+ * the application has not read yet, so call this at a point where the
+ * peer is not expected to send anything, typically right after the
+ * handshake. Rehandshakes, TLS 1.3 key updates and alerts other than
+ * close_notify are not handled by the kernel, so only offload
+ * connections that will not need them.
+ *
+ * If the kernel accepts the sending keys but not the receiving ones
+ * (old kernels can only offload sending), an error is returned and
+ * neither connection can be used any more.
+ *
+ * On success @conn must not be used any more, except to unref it; in
+ * particular it must not be closed, as that would send a close_notify
+ * alert with stale keys. Close the returned connection instead.
+ *
+ * Returns: (transfer full): the offloaded connection, or %NULL on error
+ *
+ * Since: 2.54
+ */
+GSocketConnection *
+g_tls_connection_offload (GTlsConnection  *conn,
+                          GError         **error)
+{
+#ifdef HAVE_LINUX_TLS_H
+  GTlsConnectionClass *klass;
+  GTlsOffloadParameters send, receive;
+  GIOStream *base_io_stream = NULL;
+  GSocketConnection *result = NULL;
+  GSocket *socket;
+  gboolean success;
+  int fd;
+
+  g_return_val_if_fail (G_IS_TLS_CONNECTION (conn), NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  klass = G_TLS_CONNECTION_GET_CLASS (conn);
+  if (klass->get_offload_parameters == NULL)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           _("The TLS backend does not support kernel offload"));
+      return NULL;
+    }
+
+  g_object_get (conn, "base-io-stream", &base_io_stream, NULL);
+  if (!G_IS_SOCKET_CONNECTION (base_io_stream))
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           _("Only TLS connections over sockets can be offloaded"));
+      goto out;
+    }
+
+  socket = g_socket_connection_get_socket (G_SOCKET_CONNECTION (base_io_stream));
+  fd = g_socket_get_fd (socket);
+
+  /* Attaching the TLS layer on its own doesn't change anything, so do
+   * it first: if the kernel can't do this, the backend is never asked
+   * for its keys.
+   */
+  if (setsockopt (fd, SOL_TCP, TCP_ULP, "tls", sizeof "tls") < 0)
+    {
+      int errsv = errno;
+
+      if (errsv == ENOENT || errsv == ENOPROTOOPT || errsv == EOPNOTSUPP)
+        g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                             _("The kernel does not support TLS offload"));
+      else
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                     _("Could not hand the TLS connection off to the kernel: %s"),
+                     g_strerror (errsv));
+      goto out;
+    }
+
+  memset (&send, 0, sizeof send);
+  memset (&receive, 0, sizeof receive);
+
+  if (!klass->get_offload_parameters (conn, &send, &receive, error))
+    goto out;
+
+  /* Once the sending side is in the kernel there is no going back, so
+   * a failure on the receiving side leaves the connection unusable.
+   */
+  success = set_offload_parameters (fd, TLS_TX, &send, error) &&
+            set_offload_parameters (fd, TLS_RX, &receive, error);
+
+  memset (&send, 0, sizeof send);
+  memset (&receive, 0, sizeof receive);
+
+  if (success)
+    result = g_object_ref (G_SOCKET_CONNECTION (base_io_stream));
+
+ out:
+  g_clear_object (&base_io_stream);
+
+  return result;
+#else
+  g_return_val_if_fail (G_IS_TLS_CONNECTION (conn), NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                       _("TLS offload is not supported on this platform"));
+  return NULL;
+#endif
+}
+
 /**
  * g_tls_error_quark:
  *
@@ -36,6 +36,32 @@ G_BEGIN_DECLS
 
 typedef struct _GTlsConnectionClass   GTlsConnectionClass;
 typedef struct _GTlsConnectionPrivate GTlsConnectionPrivate;
+typedef struct _GTlsOffloadParameters GTlsOffloadParameters;
+
+/**
+ * GTlsOffloadParameters:
+ * @version: the protocol version as sent on the wire: 0x0303 for
+ *     TLS 1.2, 0x0304 for TLS 1.3
+ * @cipher: the record cipher
+ * @key: the traffic key. Only the first 16 bytes are used for
+ *     %G_TLS_OFFLOAD_CIPHER_AES_128_GCM.
+ * @iv: the 12-byte nonce. For AES-GCM in TLS 1.2 this is the 4-byte
+ *     implicit salt followed by the 8-byte explicit part to start from.
+ * @rec_seq: the sequence number of the next record, big-endian
+ *
+ * The state of one direction of a TLS connection's record layer, as
+ * exported by #GTlsConnectionClass.get_offload_parameters.
+ *
+ * Since: 2.54
+ */
+struct _GTlsOffloadParameters
+{
+  guint16            version;
+  GTlsOffloadCipher  cipher;
+  guint8             key[32];
+  guint8             iv[12];
+  guint8             rec_seq[8];
+};
 
 struct _GTlsConnection {
   GIOStream parent_instance;
@@ -66,9 +92,18 @@ struct _GTlsConnectionClass
 				  GAsyncResult         *result,
 				  GError              **error);
 
+  /* Exports the record state of both directions as of the next record,
+   * for g_tls_connection_offload(). Fails with G_IO_ERROR_NOT_SUPPORTED
+   * for ciphers that can't be described, and G_IO_ERROR_BUSY while
+   * received data is still buffered. Since: 2.54 */
+  gboolean ( *get_offload_parameters ) (GTlsConnection        *conn,
+					GTlsOffloadParameters *send,
+					GTlsOffloadParameters *receive,
+					GError               **error);
+
   /*< private >*/
   /* Padding for future expansion */
-  gpointer padding[8];
+  gpointer padding[7];
 };
 
 GLIB_AVAILABLE_IN_ALL
@@ -131,6 +166,10 @@ gboolean              g_tls_connection_handshake_finish            (GTlsConnecti
 								    GAsyncResult         *result,
 								    GError              **error);
 
+GLIB_AVAILABLE_IN_2_54
+GSocketConnection *   g_tls_connection_offload                     (GTlsConnection       *conn,
+								    GError              **error);
+
 /**
  * G_TLS_ERROR:
  *
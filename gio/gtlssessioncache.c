@@ -0,0 +1,326 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtlssessioncache.h"
+#include "gsocketconnectable.h"
+#include "gtlsclientconnection.h"
+#include "glibintl.h"
+
+/**
+ * SECTION:gtlssessioncache
+ * @title: GTlsSessionCache
+ * @short_description: Shared cache of TLS client sessions
+ * @include: gio/gio.h
+ * @see_also: #GTlsClientConnection, #GSocketClient
+ *
+ * #GTlsSessionCache remembers the most recent successfully handshaken
+ * #GTlsClientConnection for each server, and uses
+ * g_tls_client_connection_copy_session_state() to let new connections
+ * to the same server resume that session, skipping the expensive part
+ * of the handshake.
+ *
+ * A cache can be shared by any number of #GSocketClient objects (see
+ * g_socket_client_set_tls_session_cache()) or used directly. It is
+ * safe to use from multiple threads.
+ *
+ * The cache holds a reference on each stored connection, so
+ * connections (and their underlying sockets) stay alive until they are
+ * replaced or evicted. Close connections with g_io_stream_close() when
+ * you are done with them to release the socket early; the session
+ * state remains usable after that.
+ *
+ * Resumption needs support from the TLS backend. If the backend does
+ * not implement session copying, g_tls_session_cache_resume() simply
+ * returns %FALSE and a full handshake is done.
+ *
+ * Since: 2.54
+ */
+
+#define DEFAULT_MAX_ENTRIES 64
+
+typedef struct
+{
+  gchar                *key;
+  GTlsClientConnection *conn;
+  GList                 link;
+} CacheEntry;
+
+struct _GTlsSessionCache
+{
+  GObject parent_instance;
+
+  GMutex      lock;
+  GHashTable *entries;  /* key → CacheEntry */
+  GQueue      lru;      /* of CacheEntry, most recently used first */
+  guint       max_entries;
+};
+
+G_DEFINE_TYPE (GTlsSessionCache, g_tls_session_cache, G_TYPE_OBJECT)
+
+static void
+cache_entry_free (gpointer data)
+{
+  CacheEntry *entry = data;
+
+  g_free (entry->key);
+  g_object_unref (entry->conn);
+  g_slice_free (CacheEntry, entry);
+}
+
+static void
+g_tls_session_cache_finalize (GObject *object)
+{
+  GTlsSessionCache *cache = G_TLS_SESSION_CACHE (object);
+
+  g_hash_table_unref (cache->entries);
+  g_mutex_clear (&cache->lock);
+
+  G_OBJECT_CLASS (g_tls_session_cache_parent_class)->finalize (object);
+}
+
+static void
+g_tls_session_cache_class_init (GTlsSessionCacheClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = g_tls_session_cache_finalize;
+}
+
+static void
+g_tls_session_cache_init (GTlsSessionCache *cache)
+{
+  g_mutex_init (&cache->lock);
+  cache->entries = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, cache_entry_free);
+  g_queue_init (&cache->lru);
+  cache->max_entries = DEFAULT_MAX_ENTRIES;
+}
+
+/* Sessions are keyed on the string form of the server identity.
+ * Connectables without a to_string() implementation would all share
+ * their type name, so they are not cached at all.
+ */
+static gchar *
+get_cache_key (GSocketConnectable *server_identity)
+{
+  GSocketConnectableIface *iface;
+
+  iface = G_SOCKET_CONNECTABLE_GET_IFACE (server_identity);
+  if (iface->to_string == NULL)
+    return NULL;
+
+  return iface->to_string (server_identity);
+}
+
+static void
+g_tls_session_cache_remove_entry (GTlsSessionCache *cache,
+                                  CacheEntry       *entry)
+{
+  g_queue_unlink (&cache->lru, &entry->link);
+  g_hash_table_remove (cache->entries, entry->key);
+}
+
+/**
+ * g_tls_session_cache_new:
+ * @max_entries: the maximum number of servers to remember sessions
+ *     for, or 0 for a default
+ *
+ * Creates a new, empty #GTlsSessionCache. When more than @max_entries
+ * sessions are stored, the least recently used ones are dropped.
+ *
+ * Returns: (transfer full): a new #GTlsSessionCache
+ *
+ * Since: 2.54
+ */
+GTlsSessionCache *
+g_tls_session_cache_new (guint max_entries)
+{
+  GTlsSessionCache *cache;
+
+  cache = g_object_new (G_TYPE_TLS_SESSION_CACHE, NULL);
+  if (max_entries > 0)
+    cache->max_entries = max_entries;
+
+  return cache;
+}
+
+/**
+ * g_tls_session_cache_store:
+ * @cache: a #GTlsSessionCache
+ * @server_identity: the server @conn is connected to
+ * @conn: a #GTlsClientConnection that has completed a handshake
+ *
+ * Remembers the session of @conn so that later connections to
+ * @server_identity can resume it. This replaces any session already
+ * stored for @server_identity.
+ *
+ * Since: 2.54
+ */
+void
+g_tls_session_cache_store (GTlsSessionCache     *cache,
+                           GSocketConnectable   *server_identity,
+                           GTlsClientConnection *conn)
+{
+  CacheEntry *entry;
+  gchar *key;
+
+  g_return_if_fail (G_IS_TLS_SESSION_CACHE (cache));
+  g_return_if_fail (G_IS_SOCKET_CONNECTABLE (server_identity));
+  g_return_if_fail (G_IS_TLS_CLIENT_CONNECTION (conn));
+
+  key = get_cache_key (server_identity);
+  if (key == NULL)
+    return;
+
+  g_mutex_lock (&cache->lock);
+
+  entry = g_hash_table_lookup (cache->entries, key);
+  if (entry != NULL)
+    {
+      g_free (key);
+      g_object_unref (entry->conn);
+      entry->conn = g_object_ref (conn);
+      g_queue_unlink (&cache->lru, &entry->link);
+    }
+  else
+    {
+      entry = g_slice_new0 (CacheEntry);
+      entry->key = key;
+      entry->conn = g_object_ref (conn);
+      entry->link.data = entry;
+      g_hash_table_insert (cache->entries, entry->key, entry);
+    }
+
+  g_queue_push_head_link (&cache->lru, &entry->link);
+
+  while (cache->lru.length > cache->max_entries)
+    g_tls_session_cache_remove_entry (cache, cache->lru.tail->data);
+
+  g_mutex_unlock (&cache->lock);
+}
+
+/**
+ * g_tls_session_cache_resume:
+ * @cache: a #GTlsSessionCache
+ * @server_identity: the server @conn is connecting to
+ * @conn: a #GTlsClientConnection that has not yet done a handshake
+ *
+ * If @cache has a session for @server_identity, copies it into @conn
+ * so that the next handshake on @conn can resume it.
+ *
+ * Whether the session is actually resumed is up to the server; if it
+ * refuses, the handshake silently falls back to a full one.
+ *
+ * Returns: %TRUE if a session was copied into @conn
+ *
+ * Since: 2.54
+ */
+gboolean
+g_tls_session_cache_resume (GTlsSessionCache     *cache,
+                            GSocketConnectable   *server_identity,
+                            GTlsClientConnection *conn)
+{
+  GTlsClientConnection *source = NULL;
+  CacheEntry *entry;
+  gchar *key;
+
+  g_return_val_if_fail (G_IS_TLS_SESSION_CACHE (cache), FALSE);
+  g_return_val_if_fail (G_IS_SOCKET_CONNECTABLE (server_identity), FALSE);
+  g_return_val_if_fail (G_IS_TLS_CLIENT_CONNECTION (conn), FALSE);
+
+  if (G_TLS_CLIENT_CONNECTION_GET_INTERFACE (conn)->copy_session_state == NULL)
+    return FALSE;
+
+  key = get_cache_key (server_identity);
+  if (key == NULL)
+    return FALSE;
+
+  g_mutex_lock (&cache->lock);
+
+  entry = g_hash_table_lookup (cache->entries, key);
+  if (entry != NULL && entry->conn != conn &&
+      G_TYPE_FROM_INSTANCE (entry->conn) == G_TYPE_FROM_INSTANCE (conn))
+    {
+      source = g_object_ref (entry->conn);
+      g_queue_unlink (&cache->lru, &entry->link);
+      g_queue_push_head_link (&cache->lru, &entry->link);
+    }
+
+  g_mutex_unlock (&cache->lock);
+  g_free (key);
+
+  if (source == NULL)
+    return FALSE;
+
+  g_tls_client_connection_copy_session_state (conn, source);
+  g_object_unref (source);
+
+  return TRUE;
+}
+
+/**
+ * g_tls_session_cache_remove:
+ * @cache: a #GTlsSessionCache
+ * @server_identity: a server
+ *
+ * Forgets the session stored for @server_identity, if any. This is
+ * useful when a resumed session turned out to be unacceptable, for
+ * example because the server's certificate changed.
+ *
+ * Since: 2.54
+ */
+void
+g_tls_session_cache_remove (GTlsSessionCache   *cache,
+                            GSocketConnectable *server_identity)
+{
+  CacheEntry *entry;
+  gchar *key;
+
+  g_return_if_fail (G_IS_TLS_SESSION_CACHE (cache));
+  g_return_if_fail (G_IS_SOCKET_CONNECTABLE (server_identity));
+
+  key = get_cache_key (server_identity);
+  if (key == NULL)
+    return;
+
+  g_mutex_lock (&cache->lock);
+  entry = g_hash_table_lookup (cache->entries, key);
+  if (entry != NULL)
+    g_tls_session_cache_remove_entry (cache, entry);
+  g_mutex_unlock (&cache->lock);
+
+  g_free (key);
+}
+
+/**
+ * g_tls_session_cache_clear:
+ * @cache: a #GTlsSessionCache
+ *
+ * Forgets all stored sessions.
+ *
+ * Since: 2.54
+ */
+void
+g_tls_session_cache_clear (GTlsSessionCache *cache)
+{
+  g_return_if_fail (G_IS_TLS_SESSION_CACHE (cache));
+
+  g_mutex_lock (&cache->lock);
+  g_queue_init (&cache->lru);
+  g_hash_table_remove_all (cache->entries);
+  g_mutex_unlock (&cache->lock);
+}
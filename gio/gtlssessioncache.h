@@ -0,0 +1,54 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_TLS_SESSION_CACHE_H__
+#define __G_TLS_SESSION_CACHE_H__
+
+#if !defined (__GIO_GIO_H_INSIDE__) && !defined (GIO_COMPILATION)
+#error "Only <gio/gio.h> can be included directly."
+#endif
+
+#include <gio/giotypes.h>
+
+G_BEGIN_DECLS
+
+#define G_TYPE_TLS_SESSION_CACHE (g_tls_session_cache_get_type ())
+GLIB_AVAILABLE_IN_2_54
+G_DECLARE_FINAL_TYPE(GTlsSessionCache, g_tls_session_cache, G, TLS_SESSION_CACHE, GObject)
+
+GLIB_AVAILABLE_IN_2_54
+GTlsSessionCache *      g_tls_session_cache_new                         (guint                 max_entries);
+
+GLIB_AVAILABLE_IN_2_54
+void                    g_tls_session_cache_store                       (GTlsSessionCache     *cache,
+                                                                         GSocketConnectable   *server_identity,
+                                                                         GTlsClientConnection *conn);
+
+GLIB_AVAILABLE_IN_2_54
+gboolean                g_tls_session_cache_resume                      (GTlsSessionCache     *cache,
+                                                                         GSocketConnectable   *server_identity,
+                                                                         GTlsClientConnection *conn);
+
+GLIB_AVAILABLE_IN_2_54
+void                    g_tls_session_cache_remove                      (GTlsSessionCache     *cache,
+                                                                         GSocketConnectable   *server_identity);
+
+GLIB_AVAILABLE_IN_2_54
+void                    g_tls_session_cache_clear                       (GTlsSessionCache     *cache);
+
+G_END_DECLS
+
+#endif /* __G_TLS_SESSION_CACHE_H__ */
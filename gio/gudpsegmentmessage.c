@@ -0,0 +1,219 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gudpsegmentmessage
+ * @title: GUdpSegmentMessage
+ * @short_description: A GSocketControlMessage for UDP segmentation offload
+ * @include: gio/gudpsegmentmessage.h
+ * @see_also: #GSocket, #GSocketControlMessage
+ *
+ * This #GSocketControlMessage carries the segment size used by UDP
+ * generic segmentation offload (GSO) and generic receive offload (GRO)
+ * on Linux.
+ *
+ * When a #GUdpSegmentMessage is sent along with a buffer using
+ * g_socket_send_message() or g_socket_send_messages() on a UDP socket,
+ * the kernel splits the buffer into datagrams of the given segment
+ * size (the last one may be shorter), which costs much less than
+ * sending each of them separately.
+ *
+ * Conversely, once the `UDP_GRO` option has been enabled on a socket
+ * with g_socket_set_option(), the kernel may coalesce several
+ * consecutive datagrams from the same sender into one buffer.
+ * g_socket_receive_message() and g_socket_receive_messages() then
+ * return a #GUdpSegmentMessage among the control messages, and the
+ * buffer has to be split by the caller at multiples of its segment
+ * size.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "gudpsegmentmessage.h"
+#include "gnetworking.h"
+
+#ifdef __linux__
+#include <netinet/udp.h>
+#endif
+
+#if defined (SOL_UDP) && defined (UDP_SEGMENT) && defined (UDP_GRO)
+#define UDP_SEGMENT_MESSAGE_SUPPORTED 1
+#else
+#define UDP_SEGMENT_MESSAGE_SUPPORTED 0
+#endif
+
+G_DEFINE_TYPE (GUdpSegmentMessage, g_udp_segment_message, G_TYPE_SOCKET_CONTROL_MESSAGE)
+
+static gsize
+g_udp_segment_message_get_size (GSocketControlMessage *message)
+{
+#if UDP_SEGMENT_MESSAGE_SUPPORTED
+  return sizeof (guint16);
+#else
+  return 0;
+#endif
+}
+
+static int
+g_udp_segment_message_get_level (GSocketControlMessage *message)
+{
+#if UDP_SEGMENT_MESSAGE_SUPPORTED
+  return SOL_UDP;
+#else
+  return 0;
+#endif
+}
+
+static int
+g_udp_segment_message_get_msg_type (GSocketControlMessage *message)
+{
+#if UDP_SEGMENT_MESSAGE_SUPPORTED
+  return UDP_SEGMENT;
+#else
+  return 0;
+#endif
+}
+
+static GSocketControlMessage *
+g_udp_segment_message_deserialize (gint     level,
+                                   gint     type,
+                                   gsize    size,
+                                   gpointer data)
+{
+#if UDP_SEGMENT_MESSAGE_SUPPORTED
+  guint segment_size;
+
+  if (level != SOL_UDP)
+    return NULL;
+
+  /* The kernel reports the GRO segment size as an int, while the GSO
+   * one is sent as a 16-bit value.
+   */
+  if (type == UDP_GRO && size == sizeof (gint))
+    {
+      gint value;
+
+      memcpy (&value, data, sizeof value);
+      segment_size = value;
+    }
+  else if (type == UDP_SEGMENT && size == sizeof (guint16))
+    {
+      guint16 value;
+
+      memcpy (&value, data, sizeof value);
+      segment_size = value;
+    }
+  else
+    return NULL;
+
+  return g_udp_segment_message_new (segment_size);
+#else
+  return NULL;
+#endif
+}
+
+static void
+g_udp_segment_message_serialize (GSocketControlMessage *_message,
+                                 gpointer               data)
+{
+#if UDP_SEGMENT_MESSAGE_SUPPORTED
+  GUdpSegmentMessage *message = G_UDP_SEGMENT_MESSAGE (_message);
+  guint16 value = message->segment_size;
+
+  memcpy (data, &value, sizeof value);
+#endif
+}
+
+static void
+g_udp_segment_message_init (GUdpSegmentMessage *message)
+{
+}
+
+static void
+g_udp_segment_message_class_init (GUdpSegmentMessageClass *class)
+{
+  GSocketControlMessageClass *scm_class;
+
+  scm_class = G_SOCKET_CONTROL_MESSAGE_CLASS (class);
+  scm_class->get_size = g_udp_segment_message_get_size;
+  scm_class->get_level = g_udp_segment_message_get_level;
+  scm_class->get_type = g_udp_segment_message_get_msg_type;
+  scm_class->serialize = g_udp_segment_message_serialize;
+  scm_class->deserialize = g_udp_segment_message_deserialize;
+}
+
+/**
+ * g_udp_segment_message_is_supported:
+ *
+ * Checks if UDP segmentation offload messages are supported on this
+ * platform. Even when they are, the running kernel may still reject
+ * them; sending one then fails with an error.
+ *
+ * Returns: %TRUE if supported, %FALSE otherwise
+ *
+ * Since: 2.54
+ */
+gboolean
+g_udp_segment_message_is_supported (void)
+{
+  return UDP_SEGMENT_MESSAGE_SUPPORTED;
+}
+
+/**
+ * g_udp_segment_message_new:
+ * @segment_size: the size of each datagram, in bytes
+ *
+ * Creates a new #GUdpSegmentMessage asking for the buffer it is sent
+ * with to be split into datagrams of @segment_size bytes.
+ *
+ * Returns: (transfer full): a new #GUdpSegmentMessage
+ *
+ * Since: 2.54
+ */
+GSocketControlMessage *
+g_udp_segment_message_new (guint segment_size)
+{
+  GUdpSegmentMessage *message;
+
+  g_return_val_if_fail (segment_size > 0 && segment_size <= G_MAXUINT16, NULL);
+  g_return_val_if_fail (g_udp_segment_message_is_supported (), NULL);
+
+  message = g_object_new (G_TYPE_UDP_SEGMENT_MESSAGE, NULL);
+  message->segment_size = segment_size;
+
+  return G_SOCKET_CONTROL_MESSAGE (message);
+}
+
+/**
+ * g_udp_segment_message_get_segment_size:
+ * @message: a #GUdpSegmentMessage
+ *
+ * Gets the segment size of @message: the size of the datagrams a sent
+ * buffer is split into, or that a received buffer was coalesced from.
+ *
+ * Returns: the segment size, in bytes
+ *
+ * Since: 2.54
+ */
+guint
+g_udp_segment_message_get_segment_size (GUdpSegmentMessage *message)
+{
+  g_return_val_if_fail (G_IS_UDP_SEGMENT_MESSAGE (message), 0);
+
+  return message->segment_size;
+}
@@ -0,0 +1,82 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_UDP_SEGMENT_MESSAGE_H__
+#define __G_UDP_SEGMENT_MESSAGE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define G_TYPE_UDP_SEGMENT_MESSAGE         (g_udp_segment_message_get_type ())
+#define G_UDP_SEGMENT_MESSAGE(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), G_TYPE_UDP_SEGMENT_MESSAGE, GUdpSegmentMessage))
+#define G_UDP_SEGMENT_MESSAGE_CLASS(c)     (G_TYPE_CHECK_CLASS_CAST ((c), G_TYPE_UDP_SEGMENT_MESSAGE, GUdpSegmentMessageClass))
+#define G_IS_UDP_SEGMENT_MESSAGE(o)        (G_TYPE_CHECK_INSTANCE_TYPE ((o), G_TYPE_UDP_SEGMENT_MESSAGE))
+#define G_IS_UDP_SEGMENT_MESSAGE_CLASS(c)  (G_TYPE_CHECK_CLASS_TYPE ((c), G_TYPE_UDP_SEGMENT_MESSAGE))
+#define G_UDP_SEGMENT_MESSAGE_GET_CLASS(o) (G_TYPE_INSTANCE_GET_CLASS ((o), G_TYPE_UDP_SEGMENT_MESSAGE, GUdpSegmentMessageClass))
+
+typedef struct _GUdpSegmentMessage        GUdpSegmentMessage;
+typedef struct _GUdpSegmentMessageClass   GUdpSegmentMessageClass;
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GUdpSegmentMessage, g_object_unref)
+
+/**
+ * GUdpSegmentMessageClass:
+ *
+ * Class structure for #GUdpSegmentMessage.
+ *
+ * Since: 2.54
+ */
+struct _GUdpSegmentMessageClass
+{
+  GSocketControlMessageClass parent_class;
+
+  /*< private >*/
+
+  /* Padding for future expansion */
+  void (*_g_reserved1) (void);
+  void (*_g_reserved2) (void);
+};
+
+/**
+ * GUdpSegmentMessage:
+ *
+ * The #GUdpSegmentMessage structure contains only private data
+ * and should only be accessed using the provided API.
+ *
+ * Since: 2.54
+ */
+struct _GUdpSegmentMessage
+{
+  GSocketControlMessage parent_instance;
+
+  /*< private >*/
+  guint segment_size;
+};
+
+GLIB_AVAILABLE_IN_2_54
+GType                  g_udp_segment_message_get_type         (void) G_GNUC_CONST;
+GLIB_AVAILABLE_IN_2_54
+GSocketControlMessage *g_udp_segment_message_new              (guint               segment_size);
+GLIB_AVAILABLE_IN_2_54
+guint                  g_udp_segment_message_get_segment_size (GUdpSegmentMessage *message);
+
+GLIB_AVAILABLE_IN_2_54
+gboolean               g_udp_segment_message_is_supported     (void);
+
+G_END_DECLS
+
+#endif /* __G_UDP_SEGMENT_MESSAGE_H__ */
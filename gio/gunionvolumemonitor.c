@@ -434,7 +434,7 @@ get_default_native_class (gpointer data)
   use_this = g_getenv ("GIO_USE_VOLUME_MONITOR");
   
   /* Ensure vfs in modules loaded */
-  _g_io_modules_ensure_loaded ();
+  _g_io_modules_ensure_extension_point_loaded (G_NATIVE_VOLUME_MONITOR_EXTENSION_POINT_NAME);
 
   ep = g_io_extension_point_lookup (G_NATIVE_VOLUME_MONITOR_EXTENSION_POINT_NAME);
 
@@ -522,6 +522,7 @@ populate_union_monitor (GUnionVolumeMonitor *union_monitor)
       g_type_class_unref (native_class);
     }
 
+  _g_io_modules_ensure_extension_point_loaded (G_VOLUME_MONITOR_EXTENSION_POINT_NAME);
   ep = g_io_extension_point_lookup (G_VOLUME_MONITOR_EXTENSION_POINT_NAME);
   for (l = g_io_extension_point_get_extensions (ep); l != NULL; l = l->next)
     {
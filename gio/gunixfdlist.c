@@ -44,11 +44,37 @@
 #include <fcntl.h>
 #include <string.h>
 #include <errno.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 
 #include "gunixfdlist.h"
 #include "gnetworking.h"
 #include "gioerror.h"
 
+#include "glib/gstdio.h"
+#include "glibintl.h"
+
+/* Not all C libraries know about memfd and file sealing yet */
+#ifdef __linux__
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS (1024 + 9)
+#define F_GET_SEALS (1024 + 10)
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#define F_SEAL_WRITE 0x0008
+#endif
+#endif
+
 struct _GUnixFDListPrivate
 {
   gint *fds;
@@ -398,3 +424,312 @@ g_unix_fd_list_get_length (GUnixFDList *list)
 
   return list->priv->nfd;
 }
+
+/* Returns a new, empty, close-on-exec file that isn't linked anywhere
+ * in the file system.  *sealable is set to whether F_ADD_SEALS can be
+ * used on it.
+ */
+static gint
+create_anonymous_file (gboolean  *sealable,
+                       GError   **error)
+{
+  gchar *path;
+  gint fd;
+
+#if defined(__linux__) && defined(__NR_memfd_create)
+  fd = syscall (__NR_memfd_create, "gio-bytes", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd >= 0)
+    {
+      *sealable = TRUE;
+      return fd;
+    }
+#endif
+
+  *sealable = FALSE;
+
+  fd = g_file_open_tmp ("gio-bytes-XXXXXX", &path, error);
+  if (fd < 0)
+    return -1;
+  g_unlink (path);
+  g_free (path);
+
+  fcntl (fd, F_SETFD, fcntl (fd, F_GETFD) | FD_CLOEXEC);
+
+  return fd;
+}
+
+/**
+ * g_unix_fd_list_append_bytes:
+ * @list: a #GUnixFDList
+ * @bytes: the data to add
+ * @error: a #GError pointer
+ *
+ * Copies the contents of @bytes into a new anonymous file and adds a
+ * file descriptor for it to @list, in the same way as
+ * g_unix_fd_list_append().
+ *
+ * Where supported (memfd on Linux), the file is sealed so that neither
+ * its size nor its contents can be changed anymore. The receiving side
+ * can then map it with g_unix_fd_list_get_bytes() instead of copying
+ * it, which makes this an efficient way to pass large buffers to
+ * another process, for example in a D-Bus `h` argument.
+ *
+ * Returns: the index of the appended fd in case of success, else -1
+ *          (and @error is set)
+ *
+ * Since: 2.54
+ */
+gint
+g_unix_fd_list_append_bytes (GUnixFDList  *list,
+                             GBytes       *bytes,
+                             GError      **error)
+{
+  const guint8 *data;
+  gsize size;
+  gsize written;
+  gboolean sealable;
+  gint fd;
+  gint index_;
+
+  g_return_val_if_fail (G_IS_UNIX_FD_LIST (list), -1);
+  g_return_val_if_fail (bytes != NULL, -1);
+  g_return_val_if_fail (error == NULL || *error == NULL, -1);
+
+  fd = create_anonymous_file (&sealable, error);
+  if (fd < 0)
+    return -1;
+
+  data = g_bytes_get_data (bytes, &size);
+  written = 0;
+  while (written < size)
+    {
+      gssize ret;
+
+      ret = write (fd, data + written, size - written);
+      if (ret < 0)
+        {
+          int saved_errno = errno;
+
+          if (saved_errno == EINTR)
+            continue;
+
+          g_set_error (error, G_IO_ERROR,
+                       g_io_error_from_errno (saved_errno),
+                       _("Error writing to anonymous file: %s"),
+                       g_strerror (saved_errno));
+          close (fd);
+          return -1;
+        }
+      written += ret;
+    }
+
+#ifdef F_ADD_SEALS
+  if (sealable)
+    fcntl (fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+#endif
+
+  index_ = g_unix_fd_list_append (list, fd, error);
+  close (fd);
+
+  return index_;
+}
+
+/**
+ * g_unix_fd_list_get_bytes:
+ * @list: a #GUnixFDList
+ * @index_: the index into the list
+ * @error: a #GError pointer
+ *
+ * Gets the contents of the file referred to by the file descriptor at
+ * @index_ in @list, typically one added by the sending side with
+ * g_unix_fd_list_append_bytes().
+ *
+ * If the file is sealed against writing and shrinking, it is mapped
+ * into memory and no data is copied. Otherwise, since the sender could
+ * still change the file, its current contents are read into a new
+ * buffer.
+ *
+ * The file descriptor stays in @list.
+ *
+ * Returns: (transfer full): a #GBytes with the contents of the file,
+ *          or %NULL if @error is set
+ *
+ * Since: 2.54
+ */
+GBytes *
+g_unix_fd_list_get_bytes (GUnixFDList  *list,
+                          gint          index_,
+                          GError      **error)
+{
+  struct stat buf;
+  GBytes *bytes;
+  guint8 *data;
+  gsize size;
+  gsize nread;
+  gint fd;
+
+  g_return_val_if_fail (G_IS_UNIX_FD_LIST (list), NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  if (index_ < 0 || index_ >= list->priv->nfd)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                   _("File descriptor index %d out of range (%d file descriptors)"),
+                   index_, list->priv->nfd);
+      return NULL;
+    }
+
+  fd = list->priv->fds[index_];
+
+#ifdef F_GET_SEALS
+  {
+    gint seals;
+
+    seals = fcntl (fd, F_GET_SEALS);
+    if (seals >= 0 &&
+        (seals & (F_SEAL_SHRINK | F_SEAL_WRITE)) == (F_SEAL_SHRINK | F_SEAL_WRITE))
+      {
+        GMappedFile *mapped_file;
+
+        mapped_file = g_mapped_file_new_from_fd (fd, FALSE, error);
+        if (mapped_file == NULL)
+          return NULL;
+        bytes = g_mapped_file_get_bytes (mapped_file);
+        g_mapped_file_unref (mapped_file);
+        return bytes;
+      }
+  }
+#endif
+
+  if (fstat (fd, &buf) < 0)
+    {
+      int saved_errno = errno;
+
+      g_set_error (error, G_IO_ERROR,
+                   g_io_error_from_errno (saved_errno),
+                   _("Error getting file size: %s"),
+                   g_strerror (saved_errno));
+      return NULL;
+    }
+
+  /* The file offset is shared with the sender, so use pread() */
+  size = buf.st_size;
+  data = g_malloc (size);
+  nread = 0;
+  while (nread < size)
+    {
+      gssize ret;
+
+      ret = pread (fd, data + nread, size - nread, nread);
+      if (ret < 0)
+        {
+          int saved_errno = errno;
+
+          if (saved_errno == EINTR)
+            continue;
+
+          g_set_error (error, G_IO_ERROR,
+                       g_io_error_from_errno (saved_errno),
+                       _("Error reading from file descriptor: %s"),
+                       g_strerror (saved_errno));
+          g_free (data);
+          return NULL;
+        }
+      else if (ret == 0)
+        break;
+      nread += ret;
+    }
+
+  return g_bytes_new_take (data, nread);
+}
+
+/**
+ * g_unix_fd_list_pack_bytes:
+ * @list: a #GUnixFDList
+ * @bytes: the data to send
+ * @threshold: size, in bytes, from which @bytes is passed as a file
+ * @error: a #GError pointer
+ *
+ * Creates a #GVariant for sending @bytes over D-Bus together with
+ * @list. If @bytes is smaller than @threshold, the returned value
+ * is a byte array (`ay`) holding the data. Otherwise the data is
+ * added to @list with g_unix_fd_list_append_bytes() and the returned
+ * value is a handle (`h`) referring to it.
+ *
+ * Since the type of the result depends on the size of @bytes, it is
+ * normally sent in a `v` argument, and decoded on the other side with
+ * g_unix_fd_list_unpack_bytes().
+ *
+ * Returns: (transfer floating): a new floating #GVariant, or %NULL if
+ *          @error is set
+ *
+ * Since: 2.54
+ */
+GVariant *
+g_unix_fd_list_pack_bytes (GUnixFDList  *list,
+                           GBytes       *bytes,
+                           gsize         threshold,
+                           GError      **error)
+{
+  gint index_;
+
+  g_return_val_if_fail (G_IS_UNIX_FD_LIST (list), NULL);
+  g_return_val_if_fail (bytes != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  if (g_bytes_get_size (bytes) < threshold)
+    return g_variant_new_from_bytes (G_VARIANT_TYPE_BYTESTRING, bytes, TRUE);
+
+  index_ = g_unix_fd_list_append_bytes (list, bytes, error);
+  if (index_ < 0)
+    return NULL;
+
+  return g_variant_new_handle (index_);
+}
+
+/**
+ * g_unix_fd_list_unpack_bytes:
+ * @list: (nullable): the #GUnixFDList received with @value, or %NULL
+ * @value: a #GVariant of type `ay` or `h`
+ * @error: a #GError pointer
+ *
+ * Gets the data sent with g_unix_fd_list_pack_bytes().
+ *
+ * If @value is a byte array, its contents are returned. If it is a
+ * handle, the contents of the file it refers to in @list are returned,
+ * as with g_unix_fd_list_get_bytes().
+ *
+ * Returns: (transfer full): a #GBytes with the data, or %NULL if
+ *          @error is set
+ *
+ * Since: 2.54
+ */
+GBytes *
+g_unix_fd_list_unpack_bytes (GUnixFDList  *list,
+                             GVariant     *value,
+                             GError      **error)
+{
+  g_return_val_if_fail (list == NULL || G_IS_UNIX_FD_LIST (list), NULL);
+  g_return_val_if_fail (value != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  if (g_variant_is_of_type (value, G_VARIANT_TYPE_BYTESTRING))
+    return g_variant_get_data_as_bytes (value);
+
+  if (!g_variant_is_of_type (value, G_VARIANT_TYPE_HANDLE))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                   _("Expected a value of type 'ay' or 'h', got '%s'"),
+                   g_variant_get_type_string (value));
+      return NULL;
+    }
+
+  if (list == NULL)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                   _("Got a file descriptor index but no file descriptors"));
+      return NULL;
+    }
+
+  return g_unix_fd_list_get_bytes (list, g_variant_get_handle (value), error);
+}
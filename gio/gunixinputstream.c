@@ -35,6 +35,7 @@
 #include "gcancellable.h"
 #include "gasynchelper.h"
 #include "gfiledescriptorbased.h"
+#include "gioprivate.h"
 #include "glibintl.h"
 
 
@@ -341,23 +342,26 @@ g_unix_input_stream_read (GInputStream  *stream,
   gssize res = -1;
   GPollFD poll_fds[2];
   int nfds;
+  gboolean waiting;
   int poll_ret;
 
   unix_stream = G_UNIX_INPUT_STREAM (stream);
 
   poll_fds[0].fd = unix_stream->priv->fd;
   poll_fds[0].events = G_IO_IN;
-  if (unix_stream->priv->is_pipe_or_socket &&
-      g_cancellable_make_pollfd (cancellable, &poll_fds[1]))
-    nfds = 2;
-  else
-    nfds = 1;
+  /* Only pipes and sockets can block. Check whether the fd is ready
+   * first, and only create a pollable fd for @cancellable if we really
+   * have to wait: most calls never do, and setting one up is not free.
+   */
+  nfds = 1;
+  waiting = !unix_stream->priv->is_pipe_or_socket || cancellable == NULL;
 
   while (1)
     {
       poll_fds[0].revents = poll_fds[1].revents = 0;
       do
-	poll_ret = g_poll (poll_fds, nfds, -1);
+	poll_ret = g_poll (poll_fds, nfds,
+			   waiting ? g_cancellable_get_poll_timeout (cancellable, -1) : 0);
       while (poll_ret == -1 && errno == EINTR);
 
       if (poll_ret == -1)
@@ -375,7 +379,15 @@ g_unix_input_stream_read (GInputStream  *stream,
 	break;
 
       if (!poll_fds[0].revents)
-	continue;
+	{
+	  if (!waiting)
+	    {
+	      waiting = TRUE;
+	      if (g_cancellable_make_pollfd (cancellable, &poll_fds[1]))
+		nfds = 2;
+	    }
+	  continue;
+	}
 
       res = read (unix_stream->priv->fd, buffer, count);
       if (res == -1)
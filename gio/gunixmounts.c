@@ -36,7 +36,9 @@
 #include <poll.h>
 #endif
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/time.h>
 #include <errno.h>
 #include <string.h>
@@ -1388,6 +1390,184 @@ get_mount_points_timestamp (void)
   return 0;
 }
 
+/* Mount table cache {{{2
+ *
+ * Generating the mount table is expensive for the kernel (and parsing
+ * it for us) on systems with thousands of mounts, and some callers
+ * such as g_unix_mount_for() look things up in it all the time.  So on
+ * Linux, where the kernel tells us about changes to the table by
+ * flagging POLLERR on an open /proc mounts file, we keep the parsed
+ * table around together with an index by mount path, and only reparse
+ * once the table has actually changed.
+ *
+ * Each poll() on the file reports a change only once, so the cache
+ * uses its own file descriptor, separate from GUnixMountMonitor's.
+ */
+
+static GUnixMountEntry *
+unix_mount_entry_copy (GUnixMountEntry *mount_entry)
+{
+  GUnixMountEntry *copy;
+
+  copy = g_new0 (GUnixMountEntry, 1);
+  copy->mount_path = g_strdup (mount_entry->mount_path);
+  copy->device_path = g_strdup (mount_entry->device_path);
+  copy->filesystem_type = g_strdup (mount_entry->filesystem_type);
+  copy->is_read_only = mount_entry->is_read_only;
+  copy->is_system_internal = mount_entry->is_system_internal;
+
+  return copy;
+}
+
+typedef struct
+{
+  gint        fd;        /* polled for changes, -1 if not possible */
+  gboolean    valid;
+  GList      *mounts;    /* as returned by _g_get_unix_mounts () */
+  GHashTable *by_path;   /* mount_path -> first entry with that path */
+} MountCache;
+
+G_LOCK_DEFINE_STATIC (mount_cache);
+static MountCache mount_cache = { -2, };
+
+/* Called with the lock held */
+static void
+mount_cache_update (void)
+{
+  GList *l;
+
+  if (mount_cache.fd == -2)
+    {
+      mount_cache.fd = -1;
+
+#if defined(HAVE_POLL) && defined(O_CLOEXEC)
+      {
+        const char *monitor_file = get_mtab_monitor_file ();
+
+        if (monitor_file != NULL && g_str_has_prefix (monitor_file, "/proc/"))
+          mount_cache.fd = g_open (monitor_file, O_RDONLY | O_CLOEXEC, 0);
+      }
+#endif
+    }
+
+  if (mount_cache.fd == -1)
+    mount_cache.valid = FALSE;
+#ifdef HAVE_POLL
+  else
+    {
+      struct pollfd pfd;
+
+      pfd.fd = mount_cache.fd;
+      pfd.events = POLLPRI;
+      pfd.revents = 0;
+
+      if (poll (&pfd, 1, 0) != 0)
+        mount_cache.valid = FALSE;
+    }
+#endif
+
+  if (mount_cache.valid)
+    return;
+
+  g_list_free_full (mount_cache.mounts, (GDestroyNotify) g_unix_mount_free);
+  g_clear_pointer (&mount_cache.by_path, g_hash_table_unref);
+
+  mount_cache.mounts = _g_get_unix_mounts ();
+  mount_cache.by_path = g_hash_table_new (g_str_hash, g_str_equal);
+
+  for (l = mount_cache.mounts; l != NULL; l = l->next)
+    {
+      GUnixMountEntry *mount_entry = l->data;
+
+      if (!g_hash_table_contains (mount_cache.by_path, mount_entry->mount_path))
+        g_hash_table_insert (mount_cache.by_path, mount_entry->mount_path, mount_entry);
+    }
+
+  /* Without a way to notice changes, the next caller has to reparse */
+  mount_cache.valid = mount_cache.fd != -1;
+}
+
+static GList *
+get_unix_mounts_cached (void)
+{
+  GList *mounts = NULL;
+  GList *l;
+
+  G_LOCK (mount_cache);
+
+  mount_cache_update ();
+
+  for (l = mount_cache.mounts; l != NULL; l = l->next)
+    mounts = g_list_prepend (mounts, unix_mount_entry_copy (l->data));
+
+  G_UNLOCK (mount_cache);
+
+  return g_list_reverse (mounts);
+}
+
+/* Returns a copy of the (first) mount at exactly @mount_path */
+static GUnixMountEntry *
+get_unix_mount_at_cached (const char *mount_path)
+{
+  GUnixMountEntry *mount_entry;
+
+  G_LOCK (mount_cache);
+
+  mount_cache_update ();
+
+  mount_entry = g_hash_table_lookup (mount_cache.by_path, mount_path);
+  if (mount_entry != NULL)
+    mount_entry = unix_mount_entry_copy (mount_entry);
+
+  G_UNLOCK (mount_cache);
+
+  return mount_entry;
+}
+
+/* Returns a copy of the mount with the longest mount path that is a
+ * prefix of @file_path, or %NULL if the table can't be trusted for
+ * this (see mount_cache_update()).
+ */
+static GUnixMountEntry *
+get_unix_mount_for_cached (const char *file_path)
+{
+  GUnixMountEntry *mount_entry = NULL;
+  char *path, *slash;
+
+  G_LOCK (mount_cache);
+
+  mount_cache_update ();
+
+  if (mount_cache.fd == -1)
+    {
+      G_UNLOCK (mount_cache);
+      return NULL;
+    }
+
+  path = g_strdup (file_path);
+
+  while (TRUE)
+    {
+      mount_entry = g_hash_table_lookup (mount_cache.by_path, path[0] ? path : "/");
+      if (mount_entry != NULL || path[0] == '\0')
+        break;
+
+      slash = strrchr (path, '/');
+      if (slash == NULL)
+        break;
+      *slash = '\0';
+    }
+
+  if (mount_entry != NULL)
+    mount_entry = unix_mount_entry_copy (mount_entry);
+
+  G_UNLOCK (mount_cache);
+
+  g_free (path);
+
+  return mount_entry;
+}
+
 /**
  * g_unix_mounts_get: (skip)
  * @time_read: (out) (optional): guint64 to contain a timestamp, or %NULL
@@ -1406,7 +1586,7 @@ g_unix_mounts_get (guint64 *time_read)
   if (time_read)
     *time_read = get_mounts_timestamp ();
 
-  return _g_get_unix_mounts ();
+  return get_unix_mounts_cached ();
 }
 
 /**
@@ -1424,24 +1604,10 @@ GUnixMountEntry *
 g_unix_mount_at (const char *mount_path,
 		 guint64    *time_read)
 {
-  GList *mounts, *l;
-  GUnixMountEntry *mount_entry, *found;
-  
-  mounts = g_unix_mounts_get (time_read);
-
-  found = NULL;
-  for (l = mounts; l != NULL; l = l->next)
-    {
-      mount_entry = l->data;
-
-      if (!found && strcmp (mount_path, mount_entry->mount_path) == 0)
-        found = mount_entry;
-      else
-        g_unix_mount_free (mount_entry);
-    }
-  g_list_free (mounts);
+  if (time_read)
+    *time_read = get_mounts_timestamp ();
 
-  return found;
+  return get_unix_mount_at_cached (mount_path);
 }
 
 /**
@@ -1466,6 +1632,19 @@ g_unix_mount_for (const char *file_path,
   g_return_val_if_fail (file_path != NULL, NULL);
 
   entry = g_unix_mount_at (file_path, time_read);
+
+  /* Look for the closest enclosing mount path in the cached table,
+   * after resolving symlinks (which a plain prefix match can't see).
+   */
+  if (entry == NULL && g_path_is_absolute (file_path))
+    {
+      char *resolved;
+
+      resolved = realpath (file_path, NULL);
+      entry = get_unix_mount_for_cached (resolved ? resolved : file_path);
+      free (resolved);
+    }
+
   if (entry == NULL)
     {
       char *topdir;
@@ -22,7 +22,9 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
+#include <limits.h>
 #include <errno.h>
 #include <stdio.h>
 #include <fcntl.h>
@@ -35,6 +37,7 @@
 #include "gcancellable.h"
 #include "gasynchelper.h"
 #include "gfiledescriptorbased.h"
+#include "gioprivate.h"
 #include "glibintl.h"
 
 
@@ -91,6 +94,11 @@ static gssize   g_unix_output_stream_write        (GOutputStream        *stream,
 						   gsize                 count,
 						   GCancellable         *cancellable,
 						   GError              **error);
+static gssize   g_unix_output_stream_writev       (GOutputStream        *stream,
+						   const GOutputVector  *vectors,
+						   gsize                 n_vectors,
+						   GCancellable         *cancellable,
+						   GError              **error);
 static gboolean g_unix_output_stream_close        (GOutputStream        *stream,
 						   GCancellable         *cancellable,
 						   GError              **error);
@@ -107,6 +115,10 @@ static gboolean g_unix_output_stream_pollable_can_poll      (GPollableOutputStre
 static gboolean g_unix_output_stream_pollable_is_writable   (GPollableOutputStream *stream);
 static GSource *g_unix_output_stream_pollable_create_source (GPollableOutputStream *stream,
 							     GCancellable         *cancellable);
+static gssize   g_unix_output_stream_pollable_writev_nonblocking (GPollableOutputStream  *stream,
+								  const GOutputVector    *vectors,
+								  gsize                   n_vectors,
+								  GError                **error);
 
 static void
 g_unix_output_stream_class_init (GUnixOutputStreamClass *klass)
@@ -118,6 +130,7 @@ g_unix_output_stream_class_init (GUnixOutputStreamClass *klass)
   gobject_class->set_property = g_unix_output_stream_set_property;
 
   stream_class->write_fn = g_unix_output_stream_write;
+  stream_class->writev_fn = g_unix_output_stream_writev;
   stream_class->close_fn = g_unix_output_stream_close;
   stream_class->close_async = g_unix_output_stream_close_async;
   stream_class->close_finish = g_unix_output_stream_close_finish;
@@ -159,6 +172,7 @@ g_unix_output_stream_pollable_iface_init (GPollableOutputStreamInterface *iface)
   iface->can_poll = g_unix_output_stream_pollable_can_poll;
   iface->is_writable = g_unix_output_stream_pollable_is_writable;
   iface->create_source = g_unix_output_stream_pollable_create_source;
+  iface->writev_nonblocking = g_unix_output_stream_pollable_writev_nonblocking;
 }
 
 static void
@@ -326,6 +340,7 @@ g_unix_output_stream_write (GOutputStream  *stream,
   gssize res = -1;
   GPollFD poll_fds[2];
   int nfds;
+  gboolean waiting;
   int poll_ret;
 
   unix_stream = G_UNIX_OUTPUT_STREAM (stream);
@@ -333,17 +348,19 @@ g_unix_output_stream_write (GOutputStream  *stream,
   poll_fds[0].fd = unix_stream->priv->fd;
   poll_fds[0].events = G_IO_OUT;
 
-  if (unix_stream->priv->is_pipe_or_socket &&
-      g_cancellable_make_pollfd (cancellable, &poll_fds[1]))
-    nfds = 2;
-  else
-    nfds = 1;
+  /* Only pipes and sockets can block. Check whether the fd is ready
+   * first, and only create a pollable fd for @cancellable if we really
+   * have to wait: most calls never do, and setting one up is not free.
+   */
+  nfds = 1;
+  waiting = !unix_stream->priv->is_pipe_or_socket || cancellable == NULL;
 
   while (1)
     {
       poll_fds[0].revents = poll_fds[1].revents = 0;
       do
-	poll_ret = g_poll (poll_fds, nfds, -1);
+	poll_ret = g_poll (poll_fds, nfds,
+			   waiting ? g_cancellable_get_poll_timeout (cancellable, -1) : 0);
       while (poll_ret == -1 && errno == EINTR);
 
       if (poll_ret == -1)
@@ -361,7 +378,15 @@ g_unix_output_stream_write (GOutputStream  *stream,
 	break;
 
       if (!poll_fds[0].revents)
-	continue;
+	{
+	  if (!waiting)
+	    {
+	      waiting = TRUE;
+	      if (g_cancellable_make_pollfd (cancellable, &poll_fds[1]))
+		nfds = 2;
+	    }
+	  continue;
+	}
 
       res = write (unix_stream->priv->fd, buffer, count);
       if (res == -1)
@@ -385,6 +410,118 @@ g_unix_output_stream_write (GOutputStream  *stream,
   return res;
 }
 
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+/* Calls writev() on @fd directly with @vectors when #GOutputVector has
+ * the same layout as struct iovec, which it does on every platform we
+ * know of. More than %IOV_MAX vectors result in a short write.
+ */
+static gssize
+writev_vectors (int                  fd,
+                const GOutputVector *vectors,
+                gsize                n_vectors)
+{
+  struct iovec *iov;
+  gsize i;
+
+  if (n_vectors > IOV_MAX)
+    n_vectors = IOV_MAX;
+
+  if (sizeof (struct iovec) == sizeof (GOutputVector) &&
+      G_STRUCT_OFFSET (struct iovec, iov_base) == G_STRUCT_OFFSET (GOutputVector, buffer) &&
+      G_STRUCT_OFFSET (struct iovec, iov_len) == G_STRUCT_OFFSET (GOutputVector, size))
+    return writev (fd, (const struct iovec *) vectors, n_vectors);
+
+  iov = g_newa (struct iovec, n_vectors);
+  for (i = 0; i < n_vectors; i++)
+    {
+      iov[i].iov_base = (void *) vectors[i].buffer;
+      iov[i].iov_len = vectors[i].size;
+    }
+
+  return writev (fd, iov, n_vectors);
+}
+
+static gssize
+g_unix_output_stream_writev (GOutputStream        *stream,
+			     const GOutputVector  *vectors,
+			     gsize                 n_vectors,
+			     GCancellable         *cancellable,
+			     GError              **error)
+{
+  GUnixOutputStream *unix_stream;
+  gssize res = -1;
+  GPollFD poll_fds[2];
+  int nfds;
+  gboolean waiting;
+  int poll_ret;
+
+  unix_stream = G_UNIX_OUTPUT_STREAM (stream);
+
+  poll_fds[0].fd = unix_stream->priv->fd;
+  poll_fds[0].events = G_IO_OUT;
+
+  /* See g_unix_output_stream_write() */
+  nfds = 1;
+  waiting = !unix_stream->priv->is_pipe_or_socket || cancellable == NULL;
+
+  while (1)
+    {
+      poll_fds[0].revents = poll_fds[1].revents = 0;
+      do
+	poll_ret = g_poll (poll_fds, nfds,
+			   waiting ? g_cancellable_get_poll_timeout (cancellable, -1) : 0);
+      while (poll_ret == -1 && errno == EINTR);
+
+      if (poll_ret == -1)
+	{
+          int errsv = errno;
+
+	  g_set_error (error, G_IO_ERROR,
+		       g_io_error_from_errno (errsv),
+		       _("Error writing to file descriptor: %s"),
+		       g_strerror (errsv));
+	  break;
+	}
+
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+	break;
+
+      if (!poll_fds[0].revents)
+	{
+	  if (!waiting)
+	    {
+	      waiting = TRUE;
+	      if (g_cancellable_make_pollfd (cancellable, &poll_fds[1]))
+		nfds = 2;
+	    }
+	  continue;
+	}
+
+      res = writev_vectors (unix_stream->priv->fd, vectors, n_vectors);
+      if (res == -1)
+	{
+          int errsv = errno;
+
+	  if (errsv == EINTR || errsv == EAGAIN)
+	    continue;
+
+	  g_set_error (error, G_IO_ERROR,
+		       g_io_error_from_errno (errsv),
+		       _("Error writing to file descriptor: %s"),
+		       g_strerror (errsv));
+	}
+
+      break;
+    }
+
+  if (nfds == 2)
+    g_cancellable_release_fd (cancellable);
+  return res;
+}
+
 static gboolean
 g_unix_output_stream_close (GOutputStream  *stream,
 			    GCancellable   *cancellable,
@@ -468,6 +605,43 @@ g_unix_output_stream_pollable_is_writable (GPollableOutputStream *stream)
   return poll_fd.revents != 0;
 }
 
+static gssize
+g_unix_output_stream_pollable_writev_nonblocking (GPollableOutputStream  *stream,
+						  const GOutputVector    *vectors,
+						  gsize                   n_vectors,
+						  GError                **error)
+{
+  GUnixOutputStream *unix_stream = G_UNIX_OUTPUT_STREAM (stream);
+  gssize res;
+
+  if (!g_pollable_output_stream_is_writable (stream))
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK,
+                           g_strerror (EAGAIN));
+      return -1;
+    }
+
+  do
+    res = writev_vectors (unix_stream->priv->fd, vectors, n_vectors);
+  while (res == -1 && errno == EINTR);
+
+  if (res == -1)
+    {
+      int errsv = errno;
+
+      if (errsv == EAGAIN)
+        g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK,
+                             g_strerror (errsv));
+      else
+        g_set_error (error, G_IO_ERROR,
+                     g_io_error_from_errno (errsv),
+                     _("Error writing to file descriptor: %s"),
+                     g_strerror (errsv));
+    }
+
+  return res;
+}
+
 static GSource *
 g_unix_output_stream_pollable_create_source (GPollableOutputStream *stream,
 					     GCancellable          *cancellable)
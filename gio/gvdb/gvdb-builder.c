@@ -36,6 +36,7 @@ struct _GvdbItem
   GvdbItem *parent;
   GvdbItem *sibling;
   GvdbItem *next;
+  guint order;
 
   /* one of:
    * this:
@@ -140,6 +141,17 @@ gvdb_item_set_hash_table (GvdbItem   *item,
   item->table = g_hash_table_ref (table);
 }
 
+/* Items with a non-zero order have their values stored after all the
+ * others, sorted by that order, so that values which are used together
+ * can be put next to each other in the file.
+ */
+void
+gvdb_item_set_order (GvdbItem *item,
+                     guint     order)
+{
+  item->order = order;
+}
+
 void
 gvdb_item_set_parent (GvdbItem *item,
                       GvdbItem *parent)
@@ -214,8 +226,18 @@ typedef struct
   GQueue *chunks;
   guint64 offset;
   gboolean byteswap;
+  guint32 version;
+
+  /* values of ordered items, written last */
+  GPtrArray *deferred;
 } FileBuilder;
 
+typedef struct
+{
+  GvdbItem *item;
+  struct gvdb_pointer *pointer;
+} DeferredValue;
+
 typedef struct
 {
   gsize offset;
@@ -341,7 +363,298 @@ file_builder_allocate_for_hash (FileBuilder            *fb,
   memset (*bloom_filter, 0, n_bloom_words * sizeof (guint32_le));
 }
 
-static void
+static gboolean file_builder_add_hash (FileBuilder         *fb,
+                                       GHashTable          *table,
+                                       struct gvdb_pointer *pointer);
+
+static gboolean
+file_builder_add_entry (FileBuilder           *fb,
+                        GvdbItem              *item,
+                        struct gvdb_hash_item *entry)
+{
+  const gchar *basename;
+
+  entry->hash_value = guint32_to_le (item->hash_value);
+  entry->parent = item_to_index (item->parent);
+  entry->unused = 0;
+
+  /* version 2 stores the full key, see gvdb-format.h */
+  if (item->parent != NULL && fb->version == GVDB_VERSION_1)
+    basename = item->key + strlen (item->parent->key);
+  else
+    basename = item->key;
+
+  file_builder_add_string (fb, basename,
+                           &entry->key_start,
+                           &entry->key_size);
+
+  if (item->value != NULL)
+    {
+      g_assert (item->child == NULL && item->table == NULL);
+
+      /* the entry lives in a chunk which isn't going anywhere, so the
+       * pointer can be filled in later
+       */
+      if (item->order != 0)
+        {
+          DeferredValue *deferred = g_slice_new (DeferredValue);
+
+          deferred->item = item;
+          deferred->pointer = &entry->value.pointer;
+          g_ptr_array_add (fb->deferred, deferred);
+        }
+      else
+        file_builder_add_value (fb, item->value, &entry->value.pointer);
+      entry->type = 'v';
+    }
+
+  if (item->child != NULL)
+    {
+      guint32 children = 0, i = 0;
+      guint32_le *offsets;
+      GvdbItem *child;
+
+      g_assert (item->table == NULL);
+
+      for (child = item->child; child; child = child->sibling)
+        children++;
+
+      offsets = file_builder_allocate (fb, 4, 4 * children,
+                                       &entry->value.pointer);
+      entry->type = 'L';
+
+      for (child = item->child; child; child = child->sibling)
+        offsets[i++] = child->assigned_index;
+
+      g_assert (children == i);
+    }
+
+  if (item->table != NULL)
+    {
+      entry->type = 'H';
+      return file_builder_add_hash (fb, item->table, &entry->value.pointer);
+    }
+
+  return TRUE;
+}
+
+typedef struct
+{
+  GvdbItem **items;
+  guint32 n_items;
+  guint32 index;
+} MphBucket;
+
+static gint
+mph_bucket_compare (gconstpointer a,
+                    gconstpointer b,
+                    gpointer      user_data)
+{
+  const MphBucket *ba = a, *bb = b;
+
+  /* largest first, the small ones are easier to fit in the gaps */
+  return (ba->n_items < bb->n_items) - (ba->n_items > bb->n_items);
+}
+
+static guint32
+item_hash_v2 (GvdbItem *item)
+{
+  guint32 hash = GVDB_HASH_V2_INIT;
+  const gchar *c;
+
+  for (c = item->key; *c; c++)
+    hash = gvdb_hash_v2_step (hash, *c);
+
+  return hash;
+}
+
+/* Finds a displacement for each bucket of items (those sharing the same
+ * djb hash modulo @n_displacements) such that every item ends up in a
+ * different one of @n_slots slots.  Returns the items in slot order
+ * (with %NULL for unused slots), or %NULL if there is no solution in
+ * reasonable time, which normally only happens for keys with identical
+ * hashes.
+ */
+static GvdbItem **
+mph_build (GHashTable *table,
+           guint32     n_displacements,
+           guint32    *displacements,
+           guint32     n_slots)
+{
+  GvdbItem **slots = NULL;
+  MphBucket *buckets;
+  GHashTableIter iter;
+  guint32 *hashes;
+  guint32 *scratch;
+  guint32 n_items;
+  guint32 max_tries;
+  gpointer value;
+  guint32 i, j, k;
+  gboolean ok = TRUE;
+
+  n_items = g_hash_table_size (table);
+  buckets = g_new0 (MphBucket, n_displacements);
+
+  g_hash_table_iter_init (&iter, table);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    buckets[((GvdbItem *) value)->hash_value % n_displacements].n_items++;
+
+  for (i = 0; i < n_displacements; i++)
+    {
+      buckets[i].items = g_new (GvdbItem *, buckets[i].n_items);
+      buckets[i].index = i;
+      buckets[i].n_items = 0;
+    }
+
+  g_hash_table_iter_init (&iter, table);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      MphBucket *bucket = &buckets[((GvdbItem *) value)->hash_value % n_displacements];
+
+      bucket->items[bucket->n_items++] = value;
+    }
+
+  g_qsort_with_data (buckets, n_displacements, sizeof (MphBucket),
+                     mph_bucket_compare, NULL);
+
+  /* the second hash of every item, bucket by bucket */
+  hashes = g_new (guint32, n_items);
+  scratch = g_new (guint32, n_items);
+  slots = g_new0 (GvdbItem *, n_slots);
+  max_tries = MAX (n_items, 1024) * 16;
+
+  for (i = 0, k = 0; ok && i < n_displacements && buckets[i].n_items; i++)
+    {
+      MphBucket *bucket = &buckets[i];
+      guint32 *h = hashes + k;
+      guint32 d;
+
+      for (j = 0; j < bucket->n_items; j++)
+        h[j] = item_hash_v2 (bucket->items[j]);
+
+      for (d = 0; d < max_tries; d++)
+        {
+          for (j = 0; j < bucket->n_items; j++)
+            {
+              guint32 l;
+
+              scratch[j] = gvdb_hash_v2_slot (h[j], d, n_slots);
+
+              if (slots[scratch[j]] != NULL)
+                break;
+
+              for (l = 0; l < j; l++)
+                if (scratch[l] == scratch[j])
+                  break;
+
+              if (l < j)
+                break;
+            }
+
+          if (j == bucket->n_items)
+            break;
+        }
+
+      if (d == max_tries)
+        {
+          ok = FALSE;
+          break;
+        }
+
+      for (j = 0; j < bucket->n_items; j++)
+        slots[scratch[j]] = bucket->items[j];
+
+      displacements[bucket->index] = d;
+      k += bucket->n_items;
+    }
+
+  for (i = 0; i < n_displacements; i++)
+    g_free (buckets[i].items);
+  g_free (buckets);
+  g_free (hashes);
+  g_free (scratch);
+
+  if (!ok)
+    {
+      g_free (slots);
+      return NULL;
+    }
+
+  return slots;
+}
+
+static gboolean
+file_builder_add_hash_v2 (FileBuilder         *fb,
+                          GHashTable          *table,
+                          struct gvdb_pointer *pointer)
+{
+  struct gvdb_hash_header_v2 *header;
+  struct gvdb_hash_item *items;
+  guint32 *displacements;
+  guint32 n_displacements;
+  guint32 n_items;
+  guint32 n_slots;
+  GvdbItem **slots;
+  guint32 i;
+  gsize size;
+
+  n_items = g_hash_table_size (table);
+
+  if (n_items == 0)
+    {
+      header = file_builder_allocate (fb, 4, sizeof *header, pointer);
+      header->n_displacements = guint32_to_le (0);
+      header->n_items = guint32_to_le (0);
+      return TRUE;
+    }
+
+  /* On average, four items per displacement.  A couple of spare slots
+   * keep the search for the last displacements from taking very long.
+   */
+  n_displacements = (n_items + 3) / 4;
+  n_slots = n_items + n_items / 64 + 1;
+  displacements = g_new0 (guint32, n_displacements);
+  slots = mph_build (table, n_displacements, displacements, n_slots);
+
+  if (slots == NULL)
+    {
+      g_free (displacements);
+      return FALSE;
+    }
+
+  for (i = 0; i < n_slots; i++)
+    if (slots[i] != NULL)
+      slots[i]->assigned_index = guint32_to_le (i);
+
+  size = sizeof *header +
+         n_displacements * sizeof (guint32_le) +
+         n_slots * sizeof (struct gvdb_hash_item);
+  header = file_builder_allocate (fb, 4, size, pointer);
+  header->n_displacements = guint32_to_le (n_displacements);
+  header->n_items = guint32_to_le (n_slots);
+
+  for (i = 0; i < n_displacements; i++)
+    ((guint32_le *) (header + 1))[i] = guint32_to_le (displacements[i]);
+  g_free (displacements);
+
+  items = (struct gvdb_hash_item *) ((guint32_le *) (header + 1) + n_displacements);
+
+  /* unused slots have type 0, which no lookup matches */
+  memset (items, 0, n_slots * sizeof (struct gvdb_hash_item));
+
+  for (i = 0; i < n_slots; i++)
+    if (slots[i] != NULL && !file_builder_add_entry (fb, slots[i], &items[i]))
+      {
+        g_free (slots);
+        return FALSE;
+      }
+
+  g_free (slots);
+
+  return TRUE;
+}
+
+static gboolean
 file_builder_add_hash (FileBuilder         *fb,
                        GHashTable          *table,
                        struct gvdb_pointer *pointer)
@@ -353,6 +666,9 @@ file_builder_add_hash (FileBuilder         *fb,
   guint32 index;
   gint bucket;
 
+  if (fb->version == GVDB_VERSION_2)
+    return file_builder_add_hash_v2 (fb, table, pointer);
+
   mytable = hash_table_new (g_hash_table_size (table));
   g_hash_table_foreach (table, hash_table_insert, mytable);
   index = 0;
@@ -372,66 +688,22 @@ file_builder_add_hash (FileBuilder         *fb,
       for (item = mytable->buckets[bucket]; item; item = item->next)
         {
           struct gvdb_hash_item *entry = items++;
-          const gchar *basename;
 
           g_assert (index == guint32_from_le (item->assigned_index));
-          entry->hash_value = guint32_to_le (item->hash_value);
-          entry->parent = item_to_index (item->parent);
-          entry->unused = 0;
-
-          if (item->parent != NULL)
-            basename = item->key + strlen (item->parent->key);
-          else
-            basename = item->key;
-
-          file_builder_add_string (fb, basename,
-                                   &entry->key_start,
-                                   &entry->key_size);
-
-          if (item->value != NULL)
-            {
-              g_assert (item->child == NULL && item->table == NULL);
-
-              file_builder_add_value (fb, item->value, &entry->value.pointer);
-              entry->type = 'v';
-            }
-
-          if (item->child != NULL)
-            {
-              guint32 children = 0, i = 0;
-              guint32_le *offsets;
-              GvdbItem *child;
-
-              g_assert (item->table == NULL);
-
-              for (child = item->child; child; child = child->sibling)
-                children++;
-
-              offsets = file_builder_allocate (fb, 4, 4 * children,
-                                               &entry->value.pointer);
-              entry->type = 'L';
-
-              for (child = item->child; child; child = child->sibling)
-                offsets[i++] = child->assigned_index;
-
-              g_assert (children == i);
-            }
-
-          if (item->table != NULL)
-            {
-              entry->type = 'H';
-              file_builder_add_hash (fb, item->table, &entry->value.pointer);
-            }
+          file_builder_add_entry (fb, item, entry);
 
           index++;
         }
     }
 
   hash_table_free (mytable);
+
+  return TRUE;
 }
 
 static FileBuilder *
-file_builder_new (gboolean byteswap)
+file_builder_new (gboolean byteswap,
+                  guint32  version)
 {
   FileBuilder *builder;
 
@@ -439,10 +711,63 @@ file_builder_new (gboolean byteswap)
   builder->chunks = g_queue_new ();
   builder->offset = sizeof (struct gvdb_header);
   builder->byteswap = byteswap;
+  builder->version = version;
+  builder->deferred = g_ptr_array_new ();
 
   return builder;
 }
 
+static void
+deferred_value_free (gpointer data)
+{
+  g_slice_free (DeferredValue, data);
+}
+
+static gint
+deferred_value_compare (gconstpointer a,
+                        gconstpointer b)
+{
+  const DeferredValue *da = *(DeferredValue * const *) a;
+  const DeferredValue *db = *(DeferredValue * const *) b;
+
+  if (da->item->order != db->item->order)
+    return da->item->order < db->item->order ? -1 : 1;
+
+  return strcmp (da->item->key, db->item->key);
+}
+
+static void
+file_builder_add_deferred (FileBuilder *fb)
+{
+  guint i;
+
+  g_ptr_array_sort (fb->deferred, deferred_value_compare);
+
+  for (i = 0; i < fb->deferred->len; i++)
+    {
+      DeferredValue *deferred = fb->deferred->pdata[i];
+
+      file_builder_add_value (fb, deferred->item->value, deferred->pointer);
+    }
+}
+
+static void
+file_builder_free (FileBuilder *fb)
+{
+  FileChunk *chunk;
+
+  while ((chunk = g_queue_pop_head (fb->chunks)))
+    {
+      g_free (chunk->data);
+      g_slice_free (FileChunk, chunk);
+    }
+
+  g_queue_free (fb->chunks);
+  g_ptr_array_foreach (fb->deferred, (GFunc) deferred_value_free, NULL);
+  g_ptr_array_free (fb->deferred, TRUE);
+  g_slice_free (FileBuilder, fb);
+}
+
 static GString *
 file_builder_serialise (FileBuilder          *fb,
                         struct gvdb_pointer   root)
@@ -463,6 +788,7 @@ file_builder_serialise (FileBuilder          *fb,
 
   result = g_string_new (NULL);
 
+  header.version = guint32_to_le (fb->version);
   header.root = root;
   g_string_append_len (result, (gpointer) &header, sizeof header);
 
@@ -488,6 +814,8 @@ file_builder_serialise (FileBuilder          *fb,
     }
 
   g_queue_free (fb->chunks);
+  g_ptr_array_foreach (fb->deferred, (GFunc) deferred_value_free, NULL);
+  g_ptr_array_free (fb->deferred, TRUE);
   g_slice_free (FileBuilder, fb);
 
   return result;
@@ -498,14 +826,41 @@ gvdb_table_write_contents (GHashTable   *table,
                            const gchar  *filename,
                            gboolean      byteswap,
                            GError      **error)
+{
+  return gvdb_table_write_contents_with_version (table, filename, byteswap,
+                                                 GVDB_VERSION_1, error);
+}
+
+/* Writes @table in the given version of the format (see gvdb-format.h).
+ * Readers from before version 2 was introduced can't open version 2
+ * files, so only use it for files that are read by the same code.  If
+ * no perfect hash can be found for some table, which should only
+ * happen with colliding keys hashes, a version 1 file is written.
+ */
+gboolean
+gvdb_table_write_contents_with_version (GHashTable   *table,
+                                        const gchar  *filename,
+                                        gboolean      byteswap,
+                                        guint32       version,
+                                        GError      **error)
 {
   struct gvdb_pointer root;
   gboolean status;
   FileBuilder *fb;
   GString *str;
 
-  fb = file_builder_new (byteswap);
-  file_builder_add_hash (fb, table, &root);
+  g_return_val_if_fail (version == GVDB_VERSION_1 || version == GVDB_VERSION_2, FALSE);
+
+  fb = file_builder_new (byteswap, version);
+
+  if (!file_builder_add_hash (fb, table, &root))
+    {
+      file_builder_free (fb);
+      fb = file_builder_new (byteswap, GVDB_VERSION_1);
+      file_builder_add_hash (fb, table, &root);
+    }
+
+  file_builder_add_deferred (fb);
   str = file_builder_serialise (fb, root);
 
   status = g_file_set_contents (filename, str->str, str->len, error);
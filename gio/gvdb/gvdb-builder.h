@@ -22,6 +22,8 @@
 
 #include <gio/gio.h>
 
+#include "gvdb-format.h"
+
 typedef struct _GvdbItem GvdbItem;
 
 G_GNUC_INTERNAL
@@ -43,6 +45,9 @@ G_GNUC_INTERNAL
 void                    gvdb_item_set_hash_table                        (GvdbItem      *item,
                                                                          GHashTable    *table);
 G_GNUC_INTERNAL
+void                    gvdb_item_set_order                             (GvdbItem      *item,
+                                                                         guint          order);
+G_GNUC_INTERNAL
 void                    gvdb_item_set_parent                            (GvdbItem      *item,
                                                                          GvdbItem      *parent);
 
@@ -51,5 +56,11 @@ gboolean                gvdb_table_write_contents                       (GHashTa
                                                                          const gchar    *filename,
                                                                          gboolean        byteswap,
                                                                          GError        **error);
+G_GNUC_INTERNAL
+gboolean                gvdb_table_write_contents_with_version          (GHashTable     *table,
+                                                                         const gchar    *filename,
+                                                                         gboolean        byteswap,
+                                                                         guint32         version,
+                                                                         GError        **error);
 
 #endif /* __gvdb_builder_h__ */
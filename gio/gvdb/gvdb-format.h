@@ -35,6 +35,22 @@ struct gvdb_hash_header {
   guint32_le n_buckets;
 };
 
+/* Version 1 of the format (the default) has a bloom filter and hash
+ * buckets, and item keys are stored relative to their parent.
+ *
+ * Version 2 uses a perfect hash instead: the djb hash of a key selects
+ * a displacement, which together with a second hash of the key gives
+ * the index of the only item that can match.  There are about 1.5%
+ * more items than keys; the unused ones have type 0.  Item keys are
+ * stored in full, so a lookup is a single string comparison; the
+ * basename used by gvdb_table_list() is the part after the parent's
+ * key.  The items have the same layout in both versions.
+ */
+struct gvdb_hash_header_v2 {
+  guint32_le n_displacements;
+  guint32_le n_items;
+};
+
 struct gvdb_hash_item {
   guint32_le hash_value;
   guint32_le parent;
@@ -77,6 +93,32 @@ static inline guint16 guint16_from_le (guint16_le value) {
   return GUINT16_FROM_LE (value.value);
 }
 
+/* seeded FNV-1a, for the second hash used by the perfect hash */
+static inline guint32 gvdb_hash_v2_step (guint32 hash, gchar c) {
+  return (hash ^ (guchar) c) * 16777619u;
+}
+
+#define GVDB_HASH_V2_INIT 2166136261u
+
+static inline guint32 gvdb_hash_v2_slot (guint32 hash,
+                                         guint32 displacement,
+                                         guint32 n_items) {
+  guint32 h = hash + displacement * 0x9e3779b9u;
+
+  /* murmur3 finaliser */
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+
+  return h % n_items;
+}
+
+/* values of gvdb_header.version */
+#define GVDB_VERSION_1 0
+#define GVDB_VERSION_2 1
+
 #define GVDB_SIGNATURE0 1918981703
 #define GVDB_SIGNATURE1 1953390953
 #define GVDB_SWAPPED_SIGNATURE0 GUINT32_SWAP_LE_BE (GVDB_SIGNATURE0)
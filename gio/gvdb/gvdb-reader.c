@@ -34,7 +34,9 @@ struct _GvdbTable {
 
   gboolean byteswapped;
   gboolean trusted;
+  guint32 version;
 
+  /* GVDB_VERSION_1 */
   const guint32_le *bloom_words;
   guint32 n_bloom_words;
   guint bloom_shift;
@@ -42,14 +44,21 @@ struct _GvdbTable {
   const guint32_le *hash_buckets;
   guint32 n_buckets;
 
+  /* GVDB_VERSION_2 */
+  const guint32_le *displacements;
+  guint32 n_displacements;
+
   struct gvdb_hash_item *hash_items;
   guint32 n_hash_items;
 };
 
+/* the key as stored in the item: the basename in version 1, the full key
+ * in version 2
+ */
 static const gchar *
-gvdb_table_item_get_key (GvdbTable                   *file,
-                         const struct gvdb_hash_item *item,
-                         gsize                       *size)
+gvdb_table_item_get_stored_key (GvdbTable                   *file,
+                                const struct gvdb_hash_item *item,
+                                gsize                       *size)
 {
   guint32 start, end;
 
@@ -63,6 +72,32 @@ gvdb_table_item_get_key (GvdbTable                   *file,
   return file->data + start;
 }
 
+/* the key relative to the item's parent */
+static const gchar *
+gvdb_table_item_get_key (GvdbTable                   *file,
+                         const struct gvdb_hash_item *item,
+                         gsize                       *size)
+{
+  const gchar *key;
+  guint32 parent;
+
+  key = gvdb_table_item_get_stored_key (file, item, size);
+
+  if (key != NULL && file->version == GVDB_VERSION_2 &&
+      (parent = guint32_from_le (item->parent)) < file->n_hash_items)
+    {
+      gsize parent_size = guint16_from_le (file->hash_items[parent].key_size);
+
+      if G_UNLIKELY (parent_size > *size)
+        return NULL;
+
+      key += parent_size;
+      *size -= parent_size;
+    }
+
+  return key;
+}
+
 static gconstpointer
 gvdb_table_dereference (GvdbTable                 *file,
                         const struct gvdb_pointer *pointer,
@@ -82,6 +117,40 @@ gvdb_table_dereference (GvdbTable                 *file,
   return file->data + start;
 }
 
+static void
+gvdb_table_setup_root_v2 (GvdbTable                 *file,
+                          const struct gvdb_pointer *pointer)
+{
+  const struct gvdb_hash_header_v2 *header;
+  guint32 n_displacements;
+  guint32 n_items;
+  gsize size;
+
+  header = gvdb_table_dereference (file, pointer, 4, &size);
+
+  if G_UNLIKELY (header == NULL || size < sizeof *header)
+    return;
+
+  size -= sizeof *header;
+
+  n_displacements = guint32_from_le (header->n_displacements);
+  n_items = guint32_from_le (header->n_items);
+
+  if G_UNLIKELY (n_displacements > size / sizeof (guint32_le))
+    return;
+
+  size -= n_displacements * sizeof (guint32_le);
+
+  if G_UNLIKELY (n_items > size / sizeof (struct gvdb_hash_item) ||
+                 (n_items == 0) != (n_displacements == 0))
+    return;
+
+  file->displacements = (gpointer) (header + 1);
+  file->n_displacements = n_displacements;
+  file->hash_items = (gpointer) (file->displacements + n_displacements);
+  file->n_hash_items = n_items;
+}
+
 static void
 gvdb_table_setup_root (GvdbTable                 *file,
                        const struct gvdb_pointer *pointer)
@@ -91,6 +160,12 @@ gvdb_table_setup_root (GvdbTable                 *file,
   guint32 n_buckets;
   gsize size;
 
+  if (file->version == GVDB_VERSION_2)
+    {
+      gvdb_table_setup_root_v2 (file, pointer);
+      return;
+    }
+
   header = gvdb_table_dereference (file, pointer, 4, &size);
 
   if G_UNLIKELY (header == NULL || size < sizeof *header)
@@ -149,14 +224,16 @@ new_from_data (const void    *data,
     {
       const struct gvdb_header *header = (gpointer) file->data;
 
+      file->version = guint32_from_le (header->version);
+
       if (header->signature[0] == GVDB_SIGNATURE0 &&
           header->signature[1] == GVDB_SIGNATURE1 &&
-          guint32_from_le (header->version) == 0)
+          file->version <= GVDB_VERSION_2)
         file->byteswapped = FALSE;
 
       else if (header->signature[0] == GVDB_SWAPPED_SIGNATURE0 &&
                header->signature[1] == GVDB_SWAPPED_SIGNATURE1 &&
-               guint32_from_le (header->version) == 0)
+               file->version <= GVDB_VERSION_2)
         file->byteswapped = TRUE;
 
       else
@@ -282,7 +359,7 @@ gvdb_table_check_name (GvdbTable             *file,
   gsize this_size;
   guint32 parent;
 
-  this_key = gvdb_table_item_get_key (file, item, &this_size);
+  this_key = gvdb_table_item_get_stored_key (file, item, &this_size);
 
   if G_UNLIKELY (this_key == NULL || this_size > key_length)
     return FALSE;
@@ -304,6 +381,43 @@ gvdb_table_check_name (GvdbTable             *file,
   return FALSE;
 }
 
+static const struct gvdb_hash_item *
+gvdb_table_lookup_v2 (GvdbTable   *file,
+                      const gchar *key,
+                      gchar        type)
+{
+  const struct gvdb_hash_item *item;
+  guint32 hash_value = 5381;
+  guint32 hash_v2 = GVDB_HASH_V2_INIT;
+  guint32 displacement;
+  const gchar *this_key;
+  gsize this_size;
+  guint key_length;
+
+  if G_UNLIKELY (file->n_hash_items == 0)
+    return NULL;
+
+  for (key_length = 0; key[key_length]; key_length++)
+    {
+      hash_value = (hash_value * 33) + ((signed char *) key)[key_length];
+      hash_v2 = gvdb_hash_v2_step (hash_v2, key[key_length]);
+    }
+
+  displacement = guint32_from_le (file->displacements[hash_value % file->n_displacements]);
+  item = &file->hash_items[gvdb_hash_v2_slot (hash_v2, displacement, file->n_hash_items)];
+
+  if (hash_value != guint32_from_le (item->hash_value) || item->type != type)
+    return NULL;
+
+  this_key = gvdb_table_item_get_stored_key (file, item, &this_size);
+
+  if G_UNLIKELY (this_key == NULL || this_size != key_length ||
+                 memcmp (this_key, key, key_length) != 0)
+    return NULL;
+
+  return item;
+}
+
 static const struct gvdb_hash_item *
 gvdb_table_lookup (GvdbTable   *file,
                    const gchar *key,
@@ -315,6 +429,9 @@ gvdb_table_lookup (GvdbTable   *file,
   guint32 lastno;
   guint32 itemno;
 
+  if (file->version == GVDB_VERSION_2)
+    return gvdb_table_lookup_v2 (file, key, type);
+
   if G_UNLIKELY (file->n_buckets == 0 || file->n_hash_items == 0)
     return NULL;
 
@@ -585,6 +702,7 @@ gvdb_table_get_table (GvdbTable   *file,
   new->unref_user_data = file->unref_user_data;
   new->byteswapped = file->byteswapped;
   new->trusted = file->trusted;
+  new->version = file->version;
   new->data = file->data;
   new->size = file->size;
   new->ref_count = 1;
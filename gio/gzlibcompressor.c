@@ -37,9 +37,20 @@ enum {
   PROP_0,
   PROP_FORMAT,
   PROP_LEVEL,
-  PROP_FILE_INFO
+  PROP_FILE_INFO,
+  PROP_THREADS,
+  PROP_DICTIONARY
 };
 
+/* Input is cut into blocks of this size when compressing on several
+ * threads; this is the same trade-off between per-block overhead and
+ * parallelism that pigz makes.
+ */
+#define BLOCK_SIZE (128 * 1024)
+
+/* The most history deflate can refer back to */
+#define DICT_SIZE 32768
+
 /**
  * SECTION:gzcompressor
  * @short_description: Zlib compressor
@@ -47,8 +58,28 @@ enum {
  *
  * #GZlibCompressor is an implementation of #GConverter that
  * compresses data using zlib.
+ *
+ * If #GZlibCompressor:threads is greater than one, the input is split
+ * into blocks that are deflated concurrently on a thread pool and
+ * stitched back together in order, the way pigz does it. Each block is
+ * primed with the end of the previous one as its dictionary and
+ * terminated with a sync flush, so the result is still a single
+ * ordinary zlib, gzip or raw deflate stream that any decompressor,
+ * including #GZlibDecompressor, reads back unchanged.
  */
 
+typedef struct
+{
+  GBytes *input;
+  GBytes *dict;
+  gboolean last;
+
+  /* filled in by the worker */
+  GByteArray *output;
+  uLong check;
+  gboolean done;
+} Block;
+
 static void g_zlib_compressor_iface_init          (GConverterIface *iface);
 
 /**
@@ -65,6 +96,23 @@ struct _GZlibCompressor
   z_stream zstream;
   gz_header gzheader;
   GFileInfo *file_info;
+  GBytes *dictionary;
+
+  /* threaded mode only */
+  guint threads;
+  GThreadPool *pool;
+  GMutex lock;
+  GCond cond;
+  GQueue blocks;          /* Block *, in stream order */
+  GByteArray *pending;    /* input not yet handed to a block */
+  GBytes *prev_input;     /* source of the next block's dictionary */
+  GByteArray *out;        /* output being handed to the caller */
+  gsize out_pos;
+  uLong check;
+  guint64 total_in;
+  gboolean header_done;
+  gboolean last_queued;
+  gboolean trailer_done;
 };
 
 static void
@@ -78,6 +126,10 @@ g_zlib_compressor_set_gzheader (GZlibCompressor *compressor)
       compressor->file_info == NULL)
     return;
 
+  /* the threaded path writes its own header */
+  if (compressor->pool != NULL)
+    return;
+
   memset (&compressor->gzheader, 0, sizeof (gz_header));
   compressor->gzheader.os = 0x03; /* Unix */
 
@@ -94,10 +146,116 @@ g_zlib_compressor_set_gzheader (GZlibCompressor *compressor)
 #endif /* !G_OS_WIN32 || ZLIB >= 1.2.4 */
 }
 
+static void
+g_zlib_compressor_set_dictionary (GZlibCompressor *compressor)
+{
+  const guint8 *dict;
+  gsize dict_size;
+
+  if (compressor->dictionary == NULL || compressor->pool != NULL)
+    return;
+
+  dict = g_bytes_get_data (compressor->dictionary, &dict_size);
+  if (deflateSetDictionary (&compressor->zstream, dict, dict_size) != Z_OK)
+    g_warning ("unexpected zlib error: %s\n", compressor->zstream.msg);
+}
+
 G_DEFINE_TYPE_WITH_CODE (GZlibCompressor, g_zlib_compressor, G_TYPE_OBJECT,
 			 G_IMPLEMENT_INTERFACE (G_TYPE_CONVERTER,
 						g_zlib_compressor_iface_init))
 
+static void
+block_free (Block *block)
+{
+  g_bytes_unref (block->input);
+  if (block->dict)
+    g_bytes_unref (block->dict);
+  if (block->output)
+    g_byte_array_unref (block->output);
+  g_slice_free (Block, block);
+}
+
+/* Runs on the thread pool: deflates one block on its own z_stream */
+static void
+compress_block (gpointer data,
+                gpointer user_data)
+{
+  Block *block = data;
+  GZlibCompressor *compressor = user_data;
+  z_stream zstream;
+  GByteArray *output;
+  const guint8 *input;
+  gsize input_size;
+  gsize used;
+  uLong check;
+  int flush;
+  int res;
+
+  memset (&zstream, 0, sizeof zstream);
+  res = deflateInit2 (&zstream,
+                      compressor->level, Z_DEFLATED,
+                      -MAX_WBITS, 8,
+                      Z_DEFAULT_STRATEGY);
+  if (res == Z_MEM_ERROR)
+    g_error ("GZlibCompressor: Not enough memory for zlib use");
+
+  if (block->dict != NULL)
+    {
+      const guint8 *dict;
+      gsize dict_size;
+
+      dict = g_bytes_get_data (block->dict, &dict_size);
+      deflateSetDictionary (&zstream, dict, dict_size);
+    }
+
+  input = g_bytes_get_data (block->input, &input_size);
+  zstream.next_in = (Bytef *) input;
+  zstream.avail_in = input_size;
+
+  output = g_byte_array_new ();
+  g_byte_array_set_size (output, deflateBound (&zstream, input_size) + 16);
+  zstream.next_out = output->data;
+  zstream.avail_out = output->len;
+
+  /* A sync flush ends the block on a byte boundary without marking it
+   * final, so the next block's output can simply be appended
+   */
+  flush = block->last ? Z_FINISH : Z_SYNC_FLUSH;
+
+  while (TRUE)
+    {
+      res = deflate (&zstream, flush);
+      if (res == Z_STREAM_END ||
+          (flush == Z_SYNC_FLUSH && zstream.avail_out != 0))
+        break;
+
+      if (res != Z_OK && res != Z_BUF_ERROR)
+        g_error ("GZlibCompressor: unexpected zlib error: %s", zstream.msg);
+
+      used = zstream.next_out - output->data;
+      g_byte_array_set_size (output, output->len * 2);
+      zstream.next_out = output->data + used;
+      zstream.avail_out = output->len - used;
+    }
+
+  g_byte_array_set_size (output, zstream.next_out - output->data);
+  deflateEnd (&zstream);
+
+  if (compressor->format == G_ZLIB_COMPRESSOR_FORMAT_GZIP)
+    check = crc32 (0L, input, input_size);
+  else if (compressor->format == G_ZLIB_COMPRESSOR_FORMAT_ZLIB)
+    check = adler32 (1L, input, input_size);
+  else
+    check = 0;
+
+  g_mutex_lock (&compressor->lock);
+  block->output = output;
+  block->check = check;
+  block->done = TRUE;
+  g_cond_broadcast (&compressor->cond);
+  g_mutex_unlock (&compressor->lock);
+}
+
 static void
 g_zlib_compressor_finalize (GObject *object)
 {
@@ -105,11 +263,28 @@ g_zlib_compressor_finalize (GObject *object)
 
   compressor = G_ZLIB_COMPRESSOR (object);
 
-  deflateEnd (&compressor->zstream);
+  if (compressor->pool != NULL)
+    {
+      g_thread_pool_free (compressor->pool, FALSE, TRUE);
+      g_queue_foreach (&compressor->blocks, (GFunc) block_free, NULL);
+      g_queue_clear (&compressor->blocks);
+      g_byte_array_unref (compressor->pending);
+      g_byte_array_unref (compressor->out);
+      if (compressor->prev_input)
+        g_bytes_unref (compressor->prev_input);
+    }
+  else
+    deflateEnd (&compressor->zstream);
+
+  g_mutex_clear (&compressor->lock);
+  g_cond_clear (&compressor->cond);
 
   if (compressor->file_info)
     g_object_unref (compressor->file_info);
 
+  if (compressor->dictionary)
+    g_bytes_unref (compressor->dictionary);
+
   G_OBJECT_CLASS (g_zlib_compressor_parent_class)->finalize (object);
 }
 
@@ -138,6 +313,14 @@ g_zlib_compressor_set_property (GObject      *object,
       g_zlib_compressor_set_file_info (compressor, g_value_get_object (value));
       break;
 
+    case PROP_THREADS:
+      compressor->threads = g_value_get_uint (value);
+      break;
+
+    case PROP_DICTIONARY:
+      compressor->dictionary = g_value_dup_boxed (value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -169,6 +352,14 @@ g_zlib_compressor_get_property (GObject    *object,
       g_value_set_object (value, compressor->file_info);
       break;
 
+    case PROP_THREADS:
+      g_value_set_uint (value, compressor->threads);
+      break;
+
+    case PROP_DICTIONARY:
+      g_value_set_boxed (value, compressor->dictionary);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -178,6 +369,29 @@ g_zlib_compressor_get_property (GObject    *object,
 static void
 g_zlib_compressor_init (GZlibCompressor *compressor)
 {
+  g_mutex_init (&compressor->lock);
+  g_cond_init (&compressor->cond);
+}
+
+static void
+g_zlib_compressor_reset_threaded (GZlibCompressor *compressor)
+{
+  compressor->check = 0;
+  if (compressor->format == G_ZLIB_COMPRESSOR_FORMAT_GZIP)
+    compressor->check = crc32 (0L, Z_NULL, 0);
+  else if (compressor->format == G_ZLIB_COMPRESSOR_FORMAT_ZLIB)
+    compressor->check = adler32 (0L, Z_NULL, 0);
+
+  g_byte_array_set_size (compressor->pending, 0);
+  g_byte_array_set_size (compressor->out, 0);
+  compressor->out_pos = 0;
+  g_clear_pointer (&compressor->prev_input, g_bytes_unref);
+  if (compressor->dictionary)
+    compressor->prev_input = g_bytes_ref (compressor->dictionary);
+  compressor->total_in = 0;
+  compressor->header_done = FALSE;
+  compressor->last_queued = FALSE;
+  compressor->trailer_done = FALSE;
 }
 
 static void
@@ -188,6 +402,28 @@ g_zlib_compressor_constructed (GObject *object)
 
   compressor = G_ZLIB_COMPRESSOR (object);
 
+  /* The gzip header has no way to say which dictionary was used */
+  if (compressor->dictionary != NULL &&
+      compressor->format == G_ZLIB_COMPRESSOR_FORMAT_GZIP)
+    {
+      g_warning ("GZlibCompressor: a dictionary can't be used with the gzip format");
+      g_clear_pointer (&compressor->dictionary, g_bytes_unref);
+    }
+
+  if (compressor->threads == 0)
+    compressor->threads = g_get_num_processors ();
+
+  if (compressor->threads > 1)
+    {
+      compressor->pool = g_thread_pool_new (compress_block, compressor,
+                                            compressor->threads, FALSE, NULL);
+      g_queue_init (&compressor->blocks);
+      compressor->pending = g_byte_array_sized_new (BLOCK_SIZE);
+      compressor->out = g_byte_array_new ();
+      g_zlib_compressor_reset_threaded (compressor);
+      return;
+    }
+
   if (compressor->format == G_ZLIB_COMPRESSOR_FORMAT_GZIP)
     {
       /* + 16 for gzip */
@@ -214,6 +450,7 @@ g_zlib_compressor_constructed (GObject *object)
     g_warning ("unexpected zlib error: %s\n", compressor->zstream.msg);
 
   g_zlib_compressor_set_gzheader (compressor);
+  g_zlib_compressor_set_dictionary (compressor);
 }
 
 static void
@@ -263,6 +500,51 @@ g_zlib_compressor_class_init (GZlibCompressorClass *klass)
                                                        G_TYPE_FILE_INFO,
                                                        G_PARAM_READWRITE |
                                                        G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GZlibCompressor:threads:
+   *
+   * The number of threads to compress on. With the default of 1 all
+   * compression happens in g_converter_convert(); with more, blocks of
+   * input are deflated concurrently on a thread pool, at the cost of
+   * slightly larger output. 0 uses one thread per processor.
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_THREADS,
+                                   g_param_spec_uint ("threads",
+                                                      P_("threads"),
+                                                      P_("Number of threads to compress on"),
+                                                      0, G_MAXUINT, 1,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_CONSTRUCT_ONLY |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GZlibCompressor:dictionary:
+   *
+   * A preset dictionary: data that is likely to occur in the input,
+   * which small messages can then refer back to instead of spelling
+   * out. The same dictionary must be given to the #GZlibDecompressor
+   * reading the data. Only the last 32 KiB of it are used.
+   *
+   * This is supported for %G_ZLIB_COMPRESSOR_FORMAT_ZLIB, which records
+   * a checksum of the dictionary in its header, and
+   * %G_ZLIB_COMPRESSOR_FORMAT_RAW, but not for
+   * %G_ZLIB_COMPRESSOR_FORMAT_GZIP.
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_DICTIONARY,
+                                   g_param_spec_boxed ("dictionary",
+                                                       P_("dictionary"),
+                                                       P_("Preset dictionary"),
+                                                       G_TYPE_BYTES,
+                                                       G_PARAM_READWRITE |
+                                                       G_PARAM_CONSTRUCT_ONLY |
+                                                       G_PARAM_STATIC_STRINGS));
 }
 
 /**
@@ -349,12 +631,347 @@ g_zlib_compressor_reset (GConverter *converter)
   GZlibCompressor *compressor = G_ZLIB_COMPRESSOR (converter);
   int res;
 
+  if (compressor->pool != NULL)
+    {
+      /* let the workers finish what they were given, then drop it */
+      while (!g_queue_is_empty (&compressor->blocks))
+        {
+          Block *block = g_queue_pop_head (&compressor->blocks);
+
+          g_mutex_lock (&compressor->lock);
+          while (!block->done)
+            g_cond_wait (&compressor->cond, &compressor->lock);
+          g_mutex_unlock (&compressor->lock);
+
+          block_free (block);
+        }
+
+      g_zlib_compressor_reset_threaded (compressor);
+      return;
+    }
+
   res = deflateReset (&compressor->zstream);
   if (res != Z_OK)
     g_warning ("unexpected zlib error: %s\n", compressor->zstream.msg);
 
-  /* deflateReset reset the header too, so re-set it */
+  /* deflateReset reset the header and dictionary too, so re-set them */
   g_zlib_compressor_set_gzheader (compressor);
+  g_zlib_compressor_set_dictionary (compressor);
+}
+
+static void
+write_header (GZlibCompressor *compressor,
+              GByteArray      *out)
+{
+  guint8 header[10];
+  const gchar *name = NULL;
+  guint32 mtime = 0;
+  guint16 check;
+  guint level_flags;
+
+  if (compressor->format == G_ZLIB_COMPRESSOR_FORMAT_GZIP)
+    {
+      if (compressor->file_info != NULL)
+        {
+          name = g_file_info_get_name (compressor->file_info);
+          mtime = g_file_info_get_attribute_uint64 (compressor->file_info,
+                                                    G_FILE_ATTRIBUTE_TIME_MODIFIED);
+        }
+
+      /* the same fields deflate() would write, see RFC 1952 */
+      header[0] = 0x1f;
+      header[1] = 0x8b;
+      header[2] = Z_DEFLATED;
+      header[3] = name != NULL ? 0x08 : 0; /* FNAME */
+      header[4] = mtime & 0xff;
+      header[5] = (mtime >> 8) & 0xff;
+      header[6] = (mtime >> 16) & 0xff;
+      header[7] = (mtime >> 24) & 0xff;
+      header[8] = compressor->level == 9 ? 2 :
+                  (compressor->level == 0 || compressor->level == 1) ? 4 : 0;
+      header[9] = 0x03; /* Unix */
+      g_byte_array_append (out, header, 10);
+
+      if (name != NULL)
+        g_byte_array_append (out, (const guint8 *) name, strlen (name) + 1);
+    }
+  else if (compressor->format == G_ZLIB_COMPRESSOR_FORMAT_ZLIB)
+    {
+      /* see RFC 1950 */
+      if (compressor->level == 0 || compressor->level == 1)
+        level_flags = 0;
+      else if (compressor->level > 1 && compressor->level < 6)
+        level_flags = 1;
+      else if (compressor->level == 6 || compressor->level == -1)
+        level_flags = 2;
+      else
+        level_flags = 3;
+
+      check = (0x78 << 8) | (level_flags << 6);
+      if (compressor->dictionary != NULL)
+        check |= 0x20; /* FDICT */
+      check += 31 - check % 31;
+
+      header[0] = check >> 8;
+      header[1] = check & 0xff;
+      g_byte_array_append (out, header, 2);
+
+      if (compressor->dictionary != NULL)
+        {
+          const guint8 *dict;
+          gsize dict_size;
+          uLong dict_id;
+
+          dict = g_bytes_get_data (compressor->dictionary, &dict_size);
+          dict_id = adler32 (adler32 (0L, Z_NULL, 0), dict, dict_size);
+
+          header[0] = (dict_id >> 24) & 0xff;
+          header[1] = (dict_id >> 16) & 0xff;
+          header[2] = (dict_id >> 8) & 0xff;
+          header[3] = dict_id & 0xff;
+          g_byte_array_append (out, header, 4);
+        }
+    }
+}
+
+static void
+write_trailer (GZlibCompressor *compressor,
+               GByteArray      *out)
+{
+  guint8 trailer[8];
+  guint32 check = compressor->check;
+  guint32 size = compressor->total_in & 0xffffffff;
+
+  if (compressor->format == G_ZLIB_COMPRESSOR_FORMAT_GZIP)
+    {
+      trailer[0] = check & 0xff;
+      trailer[1] = (check >> 8) & 0xff;
+      trailer[2] = (check >> 16) & 0xff;
+      trailer[3] = (check >> 24) & 0xff;
+      trailer[4] = size & 0xff;
+      trailer[5] = (size >> 8) & 0xff;
+      trailer[6] = (size >> 16) & 0xff;
+      trailer[7] = (size >> 24) & 0xff;
+      g_byte_array_append (out, trailer, 8);
+    }
+  else if (compressor->format == G_ZLIB_COMPRESSOR_FORMAT_ZLIB)
+    {
+      trailer[0] = (check >> 24) & 0xff;
+      trailer[1] = (check >> 16) & 0xff;
+      trailer[2] = (check >> 8) & 0xff;
+      trailer[3] = check & 0xff;
+      g_byte_array_append (out, trailer, 4);
+    }
+}
+
+/* Hands the pending input to the thread pool as the next block */
+static void
+queue_block (GZlibCompressor *compressor,
+             gboolean         last)
+{
+  Block *block;
+  gsize size;
+
+  block = g_slice_new0 (Block);
+  block->input = g_byte_array_free_to_bytes (compressor->pending);
+  block->last = last;
+  compressor->pending = g_byte_array_sized_new (BLOCK_SIZE);
+
+  /* Priming each block with the tail of the previous one keeps the
+   * ratio close to that of a single deflate stream
+   */
+  if (compressor->prev_input != NULL)
+    {
+      size = g_bytes_get_size (compressor->prev_input);
+      if (size > DICT_SIZE)
+        block->dict = g_bytes_new_from_bytes (compressor->prev_input,
+                                              size - DICT_SIZE, DICT_SIZE);
+      else
+        block->dict = g_bytes_ref (compressor->prev_input);
+      g_bytes_unref (compressor->prev_input);
+    }
+  compressor->prev_input = g_bytes_ref (block->input);
+  compressor->total_in += g_bytes_get_size (block->input);
+
+  g_queue_push_tail (&compressor->blocks, block);
+  g_thread_pool_push (compressor->pool, block, NULL);
+}
+
+static void
+wait_for_oldest_block (GZlibCompressor *compressor)
+{
+  Block *block = g_queue_peek_head (&compressor->blocks);
+
+  g_mutex_lock (&compressor->lock);
+  while (!block->done)
+    g_cond_wait (&compressor->cond, &compressor->lock);
+  g_mutex_unlock (&compressor->lock);
+}
+
+/* Copies out everything that is ready, in stream order, without
+ * waiting for blocks that are still being compressed
+ */
+static gsize
+drain_output (GZlibCompressor *compressor,
+              guint8          *outbuf,
+              gsize            outbuf_size)
+{
+  gsize written = 0;
+  Block *block;
+  gboolean done;
+  gsize n;
+
+  while (written < outbuf_size)
+    {
+      if (compressor->out_pos < compressor->out->len)
+        {
+          n = MIN (outbuf_size - written, compressor->out->len - compressor->out_pos);
+          memcpy (outbuf + written, compressor->out->data + compressor->out_pos, n);
+          compressor->out_pos += n;
+          written += n;
+          continue;
+        }
+
+      g_byte_array_set_size (compressor->out, 0);
+      compressor->out_pos = 0;
+
+      if (!compressor->header_done)
+        {
+          write_header (compressor, compressor->out);
+          compressor->header_done = TRUE;
+          continue;
+        }
+
+      block = g_queue_peek_head (&compressor->blocks);
+      if (block != NULL)
+        {
+          g_mutex_lock (&compressor->lock);
+          done = block->done;
+          g_mutex_unlock (&compressor->lock);
+
+          if (!done)
+            break;
+
+          g_queue_pop_head (&compressor->blocks);
+
+          if (compressor->format == G_ZLIB_COMPRESSOR_FORMAT_GZIP)
+            compressor->check = crc32_combine (compressor->check, block->check,
+                                               g_bytes_get_size (block->input));
+          else if (compressor->format == G_ZLIB_COMPRESSOR_FORMAT_ZLIB)
+            compressor->check = adler32_combine (compressor->check, block->check,
+                                                 g_bytes_get_size (block->input));
+
+          g_byte_array_unref (compressor->out);
+          compressor->out = block->output;
+          block->output = NULL;
+          block_free (block);
+          continue;
+        }
+
+      if (compressor->last_queued && !compressor->trailer_done)
+        {
+          write_trailer (compressor, compressor->out);
+          compressor->trailer_done = TRUE;
+          continue;
+        }
+
+      break;
+    }
+
+  return written;
+}
+
+static GConverterResult
+g_zlib_compressor_convert_threaded (GZlibCompressor *compressor,
+                                    const guint8    *inbuf,
+                                    gsize            inbuf_size,
+                                    guint8          *outbuf,
+                                    gsize            outbuf_size,
+                                    GConverterFlags  flags,
+                                    gsize           *bytes_read,
+                                    gsize           *bytes_written,
+                                    GError         **error)
+{
+  gsize read = 0;
+  gsize written = 0;
+  gsize n;
+
+  while (TRUE)
+    {
+      written += drain_output (compressor, outbuf + written, outbuf_size - written);
+      if (written == outbuf_size)
+        break;
+
+      if (read < inbuf_size)
+        {
+          /* Bound the memory held by blocks in flight */
+          if (g_queue_get_length (&compressor->blocks) >= 2 * compressor->threads)
+            {
+              wait_for_oldest_block (compressor);
+              continue;
+            }
+
+          n = MIN (inbuf_size - read, BLOCK_SIZE - compressor->pending->len);
+          g_byte_array_append (compressor->pending, inbuf + read, n);
+          read += n;
+
+          if (compressor->pending->len == BLOCK_SIZE)
+            queue_block (compressor, FALSE);
+          continue;
+        }
+
+      if (flags & G_CONVERTER_INPUT_AT_END)
+        {
+          if (!compressor->last_queued)
+            {
+              queue_block (compressor, TRUE);
+              compressor->last_queued = TRUE;
+              continue;
+            }
+
+          if (g_queue_is_empty (&compressor->blocks))
+            {
+              *bytes_read = read;
+              *bytes_written = written;
+              return G_CONVERTER_FINISHED;
+            }
+
+          wait_for_oldest_block (compressor);
+          continue;
+        }
+
+      if (flags & G_CONVERTER_FLUSH)
+        {
+          if (compressor->pending->len > 0)
+            {
+              queue_block (compressor, FALSE);
+              continue;
+            }
+
+          if (g_queue_is_empty (&compressor->blocks))
+            {
+              *bytes_read = read;
+              *bytes_written = written;
+              return G_CONVERTER_FLUSHED;
+            }
+
+          wait_for_oldest_block (compressor);
+          continue;
+        }
+
+      break;
+    }
+
+  if (read == 0 && written == 0)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT,
+                           _("Need more input"));
+      return G_CONVERTER_ERROR;
+    }
+
+  *bytes_read = read;
+  *bytes_written = written;
+  return G_CONVERTER_CONVERTED;
 }
 
 static GConverterResult
@@ -374,6 +991,11 @@ g_zlib_compressor_convert (GConverter *converter,
 
   compressor = G_ZLIB_COMPRESSOR (converter);
 
+  if (compressor->pool != NULL)
+    return g_zlib_compressor_convert_threaded (compressor, inbuf, inbuf_size,
+                                               outbuf, outbuf_size, flags,
+                                               bytes_read, bytes_written, error);
+
   compressor->zstream.next_in = (void *)inbuf;
   compressor->zstream.avail_in = inbuf_size;
 
@@ -36,7 +36,8 @@
 enum {
   PROP_0,
   PROP_FORMAT,
-  PROP_FILE_INFO
+  PROP_FILE_INFO,
+  PROP_DICTIONARY
 };
 
 /**
@@ -68,6 +69,7 @@ struct _GZlibDecompressor
   GZlibCompressorFormat format;
   z_stream zstream;
   HeaderData *header_data;
+  GBytes *dictionary;
 };
 
 static void
@@ -99,6 +101,20 @@ g_zlib_decompressor_set_gzheader (GZlibDecompressor *decompressor)
 #endif /* !G_OS_WIN32 || ZLIB >= 1.2.4 */
 }
 
+/* Raw deflate streams don't ask for their dictionary, so it has to be
+ * set up front; zlib streams get it when inflate() reports Z_NEED_DICT.
+ */
+static int
+g_zlib_decompressor_set_dictionary (GZlibDecompressor *decompressor)
+{
+  const guint8 *dict;
+  gsize dict_size;
+
+  dict = g_bytes_get_data (decompressor->dictionary, &dict_size);
+
+  return inflateSetDictionary (&decompressor->zstream, dict, dict_size);
+}
+
 G_DEFINE_TYPE_WITH_CODE (GZlibDecompressor, g_zlib_decompressor, G_TYPE_OBJECT,
 			 G_IMPLEMENT_INTERFACE (G_TYPE_CONVERTER,
 						g_zlib_decompressor_iface_init))
@@ -119,6 +135,9 @@ g_zlib_decompressor_finalize (GObject *object)
       g_free (decompressor->header_data);
     }
 
+  if (decompressor->dictionary)
+    g_bytes_unref (decompressor->dictionary);
+
   G_OBJECT_CLASS (g_zlib_decompressor_parent_class)->finalize (object);
 }
 
@@ -139,6 +158,10 @@ g_zlib_decompressor_set_property (GObject      *object,
       decompressor->format = g_value_get_enum (value);
       break;
 
+    case PROP_DICTIONARY:
+      decompressor->dictionary = g_value_dup_boxed (value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -169,6 +192,10 @@ g_zlib_decompressor_get_property (GObject    *object,
         g_value_set_object (value, NULL);
       break;
 
+    case PROP_DICTIONARY:
+      g_value_set_boxed (value, decompressor->dictionary);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -208,6 +235,10 @@ g_zlib_decompressor_constructed (GObject *object)
     g_warning ("unexpected zlib error: %s\n", decompressor->zstream.msg);
 
   g_zlib_decompressor_set_gzheader (decompressor);
+
+  if (decompressor->dictionary != NULL &&
+      decompressor->format == G_ZLIB_COMPRESSOR_FORMAT_RAW)
+    g_zlib_decompressor_set_dictionary (decompressor);
 }
 
 static void
@@ -248,6 +279,27 @@ g_zlib_decompressor_class_init (GZlibDecompressorClass *klass)
                                                        G_TYPE_FILE_INFO,
                                                        G_PARAM_READABLE |
                                                        G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GZlibDecompressor:dictionary:
+   *
+   * The preset dictionary the data was compressed with, see
+   * #GZlibCompressor:dictionary. Data in the
+   * %G_ZLIB_COMPRESSOR_FORMAT_ZLIB format that needs a dictionary
+   * fails to decompress with %G_IO_ERROR_INVALID_DATA unless this is
+   * set to the right one.
+   *
+   * Since: 2.54
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_DICTIONARY,
+                                   g_param_spec_boxed ("dictionary",
+                                                       P_("dictionary"),
+                                                       P_("Preset dictionary"),
+                                                       G_TYPE_BYTES,
+                                                       G_PARAM_READWRITE |
+                                                       G_PARAM_CONSTRUCT_ONLY |
+                                                       G_PARAM_STATIC_STRINGS));
 }
 
 /**
@@ -308,6 +360,10 @@ g_zlib_decompressor_reset (GConverter *converter)
     g_warning ("unexpected zlib error: %s\n", decompressor->zstream.msg);
 
   g_zlib_decompressor_set_gzheader (decompressor);
+
+  if (decompressor->dictionary != NULL &&
+      decompressor->format == G_ZLIB_COMPRESSOR_FORMAT_RAW)
+    g_zlib_decompressor_set_dictionary (decompressor);
 }
 
 static GConverterResult
@@ -334,6 +390,17 @@ g_zlib_decompressor_convert (GConverter *converter,
 
   res = inflate (&decompressor->zstream, Z_NO_FLUSH);
 
+  /* Carry on from where the header ended, once we have the dictionary */
+  if (res == Z_NEED_DICT && decompressor->dictionary != NULL &&
+      g_zlib_decompressor_set_dictionary (decompressor) == Z_OK)
+    {
+      res = inflate (&decompressor->zstream, Z_NO_FLUSH);
+
+      /* The header was consumed, so that is progress in itself */
+      if (res == Z_BUF_ERROR)
+        res = Z_OK;
+    }
+
   if (res == Z_DATA_ERROR || res == Z_NEED_DICT)
     {
       g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
@@ -305,19 +305,26 @@ ik_source_dispatch (GSource     *source,
         g_free (buffer);
     }
 
-  while (ik_source_can_dispatch_now (iks, now))
+  /* Take the lock once for the whole batch rather than per event: the
+   * callbacks only queue the events on their GFileMonitorSource, which
+   * then delivers everything that arrived in a single dispatch.
+   */
+  if (ik_source_can_dispatch_now (iks, now))
     {
-      ik_event_t *event;
+      G_LOCK (inotify_lock);
 
-      /* callback will free the event */
-      event = g_queue_pop_head (&iks->queue);
+      while (ik_source_can_dispatch_now (iks, now))
+        {
+          ik_event_t *event;
 
-      if (event->mask & IN_MOVED_FROM && !event->pair)
-        g_hash_table_remove (iks->unmatched_moves, GUINT_TO_POINTER (event->cookie));
+          /* callback will free the event */
+          event = g_queue_pop_head (&iks->queue);
 
-      G_LOCK (inotify_lock);
+          if (event->mask & IN_MOVED_FROM && !event->pair)
+            g_hash_table_remove (iks->unmatched_moves, GUINT_TO_POINTER (event->cookie));
 
-      interesting |= (* user_callback) (event);
+          interesting |= (* user_callback) (event);
+        }
 
       G_UNLOCK (inotify_lock);
     }
@@ -412,6 +412,49 @@ test_skip_async (void)
   g_object_unref (base);
 }
 
+static void
+test_adaptive (void)
+{
+  GInputStream *base;
+  GInputStream *in;
+  GError *error = NULL;
+  gchar *data, *copy;
+  gsize size, total, rest;
+  gssize n;
+  gint i;
+
+  size = 1024 * 1024;
+  data = g_malloc (size);
+  for (i = 0; i < size; i++)
+    data[i] = i % 251;
+  copy = g_malloc (size);
+
+  base = g_memory_input_stream_new_from_data (data, size, g_free);
+  in = g_buffered_input_stream_new_sized (base, 64);
+  g_buffered_input_stream_set_adaptive (G_BUFFERED_INPUT_STREAM (in), TRUE);
+  g_assert (g_buffered_input_stream_get_adaptive (G_BUFFERED_INPUT_STREAM (in)));
+
+  /* A base stream that always has data lets the buffer grow */
+  for (total = 0; total < size / 2; total += n)
+    {
+      n = g_input_stream_read (in, copy + total, 50, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (n, >, 0);
+    }
+  g_assert_cmpuint (g_buffered_input_stream_get_buffer_size (G_BUFFERED_INPUT_STREAM (in)), >, 64);
+  g_assert_cmpuint (g_buffered_input_stream_get_buffer_size (G_BUFFERED_INPUT_STREAM (in)), <=, 1024 * 1024);
+
+  /* The rest in one read larger than the buffer */
+  g_assert (g_input_stream_read_all (in, copy + total, size - total, &rest, NULL, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (total + rest, ==, size);
+  g_assert (memcmp (copy, data, size) == 0);
+
+  g_object_unref (in);
+  g_object_unref (base);
+  g_free (copy);
+}
+
 static void
 test_close (void)
 {
@@ -547,6 +590,7 @@ main (int   argc,
   g_test_add_func ("/buffered-input-stream/skip", test_skip);
   g_test_add_func ("/buffered-input-stream/skip-async", test_skip_async);
   g_test_add_func ("/buffered-input-stream/seek", test_seek);
+  g_test_add_func ("/buffered-input-stream/adaptive", test_adaptive);
   g_test_add_func ("/filter-input-stream/close", test_close);
 
   return g_test_run();
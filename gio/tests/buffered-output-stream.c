@@ -1,4 +1,5 @@
 #include <gio/gio.h>
+#include <string.h>
 
 static void
 test_write (void)
@@ -83,6 +84,45 @@ test_grow (void)
   g_object_unref (base);
 }
 
+static void
+test_adaptive (void)
+{
+  GOutputStream *base;
+  GOutputStream *out;
+  GError *error = NULL;
+  gchar *data;
+  gsize written, total;
+  gint i;
+
+  data = g_malloc (100000);
+  for (i = 0; i < 100000; i++)
+    data[i] = i % 251;
+
+  base = g_memory_output_stream_new_resizable ();
+  out = g_buffered_output_stream_new_sized (base, 16);
+
+  g_object_set (out, "adaptive", TRUE, NULL);
+  g_assert (g_buffered_output_stream_get_adaptive (G_BUFFERED_OUTPUT_STREAM (out)));
+
+  /* Writes that keep filling the buffer make it grow */
+  for (total = 0; total < 1000; total += 10)
+    {
+      g_assert (g_output_stream_write_all (out, data + total, 10, &written, NULL, &error));
+      g_assert_no_error (error);
+    }
+  g_assert_cmpuint (g_buffered_output_stream_get_buffer_size (G_BUFFERED_OUTPUT_STREAM (out)), >, 16);
+
+  /* Large writes go straight through, after what was buffered */
+  g_assert (g_output_stream_write_all (out, data + total, 100000 - total, &written, NULL, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (base)), ==, 100000);
+  g_assert (memcmp (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (base)), data, 100000) == 0);
+
+  g_object_unref (out);
+  g_object_unref (base);
+  g_free (data);
+}
+
 static void
 test_close (void)
 {
@@ -321,6 +361,7 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/buffered-output-stream/write", test_write);
   g_test_add_func ("/buffered-output-stream/grow", test_grow);
+  g_test_add_func ("/buffered-output-stream/adaptive", test_adaptive);
   g_test_add_func ("/buffered-output-stream/seek", test_seek);
   g_test_add_func ("/buffered-output-stream/truncate", test_truncate);
   g_test_add_func ("/filter-output-stream/close", test_close);
@@ -0,0 +1,292 @@
+/* GLib testing framework examples and tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <gio/gio.h>
+
+/* A proxy resolver that sends everything through a proxy named after
+ * the destination's scheme, and counts its lookups.
+ */
+typedef struct {
+  GObject parent_instance;
+  guint n_lookups;
+} MockProxyResolver;
+
+typedef GObjectClass MockProxyResolverClass;
+
+static void mock_proxy_resolver_iface_init (GProxyResolverInterface *iface);
+
+static GType mock_proxy_resolver_get_type (void);
+G_DEFINE_TYPE_WITH_CODE (MockProxyResolver, mock_proxy_resolver, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_PROXY_RESOLVER,
+                                                mock_proxy_resolver_iface_init))
+
+static gchar **
+mock_proxy_resolver_lookup (GProxyResolver  *resolver,
+                            const gchar     *uri,
+                            GCancellable    *cancellable,
+                            GError         **error)
+{
+  MockProxyResolver *self = (MockProxyResolver *) resolver;
+  gchar **proxies;
+  gchar *scheme;
+
+  self->n_lookups++;
+
+  if (strstr (uri, "flaky") != NULL)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Could not look up the proxy for “%s”", uri);
+      return NULL;
+    }
+
+  scheme = g_uri_parse_scheme (uri);
+  proxies = g_new0 (gchar *, 2);
+  proxies[0] = g_strdup_printf ("socks://%s-proxy.example.com:1080", scheme);
+  g_free (scheme);
+
+  return proxies;
+}
+
+static void
+mock_proxy_resolver_lookup_async (GProxyResolver      *resolver,
+                                  const gchar         *uri,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+  GTask *task;
+  gchar **proxies;
+  GError *error = NULL;
+
+  task = g_task_new (resolver, cancellable, callback, user_data);
+  proxies = mock_proxy_resolver_lookup (resolver, uri, cancellable, &error);
+  if (proxies != NULL)
+    g_task_return_pointer (task, proxies, (GDestroyNotify) g_strfreev);
+  else
+    g_task_return_error (task, error);
+  g_object_unref (task);
+}
+
+static gchar **
+mock_proxy_resolver_lookup_finish (GProxyResolver  *resolver,
+                                   GAsyncResult    *result,
+                                   GError         **error)
+{
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static void
+mock_proxy_resolver_init (MockProxyResolver *self)
+{
+}
+
+static void
+mock_proxy_resolver_class_init (MockProxyResolverClass *klass)
+{
+}
+
+static void
+mock_proxy_resolver_iface_init (GProxyResolverInterface *iface)
+{
+  iface->lookup = mock_proxy_resolver_lookup;
+  iface->lookup_async = mock_proxy_resolver_lookup_async;
+  iface->lookup_finish = mock_proxy_resolver_lookup_finish;
+}
+
+static void
+assert_proxy (GProxyResolver *resolver,
+              const gchar    *uri,
+              const gchar    *expected)
+{
+  gchar **proxies;
+  GError *error = NULL;
+
+  proxies = g_proxy_resolver_lookup (resolver, uri, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_strv_length (proxies), ==, 1);
+  g_assert_cmpstr (proxies[0], ==, expected);
+  g_strfreev (proxies);
+}
+
+static void
+test_sync (void)
+{
+  MockProxyResolver *mock;
+  GProxyResolver *resolver;
+
+  mock = g_object_new (mock_proxy_resolver_get_type (), NULL);
+  resolver = g_proxy_resolver_new_caching (G_PROXY_RESOLVER (mock), 0, 0);
+
+  assert_proxy (resolver, "http://www.example.com:80", "socks://http-proxy.example.com:1080");
+  assert_proxy (resolver, "http://www.example.com:80", "socks://http-proxy.example.com:1080");
+  assert_proxy (resolver, "HTTP://WWW.Example.COM:80/some/path", "socks://http-proxy.example.com:1080");
+  g_assert_cmpuint (mock->n_lookups, ==, 1);
+
+  /* Different schemes, hosts and ports are looked up separately */
+  assert_proxy (resolver, "https://www.example.com:80", "socks://https-proxy.example.com:1080");
+  g_assert_cmpuint (mock->n_lookups, ==, 2);
+  assert_proxy (resolver, "http://mail.example.com:80", "socks://http-proxy.example.com:1080");
+  g_assert_cmpuint (mock->n_lookups, ==, 3);
+  assert_proxy (resolver, "http://www.example.com:8080", "socks://http-proxy.example.com:1080");
+  g_assert_cmpuint (mock->n_lookups, ==, 4);
+
+  g_object_unref (resolver);
+  g_object_unref (mock);
+}
+
+static void
+test_failure (void)
+{
+  MockProxyResolver *mock;
+  GProxyResolver *resolver;
+  gchar **proxies;
+  GError *error = NULL;
+  gint i;
+
+  mock = g_object_new (mock_proxy_resolver_get_type (), NULL);
+  resolver = g_proxy_resolver_new_caching (G_PROXY_RESOLVER (mock), 0, 0);
+
+  for (i = 0; i < 2; i++)
+    {
+      proxies = g_proxy_resolver_lookup (resolver, "http://flaky.example.com:80", NULL, &error);
+      g_assert_error (error, G_IO_ERROR, G_IO_ERROR_FAILED);
+      g_assert (proxies == NULL);
+      g_clear_error (&error);
+    }
+  g_assert_cmpuint (mock->n_lookups, ==, 2);
+
+  g_object_unref (resolver);
+  g_object_unref (mock);
+}
+
+static void
+test_max_entries (void)
+{
+  MockProxyResolver *mock;
+  GProxyResolver *resolver;
+
+  mock = g_object_new (mock_proxy_resolver_get_type (), NULL);
+  resolver = g_proxy_resolver_new_caching (G_PROXY_RESOLVER (mock), 0, 2);
+
+  assert_proxy (resolver, "http://a.example.com:80", "socks://http-proxy.example.com:1080");
+  assert_proxy (resolver, "http://b.example.com:80", "socks://http-proxy.example.com:1080");
+  assert_proxy (resolver, "http://a.example.com:80", "socks://http-proxy.example.com:1080");
+  g_assert_cmpuint (mock->n_lookups, ==, 2);
+
+  /* b is the least recently used entry, so it is evicted */
+  assert_proxy (resolver, "http://c.example.com:80", "socks://http-proxy.example.com:1080");
+  assert_proxy (resolver, "http://a.example.com:80", "socks://http-proxy.example.com:1080");
+  g_assert_cmpuint (mock->n_lookups, ==, 3);
+  assert_proxy (resolver, "http://b.example.com:80", "socks://http-proxy.example.com:1080");
+  g_assert_cmpuint (mock->n_lookups, ==, 4);
+
+  g_object_unref (resolver);
+  g_object_unref (mock);
+}
+
+static void
+lookup_cb (GObject      *source,
+           GAsyncResult *result,
+           gpointer      user_data)
+{
+  gint *n_pending = user_data;
+  gchar **proxies;
+  GError *error = NULL;
+
+  proxies = g_proxy_resolver_lookup_finish (G_PROXY_RESOLVER (source), result, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_strv_length (proxies), ==, 1);
+  g_strfreev (proxies);
+
+  (*n_pending)--;
+}
+
+static void
+cancelled_lookup_cb (GObject      *source,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+  gint *n_pending = user_data;
+  gchar **proxies;
+  GError *error = NULL;
+
+  proxies = g_proxy_resolver_lookup_finish (G_PROXY_RESOLVER (source), result, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert (proxies == NULL);
+  g_error_free (error);
+
+  (*n_pending)--;
+}
+
+static void
+test_coalesce (void)
+{
+  MockProxyResolver *mock;
+  GProxyResolver *resolver;
+  GCancellable *cancellable;
+  gint n_pending = 0;
+  gint i;
+
+  mock = g_object_new (mock_proxy_resolver_get_type (), NULL);
+  resolver = g_proxy_resolver_new_caching (G_PROXY_RESOLVER (mock), 0, 0);
+  cancellable = g_cancellable_new ();
+
+  for (i = 0; i < 5; i++)
+    {
+      g_proxy_resolver_lookup_async (resolver, "http://www.example.com:80", NULL,
+                                     lookup_cb, &n_pending);
+      n_pending++;
+    }
+
+  /* cancelling one of the waiters doesn't affect the others */
+  g_proxy_resolver_lookup_async (resolver, "http://www.example.com:80", cancellable,
+                                 cancelled_lookup_cb, &n_pending);
+  n_pending++;
+  g_cancellable_cancel (cancellable);
+
+  while (n_pending > 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (mock->n_lookups, ==, 1);
+
+  /* and the result is cached for later lookups */
+  g_proxy_resolver_lookup_async (resolver, "http://www.example.com:80", NULL,
+                                 lookup_cb, &n_pending);
+  n_pending++;
+  while (n_pending > 0)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_cmpuint (mock->n_lookups, ==, 1);
+
+  g_object_unref (cancellable);
+  g_object_unref (resolver);
+  g_object_unref (mock);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/caching-proxy-resolver/sync", test_sync);
+  g_test_add_func ("/caching-proxy-resolver/failure", test_failure);
+  g_test_add_func ("/caching-proxy-resolver/max-entries", test_max_entries);
+  g_test_add_func ("/caching-proxy-resolver/coalesce", test_coalesce);
+
+  return g_test_run ();
+}
@@ -0,0 +1,286 @@
+/* GLib testing framework examples and tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gio/gio.h>
+
+/* A resolver that knows a few fixed names and counts its lookups */
+typedef struct {
+  GResolver parent_instance;
+  guint n_lookups;
+} MockResolver;
+
+typedef GResolverClass MockResolverClass;
+
+static GType mock_resolver_get_type (void);
+G_DEFINE_TYPE (MockResolver, mock_resolver, G_TYPE_RESOLVER)
+
+static GList *
+mock_resolver_lookup_by_name (GResolver     *resolver,
+                              const gchar   *hostname,
+                              GCancellable  *cancellable,
+                              GError       **error)
+{
+  MockResolver *self = (MockResolver *) resolver;
+
+  self->n_lookups++;
+
+  if (g_ascii_strcasecmp (hostname, "flaky.example.com") == 0)
+    {
+      g_set_error (error, G_RESOLVER_ERROR, G_RESOLVER_ERROR_TEMPORARY_FAILURE,
+                   "Temporarily unable to resolve “%s”", hostname);
+      return NULL;
+    }
+  else if (g_str_has_suffix (hostname, ".invalid"))
+    {
+      g_set_error (error, G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND,
+                   "Error resolving “%s”", hostname);
+      return NULL;
+    }
+
+  return g_list_prepend (NULL, g_inet_address_new_from_string ("192.0.2.1"));
+}
+
+static void
+mock_resolver_lookup_by_name_async (GResolver           *resolver,
+                                    const gchar         *hostname,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             user_data)
+{
+  GTask *task;
+  GList *addresses;
+  GError *error = NULL;
+
+  task = g_task_new (resolver, cancellable, callback, user_data);
+  addresses = mock_resolver_lookup_by_name (resolver, hostname, cancellable, &error);
+  if (addresses != NULL)
+    g_task_return_pointer (task, addresses, (GDestroyNotify) g_resolver_free_addresses);
+  else
+    g_task_return_error (task, error);
+  g_object_unref (task);
+}
+
+static GList *
+mock_resolver_lookup_by_name_finish (GResolver     *resolver,
+                                     GAsyncResult  *result,
+                                     GError       **error)
+{
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static void
+mock_resolver_init (MockResolver *self)
+{
+}
+
+static void
+mock_resolver_class_init (MockResolverClass *resolver_class)
+{
+  resolver_class->lookup_by_name = mock_resolver_lookup_by_name;
+  resolver_class->lookup_by_name_async = mock_resolver_lookup_by_name_async;
+  resolver_class->lookup_by_name_finish = mock_resolver_lookup_by_name_finish;
+}
+
+static void
+assert_resolves (GResolver   *resolver,
+                 const gchar *hostname)
+{
+  GList *addresses;
+  gchar *str;
+  GError *error = NULL;
+
+  addresses = g_resolver_lookup_by_name (resolver, hostname, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (g_list_length (addresses), ==, 1);
+  str = g_inet_address_to_string (addresses->data);
+  g_assert_cmpstr (str, ==, "192.0.2.1");
+  g_free (str);
+  g_resolver_free_addresses (addresses);
+}
+
+static void
+test_sync (void)
+{
+  MockResolver *mock;
+  GResolver *resolver;
+
+  mock = g_object_new (mock_resolver_get_type (), NULL);
+  resolver = g_resolver_new_caching (G_RESOLVER (mock), 0);
+
+  assert_resolves (resolver, "www.example.com");
+  assert_resolves (resolver, "www.example.com");
+  assert_resolves (resolver, "WWW.Example.COM");
+  g_assert_cmpuint (mock->n_lookups, ==, 1);
+
+  assert_resolves (resolver, "mail.example.com");
+  g_assert_cmpuint (mock->n_lookups, ==, 2);
+
+  g_object_unref (resolver);
+  g_object_unref (mock);
+}
+
+static void
+test_negative (void)
+{
+  MockResolver *mock;
+  GResolver *resolver;
+  GList *addresses;
+  GError *error = NULL;
+  gint i;
+
+  mock = g_object_new (mock_resolver_get_type (), NULL);
+  resolver = g_resolver_new_caching (G_RESOLVER (mock), 0);
+
+  /* "not found" is cached... */
+  for (i = 0; i < 2; i++)
+    {
+      addresses = g_resolver_lookup_by_name (resolver, "nothing.invalid", NULL, &error);
+      g_assert_error (error, G_RESOLVER_ERROR, G_RESOLVER_ERROR_NOT_FOUND);
+      g_assert (addresses == NULL);
+      g_clear_error (&error);
+    }
+  g_assert_cmpuint (mock->n_lookups, ==, 1);
+
+  /* ...but temporary failures are not */
+  for (i = 0; i < 2; i++)
+    {
+      addresses = g_resolver_lookup_by_name (resolver, "flaky.example.com", NULL, &error);
+      g_assert_error (error, G_RESOLVER_ERROR, G_RESOLVER_ERROR_TEMPORARY_FAILURE);
+      g_assert (addresses == NULL);
+      g_clear_error (&error);
+    }
+  g_assert_cmpuint (mock->n_lookups, ==, 3);
+
+  g_object_unref (resolver);
+  g_object_unref (mock);
+}
+
+static void
+test_max_entries (void)
+{
+  MockResolver *mock;
+  GResolver *resolver;
+
+  mock = g_object_new (mock_resolver_get_type (), NULL);
+  resolver = g_resolver_new_caching (G_RESOLVER (mock), 2);
+
+  assert_resolves (resolver, "a.example.com");
+  assert_resolves (resolver, "b.example.com");
+  assert_resolves (resolver, "a.example.com");
+  g_assert_cmpuint (mock->n_lookups, ==, 2);
+
+  /* b is the least recently used entry, so it is evicted */
+  assert_resolves (resolver, "c.example.com");
+  assert_resolves (resolver, "a.example.com");
+  g_assert_cmpuint (mock->n_lookups, ==, 3);
+  assert_resolves (resolver, "b.example.com");
+  g_assert_cmpuint (mock->n_lookups, ==, 4);
+
+  g_object_unref (resolver);
+  g_object_unref (mock);
+}
+
+static void
+lookup_cb (GObject      *source,
+           GAsyncResult *result,
+           gpointer      user_data)
+{
+  gint *n_pending = user_data;
+  GList *addresses;
+  GError *error = NULL;
+
+  addresses = g_resolver_lookup_by_name_finish (G_RESOLVER (source), result, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (g_list_length (addresses), ==, 1);
+  g_resolver_free_addresses (addresses);
+
+  (*n_pending)--;
+}
+
+static void
+cancelled_lookup_cb (GObject      *source,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+  gint *n_pending = user_data;
+  GList *addresses;
+  GError *error = NULL;
+
+  addresses = g_resolver_lookup_by_name_finish (G_RESOLVER (source), result, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert (addresses == NULL);
+  g_error_free (error);
+
+  (*n_pending)--;
+}
+
+static void
+test_coalesce (void)
+{
+  MockResolver *mock;
+  GResolver *resolver;
+  GCancellable *cancellable;
+  gint n_pending = 0;
+  gint i;
+
+  mock = g_object_new (mock_resolver_get_type (), NULL);
+  resolver = g_resolver_new_caching (G_RESOLVER (mock), 0);
+  cancellable = g_cancellable_new ();
+
+  for (i = 0; i < 5; i++)
+    {
+      g_resolver_lookup_by_name_async (resolver, "www.example.com", NULL,
+                                       lookup_cb, &n_pending);
+      n_pending++;
+    }
+
+  /* cancelling one of the waiters doesn't affect the others */
+  g_resolver_lookup_by_name_async (resolver, "www.example.com", cancellable,
+                                   cancelled_lookup_cb, &n_pending);
+  n_pending++;
+  g_cancellable_cancel (cancellable);
+
+  while (n_pending > 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (mock->n_lookups, ==, 1);
+
+  /* and the result is cached for later lookups */
+  g_resolver_lookup_by_name_async (resolver, "www.example.com", NULL,
+                                   lookup_cb, &n_pending);
+  n_pending++;
+  while (n_pending > 0)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_cmpuint (mock->n_lookups, ==, 1);
+
+  g_object_unref (cancellable);
+  g_object_unref (resolver);
+  g_object_unref (mock);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/caching-resolver/sync", test_sync);
+  g_test_add_func ("/caching-resolver/negative", test_negative);
+  g_test_add_func ("/caching-resolver/max-entries", test_max_entries);
+  g_test_add_func ("/caching-resolver/coalesce", test_coalesce);
+
+  return g_test_run ();
+}
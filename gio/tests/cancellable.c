@@ -216,12 +216,200 @@ test_cancel_multiple_concurrent (void)
   g_main_loop_unref (loop);
 }
 
+static void
+on_cancelled_count (GCancellable *cancellable,
+                    gpointer      user_data)
+{
+  gint *count = user_data;
+
+  (*count)++;
+}
+
+static void
+test_cancel_parent (void)
+{
+  GCancellable *parent, *child, *grandchild, *sibling, *late;
+  gint child_cancelled = 0;
+
+  parent = g_cancellable_new ();
+  child = g_cancellable_new_with_parent (parent);
+  grandchild = g_cancellable_new_with_parent (child);
+  sibling = g_cancellable_new_with_parent (parent);
+
+  g_assert (g_cancellable_get_parent (parent) == NULL);
+  g_assert (g_cancellable_get_parent (child) == parent);
+  g_assert (g_cancellable_get_parent (grandchild) == child);
+
+  g_signal_connect (child, "cancelled",
+                    G_CALLBACK (on_cancelled_count), &child_cancelled);
+
+  /* Cancellation does not propagate upward */
+  g_cancellable_cancel (sibling);
+  g_assert_true (g_cancellable_is_cancelled (sibling));
+  g_assert_false (g_cancellable_is_cancelled (parent));
+  g_assert_false (g_cancellable_is_cancelled (child));
+
+  /* ...but does propagate downward, through several levels */
+  g_cancellable_cancel (parent);
+  g_assert_true (g_cancellable_is_cancelled (parent));
+  g_assert_true (g_cancellable_is_cancelled (child));
+  g_assert_true (g_cancellable_is_cancelled (grandchild));
+  g_assert_cmpint (child_cancelled, ==, 1);
+
+  /* Children of a cancelled parent start out cancelled */
+  late = g_cancellable_new_with_parent (parent);
+  g_assert_true (g_cancellable_is_cancelled (late));
+  g_object_unref (late);
+
+  /* Resetting the parent leaves the children alone */
+  g_cancellable_reset (parent);
+  g_assert_false (g_cancellable_is_cancelled (parent));
+  g_assert_true (g_cancellable_is_cancelled (child));
+
+  /* Dropping a child unlinks it, and the parent outlives its children */
+  g_object_add_weak_pointer (G_OBJECT (parent), (gpointer *) &parent);
+  g_object_unref (parent);
+  g_assert_nonnull (parent);
+  g_object_unref (sibling);
+  g_object_unref (child);
+  g_assert_nonnull (parent);
+  g_object_unref (grandchild);
+  g_assert_null (parent);
+}
+
+static void
+test_cancel_deadline (void)
+{
+  GCancellable *cancellable, *child;
+  GError *error = NULL;
+  gint64 deadline;
+
+  g_assert_cmpint (g_cancellable_get_deadline (NULL), ==, -1);
+
+  cancellable = g_cancellable_new ();
+  g_assert_cmpint (g_cancellable_get_deadline (cancellable), ==, -1);
+  g_object_unref (cancellable);
+
+  deadline = g_get_monotonic_time () + 20 * G_TIME_SPAN_MILLISECOND;
+  cancellable = g_cancellable_new_with_deadline (deadline);
+  child = g_cancellable_new_with_parent (cancellable);
+  g_assert_cmpint (g_cancellable_get_deadline (cancellable), ==, deadline);
+  g_assert_cmpint (g_cancellable_get_deadline (child), ==, deadline);
+  g_assert_false (g_cancellable_is_cancelled (cancellable));
+
+  g_usleep (30 * G_TIME_SPAN_MILLISECOND);
+
+  g_assert_true (g_cancellable_set_error_if_cancelled (cancellable, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT);
+  g_clear_error (&error);
+
+  /* The child expired along with its parent */
+  g_assert_true (g_cancellable_set_error_if_cancelled (child, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT);
+  g_clear_error (&error);
+  g_object_unref (child);
+
+  g_object_unref (cancellable);
+
+  /* An explicit cancel is still reported as such */
+  cancellable = g_cancellable_new_with_deadline (g_get_monotonic_time () + G_TIME_SPAN_HOUR);
+  g_cancellable_cancel (cancellable);
+  g_assert_true (g_cancellable_set_error_if_cancelled (cancellable, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_clear_error (&error);
+  g_object_unref (cancellable);
+}
+
+static gboolean
+on_deadline_source (GCancellable *cancellable,
+                    gpointer      user_data)
+{
+  GMainLoop *loop = user_data;
+
+  g_assert_true (g_cancellable_is_cancelled (cancellable));
+  g_main_loop_quit (loop);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+test_cancel_deadline_source (void)
+{
+  GCancellable *cancellable;
+  GMainLoop *loop;
+  GSource *source;
+  gint64 deadline;
+
+  deadline = g_get_monotonic_time () + 20 * G_TIME_SPAN_MILLISECOND;
+  cancellable = g_cancellable_new_with_deadline (deadline);
+  loop = g_main_loop_new (NULL, FALSE);
+
+  /* The source wakes the loop by itself; nothing else is attached */
+  source = g_cancellable_source_new (cancellable);
+  g_source_set_callback (source, (GSourceFunc) on_deadline_source, loop, NULL);
+  g_source_attach (source, NULL);
+  g_source_unref (source);
+
+  g_main_loop_run (loop);
+  g_assert_cmpint (g_get_monotonic_time (), >=, deadline);
+
+  g_main_loop_unref (loop);
+  g_object_unref (cancellable);
+}
+
+static void
+test_cancel_deadline_socket (void)
+{
+  GCancellable *cancellable;
+  GInetAddress *iaddr;
+  GSocketAddress *addr;
+  GSocket *socket;
+  GError *error = NULL;
+  gint64 deadline;
+  gchar buf[16];
+  gboolean ok;
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+                         G_SOCKET_PROTOCOL_DEFAULT, &error);
+  g_assert_no_error (error);
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (iaddr, 0);
+  g_object_unref (iaddr);
+  g_socket_bind (socket, addr, TRUE, &error);
+  g_assert_no_error (error);
+  g_object_unref (addr);
+
+  /* A wait without a timeout still ends at the deadline */
+  deadline = g_get_monotonic_time () + 20 * G_TIME_SPAN_MILLISECOND;
+  cancellable = g_cancellable_new_with_deadline (deadline);
+  ok = g_socket_condition_timed_wait (socket, G_IO_IN, -1, cancellable, &error);
+  g_assert_false (ok);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT);
+  g_assert_cmpint (g_get_monotonic_time (), >=, deadline);
+  g_clear_error (&error);
+  g_object_unref (cancellable);
+
+  /* ...as does a blocking receive */
+  deadline = g_get_monotonic_time () + 20 * G_TIME_SPAN_MILLISECOND;
+  cancellable = g_cancellable_new_with_deadline (deadline);
+  g_assert_cmpint (g_socket_receive (socket, buf, sizeof buf, cancellable, &error), ==, -1);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT);
+  g_clear_error (&error);
+  g_object_unref (cancellable);
+
+  g_object_unref (socket);
+}
+
 int
 main (int argc, char *argv[])
 {
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/cancellable/multiple-concurrent", test_cancel_multiple_concurrent);
+  g_test_add_func ("/cancellable/parent", test_cancel_parent);
+  g_test_add_func ("/cancellable/deadline", test_cancel_deadline);
+  g_test_add_func ("/cancellable/deadline-source", test_cancel_deadline_source);
+  g_test_add_func ("/cancellable/deadline-socket", test_cancel_deadline_socket);
 
   return g_test_run ();
 }
@@ -120,6 +120,55 @@ test_guess (void)
 #endif
 }
 
+/* Guessing from the same names again, including after they have been
+ * pushed out by many others, gives the same results.
+ */
+static void
+test_guess_repeated (void)
+{
+  gchar *expected;
+  gchar *first;
+  guint round, i;
+
+  expected = g_content_type_from_mime_type ("text/plain");
+
+  for (round = 0; round < 2; round++)
+    {
+      for (i = 0; i < 3000; i++)
+        {
+          gchar *name, *res;
+          gboolean uncertain;
+
+          name = g_strdup_printf ("file%u.txt", i);
+          res = g_content_type_guess (name, NULL, 0, &uncertain);
+          g_assert_content_type_equals (expected, res);
+          g_assert (!uncertain);
+          g_free (res);
+          g_free (name);
+        }
+    }
+
+  first = g_content_type_guess ("foo", NULL, 0, NULL);
+  for (i = 0; i < 3; i++)
+    {
+      gchar *res;
+      gboolean uncertain;
+
+      res = g_content_type_guess ("foo", NULL, 0, &uncertain);
+      g_assert_content_type_equals (first, res);
+      g_assert (uncertain);
+      g_free (res);
+
+      res = g_content_type_guess ("foo", (const guchar *) "hello", 5, &uncertain);
+      g_assert_content_type_equals (expected, res);
+      g_assert (!uncertain);
+      g_free (res);
+    }
+
+  g_free (first);
+  g_free (expected);
+}
+
 static void
 test_unknown (void)
 {
@@ -329,6 +378,7 @@ main (int argc, char *argv[])
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/contenttype/guess", test_guess);
+  g_test_add_func ("/contenttype/guess-repeated", test_guess_repeated);
   g_test_add_func ("/contenttype/unknown", test_unknown);
   g_test_add_func ("/contenttype/subtype", test_subtype);
   g_test_add_func ("/contenttype/list", test_list);
@@ -659,8 +659,8 @@ g_leftover_converter_iface_init (GConverterIface *iface)
   iface->reset = g_leftover_converter_reset;
 }
 
-#define LEFTOVER_BUFSIZE 8192
-#define INTERNAL_BUFSIZE 4096
+#define INTERNAL_BUFSIZE (64 * 1024)
+#define LEFTOVER_BUFSIZE (2 * INTERNAL_BUFSIZE)
 
 static void
 test_converter_leftover (void)
@@ -730,6 +730,7 @@ typedef struct {
   const gchar *path;
   GZlibCompressorFormat format;
   gint level;
+  guint threads;
 } CompressorTest;
 
 static void
@@ -758,7 +759,11 @@ test_roundtrip (gconstpointer data)
     DATA_LENGTH * sizeof (guint32), NULL);
 
   ostream1 = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
-  compressor = G_CONVERTER (g_zlib_compressor_new (test->format, test->level));
+  compressor = g_object_new (G_TYPE_ZLIB_COMPRESSOR,
+                             "format", test->format,
+                             "level", test->level,
+                             "threads", MAX (test->threads, 1),
+                             NULL);
   info = g_file_info_new ();
   g_file_info_set_name (info, "foo");
   g_object_set (compressor, "file-info", info, NULL);
@@ -806,6 +811,271 @@ test_roundtrip (gconstpointer data)
   g_free (data0);
 }
 
+/* Compresses text on several threads with flushes in between, and
+ * checks that what was flushed so far decompresses to everything
+ * written before the flush.
+ */
+static void
+test_threaded_flush (void)
+{
+  GError *error = NULL;
+  GOutputStream *ostream, *costream;
+  GConverter *compressor, *decompressor;
+  GString *text;
+  gchar *decompressed;
+  gsize bytes_read, bytes_written;
+  GConverterResult res;
+  gsize compressed_size;
+  guint i;
+  gboolean ok;
+
+  compressor = g_object_new (G_TYPE_ZLIB_COMPRESSOR,
+                             "format", G_ZLIB_COMPRESSOR_FORMAT_GZIP,
+                             "level", -1,
+                             "threads", 4,
+                             NULL);
+  ostream = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
+  costream = g_converter_output_stream_new (ostream, compressor);
+
+  text = g_string_new (NULL);
+  for (i = 0; i < 60000; i++)
+    {
+      gchar *line = g_strdup_printf ("line %u of some compressible text\n", i);
+
+      ok = g_output_stream_write_all (costream, line, strlen (line), NULL, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_true (ok);
+      g_string_append (text, line);
+      g_free (line);
+
+      if (i % 20000 == 19999)
+        {
+          ok = g_output_stream_flush (costream, NULL, &error);
+          g_assert_no_error (error);
+          g_assert_true (ok);
+
+          /* Everything up to the flush must decode without the rest */
+          compressed_size = g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (ostream));
+          decompressor = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP));
+          decompressed = g_malloc (text->len + 1);
+          res = g_converter_convert (decompressor,
+                                     g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (ostream)),
+                                     compressed_size,
+                                     decompressed, text->len + 1,
+                                     G_CONVERTER_FLUSH,
+                                     &bytes_read, &bytes_written, &error);
+          g_assert_no_error (error);
+          g_assert_cmpint (res, ==, G_CONVERTER_CONVERTED);
+          g_assert_cmpuint (bytes_read, ==, compressed_size);
+          g_assert_cmpmem (decompressed, bytes_written, text->str, text->len);
+          g_free (decompressed);
+          g_object_unref (decompressor);
+        }
+    }
+
+  ok = g_output_stream_close (costream, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (ok);
+
+  /* The complete stream is a single ordinary gzip member */
+  compressed_size = g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (ostream));
+  g_assert_cmpuint (compressed_size, <, text->len / 4);
+  decompressor = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP));
+  decompressed = g_malloc (text->len + 1);
+  res = g_converter_convert (decompressor,
+                             g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (ostream)),
+                             compressed_size,
+                             decompressed, text->len + 1,
+                             G_CONVERTER_INPUT_AT_END,
+                             &bytes_read, &bytes_written, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (res, ==, G_CONVERTER_FINISHED);
+  g_assert_cmpuint (bytes_read, ==, compressed_size);
+  g_assert_cmpmem (decompressed, bytes_written, text->str, text->len);
+  g_free (decompressed);
+  g_object_unref (decompressor);
+
+  g_string_free (text, TRUE);
+  g_object_unref (costream);
+  g_object_unref (ostream);
+  g_object_unref (compressor);
+}
+
+static GBytes *
+convert_all (GConverter    *converter,
+             gconstpointer  data,
+             gsize          size,
+             GError       **error)
+{
+  GOutputStream *ostream, *costream;
+  GBytes *bytes = NULL;
+
+  ostream = g_memory_output_stream_new_resizable ();
+  costream = g_converter_output_stream_new (ostream, converter);
+
+  if (g_output_stream_write_all (costream, data, size, NULL, NULL, error) &&
+      g_output_stream_close (costream, NULL, error))
+    bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (ostream));
+
+  g_object_unref (costream);
+  g_object_unref (ostream);
+
+  return bytes;
+}
+
+static void
+test_dictionary (void)
+{
+  const gchar *dict_text = "{\"type\": \"event\", \"source\": \"sensor\", \"value\": }";
+  const gchar *message = "{\"type\": \"event\", \"source\": \"sensor\", \"value\": 42}";
+  GZlibCompressorFormat formats[] = { G_ZLIB_COMPRESSOR_FORMAT_ZLIB, G_ZLIB_COMPRESSOR_FORMAT_RAW };
+  GError *error = NULL;
+  GBytes *dictionary;
+  guint i, threads;
+
+  dictionary = g_bytes_new_static (dict_text, strlen (dict_text));
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    for (threads = 1; threads <= 2; threads++)
+      {
+        GConverter *converter;
+        GBytes *plain, *with_dict, *decompressed;
+
+        converter = g_object_new (G_TYPE_ZLIB_COMPRESSOR,
+                                  "format", formats[i],
+                                  "threads", threads,
+                                  NULL);
+        plain = convert_all (converter, message, strlen (message), &error);
+        g_assert_no_error (error);
+        g_object_unref (converter);
+
+        converter = g_object_new (G_TYPE_ZLIB_COMPRESSOR,
+                                  "format", formats[i],
+                                  "threads", threads,
+                                  "dictionary", dictionary,
+                                  NULL);
+        with_dict = convert_all (converter, message, strlen (message), &error);
+        g_assert_no_error (error);
+        g_object_unref (converter);
+
+        g_assert_cmpuint (g_bytes_get_size (with_dict), <, g_bytes_get_size (plain));
+
+        converter = g_object_new (G_TYPE_ZLIB_DECOMPRESSOR,
+                                  "format", formats[i],
+                                  "dictionary", dictionary,
+                                  NULL);
+        decompressed = convert_all (converter,
+                                    g_bytes_get_data (with_dict, NULL),
+                                    g_bytes_get_size (with_dict),
+                                    &error);
+        g_assert_no_error (error);
+        g_assert_cmpmem (g_bytes_get_data (decompressed, NULL), g_bytes_get_size (decompressed),
+                         message, strlen (message));
+        g_bytes_unref (decompressed);
+
+        /* The same decompressor still works after a reset */
+        g_converter_reset (converter);
+        decompressed = convert_all (converter,
+                                    g_bytes_get_data (with_dict, NULL),
+                                    g_bytes_get_size (with_dict),
+                                    &error);
+        g_assert_no_error (error);
+        g_assert_cmpmem (g_bytes_get_data (decompressed, NULL), g_bytes_get_size (decompressed),
+                         message, strlen (message));
+        g_bytes_unref (decompressed);
+        g_object_unref (converter);
+
+        /* zlib data says that it needs a dictionary */
+        if (formats[i] == G_ZLIB_COMPRESSOR_FORMAT_ZLIB)
+          {
+            converter = G_CONVERTER (g_zlib_decompressor_new (formats[i]));
+            decompressed = convert_all (converter,
+                                        g_bytes_get_data (with_dict, NULL),
+                                        g_bytes_get_size (with_dict),
+                                        &error);
+            g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+            g_assert_null (decompressed);
+            g_clear_error (&error);
+            g_object_unref (converter);
+          }
+
+        g_bytes_unref (plain);
+        g_bytes_unref (with_dict);
+      }
+
+  g_bytes_unref (dictionary);
+}
+
+static void
+test_base64 (void)
+{
+  GConverter *encoder, *decoder;
+  GInputStream *in, *cin;
+  GError *error = NULL;
+  guchar *data, *decoded;
+  gchar *expected;
+  gsize expected_len;
+  gint state = 0, save = 0;
+  GBytes *encoded;
+  gsize size = 100000;
+  gsize bytes_read;
+  gsize i;
+
+  data = g_malloc (size);
+  for (i = 0; i < size; i++)
+    data[i] = i * 7 + 3;
+
+  expected = g_malloc ((size / 3 + 1) * 4 * 2 + 16);
+  expected_len = g_base64_encode_step (data, size, TRUE, expected, &state, &save);
+  expected_len += g_base64_encode_close (TRUE, expected + expected_len, &state, &save);
+
+  /* encode on the way out */
+  encoder = G_CONVERTER (g_object_new (G_TYPE_BASE64_CONVERTER,
+                                       "mode", G_BASE64_CONVERTER_ENCODE,
+                                       "break-lines", TRUE,
+                                       NULL));
+  g_assert (g_base64_converter_get_break_lines (G_BASE64_CONVERTER (encoder)));
+  encoded = convert_all (encoder, data, size, &error);
+  g_assert_no_error (error);
+  g_assert_cmpmem (g_bytes_get_data (encoded, NULL), g_bytes_get_size (encoded),
+                   expected, expected_len);
+
+  /* and decode on the way in, a few bytes at a time */
+  decoder = G_CONVERTER (g_base64_converter_new (G_BASE64_CONVERTER_DECODE));
+  g_assert_cmpint (g_base64_converter_get_mode (G_BASE64_CONVERTER (decoder)), ==,
+                   G_BASE64_CONVERTER_DECODE);
+  in = g_memory_input_stream_new_from_bytes (encoded);
+  cin = g_converter_input_stream_new (in, decoder);
+
+  decoded = g_malloc (size + 1);
+  for (i = 0; ; i += bytes_read)
+    {
+      bytes_read = g_input_stream_read (cin, decoded + i, MIN (size + 1 - i, 1000), NULL, &error);
+      g_assert_no_error (error);
+      if (bytes_read == 0)
+        break;
+    }
+  g_assert_cmpmem (decoded, i, data, size);
+
+  g_object_unref (cin);
+  g_object_unref (in);
+  g_object_unref (decoder);
+  g_bytes_unref (encoded);
+
+  /* a short write, and a reset between uses */
+  g_converter_reset (encoder);
+  encoded = convert_all (encoder, "Hello", 5, &error);
+  g_assert_no_error (error);
+  g_assert_cmpmem (g_bytes_get_data (encoded, NULL), g_bytes_get_size (encoded),
+                   "SGVsbG8=\n", 9);
+  g_bytes_unref (encoded);
+
+  g_object_unref (encoder);
+  g_free (decoded);
+  g_free (expected);
+  g_free (data);
+}
+
 typedef struct {
   const gchar *path;
   const gchar *charset_in;
@@ -1195,6 +1465,10 @@ main (int   argc,
     { "/converter-output-stream/roundtrip/gzip-9", G_ZLIB_COMPRESSOR_FORMAT_GZIP, 9 },
     { "/converter-output-stream/roundtrip/raw-0", G_ZLIB_COMPRESSOR_FORMAT_RAW, 0 },
     { "/converter-output-stream/roundtrip/raw-9", G_ZLIB_COMPRESSOR_FORMAT_RAW, 9 },
+    { "/converter-output-stream/roundtrip/threaded/zlib-6", G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 6, 4 },
+    { "/converter-output-stream/roundtrip/threaded/gzip-0", G_ZLIB_COMPRESSOR_FORMAT_GZIP, 0, 3 },
+    { "/converter-output-stream/roundtrip/threaded/gzip-9", G_ZLIB_COMPRESSOR_FORMAT_GZIP, 9, 4 },
+    { "/converter-output-stream/roundtrip/threaded/raw-1", G_ZLIB_COMPRESSOR_FORMAT_RAW, 1, 2 },
   };
   CompressorTest truncation_tests[] = {
     { "/converter-input-stream/truncation/zlib", G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 0 },
@@ -1228,6 +1502,9 @@ main (int   argc,
 
   g_test_add_func ("/converter-stream/pollable", test_converter_pollable);
   g_test_add_func ("/converter-stream/leftover", test_converter_leftover);
+  g_test_add_func ("/converter-output-stream/threaded-flush", test_threaded_flush);
+  g_test_add_func ("/converter-output-stream/dictionary", test_dictionary);
+  g_test_add_func ("/converter-stream/base64", test_base64);
 
   return g_test_run();
 }
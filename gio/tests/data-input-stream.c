@@ -222,6 +222,78 @@ test_read_lines_LF_invalid_utf8 (void)
   g_object_unref (stream);
 }
 
+static GInputStream *
+new_split_lines_stream (GDataStreamNewlineType   newline_type,
+                        const gchar            **chunks)
+{
+  GInputStream *base_stream;
+  GInputStream *stream;
+  gint i;
+
+  base_stream = g_memory_input_stream_new ();
+  for (i = 0; chunks[i]; i++)
+    g_memory_input_stream_add_data (G_MEMORY_INPUT_STREAM (base_stream), chunks[i], -1, NULL);
+
+  stream = G_INPUT_STREAM (g_data_input_stream_new (base_stream));
+  g_data_input_stream_set_newline_type (G_DATA_INPUT_STREAM (stream), newline_type);
+  /* Small enough for lines and newlines to span several fills */
+  g_buffered_input_stream_set_buffer_size (G_BUFFERED_INPUT_STREAM (stream), 4);
+  g_object_unref (base_stream);
+
+  return stream;
+}
+
+static void
+test_read_line_borrowed (void)
+{
+  const gchar *any_chunks[] = { "one\r", "\ntwo\r", "three\n", "four\r", "\r\nfive", NULL };
+  const gchar *any_lines[] = { "one", "two", "three", "four", "", "five", NULL };
+  const gchar *crlf_chunks[] = { "a\rb\r", "\nc\n\r", "\n", NULL };
+  const gchar *crlf_lines[] = { "a\rb", "c\n", NULL };
+  const gchar **chunks[] = { any_chunks, crlf_chunks };
+  const gchar **lines[] = { any_lines, crlf_lines };
+  GDataStreamNewlineType types[] = { G_DATA_STREAM_NEWLINE_TYPE_ANY, G_DATA_STREAM_NEWLINE_TYPE_CR_LF };
+  GInputStream *stream;
+  GError *error = NULL;
+  const char *line;
+  char *copy;
+  gsize length;
+  gint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (types); i++)
+    {
+      /* The copying and the borrowing variant must agree */
+      stream = new_split_lines_stream (types[i], chunks[i]);
+      for (j = 0; lines[i][j]; j++)
+        {
+          copy = g_data_input_stream_read_line (G_DATA_INPUT_STREAM (stream), &length, NULL, &error);
+          g_assert_no_error (error);
+          g_assert_cmpstr (copy, ==, lines[i][j]);
+          g_assert_cmpuint (length, ==, strlen (lines[i][j]));
+          g_free (copy);
+        }
+      copy = g_data_input_stream_read_line (G_DATA_INPUT_STREAM (stream), &length, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_null (copy);
+      g_object_unref (stream);
+
+      stream = new_split_lines_stream (types[i], chunks[i]);
+      for (j = 0; lines[i][j]; j++)
+        {
+          line = g_data_input_stream_read_line_borrowed (G_DATA_INPUT_STREAM (stream), &length, NULL, &error);
+          g_assert_no_error (error);
+          g_assert_nonnull (line);
+          g_assert_cmpuint (length, ==, strlen (lines[i][j]));
+          g_assert (memcmp (line, lines[i][j], length) == 0);
+        }
+      line = g_data_input_stream_read_line_borrowed (G_DATA_INPUT_STREAM (stream), &length, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_null (line);
+      g_assert_cmpuint (length, ==, 0);
+      g_object_unref (stream);
+    }
+}
+
 static void
 test_read_until (void)
 {
@@ -494,6 +566,7 @@ main (int   argc,
   g_test_add_func ("/data-input-stream/read-lines-CR", test_read_lines_CR);
   g_test_add_func ("/data-input-stream/read-lines-CR-LF", test_read_lines_CR_LF);
   g_test_add_func ("/data-input-stream/read-lines-any", test_read_lines_any);
+  g_test_add_func ("/data-input-stream/read-line-borrowed", test_read_line_borrowed);
   g_test_add_func ("/data-input-stream/read-until", test_read_until);
   g_test_add_func ("/data-input-stream/read-upto", test_read_upto);
   g_test_add_func ("/data-input-stream/read-int", test_read_int);
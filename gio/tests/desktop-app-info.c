@@ -731,6 +731,126 @@ test_implements (void)
   assert_implementations ("org.gnome.Shell.SearchProvider2", "", FALSE, FALSE);
 }
 
+static gchar *
+run_apps_search_in (const gchar *data_dir,
+                    const gchar *cache_dir,
+                    const gchar *term)
+{
+  gboolean success;
+  gchar **envp;
+  gchar *argv[4];
+  gint status;
+  gchar *out;
+
+  argv[0] = g_test_build_filename (G_TEST_BUILT, "apps", NULL);
+  argv[1] = "search";
+  argv[2] = (gchar *) term;
+  argv[3] = NULL;
+
+  envp = g_get_environ ();
+  envp = g_environ_setenv (envp, "XDG_DATA_DIRS", data_dir, TRUE);
+  envp = g_environ_setenv (envp, "XDG_DATA_HOME", "/does-not-exist", TRUE);
+  envp = g_environ_setenv (envp, "XDG_CACHE_HOME", cache_dir, TRUE);
+  envp = g_environ_setenv (envp, "LC_ALL", "C", TRUE);
+  envp = g_environ_unsetenv (envp, "LANGUAGE");
+
+  success = g_spawn_sync (NULL, argv, envp, 0, NULL, NULL, &out, NULL, &status, NULL);
+  g_assert (success);
+  g_assert (status == 0);
+
+  g_strfreev (envp);
+  g_free (argv[0]);
+
+  return out;
+}
+
+static void
+write_desktop_file (const gchar *filename,
+                    const gchar *name)
+{
+  GError *error = NULL;
+  gchar *contents;
+
+  contents = g_strdup_printf ("[Desktop Entry]\n"
+                              "Type=Application\n"
+                              "Name=%s\n"
+                              "Exec=true\n", name);
+  g_file_set_contents (filename, contents, -1, &error);
+  g_assert_no_error (error);
+  g_free (contents);
+}
+
+static void
+test_search_cache (void)
+{
+  GError *error = NULL;
+  gchar *tmpdir;
+  gchar *apps_dir;
+  gchar *cache_dir;
+  gchar *search_cache_dir;
+  gchar *filename;
+  gchar *out;
+  GDir *dir;
+  const gchar *name;
+
+  tmpdir = g_dir_make_tmp ("desktop-search-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  apps_dir = g_build_filename (tmpdir, "applications", NULL);
+  cache_dir = g_build_filename (tmpdir, "cache", NULL);
+  search_cache_dir = g_build_filename (cache_dir, "gio", "desktop-search", NULL);
+  filename = g_build_filename (apps_dir, "cache-test.desktop", NULL);
+  g_assert_cmpint (g_mkdir (apps_dir, 0700), ==, 0);
+
+  write_desktop_file (filename, "Frobnicator");
+
+  /* The first search writes the cache, the second one uses it */
+  out = run_apps_search_in (tmpdir, cache_dir, "frob");
+  g_assert_cmpstr (out, ==, "cache-test.desktop\n");
+  g_free (out);
+  g_assert (g_file_test (search_cache_dir, G_FILE_TEST_IS_DIR));
+
+  out = run_apps_search_in (tmpdir, cache_dir, "frob");
+  g_assert_cmpstr (out, ==, "cache-test.desktop\n");
+  g_free (out);
+
+  /* Changing the desktop file makes the cache stale */
+  write_desktop_file (filename, "Whatsit Tool");
+
+  out = run_apps_search_in (tmpdir, cache_dir, "frob");
+  g_assert_cmpstr (out, ==, "");
+  g_free (out);
+
+  out = run_apps_search_in (tmpdir, cache_dir, "whats");
+  g_assert_cmpstr (out, ==, "cache-test.desktop\n");
+  g_free (out);
+
+  dir = g_dir_open (search_cache_dir, 0, &error);
+  g_assert_no_error (error);
+  while ((name = g_dir_read_name (dir)))
+    {
+      gchar *path = g_build_filename (search_cache_dir, name, NULL);
+      g_remove (path);
+      g_free (path);
+    }
+  g_dir_close (dir);
+
+  g_remove (filename);
+  g_rmdir (search_cache_dir);
+  g_free (search_cache_dir);
+  search_cache_dir = g_build_filename (cache_dir, "gio", NULL);
+  g_rmdir (search_cache_dir);
+  g_rmdir (cache_dir);
+  g_rmdir (apps_dir);
+  g_rmdir (tmpdir);
+
+  g_free (filename);
+  g_free (search_cache_dir);
+  g_free (cache_dir);
+  g_free (apps_dir);
+  g_free (tmpdir);
+}
+
 static void
 assert_shown (const gchar *desktop_id,
               gboolean     expected,
@@ -783,6 +903,7 @@ main (int   argc,
   g_test_add_func ("/desktop-app-info/actions", test_actions);
   g_test_add_func ("/desktop-app-info/search", test_search);
   g_test_add_func ("/desktop-app-info/implements", test_implements);
+  g_test_add_func ("/desktop-app-info/search-cache", test_search_cache);
   g_test_add_func ("/desktop-app-info/show-in", test_show_in);
 
   result = g_test_run ();
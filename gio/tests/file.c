@@ -1,6 +1,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <glib/gstdio.h>
 #include <gio/gio.h>
 #include <gio/gfiledescriptorbased.h>
 #ifdef G_OS_UNIX
@@ -852,6 +853,63 @@ test_copy_preserve_mode (void)
 }
 #endif
 
+static void
+copy_progress (goffset  current_num_bytes,
+               goffset  total_num_bytes,
+               gpointer user_data)
+{
+  goffset *last = user_data;
+
+  g_assert_cmpint (current_num_bytes, >=, *last);
+  g_assert_cmpint (current_num_bytes, <=, total_num_bytes);
+  *last = current_num_bytes;
+}
+
+static void
+test_copy_contents (void)
+{
+  GFile *source, *destination;
+  GFileIOStream *iostream;
+  GError *error = NULL;
+  goffset last_progress = 0;
+  gchar *contents, *copied;
+  gsize size, copied_size, i;
+
+  /* Large enough to need several chunks on every copy path */
+  size = 3 * 1024 * 1024 + 17;
+  contents = g_malloc (size);
+  for (i = 0; i < size; i++)
+    contents[i] = i * 7 + (i >> 12);
+
+  source = g_file_new_tmp ("g_file_copy_XXXXXX", &iostream, &error);
+  g_assert_no_error (error);
+  g_object_unref (iostream);
+  g_file_replace_contents (source, contents, size, NULL, FALSE,
+                           G_FILE_CREATE_NONE, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  destination = g_file_new_tmp ("g_file_copy_XXXXXX", &iostream, &error);
+  g_assert_no_error (error);
+  g_object_unref (iostream);
+
+  g_file_copy (source, destination, G_FILE_COPY_OVERWRITE, NULL,
+               copy_progress, &last_progress, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (last_progress, ==, size);
+
+  g_file_load_contents (destination, NULL, &copied, &copied_size, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpmem (copied, copied_size, contents, size);
+
+  (void) g_file_delete (source, NULL, NULL);
+  (void) g_file_delete (destination, NULL, NULL);
+
+  g_free (copied);
+  g_free (contents);
+  g_object_unref (source);
+  g_object_unref (destination);
+}
+
 static gchar *
 splice_to_string (GInputStream   *stream,
                   GError        **error)
@@ -1043,6 +1101,464 @@ test_measure_async (void)
                                    measure_done, data);
 }
 
+static void
+tree_progress (goffset  current_num_bytes,
+               goffset  total_num_bytes,
+               gpointer user_data)
+{
+  goffset *last = user_data;
+
+  g_assert_cmpint (current_num_bytes, >=, *last);
+  g_assert_cmpint (current_num_bytes, <=, total_num_bytes);
+  *last = current_num_bytes;
+}
+
+static void
+assert_same_tree (GFile *source,
+                  GFile *copy)
+{
+  guint64 source_bytes, source_dirs, source_files;
+  guint64 copy_bytes, copy_dirs, copy_files;
+  GFileInfo *source_info, *copy_info;
+  GFile *source_child, *copy_child;
+  GError *error = NULL;
+
+  g_file_measure_disk_usage (source, G_FILE_MEASURE_APPARENT_SIZE, NULL, NULL, NULL,
+                             &source_bytes, &source_dirs, &source_files, &error);
+  g_assert_no_error (error);
+  g_file_measure_disk_usage (copy, G_FILE_MEASURE_APPARENT_SIZE, NULL, NULL, NULL,
+                             &copy_bytes, &copy_dirs, &copy_files, &error);
+  g_assert_no_error (error);
+
+  g_assert_cmpuint (copy_dirs, ==, source_dirs);
+  g_assert_cmpuint (copy_files, ==, source_files);
+
+  /* Directory attributes are applied after their contents are copied */
+  source_child = g_file_get_child (source, "usr");
+  copy_child = g_file_get_child (copy, "usr");
+  source_info = g_file_query_info (source_child, G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                                   G_FILE_QUERY_INFO_NONE, NULL, &error);
+  g_assert_no_error (error);
+  copy_info = g_file_query_info (copy_child, G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                                 G_FILE_QUERY_INFO_NONE, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_file_info_get_attribute_uint64 (copy_info, G_FILE_ATTRIBUTE_TIME_MODIFIED), ==,
+                    g_file_info_get_attribute_uint64 (source_info, G_FILE_ATTRIBUTE_TIME_MODIFIED));
+
+  g_object_unref (source_info);
+  g_object_unref (copy_info);
+  g_object_unref (source_child);
+  g_object_unref (copy_child);
+}
+
+static void
+test_copy_tree (void)
+{
+  GFile *source, *tmpdir, *copy;
+  GError *error = NULL;
+  goffset last_progress = 0;
+  gchar *path;
+  gboolean ok;
+
+  path = g_test_build_filename (G_TEST_DIST, "desktop-files", NULL);
+  source = g_file_new_for_path (path);
+  g_free (path);
+
+  path = g_dir_make_tmp ("g_file_copy_tree_XXXXXX", &error);
+  g_assert_no_error (error);
+  tmpdir = g_file_new_for_path (path);
+  g_free (path);
+  copy = g_file_get_child (tmpdir, "copy");
+
+  ok = g_file_copy_tree (source, copy, G_FILE_COPY_ALL_METADATA, 4, NULL,
+                         tree_progress, &last_progress, &error);
+  g_assert_no_error (error);
+  g_assert_true (ok);
+  g_assert_cmpint (last_progress, >, 0);
+
+  assert_same_tree (source, copy);
+
+  /* Copying onto an existing tree needs OVERWRITE... */
+  ok = g_file_copy_tree (source, copy, G_FILE_COPY_NONE, 4, NULL, NULL, NULL, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_EXISTS);
+  g_assert_false (ok);
+  g_clear_error (&error);
+
+  /* ...which merges into it */
+  ok = g_file_copy_tree (source, copy, G_FILE_COPY_OVERWRITE | G_FILE_COPY_ALL_METADATA,
+                         0, NULL, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (ok);
+  assert_same_tree (source, copy);
+
+  ok = g_file_delete_tree (tmpdir, 4, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (ok);
+  g_assert_false (g_file_query_exists (tmpdir, NULL));
+
+  /* Deleting a missing file reports the same error as g_file_delete() */
+  ok = g_file_delete_tree (tmpdir, 4, NULL, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+  g_assert_false (ok);
+  g_clear_error (&error);
+
+  g_object_unref (copy);
+  g_object_unref (tmpdir);
+  g_object_unref (source);
+}
+
+typedef struct {
+  GMainLoop *loop;
+  GFile *source;
+  GFile *tmpdir;
+  goffset last_progress;
+} CopyTreeData;
+
+static void
+delete_tree_done (GObject      *object,
+                  GAsyncResult *res,
+                  gpointer      user_data)
+{
+  CopyTreeData *data = user_data;
+  GError *error = NULL;
+
+  g_assert_true (g_file_delete_tree_finish (G_FILE (object), res, &error));
+  g_assert_no_error (error);
+  g_assert_false (g_file_query_exists (data->tmpdir, NULL));
+
+  g_main_loop_quit (data->loop);
+}
+
+static void
+copy_tree_done (GObject      *object,
+                GAsyncResult *res,
+                gpointer      user_data)
+{
+  CopyTreeData *data = user_data;
+  GError *error = NULL;
+  GFile *copy;
+
+  g_assert_true (g_file_copy_tree_finish (G_FILE (object), res, &error));
+  g_assert_no_error (error);
+  g_assert_cmpint (data->last_progress, >, 0);
+
+  copy = g_file_get_child (data->tmpdir, "copy");
+  assert_same_tree (data->source, copy);
+  g_object_unref (copy);
+
+  g_file_delete_tree_async (data->tmpdir, 0, G_PRIORITY_DEFAULT, NULL,
+                            delete_tree_done, data);
+}
+
+static void
+test_copy_tree_async (void)
+{
+  CopyTreeData data = { 0, };
+  GError *error = NULL;
+  GFile *copy;
+  gchar *path;
+
+  path = g_test_build_filename (G_TEST_DIST, "desktop-files", NULL);
+  data.source = g_file_new_for_path (path);
+  g_free (path);
+
+  path = g_dir_make_tmp ("g_file_copy_tree_XXXXXX", &error);
+  g_assert_no_error (error);
+  data.tmpdir = g_file_new_for_path (path);
+  g_free (path);
+
+  data.loop = g_main_loop_new (NULL, FALSE);
+
+  copy = g_file_get_child (data.tmpdir, "copy");
+  g_file_copy_tree_async (data.source, copy, G_FILE_COPY_ALL_METADATA, 0,
+                          G_PRIORITY_DEFAULT, NULL,
+                          tree_progress, &data.last_progress,
+                          copy_tree_done, &data);
+  g_object_unref (copy);
+
+  g_main_loop_run (data.loop);
+
+  g_main_loop_unref (data.loop);
+  g_object_unref (data.tmpdir);
+  g_object_unref (data.source);
+}
+
+/* Enough entries for several of GLocalFileEnumerator's chunks, so they
+ * get looked up in parallel when a stat() is needed.
+ */
+#define N_ENUMERATE_FILES 2500
+
+static void
+check_enumerate_large (GFile       *dir,
+                       const gchar *attributes,
+                       gboolean     check_size)
+{
+  GFileEnumerator *enumerator;
+  GFileInfo *info;
+  GError *error = NULL;
+  guint8 *seen;
+  guint n_seen = 0;
+
+  enumerator = g_file_enumerate_children (dir, attributes,
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                          NULL, &error);
+  g_assert_no_error (error);
+
+  seen = g_new0 (guint8, N_ENUMERATE_FILES);
+  while ((info = g_file_enumerator_next_file (enumerator, NULL, &error)) != NULL)
+    {
+      guint64 i;
+
+      i = g_ascii_strtoull (g_file_info_get_name (info), NULL, 10);
+      g_assert_cmpuint (i, <, N_ENUMERATE_FILES);
+      g_assert_cmpint (seen[i], ==, 0);
+      seen[i] = 1;
+      n_seen++;
+
+      g_assert_cmpint (g_file_info_get_file_type (info), ==, G_FILE_TYPE_REGULAR);
+      if (check_size)
+        g_assert_cmpint (g_file_info_get_size (info), ==, i % 7);
+
+      g_object_unref (info);
+    }
+  g_assert_no_error (error);
+  g_assert_cmpuint (n_seen, ==, N_ENUMERATE_FILES);
+
+  g_free (seen);
+  g_object_unref (enumerator);
+}
+
+static void
+check_enumerate_info_list (GFile       *dir,
+                           const gchar *attributes,
+                           gboolean     check_size)
+{
+  GFileEnumerator *enumerator;
+  GFileInfoList *list;
+  GError *error = NULL;
+  guint8 *seen;
+  guint n_seen = 0;
+
+  enumerator = g_file_enumerate_children (dir, attributes,
+                                          G_FILE_QUERY_INFO_NONE,
+                                          NULL, &error);
+  g_assert_no_error (error);
+
+  seen = g_new0 (guint8, N_ENUMERATE_FILES);
+  while ((list = g_file_enumerator_next_info_list (enumerator, 300, NULL, &error)) != NULL)
+    {
+      guint j;
+
+      g_assert_cmpuint (g_file_info_list_get_length (list), >, 0);
+      g_assert_cmpuint (g_file_info_list_get_length (list), <=, 300);
+
+      for (j = 0; j < g_file_info_list_get_length (list); j++)
+        {
+          GFileInfo *info;
+          guint64 i;
+
+          i = g_ascii_strtoull (g_file_info_list_get_name (list, j), NULL, 10);
+          g_assert_cmpuint (i, <, N_ENUMERATE_FILES);
+          g_assert_cmpint (seen[i], ==, 0);
+          seen[i] = 1;
+          n_seen++;
+
+          g_assert_cmpint (g_file_info_list_get_file_type (list, j), ==, G_FILE_TYPE_REGULAR);
+
+          info = g_file_info_list_get_info (list, j);
+          g_assert_cmpstr (g_file_info_get_name (info), ==, g_file_info_list_get_name (list, j));
+          g_assert_cmpint (g_file_info_get_file_type (info), ==, G_FILE_TYPE_REGULAR);
+          g_assert_cmpint (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_SIZE), ==, check_size);
+          g_assert_cmpint (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_TIME_MODIFIED), ==, check_size);
+          g_assert_false (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_UNIX_MODE));
+          g_object_unref (info);
+
+          if (check_size)
+            {
+              g_assert_cmpint (g_file_info_list_get_size (list, j), ==, i % 7);
+              g_assert_cmpint (g_file_info_list_get_modification_time (list, j), >, 0);
+            }
+        }
+
+      g_file_info_list_unref (list);
+    }
+  g_assert_no_error (error);
+  g_assert_cmpuint (n_seen, ==, N_ENUMERATE_FILES);
+
+  g_free (seen);
+  g_object_unref (enumerator);
+}
+
+static void
+test_enumerate_large (void)
+{
+  GFile *dir;
+  GError *error = NULL;
+  gchar *path;
+  gboolean ok;
+  guint i;
+
+  path = g_dir_make_tmp ("g_file_enumerate_XXXXXX", &error);
+  g_assert_no_error (error);
+  dir = g_file_new_for_path (path);
+
+  for (i = 0; i < N_ENUMERATE_FILES; i++)
+    {
+      gchar name[16];
+      gchar *filename;
+
+      g_snprintf (name, sizeof name, "%u", i);
+      filename = g_build_filename (path, name, NULL);
+      ok = g_file_set_contents (filename, "0123456", i % 7, &error);
+      g_assert_no_error (error);
+      g_assert_true (ok);
+      g_free (filename);
+    }
+  g_free (path);
+
+  /* Name and type only come from the directory entries where possible */
+  check_enumerate_large (dir, G_FILE_ATTRIBUTE_STANDARD_NAME ","
+                         G_FILE_ATTRIBUTE_STANDARD_TYPE, FALSE);
+  /* The size needs a stat() for each entry */
+  check_enumerate_large (dir, G_FILE_ATTRIBUTE_STANDARD_NAME ","
+                         G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                         G_FILE_ATTRIBUTE_STANDARD_SIZE, TRUE);
+
+  check_enumerate_info_list (dir, G_FILE_ATTRIBUTE_STANDARD_NAME ","
+                             G_FILE_ATTRIBUTE_STANDARD_TYPE, FALSE);
+  check_enumerate_info_list (dir, G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                             G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                             G_FILE_ATTRIBUTE_TIME_MODIFIED, TRUE);
+
+  ok = g_file_delete_tree (dir, 0, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (ok);
+  g_object_unref (dir);
+}
+
+static void
+test_read_mapped (void)
+{
+  GFile *file;
+  GFileIOStream *iostream;
+  GFileInputStream *in;
+  GError *error = NULL;
+  GBytes *bytes;
+  gchar buf[8];
+  gssize n;
+  gboolean ok;
+
+  file = g_file_new_tmp ("g_file_read_mapped_XXXXXX", &iostream, &error);
+  g_assert_no_error (error);
+  g_object_unref (iostream);
+
+  ok = g_file_replace_contents (file, "0123456789", 10, NULL, FALSE, 0,
+                                NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (ok);
+
+  in = g_file_read_mapped (file, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (g_seekable_can_seek (G_SEEKABLE (in)));
+
+  n = g_input_stream_read (G_INPUT_STREAM (in), buf, 3, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 3);
+  g_assert_true (memcmp (buf, "012", 3) == 0);
+  g_assert_cmpint (g_seekable_tell (G_SEEKABLE (in)), ==, 3);
+
+  n = g_input_stream_skip (G_INPUT_STREAM (in), 2, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 2);
+
+  /* read_bytes() is clamped to the end of the file */
+  bytes = g_input_stream_read_bytes (G_INPUT_STREAM (in), 100, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpmem (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes), "56789", 5);
+  g_bytes_unref (bytes);
+
+  bytes = g_input_stream_read_bytes (G_INPUT_STREAM (in), 100, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, 0);
+  g_bytes_unref (bytes);
+
+  ok = g_seekable_seek (G_SEEKABLE (in), -4, G_SEEK_END, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (ok);
+  n = g_input_stream_read (G_INPUT_STREAM (in), buf, sizeof buf, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 4);
+  g_assert_true (memcmp (buf, "6789", 4) == 0);
+
+  ok = g_seekable_seek (G_SEEKABLE (in), -1, G_SEEK_SET, NULL, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+  g_assert_false (ok);
+  g_clear_error (&error);
+
+  /* Seeking past the end is allowed, as with lseek() */
+  ok = g_seekable_seek (G_SEEKABLE (in), 20, G_SEEK_SET, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (ok);
+  n = g_input_stream_read (G_INPUT_STREAM (in), buf, sizeof buf, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 0);
+
+  g_object_unref (in);
+
+  ok = g_file_delete (file, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (ok);
+  g_object_unref (file);
+}
+
+#ifdef G_OS_UNIX
+static void
+test_read_mapped_fifo (void)
+{
+  GFile *file;
+  GFileInputStream *in;
+  GError *error = NULL;
+  gchar *dir;
+  gchar *path;
+  gchar buf[8];
+  gssize n;
+  FILE *writer;
+
+  dir = g_dir_make_tmp ("g_file_read_mapped_XXXXXX", &error);
+  g_assert_no_error (error);
+  path = g_build_filename (dir, "fifo", NULL);
+  g_assert_cmpint (mkfifo (path, 0600), ==, 0);
+
+  /* Opening a FIFO for writing blocks until there is a reader, so
+   * keep a read-write handle open while the stream is created
+   */
+  writer = fopen (path, "r+");
+  g_assert_nonnull (writer);
+
+  file = g_file_new_for_path (path);
+  in = g_file_read_mapped (file, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_false (g_seekable_can_seek (G_SEEKABLE (in)));
+
+  fputs ("data", writer);
+  fflush (writer);
+
+  n = g_input_stream_read (G_INPUT_STREAM (in), buf, sizeof buf, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 4);
+  g_assert_true (memcmp (buf, "data", 4) == 0);
+
+  g_object_unref (in);
+  fclose (writer);
+  g_object_unref (file);
+
+  g_unlink (path);
+  g_rmdir (dir);
+  g_free (path);
+  g_free (dir);
+}
+#endif
+
 int
 main (int argc, char *argv[])
 {
@@ -1066,8 +1582,16 @@ main (int argc, char *argv[])
 #ifdef G_OS_UNIX
   g_test_add_func ("/file/copy-preserve-mode", test_copy_preserve_mode);
 #endif
+  g_test_add_func ("/file/copy-contents", test_copy_contents);
   g_test_add_func ("/file/measure", test_measure);
   g_test_add_func ("/file/measure-async", test_measure_async);
+  g_test_add_func ("/file/copy-tree", test_copy_tree);
+  g_test_add_func ("/file/copy-tree-async", test_copy_tree_async);
+  g_test_add_func ("/file/enumerate-large", test_enumerate_large);
+  g_test_add_func ("/file/read-mapped", test_read_mapped);
+#ifdef G_OS_UNIX
+  g_test_add_func ("/file/read-mapped-fifo", test_read_mapped_fifo);
+#endif
 
   return g_test_run ();
 }
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <glib/gstdio.h>
 
 #include "gdbus-tests.h"
 #include "gdbus-sessionbus.h"
@@ -940,6 +941,133 @@ test_handle_local_options_passthrough (void)
   g_test_trap_assert_passed ();
 }
 
+/* Test that G_APPLICATION_PEER_SOCKET lets a remote instance reach the
+ * primary through a socket in a private directory.
+ */
+static gboolean peer_activated;
+static gboolean peer_action_activated;
+
+static void
+peer_activate (GApplication *app)
+{
+  peer_activated = TRUE;
+}
+
+static void
+peer_action_activate (GSimpleAction *action,
+                      GVariant      *parameter,
+                      gpointer       user_data)
+{
+  peer_action_activated = TRUE;
+}
+
+static gpointer
+peer_remote_thread (gpointer data)
+{
+  GMainContext *context;
+  GApplication *app;
+  GError *error = NULL;
+
+  context = g_main_context_new ();
+  g_main_context_push_thread_default (context);
+
+  app = g_application_new ("org.gtk.TestApplication.Peer", G_APPLICATION_PEER_SOCKET);
+  g_application_register (app, NULL, &error);
+  g_assert_no_error (error);
+  g_assert (g_application_get_is_remote (app));
+
+  /* the session bus connection is still there, even if it isn't used */
+  g_assert (g_application_get_dbus_connection (app) != NULL);
+
+  g_assert (g_action_group_has_action (G_ACTION_GROUP (app), "peer"));
+  g_action_group_activate_action (G_ACTION_GROUP (app), "peer", NULL);
+  g_application_activate (app);
+
+  g_object_unref (app);
+
+  g_main_context_pop_thread_default (context);
+  g_main_context_unref (context);
+
+  return NULL;
+}
+
+static void
+test_peer_socket (void)
+{
+  GApplication *app;
+  GSimpleAction *action;
+  GThread *thread;
+  GError *error = NULL;
+  GStatBuf buf;
+  gchar *runtime_dir;
+  gchar *socket_dir;
+  gchar *socket_path;
+  const gchar *name;
+  GDir *dir;
+
+  session_bus_up ();
+
+  /* after session_bus_up(), which unsets it */
+  runtime_dir = g_dir_make_tmp ("gapplication-peer-XXXXXX", &error);
+  g_assert_no_error (error);
+  g_setenv ("XDG_RUNTIME_DIR", runtime_dir, TRUE);
+  socket_dir = g_build_filename (runtime_dir, "gapplication", NULL);
+
+  /* without the flag, nothing is created */
+  app = g_application_new ("org.gtk.TestApplication.NoPeer", G_APPLICATION_FLAGS_NONE);
+  g_application_register (app, NULL, &error);
+  g_assert_no_error (error);
+  g_assert (!g_file_test (socket_dir, G_FILE_TEST_EXISTS));
+  g_object_unref (app);
+
+  app = g_application_new ("org.gtk.TestApplication.Peer", G_APPLICATION_PEER_SOCKET);
+  g_signal_connect (app, "activate", G_CALLBACK (peer_activate), NULL);
+  action = g_simple_action_new ("peer", NULL);
+  g_signal_connect (action, "activate", G_CALLBACK (peer_action_activate), NULL);
+  g_action_map_add_action (G_ACTION_MAP (app), G_ACTION (action));
+  g_object_unref (action);
+  g_application_register (app, NULL, &error);
+  g_assert_no_error (error);
+  g_assert (!g_application_get_is_remote (app));
+
+  /* the socket is in a directory that only we can access */
+  g_assert_cmpint (g_lstat (socket_dir, &buf), ==, 0);
+  g_assert (S_ISDIR (buf.st_mode));
+  g_assert_cmpuint (buf.st_uid, ==, getuid ());
+  g_assert_cmpint (buf.st_mode & 0777, ==, 0700);
+
+  dir = g_dir_open (socket_dir, 0, &error);
+  g_assert_no_error (error);
+  name = g_dir_read_name (dir);
+  g_assert (name != NULL);
+  socket_path = g_build_filename (socket_dir, name, NULL);
+  g_assert (g_dir_read_name (dir) == NULL);
+  g_dir_close (dir);
+  g_assert_cmpint (g_lstat (socket_path, &buf), ==, 0);
+  g_assert (S_ISSOCK (buf.st_mode));
+
+  peer_activated = FALSE;
+  peer_action_activated = FALSE;
+  thread = g_thread_new ("remote", peer_remote_thread, NULL);
+  while (!peer_activated || !peer_action_activated)
+    g_main_context_iteration (NULL, TRUE);
+  g_thread_join (thread);
+
+  g_object_unref (app);
+
+  /* the primary removes its socket */
+  g_assert (!g_file_test (socket_path, G_FILE_TEST_EXISTS));
+
+  session_bus_down ();
+
+  g_rmdir (socket_dir);
+  g_rmdir (runtime_dir);
+  g_unsetenv ("XDG_RUNTIME_DIR");
+  g_free (socket_path);
+  g_free (socket_dir);
+  g_free (runtime_dir);
+}
+
 static void
 test_api (void)
 {
@@ -988,6 +1116,7 @@ main (int argc, char **argv)
   g_test_add_func ("/gapplication/test-handle-local-options1", test_handle_local_options_success);
   g_test_add_func ("/gapplication/test-handle-local-options2", test_handle_local_options_failure);
   g_test_add_func ("/gapplication/test-handle-local-options3", test_handle_local_options_passthrough);
+  g_test_add_func ("/gapplication/peer-socket", test_peer_socket);
   g_test_add_func ("/gapplication/api", test_api);
 
   return g_test_run ();
@@ -0,0 +1,719 @@
+/* GLib testing framework examples and tests
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Performance tests for GDBus.  Nothing is run unless -m perf is
+ * passed, e.g.
+ *
+ *   ./gdbus-bench -m perf
+ *   ./gdbus-bench -m perf -p /gdbus/bench/peer
+ *
+ * Every test runs for about BENCH_SECONDS and reports its result with
+ * g_test_maximized_result() or g_test_minimized_result(), so the
+ * numbers can be compared between builds.
+ */
+
+#include <gio/gio.h>
+#include <sys/socket.h>
+#include <string.h>
+
+#define BENCH_SECONDS 1
+
+/* how many calls the throughput test keeps in flight */
+#define CALL_WINDOW 64
+
+/* how many subscriptions the client makes for the fan-out test */
+#define N_SUBSCRIBERS 16
+
+static const gchar bench_xml[] =
+  "<node>"
+  "  <interface name='org.gtk.GDBus.Bench'>"
+  "    <method name='Echo'>"
+  "      <arg type='ay' name='data' direction='in'/>"
+  "      <arg type='ay' name='data' direction='out'/>"
+  "    </method>"
+  "    <method name='Emit'>"
+  "      <arg type='u' name='count' direction='in'/>"
+  "    </method>"
+  "    <signal name='Tick'>"
+  "      <arg type='u' name='n'/>"
+  "    </signal>"
+  "  </interface>"
+  "</node>";
+
+static gboolean
+bench_is_done (gint64 start_time)
+{
+  return g_get_monotonic_time () - start_time >= BENCH_SECONDS * G_USEC_PER_SEC;
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+/* Serialisation */
+
+typedef GVariant *(*BodyFunc) (void);
+
+static GVariant *
+body_string (void)
+{
+  return g_variant_new ("(s)", "The quick brown fox jumps over the lazy dog");
+}
+
+static GVariant *
+body_vardict (void)
+{
+  GVariantBuilder builder;
+  guint n;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+  for (n = 0; n < 16; n++)
+    {
+      gchar key[32];
+
+      g_snprintf (key, sizeof key, "Property%u", n);
+      if (n % 2 == 0)
+        g_variant_builder_add (&builder, "{sv}", key, g_variant_new_int32 (n));
+      else
+        g_variant_builder_add (&builder, "{sv}", key, g_variant_new_string (key));
+    }
+
+  return g_variant_new ("(a{sv})", &builder);
+}
+
+static GVariant *
+body_structs (void)
+{
+  GVariantBuilder builder;
+  guint n;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ii)"));
+  for (n = 0; n < 1000; n++)
+    g_variant_builder_add (&builder, "(ii)", n, -n);
+
+  return g_variant_new ("(a(ii))", &builder);
+}
+
+static GVariant *
+body_bytes (void)
+{
+  guint8 *data;
+
+  data = g_malloc0 (64 * 1024);
+
+  return g_variant_new ("(@ay)",
+                        g_variant_new_from_data (G_VARIANT_TYPE_BYTESTRING,
+                                                 data, 64 * 1024, TRUE,
+                                                 g_free, data));
+}
+
+static GDBusMessage *
+new_bench_message (BodyFunc body_func)
+{
+  GDBusMessage *message;
+
+  message = g_dbus_message_new_method_call ("org.gtk.GDBus.BenchService",
+                                            "/org/gtk/GDBus/Bench",
+                                            "org.gtk.GDBus.Bench",
+                                            "Method");
+  g_dbus_message_set_serial (message, 1);
+  g_dbus_message_set_body (message, body_func ());
+
+  return message;
+}
+
+static void
+test_message_serialise (gconstpointer data)
+{
+  BodyFunc body_func = (BodyFunc) data;
+  GDBusMessage *message;
+  gint64 start_time;
+  guint64 count;
+  GError *error = NULL;
+
+  message = new_bench_message (body_func);
+
+  count = 0;
+  start_time = g_get_monotonic_time ();
+  while (!bench_is_done (start_time))
+    {
+      guchar *blob;
+      gsize size;
+
+      blob = g_dbus_message_to_blob (message, &size, G_DBUS_CAPABILITY_FLAGS_NONE, &error);
+      g_assert_no_error (error);
+      g_free (blob);
+      count++;
+    }
+
+  g_test_maximized_result (count / (gdouble) BENCH_SECONDS,
+                           "%.0f messages serialised per second",
+                           count / (gdouble) BENCH_SECONDS);
+
+  g_object_unref (message);
+}
+
+static void
+test_message_deserialise (gconstpointer data)
+{
+  BodyFunc body_func = (BodyFunc) data;
+  GDBusMessage *message;
+  guchar *blob;
+  gsize size;
+  gint64 start_time;
+  guint64 count;
+  GError *error = NULL;
+
+  message = new_bench_message (body_func);
+  blob = g_dbus_message_to_blob (message, &size, G_DBUS_CAPABILITY_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_object_unref (message);
+
+  count = 0;
+  start_time = g_get_monotonic_time ();
+  while (!bench_is_done (start_time))
+    {
+      message = g_dbus_message_new_from_blob (blob, size, G_DBUS_CAPABILITY_FLAGS_NONE, &error);
+      g_assert_no_error (error);
+      /* make sure the body is actually looked at */
+      g_assert (g_dbus_message_get_body (message) != NULL);
+      g_object_unref (message);
+      count++;
+    }
+
+  g_test_maximized_result (count / (gdouble) BENCH_SECONDS,
+                           "%.0f messages deserialised per second",
+                           count / (gdouble) BENCH_SECONDS);
+
+  g_free (blob);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+/* Connections
+ *
+ * The service side runs in its own thread with its own main context,
+ * so that both ends of every exchange are exercised the same way as
+ * between two processes.
+ */
+
+typedef struct
+{
+  gboolean use_bus;
+  GTestDBus *bus;
+
+  GDBusConnection *client;
+  GDBusConnection *server;
+  const gchar *destination;
+
+  GThread *thread;
+  GMainContext *server_context;
+  GMainLoop *server_loop;
+  GIOStream *server_stream;
+
+  GMutex lock;
+  GCond cond;
+  gboolean ready;
+} Fixture;
+
+static void
+on_method_call (GDBusConnection       *connection,
+                const gchar           *sender,
+                const gchar           *object_path,
+                const gchar           *interface_name,
+                const gchar           *method_name,
+                GVariant              *parameters,
+                GDBusMethodInvocation *invocation,
+                gpointer               user_data)
+{
+  if (g_strcmp0 (method_name, "Echo") == 0)
+    {
+      g_dbus_method_invocation_return_value (invocation, g_variant_ref (parameters));
+    }
+  else if (g_strcmp0 (method_name, "Emit") == 0)
+    {
+      guint count;
+      guint n;
+
+      g_variant_get (parameters, "(u)", &count);
+      for (n = 0; n < count; n++)
+        g_dbus_connection_emit_signal (connection,
+                                       NULL,
+                                       "/org/gtk/GDBus/Bench",
+                                       "org.gtk.GDBus.Bench",
+                                       "Tick",
+                                       g_variant_new ("(u)", n),
+                                       NULL);
+      g_dbus_method_invocation_return_value (invocation, NULL);
+    }
+  else
+    g_assert_not_reached ();
+}
+
+static const GDBusInterfaceVTable vtable =
+{
+  on_method_call,
+  NULL,
+  NULL
+};
+
+static gpointer
+server_thread_func (gpointer user_data)
+{
+  Fixture *f = user_data;
+  GDBusNodeInfo *node_info;
+  GError *error = NULL;
+  gchar *guid;
+  guint registration_id;
+
+  g_main_context_push_thread_default (f->server_context);
+
+  if (f->use_bus)
+    {
+      f->server = g_dbus_connection_new_for_address_sync (g_test_dbus_get_bus_address (f->bus),
+                                                          G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                                          G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                                          NULL, NULL, &error);
+    }
+  else
+    {
+      guid = g_dbus_generate_guid ();
+      f->server = g_dbus_connection_new_sync (f->server_stream,
+                                              guid,
+                                              G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_SERVER |
+                                              G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_ALLOW_ANONYMOUS,
+                                              NULL, NULL, &error);
+      g_free (guid);
+    }
+  g_assert_no_error (error);
+
+  node_info = g_dbus_node_info_new_for_xml (bench_xml, &error);
+  g_assert_no_error (error);
+  registration_id = g_dbus_connection_register_object (f->server,
+                                                       "/org/gtk/GDBus/Bench",
+                                                       node_info->interfaces[0],
+                                                       &vtable,
+                                                       NULL, NULL,
+                                                       &error);
+  g_assert_no_error (error);
+  g_dbus_node_info_unref (node_info);
+
+  g_mutex_lock (&f->lock);
+  f->ready = TRUE;
+  g_cond_signal (&f->cond);
+  g_mutex_unlock (&f->lock);
+
+  g_main_loop_run (f->server_loop);
+
+  g_dbus_connection_unregister_object (f->server, registration_id);
+  g_main_context_pop_thread_default (f->server_context);
+
+  return NULL;
+}
+
+static void
+setup (Fixture       *f,
+       gconstpointer  data)
+{
+  GError *error = NULL;
+  GIOStream *client_stream = NULL;
+
+  f->use_bus = GPOINTER_TO_INT (data);
+
+  if (f->use_bus)
+    {
+      gchar *dbus_daemon;
+
+      dbus_daemon = g_find_program_in_path ("dbus-daemon");
+      if (dbus_daemon == NULL)
+        {
+          g_test_skip ("dbus-daemon not available");
+          return;
+        }
+      g_free (dbus_daemon);
+
+      f->bus = g_test_dbus_new (G_TEST_DBUS_NONE);
+      g_test_dbus_up (f->bus);
+    }
+  else
+    {
+      gint fds[2];
+      GSocket *socket;
+
+      g_assert_cmpint (socketpair (AF_UNIX, SOCK_STREAM, 0, fds), ==, 0);
+
+      socket = g_socket_new_from_fd (fds[0], &error);
+      g_assert_no_error (error);
+      f->server_stream = G_IO_STREAM (g_socket_connection_factory_create_connection (socket));
+      g_object_unref (socket);
+
+      socket = g_socket_new_from_fd (fds[1], &error);
+      g_assert_no_error (error);
+      client_stream = G_IO_STREAM (g_socket_connection_factory_create_connection (socket));
+      g_object_unref (socket);
+    }
+
+  g_mutex_init (&f->lock);
+  g_cond_init (&f->cond);
+  f->server_context = g_main_context_new ();
+  f->server_loop = g_main_loop_new (f->server_context, FALSE);
+  f->thread = g_thread_new ("gdbus-bench-server", server_thread_func, f);
+
+  if (f->use_bus)
+    {
+      f->client = g_dbus_connection_new_for_address_sync (g_test_dbus_get_bus_address (f->bus),
+                                                          G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                                          G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                                          NULL, NULL, &error);
+    }
+  else
+    {
+      f->client = g_dbus_connection_new_sync (client_stream,
+                                              NULL,
+                                              G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+                                              NULL, NULL, &error);
+      g_object_unref (client_stream);
+    }
+  g_assert_no_error (error);
+
+  g_mutex_lock (&f->lock);
+  while (!f->ready)
+    g_cond_wait (&f->cond, &f->lock);
+  g_mutex_unlock (&f->lock);
+
+  if (f->use_bus)
+    f->destination = g_dbus_connection_get_unique_name (f->server);
+}
+
+static void
+teardown (Fixture       *f,
+          gconstpointer  data)
+{
+  if (f->thread == NULL)
+    return;
+
+  g_main_loop_quit (f->server_loop);
+  g_thread_join (f->thread);
+
+  g_dbus_connection_close_sync (f->client, NULL, NULL);
+  g_object_unref (f->client);
+  g_dbus_connection_close_sync (f->server, NULL, NULL);
+  g_object_unref (f->server);
+  g_clear_object (&f->server_stream);
+
+  g_main_loop_unref (f->server_loop);
+  g_main_context_unref (f->server_context);
+  g_mutex_clear (&f->lock);
+  g_cond_clear (&f->cond);
+
+  if (f->bus != NULL)
+    {
+      g_test_dbus_down (f->bus);
+      g_object_unref (f->bus);
+    }
+}
+
+static GVariant *
+echo_parameters (gsize size)
+{
+  guint8 *data;
+
+  data = g_malloc0 (size);
+
+  return g_variant_new ("(@ay)",
+                        g_variant_new_from_data (G_VARIANT_TYPE_BYTESTRING,
+                                                 data, size, TRUE,
+                                                 g_free, data));
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
+static void
+test_call_latency (Fixture       *f,
+                   gconstpointer  data)
+{
+  GVariant *parameters;
+  gint64 start_time;
+  gint64 elapsed;
+  guint64 count;
+  GError *error = NULL;
+
+  if (f->thread == NULL)
+    return;
+
+  parameters = g_variant_ref_sink (echo_parameters (16));
+
+  count = 0;
+  start_time = g_get_monotonic_time ();
+  while (!bench_is_done (start_time))
+    {
+      GVariant *result;
+
+      result = g_dbus_connection_call_sync (f->client,
+                                            f->destination,
+                                            "/org/gtk/GDBus/Bench",
+                                            "org.gtk.GDBus.Bench",
+                                            "Echo",
+                                            parameters,
+                                            G_VARIANT_TYPE ("(ay)"),
+                                            G_DBUS_CALL_FLAGS_NONE,
+                                            -1, NULL, &error);
+      g_assert_no_error (error);
+      g_variant_unref (result);
+      count++;
+    }
+  elapsed = g_get_monotonic_time () - start_time;
+
+  g_test_minimized_result (elapsed / (gdouble) count,
+                           "%.1f microseconds per round trip",
+                           elapsed / (gdouble) count);
+
+  g_variant_unref (parameters);
+}
+
+typedef struct
+{
+  Fixture *f;
+  GVariant *parameters;
+  gint64 start_time;
+  guint64 count;
+  guint in_flight;
+  GMainLoop *loop;
+} ThroughputData;
+
+static void start_call (ThroughputData *data);
+
+static void
+on_call_done (GObject      *source,
+              GAsyncResult *res,
+              gpointer      user_data)
+{
+  ThroughputData *data = user_data;
+  GVariant *result;
+  GError *error = NULL;
+
+  result = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), res, &error);
+  g_assert_no_error (error);
+  g_variant_unref (result);
+
+  data->count++;
+  data->in_flight--;
+
+  if (!bench_is_done (data->start_time))
+    start_call (data);
+  else if (data->in_flight == 0)
+    g_main_loop_quit (data->loop);
+}
+
+static void
+start_call (ThroughputData *data)
+{
+  data->in_flight++;
+  g_dbus_connection_call (data->f->client,
+                          data->f->destination,
+                          "/org/gtk/GDBus/Bench",
+                          "org.gtk.GDBus.Bench",
+                          "Echo",
+                          data->parameters,
+                          G_VARIANT_TYPE ("(ay)"),
+                          G_DBUS_CALL_FLAGS_NONE,
+                          -1, NULL,
+                          on_call_done, data);
+}
+
+static void
+test_call_throughput (Fixture       *f,
+                      gconstpointer  user_data)
+{
+  ThroughputData data = { 0, };
+  guint n;
+
+  if (f->thread == NULL)
+    return;
+
+  data.f = f;
+  data.parameters = g_variant_ref_sink (echo_parameters (4096));
+  data.loop = g_main_loop_new (NULL, FALSE);
+
+  data.start_time = g_get_monotonic_time ();
+  for (n = 0; n < CALL_WINDOW; n++)
+    start_call (&data);
+  g_main_loop_run (data.loop);
+
+  g_test_maximized_result (data.count / (gdouble) BENCH_SECONDS,
+                           "%.0f calls per second with %d in flight",
+                           data.count / (gdouble) BENCH_SECONDS, CALL_WINDOW);
+
+  g_main_loop_unref (data.loop);
+  g_variant_unref (data.parameters);
+}
+
+typedef struct
+{
+  guint64 received;
+  guint64 expected;
+  GMainLoop *loop;
+} FanOutData;
+
+static void
+on_tick (GDBusConnection *connection,
+         const gchar     *sender_name,
+         const gchar     *object_path,
+         const gchar     *interface_name,
+         const gchar     *signal_name,
+         GVariant        *parameters,
+         gpointer         user_data)
+{
+  FanOutData *data = user_data;
+
+  data->received++;
+  if (data->received == data->expected)
+    g_main_loop_quit (data->loop);
+}
+
+static void
+test_signal_fan_out (Fixture       *f,
+                     gconstpointer  user_data)
+{
+  FanOutData data = { 0, };
+  guint ids[N_SUBSCRIBERS];
+  gint64 start_time;
+  gint64 elapsed;
+  guint64 total;
+  guint batch;
+  guint n;
+  GError *error = NULL;
+
+  if (f->thread == NULL)
+    return;
+
+  data.loop = g_main_loop_new (NULL, FALSE);
+  for (n = 0; n < N_SUBSCRIBERS; n++)
+    ids[n] = g_dbus_connection_signal_subscribe (f->client,
+                                                 f->destination,
+                                                 "org.gtk.GDBus.Bench",
+                                                 "Tick",
+                                                 "/org/gtk/GDBus/Bench",
+                                                 NULL,
+                                                 G_DBUS_SIGNAL_FLAGS_NONE,
+                                                 on_tick, &data, NULL);
+
+  /* make sure the match rules are in place on the bus */
+  if (f->use_bus)
+    {
+      GVariant *result;
+
+      result = g_dbus_connection_call_sync (f->client,
+                                            "org.freedesktop.DBus",
+                                            "/org/freedesktop/DBus",
+                                            "org.freedesktop.DBus.Peer",
+                                            "Ping",
+                                            NULL, NULL,
+                                            G_DBUS_CALL_FLAGS_NONE,
+                                            -1, NULL, &error);
+      g_assert_no_error (error);
+      g_variant_unref (result);
+    }
+
+  batch = 1000;
+  total = 0;
+  start_time = g_get_monotonic_time ();
+  while (!bench_is_done (start_time))
+    {
+      GVariant *result;
+
+      data.received = 0;
+      data.expected = (guint64) batch * N_SUBSCRIBERS;
+      result = g_dbus_connection_call_sync (f->client,
+                                            f->destination,
+                                            "/org/gtk/GDBus/Bench",
+                                            "org.gtk.GDBus.Bench",
+                                            "Emit",
+                                            g_variant_new ("(u)", batch),
+                                            NULL,
+                                            G_DBUS_CALL_FLAGS_NONE,
+                                            -1, NULL, &error);
+      g_assert_no_error (error);
+      g_variant_unref (result);
+      if (data.received < data.expected)
+        g_main_loop_run (data.loop);
+      total += data.received;
+    }
+  elapsed = g_get_monotonic_time () - start_time;
+
+  g_test_maximized_result (total * G_USEC_PER_SEC / (gdouble) elapsed,
+                           "%.0f signal callbacks per second with %d subscribers",
+                           total * G_USEC_PER_SEC / (gdouble) elapsed, N_SUBSCRIBERS);
+
+  for (n = 0; n < N_SUBSCRIBERS; n++)
+    g_dbus_connection_signal_unsubscribe (f->client, ids[n]);
+  g_main_loop_unref (data.loop);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
+int
+main (int   argc,
+      char *argv[])
+{
+  static const struct
+  {
+    const gchar *name;
+    BodyFunc func;
+  } bodies[] = {
+    { "string", body_string },
+    { "vardict", body_vardict },
+    { "structs", body_structs },
+    { "bytes", body_bytes },
+  };
+  static const gchar * const modes[] = { "peer", "bus" };
+  guint n;
+
+  g_test_init (&argc, &argv, NULL);
+
+  if (!g_test_perf ())
+    return g_test_run ();
+
+  for (n = 0; n < G_N_ELEMENTS (bodies); n++)
+    {
+      gchar *path;
+
+      path = g_strdup_printf ("/gdbus/bench/message/serialise/%s", bodies[n].name);
+      g_test_add_data_func (path, bodies[n].func, test_message_serialise);
+      g_free (path);
+
+      path = g_strdup_printf ("/gdbus/bench/message/deserialise/%s", bodies[n].name);
+      g_test_add_data_func (path, bodies[n].func, test_message_deserialise);
+      g_free (path);
+    }
+
+  for (n = 0; n < G_N_ELEMENTS (modes); n++)
+    {
+      gchar *path;
+
+      path = g_strdup_printf ("/gdbus/bench/%s/call-latency", modes[n]);
+      g_test_add (path, Fixture, GINT_TO_POINTER (n), setup, test_call_latency, teardown);
+      g_free (path);
+
+      path = g_strdup_printf ("/gdbus/bench/%s/call-throughput", modes[n]);
+      g_test_add (path, Fixture, GINT_TO_POINTER (n), setup, test_call_throughput, teardown);
+      g_free (path);
+
+      path = g_strdup_printf ("/gdbus/bench/%s/signal-fan-out", modes[n]);
+      g_test_add (path, Fixture, GINT_TO_POINTER (n), setup, test_signal_fan_out, teardown);
+      g_free (path);
+    }
+
+  return g_test_run ();
+}
@@ -141,6 +141,94 @@ message_copy (void)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+static void
+message_from_bytes (void)
+{
+  GDBusMessageByteOrder byte_orders[] = {
+    G_DBUS_MESSAGE_BYTE_ORDER_LITTLE_ENDIAN,
+    G_DBUS_MESSAGE_BYTE_ORDER_BIG_ENDIAN
+  };
+  GDBusMessageByteOrder host_order;
+  GVariant *body;
+  gchar *big_string;
+  guchar *big_bytes;
+  guint32 *big_words;
+  guint n;
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+  host_order = G_DBUS_MESSAGE_BYTE_ORDER_LITTLE_ENDIAN;
+#else
+  host_order = G_DBUS_MESSAGE_BYTE_ORDER_BIG_ENDIAN;
+#endif
+
+  big_string = g_strnfill (1000, 'x');
+  big_bytes = g_malloc (3000);
+  big_words = g_new (guint32, 1000);
+  for (n = 0; n < 3000; n++)
+    big_bytes[n] = n;
+  for (n = 0; n < 1000; n++)
+    big_words[n] = n * 12345;
+
+  body = g_variant_new ("(@ay@au&s&os@a{sv})",
+                        g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, big_bytes, 3000, 1),
+                        g_variant_new_fixed_array (G_VARIANT_TYPE_UINT32, big_words, 1000, 4),
+                        big_string, "/org/example/Object", "small",
+                        g_variant_new_parsed ("{'big': <%s>, 'small': <'s'>}", big_string));
+  g_variant_ref_sink (body);
+
+  for (n = 0; n < G_N_ELEMENTS (byte_orders); n++)
+    {
+      GDBusMessage *m, *recovered;
+      GError *error;
+      GVariant *child;
+      gconstpointer data;
+      GBytes *bytes;
+      guchar *blob;
+      gsize blob_len;
+
+      m = g_dbus_message_new_signal ("/org/example/Object",
+                                     "org.example.Interface",
+                                     "Signal");
+      g_dbus_message_set_byte_order (m, byte_orders[n]);
+      g_dbus_message_set_body (m, body);
+
+      error = NULL;
+      blob = g_dbus_message_to_blob (m, &blob_len, G_DBUS_CAPABILITY_FLAGS_NONE, &error);
+      g_assert_no_error (error);
+      bytes = g_bytes_new_take (blob, blob_len);
+
+      recovered = g_dbus_message_new_from_bytes (bytes, G_DBUS_CAPABILITY_FLAGS_NONE, &error);
+      g_assert_no_error (error);
+      g_assert (g_variant_equal (g_dbus_message_get_body (recovered), body));
+
+      /* big arrays refer to the blob, unless they had to be swapped */
+      child = g_variant_get_child_value (g_dbus_message_get_body (recovered), 0);
+      data = g_variant_get_data (child);
+      if (byte_orders[n] == host_order)
+        g_assert ((const guchar *) data >= blob && (const guchar *) data < blob + blob_len);
+      g_variant_unref (child);
+
+      /* big strings always do */
+      child = g_variant_get_child_value (g_dbus_message_get_body (recovered), 2);
+      data = g_variant_get_data (child);
+      g_assert ((const guchar *) data >= blob && (const guchar *) data < blob + blob_len);
+      g_variant_unref (child);
+
+      /* and keep it alive */
+      g_bytes_unref (bytes);
+      g_object_unref (m);
+      g_assert (g_variant_equal (g_dbus_message_get_body (recovered), body));
+      g_object_unref (recovered);
+    }
+
+  g_variant_unref (body);
+  g_free (big_words);
+  g_free (big_bytes);
+  g_free (big_string);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
 int
 main (int   argc,
       char *argv[])
@@ -151,6 +239,7 @@ main (int   argc,
 
   g_test_add_func ("/gdbus/message/lock", message_lock);
   g_test_add_func ("/gdbus/message/copy", message_copy);
+  g_test_add_func ("/gdbus/message/from-bytes", message_from_bytes);
   return g_test_run();
 }
 
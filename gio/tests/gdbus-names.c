@@ -714,6 +714,126 @@ test_bus_watch_name (void)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+typedef struct
+{
+  GHashTable *state;    /* name -> "appeared" or "vanished" */
+  guint num_calls;
+  guint num_free_func;
+} WatchNamesData;
+
+static void
+names_appeared_handler (GDBusConnection *connection,
+                        const gchar     *name,
+                        const gchar     *name_owner,
+                        gpointer         user_data)
+{
+  WatchNamesData *data = user_data;
+
+  g_assert (connection != NULL);
+  g_assert (g_dbus_is_unique_name (name_owner));
+  g_assert_cmpstr (g_hash_table_lookup (data->state, name), !=, "appeared");
+  g_hash_table_insert (data->state, g_strdup (name), "appeared");
+  data->num_calls++;
+}
+
+static void
+names_vanished_handler (GDBusConnection *connection,
+                        const gchar     *name,
+                        gpointer         user_data)
+{
+  WatchNamesData *data = user_data;
+
+  g_assert_cmpstr (g_hash_table_lookup (data->state, name), !=, "vanished");
+  g_hash_table_insert (data->state, g_strdup (name), "vanished");
+  data->num_calls++;
+}
+
+static void
+watch_names_data_free_func (WatchNamesData *data)
+{
+  data->num_free_func++;
+}
+
+static void
+test_bus_watch_names (void)
+{
+  const gchar *names[] = {
+    "org.gtk.GDBus.Name1",
+    "org.gtk.GDBus.Name2",
+    "org.gtk.GDBus.Name1",      /* duplicates are ignored */
+    "org.gtk.GDBus.Other.Name",
+    NULL
+  };
+  GDBusConnection *connection;
+  WatchNamesData data;
+  GVariant *result;
+  guint id;
+
+  session_bus_up ();
+
+  connection = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, NULL);
+  g_assert (connection != NULL);
+  g_dbus_connection_set_exit_on_close (connection, FALSE);
+
+  result = g_dbus_connection_call_sync (connection,
+                                        "org.freedesktop.DBus", "/org/freedesktop/DBus", "org.freedesktop.DBus",
+                                        "RequestName", g_variant_new ("(su)", "org.gtk.GDBus.Name1", 0),
+                                        G_VARIANT_TYPE ("(u)"), G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL);
+  g_assert (result != NULL);
+  g_variant_unref (result);
+
+  data.state = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  data.num_calls = 0;
+  data.num_free_func = 0;
+  id = g_bus_watch_names_on_connection (connection,
+                                        names,
+                                        G_BUS_NAME_WATCHER_FLAGS_NONE,
+                                        names_appeared_handler,
+                                        names_vanished_handler,
+                                        &data,
+                                        (GDestroyNotify) watch_names_data_free_func);
+  g_assert_cmpuint (id, >, 0);
+
+  while (data.num_calls < 3)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_cmpuint (g_hash_table_size (data.state), ==, 3);
+  g_assert_cmpstr (g_hash_table_lookup (data.state, "org.gtk.GDBus.Name1"), ==, "appeared");
+  g_assert_cmpstr (g_hash_table_lookup (data.state, "org.gtk.GDBus.Name2"), ==, "vanished");
+  g_assert_cmpstr (g_hash_table_lookup (data.state, "org.gtk.GDBus.Other.Name"), ==, "vanished");
+
+  /* changes are dispatched to the right name */
+  result = g_dbus_connection_call_sync (connection,
+                                        "org.freedesktop.DBus", "/org/freedesktop/DBus", "org.freedesktop.DBus",
+                                        "RequestName", g_variant_new ("(su)", "org.gtk.GDBus.Name2", 0),
+                                        G_VARIANT_TYPE ("(u)"), G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL);
+  g_assert (result != NULL);
+  g_variant_unref (result);
+  result = g_dbus_connection_call_sync (connection,
+                                        "org.freedesktop.DBus", "/org/freedesktop/DBus", "org.freedesktop.DBus",
+                                        "ReleaseName", g_variant_new ("(s)", "org.gtk.GDBus.Name1"),
+                                        G_VARIANT_TYPE ("(u)"), G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL);
+  g_assert (result != NULL);
+  g_variant_unref (result);
+
+  while (data.num_calls < 5)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_cmpstr (g_hash_table_lookup (data.state, "org.gtk.GDBus.Name1"), ==, "vanished");
+  g_assert_cmpstr (g_hash_table_lookup (data.state, "org.gtk.GDBus.Name2"), ==, "appeared");
+  g_assert_cmpstr (g_hash_table_lookup (data.state, "org.gtk.GDBus.Other.Name"), ==, "vanished");
+
+  g_bus_unwatch_name (id);
+  while (data.num_free_func == 0)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_cmpuint (data.num_calls, ==, 5);
+
+  g_hash_table_unref (data.state);
+  g_object_unref (connection);
+
+  session_bus_down ();
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
 static void
 test_validate_names (void)
 {
@@ -779,6 +899,7 @@ main (int   argc,
   g_test_add_func ("/gdbus/validate-names", test_validate_names);
   g_test_add_func ("/gdbus/bus-own-name", test_bus_own_name);
   g_test_add_func ("/gdbus/bus-watch-name", test_bus_watch_name);
+  g_test_add_func ("/gdbus/bus-watch-names", test_bus_watch_names);
 
   ret = g_test_run();
 
@@ -25,7 +25,11 @@
 
 #include "gdbus-tests.h"
 
+#ifdef TEST_CODEGEN_FAST_MARSHALLING
+#include "gdbus-test-codegen-fast-generated.h"
+#else
 #include "gdbus-test-codegen-generated.h"
+#endif
 
 /* ---------------------------------------------------------------------------------------------------- */
 
@@ -1857,8 +1861,9 @@ check_object_manager (void)
 
   /* Check that the manager object is visible */
   info = introspect (c, g_dbus_connection_get_unique_name (c), "/managed", loop);
-  g_assert_cmpint (count_interfaces (info), ==, 4); /* ObjectManager + Properties,Introspectable,Peer */
+  g_assert_cmpint (count_interfaces (info), ==, 5); /* ObjectManager,PagedObjectManager + Properties,Introspectable,Peer */
   g_assert (has_interface (info, "org.freedesktop.DBus.ObjectManager"));
+  g_assert (has_interface (info, "org.gtk.GDBus.PagedObjectManager"));
   g_assert_cmpint (count_nodes (info), ==, 0);
   g_dbus_node_info_unref (info);
 
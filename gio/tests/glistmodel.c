@@ -216,6 +216,236 @@ test_store_sorted (void)
   g_object_unref (store);
 }
 
+/* Keeps a copy of a model up to date using only #GListModel::items-changed,
+ * to check that the signal describes the changes correctly.
+ */
+static void
+mirror_items_changed (GListModel *model,
+                      guint       position,
+                      guint       removed,
+                      guint       added,
+                      gpointer    user_data)
+{
+  GPtrArray *mirror = user_data;
+  guint i;
+
+  g_assert_cmpuint (position + removed, <=, mirror->len);
+
+  g_ptr_array_remove_range (mirror, position, removed);
+  for (i = 0; i < added; i++)
+    g_ptr_array_insert (mirror, position + i, g_list_model_get_item (model, position + i));
+
+  g_assert_cmpuint (mirror->len, ==, g_list_model_get_n_items (model));
+}
+
+static void
+assert_same_items (GListModel *model,
+                   GPtrArray  *items)
+{
+  guint i;
+
+  g_assert_cmpuint (g_list_model_get_n_items (model), ==, items->len);
+
+  for (i = 0; i < items->len; i++)
+    {
+      GObject *item = g_list_model_get_item (model, i);
+
+      g_assert (item == g_ptr_array_index (items, i));
+      g_object_unref (item);
+    }
+}
+
+static GPtrArray *
+get_all_items (GListModel *model)
+{
+  GPtrArray *items;
+  guint i;
+
+  items = g_ptr_array_new_with_free_func (g_object_unref);
+  for (i = 0; i < g_list_model_get_n_items (model); i++)
+    g_ptr_array_add (items, g_list_model_get_item (model, i));
+
+  return items;
+}
+
+static GObject *
+make_keyed_object (void)
+{
+  GObject *obj;
+
+  obj = g_object_new (G_TYPE_OBJECT, NULL);
+  g_object_set_data_full (obj, "key", make_random_string (), g_free);
+
+  return obj;
+}
+
+static void
+test_store_splice_order (gconstpointer data)
+{
+  gboolean indexed = GPOINTER_TO_INT (data);
+  GListStore *store;
+  GObject *items[5];
+  GObject *item;
+  guint i;
+
+  store = indexed ? g_list_store_new_indexed (G_TYPE_OBJECT) : g_list_store_new (G_TYPE_OBJECT);
+
+  for (i = 0; i < G_N_ELEMENTS (items); i++)
+    items[i] = g_object_new (G_TYPE_OBJECT, NULL);
+
+  g_list_store_append (store, items[0]);
+  g_list_store_append (store, items[4]);
+  g_list_store_splice (store, 1, 0, (gpointer *) items + 1, 3);
+
+  for (i = 0; i < G_N_ELEMENTS (items); i++)
+    {
+      item = g_list_model_get_item (G_LIST_MODEL (store), i);
+      g_assert (item == items[i]);
+      g_object_unref (item);
+    }
+
+  g_object_unref (store);
+  for (i = 0; i < G_N_ELEMENTS (items); i++)
+    g_object_unref (items[i]);
+}
+
+static void
+test_store_indexed (void)
+{
+  GListStore *stores[2];
+  GPtrArray *mirrors[2];
+  GPtrArray *items;
+  gboolean indexed;
+  guint round;
+  guint s;
+
+  stores[0] = g_list_store_new (G_TYPE_OBJECT);
+  stores[1] = g_list_store_new_indexed (G_TYPE_OBJECT);
+
+  g_object_get (stores[1], "indexed", &indexed, NULL);
+  g_assert_true (indexed);
+
+  for (s = 0; s < 2; s++)
+    {
+      mirrors[s] = g_ptr_array_new_with_free_func (g_object_unref);
+      g_signal_connect (stores[s], "items-changed", G_CALLBACK (mirror_items_changed), mirrors[s]);
+    }
+
+  /* Apply the same random changes to both kinds of store, sometimes
+   * batching them, and check that they agree and report the changes
+   * correctly.
+   */
+  for (round = 0; round < 200; round++)
+    {
+      gboolean frozen = g_test_rand_bit ();
+      guint n_changes = g_test_rand_int_range (1, 8);
+      guint c;
+
+      if (frozen)
+        for (s = 0; s < 2; s++)
+          g_list_store_freeze_items_changed (stores[s]);
+
+      for (c = 0; c < n_changes; c++)
+        {
+          guint n_items = g_list_model_get_n_items (G_LIST_MODEL (stores[0]));
+          GObject *additions[10];
+          guint n_additions = g_test_rand_int_range (1, G_N_ELEMENTS (additions));
+          guint position = g_test_rand_int_range (0, n_items + 1);
+          guint n_removals = g_test_rand_int_range (0, MIN (n_items - position, 5) + 1);
+          guint i;
+
+          for (i = 0; i < n_additions; i++)
+            additions[i] = make_keyed_object ();
+
+          switch (g_test_rand_int_range (0, 4))
+            {
+            case 0:
+              for (s = 0; s < 2; s++)
+                g_list_store_splice (stores[s], position, n_removals, (gpointer *) additions, n_additions);
+              break;
+
+            case 1:
+              if (position == n_items)
+                break;
+              for (s = 0; s < 2; s++)
+                g_list_store_remove (stores[s], position);
+              break;
+
+            case 2:
+              for (s = 0; s < 2; s++)
+                g_list_store_insert (stores[s], position, additions[0]);
+              break;
+
+            case 3:
+              for (s = 0; s < 2; s++)
+                {
+                  g_list_store_sort (stores[s], compare_items, GUINT_TO_POINTER (0x1234u));
+                  g_list_store_insert_sorted (stores[s], additions[0],
+                                              compare_items, GUINT_TO_POINTER (0x1234u));
+                  g_list_store_merge_sorted (stores[s], (gpointer *) additions + 1, n_additions - 1,
+                                             compare_items, GUINT_TO_POINTER (0x1234u));
+                }
+              break;
+            }
+
+          items = get_all_items (G_LIST_MODEL (stores[0]));
+          assert_same_items (G_LIST_MODEL (stores[1]), items);
+          g_ptr_array_unref (items);
+
+          for (i = 0; i < n_additions; i++)
+            g_object_unref (additions[i]);
+        }
+
+      if (frozen)
+        for (s = 0; s < 2; s++)
+          g_list_store_thaw_items_changed (stores[s]);
+
+      for (s = 0; s < 2; s++)
+        assert_same_items (G_LIST_MODEL (stores[s]), mirrors[s]);
+    }
+
+  for (s = 0; s < 2; s++)
+    {
+      g_object_unref (stores[s]);
+      g_ptr_array_unref (mirrors[s]);
+    }
+}
+
+static void
+test_store_freeze (void)
+{
+  GListStore *store;
+  GPtrArray *mirror;
+  GObject *items[3];
+  guint i;
+
+  store = g_list_store_new (G_TYPE_OBJECT);
+  mirror = g_ptr_array_new_with_free_func (g_object_unref);
+  g_signal_connect (store, "items-changed", G_CALLBACK (mirror_items_changed), mirror);
+
+  for (i = 0; i < G_N_ELEMENTS (items); i++)
+    items[i] = g_object_new (G_TYPE_OBJECT, NULL);
+
+  g_list_store_freeze_items_changed (store);
+  g_list_store_freeze_items_changed (store);
+  for (i = 0; i < G_N_ELEMENTS (items); i++)
+    g_list_store_append (store, items[i]);
+  g_list_store_remove (store, 1);
+  g_list_store_thaw_items_changed (store);
+
+  /* nothing is emitted until the last thaw */
+  g_assert_cmpuint (mirror->len, ==, 0);
+
+  g_list_store_thaw_items_changed (store);
+  assert_same_items (G_LIST_MODEL (store), mirror);
+  g_assert_cmpuint (mirror->len, ==, 2);
+
+  g_object_unref (store);
+  g_ptr_array_unref (mirror);
+  for (i = 0; i < G_N_ELEMENTS (items); i++)
+    g_object_unref (items[i]);
+}
+
 int main (int argc, char *argv[])
 {
   g_test_init (&argc, &argv, NULL);
@@ -223,6 +453,10 @@ int main (int argc, char *argv[])
   g_test_add_func ("/glistmodel/store/boundaries", test_store_boundaries);
   g_test_add_func ("/glistmodel/store/refcounts", test_store_refcounts);
   g_test_add_func ("/glistmodel/store/sorted", test_store_sorted);
+  g_test_add_data_func ("/glistmodel/store/splice-order", GINT_TO_POINTER (FALSE), test_store_splice_order);
+  g_test_add_data_func ("/glistmodel/store/splice-order/indexed", GINT_TO_POINTER (TRUE), test_store_splice_order);
+  g_test_add_func ("/glistmodel/store/indexed", test_store_indexed);
+  g_test_add_func ("/glistmodel/store/freeze", test_store_freeze);
 
   return g_test_run ();
 }
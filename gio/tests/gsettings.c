@@ -703,6 +703,105 @@ test_atomic (void)
   g_object_unref (settings);
 }
 
+static gboolean
+count_change_event_cb (GSettings    *settings,
+                       const GQuark *keys,
+                       gint          n_keys,
+                       gpointer      user_data)
+{
+  GArray *events = user_data;
+
+  g_array_append_val (events, n_keys);
+
+  return FALSE;
+}
+
+/* Check that changes made while frozen are announced as one
+ * change-event, and that reads are not held back meanwhile.
+ */
+static void
+test_freeze_changes (void)
+{
+  GSettings *settings;
+  GSettings *settings2;
+  GArray *events;
+  gchar *str;
+
+  settings = g_settings_new ("org.gtk.test");
+  settings2 = g_settings_new ("org.gtk.test");
+  events = g_array_new (FALSE, FALSE, sizeof (gint));
+
+  g_signal_connect (settings, "change-event",
+                    G_CALLBACK (count_change_event_cb), events);
+
+  g_settings_freeze_changes (settings);
+  g_settings_freeze_changes (settings);
+
+  g_settings_set (settings, "greeting", "s", "frozen hello");
+  g_settings_set (settings2, "farewell", "s", "frozen bye");
+  g_settings_set (settings, "greeting", "s", "frozen hello again");
+
+  g_settings_get (settings, "greeting", "s", &str);
+  g_assert_cmpstr (str, ==, "frozen hello again");
+  g_free (str);
+
+  g_settings_get (settings, "farewell", "s", &str);
+  g_assert_cmpstr (str, ==, "frozen bye");
+  g_free (str);
+
+  g_settings_thaw_changes (settings);
+  g_assert_cmpuint (events->len, ==, 0);
+
+  g_settings_thaw_changes (settings);
+  g_assert_cmpuint (events->len, ==, 1);
+  g_assert_cmpint (g_array_index (events, gint, 0), ==, 2);
+
+  /* not frozen anymore */
+  g_settings_set (settings2, "farewell", "s", "bye");
+  g_assert_cmpuint (events->len, ==, 2);
+  g_assert_cmpint (g_array_index (events, gint, 1), ==, 1);
+
+  g_array_unref (events);
+  g_object_unref (settings2);
+  g_object_unref (settings);
+}
+
+/* Check that values cached while reading from the owning thread are
+ * dropped when some other GSettings object changes them.
+ */
+static void
+test_value_cache (void)
+{
+  GSettings *settings;
+  GSettings *settings2;
+  gchar *str;
+
+  g_assert (g_main_context_acquire (NULL));
+
+  settings = g_settings_new ("org.gtk.test");
+  settings2 = g_settings_new ("org.gtk.test");
+
+  g_settings_set_string (settings, "greeting", "cached hello");
+  str = g_settings_get_string (settings, "greeting");
+  g_assert_cmpstr (str, ==, "cached hello");
+  g_free (str);
+
+  g_settings_set_string (settings2, "greeting", "uncached hello");
+  str = g_settings_get_string (settings, "greeting");
+  g_assert_cmpstr (str, ==, "uncached hello");
+  g_free (str);
+
+  g_settings_reset (settings2, "greeting");
+  str = g_settings_get_string (settings, "greeting");
+  g_assert_cmpstr (str, ==, "Hello, earthlings");
+  g_free (str);
+
+  g_object_unref (settings2);
+  g_object_unref (settings);
+
+  g_main_context_release (NULL);
+}
+
 /* On Windows the interaction between the C library locale and libintl
  * (from GNU gettext) is not like on POSIX, so just skip these tests
  * for now.
@@ -1736,6 +1835,88 @@ test_keyfile (void)
   g_chmod ("keyfile", 0777);
 }
 
+static gboolean
+quit_loop_cb (gpointer user_data)
+{
+  g_main_loop_quit (user_data);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gchar *
+keyfile_get_string (const gchar *filename,
+                    const gchar *group,
+                    const gchar *key)
+{
+  GKeyFile *keyfile;
+  gchar *str;
+
+  keyfile = g_key_file_new ();
+  g_key_file_load_from_file (keyfile, filename, 0, NULL);
+  str = g_key_file_get_string (keyfile, group, key, NULL);
+  g_key_file_free (keyfile);
+
+  return str;
+}
+
+/*
+ * Test that a keyfile backend with a write delay writes changes
+ * together, and only after the delay or when it goes away
+ */
+static void
+test_keyfile_write_delay (void)
+{
+  GSettingsBackend *kf_backend;
+  GSettings *settings;
+  GMainLoop *loop;
+  gchar *str;
+
+  g_remove ("keyfile-delay/gsettings.store");
+  g_rmdir ("keyfile-delay");
+
+  kf_backend = g_keyfile_settings_backend_new ("keyfile-delay/gsettings.store", "/", "root");
+  g_object_set (kf_backend, "write-delay", 100, NULL);
+  settings = g_settings_new_with_backend ("org.gtk.test", kf_backend);
+
+  g_settings_set (settings, "greeting", "s", "delayed hello");
+  g_settings_set (settings, "farewell", "s", "delayed bye");
+
+  /* the in-memory state is current... */
+  str = g_settings_get_string (settings, "greeting");
+  g_assert_cmpstr (str, ==, "delayed hello");
+  g_free (str);
+
+  /* ...but nothing reached the disk yet */
+  g_assert (!g_file_test ("keyfile-delay/gsettings.store", G_FILE_TEST_EXISTS));
+
+  loop = g_main_loop_new (NULL, FALSE);
+  g_timeout_add (500, quit_loop_cb, loop);
+  g_main_loop_run (loop);
+  g_main_loop_unref (loop);
+
+  str = keyfile_get_string ("keyfile-delay/gsettings.store", "tests", "greeting");
+  g_assert_cmpstr (str, ==, "'delayed hello'");
+  g_free (str);
+  str = keyfile_get_string ("keyfile-delay/gsettings.store", "tests", "farewell");
+  g_assert_cmpstr (str, ==, "'delayed bye'");
+  g_free (str);
+
+  /* pending changes are written out when the backend is finalized */
+  g_settings_reset (settings, "greeting");
+  str = keyfile_get_string ("keyfile-delay/gsettings.store", "tests", "greeting");
+  g_assert_cmpstr (str, ==, "'delayed hello'");
+  g_free (str);
+
+  g_object_unref (settings);
+  g_object_unref (kf_backend);
+
+  str = keyfile_get_string ("keyfile-delay/gsettings.store", "tests", "greeting");
+  g_assert_cmpstr (str, ==, NULL);
+
+  g_remove ("keyfile-delay/gsettings.store");
+  g_rmdir ("keyfile-delay");
+}
+
 /* Test that getting child schemas works
  */
 static void
@@ -2278,6 +2459,47 @@ G_GNUC_BEGIN_IGNORE_DEPRECATIONS
 G_GNUC_END_IGNORE_DEPRECATIONS
 }
 
+/* Test that the default source hands out the same schema, and the same
+ * key information, to everybody
+ */
+static void
+test_schema_shared (void)
+{
+  GSettingsSchemaSource *source;
+  GSettingsSchema *schema1, *schema2;
+  GSettingsSchemaKey *key1, *key2;
+  GVariant *value1, *value2;
+  GSettings *settings1, *settings2;
+
+  source = g_settings_schema_source_get_default ();
+  schema1 = g_settings_schema_source_lookup (source, "org.gtk.test.basic-types", TRUE);
+  schema2 = g_settings_schema_source_lookup (source, "org.gtk.test.basic-types", TRUE);
+  g_assert (schema1 != NULL);
+  g_assert (schema1 == schema2);
+  g_settings_schema_unref (schema2);
+
+  settings1 = g_settings_new ("org.gtk.test.basic-types");
+  settings2 = g_settings_new ("org.gtk.test.basic-types");
+  g_object_get (settings1, "settings-schema", &schema2, NULL);
+  g_assert (schema1 == schema2);
+  g_settings_schema_unref (schema2);
+
+  key1 = g_settings_schema_get_key (schema1, "test-int32");
+  key2 = g_settings_schema_get_key (schema1, "test-int32");
+  g_assert (key1 != key2);
+  value1 = g_settings_schema_key_get_default_value (key1);
+  value2 = g_settings_schema_key_get_default_value (key2);
+  g_assert (value1 == value2);
+  g_variant_unref (value1);
+  g_variant_unref (value2);
+  g_settings_schema_key_unref (key1);
+  g_settings_schema_key_unref (key2);
+
+  g_object_unref (settings1);
+  g_object_unref (settings2);
+  g_settings_schema_unref (schema1);
+}
+
 static void
 test_schema_source (void)
 {
@@ -2688,6 +2910,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/gsettings/delay-revert", test_delay_revert);
   g_test_add_func ("/gsettings/delay-child", test_delay_child);
   g_test_add_func ("/gsettings/atomic", test_atomic);
+  g_test_add_func ("/gsettings/freeze-changes", test_freeze_changes);
+  g_test_add_func ("/gsettings/value-cache", test_value_cache);
 
   g_test_add_func ("/gsettings/simple-binding", test_simple_binding);
   g_test_add_func ("/gsettings/directional-binding", test_directional_binding);
@@ -2708,6 +2932,7 @@ main (int argc, char *argv[])
     }
 
   g_test_add_func ("/gsettings/keyfile", test_keyfile);
+  g_test_add_func ("/gsettings/keyfile-write-delay", test_keyfile_write_delay);
   g_test_add_func ("/gsettings/child-schema", test_child_schema);
   g_test_add_func ("/gsettings/strinfo", test_strinfo);
   g_test_add_func ("/gsettings/enums", test_enums);
@@ -2728,6 +2953,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/gsettings/mapped", test_get_mapped);
   g_test_add_func ("/gsettings/get-range", test_get_range);
   g_test_add_func ("/gsettings/schema-source", test_schema_source);
+  g_test_add_func ("/gsettings/schema-shared", test_schema_shared);
   g_test_add_func ("/gsettings/schema-list-keys", test_schema_list_keys);
   g_test_add_func ("/gsettings/actions", test_actions);
   g_test_add_func ("/gsettings/null-backend", test_null_backend);
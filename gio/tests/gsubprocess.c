@@ -691,6 +691,60 @@ test_communicate (void)
   g_object_unref (proc);
 }
 
+static void
+on_communicate_stream_output (GSubprocess *proc,
+                              GBytes      *bytes,
+                              gboolean     is_stderr,
+                              gpointer     user_data)
+{
+  GByteArray *output = user_data;
+
+  g_assert_false (is_stderr);
+  g_assert_cmpuint (g_bytes_get_size (bytes), >, 0);
+  g_byte_array_append (output, g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes));
+}
+
+static void
+test_communicate_stream (void)
+{
+  GError *error = NULL;
+  GPtrArray *args;
+  GSubprocessLauncher *launcher;
+  GSubprocess *proc;
+  GByteArray *output;
+  GBytes *input;
+  guchar *data;
+  gsize i, len;
+
+  len = 1024 * 1024;
+  data = g_malloc (len);
+  for (i = 0; i < len; i++)
+    data[i] = i % 251;
+  input = g_bytes_new_take (data, len);
+
+  args = get_test_subprocess_args ("cat", NULL);
+  launcher = g_subprocess_launcher_new (G_SUBPROCESS_FLAGS_STDIN_PIPE
+                                        | G_SUBPROCESS_FLAGS_STDOUT_PIPE
+                                        | G_SUBPROCESS_FLAGS_STDERR_MERGE);
+  g_subprocess_launcher_set_pipe_size (launcher, 256 * 1024);
+  proc = g_subprocess_launcher_spawnv (launcher, (const gchar * const *) args->pdata, &error);
+  g_assert_no_error (error);
+  g_ptr_array_free (args, TRUE);
+
+  output = g_byte_array_new ();
+  g_subprocess_communicate_stream (proc, input, on_communicate_stream_output, output,
+                                   NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (g_subprocess_get_successful (proc));
+
+  g_assert_cmpmem (output->data, output->len, g_bytes_get_data (input, NULL), len);
+
+  g_byte_array_unref (output);
+  g_bytes_unref (input);
+  g_object_unref (proc);
+  g_object_unref (launcher);
+}
+
 static void
 test_communicate_utf8_async (void)
 {
@@ -1259,6 +1313,7 @@ main (int argc, char **argv)
   g_test_add_func ("/gsubprocess/multi1", test_multi_1);
   g_test_add_func ("/gsubprocess/communicate", test_communicate);
   g_test_add_func ("/gsubprocess/communicate-async", test_communicate_async);
+  g_test_add_func ("/gsubprocess/communicate-stream", test_communicate_stream);
   g_test_add_func ("/gsubprocess/communicate-utf8", test_communicate_utf8);
   g_test_add_func ("/gsubprocess/communicate-utf8-async", test_communicate_utf8_async);
   g_test_add_func ("/gsubprocess/communicate-utf8-invalid", test_communicate_utf8_invalid);
@@ -239,10 +239,12 @@ enum
 };
 
 static void g_test_tls_connection_initable_iface_init (GInitableIface *iface);
+static void g_test_tls_connection_client_iface_init (GTlsClientConnectionInterface *iface);
 
 #define g_test_tls_connection_get_type _g_test_tls_connection_get_type
 G_DEFINE_TYPE_WITH_CODE (GTestTlsConnection, g_test_tls_connection, G_TYPE_TLS_CONNECTION,
-			 G_IMPLEMENT_INTERFACE (G_TYPE_TLS_CLIENT_CONNECTION, NULL);
+			 G_IMPLEMENT_INTERFACE (G_TYPE_TLS_CLIENT_CONNECTION,
+						g_test_tls_connection_client_iface_init);
 			 G_IMPLEMENT_INTERFACE (G_TYPE_TLS_SERVER_CONNECTION, NULL);
 			 G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE,
 						g_test_tls_connection_initable_iface_init);)
@@ -316,6 +318,21 @@ g_test_tls_connection_initable_init (GInitable       *initable,
   return FALSE;
 }
 
+/* Records where the session came from, for the session cache tests */
+static void
+g_test_tls_connection_copy_session_state (GTlsClientConnection *conn,
+                                          GTlsClientConnection *source)
+{
+  g_object_set_data_full (G_OBJECT (conn), "session-source",
+                          g_object_ref (source), g_object_unref);
+}
+
+static void
+g_test_tls_connection_client_iface_init (GTlsClientConnectionInterface *iface)
+{
+  iface->copy_session_state = g_test_tls_connection_copy_session_state;
+}
+
 static void
 g_test_tls_connection_initable_iface_init (GInitableIface  *iface)
 {
@@ -0,0 +1,299 @@
+/* GLib testing framework examples and tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib/gstdio.h>
+
+/* the gvdb functions are internal to libgio */
+#include "../gvdb/gvdb-builder.c"
+#include "../gvdb/gvdb-reader.c"
+
+static GHashTable *
+build_table (guint n_values)
+{
+  GHashTable *root, *child;
+  GvdbItem *dir, *item;
+  guint i;
+
+  root = gvdb_hash_table_new (NULL, NULL);
+
+  dir = gvdb_hash_table_insert (root, "/dir/");
+  gvdb_item_set_parent (dir, gvdb_hash_table_insert (root, "/"));
+
+  for (i = 0; i < n_values; i++)
+    {
+      gchar *key = g_strdup_printf ("/dir/key%u", i);
+
+      item = gvdb_hash_table_insert (root, key);
+      gvdb_item_set_value (item, g_variant_new_uint32 (i));
+      gvdb_item_set_parent (item, dir);
+      g_free (key);
+    }
+
+  child = gvdb_hash_table_new (root, "child");
+  gvdb_hash_table_insert_string (child, "greeting", "hello");
+  gvdb_hash_table_insert_string (child, "farewell", "bye");
+  g_hash_table_unref (child);
+
+  return root;
+}
+
+static void
+check_table (GvdbTable *table,
+             guint      n_values)
+{
+  GvdbTable *child;
+  GVariant *value;
+  gchar **list;
+  guint i;
+
+  g_assert (gvdb_table_is_valid (table));
+
+  for (i = 0; i < n_values; i++)
+    {
+      gchar *key = g_strdup_printf ("/dir/key%u", i);
+
+      value = gvdb_table_get_value (table, key);
+      g_assert (value != NULL);
+      g_assert_cmpuint (g_variant_get_uint32 (value), ==, i);
+      g_variant_unref (value);
+      g_free (key);
+    }
+
+  g_assert (gvdb_table_get_value (table, "/dir/key") == NULL);
+  g_assert (gvdb_table_get_value (table, "/dir/") == NULL);
+  g_assert (gvdb_table_get_value (table, "key0") == NULL);
+  g_assert (gvdb_table_get_value (table, "") == NULL);
+  g_assert (!gvdb_table_has_value (table, "child"));
+
+  list = gvdb_table_list (table, "/dir/");
+  g_assert (list != NULL);
+  g_assert_cmpuint (g_strv_length (list), ==, n_values);
+  for (i = 0; i < n_values; i++)
+    g_assert (g_str_has_prefix (list[i], "key"));
+  g_strfreev (list);
+
+  list = gvdb_table_list (table, "/");
+  g_assert (list != NULL);
+  g_assert_cmpuint (g_strv_length (list), ==, 1);
+  g_assert_cmpstr (list[0], ==, "dir/");
+  g_strfreev (list);
+
+  child = gvdb_table_get_table (table, "child");
+  g_assert (child != NULL);
+  g_assert (gvdb_table_get_table (table, "/dir/key0") == NULL);
+
+  value = gvdb_table_get_value (child, "greeting");
+  g_assert_cmpstr (g_variant_get_string (value, NULL), ==, "hello");
+  g_variant_unref (value);
+  g_assert (gvdb_table_has_value (child, "farewell"));
+  g_assert (!gvdb_table_has_value (child, "/dir/key0"));
+
+  gvdb_table_unref (child);
+}
+
+typedef struct
+{
+  guint opened;
+  guint values;
+} WalkData;
+
+static gboolean
+walk_open (const gchar *name,
+           gsize        name_len,
+           gpointer     user_data)
+{
+  WalkData *data = user_data;
+
+  data->opened++;
+
+  return TRUE;
+}
+
+static void
+walk_value (const gchar *name,
+            gsize        name_len,
+            GVariant    *value,
+            gpointer     user_data)
+{
+  WalkData *data = user_data;
+  gchar *expected;
+
+  expected = g_strdup_printf ("key%u", g_variant_get_uint32 (value));
+  g_assert_cmpint (strlen (expected), ==, name_len);
+  g_assert (memcmp (expected, name, name_len) == 0);
+  g_free (expected);
+
+  data->values++;
+}
+
+static void
+walk_close (gsize    name_len,
+            gpointer user_data)
+{
+}
+
+static void
+test_version (gconstpointer user_data)
+{
+  guint32 version = GPOINTER_TO_UINT (user_data);
+  const struct gvdb_header *header;
+  GError *error = NULL;
+  WalkData walk = { 0, };
+  GHashTable *root;
+  GvdbTable *table;
+  gchar *filename;
+  gint fd;
+
+  fd = g_file_open_tmp ("gvdb-XXXXXX", &filename, &error);
+  g_assert_no_error (error);
+  close (fd);
+
+  root = build_table (1000);
+  gvdb_table_write_contents_with_version (root, filename, FALSE, version, &error);
+  g_assert_no_error (error);
+  g_hash_table_unref (root);
+
+  table = gvdb_table_new (filename, FALSE, &error);
+  g_assert_no_error (error);
+
+  header = (gconstpointer) table->data;
+  g_assert_cmpuint (guint32_from_le (header->version), ==, version);
+
+  check_table (table, 1000);
+
+  gvdb_table_walk (table, "/", walk_open, walk_value, walk_close, &walk);
+  g_assert_cmpuint (walk.opened, ==, 2);
+  g_assert_cmpuint (walk.values, ==, 1000);
+
+  gvdb_table_unref (table);
+
+  g_unlink (filename);
+  g_free (filename);
+}
+
+static void
+test_empty (gconstpointer user_data)
+{
+  guint32 version = GPOINTER_TO_UINT (user_data);
+  GError *error = NULL;
+  GHashTable *root;
+  GvdbTable *table;
+  gchar *filename;
+  gint fd;
+
+  fd = g_file_open_tmp ("gvdb-XXXXXX", &filename, &error);
+  g_assert_no_error (error);
+  close (fd);
+
+  root = gvdb_hash_table_new (NULL, NULL);
+  gvdb_table_write_contents_with_version (root, filename, FALSE, version, &error);
+  g_assert_no_error (error);
+  g_hash_table_unref (root);
+
+  table = gvdb_table_new (filename, FALSE, &error);
+  g_assert_no_error (error);
+  g_assert (gvdb_table_get_value (table, "anything") == NULL);
+  g_assert (gvdb_table_list (table, "") == NULL);
+  gvdb_table_unref (table);
+
+  g_unlink (filename);
+  g_free (filename);
+}
+
+static void
+test_order (void)
+{
+  GError *error = NULL;
+  GHashTable *root;
+  GvdbTable *table;
+  const guint8 *last = NULL;
+  gchar *filename;
+  GvdbItem *item;
+  gint fd;
+  guint i;
+
+  fd = g_file_open_tmp ("gvdb-XXXXXX", &filename, &error);
+  g_assert_no_error (error);
+  close (fd);
+
+  /* every third value is stored after all the others, in reverse */
+  root = build_table (100);
+  for (i = 0; i < 100; i += 3)
+    {
+      gchar *key = g_strdup_printf ("/dir/key%u", i);
+
+      item = g_hash_table_lookup (root, key);
+      gvdb_item_set_order (item, 100 - i);
+      g_free (key);
+    }
+
+  gvdb_table_write_contents (root, filename, FALSE, &error);
+  g_assert_no_error (error);
+  g_hash_table_unref (root);
+
+  table = gvdb_table_new (filename, FALSE, &error);
+  g_assert_no_error (error);
+
+  check_table (table, 100);
+
+  /* ordered values come after all others, by increasing order */
+  for (i = 0; i < 100; i++)
+    {
+      gchar *key = g_strdup_printf ("/dir/key%u", i);
+      GVariant *value;
+
+      value = gvdb_table_get_raw_value (table, key);
+      if (i % 3 != 0)
+        last = MAX (last, (const guint8 *) g_variant_get_data (value));
+      g_variant_unref (value);
+      g_free (key);
+    }
+
+  for (i = 99; i != 0; i--)
+    {
+      gchar *key;
+      GVariant *value;
+
+      if (i % 3 != 0)
+        continue;
+
+      key = g_strdup_printf ("/dir/key%u", i);
+      value = gvdb_table_get_raw_value (table, key);
+      g_assert ((const guint8 *) g_variant_get_data (value) > last);
+      last = g_variant_get_data (value);
+      g_variant_unref (value);
+      g_free (key);
+    }
+
+  gvdb_table_unref (table);
+
+  g_unlink (filename);
+  g_free (filename);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_data_func ("/gvdb/v1", GUINT_TO_POINTER (GVDB_VERSION_1), test_version);
+  g_test_add_data_func ("/gvdb/v2", GUINT_TO_POINTER (GVDB_VERSION_2), test_version);
+  g_test_add_data_func ("/gvdb/v1/empty", GUINT_TO_POINTER (GVDB_VERSION_1), test_empty);
+  g_test_add_data_func ("/gvdb/v2/empty", GUINT_TO_POINTER (GVDB_VERSION_2), test_empty);
+  g_test_add_func ("/gvdb/order", test_order);
+
+  return g_test_run ();
+}
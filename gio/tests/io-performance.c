@@ -0,0 +1,271 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Benchmarks of GTask threads and of GSocket on the loopback
+ * interface. Without -m perf, every benchmark runs a single iteration
+ * as a quick test.
+ */
+
+#include <gio/gio.h>
+
+/* GTask */
+
+static void
+task_thread_func (GTask        *task,
+                  gpointer      source_object,
+                  gpointer      task_data,
+                  GCancellable *cancellable)
+{
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+task_done (GObject      *source_object,
+           GAsyncResult *result,
+           gpointer      user_data)
+{
+  gboolean *done = user_data;
+
+  *done = g_task_propagate_boolean (G_TASK (result), NULL);
+}
+
+/* Each iteration runs a task in a thread, and waits for its callback */
+static void
+bench_task_run_in_thread (gconstpointer data,
+                          guint64       n_iterations)
+{
+  GTask *task;
+  gboolean done;
+  guint64 i;
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      done = FALSE;
+      task = g_task_new (NULL, NULL, task_done, &done);
+      g_task_run_in_thread (task, task_thread_func);
+      g_object_unref (task);
+
+      while (!done)
+        g_main_context_iteration (NULL, TRUE);
+    }
+}
+
+/* GSocket */
+
+static GSocket *
+listen_on_loopback (void)
+{
+  GInetAddress *iaddr;
+  GSocketAddress *addr;
+  GSocket *listener;
+  GError *error = NULL;
+
+  listener = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+                           G_SOCKET_PROTOCOL_DEFAULT, &error);
+  g_assert_no_error (error);
+
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (iaddr, 0);
+  g_object_unref (iaddr);
+
+  g_socket_bind (listener, addr, TRUE, &error);
+  g_assert_no_error (error);
+  g_object_unref (addr);
+
+  g_socket_set_listen_backlog (listener, 128);
+  g_socket_listen (listener, &error);
+  g_assert_no_error (error);
+
+  return listener;
+}
+
+static GSocket *
+connect_to (GSocket *listener)
+{
+  GSocketAddress *addr;
+  GSocket *client;
+  GError *error = NULL;
+
+  addr = g_socket_get_local_address (listener, &error);
+  g_assert_no_error (error);
+
+  client = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+                         G_SOCKET_PROTOCOL_DEFAULT, &error);
+  g_assert_no_error (error);
+
+  g_socket_connect (client, addr, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (addr);
+
+  return client;
+}
+
+static GSocket *accept_listener;
+
+/* Each iteration connects to a listening socket, accepts the
+ * connection, and closes both ends
+ */
+static void
+bench_socket_accept (gconstpointer data,
+                     guint64       n_iterations)
+{
+  GSocket *client, *server;
+  GError *error = NULL;
+  guint64 i;
+
+  if (accept_listener == NULL)
+    accept_listener = listen_on_loopback ();
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      client = connect_to (accept_listener);
+      server = g_socket_accept (accept_listener, NULL, &error);
+      g_assert_no_error (error);
+
+      g_object_unref (server);
+      g_object_unref (client);
+    }
+}
+
+/* blocks are small enough to fit in the socket buffers, since the
+ * echo is read back only once the whole block has been sent
+ */
+#define ECHO_BUFFER_SIZE 16384
+
+static GSocket *echo_client;
+static GThread *echo_thread;
+
+static void
+send_all (GSocket     *socket,
+          const gchar *buffer,
+          gsize        len)
+{
+  GError *error = NULL;
+  gssize n;
+
+  for (; len > 0; buffer += n, len -= n)
+    {
+      n = g_socket_send (socket, buffer, len, NULL, &error);
+      g_assert_no_error (error);
+    }
+}
+
+static gpointer
+echo_thread_func (gpointer data)
+{
+  GSocket *server = data;
+  gchar *buffer;
+  gssize len;
+  GError *error = NULL;
+
+  buffer = g_malloc (ECHO_BUFFER_SIZE);
+
+  while ((len = g_socket_receive (server, buffer, ECHO_BUFFER_SIZE, NULL, &error)) > 0)
+    send_all (server, buffer, len);
+  g_assert_no_error (error);
+
+  g_free (buffer);
+  g_object_unref (server);
+
+  return NULL;
+}
+
+static void
+start_echo (void)
+{
+  GSocket *listener, *server;
+  GError *error = NULL;
+
+  listener = listen_on_loopback ();
+  echo_client = connect_to (listener);
+  server = g_socket_accept (listener, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (listener);
+
+  echo_thread = g_thread_new ("echo", echo_thread_func, server);
+}
+
+static void
+stop_echo (void)
+{
+  if (echo_client == NULL)
+    return;
+
+  g_socket_shutdown (echo_client, FALSE, TRUE, NULL);
+  g_thread_join (echo_thread);
+  g_clear_object (&echo_client);
+}
+
+/* Each iteration sends a block to the echo thread, and reads it back */
+static void
+bench_socket_echo (gconstpointer data,
+                   guint64       n_iterations)
+{
+  gsize block_size = GPOINTER_TO_SIZE (data);
+  gchar *block;
+  gssize n;
+  gsize done;
+  guint64 i;
+  GError *error = NULL;
+
+  if (echo_client == NULL)
+    start_echo ();
+
+  block = g_malloc0 (block_size);
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      send_all (echo_client, block, block_size);
+
+      for (done = 0; done < block_size; done += n)
+        {
+          n = g_socket_receive (echo_client, block + done, block_size - done, NULL, &error);
+          g_assert_no_error (error);
+          g_assert_cmpint (n, >, 0);
+        }
+    }
+
+  g_free (block);
+}
+
+int
+main (int argc, char *argv[])
+{
+  static const gsize block_sizes[] = { 64, 1024, ECHO_BUFFER_SIZE };
+  guint i;
+  gint ret;
+
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_bench ("/task/run-in-thread", NULL, bench_task_run_in_thread);
+  g_test_add_bench ("/socket/accept", NULL, bench_socket_accept);
+
+  for (i = 0; i < G_N_ELEMENTS (block_sizes); i++)
+    {
+      gchar *path;
+
+      path = g_strdup_printf ("/socket/echo/%" G_GSIZE_FORMAT, block_sizes[i]);
+      g_test_add_bench (path, GSIZE_TO_POINTER (block_sizes[i]), bench_socket_echo);
+      g_free (path);
+    }
+
+  ret = g_test_run ();
+
+  stop_echo ();
+  g_clear_object (&accept_listener);
+
+  return ret;
+}
@@ -0,0 +1,225 @@
+/* GLib testing framework examples and tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gio/gio.h>
+#include <string.h>
+
+/* Asynchronous I/O on local files, with GIO_USE_IO_URING=1. Where the
+ * kernel has no io_uring this exercises the threaded fallback instead,
+ * which has to behave the same.
+ */
+
+static void
+result_cb (GObject      *source,
+           GAsyncResult *result,
+           gpointer      user_data)
+{
+  GAsyncResult **result_out = user_data;
+
+  *result_out = g_object_ref (result);
+}
+
+static GAsyncResult *
+wait_for_result (GAsyncResult **result)
+{
+  while (*result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  return *result;
+}
+
+static GFile *
+create_file (gchar   **contents,
+             gsize    *length)
+{
+  GOutputStream *output;
+  GFileIOStream *iostream;
+  GAsyncResult *result = NULL;
+  GFile *file;
+  GError *error = NULL;
+  gsize i, written;
+
+  *length = 1024 * 1024 + 3;
+  *contents = g_malloc (*length);
+  for (i = 0; i < *length; i++)
+    (*contents)[i] = i % 253;
+
+  file = g_file_new_tmp ("io-uringXXXXXX", &iostream, &error);
+  g_assert_no_error (error);
+  output = g_io_stream_get_output_stream (G_IO_STREAM (iostream));
+
+  for (written = 0; written < *length; )
+    {
+      gssize n;
+
+      g_output_stream_write_async (output, *contents + written, *length - written,
+                                   G_PRIORITY_DEFAULT, NULL, result_cb, &result);
+      n = g_output_stream_write_finish (output, wait_for_result (&result), &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (n, >, 0);
+      g_clear_object (&result);
+      written += n;
+    }
+
+  g_io_stream_close (G_IO_STREAM (iostream), NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (iostream);
+
+  return file;
+}
+
+static void
+test_read_write (void)
+{
+  GInputStream *input;
+  GAsyncResult *result = NULL;
+  GFile *file;
+  GError *error = NULL;
+  gchar *contents, *buffer;
+  gsize length, total;
+  gssize n;
+
+  file = create_file (&contents, &length);
+
+  input = G_INPUT_STREAM (g_file_read (file, NULL, &error));
+  g_assert_no_error (error);
+
+  buffer = g_malloc (length + 1);
+  total = 0;
+  do
+    {
+      g_input_stream_read_async (input, buffer + total, MIN (65536, length + 1 - total),
+                                 G_PRIORITY_DEFAULT, NULL, result_cb, &result);
+      n = g_input_stream_read_finish (input, wait_for_result (&result), &error);
+      g_assert_no_error (error);
+      g_clear_object (&result);
+      total += n;
+    }
+  while (n > 0);
+
+  g_assert_cmpuint (total, ==, length);
+  g_assert (memcmp (buffer, contents, length) == 0);
+
+  g_object_unref (input);
+  g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+  g_free (buffer);
+  g_free (contents);
+}
+
+static void
+test_position (void)
+{
+  GInputStream *input;
+  GAsyncResult *result = NULL;
+  GFile *file;
+  GError *error = NULL;
+  gchar *contents, buffer[100];
+  gsize length;
+  gssize n;
+
+  file = create_file (&contents, &length);
+
+  input = G_INPUT_STREAM (g_file_read (file, NULL, &error));
+  g_assert_no_error (error);
+
+  /* Asynchronous reads continue where synchronous ones and seeks left off */
+  n = g_input_stream_read (input, buffer, 10, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 10);
+
+  g_input_stream_read_async (input, buffer, sizeof buffer, G_PRIORITY_DEFAULT,
+                             NULL, result_cb, &result);
+  n = g_input_stream_read_finish (input, wait_for_result (&result), &error);
+  g_assert_no_error (error);
+  g_clear_object (&result);
+  g_assert_cmpint (n, ==, sizeof buffer);
+  g_assert (memcmp (buffer, contents + 10, sizeof buffer) == 0);
+  g_assert_cmpint (g_seekable_tell (G_SEEKABLE (input)), ==, 10 + sizeof buffer);
+
+  g_seekable_seek (G_SEEKABLE (input), 1000, G_SEEK_SET, NULL, &error);
+  g_assert_no_error (error);
+  g_input_stream_read_async (input, buffer, sizeof buffer, G_PRIORITY_DEFAULT,
+                             NULL, result_cb, &result);
+  n = g_input_stream_read_finish (input, wait_for_result (&result), &error);
+  g_assert_no_error (error);
+  g_clear_object (&result);
+  g_assert_cmpint (n, ==, sizeof buffer);
+  g_assert (memcmp (buffer, contents + 1000, sizeof buffer) == 0);
+
+  g_object_unref (input);
+  g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+  g_free (contents);
+}
+
+static void
+test_cancel (void)
+{
+  GInputStream *input;
+  GCancellable *cancellable;
+  GAsyncResult *result = NULL;
+  GFile *file;
+  GError *error = NULL;
+  gchar *contents, buffer[100];
+  gsize length;
+  gssize n;
+
+  file = create_file (&contents, &length);
+
+  input = G_INPUT_STREAM (g_file_read (file, NULL, &error));
+  g_assert_no_error (error);
+
+  cancellable = g_cancellable_new ();
+  g_input_stream_read_async (input, buffer, sizeof buffer, G_PRIORITY_DEFAULT,
+                             cancellable, result_cb, &result);
+  g_cancellable_cancel (cancellable);
+  n = g_input_stream_read_finish (input, wait_for_result (&result), &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_cmpint (n, ==, -1);
+  g_clear_error (&error);
+  g_clear_object (&result);
+
+  /* The stream is still usable */
+  g_input_stream_read_async (input, buffer, sizeof buffer, G_PRIORITY_DEFAULT,
+                             NULL, result_cb, &result);
+  n = g_input_stream_read_finish (input, wait_for_result (&result), &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, >, 0);
+  g_clear_object (&result);
+
+  g_object_unref (cancellable);
+  g_object_unref (input);
+  g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+  g_free (contents);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  /* Must be set before the first local file stream is created */
+  g_setenv ("GIO_USE_IO_URING", "1", TRUE);
+
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/io-uring/read-write", test_read_write);
+  g_test_add_func ("/io-uring/position", test_position);
+  g_test_add_func ("/io-uring/cancel", test_cancel);
+
+  return g_test_run ();
+}
@@ -337,6 +337,210 @@ test_steal_as_bytes (void)
   g_object_unref (o);
 }
 
+static void
+test_seek_chunked (void)
+{
+  GOutputStream *mo;
+  gint i;
+
+  for (i = 1; i < 300; i += 37)
+    {
+      mo = g_memory_output_stream_new_chunked (i);
+
+      test_seek_resizable_stream (mo);
+
+      g_assert_cmpint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 0);
+      g_assert_cmpint (g_memory_output_stream_get_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 0);
+
+      g_object_unref (mo);
+    }
+}
+
+static void
+test_reserve (void)
+{
+  GOutputStream *mo;
+  GError *error = NULL;
+  gpointer data;
+  gchar buf[100];
+  gint i;
+
+  mo = g_memory_output_stream_new_resizable ();
+
+  g_assert_true (g_memory_output_stream_reserve (G_MEMORY_OUTPUT_STREAM (mo), 1000, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_memory_output_stream_get_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 1000);
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 0);
+
+  /* Reserving less never shrinks */
+  g_assert_true (g_memory_output_stream_reserve (G_MEMORY_OUTPUT_STREAM (mo), 10, &error));
+  g_assert_cmpuint (g_memory_output_stream_get_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 1000);
+
+  /* Writes that fit don't reallocate */
+  data = g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (mo));
+  memset (buf, 'x', sizeof buf);
+  for (i = 0; i < 10; i++)
+    {
+      g_output_stream_write_all (mo, buf, sizeof buf, NULL, NULL, &error);
+      g_assert_no_error (error);
+    }
+  g_assert_true (data == g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (mo)));
+  g_assert_cmpuint (g_memory_output_stream_get_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 1000);
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 1000);
+
+  g_object_unref (mo);
+
+  mo = g_memory_output_stream_new (buf, sizeof buf, NULL, NULL);
+  g_assert_false (g_memory_output_stream_reserve (G_MEMORY_OUTPUT_STREAM (mo), 1000, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE);
+  g_clear_error (&error);
+  g_object_unref (mo);
+
+  mo = g_memory_output_stream_new_chunked (64);
+  g_assert_true (g_memory_output_stream_reserve (G_MEMORY_OUTPUT_STREAM (mo), 1000, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_memory_output_stream_get_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 1024);
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 0);
+  g_object_unref (mo);
+}
+
+static void
+check_bytes_list (GList       *list,
+                  gsize        chunk_size,
+                  const gchar *expected,
+                  gsize        expected_len)
+{
+  GList *l;
+  gsize offset = 0;
+
+  for (l = list; l != NULL; l = l->next)
+    {
+      gsize size;
+      gconstpointer data = g_bytes_get_data (l->data, &size);
+
+      if (l->next != NULL)
+        g_assert_cmpuint (size, ==, chunk_size);
+      g_assert_cmpuint (offset + size, <=, expected_len);
+      g_assert_cmpmem (data, size, expected + offset, size);
+      offset += size;
+    }
+
+  g_assert_cmpuint (offset, ==, expected_len);
+}
+
+static void
+test_chunked (void)
+{
+  GOutputStream *mo;
+  GError *error = NULL;
+  GString *expected;
+  GList *list;
+  gchar *data;
+  GBytes *bytes;
+  gint i;
+
+  mo = g_memory_output_stream_new_chunked (16);
+  g_assert_null (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (mo)));
+
+  expected = g_string_new (NULL);
+  for (i = 0; i < 20; i++)
+    {
+      gchar *line = g_strdup_printf ("line %d\n", i);
+
+      g_output_stream_write_all (mo, line, strlen (line), NULL, NULL, &error);
+      g_assert_no_error (error);
+      g_string_append (expected, line);
+      g_free (line);
+    }
+
+  /* Overwrite across a block boundary */
+  g_seekable_seek (G_SEEKABLE (mo), 14, G_SEEK_SET, NULL, &error);
+  g_assert_no_error (error);
+  g_output_stream_write_all (mo, "ABCD", 4, NULL, NULL, &error);
+  g_assert_no_error (error);
+  memcpy (expected->str + 14, "ABCD", 4);
+
+  /* Truncating mid-block and growing again gives zeros */
+  g_seekable_truncate (G_SEEKABLE (mo), 40, NULL, &error);
+  g_assert_no_error (error);
+  g_seekable_seek (G_SEEKABLE (mo), 0, G_SEEK_END, NULL, &error);
+  g_assert_cmpint (g_seekable_tell (G_SEEKABLE (mo)), ==, 40);
+  g_seekable_truncate (G_SEEKABLE (mo), 50, NULL, &error);
+  g_assert_no_error (error);
+  g_string_truncate (expected, 40);
+  g_string_append_len (expected, "\0\0\0\0\0\0\0\0\0\0", 10);
+
+  /* A gap after seeking past the end is zeroed too */
+  g_seekable_seek (G_SEEKABLE (mo), 60, G_SEEK_SET, NULL, &error);
+  g_output_stream_write_all (mo, "end", 3, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_string_append_len (expected, "\0\0\0\0\0\0\0\0\0\0end", 13);
+
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, expected->len);
+
+  list = g_memory_output_stream_steal_as_bytes_list (G_MEMORY_OUTPUT_STREAM (mo));
+  g_assert_cmpuint (g_list_length (list), ==, 4);
+  check_bytes_list (list, 16, expected->str, expected->len);
+  g_list_free_full (list, (GDestroyNotify) g_bytes_unref);
+
+  /* The stream is empty again and can be reused */
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 0);
+  g_assert_cmpint (g_seekable_tell (G_SEEKABLE (mo)), ==, 0);
+  g_output_stream_write_all (mo, "again", 5, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  g_output_stream_close (mo, NULL, &error);
+  g_assert_no_error (error);
+
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (mo));
+  g_assert_cmpmem (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes), "again", 5);
+  g_bytes_unref (bytes);
+  g_object_unref (mo);
+
+  mo = g_memory_output_stream_new_chunked (4);
+  g_output_stream_write_all (mo, "0123456789", 10, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_output_stream_close (mo, NULL, &error);
+  data = g_memory_output_stream_steal_data (G_MEMORY_OUTPUT_STREAM (mo));
+  g_assert_true (memcmp (data, "0123456789", 10) == 0);
+  g_free (data);
+  g_object_unref (mo);
+
+  g_string_free (expected, TRUE);
+}
+
+static void
+test_steal_as_bytes_list (void)
+{
+  GOutputStream *mo;
+  GError *error = NULL;
+  gpointer data;
+  GList *list;
+
+  mo = g_memory_output_stream_new_resizable ();
+  g_assert_null (g_memory_output_stream_steal_as_bytes_list (G_MEMORY_OUTPUT_STREAM (mo)));
+
+  g_output_stream_write_all (mo, "hello world", 11, NULL, NULL, &error);
+  g_assert_no_error (error);
+  data = g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (mo));
+
+  /* Without closing, and without copying */
+  list = g_memory_output_stream_steal_as_bytes_list (G_MEMORY_OUTPUT_STREAM (mo));
+  g_assert_cmpuint (g_list_length (list), ==, 1);
+  g_assert_true (g_bytes_get_data (list->data, NULL) == data);
+  check_bytes_list (list, 0, "hello world", 11);
+  g_list_free_full (list, (GDestroyNotify) g_bytes_unref);
+
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 0);
+  g_output_stream_write_all (mo, "bye", 3, NULL, NULL, &error);
+  g_assert_no_error (error);
+  list = g_memory_output_stream_steal_as_bytes_list (G_MEMORY_OUTPUT_STREAM (mo));
+  check_bytes_list (list, 0, "bye", 3);
+  g_list_free_full (list, (GDestroyNotify) g_bytes_unref);
+
+  g_object_unref (mo);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -351,6 +555,10 @@ main (int   argc,
   g_test_add_func ("/memory-output-stream/properties", test_properties);
   g_test_add_func ("/memory-output-stream/write-bytes", test_write_bytes);
   g_test_add_func ("/memory-output-stream/steal_as_bytes", test_steal_as_bytes);
+  g_test_add_func ("/memory-output-stream/seek/chunked", test_seek_chunked);
+  g_test_add_func ("/memory-output-stream/reserve", test_reserve);
+  g_test_add_func ("/memory-output-stream/chunked", test_chunked);
+  g_test_add_func ("/memory-output-stream/steal-as-bytes-list", test_steal_as_bytes_list);
 
   return g_test_run();
 }
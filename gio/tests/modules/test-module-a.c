@@ -57,3 +57,14 @@ GLIB_TEST_EXPORT_SYMBOL void
 g_io_module_unload (GIOModule *module)
 {
 }
+
+GLIB_TEST_EXPORT_SYMBOL char **
+g_io_module_query (void)
+{
+  char *eps[] = {
+    "test-extension-point",
+    NULL
+  };
+
+  return g_strdupv (eps);
+}
@@ -37,6 +37,7 @@ static GCancellable *cancellable;
 static GMainLoop *loop;
 static int nlookups = 0;
 static gboolean synchronous = FALSE;
+static gboolean use_dns = FALSE;
 static guint connectable_count = 0;
 static GResolverRecordType record_type = 0;
 
@@ -47,6 +48,7 @@ usage (void)
 	fprintf (stderr, "Usage: resolver [-s] [-t MX|TXT|NS|SOA] rrname ...\n");
 	fprintf (stderr, "       resolver [-s] -c NUMBER [hostname | IP | service/protocol/domain ]\n");
 	fprintf (stderr, "       Use -s to do synchronous lookups.\n");
+	fprintf (stderr, "       Use -d to do asynchronous lookups with g_resolver_new_dns().\n");
 	fprintf (stderr, "       Use -c NUMBER (and only a single resolvable argument) to test GSocketConnectable.\n");
 	fprintf (stderr, "       The given NUMBER determines how many times the connectable will be enumerated.\n");
 	fprintf (stderr, "       Use -t with MX, TXT, NS or SOA to lookup DNS records of those types.\n");
@@ -669,6 +671,7 @@ record_type_arg (const gchar *option_name,
 
 static const GOptionEntry option_entries[] = {
   { "synchronous", 's', 0, G_OPTION_ARG_NONE, &synchronous, "Synchronous connections", NULL },
+  { "dns", 'd', 0, G_OPTION_ARG_NONE, &use_dns, "Use the non-blocking DNS resolver", NULL },
   { "connectable", 'c', 0, G_OPTION_ARG_INT, &connectable_count, "Connectable count", "C" },
   { "special-type", 't', 0, G_OPTION_ARG_CALLBACK, record_type_arg, "Record type like MX, TXT, NS or SOA", "RR" },
   { NULL },
@@ -696,7 +699,13 @@ main (int argc, char **argv)
   if (argc < 2 || (argc > 2 && connectable_count))
     usage ();
 
-  resolver = g_resolver_get_default ();
+  if (use_dns)
+    {
+      resolver = g_resolver_new_dns ();
+      g_resolver_set_default (resolver);
+    }
+  else
+    resolver = g_resolver_get_default ();
 
   cancellable = g_cancellable_new ();
 
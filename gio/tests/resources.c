@@ -18,9 +18,13 @@
 
 #include <string.h>
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #include "gconstructor.h"
 #include "test_resources2.h"
 
+/* used to create resources without a directory structure */
+#include "../gvdb/gvdb-builder.c"
+
 static void
 test_resource (GResource *resource)
 {
@@ -180,6 +184,126 @@ test_resource_data (void)
   g_resource_unref (resource);
 }
 
+static void
+test_resource_decompression_cache (void)
+{
+  GResource *resource;
+  GError *error = NULL;
+  GBytes *data, *data2;
+
+  resource = g_resource_load (g_test_get_filename (G_TEST_BUILT, "test.gresource", NULL), &error);
+  g_assert (resource != NULL);
+  g_assert_no_error (error);
+
+  /* /test1.txt is compressed, so it is only decompressed once */
+  data = g_resource_lookup_data (resource, "/test1.txt", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (g_bytes_get_data (data, NULL), ==, "test1\n");
+
+  data2 = g_resource_lookup_data (resource, "/test1.txt", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert (g_bytes_get_data (data, NULL) == g_bytes_get_data (data2, NULL));
+  g_bytes_unref (data2);
+
+  /* the cached data outlives the resource */
+  g_resource_unref (resource);
+  g_assert_cmpstr (g_bytes_get_data (data, NULL), ==, "test1\n");
+  g_assert_cmpint (g_bytes_get_size (data), ==, 6);
+  g_bytes_unref (data);
+}
+
+static void
+test_resource_prefetch (void)
+{
+  GResource *resource;
+  GError *error = NULL;
+  gboolean found;
+
+  resource = g_resource_load (g_test_get_filename (G_TEST_BUILT, "test.gresource", NULL), &error);
+  g_assert (resource != NULL);
+  g_assert_no_error (error);
+
+  found = g_resource_prefetch (resource, "/test1.txt", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert (found);
+
+  found = g_resource_prefetch (resource, "/a_prefix", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert (found);
+
+  found = g_resource_prefetch (resource, "/", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert (found);
+
+  found = g_resource_prefetch (resource, "/not/there", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND);
+  g_assert (!found);
+  g_clear_error (&error);
+
+  found = g_resources_prefetch ("/a_prefix/", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND);
+  g_assert (!found);
+  g_clear_error (&error);
+
+  g_resources_register (resource);
+
+  found = g_resources_prefetch ("/a_prefix/", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert (found);
+
+  g_resources_unregister (resource);
+  g_resource_unref (resource);
+}
+
+static void
+test_resource_access_log (void)
+{
+  if (g_test_subprocess ())
+    {
+      GResource *resource;
+      GError *error = NULL;
+      GBytes *data;
+      gchar *filename;
+      gchar *contents;
+      gint fd;
+
+      fd = g_file_open_tmp ("resources-XXXXXX", &filename, &error);
+      g_assert_no_error (error);
+      close (fd);
+
+      g_setenv ("G_RESOURCE_ACCESS_LOG", filename, TRUE);
+
+      resource = g_resource_load (g_test_get_filename (G_TEST_BUILT, "test.gresource", NULL), &error);
+      g_assert_no_error (error);
+
+      data = g_resource_lookup_data (resource, "/a_prefix/test2.txt", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+      g_assert_no_error (error);
+      g_bytes_unref (data);
+      data = g_resource_lookup_data (resource, "/test1.txt", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+      g_assert_no_error (error);
+      g_bytes_unref (data);
+      data = g_resource_lookup_data (resource, "/a_prefix/test2.txt", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+      g_assert_no_error (error);
+      g_bytes_unref (data);
+      data = g_resource_lookup_data (resource, "/not/there", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+      g_assert (data == NULL);
+      g_clear_error (&error);
+
+      g_file_get_contents (filename, &contents, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpstr (contents, ==, "/a_prefix/test2.txt\n/test1.txt\n");
+      g_free (contents);
+
+      g_resource_unref (resource);
+      g_unlink (filename);
+      g_free (filename);
+      return;
+    }
+
+  g_test_trap_subprocess (NULL, 0, 0);
+  g_test_trap_assert_passed ();
+}
+
 static void
 test_resource_registered (void)
 {
@@ -302,6 +426,137 @@ test_resource_registered (void)
   g_clear_error (&error);
 }
 
+static void
+insert_file (GHashTable  *table,
+             const gchar *path,
+             const gchar *contents,
+             GvdbItem    *parent)
+{
+  GvdbItem *item;
+  GVariant *array;
+
+  /* uncompressed data is stored with a trailing nul */
+  array = g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, contents, strlen (contents) + 1, 1);
+
+  item = gvdb_hash_table_insert (table, path);
+  gvdb_item_set_value (item, g_variant_new ("(uu@ay)",
+                                            GUINT32_TO_LE (strlen (contents)),
+                                            GUINT32_TO_LE (0),
+                                            array));
+  if (parent)
+    gvdb_item_set_parent (item, parent);
+}
+
+static GResource *
+load_table (GHashTable *table)
+{
+  GResource *resource;
+  GError *error = NULL;
+  gchar *filename;
+  gint fd;
+
+  fd = g_file_open_tmp ("resources-XXXXXX", &filename, &error);
+  g_assert_no_error (error);
+  close (fd);
+
+  gvdb_table_write_contents (table, filename, FALSE, &error);
+  g_assert_no_error (error);
+  g_hash_table_unref (table);
+
+  resource = g_resource_load (filename, &error);
+  g_assert_no_error (error);
+
+  g_unlink (filename);
+  g_free (filename);
+
+  return resource;
+}
+
+static void
+assert_lookup (const gchar *path,
+               const gchar *contents)
+{
+  GError *error = NULL;
+  GBytes *data;
+
+  data = g_resources_lookup_data (path, G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  if (contents == NULL)
+    {
+      g_assert (data == NULL);
+      g_assert_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_NOT_FOUND);
+      g_clear_error (&error);
+    }
+  else
+    {
+      g_assert_no_error (error);
+      g_assert_cmpstr (g_bytes_get_data (data, NULL), ==, contents);
+      g_bytes_unref (data);
+    }
+}
+
+static void
+test_resource_registered_order (void)
+{
+  GResource *resource, *shadow, *flat;
+  GError *error = NULL;
+  GHashTable *table;
+  GvdbItem *dir;
+  char **children;
+
+  resource = g_resource_load (g_test_get_filename (G_TEST_BUILT, "test.gresource", NULL), &error);
+  g_assert_no_error (error);
+
+  /* same layout as glib-compile-resources generates */
+  table = gvdb_hash_table_new (NULL, NULL);
+  dir = gvdb_hash_table_insert (table, "/a_prefix/");
+  gvdb_item_set_parent (dir, gvdb_hash_table_insert (table, "/"));
+  insert_file (table, "/a_prefix/test2.txt", "shadow\n", dir);
+  insert_file (table, "/a_prefix/test3.txt", "test3\n", dir);
+  shadow = load_table (table);
+
+  /* no directories at all */
+  table = gvdb_hash_table_new (NULL, NULL);
+  insert_file (table, "/a_prefix/test2.txt", "flat\n", NULL);
+  insert_file (table, "/elsewhere/test4.txt", "test4\n", NULL);
+  flat = load_table (table);
+
+  g_resources_register (resource);
+  assert_lookup ("/a_prefix/test2.txt", "test2\n");
+  assert_lookup ("/a_prefix/test3.txt", NULL);
+
+  /* the resource registered last wins */
+  g_resources_register (shadow);
+  assert_lookup ("/a_prefix/test2.txt", "shadow\n");
+  assert_lookup ("/a_prefix/test3.txt", "test3\n");
+  assert_lookup ("/test1.txt", "test1\n");
+
+  children = g_resources_enumerate_children ("/a_prefix", G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (g_strv_length (children), ==, 3);
+  g_strfreev (children);
+
+  /* resources without directories are searched for everything */
+  g_resources_register (flat);
+  assert_lookup ("/a_prefix/test2.txt", "flat\n");
+  assert_lookup ("/elsewhere/test4.txt", "test4\n");
+  assert_lookup ("/a_prefix/test3.txt", "test3\n");
+
+  g_resources_unregister (flat);
+  assert_lookup ("/a_prefix/test2.txt", "shadow\n");
+  assert_lookup ("/elsewhere/test4.txt", NULL);
+
+  g_resources_unregister (shadow);
+  assert_lookup ("/a_prefix/test2.txt", "test2\n");
+  assert_lookup ("/a_prefix/test3.txt", NULL);
+
+  g_resources_unregister (resource);
+  assert_lookup ("/a_prefix/test2.txt", NULL);
+
+  g_resource_unref (flat);
+  g_resource_unref (shadow);
+  g_resource_unref (resource);
+}
+
 static void
 test_resource_automatic (void)
 {
@@ -644,7 +899,11 @@ main (int   argc,
 
   g_test_add_func ("/resource/file", test_resource_file);
   g_test_add_func ("/resource/data", test_resource_data);
+  g_test_add_func ("/resource/decompression-cache", test_resource_decompression_cache);
+  g_test_add_func ("/resource/prefetch", test_resource_prefetch);
+  g_test_add_func ("/resource/access-log", test_resource_access_log);
   g_test_add_func ("/resource/registered", test_resource_registered);
+  g_test_add_func ("/resource/registered-order", test_resource_registered_order);
   g_test_add_func ("/resource/manual", test_resource_manual);
   g_test_add_func ("/resource/manual2", test_resource_manual2);
 #ifdef G_HAS_CONSTRUCTORS
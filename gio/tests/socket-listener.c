@@ -80,6 +80,81 @@ test_event_signal (void)
   g_object_unref (listener);
 }
 
+static void
+test_accept_batch (void)
+{
+  GInetAddress *iaddr;
+  GSocketAddress *saddr, *effective_address;
+  GSocketListener *listener;
+  GSocket *clients[5], *socket;
+  GError *error = NULL;
+  gint i;
+
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  saddr = g_inet_socket_address_new (iaddr, 0);
+  g_object_unref (iaddr);
+
+  listener = g_socket_listener_new ();
+  g_socket_listener_set_accept_batch (listener, 0);
+
+  g_socket_listener_add_address (listener,
+                                 saddr,
+                                 G_SOCKET_TYPE_STREAM,
+                                 G_SOCKET_PROTOCOL_TCP,
+                                 NULL,
+                                 &effective_address,
+                                 &error);
+  g_assert_no_error (error);
+  g_object_unref (saddr);
+
+  for (i = 0; i < G_N_ELEMENTS (clients); i++)
+    {
+      clients[i] = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+                                 G_SOCKET_PROTOCOL_TCP, &error);
+      g_assert_no_error (error);
+      g_socket_connect (clients[i], effective_address, NULL, &error);
+      g_assert_no_error (error);
+    }
+
+  /* The first accept picks up all of the connections, and the others
+   * are returned without waiting */
+  for (i = 0; i < G_N_ELEMENTS (clients); i++)
+    {
+      socket = g_socket_listener_accept_socket (listener, NULL, NULL, &error);
+      g_assert_no_error (error);
+      g_assert (G_IS_SOCKET (socket));
+      g_assert_true (g_socket_get_blocking (socket));
+      g_object_unref (socket);
+    }
+
+  /* Connections that are still queued are dropped on close */
+  for (i = 0; i < G_N_ELEMENTS (clients); i++)
+    {
+      g_object_unref (clients[i]);
+      clients[i] = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+                                 G_SOCKET_PROTOCOL_TCP, &error);
+      g_assert_no_error (error);
+      g_socket_connect (clients[i], effective_address, NULL, &error);
+      g_assert_no_error (error);
+    }
+
+  socket = g_socket_listener_accept_socket (listener, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (socket);
+
+  g_socket_listener_close (listener);
+
+  socket = g_socket_listener_accept_socket (listener, NULL, NULL, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CLOSED);
+  g_assert (socket == NULL);
+  g_clear_error (&error);
+
+  for (i = 0; i < G_N_ELEMENTS (clients); i++)
+    g_object_unref (clients[i]);
+  g_object_unref (effective_address);
+  g_object_unref (listener);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -89,6 +164,7 @@ main (int   argc,
   g_test_bug_base ("http://bugzilla.gnome.org/");
 
   g_test_add_func ("/socket-listener/event-signal", test_event_signal);
+  g_test_add_func ("/socket-listener/accept-batch", test_accept_batch);
 
   return g_test_run();
 }
@@ -232,6 +232,93 @@ test_threaded_712570 (void)
   g_mutex_unlock (&mutex_712570);
 }
 
+typedef struct
+{
+  GThread *main_thread;
+  GMutex mutex;
+  GHashTable *threads;
+  gint n_incoming;
+} ShardedData;
+
+static gboolean
+sharded_incoming_cb (GSocketService    *service,
+                     GSocketConnection *connection,
+                     GObject           *source_object,
+                     gpointer           user_data)
+{
+  ShardedData *data = user_data;
+
+  g_assert (g_thread_self () != data->main_thread);
+  g_assert (g_main_context_get_thread_default () != NULL);
+  g_assert (source_object == G_OBJECT (service));
+
+  g_mutex_lock (&data->mutex);
+  g_hash_table_add (data->threads, g_thread_self ());
+  g_mutex_unlock (&data->mutex);
+
+  g_atomic_int_inc (&data->n_incoming);
+
+  return TRUE;
+}
+
+static void
+test_sharded (void)
+{
+  ShardedData data;
+  GSocketService *service;
+  GSocketClient *client;
+  GSocketConnection *connections[20];
+  guint n_shards = 0;
+  guint16 port;
+  GError *error = NULL;
+  gint i;
+
+  data.main_thread = g_thread_self ();
+  g_mutex_init (&data.mutex);
+  data.threads = g_hash_table_new (NULL, NULL);
+  data.n_incoming = 0;
+
+  service = g_socket_service_new_sharded (4);
+  g_object_get (service, "shards", &n_shards, NULL);
+  g_assert_cmpuint (n_shards, ==, 4);
+
+  g_signal_connect (service, "incoming", G_CALLBACK (sharded_incoming_cb), &data);
+
+  port = g_socket_listener_add_any_inet_port (G_SOCKET_LISTENER (service),
+                                              G_OBJECT (service), &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (port, !=, 0);
+
+  client = g_socket_client_new ();
+  for (i = 0; i < G_N_ELEMENTS (connections); i++)
+    {
+      connections[i] = g_socket_client_connect_to_host (client, "localhost",
+                                                        port, NULL, &error);
+      g_assert_no_error (error);
+    }
+
+  while (g_atomic_int_get (&data.n_incoming) < G_N_ELEMENTS (connections))
+    g_usleep (1000);
+
+  g_mutex_lock (&data.mutex);
+  g_assert_cmpuint (g_hash_table_size (data.threads), >=, 1);
+  g_assert_cmpuint (g_hash_table_size (data.threads), <=, 4);
+  g_mutex_unlock (&data.mutex);
+
+  g_socket_service_stop (service);
+  g_socket_listener_close (G_SOCKET_LISTENER (service));
+
+  for (i = 0; i < G_N_ELEMENTS (connections); i++)
+    g_object_unref (connections[i]);
+  g_object_unref (client);
+  g_object_unref (service);
+
+  g_assert_cmpint (data.n_incoming, ==, G_N_ELEMENTS (connections));
+
+  g_hash_table_unref (data.threads);
+  g_mutex_clear (&data.mutex);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -242,6 +329,7 @@ main (int   argc,
 
   g_test_add_func ("/socket-service/start-stop", test_start_stop);
   g_test_add_func ("/socket-service/threaded/712570", test_threaded_712570);
+  g_test_add_func ("/socket-service/sharded", test_sharded);
 
   return g_test_run();
 }
@@ -25,6 +25,11 @@
 #include <stdlib.h>
 #include <gio/gnetworking.h>
 #include <gio/gunixconnection.h>
+#include <gio/gudpsegmentmessage.h>
+#endif
+
+#ifdef __linux__
+#include <netinet/udp.h>
 #endif
 
 #include "gnetworkingprivate.h"
@@ -1386,6 +1391,240 @@ test_unix_connection_ancillary_data (void)
    * g_unix_connection_receive_credentials().
    */
 }
+
+#ifdef __linux__
+static void
+test_udp_segment_message (void)
+{
+  GSocket *server, *client;
+  GSocketAddress *addr;
+  GInetAddress *iaddr;
+  GSocketControlMessage *message;
+  GOutputVector out_vector;
+  GOutputMessage out_message;
+  GInputVector in_vectors[4];
+  GInputMessage in_messages[4];
+  gchar buffer[300], in_buffers[4][300];
+  GError *error = NULL;
+  gint i, n_received;
+
+  if (!g_udp_segment_message_is_supported ())
+    {
+      g_test_skip ("UDP segmentation offload is not supported");
+      return;
+    }
+
+  server = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+                         G_SOCKET_PROTOCOL_UDP, &error);
+  g_assert_no_error (error);
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (iaddr, 0);
+  g_object_unref (iaddr);
+  g_socket_bind (server, addr, TRUE, &error);
+  g_assert_no_error (error);
+  g_object_unref (addr);
+  addr = g_socket_get_local_address (server, &error);
+  g_assert_no_error (error);
+
+  client = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+                         G_SOCKET_PROTOCOL_UDP, &error);
+  g_assert_no_error (error);
+
+  /* One buffer goes out as three datagrams */
+  memset (buffer, 'x', sizeof buffer);
+  out_vector.buffer = buffer;
+  out_vector.size = sizeof buffer;
+  message = g_udp_segment_message_new (100);
+  out_message.address = addr;
+  out_message.vectors = &out_vector;
+  out_message.num_vectors = 1;
+  out_message.bytes_sent = 0;
+  out_message.control_messages = &message;
+  out_message.num_control_messages = 1;
+
+  if (g_socket_send_messages (client, &out_message, 1, 0, NULL, &error) < 0)
+    {
+      /* e.g. an old kernel */
+      g_test_skip (error->message);
+      g_clear_error (&error);
+      goto out;
+    }
+  g_assert_cmpuint (out_message.bytes_sent, ==, sizeof buffer);
+
+  g_socket_set_timeout (server, 2);
+  for (n_received = 0; n_received < 3; )
+    {
+      gint n;
+
+      for (i = 0; i < G_N_ELEMENTS (in_messages); i++)
+        {
+          in_vectors[i].buffer = in_buffers[i];
+          in_vectors[i].size = sizeof in_buffers[i];
+          in_messages[i].address = NULL;
+          in_messages[i].vectors = &in_vectors[i];
+          in_messages[i].num_vectors = 1;
+          in_messages[i].bytes_received = 0;
+          in_messages[i].flags = 0;
+          in_messages[i].control_messages = NULL;
+          in_messages[i].num_control_messages = NULL;
+        }
+
+      n = g_socket_receive_messages (server, in_messages, 3 - n_received,
+                                     0, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (n, >, 0);
+
+      for (i = 0; i < n; i++)
+        g_assert_cmpuint (in_messages[i].bytes_received, ==, 100);
+      n_received += n;
+    }
+
+ out:
+  g_object_unref (message);
+  g_object_unref (addr);
+  g_object_unref (client);
+  g_object_unref (server);
+}
+
+static void
+test_udp_segment_message_deserialize (void)
+{
+  GSocketControlMessage *message;
+  gint gro_size = 1200;
+  guint16 gso_size = 1400;
+  gchar data[2];
+
+  if (!g_udp_segment_message_is_supported ())
+    {
+      g_test_skip ("UDP segmentation offload is not supported");
+      return;
+    }
+
+  /* What the kernel hands back for UDP_GRO */
+  message = g_socket_control_message_deserialize (SOL_UDP, UDP_GRO,
+                                                  sizeof gro_size, &gro_size);
+  g_assert (G_IS_UDP_SEGMENT_MESSAGE (message));
+  g_assert_cmpuint (g_udp_segment_message_get_segment_size (G_UDP_SEGMENT_MESSAGE (message)), ==, 1200);
+  g_object_unref (message);
+
+  message = g_socket_control_message_deserialize (SOL_UDP, UDP_SEGMENT,
+                                                  sizeof gso_size, &gso_size);
+  g_assert (G_IS_UDP_SEGMENT_MESSAGE (message));
+  g_assert_cmpint (g_socket_control_message_get_level (message), ==, SOL_UDP);
+  g_assert_cmpint (g_socket_control_message_get_msg_type (message), ==, UDP_SEGMENT);
+  g_assert_cmpuint (g_socket_control_message_get_size (message), ==, sizeof data);
+  g_socket_control_message_serialize (message, data);
+  g_assert (memcmp (data, &gso_size, sizeof data) == 0);
+  g_object_unref (message);
+}
+#endif /* __linux__ */
+
+static gpointer
+drain_socket_thread (gpointer user_data)
+{
+  GSocket *socket = user_data;
+  GByteArray *received;
+  gchar buffer[16384];
+  GError *error = NULL;
+  gssize n;
+
+  received = g_byte_array_new ();
+  while ((n = g_socket_receive (socket, buffer, sizeof buffer, NULL, &error)) > 0)
+    g_byte_array_append (received, (guint8 *) buffer, n);
+  g_assert_no_error (error);
+
+  return received;
+}
+
+static void
+splice_file_cb (GObject      *source,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+  gssize *spliced = user_data;
+  GError *error = NULL;
+
+  *spliced = g_output_stream_splice_finish (G_OUTPUT_STREAM (source), result, &error);
+  g_assert_no_error (error);
+}
+
+static void
+test_splice_file (gconstpointer user_data)
+{
+  gboolean async = GPOINTER_TO_INT (user_data);
+  GSocket *sockets[2];
+  GSocketConnection *connection;
+  GFileIOStream *iostream;
+  GFile *file;
+  GInputStream *input;
+  GByteArray *received;
+  GThread *thread;
+  gchar *contents;
+  gsize length, i;
+  gssize spliced;
+  GError *error = NULL;
+  int fds[2];
+
+  /* Large enough not to fit into the socket buffers */
+  length = 4 * 1024 * 1024 + 17;
+  contents = g_malloc (length);
+  for (i = 0; i < length; i++)
+    contents[i] = i % 251;
+
+  file = g_file_new_tmp ("splice-fileXXXXXX", &iostream, &error);
+  g_assert_no_error (error);
+  g_object_unref (iostream);
+  g_file_replace_contents (file, contents, length, NULL, FALSE,
+                           G_FILE_CREATE_NONE, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  g_assert_cmpint (socketpair (AF_UNIX, SOCK_STREAM, 0, fds), ==, 0);
+  sockets[0] = g_socket_new_from_fd (fds[0], &error);
+  g_assert_no_error (error);
+  sockets[1] = g_socket_new_from_fd (fds[1], &error);
+  g_assert_no_error (error);
+  connection = g_socket_connection_factory_create_connection (sockets[0]);
+
+  thread = g_thread_new ("drain", drain_socket_thread, sockets[1]);
+
+  input = G_INPUT_STREAM (g_file_read (file, NULL, &error));
+  g_assert_no_error (error);
+
+  if (async)
+    {
+      spliced = 0;
+      g_output_stream_splice_async (g_io_stream_get_output_stream (G_IO_STREAM (connection)),
+                                    input, G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE,
+                                    G_PRIORITY_DEFAULT, NULL,
+                                    splice_file_cb, &spliced);
+      while (spliced == 0)
+        g_main_context_iteration (NULL, TRUE);
+    }
+  else
+    {
+      spliced = g_output_stream_splice (g_io_stream_get_output_stream (G_IO_STREAM (connection)),
+                                        input, G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE,
+                                        NULL, &error);
+      g_assert_no_error (error);
+    }
+  g_assert_cmpint (spliced, ==, length);
+  g_assert (g_input_stream_is_closed (input));
+
+  g_socket_shutdown (sockets[0], FALSE, TRUE, &error);
+  g_assert_no_error (error);
+  received = g_thread_join (thread);
+  g_assert_cmpuint (received->len, ==, length);
+  g_assert (memcmp (received->data, contents, length) == 0);
+
+  g_byte_array_unref (received);
+  g_object_unref (input);
+  g_object_unref (connection);
+  g_object_unref (sockets[0]);
+  g_object_unref (sockets[1]);
+  g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+  g_free (contents);
+}
 #endif /* G_OS_UNIX */
 
 static void
@@ -1599,6 +1838,306 @@ test_get_available (gconstpointer user_data)
   g_object_unref (client);
 }
 
+/* A connectable that enumerates a fixed list of addresses, in order */
+typedef struct {
+  GObject parent_instance;
+  GList *addresses;
+} TestConnectable;
+
+typedef GObjectClass TestConnectableClass;
+
+typedef struct {
+  GSocketAddressEnumerator parent_instance;
+  GList *next;
+} TestEnumerator;
+
+typedef GSocketAddressEnumeratorClass TestEnumeratorClass;
+
+static GType test_connectable_get_type (void);
+static GType test_enumerator_get_type (void);
+static void test_connectable_iface_init (GSocketConnectableIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TestConnectable, test_connectable, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_SOCKET_CONNECTABLE,
+                                                test_connectable_iface_init))
+G_DEFINE_TYPE (TestEnumerator, test_enumerator, G_TYPE_SOCKET_ADDRESS_ENUMERATOR)
+
+static void
+test_connectable_finalize (GObject *object)
+{
+  TestConnectable *connectable = (TestConnectable *) object;
+
+  g_list_free_full (connectable->addresses, g_object_unref);
+
+  G_OBJECT_CLASS (test_connectable_parent_class)->finalize (object);
+}
+
+static void
+test_connectable_init (TestConnectable *connectable)
+{
+}
+
+static void
+test_connectable_class_init (TestConnectableClass *klass)
+{
+  klass->finalize = test_connectable_finalize;
+}
+
+static GSocketAddressEnumerator *
+test_connectable_enumerate (GSocketConnectable *connectable)
+{
+  TestEnumerator *enumerator;
+
+  enumerator = g_object_new (test_enumerator_get_type (), NULL);
+  enumerator->next = ((TestConnectable *) connectable)->addresses;
+
+  return G_SOCKET_ADDRESS_ENUMERATOR (enumerator);
+}
+
+static void
+test_connectable_iface_init (GSocketConnectableIface *iface)
+{
+  iface->enumerate = test_connectable_enumerate;
+}
+
+static GSocketAddress *
+test_enumerator_next (GSocketAddressEnumerator  *enumerator,
+                      GCancellable              *cancellable,
+                      GError                   **error)
+{
+  TestEnumerator *self = (TestEnumerator *) enumerator;
+  GSocketAddress *address;
+
+  if (self->next == NULL)
+    return NULL;
+
+  address = g_object_ref (self->next->data);
+  self->next = self->next->next;
+
+  return address;
+}
+
+static void
+test_enumerator_init (TestEnumerator *enumerator)
+{
+}
+
+static void
+test_enumerator_class_init (TestEnumeratorClass *klass)
+{
+  klass->next = test_enumerator_next;
+}
+
+static GSocket *
+listen_on_loopback (gint backlog)
+{
+  GInetAddress *iaddr;
+  GSocketAddress *addr;
+  GSocket *socket;
+  GError *error = NULL;
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+                         G_SOCKET_PROTOCOL_DEFAULT, &error);
+  g_assert_no_error (error);
+
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (iaddr, 0);
+  g_socket_bind (socket, addr, TRUE, &error);
+  g_assert_no_error (error);
+  g_object_unref (addr);
+  g_object_unref (iaddr);
+
+  g_socket_set_listen_backlog (socket, backlog);
+  g_socket_listen (socket, &error);
+  g_assert_no_error (error);
+
+  return socket;
+}
+
+static void
+happy_eyeballs_connected (GObject      *source,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  GSocketConnection **connection = user_data;
+  GError *error = NULL;
+
+  *connection = g_socket_client_connect_finish (G_SOCKET_CLIENT (source),
+                                                result, &error);
+  g_assert_no_error (error);
+}
+
+static void
+test_client_happy_eyeballs (void)
+{
+  TestConnectable *connectable;
+  GSocket *black_hole, *filler, *server;
+  GSocketAddress *black_hole_addr, *server_addr, *remote_addr;
+  GSocketClient *client;
+  GSocketConnection *connection = NULL;
+  GError *error = NULL;
+  gint64 start;
+
+  /* Once the accept queue of a socket with a backlog of zero is full,
+   * Linux silently drops further SYNs, so connecting to it hangs much
+   * like connecting to an address without a working route does.
+   */
+  black_hole = listen_on_loopback (0);
+  black_hole_addr = g_socket_get_local_address (black_hole, &error);
+  g_assert_no_error (error);
+
+  filler = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+                         G_SOCKET_PROTOCOL_DEFAULT, &error);
+  g_assert_no_error (error);
+  g_socket_connect (filler, black_hole_addr, NULL, &error);
+  g_assert_no_error (error);
+
+  server = listen_on_loopback (10);
+  server_addr = g_socket_get_local_address (server, &error);
+  g_assert_no_error (error);
+
+  connectable = g_object_new (test_connectable_get_type (), NULL);
+  connectable->addresses = g_list_append (connectable->addresses, g_object_ref (black_hole_addr));
+  connectable->addresses = g_list_append (connectable->addresses, g_object_ref (server_addr));
+
+  client = g_socket_client_new ();
+  g_socket_client_set_enable_proxy (client, FALSE);
+  g_socket_client_set_connection_attempt_delay (client, 50);
+
+  start = g_get_monotonic_time ();
+  g_socket_client_connect_async (client, G_SOCKET_CONNECTABLE (connectable), NULL,
+                                 happy_eyeballs_connected, &connection);
+  while (connection == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  /* well below the first SYN retransmission timeout */
+  g_assert_cmpint (g_get_monotonic_time () - start, <, G_USEC_PER_SEC);
+
+  remote_addr = g_socket_connection_get_remote_address (connection, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (remote_addr)), ==,
+                   g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (server_addr)));
+  g_object_unref (remote_addr);
+
+  g_object_unref (connection);
+  g_object_unref (client);
+  g_object_unref (connectable);
+  g_object_unref (server_addr);
+  g_object_unref (server);
+  g_object_unref (filler);
+  g_object_unref (black_hole_addr);
+  g_object_unref (black_hole);
+}
+
+static void
+test_tcp_options (void)
+{
+  GSocket *sock;
+  gboolean nodelay = TRUE;
+  GError *error = NULL;
+
+  sock = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+                       G_SOCKET_PROTOCOL_DEFAULT, &error);
+  g_assert_no_error (error);
+
+  g_assert_false (g_socket_get_tcp_nodelay (sock));
+  g_socket_set_tcp_nodelay (sock, TRUE);
+  g_assert_true (g_socket_get_tcp_nodelay (sock));
+  g_object_set (sock, "tcp-nodelay", FALSE, NULL);
+  g_object_get (sock, "tcp-nodelay", &nodelay, NULL);
+  g_assert_false (nodelay);
+
+  /* The kernel is free to round these up */
+  g_socket_set_send_buffer_size (sock, 65536);
+  g_assert_cmpuint (g_socket_get_send_buffer_size (sock), >=, 65536);
+  g_socket_set_receive_buffer_size (sock, 65536);
+  g_assert_cmpuint (g_socket_get_receive_buffer_size (sock), >=, 65536);
+
+#ifdef __linux__
+  g_assert_cmpuint (g_socket_get_tcp_notsent_lowat (sock), ==, 0);
+  g_socket_set_tcp_notsent_lowat (sock, 16384);
+  g_assert_cmpuint (g_socket_get_tcp_notsent_lowat (sock), ==, 16384);
+#endif
+
+  g_object_unref (sock);
+}
+
+static void
+tcp_fast_open_server_thread (gpointer user_data)
+{
+  GSocketListener *listener = user_data;
+  GSocketConnection *connection;
+  GInputStream *input;
+  GOutputStream *output;
+  gchar buf[128];
+  gssize len;
+  GError *error = NULL;
+
+  connection = g_socket_listener_accept (listener, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  input = g_io_stream_get_input_stream (G_IO_STREAM (connection));
+  output = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+
+  len = g_input_stream_read (input, buf, sizeof buf, NULL, &error);
+  g_assert_no_error (error);
+  g_output_stream_write_all (output, buf, len, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  g_object_unref (connection);
+}
+
+static void
+test_tcp_fast_open (void)
+{
+  GSocketListener *listener;
+  GSocketClient *client;
+  GSocketConnection *connection;
+  GInputStream *input;
+  GOutputStream *output;
+  GThread *thread;
+  guint16 port;
+  gchar buf[128];
+  gsize len;
+  gint i;
+  GError *error = NULL;
+
+  listener = g_socket_listener_new ();
+  g_socket_listener_set_tcp_fast_open (listener, 16);
+  port = g_socket_listener_add_any_inet_port (listener, NULL, &error);
+  g_assert_no_error (error);
+
+  client = g_socket_client_new ();
+  g_socket_client_set_tcp_nodelay (client, TRUE);
+  g_socket_client_set_tcp_fast_open (client, TRUE);
+
+  /* Whether or not the kernel supports Fast Open, or already has a
+   * cookie for the server, the connection must behave the same */
+  for (i = 0; i < 2; i++)
+    {
+      thread = g_thread_new ("server", (GThreadFunc) tcp_fast_open_server_thread, listener);
+
+      connection = g_socket_client_connect_to_host (client, "127.0.0.1", port, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_true (g_socket_get_tcp_nodelay (g_socket_connection_get_socket (connection)));
+
+      input = g_io_stream_get_input_stream (G_IO_STREAM (connection));
+      output = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+
+      g_output_stream_write_all (output, "hello", 5, NULL, NULL, &error);
+      g_assert_no_error (error);
+      g_input_stream_read_all (input, buf, 5, &len, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpmem (buf, len, "hello", 5);
+
+      g_thread_join (thread);
+      g_object_unref (connection);
+    }
+
+  g_object_unref (client);
+  g_object_unref (listener);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -1643,13 +2182,24 @@ main (int   argc,
   g_test_add_func ("/socket/unix-from-fd", test_unix_from_fd);
   g_test_add_func ("/socket/unix-connection", test_unix_connection);
   g_test_add_func ("/socket/unix-connection-ancillary-data", test_unix_connection_ancillary_data);
+#ifdef __linux__
+  g_test_add_func ("/socket/udp-segment-message", test_udp_segment_message);
+  g_test_add_func ("/socket/udp-segment-message/deserialize", test_udp_segment_message_deserialize);
+#endif
+  g_test_add_data_func ("/socket/splice-file/sync", GINT_TO_POINTER (FALSE), test_splice_file);
+  g_test_add_data_func ("/socket/splice-file/async", GINT_TO_POINTER (TRUE), test_splice_file);
 #endif
   g_test_add_func ("/socket/reuse/tcp", test_reuse_tcp);
+  g_test_add_func ("/socket/tcp-options", test_tcp_options);
+  g_test_add_func ("/socket/tcp-fast-open", test_tcp_fast_open);
   g_test_add_func ("/socket/reuse/udp", test_reuse_udp);
   g_test_add_data_func ("/socket/get_available/datagram", GUINT_TO_POINTER (G_SOCKET_TYPE_DATAGRAM),
                         test_get_available);
   g_test_add_data_func ("/socket/get_available/stream", GUINT_TO_POINTER (G_SOCKET_TYPE_STREAM),
                         test_get_available);
+#ifdef __linux__
+  g_test_add_func ("/socket/client/happy-eyeballs", test_client_happy_eyeballs);
+#endif
 
   return g_test_run();
 }
@@ -113,6 +113,114 @@ test_write_all_async_memory (void)
   g_object_unref (ms);
 }
 
+static gboolean got_writev_done;
+
+static void
+writev_done (GObject      *source,
+             GAsyncResult *result,
+             gpointer      user_data)
+{
+  gboolean success;
+  gsize written;
+
+  success = g_output_stream_writev_all_finish (G_OUTPUT_STREAM (source), result, &written, NULL);
+  g_assert_cmpint (expected_write_success, ==, success);
+  g_assert_cmpint (expected_written, ==, written);
+  got_writev_done = TRUE;
+}
+
+static void
+wait_for_writev (gboolean success,
+                 gsize    written)
+{
+  g_assert (!got_writev_done);
+  expected_write_success = success;
+  expected_written = written;
+
+  while (!got_writev_done)
+    g_main_context_iteration (NULL, TRUE);
+
+  got_writev_done = FALSE;
+}
+
+static void
+test_writev_all_memory (void)
+{
+  GOutputStream *ms;
+  GError *error = NULL;
+  GOutputVector vectors[3];
+  gsize written;
+  gchar b[24];
+
+  ms = g_memory_output_stream_new (b, sizeof b, NULL, NULL);
+
+  vectors[0].buffer = "0123";
+  vectors[0].size = 4;
+  vectors[1].buffer = "";
+  vectors[1].size = 0;
+  vectors[2].buffer = "456789";
+  vectors[2].size = 6;
+  g_assert_cmpint (g_output_stream_writev (ms, vectors, 3, NULL, &error), ==, 10);
+  g_assert_no_error (error);
+
+  vectors[0].buffer = "01234567";
+  vectors[0].size = 8;
+  vectors[1].buffer = "89";
+  vectors[1].size = 2;
+  g_assert (g_output_stream_writev_all (ms, vectors, 2, &written, NULL, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (written, ==, 10);
+
+  /* out of space, but we see the partial write */
+  vectors[0].buffer = "01";
+  vectors[0].size = 2;
+  vectors[1].buffer = "23456789";
+  vectors[1].size = 8;
+  g_assert (!g_output_stream_writev_all (ms, vectors, 2, &written, NULL, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE);
+  g_assert_cmpuint (written, ==, 4);
+  g_clear_error (&error);
+
+  g_assert (!memcmp (b, "012345678901234567890123", 24));
+
+  g_object_unref (ms);
+}
+
+static void
+test_writev_all_async_memory (void)
+{
+  GOutputStream *ms;
+  GOutputVector vectors[2];
+  gchar b[24];
+
+  ms = g_memory_output_stream_new (b, sizeof b, NULL, NULL);
+
+  vectors[0].buffer = "01234";
+  vectors[0].size = 5;
+  vectors[1].buffer = "56789";
+  vectors[1].size = 5;
+  g_output_stream_writev_all_async (ms, vectors, 2, 0, NULL, writev_done, NULL);
+  wait_for_writev (TRUE, 10);
+
+  vectors[0].buffer = "01234";
+  vectors[0].size = 5;
+  vectors[1].buffer = "56789";
+  vectors[1].size = 5;
+  g_output_stream_writev_all_async (ms, vectors, 2, 0, NULL, writev_done, NULL);
+  wait_for_writev (TRUE, 10);
+
+  vectors[0].buffer = "01234";
+  vectors[0].size = 5;
+  vectors[1].buffer = "56789";
+  vectors[1].size = 5;
+  g_output_stream_writev_all_async (ms, vectors, 2, 0, NULL, writev_done, NULL);
+  wait_for_writev (FALSE, 4);
+
+  g_assert (!memcmp (b, "012345678901234567890123", 24));
+
+  g_object_unref (ms);
+}
+
 static void
 test_read_all_async_memory (void)
 {
@@ -240,6 +348,233 @@ test_read_write_all_async_pipe (void)
   g_object_unref (out);
   g_object_unref (in);
 }
+
+static void
+check_writev_stream (GOutputStream *out,
+                     GInputStream  *in)
+{
+  GError *error = NULL;
+  GOutputVector vectors[3];
+  gchar wbuf[100] = { 0, };
+  gchar rbuf[100];
+  gsize in_flight;
+  gssize s;
+
+  vectors[0].buffer = "012";
+  vectors[0].size = 3;
+  vectors[1].buffer = "3456";
+  vectors[1].size = 4;
+  vectors[2].buffer = "789";
+  vectors[2].size = 3;
+
+  /* a single writev() gathers all of the vectors */
+  s = g_output_stream_writev (out, vectors, 3, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (s, ==, 10);
+  g_assert (g_input_stream_read_all (in, rbuf, 10, NULL, NULL, &error));
+  g_assert_no_error (error);
+  g_assert (!memcmp (rbuf, "0123456789", 10));
+
+  s = g_pollable_output_stream_writev_nonblocking (G_POLLABLE_OUTPUT_STREAM (out),
+                                                   vectors, 3, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (s, ==, 10);
+  g_assert (g_input_stream_read_all (in, rbuf, 10, NULL, NULL, &error));
+  g_assert_no_error (error);
+  g_assert (!memcmp (rbuf, "0123456789", 10));
+
+  /* Fill up the buffer */
+  in_flight = 0;
+  while ((s = g_pollable_output_stream_write_nonblocking (G_POLLABLE_OUTPUT_STREAM (out),
+                                                          wbuf, sizeof wbuf,
+                                                          NULL, &error)) > 0)
+    in_flight += s;
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK);
+  g_clear_error (&error);
+
+  s = g_pollable_output_stream_writev_nonblocking (G_POLLABLE_OUTPUT_STREAM (out),
+                                                   vectors, 3, NULL, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK);
+  g_assert_cmpint (s, ==, -1);
+  g_clear_error (&error);
+
+  /* The async version waits for the stream to become writable */
+  g_output_stream_writev_all_async (out, vectors, 3, 0, NULL, writev_done, NULL);
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+  g_assert (!got_writev_done);
+
+  while (in_flight)
+    {
+      s = g_input_stream_read (in, rbuf, MIN (sizeof rbuf, in_flight), NULL, &error);
+      g_assert_no_error (error);
+      g_assert (s > 0);
+      in_flight -= s;
+    }
+
+  wait_for_writev (TRUE, 10);
+  g_assert (g_input_stream_read_all (in, rbuf, 10, NULL, NULL, &error));
+  g_assert_no_error (error);
+  g_assert (!memcmp (rbuf, "0123456789", 10));
+}
+
+static void
+test_writev_pipe (void)
+{
+  GOutputStream *out;
+  GInputStream *in;
+  gint sv[2];
+
+  g_assert_cmpint (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), ==, 0);
+
+  out = g_unix_output_stream_new (sv[0], TRUE);
+  in = g_unix_input_stream_new (sv[1], TRUE);
+
+  check_writev_stream (out, in);
+
+  g_object_unref (out);
+  g_object_unref (in);
+}
+
+static void
+test_writev_socket (void)
+{
+  GSocketConnection *client, *server;
+  GSocket *socket;
+  GError *error = NULL;
+  gint sv[2];
+
+  g_assert_cmpint (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), ==, 0);
+
+  socket = g_socket_new_from_fd (sv[0], &error);
+  g_assert_no_error (error);
+  client = g_socket_connection_factory_create_connection (socket);
+  g_object_unref (socket);
+
+  socket = g_socket_new_from_fd (sv[1], &error);
+  g_assert_no_error (error);
+  server = g_socket_connection_factory_create_connection (socket);
+  g_object_unref (socket);
+
+  check_writev_stream (g_io_stream_get_output_stream (G_IO_STREAM (client)),
+                       g_io_stream_get_input_stream (G_IO_STREAM (server)));
+
+  g_object_unref (client);
+  g_object_unref (server);
+}
+
+static void
+read_bytes_done (GObject      *source,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+  GAsyncResult **result_out = user_data;
+
+  g_assert (*result_out == NULL);
+  *result_out = g_object_ref (result);
+}
+
+static GBytes *
+wait_for_read_bytes (GInputStream  *in,
+                     GAsyncResult **result,
+                     GError       **error)
+{
+  GBytes *bytes;
+
+  while (*result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  bytes = g_input_stream_read_bytes_finish (in, *result, error);
+  g_clear_object (result);
+
+  return bytes;
+}
+
+static void
+test_read_bytes_async_socket (void)
+{
+  GSocketConnection *client, *server;
+  GCancellable *cancellable;
+  GAsyncResult *result = NULL;
+  GOutputStream *out;
+  GInputStream *in;
+  GSocket *socket;
+  GError *error = NULL;
+  GBytes *bytes;
+  gchar wbuf[3000];
+  gint sv[2];
+
+  g_assert_cmpint (socketpair (AF_UNIX, SOCK_STREAM, 0, sv), ==, 0);
+
+  socket = g_socket_new_from_fd (sv[0], &error);
+  g_assert_no_error (error);
+  client = g_socket_connection_factory_create_connection (socket);
+  g_object_unref (socket);
+
+  socket = g_socket_new_from_fd (sv[1], &error);
+  g_assert_no_error (error);
+  server = g_socket_connection_factory_create_connection (socket);
+  g_object_unref (socket);
+
+  out = g_io_stream_get_output_stream (G_IO_STREAM (client));
+  in = g_io_stream_get_input_stream (G_IO_STREAM (server));
+
+  /* Nothing to read yet: the stream stays pending until data arrives */
+  g_input_stream_read_bytes_async (in, 4096, 0, NULL, read_bytes_done, &result);
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+  g_assert (result == NULL);
+  g_assert (g_input_stream_has_pending (in));
+
+  g_output_stream_write_all (out, "0123456789", 10, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  bytes = wait_for_read_bytes (in, &result, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, 10);
+  g_assert (!memcmp (g_bytes_get_data (bytes, NULL), "0123456789", 10));
+  g_assert (!g_input_stream_has_pending (in));
+  g_bytes_unref (bytes);
+
+  /* Data which is already there is returned immediately */
+  memset (wbuf, 'x', sizeof wbuf);
+  g_output_stream_write_all (out, wbuf, sizeof wbuf, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  g_input_stream_read_bytes_async (in, 4096, 0, NULL, read_bytes_done, &result);
+  bytes = wait_for_read_bytes (in, &result, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, sizeof wbuf);
+  g_assert (!memcmp (g_bytes_get_data (bytes, NULL), wbuf, sizeof wbuf));
+  g_bytes_unref (bytes);
+
+  /* Cancelling a waiting read releases the stream */
+  cancellable = g_cancellable_new ();
+  g_input_stream_read_bytes_async (in, 4096, 0, cancellable, read_bytes_done, &result);
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+  g_assert (result == NULL);
+  g_cancellable_cancel (cancellable);
+  bytes = wait_for_read_bytes (in, &result, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert (bytes == NULL);
+  g_assert (!g_input_stream_has_pending (in));
+  g_clear_error (&error);
+  g_object_unref (cancellable);
+
+  /* EOF gives an empty GBytes */
+  g_io_stream_close (G_IO_STREAM (client), NULL, &error);
+  g_assert_no_error (error);
+
+  g_input_stream_read_bytes_async (in, 200000, 0, NULL, read_bytes_done, &result);
+  bytes = wait_for_read_bytes (in, &result, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, 0);
+  g_bytes_unref (bytes);
+
+  g_object_unref (client);
+  g_object_unref (server);
+}
 #endif
 
 int
@@ -250,8 +585,13 @@ main (int    argc,
 
   g_test_add_func ("/stream/read_all_async/memory", test_read_all_async_memory);
   g_test_add_func ("/stream/write_all_async/memory", test_write_all_async_memory);
+  g_test_add_func ("/stream/writev_all/memory", test_writev_all_memory);
+  g_test_add_func ("/stream/writev_all_async/memory", test_writev_all_async_memory);
 #ifdef G_OS_UNIX
   g_test_add_func ("/stream/read_write_all_async/pipe", test_read_write_all_async_pipe);
+  g_test_add_func ("/stream/writev/pipe", test_writev_pipe);
+  g_test_add_func ("/stream/writev/socket", test_writev_socket);
+  g_test_add_func ("/stream/read_bytes_async/socket", test_read_bytes_async_socket);
 #endif
 
   return g_test_run();
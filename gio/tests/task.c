@@ -268,6 +268,166 @@ test_return_from_same_iteration (void)
   g_assert_true (same_notification_emitted);
 }
 
+/* test_return_batched: tasks that cannot complete immediately are
+ * completed in order, from a single shared source per priority.
+ */
+#define N_BATCHED_TASKS 100
+
+typedef struct {
+  gint next;
+  GSource *default_source;
+  GSource *high_source;
+  gboolean high_seen;
+} BatchedData;
+
+static void
+batched_callback (GObject      *object,
+                  GAsyncResult *result,
+                  gpointer      user_data)
+{
+  BatchedData *data = user_data;
+  GTask *task = G_TASK (result);
+  GSource *source = g_main_current_source ();
+  GError *error = NULL;
+
+  if (g_task_get_priority (task) == G_PRIORITY_HIGH)
+    {
+      g_assert_cmpint (data->next, ==, 0);
+      data->high_source = source;
+      data->high_seen = TRUE;
+      g_assert_true (g_task_propagate_boolean (task, &error));
+      g_assert_no_error (error);
+      return;
+    }
+
+  g_assert_true (data->high_seen);
+  if (data->default_source == NULL)
+    data->default_source = source;
+  g_assert (source == data->default_source);
+
+  g_assert_cmpint (g_task_propagate_int (task, &error), ==, data->next);
+  g_assert_no_error (error);
+
+  if (++data->next == N_BATCHED_TASKS)
+    g_main_loop_quit (loop);
+}
+
+static gboolean
+batched_start (gpointer user_data)
+{
+  BatchedData *data = user_data;
+  GTask *task;
+  gint i;
+
+  for (i = 0; i < N_BATCHED_TASKS; i++)
+    {
+      task = g_task_new (NULL, NULL, batched_callback, data);
+      g_task_return_int (task, i);
+      g_object_unref (task);
+    }
+
+  task = g_task_new (NULL, NULL, batched_callback, data);
+  g_task_set_priority (task, G_PRIORITY_HIGH);
+  g_task_return_boolean (task, TRUE);
+  g_object_unref (task);
+
+  g_assert_cmpint (data->next, ==, 0);
+
+  return FALSE;
+}
+
+static void
+test_return_batched (void)
+{
+  BatchedData data = { 0, };
+
+  g_idle_add (batched_start, &data);
+  g_main_loop_run (loop);
+
+  g_assert_cmpint (data.next, ==, N_BATCHED_TASKS);
+  g_assert_nonnull (data.default_source);
+  g_assert (data.high_source != data.default_source);
+}
+
+/* test_return_batched_ordering: batching completions does not reorder
+ * them with respect to sources attached before the task returned.
+ */
+static gboolean
+ordering_mark (gpointer user_data)
+{
+  GString *order = user_data;
+
+  g_string_append_c (order, '.');
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ordering_callback (GObject      *object,
+                   GAsyncResult *result,
+                   gpointer      user_data)
+{
+  GString *order = user_data;
+
+  g_assert_true (g_task_propagate_boolean (G_TASK (result), NULL));
+  g_string_append_printf (order, "%d", GPOINTER_TO_INT (g_task_get_task_data (G_TASK (result))));
+
+  if (order->len == 6)
+    g_main_loop_quit (loop);
+}
+
+typedef struct {
+  GTask *tasks[3];
+  GString *order;
+} OrderingData;
+
+static gpointer
+ordering_thread (gpointer user_data)
+{
+  OrderingData *data = user_data;
+  gint i;
+
+  for (i = 0; i < 3; i++)
+    {
+      GSource *source;
+
+      /* Like a progress update sent to the task's context */
+      source = g_idle_source_new ();
+      g_source_set_priority (source, G_PRIORITY_DEFAULT);
+      g_source_set_callback (source, ordering_mark, data->order, NULL);
+      g_source_attach (source, g_task_get_context (data->tasks[i]));
+      g_source_unref (source);
+
+      g_task_return_boolean (data->tasks[i], TRUE);
+    }
+
+  return NULL;
+}
+
+static void
+test_return_batched_ordering (void)
+{
+  OrderingData data;
+  GThread *thread;
+  gint i;
+
+  data.order = g_string_new (NULL);
+  for (i = 0; i < 3; i++)
+    {
+      data.tasks[i] = g_task_new (NULL, NULL, ordering_callback, data.order);
+      g_task_set_task_data (data.tasks[i], GINT_TO_POINTER (i), NULL);
+    }
+
+  thread = g_thread_new ("ordering", ordering_thread, &data);
+  g_main_loop_run (loop);
+  g_thread_join (thread);
+
+  g_assert_cmpstr (data.order->str, ==, ".0.1.2");
+
+  for (i = 0; i < 3; i++)
+    g_object_unref (data.tasks[i]);
+  g_string_free (data.order, TRUE);
+}
+
 /* test_return_from_toplevel: calling g_task_return_* from outside any
  * main loop completes the task inside the main loop.
  */
@@ -1538,6 +1698,57 @@ test_return_on_cancel_sync (void)
   g_object_unref (cancellable);
 }
 
+/* test_return_on_cancel_deadline: g_task_run_in_thread_sync() returns
+ * at the deadline of the task's cancellable when return-on-cancel is set.
+ */
+static GMutex deadline_mutex;
+static GCond deadline_cond;
+static gboolean deadline_released;
+
+static void
+deadline_thread (GTask        *task,
+                 gpointer      source_object,
+                 gpointer      task_data,
+                 GCancellable *cancellable)
+{
+  g_mutex_lock (&deadline_mutex);
+  while (!deadline_released)
+    g_cond_wait (&deadline_cond, &deadline_mutex);
+  g_mutex_unlock (&deadline_mutex);
+
+  g_task_return_int (task, 1);
+}
+
+static void
+test_return_on_cancel_deadline (void)
+{
+  GTask *task;
+  GCancellable *cancellable;
+  GError *error = NULL;
+  gint64 deadline;
+
+  deadline = g_get_monotonic_time () + 20 * G_TIME_SPAN_MILLISECOND;
+  cancellable = g_cancellable_new_with_deadline (deadline);
+
+  task = g_task_new (NULL, cancellable, NULL, NULL);
+  g_task_set_return_on_cancel (task, TRUE);
+  g_task_run_in_thread_sync (task, deadline_thread);
+
+  g_assert_cmpint (g_get_monotonic_time (), >=, deadline);
+  g_assert_true (g_cancellable_is_cancelled (cancellable));
+  g_assert_cmpint (g_task_propagate_int (task, &error), ==, -1);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT);
+  g_clear_error (&error);
+  g_object_unref (task);
+
+  g_mutex_lock (&deadline_mutex);
+  deadline_released = TRUE;
+  g_cond_signal (&deadline_cond);
+  g_mutex_unlock (&deadline_mutex);
+
+  g_object_unref (cancellable);
+}
+
 /* test_return_on_cancel_atomic: turning return-on-cancel on/off is
  * non-racy
  */
@@ -1986,6 +2197,212 @@ test_legacy_error (void)
   g_assert (simple == NULL);
 }
 
+/* test_executor_bounded: a bounded executor never runs more tasks at
+ * once than it has threads.
+ */
+
+static GMutex executor_mutex;
+static gint executor_tasks_running, executor_tasks_max, executor_tasks_left;
+
+static void
+count_concurrency_thread (GTask        *task,
+                          gpointer      source_object,
+                          gpointer      task_data,
+                          GCancellable *cancellable)
+{
+  g_mutex_lock (&executor_mutex);
+  executor_tasks_running++;
+  executor_tasks_max = MAX (executor_tasks_max, executor_tasks_running);
+  g_mutex_unlock (&executor_mutex);
+
+  g_usleep (10000);
+
+  g_mutex_lock (&executor_mutex);
+  executor_tasks_running--;
+  g_mutex_unlock (&executor_mutex);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+executor_task_callback (GObject      *source,
+                        GAsyncResult *result,
+                        gpointer      user_data)
+{
+  g_assert (g_task_propagate_boolean (G_TASK (result), NULL));
+
+  if (--executor_tasks_left == 0)
+    g_main_loop_quit (loop);
+}
+
+static void
+test_executor_bounded (void)
+{
+  GTaskExecutor *executor;
+  GTask *task;
+  int i;
+
+  executor = g_task_executor_new_bounded ("test-cpu", 2);
+  g_assert_cmpstr (g_task_executor_get_name (executor), ==, "test-cpu");
+
+  executor_tasks_max = 0;
+  for (i = 0; i < 8; i++)
+    {
+      task = g_task_new (NULL, NULL, executor_task_callback, NULL);
+      g_assert (g_task_get_executor (task) == NULL);
+      g_task_set_executor (task, executor);
+      g_assert (g_task_get_executor (task) == executor);
+      g_task_run_in_thread (task, count_concurrency_thread);
+      g_object_unref (task);
+      executor_tasks_left++;
+    }
+
+  /* The tasks keep the executor alive */
+  g_task_executor_unref (executor);
+
+  g_main_loop_run (loop);
+
+  g_assert_cmpint (executor_tasks_max, >=, 1);
+  g_assert_cmpint (executor_tasks_max, <=, 2);
+}
+
+/* test_executor_priority: tasks queued on an executor start in
+ * priority order, and a busy executor does not hold up the others.
+ */
+
+static void
+record_sequence_thread (GTask        *task,
+                        gpointer      source_object,
+                        gpointer      task_data,
+                        GCancellable *cancellable)
+{
+  gint *seq_no_p = task_data;
+  static gint seq;
+
+  *seq_no_p = ++seq;
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+test_executor_priority (void)
+{
+  GTaskExecutor *executor;
+  GMutex blocker;
+  GTask *task;
+  gint seq_low = 0, seq_default = 0, seq_high = 0, seq_other = 0;
+
+  executor = g_task_executor_new_bounded ("test-serial", 1);
+
+  g_mutex_init (&blocker);
+  g_mutex_lock (&blocker);
+  task = g_task_new (NULL, NULL, executor_task_callback, NULL);
+  g_task_set_task_data (task, &blocker, NULL);
+  g_task_set_priority (task, G_PRIORITY_HIGH * 2);
+  g_task_set_executor (task, executor);
+  g_task_run_in_thread (task, fake_task_thread);
+  g_object_unref (task);
+  executor_tasks_left++;
+
+  task = g_task_new (NULL, NULL, executor_task_callback, NULL);
+  g_task_set_task_data (task, &seq_low, NULL);
+  g_task_set_priority (task, G_PRIORITY_LOW);
+  g_task_set_executor (task, executor);
+  g_task_run_in_thread (task, record_sequence_thread);
+  g_object_unref (task);
+  executor_tasks_left++;
+
+  task = g_task_new (NULL, NULL, executor_task_callback, NULL);
+  g_task_set_task_data (task, &seq_default, NULL);
+  g_task_set_executor (task, executor);
+  g_task_run_in_thread (task, record_sequence_thread);
+  g_object_unref (task);
+  executor_tasks_left++;
+
+  task = g_task_new (NULL, NULL, executor_task_callback, NULL);
+  g_task_set_task_data (task, &seq_high, NULL);
+  g_task_set_priority (task, G_PRIORITY_HIGH);
+  g_task_set_executor (task, executor);
+  g_task_run_in_thread (task, record_sequence_thread);
+  g_object_unref (task);
+  executor_tasks_left++;
+
+  /* The default executor still has threads to spare */
+  task = g_task_new (NULL, NULL, NULL, NULL);
+  g_task_set_task_data (task, &seq_other, NULL);
+  g_task_run_in_thread_sync (task, record_sequence_thread);
+  g_object_unref (task);
+  g_assert_cmpint (seq_other, ==, 1);
+
+  g_mutex_unlock (&blocker);
+  g_main_loop_run (loop);
+  g_mutex_clear (&blocker);
+
+  g_assert_cmpint (seq_high, ==, 2);
+  g_assert_cmpint (seq_default, ==, 3);
+  g_assert_cmpint (seq_low, ==, 4);
+
+  g_task_executor_unref (executor);
+}
+
+/* test_executor_elastic: an elastic executor grows when its tasks
+ * wait on each other.
+ */
+
+static void
+wait_for_flag_thread (GTask        *task,
+                      gpointer      source_object,
+                      gpointer      task_data,
+                      GCancellable *cancellable)
+{
+  gint *flag = task_data;
+
+  while (!g_atomic_int_get (flag))
+    g_usleep (1000);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+set_flag_thread (GTask        *task,
+                 gpointer      source_object,
+                 gpointer      task_data,
+                 GCancellable *cancellable)
+{
+  gint *flag = task_data;
+
+  g_atomic_int_set (flag, TRUE);
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+test_executor_elastic (void)
+{
+  GTaskExecutor *executor;
+  GTask *task;
+  gint flag = FALSE;
+
+  executor = g_task_executor_new_elastic ("test-io", 1);
+
+  task = g_task_new (NULL, NULL, executor_task_callback, NULL);
+  g_task_set_task_data (task, &flag, NULL);
+  g_task_set_executor (task, executor);
+  g_task_run_in_thread (task, wait_for_flag_thread);
+  g_object_unref (task);
+  executor_tasks_left++;
+
+  task = g_task_new (NULL, NULL, executor_task_callback, NULL);
+  g_task_set_task_data (task, &flag, NULL);
+  g_task_set_executor (task, executor);
+  g_task_run_in_thread (task, set_flag_thread);
+  g_object_unref (task);
+  executor_tasks_left++;
+
+  g_main_loop_run (loop);
+  g_assert (flag);
+
+  g_task_executor_unref (executor);
+}
+
 
 int
 main (int argc, char **argv)
@@ -2001,6 +2418,8 @@ main (int argc, char **argv)
   g_test_add_func ("/gtask/basic", test_basic);
   g_test_add_func ("/gtask/error", test_error);
   g_test_add_func ("/gtask/return-from-same-iteration", test_return_from_same_iteration);
+  g_test_add_func ("/gtask/return-batched", test_return_batched);
+  g_test_add_func ("/gtask/return-batched-ordering", test_return_batched_ordering);
   g_test_add_func ("/gtask/return-from-toplevel", test_return_from_toplevel);
   g_test_add_func ("/gtask/return-from-anon-thread", test_return_from_anon_thread);
   g_test_add_func ("/gtask/return-from-wrong-thread", test_return_from_wrong_thread);
@@ -2017,9 +2436,13 @@ main (int argc, char **argv)
   g_test_add_func ("/gtask/return-on-cancel", test_return_on_cancel);
   g_test_add_func ("/gtask/return-on-cancel-sync", test_return_on_cancel_sync);
   g_test_add_func ("/gtask/return-on-cancel-atomic", test_return_on_cancel_atomic);
+  g_test_add_func ("/gtask/return-on-cancel-deadline", test_return_on_cancel_deadline);
   g_test_add_func ("/gtask/return-pointer", test_return_pointer);
   g_test_add_func ("/gtask/object-keepalive", test_object_keepalive);
   g_test_add_func ("/gtask/legacy-error", test_legacy_error);
+  g_test_add_func ("/gtask/executor/bounded", test_executor_bounded);
+  g_test_add_func ("/gtask/executor/priority", test_executor_priority);
+  g_test_add_func ("/gtask/executor/elastic", test_executor_elastic);
 
   ret = g_test_run();
 
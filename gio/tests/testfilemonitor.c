@@ -652,6 +652,246 @@ test_cross_dir_moves (void)
   g_object_unref (data[1].file);
 }
 
+static void
+recursive_monitor_changed (GFileMonitor      *monitor,
+                           GFile             *file,
+                           GFile             *other_file,
+                           GFileMonitorEvent  event_type,
+                           gpointer           user_data)
+{
+  TestData *data = user_data;
+  gchar *path;
+
+  /* Other events depend on the timing of the virtual change done hints */
+  if (event_type != G_FILE_MONITOR_EVENT_CREATED)
+    return;
+
+  path = g_file_get_relative_path (data->file, file);
+  record_event (data, event_type, path, NULL, -1);
+  g_free (path);
+}
+
+static gboolean
+recursive_step (gpointer user_data)
+{
+  TestData *data = user_data;
+  GFile *file;
+  GError *error = NULL;
+
+  switch (data->step)
+    {
+    case 1:
+      record_event (data, -1, NULL, NULL, 1);
+      file = g_file_resolve_relative_path (data->file, "a/b/c");
+      g_file_make_directory (file, NULL, &error);
+      g_assert_no_error (error);
+      g_object_unref (file);
+      break;
+    case 2:
+      record_event (data, -1, NULL, NULL, 2);
+      file = g_file_resolve_relative_path (data->file, "a/b/c/file");
+      g_file_replace_contents (file, "step 2", 6, NULL, FALSE, G_FILE_CREATE_NONE, NULL, NULL, &error);
+      g_assert_no_error (error);
+      g_object_unref (file);
+      break;
+    case 3:
+      record_event (data, -1, NULL, NULL, 3);
+      g_main_loop_quit (data->loop);
+      return G_SOURCE_REMOVE;
+    }
+
+  data->step++;
+
+  return G_SOURCE_CONTINUE;
+}
+
+/* this is the output we expect from the above steps */
+static RecordedEvent recursive_output[] = {
+  { -1, NULL, NULL, 1 },
+  { G_FILE_MONITOR_EVENT_CREATED, "a/b/c", NULL, -1 },
+  { -1, NULL, NULL, 2 },
+  { G_FILE_MONITOR_EVENT_CREATED, "a/b/c/file", NULL, -1 },
+  { -1, NULL, NULL, 3 }
+};
+
+static void
+test_dir_recursive (void)
+{
+  const gchar *cleanup[] = { "a/b/c/file", "a/b/c", "a/b", "a", "." };
+  GError *error = NULL;
+  GFile *subdir;
+  gchar *path;
+  TestData data;
+  gsize i;
+
+  data.step = 0;
+  data.events = NULL;
+
+  path = g_dir_make_tmp ("recursive_monitor_test_XXXXXX", &error);
+  g_assert_no_error (error);
+  data.file = g_file_new_for_path (path);
+
+  subdir = g_file_resolve_relative_path (data.file, "a/b");
+  g_file_make_directory_with_parents (subdir, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (subdir);
+
+  data.monitor = g_file_monitor_directory (data.file, G_FILE_MONITOR_WATCH_RECURSIVE, NULL, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+    {
+      g_test_skip ("recursive file monitoring not supported");
+      g_clear_error (&error);
+      goto out;
+    }
+  g_assert_no_error (error);
+
+  g_file_monitor_set_rate_limit (data.monitor, 200);
+  g_signal_connect (data.monitor, "changed", G_CALLBACK (recursive_monitor_changed), &data);
+
+  data.loop = g_main_loop_new (NULL, TRUE);
+
+  g_timeout_add (500, recursive_step, &data);
+
+  g_main_loop_run (data.loop);
+
+  check_expected_events (recursive_output, G_N_ELEMENTS (recursive_output), data.events);
+
+  g_list_free_full (data.events, (GDestroyNotify)free_recorded_event);
+  g_main_loop_unref (data.loop);
+  g_object_unref (data.monitor);
+
+out:
+  for (i = 0; i < G_N_ELEMENTS (cleanup); i++)
+    {
+      subdir = g_file_resolve_relative_path (data.file, cleanup[i]);
+      g_file_delete (subdir, NULL, NULL);
+      g_object_unref (subdir);
+    }
+  g_object_unref (data.file);
+  g_free (path);
+}
+
+typedef struct
+{
+  GFile *file;
+  GMainLoop *loop;
+  gint step;
+  guint n_batches;
+  guint n_batched_changes;
+  guint n_attribute_changed;
+  guint n_changed;
+} BatchData;
+
+static void
+batch_monitor_changes (GFileMonitor             *monitor,
+                       const GFileMonitorChange *changes,
+                       guint                     n_changes,
+                       gpointer                  user_data)
+{
+  BatchData *data = user_data;
+  guint i;
+
+  g_assert_cmpuint (n_changes, >, 0);
+
+  data->n_batches++;
+  data->n_batched_changes += n_changes;
+
+  for (i = 0; i < n_changes; i++)
+    {
+      g_assert (G_IS_FILE (changes[i].file));
+      if (changes[i].event_type == G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED)
+        data->n_attribute_changed++;
+    }
+}
+
+static void
+batch_monitor_changed (GFileMonitor      *monitor,
+                       GFile             *file,
+                       GFile             *other_file,
+                       GFileMonitorEvent  event_type,
+                       gpointer           user_data)
+{
+  BatchData *data = user_data;
+
+  data->n_changed++;
+}
+
+static gboolean
+batch_step (gpointer user_data)
+{
+  BatchData *data = user_data;
+  GError *error = NULL;
+  gint i;
+
+  switch (data->step)
+    {
+    case 1:
+      /* Several attribute changes in quick succession, with time for
+       * them all to reach the monitor before the main loop runs again.
+       */
+      for (i = 0; i < 10; i++)
+        {
+          g_file_set_attribute_uint32 (data->file, G_FILE_ATTRIBUTE_UNIX_MODE,
+                                       (i % 2) ? 0600 : 0644,
+                                       G_FILE_QUERY_INFO_NONE, NULL, &error);
+          g_assert_no_error (error);
+        }
+      g_usleep (300 * G_TIME_SPAN_MILLISECOND);
+      break;
+    case 2:
+      g_main_loop_quit (data->loop);
+      return G_SOURCE_REMOVE;
+    }
+
+  data->step++;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+test_dir_changes_batched (void)
+{
+  GFileMonitor *monitor;
+  GError *error = NULL;
+  GFile *dir;
+  gchar *path;
+  BatchData data = { NULL, };
+
+  path = g_dir_make_tmp ("batch_monitor_test_XXXXXX", &error);
+  g_assert_no_error (error);
+  dir = g_file_new_for_path (path);
+  data.file = g_file_get_child (dir, "file");
+  g_file_replace_contents (data.file, "x", 1, NULL, FALSE, G_FILE_CREATE_NONE, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  monitor = g_file_monitor_directory (dir, G_FILE_MONITOR_COALESCE_EVENTS, NULL, &error);
+  g_assert_no_error (error);
+
+  g_signal_connect (monitor, "changes", G_CALLBACK (batch_monitor_changes), &data);
+  g_signal_connect (monitor, "changed", G_CALLBACK (batch_monitor_changed), &data);
+
+  data.loop = g_main_loop_new (NULL, TRUE);
+
+  g_timeout_add (500, batch_step, &data);
+
+  g_main_loop_run (data.loop);
+
+  /* All ten changes arrived together, and only the last one was kept */
+  g_assert_cmpuint (data.n_batches, ==, 1);
+  g_assert_cmpuint (data.n_attribute_changed, ==, 1);
+
+  /* The individual signal still sees everything */
+  g_assert_cmpuint (data.n_changed, ==, data.n_batched_changes);
+
+  g_main_loop_unref (data.loop);
+  g_object_unref (monitor);
+  g_file_delete (data.file, NULL, NULL);
+  g_object_unref (data.file);
+  g_file_delete (dir, NULL, NULL);
+  g_object_unref (dir);
+  g_free (path);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -662,6 +902,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/monitor/dir-monitor", test_dir_monitor);
   g_test_add_func ("/monitor/dir-not-existent", test_dir_non_existent);
   g_test_add_func ("/monitor/cross-dir-moves", test_cross_dir_moves);
+  g_test_add_func ("/monitor/dir-recursive", test_dir_recursive);
+  g_test_add_func ("/monitor/dir-changes-batched", test_dir_changes_batched);
 
   return g_test_run ();
 }
@@ -0,0 +1,174 @@
+/* GLib testing framework examples and tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gio/gio.h>
+
+#include "gtesttlsbackend.h"
+
+/* The test backend's connections can't be initialised, but they don't
+ * need to be for their session state to be copied.
+ */
+static GTlsClientConnection *
+new_connection (void)
+{
+  GType type;
+
+  type = g_tls_backend_get_client_connection_type (g_tls_backend_get_default ());
+
+  return g_object_new (type, NULL);
+}
+
+static GTlsClientConnection *
+get_session_source (GTlsClientConnection *conn)
+{
+  return g_object_get_data (G_OBJECT (conn), "session-source");
+}
+
+static void
+test_resume (void)
+{
+  GTlsSessionCache *cache;
+  GSocketConnectable *server_a, *server_b;
+  GTlsClientConnection *first, *second, *third, *other;
+
+  cache = g_tls_session_cache_new (0);
+  server_a = g_network_address_new ("a.example.com", 443);
+  server_b = g_network_address_new ("b.example.com", 443);
+  first = new_connection ();
+  second = new_connection ();
+  third = new_connection ();
+  other = new_connection ();
+
+  g_assert_false (g_tls_session_cache_resume (cache, server_a, first));
+  g_assert_null (get_session_source (first));
+
+  g_tls_session_cache_store (cache, server_a, first);
+
+  g_assert_true (g_tls_session_cache_resume (cache, server_a, second));
+  g_assert (get_session_source (second) == first);
+
+  g_assert_false (g_tls_session_cache_resume (cache, server_b, other));
+  g_assert_null (get_session_source (other));
+
+  /* A newer session replaces the old one */
+  g_tls_session_cache_store (cache, server_a, second);
+  g_assert_true (g_tls_session_cache_resume (cache, server_a, third));
+  g_assert (get_session_source (third) == second);
+
+  g_tls_session_cache_remove (cache, server_a);
+  g_assert_false (g_tls_session_cache_resume (cache, server_a, other));
+
+  g_object_unref (first);
+  g_object_unref (second);
+  g_object_unref (third);
+  g_object_unref (other);
+  g_object_unref (server_a);
+  g_object_unref (server_b);
+  g_object_unref (cache);
+}
+
+static void
+test_eviction (void)
+{
+  GTlsSessionCache *cache;
+  GSocketConnectable *servers[3];
+  GTlsClientConnection *conns[3];
+  GTlsClientConnection *conn;
+  guint i;
+
+  cache = g_tls_session_cache_new (2);
+  for (i = 0; i < 3; i++)
+    {
+      gchar *name = g_strdup_printf ("%u.example.com", i);
+
+      servers[i] = g_network_address_new (name, 443);
+      conns[i] = new_connection ();
+      g_free (name);
+    }
+
+  g_tls_session_cache_store (cache, servers[0], conns[0]);
+  g_tls_session_cache_store (cache, servers[1], conns[1]);
+
+  /* Using the first session makes the second one the oldest */
+  conn = new_connection ();
+  g_assert_true (g_tls_session_cache_resume (cache, servers[0], conn));
+  g_object_unref (conn);
+
+  g_tls_session_cache_store (cache, servers[2], conns[2]);
+
+  conn = new_connection ();
+  g_assert_false (g_tls_session_cache_resume (cache, servers[1], conn));
+  g_assert_true (g_tls_session_cache_resume (cache, servers[0], conn));
+  g_assert (get_session_source (conn) == conns[0]);
+  g_assert_true (g_tls_session_cache_resume (cache, servers[2], conn));
+  g_assert (get_session_source (conn) == conns[2]);
+  g_object_unref (conn);
+
+  g_tls_session_cache_clear (cache);
+
+  conn = new_connection ();
+  for (i = 0; i < 3; i++)
+    g_assert_false (g_tls_session_cache_resume (cache, servers[i], conn));
+  g_object_unref (conn);
+
+  for (i = 0; i < 3; i++)
+    {
+      g_object_unref (servers[i]);
+      g_object_unref (conns[i]);
+    }
+  g_object_unref (cache);
+}
+
+static void
+test_socket_client (void)
+{
+  GSocketClient *client;
+  GTlsSessionCache *cache, *value;
+
+  client = g_socket_client_new ();
+  g_assert_null (g_socket_client_get_tls_session_cache (client));
+
+  cache = g_tls_session_cache_new (0);
+  g_socket_client_set_tls_session_cache (client, cache);
+  g_assert (g_socket_client_get_tls_session_cache (client) == cache);
+
+  g_object_get (client, "tls-session-cache", &value, NULL);
+  g_assert (value == cache);
+  g_object_unref (value);
+
+  g_socket_client_set_tls_session_cache (client, NULL);
+  g_assert_null (g_socket_client_get_tls_session_cache (client));
+
+  g_object_unref (cache);
+  g_object_unref (client);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  _g_test_tls_backend_get_type ();
+
+  g_test_add_func ("/tls-session-cache/resume", test_resume);
+  g_test_add_func ("/tls-session-cache/eviction", test_eviction);
+  g_test_add_func ("/tls-session-cache/socket-client", test_socket_client);
+
+  return g_test_run ();
+}
@@ -230,12 +230,81 @@ G_GNUC_END_IGNORE_DEPRECATIONS
   check_fd_list (fd_list);
 }
 
+static void
+test_bytes (void)
+{
+  GUnixFDList *list;
+  GError *err = NULL;
+  GBytes *small, *large, *bytes;
+  GVariant *value;
+  guint8 *data;
+  gsize i;
+
+  list = g_unix_fd_list_new ();
+
+  small = g_bytes_new_static ("hello", 5);
+  value = g_unix_fd_list_pack_bytes (list, small, 4096, &err);
+  g_assert_no_error (err);
+  g_variant_ref_sink (value);
+  g_assert (g_variant_is_of_type (value, G_VARIANT_TYPE_BYTESTRING));
+  g_assert_cmpint (g_unix_fd_list_get_length (list), ==, 0);
+  bytes = g_unix_fd_list_unpack_bytes (NULL, value, &err);
+  g_assert_no_error (err);
+  g_assert (g_bytes_equal (bytes, small));
+  g_bytes_unref (bytes);
+  g_variant_unref (value);
+
+  data = g_malloc (1024 * 1024);
+  for (i = 0; i < 1024 * 1024; i++)
+    data[i] = i % 251;
+  large = g_bytes_new_take (data, 1024 * 1024);
+  value = g_unix_fd_list_pack_bytes (list, large, 4096, &err);
+  g_assert_no_error (err);
+  g_variant_ref_sink (value);
+  g_assert (g_variant_is_of_type (value, G_VARIANT_TYPE_HANDLE));
+  g_assert_cmpint (g_variant_get_handle (value), ==, 0);
+  g_assert_cmpint (g_unix_fd_list_get_length (list), ==, 1);
+  bytes = g_unix_fd_list_unpack_bytes (list, value, &err);
+  g_assert_no_error (err);
+  g_assert (g_bytes_equal (bytes, large));
+  g_bytes_unref (bytes);
+
+  /* a second read gives the same data */
+  bytes = g_unix_fd_list_get_bytes (list, 0, &err);
+  g_assert_no_error (err);
+  g_assert (g_bytes_equal (bytes, large));
+  g_bytes_unref (bytes);
+
+  bytes = g_unix_fd_list_unpack_bytes (NULL, value, &err);
+  g_assert_error (err, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+  g_assert (bytes == NULL);
+  g_clear_error (&err);
+  g_variant_unref (value);
+
+  bytes = g_unix_fd_list_get_bytes (list, 1, &err);
+  g_assert_error (err, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+  g_assert (bytes == NULL);
+  g_clear_error (&err);
+
+  value = g_variant_ref_sink (g_variant_new_string ("nope"));
+  bytes = g_unix_fd_list_unpack_bytes (list, value, &err);
+  g_assert_error (err, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+  g_assert (bytes == NULL);
+  g_clear_error (&err);
+  g_variant_unref (value);
+
+  g_bytes_unref (small);
+  g_bytes_unref (large);
+  g_object_unref (list);
+}
+
 int
 main (int argc, char **argv)
 {
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/unix-streams/file-descriptors", test_fds);
+  g_test_add_func ("/unix-streams/bytes", test_bytes);
 
   return g_test_run();
 
@@ -0,0 +1,120 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gio/gio.h>
+#include <gio/gunixmounts.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void
+test_mounts_get (void)
+{
+  GList *mounts1, *mounts2, *l1, *l2;
+
+  mounts1 = g_unix_mounts_get (NULL);
+  mounts2 = g_unix_mounts_get (NULL);
+
+  if (mounts1 == NULL)
+    {
+      g_test_skip ("no mount table available");
+      return;
+    }
+
+  /* Repeated calls return equal, but separately owned, lists */
+  g_assert_cmpuint (g_list_length (mounts1), ==, g_list_length (mounts2));
+  for (l1 = mounts1, l2 = mounts2; l1 != NULL; l1 = l1->next, l2 = l2->next)
+    {
+      g_assert (l1->data != l2->data);
+      g_assert_cmpint (g_unix_mount_compare (l1->data, l2->data), ==, 0);
+    }
+
+  g_list_free_full (mounts1, (GDestroyNotify) g_unix_mount_free);
+  g_list_free_full (mounts2, (GDestroyNotify) g_unix_mount_free);
+}
+
+static void
+test_mount_at (void)
+{
+  GList *mounts, *l;
+
+  mounts = g_unix_mounts_get (NULL);
+
+  for (l = mounts; l != NULL; l = l->next)
+    {
+      GUnixMountEntry *mount = l->data;
+      GUnixMountEntry *found;
+
+      found = g_unix_mount_at (g_unix_mount_get_mount_path (mount), NULL);
+      g_assert (found != NULL);
+      g_assert_cmpstr (g_unix_mount_get_mount_path (found), ==, g_unix_mount_get_mount_path (mount));
+      g_unix_mount_free (found);
+    }
+
+  g_assert (g_unix_mount_at ("/nonexistent/mount/path", NULL) == NULL);
+
+  g_list_free_full (mounts, (GDestroyNotify) g_unix_mount_free);
+}
+
+static void
+test_mount_for (void)
+{
+  GUnixMountEntry *mount;
+  const gchar *mount_path;
+  gchar *dir, *file, *resolved;
+
+  mount = g_unix_mount_at ("/", NULL);
+  if (mount == NULL)
+    {
+      g_test_skip ("no root mount in the mount table");
+      return;
+    }
+  g_unix_mount_free (mount);
+
+  dir = g_dir_make_tmp ("unix-mounts-XXXXXX", NULL);
+  g_assert (dir != NULL);
+  file = g_build_filename (dir, "file", NULL);
+  g_assert (g_file_set_contents (file, "", 0, NULL));
+
+  /* The mount containing a file is the closest one above it */
+  mount = g_unix_mount_for (file, NULL);
+  g_assert (mount != NULL);
+  mount_path = g_unix_mount_get_mount_path (mount);
+  resolved = realpath (file, NULL);
+  g_assert (resolved != NULL);
+  g_assert (strcmp (mount_path, "/") == 0 ||
+            (g_str_has_prefix (resolved, mount_path) && resolved[strlen (mount_path)] == '/'));
+  free (resolved);
+  g_unix_mount_free (mount);
+
+  g_remove (file);
+  g_rmdir (dir);
+  g_free (file);
+  g_free (dir);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/unix-mounts/get", test_mounts_get);
+  g_test_add_func ("/unix-mounts/mount-at", test_mount_at);
+  g_test_add_func ("/unix-mounts/mount-for", test_mount_for);
+
+  return g_test_run ();
+}
@@ -76,6 +76,7 @@ struct XdgDirTimeList
   time_t mtime;
   char *directory_name;
   int checked;
+  XdgMimeCache *cache;
   XdgDirTimeList *next;
 };
 
@@ -94,9 +95,10 @@ struct XdgCallbackList
 typedef int (*XdgDirectoryFunc) (const char *directory,
 				 void       *user_data);
 
-static void
-xdg_dir_time_list_add (char   *file_name, 
-		       time_t  mtime)
+static int
+xdg_dir_time_list_add (char         *file_name, 
+		       time_t        mtime,
+		       XdgMimeCache *cache)
 {
   XdgDirTimeList *list;
 
@@ -105,7 +107,7 @@ xdg_dir_time_list_add (char   *file_name,
       if (strcmp (list->directory_name, file_name) == 0)
         {
           free (file_name);
-          return;
+          return FALSE;
         }
     }
   
@@ -113,8 +115,11 @@ xdg_dir_time_list_add (char   *file_name,
   list->checked = XDG_CHECKED_UNCHECKED;
   list->directory_name = file_name;
   list->mtime = mtime;
+  list->cache = cache ? _xdg_mime_cache_ref (cache) : NULL;
   list->next = dir_time_list;
   dir_time_list = list;
+
+  return TRUE;
 }
  
 static void
@@ -125,15 +130,24 @@ xdg_dir_time_list_free (XdgDirTimeList *list)
   while (list)
     {
       next = list->next;
+      if (list->cache)
+        _xdg_mime_cache_unref (list->cache);
       free (list->directory_name);
       free (list);
       list = next;
     }
 }
 
+/* Maps the mime.cache file of @directory, if there is one.  @old_list is
+ * the time list from before a reload: a cache whose file has not changed
+ * since then is reused rather than being mapped again.
+ */
 static int
-xdg_mime_init_from_directory (const char *directory)
+xdg_mime_init_cache_from_directory (const char     *directory,
+				    XdgDirTimeList *old_list)
 {
+  XdgMimeCache *cache = NULL;
+  XdgDirTimeList *list;
   char *file_name;
   struct stat st;
 
@@ -141,30 +155,63 @@ xdg_mime_init_from_directory (const char *directory)
 
   file_name = malloc (strlen (directory) + strlen ("/mime/mime.cache") + 1);
   strcpy (file_name, directory); strcat (file_name, "/mime/mime.cache");
-  if (stat (file_name, &st) == 0)
+  if (stat (file_name, &st) != 0)
     {
-      XdgMimeCache *cache = _xdg_mime_cache_new_from_file (file_name);
+      free (file_name);
+      return FALSE;
+    }
 
-      if (cache != NULL)
+  for (list = old_list; list; list = list->next)
+    {
+      if (list->cache != NULL &&
+	  list->mtime == st.st_mtime &&
+	  strcmp (list->directory_name, file_name) == 0)
 	{
-	  xdg_dir_time_list_add (file_name, st.st_mtime);
+	  cache = _xdg_mime_cache_ref (list->cache);
+	  break;
+	}
+    }
 
-	  _caches = realloc (_caches, sizeof (XdgMimeCache *) * (n_caches + 2));
-	  _caches[n_caches] = cache;
-          _caches[n_caches + 1] = NULL;
-	  n_caches++;
+  if (cache == NULL)
+    cache = _xdg_mime_cache_new_from_file (file_name);
 
-	  return FALSE;
-	}
+  if (cache == NULL)
+    {
+      free (file_name);
+      return FALSE;
     }
-  free (file_name);
+
+  if (xdg_dir_time_list_add (file_name, st.st_mtime, cache))
+    {
+      _caches = realloc (_caches, sizeof (XdgMimeCache *) * (n_caches + 2));
+      _caches[n_caches] = cache;
+      _caches[n_caches + 1] = NULL;
+      n_caches++;
+    }
+  else
+    _xdg_mime_cache_unref (cache);
+
+  return FALSE; /* Keep processing */
+}
+
+/* Reads the text files of @directory.  This is only done when none of the
+ * directories has a mime.cache, since the lookups only ever use the caches
+ * once there is at least one.
+ */
+static int
+xdg_mime_init_from_directory (const char *directory)
+{
+  char *file_name;
+  struct stat st;
+
+  assert (directory != NULL);
 
   file_name = malloc (strlen (directory) + strlen ("/mime/globs2") + 1);
   strcpy (file_name, directory); strcat (file_name, "/mime/globs2");
   if (stat (file_name, &st) == 0)
     {
       _xdg_mime_glob_read_from_file (global_hash, file_name, TRUE);
-      xdg_dir_time_list_add (file_name, st.st_mtime);
+      xdg_dir_time_list_add (file_name, st.st_mtime, NULL);
     }
   else
     {
@@ -174,7 +221,7 @@ xdg_mime_init_from_directory (const char *directory)
       if (stat (file_name, &st) == 0)
         {
           _xdg_mime_glob_read_from_file (global_hash, file_name, FALSE);
-          xdg_dir_time_list_add (file_name, st.st_mtime);
+          xdg_dir_time_list_add (file_name, st.st_mtime, NULL);
         }
       else
         {
@@ -187,7 +234,7 @@ xdg_mime_init_from_directory (const char *directory)
   if (stat (file_name, &st) == 0)
     {
       _xdg_mime_magic_read_from_file (global_magic, file_name);
-      xdg_dir_time_list_add (file_name, st.st_mtime);
+      xdg_dir_time_list_add (file_name, st.st_mtime, NULL);
     }
   else
     {
@@ -358,10 +405,15 @@ xdg_check_dir (const char *directory,
       return FALSE;
     }
 
-  /* Check the globs file */
-  file_name = malloc (strlen (directory) + strlen ("/mime/globs") + 1);
-  strcpy (file_name, directory); strcat (file_name, "/mime/globs");
-  invalid = xdg_check_file (file_name, NULL);
+  /* The text files aren't loaded at all while there are caches, so a new
+   * mime.cache appearing is the only change that matters here */
+  if (_caches)
+    return FALSE;
+
+  /* Check the globs2 file, or the globs file if there is none */
+  file_name = malloc (strlen (directory) + strlen ("/mime/globs2") + 1);
+  strcpy (file_name, directory); strcat (file_name, "/mime/globs2");
+  invalid = xdg_check_file (file_name, &exists);
   free (file_name);
   if (invalid)
     {
@@ -369,6 +421,19 @@ xdg_check_dir (const char *directory,
       return TRUE;
     }
 
+  if (!exists)
+    {
+      file_name = malloc (strlen (directory) + strlen ("/mime/globs") + 1);
+      strcpy (file_name, directory); strcat (file_name, "/mime/globs");
+      invalid = xdg_check_file (file_name, NULL);
+      free (file_name);
+      if (invalid)
+        {
+          *invalid_dir_list = TRUE;
+          return TRUE;
+        }
+    }
+
   /* Check the magic file */
   file_name = malloc (strlen (directory) + strlen ("/mime/magic") + 1);
   strcpy (file_name, directory); strcat (file_name, "/mime/magic");
@@ -432,6 +497,26 @@ xdg_check_time_and_dirs (void)
   return retval;
 }
 
+static void
+xdg_mime_load (XdgDirTimeList *old_list)
+{
+  global_hash = _xdg_glob_hash_new ();
+  global_magic = _xdg_mime_magic_new ();
+  alias_list = _xdg_mime_alias_list_new ();
+  parent_list = _xdg_mime_parent_list_new ();
+  icon_list = _xdg_mime_icon_list_new ();
+  generic_icon_list = _xdg_mime_icon_list_new ();
+
+  xdg_run_command_on_dirs ((XdgDirectoryFunc) xdg_mime_init_cache_from_directory,
+			   old_list);
+
+  if (_caches == NULL)
+    xdg_run_command_on_dirs ((XdgDirectoryFunc) xdg_mime_init_from_directory,
+			     NULL);
+
+  need_reread = FALSE;
+}
+
 /* Called in every public function.  It reloads the hash function if need be.
  */
 static void
@@ -439,23 +524,20 @@ xdg_mime_init (void)
 {
   if (xdg_check_time_and_dirs ())
     {
-      xdg_mime_shutdown ();
-    }
+      XdgDirTimeList *old_list;
 
-  if (need_reread)
-    {
-      global_hash = _xdg_glob_hash_new ();
-      global_magic = _xdg_mime_magic_new ();
-      alias_list = _xdg_mime_alias_list_new ();
-      parent_list = _xdg_mime_parent_list_new ();
-      icon_list = _xdg_mime_icon_list_new ();
-      generic_icon_list = _xdg_mime_icon_list_new ();
+      /* Hold on to the old caches so that the unchanged ones are reused */
+      old_list = dir_time_list;
+      dir_time_list = NULL;
 
-      xdg_run_command_on_dirs ((XdgDirectoryFunc) xdg_mime_init_from_directory,
-			       NULL);
+      xdg_mime_shutdown ();
+      xdg_mime_load (old_list);
 
-      need_reread = FALSE;
+      xdg_dir_time_list_free (old_list);
     }
+
+  if (need_reread)
+    xdg_mime_load (NULL);
 }
 
 const char *
@@ -0,0 +1,396 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "garena.h"
+
+#include "gmem.h"
+#include "gmessages.h"
+#include "gslice.h"
+#include "gtestutils.h"
+
+#include <string.h>
+
+/**
+ * SECTION:arenas
+ * @title: Memory Arenas
+ * @short_description: allocate many blocks of memory, free them at once
+ *
+ * A #GArena hands out memory from large blocks that it allocates as
+ * needed, by simply advancing a pointer.  Memory allocated from an
+ * arena is never freed on its own; all of it is released together when
+ * the arena is reset with g_arena_reset() or freed with g_arena_free().
+ *
+ * This makes allocating from an arena very cheap, and makes it possible
+ * to release an arbitrarily complex set of data structures with a single
+ * call, which suits scratch data that shares a common lifetime, like
+ * everything built while handling one request.
+ *
+ * #GString, #GPtrArray and #GHashTable can be created inside an arena
+ * with g_string_new_in_arena(), g_ptr_array_new_in_arena() and
+ * g_hash_table_new_in_arena().  Both their structure and the memory
+ * they allocate as they grow then come from the arena.  They can still
+ * be freed as usual, which runs destroy notifiers but gives no memory
+ * back, or be left for the arena to release.
+ *
+ * A #GArena is not thread-safe; if it is shared between threads, the
+ * caller must serialize all access to it.
+ */
+
+/**
+ * GArena:
+ *
+ * An opaque structure representing a memory arena.
+ *
+ * Since: 2.54
+ */
+
+#define ARENA_ALIGNMENT         (2 * sizeof (gsize))
+#define ARENA_ALIGN(size)       (((size) + ARENA_ALIGNMENT - 1) & ~(gsize) (ARENA_ALIGNMENT - 1))
+#define ARENA_DEFAULT_BLOCK     (4096)
+#define ARENA_BLOCK_HEADER      ARENA_ALIGN (sizeof (GArenaBlock))
+
+typedef struct _GArenaBlock GArenaBlock;
+
+struct _GArenaBlock
+{
+  GArenaBlock *next;
+  gsize        size;            /* usable bytes, after the header */
+};
+
+struct _GArena
+{
+  GArenaBlock *blocks;          /* the block being filled comes first */
+  guint8      *pos;
+  guint8      *end;
+  guint8      *last;            /* most recent allocation, for g_arena_realloc() */
+  gsize        block_size;
+};
+
+static inline guint8 *
+block_data (GArenaBlock *block)
+{
+  return (guint8 *) block + ARENA_BLOCK_HEADER;
+}
+
+/**
+ * g_arena_new:
+ * @block_size: the size of the blocks of memory the arena allocates,
+ *     or 0 for a default of a few kilobytes
+ *
+ * Creates a new, empty #GArena.
+ *
+ * Allocations larger than a quarter of @block_size get a block of
+ * their own, so @block_size only needs to be large compared to the
+ * typical allocation.  No memory beyond the #GArena itself is allocated
+ * until the first allocation.
+ *
+ * Returns: (transfer full): a new #GArena, free it with g_arena_free()
+ *
+ * Since: 2.54
+ */
+GArena *
+g_arena_new (gsize block_size)
+{
+  GArena *arena;
+
+  if (block_size == 0)
+    block_size = ARENA_DEFAULT_BLOCK;
+
+  arena = g_slice_new0 (GArena);
+  arena->block_size = ARENA_ALIGN (MAX (block_size, 4 * ARENA_ALIGNMENT));
+
+  return arena;
+}
+
+/**
+ * g_arena_free:
+ * @arena: (transfer full): a #GArena
+ *
+ * Frees @arena and all the memory that was allocated from it, including
+ * that of any #GString, #GPtrArray or #GHashTable created inside it.
+ *
+ * Unlike freeing such containers one by one, this does not call any
+ * destroy notifiers they have.
+ *
+ * Since: 2.54
+ */
+void
+g_arena_free (GArena *arena)
+{
+  GArenaBlock *block, *next;
+
+  g_return_if_fail (arena != NULL);
+
+  for (block = arena->blocks; block; block = next)
+    {
+      next = block->next;
+      g_free (block);
+    }
+
+  g_slice_free (GArena, arena);
+}
+
+/**
+ * g_arena_reset:
+ * @arena: a #GArena
+ *
+ * Releases all the memory that was allocated from @arena, like
+ * g_arena_free(), but leaves @arena itself ready to be used again.
+ *
+ * One block of memory is kept for the allocations that follow, so
+ * that an arena which is reset after every unit of work does not go
+ * back to the system allocator each time.
+ *
+ * Since: 2.54
+ */
+void
+g_arena_reset (GArena *arena)
+{
+  GArenaBlock *block, *next, *kept = NULL;
+
+  g_return_if_fail (arena != NULL);
+
+  for (block = arena->blocks; block; block = next)
+    {
+      next = block->next;
+
+      if (kept == NULL && block->size == arena->block_size)
+        kept = block;
+      else
+        g_free (block);
+    }
+
+  arena->blocks = kept;
+  arena->last = NULL;
+
+  if (kept)
+    {
+      kept->next = NULL;
+      arena->pos = block_data (kept);
+      arena->end = arena->pos + kept->size;
+    }
+  else
+    arena->pos = arena->end = NULL;
+}
+
+static gpointer
+g_arena_alloc_slow (GArena *arena,
+                    gsize   size)
+{
+  GArenaBlock *block;
+
+  if (size > arena->block_size / 4)
+    {
+      /* A block of its own, linked behind the one being filled so that
+       * the rest of that one is not wasted.
+       */
+      block = g_malloc (ARENA_BLOCK_HEADER + size);
+      block->size = size;
+
+      if (arena->blocks)
+        {
+          block->next = arena->blocks->next;
+          arena->blocks->next = block;
+        }
+      else
+        {
+          block->next = NULL;
+          arena->blocks = block;
+          arena->pos = arena->end = block_data (block) + size;
+        }
+
+      arena->last = NULL;
+
+      return block_data (block);
+    }
+
+  block = g_malloc (ARENA_BLOCK_HEADER + arena->block_size);
+  block->size = arena->block_size;
+  block->next = arena->blocks;
+  arena->blocks = block;
+
+  arena->last = block_data (block);
+  arena->pos = arena->last + size;
+  arena->end = arena->last + block->size;
+
+  return arena->last;
+}
+
+/**
+ * g_arena_alloc:
+ * @arena: a #GArena
+ * @size: the number of bytes to allocate
+ *
+ * Allocates @size bytes of memory from @arena.  The memory is suitably
+ * aligned for any kind of variable, just like memory returned by
+ * g_malloc().
+ *
+ * The memory must not be freed with g_free(); it stays valid until
+ * @arena is reset or freed.
+ *
+ * Returns: (transfer none): the allocated memory
+ *
+ * Since: 2.54
+ */
+gpointer
+g_arena_alloc (GArena *arena,
+               gsize   size)
+{
+  guint8 *mem;
+
+  g_return_val_if_fail (arena != NULL, NULL);
+
+  size = ARENA_ALIGN (MAX (size, 1));
+  if (G_UNLIKELY (size > (gsize) (arena->end - arena->pos)))
+    return g_arena_alloc_slow (arena, size);
+
+  mem = arena->pos;
+  arena->pos += size;
+  arena->last = mem;
+
+  return mem;
+}
+
+/**
+ * g_arena_alloc0:
+ * @arena: a #GArena
+ * @size: the number of bytes to allocate
+ *
+ * Allocates @size bytes of memory from @arena, like g_arena_alloc(),
+ * and sets them to 0.
+ *
+ * Returns: (transfer none): the allocated memory
+ *
+ * Since: 2.54
+ */
+gpointer
+g_arena_alloc0 (GArena *arena,
+                gsize   size)
+{
+  gpointer mem;
+
+  mem = g_arena_alloc (arena, size);
+  if (mem)
+    memset (mem, 0, size);
+
+  return mem;
+}
+
+/**
+ * g_arena_realloc:
+ * @arena: a #GArena
+ * @mem: (nullable): memory allocated from @arena, or %NULL
+ * @old_size: the size that @mem was allocated with
+ * @new_size: the size that is needed now
+ *
+ * Grows a block of memory that was allocated from @arena.
+ *
+ * If @mem was the most recent allocation from @arena and there is room
+ * behind it, it grows in place; otherwise, a new block of memory is
+ * allocated and the first @old_size bytes are copied into it.  The
+ * memory at @mem is not reused either way until @arena is reset.
+ *
+ * Shrinking returns @mem unchanged.
+ *
+ * Returns: (transfer none): the memory, which may have moved
+ *
+ * Since: 2.54
+ */
+gpointer
+g_arena_realloc (GArena   *arena,
+                 gpointer  mem,
+                 gsize     old_size,
+                 gsize     new_size)
+{
+  gpointer new_mem;
+
+  g_return_val_if_fail (arena != NULL, NULL);
+
+  if (mem == NULL)
+    return g_arena_alloc (arena, new_size);
+
+  if (new_size <= old_size)
+    return mem;
+
+  if (mem == arena->last &&
+      ARENA_ALIGN (new_size) <= (gsize) (arena->end - arena->last))
+    {
+      arena->pos = arena->last + ARENA_ALIGN (new_size);
+      return mem;
+    }
+
+  new_mem = g_arena_alloc (arena, new_size);
+  memcpy (new_mem, mem, old_size);
+
+  return new_mem;
+}
+
+/**
+ * g_arena_strdup:
+ * @arena: a #GArena
+ * @str: (nullable): the string to duplicate
+ *
+ * Duplicates a string into @arena, like g_strdup() does with g_malloc().
+ *
+ * Returns: (transfer none) (nullable): the copy of @str, or %NULL if
+ *     @str is %NULL
+ *
+ * Since: 2.54
+ */
+gchar *
+g_arena_strdup (GArena      *arena,
+                const gchar *str)
+{
+  if (str == NULL)
+    return NULL;
+
+  return g_arena_memdup (arena, str, strlen (str) + 1);
+}
+
+/**
+ * g_arena_memdup:
+ * @arena: a #GArena
+ * @mem: (nullable): the memory to copy
+ * @size: the number of bytes to copy
+ *
+ * Copies @size bytes of memory from @mem into @arena, like g_memdup()
+ * does with g_malloc().
+ *
+ * Returns: (transfer none) (nullable): the copy of @mem, or %NULL if
+ *     @mem is %NULL
+ *
+ * Since: 2.54
+ */
+gpointer
+g_arena_memdup (GArena        *arena,
+                gconstpointer  mem,
+                gsize          size)
+{
+  gpointer new_mem;
+
+  if (mem == NULL)
+    return NULL;
+
+  new_mem = g_arena_alloc (arena, size);
+  if (new_mem)
+    memcpy (new_mem, mem, size);
+
+  return new_mem;
+}
@@ -0,0 +1,60 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_ARENA_H__
+#define __G_ARENA_H__
+
+#if !defined (__GLIB_H_INSIDE__) && !defined (GLIB_COMPILATION)
+#error "Only <glib.h> can be included directly."
+#endif
+
+#include <glib/gtypes.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GArena GArena;
+
+GLIB_AVAILABLE_IN_2_54
+GArena   *g_arena_new           (gsize          block_size);
+GLIB_AVAILABLE_IN_2_54
+void      g_arena_free          (GArena        *arena);
+GLIB_AVAILABLE_IN_2_54
+void      g_arena_reset         (GArena        *arena);
+
+GLIB_AVAILABLE_IN_2_54
+gpointer  g_arena_alloc         (GArena        *arena,
+                                 gsize          size) G_GNUC_MALLOC G_GNUC_ALLOC_SIZE(2);
+GLIB_AVAILABLE_IN_2_54
+gpointer  g_arena_alloc0        (GArena        *arena,
+                                 gsize          size) G_GNUC_MALLOC G_GNUC_ALLOC_SIZE(2);
+GLIB_AVAILABLE_IN_2_54
+gpointer  g_arena_realloc       (GArena        *arena,
+                                 gpointer       mem,
+                                 gsize          old_size,
+                                 gsize          new_size) G_GNUC_WARN_UNUSED_RESULT;
+GLIB_AVAILABLE_IN_2_54
+gchar    *g_arena_strdup        (GArena        *arena,
+                                 const gchar   *str) G_GNUC_MALLOC;
+GLIB_AVAILABLE_IN_2_54
+gpointer  g_arena_memdup        (GArena        *arena,
+                                 gconstpointer  mem,
+                                 gsize          size) G_GNUC_MALLOC G_GNUC_ALLOC_SIZE(3);
+
+G_END_DECLS
+
+#endif /* __G_ARENA_H__ */
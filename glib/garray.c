@@ -40,6 +40,7 @@
 #include "gthread.h"
 #include "gmessages.h"
 #include "gqsort.h"
+#include "gstrfuncs.h"
 
 
 /**
@@ -107,6 +108,7 @@ struct _GRealArray
   guint   clear : 1;
   gint    ref_count;
   GDestroyNotify clear_func;
+  gsize   alignment;    /* non-zero if data comes from g_aligned_alloc() */
 };
 
 /**
@@ -200,6 +202,7 @@ g_array_sized_new (gboolean zero_terminated,
   array->elt_size        = elt_size;
   array->ref_count       = 1;
   array->clear_func      = NULL;
+  array->alignment       = 0;
 
   if (array->zero_terminated || reserved_size != 0)
     {
@@ -362,7 +365,10 @@ array_free (GRealArray     *array,
             array->clear_func (g_array_elt_pos (array, i));
         }
 
-      g_free (array->data);
+      if (array->alignment)
+        g_aligned_free (array->data);
+      else
+        g_free (array->data);
       segment = NULL;
     }
   else
@@ -382,6 +388,51 @@ array_free (GRealArray     *array,
   return segment;
 }
 
+/**
+ * g_array_steal:
+ * @array: a #GArray
+ * @len: (optional) (out caller-allocates): return location for the
+ *     number of elements in the returned data, or %NULL
+ *
+ * Takes the element data out of @array without copying it, and leaves
+ * @array empty but usable.
+ *
+ * This is like g_array_free() with @free_segment set to %FALSE, but
+ * keeps the #GArray, and any other references to it, alive.  No clear
+ * function is called, since the elements now belong to the caller.
+ *
+ * Returns: (transfer full) (nullable): the element data, which should
+ *     be freed using g_free(), or with g_aligned_free() if the array
+ *     was created by g_byte_array_sized_new_aligned()
+ *
+ * Since: 2.54
+ */
+gpointer
+g_array_steal (GArray *farray,
+               gsize  *len)
+{
+  GRealArray *array = (GRealArray *) farray;
+  gpointer segment;
+
+  g_return_val_if_fail (array, NULL);
+
+  segment = array->data;
+  if (len != NULL)
+    *len = array->len;
+
+  array->data  = NULL;
+  array->len   = 0;
+  array->alloc = 0;
+
+  if (array->zero_terminated)
+    {
+      g_array_maybe_expand (array, 0);
+      g_array_zero_terminate (array);
+    }
+
+  return segment;
+}
+
 /**
  * g_array_append_vals:
  * @array: a #GArray
@@ -785,7 +836,18 @@ g_array_maybe_expand (GRealArray *array,
       want_alloc = g_nearest_pow (want_alloc);
       want_alloc = MAX (want_alloc, MIN_ARRAY_SIZE);
 
-      array->data = g_realloc (array->data, want_alloc);
+      if (array->alignment)
+        {
+          /* there is no aligned realloc() */
+          guint8 *data = g_aligned_alloc (1, want_alloc, array->alignment);
+
+          if (array->data)
+            memcpy (data, array->data, array->alloc);
+          g_aligned_free (array->data);
+          array->data = data;
+        }
+      else
+        array->data = g_realloc (array->data, want_alloc);
 
       if (G_UNLIKELY (g_mem_gc_friendly))
         memset (array->data + array->alloc, 0, want_alloc - array->alloc);
@@ -858,9 +920,15 @@ struct _GRealPtrArray
   guint           len;
   guint           alloc;
   gint            ref_count;
+  guint           n_inline;     /* slots right behind the structure */
   GDestroyNotify  element_free_func;
+  GArena         *arena;
 };
 
+#define ptr_array_inline_storage(array) ((gpointer *) ((GRealPtrArray *) (array) + 1))
+#define ptr_array_is_inline(array) ((array)->n_inline != 0 && \
+                                    (array)->pdata == ptr_array_inline_storage (array))
+
 /**
  * g_ptr_array_index:
  * @array: a #GPtrArray
@@ -912,7 +980,9 @@ g_ptr_array_sized_new (guint reserved_size)
   array->len = 0;
   array->alloc = 0;
   array->ref_count = 1;
+  array->n_inline = 0;
   array->element_free_func = NULL;
+  array->arena = NULL;
 
   if (reserved_size != 0)
     g_ptr_array_maybe_expand (array, reserved_size);
@@ -920,6 +990,45 @@ g_ptr_array_sized_new (guint reserved_size)
   return (GPtrArray*) array;  
 }
 
+/**
+ * g_ptr_array_new_in_arena:
+ * @arena: a #GArena
+ *
+ * Creates a new #GPtrArray inside @arena, with a reference count of 1.
+ *
+ * The #GPtrArray and its array of pointers are allocated from @arena,
+ * also when the array grows; they are released along with @arena and
+ * stay valid until then.  The array may be left for @arena to release,
+ * or be freed with g_ptr_array_unref() or g_ptr_array_free() as usual,
+ * which calls the element free function, if there is one, but gives no
+ * memory back.  If the array of pointers is kept by passing %FALSE to
+ * g_ptr_array_free(), it belongs to @arena and must not be freed with
+ * g_free().
+ *
+ * Returns: (transfer none): the new #GPtrArray
+ *
+ * Since: 2.54
+ */
+GPtrArray *
+g_ptr_array_new_in_arena (GArena *arena)
+{
+  GRealPtrArray *array;
+
+  g_return_val_if_fail (arena != NULL, NULL);
+
+  array = g_arena_alloc (arena, sizeof (GRealPtrArray));
+
+  array->pdata = NULL;
+  array->len = 0;
+  array->alloc = 0;
+  array->ref_count = 1;
+  array->n_inline = 0;
+  array->element_free_func = NULL;
+  array->arena = arena;
+
+  return (GPtrArray *) array;
+}
+
 /**
  * g_ptr_array_new_with_free_func:
  * @element_free_func: (nullable): A function to free elements with
@@ -975,6 +1084,56 @@ g_ptr_array_new_full (guint          reserved_size,
   return array;
 }
 
+/**
+ * g_ptr_array_new_inline:
+ * @n_inline: number of pointers to store along with the #GPtrArray
+ * @element_free_func: (nullable): A function to free elements with
+ *     destroy @array or %NULL
+ *
+ * Creates a new #GPtrArray like g_ptr_array_new_full(), but with room
+ * for @n_inline pointers in the same block of memory as the #GPtrArray
+ * itself.
+ *
+ * As long as the array holds no more than @n_inline pointers, it costs
+ * a single allocation instead of two; only when it grows beyond that
+ * are the pointers moved to memory of their own.  This suits the many
+ * arrays that hold just a few elements.
+ *
+ * The array of pointers that g_ptr_array_free() with @free_segment set
+ * to %FALSE or g_ptr_array_steal() return is copied out of the inline
+ * space if needed, so it can be freed with g_free() as usual.
+ *
+ * Returns: A new #GPtrArray
+ *
+ * Since: 2.54
+ */
+GPtrArray *
+g_ptr_array_new_inline (guint          n_inline,
+                        GDestroyNotify element_free_func)
+{
+  GRealPtrArray *array;
+
+  g_return_val_if_fail (n_inline <= (G_MAXSIZE - sizeof (GRealPtrArray)) / sizeof (gpointer), NULL);
+
+  if (n_inline == 0)
+    return g_ptr_array_new_with_free_func (element_free_func);
+
+  array = g_slice_alloc (sizeof (GRealPtrArray) + n_inline * sizeof (gpointer));
+
+  array->pdata = ptr_array_inline_storage (array);
+  array->len = 0;
+  array->alloc = n_inline;
+  array->ref_count = 1;
+  array->n_inline = n_inline;
+  array->element_free_func = element_free_func;
+  array->arena = NULL;
+
+  if (G_UNLIKELY (g_mem_gc_friendly))
+    memset (array->pdata, 0, n_inline * sizeof (gpointer));
+
+  return (GPtrArray *) array;
+}
+
 /**
  * g_ptr_array_set_free_func:
  * @array: A #GPtrArray
@@ -1021,6 +1180,24 @@ g_ptr_array_ref (GPtrArray *array)
   return array;
 }
 
+/* Empties @array, after its storage has been freed or handed out */
+static void
+ptr_array_reset (GRealPtrArray *array)
+{
+  if (array->n_inline)
+    {
+      array->pdata = ptr_array_inline_storage (array);
+      array->alloc = array->n_inline;
+    }
+  else
+    {
+      array->pdata = NULL;
+      array->alloc = 0;
+    }
+
+  array->len = 0;
+}
+
 static gpointer *ptr_array_free (GPtrArray *, ArrayFreeFlags);
 
 /**
@@ -1095,26 +1272,74 @@ ptr_array_free (GPtrArray      *array,
     {
       if (rarray->element_free_func != NULL)
         g_ptr_array_foreach (array, (GFunc) rarray->element_free_func, NULL);
-      g_free (rarray->pdata);
+      if (!rarray->arena && !ptr_array_is_inline (rarray))
+        g_free (rarray->pdata);
       segment = NULL;
     }
+  else if (ptr_array_is_inline (rarray))
+    segment = g_memdup (rarray->pdata, sizeof (gpointer) * rarray->len);
   else
     segment = rarray->pdata;
 
   if (flags & PRESERVE_WRAPPER)
     {
-      rarray->pdata = NULL;
-      rarray->len = 0;
-      rarray->alloc = 0;
+      ptr_array_reset (rarray);
     }
-  else
+  else if (!rarray->arena)
     {
-      g_slice_free1 (sizeof (GRealPtrArray), rarray);
+      g_slice_free1 (sizeof (GRealPtrArray) + rarray->n_inline * sizeof (gpointer), rarray);
     }
 
   return segment;
 }
 
+/**
+ * g_ptr_array_steal:
+ * @array: a #GPtrArray
+ * @len: (optional) (out caller-allocates): return location for the
+ *     number of pointers in the returned array, or %NULL
+ *
+ * Takes the array of pointers out of @array without copying it, and
+ * leaves @array empty but usable.
+ *
+ * This is like g_ptr_array_free() with @free_segment set to %FALSE,
+ * but keeps the #GPtrArray, and any other references to it, alive.
+ * The element free function is not called, since the elements now
+ * belong to the caller.  Only for arrays created with
+ * g_ptr_array_new_inline() that have not outgrown their inline space
+ * are the pointers copied.
+ *
+ * Returns: (transfer full) (nullable): the array of pointers, which
+ *     should be freed using g_free(), unless @array was created inside
+ *     an arena
+ *
+ * Since: 2.54
+ */
+gpointer *
+g_ptr_array_steal (GPtrArray *array,
+                   gsize     *len)
+{
+  GRealPtrArray *rarray = (GRealPtrArray *) array;
+  gpointer *segment;
+
+  g_return_val_if_fail (array, NULL);
+
+  if (len != NULL)
+    *len = rarray->len;
+
+  if (ptr_array_is_inline (rarray))
+    {
+      segment = g_memdup (rarray->pdata, sizeof (gpointer) * rarray->len);
+      rarray->len = 0;
+      return segment;
+    }
+
+  segment = rarray->pdata;
+  ptr_array_reset (rarray);
+
+  return segment;
+}
+
 static void
 g_ptr_array_maybe_expand (GRealPtrArray *array,
                           gint           len)
@@ -1124,7 +1349,19 @@ g_ptr_array_maybe_expand (GRealPtrArray *array,
       guint old_alloc = array->alloc;
       array->alloc = g_nearest_pow (array->len + len);
       array->alloc = MAX (array->alloc, MIN_ARRAY_SIZE);
-      array->pdata = g_realloc (array->pdata, sizeof (gpointer) * array->alloc);
+      if (G_UNLIKELY (array->arena))
+        array->pdata = g_arena_realloc (array->arena, array->pdata,
+                                        sizeof (gpointer) * old_alloc,
+                                        sizeof (gpointer) * array->alloc);
+      else if (ptr_array_is_inline (array))
+        {
+          gpointer *pdata = g_new (gpointer, array->alloc);
+
+          memcpy (pdata, array->pdata, sizeof (gpointer) * old_alloc);
+          array->pdata = pdata;
+        }
+      else
+        array->pdata = g_realloc (array->pdata, sizeof (gpointer) * array->alloc);
       if (G_UNLIKELY (g_mem_gc_friendly))
         for ( ; old_alloc < array->alloc; old_alloc++)
           array->pdata [old_alloc] = NULL;
@@ -1620,6 +1857,41 @@ g_byte_array_sized_new (guint reserved_size)
   return (GByteArray *)g_array_sized_new (FALSE, FALSE, 1, reserved_size);
 }
 
+/**
+ * g_byte_array_sized_new_aligned:
+ * @reserved_size: number of bytes preallocated
+ * @alignment: the alignment of the byte data, which must be a power of 2
+ *
+ * Creates a new #GByteArray with @reserved_size bytes preallocated,
+ * like g_byte_array_sized_new(), whose data is always aligned to a
+ * multiple of @alignment bytes, also after it is moved as the array
+ * grows.
+ *
+ * The data is allocated with g_aligned_alloc(), so if it is taken out
+ * of the array with g_byte_array_free(), it must be freed with
+ * g_aligned_free().  g_byte_array_free_to_bytes() takes care of this.
+ *
+ * Returns: the new #GByteArray
+ *
+ * Since: 2.54
+ */
+GByteArray*
+g_byte_array_sized_new_aligned (guint reserved_size,
+                                gsize alignment)
+{
+  GRealArray *array;
+
+  g_return_val_if_fail (alignment != 0 && (alignment & (alignment - 1)) == 0, NULL);
+
+  array = (GRealArray *)g_array_sized_new (FALSE, FALSE, 1, 0);
+  array->alignment = alignment;
+
+  if (reserved_size != 0)
+    g_array_maybe_expand (array, reserved_size);
+
+  return (GByteArray *)array;
+}
+
 /**
  * g_byte_array_free:
  * @array: a #GByteArray
@@ -1631,7 +1903,9 @@ g_byte_array_sized_new (guint reserved_size)
  * the size of @array will be set to zero.
  *
  * Returns: the element data if @free_segment is %FALSE, otherwise
- *          %NULL.  The element data should be freed using g_free().
+ *          %NULL.  The element data should be freed using g_free(), or
+ *          g_aligned_free() if @array was created with
+ *          g_byte_array_sized_new_aligned().
  */
 guint8*
 g_byte_array_free (GByteArray *array,
@@ -1666,6 +1940,8 @@ g_byte_array_free_to_bytes (GByteArray *array)
   g_return_val_if_fail (array != NULL, NULL);
 
   length = array->len;
+  if (((GRealArray *)array)->alignment)
+    return g_bytes_new_take_aligned (g_byte_array_free (array, FALSE), length);
   return g_bytes_new_take (g_byte_array_free (array, FALSE), length);
 }
 
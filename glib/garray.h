@@ -30,6 +30,7 @@
 #endif
 
 #include <glib/gtypes.h>
+#include <glib/garena.h>
 
 G_BEGIN_DECLS
 
@@ -78,6 +79,9 @@ GArray* g_array_sized_new         (gboolean          zero_terminated,
 GLIB_AVAILABLE_IN_ALL
 gchar*  g_array_free              (GArray           *array,
 				   gboolean          free_segment);
+GLIB_AVAILABLE_IN_2_54
+gpointer g_array_steal            (GArray           *array,
+				   gsize            *len);
 GLIB_AVAILABLE_IN_ALL
 GArray *g_array_ref               (GArray           *array);
 GLIB_AVAILABLE_IN_ALL
@@ -135,9 +139,17 @@ GPtrArray* g_ptr_array_sized_new          (guint             reserved_size);
 GLIB_AVAILABLE_IN_ALL
 GPtrArray* g_ptr_array_new_full           (guint             reserved_size,
 					   GDestroyNotify    element_free_func);
+GLIB_AVAILABLE_IN_2_54
+GPtrArray* g_ptr_array_new_in_arena       (GArena           *arena);
+GLIB_AVAILABLE_IN_2_54
+GPtrArray* g_ptr_array_new_inline         (guint             n_inline,
+					   GDestroyNotify    element_free_func);
 GLIB_AVAILABLE_IN_ALL
 gpointer*  g_ptr_array_free               (GPtrArray        *array,
 					   gboolean          free_seg);
+GLIB_AVAILABLE_IN_2_54
+gpointer*  g_ptr_array_steal              (GPtrArray        *array,
+					   gsize            *len);
 GLIB_AVAILABLE_IN_ALL
 GPtrArray* g_ptr_array_ref                (GPtrArray        *array);
 GLIB_AVAILABLE_IN_ALL
@@ -195,6 +207,9 @@ GByteArray* g_byte_array_new_take          (guint8           *data,
                                             gsize             len);
 GLIB_AVAILABLE_IN_ALL
 GByteArray* g_byte_array_sized_new         (guint             reserved_size);
+GLIB_AVAILABLE_IN_2_54
+GByteArray* g_byte_array_sized_new_aligned (guint             reserved_size,
+                                            gsize             alignment);
 GLIB_AVAILABLE_IN_ALL
 guint8*     g_byte_array_free              (GByteArray       *array,
 					    gboolean          free_segment);
@@ -1,7 +1,7 @@
 /* GLIB - Library of useful routines for C programming
  * Copyright (C) 1995-1997  Peter Mattis, Spencer Kimball and Josh MacDonald
  *
- * GAsyncQueue: asynchronous queue implementation, based on GQueue.
+ * GAsyncQueue: asynchronous queue implementation, based on GRingQueue.
  * Copyright (C) 2000 Sebastian Wilhelmi; University of Karlsruhe
  *
  * This library is free software; you can redistribute it and/or
@@ -29,7 +29,7 @@
 
 #include "gmain.h"
 #include "gmem.h"
-#include "gqueue.h"
+#include "gringqueue.h"
 #include "gtestutils.h"
 #include "gtimer.h"
 #include "gthread.h"
@@ -96,7 +96,7 @@ struct _GAsyncQueue
 {
   GMutex mutex;
   GCond cond;
-  GQueue queue;
+  GRingQueue *queue;
   GDestroyNotify item_free_func;
   guint waiting_threads;
   gint ref_count;
@@ -141,7 +141,7 @@ g_async_queue_new_full (GDestroyNotify item_free_func)
   queue = g_new (GAsyncQueue, 1);
   g_mutex_init (&queue->mutex);
   g_cond_init (&queue->cond);
-  g_queue_init (&queue->queue);
+  queue->queue = g_ring_queue_new ();
   queue->waiting_threads = 0;
   queue->ref_count = 1;
   queue->item_free_func = item_free_func;
@@ -230,8 +230,9 @@ g_async_queue_unref (GAsyncQueue *queue)
       g_mutex_clear (&queue->mutex);
       g_cond_clear (&queue->cond);
       if (queue->item_free_func)
-        g_queue_foreach (&queue->queue, (GFunc) queue->item_free_func, NULL);
-      g_queue_clear (&queue->queue);
+        g_ring_queue_free_full (queue->queue, queue->item_free_func);
+      else
+        g_ring_queue_free (queue->queue);
       g_free (queue);
     }
 }
@@ -311,11 +312,76 @@ g_async_queue_push_unlocked (GAsyncQueue *queue,
   g_return_if_fail (queue);
   g_return_if_fail (data);
 
-  g_queue_push_head (&queue->queue, data);
+  g_ring_queue_push_head (queue->queue, data);
   if (queue->waiting_threads > 0)
     g_cond_signal (&queue->cond);
 }
 
+/**
+ * g_async_queue_push_many:
+ * @queue: a #GAsyncQueue
+ * @data: (array length=n_data): the items to push into the @queue
+ * @n_data: the number of items in @data
+ *
+ * Pushes the @n_data items of @data into the @queue, in order, as if
+ * g_async_queue_push() had been called for each of them but taking
+ * the lock of @queue only once.  At most @n_data waiting threads are
+ * woken up.  None of the items may be %NULL.
+ *
+ * Since: 2.54
+ */
+void
+g_async_queue_push_many (GAsyncQueue *queue,
+                         gpointer    *data,
+                         guint        n_data)
+{
+  g_return_if_fail (queue);
+  g_return_if_fail (data || n_data == 0);
+
+  g_mutex_lock (&queue->mutex);
+  g_async_queue_push_many_unlocked (queue, data, n_data);
+  g_mutex_unlock (&queue->mutex);
+}
+
+/**
+ * g_async_queue_push_many_unlocked:
+ * @queue: a #GAsyncQueue
+ * @data: (array length=n_data): the items to push into the @queue
+ * @n_data: the number of items in @data
+ *
+ * Pushes the @n_data items of @data into the @queue, like
+ * g_async_queue_push_many().
+ *
+ * This function must be called while holding the @queue's lock.
+ *
+ * Since: 2.54
+ */
+void
+g_async_queue_push_many_unlocked (GAsyncQueue *queue,
+                                  gpointer    *data,
+                                  guint        n_data)
+{
+  guint i;
+
+  g_return_if_fail (queue);
+  g_return_if_fail (data || n_data == 0);
+
+  for (i = 0; i < n_data; i++)
+    g_return_if_fail (data[i]);
+
+  for (i = 0; i < n_data; i++)
+    g_ring_queue_push_head (queue->queue, data[i]);
+
+  if (queue->waiting_threads > 0 && n_data > 0)
+    {
+      if (n_data >= queue->waiting_threads)
+        g_cond_broadcast (&queue->cond);
+      else
+        for (i = 0; i < n_data; i++)
+          g_cond_signal (&queue->cond);
+    }
+}
+
 /**
  * g_async_queue_push_sorted:
  * @queue: a #GAsyncQueue
@@ -395,10 +461,10 @@ g_async_queue_push_sorted_unlocked (GAsyncQueue      *queue,
   sd.func = func;
   sd.user_data = user_data;
 
-  g_queue_insert_sorted (&queue->queue,
-                         data,
-                         (GCompareDataFunc)g_async_queue_invert_compare,
-                         &sd);
+  g_ring_queue_insert_sorted (queue->queue,
+                              data,
+                              (GCompareDataFunc)g_async_queue_invert_compare,
+                              &sd);
   if (queue->waiting_threads > 0)
     g_cond_signal (&queue->cond);
 }
@@ -410,10 +476,10 @@ g_async_queue_pop_intern_unlocked (GAsyncQueue *queue,
 {
   gpointer retval;
 
-  if (!g_queue_peek_tail_link (&queue->queue) && wait)
+  if (g_ring_queue_is_empty (queue->queue) && wait)
     {
       queue->waiting_threads++;
-      while (!g_queue_peek_tail_link (&queue->queue))
+      while (g_ring_queue_is_empty (queue->queue))
         {
 	  if (end_time == -1)
 	    g_cond_wait (&queue->cond, &queue->mutex);
@@ -426,7 +492,7 @@ g_async_queue_pop_intern_unlocked (GAsyncQueue *queue,
       queue->waiting_threads--;
     }
 
-  retval = g_queue_pop_tail (&queue->queue);
+  retval = g_ring_queue_pop_tail (queue->queue);
 
   g_assert (retval || !wait || end_time > 0);
 
@@ -570,6 +636,162 @@ g_async_queue_timeout_pop_unlocked (GAsyncQueue *queue,
   return g_async_queue_pop_intern_unlocked (queue, TRUE, end_time);
 }
 
+static guint
+g_async_queue_pop_many_intern_unlocked (GAsyncQueue *queue,
+                                        gpointer    *data,
+                                        guint        max_data,
+                                        gint64       end_time)
+{
+  guint n_data;
+
+  if (max_data == 0)
+    return 0;
+
+  data[0] = g_async_queue_pop_intern_unlocked (queue, TRUE, end_time);
+  if (data[0] == NULL)
+    return 0;
+
+  for (n_data = 1; n_data < max_data; n_data++)
+    {
+      data[n_data] = g_ring_queue_pop_tail (queue->queue);
+      if (data[n_data] == NULL)
+        break;
+    }
+
+  return n_data;
+}
+
+/**
+ * g_async_queue_pop_many:
+ * @queue: a #GAsyncQueue
+ * @data: (out caller-allocates) (array length=max_data): return location
+ *     for the items
+ * @max_data: the maximum number of items to pop
+ *
+ * Pops up to @max_data items from the @queue, in the order in which
+ * g_async_queue_pop() would have returned them, taking the lock of
+ * @queue only once.  If @queue is empty, this function blocks until
+ * data becomes available; it then returns what is available without
+ * waiting for more.
+ *
+ * Returns: the number of items stored in @data, which is at least 1
+ *     unless @max_data is 0
+ *
+ * Since: 2.54
+ */
+guint
+g_async_queue_pop_many (GAsyncQueue *queue,
+                        gpointer    *data,
+                        guint        max_data)
+{
+  guint retval;
+
+  g_return_val_if_fail (queue, 0);
+  g_return_val_if_fail (data || max_data == 0, 0);
+
+  g_mutex_lock (&queue->mutex);
+  retval = g_async_queue_pop_many_intern_unlocked (queue, data, max_data, -1);
+  g_mutex_unlock (&queue->mutex);
+
+  return retval;
+}
+
+/**
+ * g_async_queue_pop_many_unlocked:
+ * @queue: a #GAsyncQueue
+ * @data: (out caller-allocates) (array length=max_data): return location
+ *     for the items
+ * @max_data: the maximum number of items to pop
+ *
+ * Pops up to @max_data items from the @queue, like
+ * g_async_queue_pop_many().
+ *
+ * This function must be called while holding the @queue's lock.
+ *
+ * Returns: the number of items stored in @data, which is at least 1
+ *     unless @max_data is 0
+ *
+ * Since: 2.54
+ */
+guint
+g_async_queue_pop_many_unlocked (GAsyncQueue *queue,
+                                 gpointer    *data,
+                                 guint        max_data)
+{
+  g_return_val_if_fail (queue, 0);
+  g_return_val_if_fail (data || max_data == 0, 0);
+
+  return g_async_queue_pop_many_intern_unlocked (queue, data, max_data, -1);
+}
+
+/**
+ * g_async_queue_timeout_pop_many:
+ * @queue: a #GAsyncQueue
+ * @data: (out caller-allocates) (array length=max_data): return location
+ *     for the items
+ * @max_data: the maximum number of items to pop
+ * @timeout: the number of microseconds to wait
+ *
+ * Pops up to @max_data items from the @queue, like
+ * g_async_queue_pop_many(), but waits for at most @timeout
+ * microseconds if @queue is empty.
+ *
+ * Returns: the number of items stored in @data, or 0 if no data is
+ *     received before the timeout
+ *
+ * Since: 2.54
+ */
+guint
+g_async_queue_timeout_pop_many (GAsyncQueue *queue,
+                                gpointer    *data,
+                                guint        max_data,
+                                guint64      timeout)
+{
+  gint64 end_time = g_get_monotonic_time () + timeout;
+  guint retval;
+
+  g_return_val_if_fail (queue, 0);
+  g_return_val_if_fail (data || max_data == 0, 0);
+
+  g_mutex_lock (&queue->mutex);
+  retval = g_async_queue_pop_many_intern_unlocked (queue, data, max_data, end_time);
+  g_mutex_unlock (&queue->mutex);
+
+  return retval;
+}
+
+/**
+ * g_async_queue_timeout_pop_many_unlocked:
+ * @queue: a #GAsyncQueue
+ * @data: (out caller-allocates) (array length=max_data): return location
+ *     for the items
+ * @max_data: the maximum number of items to pop
+ * @timeout: the number of microseconds to wait
+ *
+ * Pops up to @max_data items from the @queue, like
+ * g_async_queue_timeout_pop_many().
+ *
+ * This function must be called while holding the @queue's lock.
+ *
+ * Returns: the number of items stored in @data, or 0 if no data is
+ *     received before the timeout
+ *
+ * Since: 2.54
+ */
+guint
+g_async_queue_timeout_pop_many_unlocked (GAsyncQueue *queue,
+                                         gpointer    *data,
+                                         guint        max_data,
+                                         guint64      timeout)
+{
+  gint64 end_time = g_get_monotonic_time () + timeout;
+
+  g_return_val_if_fail (queue, 0);
+  g_return_val_if_fail (data || max_data == 0, 0);
+
+  return g_async_queue_pop_many_intern_unlocked (queue, data, max_data, end_time);
+}
+
 /**
  * g_async_queue_timed_pop:
  * @queue: a #GAsyncQueue
@@ -674,7 +896,7 @@ g_async_queue_length (GAsyncQueue *queue)
   g_return_val_if_fail (queue, 0);
 
   g_mutex_lock (&queue->mutex);
-  retval = queue->queue.length - queue->waiting_threads;
+  retval = g_ring_queue_get_length (queue->queue) - queue->waiting_threads;
   g_mutex_unlock (&queue->mutex);
 
   return retval;
@@ -702,7 +924,7 @@ g_async_queue_length_unlocked (GAsyncQueue *queue)
 {
   g_return_val_if_fail (queue, 0);
 
-  return queue->queue.length - queue->waiting_threads;
+  return g_ring_queue_get_length (queue->queue) - queue->waiting_threads;
 }
 
 /**
@@ -780,9 +1002,9 @@ g_async_queue_sort_unlocked (GAsyncQueue      *queue,
   sd.func = func;
   sd.user_data = user_data;
 
-  g_queue_sort (&queue->queue,
-                (GCompareDataFunc)g_async_queue_invert_compare,
-                &sd);
+  g_ring_queue_sort (queue->queue,
+                     (GCompareDataFunc)g_async_queue_invert_compare,
+                     &sd);
 }
 
 /**
@@ -832,7 +1054,7 @@ g_async_queue_remove_unlocked (GAsyncQueue *queue,
   g_return_val_if_fail (queue != NULL, FALSE);
   g_return_val_if_fail (item != NULL, FALSE);
 
-  return g_queue_remove (&queue->queue, item);
+  return g_ring_queue_remove (queue->queue, item);
 }
 
 /**
@@ -880,7 +1102,7 @@ g_async_queue_push_front_unlocked (GAsyncQueue *queue,
   g_return_if_fail (queue != NULL);
   g_return_if_fail (item != NULL);
 
-  g_queue_push_tail (&queue->queue, item);
+  g_ring_queue_push_tail (queue->queue, item);
   if (queue->waiting_threads > 0)
     g_cond_signal (&queue->cond);
 }
@@ -60,6 +60,14 @@ void         g_async_queue_push                 (GAsyncQueue      *queue,
 GLIB_AVAILABLE_IN_ALL
 void         g_async_queue_push_unlocked        (GAsyncQueue      *queue,
                                                  gpointer          data);
+GLIB_AVAILABLE_IN_2_54
+void         g_async_queue_push_many            (GAsyncQueue      *queue,
+                                                 gpointer         *data,
+                                                 guint             n_data);
+GLIB_AVAILABLE_IN_2_54
+void         g_async_queue_push_many_unlocked   (GAsyncQueue      *queue,
+                                                 gpointer         *data,
+                                                 guint             n_data);
 GLIB_AVAILABLE_IN_ALL
 void         g_async_queue_push_sorted          (GAsyncQueue      *queue,
                                                  gpointer          data,
@@ -84,6 +92,24 @@ gpointer     g_async_queue_timeout_pop          (GAsyncQueue      *queue,
 GLIB_AVAILABLE_IN_ALL
 gpointer     g_async_queue_timeout_pop_unlocked (GAsyncQueue      *queue,
                                                  guint64           timeout);
+GLIB_AVAILABLE_IN_2_54
+guint        g_async_queue_pop_many             (GAsyncQueue      *queue,
+                                                 gpointer         *data,
+                                                 guint             max_data);
+GLIB_AVAILABLE_IN_2_54
+guint        g_async_queue_pop_many_unlocked    (GAsyncQueue      *queue,
+                                                 gpointer         *data,
+                                                 guint             max_data);
+GLIB_AVAILABLE_IN_2_54
+guint        g_async_queue_timeout_pop_many     (GAsyncQueue      *queue,
+                                                 gpointer         *data,
+                                                 guint             max_data,
+                                                 guint64           timeout);
+GLIB_AVAILABLE_IN_2_54
+guint        g_async_queue_timeout_pop_many_unlocked (GAsyncQueue *queue,
+                                                 gpointer         *data,
+                                                 guint             max_data,
+                                                 guint64           timeout);
 GLIB_AVAILABLE_IN_ALL
 gint         g_async_queue_length               (GAsyncQueue      *queue);
 GLIB_AVAILABLE_IN_ALL
@@ -27,8 +27,17 @@
 
 #include "gbase64.h"
 #include "gtestutils.h"
+#include "gthread.h"
 #include "glibintl.h"
 
+/* Blocks of 12 bytes and 16 characters with SSSE3, picked at runtime */
+#if (defined (__x86_64__) || defined (__i386__)) && \
+    ((defined (__GNUC__) && __GNUC__ >= 5) || defined (__clang__))
+#include <cpuid.h>
+#include <immintrin.h>
+#define BASE64_USE_SSSE3 1
+#endif
+
 
 /**
  * SECTION:base64
@@ -56,6 +65,114 @@
 static const char base64_alphabet[] =
         "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+#ifdef BASE64_USE_SSSE3
+static gboolean
+base64_have_ssse3 (void)
+{
+  static gsize have_ssse3 = 0;
+
+  if (g_once_init_enter (&have_ssse3))
+    {
+      guint eax, ebx, ecx, edx;
+      gboolean found;
+
+      found = __get_cpuid (1, &eax, &ebx, &ecx, &edx) && (ecx & (1 << 9));
+      g_once_init_leave (&have_ssse3, found ? 2 : 1);
+    }
+
+  return have_ssse3 == 2;
+}
+
+/* Encodes @n_blocks times 12 bytes into 16 characters each.  Reads 4
+ * bytes beyond the last block, which the caller must have.
+ */
+__attribute__ ((target ("ssse3")))
+static void
+base64_encode_ssse3 (const guchar *in,
+                     gsize         n_blocks,
+                     gchar        *out)
+{
+  /* 3 bytes into each 32-bit lane as [b1 b0 b2 b1], then the 6-bit
+   * indices moved into separate bytes with multiplications.
+   */
+  const __m128i spread = _mm_setr_epi8 (1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+  const __m128i shift_lut = _mm_setr_epi8 ('a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                           '/' - 63, 'A', 0, 0);
+
+  for (; n_blocks > 0; n_blocks--, in += 12, out += 16)
+    {
+      __m128i v, hi, lo, indices, offsets;
+
+      v = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) in), spread);
+      hi = _mm_mulhi_epu16 (_mm_and_si128 (v, _mm_set1_epi32 (0x0fc0fc00)),
+                            _mm_set1_epi32 (0x04000040));
+      lo = _mm_mullo_epi16 (_mm_and_si128 (v, _mm_set1_epi32 (0x003f03f0)),
+                            _mm_set1_epi32 (0x01000010));
+      indices = _mm_or_si128 (hi, lo);
+
+      /* 0..25 go to 13, and 26..63 to 0..12, to pick the offset to add */
+      offsets = _mm_subs_epu8 (indices, _mm_set1_epi8 (51));
+      offsets = _mm_or_si128 (offsets, _mm_and_si128 (_mm_cmpgt_epi8 (_mm_set1_epi8 (26), indices),
+                                                      _mm_set1_epi8 (13)));
+      offsets = _mm_shuffle_epi8 (shift_lut, offsets);
+
+      _mm_storeu_si128 ((__m128i *) out, _mm_add_epi8 (indices, offsets));
+    }
+}
+
+/* Decodes blocks of 16 characters into 12 bytes each for as long as
+ * they only contain characters of the alphabet, returning the number of
+ * blocks done.  Anything else is left to the caller.
+ */
+__attribute__ ((target ("ssse3")))
+static gsize
+base64_decode_ssse3 (const guchar *in,
+                     gsize         max_blocks,
+                     guchar       *out)
+{
+  /* Bits for the classes of the low and high nibbles; valid characters
+   * have no bit in common between the two.
+   */
+  const __m128i lut_lo = _mm_setr_epi8 (0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  const __m128i lut_hi = _mm_setr_epi8 (0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m128i lut_roll = _mm_setr_epi8 (0, 16, 19, 4, -65, -65, -71, -71,
+                                          0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i mask_2f = _mm_set1_epi8 (0x2f);
+  const __m128i pack = _mm_setr_epi8 (2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  gsize n_blocks;
+
+  for (n_blocks = 0; n_blocks < max_blocks; n_blocks++, in += 16, out += 12)
+    {
+      __m128i v, hi_nibbles, roll;
+
+      v = _mm_loadu_si128 ((const __m128i *) in);
+      hi_nibbles = _mm_and_si128 (_mm_srli_epi32 (v, 4), mask_2f);
+      if (_mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_and_si128 (_mm_shuffle_epi8 (lut_lo, _mm_and_si128 (v, mask_2f)),
+                                                            _mm_shuffle_epi8 (lut_hi, hi_nibbles)),
+                                             _mm_setzero_si128 ())) != 0xffff)
+        break;
+
+      /* characters to their 6-bit values, '/' being the odd one out */
+      roll = _mm_shuffle_epi8 (lut_roll, _mm_add_epi8 (_mm_cmpeq_epi8 (v, mask_2f), hi_nibbles));
+      v = _mm_add_epi8 (v, roll);
+
+      /* pack 4 x 6 bits into 3 bytes per lane */
+      v = _mm_maddubs_epi16 (v, _mm_set1_epi32 (0x01400140));
+      v = _mm_madd_epi16 (v, _mm_set1_epi32 (0x00011000));
+      v = _mm_shuffle_epi8 (v, pack);
+
+      _mm_storel_epi64 ((__m128i *) out, v);
+      *(guint32 *) (out + 8) = _mm_cvtsi128_si32 (_mm_srli_si128 (v, 8));
+    }
+
+  return n_blocks;
+}
+#endif /* BASE64_USE_SSSE3 */
+
 /**
  * g_base64_encode_step:
  * @in: (array length=len) (element-type guint8): the binary data to encode
@@ -116,6 +233,9 @@ g_base64_encode_step (const guchar *in,
       const guchar *inend = in+len-2;
       int c1, c2, c3;
       int already;
+#ifdef BASE64_USE_SSSE3
+      gboolean use_ssse3 = len >= 16 && base64_have_ssse3 ();
+#endif
 
       already = *state;
 
@@ -136,6 +256,21 @@ g_base64_encode_step (const guchar *in,
        */
       while (inptr < inend)
         {
+#ifdef BASE64_USE_SSSE3
+          if (use_ssse3 && in + len - inptr >= 16)
+            {
+              gsize n_blocks = (in + len - inptr - 4) / 12;
+
+              /* each block is 4 groups, and a line break comes after 19 */
+              if (break_lines)
+                n_blocks = MIN (n_blocks, (gsize) (18 - already) / 4);
+
+              base64_encode_ssse3 (inptr, n_blocks, outptr);
+              inptr += n_blocks * 12;
+              outptr += n_blocks * 16;
+              already += n_blocks * 4;
+            }
+#endif
           c1 = *inptr++;
         skip1:
           c2 = *inptr++;
@@ -361,6 +496,22 @@ g_base64_decode_step (const gchar  *in,
   inptr = (const guchar *)in;
   while (inptr < inend)
     {
+#ifdef BASE64_USE_SSSE3
+      if (i == 0 && inend - inptr >= 16 && base64_have_ssse3 ())
+        {
+          gsize n_blocks = base64_decode_ssse3 (inptr, (inend - inptr) / 16, outptr);
+
+          if (n_blocks > 0)
+            {
+              inptr += n_blocks * 16;
+              outptr += n_blocks * 12;
+              last[1] = inptr[-2];
+              last[0] = inptr[-1];
+              if (inptr == inend)
+                break;
+            }
+        }
+#endif
       c = *inptr++;
       rank = mime_base64_rank [c];
       if (rank != 0xff)
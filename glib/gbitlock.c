@@ -27,11 +27,18 @@
 #include <glib/gslist.h>
 #include <glib/gthread.h>
 #include <glib/gslice.h>
+#include <glib/gmain.h>
 
 #include "gthreadprivate.h"
 
 #ifdef G_BIT_LOCK_FORCE_FUTEX_EMULATION
 #undef HAVE_FUTEX
+/* This file is then built into a test, outside of libglib */
+#undef g_lock_profile_wanted
+#define g_lock_profile_wanted() FALSE
+#define g_lock_profile_active FALSE
+#define g_lock_profile_contended(lock, kind, wait_start)
+#define g_lock_profile_released(lock, kind)
 #endif
 
 #ifndef HAVE_FUTEX
@@ -74,7 +81,7 @@ static GSList *g_futex_address_list = NULL;
  * waiting process will unblock due to a g_futex_wake() call in a
  * separate process.
  */
-static void
+void
 g_futex_wait (const volatile gint *address,
               gint                 value)
 {
@@ -92,7 +99,7 @@ g_futex_wait (const volatile gint *address,
  * wakeups may occur.  As such, this call may result in more than one
  * thread being woken up.
  */
-static void
+void
 g_futex_wake (const volatile gint *address)
 {
   syscall (__NR_futex, address, (gsize) FUTEX_WAKE_PRIVATE, (gsize) 1, NULL);
@@ -124,7 +131,7 @@ g_futex_find_address (const volatile gint *address)
   return NULL;
 }
 
-static void
+void
 g_futex_wait (const volatile gint *address,
               gint                 value)
 {
@@ -157,7 +164,7 @@ g_futex_wait (const volatile gint *address,
   g_mutex_unlock (&g_futex_mutex);
 }
 
-static void
+void
 g_futex_wake (const volatile gint *address)
 {
   WaitAddress *waiter;
@@ -209,6 +216,8 @@ void
 g_bit_lock (volatile gint *address,
             gint           lock_bit)
 {
+  gint64 wait_start = 0;
+
 #ifdef USE_ASM_GOTO
  retry:
   __asm__ volatile goto ("lock bts %1, (%0)\n"
@@ -217,9 +226,15 @@ g_bit_lock (volatile gint *address,
                          : "r" (address), "r" (lock_bit)
                          : "cc", "memory"
                          : contended);
+
+  if G_UNLIKELY (wait_start)
+    g_lock_profile_contended ((gpointer) address, G_LOCK_PROFILE_BIT_LOCK, wait_start);
   return;
 
  contended:
+  if (wait_start == 0 && g_lock_profile_wanted ())
+    wait_start = g_get_monotonic_time ();
+
   {
     guint mask = 1u << lock_bit;
     guint v;
@@ -246,12 +261,18 @@ g_bit_lock (volatile gint *address,
     {
       guint class = ((gsize) address) % G_N_ELEMENTS (g_bit_lock_contended);
 
+      if (wait_start == 0 && g_lock_profile_wanted ())
+        wait_start = g_get_monotonic_time ();
+
       g_atomic_int_add (&g_bit_lock_contended[class], +1);
       g_futex_wait (address, v);
       g_atomic_int_add (&g_bit_lock_contended[class], -1);
 
       goto retry;
     }
+
+  if G_UNLIKELY (wait_start)
+    g_lock_profile_contended ((gpointer) address, G_LOCK_PROFILE_BIT_LOCK, wait_start);
 #endif
 }
 
@@ -336,7 +357,12 @@ g_bit_unlock (volatile gint *address,
     guint class = ((gsize) address) % G_N_ELEMENTS (g_bit_lock_contended);
 
     if (g_atomic_int_get (&g_bit_lock_contended[class]))
-      g_futex_wake (address);
+      {
+        if G_UNLIKELY (g_lock_profile_active)
+          g_lock_profile_released ((gpointer) address, G_LOCK_PROFILE_BIT_LOCK);
+
+        g_futex_wake (address);
+      }
   }
 }
 
@@ -403,6 +429,8 @@ void
   g_return_if_fail (lock_bit < 32);
 
   {
+    gint64 wait_start = 0;
+
 #ifdef USE_ASM_GOTO
  retry:
     asm volatile goto ("lock bts %1, (%0)\n"
@@ -411,9 +439,15 @@ void
                        : "r" (address), "r" ((gsize) lock_bit)
                        : "cc", "memory"
                        : contended);
+
+    if G_UNLIKELY (wait_start)
+      g_lock_profile_contended ((gpointer) address, G_LOCK_PROFILE_POINTER_BIT_LOCK, wait_start);
     return;
 
  contended:
+    if (wait_start == 0 && g_lock_profile_wanted ())
+      wait_start = g_get_monotonic_time ();
+
     {
       volatile gsize *pointer_address = address;
       gsize mask = 1u << lock_bit;
@@ -442,12 +476,18 @@ void
     {
       guint class = ((gsize) address) % G_N_ELEMENTS (g_bit_lock_contended);
 
+      if (wait_start == 0 && g_lock_profile_wanted ())
+        wait_start = g_get_monotonic_time ();
+
       g_atomic_int_add (&g_bit_lock_contended[class], +1);
       g_futex_wait (g_futex_int_address (address), (guint) v);
       g_atomic_int_add (&g_bit_lock_contended[class], -1);
 
       goto retry;
     }
+
+  if G_UNLIKELY (wait_start)
+    g_lock_profile_contended ((gpointer) address, G_LOCK_PROFILE_POINTER_BIT_LOCK, wait_start);
 #endif
   }
 }
@@ -534,7 +574,12 @@ void
     {
       guint class = ((gsize) address) % G_N_ELEMENTS (g_bit_lock_contended);
       if (g_atomic_int_get (&g_bit_lock_contended[class]))
-        g_futex_wake (g_futex_int_address (address));
+        {
+          if G_UNLIKELY (g_lock_profile_active)
+            g_lock_profile_released ((gpointer) address, G_LOCK_PROFILE_POINTER_BIT_LOCK);
+
+          g_futex_wake (g_futex_int_address (address));
+        }
     }
   }
 }
@@ -175,7 +175,8 @@ struct _BookmarkMetadata
   GList *groups;
   
   GList *applications;
-  GHashTable *apps_by_name;
+  guint n_applications;
+  GHashTable *apps_by_name; /* only for long application lists */
   
   gchar *icon_href;
   gchar *icon_mime;
@@ -247,6 +248,10 @@ static void          g_bookmark_file_add_item    (GBookmarkFile  *bookmark,
 						       
 static time_t  timestamp_from_iso8601 (const gchar *iso_date);
 static gchar * timestamp_to_iso8601   (time_t       timestamp);
+static void    append_timestamp       (GString     *str,
+                                       time_t       timestamp);
+static void    append_escaped_text    (GString     *str,
+                                       const gchar *text);
 
 /********************************
  * BookmarkAppInfo              *
@@ -282,36 +287,26 @@ bookmark_app_info_free (BookmarkAppInfo *app_info)
   g_slice_free (BookmarkAppInfo, app_info);
 }
 
-static gchar *
-bookmark_app_info_dump (BookmarkAppInfo *app_info)
+static void
+bookmark_app_info_dump (BookmarkAppInfo *app_info,
+                        GString         *retval)
 {
-  gchar *retval;
-  gchar *name, *exec, *modified, *count;
-
   g_warn_if_fail (app_info != NULL);
 
   if (app_info->count == 0)
-    return NULL;
-
-  name = g_markup_escape_text (app_info->name, -1);
-  exec = g_markup_escape_text (app_info->exec, -1);
-  modified = timestamp_to_iso8601 (app_info->stamp);
-  count = g_strdup_printf ("%u", app_info->count);
-
-  retval = g_strconcat ("          "
-                        "<" BOOKMARK_NAMESPACE_NAME ":" BOOKMARK_APPLICATION_ELEMENT
-                        " " BOOKMARK_NAME_ATTRIBUTE "=\"", name, "\""
-                        " " BOOKMARK_EXEC_ATTRIBUTE "=\"", exec, "\""
-                        " " BOOKMARK_MODIFIED_ATTRIBUTE "=\"", modified, "\""
-                        " " BOOKMARK_COUNT_ATTRIBUTE "=\"", count, "\"/>\n",
-                        NULL);
-
-  g_free (name);
-  g_free (exec);
-  g_free (modified);
-  g_free (count);
+    return;
 
-  return retval;
+  g_string_append (retval,
+                   "          "
+                   "<" BOOKMARK_NAMESPACE_NAME ":" BOOKMARK_APPLICATION_ELEMENT
+                   " " BOOKMARK_NAME_ATTRIBUTE "=\"");
+  append_escaped_text (retval, app_info->name);
+  g_string_append (retval, "\" " BOOKMARK_EXEC_ATTRIBUTE "=\"");
+  append_escaped_text (retval, app_info->exec);
+  g_string_append (retval, "\" " BOOKMARK_MODIFIED_ATTRIBUTE "=\"");
+  append_timestamp (retval, app_info->stamp);
+  g_string_append_printf (retval, "\" " BOOKMARK_COUNT_ATTRIBUTE "=\"%u\"/>\n",
+                          app_info->count);
 }
 
 
@@ -332,10 +327,8 @@ bookmark_metadata_new (void)
   retval->groups = NULL;
   
   retval->applications = NULL;
-  retval->apps_by_name = g_hash_table_new_full (g_str_hash,
-                                                g_str_equal,
-                                                NULL,
-                                                NULL);
+  retval->n_applications = 0;
+  retval->apps_by_name = NULL;
   
   retval->is_private = FALSE;
   
@@ -356,7 +349,8 @@ bookmark_metadata_free (BookmarkMetadata *metadata)
   g_list_free_full (metadata->groups, g_free);
   g_list_free_full (metadata->applications, (GDestroyNotify) bookmark_app_info_free);
 
-  g_hash_table_destroy (metadata->apps_by_name);
+  if (metadata->apps_by_name)
+    g_hash_table_destroy (metadata->apps_by_name);
 
   g_free (metadata->icon_href);
   g_free (metadata->icon_mime);
@@ -364,16 +358,52 @@ bookmark_metadata_free (BookmarkMetadata *metadata)
   g_slice_free (BookmarkMetadata, metadata);
 }
 
-static gchar *
-bookmark_metadata_dump (BookmarkMetadata *metadata)
+/* Most items are registered by one or two applications; a hash table
+ * to look them up only pays off for longer lists.
+ */
+#define APPS_BY_NAME_THRESHOLD 8
+
+static void
+bookmark_metadata_add_app_info (BookmarkMetadata *metadata,
+                                BookmarkAppInfo  *app_info)
+{
+  metadata->applications = g_list_prepend (metadata->applications, app_info);
+  metadata->n_applications++;
+
+  if (metadata->apps_by_name)
+    g_hash_table_replace (metadata->apps_by_name, app_info->name, app_info);
+  else if (metadata->n_applications > APPS_BY_NAME_THRESHOLD)
+    {
+      GList *l;
+
+      metadata->apps_by_name = g_hash_table_new (g_str_hash, g_str_equal);
+
+      for (l = g_list_last (metadata->applications); l != NULL; l = l->prev)
+        {
+          BookmarkAppInfo *ai = l->data;
+
+          g_hash_table_replace (metadata->apps_by_name, ai->name, ai);
+        }
+    }
+}
+
+static void
+bookmark_metadata_remove_app_info (BookmarkMetadata *metadata,
+                                   BookmarkAppInfo  *app_info)
+{
+  metadata->applications = g_list_remove (metadata->applications, app_info);
+  metadata->n_applications--;
+
+  if (metadata->apps_by_name)
+    g_hash_table_remove (metadata->apps_by_name, app_info->name);
+}
+
+static void
+bookmark_metadata_dump (BookmarkMetadata *metadata,
+                        GString          *retval)
 {
-  GString *retval;
-  gchar *buffer;
- 
   if (!metadata->applications)
-    return NULL;
-  
-  retval = g_string_sized_new (1024);
+    return;
   
   /* metadata container */
   g_string_append (retval,
@@ -384,12 +414,12 @@ bookmark_metadata_dump (BookmarkMetadata *metadata)
 
   /* mime type */
   if (metadata->mime_type) {
-    buffer = g_strconcat ("        "
-			  "<" MIME_NAMESPACE_NAME ":" MIME_TYPE_ELEMENT " "
-			  MIME_TYPE_ATTRIBUTE "=\"", metadata->mime_type, "\"/>\n",
-			  NULL);    
-    g_string_append (retval, buffer);
-    g_free (buffer);
+    g_string_append (retval,
+                     "        "
+                     "<" MIME_NAMESPACE_NAME ":" MIME_TYPE_ELEMENT " "
+                     MIME_TYPE_ATTRIBUTE "=\"");
+    g_string_append (retval, metadata->mime_type);
+    g_string_append (retval, "\"/>\n");
   }
 
   if (metadata->groups)
@@ -404,19 +434,14 @@ bookmark_metadata_dump (BookmarkMetadata *metadata)
       
       for (l = g_list_last (metadata->groups); l != NULL; l = l->prev)
         {
-          gchar *group_name;
-
-	  group_name = g_markup_escape_text ((gchar *) l->data, -1);
-	  buffer = g_strconcat ("          "
-				"<" BOOKMARK_NAMESPACE_NAME
-				":" BOOKMARK_GROUP_ELEMENT ">",
-				group_name,
-				"</" BOOKMARK_NAMESPACE_NAME
-				":"  BOOKMARK_GROUP_ELEMENT ">\n", NULL);
-	  g_string_append (retval, buffer);
-
-	  g_free (buffer);
-	  g_free (group_name);
+          g_string_append (retval,
+                           "          "
+                           "<" BOOKMARK_NAMESPACE_NAME
+                           ":" BOOKMARK_GROUP_ELEMENT ">");
+          append_escaped_text (retval, l->data);
+          g_string_append (retval,
+                           "</" BOOKMARK_NAMESPACE_NAME
+                           ":"  BOOKMARK_GROUP_ELEMENT ">\n");
         }
       
       /* close groups container */
@@ -439,18 +464,10 @@ bookmark_metadata_dump (BookmarkMetadata *metadata)
       for (l = g_list_last (metadata->applications); l != NULL; l = l->prev)
         {
           BookmarkAppInfo *app_info = (BookmarkAppInfo *) l->data;
-          gchar *app_data;
 
 	  g_warn_if_fail (app_info != NULL);
           
-          app_data = bookmark_app_info_dump (app_info);
-
-	  if (app_data)
-            {
-              retval = g_string_append (retval, app_data);
-
-	      g_free (app_data);
-	    }
+          bookmark_app_info_dump (app_info, retval);
         }
       
       /* close applications container */
@@ -466,14 +483,15 @@ bookmark_metadata_dump (BookmarkMetadata *metadata)
       if (!metadata->icon_mime)
         metadata->icon_mime = g_strdup ("application/octet-stream");
 
-      buffer = g_strconcat ("       "
-			    "<" BOOKMARK_NAMESPACE_NAME
-			    ":" BOOKMARK_ICON_ELEMENT
-			    " " BOOKMARK_HREF_ATTRIBUTE "=\"", metadata->icon_href,
-			    "\" " BOOKMARK_TYPE_ATTRIBUTE "=\"", metadata->icon_mime, "\"/>\n", NULL);
-      g_string_append (retval, buffer);
-
-      g_free (buffer);
+      g_string_append (retval,
+                       "       "
+                       "<" BOOKMARK_NAMESPACE_NAME
+                       ":" BOOKMARK_ICON_ELEMENT
+                       " " BOOKMARK_HREF_ATTRIBUTE "=\"");
+      g_string_append (retval, metadata->icon_href);
+      g_string_append (retval, "\" " BOOKMARK_TYPE_ATTRIBUTE "=\"");
+      g_string_append (retval, metadata->icon_mime);
+      g_string_append (retval, "\"/>\n");
     }
   
   /* private hint */
@@ -487,8 +505,6 @@ bookmark_metadata_dump (BookmarkMetadata *metadata)
   g_string_append (retval,
 		   "      "
 		   "</" XBEL_METADATA_ELEMENT ">\n");
-  			   
-  return g_string_free (retval, FALSE);
 }
 
 /******************************************************
@@ -534,115 +550,77 @@ bookmark_item_free (BookmarkItem *item)
   g_slice_free (BookmarkItem, item);
 }
 
-static gchar *
-bookmark_item_dump (BookmarkItem *item)
+static void
+bookmark_item_dump (BookmarkItem *item,
+                    GString      *retval)
 {
-  GString *retval;
-  gchar *added, *visited, *modified;
-  gchar *escaped_uri;
-  gchar *buffer;
- 
   /* at this point, we must have at least a registered application; if we don't
    * we don't screw up the bookmark file, and just skip this item
    */
   if (!item->metadata || !item->metadata->applications)
     {
       g_warning ("Item for URI '%s' has no registered applications: skipping.\n", item->uri);
-      return NULL;
+      return;
     }
   
-  retval = g_string_sized_new (4096);
-  
-  added = timestamp_to_iso8601 (item->added);
-  modified = timestamp_to_iso8601 (item->modified);
-  visited = timestamp_to_iso8601 (item->visited);
-
-  escaped_uri = g_markup_escape_text (item->uri, -1);
-
-  buffer = g_strconcat ("  <"
-                        XBEL_BOOKMARK_ELEMENT
-                        " "
-                        XBEL_HREF_ATTRIBUTE "=\"", escaped_uri, "\" "
-                        XBEL_ADDED_ATTRIBUTE "=\"", added, "\" "
-                        XBEL_MODIFIED_ATTRIBUTE "=\"", modified, "\" "
-                        XBEL_VISITED_ATTRIBUTE "=\"", visited, "\">\n",
-                        NULL);
-
-  g_string_append (retval, buffer);
-
-  g_free (escaped_uri);
-  g_free (visited);
-  g_free (modified);
-  g_free (added);
-  g_free (buffer);
+  g_string_append (retval,
+                   "  <"
+                   XBEL_BOOKMARK_ELEMENT
+                   " "
+                   XBEL_HREF_ATTRIBUTE "=\"");
+  append_escaped_text (retval, item->uri);
+  g_string_append (retval, "\" " XBEL_ADDED_ATTRIBUTE "=\"");
+  append_timestamp (retval, item->added);
+  g_string_append (retval, "\" " XBEL_MODIFIED_ATTRIBUTE "=\"");
+  append_timestamp (retval, item->modified);
+  g_string_append (retval, "\" " XBEL_VISITED_ATTRIBUTE "=\"");
+  append_timestamp (retval, item->visited);
+  g_string_append (retval, "\">\n");
   
   if (item->title)
     {
-      gchar *escaped_title;
-      
-      escaped_title = g_markup_escape_text (item->title, -1);
-      buffer = g_strconcat ("    "
-                            "<" XBEL_TITLE_ELEMENT ">",
-                            escaped_title,
-                            "</" XBEL_TITLE_ELEMENT ">\n",
-                            NULL);
-      g_string_append (retval, buffer);
-
-      g_free (escaped_title);
-      g_free (buffer);
+      g_string_append (retval, "    " "<" XBEL_TITLE_ELEMENT ">");
+      append_escaped_text (retval, item->title);
+      g_string_append (retval, "</" XBEL_TITLE_ELEMENT ">\n");
     }
   
   if (item->description)
     {
-      gchar *escaped_desc;
-      
-      escaped_desc = g_markup_escape_text (item->description, -1);
-      buffer = g_strconcat ("    "
-                            "<" XBEL_DESC_ELEMENT ">",
-                            escaped_desc,
-                            "</" XBEL_DESC_ELEMENT ">\n",
-                            NULL);
-      g_string_append (retval, buffer);
-
-      g_free (escaped_desc);
-      g_free (buffer);
+      g_string_append (retval, "    " "<" XBEL_DESC_ELEMENT ">");
+      append_escaped_text (retval, item->description);
+      g_string_append (retval, "</" XBEL_DESC_ELEMENT ">\n");
     }
   
-  if (item->metadata)
-    {
-      gchar *metadata;
-      
-      metadata = bookmark_metadata_dump (item->metadata);
-      if (metadata)
-        {
-          buffer = g_strconcat ("    "
-                                "<" XBEL_INFO_ELEMENT ">\n",
-                                metadata,
-                                "    "
-				"</" XBEL_INFO_ELEMENT ">\n",
-                                NULL);
-          retval = g_string_append (retval, buffer);
-
-          g_free (buffer);
-	  g_free (metadata);
-	}
-    }
+  g_string_append (retval, "    " "<" XBEL_INFO_ELEMENT ">\n");
+  bookmark_metadata_dump (item->metadata, retval);
+  g_string_append (retval, "    " "</" XBEL_INFO_ELEMENT ">\n");
 
   g_string_append (retval, "  </" XBEL_BOOKMARK_ELEMENT ">\n");
-  
-  return g_string_free (retval, FALSE);
 }
 
 static BookmarkAppInfo *
 bookmark_item_lookup_app_info (BookmarkItem *item,
 			       const gchar  *app_name)
 {
+  GList *l;
+
   g_warn_if_fail (item != NULL && app_name != NULL);
 
   if (!item->metadata)
     return NULL;
   
-  return g_hash_table_lookup (item->metadata->apps_by_name, app_name);
+  if (item->metadata->apps_by_name)
+    return g_hash_table_lookup (item->metadata->apps_by_name, app_name);
+
+  for (l = item->metadata->applications; l != NULL; l = l->next)
+    {
+      BookmarkAppInfo *ai = l->data;
+
+      if (strcmp (ai->name, app_name) == 0)
+        return ai;
+    }
+
+  return NULL;
 }
 
 /*************************
@@ -860,8 +838,7 @@ parse_application_element (GMarkupParseContext  *context,
       if (!item->metadata)
 	item->metadata = bookmark_metadata_new ();
       
-      item->metadata->applications = g_list_prepend (item->metadata->applications, ai);
-      g_hash_table_replace (item->metadata->apps_by_name, ai->name, ai);
+      bookmark_metadata_add_app_info (item->metadata, ai);
     }
       
   ai->exec = g_strdup (exec);
@@ -1444,10 +1421,10 @@ g_bookmark_file_dump (GBookmarkFile  *bookmark,
 		      GError        **error)
 {
   GString *retval;
-  gchar *buffer;
   GList *l;
   
-  retval = g_string_sized_new (4096);
+  /* a serialized item usually takes less than 1k */
+  retval = g_string_sized_new (4096 + 1024 * g_hash_table_size (bookmark->items_by_uri));
 
   g_string_append (retval,
 		   "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
@@ -1463,35 +1440,16 @@ g_bookmark_file_dump (GBookmarkFile  *bookmark,
   
   if (bookmark->title)
     {
-      gchar *escaped_title;
- 
-      escaped_title = g_markup_escape_text (bookmark->title, -1);
-
-      buffer = g_strconcat ("  "
-			    "<" XBEL_TITLE_ELEMENT ">",
-			    escaped_title,
-			    "</" XBEL_TITLE_ELEMENT ">\n", NULL);
-      
-      g_string_append (retval, buffer);
-
-      g_free (buffer);
-      g_free (escaped_title);
+      g_string_append (retval, "  " "<" XBEL_TITLE_ELEMENT ">");
+      append_escaped_text (retval, bookmark->title);
+      g_string_append (retval, "</" XBEL_TITLE_ELEMENT ">\n");
     }
   
   if (bookmark->description)
     {
-      gchar *escaped_desc;
- 
-      escaped_desc = g_markup_escape_text (bookmark->description, -1);
-
-      buffer = g_strconcat ("  "
-			    "<" XBEL_DESC_ELEMENT ">",
-			    escaped_desc,
-			    "</" XBEL_DESC_ELEMENT ">\n", NULL);
-      g_string_append (retval, buffer);
-
-      g_free (buffer);
-      g_free (escaped_desc);
+      g_string_append (retval, "  " "<" XBEL_DESC_ELEMENT ">");
+      append_escaped_text (retval, bookmark->description);
+      g_string_append (retval, "</" XBEL_DESC_ELEMENT ">\n");
     }
   
   if (!bookmark->items)
@@ -1503,18 +1461,7 @@ g_bookmark_file_dump (GBookmarkFile  *bookmark,
   for (l = g_list_last (bookmark->items);
        l != NULL;
        l = l->prev)
-    {
-      BookmarkItem *item = (BookmarkItem *) l->data;
-      gchar *item_dump;
-      
-      item_dump = bookmark_item_dump (item);
-      if (!item_dump)
-        continue;
-      
-      retval = g_string_append (retval, item_dump);
-      
-      g_free (item_dump);
-    }
+    bookmark_item_dump ((BookmarkItem *) l->data, retval);
 
 out:
   g_string_append (retval, "</" XBEL_ROOT_ELEMENT ">");
@@ -1559,6 +1506,45 @@ timestamp_from_iso8601 (const gchar *iso_date)
   return (time_t) stamp.tv_sec;
 }
 
+static void
+append_timestamp (GString *str,
+                  time_t   timestamp)
+{
+  gchar *iso8601;
+
+  iso8601 = timestamp_to_iso8601 (timestamp);
+  g_string_append (str, iso8601);
+  g_free (iso8601);
+}
+
+/* like appending the result of g_markup_escape_text(), but without
+ * the copy for the common case of text that needs no escaping
+ */
+static void
+append_escaped_text (GString     *str,
+                     const gchar *text)
+{
+  const guchar *p;
+  gchar *escaped;
+
+  for (p = (const guchar *) text; *p != '\0'; p++)
+    {
+      if (*p < 0x20 || *p > 0x7e ||
+          *p == '&' || *p == '<' || *p == '>' || *p == '\'' || *p == '"')
+        break;
+    }
+
+  if (*p == '\0')
+    {
+      g_string_append_len (str, text, (const gchar *) p - text);
+      return;
+    }
+
+  escaped = g_markup_escape_text (text, -1);
+  g_string_append (str, escaped);
+  g_free (escaped);
+}
+
 G_DEFINE_QUARK (g-bookmark-file-error-quark, g_bookmark_file_error)
 
 /********************
@@ -3203,15 +3189,13 @@ g_bookmark_file_set_app_info (GBookmarkFile  *bookmark,
         {
           ai = bookmark_app_info_new (name);
           
-          item->metadata->applications = g_list_prepend (item->metadata->applications, ai);
-          g_hash_table_replace (item->metadata->apps_by_name, ai->name, ai);
+          bookmark_metadata_add_app_info (item->metadata, ai);
         }
     }
 
   if (count == 0)
     {
-      item->metadata->applications = g_list_remove (item->metadata->applications, ai);
-      g_hash_table_remove (item->metadata->apps_by_name, ai->name);
+      bookmark_metadata_remove_app_info (item->metadata, ai);
       bookmark_app_info_free (ai);
 
       item->modified = time (NULL);
@@ -0,0 +1,434 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MT safe
+ */
+
+#include "config.h"
+
+#include "gboundedqueue.h"
+
+#include "gatomic.h"
+#include "gmem.h"
+#include "gmessages.h"
+#include "gthreadprivate.h"
+
+/**
+ * SECTION:bounded_queues
+ * @title: Bounded Queues
+ * @short_description: fixed-capacity lock-free queues between threads
+ * @see_also: #GAsyncQueue
+ *
+ * A #GBoundedQueue is a first-in, first-out queue of pointers with a
+ * fixed capacity, which any number of threads can push to and pop
+ * from concurrently.
+ *
+ * Unlike #GAsyncQueue, it does not use a lock: g_bounded_queue_try_push()
+ * and g_bounded_queue_try_pop() take a slot in a ring buffer with an
+ * atomic operation, and only fail if the queue is full or empty,
+ * respectively.  g_bounded_queue_push() and g_bounded_queue_pop() wait
+ * until there is room or an item, so a full queue slows producers down
+ * to the pace of consumers.  Waiting threads sleep in the kernel, and
+ * are only woken up when there is something for them to do.
+ *
+ * This makes #GBoundedQueue a good fit for handing large numbers of
+ * small items from one set of threads to another, where the cost of
+ * locking a #GAsyncQueue for every item dominates.  On the other hand,
+ * it cannot be locked, sorted or searched, and its items cannot be
+ * %NULL.
+ */
+
+/**
+ * GBoundedQueue:
+ *
+ * An opaque data structure which represents a bounded queue.
+ *
+ * It should only be accessed through the g_bounded_queue_*() functions.
+ *
+ * Since: 2.54
+ */
+
+typedef struct
+{
+  /* Equal to the position for a free slot, and to the position + 1
+   * once it has been filled in.  See Dmitry Vyukov's bounded MPMC queue.
+   */
+  volatile gint sequence;
+  gpointer data;
+} GBoundedQueueSlot;
+
+struct _GBoundedQueue
+{
+  GBoundedQueueSlot *slots;
+  guint mask;
+  GDestroyNotify item_free_func;
+  volatile gint ref_count;
+
+  volatile gint head;
+  volatile gint tail;
+
+  /* Sleeping poppers wait for @pushes to change, sleeping pushers for
+   * @pops; these are only bumped when somebody is waiting.
+   */
+  volatile gint pushes;
+  volatile gint pops;
+  volatile gint waiting_poppers;
+  volatile gint waiting_pushers;
+};
+
+/**
+ * g_bounded_queue_new:
+ * @capacity: the maximum number of items in the queue
+ *
+ * Creates a new bounded queue, with room for at least @capacity items.
+ * @capacity is rounded up to the next power of two.
+ *
+ * Returns: a new #GBoundedQueue. Free with g_bounded_queue_unref()
+ *
+ * Since: 2.54
+ */
+GBoundedQueue *
+g_bounded_queue_new (guint capacity)
+{
+  return g_bounded_queue_new_full (capacity, NULL);
+}
+
+/**
+ * g_bounded_queue_new_full:
+ * @capacity: the maximum number of items in the queue
+ * @item_free_func: (nullable): function to free queue elements
+ *
+ * Creates a new bounded queue, like g_bounded_queue_new(), with a
+ * destroy notify function that is used to free any remaining items
+ * when the queue is destroyed after the final unref.
+ *
+ * Returns: a new #GBoundedQueue. Free with g_bounded_queue_unref()
+ *
+ * Since: 2.54
+ */
+GBoundedQueue *
+g_bounded_queue_new_full (guint          capacity,
+                          GDestroyNotify item_free_func)
+{
+  GBoundedQueue *queue;
+  guint size, i;
+
+  g_return_val_if_fail (capacity > 0, NULL);
+  g_return_val_if_fail (capacity <= G_MAXINT / 2, NULL);
+
+  for (size = 1; size < capacity; size <<= 1)
+    ;
+
+  queue = g_new0 (GBoundedQueue, 1);
+  queue->slots = g_new (GBoundedQueueSlot, size);
+  queue->mask = size - 1;
+  queue->item_free_func = item_free_func;
+  queue->ref_count = 1;
+
+  for (i = 0; i < size; i++)
+    {
+      queue->slots[i].sequence = i;
+      queue->slots[i].data = NULL;
+    }
+
+  return queue;
+}
+
+/**
+ * g_bounded_queue_ref:
+ * @queue: a #GBoundedQueue
+ *
+ * Increases the reference count of @queue by 1.
+ *
+ * Returns: @queue
+ *
+ * Since: 2.54
+ */
+GBoundedQueue *
+g_bounded_queue_ref (GBoundedQueue *queue)
+{
+  g_return_val_if_fail (queue, NULL);
+
+  g_atomic_int_inc (&queue->ref_count);
+
+  return queue;
+}
+
+/**
+ * g_bounded_queue_unref:
+ * @queue: a #GBoundedQueue
+ *
+ * Decreases the reference count of @queue by 1.  If it drops to 0,
+ * the remaining items are freed with the @item_free_func given to
+ * g_bounded_queue_new_full(), if any, and @queue is freed.
+ *
+ * Since: 2.54
+ */
+void
+g_bounded_queue_unref (GBoundedQueue *queue)
+{
+  g_return_if_fail (queue);
+
+  if (g_atomic_int_dec_and_test (&queue->ref_count))
+    {
+      gpointer data;
+
+      g_return_if_fail (queue->waiting_poppers == 0 && queue->waiting_pushers == 0);
+
+      if (queue->item_free_func)
+        while ((data = g_bounded_queue_try_pop (queue)))
+          queue->item_free_func (data);
+
+      g_free (queue->slots);
+      g_free (queue);
+    }
+}
+
+/* Wakes up one thread waiting for @counter to change, if there is one */
+static inline void
+g_bounded_queue_signal (volatile gint *counter,
+                        volatile gint *waiting)
+{
+  if (G_UNLIKELY (g_atomic_int_get (waiting) > 0))
+    {
+      g_atomic_int_inc (counter);
+      g_futex_wake (counter);
+    }
+}
+
+/**
+ * g_bounded_queue_try_push:
+ * @queue: a #GBoundedQueue
+ * @data: @data to push into the @queue
+ *
+ * Pushes @data into @queue, if it is not full.  @data must not be %NULL.
+ *
+ * Returns: %TRUE if @data was pushed, %FALSE if @queue is full
+ *
+ * Since: 2.54
+ */
+gboolean
+g_bounded_queue_try_push (GBoundedQueue *queue,
+                          gpointer       data)
+{
+  GBoundedQueueSlot *slot;
+  guint pos;
+
+  g_return_val_if_fail (queue, FALSE);
+  g_return_val_if_fail (data, FALSE);
+
+  pos = g_atomic_int_get (&queue->tail);
+  for (;;)
+    {
+      gint diff;
+
+      slot = &queue->slots[pos & queue->mask];
+      diff = (gint) ((guint) g_atomic_int_get (&slot->sequence) - pos);
+
+      if (diff == 0)
+        {
+          if (g_atomic_int_compare_and_exchange (&queue->tail, pos, pos + 1))
+            break;
+          pos = g_atomic_int_get (&queue->tail);
+        }
+      else if (diff < 0)
+        return FALSE;
+      else
+        pos = g_atomic_int_get (&queue->tail);
+    }
+
+  slot->data = data;
+  g_atomic_int_set (&slot->sequence, pos + 1);
+
+  g_bounded_queue_signal (&queue->pushes, &queue->waiting_poppers);
+
+  return TRUE;
+}
+
+/**
+ * g_bounded_queue_try_pop:
+ * @queue: a #GBoundedQueue
+ *
+ * Pops the oldest item from @queue, if there is one.
+ *
+ * Returns: (nullable): the item, or %NULL if @queue is empty
+ *
+ * Since: 2.54
+ */
+gpointer
+g_bounded_queue_try_pop (GBoundedQueue *queue)
+{
+  GBoundedQueueSlot *slot;
+  gpointer data;
+  guint pos;
+
+  g_return_val_if_fail (queue, NULL);
+
+  pos = g_atomic_int_get (&queue->head);
+  for (;;)
+    {
+      gint diff;
+
+      slot = &queue->slots[pos & queue->mask];
+      diff = (gint) ((guint) g_atomic_int_get (&slot->sequence) - (pos + 1));
+
+      if (diff == 0)
+        {
+          if (g_atomic_int_compare_and_exchange (&queue->head, pos, pos + 1))
+            break;
+          pos = g_atomic_int_get (&queue->head);
+        }
+      else if (diff < 0)
+        return NULL;
+      else
+        pos = g_atomic_int_get (&queue->head);
+    }
+
+  data = slot->data;
+  g_atomic_int_set (&slot->sequence, pos + queue->mask + 1);
+
+  g_bounded_queue_signal (&queue->pops, &queue->waiting_pushers);
+
+  return data;
+}
+
+/**
+ * g_bounded_queue_push:
+ * @queue: a #GBoundedQueue
+ * @data: @data to push into the @queue
+ *
+ * Pushes @data into @queue, waiting for room if it is full.  @data
+ * must not be %NULL.
+ *
+ * Since: 2.54
+ */
+void
+g_bounded_queue_push (GBoundedQueue *queue,
+                      gpointer       data)
+{
+  g_return_if_fail (queue);
+  g_return_if_fail (data);
+
+  while (!g_bounded_queue_try_push (queue, data))
+    {
+      gint pops;
+
+      /* Announcing ourselves before checking again pairs with
+       * g_bounded_queue_signal() checking for waiters after popping:
+       * either we see the free slot, or the popper sees us and
+       * changes @pops so that we do not sleep.
+       */
+      pops = g_atomic_int_get (&queue->pops);
+      g_atomic_int_inc (&queue->waiting_pushers);
+
+      if (g_bounded_queue_try_push (queue, data))
+        {
+          g_atomic_int_add (&queue->waiting_pushers, -1);
+          return;
+        }
+
+      g_futex_wait (&queue->pops, pops);
+      g_atomic_int_add (&queue->waiting_pushers, -1);
+    }
+}
+
+/**
+ * g_bounded_queue_pop:
+ * @queue: a #GBoundedQueue
+ *
+ * Pops the oldest item from @queue, waiting for one if @queue is
+ * empty.
+ *
+ * Returns: the item
+ *
+ * Since: 2.54
+ */
+gpointer
+g_bounded_queue_pop (GBoundedQueue *queue)
+{
+  gpointer data;
+
+  g_return_val_if_fail (queue, NULL);
+
+  while (!(data = g_bounded_queue_try_pop (queue)))
+    {
+      gint pushes;
+
+      pushes = g_atomic_int_get (&queue->pushes);
+      g_atomic_int_inc (&queue->waiting_poppers);
+
+      data = g_bounded_queue_try_pop (queue);
+      if (data)
+        {
+          g_atomic_int_add (&queue->waiting_poppers, -1);
+          return data;
+        }
+
+      g_futex_wait (&queue->pushes, pushes);
+      g_atomic_int_add (&queue->waiting_poppers, -1);
+    }
+
+  return data;
+}
+
+/**
+ * g_bounded_queue_length:
+ * @queue: a #GBoundedQueue
+ *
+ * Returns the number of items in @queue.  Since other threads may be
+ * pushing and popping at the same time, this is only a snapshot.
+ *
+ * Returns: the number of items in @queue
+ *
+ * Since: 2.54
+ */
+guint
+g_bounded_queue_length (GBoundedQueue *queue)
+{
+  guint head, tail;
+
+  g_return_val_if_fail (queue, 0);
+
+  /* The tail never falls behind the head, so reading them in this
+   * order at worst counts items pushed in between
+   */
+  head = g_atomic_int_get (&queue->head);
+  tail = g_atomic_int_get (&queue->tail);
+
+  return MIN (tail - head, queue->mask + 1);
+}
+
+/**
+ * g_bounded_queue_get_capacity:
+ * @queue: a #GBoundedQueue
+ *
+ * Returns the maximum number of items @queue can hold, which is the
+ * capacity given to g_bounded_queue_new() rounded up to a power of two.
+ *
+ * Returns: the capacity of @queue
+ *
+ * Since: 2.54
+ */
+guint
+g_bounded_queue_get_capacity (GBoundedQueue *queue)
+{
+  g_return_val_if_fail (queue, 0);
+
+  return queue->mask + 1;
+}
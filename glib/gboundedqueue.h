@@ -0,0 +1,60 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_BOUNDED_QUEUE_H__
+#define __G_BOUNDED_QUEUE_H__
+
+#if !defined (__GLIB_H_INSIDE__) && !defined (GLIB_COMPILATION)
+#error "Only <glib.h> can be included directly."
+#endif
+
+#include <glib/gtypes.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GBoundedQueue GBoundedQueue;
+
+GLIB_AVAILABLE_IN_2_54
+GBoundedQueue *g_bounded_queue_new          (guint           capacity);
+GLIB_AVAILABLE_IN_2_54
+GBoundedQueue *g_bounded_queue_new_full     (guint           capacity,
+                                             GDestroyNotify  item_free_func);
+GLIB_AVAILABLE_IN_2_54
+GBoundedQueue *g_bounded_queue_ref          (GBoundedQueue  *queue);
+GLIB_AVAILABLE_IN_2_54
+void           g_bounded_queue_unref        (GBoundedQueue  *queue);
+
+GLIB_AVAILABLE_IN_2_54
+void           g_bounded_queue_push         (GBoundedQueue  *queue,
+                                             gpointer        data);
+GLIB_AVAILABLE_IN_2_54
+gboolean       g_bounded_queue_try_push     (GBoundedQueue  *queue,
+                                             gpointer        data);
+GLIB_AVAILABLE_IN_2_54
+gpointer       g_bounded_queue_pop          (GBoundedQueue  *queue);
+GLIB_AVAILABLE_IN_2_54
+gpointer       g_bounded_queue_try_pop      (GBoundedQueue  *queue);
+
+GLIB_AVAILABLE_IN_2_54
+guint          g_bounded_queue_length       (GBoundedQueue  *queue);
+GLIB_AVAILABLE_IN_2_54
+guint          g_bounded_queue_get_capacity (GBoundedQueue  *queue);
+
+G_END_DECLS
+
+#endif /* __G_BOUNDED_QUEUE_H__ */
@@ -0,0 +1,1277 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gbtree.h"
+
+#include "gatomic.h"
+#include "gmem.h"
+#include "gmessages.h"
+#include "gslice.h"
+#include "gtestutils.h"
+
+#include <string.h>
+
+/**
+ * SECTION:btrees
+ * @title: B-Trees
+ * @short_description: a sorted collection of key/value pairs laid out
+ *     for fast lookups in large collections
+ * @see_also: #GTree
+ *
+ * The #GBTree structure and its associated functions provide a sorted
+ * collection of key/value pairs, like #GTree does, but store them in a
+ * B+ tree rather than in a binary tree.
+ *
+ * Each node of a #GBTree holds up to fifteen keys, and only the bottom
+ * level of nodes, the leaves, hold values.  Compared to a #GTree, this
+ * needs one allocation for every few entries instead of one for each,
+ * and a lookup visits a node for every factor of around ten in the size
+ * of the tree instead of for every factor of two.  The keys of a node
+ * fill two cache lines, so that a lookup in a large tree causes far
+ * fewer cache misses.
+ *
+ * The leaves are linked together in order, so iterating over the tree,
+ * or over a range of it with g_btree_iter_init_at(), is a walk over
+ * consecutive memory.  A tree can be built from sorted input with
+ * g_btree_load_sorted(), which does not need to compare keys to place
+ * them and packs the leaves full.
+ *
+ * To create a new #GBTree use g_btree_new().  #GBTree uses the same
+ * comparison functions as #GTree.
+ */
+
+/**
+ * GBTree:
+ *
+ * The GBTree struct is an opaque data structure representing a B-tree.
+ * It should be accessed only by using the following functions.
+ *
+ * Since: 2.54
+ */
+
+/**
+ * GBTreeIter:
+ *
+ * A GBTreeIter structure represents an iterator that can be used to
+ * iterate over the entries of a #GBTree in order.  GBTreeIter
+ * structures are typically allocated on the stack and then initialized
+ * with g_btree_iter_init() or g_btree_iter_init_at().
+ *
+ * An iterator becomes invalid when the tree is changed.
+ *
+ * Since: 2.54
+ */
+
+/* 8 bytes of header and fifteen keys make two cache lines on 64-bit
+ * systems; leaves and inner nodes are four cache lines each.
+ */
+#define BTREE_MAX_KEYS 15
+#define BTREE_MIN_KEYS (BTREE_MAX_KEYS / 2)
+
+typedef struct _GBTreeNode  GBTreeNode;
+typedef struct _GBTreeLeaf  GBTreeLeaf;
+typedef struct _GBTreeInner GBTreeInner;
+
+struct _GBTreeNode
+{
+  guint16  n_keys;
+  guint16  is_leaf;
+  gpointer keys[BTREE_MAX_KEYS];
+};
+
+struct _GBTreeLeaf
+{
+  GBTreeNode  node;
+  gpointer    values[BTREE_MAX_KEYS];
+  GBTreeLeaf *next;
+};
+
+/* keys[i] is the smallest key below children[i + 1], and always the
+ * very same pointer as that entry in its leaf, so that it stays valid
+ * for as long as the entry is in the tree.
+ */
+struct _GBTreeInner
+{
+  GBTreeNode  node;
+  GBTreeNode *children[BTREE_MAX_KEYS + 1];
+};
+
+#define LEAF(n)  ((GBTreeLeaf *) (n))
+#define INNER(n) ((GBTreeInner *) (n))
+
+struct _GBTree
+{
+  GBTreeNode       *root;
+  GBTreeLeaf       *first;
+  gint              nnodes;
+  gint              height;
+
+  GCompareDataFunc  key_compare;
+  gpointer          key_compare_data;
+  GDestroyNotify    key_destroy_func;
+  GDestroyNotify    value_destroy_func;
+
+  gint              ref_count;
+};
+
+typedef struct
+{
+  GBTree    *tree;
+  GBTreeLeaf *leaf;
+  gint        index;
+} RealIter;
+
+G_STATIC_ASSERT (sizeof (GBTreeIter) >= sizeof (RealIter));
+
+static GBTreeLeaf *
+leaf_new (void)
+{
+  GBTreeLeaf *leaf = g_slice_new (GBTreeLeaf);
+
+  leaf->node.n_keys = 0;
+  leaf->node.is_leaf = TRUE;
+  leaf->next = NULL;
+
+  return leaf;
+}
+
+static GBTreeInner *
+inner_new (void)
+{
+  GBTreeInner *inner = g_slice_new (GBTreeInner);
+
+  inner->node.n_keys = 0;
+  inner->node.is_leaf = FALSE;
+
+  return inner;
+}
+
+static void
+node_free (GBTreeNode *node)
+{
+  if (node->is_leaf)
+    g_slice_free (GBTreeLeaf, LEAF (node));
+  else
+    g_slice_free (GBTreeInner, INNER (node));
+}
+
+static inline gint
+btree_compare (GBTree        *tree,
+               gconstpointer  a,
+               gconstpointer  b)
+{
+  return tree->key_compare (a, b, tree->key_compare_data);
+}
+
+/* Returns the index of the first key of @node that is not less than
+ * @key, and whether it is equal to @key.
+ */
+static guint
+node_lower_bound (GBTree        *tree,
+                  GBTreeNode    *node,
+                  gconstpointer  key,
+                  gboolean      *found)
+{
+  guint lo = 0, hi = node->n_keys;
+
+  while (lo < hi)
+    {
+      guint mid = (lo + hi) / 2;
+      gint cmp = btree_compare (tree, key, node->keys[mid]);
+
+      if (cmp > 0)
+        lo = mid + 1;
+      else if (cmp < 0)
+        hi = mid;
+      else
+        {
+          *found = TRUE;
+          return mid;
+        }
+    }
+
+  *found = FALSE;
+  return lo;
+}
+
+/* Returns the child of @node that @key belongs to */
+static inline guint
+inner_child_index (GBTree        *tree,
+                   GBTreeNode    *node,
+                   gconstpointer  key)
+{
+  gboolean found;
+  guint i;
+
+  i = node_lower_bound (tree, node, key, &found);
+
+  return found ? i + 1 : i;
+}
+
+static GBTreeLeaf *
+btree_find_leaf (GBTree        *tree,
+                 gconstpointer  key,
+                 guint         *index,
+                 gboolean      *found)
+{
+  GBTreeNode *node = tree->root;
+
+  if (node == NULL)
+    return NULL;
+
+  while (!node->is_leaf)
+    node = INNER (node)->children[inner_child_index (tree, node, key)];
+
+  *index = node_lower_bound (tree, node, key, found);
+
+  return LEAF (node);
+}
+
+static gpointer
+subtree_min (GBTreeNode *node)
+{
+  while (!node->is_leaf)
+    node = INNER (node)->children[0];
+
+  return node->keys[0];
+}
+
+/**
+ * g_btree_new:
+ * @key_compare_func: the function used to order the keys in the
+ *     #GBTree.  It should return values similar to the standard strcmp()
+ *     function - 0 if the two arguments are equal, a negative value if
+ *     the first argument comes before the second, or a positive value
+ *     if the first argument comes after the second.
+ *
+ * Creates a new #GBTree.
+ *
+ * Returns: a newly allocated #GBTree
+ *
+ * Since: 2.54
+ */
+GBTree *
+g_btree_new (GCompareFunc key_compare_func)
+{
+  g_return_val_if_fail (key_compare_func != NULL, NULL);
+
+  return g_btree_new_full ((GCompareDataFunc) key_compare_func, NULL, NULL, NULL);
+}
+
+/**
+ * g_btree_new_full:
+ * @key_compare_func: qsort()-style comparison function
+ * @key_compare_data: data to pass to comparison function
+ * @key_destroy_func: (nullable): a function to free the memory allocated
+ *     for the key used when removing the entry from the #GBTree or %NULL
+ *     if you don't want to supply such a function
+ * @value_destroy_func: (nullable): a function to free the memory
+ *     allocated for the value used when removing the entry from the
+ *     #GBTree or %NULL if you don't want to supply such a function
+ *
+ * Creates a new #GBTree like g_btree_new() and allows to specify
+ * functions to free the memory allocated for the key and value that
+ * get called when removing the entry from the #GBTree.
+ *
+ * Returns: a newly allocated #GBTree
+ *
+ * Since: 2.54
+ */
+GBTree *
+g_btree_new_full (GCompareDataFunc key_compare_func,
+                  gpointer         key_compare_data,
+                  GDestroyNotify   key_destroy_func,
+                  GDestroyNotify   value_destroy_func)
+{
+  GBTree *tree;
+
+  g_return_val_if_fail (key_compare_func != NULL, NULL);
+
+  tree = g_slice_new (GBTree);
+  tree->root               = NULL;
+  tree->first              = NULL;
+  tree->nnodes             = 0;
+  tree->height             = 0;
+  tree->key_compare        = key_compare_func;
+  tree->key_compare_data   = key_compare_data;
+  tree->key_destroy_func   = key_destroy_func;
+  tree->value_destroy_func = value_destroy_func;
+  tree->ref_count          = 1;
+
+  return tree;
+}
+
+/**
+ * g_btree_ref:
+ * @tree: a #GBTree
+ *
+ * Increments the reference count of @tree by one.
+ *
+ * It is safe to call this function from any thread.
+ *
+ * Returns: the passed in #GBTree
+ *
+ * Since: 2.54
+ */
+GBTree *
+g_btree_ref (GBTree *tree)
+{
+  g_return_val_if_fail (tree != NULL, NULL);
+
+  g_atomic_int_inc (&tree->ref_count);
+
+  return tree;
+}
+
+static void
+inner_free_recursive (GBTreeNode *node)
+{
+  guint i;
+
+  if (node->is_leaf)
+    return;
+
+  for (i = 0; i <= node->n_keys; i++)
+    inner_free_recursive (INNER (node)->children[i]);
+
+  node_free (node);
+}
+
+/**
+ * g_btree_remove_all:
+ * @tree: a #GBTree
+ *
+ * Removes all key/value pairs from @tree, freeing them with the destroy
+ * functions of @tree, if any.
+ *
+ * Since: 2.54
+ */
+void
+g_btree_remove_all (GBTree *tree)
+{
+  GBTreeLeaf *leaf, *next;
+
+  g_return_if_fail (tree != NULL);
+
+  if (tree->root == NULL)
+    return;
+
+  /* the leaves are reached through their links, the rest from the top */
+  inner_free_recursive (tree->root);
+
+  for (leaf = tree->first; leaf; leaf = next)
+    {
+      guint i;
+
+      next = leaf->next;
+
+      for (i = 0; i < leaf->node.n_keys; i++)
+        {
+          if (tree->key_destroy_func)
+            tree->key_destroy_func (leaf->node.keys[i]);
+          if (tree->value_destroy_func)
+            tree->value_destroy_func (leaf->values[i]);
+        }
+
+      g_slice_free (GBTreeLeaf, leaf);
+    }
+
+  tree->root = NULL;
+  tree->first = NULL;
+  tree->nnodes = 0;
+  tree->height = 0;
+}
+
+/**
+ * g_btree_unref:
+ * @tree: a #GBTree
+ *
+ * Decrements the reference count of @tree by one.  If the reference
+ * count drops to 0, all keys and values will be destroyed (if destroy
+ * functions were specified) and all memory allocated by @tree will be
+ * released.
+ *
+ * It is safe to call this function from any thread.
+ *
+ * Since: 2.54
+ */
+void
+g_btree_unref (GBTree *tree)
+{
+  g_return_if_fail (tree != NULL);
+
+  if (g_atomic_int_dec_and_test (&tree->ref_count))
+    {
+      g_btree_remove_all (tree);
+      g_slice_free (GBTree, tree);
+    }
+}
+
+typedef struct
+{
+  gpointer    key;
+  gpointer    value;
+  gboolean    replace;
+
+  gboolean    existed;
+  gpointer    old_key;          /* the key to free if it existed */
+  gpointer    old_value;
+
+  gpointer    split_key;
+  GBTreeNode *split_node;
+} InsertState;
+
+static void
+leaf_insert_at (GBTreeLeaf *leaf,
+                guint       i,
+                gpointer    key,
+                gpointer    value)
+{
+  guint n = leaf->node.n_keys;
+
+  memmove (&leaf->node.keys[i + 1], &leaf->node.keys[i], (n - i) * sizeof (gpointer));
+  memmove (&leaf->values[i + 1], &leaf->values[i], (n - i) * sizeof (gpointer));
+  leaf->node.keys[i] = key;
+  leaf->values[i] = value;
+  leaf->node.n_keys++;
+}
+
+static void
+leaf_insert (GBTree      *tree,
+             GBTreeLeaf  *leaf,
+             InsertState *state)
+{
+  gboolean found;
+  guint i;
+
+  i = node_lower_bound (tree, &leaf->node, state->key, &found);
+
+  if (found)
+    {
+      state->existed = TRUE;
+      state->old_value = leaf->values[i];
+      leaf->values[i] = state->value;
+
+      if (state->replace)
+        {
+          state->old_key = leaf->node.keys[i];
+          leaf->node.keys[i] = state->key;
+        }
+      else
+        state->old_key = state->key;
+
+      return;
+    }
+
+  if (leaf->node.n_keys == BTREE_MAX_KEYS)
+    {
+      /* split so that both halves end up with the same number of keys */
+      GBTreeLeaf *right = leaf_new ();
+      guint half = (BTREE_MAX_KEYS + 1) / 2;
+      guint from = i < half ? half - 1 : half;
+
+      right->node.n_keys = BTREE_MAX_KEYS - from;
+      memcpy (right->node.keys, &leaf->node.keys[from], right->node.n_keys * sizeof (gpointer));
+      memcpy (right->values, &leaf->values[from], right->node.n_keys * sizeof (gpointer));
+      leaf->node.n_keys = from;
+
+      right->next = leaf->next;
+      leaf->next = right;
+
+      if (i < half)
+        leaf_insert_at (leaf, i, state->key, state->value);
+      else
+        leaf_insert_at (right, i - from, state->key, state->value);
+
+      state->split_key = right->node.keys[0];
+      state->split_node = &right->node;
+    }
+  else
+    leaf_insert_at (leaf, i, state->key, state->value);
+}
+
+static void
+node_insert (GBTree      *tree,
+             GBTreeNode  *node,
+             InsertState *state)
+{
+  GBTreeInner *inner;
+  gpointer keys[BTREE_MAX_KEYS + 1];
+  GBTreeNode *children[BTREE_MAX_KEYS + 2];
+  GBTreeInner *right;
+  guint i, n, half;
+
+  if (node->is_leaf)
+    {
+      leaf_insert (tree, LEAF (node), state);
+      return;
+    }
+
+  inner = INNER (node);
+  i = inner_child_index (tree, node, state->key);
+
+  node_insert (tree, inner->children[i], state);
+
+  if (state->existed)
+    {
+      if (state->replace && i > 0 && node->keys[i - 1] == state->old_key)
+        node->keys[i - 1] = state->key;
+      return;
+    }
+
+  if (state->split_node == NULL)
+    return;
+
+  n = node->n_keys;
+
+  if (n < BTREE_MAX_KEYS)
+    {
+      memmove (&node->keys[i + 1], &node->keys[i], (n - i) * sizeof (gpointer));
+      memmove (&inner->children[i + 2], &inner->children[i + 1], (n - i) * sizeof (gpointer));
+      node->keys[i] = state->split_key;
+      inner->children[i + 1] = state->split_node;
+      node->n_keys++;
+
+      state->split_node = NULL;
+      return;
+    }
+
+  /* lay the keys and children out with the new ones in place, then
+   * hand the middle key up and the top half to a new node
+   */
+  memcpy (keys, node->keys, i * sizeof (gpointer));
+  keys[i] = state->split_key;
+  memcpy (&keys[i + 1], &node->keys[i], (n - i) * sizeof (gpointer));
+
+  memcpy (children, inner->children, (i + 1) * sizeof (gpointer));
+  children[i + 1] = state->split_node;
+  memcpy (&children[i + 2], &inner->children[i + 1], (n - i) * sizeof (gpointer));
+
+  half = (BTREE_MAX_KEYS + 1) / 2 - 1;
+  right = inner_new ();
+
+  node->n_keys = half;
+  memcpy (node->keys, keys, half * sizeof (gpointer));
+  memcpy (inner->children, children, (half + 1) * sizeof (gpointer));
+
+  right->node.n_keys = BTREE_MAX_KEYS - half;
+  memcpy (right->node.keys, &keys[half + 1], right->node.n_keys * sizeof (gpointer));
+  memcpy (right->children, &children[half + 1], (right->node.n_keys + 1) * sizeof (gpointer));
+
+  state->split_key = keys[half];
+  state->split_node = &right->node;
+}
+
+static void
+g_btree_insert_internal (GBTree   *tree,
+                         gpointer  key,
+                         gpointer  value,
+                         gboolean  replace)
+{
+  InsertState state = { key, value, replace, FALSE, NULL, NULL, NULL, NULL };
+
+  if (tree->root == NULL)
+    {
+      tree->first = leaf_new ();
+      tree->root = &tree->first->node;
+      tree->height = 1;
+    }
+
+  node_insert (tree, tree->root, &state);
+
+  if (state.split_node)
+    {
+      GBTreeInner *root = inner_new ();
+
+      root->node.n_keys = 1;
+      root->node.keys[0] = state.split_key;
+      root->children[0] = tree->root;
+      root->children[1] = state.split_node;
+
+      tree->root = &root->node;
+      tree->height++;
+    }
+
+  if (state.existed)
+    {
+      if (tree->key_destroy_func)
+        tree->key_destroy_func (state.old_key);
+      if (tree->value_destroy_func)
+        tree->value_destroy_func (state.old_value);
+    }
+  else
+    tree->nnodes++;
+}
+
+/**
+ * g_btree_insert:
+ * @tree: a #GBTree
+ * @key: the key to insert
+ * @value: the value corresponding to the key
+ *
+ * Inserts a key/value pair into a #GBTree, like g_tree_insert() does.
+ *
+ * If the given key already exists in the #GBTree its corresponding
+ * value is set to the new value.  If you supplied a @value_destroy_func
+ * when creating the #GBTree, the old value is freed using that
+ * function.  If you supplied a @key_destroy_func when creating the
+ * #GBTree, the passed key is freed using that function.
+ *
+ * Since: 2.54
+ */
+void
+g_btree_insert (GBTree   *tree,
+                gpointer  key,
+                gpointer  value)
+{
+  g_return_if_fail (tree != NULL);
+
+  g_btree_insert_internal (tree, key, value, FALSE);
+}
+
+/**
+ * g_btree_replace:
+ * @tree: a #GBTree
+ * @key: the key to insert
+ * @value: the value corresponding to the key
+ *
+ * Inserts a new key and value into a #GBTree similar to
+ * g_btree_insert().  The difference is that if the key already exists
+ * in the #GBTree, it gets replaced by the new key.  If you supplied a
+ * @value_destroy_func when creating the #GBTree, the old value is freed
+ * using that function.  If you supplied a @key_destroy_func when
+ * creating the #GBTree, the old key is freed using that function.
+ *
+ * Since: 2.54
+ */
+void
+g_btree_replace (GBTree   *tree,
+                 gpointer  key,
+                 gpointer  value)
+{
+  g_return_if_fail (tree != NULL);
+
+  g_btree_insert_internal (tree, key, value, TRUE);
+}
+
+typedef struct
+{
+  gconstpointer key;
+
+  gboolean      found;
+  gpointer      old_key;
+  gpointer      old_value;
+} RemoveState;
+
+/* @parent->children[i] has too few keys after a removal; borrow one
+ * from a sibling that can spare it, or merge with a sibling.
+ */
+static void
+inner_rebalance (GBTreeInner *parent,
+                 guint        i)
+{
+  GBTreeNode *child = parent->children[i];
+  GBTreeNode *left = i > 0 ? parent->children[i - 1] : NULL;
+  GBTreeNode *right = i < parent->node.n_keys ? parent->children[i + 1] : NULL;
+  guint n, k;
+
+  if (left && left->n_keys > BTREE_MIN_KEYS)
+    {
+      n = child->n_keys;
+      memmove (&child->keys[1], &child->keys[0], n * sizeof (gpointer));
+
+      if (child->is_leaf)
+        {
+          memmove (&LEAF (child)->values[1], &LEAF (child)->values[0], n * sizeof (gpointer));
+          child->keys[0] = left->keys[left->n_keys - 1];
+          LEAF (child)->values[0] = LEAF (left)->values[left->n_keys - 1];
+          parent->node.keys[i - 1] = child->keys[0];
+        }
+      else
+        {
+          memmove (&INNER (child)->children[1], &INNER (child)->children[0], (n + 1) * sizeof (gpointer));
+          child->keys[0] = parent->node.keys[i - 1];
+          INNER (child)->children[0] = INNER (left)->children[left->n_keys];
+          parent->node.keys[i - 1] = left->keys[left->n_keys - 1];
+        }
+
+      left->n_keys--;
+      child->n_keys++;
+      return;
+    }
+
+  if (right && right->n_keys > BTREE_MIN_KEYS)
+    {
+      n = right->n_keys;
+
+      if (child->is_leaf)
+        {
+          child->keys[child->n_keys] = right->keys[0];
+          LEAF (child)->values[child->n_keys] = LEAF (right)->values[0];
+          memmove (&LEAF (right)->values[0], &LEAF (right)->values[1], (n - 1) * sizeof (gpointer));
+          memmove (&right->keys[0], &right->keys[1], (n - 1) * sizeof (gpointer));
+          parent->node.keys[i] = right->keys[0];
+        }
+      else
+        {
+          child->keys[child->n_keys] = parent->node.keys[i];
+          INNER (child)->children[child->n_keys + 1] = INNER (right)->children[0];
+          parent->node.keys[i] = right->keys[0];
+          memmove (&right->keys[0], &right->keys[1], (n - 1) * sizeof (gpointer));
+          memmove (&INNER (right)->children[0], &INNER (right)->children[1], n * sizeof (gpointer));
+        }
+
+      right->n_keys--;
+      child->n_keys++;
+      return;
+    }
+
+  /* merge the right one of the pair into the left one */
+  if (left)
+    {
+      right = child;
+      k = i - 1;
+    }
+  else
+    {
+      left = child;
+      k = i;
+    }
+
+  n = left->n_keys;
+
+  if (left->is_leaf)
+    {
+      memcpy (&left->keys[n], right->keys, right->n_keys * sizeof (gpointer));
+      memcpy (&LEAF (left)->values[n], LEAF (right)->values, right->n_keys * sizeof (gpointer));
+      left->n_keys += right->n_keys;
+      LEAF (left)->next = LEAF (right)->next;
+    }
+  else
+    {
+      left->keys[n] = parent->node.keys[k];
+      memcpy (&left->keys[n + 1], right->keys, right->n_keys * sizeof (gpointer));
+      memcpy (&INNER (left)->children[n + 1], INNER (right)->children, (right->n_keys + 1) * sizeof (gpointer));
+      left->n_keys += 1 + right->n_keys;
+    }
+
+  node_free (right);
+
+  n = parent->node.n_keys;
+  memmove (&parent->node.keys[k], &parent->node.keys[k + 1], (n - k - 1) * sizeof (gpointer));
+  memmove (&parent->children[k + 1], &parent->children[k + 2], (n - k - 1) * sizeof (gpointer));
+  parent->node.n_keys--;
+}
+
+static void
+node_remove (GBTree      *tree,
+             GBTreeNode  *node,
+             RemoveState *state)
+{
+  GBTreeNode *child;
+  gboolean found;
+  guint i;
+
+  if (node->is_leaf)
+    {
+      GBTreeLeaf *leaf = LEAF (node);
+      guint n = node->n_keys;
+
+      i = node_lower_bound (tree, node, state->key, &found);
+      if (!found)
+        return;
+
+      state->found = TRUE;
+      state->old_key = node->keys[i];
+      state->old_value = leaf->values[i];
+
+      memmove (&node->keys[i], &node->keys[i + 1], (n - i - 1) * sizeof (gpointer));
+      memmove (&leaf->values[i], &leaf->values[i + 1], (n - i - 1) * sizeof (gpointer));
+      node->n_keys--;
+
+      return;
+    }
+
+  i = inner_child_index (tree, node, state->key);
+  child = INNER (node)->children[i];
+
+  node_remove (tree, child, state);
+
+  if (!state->found)
+    return;
+
+  /* the key is about to be freed, so it cannot stay a separator */
+  if (i > 0 && node->keys[i - 1] == state->old_key)
+    node->keys[i - 1] = subtree_min (child);
+
+  if (child->n_keys < BTREE_MIN_KEYS)
+    inner_rebalance (INNER (node), i);
+}
+
+static gboolean
+g_btree_remove_internal (GBTree        *tree,
+                         gconstpointer  key,
+                         gboolean       steal)
+{
+  RemoveState state = { key, FALSE, NULL, NULL };
+  GBTreeNode *root = tree->root;
+
+  if (root == NULL)
+    return FALSE;
+
+  node_remove (tree, root, &state);
+
+  if (!state.found)
+    return FALSE;
+
+  if (!root->is_leaf && root->n_keys == 0)
+    {
+      tree->root = INNER (root)->children[0];
+      tree->height--;
+      node_free (root);
+    }
+  else if (root->is_leaf && root->n_keys == 0)
+    {
+      tree->root = NULL;
+      tree->first = NULL;
+      tree->height = 0;
+      node_free (root);
+    }
+
+  tree->nnodes--;
+
+  if (!steal)
+    {
+      if (tree->key_destroy_func)
+        tree->key_destroy_func (state.old_key);
+      if (tree->value_destroy_func)
+        tree->value_destroy_func (state.old_value);
+    }
+
+  return TRUE;
+}
+
+/**
+ * g_btree_remove:
+ * @tree: a #GBTree
+ * @key: the key to remove
+ *
+ * Removes a key/value pair from a #GBTree.
+ *
+ * If the #GBTree was created using g_btree_new_full(), the key and
+ * value are freed using the supplied destroy functions, otherwise you
+ * have to make sure that any dynamically allocated values are freed
+ * yourself.  If the key does not exist in the #GBTree, the function
+ * does nothing.
+ *
+ * Returns: %TRUE if the key was found
+ *
+ * Since: 2.54
+ */
+gboolean
+g_btree_remove (GBTree        *tree,
+                gconstpointer  key)
+{
+  g_return_val_if_fail (tree != NULL, FALSE);
+
+  return g_btree_remove_internal (tree, key, FALSE);
+}
+
+/**
+ * g_btree_steal:
+ * @tree: a #GBTree
+ * @key: the key to remove
+ *
+ * Removes a key and its associated value from a #GBTree without
+ * calling the key and value destroy functions.
+ *
+ * Returns: %TRUE if the key was found
+ *
+ * Since: 2.54
+ */
+gboolean
+g_btree_steal (GBTree        *tree,
+               gconstpointer  key)
+{
+  g_return_val_if_fail (tree != NULL, FALSE);
+
+  return g_btree_remove_internal (tree, key, TRUE);
+}
+
+/**
+ * g_btree_load_sorted:
+ * @tree: an empty #GBTree
+ * @keys: (array length=n_entries): the keys, in strictly ascending order
+ * @values: (array length=n_entries) (nullable): the values for @keys,
+ *     or %NULL for all values to be %NULL
+ * @n_entries: the number of entries in @keys and @values
+ *
+ * Fills an empty #GBTree with entries that are already sorted.
+ *
+ * This is much faster than inserting the entries one by one: each key
+ * is only compared to the one before it, to check the order, and the
+ * tree is built from the bottom up.  The leaves are packed full, so
+ * that the tree takes as little memory as possible; inserting into it
+ * afterwards splits them again.
+ *
+ * If the keys are not in strictly ascending order according to the
+ * comparison function of @tree, a critical warning is emitted and the
+ * tree is left empty.
+ *
+ * Since: 2.54
+ */
+void
+g_btree_load_sorted (GBTree    *tree,
+                     gpointer  *keys,
+                     gpointer  *values,
+                     gsize      n_entries)
+{
+  GBTreeNode **level;
+  gpointer *mins;
+  GBTreeLeaf *prev = NULL;
+  gsize n_level, pos, i, j;
+
+  g_return_if_fail (tree != NULL);
+  g_return_if_fail (tree->root == NULL);
+  g_return_if_fail (keys != NULL || n_entries == 0);
+  g_return_if_fail (n_entries <= G_MAXINT);
+
+  if (n_entries == 0)
+    return;
+
+  for (i = 1; i < n_entries; i++)
+    if (btree_compare (tree, keys[i - 1], keys[i]) >= 0)
+      {
+        g_critical ("%s: keys are not in strictly ascending order", G_STRFUNC);
+        return;
+      }
+
+  n_level = (n_entries + BTREE_MAX_KEYS - 1) / BTREE_MAX_KEYS;
+  level = g_new (GBTreeNode *, n_level);
+  mins = g_new (gpointer, n_level);
+
+  /* spread the entries evenly, which leaves each leaf at least half full */
+  for (j = 0, pos = 0; j < n_level; j++)
+    {
+      GBTreeLeaf *leaf = leaf_new ();
+      gsize count = n_entries / n_level + (j < n_entries % n_level);
+
+      memcpy (leaf->node.keys, &keys[pos], count * sizeof (gpointer));
+      if (values)
+        memcpy (leaf->values, &values[pos], count * sizeof (gpointer));
+      else
+        memset (leaf->values, 0, count * sizeof (gpointer));
+      leaf->node.n_keys = count;
+
+      if (prev)
+        prev->next = leaf;
+      else
+        tree->first = leaf;
+      prev = leaf;
+
+      level[j] = &leaf->node;
+      mins[j] = keys[pos];
+      pos += count;
+    }
+
+  tree->height = 1;
+
+  while (n_level > 1)
+    {
+      gsize n_inner = (n_level + BTREE_MAX_KEYS) / (BTREE_MAX_KEYS + 1);
+
+      for (j = 0, pos = 0; j < n_inner; j++)
+        {
+          GBTreeInner *inner = inner_new ();
+          gsize count = n_level / n_inner + (j < n_level % n_inner);
+
+          for (i = 0; i < count; i++)
+            {
+              inner->children[i] = level[pos + i];
+              if (i > 0)
+                inner->node.keys[i - 1] = mins[pos + i];
+            }
+          inner->node.n_keys = count - 1;
+
+          level[j] = &inner->node;
+          mins[j] = mins[pos];
+          pos += count;
+        }
+
+      n_level = n_inner;
+      tree->height++;
+    }
+
+  tree->root = level[0];
+  tree->nnodes = n_entries;
+
+  g_free (level);
+  g_free (mins);
+}
+
+/**
+ * g_btree_lookup:
+ * @tree: a #GBTree
+ * @key: the key to look up
+ *
+ * Gets the value corresponding to the given key.
+ *
+ * Returns: (nullable): the value corresponding to the key, or %NULL
+ *     if the key was not found
+ *
+ * Since: 2.54
+ */
+gpointer
+g_btree_lookup (GBTree        *tree,
+                gconstpointer  key)
+{
+  gpointer value = NULL;
+
+  g_btree_lookup_extended (tree, key, NULL, &value);
+
+  return value;
+}
+
+/**
+ * g_btree_lookup_extended:
+ * @tree: a #GBTree
+ * @lookup_key: the key to look up
+ * @orig_key: (out) (optional) (nullable): returns the original key
+ * @value: (out) (optional) (nullable): returns the value associated
+ *     with the key
+ *
+ * Looks up a key in the #GBTree, returning the original key and the
+ * associated value.  This is useful if you need to free the memory
+ * allocated for the original key, for example before calling
+ * g_btree_remove().
+ *
+ * Returns: %TRUE if the key was found in the #GBTree
+ *
+ * Since: 2.54
+ */
+gboolean
+g_btree_lookup_extended (GBTree        *tree,
+                         gconstpointer  lookup_key,
+                         gpointer      *orig_key,
+                         gpointer      *value)
+{
+  GBTreeLeaf *leaf;
+  gboolean found;
+  guint i;
+
+  g_return_val_if_fail (tree != NULL, FALSE);
+
+  leaf = btree_find_leaf (tree, lookup_key, &i, &found);
+  if (leaf == NULL || !found)
+    return FALSE;
+
+  if (orig_key)
+    *orig_key = leaf->node.keys[i];
+  if (value)
+    *value = leaf->values[i];
+
+  return TRUE;
+}
+
+/**
+ * g_btree_foreach:
+ * @tree: a #GBTree
+ * @func: the function to call for each node visited.  If this function
+ *     returns %TRUE, the traversal is stopped.
+ * @user_data: user data to pass to the function
+ *
+ * Calls the given function for each of the key/value pairs in the
+ * #GBTree, in sorted order of the keys.  The tree may not be modified
+ * while iterating over it.
+ *
+ * Since: 2.54
+ */
+void
+g_btree_foreach (GBTree        *tree,
+                 GTraverseFunc  func,
+                 gpointer       user_data)
+{
+  GBTreeLeaf *leaf;
+  guint i;
+
+  g_return_if_fail (tree != NULL);
+
+  for (leaf = tree->first; leaf; leaf = leaf->next)
+    for (i = 0; i < leaf->node.n_keys; i++)
+      if (func (leaf->node.keys[i], leaf->values[i], user_data))
+        return;
+}
+
+/**
+ * g_btree_nnodes:
+ * @tree: a #GBTree
+ *
+ * Gets the number of key/value pairs in a #GBTree.
+ *
+ * Returns: the number of key/value pairs in the #GBTree
+ *
+ * Since: 2.54
+ */
+gint
+g_btree_nnodes (GBTree *tree)
+{
+  g_return_val_if_fail (tree != NULL, 0);
+
+  return tree->nnodes;
+}
+
+/**
+ * g_btree_height:
+ * @tree: a #GBTree
+ *
+ * Gets the height of a #GBTree: the number of levels of nodes that a
+ * lookup goes through.
+ *
+ * If the #GBTree contains no nodes, the height is 0.  As long as all
+ * entries fit into a single leaf, the height is 1.
+ *
+ * Returns: the height of @tree
+ *
+ * Since: 2.54
+ */
+gint
+g_btree_height (GBTree *tree)
+{
+  g_return_val_if_fail (tree != NULL, 0);
+
+  return tree->height;
+}
+
+/**
+ * g_btree_iter_init:
+ * @iter: an uninitialized #GBTreeIter
+ * @tree: a #GBTree
+ *
+ * Initializes a key/value pair iterator so that g_btree_iter_next()
+ * starts at the smallest key of @tree.
+ *
+ * |[<!-- language="C" -->
+ * GBTreeIter iter;
+ * gpointer key, value;
+ *
+ * g_btree_iter_init (&iter, tree);
+ * while (g_btree_iter_next (&iter, &key, &value))
+ *   {
+ *     // do something with key and value
+ *   }
+ * ]|
+ *
+ * Since: 2.54
+ */
+void
+g_btree_iter_init (GBTreeIter *iter,
+                   GBTree     *tree)
+{
+  RealIter *ri = (RealIter *) iter;
+
+  g_return_if_fail (iter != NULL);
+  g_return_if_fail (tree != NULL);
+
+  ri->tree = tree;
+  ri->leaf = tree->first;
+  ri->index = 0;
+}
+
+/**
+ * g_btree_iter_init_at:
+ * @iter: an uninitialized #GBTreeIter
+ * @tree: a #GBTree
+ * @key: the key to start at
+ *
+ * Initializes a key/value pair iterator so that g_btree_iter_next()
+ * starts at @key, or at the smallest key after it if @key is not in
+ * @tree.
+ *
+ * To visit a range of keys, stop calling g_btree_iter_next() once it
+ * returns a key past the end of the range:
+ *
+ * |[<!-- language="C" -->
+ * g_btree_iter_init_at (&iter, tree, first);
+ * while (g_btree_iter_next (&iter, &key, &value) &&
+ *        compare (key, last) <= 0)
+ *   {
+ *     // do something with key and value
+ *   }
+ * ]|
+ *
+ * Since: 2.54
+ */
+void
+g_btree_iter_init_at (GBTreeIter    *iter,
+                      GBTree        *tree,
+                      gconstpointer  key)
+{
+  RealIter *ri = (RealIter *) iter;
+  gboolean found;
+  guint i = 0;
+
+  g_return_if_fail (iter != NULL);
+  g_return_if_fail (tree != NULL);
+
+  ri->tree = tree;
+  ri->leaf = btree_find_leaf (tree, key, &i, &found);
+  ri->index = i;
+}
+
+/**
+ * g_btree_iter_next:
+ * @iter: an initialized #GBTreeIter
+ * @key: (out) (optional): a location to store the key
+ * @value: (out) (optional) (nullable): a location to store the value
+ *
+ * Advances @iter and retrieves the key and/or value that are now
+ * pointed to as a result of this advancement.  If %FALSE is returned,
+ * @key and @value are not set, and the iterator becomes invalid.
+ *
+ * Returns: %FALSE if the end of the #GBTree has been reached
+ *
+ * Since: 2.54
+ */
+gboolean
+g_btree_iter_next (GBTreeIter *iter,
+                   gpointer   *key,
+                   gpointer   *value)
+{
+  RealIter *ri = (RealIter *) iter;
+
+  g_return_val_if_fail (iter != NULL, FALSE);
+
+  while (ri->leaf && ri->index >= ri->leaf->node.n_keys)
+    {
+      ri->leaf = ri->leaf->next;
+      ri->index = 0;
+    }
+
+  if (ri->leaf == NULL)
+    return FALSE;
+
+  if (key)
+    *key = ri->leaf->node.keys[ri->index];
+  if (value)
+    *value = ri->leaf->values[ri->index];
+  ri->index++;
+
+  return TRUE;
+}
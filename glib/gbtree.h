@@ -0,0 +1,106 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_BTREE_H__
+#define __G_BTREE_H__
+
+#if !defined (__GLIB_H_INSIDE__) && !defined (GLIB_COMPILATION)
+#error "Only <glib.h> can be included directly."
+#endif
+
+#include <glib/gtree.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GBTree     GBTree;
+typedef struct _GBTreeIter GBTreeIter;
+
+struct _GBTreeIter
+{
+  /*< private >*/
+  gpointer dummy1;
+  gpointer dummy2;
+  gint     dummy3;
+};
+
+GLIB_AVAILABLE_IN_2_54
+GBTree * g_btree_new             (GCompareFunc      key_compare_func);
+GLIB_AVAILABLE_IN_2_54
+GBTree * g_btree_new_full        (GCompareDataFunc  key_compare_func,
+                                  gpointer          key_compare_data,
+                                  GDestroyNotify    key_destroy_func,
+                                  GDestroyNotify    value_destroy_func);
+GLIB_AVAILABLE_IN_2_54
+GBTree * g_btree_ref             (GBTree           *tree);
+GLIB_AVAILABLE_IN_2_54
+void     g_btree_unref           (GBTree           *tree);
+
+GLIB_AVAILABLE_IN_2_54
+void     g_btree_insert          (GBTree           *tree,
+                                  gpointer          key,
+                                  gpointer          value);
+GLIB_AVAILABLE_IN_2_54
+void     g_btree_replace         (GBTree           *tree,
+                                  gpointer          key,
+                                  gpointer          value);
+GLIB_AVAILABLE_IN_2_54
+gboolean g_btree_remove          (GBTree           *tree,
+                                  gconstpointer     key);
+GLIB_AVAILABLE_IN_2_54
+gboolean g_btree_steal           (GBTree           *tree,
+                                  gconstpointer     key);
+GLIB_AVAILABLE_IN_2_54
+void     g_btree_remove_all      (GBTree           *tree);
+GLIB_AVAILABLE_IN_2_54
+void     g_btree_load_sorted     (GBTree           *tree,
+                                  gpointer         *keys,
+                                  gpointer         *values,
+                                  gsize             n_entries);
+
+GLIB_AVAILABLE_IN_2_54
+gpointer g_btree_lookup          (GBTree           *tree,
+                                  gconstpointer     key);
+GLIB_AVAILABLE_IN_2_54
+gboolean g_btree_lookup_extended (GBTree           *tree,
+                                  gconstpointer     lookup_key,
+                                  gpointer         *orig_key,
+                                  gpointer         *value);
+GLIB_AVAILABLE_IN_2_54
+void     g_btree_foreach         (GBTree           *tree,
+                                  GTraverseFunc     func,
+                                  gpointer          user_data);
+GLIB_AVAILABLE_IN_2_54
+gint     g_btree_nnodes          (GBTree           *tree);
+GLIB_AVAILABLE_IN_2_54
+gint     g_btree_height          (GBTree           *tree);
+
+GLIB_AVAILABLE_IN_2_54
+void     g_btree_iter_init       (GBTreeIter       *iter,
+                                  GBTree           *tree);
+GLIB_AVAILABLE_IN_2_54
+void     g_btree_iter_init_at    (GBTreeIter       *iter,
+                                  GBTree           *tree,
+                                  gconstpointer     key);
+GLIB_AVAILABLE_IN_2_54
+gboolean g_btree_iter_next       (GBTreeIter       *iter,
+                                  gpointer         *key,
+                                  gpointer         *value);
+
+G_END_DECLS
+
+#endif /* __G_BTREE_H__ */
@@ -126,6 +126,33 @@ g_bytes_new_take (gpointer data,
   return g_bytes_new_with_free_func (data, size, g_free, data);
 }
 
+/**
+ * g_bytes_new_take_aligned:
+ * @data: (transfer full) (array length=size) (element-type guint8) (nullable):
+ *     the data to be used for the bytes
+ * @size: the size of @data
+ *
+ * Creates a new #GBytes from @data, like g_bytes_new_take(), for data
+ * that was allocated with g_aligned_alloc() or g_aligned_alloc0().
+ * g_aligned_free() will be called on @data when the bytes is no longer
+ * in use.
+ *
+ * g_bytes_unref_to_data() and g_bytes_unref_to_array() copy such data
+ * instead of handing it over, since it cannot be freed with g_free().
+ *
+ * @data may be %NULL if @size is 0.
+ *
+ * Returns: (transfer full): a new #GBytes
+ *
+ * Since: 2.54
+ */
+GBytes *
+g_bytes_new_take_aligned (gpointer data,
+                          gsize    size)
+{
+  return g_bytes_new_with_free_func (data, size, g_aligned_free, data);
+}
+
 
 /**
  * g_bytes_new_static: (skip)
@@ -201,7 +228,10 @@ g_bytes_new_with_free_func (gconstpointer  data,
  * @length may not be longer than the size of @bytes.
  *
  * A reference to @bytes will be held by the newly created #GBytes until
- * the byte data is no longer needed.
+ * the byte data is no longer needed.  If @bytes is itself a subsection
+ * of another #GBytes, that one is referenced instead (since 2.54), so
+ * the data can be sliced any number of times without making any of the
+ * intermediate slices outlive their last user.
  *
  * Returns: (transfer full): a new #GBytes
  *
@@ -217,6 +247,22 @@ g_bytes_new_from_bytes (GBytes  *bytes,
   g_return_val_if_fail (offset <= bytes->size, NULL);
   g_return_val_if_fail (offset + length <= bytes->size, NULL);
 
+  /* Slices of slices refer to the original bytes, so that slicing
+   * over and over does not keep every step alive.
+   */
+  while (bytes->data != NULL && bytes->free_func == (GDestroyNotify) g_bytes_unref)
+    {
+      GBytes *parent = bytes->user_data;
+      const gchar *start = parent->data;
+
+      if ((const gchar *) bytes->data < start ||
+          (const gchar *) bytes->data + bytes->size > start + parent->size)
+        break;
+
+      offset += (const gchar *) bytes->data - start;
+      bytes = parent;
+    }
+
   return g_bytes_new_with_free_func ((gchar *)bytes->data + offset, length,
                                      (GDestroyNotify)g_bytes_unref, g_bytes_ref (bytes));
 }
@@ -39,6 +39,10 @@ GLIB_AVAILABLE_IN_ALL
 GBytes *        g_bytes_new_take                (gpointer        data,
                                                  gsize           size);
 
+GLIB_AVAILABLE_IN_2_54
+GBytes *        g_bytes_new_take_aligned        (gpointer        data,
+                                                 gsize           size);
+
 GLIB_AVAILABLE_IN_ALL
 GBytes *        g_bytes_new_static              (gconstpointer   data,
                                                  gsize           size);
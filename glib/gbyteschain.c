@@ -0,0 +1,589 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gbyteschain.h"
+
+#include "garray.h"
+#include "gatomic.h"
+#include "gmem.h"
+#include "gmessages.h"
+#include "gslice.h"
+#include "gtestutils.h"
+
+#include <string.h>
+
+/**
+ * SECTION:byte_chains
+ * @title: Byte Chains
+ * @short_description: a sequence of bytes made of several #GBytes,
+ *     to be consumed without copying
+ * @see_also: #GBytes
+ *
+ * A #GBytesChain is a sequence of bytes held in a list of #GBytes
+ * segments.  Bytes are added at the end by appending #GBytes, and
+ * taken from the front with g_bytes_chain_skip(), g_bytes_chain_pop()
+ * or g_bytes_chain_split().  None of these copy any data, except
+ * g_bytes_chain_pop() when the requested bytes span several segments.
+ * Taking only part of a segment keeps a cursor into it, or slices it
+ * with g_bytes_new_from_bytes().
+ *
+ * The segments can be handed to scatter/gather I/O functions like
+ * g_socket_send_message() directly:
+ *
+ * |[<!-- language="C" -->
+ * GOutputVector vectors[16];
+ * guint i, n_vectors;
+ * gssize sent;
+ *
+ * n_vectors = MIN (g_bytes_chain_get_n_segments (chain), G_N_ELEMENTS (vectors));
+ * for (i = 0; i < n_vectors; i++)
+ *   vectors[i].buffer = g_bytes_chain_get_segment (chain, i, &vectors[i].size);
+ *
+ * sent = g_socket_send_message (socket, NULL, vectors, n_vectors,
+ *                               NULL, 0, 0, NULL, &error);
+ * if (sent > 0)
+ *   g_bytes_chain_skip (chain, sent);
+ * ]|
+ *
+ * A #GBytesChain is not thread-safe.  The #GBytes in it are immutable
+ * and can be shared with other threads and chains.
+ *
+ * Since: 2.54
+ */
+
+/**
+ * GBytesChain:
+ *
+ * An opaque structure representing a list of #GBytes that is consumed
+ * from the front.
+ *
+ * Since: 2.54
+ */
+
+struct _GBytesChain
+{
+  /* the segments from index @first on are in the chain, and the first
+   * @first_offset bytes of the first one were already taken
+   */
+  GPtrArray *segments;
+  guint      first;
+  gsize      first_offset;
+
+  gsize      size;
+  gint       ref_count;
+};
+
+#define SEGMENT(chain, i) ((GBytes *) g_ptr_array_index ((chain)->segments, (chain)->first + (i)))
+
+/**
+ * g_bytes_chain_new:
+ *
+ * Creates a new, empty #GBytesChain.
+ *
+ * Returns: (transfer full): a new #GBytesChain
+ *
+ * Since: 2.54
+ */
+GBytesChain *
+g_bytes_chain_new (void)
+{
+  GBytesChain *chain;
+
+  chain = g_slice_new (GBytesChain);
+  chain->segments = g_ptr_array_new ();
+  chain->first = 0;
+  chain->first_offset = 0;
+  chain->size = 0;
+  chain->ref_count = 1;
+
+  return chain;
+}
+
+/**
+ * g_bytes_chain_ref:
+ * @chain: a #GBytesChain
+ *
+ * Increases the reference count of @chain.
+ *
+ * Returns: the @chain
+ *
+ * Since: 2.54
+ */
+GBytesChain *
+g_bytes_chain_ref (GBytesChain *chain)
+{
+  g_return_val_if_fail (chain != NULL, NULL);
+
+  g_atomic_int_inc (&chain->ref_count);
+
+  return chain;
+}
+
+/**
+ * g_bytes_chain_unref:
+ * @chain: a #GBytesChain
+ *
+ * Decreases the reference count of @chain.  When it drops to 0, the
+ * references to the #GBytes in @chain are released, and @chain is
+ * freed.
+ *
+ * Since: 2.54
+ */
+void
+g_bytes_chain_unref (GBytesChain *chain)
+{
+  guint i;
+
+  g_return_if_fail (chain != NULL);
+
+  if (!g_atomic_int_dec_and_test (&chain->ref_count))
+    return;
+
+  for (i = chain->first; i < chain->segments->len; i++)
+    g_bytes_unref (g_ptr_array_index (chain->segments, i));
+
+  g_ptr_array_unref (chain->segments);
+  g_slice_free (GBytesChain, chain);
+}
+
+/* Drops the first segment from the chain, returning its reference */
+static GBytes *
+chain_take_first (GBytesChain *chain)
+{
+  GBytes *bytes = SEGMENT (chain, 0);
+
+  chain->first++;
+  chain->first_offset = 0;
+
+  /* the taken slots are reused once they are half the array */
+  if (chain->first == chain->segments->len)
+    {
+      g_ptr_array_set_size (chain->segments, 0);
+      chain->first = 0;
+    }
+  else if (chain->first >= 16 && chain->first * 2 >= chain->segments->len)
+    {
+      g_ptr_array_remove_range (chain->segments, 0, chain->first);
+      chain->first = 0;
+    }
+
+  return bytes;
+}
+
+static void
+chain_push (GBytesChain *chain,
+            GBytes      *bytes)
+{
+  g_ptr_array_add (chain->segments, bytes);
+  chain->size += g_bytes_get_size (bytes);
+}
+
+/**
+ * g_bytes_chain_append:
+ * @chain: a #GBytesChain
+ * @bytes: the #GBytes to add
+ *
+ * Adds the data in @bytes to the end of @chain, taking a reference to
+ * @bytes.  Empty #GBytes are ignored.
+ *
+ * Since: 2.54
+ */
+void
+g_bytes_chain_append (GBytesChain *chain,
+                      GBytes      *bytes)
+{
+  g_return_if_fail (chain != NULL);
+  g_return_if_fail (bytes != NULL);
+
+  if (g_bytes_get_size (bytes) > 0)
+    chain_push (chain, g_bytes_ref (bytes));
+}
+
+/**
+ * g_bytes_chain_prepend:
+ * @chain: a #GBytesChain
+ * @bytes: the #GBytes to add
+ *
+ * Adds the data in @bytes to the front of @chain, taking a reference
+ * to @bytes.  Empty #GBytes are ignored.
+ *
+ * This can be used to put back data that was taken from @chain with
+ * g_bytes_chain_pop() but not used.
+ *
+ * Since: 2.54
+ */
+void
+g_bytes_chain_prepend (GBytesChain *chain,
+                       GBytes      *bytes)
+{
+  g_return_if_fail (chain != NULL);
+  g_return_if_fail (bytes != NULL);
+
+  if (g_bytes_get_size (bytes) == 0)
+    return;
+
+  /* the cursor only applies to the first segment */
+  if (chain->first_offset > 0)
+    {
+      GBytes *head = SEGMENT (chain, 0);
+
+      chain->segments->pdata[chain->first] =
+        g_bytes_new_from_bytes (head, chain->first_offset,
+                                g_bytes_get_size (head) - chain->first_offset);
+      chain->first_offset = 0;
+      g_bytes_unref (head);
+    }
+
+  if (chain->first > 0)
+    chain->segments->pdata[--chain->first] = g_bytes_ref (bytes);
+  else
+    g_ptr_array_insert (chain->segments, 0, g_bytes_ref (bytes));
+
+  chain->size += g_bytes_get_size (bytes);
+}
+
+/**
+ * g_bytes_chain_append_chain:
+ * @chain: a #GBytesChain
+ * @other: another #GBytesChain
+ *
+ * Adds the data in @other to the end of @chain without copying it:
+ * @chain takes references to the #GBytes in @other.  @other is not
+ * changed.
+ *
+ * Since: 2.54
+ */
+void
+g_bytes_chain_append_chain (GBytesChain *chain,
+                            GBytesChain *other)
+{
+  guint i, n;
+
+  g_return_if_fail (chain != NULL);
+  g_return_if_fail (other != NULL);
+  g_return_if_fail (chain != other);
+
+  n = g_bytes_chain_get_n_segments (other);
+
+  for (i = 0; i < n; i++)
+    {
+      GBytes *bytes = SEGMENT (other, i);
+
+      if (i == 0 && other->first_offset > 0)
+        chain_push (chain, g_bytes_new_from_bytes (bytes, other->first_offset,
+                                                   g_bytes_get_size (bytes) - other->first_offset));
+      else
+        chain_push (chain, g_bytes_ref (bytes));
+    }
+}
+
+/**
+ * g_bytes_chain_get_size:
+ * @chain: a #GBytesChain
+ *
+ * Gets the number of bytes in @chain.
+ *
+ * Returns: the size of @chain
+ *
+ * Since: 2.54
+ */
+gsize
+g_bytes_chain_get_size (GBytesChain *chain)
+{
+  g_return_val_if_fail (chain != NULL, 0);
+
+  return chain->size;
+}
+
+/**
+ * g_bytes_chain_get_n_segments:
+ * @chain: a #GBytesChain
+ *
+ * Gets the number of separate memory regions that make up @chain,
+ * to be retrieved with g_bytes_chain_get_segment().
+ *
+ * Returns: the number of segments in @chain
+ *
+ * Since: 2.54
+ */
+guint
+g_bytes_chain_get_n_segments (GBytesChain *chain)
+{
+  g_return_val_if_fail (chain != NULL, 0);
+
+  return chain->segments->len - chain->first;
+}
+
+/**
+ * g_bytes_chain_get_segment:
+ * @chain: a #GBytesChain
+ * @index_: the index of the segment, less than
+ *     g_bytes_chain_get_n_segments()
+ * @size: (out): return location for the size of the segment
+ *
+ * Gets the location and size of one of the memory regions that make
+ * up @chain, in order.  Segments are never empty.
+ *
+ * The data stays valid until it is removed from @chain.
+ *
+ * Returns: (transfer none) (array length=size) (element-type guint8):
+ *     the data of the segment
+ *
+ * Since: 2.54
+ */
+gconstpointer
+g_bytes_chain_get_segment (GBytesChain *chain,
+                           guint        index_,
+                           gsize       *size)
+{
+  const guint8 *data;
+  gsize segment_size;
+
+  g_return_val_if_fail (chain != NULL, NULL);
+  g_return_val_if_fail (index_ < g_bytes_chain_get_n_segments (chain), NULL);
+  g_return_val_if_fail (size != NULL, NULL);
+
+  data = g_bytes_get_data (SEGMENT (chain, index_), &segment_size);
+
+  if (index_ == 0)
+    {
+      data += chain->first_offset;
+      segment_size -= chain->first_offset;
+    }
+
+  *size = segment_size;
+
+  return data;
+}
+
+/**
+ * g_bytes_chain_peek:
+ * @chain: a #GBytesChain
+ * @buffer: (out caller-allocates) (array length=length) (element-type guint8):
+ *     a buffer of at least @length bytes
+ * @length: the number of bytes to copy
+ *
+ * Copies up to @length bytes from the front of @chain into @buffer,
+ * without removing them.  This is meant for looking at headers; the
+ * data itself is best taken with g_bytes_chain_pop() or
+ * g_bytes_chain_split(), which do not copy it.
+ *
+ * Returns: the number of bytes copied, which is less than @length only
+ *     if @chain holds fewer bytes
+ *
+ * Since: 2.54
+ */
+gsize
+g_bytes_chain_peek (GBytesChain *chain,
+                    gpointer     buffer,
+                    gsize        length)
+{
+  guint8 *dest = buffer;
+  guint i, n;
+
+  g_return_val_if_fail (chain != NULL, 0);
+  g_return_val_if_fail (buffer != NULL || length == 0, 0);
+
+  length = MIN (length, chain->size);
+  n = g_bytes_chain_get_n_segments (chain);
+
+  for (i = 0; i < n && dest < (guint8 *) buffer + length; i++)
+    {
+      gsize size;
+      gconstpointer data = g_bytes_chain_get_segment (chain, i, &size);
+
+      size = MIN (size, (gsize) ((guint8 *) buffer + length - dest));
+      memcpy (dest, data, size);
+      dest += size;
+    }
+
+  return length;
+}
+
+/**
+ * g_bytes_chain_skip:
+ * @chain: a #GBytesChain
+ * @length: the number of bytes to remove, at most the size of @chain
+ *
+ * Removes @length bytes from the front of @chain, for example after
+ * they have been written out.
+ *
+ * Since: 2.54
+ */
+void
+g_bytes_chain_skip (GBytesChain *chain,
+                    gsize        length)
+{
+  g_return_if_fail (chain != NULL);
+  g_return_if_fail (length <= chain->size);
+
+  chain->size -= length;
+
+  while (length > 0)
+    {
+      gsize available = g_bytes_get_size (SEGMENT (chain, 0)) - chain->first_offset;
+
+      if (length < available)
+        {
+          chain->first_offset += length;
+          break;
+        }
+
+      g_bytes_unref (chain_take_first (chain));
+      length -= available;
+    }
+}
+
+/* Removes at most @length bytes, all from the first segment */
+static GBytes *
+chain_pop_first (GBytesChain *chain,
+                 gsize        length)
+{
+  GBytes *head = SEGMENT (chain, 0);
+  gsize offset = chain->first_offset;
+  gsize available = g_bytes_get_size (head) - offset;
+  GBytes *res;
+
+  if (length < available)
+    {
+      chain->first_offset += length;
+      res = g_bytes_new_from_bytes (head, offset, length);
+    }
+  else
+    {
+      head = chain_take_first (chain);
+      length = available;
+
+      if (offset == 0)
+        res = head;
+      else
+        {
+          res = g_bytes_new_from_bytes (head, offset, length);
+          g_bytes_unref (head);
+        }
+    }
+
+  chain->size -= length;
+
+  return res;
+}
+
+/**
+ * g_bytes_chain_pop:
+ * @chain: a #GBytesChain
+ * @length: the number of bytes to remove, at most the size of @chain
+ *
+ * Removes @length bytes from the front of @chain and returns them as
+ * a single #GBytes.
+ *
+ * If the bytes are all in the first segment, the returned #GBytes is
+ * that segment or a slice of it, and no data is copied.  Otherwise
+ * the bytes are copied into a new #GBytes.
+ *
+ * Returns: (transfer full): a #GBytes with the removed bytes
+ *
+ * Since: 2.54
+ */
+GBytes *
+g_bytes_chain_pop (GBytesChain *chain,
+                   gsize        length)
+{
+  gpointer data;
+
+  g_return_val_if_fail (chain != NULL, NULL);
+  g_return_val_if_fail (length <= chain->size, NULL);
+
+  if (length == 0)
+    return g_bytes_new (NULL, 0);
+
+  if (length <= g_bytes_get_size (SEGMENT (chain, 0)) - chain->first_offset)
+    return chain_pop_first (chain, length);
+
+  data = g_malloc (length);
+  g_bytes_chain_peek (chain, data, length);
+  g_bytes_chain_skip (chain, length);
+
+  return g_bytes_new_take (data, length);
+}
+
+/**
+ * g_bytes_chain_split:
+ * @chain: a #GBytesChain
+ * @length: the number of bytes to remove, at most the size of @chain
+ *
+ * Removes @length bytes from the front of @chain and returns them in
+ * a new #GBytesChain, without copying any data.  A segment that is
+ * split in two is shared by both chains.
+ *
+ * Returns: (transfer full): a new #GBytesChain with the removed bytes
+ *
+ * Since: 2.54
+ */
+GBytesChain *
+g_bytes_chain_split (GBytesChain *chain,
+                     gsize        length)
+{
+  GBytesChain *res;
+
+  g_return_val_if_fail (chain != NULL, NULL);
+  g_return_val_if_fail (length <= chain->size, NULL);
+
+  res = g_bytes_chain_new ();
+
+  while (res->size < length)
+    chain_push (res, chain_pop_first (chain, length - res->size));
+
+  return res;
+}
+
+/**
+ * g_bytes_chain_flatten:
+ * @chain: a #GBytesChain
+ *
+ * Returns the contents of @chain as a single #GBytes, without
+ * removing them.  If @chain has a single segment, no data is copied.
+ *
+ * Returns: (transfer full): a #GBytes with the contents of @chain
+ *
+ * Since: 2.54
+ */
+GBytes *
+g_bytes_chain_flatten (GBytesChain *chain)
+{
+  gpointer data;
+
+  g_return_val_if_fail (chain != NULL, NULL);
+
+  switch (g_bytes_chain_get_n_segments (chain))
+    {
+    case 0:
+      return g_bytes_new (NULL, 0);
+
+    case 1:
+      if (chain->first_offset == 0)
+        return g_bytes_ref (SEGMENT (chain, 0));
+      return g_bytes_new_from_bytes (SEGMENT (chain, 0), chain->first_offset, chain->size);
+
+    default:
+      data = g_malloc (chain->size);
+      g_bytes_chain_peek (chain, data, chain->size);
+      return g_bytes_new_take (data, chain->size);
+    }
+}
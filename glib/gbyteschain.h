@@ -0,0 +1,76 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_BYTES_CHAIN_H__
+#define __G_BYTES_CHAIN_H__
+
+#if !defined (__GLIB_H_INSIDE__) && !defined (GLIB_COMPILATION)
+#error "Only <glib.h> can be included directly."
+#endif
+
+#include <glib/gbytes.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GBytesChain GBytesChain;
+
+GLIB_AVAILABLE_IN_2_54
+GBytesChain *   g_bytes_chain_new               (void);
+GLIB_AVAILABLE_IN_2_54
+GBytesChain *   g_bytes_chain_ref               (GBytesChain    *chain);
+GLIB_AVAILABLE_IN_2_54
+void            g_bytes_chain_unref             (GBytesChain    *chain);
+
+GLIB_AVAILABLE_IN_2_54
+void            g_bytes_chain_append            (GBytesChain    *chain,
+                                                 GBytes         *bytes);
+GLIB_AVAILABLE_IN_2_54
+void            g_bytes_chain_prepend           (GBytesChain    *chain,
+                                                 GBytes         *bytes);
+GLIB_AVAILABLE_IN_2_54
+void            g_bytes_chain_append_chain      (GBytesChain    *chain,
+                                                 GBytesChain    *other);
+
+GLIB_AVAILABLE_IN_2_54
+gsize           g_bytes_chain_get_size          (GBytesChain    *chain);
+GLIB_AVAILABLE_IN_2_54
+guint           g_bytes_chain_get_n_segments    (GBytesChain    *chain);
+GLIB_AVAILABLE_IN_2_54
+gconstpointer   g_bytes_chain_get_segment       (GBytesChain    *chain,
+                                                 guint           index_,
+                                                 gsize          *size);
+
+GLIB_AVAILABLE_IN_2_54
+gsize           g_bytes_chain_peek              (GBytesChain    *chain,
+                                                 gpointer        buffer,
+                                                 gsize           length);
+GLIB_AVAILABLE_IN_2_54
+void            g_bytes_chain_skip              (GBytesChain    *chain,
+                                                 gsize           length);
+GLIB_AVAILABLE_IN_2_54
+GBytes *        g_bytes_chain_pop               (GBytesChain    *chain,
+                                                 gsize           length);
+GLIB_AVAILABLE_IN_2_54
+GBytesChain *   g_bytes_chain_split             (GBytesChain    *chain,
+                                                 gsize           length);
+GLIB_AVAILABLE_IN_2_54
+GBytes *        g_bytes_chain_flatten           (GBytesChain    *chain);
+
+G_END_DECLS
+
+#endif /* __G_BYTES_CHAIN_H__ */
@@ -23,12 +23,21 @@
 #include "gchecksum.h"
 
 #include "gslice.h"
+#include "gthread.h"
 #include "gmem.h"
 #include "gstrfuncs.h"
 #include "gtestutils.h"
 #include "gtypes.h"
 #include "glibintl.h"
 
+/* SHA-256 with the x86 SHA extensions, picked at runtime */
+#if (defined (__x86_64__) || defined (__i386__)) && \
+    ((defined (__GNUC__) && __GNUC__ >= 5) || defined (__clang__))
+#include <cpuid.h>
+#include <immintrin.h>
+#define SHA256_USE_SHA_NI 1
+#endif
+
 
 /**
  * SECTION:checksum
@@ -985,6 +994,143 @@ sha256_transform (guint32      buf[8],
   buf[7] += H;
 }
 
+#ifdef SHA256_USE_SHA_NI
+static const guint32 sha256_k[64] =
+{
+  0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+  0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+  0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+  0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+  0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+  0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+  0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+  0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+  0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+  0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+  0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+  0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+  0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+  0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+  0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+  0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+static gboolean
+sha256_have_sha_ni (void)
+{
+  static gsize have_sha_ni = 0;
+
+  if (g_once_init_enter (&have_sha_ni))
+    {
+      guint eax, ebx, ecx, edx;
+      gboolean found = FALSE;
+
+      /* SSSE3 and SSE4.1 for the shuffles, then SHA itself */
+      if (__get_cpuid (1, &eax, &ebx, &ecx, &edx) &&
+          (ecx & (1 << 9)) && (ecx & (1 << 19)) &&
+          __get_cpuid_max (0, NULL) >= 7)
+        {
+          __cpuid_count (7, 0, eax, ebx, ecx, edx);
+          found = (ebx & (1 << 29)) != 0;
+        }
+
+      g_once_init_leave (&have_sha_ni, found ? 2 : 1);
+    }
+
+  return have_sha_ni == 2;
+}
+
+/* Four rounds, also extending the message schedule where it is still
+ * needed.  The state is kept as ABEF and CDGH, as the instructions
+ * expect.
+ */
+#define SHA_NI_ROUNDS(msg, prev, next, k)                                    \
+  G_STMT_START {                                                             \
+    t = _mm_add_epi32 (msg, _mm_loadu_si128 ((const __m128i *) &sha256_k[k])); \
+    state1 = _mm_sha256rnds2_epu32 (state1, state0, t);                      \
+    if ((k) >= 12 && (k) < 60)                                               \
+      {                                                                      \
+        next = _mm_add_epi32 (next, _mm_alignr_epi8 (msg, prev, 4));         \
+        next = _mm_sha256msg2_epu32 (next, msg);                             \
+      }                                                                      \
+    state0 = _mm_sha256rnds2_epu32 (state0, state1, _mm_shuffle_epi32 (t, 0x0E)); \
+    if ((k) >= 4 && (k) < 52)                                                \
+      prev = _mm_sha256msg1_epu32 (prev, msg);                               \
+  } G_STMT_END
+
+__attribute__ ((target ("sha,sse4.1")))
+static void
+sha256_transform_sha_ni (guint32       buf[8],
+                         const guint8 *data,
+                         gsize         n_blocks)
+{
+  const __m128i byte_swap = _mm_set_epi64x (G_GINT64_CONSTANT (0x0c0d0e0f08090a0b),
+                                            G_GINT64_CONSTANT (0x0405060700010203));
+  __m128i state0, state1, abef, cdgh, t;
+  __m128i m0, m1, m2, m3;
+
+  t = _mm_shuffle_epi32 (_mm_loadu_si128 ((const __m128i *) &buf[0]), 0xB1);  /* CDAB */
+  state1 = _mm_shuffle_epi32 (_mm_loadu_si128 ((const __m128i *) &buf[4]), 0x1B);  /* EFGH */
+  state0 = _mm_alignr_epi8 (t, state1, 8);  /* ABEF */
+  state1 = _mm_blend_epi16 (state1, t, 0xF0);  /* CDGH */
+
+  for (; n_blocks > 0; n_blocks--, data += SHA256_DATASIZE)
+    {
+      abef = state0;
+      cdgh = state1;
+
+      m0 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data +  0)), byte_swap);
+      m1 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data + 16)), byte_swap);
+      m2 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data + 32)), byte_swap);
+      m3 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data + 48)), byte_swap);
+
+      SHA_NI_ROUNDS (m0, m3, m1,  0);
+      SHA_NI_ROUNDS (m1, m0, m2,  4);
+      SHA_NI_ROUNDS (m2, m1, m3,  8);
+      SHA_NI_ROUNDS (m3, m2, m0, 12);
+      SHA_NI_ROUNDS (m0, m3, m1, 16);
+      SHA_NI_ROUNDS (m1, m0, m2, 20);
+      SHA_NI_ROUNDS (m2, m1, m3, 24);
+      SHA_NI_ROUNDS (m3, m2, m0, 28);
+      SHA_NI_ROUNDS (m0, m3, m1, 32);
+      SHA_NI_ROUNDS (m1, m0, m2, 36);
+      SHA_NI_ROUNDS (m2, m1, m3, 40);
+      SHA_NI_ROUNDS (m3, m2, m0, 44);
+      SHA_NI_ROUNDS (m0, m3, m1, 48);
+      SHA_NI_ROUNDS (m1, m0, m2, 52);
+      SHA_NI_ROUNDS (m2, m1, m3, 56);
+      SHA_NI_ROUNDS (m3, m2, m0, 60);
+
+      state0 = _mm_add_epi32 (state0, abef);
+      state1 = _mm_add_epi32 (state1, cdgh);
+    }
+
+  t = _mm_shuffle_epi32 (state0, 0x1B);  /* FEBA */
+  state1 = _mm_shuffle_epi32 (state1, 0xB1);  /* DCHG */
+  _mm_storeu_si128 ((__m128i *) &buf[0], _mm_blend_epi16 (t, state1, 0xF0));  /* DCBA */
+  _mm_storeu_si128 ((__m128i *) &buf[4], _mm_alignr_epi8 (state1, t, 8));  /* HGFE */
+}
+
+#undef SHA_NI_ROUNDS
+#endif /* SHA256_USE_SHA_NI */
+
+static void
+sha256_transform_blocks (guint32       buf[8],
+                         const guint8 *data,
+                         gsize         n_blocks)
+{
+#ifdef SHA256_USE_SHA_NI
+  if (sha256_have_sha_ni ())
+    {
+      sha256_transform_sha_ni (buf, data, n_blocks);
+      return;
+    }
+#endif
+
+  for (; n_blocks > 0; n_blocks--, data += SHA256_DATASIZE)
+    sha256_transform (buf, data);
+}
+
 static void
 sha256_sum_update (Sha256sum    *sha256,
                    const guchar *buffer,
@@ -1009,19 +1155,21 @@ sha256_sum_update (Sha256sum    *sha256,
     {
       memcpy ((sha256->data + left), input, fill);
 
-      sha256_transform (sha256->buf, sha256->data);
+      sha256_transform_blocks (sha256->buf, sha256->data, 1);
       length -= fill;
       input += fill;
 
       left = 0;
     }
 
-  while (length >= SHA256_DATASIZE)
+  if (length >= SHA256_DATASIZE)
     {
-      sha256_transform (sha256->buf, input);
+      gsize n_blocks = length / SHA256_DATASIZE;
+
+      sha256_transform_blocks (sha256->buf, input, n_blocks);
 
-      length -= 64;
-      input += 64;
+      length -= n_blocks * SHA256_DATASIZE;
+      input += n_blocks * SHA256_DATASIZE;
     }
 
   if (length)
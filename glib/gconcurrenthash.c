@@ -0,0 +1,672 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gconcurrenthash.h"
+
+#include "gatomic.h"
+#include "ghashprivate.h"
+#include "gmem.h"
+#include "gmessages.h"
+#include "gslice.h"
+#include "gtestutils.h"
+#include "gthread.h"
+
+/**
+ * SECTION:concurrent_hash_tables
+ * @title: Concurrent Hash Tables
+ * @short_description: associations between keys and values that can
+ *     be shared between threads
+ * @see_also: #GHashTable
+ *
+ * A #GConcurrentHashTable maps keys to values like a #GHashTable, but
+ * can be used from several threads at the same time without any
+ * locking on the caller's side.
+ *
+ * The table is split into a number of shards, each a #GHashTable with
+ * a lock of its own, and a key always goes to the same shard.  Threads
+ * working on keys in different shards never wait for each other, and
+ * any number of threads can look up keys in the same shard at once;
+ * only changes to a shard are exclusive.  The number of shards grows
+ * with the number of processors, so contention stays low even when
+ * all of them use the table.
+ *
+ * The same hash and equality functions as for #GHashTable can be used,
+ * like g_str_hash() and g_str_equal() or g_direct_hash() and
+ * g_direct_equal().  The hash function is only called once per
+ * operation; its result both picks the shard and is used inside it.
+ *
+ * Destroy notifiers are called after the lock of the shard has been
+ * released, so they may use the table themselves.
+ *
+ * Since values can be replaced or removed by another thread at any
+ * moment, a value returned by g_concurrent_hash_table_lookup() is only
+ * safe to use if no other thread will remove it, or if the table does
+ * not own its values.  To get a reference to a value that may go away
+ * concurrently, use g_concurrent_hash_table_lookup_copy(), which calls
+ * a copy (or ref) function while the shard is still locked.  Iterating
+ * over the table works the same way: g_concurrent_hash_table_snapshot()
+ * gives a #GHashTable with copies of all entries, which the caller can
+ * then iterate without any locking.
+ */
+
+/**
+ * GConcurrentHashTable:
+ *
+ * An opaque structure representing a hash table that can be shared
+ * between threads.
+ *
+ * Since: 2.54
+ */
+
+#define SHARD_ALIGNMENT 64      /* keep shards on cache lines of their own */
+#define MIN_SHARD_SHIFT 3
+#define MAX_SHARD_SHIFT 8
+
+typedef union
+{
+  struct
+  {
+    GRWLock     lock;
+    GHashTable *table;
+  } s;
+  guint8 padding[SHARD_ALIGNMENT];
+} GConcurrentShard;
+
+G_STATIC_ASSERT (sizeof (GConcurrentShard) == SHARD_ALIGNMENT);
+
+struct _GConcurrentHashTable
+{
+  GConcurrentShard *shards;
+  guint             n_shards;
+  guint             shard_shift;
+
+  GHashFunc         hash_func;
+  GEqualFunc        key_equal_func;
+  GDestroyNotify    key_destroy_func;
+  GDestroyNotify    value_destroy_func;
+
+  gint              ref_count;
+};
+
+/* The inner tables take the low bits of the scrambled hash value, so
+ * pick the shard from the high bits of a different product.
+ */
+static inline GConcurrentShard *
+get_shard (GConcurrentHashTable *hash_table,
+           guint                 hash_value)
+{
+  return &hash_table->shards[(hash_value * 0x9e3779b1u) >> hash_table->shard_shift];
+}
+
+/**
+ * g_concurrent_hash_table_new:
+ * @hash_func: a function to create a hash value from a key
+ * @key_equal_func: a function to check two keys for equality
+ *
+ * Creates a new #GConcurrentHashTable with a reference count of 1.
+ *
+ * @hash_func and @key_equal_func are the same as for g_hash_table_new(),
+ * except that both must be safe to call from several threads at once.
+ *
+ * Returns: a new #GConcurrentHashTable
+ *
+ * Since: 2.54
+ */
+GConcurrentHashTable *
+g_concurrent_hash_table_new (GHashFunc  hash_func,
+                             GEqualFunc key_equal_func)
+{
+  return g_concurrent_hash_table_new_full (hash_func, key_equal_func, NULL, NULL);
+}
+
+/**
+ * g_concurrent_hash_table_new_full:
+ * @hash_func: a function to create a hash value from a key
+ * @key_equal_func: a function to check two keys for equality
+ * @key_destroy_func: (nullable): a function to free the memory allocated
+ *     for the key used when removing the entry from the table, or %NULL
+ *     if you don't want to supply such a function
+ * @value_destroy_func: (nullable): a function to free the memory allocated
+ *     for the value used when removing the entry from the table, or %NULL
+ *     if you don't want to supply such a function
+ *
+ * Creates a new #GConcurrentHashTable like g_concurrent_hash_table_new()
+ * with a reference count of 1, and allows to specify functions to free
+ * the memory allocated for the key and value that get called when
+ * removing the entry from the table.
+ *
+ * Returns: a new #GConcurrentHashTable
+ *
+ * Since: 2.54
+ */
+GConcurrentHashTable *
+g_concurrent_hash_table_new_full (GHashFunc      hash_func,
+                                  GEqualFunc     key_equal_func,
+                                  GDestroyNotify key_destroy_func,
+                                  GDestroyNotify value_destroy_func)
+{
+  GConcurrentHashTable *hash_table;
+  guint shift;
+  guint i;
+
+  shift = MIN_SHARD_SHIFT;
+  while (shift < MAX_SHARD_SHIFT && (1u << shift) < 4 * g_get_num_processors ())
+    shift++;
+
+  hash_table = g_slice_new (GConcurrentHashTable);
+  hash_table->n_shards           = 1u << shift;
+  hash_table->shard_shift        = 32 - shift;
+  hash_table->hash_func          = hash_func ? hash_func : g_direct_hash;
+  hash_table->key_equal_func     = key_equal_func;
+  hash_table->key_destroy_func   = key_destroy_func;
+  hash_table->value_destroy_func = value_destroy_func;
+  hash_table->ref_count          = 1;
+
+  hash_table->shards = g_aligned_alloc0 (hash_table->n_shards, sizeof (GConcurrentShard),
+                                         SHARD_ALIGNMENT);
+  for (i = 0; i < hash_table->n_shards; i++)
+    {
+      g_rw_lock_init (&hash_table->shards[i].s.lock);
+      hash_table->shards[i].s.table = g_hash_table_new (hash_table->hash_func, key_equal_func);
+    }
+
+  return hash_table;
+}
+
+/**
+ * g_concurrent_hash_table_ref:
+ * @hash_table: a valid #GConcurrentHashTable
+ *
+ * Atomically increments the reference count of @hash_table by one.
+ * This function is MT-safe and may be called from any thread.
+ *
+ * Returns: the passed in #GConcurrentHashTable
+ *
+ * Since: 2.54
+ */
+GConcurrentHashTable *
+g_concurrent_hash_table_ref (GConcurrentHashTable *hash_table)
+{
+  g_return_val_if_fail (hash_table != NULL, NULL);
+
+  g_atomic_int_inc (&hash_table->ref_count);
+
+  return hash_table;
+}
+
+/* Frees what the table owns in @table, which is no longer reachable
+ * from any shard.
+ */
+static void
+free_entries (GConcurrentHashTable *hash_table,
+              GHashTable           *table)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+
+  if (hash_table->key_destroy_func || hash_table->value_destroy_func)
+    {
+      g_hash_table_iter_init (&iter, table);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+          if (hash_table->key_destroy_func)
+            hash_table->key_destroy_func (key);
+          if (hash_table->value_destroy_func)
+            hash_table->value_destroy_func (value);
+        }
+    }
+
+  g_hash_table_unref (table);
+}
+
+/**
+ * g_concurrent_hash_table_unref:
+ * @hash_table: (transfer full): a valid #GConcurrentHashTable
+ *
+ * Atomically decrements the reference count of @hash_table by one.
+ * If the reference count drops to 0, all keys and values will be
+ * destroyed, and all memory allocated by the hash table is released.
+ * This function is MT-safe and may be called from any thread.
+ *
+ * Since: 2.54
+ */
+void
+g_concurrent_hash_table_unref (GConcurrentHashTable *hash_table)
+{
+  guint i;
+
+  g_return_if_fail (hash_table != NULL);
+
+  if (!g_atomic_int_dec_and_test (&hash_table->ref_count))
+    return;
+
+  for (i = 0; i < hash_table->n_shards; i++)
+    {
+      free_entries (hash_table, hash_table->shards[i].s.table);
+      g_rw_lock_clear (&hash_table->shards[i].s.lock);
+    }
+
+  g_aligned_free (hash_table->shards);
+  g_slice_free (GConcurrentHashTable, hash_table);
+}
+
+static gboolean
+g_concurrent_hash_table_insert_internal (GConcurrentHashTable *hash_table,
+                                         gpointer              key,
+                                         gpointer              value,
+                                         gboolean              keep_new_key)
+{
+  GConcurrentShard *shard;
+  guint hash_value;
+  gpointer old_key = NULL;
+  gpointer old_value = NULL;
+  gboolean inserted;
+
+  g_return_val_if_fail (hash_table != NULL, FALSE);
+
+  hash_value = hash_table->hash_func (key);
+  shard = get_shard (hash_table, hash_value);
+
+  g_rw_lock_writer_lock (&shard->s.lock);
+  inserted = g_hash_table_exchange_hashed (shard->s.table, key, value, hash_value,
+                                           keep_new_key, &old_key, &old_value);
+  g_rw_lock_writer_unlock (&shard->s.lock);
+
+  if (!inserted)
+    {
+      if (hash_table->key_destroy_func)
+        hash_table->key_destroy_func (keep_new_key ? old_key : key);
+      if (hash_table->value_destroy_func)
+        hash_table->value_destroy_func (old_value);
+    }
+
+  return inserted;
+}
+
+/**
+ * g_concurrent_hash_table_insert:
+ * @hash_table: a #GConcurrentHashTable
+ * @key: a key to insert
+ * @value: the value to associate with the key
+ *
+ * Inserts a new key and value into a #GConcurrentHashTable, like
+ * g_hash_table_insert() does.
+ *
+ * If the key already exists in the table its current value is replaced
+ * with the new value, and the passed key is freed.
+ *
+ * Returns: %TRUE if the key did not exist yet
+ *
+ * Since: 2.54
+ */
+gboolean
+g_concurrent_hash_table_insert (GConcurrentHashTable *hash_table,
+                                gpointer              key,
+                                gpointer              value)
+{
+  return g_concurrent_hash_table_insert_internal (hash_table, key, value, FALSE);
+}
+
+/**
+ * g_concurrent_hash_table_replace:
+ * @hash_table: a #GConcurrentHashTable
+ * @key: a key to insert
+ * @value: the value to associate with the key
+ *
+ * Inserts a new key and value into a #GConcurrentHashTable, like
+ * g_hash_table_replace() does.
+ *
+ * If the key already exists in the table, both its key and its value
+ * are replaced by the new ones, and the old ones are freed.
+ *
+ * Returns: %TRUE if the key did not exist yet
+ *
+ * Since: 2.54
+ */
+gboolean
+g_concurrent_hash_table_replace (GConcurrentHashTable *hash_table,
+                                 gpointer              key,
+                                 gpointer              value)
+{
+  return g_concurrent_hash_table_insert_internal (hash_table, key, value, TRUE);
+}
+
+/**
+ * g_concurrent_hash_table_remove:
+ * @hash_table: a #GConcurrentHashTable
+ * @key: the key to remove
+ *
+ * Removes a key and its associated value from a #GConcurrentHashTable,
+ * freeing them with the destroy notifiers of the table, if any.
+ *
+ * Returns: %TRUE if the key was found and removed
+ *
+ * Since: 2.54
+ */
+gboolean
+g_concurrent_hash_table_remove (GConcurrentHashTable *hash_table,
+                                gconstpointer         key)
+{
+  GConcurrentShard *shard;
+  guint hash_value;
+  gpointer orig_key, value;
+  gboolean removed;
+
+  g_return_val_if_fail (hash_table != NULL, FALSE);
+
+  hash_value = hash_table->hash_func (key);
+  shard = get_shard (hash_table, hash_value);
+
+  g_rw_lock_writer_lock (&shard->s.lock);
+  removed = g_hash_table_steal_hashed (shard->s.table, key, hash_value, &orig_key, &value);
+  g_rw_lock_writer_unlock (&shard->s.lock);
+
+  if (removed)
+    {
+      if (hash_table->key_destroy_func)
+        hash_table->key_destroy_func (orig_key);
+      if (hash_table->value_destroy_func)
+        hash_table->value_destroy_func (value);
+    }
+
+  return removed;
+}
+
+/**
+ * g_concurrent_hash_table_remove_all:
+ * @hash_table: a #GConcurrentHashTable
+ *
+ * Removes all keys and their associated values from a
+ * #GConcurrentHashTable, freeing them with the destroy notifiers of
+ * the table, if any.
+ *
+ * The shards are emptied one after the other, so keys that other
+ * threads insert meanwhile may or may not be removed.
+ *
+ * Since: 2.54
+ */
+void
+g_concurrent_hash_table_remove_all (GConcurrentHashTable *hash_table)
+{
+  guint i;
+
+  g_return_if_fail (hash_table != NULL);
+
+  for (i = 0; i < hash_table->n_shards; i++)
+    {
+      GConcurrentShard *shard = &hash_table->shards[i];
+      GHashTable *table, *empty;
+
+      empty = g_hash_table_new (hash_table->hash_func, hash_table->key_equal_func);
+
+      g_rw_lock_writer_lock (&shard->s.lock);
+      table = shard->s.table;
+      shard->s.table = empty;
+      g_rw_lock_writer_unlock (&shard->s.lock);
+
+      free_entries (hash_table, table);
+    }
+}
+
+/**
+ * g_concurrent_hash_table_lookup:
+ * @hash_table: a #GConcurrentHashTable
+ * @key: the key to look up
+ *
+ * Looks up a key in a #GConcurrentHashTable, like g_hash_table_lookup()
+ * does.
+ *
+ * The value is not protected from being freed by another thread that
+ * removes or replaces @key afterwards; see the section description and
+ * g_concurrent_hash_table_lookup_copy().
+ *
+ * Returns: (nullable): the associated value, or %NULL if the key is
+ *     not found
+ *
+ * Since: 2.54
+ */
+gpointer
+g_concurrent_hash_table_lookup (GConcurrentHashTable *hash_table,
+                                gconstpointer         key)
+{
+  GConcurrentShard *shard;
+  guint hash_value;
+  gpointer value = NULL;
+
+  g_return_val_if_fail (hash_table != NULL, NULL);
+
+  hash_value = hash_table->hash_func (key);
+  shard = get_shard (hash_table, hash_value);
+
+  g_rw_lock_reader_lock (&shard->s.lock);
+  g_hash_table_lookup_extended_hashed (shard->s.table, key, hash_value, NULL, &value);
+  g_rw_lock_reader_unlock (&shard->s.lock);
+
+  return value;
+}
+
+/**
+ * g_concurrent_hash_table_lookup_copy:
+ * @hash_table: a #GConcurrentHashTable
+ * @key: the key to look up
+ * @copy_func: (scope call): a function to copy the value, or to take a
+ *     reference on it
+ * @user_data: user data to pass to @copy_func
+ *
+ * Looks up a key in a #GConcurrentHashTable and returns what @copy_func
+ * returns for its value.
+ *
+ * @copy_func is called while no other thread can remove the value, so
+ * the copy stays valid however the table changes later.  It must not
+ * call any function on @hash_table.
+ *
+ * Returns: (nullable): the copy of the associated value, or %NULL if
+ *     the key is not found
+ *
+ * Since: 2.54
+ */
+gpointer
+g_concurrent_hash_table_lookup_copy (GConcurrentHashTable *hash_table,
+                                     gconstpointer         key,
+                                     GCopyFunc             copy_func,
+                                     gpointer              user_data)
+{
+  GConcurrentShard *shard;
+  guint hash_value;
+  gpointer value = NULL;
+
+  g_return_val_if_fail (hash_table != NULL, NULL);
+  g_return_val_if_fail (copy_func != NULL, NULL);
+
+  hash_value = hash_table->hash_func (key);
+  shard = get_shard (hash_table, hash_value);
+
+  g_rw_lock_reader_lock (&shard->s.lock);
+  if (g_hash_table_lookup_extended_hashed (shard->s.table, key, hash_value, NULL, &value))
+    value = copy_func (value, user_data);
+  g_rw_lock_reader_unlock (&shard->s.lock);
+
+  return value;
+}
+
+/**
+ * g_concurrent_hash_table_contains:
+ * @hash_table: a #GConcurrentHashTable
+ * @key: a key to check
+ *
+ * Checks if @key is in @hash_table.
+ *
+ * Returns: %TRUE if @key is in @hash_table, %FALSE otherwise
+ *
+ * Since: 2.54
+ */
+gboolean
+g_concurrent_hash_table_contains (GConcurrentHashTable *hash_table,
+                                  gconstpointer         key)
+{
+  GConcurrentShard *shard;
+  guint hash_value;
+  gboolean found;
+
+  g_return_val_if_fail (hash_table != NULL, FALSE);
+
+  hash_value = hash_table->hash_func (key);
+  shard = get_shard (hash_table, hash_value);
+
+  g_rw_lock_reader_lock (&shard->s.lock);
+  found = g_hash_table_lookup_extended_hashed (shard->s.table, key, hash_value, NULL, NULL);
+  g_rw_lock_reader_unlock (&shard->s.lock);
+
+  return found;
+}
+
+/**
+ * g_concurrent_hash_table_size:
+ * @hash_table: a #GConcurrentHashTable
+ *
+ * Returns the number of elements contained in the #GConcurrentHashTable.
+ * If other threads change the table at the same time, this is only an
+ * approximation.
+ *
+ * Returns: the number of key/value pairs in the table
+ *
+ * Since: 2.54
+ */
+guint
+g_concurrent_hash_table_size (GConcurrentHashTable *hash_table)
+{
+  guint size = 0;
+  guint i;
+
+  g_return_val_if_fail (hash_table != NULL, 0);
+
+  for (i = 0; i < hash_table->n_shards; i++)
+    {
+      GConcurrentShard *shard = &hash_table->shards[i];
+
+      g_rw_lock_reader_lock (&shard->s.lock);
+      size += g_hash_table_size (shard->s.table);
+      g_rw_lock_reader_unlock (&shard->s.lock);
+    }
+
+  return size;
+}
+
+/**
+ * g_concurrent_hash_table_foreach:
+ * @hash_table: a #GConcurrentHashTable
+ * @func: (scope call): the function to call for each key/value pair
+ * @user_data: user data to pass to the function
+ *
+ * Calls the given function for each of the key/value pairs in the
+ * #GConcurrentHashTable.
+ *
+ * The shards are visited one after the other, each locked against
+ * changes while @func runs for its entries, so every entry that is in
+ * the table throughout the call is visited exactly once.  @func must
+ * not call any function on @hash_table; use
+ * g_concurrent_hash_table_snapshot() if it needs to.
+ *
+ * Since: 2.54
+ */
+void
+g_concurrent_hash_table_foreach (GConcurrentHashTable *hash_table,
+                                 GHFunc                func,
+                                 gpointer              user_data)
+{
+  guint i;
+
+  g_return_if_fail (hash_table != NULL);
+  g_return_if_fail (func != NULL);
+
+  for (i = 0; i < hash_table->n_shards; i++)
+    {
+      GConcurrentShard *shard = &hash_table->shards[i];
+
+      g_rw_lock_reader_lock (&shard->s.lock);
+      g_hash_table_foreach (shard->s.table, func, user_data);
+      g_rw_lock_reader_unlock (&shard->s.lock);
+    }
+}
+
+/**
+ * g_concurrent_hash_table_snapshot:
+ * @hash_table: a #GConcurrentHashTable
+ * @key_copy_func: (nullable) (scope call): a function to copy the keys,
+ *     or %NULL to use the keys themselves
+ * @value_copy_func: (nullable) (scope call): a function to copy the
+ *     values, or %NULL to use the values themselves
+ * @user_data: user data to pass to the copy functions
+ *
+ * Copies the contents of a #GConcurrentHashTable into a new #GHashTable
+ * that belongs to the caller and can be iterated without any locking.
+ *
+ * Each shard is copied while it is locked against changes, like in
+ * g_concurrent_hash_table_foreach().  The copy functions are called
+ * under that lock, and must not call any function on @hash_table.
+ *
+ * The returned table uses the hash and equality functions of
+ * @hash_table.  Keys and values that were copied are freed with the
+ * destroy notifiers of @hash_table when they are removed from it;
+ * those that were not are borrowed from @hash_table.
+ *
+ * Returns: (transfer full): a new #GHashTable
+ *
+ * Since: 2.54
+ */
+GHashTable *
+g_concurrent_hash_table_snapshot (GConcurrentHashTable *hash_table,
+                                  GCopyFunc             key_copy_func,
+                                  GCopyFunc             value_copy_func,
+                                  gpointer              user_data)
+{
+  GHashTable *snapshot;
+  guint i;
+
+  g_return_val_if_fail (hash_table != NULL, NULL);
+
+  snapshot = g_hash_table_new_full (hash_table->hash_func, hash_table->key_equal_func,
+                                    key_copy_func ? hash_table->key_destroy_func : NULL,
+                                    value_copy_func ? hash_table->value_destroy_func : NULL);
+
+  for (i = 0; i < hash_table->n_shards; i++)
+    {
+      GConcurrentShard *shard = &hash_table->shards[i];
+      GHashTableIter iter;
+      gpointer key, value;
+
+      g_rw_lock_reader_lock (&shard->s.lock);
+
+      g_hash_table_iter_init (&iter, shard->s.table);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+          if (key_copy_func)
+            key = key_copy_func (key, user_data);
+          if (value_copy_func)
+            value = value_copy_func (value, user_data);
+
+          g_hash_table_insert (snapshot, key, value);
+        }
+
+      g_rw_lock_reader_unlock (&shard->s.lock);
+    }
+
+  return snapshot;
+}
@@ -0,0 +1,86 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_CONCURRENT_HASH_H__
+#define __G_CONCURRENT_HASH_H__
+
+#if !defined (__GLIB_H_INSIDE__) && !defined (GLIB_COMPILATION)
+#error "Only <glib.h> can be included directly."
+#endif
+
+#include <glib/ghash.h>
+#include <glib/gnode.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GConcurrentHashTable GConcurrentHashTable;
+
+GLIB_AVAILABLE_IN_2_54
+GConcurrentHashTable *g_concurrent_hash_table_new         (GHashFunc             hash_func,
+                                                           GEqualFunc            key_equal_func);
+GLIB_AVAILABLE_IN_2_54
+GConcurrentHashTable *g_concurrent_hash_table_new_full    (GHashFunc             hash_func,
+                                                           GEqualFunc            key_equal_func,
+                                                           GDestroyNotify        key_destroy_func,
+                                                           GDestroyNotify        value_destroy_func);
+GLIB_AVAILABLE_IN_2_54
+GConcurrentHashTable *g_concurrent_hash_table_ref         (GConcurrentHashTable *hash_table);
+GLIB_AVAILABLE_IN_2_54
+void                  g_concurrent_hash_table_unref       (GConcurrentHashTable *hash_table);
+
+GLIB_AVAILABLE_IN_2_54
+gboolean              g_concurrent_hash_table_insert      (GConcurrentHashTable *hash_table,
+                                                           gpointer              key,
+                                                           gpointer              value);
+GLIB_AVAILABLE_IN_2_54
+gboolean              g_concurrent_hash_table_replace     (GConcurrentHashTable *hash_table,
+                                                           gpointer              key,
+                                                           gpointer              value);
+GLIB_AVAILABLE_IN_2_54
+gboolean              g_concurrent_hash_table_remove      (GConcurrentHashTable *hash_table,
+                                                           gconstpointer         key);
+GLIB_AVAILABLE_IN_2_54
+void                  g_concurrent_hash_table_remove_all  (GConcurrentHashTable *hash_table);
+
+GLIB_AVAILABLE_IN_2_54
+gpointer              g_concurrent_hash_table_lookup      (GConcurrentHashTable *hash_table,
+                                                           gconstpointer         key);
+GLIB_AVAILABLE_IN_2_54
+gpointer              g_concurrent_hash_table_lookup_copy (GConcurrentHashTable *hash_table,
+                                                           gconstpointer         key,
+                                                           GCopyFunc             copy_func,
+                                                           gpointer              user_data);
+GLIB_AVAILABLE_IN_2_54
+gboolean              g_concurrent_hash_table_contains    (GConcurrentHashTable *hash_table,
+                                                           gconstpointer         key);
+GLIB_AVAILABLE_IN_2_54
+guint                 g_concurrent_hash_table_size        (GConcurrentHashTable *hash_table);
+
+GLIB_AVAILABLE_IN_2_54
+void                  g_concurrent_hash_table_foreach     (GConcurrentHashTable *hash_table,
+                                                           GHFunc                func,
+                                                           gpointer              user_data);
+GLIB_AVAILABLE_IN_2_54
+GHashTable           *g_concurrent_hash_table_snapshot    (GConcurrentHashTable *hash_table,
+                                                           GCopyFunc             key_copy_func,
+                                                           GCopyFunc             value_copy_func,
+                                                           gpointer              user_data);
+
+G_END_DECLS
+
+#endif /* __G_CONCURRENT_HASH_H__ */
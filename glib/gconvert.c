@@ -302,12 +302,120 @@ g_iconv_close (GIConv converter)
   return iconv_close (cd);
 }
 
+/* Opening an iconv descriptor is expensive (it may involve loading
+ * gconv modules), so each thread keeps a few recently used descriptors
+ * around, keyed on the pair of codeset names. A descriptor is handed
+ * out to one caller at a time and has its shift state reset before
+ * being reused.
+ *
+ * glibc only honours a byte order mark on the first call to iconv()
+ * for a descriptor, and resetting doesn't change that, so converters
+ * for Unicode encodings without an explicit byte order aren't cached.
+ */
+#define CONVERTER_CACHE_SIZE 8
+
+typedef struct
+{
+  gchar    *to_codeset;
+  gchar    *from_codeset;
+  GIConv    cd;
+  gboolean  in_use;
+} ConverterCacheEntry;
+
+typedef struct
+{
+  ConverterCacheEntry entries[CONVERTER_CACHE_SIZE];  /* most recently used first */
+  guint               n_entries;
+} ConverterCache;
+
+static void
+converter_cache_free (gpointer data)
+{
+  ConverterCache *cache = data;
+  guint i;
+
+  for (i = 0; i < cache->n_entries; i++)
+    {
+      g_free (cache->entries[i].to_codeset);
+      g_free (cache->entries[i].from_codeset);
+      g_iconv_close (cache->entries[i].cd);
+    }
+  g_free (cache);
+}
+
+static GPrivate converter_cache_private = G_PRIVATE_INIT (converter_cache_free);
+
+static ConverterCache *
+get_converter_cache (void)
+{
+  ConverterCache *cache = g_private_get (&converter_cache_private);
+
+  if (!cache)
+    {
+      cache = g_new0 (ConverterCache, 1);
+      g_private_set (&converter_cache_private, cache);
+    }
+
+  return cache;
+}
+
+/* Moves entry @i to the front of @cache */
+static ConverterCacheEntry *
+converter_cache_promote (ConverterCache *cache,
+                         guint           i)
+{
+  ConverterCacheEntry entry = cache->entries[i];
+
+  memmove (&cache->entries[1], &cache->entries[0], i * sizeof (ConverterCacheEntry));
+  cache->entries[0] = entry;
+
+  return &cache->entries[0];
+}
+
+static gboolean
+codeset_uses_bom (const gchar *codeset)
+{
+  static const gchar * const prefixes[] = {
+    "UTF-16", "UTF16", "UTF-32", "UTF32", "UCS-2", "UCS2", "UCS-4", "UCS4", "UNICODE"
+  };
+  gsize len = strlen (codeset);
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (prefixes); i++)
+    {
+      if (g_ascii_strncasecmp (codeset, prefixes[i], strlen (prefixes[i])) == 0)
+        return !(len >= 2 &&
+                 (g_ascii_strcasecmp (codeset + len - 2, "LE") == 0 ||
+                  g_ascii_strcasecmp (codeset + len - 2, "BE") == 0));
+    }
+
+  return FALSE;
+}
+
 static GIConv
 open_converter (const gchar *to_codeset,
 		const gchar *from_codeset,
 		GError     **error)
 {
+  ConverterCache *cache;
+  ConverterCacheEntry *entry;
   GIConv cd;
+  guint i;
+
+  cache = get_converter_cache ();
+  for (i = 0; i < cache->n_entries; i++)
+    {
+      entry = &cache->entries[i];
+      if (!entry->in_use &&
+          strcmp (entry->to_codeset, to_codeset) == 0 &&
+          strcmp (entry->from_codeset, from_codeset) == 0)
+        {
+          entry = converter_cache_promote (cache, i);
+          entry->in_use = TRUE;
+          g_iconv (entry->cd, NULL, NULL, NULL, NULL);
+          return entry->cd;
+        }
+    }
 
   cd = g_iconv_open (to_codeset, from_codeset);
 
@@ -325,18 +433,66 @@ open_converter (const gchar *to_codeset,
 			 _("Could not open converter from “%s” to “%s”"),
 			 from_codeset, to_codeset);
 	}
+
+      return cd;
     }
-  
+
+  if (codeset_uses_bom (to_codeset) || codeset_uses_bom (from_codeset))
+    return cd;
+
+  /* Find a slot, evicting the least recently used idle descriptor if
+   * the cache is full. If every descriptor is busy, don't cache this one.
+   */
+  if (cache->n_entries < CONVERTER_CACHE_SIZE)
+    i = cache->n_entries++;
+  else
+    {
+      for (i = CONVERTER_CACHE_SIZE; i > 0; i--)
+        if (!cache->entries[i - 1].in_use)
+          break;
+      if (i == 0)
+        return cd;
+
+      i--;
+      entry = &cache->entries[i];
+      g_free (entry->to_codeset);
+      g_free (entry->from_codeset);
+      g_iconv_close (entry->cd);
+    }
+
+  entry = &cache->entries[i];
+  entry->to_codeset = g_strdup (to_codeset);
+  entry->from_codeset = g_strdup (from_codeset);
+  entry->cd = cd;
+  entry = converter_cache_promote (cache, i);
+  entry->in_use = TRUE;
+
   return cd;
 }
 
 static int
 close_converter (GIConv cd)
 {
+  ConverterCache *cache;
+  guint i;
+
   if (cd == (GIConv) -1)
     return 0;
-  
-  return g_iconv_close (cd);  
+
+  cache = g_private_get (&converter_cache_private);
+  if (cache)
+    {
+      for (i = 0; i < cache->n_entries; i++)
+        {
+          if (cache->entries[i].cd == cd)
+            {
+              cache->entries[i].in_use = FALSE;
+              return 0;
+            }
+        }
+    }
+
+  return g_iconv_close (cd);
 }
 
 /**
@@ -492,6 +648,341 @@ g_convert_with_iconv (const gchar *str,
     return dest;
 }
 
+/* Conversions between UTF-8 and a handful of very common, stateless
+ * encodings are done directly rather than through iconv. Their results
+ * (including bytes_read on errors and partial input) match what iconv
+ * would produce.
+ */
+typedef enum
+{
+  BUILTIN_CHARSET_NONE,
+  BUILTIN_CHARSET_UTF8,
+  BUILTIN_CHARSET_ASCII,
+  BUILTIN_CHARSET_LATIN1,
+  BUILTIN_CHARSET_UTF16LE,
+  BUILTIN_CHARSET_UTF16BE
+} BuiltinCharset;
+
+static BuiltinCharset
+get_builtin_charset (const gchar *codeset)
+{
+  static const struct {
+    const gchar    *name;
+    BuiltinCharset  charset;
+  } charsets[] = {
+    { "UTF-8", BUILTIN_CHARSET_UTF8 },
+    { "UTF8", BUILTIN_CHARSET_UTF8 },
+    { "ASCII", BUILTIN_CHARSET_ASCII },
+    { "US-ASCII", BUILTIN_CHARSET_ASCII },
+    { "ANSI_X3.4-1968", BUILTIN_CHARSET_ASCII },
+    { "ISO-8859-1", BUILTIN_CHARSET_LATIN1 },
+    { "ISO8859-1", BUILTIN_CHARSET_LATIN1 },
+    { "ISO_8859-1", BUILTIN_CHARSET_LATIN1 },
+    { "LATIN1", BUILTIN_CHARSET_LATIN1 },
+    { "UTF-16LE", BUILTIN_CHARSET_UTF16LE },
+    { "UTF-16BE", BUILTIN_CHARSET_UTF16BE }
+  };
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (charsets); i++)
+    {
+      if (g_ascii_strcasecmp (codeset, charsets[i].name) == 0)
+        return charsets[i].charset;
+    }
+
+  return BUILTIN_CHARSET_NONE;
+}
+
+/* Returns the length of the run of ASCII bytes at the start of @p,
+ * checking a machine word at a time where possible.
+ */
+static gsize
+ascii_run_length (const guchar *p,
+                  gsize         len)
+{
+  const gsize high_bits = ((gsize) -1 / 0xff) * 0x80;
+  gsize i = 0;
+
+  while (i < len && ((gsize) (p + i) % sizeof (gsize)) != 0)
+    {
+      if (p[i] & 0x80)
+        return i;
+      i++;
+    }
+
+  while (i + sizeof (gsize) <= len && (*(const gsize *) (p + i) & high_bits) == 0)
+    i += sizeof (gsize);
+
+  while (i < len && !(p[i] & 0x80))
+    i++;
+
+  return i;
+}
+
+/* Decodes one character from the @len bytes at @p in @charset. Returns
+ * the number of bytes consumed, 0 if the input ends in the middle of a
+ * character, or -1 if the input is invalid.
+ */
+static gint
+builtin_decode (BuiltinCharset  charset,
+                const guchar   *p,
+                gsize           len,
+                gunichar       *ch)
+{
+  gunichar c, min;
+  gint n, i;
+
+  switch (charset)
+    {
+    case BUILTIN_CHARSET_UTF8:
+      c = p[0];
+      if (c < 0x80)
+        {
+          *ch = c;
+          return 1;
+        }
+      else if (c < 0xc2)
+        return -1;
+      else if (c < 0xe0)
+        {
+          n = 2;
+          c &= 0x1f;
+          min = 0x80;
+        }
+      else if (c < 0xf0)
+        {
+          n = 3;
+          c &= 0x0f;
+          min = 0x800;
+        }
+      else if (c < 0xf5)
+        {
+          n = 4;
+          c &= 0x07;
+          min = 0x10000;
+        }
+      else
+        return -1;
+
+      for (i = 1; i < n; i++)
+        {
+          if (i >= len)
+            return 0;
+          if ((p[i] & 0xc0) != 0x80)
+            return -1;
+          c = (c << 6) | (p[i] & 0x3f);
+        }
+
+      if (c < min || c > 0x10ffff || (c >= 0xd800 && c < 0xe000))
+        return -1;
+
+      *ch = c;
+      return n;
+
+    case BUILTIN_CHARSET_ASCII:
+      if (p[0] & 0x80)
+        return -1;
+      *ch = p[0];
+      return 1;
+
+    case BUILTIN_CHARSET_LATIN1:
+      *ch = p[0];
+      return 1;
+
+    case BUILTIN_CHARSET_UTF16LE:
+    case BUILTIN_CHARSET_UTF16BE:
+      if (len < 2)
+        return 0;
+      if (charset == BUILTIN_CHARSET_UTF16LE)
+        c = p[0] | (p[1] << 8);
+      else
+        c = (p[0] << 8) | p[1];
+
+      if (c < 0xd800 || c >= 0xe000)
+        {
+          *ch = c;
+          return 2;
+        }
+      else if (c >= 0xdc00)
+        return -1;
+
+      if (len < 4)
+        return 0;
+      if (charset == BUILTIN_CHARSET_UTF16LE)
+        min = p[2] | (p[3] << 8);
+      else
+        min = (p[2] << 8) | p[3];
+      if (min < 0xdc00 || min >= 0xe000)
+        return -1;
+
+      *ch = 0x10000 + ((c - 0xd800) << 10) + (min - 0xdc00);
+      return 4;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+/* Encodes @ch in @charset at @out, which must have room for 4 bytes.
+ * Returns the number of bytes written, or -1 if @ch can't be
+ * represented.
+ */
+static gint
+builtin_encode (BuiltinCharset  charset,
+                gunichar        ch,
+                guchar         *out)
+{
+  gunichar2 units[2];
+  gint n, i;
+
+  switch (charset)
+    {
+    case BUILTIN_CHARSET_UTF8:
+      return g_unichar_to_utf8 (ch, (gchar *) out);
+
+    case BUILTIN_CHARSET_ASCII:
+      if (ch >= 0x80)
+        return -1;
+      out[0] = ch;
+      return 1;
+
+    case BUILTIN_CHARSET_LATIN1:
+      if (ch >= 0x100)
+        return -1;
+      out[0] = ch;
+      return 1;
+
+    case BUILTIN_CHARSET_UTF16LE:
+    case BUILTIN_CHARSET_UTF16BE:
+      if (ch < 0x10000)
+        {
+          units[0] = ch;
+          n = 1;
+        }
+      else
+        {
+          units[0] = 0xd800 + ((ch - 0x10000) >> 10);
+          units[1] = 0xdc00 + ((ch - 0x10000) & 0x3ff);
+          n = 2;
+        }
+
+      for (i = 0; i < n; i++)
+        {
+          if (charset == BUILTIN_CHARSET_UTF16LE)
+            {
+              *out++ = units[i] & 0xff;
+              *out++ = units[i] >> 8;
+            }
+          else
+            {
+              *out++ = units[i] >> 8;
+              *out++ = units[i] & 0xff;
+            }
+        }
+      return n * 2;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static gboolean
+builtin_charset_is_bytewise (BuiltinCharset charset)
+{
+  return (charset == BUILTIN_CHARSET_UTF8 ||
+          charset == BUILTIN_CHARSET_ASCII ||
+          charset == BUILTIN_CHARSET_LATIN1);
+}
+
+static gchar *
+convert_builtin (const gchar     *str,
+                 gsize            len,
+                 BuiltinCharset   to_charset,
+                 BuiltinCharset   from_charset,
+                 gsize           *bytes_read,
+                 gsize           *bytes_written,
+                 GError         **error)
+{
+  const guchar *p = (const guchar *) str;
+  const guchar *end = p + len;
+  guchar *dest, *outp;
+  gboolean have_error = FALSE;
+  gunichar ch;
+  gsize run, i;
+  gint consumed, written;
+
+  /* No supported pair more than doubles the length of its input */
+  outp = dest = g_malloc (len * 2 + NUL_TERMINATOR_LENGTH);
+
+  while (p < end)
+    {
+      if (builtin_charset_is_bytewise (from_charset))
+        {
+          run = ascii_run_length (p, end - p);
+          if (builtin_charset_is_bytewise (to_charset))
+            {
+              memcpy (outp, p, run);
+              outp += run;
+            }
+          else if (to_charset == BUILTIN_CHARSET_UTF16LE)
+            {
+              for (i = 0; i < run; i++, outp += 2)
+                {
+                  outp[0] = p[i];
+                  outp[1] = 0;
+                }
+            }
+          else
+            {
+              for (i = 0; i < run; i++, outp += 2)
+                {
+                  outp[0] = 0;
+                  outp[1] = p[i];
+                }
+            }
+          p += run;
+          if (p == end)
+            break;
+        }
+
+      consumed = builtin_decode (from_charset, p, end - p, &ch);
+      if (consumed == 0)
+        break;
+      if (consumed < 0 || (written = builtin_encode (to_charset, ch, outp)) < 0)
+        {
+          g_set_error_literal (error, G_CONVERT_ERROR, G_CONVERT_ERROR_ILLEGAL_SEQUENCE,
+                               _("Invalid byte sequence in conversion input"));
+          have_error = TRUE;
+          break;
+        }
+
+      outp += written;
+      p += consumed;
+    }
+
+  memset (outp, 0, NUL_TERMINATOR_LENGTH);
+
+  if (bytes_read)
+    *bytes_read = p - (const guchar *) str;
+  else if (p != end && !have_error)
+    {
+      g_set_error_literal (error, G_CONVERT_ERROR, G_CONVERT_ERROR_PARTIAL_INPUT,
+                           _("Partial character sequence at end of input"));
+      have_error = TRUE;
+    }
+
+  if (bytes_written)
+    *bytes_written = outp - dest;	/* Doesn't include '\0' */
+
+  if (have_error)
+    {
+      g_free (dest);
+      return NULL;
+    }
+  else
+    return (gchar *) dest;
+}
+
 /**
  * g_convert:
  * @str:           the string to convert
@@ -544,11 +1035,25 @@ g_convert (const gchar *str,
 {
   gchar *res;
   GIConv cd;
+  BuiltinCharset to_charset, from_charset;
 
   g_return_val_if_fail (str != NULL, NULL);
   g_return_val_if_fail (to_codeset != NULL, NULL);
   g_return_val_if_fail (from_codeset != NULL, NULL);
-  
+
+  to_charset = get_builtin_charset (to_codeset);
+  from_charset = get_builtin_charset (from_codeset);
+  if (to_charset != BUILTIN_CHARSET_NONE && from_charset != BUILTIN_CHARSET_NONE &&
+      (to_charset == BUILTIN_CHARSET_UTF8 || from_charset == BUILTIN_CHARSET_UTF8))
+    {
+      if (len < 0)
+        len = strlen (str);
+
+      if ((gsize) len < (G_MAXSIZE - NUL_TERMINATOR_LENGTH) / 2)
+        return convert_builtin (str, len, to_charset, from_charset,
+                                bytes_read, bytes_written, error);
+    }
+
   cd = open_converter (to_codeset, from_codeset, error);
 
   if (cd == (GIConv) -1)
@@ -39,6 +39,7 @@
 #include "gslice.h"
 #include "gdatasetprivate.h"
 #include "ghash.h"
+#include "gqsort.h"
 #include "gquark.h"
 #include "gstrfuncs.h"
 #include "gtestutils.h"
@@ -203,6 +204,128 @@ static GDataset     *g_dataset_cached = NULL; /* should this be
 
 #define DATALIST_LOCK_BIT 2
 
+/* Datalists with at least this many elements are kept sorted by key, so
+ * that lookups can use a binary search instead of scanning the list.
+ * Shorter lists are unordered, which keeps additions and removals cheap.
+ */
+#define DATALIST_SORTED_MIN 16
+
+static gint
+datalist_elt_cmp (gconstpointer a,
+                  gconstpointer b,
+                  gpointer      user_data)
+{
+  const GDataElt *elt_a = a, *elt_b = b;
+
+  return elt_a->key < elt_b->key ? -1 : elt_a->key > elt_b->key;
+}
+
+/* Returns the index of the first element with a key not less than
+ * @key_id, in a sorted datalist.
+ */
+static inline guint
+datalist_search (GData  *d,
+                 GQuark  key_id)
+{
+  guint lo = 0, hi = d->len;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (d->data[mid].key < key_id)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+static inline GDataElt *
+datalist_find (GData  *d,
+               GQuark  key_id)
+{
+  GDataElt *data, *data_end;
+
+  if (d == NULL)
+    return NULL;
+
+  if (d->len >= DATALIST_SORTED_MIN)
+    {
+      guint i = datalist_search (d, key_id);
+
+      return i < d->len && d->data[i].key == key_id ? &d->data[i] : NULL;
+    }
+
+  data = d->data;
+  data_end = data + d->len;
+  while (data < data_end)
+    {
+      if (data->key == key_id)
+        return data;
+      data++;
+    }
+
+  return NULL;
+}
+
+/* Removes @data from @d, keeping a sorted list sorted. */
+static inline void
+datalist_remove (GData    *d,
+                 GDataElt *data)
+{
+  GDataElt *data_last = d->data + d->len - 1;
+
+  if (d->len >= DATALIST_SORTED_MIN)
+    memmove (data, data + 1, (data_last - data) * sizeof (GDataElt));
+  else if (data != data_last)
+    *data = *data_last;
+  d->len--;
+}
+
+/* Adds a new element to @d (which may be %NULL), returning the possibly
+ * reallocated list.
+ */
+static GData *
+datalist_append (GData          *d,
+                 GQuark          key_id,
+                 gpointer        new_data,
+                 GDestroyNotify  new_destroy_func)
+{
+  guint i;
+
+  if (d == NULL)
+    {
+      d = g_malloc (sizeof (GData));
+      d->len = 0;
+      d->alloc = 1;
+    }
+  else if (d->len == d->alloc)
+    {
+      d->alloc = d->alloc * 2;
+      d = g_realloc (d, sizeof (GData) + (d->alloc - 1) * sizeof (GDataElt));
+    }
+
+  if (d->len >= DATALIST_SORTED_MIN)
+    {
+      i = datalist_search (d, key_id);
+      memmove (&d->data[i + 1], &d->data[i], (d->len - i) * sizeof (GDataElt));
+    }
+  else
+    i = d->len;
+
+  d->data[i].key = key_id;
+  d->data[i].data = new_data;
+  d->data[i].destroy = new_destroy_func;
+  d->len++;
+
+  if (d->len == DATALIST_SORTED_MIN)
+    g_qsort_with_data (d->data, d->len, sizeof (GDataElt), datalist_elt_cmp, NULL);
+
+  return d;
+}
+
 static void
 g_datalist_lock (GData **datalist)
 {
@@ -349,134 +472,99 @@ g_data_set_internal (GData	  **datalist,
 		     GDataset	   *dataset)
 {
   GData *d, *old_d;
-  GDataElt old, *data, *data_last, *data_end;
+  GDataElt old, *data;
 
   g_datalist_lock (datalist);
 
   d = G_DATALIST_GET_POINTER (datalist);
+  data = datalist_find (d, key_id);
 
   if (new_data == NULL) /* remove */
     {
-      if (d)
+      if (data)
 	{
-	  data = d->data;
-	  data_last = data + d->len - 1;
-	  while (data <= data_last)
+	  old = *data;
+	  datalist_remove (d, data);
+
+	  /* We don't bother to shrink, but if all data are now gone
+	   * we at least free the memory
+	   */
+	  if (d->len == 0)
+	    {
+	      G_DATALIST_SET_POINTER (datalist, NULL);
+	      g_free (d);
+	      /* datalist may be situated in dataset, so must not be
+	       * unlocked after we free it
+	       */
+	      g_datalist_unlock (datalist);
+
+	      /* the dataset destruction *must* be done
+	       * prior to invocation of the data destroy function
+	       */
+	      if (dataset)
+		g_dataset_destroy_internal (dataset);
+	    }
+	  else
+	    {
+	      g_datalist_unlock (datalist);
+	    }
+
+	  /* We found and removed an old value
+	   * the GData struct *must* already be unlinked
+	   * when invoking the destroy function.
+	   * we use (new_data==NULL && new_destroy_func!=NULL) as
+	   * a special hint combination to "steal"
+	   * data without destroy notification
+	   */
+	  if (old.destroy && !new_destroy_func)
 	    {
-	      if (data->key == key_id)
-		{
-		  old = *data;
-		  if (data != data_last)
-		    *data = *data_last;
-		  d->len--;
-
-		  /* We don't bother to shrink, but if all data are now gone
-		   * we at least free the memory
-                   */
-		  if (d->len == 0)
-		    {
-		      G_DATALIST_SET_POINTER (datalist, NULL);
-		      g_free (d);
-		      /* datalist may be situated in dataset, so must not be
-		       * unlocked after we free it
-		       */
-		      g_datalist_unlock (datalist);
-
-		      /* the dataset destruction *must* be done
-		       * prior to invocation of the data destroy function
-		       */
-		      if (dataset)
-			g_dataset_destroy_internal (dataset);
-		    }
-		  else
-		    {
-		      g_datalist_unlock (datalist);
-		    }
-
-		  /* We found and removed an old value
-		   * the GData struct *must* already be unlinked
-		   * when invoking the destroy function.
-		   * we use (new_data==NULL && new_destroy_func!=NULL) as
-		   * a special hint combination to "steal"
-		   * data without destroy notification
-		   */
-		  if (old.destroy && !new_destroy_func)
-		    {
-		      if (dataset)
-			G_UNLOCK (g_dataset_global);
-		      old.destroy (old.data);
-		      if (dataset)
-			G_LOCK (g_dataset_global);
-		      old.data = NULL;
-		    }
-
-		  return old.data;
-		}
-	      data++;
+	      if (dataset)
+		G_UNLOCK (g_dataset_global);
+	      old.destroy (old.data);
+	      if (dataset)
+		G_LOCK (g_dataset_global);
+	      old.data = NULL;
 	    }
+
+	  return old.data;
 	}
     }
   else
     {
-      old.data = NULL;
-      if (d)
+      if (data)
 	{
-	  data = d->data;
-	  data_end = data + d->len;
-	  while (data < data_end)
+	  if (!data->destroy)
+	    {
+	      data->data = new_data;
+	      data->destroy = new_destroy_func;
+	      g_datalist_unlock (datalist);
+	    }
+	  else
 	    {
-	      if (data->key == key_id)
-		{
-		  if (!data->destroy)
-		    {
-		      data->data = new_data;
-		      data->destroy = new_destroy_func;
-		      g_datalist_unlock (datalist);
-		    }
-		  else
-		    {
-		      old = *data;
-		      data->data = new_data;
-		      data->destroy = new_destroy_func;
-
-		      g_datalist_unlock (datalist);
-
-		      /* We found and replaced an old value
-		       * the GData struct *must* already be unlinked
-		       * when invoking the destroy function.
-		       */
-		      if (dataset)
-			G_UNLOCK (g_dataset_global);
-		      old.destroy (old.data);
-		      if (dataset)
-			G_LOCK (g_dataset_global);
-		    }
-		  return NULL;
-		}
-	      data++;
+	      old = *data;
+	      data->data = new_data;
+	      data->destroy = new_destroy_func;
+
+	      g_datalist_unlock (datalist);
+
+	      /* We found and replaced an old value
+	       * the GData struct *must* already be unlinked
+	       * when invoking the destroy function.
+	       */
+	      if (dataset)
+		G_UNLOCK (g_dataset_global);
+	      old.destroy (old.data);
+	      if (dataset)
+		G_LOCK (g_dataset_global);
 	    }
+	  return NULL;
 	}
 
       /* The key was not found, insert it */
       old_d = d;
-      if (d == NULL)
-	{
-	  d = g_malloc (sizeof (GData));
-	  d->len = 0;
-	  d->alloc = 1;
-	}
-      else if (d->len == d->alloc)
-	{
-	  d->alloc = d->alloc * 2;
-	  d = g_realloc (d, sizeof (GData) + (d->alloc - 1) * sizeof (GDataElt));
-	}
+      d = datalist_append (d, key_id, new_data, new_destroy_func);
       if (old_d != d)
 	G_DATALIST_SET_POINTER (datalist, d);
-
-      d->data[d->len].key = key_id;
-      d->data[d->len].data = new_data;
-      d->data[d->len].destroy = new_destroy_func;
-      d->len++;
     }
 
   g_datalist_unlock (datalist);
@@ -846,27 +934,13 @@ g_datalist_id_dup_data (GData          **datalist,
 {
   gpointer val = NULL;
   gpointer retval = NULL;
-  GData *d;
-  GDataElt *data, *data_end;
+  GDataElt *data;
 
   g_datalist_lock (datalist);
 
-  d = G_DATALIST_GET_POINTER (datalist);
-  if (d)
-    {
-      data = d->data;
-      data_end = data + d->len;
-      do
-        {
-          if (data->key == key_id)
-            {
-              val = data->data;
-              break;
-            }
-          data++;
-        }
-      while (data < data_end);
-    }
+  data = datalist_find (G_DATALIST_GET_POINTER (datalist), key_id);
+  if (data)
+    val = data->data;
 
   if (dup_func)
     retval = dup_func (val, user_data);
@@ -916,7 +990,7 @@ g_datalist_id_replace_data (GData          **datalist,
 {
   gpointer val = NULL;
   GData *d;
-  GDataElt *data, *data_end;
+  GDataElt *data;
 
   g_return_val_if_fail (datalist != NULL, FALSE);
   g_return_val_if_fail (key_id != 0, FALSE);
@@ -927,43 +1001,32 @@ g_datalist_id_replace_data (GData          **datalist,
   g_datalist_lock (datalist);
 
   d = G_DATALIST_GET_POINTER (datalist);
-  if (d)
+  data = datalist_find (d, key_id);
+  if (data)
     {
-      data = d->data;
-      data_end = data + d->len - 1;
-      while (data <= data_end)
+      val = data->data;
+      if (val == oldval)
         {
-          if (data->key == key_id)
+          if (old_destroy)
+            *old_destroy = data->destroy;
+          if (newval != NULL)
             {
-              val = data->data;
-              if (val == oldval)
-                {
-                  if (old_destroy)
-                    *old_destroy = data->destroy;
-                  if (newval != NULL)
-                    {
-                      data->data = newval;
-                      data->destroy = destroy;
-                    }
-                  else
-                   {
-                     if (data != data_end)
-                       *data = *data_end;
-                     d->len--;
-
-                     /* We don't bother to shrink, but if all data are now gone
-                      * we at least free the memory
-                      */
-                     if (d->len == 0)
-                       {
-                         G_DATALIST_SET_POINTER (datalist, NULL);
-                         g_free (d);
-                       }
-                   }
-                }
-              break;
+              data->data = newval;
+              data->destroy = destroy;
             }
-          data++;
+          else
+           {
+             datalist_remove (d, data);
+
+             /* We don't bother to shrink, but if all data are now gone
+              * we at least free the memory
+              */
+             if (d->len == 0)
+               {
+                 G_DATALIST_SET_POINTER (datalist, NULL);
+                 g_free (d);
+               }
+           }
         }
     }
 
@@ -973,24 +1036,9 @@ g_datalist_id_replace_data (GData          **datalist,
 
       /* insert newval */
       old_d = d;
-      if (d == NULL)
-	{
-          d = g_malloc (sizeof (GData));
-          d->len = 0;
-          d->alloc = 1;
-        }
-      else if (d->len == d->alloc)
-        {
-          d->alloc = d->alloc * 2;
-          d = g_realloc (d, sizeof (GData) + (d->alloc - 1) * sizeof (GDataElt));
-        }
+      d = datalist_append (d, key_id, newval, destroy);
       if (old_d != d)
         G_DATALIST_SET_POINTER (datalist, d);
-
-      d->data[d->len].key = key_id;
-      d->data[d->len].data = newval;
-      d->data[d->len].destroy = destroy;
-      d->len++;
     }
 
   g_datalist_unlock (datalist);
@@ -1134,7 +1182,7 @@ g_datalist_foreach (GData	   **datalist,
       for (j = 0; j < d->len; j++)
 	{
 	  if (d->data[j].key == keys[i]) {
-	    func (d->data[i].key, d->data[i].data, user_data);
+	    func (d->data[j].key, d->data[j].data, user_data);
 	    break;
 	  }
 	}
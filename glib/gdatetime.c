@@ -55,6 +55,7 @@
 #include "gdatetime.h"
 
 #include "gslice.h"
+#include "garray.h"
 #include "gatomic.h"
 #include "gcharset.h"
 #include "gconvert.h"
@@ -2227,6 +2228,380 @@ g_date_time_locale_format_locale (GDateTime   *datetime,
   return success;
 }
 
+/* A conversion specification, with its modifiers */
+typedef struct
+{
+  gunichar     c;
+  gboolean     alt_digits;
+  gboolean     pad_set;
+  const gchar *pad;
+  guint        colons;
+} Conversion;
+
+/* Parses the conversion specification after a '%', and moves @format
+ * past it. Whether the conversion itself exists is only known once
+ * format_conversion() gets to it.
+ */
+static gboolean
+parse_conversion (const gchar **format,
+                  Conversion   *conv)
+{
+  conv->alt_digits = FALSE;
+  conv->pad_set = FALSE;
+  conv->pad = "";
+  conv->colons = 0;
+
+  while (TRUE)
+    {
+      conv->c = g_utf8_get_char (*format);
+      *format = g_utf8_next_char (*format);
+
+      switch (conv->c)
+        {
+        case 'O':
+          conv->alt_digits = TRUE;
+          break;
+        case '-':
+          conv->pad_set = TRUE;
+          conv->pad = "";
+          break;
+        case '_':
+          conv->pad_set = TRUE;
+          conv->pad = " ";
+          break;
+        case '0':
+          conv->pad_set = TRUE;
+          conv->pad = "0";
+          break;
+        case ':':
+          /* Colons are only allowed before 'z' */
+          if (**format && **format != 'z' && **format != ':')
+            return FALSE;
+          conv->colons++;
+          break;
+        default:
+          return TRUE;
+        }
+    }
+}
+
+static gboolean
+format_conversion (GDateTime        *datetime,
+                   const Conversion *conv,
+                   GString          *outstr,
+                   gboolean          locale_is_utf8)
+{
+  gboolean     alt_digits = conv->alt_digits;
+  gboolean     pad_set = conv->pad_set;
+  gchar       *pad = (gchar *) conv->pad;
+  guint        colons = conv->colons;
+  gchar       *tmp;
+  gsize        tmp_len;
+  gchar       *ampm;
+  const gchar *name;
+  const gchar *tz;
+
+  switch (conv->c)
+    {
+    case 'a':
+      name = WEEKDAY_ABBR (datetime);
+#if !defined (HAVE_LANGINFO_TIME)
+      if (!locale_is_utf8)
+	{
+	  tmp = g_locale_from_utf8 (name, -1, NULL, &tmp_len, NULL);
+	  if (!tmp)
+	    return FALSE;
+	  g_string_append_len (outstr, tmp, tmp_len);
+	  g_free (tmp);
+	}
+      else
+#endif
+	{
+	  g_string_append (outstr, name);
+	}
+      break;
+    case 'A':
+      name = WEEKDAY_FULL (datetime);
+#if !defined (HAVE_LANGINFO_TIME)
+      if (!locale_is_utf8)
+	{
+	  tmp = g_locale_from_utf8 (name, -1, NULL, &tmp_len, NULL);
+	  if (!tmp)
+	    return FALSE;
+	  g_string_append_len (outstr, tmp, tmp_len);
+	  g_free (tmp);
+	}
+      else
+#endif
+	{
+	  g_string_append (outstr, name);
+	}
+      break;
+    case 'b':
+      name = MONTH_ABBR (datetime);
+#if !defined (HAVE_LANGINFO_TIME)
+      if (!locale_is_utf8)
+	{
+	  tmp = g_locale_from_utf8 (name, -1, NULL, &tmp_len, NULL);
+	  if (!tmp)
+	    return FALSE;
+	  g_string_append_len (outstr, tmp, tmp_len);
+	  g_free (tmp);
+	}
+      else
+#endif
+	{
+	  g_string_append (outstr, name);
+	}
+      break;
+    case 'B':
+      name = MONTH_FULL (datetime);
+#if !defined (HAVE_LANGINFO_TIME)
+      if (!locale_is_utf8)
+	{
+	  tmp = g_locale_from_utf8 (name, -1, NULL, &tmp_len, NULL);
+	  if (!tmp)
+	    return FALSE;
+	  g_string_append_len (outstr, tmp, tmp_len);
+	  g_free (tmp);
+	}
+      else
+#endif
+	{
+	  g_string_append (outstr, name);
+	}
+      break;
+    case 'c':
+      {
+	if (!g_date_time_locale_format_locale (datetime, PREFERRED_DATE_TIME_FMT,
+					       outstr, locale_is_utf8))
+	  return FALSE;
+      }
+      break;
+    case 'C':
+      format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
+		     g_date_time_get_year (datetime) / 100);
+      break;
+    case 'd':
+      format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
+		     g_date_time_get_day_of_month (datetime));
+      break;
+    case 'e':
+      format_number (outstr, alt_digits, pad_set ? pad : " ", 2,
+		     g_date_time_get_day_of_month (datetime));
+      break;
+    case 'F':
+      g_string_append_printf (outstr, "%d-%02d-%02d",
+			      g_date_time_get_year (datetime),
+			      g_date_time_get_month (datetime),
+			      g_date_time_get_day_of_month (datetime));
+      break;
+    case 'g':
+      format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
+		     g_date_time_get_week_numbering_year (datetime) % 100);
+      break;
+    case 'G':
+      format_number (outstr, alt_digits, pad_set ? pad : 0, 0,
+		     g_date_time_get_week_numbering_year (datetime));
+      break;
+    case 'h':
+      name = MONTH_ABBR (datetime);
+#if !defined (HAVE_LANGINFO_TIME)
+      if (!locale_is_utf8)
+	{
+	  tmp = g_locale_from_utf8 (name, -1, NULL, &tmp_len, NULL);
+	  if (!tmp)
+	    return FALSE;
+	  g_string_append_len (outstr, tmp, tmp_len);
+	  g_free (tmp);
+	}
+      else
+#endif
+	{
+	  g_string_append (outstr, name);
+	}
+      break;
+    case 'H':
+      format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
+		     g_date_time_get_hour (datetime));
+      break;
+    case 'I':
+      format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
+		     (g_date_time_get_hour (datetime) + 11) % 12 + 1);
+      break;
+    case 'j':
+      format_number (outstr, alt_digits, pad_set ? pad : "0", 3,
+		     g_date_time_get_day_of_year (datetime));
+      break;
+    case 'k':
+      format_number (outstr, alt_digits, pad_set ? pad : " ", 2,
+		     g_date_time_get_hour (datetime));
+      break;
+    case 'l':
+      format_number (outstr, alt_digits, pad_set ? pad : " ", 2,
+		     (g_date_time_get_hour (datetime) + 11) % 12 + 1);
+      break;
+    case 'n':
+      g_string_append_c (outstr, '\n');
+      break;
+    case 'm':
+      format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
+		     g_date_time_get_month (datetime));
+      break;
+    case 'M':
+      format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
+		     g_date_time_get_minute (datetime));
+      break;
+    case 'p':
+      ampm = (gchar *) GET_AMPM (datetime);
+#if defined (HAVE_LANGINFO_TIME)
+      if (!locale_is_utf8)
+	{
+	  /* This assumes that locale encoding can't have embedded NULs */
+	  ampm = tmp = g_locale_to_utf8 (ampm, -1, NULL, NULL, NULL);
+	  if (!tmp)
+	    return FALSE;
+	}
+#endif
+      ampm = g_utf8_strup (ampm, -1);
+      tmp_len = strlen (ampm);
+      if (!locale_is_utf8)
+	{
+#if defined (HAVE_LANGINFO_TIME)
+	  g_free (tmp);
+#endif
+	  tmp = g_locale_from_utf8 (ampm, -1, NULL, &tmp_len, NULL);
+	  g_free (ampm);
+	  if (!tmp)
+	    return FALSE;
+	  ampm = tmp;
+	}
+      g_string_append_len (outstr, ampm, tmp_len);
+      g_free (ampm);
+      break;
+    case 'P':
+      ampm = (gchar *) GET_AMPM (datetime);
+#if defined (HAVE_LANGINFO_TIME)
+      if (!locale_is_utf8)
+	{
+	  /* This assumes that locale encoding can't have embedded NULs */
+	  ampm = tmp = g_locale_to_utf8 (ampm, -1, NULL, NULL, NULL);
+	  if (!tmp)
+	    return FALSE;
+	}
+#endif
+      ampm = g_utf8_strdown (ampm, -1);
+      tmp_len = strlen (ampm);
+      if (!locale_is_utf8)
+	{
+#if defined (HAVE_LANGINFO_TIME)
+	  g_free (tmp);
+#endif
+	  tmp = g_locale_from_utf8 (ampm, -1, NULL, &tmp_len, NULL);
+	  g_free (ampm);
+	  if (!tmp)
+	    return FALSE;
+	  ampm = tmp;
+	}
+      g_string_append_len (outstr, ampm, tmp_len);
+      g_free (ampm);
+      break;
+    case 'r':
+      {
+	if (!g_date_time_locale_format_locale (datetime, PREFERRED_12HR_TIME_FMT,
+					       outstr, locale_is_utf8))
+	  return FALSE;
+      }
+      break;
+    case 'R':
+      g_string_append_printf (outstr, "%02d:%02d",
+			      g_date_time_get_hour (datetime),
+			      g_date_time_get_minute (datetime));
+      break;
+    case 's':
+      g_string_append_printf (outstr, "%" G_GINT64_FORMAT, g_date_time_to_unix (datetime));
+      break;
+    case 'S':
+      format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
+		     g_date_time_get_second (datetime));
+      break;
+    case 't':
+      g_string_append_c (outstr, '\t');
+      break;
+    case 'T':
+      g_string_append_printf (outstr, "%02d:%02d:%02d",
+			      g_date_time_get_hour (datetime),
+			      g_date_time_get_minute (datetime),
+			      g_date_time_get_second (datetime));
+      break;
+    case 'u':
+      format_number (outstr, alt_digits, 0, 0,
+		     g_date_time_get_day_of_week (datetime));
+      break;
+    case 'V':
+      format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
+		     g_date_time_get_week_of_year (datetime));
+      break;
+    case 'w':
+      format_number (outstr, alt_digits, 0, 0,
+		     g_date_time_get_day_of_week (datetime) % 7);
+      break;
+    case 'x':
+      {
+	if (!g_date_time_locale_format_locale (datetime, PREFERRED_DATE_FMT,
+					       outstr, locale_is_utf8))
+	  return FALSE;
+      }
+      break;
+    case 'X':
+      {
+	if (!g_date_time_locale_format_locale (datetime, PREFERRED_TIME_FMT,
+					       outstr, locale_is_utf8))
+	  return FALSE;
+      }
+      break;
+    case 'y':
+      format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
+		     g_date_time_get_year (datetime) % 100);
+      break;
+    case 'Y':
+      format_number (outstr, alt_digits, 0, 0,
+		     g_date_time_get_year (datetime));
+      break;
+    case 'z':
+      {
+	gint64 offset;
+	if (datetime->tz != NULL)
+	  offset = g_date_time_get_utc_offset (datetime) / USEC_PER_SECOND;
+	else
+	  offset = 0;
+	if (!format_z (outstr, (int) offset, colons))
+	  return FALSE;
+      }
+      break;
+    case 'Z':
+      tz = g_date_time_get_timezone_abbreviation (datetime);
+      tmp_len = strlen (tz);
+      if (!locale_is_utf8)
+	{
+	  tz = tmp = g_locale_from_utf8 (tz, -1, NULL, &tmp_len, NULL);
+	  if (!tmp)
+	    return FALSE;
+	}
+      g_string_append_len (outstr, tz, tmp_len);
+      if (!locale_is_utf8)
+	g_free (tmp);
+      break;
+    case '%':
+      g_string_append_c (outstr, '%');
+      break;
+    default:
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 /* g_date_time_format() subroutine that takes a UTF-8 format
  * string and produces a locale-encoded date/time string.
  */
@@ -2236,17 +2611,10 @@ g_date_time_format_locale (GDateTime   *datetime,
 			   GString     *outstr,
 			   gboolean     locale_is_utf8)
 {
-  guint     len;
-  guint     colons;
-  gchar    *tmp;
-  gsize     tmp_len;
-  gunichar  c;
-  gboolean  alt_digits = FALSE;
-  gboolean  pad_set = FALSE;
-  gchar    *pad = "";
-  gchar    *ampm;
-  const gchar *name;
-  const gchar *tz;
+  guint       len;
+  gchar      *tmp;
+  gsize       tmp_len;
+  Conversion  conv;
 
   while (*format)
     {
@@ -2274,331 +2642,9 @@ g_date_time_format_locale (GDateTime   *datetime,
       if (!*format)
 	break;
 
-      colons = 0;
-      alt_digits = FALSE;
-      pad_set = FALSE;
-
-    next_mod:
-      c = g_utf8_get_char (format);
-      format = g_utf8_next_char (format);
-      switch (c)
-	{
-	case 'a':
-	  name = WEEKDAY_ABBR (datetime);
-#if !defined (HAVE_LANGINFO_TIME)
-	  if (!locale_is_utf8)
-	    {
-	      tmp = g_locale_from_utf8 (name, -1, NULL, &tmp_len, NULL);
-	      if (!tmp)
-		return FALSE;
-	      g_string_append_len (outstr, tmp, tmp_len);
-	      g_free (tmp);
-	    }
-	  else
-#endif
-	    {
-	      g_string_append (outstr, name);
-	    }
-	  break;
-	case 'A':
-	  name = WEEKDAY_FULL (datetime);
-#if !defined (HAVE_LANGINFO_TIME)
-	  if (!locale_is_utf8)
-	    {
-	      tmp = g_locale_from_utf8 (name, -1, NULL, &tmp_len, NULL);
-	      if (!tmp)
-		return FALSE;
-	      g_string_append_len (outstr, tmp, tmp_len);
-	      g_free (tmp);
-	    }
-	  else
-#endif
-	    {
-	      g_string_append (outstr, name);
-	    }
-	  break;
-	case 'b':
-	  name = MONTH_ABBR (datetime);
-#if !defined (HAVE_LANGINFO_TIME)
-	  if (!locale_is_utf8)
-	    {
-	      tmp = g_locale_from_utf8 (name, -1, NULL, &tmp_len, NULL);
-	      if (!tmp)
-		return FALSE;
-	      g_string_append_len (outstr, tmp, tmp_len);
-	      g_free (tmp);
-	    }
-	  else
-#endif
-	    {
-	      g_string_append (outstr, name);
-	    }
-	  break;
-	case 'B':
-	  name = MONTH_FULL (datetime);
-#if !defined (HAVE_LANGINFO_TIME)
-	  if (!locale_is_utf8)
-	    {
-	      tmp = g_locale_from_utf8 (name, -1, NULL, &tmp_len, NULL);
-	      if (!tmp)
-		return FALSE;
-	      g_string_append_len (outstr, tmp, tmp_len);
-	      g_free (tmp);
-	    }
-	  else
-#endif
-	    {
-	      g_string_append (outstr, name);
-	    }
-	  break;
-	case 'c':
-	  {
-	    if (!g_date_time_locale_format_locale (datetime, PREFERRED_DATE_TIME_FMT,
-						   outstr, locale_is_utf8))
-	      return FALSE;
-	  }
-	  break;
-	case 'C':
-	  format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
-			 g_date_time_get_year (datetime) / 100);
-	  break;
-	case 'd':
-	  format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
-			 g_date_time_get_day_of_month (datetime));
-	  break;
-	case 'e':
-	  format_number (outstr, alt_digits, pad_set ? pad : " ", 2,
-			 g_date_time_get_day_of_month (datetime));
-	  break;
-	case 'F':
-	  g_string_append_printf (outstr, "%d-%02d-%02d",
-				  g_date_time_get_year (datetime),
-				  g_date_time_get_month (datetime),
-				  g_date_time_get_day_of_month (datetime));
-	  break;
-	case 'g':
-	  format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
-			 g_date_time_get_week_numbering_year (datetime) % 100);
-	  break;
-	case 'G':
-	  format_number (outstr, alt_digits, pad_set ? pad : 0, 0,
-			 g_date_time_get_week_numbering_year (datetime));
-	  break;
-	case 'h':
-	  name = MONTH_ABBR (datetime);
-#if !defined (HAVE_LANGINFO_TIME)
-	  if (!locale_is_utf8)
-	    {
-	      tmp = g_locale_from_utf8 (name, -1, NULL, &tmp_len, NULL);
-	      if (!tmp)
-		return FALSE;
-	      g_string_append_len (outstr, tmp, tmp_len);
-	      g_free (tmp);
-	    }
-	  else
-#endif
-	    {
-	      g_string_append (outstr, name);
-	    }
-	  break;
-	case 'H':
-	  format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
-			 g_date_time_get_hour (datetime));
-	  break;
-	case 'I':
-	  format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
-			 (g_date_time_get_hour (datetime) + 11) % 12 + 1);
-	  break;
-	case 'j':
-	  format_number (outstr, alt_digits, pad_set ? pad : "0", 3,
-			 g_date_time_get_day_of_year (datetime));
-	  break;
-	case 'k':
-	  format_number (outstr, alt_digits, pad_set ? pad : " ", 2,
-			 g_date_time_get_hour (datetime));
-	  break;
-	case 'l':
-	  format_number (outstr, alt_digits, pad_set ? pad : " ", 2,
-			 (g_date_time_get_hour (datetime) + 11) % 12 + 1);
-	  break;
-	case 'n':
-	  g_string_append_c (outstr, '\n');
-	  break;
-	case 'm':
-	  format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
-			 g_date_time_get_month (datetime));
-	  break;
-	case 'M':
-	  format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
-			 g_date_time_get_minute (datetime));
-	  break;
-	case 'O':
-	  alt_digits = TRUE;
-	  goto next_mod;
-	case 'p':
-	  ampm = (gchar *) GET_AMPM (datetime);
-#if defined (HAVE_LANGINFO_TIME)
-	  if (!locale_is_utf8)
-	    {
-	      /* This assumes that locale encoding can't have embedded NULs */
-	      ampm = tmp = g_locale_to_utf8 (ampm, -1, NULL, NULL, NULL);
-	      if (!tmp)
-		return FALSE;
-	    }
-#endif
-	  ampm = g_utf8_strup (ampm, -1);
-	  tmp_len = strlen (ampm);
-	  if (!locale_is_utf8)
-	    {
-#if defined (HAVE_LANGINFO_TIME)
-	      g_free (tmp);
-#endif
-	      tmp = g_locale_from_utf8 (ampm, -1, NULL, &tmp_len, NULL);
-	      g_free (ampm);
-	      if (!tmp)
-		return FALSE;
-	      ampm = tmp;
-	    }
-	  g_string_append_len (outstr, ampm, tmp_len);
-	  g_free (ampm);
-	  break;
-	case 'P':
-	  ampm = (gchar *) GET_AMPM (datetime);
-#if defined (HAVE_LANGINFO_TIME)
-	  if (!locale_is_utf8)
-	    {
-	      /* This assumes that locale encoding can't have embedded NULs */
-	      ampm = tmp = g_locale_to_utf8 (ampm, -1, NULL, NULL, NULL);
-	      if (!tmp)
-		return FALSE;
-	    }
-#endif
-	  ampm = g_utf8_strdown (ampm, -1);
-	  tmp_len = strlen (ampm);
-	  if (!locale_is_utf8)
-	    {
-#if defined (HAVE_LANGINFO_TIME)
-	      g_free (tmp);
-#endif
-	      tmp = g_locale_from_utf8 (ampm, -1, NULL, &tmp_len, NULL);
-	      g_free (ampm);
-	      if (!tmp)
-		return FALSE;
-	      ampm = tmp;
-	    }
-	  g_string_append_len (outstr, ampm, tmp_len);
-	  g_free (ampm);
-	  break;
-	case 'r':
-	  {
-	    if (!g_date_time_locale_format_locale (datetime, PREFERRED_12HR_TIME_FMT,
-						   outstr, locale_is_utf8))
-	      return FALSE;
-	  }
-	  break;
-	case 'R':
-	  g_string_append_printf (outstr, "%02d:%02d",
-				  g_date_time_get_hour (datetime),
-				  g_date_time_get_minute (datetime));
-	  break;
-	case 's':
-	  g_string_append_printf (outstr, "%" G_GINT64_FORMAT, g_date_time_to_unix (datetime));
-	  break;
-	case 'S':
-	  format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
-			 g_date_time_get_second (datetime));
-	  break;
-	case 't':
-	  g_string_append_c (outstr, '\t');
-	  break;
-	case 'T':
-	  g_string_append_printf (outstr, "%02d:%02d:%02d",
-				  g_date_time_get_hour (datetime),
-				  g_date_time_get_minute (datetime),
-				  g_date_time_get_second (datetime));
-	  break;
-	case 'u':
-	  format_number (outstr, alt_digits, 0, 0,
-			 g_date_time_get_day_of_week (datetime));
-	  break;
-	case 'V':
-	  format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
-			 g_date_time_get_week_of_year (datetime));
-	  break;
-	case 'w':
-	  format_number (outstr, alt_digits, 0, 0,
-			 g_date_time_get_day_of_week (datetime) % 7);
-	  break;
-	case 'x':
-	  {
-	    if (!g_date_time_locale_format_locale (datetime, PREFERRED_DATE_FMT,
-						   outstr, locale_is_utf8))
-	      return FALSE;
-	  }
-	  break;
-	case 'X':
-	  {
-	    if (!g_date_time_locale_format_locale (datetime, PREFERRED_TIME_FMT,
-						   outstr, locale_is_utf8))
-	      return FALSE;
-	  }
-	  break;
-	case 'y':
-	  format_number (outstr, alt_digits, pad_set ? pad : "0", 2,
-			 g_date_time_get_year (datetime) % 100);
-	  break;
-	case 'Y':
-	  format_number (outstr, alt_digits, 0, 0,
-			 g_date_time_get_year (datetime));
-	  break;
-	case 'z':
-	  {
-	    gint64 offset;
-	    if (datetime->tz != NULL)
-	      offset = g_date_time_get_utc_offset (datetime) / USEC_PER_SECOND;
-	    else
-	      offset = 0;
-	    if (!format_z (outstr, (int) offset, colons))
-	      return FALSE;
-	  }
-	  break;
-	case 'Z':
-	  tz = g_date_time_get_timezone_abbreviation (datetime);
-	  tmp_len = strlen (tz);
-	  if (!locale_is_utf8)
-	    {
-	      tz = tmp = g_locale_from_utf8 (tz, -1, NULL, &tmp_len, NULL);
-	      if (!tmp)
-		return FALSE;
-	    }
-	  g_string_append_len (outstr, tz, tmp_len);
-	  if (!locale_is_utf8)
-	    g_free (tmp);
-	  break;
-	case '%':
-	  g_string_append_c (outstr, '%');
-	  break;
-	case '-':
-	  pad_set = TRUE;
-	  pad = "";
-	  goto next_mod;
-	case '_':
-	  pad_set = TRUE;
-	  pad = " ";
-	  goto next_mod;
-	case '0':
-	  pad_set = TRUE;
-	  pad = "0";
-	  goto next_mod;
-	case ':':
-	  /* Colons are only allowed before 'z' */
-	  if (*format && *format != 'z' && *format != ':')
-	    return FALSE;
-	  colons++;
-	  goto next_mod;
-	default:
-	  return FALSE;
-	}
+      if (!parse_conversion (&format, &conv) ||
+          !format_conversion (datetime, &conv, outstr, locale_is_utf8))
+        return FALSE;
     }
 
   return TRUE;
@@ -2732,5 +2778,339 @@ g_date_time_format (GDateTime   *datetime,
 }
 
 
+/* Formatter {{{1 */
+
+typedef struct
+{
+  const gchar *literal;     /* NULL for a conversion */
+  gsize        literal_len;
+  Conversion   conv;
+} FormatItem;
+
+/**
+ * GDateTimeFormatter:
+ *
+ * A format for g_date_time_format(), parsed once to be applied to
+ * many #GDateTime values. It is created with g_date_time_formatter_new().
+ *
+ * Since: 2.54
+ */
+struct _GDateTimeFormatter
+{
+  gint        ref_count;
+  guint       serial;
+  gboolean    uses_zone_name;
+  gchar      *format;
+  FormatItem *items;
+  guint       n_items;
+};
+
+/* The output for the last second that a formatter formatted in this
+ * thread, keyed on everything that output depends on
+ */
+typedef struct
+{
+  guint    serial;
+  gboolean locale_is_utf8;
+  gint64   second;
+  gint64   utc_offset;
+  gchar   *zone_name;
+  GString *output;
+} FormatterCache;
+
+static void
+formatter_cache_free (gpointer data)
+{
+  FormatterCache *cache = data;
+
+  g_free (cache->zone_name);
+  g_string_free (cache->output, TRUE);
+  g_slice_free (FormatterCache, cache);
+}
+
+static GPrivate formatter_cache = G_PRIVATE_INIT (formatter_cache_free);
+
+static gboolean
+g_date_time_formatter_format_locale (GDateTimeFormatter *formatter,
+                                     GDateTime          *datetime,
+                                     GString            *outstr,
+                                     gboolean            locale_is_utf8)
+{
+  gchar *tmp;
+  gsize tmp_len;
+  guint i;
+
+  for (i = 0; i < formatter->n_items; i++)
+    {
+      const FormatItem *item = &formatter->items[i];
+
+      if (item->literal == NULL)
+        {
+          if (!format_conversion (datetime, &item->conv, outstr, locale_is_utf8))
+            return FALSE;
+        }
+      else if (locale_is_utf8)
+        g_string_append_len (outstr, item->literal, item->literal_len);
+      else
+        {
+          tmp = g_locale_from_utf8 (item->literal, item->literal_len, NULL, &tmp_len, NULL);
+          if (!tmp)
+            return FALSE;
+          g_string_append_len (outstr, tmp, tmp_len);
+          g_free (tmp);
+        }
+    }
+
+  return TRUE;
+}
+
+/**
+ * g_date_time_formatter_new:
+ * @format: a valid UTF-8 string, containing a format as understood by
+ *          g_date_time_format()
+ *
+ * Parses @format for formatting many #GDateTime values with
+ * g_date_time_formatter_format() or g_date_time_formatter_append(),
+ * without parsing it again each time.
+ *
+ * Returns: (transfer full) (nullable): a new #GDateTimeFormatter, or
+ *     %NULL if @format is not a valid format
+ *
+ * Since: 2.54
+ */
+GDateTimeFormatter *
+g_date_time_formatter_new (const gchar *format)
+{
+  static guint serial;
+  GDateTimeFormatter *formatter;
+  GArray *items;
+  FormatItem item;
+  const gchar *p;
+  GDateTime *epoch;
+  GString *test;
+  gboolean valid;
+  gsize len;
+
+  g_return_val_if_fail (format != NULL, NULL);
+  g_return_val_if_fail (g_utf8_validate (format, -1, NULL), NULL);
+
+  formatter = g_slice_new0 (GDateTimeFormatter);
+  formatter->ref_count = 1;
+  formatter->serial = g_atomic_int_add (&serial, 1) + 1;
+  formatter->format = g_strdup (format);
+
+  items = g_array_new (FALSE, FALSE, sizeof (FormatItem));
+  valid = TRUE;
+  p = formatter->format;
+  while (*p && valid)
+    {
+      len = strcspn (p, "%");
+      if (len)
+        {
+          item.literal = p;
+          item.literal_len = len;
+          g_array_append_val (items, item);
+        }
+
+      p += len;
+      if (!*p || !*++p)
+        break;
+
+      item.literal = NULL;
+      valid = parse_conversion (&p, &item.conv);
+      if (strchr ("crxXZ", item.conv.c) != NULL)
+        formatter->uses_zone_name = TRUE;
+      g_array_append_val (items, item);
+    }
+
+  formatter->n_items = items->len;
+  formatter->items = (FormatItem *) g_array_free (items, FALSE);
+
+  /* which conversions exist is known to format_conversion() */
+  if (valid)
+    {
+      epoch = g_date_time_new_from_unix_utc (0);
+      test = g_string_new (NULL);
+      valid = g_date_time_formatter_format_locale (formatter, epoch, test, TRUE);
+      g_string_free (test, TRUE);
+      g_date_time_unref (epoch);
+    }
+
+  if (!valid)
+    {
+      g_date_time_formatter_unref (formatter);
+      return NULL;
+    }
+
+  return formatter;
+}
+
+/**
+ * g_date_time_formatter_ref:
+ * @formatter: a #GDateTimeFormatter
+ *
+ * Atomically increments the reference count of @formatter by one.
+ *
+ * Returns: the #GDateTimeFormatter with the reference count increased
+ *
+ * Since: 2.54
+ */
+GDateTimeFormatter *
+g_date_time_formatter_ref (GDateTimeFormatter *formatter)
+{
+  g_return_val_if_fail (formatter != NULL, NULL);
+
+  g_atomic_int_inc (&formatter->ref_count);
+
+  return formatter;
+}
+
+/**
+ * g_date_time_formatter_unref:
+ * @formatter: a #GDateTimeFormatter
+ *
+ * Atomically decrements the reference count of @formatter by one.
+ * When the reference count drops to 0, it is freed.
+ *
+ * Since: 2.54
+ */
+void
+g_date_time_formatter_unref (GDateTimeFormatter *formatter)
+{
+  g_return_if_fail (formatter != NULL);
+
+  if (g_atomic_int_dec_and_test (&formatter->ref_count))
+    {
+      g_free (formatter->items);
+      g_free (formatter->format);
+      g_slice_free (GDateTimeFormatter, formatter);
+    }
+}
+
+/* Returns the UTF-8 output of @formatter for @datetime, from the
+ * cache of the thread when the second is the same as last time
+ */
+static const GString *
+g_date_time_formatter_lookup (GDateTimeFormatter *formatter,
+                              GDateTime          *datetime)
+{
+  FormatterCache *cache;
+  gboolean locale_is_utf8 = g_get_charset (NULL);
+  const gchar *zone_name = NULL;
+  gint64 second, utc_offset;
+  gchar *utf8;
+
+  second = g_date_time_to_unix (datetime);
+  utc_offset = g_date_time_get_utc_offset (datetime);
+  if (formatter->uses_zone_name)
+    zone_name = g_date_time_get_timezone_abbreviation (datetime);
+
+  cache = g_private_get (&formatter_cache);
+  if (cache == NULL)
+    {
+      cache = g_slice_new0 (FormatterCache);
+      cache->output = g_string_new (NULL);
+      g_private_set (&formatter_cache, cache);
+    }
+  else if (cache->serial == formatter->serial &&
+           cache->locale_is_utf8 == locale_is_utf8 &&
+           cache->second == second &&
+           cache->utc_offset == utc_offset &&
+           g_strcmp0 (cache->zone_name, zone_name) == 0)
+    return cache->output;
+
+  cache->serial = 0;
+  g_string_truncate (cache->output, 0);
+  if (!g_date_time_formatter_format_locale (formatter, datetime,
+                                            cache->output, locale_is_utf8))
+    return NULL;
+
+  if (!locale_is_utf8)
+    {
+      utf8 = g_locale_to_utf8 (cache->output->str, cache->output->len, NULL, NULL, NULL);
+      if (utf8 == NULL)
+        return NULL;
+      g_string_assign (cache->output, utf8);
+      g_free (utf8);
+    }
+
+  cache->serial = formatter->serial;
+  cache->locale_is_utf8 = locale_is_utf8;
+  cache->second = second;
+  cache->utc_offset = utc_offset;
+  g_free (cache->zone_name);
+  cache->zone_name = g_strdup (zone_name);
+
+  return cache->output;
+}
+
+/**
+ * g_date_time_formatter_format:
+ * @formatter: a #GDateTimeFormatter
+ * @datetime: A #GDateTime
+ *
+ * Formats @datetime in the same way as g_date_time_format() does with
+ * the format @formatter was created for.
+ *
+ * Since formats have no conversions for fractions of a second, each
+ * thread keeps the output for the last second it formatted, and
+ * returns a copy of it for other #GDateTime values in that second.
+ * This makes formatting many timestamps, as for logging, much cheaper.
+ *
+ * Returns: a newly allocated string, or %NULL in the case that there
+ *     was an error. The string should be freed with g_free().
+ *
+ * Since: 2.54
+ */
+gchar *
+g_date_time_formatter_format (GDateTimeFormatter *formatter,
+                              GDateTime          *datetime)
+{
+  const GString *output;
+
+  g_return_val_if_fail (formatter != NULL, NULL);
+  g_return_val_if_fail (datetime != NULL, NULL);
+
+  output = g_date_time_formatter_lookup (formatter, datetime);
+  if (output == NULL)
+    return NULL;
+
+  return g_strndup (output->str, output->len);
+}
+
+/**
+ * g_date_time_formatter_append:
+ * @formatter: a #GDateTimeFormatter
+ * @datetime: A #GDateTime
+ * @string: a #GString
+ *
+ * Like g_date_time_formatter_format(), but appends the output to
+ * @string instead of allocating a new string.
+ *
+ * Returns: %TRUE on success, or %FALSE in the case that there was an
+ *     error, in which case @string is left unchanged
+ *
+ * Since: 2.54
+ */
+gboolean
+g_date_time_formatter_append (GDateTimeFormatter *formatter,
+                              GDateTime          *datetime,
+                              GString            *string)
+{
+  const GString *output;
+
+  g_return_val_if_fail (formatter != NULL, FALSE);
+  g_return_val_if_fail (datetime != NULL, FALSE);
+  g_return_val_if_fail (string != NULL, FALSE);
+
+  output = g_date_time_formatter_lookup (formatter, datetime);
+  if (output == NULL)
+    return FALSE;
+
+  g_string_append_len (string, output->str, output->len);
+
+  return TRUE;
+}
+
 /* Epilogue {{{1 */
 /* vim:set foldmethod=marker: */
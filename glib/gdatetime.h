@@ -28,6 +28,7 @@
 #error "Only <glib.h> can be included directly."
 #endif
 
+#include <glib/gstring.h>
 #include <glib/gtimezone.h>
 
 G_BEGIN_DECLS
@@ -257,6 +258,22 @@ GLIB_AVAILABLE_IN_ALL
 gchar *                 g_date_time_format                              (GDateTime      *datetime,
                                                                          const gchar    *format) G_GNUC_MALLOC;
 
+typedef struct _GDateTimeFormatter GDateTimeFormatter;
+
+GLIB_AVAILABLE_IN_2_54
+GDateTimeFormatter *    g_date_time_formatter_new                       (const gchar        *format);
+GLIB_AVAILABLE_IN_2_54
+GDateTimeFormatter *    g_date_time_formatter_ref                       (GDateTimeFormatter *formatter);
+GLIB_AVAILABLE_IN_2_54
+void                    g_date_time_formatter_unref                     (GDateTimeFormatter *formatter);
+GLIB_AVAILABLE_IN_2_54
+gchar *                 g_date_time_formatter_format                    (GDateTimeFormatter *formatter,
+                                                                         GDateTime          *datetime) G_GNUC_MALLOC;
+GLIB_AVAILABLE_IN_2_54
+gboolean                g_date_time_formatter_append                    (GDateTimeFormatter *formatter,
+                                                                         GDateTime          *datetime,
+                                                                         GString            *string);
+
 G_END_DECLS
 
 #endif /* __G_DATE_TIME_H__ */
@@ -0,0 +1,420 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * MT safe
+ */
+
+#include "config.h"
+
+#include "gepoch.h"
+
+#include "gatomic.h"
+#include "gmem.h"
+#include "gmessages.h"
+#include "gslice.h"
+#include "gthread.h"
+
+/**
+ * SECTION:epoch
+ * @title: Epoch-Based Reclamation
+ * @short_description: freeing memory that other threads may still read
+ * @see_also: #GBoundedQueue
+ *
+ * Data structures that threads read without taking a lock cannot free
+ * an element as soon as it has been removed, since another thread may
+ * have found it just before and still be looking at it. The functions
+ * in this section solve this by deferring the free until every thread
+ * that could have seen the element is done.
+ *
+ * Readers wrap their accesses to the shared structure between
+ * g_epoch_enter() and g_epoch_leave(). Pointers read from the structure
+ * stay valid until g_epoch_leave() is called, and must not be used
+ * afterwards. Critical sections can be nested, and should be short:
+ * they must not block, since a thread inside a critical section holds
+ * up the reclamation of everything retired in the meantime.
+ *
+ * A writer that has unlinked an element, so that no new reader can find
+ * it, passes it to g_epoch_retire() instead of freeing it. The notify
+ * function is called later, from a thread that calls g_epoch_retire()
+ * or g_epoch_synchronize(), once all critical sections that were
+ * running when the element was retired have ended.
+ *
+ * |[<!-- language="C" -->
+ *   // Reader
+ *   g_epoch_enter ();
+ *   config = g_atomic_pointer_get (&current_config);
+ *   use_config (config);
+ *   g_epoch_leave ();
+ *
+ *   // Writer
+ *   old_config = g_atomic_pointer_get (&current_config);
+ *   g_atomic_pointer_set (&current_config, new_config);
+ *   g_epoch_retire (old_config, (GDestroyNotify) config_free);
+ * ]|
+ *
+ * Threads do not need to register: a thread is registered on its first
+ * call, and unregistered when it exits. Anything it retired that could
+ * not be freed yet is then freed by another thread.
+ *
+ * The implementation is a global epoch counter: a thread records the
+ * epoch it entered in, and the epoch is only advanced once all threads
+ * inside a critical section have entered in the current one. Anything
+ * retired in an epoch can be freed after two more advances. Entering
+ * and leaving cost an atomic operation each and never wait.
+ */
+
+/* Epochs advance in steps of 2, so that the low bit of a thread's
+ * state can mark it as inside a critical section.  Counters wrap
+ * around, so they are only ever compared by difference.
+ */
+#define EPOCH_ACTIVE            1
+#define EPOCH_STEP              2
+#define EPOCH_GRACE             (2 * EPOCH_STEP)
+
+/* How many elements a thread retires before it tries to advance the
+ * epoch and free some of them.
+ */
+#define EPOCH_RECLAIM_THRESHOLD 64
+
+typedef struct _EpochRetired EpochRetired;
+typedef struct _EpochThread EpochThread;
+
+struct _EpochRetired
+{
+  gpointer       data;
+  GDestroyNotify notify;
+  guint          epoch;
+  EpochRetired  *next;
+};
+
+struct _EpochThread
+{
+  volatile gint state;          /* 0 outside, epoch | EPOCH_ACTIVE inside */
+  volatile gint in_use;
+  guint         depth;
+  guint         n_retired;
+  EpochRetired *retired;
+  EpochRetired *retired_tail;
+  EpochThread  *next;           /* never changes once on the list */
+};
+
+static void epoch_thread_release (gpointer data);
+
+static volatile gint  epoch_global = 0;
+static EpochThread   *epoch_threads = NULL;  /* atomic, records are never freed */
+static GPrivate       epoch_thread_private = G_PRIVATE_INIT (epoch_thread_release);
+
+/* Retired elements of threads that have exited */
+G_LOCK_DEFINE_STATIC (epoch_orphans);
+static EpochRetired  *epoch_orphans = NULL;
+
+static EpochThread *
+epoch_thread_get (void)
+{
+  EpochThread *thread;
+
+  thread = g_private_get (&epoch_thread_private);
+  if G_LIKELY (thread != NULL)
+    return thread;
+
+  /* Reuse the record of a thread that has exited, if any */
+  for (thread = g_atomic_pointer_get (&epoch_threads); thread; thread = thread->next)
+    if (g_atomic_int_get (&thread->in_use) == 0 &&
+        g_atomic_int_compare_and_exchange (&thread->in_use, 0, 1))
+      break;
+
+  if (thread == NULL)
+    {
+      thread = g_new0 (EpochThread, 1);
+      thread->in_use = 1;
+      do
+        thread->next = g_atomic_pointer_get (&epoch_threads);
+      while (!g_atomic_pointer_compare_and_exchange (&epoch_threads, thread->next, thread));
+    }
+
+  g_private_set (&epoch_thread_private, thread);
+
+  return thread;
+}
+
+/* Advances the global epoch if no thread is in a critical section that
+ * it entered in an earlier epoch.  Returns whether it moved.
+ */
+static gboolean
+epoch_try_advance (void)
+{
+  EpochThread *thread;
+  gint epoch;
+
+  epoch = g_atomic_int_get (&epoch_global);
+
+  for (thread = g_atomic_pointer_get (&epoch_threads); thread; thread = thread->next)
+    {
+      gint state = g_atomic_int_get (&thread->state);
+
+      if ((state & EPOCH_ACTIVE) && state != (epoch | EPOCH_ACTIVE))
+        return FALSE;
+    }
+
+  return g_atomic_int_compare_and_exchange (&epoch_global, epoch,
+                                            (gint) ((guint) epoch + EPOCH_STEP));
+}
+
+static inline gboolean
+epoch_expired (const EpochRetired *retired,
+               guint               epoch)
+{
+  return epoch - retired->epoch >= EPOCH_GRACE;
+}
+
+static void
+epoch_free_list (EpochRetired *list)
+{
+  while (list)
+    {
+      EpochRetired *next = list->next;
+
+      list->notify (list->data);
+      g_slice_free (EpochRetired, list);
+      list = next;
+    }
+}
+
+/* Frees what the calling thread retired long enough ago.  Its list is
+ * in retirement order, so the expired elements are a prefix of it.
+ * They are unlinked before any notify function runs, since one may
+ * retire more elements.
+ */
+static void
+epoch_reclaim_thread (EpochThread *thread)
+{
+  EpochRetired *expired, *last = NULL, *retired;
+  guint epoch;
+
+  epoch = g_atomic_int_get (&epoch_global);
+
+  for (retired = thread->retired; retired && epoch_expired (retired, epoch); retired = retired->next)
+    {
+      last = retired;
+      thread->n_retired--;
+    }
+
+  if (last == NULL)
+    return;
+
+  expired = thread->retired;
+  thread->retired = last->next;
+  if (thread->retired == NULL)
+    thread->retired_tail = NULL;
+  last->next = NULL;
+
+  epoch_free_list (expired);
+}
+
+/* The orphans come from several threads, so they are not sorted */
+static void
+epoch_reclaim_orphans (gboolean wait)
+{
+  EpochRetired *expired = NULL, **link;
+  guint epoch;
+
+  if (g_atomic_pointer_get (&epoch_orphans) == NULL)
+    return;
+
+  if (wait)
+    G_LOCK (epoch_orphans);
+  else if (!G_TRYLOCK (epoch_orphans))
+    return;
+
+  epoch = g_atomic_int_get (&epoch_global);
+
+  link = &epoch_orphans;
+  while (*link)
+    {
+      EpochRetired *retired = *link;
+
+      if (epoch_expired (retired, epoch))
+        {
+          *link = retired->next;
+          retired->next = expired;
+          expired = retired;
+        }
+      else
+        link = &retired->next;
+    }
+
+  G_UNLOCK (epoch_orphans);
+
+  epoch_free_list (expired);
+}
+
+static void
+epoch_thread_release (gpointer data)
+{
+  EpochThread *thread = data;
+
+  if (thread->retired)
+    {
+      G_LOCK (epoch_orphans);
+      thread->retired_tail->next = epoch_orphans;
+      epoch_orphans = thread->retired;
+      G_UNLOCK (epoch_orphans);
+
+      thread->retired = thread->retired_tail = NULL;
+      thread->n_retired = 0;
+    }
+
+  thread->depth = 0;
+  g_atomic_int_set (&thread->state, 0);
+  g_atomic_int_set (&thread->in_use, 0);
+
+  if (epoch_try_advance ())
+    epoch_reclaim_orphans (FALSE);
+}
+
+/**
+ * g_epoch_enter:
+ *
+ * Enters a critical section, in which pointers read from a data
+ * structure whose elements are freed with g_epoch_retire() stay valid.
+ *
+ * Critical sections nest: every call must be matched by a call to
+ * g_epoch_leave() from the same thread.
+ *
+ * Since: 2.54
+ */
+void
+g_epoch_enter (void)
+{
+  EpochThread *thread = epoch_thread_get ();
+
+  if (thread->depth++ == 0)
+    {
+      gint epoch = g_atomic_int_get (&epoch_global);
+
+      /* A full barrier: loads from the structure must not be done
+       * before other threads can see that we are inside.  If the epoch
+       * moves on before this, we just hold it up a little longer.
+       */
+      g_atomic_int_compare_and_exchange (&thread->state, 0, epoch | EPOCH_ACTIVE);
+    }
+}
+
+/**
+ * g_epoch_leave:
+ *
+ * Leaves a critical section entered with g_epoch_enter(). Once the
+ * outermost critical section has been left, pointers read inside it
+ * must not be used anymore.
+ *
+ * Since: 2.54
+ */
+void
+g_epoch_leave (void)
+{
+  EpochThread *thread = epoch_thread_get ();
+
+  g_return_if_fail (thread->depth > 0);
+
+  if (--thread->depth == 0)
+    g_atomic_int_set (&thread->state, 0);
+}
+
+/**
+ * g_epoch_retire:
+ * @data: the data to free
+ * @notify: a function to free @data
+ *
+ * Arranges for @notify to be called on @data once no thread can be
+ * using it anymore, that is once all critical sections running now
+ * have ended.
+ *
+ * @data must already have been removed from the shared data structure,
+ * so that threads entering a critical section after this call cannot
+ * find it. This function can be called both inside and outside a
+ * critical section, and does not wait.
+ *
+ * @notify is called later, from any thread, and possibly within a
+ * call to g_epoch_retire().
+ *
+ * Since: 2.54
+ */
+void
+g_epoch_retire (gpointer       data,
+                GDestroyNotify notify)
+{
+  EpochThread *thread;
+  EpochRetired *retired;
+
+  g_return_if_fail (notify != NULL);
+
+  thread = epoch_thread_get ();
+
+  retired = g_slice_new (EpochRetired);
+  retired->data = data;
+  retired->notify = notify;
+  retired->epoch = g_atomic_int_get (&epoch_global);
+  retired->next = NULL;
+
+  if (thread->retired_tail)
+    thread->retired_tail->next = retired;
+  else
+    thread->retired = retired;
+  thread->retired_tail = retired;
+
+  if (++thread->n_retired >= EPOCH_RECLAIM_THRESHOLD)
+    {
+      epoch_try_advance ();
+      epoch_reclaim_thread (thread);
+      epoch_reclaim_orphans (FALSE);
+    }
+}
+
+/**
+ * g_epoch_synchronize:
+ *
+ * Waits until all critical sections that are running now have ended,
+ * and frees everything that the calling thread retired before this
+ * call, as well as whatever exited threads left behind.
+ *
+ * This must not be called from inside a critical section, which would
+ * never end. It is useful before unloading code that notify functions
+ * point to, or in tests; it is not needed to keep memory use bounded,
+ * since g_epoch_retire() frees elements as it goes.
+ *
+ * Since: 2.54
+ */
+void
+g_epoch_synchronize (void)
+{
+  EpochThread *thread;
+  guint start;
+
+  thread = epoch_thread_get ();
+
+  g_return_if_fail (thread->depth == 0);
+
+  start = g_atomic_int_get (&epoch_global);
+  while ((guint) g_atomic_int_get (&epoch_global) - start < EPOCH_GRACE)
+    if (!epoch_try_advance ())
+      g_thread_yield ();
+
+  epoch_reclaim_thread (thread);
+  epoch_reclaim_orphans (TRUE);
+}
@@ -0,0 +1,42 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_EPOCH_H__
+#define __G_EPOCH_H__
+
+#if !defined (__GLIB_H_INSIDE__) && !defined (GLIB_COMPILATION)
+#error "Only <glib.h> can be included directly."
+#endif
+
+#include <glib/gtypes.h>
+
+G_BEGIN_DECLS
+
+GLIB_AVAILABLE_IN_2_54
+void g_epoch_enter       (void);
+GLIB_AVAILABLE_IN_2_54
+void g_epoch_leave       (void);
+GLIB_AVAILABLE_IN_2_54
+void g_epoch_retire      (gpointer       data,
+                          GDestroyNotify notify);
+GLIB_AVAILABLE_IN_2_54
+void g_epoch_synchronize (void);
+
+G_END_DECLS
+
+#endif /* __G_EPOCH_H__ */
@@ -49,6 +49,8 @@
 #include "gfileutils.h"
 
 #include "gstdio.h"
+#include "gmappedfile.h"
+#include "gbytes.h"
 #include "glibintl.h"
 
 #ifdef HAVE_LINUX_MAGIC_H /* for btrfs check */
@@ -657,12 +659,11 @@ set_file_error (GError      **error,
 static gboolean
 get_contents_stdio (const gchar  *filename,
                     FILE         *f,
+                    gsize         size_hint,
                     gchar       **contents,
                     gsize        *length,
                     GError      **error)
 {
-  gchar buf[4096];
-  gsize bytes;  /* always <= sizeof(buf) */
   gchar *str = NULL;
   gsize total_bytes = 0;
   gsize total_allocated = 0;
@@ -671,31 +672,30 @@ get_contents_stdio (const gchar  *filename,
 
   g_assert (f != NULL);
 
-  while (!feof (f))
+  /* Read straight into the result, doubling it whenever it fills up,
+   * and keeping one byte spare for the nul.
+   */
+  while (TRUE)
     {
+      gsize bytes;
       gint save_errno;
 
-      bytes = fread (buf, 1, sizeof (buf), f);
-      save_errno = errno;
-
-      if (total_bytes > G_MAXSIZE - bytes)
-          goto file_too_large;
-
-      /* Possibility of overflow eliminated above. */
-      while (total_bytes + bytes >= total_allocated)
+      if (total_bytes + 1 >= total_allocated)
         {
+          gsize new_allocated;
+
           if (str)
             {
               if (total_allocated > G_MAXSIZE / 2)
                   goto file_too_large;
-              total_allocated *= 2;
+              new_allocated = total_allocated * 2;
             }
           else
             {
-              total_allocated = MIN (bytes + 1, sizeof (buf));
+              new_allocated = MAX (MIN (size_hint, G_MAXSIZE - 1) + 1, 4096);
             }
 
-          tmp = g_try_realloc (str, total_allocated);
+          tmp = g_try_realloc (str, new_allocated);
 
           if (tmp == NULL)
             {
@@ -703,8 +703,8 @@ get_contents_stdio (const gchar  *filename,
               g_set_error (error,
                            G_FILE_ERROR,
                            G_FILE_ERROR_NOMEM,
-                           g_dngettext (GETTEXT_PACKAGE, "Could not allocate %lu byte to read file “%s”", "Could not allocate %lu bytes to read file “%s”", (gulong)total_allocated),
-                           (gulong) total_allocated,
+                           g_dngettext (GETTEXT_PACKAGE, "Could not allocate %lu byte to read file “%s”", "Could not allocate %lu bytes to read file “%s”", (gulong)new_allocated),
+                           (gulong) new_allocated,
 			   display_filename);
               g_free (display_filename);
 
@@ -712,8 +712,14 @@ get_contents_stdio (const gchar  *filename,
             }
 
 	  str = tmp;
+          total_allocated = new_allocated;
         }
 
+      bytes = fread (str + total_bytes, 1, total_allocated - total_bytes - 1, f);
+      save_errno = errno;
+
+      total_bytes += bytes;
+
       if (ferror (f))
         {
           display_filename = g_filename_display_name (filename);
@@ -728,20 +734,12 @@ get_contents_stdio (const gchar  *filename,
           goto error;
         }
 
-      g_assert (str != NULL);
-      memcpy (str + total_bytes, buf, bytes);
-
-      total_bytes += bytes;
+      if (feof (f))
+        break;
     }
 
   fclose (f);
 
-  if (total_allocated == 0)
-    {
-      str = g_new (gchar, 1);
-      total_bytes = 0;
-    }
-
   str[total_bytes] = '\0';
 
   if (length)
@@ -852,45 +850,22 @@ get_contents_regfile (const gchar  *filename,
 }
 
 static gboolean
-get_contents_posix (const gchar  *filename,
-                    gchar       **contents,
-                    gsize        *length,
-                    GError      **error)
+get_contents_fd (const gchar  *filename,
+                 struct stat  *stat_buf,
+                 gint          fd,
+                 gchar       **contents,
+                 gsize        *length,
+                 GError      **error)
 {
-  struct stat stat_buf;
-  gint fd;
-
-  /* O_BINARY useful on Cygwin */
-  fd = open (filename, O_RDONLY|O_BINARY);
-
-  if (fd < 0)
-    {
-      int saved_errno = errno;
-      set_file_error (error,
-                      filename,
-                      _("Failed to open file “%s”: %s"),
-                      saved_errno);
-
-      return FALSE;
-    }
-
-  /* I don't think this will ever fail, aside from ENOMEM, but. */
-  if (fstat (fd, &stat_buf) < 0)
-    {
-      int saved_errno = errno;
-      set_file_error (error,
-                      filename,
-                      _("Failed to get attributes of file “%s”: fstat() failed: %s"),
-                      saved_errno);
-      close (fd);
-
-      return FALSE;
-    }
+#ifdef HAVE_POSIX_FADVISE
+  /* Best effort; this fails harmlessly on pipes and the like */
+  (void) posix_fadvise (fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
 
-  if (stat_buf.st_size > 0 && S_ISREG (stat_buf.st_mode))
+  if (stat_buf->st_size > 0 && S_ISREG (stat_buf->st_mode))
     {
       gboolean retval = get_contents_regfile (filename,
-					      &stat_buf,
+					      stat_buf,
 					      fd,
 					      contents,
 					      length,
@@ -912,16 +887,75 @@ get_contents_posix (const gchar  *filename,
                           filename,
                           _("Failed to open file “%s”: fdopen() failed: %s"),
                           saved_errno);
+          close (fd);
 
           return FALSE;
         }
-  
-      retval = get_contents_stdio (filename, f, contents, length, error);
+
+      /* Some special files report a useful size even though they are
+       * not regular files; start the buffer there if so.
+       */
+      retval = get_contents_stdio (filename, f,
+                                   MAX (stat_buf->st_size, 0),
+                                   contents, length, error);
 
       return retval;
     }
 }
 
+static gint
+open_for_contents (const gchar  *filename,
+                   struct stat  *stat_buf,
+                   GError      **error)
+{
+  gint fd;
+
+  /* O_BINARY useful on Cygwin */
+  fd = open (filename, O_RDONLY|O_BINARY);
+
+  if (fd < 0)
+    {
+      int saved_errno = errno;
+      set_file_error (error,
+                      filename,
+                      _("Failed to open file “%s”: %s"),
+                      saved_errno);
+
+      return -1;
+    }
+
+  /* I don't think this will ever fail, aside from ENOMEM, but. */
+  if (fstat (fd, stat_buf) < 0)
+    {
+      int saved_errno = errno;
+      set_file_error (error,
+                      filename,
+                      _("Failed to get attributes of file “%s”: fstat() failed: %s"),
+                      saved_errno);
+      close (fd);
+
+      return -1;
+    }
+
+  return fd;
+}
+
+static gboolean
+get_contents_posix (const gchar  *filename,
+                    gchar       **contents,
+                    gsize        *length,
+                    GError      **error)
+{
+  struct stat stat_buf;
+  gint fd;
+
+  fd = open_for_contents (filename, &stat_buf, error);
+  if (fd < 0)
+    return FALSE;
+
+  return get_contents_fd (filename, &stat_buf, fd, contents, length, error);
+}
+
 #else  /* G_OS_WIN32 */
 
 static gboolean
@@ -946,7 +980,7 @@ get_contents_win32 (const gchar  *filename,
       return FALSE;
     }
   
-  retval = get_contents_stdio (filename, f, contents, length, error);
+  retval = get_contents_stdio (filename, f, 0, contents, length, error);
 
   return retval;
 }
@@ -994,6 +1028,88 @@ g_file_get_contents (const gchar  *filename,
 #endif
 }
 
+/* Below this, copying the file is cheaper than setting up a mapping */
+#define DEFAULT_MMAP_THRESHOLD (128 * 1024)
+
+/**
+ * g_file_get_bytes:
+ * @filename: (type filename): name of a file to read contents from, in the GLib file name encoding
+ * @mmap_threshold: size in bytes from which the file is mapped rather
+ *     than read, or 0 for a default
+ * @error: return location for a #GError, or %NULL
+ *
+ * Loads an entire file into a #GBytes, in the same way as
+ * g_file_get_contents().
+ *
+ * Regular files of at least @mmap_threshold bytes are not copied;
+ * the returned #GBytes refers to a read-only private mapping of the
+ * file instead, as with g_mapped_file_get_bytes().  As with any
+ * mapping, the data can change if the file is modified in place, and
+ * the process can crash if it is truncated, so only use this with
+ * files that are replaced atomically (eg: with g_file_set_contents()).
+ * Pass %G_MAXSIZE to never map the file.
+ *
+ * Unlike with g_file_get_contents(), the data is not guaranteed to be
+ * nul-terminated.
+ *
+ * Returns: (transfer full): a #GBytes with the contents of the file,
+ *     or %NULL if an error occurred
+ *
+ * Since: 2.54
+ */
+GBytes *
+g_file_get_bytes (const gchar  *filename,
+                  gsize         mmap_threshold,
+                  GError      **error)
+{
+  gchar *contents;
+  gsize length;
+
+  g_return_val_if_fail (filename != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  if (mmap_threshold == 0)
+    mmap_threshold = DEFAULT_MMAP_THRESHOLD;
+
+#ifdef G_OS_WIN32
+  if (!get_contents_win32 (filename, &contents, &length, error))
+    return NULL;
+#else
+  {
+    struct stat stat_buf;
+    gint fd;
+
+    fd = open_for_contents (filename, &stat_buf, error);
+    if (fd < 0)
+      return NULL;
+
+    if (S_ISREG (stat_buf.st_mode) &&
+        stat_buf.st_size > 0 &&
+        (guint64) stat_buf.st_size >= mmap_threshold)
+      {
+        GMappedFile *mapped;
+        GBytes *bytes;
+
+        mapped = g_mapped_file_new_from_fd (fd, FALSE, error);
+        close (fd);
+
+        if (mapped == NULL)
+          return NULL;
+
+        bytes = g_mapped_file_get_bytes (mapped);
+        g_mapped_file_unref (mapped);
+
+        return bytes;
+      }
+
+    if (!get_contents_fd (filename, &stat_buf, fd, &contents, &length, error))
+      return NULL;
+  }
+#endif
+
+  return g_bytes_new_take (contents, length);
+}
+
 static gboolean
 rename_file (const char  *old_name,
 	     const char  *new_name,
@@ -1023,32 +1139,64 @@ rename_file (const char  *old_name,
   return TRUE;
 }
 
-static gchar *
-write_to_temp_file (const gchar  *contents,
-		    gssize        length,
-		    const gchar  *dest_file,
-		    GError      **err)
+#if defined (O_TMPFILE) && defined (HAVE_LINKAT)
+#define USE_O_TMPFILE 1
+#endif
+
+typedef gint (*GTmpFileCallback) (const gchar *, gint, gint);
+
+/* Creates a temporary file next to @dest_file and writes @contents to
+ * it.  Returns the still open descriptor, and the name of the file in
+ * @tmp_name, or -1.
+ *
+ * With @try_tmpfile, the file may be created without a name using
+ * O_TMPFILE, in which case @tmp_name is set to %NULL; see
+ * link_tmpfile().
+ */
+static gint
+write_to_temp_fd (const gchar  *contents,
+                  gssize        length,
+                  const gchar  *dest_file,
+                  gboolean      try_tmpfile,
+                  gchar       **tmp_name,
+                  GError      **err)
 {
-  gchar *tmp_name;
-  gchar *retval;
-  gint fd;
+  const gchar *display_name;
+  gint fd = -1;
 
-  retval = NULL;
+  *tmp_name = NULL;
 
-  tmp_name = g_strdup_printf ("%s.XXXXXX", dest_file);
+#ifdef USE_O_TMPFILE
+  if (try_tmpfile)
+    {
+      gchar *dirname = g_path_get_dirname (dest_file);
 
-  errno = 0;
-  fd = g_mkstemp_full (tmp_name, O_RDWR | O_BINARY, 0666);
+      /* Not every filesystem supports it; fall back to a named file */
+      fd = g_open (dirname, O_TMPFILE | O_RDWR | O_BINARY, 0666);
+      g_free (dirname);
+    }
+#endif
 
   if (fd == -1)
     {
-      int saved_errno = errno;
-      set_file_error (err,
-                      tmp_name, _("Failed to create file “%s”: %s"),
-                      saved_errno);
-      goto out;
+      *tmp_name = g_strdup_printf ("%s.XXXXXX", dest_file);
+
+      errno = 0;
+      fd = g_mkstemp_full (*tmp_name, O_RDWR | O_BINARY, 0666);
+
+      if (fd == -1)
+        {
+          int saved_errno = errno;
+          set_file_error (err,
+                          *tmp_name, _("Failed to create file “%s”: %s"),
+                          saved_errno);
+          g_clear_pointer (tmp_name, g_free);
+          return -1;
+        }
     }
 
+  display_name = *tmp_name ? *tmp_name : dest_file;
+
 #ifdef HAVE_FALLOCATE
   if (length > 0)
     {
@@ -1071,12 +1219,14 @@ write_to_temp_file (const gchar  *contents,
             continue;
 
           set_file_error (err,
-                          tmp_name, _("Failed to write file “%s”: write() failed: %s"),
+                          display_name, _("Failed to write file “%s”: write() failed: %s"),
                           saved_errno);
           close (fd);
-          g_unlink (tmp_name);
+          if (*tmp_name)
+            g_unlink (*tmp_name);
+          g_clear_pointer (tmp_name, g_free);
 
-          goto out;
+          return -1;
         }
 
       g_assert (s <= length);
@@ -1085,6 +1235,18 @@ write_to_temp_file (const gchar  *contents,
       length -= s;
     }
 
+  return fd;
+}
+
+/* Makes sure the data written to @fd is on disk before it replaces
+ * @dest_file, when that is needed.
+ */
+static gboolean
+sync_temp_fd (gint          fd,
+              const gchar  *display_name,
+              const gchar  *dest_file,
+              GError      **err)
+{
 #ifdef BTRFS_SUPER_MAGIC
   {
     struct statfs buf;
@@ -1095,7 +1257,7 @@ write_to_temp_file (const gchar  *contents,
      */
 
     if (fstatfs (fd, &buf) == 0 && buf.f_type == BTRFS_SUPER_MAGIC)
-      goto no_fsync;
+      return TRUE;
   }
 #endif
 
@@ -1114,34 +1276,104 @@ write_to_temp_file (const gchar  *contents,
       {
         int saved_errno = errno;
         set_file_error (err,
-                        tmp_name, _("Failed to write file “%s”: fsync() failed: %s"),
+                        display_name, _("Failed to write file “%s”: fsync() failed: %s"),
                         saved_errno);
-        close (fd);
-        g_unlink (tmp_name);
-
-        goto out;
+        return FALSE;
       }
   }
 #endif
 
-#ifdef BTRFS_SUPER_MAGIC
- no_fsync:
-#endif
+  return TRUE;
+}
+
+static gchar *
+write_to_temp_file (const gchar  *contents,
+		    gssize        length,
+		    const gchar  *dest_file,
+		    GError      **err)
+{
+  gchar *tmp_name;
+  gint fd;
+
+  fd = write_to_temp_fd (contents, length, dest_file, FALSE, &tmp_name, err);
+  if (fd == -1)
+    return NULL;
+
+  if (!sync_temp_fd (fd, tmp_name, dest_file, err))
+    {
+      close (fd);
+      g_unlink (tmp_name);
+      g_free (tmp_name);
+
+      return NULL;
+    }
 
   errno = 0;
   if (!g_close (fd, err))
     {
       g_unlink (tmp_name);
+      g_free (tmp_name);
 
-      goto out;
+      return NULL;
     }
 
-  retval = g_strdup (tmp_name);
+  return tmp_name;
+}
 
- out:
-  g_free (tmp_name);
+/* Renames @tmp_filename over @filename, removing @tmp_filename if
+ * that fails.
+ */
+static gboolean
+replace_file (const gchar  *tmp_filename,
+              const gchar  *filename,
+              GError      **error)
+{
+  GError *rename_error = NULL;
 
-  return retval;
+  if (!rename_file (tmp_filename, filename, &rename_error))
+    {
+#ifndef G_OS_WIN32
+
+      g_unlink (tmp_filename);
+      g_propagate_error (error, rename_error);
+      return FALSE;
+
+#else /* G_OS_WIN32 */
+      
+      /* Renaming failed, but on Windows this may just mean
+       * the file already exists. So if the target file
+       * exists, try deleting it and do the rename again.
+       */
+      if (!g_file_test (filename, G_FILE_TEST_EXISTS))
+	{
+	  g_unlink (tmp_filename);
+	  g_propagate_error (error, rename_error);
+	  return FALSE;
+	}
+
+      g_error_free (rename_error);
+      
+      if (g_unlink (filename) == -1)
+	{
+          int saved_errno = errno;
+          set_file_error (error,
+                          filename,
+		          _("Existing file “%s” could not be removed: g_unlink() failed: %s"),
+                          saved_errno);
+	  g_unlink (tmp_filename);
+	  return FALSE;
+	}
+      
+      if (!rename_file (tmp_filename, filename, error))
+	{
+	  g_unlink (tmp_filename);
+	  return FALSE;
+	}
+
+#endif
+    }
+
+  return TRUE;
 }
 
 /**
@@ -1190,7 +1422,6 @@ g_file_set_contents (const gchar  *filename,
 {
   gchar *tmp_filename;
   gboolean retval;
-  GError *rename_error = NULL;
   
   g_return_val_if_fail (filename != NULL, FALSE);
   g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
@@ -1203,70 +1434,308 @@ g_file_set_contents (const gchar  *filename,
   tmp_filename = write_to_temp_file (contents, length, filename, error);
   
   if (!tmp_filename)
+    return FALSE;
+
+  retval = replace_file (tmp_filename, filename, error);
+
+  g_free (tmp_filename);
+  return retval;
+}
+
+/**
+ * GFileBatch:
+ *
+ * An opaque structure holding files written with
+ * g_file_batch_set_contents() until g_file_batch_commit().
+ *
+ * Since: 2.54
+ */
+
+/**
+ * GFileBatchFlags:
+ * @G_FILE_BATCH_FLAGS_NONE: No flags.
+ * @G_FILE_BATCH_FLAGS_TMPFILE: Where the system supports it (ie: with
+ *     `O_TMPFILE` on Linux), write each file without a name until the
+ *     batch is committed, so that a crash before then leaves no
+ *     temporary files behind.  A file that does not exist yet is then
+ *     created under its final name directly.
+ *
+ * Flags for g_file_batch_new().
+ *
+ * Since: 2.54
+ */
+
+struct _GFileBatch
+{
+  GFileBatchFlags flags;
+  GArray *entries;   /* of FileBatchEntry */
+};
+
+typedef struct
+{
+  gchar *filename;
+  gchar *tmp_name;   /* NULL while an O_TMPFILE has no name */
+  gint   fd;
+} FileBatchEntry;
+
+static void
+file_batch_entry_clear (gpointer data)
+{
+  FileBatchEntry *entry = data;
+
+  if (entry->fd != -1)
+    close (entry->fd);
+  if (entry->tmp_name)
+    g_unlink (entry->tmp_name);
+
+  g_free (entry->tmp_name);
+  g_free (entry->filename);
+}
+
+static gint get_tmp_file (gchar            *tmpl,
+                          GTmpFileCallback  f,
+                          int               flags,
+                          int               mode);
+
+#ifdef USE_O_TMPFILE
+/* A GTmpFileCallback; @flags carries the descriptor of the O_TMPFILE */
+static gint
+wrap_linkat (const gchar *filename,
+             int          flags,
+             int          mode G_GNUC_UNUSED)
+{
+  gchar proc_path[32];
+
+  /* linkat (fd, "", ..., AT_EMPTY_PATH) would need CAP_DAC_READ_SEARCH */
+  g_snprintf (proc_path, sizeof proc_path, "/proc/self/fd/%d", flags);
+
+  return linkat (AT_FDCWD, proc_path, AT_FDCWD, filename, AT_SYMLINK_FOLLOW);
+}
+
+/* Gives an O_TMPFILE its final name if nothing has that name yet, or
+ * else a temporary name to rename over it.
+ */
+static gboolean
+link_tmpfile (FileBatchEntry  *entry,
+              GError         **error)
+{
+  int saved_errno;
+
+  if (wrap_linkat (entry->filename, entry->fd, 0) == 0)
+    return TRUE;
+
+  if (errno == EEXIST)
     {
-      retval = FALSE;
-      goto out;
+      gchar *tmp_name = g_strdup_printf ("%s.XXXXXX", entry->filename);
+
+      if (get_tmp_file (tmp_name, wrap_linkat, entry->fd, 0) == 0)
+        {
+          entry->tmp_name = tmp_name;
+          return TRUE;
+        }
+
+      g_free (tmp_name);
     }
 
-  if (!rename_file (tmp_filename, filename, &rename_error))
-    {
-#ifndef G_OS_WIN32
+  saved_errno = errno;
+  set_file_error (error,
+                  entry->filename, _("Failed to create file “%s”: %s"),
+                  saved_errno);
 
-      g_unlink (tmp_filename);
-      g_propagate_error (error, rename_error);
-      retval = FALSE;
-      goto out;
+  return FALSE;
+}
+#endif
 
-#else /* G_OS_WIN32 */
-      
-      /* Renaming failed, but on Windows this may just mean
-       * the file already exists. So if the target file
-       * exists, try deleting it and do the rename again.
-       */
-      if (!g_file_test (filename, G_FILE_TEST_EXISTS))
-	{
-	  g_unlink (tmp_filename);
-	  g_propagate_error (error, rename_error);
-	  retval = FALSE;
-	  goto out;
-	}
+/**
+ * g_file_batch_new:
+ * @flags: #GFileBatchFlags
+ *
+ * Creates a new #GFileBatch, to replace the contents of many files at
+ * once.
+ *
+ * Each file in the batch is replaced in the same way as with
+ * g_file_set_contents(), but the cost of making the data durable is
+ * shared: the data of every file is written out before any of them is
+ * renamed into place, and the writeback of each file starts as soon as
+ * it is added, so that g_file_batch_commit() mostly waits for I/O that
+ * is already in flight rather than syncing one file at a time.
+ *
+ * Returns: (transfer full): a new #GFileBatch, free it with
+ *     g_file_batch_free()
+ *
+ * Since: 2.54
+ */
+GFileBatch *
+g_file_batch_new (GFileBatchFlags flags)
+{
+  GFileBatch *batch;
 
-      g_error_free (rename_error);
-      
-      if (g_unlink (filename) == -1)
-	{
-          int saved_errno = errno;
-          set_file_error (error,
-                          filename,
-		          _("Existing file “%s” could not be removed: g_unlink() failed: %s"),
-                          saved_errno);
-	  g_unlink (tmp_filename);
-	  retval = FALSE;
-	  goto out;
-	}
-      
-      if (!rename_file (tmp_filename, filename, error))
-	{
-	  g_unlink (tmp_filename);
-	  retval = FALSE;
-	  goto out;
-	}
+  batch = g_slice_new (GFileBatch);
+  batch->flags = flags;
+  batch->entries = g_array_new (FALSE, FALSE, sizeof (FileBatchEntry));
+  g_array_set_clear_func (batch->entries, file_batch_entry_clear);
+
+  return batch;
+}
+
+/**
+ * g_file_batch_set_contents:
+ * @batch: a #GFileBatch
+ * @filename: (type filename): name of a file to write @contents to, in the
+ *     GLib file name encoding
+ * @contents: (array length=length) (element-type guint8): string to write to
+ *     the file
+ * @length: length of @contents, or -1 if @contents is a nul-terminated string
+ * @error: return location for a #GError, or %NULL
+ *
+ * Writes all of @contents to a temporary file next to @filename, which
+ * will replace @filename when @batch is committed.  @filename itself is
+ * left alone until then.
+ *
+ * The temporary file stays open until the batch is committed or freed,
+ * so very large batches are limited by the number of open files the
+ * process is allowed.
+ *
+ * Returns: %TRUE on success, %FALSE if an error occurred
+ *
+ * Since: 2.54
+ */
+gboolean
+g_file_batch_set_contents (GFileBatch   *batch,
+                           const gchar  *filename,
+                           const gchar  *contents,
+                           gssize        length,
+                           GError      **error)
+{
+  FileBatchEntry entry;
+
+  g_return_val_if_fail (batch != NULL, FALSE);
+  g_return_val_if_fail (filename != NULL, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+  g_return_val_if_fail (contents != NULL || length == 0, FALSE);
+  g_return_val_if_fail (length >= -1, FALSE);
+
+  if (length == -1)
+    length = strlen (contents);
+
+  entry.fd = write_to_temp_fd (contents, length, filename,
+                               (batch->flags & G_FILE_BATCH_FLAGS_TMPFILE) != 0,
+                               &entry.tmp_name, error);
+  if (entry.fd == -1)
+    return FALSE;
 
+#ifdef HAVE_SYNC_FILE_RANGE
+  /* Start writeback now, so that it overlaps with the writing of the
+   * other files.  This does not wait, and makes no promise; the
+   * fsync() in g_file_batch_commit() does.
+   */
+  (void) sync_file_range (entry.fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
+
+  entry.filename = g_strdup (filename);
+  g_array_append_val (batch->entries, entry);
+
+  return TRUE;
+}
+
+/**
+ * g_file_batch_commit:
+ * @batch: a #GFileBatch
+ * @error: return location for a #GError, or %NULL
+ *
+ * Replaces every file given to g_file_batch_set_contents(), in the
+ * order they were given.
+ *
+ * Each replacement is atomic, as with g_file_set_contents(), but the
+ * batch as a whole is not: if an error occurs, the files before the
+ * one that failed have been replaced and the others are left alone.
+ *
+ * Either way, @batch is empty afterwards and can be used again.
+ *
+ * Returns: %TRUE on success, %FALSE if an error occurred
+ *
+ * Since: 2.54
+ */
+gboolean
+g_file_batch_commit (GFileBatch  *batch,
+                     GError     **error)
+{
+  gboolean retval = FALSE;
+  guint i;
+
+  g_return_val_if_fail (batch != NULL, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  /* All of the data goes to disk before the first rename */
+  for (i = 0; i < batch->entries->len; i++)
+    {
+      FileBatchEntry *entry = &g_array_index (batch->entries, FileBatchEntry, i);
+
+      if (!sync_temp_fd (entry->fd,
+                         entry->tmp_name ? entry->tmp_name : entry->filename,
+                         entry->filename, error))
+        goto out;
+    }
+
+  for (i = 0; i < batch->entries->len; i++)
+    {
+      FileBatchEntry *entry = &g_array_index (batch->entries, FileBatchEntry, i);
+      gint fd;
+
+#ifdef USE_O_TMPFILE
+      if (entry->tmp_name == NULL && !link_tmpfile (entry, error))
+        goto out;
 #endif
+
+      fd = entry->fd;
+      entry->fd = -1;
+
+      errno = 0;
+      if (!g_close (fd, error))
+        goto out;
+
+      if (entry->tmp_name != NULL)
+        {
+          gboolean replaced = replace_file (entry->tmp_name, entry->filename, error);
+
+          /* replace_file() removes the temporary file if it fails */
+          g_clear_pointer (&entry->tmp_name, g_free);
+
+          if (!replaced)
+            goto out;
+        }
     }
 
   retval = TRUE;
-  
+
  out:
-  g_free (tmp_filename);
+  g_array_set_size (batch->entries, 0);
+
   return retval;
 }
 
+/**
+ * g_file_batch_free:
+ * @batch: (transfer full): a #GFileBatch
+ *
+ * Frees @batch.  Files written with g_file_batch_set_contents() since
+ * the last commit are discarded.
+ *
+ * Since: 2.54
+ */
+void
+g_file_batch_free (GFileBatch *batch)
+{
+  g_return_if_fail (batch != NULL);
+
+  g_array_unref (batch->entries);
+  g_slice_free (GFileBatch, batch);
+}
+
 /*
  * get_tmp_file based on the mkstemp implementation from the GNU C library.
  * Copyright (C) 1991,92,93,94,95,96,97,98,99 Free Software Foundation, Inc.
  */
-typedef gint (*GTmpFileCallback) (const gchar *, gint, gint);
 
 static gint
 get_tmp_file (gchar            *tmpl,
@@ -23,6 +23,7 @@
 #error "Only <glib.h> can be included directly."
 #endif
 
+#include <glib/garray.h>
 #include <glib/gerror.h>
 
 G_BEGIN_DECLS
@@ -71,6 +72,14 @@ typedef enum
   G_FILE_TEST_EXISTS        = 1 << 4
 } GFileTest;
 
+typedef enum
+{
+  G_FILE_BATCH_FLAGS_NONE    = 0,
+  G_FILE_BATCH_FLAGS_TMPFILE = 1 << 0
+} GFileBatchFlags;
+
+typedef struct _GFileBatch GFileBatch;
+
 GLIB_AVAILABLE_IN_ALL
 GQuark     g_file_error_quark      (void);
 /* So other code can generate a GFileError */
@@ -93,6 +102,24 @@ gboolean g_file_set_contents (const gchar *filename,
 GLIB_AVAILABLE_IN_ALL
 gchar   *g_file_read_link    (const gchar  *filename,
                               GError      **error);
+GLIB_AVAILABLE_IN_2_54
+GBytes  *g_file_get_bytes    (const gchar  *filename,
+                              gsize         mmap_threshold,
+                              GError      **error);
+
+GLIB_AVAILABLE_IN_2_54
+GFileBatch *g_file_batch_new          (GFileBatchFlags   flags);
+GLIB_AVAILABLE_IN_2_54
+gboolean    g_file_batch_set_contents (GFileBatch       *batch,
+                                       const gchar      *filename,
+                                       const gchar      *contents,
+                                       gssize            length,
+                                       GError          **error);
+GLIB_AVAILABLE_IN_2_54
+gboolean    g_file_batch_commit       (GFileBatch       *batch,
+                                       GError          **error);
+GLIB_AVAILABLE_IN_2_54
+void        g_file_batch_free         (GFileBatch       *batch);
 
 /* Wrapper / workalike for mkdtemp() */
 GLIB_AVAILABLE_IN_2_30
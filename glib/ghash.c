@@ -28,15 +28,18 @@
 
 #include "config.h"
 
-#include <string.h>  /* memset */
+#include <string.h>  /* memset, memcpy, strlen */
 
 #include "ghash.h"
+#include "ghashprivate.h"
 
 #include "glib-private.h"
 #include "gstrfuncs.h"
 #include "gatomic.h"
 #include "gtestutils.h"
 #include "gslice.h"
+#include "grand.h"
+#include "gthread.h"
 
 
 /**
@@ -116,9 +119,11 @@
  *
  * <!-- FIXME: Need more here. --> A good hash functions should produce
  * hash values that are evenly distributed over a fairly large range.
- * The modulus is taken with the hash table size (a prime number) to
- * find the 'bucket' to place each key into. The function should also
- * be very fast, since it is called for each key lookup.
+ * The hash value is scrambled to find the group of slots to place each
+ * key into. The function should also be very fast, since it is called
+ * for each key lookup, and again for every key when the table is
+ * resized; it must keep returning the same value for a key while the
+ * key is in the table.
  *
  * Note that the hash functions provided by GLib have these qualities,
  * but are not particularly robust against manufactured keys that
@@ -201,25 +206,153 @@
  * release of GLib. It does nothing.
  */
 
-#define HASH_TABLE_MIN_SHIFT 3  /* 1 << 3 == 8 buckets */
+#define HASH_TABLE_MIN_SHIFT 3  /* 1 << 3 == 8 slots */
+
+/* The table is open-addressed, with the slots grouped so that a whole
+ * group can be probed at once: next to the keys and values, there is
+ * one control byte per slot.  For an occupied slot, it holds 7 bits of
+ * the hash of the key, so the key equality function is only called
+ * for keys that are very likely to match; otherwise it tells whether
+ * the slot is empty or a tombstone.  Tables smaller than a group are
+ * padded with sentinel control bytes which never match.
+ *
+ * A lookup scrambles the hash value, picks a group from it, and
+ * compares the control bytes of all the slots of the group with the
+ * 7 hash bits in one go.  If the key is not found in the group and the
+ * group has an empty slot, the key is not in the table; otherwise,
+ * probing continues with further groups.
+ *
+ * Keys and values are kept together in one array of entries, so that
+ * finding the value costs no more cache misses than finding the key.
+ * As long as every value is the same as its key (when the table is
+ * used as a set), the array holds only the keys; it is split out in
+ * key/value pairs as soon as a different value is stored.
+ *
+ * Hash values are not stored, so the hash function is called again for
+ * every key when the table is resized.
+ */
+#define CTRL_EMPTY      ((guint8) 0x80)
+#define CTRL_TOMBSTONE  ((guint8) 0xfe)
+#define CTRL_SENTINEL   ((guint8) 0xff)
+#define CTRL_IS_FULL(c_) ((c_) < 0x80)
+
+#if defined (__SSE2__) || defined (_M_X64) || defined (_M_AMD64) || \
+    (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+
+#define GROUP_WIDTH 16
+#define GROUP_MASK_SHIFT 0  /* one bit per slot */
+
+typedef guint32 GroupMask;
+
+static inline GroupMask
+group_match (const guint8 *ctrl,
+             guint8        h2)
+{
+  __m128i group = _mm_loadu_si128 ((const __m128i *) ctrl);
+
+  return _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_set1_epi8 ((char) h2), group));
+}
+
+static inline GroupMask
+group_match_empty (const guint8 *ctrl)
+{
+  __m128i group = _mm_loadu_si128 ((const __m128i *) ctrl);
+
+  return _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_set1_epi8 ((char) CTRL_EMPTY), group));
+}
+
+/* Empty slots and tombstones, the only control bytes below the sentinel
+ * when taken as signed
+ */
+static inline GroupMask
+group_match_free (const guint8 *ctrl)
+{
+  __m128i group = _mm_loadu_si128 ((const __m128i *) ctrl);
+
+  return _mm_movemask_epi8 (_mm_cmpgt_epi8 (_mm_set1_epi8 ((char) CTRL_SENTINEL), group));
+}
+#else
+/* Portable version, working on 8 control bytes in a 64-bit word */
+#define GROUP_WIDTH 8
+#define GROUP_MASK_SHIFT 3  /* the top bit of each byte */
+
+typedef guint64 GroupMask;
+
+#define GROUP_LSBS G_GUINT64_CONSTANT (0x0101010101010101)
+#define GROUP_MSBS G_GUINT64_CONSTANT (0x8080808080808080)
+
+static inline guint64
+group_load (const guint8 *ctrl)
+{
+  guint64 group;
+
+  memcpy (&group, ctrl, sizeof group);
+
+  return GUINT64_FROM_LE (group);
+}
+
+static inline GroupMask
+group_match (const guint8 *ctrl,
+             guint8        h2)
+{
+  guint64 x = group_load (ctrl) ^ (GROUP_LSBS * h2);
+
+  /* Exact test for zero bytes, without carries between bytes */
+  return ~(((x & ~GROUP_MSBS) + ~GROUP_MSBS) | x | ~GROUP_MSBS);
+}
+
+static inline GroupMask
+group_match_empty (const guint8 *ctrl)
+{
+  guint64 group = group_load (ctrl);
+
+  /* top bit set, bit 1 clear */
+  return group & (~group << 6) & GROUP_MSBS;
+}
+
+static inline GroupMask
+group_match_free (const guint8 *ctrl)
+{
+  guint64 group = group_load (ctrl);
+
+  /* top bit set, bit 0 clear */
+  return group & (~group << 7) & GROUP_MSBS;
+}
+#endif
+
+static inline guint
+group_mask_first (GroupMask mask)
+{
+#if defined (__GNUC__) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4))
+  return __builtin_ctzll (mask) >> GROUP_MASK_SHIFT;
+#else
+  guint i = 0;
+
+  while (!(mask & 1))
+    {
+      mask >>= 1;
+      i++;
+    }
+
+  return i >> GROUP_MASK_SHIFT;
+#endif
+}
 
-#define UNUSED_HASH_VALUE 0
-#define TOMBSTONE_HASH_VALUE 1
-#define HASH_IS_UNUSED(h_) ((h_) == UNUSED_HASH_VALUE)
-#define HASH_IS_TOMBSTONE(h_) ((h_) == TOMBSTONE_HASH_VALUE)
-#define HASH_IS_REAL(h_) ((h_) >= 2)
+#define GROUP_MASK_NEXT(mask_) ((mask_) &= (mask_) - 1)
 
 struct _GHashTable
 {
   gint             size;
-  gint             mod;
-  guint            mask;
+  guint            group_mask;  /* number of groups - 1 */
   gint             nnodes;
   gint             noccupied;  /* nnodes + tombstones */
+  gint             min_size;   /* from g_hash_table_reserve(), or 0 */
 
+  guint8          *ctrl;
   gpointer        *keys;
-  guint           *hashes;
-  gpointer        *values;
+  gpointer        *values;      /* keys, or keys + 1 for key/value pairs */
+  guint            entry_shift; /* 0 for keys only, 1 for pairs */
 
   GHashFunc        hash_func;
   GEqualFunc       key_equal_func;
@@ -234,8 +367,12 @@ struct _GHashTable
 #endif
   GDestroyNotify   key_destroy_func;
   GDestroyNotify   value_destroy_func;
+  GArena          *arena;
 };
 
+#define NODE_KEY(hash_table, i)   ((hash_table)->keys[(gsize) (i) << (hash_table)->entry_shift])
+#define NODE_VALUE(hash_table, i) ((hash_table)->values[(gsize) (i) << (hash_table)->entry_shift])
+
 typedef struct
 {
   GHashTable  *hash_table;
@@ -249,63 +386,50 @@ typedef struct
 G_STATIC_ASSERT (sizeof (GHashTableIter) == sizeof (RealIter));
 G_STATIC_ASSERT (_g_alignof (GHashTableIter) >= _g_alignof (RealIter));
 
-/* Each table size has an associated prime modulo (the first prime
- * lower than the table size) used to find the initial bucket. Probing
- * then works modulo 2^n. The prime modulo is necessary to get a
- * good distribution with poor hash functions.
- */
-static const gint prime_mod [] =
-{
-  1,          /* For 1 << 0 */
-  2,
-  3,
-  7,
-  13,
-  31,
-  61,
-  127,
-  251,
-  509,
-  1021,
-  2039,
-  4093,
-  8191,
-  16381,
-  32749,
-  65521,      /* For 1 << 16 */
-  131071,
-  262139,
-  524287,
-  1048573,
-  2097143,
-  4194301,
-  8388593,
-  16777213,
-  33554393,
-  67108859,
-  134217689,
-  268435399,
-  536870909,
-  1073741789,
-  2147483647  /* For 1 << 31 */
-};
+/* Storage of tables created with g_hash_table_new_in_arena() comes from
+ * the arena, and is only given back along with it.
+ */
+static inline gpointer
+g_hash_table_alloc0 (GHashTable *hash_table,
+                     gsize       size)
+{
+  if (G_UNLIKELY (hash_table->arena))
+    return g_arena_alloc0 (hash_table->arena, size);
+
+  return g_malloc0 (size);
+}
+
+static inline void
+g_hash_table_free_storage (GHashTable *hash_table,
+                           gpointer    mem)
+{
+  if (!hash_table->arena)
+    g_free (mem);
+}
+
+/* The hash value is scrambled with a multiplication, since the hash
+ * functions in common use give poorly distributed low bits; the group
+ * and the 7 bits kept in the control byte come from different parts of
+ * the product.
+ */
+static inline guint64
+g_hash_table_scramble (guint hash_value)
+{
+  return (guint64) hash_value * G_GUINT64_CONSTANT (0x9e3779b97f4a7c15);
+}
+
+#define SCRAMBLED_GROUP(hash_table, s_) ((guint) ((s_) >> 32) & (hash_table)->group_mask)
+#define SCRAMBLED_H2(s_)                ((guint8) ((s_) >> 57))
 
 static void
 g_hash_table_set_shift (GHashTable *hash_table, gint shift)
 {
-  gint i;
-  guint mask = 0;
-
   hash_table->size = 1 << shift;
-  hash_table->mod  = prime_mod [shift];
 
-  for (i = 0; i < shift; i++)
-    {
-      mask <<= 1;
-      mask |= 1;
-    }
-
-  hash_table->mask = mask;
+  if (hash_table->size > GROUP_WIDTH)
+    hash_table->group_mask = hash_table->size / GROUP_WIDTH - 1;
+  else
+    hash_table->group_mask = 0;
 }
 
 static gint
@@ -330,40 +454,80 @@ g_hash_table_set_shift_from_size (GHashTable *hash_table, gint size)
   g_hash_table_set_shift (hash_table, shift);
 }
 
+/* Allocates empty storage for the current size and entry layout */
+static void
+g_hash_table_setup_storage (GHashTable *hash_table)
+{
+  gsize n_ctrl = MAX (hash_table->size, GROUP_WIDTH);
+
+  if (G_UNLIKELY (hash_table->arena))
+    hash_table->ctrl = g_arena_alloc (hash_table->arena, n_ctrl);
+  else
+    hash_table->ctrl = g_malloc (n_ctrl);
+
+  memset (hash_table->ctrl, CTRL_EMPTY, hash_table->size);
+  memset (hash_table->ctrl + hash_table->size, CTRL_SENTINEL, n_ctrl - hash_table->size);
+
+  hash_table->keys = g_hash_table_alloc0 (hash_table,
+                                          (sizeof (gpointer) * hash_table->size) << hash_table->entry_shift);
+  hash_table->values = hash_table->keys + hash_table->entry_shift;
+}
+
 /*
- * g_hash_table_lookup_node:
+ * g_hash_table_set_ctrl_free:
+ * @hash_table: our #GHashTable
+ * @i: the slot to free
+ *
+ * Sets the control byte of a slot that is given up.  A tombstone is only
+ * needed if lookups may have probed past the group of the slot, which
+ * they have not as long as the group has an empty slot: a group that
+ * filled up gets no empty slots back until the table is resized.
+ *
+ * Returns: %TRUE if the slot became empty, and not a tombstone
+ */
+static inline gboolean
+g_hash_table_set_ctrl_free (GHashTable *hash_table,
+                            guint       i)
+{
+  guint group_start = i & ~(guint) (GROUP_WIDTH - 1);
+
+  if (group_match_empty (hash_table->ctrl + group_start))
+    {
+      hash_table->ctrl[i] = CTRL_EMPTY;
+      return TRUE;
+    }
+
+  hash_table->ctrl[i] = CTRL_TOMBSTONE;
+  return FALSE;
+}
+
+/*
+ * g_hash_table_lookup_node_hashed:
  * @hash_table: our #GHashTable
  * @key: the key to lookup against
- * @hash_return: key hash return location
+ * @hash_value: the hash value of @key
  *
  * Performs a lookup in the hash table, preserving extra information
  * usually needed for insertion.
  *
- * This function first computes the hash value of the key using the
- * user's hash function.
- *
  * If an entry in the table matching @key is found then this function
  * returns the index of that entry in the table, and if not, the
  * index of an unused node (empty or tombstone) where the key can be
  * inserted.
  *
- * The computed hash value is returned in the variable pointed to
- * by @hash_return. This is to save insertions from having to compute
- * the hash record again for the new record.
- *
  * Returns: index of the described node
  */
 static inline guint
-g_hash_table_lookup_node (GHashTable    *hash_table,
-                          gconstpointer  key,
-                          guint         *hash_return)
+g_hash_table_lookup_node_hashed (GHashTable    *hash_table,
+                                 gconstpointer  key,
+                                 guint          hash_value)
 {
-  guint node_index;
-  guint node_hash;
-  guint hash_value;
-  guint first_tombstone = 0;
-  gboolean have_tombstone = FALSE;
+  guint64 scrambled;
+  guint8 h2;
+  guint group;
   guint step = 0;
+  guint free_index = 0;
+  gboolean have_free = FALSE;
 
   /* If this happens, then the application is probably doing too much work
    * from a destroy notifier. The alternative would be to crash any second
@@ -372,24 +536,19 @@ g_hash_table_lookup_node (GHashTable    *hash_table,
    * table is empty prior to removing the last reference using g_hash_table_unref(). */
   g_assert (hash_table->ref_count > 0);
 
-  hash_value = hash_table->hash_func (key);
-  if (G_UNLIKELY (!HASH_IS_REAL (hash_value)))
-    hash_value = 2;
-
-  *hash_return = hash_value;
+  scrambled = g_hash_table_scramble (hash_value);
+  h2 = SCRAMBLED_H2 (scrambled);
+  group = SCRAMBLED_GROUP (hash_table, scrambled);
 
-  node_index = hash_value % hash_table->mod;
-  node_hash = hash_table->hashes[node_index];
-
-  while (!HASH_IS_UNUSED (node_hash))
+  while (TRUE)
     {
-      /* We first check if our full hash values
-       * are equal so we can avoid calling the full-blown
-       * key equality function in most cases.
-       */
-      if (node_hash == hash_value)
+      const guint8 *ctrl = hash_table->ctrl + group * GROUP_WIDTH;
+      GroupMask match;
+
+      for (match = group_match (ctrl, h2); match; GROUP_MASK_NEXT (match))
         {
-          gpointer node_key = hash_table->keys[node_index];
+          guint node_index = group * GROUP_WIDTH + group_mask_first (match);
+          gpointer node_key = NODE_KEY (hash_table, node_index);
 
           if (hash_table->key_equal_func)
             {
@@ -401,22 +560,53 @@ g_hash_table_lookup_node (GHashTable    *hash_table,
               return node_index;
             }
         }
-      else if (HASH_IS_TOMBSTONE (node_hash) && !have_tombstone)
+
+      /* Remember the first free slot, for the caller to insert into;
+       * it can be in an earlier group than the last one probed if
+       * there are tombstones.
+       */
+      if (!have_free)
         {
-          first_tombstone = node_index;
-          have_tombstone = TRUE;
+          match = group_match_free (ctrl);
+          if (match)
+            {
+              free_index = group * GROUP_WIDTH + group_mask_first (match);
+              have_free = TRUE;
+            }
         }
 
+      /* The load factor guarantees that there is an empty slot somewhere */
+      if (group_match_empty (ctrl))
+        return free_index;
+
       step++;
-      node_index += step;
-      node_index &= hash_table->mask;
-      node_hash = hash_table->hashes[node_index];
+      group = (group + step) & hash_table->group_mask;
     }
+}
 
-  if (have_tombstone)
-    return first_tombstone;
+/*
+ * g_hash_table_lookup_node:
+ * @hash_table: our #GHashTable
+ * @key: the key to lookup against
+ * @hash_return: key hash return location
+ *
+ * Like g_hash_table_lookup_node_hashed(), but first computes the hash
+ * value of the key using the user's hash function.
+ *
+ * The computed hash value is returned in the variable pointed to
+ * by @hash_return. This is to save insertions from having to compute
+ * the hash record again for the new record.
+ *
+ * Returns: index of the described node
+ */
+static inline guint
+g_hash_table_lookup_node (GHashTable    *hash_table,
+                          gconstpointer  key,
+                          guint         *hash_return)
+{
+  *hash_return = hash_table->hash_func (key);
 
-  return node_index;
+  return g_hash_table_lookup_node_hashed (hash_table, key, *hash_return);
 }
 
 /*
@@ -426,7 +616,8 @@ g_hash_table_lookup_node (GHashTable    *hash_table,
  * @notify: %TRUE if the destroy notify handlers are to be called
  *
  * Removes a node from the hash table and updates the node count.
- * The node is replaced by a tombstone. No table resize is performed.
+ * The node is replaced by a tombstone, unless it can be marked as
+ * empty right away. No table resize is performed.
  *
  * If @notify is %TRUE then the destroy notify functions are called
  * for the key and value of the hash node.
@@ -439,15 +630,15 @@ g_hash_table_remove_node (GHashTable   *hash_table,
   gpointer key;
   gpointer value;
 
-  key = hash_table->keys[i];
-  value = hash_table->values[i];
+  key = NODE_KEY (hash_table, i);
+  value = NODE_VALUE (hash_table, i);
 
-  /* Erect tombstone */
-  hash_table->hashes[i] = TOMBSTONE_HASH_VALUE;
+  if (g_hash_table_set_ctrl_free (hash_table, i))
+    hash_table->noccupied--;
 
   /* Be GC friendly */
-  hash_table->keys[i] = NULL;
-  hash_table->values[i] = NULL;
+  NODE_KEY (hash_table, i) = NULL;
+  NODE_VALUE (hash_table, i) = NULL;
 
   hash_table->nnodes--;
 
@@ -479,9 +670,9 @@ g_hash_table_remove_all_nodes (GHashTable *hash_table,
   gpointer key;
   gpointer value;
   gint old_size;
+  guint8   *old_ctrl;
   gpointer *old_keys;
-  gpointer *old_values;
-  guint    *old_hashes;
+  guint     old_entry_shift;
 
   /* If the hash table is already empty, there is nothing to be done. */
   if (hash_table->nnodes == 0)
@@ -496,9 +687,8 @@ g_hash_table_remove_all_nodes (GHashTable *hash_table,
     {
       if (!destruction)
         {
-          memset (hash_table->hashes, 0, hash_table->size * sizeof (guint));
-          memset (hash_table->keys, 0, hash_table->size * sizeof (gpointer));
-          memset (hash_table->values, 0, hash_table->size * sizeof (gpointer));
+          memset (hash_table->ctrl, CTRL_EMPTY, hash_table->size);
+          memset (hash_table->keys, 0, (hash_table->size * sizeof (gpointer)) << hash_table->entry_shift);
         }
 
       return;
@@ -506,9 +696,9 @@ g_hash_table_remove_all_nodes (GHashTable *hash_table,
 
   /* Keep the old storage space around to iterate over it. */
   old_size = hash_table->size;
-  old_keys   = hash_table->keys;
-  old_values = hash_table->values;
-  old_hashes = hash_table->hashes;
+  old_ctrl = hash_table->ctrl;
+  old_keys = hash_table->keys;
+  old_entry_shift = hash_table->entry_shift;
 
   /* Now create a new storage space; If the table is destroyed we can use the
    * shortcut of not creating a new storage. This saves the allocation at the
@@ -516,30 +706,29 @@ g_hash_table_remove_all_nodes (GHashTable *hash_table,
    * However, the application doesn't own any reference anymore, so access
    * is not allowed. If accesses are done, then either an assert or crash
    * *will* happen. */
-  g_hash_table_set_shift (hash_table, HASH_TABLE_MIN_SHIFT);
+  g_hash_table_set_shift_from_size (hash_table, MAX (hash_table->min_size - 1, 0));
+  hash_table->entry_shift = 0;
   if (!destruction)
-    {
-      hash_table->keys   = g_new0 (gpointer, hash_table->size);
-      hash_table->values = hash_table->keys;
-      hash_table->hashes = g_new0 (guint, hash_table->size);
-    }
+    g_hash_table_setup_storage (hash_table);
   else
     {
+      hash_table->ctrl   = NULL;
       hash_table->keys   = NULL;
       hash_table->values = NULL;
-      hash_table->hashes = NULL;
     }
 
   for (i = 0; i < old_size; i++)
     {
-      if (HASH_IS_REAL (old_hashes[i]))
+      if (CTRL_IS_FULL (old_ctrl[i]))
         {
-          key = old_keys[i];
-          value = old_values[i];
+          gsize entry = (gsize) i << old_entry_shift;
+
+          key = old_keys[entry];
+          value = old_keys[entry + old_entry_shift];
 
-          old_hashes[i] = UNUSED_HASH_VALUE;
-          old_keys[i] = NULL;
-          old_values[i] = NULL;
+          old_ctrl[i] = CTRL_EMPTY;
+          old_keys[entry] = NULL;
+          old_keys[entry + old_entry_shift] = NULL;
 
           if (hash_table->key_destroy_func != NULL)
             hash_table->key_destroy_func (key);
@@ -550,11 +739,8 @@ g_hash_table_remove_all_nodes (GHashTable *hash_table,
     }
 
   /* Destroy old storage space. */
-  if (old_keys != old_values)
-    g_free (old_values);
-
-  g_free (old_keys);
-  g_free (old_hashes);
+  g_hash_table_free_storage (hash_table, old_keys);
+  g_hash_table_free_storage (hash_table, old_ctrl);
 }
 
 /*
@@ -569,58 +755,70 @@ g_hash_table_remove_all_nodes (GHashTable *hash_table,
  * This function may "resize" the hash table to its current size, with
  * the side effect of cleaning up tombstones and otherwise optimizing
  * the probe sequences.
+ *
+ * Since the group of a key is taken from the low bits of its scrambled
+ * hash, old groups are spread over new groups in order, which keeps the
+ * writes into the new storage local when the table grows.
  */
 static void
 g_hash_table_resize (GHashTable *hash_table)
 {
-  gpointer *new_keys;
-  gpointer *new_values;
-  guint *new_hashes;
+  GHashFunc hash_func = hash_table->hash_func;
+  guint8 *old_ctrl, *new_ctrl;
+  gpointer *old_keys, *new_keys;
+  guint entry_shift;
+  guint group_mask;
   gint old_size;
   gint i;
 
   old_size = hash_table->size;
-  g_hash_table_set_shift_from_size (hash_table, hash_table->nnodes * 2);
+  old_ctrl = hash_table->ctrl;
+  old_keys = hash_table->keys;
+  entry_shift = hash_table->entry_shift;
 
-  new_keys = g_new0 (gpointer, hash_table->size);
-  if (hash_table->keys == hash_table->values)
-    new_values = new_keys;
-  else
-    new_values = g_new0 (gpointer, hash_table->size);
-  new_hashes = g_new0 (guint, hash_table->size);
+  /* leaves the table at most half full, and at least as large as
+   * reserved
+   */
+  g_hash_table_set_shift_from_size (hash_table, MAX (MAX (hash_table->nnodes * 2, hash_table->min_size) - 1, 0));
+  g_hash_table_setup_storage (hash_table);
+
+  new_ctrl = hash_table->ctrl;
+  new_keys = hash_table->keys;
+  group_mask = hash_table->group_mask;
 
   for (i = 0; i < old_size; i++)
     {
-      guint node_hash = hash_table->hashes[i];
-      guint hash_val;
+      gsize entry = (gsize) i << entry_shift;
+      gsize new_entry;
+      guint64 scrambled;
+      guint group;
       guint step = 0;
+      guint node_index;
+      GroupMask match;
 
-      if (!HASH_IS_REAL (node_hash))
+      if (!CTRL_IS_FULL (old_ctrl[i]))
         continue;
 
-      hash_val = node_hash % hash_table->mod;
+      /* There are no tombstones yet, nor keys that compare equal */
+      scrambled = g_hash_table_scramble (hash_func (old_keys[entry]));
+      group = (guint) (scrambled >> 32) & group_mask;
 
-      while (!HASH_IS_UNUSED (new_hashes[hash_val]))
+      while (!(match = group_match_empty (new_ctrl + group * GROUP_WIDTH)))
         {
           step++;
-          hash_val += step;
-          hash_val &= hash_table->mask;
+          group = (group + step) & group_mask;
         }
 
-      new_hashes[hash_val] = hash_table->hashes[i];
-      new_keys[hash_val] = hash_table->keys[i];
-      new_values[hash_val] = hash_table->values[i];
-    }
-
-  if (hash_table->keys != hash_table->values)
-    g_free (hash_table->values);
+      node_index = group * GROUP_WIDTH + group_mask_first (match);
+      new_ctrl[node_index] = SCRAMBLED_H2 (scrambled);
 
-  g_free (hash_table->keys);
-  g_free (hash_table->hashes);
+      new_entry = (gsize) node_index << entry_shift;
+      new_keys[new_entry] = old_keys[entry];
+      new_keys[new_entry + entry_shift] = old_keys[entry + entry_shift];
+    }
 
-  hash_table->keys = new_keys;
-  hash_table->values = new_values;
-  hash_table->hashes = new_hashes;
+  g_hash_table_free_storage (hash_table, old_keys);
+  g_hash_table_free_storage (hash_table, old_ctrl);
 
   hash_table->noccupied = hash_table->nnodes;
 }
@@ -632,7 +830,8 @@ g_hash_table_resize (GHashTable *hash_table)
  * Resizes the hash table, if needed.
  *
  * Essentially, calls g_hash_table_resize() if the table has strayed
- * too far from its ideal size for its number of nodes.
+ * too far from its ideal size for its number of nodes: if it is more
+ * than 7/8 full counting the tombstones, or less than 1/8 full.
  */
 static inline void
 g_hash_table_maybe_resize (GHashTable *hash_table)
@@ -640,11 +839,36 @@ g_hash_table_maybe_resize (GHashTable *hash_table)
   gint noccupied = hash_table->noccupied;
   gint size = hash_table->size;
 
-  if ((size > hash_table->nnodes * 4 && size > 1 << HASH_TABLE_MIN_SHIFT) ||
-      (size <= noccupied + (noccupied / 16)))
+  if ((size > hash_table->nnodes * 8 && size > 1 << HASH_TABLE_MIN_SHIFT &&
+       size > hash_table->min_size) ||
+      (noccupied >= size - size / 8))
     g_hash_table_resize (hash_table);
 }
 
+/*
+ * g_hash_table_split_values:
+ * @hash_table: our #GHashTable
+ *
+ * Makes room for values that differ from their keys, by turning the
+ * array of keys into one of key/value pairs.
+ */
+static void
+g_hash_table_split_values (GHashTable *hash_table)
+{
+  gpointer *entries;
+  gint i;
+
+  entries = g_hash_table_alloc0 (hash_table, sizeof (gpointer) * 2 * hash_table->size);
+  for (i = 0; i < hash_table->size; i++)
+    entries[2 * i] = entries[2 * i + 1] = hash_table->keys[i];
+
+  g_hash_table_free_storage (hash_table, hash_table->keys);
+
+  hash_table->keys = entries;
+  hash_table->values = entries + 1;
+  hash_table->entry_shift = 1;
+}
+
 /**
  * g_hash_table_new:
  * @hash_func: a function to create a hash value from a key
@@ -711,9 +935,11 @@ g_hash_table_new_full (GHashFunc      hash_func,
   GHashTable *hash_table;
 
   hash_table = g_slice_new (GHashTable);
+  hash_table->arena              = NULL;
   g_hash_table_set_shift (hash_table, HASH_TABLE_MIN_SHIFT);
   hash_table->nnodes             = 0;
   hash_table->noccupied          = 0;
+  hash_table->min_size           = 0;
   hash_table->hash_func          = hash_func ? hash_func : g_direct_hash;
   hash_table->key_equal_func     = key_equal_func;
   hash_table->ref_count          = 1;
@@ -722,9 +948,58 @@ g_hash_table_new_full (GHashFunc      hash_func,
 #endif
   hash_table->key_destroy_func   = key_destroy_func;
   hash_table->value_destroy_func = value_destroy_func;
-  hash_table->keys               = g_new0 (gpointer, hash_table->size);
-  hash_table->values             = hash_table->keys;
-  hash_table->hashes             = g_new0 (guint, hash_table->size);
+  hash_table->entry_shift        = 0;
+  g_hash_table_setup_storage (hash_table);
+
+  return hash_table;
+}
+
+/**
+ * g_hash_table_new_in_arena:
+ * @arena: a #GArena
+ * @hash_func: a function to create a hash value from a key
+ * @key_equal_func: a function to check two keys for equality
+ *
+ * Creates a new #GHashTable inside @arena, with a reference count of 1,
+ * like g_hash_table_new().
+ *
+ * The #GHashTable and its storage are allocated from @arena, also when
+ * the table grows; they are released along with @arena and stay valid
+ * until then.  The table may be left for @arena to release, or be freed
+ * with g_hash_table_unref() as usual, which gives no memory back.
+ *
+ * Keys and values are typically allocated from @arena as well, so
+ * there are no destroy notifiers for them.
+ *
+ * Returns: (transfer none): a new #GHashTable
+ *
+ * Since: 2.54
+ */
+GHashTable *
+g_hash_table_new_in_arena (GArena     *arena,
+                           GHashFunc   hash_func,
+                           GEqualFunc  key_equal_func)
+{
+  GHashTable *hash_table;
+
+  g_return_val_if_fail (arena != NULL, NULL);
+
+  hash_table = g_arena_alloc (arena, sizeof (GHashTable));
+  hash_table->arena              = arena;
+  g_hash_table_set_shift (hash_table, HASH_TABLE_MIN_SHIFT);
+  hash_table->nnodes             = 0;
+  hash_table->noccupied          = 0;
+  hash_table->min_size           = 0;
+  hash_table->hash_func          = hash_func ? hash_func : g_direct_hash;
+  hash_table->key_equal_func     = key_equal_func;
+  hash_table->ref_count          = 1;
+#ifndef G_DISABLE_ASSERT
+  hash_table->version            = 0;
+#endif
+  hash_table->key_destroy_func   = NULL;
+  hash_table->value_destroy_func = NULL;
+  hash_table->entry_shift        = 0;
+  g_hash_table_setup_storage (hash_table);
 
   return hash_table;
 }
@@ -805,12 +1080,12 @@ g_hash_table_iter_next (GHashTableIter *iter,
           return FALSE;
         }
     }
-  while (!HASH_IS_REAL (ri->hash_table->hashes[position]));
+  while (!CTRL_IS_FULL (ri->hash_table->ctrl[position]));
 
   if (key != NULL)
-    *key = ri->hash_table->keys[position];
+    *key = NODE_KEY (ri->hash_table, position);
   if (value != NULL)
-    *value = ri->hash_table->values[position];
+    *value = NODE_VALUE (ri->hash_table, position);
 
   ri->position = position;
   return TRUE;
@@ -911,12 +1186,12 @@ g_hash_table_insert_node (GHashTable *hash_table,
                           gboolean    reusing_key)
 {
   gboolean already_exists;
-  guint old_hash;
+  guint8 old_ctrl;
   gpointer key_to_free = NULL;
   gpointer value_to_free = NULL;
 
-  old_hash = hash_table->hashes[node_index];
-  already_exists = HASH_IS_REAL (old_hash);
+  old_ctrl = hash_table->ctrl[node_index];
+  already_exists = CTRL_IS_FULL (old_ctrl);
 
   /* Proceed in three steps.  First, deal with the key because it is the
    * most complicated.  Then consider if we need to split the table in
@@ -942,38 +1217,38 @@ g_hash_table_insert_node (GHashTable *hash_table,
        * because we might change the value in the event that the two
        * arrays are shared.
        */
-      value_to_free = hash_table->values[node_index];
+      value_to_free = NODE_VALUE (hash_table, node_index);
 
       if (keep_new_key)
         {
-          key_to_free = hash_table->keys[node_index];
-          hash_table->keys[node_index] = new_key;
+          key_to_free = NODE_KEY (hash_table, node_index);
+          NODE_KEY (hash_table, node_index) = new_key;
         }
       else
         key_to_free = new_key;
     }
   else
     {
-      hash_table->hashes[node_index] = key_hash;
-      hash_table->keys[node_index] = new_key;
+      hash_table->ctrl[node_index] = SCRAMBLED_H2 (g_hash_table_scramble (key_hash));
+      NODE_KEY (hash_table, node_index) = new_key;
     }
 
   /* Step two: check if the value that we are about to write to the
    * table is the same as the key in the same position.  If it's not,
    * split the table.
    */
-  if (G_UNLIKELY (hash_table->keys == hash_table->values && hash_table->keys[node_index] != new_value))
-    hash_table->values = g_memdup (hash_table->keys, sizeof (gpointer) * hash_table->size);
+  if (G_UNLIKELY (hash_table->entry_shift == 0 && NODE_KEY (hash_table, node_index) != new_value))
+    g_hash_table_split_values (hash_table);
 
   /* Step 3: Actually do the write */
-  hash_table->values[node_index] = new_value;
+  NODE_VALUE (hash_table, node_index) = new_value;
 
   /* Now, the bookkeeping... */
   if (!already_exists)
     {
       hash_table->nnodes++;
 
-      if (HASH_IS_UNUSED (old_hash))
+      if (old_ctrl == CTRL_EMPTY)
         {
           /* We replaced an empty node, and not a tombstone */
           hash_table->noccupied++;
@@ -1015,7 +1290,6 @@ g_hash_table_iter_replace (GHashTableIter *iter,
                            gpointer        value)
 {
   RealIter *ri;
-  guint node_hash;
   gpointer key;
 
   ri = (RealIter *) iter;
@@ -1027,10 +1301,10 @@ g_hash_table_iter_replace (GHashTableIter *iter,
   g_return_if_fail (ri->position >= 0);
   g_return_if_fail (ri->position < ri->hash_table->size);
 
-  node_hash = ri->hash_table->hashes[ri->position];
-  key = ri->hash_table->keys[ri->position];
+  key = NODE_KEY (ri->hash_table, ri->position);
 
-  g_hash_table_insert_node (ri->hash_table, ri->position, node_hash, key, value, TRUE, TRUE);
+  /* the node exists, so its hash is not needed */
+  g_hash_table_insert_node (ri->hash_table, ri->position, 0, key, value, TRUE, TRUE);
 
 #ifndef G_DISABLE_ASSERT
   ri->version++;
@@ -1097,10 +1371,10 @@ g_hash_table_unref (GHashTable *hash_table)
   if (g_atomic_int_dec_and_test (&hash_table->ref_count))
     {
       g_hash_table_remove_all_nodes (hash_table, TRUE, TRUE);
-      if (hash_table->keys != hash_table->values)
-        g_free (hash_table->values);
+      if (hash_table->arena)
+        return;
       g_free (hash_table->keys);
-      g_free (hash_table->hashes);
+      g_free (hash_table->ctrl);
       g_slice_free (GHashTable, hash_table);
     }
 }
@@ -1148,8 +1422,8 @@ g_hash_table_lookup (GHashTable    *hash_table,
 
   node_index = g_hash_table_lookup_node (hash_table, key, &node_hash);
 
-  return HASH_IS_REAL (hash_table->hashes[node_index])
-    ? hash_table->values[node_index]
+  return CTRL_IS_FULL (hash_table->ctrl[node_index])
+    ? NODE_VALUE (hash_table, node_index)
     : NULL;
 }
 
@@ -1185,14 +1459,90 @@ g_hash_table_lookup_extended (GHashTable    *hash_table,
 
   node_index = g_hash_table_lookup_node (hash_table, lookup_key, &node_hash);
 
-  if (!HASH_IS_REAL (hash_table->hashes[node_index]))
+  if (!CTRL_IS_FULL (hash_table->ctrl[node_index]))
+    return FALSE;
+
+  if (orig_key)
+    *orig_key = NODE_KEY (hash_table, node_index);
+
+  if (value)
+    *value = NODE_VALUE (hash_table, node_index);
+
+  return TRUE;
+}
+
+/**
+ * g_hash_table_lookup_hashed:
+ * @hash_table: a #GHashTable
+ * @key: the key to look up
+ * @hash_value: the hash value of @key
+ *
+ * Looks up a key in a #GHashTable like g_hash_table_lookup(), but uses
+ * @hash_value instead of calling the hash function of @hash_table.
+ *
+ * This saves computing the hash of @key again when it is already known,
+ * for example from an earlier lookup in another table with the same hash
+ * function.  @hash_value must be what that hash function returns for
+ * @key, or the key is not found.
+ *
+ * Returns: (nullable): the associated value, or %NULL if the key is not found
+ *
+ * Since: 2.54
+ */
+gpointer
+g_hash_table_lookup_hashed (GHashTable    *hash_table,
+                            gconstpointer  key,
+                            guint          hash_value)
+{
+  guint node_index;
+
+  g_return_val_if_fail (hash_table != NULL, NULL);
+
+  node_index = g_hash_table_lookup_node_hashed (hash_table, key, hash_value);
+
+  return CTRL_IS_FULL (hash_table->ctrl[node_index])
+    ? NODE_VALUE (hash_table, node_index)
+    : NULL;
+}
+
+/**
+ * g_hash_table_lookup_extended_hashed:
+ * @hash_table: a #GHashTable
+ * @lookup_key: the key to look up
+ * @hash_value: the hash value of @lookup_key
+ * @orig_key: (out) (optional): return location for the original key
+ * @value: (out) (optional): return location for the value associated
+ * with the key
+ *
+ * Looks up a key in a #GHashTable like g_hash_table_lookup_extended(),
+ * but uses @hash_value instead of calling the hash function of
+ * @hash_table; see g_hash_table_lookup_hashed().
+ *
+ * Returns: %TRUE if the key was found in the #GHashTable
+ *
+ * Since: 2.54
+ */
+gboolean
+g_hash_table_lookup_extended_hashed (GHashTable    *hash_table,
+                                     gconstpointer  lookup_key,
+                                     guint          hash_value,
+                                     gpointer      *orig_key,
+                                     gpointer      *value)
+{
+  guint node_index;
+
+  g_return_val_if_fail (hash_table != NULL, FALSE);
+
+  node_index = g_hash_table_lookup_node_hashed (hash_table, lookup_key, hash_value);
+
+  if (!CTRL_IS_FULL (hash_table->ctrl[node_index]))
     return FALSE;
 
   if (orig_key)
-    *orig_key = hash_table->keys[node_index];
+    *orig_key = NODE_KEY (hash_table, node_index);
 
   if (value)
-    *value = hash_table->values[node_index];
+    *value = NODE_VALUE (hash_table, node_index);
 
   return TRUE;
 }
@@ -1231,6 +1581,63 @@ g_hash_table_insert_internal (GHashTable *hash_table,
   return g_hash_table_insert_node (hash_table, node_index, key_hash, key, value, keep_new_key, FALSE);
 }
 
+/*
+ * The following are for #GConcurrentHashTable, which computes the hash
+ * value of a key once to pick a shard and passes it on.  They never
+ * call destroy notifiers; the caller gets the displaced key and value
+ * back instead, to free them once it has dropped its lock.
+ */
+gboolean
+g_hash_table_exchange_hashed (GHashTable *hash_table,
+                              gpointer    key,
+                              gpointer    value,
+                              guint       hash_value,
+                              gboolean    keep_new_key,
+                              gpointer   *old_key,
+                              gpointer   *old_value)
+{
+  guint node_index;
+
+  g_assert (hash_table->key_destroy_func == NULL && hash_table->value_destroy_func == NULL);
+
+  node_index = g_hash_table_lookup_node_hashed (hash_table, key, hash_value);
+
+  if (CTRL_IS_FULL (hash_table->ctrl[node_index]))
+    {
+      *old_key = NODE_KEY (hash_table, node_index);
+      *old_value = NODE_VALUE (hash_table, node_index);
+    }
+
+  return g_hash_table_insert_node (hash_table, node_index, hash_value, key, value, keep_new_key, FALSE);
+}
+
+gboolean
+g_hash_table_steal_hashed (GHashTable    *hash_table,
+                           gconstpointer  key,
+                           guint          hash_value,
+                           gpointer      *orig_key,
+                           gpointer      *value)
+{
+  guint node_index;
+
+  node_index = g_hash_table_lookup_node_hashed (hash_table, key, hash_value);
+
+  if (!CTRL_IS_FULL (hash_table->ctrl[node_index]))
+    return FALSE;
+
+  *orig_key = NODE_KEY (hash_table, node_index);
+  *value = NODE_VALUE (hash_table, node_index);
+
+  g_hash_table_remove_node (hash_table, node_index, FALSE);
+  g_hash_table_maybe_resize (hash_table);
+
+#ifndef G_DISABLE_ASSERT
+  hash_table->version++;
+#endif
+
+  return TRUE;
+}
+
 /**
  * g_hash_table_insert:
  * @hash_table: a #GHashTable
@@ -1304,6 +1711,112 @@ g_hash_table_add (GHashTable *hash_table,
   return g_hash_table_insert_internal (hash_table, key, key, TRUE);
 }
 
+/**
+ * g_hash_table_insert_hashed:
+ * @hash_table: a #GHashTable
+ * @key: a key to insert
+ * @value: the value to associate with the key
+ * @hash_value: the hash value of @key
+ *
+ * Inserts a new key and value into a #GHashTable like
+ * g_hash_table_insert(), but uses @hash_value instead of calling the
+ * hash function of @hash_table.
+ *
+ * @hash_value must be what that hash function returns for @key, since
+ * it is still called for all keys when the table is resized.
+ *
+ * Returns: %TRUE if the key did not exist yet
+ *
+ * Since: 2.54
+ */
+gboolean
+g_hash_table_insert_hashed (GHashTable *hash_table,
+                            gpointer    key,
+                            gpointer    value,
+                            guint       hash_value)
+{
+  guint node_index;
+
+  g_return_val_if_fail (hash_table != NULL, FALSE);
+
+  node_index = g_hash_table_lookup_node_hashed (hash_table, key, hash_value);
+
+  return g_hash_table_insert_node (hash_table, node_index, hash_value, key, value, FALSE, FALSE);
+}
+
+/**
+ * g_hash_table_replace_hashed:
+ * @hash_table: a #GHashTable
+ * @key: a key to insert
+ * @value: the value to associate with the key
+ * @hash_value: the hash value of @key
+ *
+ * Inserts a new key and value into a #GHashTable like
+ * g_hash_table_replace(), but uses @hash_value instead of calling the
+ * hash function of @hash_table; see g_hash_table_insert_hashed().
+ *
+ * Returns: %TRUE if the key did not exist yet
+ *
+ * Since: 2.54
+ */
+gboolean
+g_hash_table_replace_hashed (GHashTable *hash_table,
+                             gpointer    key,
+                             gpointer    value,
+                             guint       hash_value)
+{
+  guint node_index;
+
+  g_return_val_if_fail (hash_table != NULL, FALSE);
+
+  node_index = g_hash_table_lookup_node_hashed (hash_table, key, hash_value);
+
+  return g_hash_table_insert_node (hash_table, node_index, hash_value, key, value, TRUE, FALSE);
+}
+
+/**
+ * g_hash_table_reserve:
+ * @hash_table: a #GHashTable
+ * @n_elements: the number of entries to make room for
+ *
+ * Resizes @hash_table so that it can hold @n_elements entries without
+ * growing again, which avoids resizing it over and over while filling
+ * it with a known number of entries.
+ *
+ * The table also does not shrink below that size any more as entries
+ * are removed.  Call this again with a smaller number, or 0, to let it
+ * shrink again.
+ *
+ * Since: 2.54
+ */
+void
+g_hash_table_reserve (GHashTable *hash_table,
+                      guint       n_elements)
+{
+  gint shift;
+
+  g_return_if_fail (hash_table != NULL);
+  g_return_if_fail (n_elements <= G_MAXINT / 2);
+
+  if (n_elements > 0)
+    {
+      /* g_hash_table_maybe_resize() grows the table once it is 7/8 full */
+      shift = g_hash_table_find_closest_shift (n_elements + n_elements / 7);
+      hash_table->min_size = 1 << MAX (shift, HASH_TABLE_MIN_SHIFT);
+    }
+  else
+    hash_table->min_size = 0;
+
+  if (hash_table->size < hash_table->min_size)
+    g_hash_table_resize (hash_table);
+  else
+    g_hash_table_maybe_resize (hash_table);
+
+#ifndef G_DISABLE_ASSERT
+  hash_table->version++;
+#endif
+}
+
 /**
  * g_hash_table_contains:
  * @hash_table: a #GHashTable
@@ -1326,7 +1839,7 @@ g_hash_table_contains (GHashTable    *hash_table,
 
   node_index = g_hash_table_lookup_node (hash_table, key, &node_hash);
 
-  return HASH_IS_REAL (hash_table->hashes[node_index]);
+  return CTRL_IS_FULL (hash_table->ctrl[node_index]);
 }
 
 /*
@@ -1354,7 +1867,7 @@ g_hash_table_remove_internal (GHashTable    *hash_table,
 
   node_index = g_hash_table_lookup_node (hash_table, key, &node_hash);
 
-  if (!HASH_IS_REAL (hash_table->hashes[node_index]))
+  if (!CTRL_IS_FULL (hash_table->ctrl[node_index]))
     return FALSE;
 
   g_hash_table_remove_node (hash_table, node_index, notify);
@@ -1486,11 +1999,11 @@ g_hash_table_foreach_remove_or_steal (GHashTable *hash_table,
 
   for (i = 0; i < hash_table->size; i++)
     {
-      guint node_hash = hash_table->hashes[i];
-      gpointer node_key = hash_table->keys[i];
-      gpointer node_value = hash_table->values[i];
+      guint8 node_ctrl = hash_table->ctrl[i];
+      gpointer node_key = NODE_KEY (hash_table, i);
+      gpointer node_value = NODE_VALUE (hash_table, i);
 
-      if (HASH_IS_REAL (node_hash) &&
+      if (CTRL_IS_FULL (node_ctrl) &&
           (* func) (node_key, node_value, user_data))
         {
           g_hash_table_remove_node (hash_table, i, notify);
@@ -1602,11 +2115,11 @@ g_hash_table_foreach (GHashTable *hash_table,
 
   for (i = 0; i < hash_table->size; i++)
     {
-      guint node_hash = hash_table->hashes[i];
-      gpointer node_key = hash_table->keys[i];
-      gpointer node_value = hash_table->values[i];
+      guint8 node_ctrl = hash_table->ctrl[i];
+      gpointer node_key = NODE_KEY (hash_table, i);
+      gpointer node_value = NODE_VALUE (hash_table, i);
 
-      if (HASH_IS_REAL (node_hash))
+      if (CTRL_IS_FULL (node_ctrl))
         (* func) (node_key, node_value, user_data);
 
 #ifndef G_DISABLE_ASSERT
@@ -1663,11 +2176,11 @@ g_hash_table_find (GHashTable *hash_table,
 
   for (i = 0; i < hash_table->size; i++)
     {
-      guint node_hash = hash_table->hashes[i];
-      gpointer node_key = hash_table->keys[i];
-      gpointer node_value = hash_table->values[i];
+      guint8 node_ctrl = hash_table->ctrl[i];
+      gpointer node_key = NODE_KEY (hash_table, i);
+      gpointer node_value = NODE_VALUE (hash_table, i);
 
-      if (HASH_IS_REAL (node_hash))
+      if (CTRL_IS_FULL (node_ctrl))
         match = predicate (node_key, node_value, user_data);
 
 #ifndef G_DISABLE_ASSERT
@@ -1726,8 +2239,8 @@ g_hash_table_get_keys (GHashTable *hash_table)
   retval = NULL;
   for (i = 0; i < hash_table->size; i++)
     {
-      if (HASH_IS_REAL (hash_table->hashes[i]))
-        retval = g_list_prepend (retval, hash_table->keys[i]);
+      if (CTRL_IS_FULL (hash_table->ctrl[i]))
+        retval = g_list_prepend (retval, NODE_KEY (hash_table, i));
     }
 
   return retval;
@@ -1771,8 +2284,8 @@ g_hash_table_get_keys_as_array (GHashTable *hash_table,
   result = g_new (gpointer, hash_table->nnodes + 1);
   for (i = 0; i < hash_table->size; i++)
     {
-      if (HASH_IS_REAL (hash_table->hashes[i]))
-        result[j++] = hash_table->keys[i];
+      if (CTRL_IS_FULL (hash_table->ctrl[i]))
+        result[j++] = NODE_KEY (hash_table, i);
     }
   g_assert_cmpint (j, ==, hash_table->nnodes);
   result[j] = NULL;
@@ -1812,8 +2325,8 @@ g_hash_table_get_values (GHashTable *hash_table)
   retval = NULL;
   for (i = 0; i < hash_table->size; i++)
     {
-      if (HASH_IS_REAL (hash_table->hashes[i]))
-        retval = g_list_prepend (retval, hash_table->values[i]);
+      if (CTRL_IS_FULL (hash_table->ctrl[i]))
+        retval = g_list_prepend (retval, NODE_VALUE (hash_table, i));
     }
 
   return retval;
@@ -1881,6 +2394,123 @@ g_str_hash (gconstpointer v)
   return h;
 }
 
+/* SipHash-1-3, keyed with a random seed chosen once per process */
+static guint64 str_hash_seed[2];
+
+#define SIP_ROTL(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+#define SIP_ROUND(v0, v1, v2, v3)                          \
+  G_STMT_START {                                           \
+    v0 += v1; v1 = SIP_ROTL (v1, 13); v1 ^= v0;            \
+    v0 = SIP_ROTL (v0, 32);                                \
+    v2 += v3; v3 = SIP_ROTL (v3, 16); v3 ^= v2;            \
+    v0 += v3; v3 = SIP_ROTL (v3, 21); v3 ^= v0;            \
+    v2 += v1; v1 = SIP_ROTL (v1, 17); v1 ^= v2;            \
+    v2 = SIP_ROTL (v2, 32);                                \
+  } G_STMT_END
+
+static void
+str_hash_seed_init (void)
+{
+  static gsize initialised;
+
+  if (g_once_init_enter (&initialised))
+    {
+      GRand *rand;
+
+      /* Not the global generator: programs (and g_test_init()) can
+       * seed that with a known value.  A new GRand is seeded from
+       * /dev/urandom where available.
+       */
+      rand = g_rand_new ();
+      str_hash_seed[0] = ((guint64) g_rand_int (rand) << 32) | g_rand_int (rand);
+      str_hash_seed[1] = ((guint64) g_rand_int (rand) << 32) | g_rand_int (rand);
+      g_rand_free (rand);
+
+      g_once_init_leave (&initialised, 1);
+    }
+}
+
+static guint64
+siphash13 (const guint8 *data,
+           gsize         len)
+{
+  guint64 v0 = str_hash_seed[0] ^ G_GUINT64_CONSTANT (0x736f6d6570736575);
+  guint64 v1 = str_hash_seed[1] ^ G_GUINT64_CONSTANT (0x646f72616e646f6d);
+  guint64 v2 = str_hash_seed[0] ^ G_GUINT64_CONSTANT (0x6c7967656e657261);
+  guint64 v3 = str_hash_seed[1] ^ G_GUINT64_CONSTANT (0x7465646279746573);
+  guint64 m, b = (guint64) len << 56;
+  const guint8 *end = data + (len & ~(gsize) 7);
+
+  for (; data != end; data += 8)
+    {
+      memcpy (&m, data, 8);
+      m = GUINT64_FROM_LE (m);
+
+      v3 ^= m;
+      SIP_ROUND (v0, v1, v2, v3);
+      v0 ^= m;
+    }
+
+  switch (len & 7)
+    {
+    case 7: b |= (guint64) data[6] << 48; /* fall through */
+    case 6: b |= (guint64) data[5] << 40; /* fall through */
+    case 5: b |= (guint64) data[4] << 32; /* fall through */
+    case 4: b |= (guint64) data[3] << 24; /* fall through */
+    case 3: b |= (guint64) data[2] << 16; /* fall through */
+    case 2: b |= (guint64) data[1] << 8;  /* fall through */
+    case 1: b |= (guint64) data[0];
+    }
+
+  v3 ^= b;
+  SIP_ROUND (v0, v1, v2, v3);
+  v0 ^= b;
+
+  v2 ^= 0xff;
+  SIP_ROUND (v0, v1, v2, v3);
+  SIP_ROUND (v0, v1, v2, v3);
+  SIP_ROUND (v0, v1, v2, v3);
+
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/**
+ * g_str_hash_seeded:
+ * @v: (not nullable): a string key
+ *
+ * Converts a string to a hash value, like g_str_hash(), but with
+ * SipHash-1-3 keyed with a random seed that is chosen once per process.
+ *
+ * It works on eight bytes of the string at a time, so it is faster
+ * than g_str_hash() for strings longer than a few dozen bytes, like
+ * paths and URLs, though somewhat slower for very short ones.  And
+ * since the hash values cannot be predicted from outside the process,
+ * it is not possible to make many keys collide on purpose, which makes
+ * it the right choice for tables of keys that come from untrusted
+ * input.
+ *
+ * The hash value of a string differs between processes, so it must
+ * not be stored or sent elsewhere; use g_str_hash() for that.
+ *
+ * It can be passed to g_hash_table_new() as the @hash_func parameter,
+ * when using non-%NULL strings as keys in a #GHashTable.
+ *
+ * Returns: a hash value corresponding to the key
+ *
+ * Since: 2.54
+ */
+guint
+g_str_hash_seeded (gconstpointer v)
+{
+  guint64 h;
+
+  str_hash_seed_init ();
+
+  h = siphash13 (v, strlen (v));
+
+  return (guint) (h ^ (h >> 32));
+}
+
 /**
  * g_direct_hash:
  * @v: (nullable): a #gpointer key
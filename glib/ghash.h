@@ -30,6 +30,7 @@
 #endif
 
 #include <glib/gtypes.h>
+#include <glib/garena.h>
 #include <glib/glist.h>
 
 G_BEGIN_DECLS
@@ -61,6 +62,10 @@ GHashTable* g_hash_table_new_full          (GHashFunc       hash_func,
                                             GEqualFunc      key_equal_func,
                                             GDestroyNotify  key_destroy_func,
                                             GDestroyNotify  value_destroy_func);
+GLIB_AVAILABLE_IN_2_54
+GHashTable* g_hash_table_new_in_arena      (GArena         *arena,
+                                            GHashFunc       hash_func,
+                                            GEqualFunc      key_equal_func);
 GLIB_AVAILABLE_IN_ALL
 void        g_hash_table_destroy           (GHashTable     *hash_table);
 GLIB_AVAILABLE_IN_ALL
@@ -121,6 +126,30 @@ GLIB_AVAILABLE_IN_2_40
 gpointer *  g_hash_table_get_keys_as_array (GHashTable     *hash_table,
                                             guint          *length);
 
+GLIB_AVAILABLE_IN_2_54
+gpointer    g_hash_table_lookup_hashed          (GHashTable     *hash_table,
+                                                 gconstpointer   key,
+                                                 guint           hash_value);
+GLIB_AVAILABLE_IN_2_54
+gboolean    g_hash_table_lookup_extended_hashed (GHashTable     *hash_table,
+                                                 gconstpointer   lookup_key,
+                                                 guint           hash_value,
+                                                 gpointer       *orig_key,
+                                                 gpointer       *value);
+GLIB_AVAILABLE_IN_2_54
+gboolean    g_hash_table_insert_hashed          (GHashTable     *hash_table,
+                                                 gpointer        key,
+                                                 gpointer        value,
+                                                 guint           hash_value);
+GLIB_AVAILABLE_IN_2_54
+gboolean    g_hash_table_replace_hashed         (GHashTable     *hash_table,
+                                                 gpointer        key,
+                                                 gpointer        value,
+                                                 guint           hash_value);
+GLIB_AVAILABLE_IN_2_54
+void        g_hash_table_reserve                (GHashTable     *hash_table,
+                                                 guint           n_elements);
+
 GLIB_AVAILABLE_IN_ALL
 void        g_hash_table_iter_init         (GHashTableIter *iter,
                                             GHashTable     *hash_table);
@@ -155,6 +184,8 @@ gboolean g_str_equal    (gconstpointer  v1,
                          gconstpointer  v2);
 GLIB_AVAILABLE_IN_ALL
 guint    g_str_hash     (gconstpointer  v);
+GLIB_AVAILABLE_IN_2_54
+guint    g_str_hash_seeded (gconstpointer  v);
 
 GLIB_AVAILABLE_IN_ALL
 gboolean g_int_equal    (gconstpointer  v1,
@@ -0,0 +1,45 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_HASH_PRIVATE_H__
+#define __G_HASH_PRIVATE_H__
+
+#include "ghash.h"
+
+G_BEGIN_DECLS
+
+/* Changes with a hash value the caller already computed, for
+ * GConcurrentHashTable, see ghash.c.  The table must not have destroy
+ * notifiers.
+ */
+gboolean g_hash_table_exchange_hashed (GHashTable    *hash_table,
+                                       gpointer       key,
+                                       gpointer       value,
+                                       guint          hash_value,
+                                       gboolean       keep_new_key,
+                                       gpointer      *old_key,
+                                       gpointer      *old_value);
+gboolean g_hash_table_steal_hashed    (GHashTable    *hash_table,
+                                       gconstpointer  key,
+                                       guint          hash_value,
+                                       gpointer      *orig_key,
+                                       gpointer      *value);
+
+G_END_DECLS
+
+#endif /* __G_HASH_PRIVATE_H__ */
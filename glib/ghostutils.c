@@ -397,6 +397,10 @@ nameprep (const gchar *hostname,
 static const gchar *
 idna_end_of_label (const gchar *str)
 {
+  /* Skip ASCII quickly; only '.' can end the label there */
+  while (*str && *str != '.' && (guchar)*str < 0x80)
+    str++;
+
   for (; *str; str = g_utf8_next_char (str))
     {
       if (idna_is_dot (str))
@@ -426,6 +430,17 @@ g_hostname_to_ascii (const gchar *hostname)
   gssize llen, oldlen;
   gboolean unicode;
 
+  /* Plain ASCII hostnames, by far the most common case, only need to
+   * be lowercased; none of the IDNA steps change anything else in them.
+   */
+  for (p = (gchar *) hostname; *p; p++)
+    {
+      if ((guchar)*p >= 0x80)
+        break;
+    }
+  if (!*p)
+    return g_ascii_strdown (hostname, p - hostname);
+
   label = name = nameprep (hostname, -1, &unicode);
   if (!name || !unicode)
     return name;
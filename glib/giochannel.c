@@ -151,6 +151,11 @@
 
 #define G_IO_NICE_BUF_SIZE	1024
 
+/* When reads keep filling the whole read buffer, its size is doubled,
+ * up to this limit, so that fast sources need fewer calls to io_read().
+ */
+#define G_IO_MAX_READ_SIZE	(64 * 1024)
+
 /* This needs to be as wide as the largest character in any possible encoding */
 #define MAX_CHAR_SIZE		10
 
@@ -162,9 +167,22 @@
 				 : (channel)->read_buf)
 #define BUF_LEN(string)		((string) ? (string)->len : 0)
 
+/* Data is consumed from the read buffer by advancing read_pos, rather
+ * than by moving the rest of the buffer down each time. The consumed
+ * data is only discarded when the buffer is refilled, or when something
+ * needs the buffer to start at the unread data.
+ */
+#define UNREAD_LEN(channel)	(BUF_LEN (USE_BUF (channel)) - (channel)->read_pos)
+#define UNREAD_DATA(channel)	(USE_BUF (channel)->str + (channel)->read_pos)
+
 static GIOError		g_io_error_get_from_g_error	(GIOStatus    status,
 							 GError      *err);
 static void		g_io_channel_purge		(GIOChannel  *channel);
+static void		g_io_channel_compact_read_buf	(GIOChannel  *channel);
+static void		g_io_channel_consume		(GIOChannel  *channel,
+							 gsize        count);
+static GIOStatus	g_io_channel_prepare_read	(GIOChannel  *channel,
+							 GError     **err);
 static GIOStatus	g_io_channel_fill_buffer	(GIOChannel  *channel,
 							 GError     **err);
 static GIOStatus	g_io_channel_read_line_backend	(GIOChannel  *channel,
@@ -194,6 +212,7 @@ g_io_channel_init (GIOChannel *channel)
   channel->write_cd = (GIConv) -1;
   channel->read_buf = NULL; /* Lazy allocate buffers */
   channel->encoded_read_buf = NULL;
+  channel->read_pos = 0;
   channel->write_buf = NULL;
   channel->partial_write_buf[0] = '\0';
   channel->use_buffer = TRUE;
@@ -574,6 +593,7 @@ g_io_channel_purge (GIOChannel *channel)
     g_string_truncate (channel->read_buf, 0);
   if (channel->write_buf)
     g_string_truncate (channel->write_buf, 0);
+  channel->read_pos = 0;
   if (channel->encoding)
     {
       if (channel->encoded_read_buf)
@@ -720,16 +740,9 @@ g_io_channel_get_buffer_condition (GIOChannel *channel)
 {
   GIOCondition condition = 0;
 
-  if (channel->encoding)
-    {
-      if (channel->encoded_read_buf && (channel->encoded_read_buf->len > 0))
-        condition |= G_IO_IN; /* Only return if we have full characters */
-    }
-  else
-    {
-      if (channel->read_buf && (channel->read_buf->len > 0))
-        condition |= G_IO_IN;
-    }
+  /* With an encoding, this only counts full characters */
+  if (UNREAD_LEN (channel) > 0)
+    condition |= G_IO_IN;
 
   if (channel->write_buf && (channel->write_buf->len < channel->buf_size))
     condition |= G_IO_OUT;
@@ -1088,6 +1101,8 @@ g_io_channel_seek_position (GIOChannel  *channel,
 			G_IO_STATUS_ERROR);
   g_return_val_if_fail (channel->is_seekable, G_IO_STATUS_ERROR);
 
+  g_io_channel_compact_read_buf (channel);
+
   switch (type)
     {
       case G_SEEK_CUR: /* The user is seeking relative to the head of the buffer */
@@ -1239,6 +1254,8 @@ g_io_channel_set_buffered (GIOChannel *channel,
       return;
     }
 
+  g_io_channel_compact_read_buf (channel);
+
   g_return_if_fail (!channel->read_buf || channel->read_buf->len == 0);
   g_return_if_fail (!channel->write_buf || channel->write_buf->len == 0);
 
@@ -1315,6 +1332,9 @@ g_io_channel_set_encoding (GIOChannel	*channel,
   g_return_val_if_fail (channel != NULL, G_IO_STATUS_ERROR);
   g_return_val_if_fail ((error == NULL) || (*error == NULL), G_IO_STATUS_ERROR);
 
+  /* The read buffer in use may change below */
+  g_io_channel_compact_read_buf (channel);
+
   /* Make sure the encoded buffers are empty */
 
   g_return_val_if_fail (!channel->do_encode || !channel->encoded_read_buf ||
@@ -1447,11 +1467,41 @@ g_io_channel_get_encoding (GIOChannel *channel)
   return channel->encoding;
 }
 
+/* Discards the data at the start of the read buffer that has already
+ * been consumed.
+ */
+static void
+g_io_channel_compact_read_buf (GIOChannel *channel)
+{
+  if (channel->read_pos > 0)
+    {
+      g_string_erase (USE_BUF (channel), 0, channel->read_pos);
+      channel->read_pos = 0;
+    }
+}
+
+static void
+g_io_channel_consume (GIOChannel *channel,
+                      gsize       count)
+{
+  channel->read_pos += count;
+  g_assert (channel->read_pos <= BUF_LEN (USE_BUF (channel)));
+
+  /* Emptying the buffer is free, so do it straight away */
+  if (channel->read_pos == USE_BUF (channel)->len)
+    {
+      g_string_truncate (USE_BUF (channel), 0);
+      channel->read_pos = 0;
+    }
+}
+
+/* Seekable channels share their position between reading and writing,
+ * so pending writes have to go out before anything is read.
+ */
 static GIOStatus
-g_io_channel_fill_buffer (GIOChannel  *channel,
-                          GError     **err)
+g_io_channel_prepare_read (GIOChannel  *channel,
+                           GError     **err)
 {
-  gsize read_size, cur_len, oldlen;
   GIOStatus status;
 
   if (channel->is_seekable && channel->write_buf && channel->write_buf->len > 0)
@@ -1466,18 +1516,45 @@ g_io_channel_fill_buffer (GIOChannel  *channel,
       channel->partial_write_buf[0] = '\0';
     }
 
+  return G_IO_STATUS_NORMAL;
+}
+
+static GIOStatus
+g_io_channel_fill_buffer (GIOChannel  *channel,
+                          GError     **err)
+{
+  gsize read_size, cur_len, oldlen, request;
+  GIOStatus status;
+
+  status = g_io_channel_prepare_read (channel, err);
+  if (status != G_IO_STATUS_NORMAL)
+    return status;
+
+  g_io_channel_compact_read_buf (channel);
+
   if (!channel->read_buf)
     channel->read_buf = g_string_sized_new (channel->buf_size);
 
   cur_len = channel->read_buf->len;
 
-  g_string_set_size (channel->read_buf, channel->read_buf->len + channel->buf_size);
+  /* Read at least buf_size bytes, or as much as already fits */
+  request = MAX (channel->buf_size,
+                 channel->read_buf->allocated_len - cur_len - 1);
+
+  g_string_set_size (channel->read_buf, cur_len + request);
 
   status = channel->funcs->io_read (channel, channel->read_buf->str + cur_len,
-                                    channel->buf_size, &read_size, err);
+                                    request, &read_size, err);
 
   g_assert ((status == G_IO_STATUS_NORMAL) || (read_size == 0));
 
+  /* If the data is coming in faster than this, make room for more
+   * next time.
+   */
+  if (read_size == request && request < G_IO_MAX_READ_SIZE)
+    g_string_set_size (channel->read_buf,
+                       cur_len + MIN (request * 2, G_IO_MAX_READ_SIZE));
+
   g_string_truncate (channel->read_buf, read_size + cur_len);
 
   if ((status != G_IO_STATUS_NORMAL) &&
@@ -1662,8 +1739,8 @@ g_io_channel_read_line (GIOChannel  *channel,
   if (status == G_IO_STATUS_NORMAL)
     {
       g_assert (USE_BUF (channel));
-      *str_return = g_strndup (USE_BUF (channel)->str, got_length);
-      g_string_erase (USE_BUF (channel), 0, got_length);
+      *str_return = g_strndup (UNREAD_DATA (channel), got_length);
+      g_io_channel_consume (channel, got_length);
     }
   else
     *str_return = NULL;
@@ -1708,9 +1785,73 @@ g_io_channel_read_line_string (GIOChannel  *channel,
   if (status == G_IO_STATUS_NORMAL)
     {
       g_assert (USE_BUF (channel));
-      g_string_append_len (buffer, USE_BUF (channel)->str, length);
-      g_string_erase (USE_BUF (channel), 0, length);
+      g_string_append_len (buffer, UNREAD_DATA (channel), length);
+      g_io_channel_consume (channel, length);
+    }
+
+  return status;
+}
+
+/**
+ * g_io_channel_read_line_borrowed:
+ * @channel: a #GIOChannel
+ * @str_return: (out) (array length=length) (element-type guint8) (transfer none):
+ *              location to store a pointer to the line read from @channel,
+ *              including the line terminator
+ * @length: (out): location to store the length of the line
+ * @terminator_pos: (out) (optional): location to store position of line
+ *                  terminator, or %NULL
+ * @error: a location to store an error of type #GConvertError
+ *         or #GIOChannelError
+ *
+ * Reads a line from @channel like g_io_channel_read_line(), but
+ * returns a pointer into the channel's read buffer instead of a copy.
+ * This avoids an allocation and a copy for every line, which matters
+ * when reading lots of short lines.
+ *
+ * The line is not nul-terminated. It is only valid until the next
+ * call to a function that reads from, writes to, seeks, or changes
+ * the encoding or buffering of @channel.
+ *
+ * Returns: the status of the operation. @str_return is only set if
+ *     this is %G_IO_STATUS_NORMAL.
+ *
+ * Since: 2.54
+ **/
+GIOStatus
+g_io_channel_read_line_borrowed (GIOChannel   *channel,
+                                 const gchar **str_return,
+                                 gsize        *length,
+                                 gsize        *terminator_pos,
+                                 GError      **error)
+{
+  GIOStatus status;
+  gsize got_length;
+
+  g_return_val_if_fail (channel != NULL, G_IO_STATUS_ERROR);
+  g_return_val_if_fail (str_return != NULL, G_IO_STATUS_ERROR);
+  g_return_val_if_fail (length != NULL, G_IO_STATUS_ERROR);
+  g_return_val_if_fail ((error == NULL) || (*error == NULL),
+			G_IO_STATUS_ERROR);
+  g_return_val_if_fail (channel->is_readable, G_IO_STATUS_ERROR);
+
+  status = g_io_channel_read_line_backend (channel, &got_length, terminator_pos, error);
+
+  if (status != G_IO_STATUS_ERROR)
+    *length = got_length;
+
+  if (status == G_IO_STATUS_NORMAL)
+    {
+      g_assert (USE_BUF (channel));
+      *str_return = UNREAD_DATA (channel);
+
+      /* Unlike g_io_channel_consume(), this must leave the data where
+       * it is, so it's only discarded when the buffer is next refilled.
+       */
+      channel->read_pos += got_length;
     }
+  else
+    *str_return = NULL;
 
   return status;
 }
@@ -1748,17 +1889,17 @@ g_io_channel_read_line_backend (GIOChannel  *channel,
 
   while (TRUE)
     {
-      gchar *nextchar, *lastchar;
+      gchar *nextchar, *lastchar, *line_start;
       GString *use_buf;
 
-      if (!first_time || (BUF_LEN (USE_BUF (channel)) == 0))
+      if (!first_time || (UNREAD_LEN (channel) == 0))
         {
 read_again:
           status = g_io_channel_fill_buffer (channel, error);
           switch (status)
             {
               case G_IO_STATUS_NORMAL:
-                if (BUF_LEN (USE_BUF (channel)) == 0)
+                if (UNREAD_LEN (channel) == 0)
                   /* Can happen when using conversion and only read
                    * part of a character
                    */
@@ -1768,7 +1909,7 @@ read_again:
                   }
                 break;
               case G_IO_STATUS_EOF:
-                if (BUF_LEN (USE_BUF (channel)) == 0)
+                if (UNREAD_LEN (channel) == 0)
                   {
                     if (length)
                       *length = 0;
@@ -1792,22 +1933,23 @@ read_again:
             }
         }
 
-      g_assert (BUF_LEN (USE_BUF (channel)) != 0);
+      g_assert (UNREAD_LEN (channel) != 0);
 
       use_buf = USE_BUF (channel); /* The buffer has been created by this point */
+      line_start = UNREAD_DATA (channel); /* Refilling may have moved this */
 
       first_time = FALSE;
 
       lastchar = use_buf->str + use_buf->len;
 
-      for (nextchar = use_buf->str + checked_to; nextchar < lastchar;
+      for (nextchar = line_start + checked_to; nextchar < lastchar;
            channel->encoding ? nextchar = g_utf8_next_char (nextchar) : nextchar++)
         {
           if (channel->line_term)
             {
               if (memcmp (channel->line_term, nextchar, line_term_len) == 0)
                 {
-                  line_length = nextchar - use_buf->str;
+                  line_length = nextchar - line_start;
                   got_term_len = line_term_len;
                   goto done;
                 }
@@ -1817,11 +1959,11 @@ read_again:
               switch (*nextchar)
                 {
                   case '\n': /* unix */
-                    line_length = nextchar - use_buf->str;
+                    line_length = nextchar - line_start;
                     got_term_len = 1;
                     goto done;
                   case '\r': /* Warning: do not use with sockets */
-                    line_length = nextchar - use_buf->str;
+                    line_length = nextchar - line_start;
                     if ((nextchar == lastchar - 1) && (status != G_IO_STATUS_EOF)
                        && (lastchar == use_buf->str + use_buf->len))
                       goto read_again; /* Try to read more data */
@@ -1833,13 +1975,13 @@ read_again:
                   case '\xe2': /* Unicode paragraph separator */
                     if (strncmp ("\xe2\x80\xa9", nextchar, 3) == 0)
                       {
-                        line_length = nextchar - use_buf->str;
+                        line_length = nextchar - line_start;
                         got_term_len = 3;
                         goto done;
                       }
                     break;
                   case '\0': /* Embeded null in input */
-                    line_length = nextchar - use_buf->str;
+                    line_length = nextchar - line_start;
                     got_term_len = 1;
                     goto done;
                   default: /* no match */
@@ -1861,13 +2003,13 @@ read_again:
                                    _("Channel terminates in a partial character"));
               return G_IO_STATUS_ERROR;
             }
-          line_length = use_buf->len;
+          line_length = lastchar - line_start;
           got_term_len = 0;
           break;
         }
 
-      if (use_buf->len > line_term_len - 1)
-	checked_to = use_buf->len - (line_term_len - 1);
+      if ((gsize) (lastchar - line_start) > line_term_len - 1)
+	checked_to = lastchar - line_start - (line_term_len - 1);
       else
 	checked_to = 0;
     }
@@ -1925,6 +2067,8 @@ g_io_channel_read_to_end (GIOChannel  *channel,
       return G_IO_STATUS_ERROR;
     }
 
+  g_io_channel_compact_read_buf (channel);
+
   do
     status = g_io_channel_fill_buffer (channel, error);
   while (status == G_IO_STATUS_NORMAL);
@@ -2019,14 +2163,51 @@ g_io_channel_read_chars (GIOChannel  *channel,
       return status;
     }
 
+  /* For large binary reads, hand over whatever is buffered and then
+   * read straight into @buf, rather than going through the buffer.
+   */
+  if (!channel->encoding && UNREAD_LEN (channel) < count &&
+      count - UNREAD_LEN (channel) >= channel->buf_size)
+    {
+      gsize buffered = UNREAD_LEN (channel);
+      gsize tmp_bytes;
+
+      if (buffered > 0)
+        {
+          memcpy (buf, UNREAD_DATA (channel), buffered);
+          g_io_channel_consume (channel, buffered);
+        }
+
+      status = g_io_channel_prepare_read (channel, error);
+      got_bytes = buffered;
+      while (got_bytes < count && status == G_IO_STATUS_NORMAL)
+        {
+          status = channel->funcs->io_read (channel, buf + got_bytes,
+                                            count - got_bytes, &tmp_bytes, error);
+          got_bytes += tmp_bytes;
+        }
+
+      if (bytes_read)
+        *bytes_read = got_bytes;
+
+      /* Only return an error if we have no data */
+      if (got_bytes == 0)
+        return status;
+
+      if (status == G_IO_STATUS_ERROR)
+        g_clear_error (error);
+
+      return G_IO_STATUS_NORMAL;
+    }
+
   status = G_IO_STATUS_NORMAL;
 
-  while (BUF_LEN (USE_BUF (channel)) < count && status == G_IO_STATUS_NORMAL)
+  while (UNREAD_LEN (channel) < count && status == G_IO_STATUS_NORMAL)
     status = g_io_channel_fill_buffer (channel, error);
 
   /* Only return an error if we have no data */
 
-  if (BUF_LEN (USE_BUF (channel)) == 0)
+  if (UNREAD_LEN (channel) == 0)
     {
       g_assert (status != G_IO_STATUS_NORMAL);
 
@@ -2048,18 +2229,18 @@ g_io_channel_read_chars (GIOChannel  *channel,
   if (status == G_IO_STATUS_ERROR)
     g_clear_error (error);
 
-  got_bytes = MIN (count, BUF_LEN (USE_BUF (channel)));
+  got_bytes = MIN (count, UNREAD_LEN (channel));
 
   g_assert (got_bytes > 0);
 
   if (channel->encoding)
     /* Don't validate for NULL encoding, binary safe */
     {
-      gchar *nextchar, *prevchar;
+      gchar *nextchar, *prevchar, *start;
 
       g_assert (USE_BUF (channel) == channel->encoded_read_buf);
 
-      nextchar = channel->encoded_read_buf->str;
+      nextchar = start = UNREAD_DATA (channel);
 
       do
         {
@@ -2067,16 +2248,16 @@ g_io_channel_read_chars (GIOChannel  *channel,
           nextchar = g_utf8_next_char (nextchar);
           g_assert (nextchar != prevchar); /* Possible for *prevchar of -1 or -2 */
         }
-      while (nextchar < channel->encoded_read_buf->str + got_bytes);
+      while (nextchar < start + got_bytes);
 
-      if (nextchar > channel->encoded_read_buf->str + got_bytes)
-        got_bytes = prevchar - channel->encoded_read_buf->str;
+      if (nextchar > start + got_bytes)
+        got_bytes = prevchar - start;
 
       g_assert (got_bytes > 0 || count < 6);
     }
 
-  memcpy (buf, USE_BUF (channel)->str, got_bytes);
-  g_string_erase (USE_BUF (channel), 0, got_bytes);
+  memcpy (buf, UNREAD_DATA (channel), got_bytes);
+  g_io_channel_consume (channel, got_bytes);
 
   if (bytes_read)
     *bytes_read = got_bytes;
@@ -2109,12 +2290,12 @@ g_io_channel_read_unichar (GIOChannel  *channel,
 			G_IO_STATUS_ERROR);
   g_return_val_if_fail (channel->is_readable, G_IO_STATUS_ERROR);
 
-  while (BUF_LEN (channel->encoded_read_buf) == 0 && status == G_IO_STATUS_NORMAL)
+  while (UNREAD_LEN (channel) == 0 && status == G_IO_STATUS_NORMAL)
     status = g_io_channel_fill_buffer (channel, error);
 
   /* Only return an error if we have no data */
 
-  if (BUF_LEN (USE_BUF (channel)) == 0)
+  if (UNREAD_LEN (channel) == 0)
     {
       g_assert (status != G_IO_STATUS_NORMAL);
 
@@ -2136,11 +2317,11 @@ g_io_channel_read_unichar (GIOChannel  *channel,
     g_clear_error (error);
 
   if (thechar)
-    *thechar = g_utf8_get_char (channel->encoded_read_buf->str);
+    *thechar = g_utf8_get_char (UNREAD_DATA (channel));
 
-  g_string_erase (channel->encoded_read_buf, 0,
-                  g_utf8_next_char (channel->encoded_read_buf->str)
-                  - channel->encoded_read_buf->str);
+  g_io_channel_consume (channel,
+                        g_utf8_next_char (UNREAD_DATA (channel))
+                        - UNREAD_DATA (channel));
 
   return G_IO_STATUS_NORMAL;
 }
@@ -2215,6 +2396,8 @@ g_io_channel_write_chars (GIOChannel   *channel,
 
   /* General case */
 
+  g_io_channel_compact_read_buf (channel);
+
   if (channel->is_seekable && (( BUF_LEN (channel->read_buf) > 0)
     || (BUF_LEN (channel->encoded_read_buf) > 0)))
     {
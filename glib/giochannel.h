@@ -121,7 +121,7 @@ struct _GIOChannel
   guint is_writeable   : 1;	/* ditto */
   guint is_seekable    : 1;	/* ditto */
 
-  gpointer reserved1;	
+  gsize read_pos;		/* Data at the start of the read buffer already consumed */
   gpointer reserved2;	
 };
 
@@ -257,6 +257,12 @@ GIOStatus   g_io_channel_read_line_string (GIOChannel   *channel,
 					   GString      *buffer,
 					   gsize        *terminator_pos,
 					   GError      **error);
+GLIB_AVAILABLE_IN_2_54
+GIOStatus   g_io_channel_read_line_borrowed (GIOChannel   *channel,
+					     const gchar **str_return,
+					     gsize        *length,
+					     gsize        *terminator_pos,
+					     GError      **error);
 GLIB_AVAILABLE_IN_ALL
 GIOStatus   g_io_channel_read_to_end      (GIOChannel   *channel,
 					   gchar       **str_return,
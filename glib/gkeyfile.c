@@ -58,6 +58,7 @@
 #include "ghash.h"
 #include "glibintl.h"
 #include "glist.h"
+#include "gmappedfile.h"
 #include "gslist.h"
 #include "gmem.h"
 #include "gmessages.h"
@@ -521,7 +522,8 @@ static void                  g_key_file_add_key                (GKeyFile
 static void                  g_key_file_add_group              (GKeyFile               *key_file,
 								const gchar            *group_name);
 static gboolean              g_key_file_is_group_name          (const gchar *name);
-static gboolean              g_key_file_is_key_name            (const gchar *name);
+static gboolean              g_key_file_is_key_name            (const gchar *name,
+                                                                gsize        len);
 static void                  g_key_file_key_value_pair_free    (GKeyFileKeyValuePair   *pair);
 static gboolean              g_key_file_line_is_comment        (const gchar            *line);
 static gboolean              g_key_file_line_is_group          (const gchar            *line);
@@ -562,7 +564,9 @@ static void                  g_key_file_parse_group            (GKeyFile
 								const gchar            *line,
 								gsize                   length,
 								GError                **error);
-static gchar                *key_get_locale                    (const gchar            *key);
+static const gchar          *key_get_locale                    (const gchar            *key,
+                                                                gsize                   key_len,
+                                                                gsize                  *locale_len);
 static void                  g_key_file_parse_data             (GKeyFile               *key_file,
 								const gchar            *data,
 								gsize                   length,
@@ -752,6 +756,7 @@ g_key_file_load_from_fd (GKeyFile       *key_file,
 			 GError        **error)
 {
   GError *key_file_error = NULL;
+  GMappedFile *mapped_file;
   gssize bytes_read;
   struct stat stat_buf;
   gchar read_buf[4096];
@@ -779,29 +784,44 @@ g_key_file_load_from_fd (GKeyFile       *key_file,
   key_file->list_separator = list_separator;
   key_file->flags = flags;
 
-  do
+  /* Parse the whole file in one go from a mapping where possible,
+   * rather than a chunk at a time through read_buf
+   */
+  mapped_file = g_mapped_file_new_from_fd (fd, FALSE, NULL);
+  if (mapped_file != NULL)
+    {
+      g_key_file_parse_data (key_file,
+			     g_mapped_file_get_contents (mapped_file),
+			     g_mapped_file_get_length (mapped_file),
+			     &key_file_error);
+      g_mapped_file_unref (mapped_file);
+    }
+  else
     {
-      bytes_read = read (fd, read_buf, 4096);
+      do
+        {
+          bytes_read = read (fd, read_buf, 4096);
 
-      if (bytes_read == 0)  /* End of File */
-        break;
+          if (bytes_read == 0)  /* End of File */
+            break;
 
-      if (bytes_read < 0)
-        {
-          if (errno == EINTR || errno == EAGAIN)
-            continue;
+          if (bytes_read < 0)
+            {
+              if (errno == EINTR || errno == EAGAIN)
+                continue;
 
-          g_set_error_literal (error, G_FILE_ERROR,
-                               g_file_error_from_errno (errno),
-                               g_strerror (errno));
-          return FALSE;
-        }
+              g_set_error_literal (error, G_FILE_ERROR,
+                                   g_file_error_from_errno (errno),
+                                   g_strerror (errno));
+              return FALSE;
+            }
 
-      g_key_file_parse_data (key_file,
-			     read_buf, bytes_read,
-			     &key_file_error);
+          g_key_file_parse_data (key_file,
+				 read_buf, bytes_read,
+				 &key_file_error);
+        }
+      while (!key_file_error);
     }
-  while (!key_file_error);
 
   if (key_file_error)
     {
@@ -1162,7 +1182,8 @@ g_key_file_unref (GKeyFile *key_file)
  */
 static gboolean
 g_key_file_locale_is_interesting (GKeyFile    *key_file,
-				  const gchar *locale)
+				  const gchar *locale,
+				  gsize        locale_len)
 {
   gsize i;
 
@@ -1171,7 +1192,8 @@ g_key_file_locale_is_interesting (GKeyFile    *key_file,
 
   for (i = 0; key_file->locales[i] != NULL; i++)
     {
-      if (g_ascii_strcasecmp (key_file->locales[i], locale) == 0)
+      if (g_ascii_strncasecmp (key_file->locales[i], locale, locale_len) == 0 &&
+          key_file->locales[i][locale_len] == '\0')
 	return TRUE;
     }
 
@@ -1281,8 +1303,10 @@ g_key_file_parse_key_value_pair (GKeyFile     *key_file,
 				 gsize         length,
 				 GError      **error)
 {
-  gchar *key, *value, *key_end, *value_start, *locale;
-  gsize key_len, value_len;
+  GKeyFileKeyValuePair *pair;
+  gchar *key, *value;
+  const gchar *key_end, *value_start, *locale;
+  gsize key_len, value_len, locale_len;
 
   if (key_file->current_group == NULL || key_file->current_group->name == NULL)
     {
@@ -1304,14 +1328,13 @@ g_key_file_parse_key_value_pair (GKeyFile     *key_file,
   while (g_ascii_isspace (*key_end))
     key_end--;
 
-  key_len = key_end - line + 2;
-
-  g_warn_if_fail (key_len <= length);
+  key_len = key_end - line + 1;
 
-  key = g_strndup (line, key_len - 1);
+  g_warn_if_fail (key_len < length);
 
-  if (!g_key_file_is_key_name (key))
+  if (!g_key_file_is_key_name (line, key_len))
     {
+      key = g_strndup (line, key_len);
       g_set_error (error, G_KEY_FILE_ERROR,
                    G_KEY_FILE_ERROR_PARSE,
                    _("Invalid key name: %s"), key);
@@ -1319,13 +1342,23 @@ g_key_file_parse_key_value_pair (GKeyFile     *key_file,
       return; 
     }
 
+  /* Is this key a translation? If so, is it one that we care about?
+   * Most lines of a desktop file are translations nobody asked for,
+   * so find out before copying anything.
+   */
+  locale = key_get_locale (line, key_len, &locale_len);
+
+  if (locale != NULL && !g_key_file_locale_is_interesting (key_file, locale, locale_len))
+    return;
+
   /* Pull the value from the line (chugging leading whitespace)
    */
   while (g_ascii_isspace (*value_start))
     value_start++;
 
-  value_len = line + length - value_start + 1;
+  value_len = line + length - value_start;
 
+  key = g_strndup (line, key_len);
   value = g_strndup (value_start, value_len);
 
   g_warn_if_fail (key_file->start_group != NULL);
@@ -1351,43 +1384,37 @@ g_key_file_parse_key_value_pair (GKeyFile     *key_file,
         }
     }
 
-  /* Is this key a translation? If so, is it one that we care about?
-   */
-  locale = key_get_locale (key);
-
-  if (locale == NULL || g_key_file_locale_is_interesting (key_file, locale))
-    {
-      GKeyFileKeyValuePair *pair;
-
-      pair = g_slice_new (GKeyFileKeyValuePair);
-      pair->key = key;
-      pair->value = value;
-
-      g_key_file_add_key_value_pair (key_file, key_file->current_group, pair);
-    }
-  else
-    {
-      g_free (key);
-      g_free (value);
-    }
+  pair = g_slice_new (GKeyFileKeyValuePair);
+  pair->key = key;
+  pair->value = value;
 
-  g_free (locale);
+  g_key_file_add_key_value_pair (key_file, key_file->current_group, pair);
 }
 
-static gchar *
-key_get_locale (const gchar *key)
+/* Returns the locale of a valid key name of @key_len bytes, which is
+ * not nul-terminated, or %NULL if it isn't a translation
+ */
+static const gchar *
+key_get_locale (const gchar *key,
+                gsize        key_len,
+                gsize       *locale_len)
 {
-  gchar *locale;
+  const gchar *locale;
 
-  locale = g_strrstr (key, "[");
+  if (key_len == 0 || key[key_len - 1] != ']')
+    return NULL;
 
-  if (locale && strlen (locale) <= 2)
-    locale = NULL;
+  locale = key + key_len - 1;
+  while (locale > key && *locale != '[')
+    locale--;
 
-  if (locale)
-    locale = g_strndup (locale + 1, strlen (locale) - 2);
+  /* an empty locale; as before, such a key is not a translation */
+  if (*locale != '[' || key + key_len - locale <= 2)
+    return NULL;
 
-  return locale;
+  *locale_len = key + key_len - locale - 2;
+
+  return locale + 1;
 }
 
 static void
@@ -1799,7 +1826,7 @@ g_key_file_set_value (GKeyFile    *key_file,
 
   g_return_if_fail (key_file != NULL);
   g_return_if_fail (g_key_file_is_group_name (group_name));
-  g_return_if_fail (g_key_file_is_key_name (key));
+  g_return_if_fail (key != NULL && g_key_file_is_key_name (key, strlen (key)));
   g_return_if_fail (value != NULL);
 
   group = g_key_file_lookup_group (key_file, group_name);
@@ -4004,19 +4031,23 @@ g_key_file_is_group_name (const gchar *name)
 }
 
 static gboolean
-g_key_file_is_key_name (const gchar *name)
+g_key_file_is_key_name (const gchar *name,
+                        gsize        len)
 {
-  gchar *p, *q;
+  const gchar *p, *q, *end;
 
   if (name == NULL)
     return FALSE;
 
-  p = q = (gchar *) name;
+  p = q = name;
+  end = name + len;
   /* We accept a little more than the desktop entry spec says,
    * since gnome-vfs uses mime-types as keys in its cache.
+   *
+   * The delimiters are ASCII, so they can be looked for bytewise.
    */
-  while (*q && *q != '=' && *q != '[' && *q != ']')
-    q = g_utf8_find_next_char (q, NULL);
+  while (q < end && *q && *q != '=' && *q != '[' && *q != ']')
+    q++;
   
   /* No empty keys, please */
   if (q == p)
@@ -4030,19 +4061,23 @@ g_key_file_is_key_name (const gchar *name)
   if (*p == ' ' || q[-1] == ' ')
     return FALSE;
 
-  if (*q == '[')
+  if (q < end && *q == '[')
     {
       q++;
-      while (*q && (g_unichar_isalnum (g_utf8_get_char_validated (q, -1)) || *q == '-' || *q == '_' || *q == '.' || *q == '@'))
-        q = g_utf8_find_next_char (q, NULL);
+      while (q < end && (g_unichar_isalnum (g_utf8_get_char_validated (q, end - q)) || *q == '-' || *q == '_' || *q == '.' || *q == '@'))
+        {
+          q++;
+          while (q < end && (*q & 0xc0) == 0x80)
+            q++;
+        }
 
-      if (*q != ']')
+      if (q == end || *q != ']')
         return FALSE;     
 
       q++;
     }
 
-  if (*q != '\0')
+  if (q != end)
     return FALSE;
 
   return TRUE;
@@ -271,6 +271,8 @@ glib_init (void)
   g_messages_prefixed_init ();
   g_debug_init ();
   g_quark_init ();
+  g_lock_profile_init ();
+  g_mem_stats_init ();
 }
 
 #if defined (G_OS_WIN32)
@@ -27,6 +27,8 @@ extern GLogLevelFlags g_log_msg_prefix;
 
 void glib_init (void);
 void g_quark_init (void);
+void g_lock_profile_init (void);
+void g_mem_stats_init (void);
 
 #ifdef G_OS_WIN32
 #include <windows.h>
@@ -48,6 +48,8 @@ glib__private__ (void)
     g_dir_new_from_dirp,
 
     glib_init,
+
+    g_main_context_peek_next_id,
   };
 
   return &table;
@@ -30,6 +30,7 @@
 GMainContext *          g_get_worker_context            (void);
 gboolean                g_check_setuid                  (void);
 GMainContext *          g_main_context_new_with_next_id (guint next_id);
+guint                   g_main_context_peek_next_id     (GMainContext *context);
 
 #ifdef G_OS_WIN32
 gchar *_glib_get_dll_directory (void);
@@ -64,6 +65,9 @@ typedef struct {
   /* See glib-init.c */
   void                  (* glib_init)                   (void);
 
+  /* See gmain.c */
+  guint                 (* g_main_context_peek_next_id) (GMainContext *context);
+
   /* Add other private functions here, initialize them in glib-private.c */
 } GLibPrivateVTable;
 
@@ -29,14 +29,19 @@
 
 #include <glib/galloca.h>
 #include <glib/garray.h>
+#include <glib/garena.h>
 #include <glib/gasyncqueue.h>
 #include <glib/gatomic.h>
 #include <glib/gbacktrace.h>
 #include <glib/gbase64.h>
 #include <glib/gbitlock.h>
 #include <glib/gbookmarkfile.h>
+#include <glib/gboundedqueue.h>
+#include <glib/gbtree.h>
 #include <glib/gbytes.h>
+#include <glib/gbyteschain.h>
 #include <glib/gcharset.h>
+#include <glib/gconcurrenthash.h>
 #include <glib/gchecksum.h>
 #include <glib/gconvert.h>
 #include <glib/gdataset.h>
@@ -44,6 +49,7 @@
 #include <glib/gdatetime.h>
 #include <glib/gdir.h>
 #include <glib/genviron.h>
+#include <glib/gepoch.h>
 #include <glib/gerror.h>
 #include <glib/gfileutils.h>
 #include <glib/ggettext.h>
@@ -69,7 +75,9 @@
 #include <glib/gquark.h>
 #include <glib/gqueue.h>
 #include <glib/grand.h>
+#include <glib/grefstring.h>
 #include <glib/gregex.h>
+#include <glib/gringqueue.h>
 #include <glib/gscanner.h>
 #include <glib/gsequence.h>
 #include <glib/gshell.h>
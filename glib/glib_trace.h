@@ -30,11 +30,13 @@
 /* include the generated probes header and put markers in code */
 #include "glib_probes.h"
 #define TRACE(probe) probe
+#define TRACE_ENABLED(probe) G_UNLIKELY (probe ## _ENABLED ())
 
 #else
 
 /* Wrap the probe to allow it to be removed when no systemtap available */
 #define TRACE(probe)
+#define TRACE_ENABLED(probe) FALSE
 
 #endif
 
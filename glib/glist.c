@@ -1117,17 +1117,20 @@ g_list_insert_sorted_with_data (GList            *list,
   return g_list_insert_sorted_real (list, data, (GFunc) func, user_data);
 }
 
+/* Merges two sorted, %NULL-terminated runs, only following and setting
+ * the next pointers; g_list_sort_real() fixes up the prev pointers at
+ * the end.
+ */
 static GList *
 g_list_sort_merge (GList     *l1, 
                    GList     *l2,
                    GFunc     compare_func,
                    gpointer  user_data)
 {
-  GList list, *l, *lprev;
+  GList list, *l;
   gint cmp;
 
   l = &list; 
-  lprev = NULL;
 
   while (l1 && l2)
     {
@@ -1144,43 +1147,63 @@ g_list_sort_merge (GList     *l1,
           l2 = l2->next;
         }
       l = l->next;
-      l->prev = lprev; 
-      lprev = l;
     }
   l->next = l1 ? l1 : l2;
-  l->next->prev = l;
 
   return list.next;
 }
 
+/* A bottom-up merge sort: each element is merged into a set of sorted
+ * runs whose lengths are distinct powers of two, like incrementing a
+ * binary counter.  Unlike splitting the list in halves, this needs
+ * neither the length of the list nor recursion, and it only walks the
+ * list once.
+ */
 static GList * 
 g_list_sort_real (GList    *list,
                   GFunc     compare_func,
                   gpointer  user_data)
 {
-  GList *l1, *l2;
+  /* runs[i] is either %NULL or a run of 2^i elements, all of which
+   * were in the list before those in runs[i - 1] */
+  GList *runs[GLIB_SIZEOF_SIZE_T * 8] = { NULL, };
+  GList *l, *next, *prev;
+  guint i, n_runs = 0;
   
   if (!list) 
     return NULL;
   if (!list->next) 
     return list;
-  
-  l1 = list; 
-  l2 = list->next;
 
-  while ((l2 = l2->next) != NULL)
+  for (l = list; l != NULL; l = next)
     {
-      if ((l2 = l2->next) == NULL) 
-        break;
-      l1 = l1->next;
+      next = l->next;
+      l->next = NULL;
+
+      for (i = 0; runs[i] != NULL; i++)
+        {
+          l = g_list_sort_merge (runs[i], l, compare_func, user_data);
+          runs[i] = NULL;
+        }
+      runs[i] = l;
+      n_runs = MAX (n_runs, i + 1);
     }
-  l2 = l1->next; 
-  l1->next = NULL; 
 
-  return g_list_sort_merge (g_list_sort_real (list, compare_func, user_data),
-                            g_list_sort_real (l2, compare_func, user_data),
-                            compare_func,
-                            user_data);
+  list = NULL;
+  for (i = 0; i < n_runs; i++)
+    {
+      if (runs[i] != NULL)
+        list = list ? g_list_sort_merge (runs[i], list, compare_func, user_data) : runs[i];
+    }
+
+  prev = NULL;
+  for (l = list; l != NULL; l = l->next)
+    {
+      l->prev = prev;
+      prev = l;
+    }
+
+  return list;
 }
 
 /**
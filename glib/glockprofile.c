@@ -0,0 +1,408 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * glockprofile.c: lock contention profiling
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gthread.h"
+#include "gthreadprivate.h"
+#include "glib-init.h"
+
+#include "gatomic.h"
+#include "gmain.h"
+#include "gmem.h"
+#include "gqsort.h"
+#include "gstrfuncs.h"
+#include "gstring.h"
+#include "gutils.h"
+#include "glib_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_EXECINFO_H
+#include <execinfo.h>
+#endif
+
+/* The profiler is called from the contended paths of the locks
+ * themselves, so it must not take any GLib lock or allocate memory
+ * through GLib: the table of locks is allocated once, with calloc(),
+ * and protected by a plain spin lock.  Contention on that spin lock
+ * only happens while profiling already-contended locks.
+ */
+
+#define N_ENTRIES       1024
+#define N_FRAMES        8
+#define N_BUCKETS       16
+
+typedef struct
+{
+  gconstpointer lock;
+  GLockProfileKind kind;
+  guint contentions;
+  gint64 total_wait;
+  gint64 max_wait;
+  guint histogram[N_BUCKETS];
+  gpointer waiter[N_FRAMES];
+  gint n_waiter;
+  gpointer holder[N_FRAMES];
+  gint n_holder;
+} GLockProfileEntry;
+
+gboolean g_lock_profile_active;
+
+static GLockProfileEntry *entries;
+static volatile gint table_lock;
+static guint n_dropped;
+
+static const gchar * const kind_names[] = {
+  "GMutex", "GRecMutex", "GRWLock", "g_bit_lock", "g_pointer_bit_lock"
+};
+
+static void
+table_lock_acquire (void)
+{
+  while (!g_atomic_int_compare_and_exchange (&table_lock, 0, 1))
+    g_thread_yield ();
+}
+
+static void
+table_lock_release (void)
+{
+  g_atomic_int_set (&table_lock, 0);
+}
+
+/* Called with the table locked */
+static GLockProfileEntry *
+lookup_entry (gconstpointer    lock,
+              GLockProfileKind kind)
+{
+  guint i, start;
+
+  if (entries == NULL)
+    return NULL;
+
+  start = (((gsize) lock) >> 3) % N_ENTRIES;
+  for (i = 0; i < N_ENTRIES; i++)
+    {
+      GLockProfileEntry *entry = &entries[(start + i) % N_ENTRIES];
+
+      if (entry->lock == lock)
+        return entry;
+
+      if (entry->lock == NULL)
+        {
+          entry->lock = lock;
+          entry->kind = kind;
+          return entry;
+        }
+    }
+
+  n_dropped++;
+
+  return NULL;
+}
+
+static gint
+capture_backtrace (gpointer *frames)
+{
+#ifdef HAVE_EXECINFO_H
+  return backtrace (frames, N_FRAMES);
+#else
+  return 0;
+#endif
+}
+
+void
+g_lock_profile_contended (gconstpointer    lock,
+                          GLockProfileKind kind,
+                          gint64           wait_start)
+{
+  GLockProfileEntry *entry;
+  gpointer frames[N_FRAMES];
+  gint n_frames;
+  gint64 wait;
+
+  wait = g_get_monotonic_time () - wait_start;
+
+  TRACE (GLIB_LOCK_CONTENDED ((void *) lock, kind, wait));
+
+  if (!g_lock_profile_active)
+    return;
+
+  n_frames = capture_backtrace (frames);
+
+  table_lock_acquire ();
+
+  entry = lookup_entry (lock, kind);
+  if (entry)
+    {
+      entry->contentions++;
+      entry->total_wait += wait;
+      entry->max_wait = MAX (entry->max_wait, wait);
+      entry->histogram[wait > 0 ? MIN (g_bit_storage (wait), N_BUCKETS - 1) : 0]++;
+
+      /* Keep the first one; later ones are usually the same */
+      if (entry->n_waiter == 0)
+        {
+          memcpy (entry->waiter, frames, n_frames * sizeof (gpointer));
+          entry->n_waiter = n_frames;
+        }
+    }
+
+  table_lock_release ();
+}
+
+void
+g_lock_profile_released (gconstpointer    lock,
+                         GLockProfileKind kind)
+{
+  GLockProfileEntry *entry;
+  gpointer frames[N_FRAMES];
+  gint n_frames;
+
+  if (!g_lock_profile_active)
+    return;
+
+  n_frames = capture_backtrace (frames);
+
+  table_lock_acquire ();
+
+  /* The holder of a lock that somebody waits for, at the time it lets
+   * go of it; the last one is the most interesting.
+   */
+  entry = lookup_entry (lock, kind);
+  if (entry)
+    {
+      memcpy (entry->holder, frames, n_frames * sizeof (gpointer));
+      entry->n_holder = n_frames;
+    }
+
+  table_lock_release ();
+}
+
+/**
+ * g_lock_profile_set_enabled:
+ * @enabled: whether to record lock contention
+ *
+ * Turns the lock profiler on or off.  While it is on, every time a
+ * thread has to wait for a #GMutex, #GRecMutex, #GRWLock or a lock
+ * taken with g_bit_lock() or g_pointer_bit_lock(), the time it waited
+ * is recorded for that lock, along with where it waited from and where
+ * the thread holding the lock released it.  Use g_lock_profile_dump()
+ * to see the result.
+ *
+ * Locks that are never contended cost nothing more while the profiler
+ * is on; contended ones get slower.  Up to 1024 different locks are
+ * recorded.
+ *
+ * The profiler can also be turned on by setting the `G_LOCK_PROFILE`
+ * environment variable to `1`, in which case a report is also printed
+ * to stderr when the program exits.
+ *
+ * Contention is also reported to the `glib.lock_contended` trace
+ * probe, whether the profiler is on or not.
+ *
+ * Where they are reported, backtraces are symbolized as well as the
+ * system allows; tools like addr2line can be used for the rest.  Only
+ * the system thread implementation for Linux reports the holder of
+ * contended #GMutex and #GRecMutex locks.
+ *
+ * Since: 2.54
+ */
+void
+g_lock_profile_set_enabled (gboolean enabled)
+{
+  if (enabled)
+    {
+      table_lock_acquire ();
+      if (entries == NULL)
+        entries = calloc (N_ENTRIES, sizeof (GLockProfileEntry));
+      table_lock_release ();
+
+      if (entries == NULL)
+        return;
+    }
+
+  g_lock_profile_active = enabled != FALSE;
+}
+
+/**
+ * g_lock_profile_reset:
+ *
+ * Forgets everything that the lock profiler recorded so far.
+ *
+ * Since: 2.54
+ */
+void
+g_lock_profile_reset (void)
+{
+  table_lock_acquire ();
+  if (entries)
+    memset (entries, 0, N_ENTRIES * sizeof (GLockProfileEntry));
+  n_dropped = 0;
+  table_lock_release ();
+}
+
+static gint
+compare_entries (gconstpointer a,
+                 gconstpointer b,
+                 gpointer      user_data)
+{
+  const GLockProfileEntry *entry_a = a, *entry_b = b;
+
+  if (entry_a->total_wait != entry_b->total_wait)
+    return entry_a->total_wait > entry_b->total_wait ? -1 : 1;
+
+  return entry_a->contentions > entry_b->contentions ? -1 :
+         entry_a->contentions < entry_b->contentions;
+}
+
+static void
+append_backtrace (GString     *string,
+                  const gchar *title,
+                  gpointer    *frames,
+                  gint         n_frames)
+{
+  gchar **symbols = NULL;
+  gint i;
+
+  if (n_frames == 0)
+    return;
+
+  g_string_append_printf (string, "    %s:\n", title);
+
+#ifdef HAVE_EXECINFO_H
+  symbols = backtrace_symbols (frames, n_frames);
+#endif
+
+  for (i = 0; i < n_frames; i++)
+    {
+      if (symbols)
+        g_string_append_printf (string, "      %s\n", symbols[i]);
+      else
+        g_string_append_printf (string, "      %p\n", frames[i]);
+    }
+
+  free (symbols);
+}
+
+/**
+ * g_lock_profile_dump:
+ *
+ * Produces a report of what the lock profiler recorded, with one entry
+ * per contended lock, the locks with the longest total waiting time
+ * first.  Every entry gives the number of times a thread waited for
+ * the lock, the total and longest waiting time, a histogram of the
+ * waiting times in powers of two microseconds, and backtraces of a
+ * waiting thread and the thread that last released the lock while
+ * another one waited.
+ *
+ * The format is meant for humans and may change.
+ *
+ * Returns: (transfer full): the report, free it with g_free()
+ *
+ * Since: 2.54
+ */
+gchar *
+g_lock_profile_dump (void)
+{
+  GLockProfileEntry *snapshot;
+  GString *string;
+  guint n_snapshot = 0;
+  guint dropped;
+  guint i, j;
+
+  /* Copy first, since formatting takes locks of its own */
+  snapshot = calloc (N_ENTRIES, sizeof (GLockProfileEntry));
+  if (snapshot == NULL)
+    return g_strdup ("");
+
+  table_lock_acquire ();
+  if (entries)
+    for (i = 0; i < N_ENTRIES; i++)
+      if (entries[i].lock && entries[i].contentions > 0)
+        snapshot[n_snapshot++] = entries[i];
+  dropped = n_dropped;
+  table_lock_release ();
+
+  g_qsort_with_data (snapshot, n_snapshot, sizeof (GLockProfileEntry),
+                     compare_entries, NULL);
+
+  string = g_string_new (NULL);
+  g_string_append_printf (string, "%u contended locks", n_snapshot);
+  if (dropped)
+    g_string_append_printf (string, " (%u contentions on further locks not recorded)", dropped);
+  g_string_append (string, "\n");
+
+  for (i = 0; i < n_snapshot; i++)
+    {
+      GLockProfileEntry *entry = &snapshot[i];
+
+      g_string_append_printf (string,
+                              "%s %p: %u contentions, %" G_GINT64_FORMAT " us total, "
+                              "%" G_GINT64_FORMAT " us max\n",
+                              kind_names[entry->kind], entry->lock, entry->contentions,
+                              entry->total_wait, entry->max_wait);
+
+      g_string_append (string, "    waits:");
+      for (j = 0; j < N_BUCKETS; j++)
+        if (entry->histogram[j])
+          {
+            if (j == 0)
+              g_string_append_printf (string, " <1us:%u", entry->histogram[j]);
+            else if (j == N_BUCKETS - 1)
+              g_string_append_printf (string, " >=%uus:%u", 1u << (j - 1), entry->histogram[j]);
+            else
+              g_string_append_printf (string, " <%uus:%u", 1u << j, entry->histogram[j]);
+          }
+      g_string_append (string, "\n");
+
+      append_backtrace (string, "waiter", entry->waiter, entry->n_waiter);
+      append_backtrace (string, "holder", entry->holder, entry->n_holder);
+    }
+
+  free (snapshot);
+
+  return g_string_free (string, FALSE);
+}
+
+static void
+g_lock_profile_print_at_exit (void)
+{
+  gchar *report;
+
+  report = g_lock_profile_dump ();
+  fputs (report, stderr);
+  g_free (report);
+}
+
+void
+g_lock_profile_init (void)
+{
+  const gchar *value;
+
+  value = getenv ("G_LOCK_PROFILE");
+  if (value == NULL || strcmp (value, "1") != 0)
+    return;
+
+  g_lock_profile_set_enabled (TRUE);
+  atexit (g_lock_profile_print_at_exit);
+}
@@ -97,6 +97,7 @@
 #endif
 
 #include "gwakeup.h"
+#include "gpollset.h"
 #include "gmain-internal.h"
 #include "glib-init.h"
 #include "glib-private.h"
@@ -275,10 +276,31 @@ struct _GMainContext
   GPtrArray *pending_dispatches;
   gint timeout;			/* Timeout for current iteration */
 
+  /* Binary min-heap, keyed on ready_time, of the attached sources which
+   * have no prepare function and a ready time set; see
+   * deadline_heap_update().
+   */
+  GPtrArray *deadline_heap;
+
   guint next_id;
+  gint ids_wrapped;
   GList *source_lists;
+
+  /* Sources attached while another thread held the lock, pushed without
+   * taking it and linked through their ->next pointers (newest first).
+   * They are moved onto source_lists by the next LOCK_CONTEXT().
+   */
+  gpointer incoming_sources;
   gint in_check_or_prepare;
 
+  /* GInvokeBatch for g_main_context_invoke_batched(), created on first use */
+  gpointer invoke_batch;
+
+  /* Source name -> GSourceStats, or NULL if not collecting; the key of
+   * unnamed sources is "". See g_main_context_set_source_stats_enabled().
+   */
+  GHashTable *source_stats;
+
   GPollRec *poll_records;
   guint n_poll_records;
   GPollFD *cached_poll_array;
@@ -291,10 +313,28 @@ struct _GMainContext
 /* Flag indicating whether the set of fd's changed during a poll */
   gboolean poll_changed;
 
+  /* File descriptors added with g_source_add_unix_fd() are kept
+   * registered in a native poll set (epoll, kqueue) when there is one,
+   * instead of being handed to poll_func on each iteration.
+   */
+  GPollSet *poll_set;
+  GPollFD poll_set_rec;
+  /* TRUE between query and check of an iteration that only polls the
+   * poll set fd; other callers of g_main_context_query() see every fd.
+   */
+  gboolean poll_set_in_use;
+  GHashTable *poll_set_records;     /* gint fd -> GPollRec chain */
+  GPtrArray *poll_set_ready;        /* GPollFD with non-zero revents */
+  GPollFD *poll_set_fds;
+  guint poll_set_fds_size;
+
   GPollFunc poll_func;
 
   gint64   time;
   gboolean time_is_fresh;
+
+  /* Microseconds; see g_main_context_set_timer_slack() */
+  gint64   timer_slack;
 };
 
 struct _GSourceCallback
@@ -352,6 +392,18 @@ struct _GSourcePrivate
   GSource *parent_source;
 
   gint64 ready_time;
+  gint heap_index;              /* in context->deadline_heap, or -1 */
+
+  /* While on context->incoming_sources: bit 0 is set, and the rest
+   * counts the g_source_unref() calls deferred until the source is
+   * drained.  See g_source_attach_lockless().
+   */
+  volatile gint incoming_state;
+
+  /* Monotonic time at which the source was found ready, when timing
+   * dispatches; see g_main_context_record_dispatch_unlocked().
+   */
+  gint64 ready_at;
 
   /* This is currently only used on UNIX, but we always declare it (and
    * let it remain empty on Windows) to avoid #ifdef all over the place.
@@ -367,13 +419,24 @@ typedef struct _GSourceIter
   GSource *source;
 } GSourceIter;
 
-#define LOCK_CONTEXT(context) g_mutex_lock (&context->mutex)
+#define LOCK_CONTEXT(context)                                             \
+   G_STMT_START {                                                         \
+    g_mutex_lock (&(context)->mutex);                                     \
+    if (G_UNLIKELY (g_atomic_pointer_get (&(context)->incoming_sources))) \
+      g_main_context_drain_incoming_unlocked (context);                   \
+   } G_STMT_END
 #define UNLOCK_CONTEXT(context) g_mutex_unlock (&context->mutex)
 #define G_THREAD_SELF g_thread_self ()
 
 #define SOURCE_DESTROYED(source) (((source)->flags & G_HOOK_FLAG_ACTIVE) == 0)
 #define SOURCE_BLOCKED(source) (((source)->flags & G_SOURCE_BLOCKED) != 0)
 
+/* Whether dispatches need to be timed, for the statistics or for the
+ * main__source_dispatch_stats probe.
+ */
+#define DISPATCH_TIMING(context) \
+  ((context)->source_stats != NULL || TRACE_ENABLED (GLIB_MAIN_SOURCE_DISPATCH_STATS))
+
 #define SOURCE_UNREF(source, context)                       \
    G_STMT_START {                                           \
     if ((source)->ref_count > 1)                            \
@@ -388,6 +451,7 @@ typedef struct _GSourceIter
 static void g_source_unref_internal             (GSource      *source,
 						 GMainContext *context,
 						 gboolean      have_lock);
+static void g_main_context_drain_incoming_unlocked (GMainContext *context);
 static void g_source_destroy_internal           (GSource      *source,
 						 GMainContext *context,
 						 gboolean      have_lock);
@@ -407,6 +471,12 @@ static void g_main_context_add_poll_unlocked    (GMainContext *context,
 						 GPollFD      *fd);
 static void g_main_context_remove_poll_unlocked (GMainContext *context,
 						 GPollFD      *fd);
+static void g_main_context_add_unix_fd_unlocked (GMainContext *context,
+						 gint          priority,
+						 GPollFD      *fd);
+static gboolean g_main_context_modify_unix_fd_unlocked (GMainContext *context,
+                                                        GPollFD      *fd,
+                                                        gushort       events);
 
 static void     g_source_iter_init  (GSourceIter   *iter,
 				     GMainContext  *context,
@@ -582,10 +652,29 @@ g_main_context_unref (GMainContext *context)
   g_mutex_clear (&context->mutex);
 
   g_ptr_array_free (context->pending_dispatches, TRUE);
+  g_ptr_array_free (context->deadline_heap, TRUE);
   g_free (context->cached_poll_array);
 
+  if (context->source_stats)
+    g_hash_table_unref (context->source_stats);
+
   poll_rec_list_free (context, context->poll_records);
 
+  if (context->poll_set)
+    {
+      GHashTableIter fd_iter;
+      gpointer chain;
+
+      g_hash_table_iter_init (&fd_iter, context->poll_set_records);
+      while (g_hash_table_iter_next (&fd_iter, NULL, &chain))
+        poll_rec_list_free (context, chain);
+      g_hash_table_destroy (context->poll_set_records);
+
+      g_ptr_array_free (context->poll_set_ready, TRUE);
+      g_free (context->poll_set_fds);
+      g_poll_set_free (context->poll_set);
+    }
+
   g_wakeup_free (context->wakeup);
   g_cond_clear (&context->cond);
 
@@ -604,6 +693,15 @@ g_main_context_new_with_next_id (guint next_id)
   return ret;
 }
 
+/* Used by GTask to tell whether any source has been attached to
+ * @context since the one with id @next_id - 1.
+ */
+guint
+g_main_context_peek_next_id (GMainContext *context)
+{
+  return (guint) g_atomic_int_get ((gint *) &context->next_id);
+}
+
 /**
  * g_main_context_new:
  * 
@@ -650,13 +748,24 @@ g_main_context_new (void)
   context->cached_poll_array_size = 0;
   
   context->pending_dispatches = g_ptr_array_new ();
+  context->deadline_heap = g_ptr_array_new ();
   
   context->time_is_fresh = FALSE;
   
   context->wakeup = g_wakeup_new ();
+  /* The context looks at its sources after acknowledging a wakeup */
+  g_wakeup_set_coalescing (context->wakeup, TRUE);
   g_wakeup_get_pollfd (context->wakeup, &context->wake_up_rec);
   g_main_context_add_poll_unlocked (context, 0, &context->wake_up_rec);
 
+  context->poll_set = g_poll_set_new ();
+  if (context->poll_set)
+    {
+      g_poll_set_get_pollfd (context->poll_set, &context->poll_set_rec);
+      context->poll_set_records = g_hash_table_new (NULL, NULL);
+      context->poll_set_ready = g_ptr_array_new ();
+    }
+
   G_LOCK (main_context_list);
   main_context_list = g_slist_append (main_context_list, context);
 
@@ -922,6 +1031,7 @@ g_source_new (GSourceFuncs *source_funcs,
   source->flags = G_HOOK_FLAG_ACTIVE;
 
   source->priv->ready_time = -1;
+  source->priv->heap_index = -1;
 
   /* NULL/0 initialization for all other fields */
 
@@ -932,6 +1042,185 @@ g_source_new (GSourceFuncs *source_funcs,
   return source;
 }
 
+/* The deadline heap lets g_main_context_prepare() and
+ * g_main_context_check() deal with all the prepare-less sources that
+ * only become ready through g_source_set_ready_time() (which includes
+ * every g_timeout_source_new()) without looking at them one by one: the
+ * expired ones are popped off the top and the next wakeup is read from
+ * the root.
+ *
+ * A source is in the heap iff it is attached, neither destroyed nor
+ * blocked, has a ready time and no prepare function.  Sources popped
+ * because they expired are put back after they are dispatched.
+ */
+
+#define HEAP_SOURCE(context, i) ((GSource *) (context)->deadline_heap->pdata[i])
+
+/* HOLDS: context's lock */
+static void
+deadline_heap_set (GMainContext *context,
+                   guint         index,
+                   GSource      *source)
+{
+  context->deadline_heap->pdata[index] = source;
+  source->priv->heap_index = index;
+}
+
+/* HOLDS: context's lock */
+static void
+deadline_heap_sift (GMainContext *context,
+                    guint         index)
+{
+  GSource *source = HEAP_SOURCE (context, index);
+  gint64 ready_time = source->priv->ready_time;
+  guint len = context->deadline_heap->len;
+
+  /* Up... */
+  while (index > 0)
+    {
+      guint parent = (index - 1) / 2;
+
+      if (HEAP_SOURCE (context, parent)->priv->ready_time <= ready_time)
+        break;
+
+      deadline_heap_set (context, index, HEAP_SOURCE (context, parent));
+      index = parent;
+    }
+
+  /* ...or down */
+  while (2 * index + 1 < len)
+    {
+      guint child = 2 * index + 1;
+
+      if (child + 1 < len &&
+          HEAP_SOURCE (context, child + 1)->priv->ready_time <
+          HEAP_SOURCE (context, child)->priv->ready_time)
+        child++;
+
+      if (ready_time <= HEAP_SOURCE (context, child)->priv->ready_time)
+        break;
+
+      deadline_heap_set (context, index, HEAP_SOURCE (context, child));
+      index = child;
+    }
+
+  deadline_heap_set (context, index, source);
+}
+
+/* HOLDS: context's lock */
+static void
+deadline_heap_remove (GMainContext *context,
+                      GSource      *source)
+{
+  guint index = source->priv->heap_index;
+  GSource *last;
+
+  source->priv->heap_index = -1;
+
+  last = g_ptr_array_remove_index (context->deadline_heap,
+                                   context->deadline_heap->len - 1);
+  if (last != source)
+    {
+      deadline_heap_set (context, index, last);
+      deadline_heap_sift (context, index);
+    }
+}
+
+/* HOLDS: context's lock
+ *
+ * Puts @source in the heap, moves it, or takes it out, according to its
+ * current state.
+ */
+static void
+deadline_heap_update (GMainContext *context,
+                      GSource      *source)
+{
+  gboolean wanted;
+
+  wanted = source->context == context &&
+           !SOURCE_DESTROYED (source) &&
+           !SOURCE_BLOCKED (source) &&
+           source->priv->ready_time != -1 &&
+           source->source_funcs->prepare == NULL;
+
+  if (source->priv->heap_index >= 0)
+    {
+      if (wanted)
+        deadline_heap_sift (context, source->priv->heap_index);
+      else
+        deadline_heap_remove (context, source);
+    }
+  else if (wanted)
+    {
+      g_ptr_array_add (context->deadline_heap, source);
+      source->priv->heap_index = context->deadline_heap->len - 1;
+      deadline_heap_sift (context, source->priv->heap_index);
+    }
+}
+
+/* HOLDS: context's lock
+ *
+ * Returns the time at which to wake up for a source becoming ready at
+ * @ready_time: the next multiple of the timer
+ * slack, so that all the sources becoming ready within one slack period
+ * are dispatched by a single wakeup.
+ */
+static inline gint64
+timer_slack_deadline (GMainContext *context,
+                      gint64        ready_time)
+{
+  gint64 slack = context->timer_slack;
+
+  if (slack == 0 || ready_time <= 0)
+    return ready_time;
+
+  return ((ready_time + slack - 1) / slack) * slack;
+}
+
+/* HOLDS: context's lock
+ *
+ * Flags every source whose ready time has passed as ready and returns
+ * the timeout until the next one expires, or -1.
+ */
+static gint
+deadline_heap_expire (GMainContext *context)
+{
+  GSource *source;
+  gint64 remaining;
+
+  if (context->deadline_heap->len == 0)
+    return -1;
+
+  if (!context->time_is_fresh)
+    {
+      context->time = g_get_monotonic_time ();
+      context->time_is_fresh = TRUE;
+    }
+
+  while (context->deadline_heap->len > 0)
+    {
+      GSource *ready_source;
+
+      source = HEAP_SOURCE (context, 0);
+
+      if (source->priv->ready_time > context->time)
+        break;
+
+      deadline_heap_remove (context, source);
+
+      for (ready_source = source; ready_source; ready_source = ready_source->priv->parent_source)
+        ready_source->flags |= G_SOURCE_READY;
+    }
+
+  if (context->deadline_heap->len == 0)
+    return -1;
+
+  /* rounding down will lead to spinning, so always round up */
+  remaining = timer_slack_deadline (context, HEAP_SOURCE (context, 0)->priv->ready_time) - context->time;
+
+  return MIN ((remaining + 999) / 1000, G_MAXINT);
+}
+
 /* Holds context's lock */
 static void
 g_source_iter_init (GSourceIter  *iter,
@@ -1141,28 +1430,69 @@ conditional_wakeup (GMainContext *context)
     g_wakeup_signal (context->wakeup);
 }
 
+/* Until the id counter wraps around, every id it returns is unused, so
+ * ids can be handed out without holding the lock.  Close to wrapping,
+ * this returns 0 and the caller must take the lock and use
+ * source_id_new_unlocked() instead, which checks for ids in use.
+ */
 static guint
-g_source_attach_unlocked (GSource      *source,
-                          GMainContext *context,
-                          gboolean      do_wakeup)
+source_id_new_lockless (GMainContext *context)
+{
+  guint id;
+
+  if (g_atomic_int_get (&context->ids_wrapped))
+    return 0;
+
+  id = (guint) g_atomic_int_add ((gint *) &context->next_id, 1);
+
+  if (id == 0 || id > G_MAXUINT - G_MAXUINT16)
+    {
+      g_atomic_int_set (&context->ids_wrapped, TRUE);
+      return 0;
+    }
+
+  return id;
+}
+
+/* Holds context's lock */
+static guint
+source_id_new_unlocked (GMainContext *context)
 {
-  GSList *tmp_list;
   guint id;
 
   /* The counter may have wrapped, so we must ensure that we do not
    * reuse the source id of an existing source.
    */
   do
-    id = context->next_id++;
+    id = (guint) g_atomic_int_add ((gint *) &context->next_id, 1);
   while (id == 0 || g_hash_table_contains (context->sources, GUINT_TO_POINTER (id)));
 
-  source->context = context;
-  source->source_id = id;
-  source->ref_count++;
+  if (id > G_MAXUINT - G_MAXUINT16)
+    g_atomic_int_set (&context->ids_wrapped, TRUE);
+
+  return id;
+}
+
+static guint g_source_attach_unlocked (GSource      *source,
+                                       GMainContext *context,
+                                       gboolean      do_wakeup);
+
+/* Holds context's lock
+ *
+ * Does the part of attaching that makes @source visible to the context;
+ * source->context, source->source_id and the reference have already
+ * been set up.
+ */
+static void
+g_source_attach_finish_unlocked (GSource      *source,
+                                 GMainContext *context)
+{
+  GSList *tmp_list;
 
-  g_hash_table_insert (context->sources, GUINT_TO_POINTER (id), source);
+  g_hash_table_insert (context->sources, GUINT_TO_POINTER (source->source_id), source);
 
   source_add_to_context (source, context);
+  deadline_heap_update (context, source);
 
   if (!SOURCE_BLOCKED (source))
     {
@@ -1174,7 +1504,7 @@ g_source_attach_unlocked (GSource      *source,
         }
 
       for (tmp_list = source->priv->fds; tmp_list; tmp_list = tmp_list->next)
-        g_main_context_add_poll_unlocked (context, source->priority, tmp_list->data);
+        g_main_context_add_unix_fd_unlocked (context, source->priority, tmp_list->data);
     }
 
   tmp_list = source->priv->child_sources;
@@ -1183,6 +1513,18 @@ g_source_attach_unlocked (GSource      *source,
       g_source_attach_unlocked (tmp_list->data, context, FALSE);
       tmp_list = tmp_list->next;
     }
+}
+
+static guint
+g_source_attach_unlocked (GSource      *source,
+                          GMainContext *context,
+                          gboolean      do_wakeup)
+{
+  source->context = context;
+  source->source_id = source_id_new_unlocked (context);
+  source->ref_count++;
+
+  g_source_attach_finish_unlocked (source, context);
 
   /* If another thread has acquired the context, wake it up since it
    * might be in poll() right now.
@@ -1193,6 +1535,78 @@ g_source_attach_unlocked (GSource      *source,
   return source->source_id;
 }
 
+/* Holds context's lock */
+static void
+g_main_context_drain_incoming_unlocked (GMainContext *context)
+{
+  GSource *list, *source, *next;
+  GSource *ordered = NULL;
+
+  do
+    list = g_atomic_pointer_get (&context->incoming_sources);
+  while (!g_atomic_pointer_compare_and_exchange (&context->incoming_sources, list, NULL));
+
+  /* Attach in the order g_source_attach() was called */
+  for (source = list; source; source = next)
+    {
+      next = source->next;
+      source->next = ordered;
+      ordered = source;
+    }
+
+  for (source = ordered; source; source = next)
+    {
+      gint state;
+
+      next = source->next;
+      source->next = NULL;
+
+      do
+        state = g_atomic_int_get (&source->priv->incoming_state);
+      while (!g_atomic_int_compare_and_exchange (&source->priv->incoming_state, state, 0));
+
+      /* The queue's own reference keeps this above zero */
+      source->ref_count -= state >> 1;
+
+      g_source_attach_finish_unlocked (source, context);
+    }
+}
+
+/* Attaches @source without waiting for the context lock, as long as a
+ * source id can be allocated without it.  Returns 0 otherwise.
+ */
+static guint
+g_source_attach_lockless (GSource      *source,
+                          GMainContext *context)
+{
+  gpointer head;
+  guint id;
+
+  id = source_id_new_lockless (context);
+  if (id == 0)
+    return 0;
+
+  source->context = context;
+  source->source_id = id;
+  source->ref_count++;
+  source->priv->incoming_state = 1;
+
+  do
+    {
+      head = g_atomic_pointer_get (&context->incoming_sources);
+      source->next = head;
+    }
+  while (!g_atomic_pointer_compare_and_exchange (&context->incoming_sources, head, source));
+
+  /* The lock is held by someone else, so this can only be the owner if
+   * the owner is not itself holding the lock; either way wake it up if
+   * it is not us, exactly like g_source_attach_unlocked() does.
+   */
+  conditional_wakeup (context);
+
+  return id;
+}
+
 /**
  * g_source_attach:
  * @source: a #GSource
@@ -1216,7 +1630,25 @@ g_source_attach (GSource      *source,
   if (!context)
     context = g_main_context_default ();
 
-  LOCK_CONTEXT (context);
+  /* If the lock is busy (typically because the owner is going through
+   * its sources), queue the source for the next LOCK_CONTEXT() rather
+   * than waiting.
+   */
+  if (!g_mutex_trylock (&context->mutex))
+    {
+      result = g_source_attach_lockless (source, context);
+
+      if (result != 0)
+        {
+          TRACE (GLIB_MAIN_SOURCE_ATTACH (g_source_get_name (source), source, context,
+                                          result));
+          return result;
+        }
+
+      LOCK_CONTEXT (context);
+    }
+  else if (g_atomic_pointer_get (&context->incoming_sources))
+    g_main_context_drain_incoming_unlocked (context);
 
   result = g_source_attach_unlocked (source, context, TRUE);
 
@@ -1246,6 +1678,7 @@ g_source_destroy_internal (GSource      *source,
       GSourceCallbackFuncs *old_cb_funcs;
       
       source->flags &= ~G_HOOK_FLAG_ACTIVE;
+      deadline_heap_update (context, source);
 
       old_cb_data = source->callback_data;
       old_cb_funcs = source->callback_funcs;
@@ -1745,7 +2178,7 @@ g_source_set_priority_unlocked (GSource      *source,
           for (tmp_list = source->priv->fds; tmp_list; tmp_list = tmp_list->next)
             {
               g_main_context_remove_poll_unlocked (context, tmp_list->data);
-              g_main_context_add_poll_unlocked (context, priority, tmp_list->data);
+              g_main_context_add_unix_fd_unlocked (context, priority, tmp_list->data);
             }
 	}
     }
@@ -1863,6 +2296,8 @@ g_source_set_ready_time (GSource *source,
 
   if (context)
     {
+      deadline_heap_update (context, source);
+
       /* Quite likely that we need to change the timeout on the poll */
       if (!SOURCE_BLOCKED (source))
         conditional_wakeup (context);
@@ -2174,8 +2609,19 @@ g_source_unref_internal (GSource      *source,
 void
 g_source_unref (GSource *source)
 {
+  gint state;
+
   g_return_if_fail (source != NULL);
 
+  /* The common g_source_attach(); g_source_unref(); sequence should not
+   * have to wait for the lock after a lockless attach either: the
+   * reference held by the incoming queue means this cannot be the last
+   * one, so just leave a note for the drain.
+   */
+  while ((state = g_atomic_int_get (&source->priv->incoming_state)) & 1)
+    if (g_atomic_int_compare_and_exchange (&source->priv->incoming_state, state, state + 2))
+      return;
+
   g_source_unref_internal (source, source->context, FALSE);
 }
 
@@ -2464,7 +2910,7 @@ g_source_add_unix_fd (GSource      *source,
   if (context)
     {
       if (!SOURCE_BLOCKED (source))
-        g_main_context_add_poll_unlocked (context, source->priority, poll_fd);
+        g_main_context_add_unix_fd_unlocked (context, source->priority, poll_fd);
       UNLOCK_CONTEXT (context);
     }
 
@@ -2505,10 +2951,20 @@ g_source_modify_unix_fd (GSource      *source,
   context = source->context;
   poll_fd = tag;
 
-  poll_fd->events = new_events;
-
   if (context)
-    g_main_context_wakeup (context);
+    {
+      gboolean in_poll_set;
+
+      LOCK_CONTEXT (context);
+      in_poll_set = g_main_context_modify_unix_fd_unlocked (context, poll_fd, new_events);
+      UNLOCK_CONTEXT (context);
+
+      /* The kernel notices the change by itself */
+      if (!in_poll_set)
+        g_main_context_wakeup (context);
+    }
+  else
+    poll_fd->events = new_events;
 }
 
 /**
@@ -3120,6 +3576,8 @@ block_source (GSource *source)
 
   if (source->context)
     {
+      deadline_heap_update (source->context, source);
+
       tmp_list = source->poll_fds;
       while (tmp_list)
         {
@@ -3153,6 +3611,8 @@ unblock_source (GSource *source)
   
   source->flags &= ~G_SOURCE_BLOCKED;
 
+  deadline_heap_update (source->context, source);
+
   tmp_list = source->poll_fds;
   while (tmp_list)
     {
@@ -3161,7 +3621,7 @@ unblock_source (GSource *source)
     }
 
   for (tmp_list = source->priv->fds; tmp_list; tmp_list = tmp_list->next)
-    g_main_context_add_poll_unlocked (source->context, source->priority, tmp_list->data);
+    g_main_context_add_unix_fd_unlocked (source->context, source->priority, tmp_list->data);
 
   if (source->priv && source->priv->child_sources)
     {
@@ -3174,6 +3634,46 @@ unblock_source (GSource *source)
     }
 }
 
+/* HOLDS: context's lock */
+static void
+g_main_context_record_dispatch_unlocked (GMainContext *context,
+                                         GSource      *source,
+                                         gint64        dispatch_start,
+                                         gint64        dispatch_end)
+{
+  gint64 duration, latency;
+
+  duration = dispatch_end - dispatch_start;
+  latency = 0;
+  if (source->priv->ready_at != 0 && dispatch_start > source->priv->ready_at)
+    latency = dispatch_start - source->priv->ready_at;
+  source->priv->ready_at = 0;
+
+  TRACE (GLIB_MAIN_SOURCE_DISPATCH_STATS (source->name, source,
+                                          latency, duration));
+
+  if (context->source_stats)
+    {
+      GSourceStats *stats;
+      const gchar *key;
+
+      key = source->name ? source->name : "";
+      stats = g_hash_table_lookup (context->source_stats, key);
+      if (stats == NULL)
+        {
+          stats = g_slice_new0 (GSourceStats);
+          stats->name = g_strdup (source->name);
+          g_hash_table_insert (context->source_stats, g_strdup (key), stats);
+        }
+
+      stats->dispatch_count++;
+      stats->total_dispatch_time += duration;
+      stats->max_dispatch_time = MAX (stats->max_dispatch_time, duration);
+      stats->total_latency += latency;
+      stats->max_latency = MAX (stats->max_latency, latency);
+    }
+}
+
 /* HOLDS: context's lock */
 static void
 g_main_dispatch (GMainContext *context)
@@ -3198,6 +3698,9 @@ g_main_dispatch (GMainContext *context)
 	  GSourceCallbackFuncs *cb_funcs;
 	  gpointer cb_data;
 	  gboolean need_destroy;
+          gboolean timing;
+          gint64 dispatch_start = 0;
+          gint64 dispatch_end = 0;
 
 	  gboolean (*dispatch) (GSource *,
 				GSourceFunc,
@@ -3220,6 +3723,8 @@ g_main_dispatch (GMainContext *context)
 	  if (cb_funcs)
 	    cb_funcs->get (cb_data, source, &callback, &user_data);
 
+          timing = DISPATCH_TIMING (context);
+
 	  UNLOCK_CONTEXT (context);
 
           /* These operations are safe because 'current' is thread-local
@@ -3229,12 +3734,18 @@ g_main_dispatch (GMainContext *context)
           current->source = source;
           current->depth++;
 
+          if (G_UNLIKELY (timing))
+            dispatch_start = g_get_monotonic_time ();
+
           TRACE (GLIB_MAIN_BEFORE_DISPATCH (g_source_get_name (source), source,
                                             dispatch, callback, user_data));
           need_destroy = !(* dispatch) (source, callback, user_data);
           TRACE (GLIB_MAIN_AFTER_DISPATCH (g_source_get_name (source), source,
                                            dispatch, need_destroy));
 
+          if (G_UNLIKELY (timing))
+            dispatch_end = g_get_monotonic_time ();
+
           current->source = prev_source;
           current->depth--;
 
@@ -3246,8 +3757,15 @@ g_main_dispatch (GMainContext *context)
 	  if (!was_in_call)
 	    source->flags &= ~G_HOOK_FLAG_IN_CALL;
 
+          if (G_UNLIKELY (timing))
+            g_main_context_record_dispatch_unlocked (context, source,
+                                                     dispatch_start,
+                                                     dispatch_end);
+
 	  if (SOURCE_BLOCKED (source) && !SOURCE_DESTROYED (source))
 	    unblock_source (source);
+	  else
+	    deadline_heap_update (context, source);
 	  
 	  /* Note: this depends on the fact that we can't switch
 	   * sources from one main context to another
@@ -3504,7 +4022,7 @@ g_main_context_prepare (GMainContext *context,
   
   /* Prepare all sources */
 
-  context->timeout = -1;
+  context->timeout = deadline_heap_expire (context);
   
   g_source_iter_init (&iter, context, TRUE);
   while (g_source_iter_next (&iter, &source))
@@ -3541,7 +4059,8 @@ g_main_context_prepare (GMainContext *context,
               result = FALSE;
             }
 
-          if (result == FALSE && source->priv->ready_time != -1)
+          /* Sources without prepare are on the deadline heap */
+          if (result == FALSE && prepare && source->priv->ready_time != -1)
             {
               if (!context->time_is_fresh)
                 {
@@ -3559,7 +4078,7 @@ g_main_context_prepare (GMainContext *context,
                   gint timeout;
 
                   /* rounding down will lead to spinning, so always round up */
-                  timeout = (source->priv->ready_time - context->time + 999) / 1000;
+                  timeout = (timer_slack_deadline (context, source->priv->ready_time) - context->time + 999) / 1000;
 
                   if (source_timeout < 0 || timeout < source_timeout)
                     source_timeout = timeout;
@@ -3672,26 +4191,152 @@ g_main_context_query (GMainContext *context,
       lastpollrec = pollrec;
     }
 
-  context->poll_changed = FALSE;
-  
-  if (timeout)
+  if (context->poll_set_in_use)
     {
-      *timeout = context->timeout;
-      if (*timeout != 0)
-        context->time_is_fresh = FALSE;
+      /* Everything registered in the poll set is covered by a single fd */
+      if (n_poll < n_fds)
+        {
+          fds[n_poll].fd = context->poll_set_rec.fd;
+          fds[n_poll].events = context->poll_set_rec.events;
+          fds[n_poll].revents = 0;
+        }
+
+      n_poll++;
     }
+  else if (context->poll_set)
+    {
+      GHashTableIter fd_iter;
+      gpointer chain;
 
-  TRACE (GLIB_MAIN_CONTEXT_AFTER_QUERY (context, context->timeout,
-                                        fds, n_poll));
+      g_hash_table_iter_init (&fd_iter, context->poll_set_records);
+      while (g_hash_table_iter_next (&fd_iter, NULL, &chain))
+        {
+          events = 0;
 
-  UNLOCK_CONTEXT (context);
+          for (pollrec = chain; pollrec; pollrec = pollrec->next)
+            if (pollrec->priority <= max_priority)
+              events |= pollrec->fd->events & ~(G_IO_ERR|G_IO_HUP|G_IO_NVAL);
 
-  return n_poll;
-}
+          if (events == 0)
+            continue;
 
-/**
- * g_main_context_check:
- * @context: a #GMainContext
+          if (n_poll < n_fds)
+            {
+              fds[n_poll].fd = ((GPollRec *) chain)->fd->fd;
+              fds[n_poll].events = events;
+              fds[n_poll].revents = 0;
+            }
+
+          n_poll++;
+        }
+    }
+
+  context->poll_changed = FALSE;
+  
+  if (timeout)
+    {
+      *timeout = context->timeout;
+      if (*timeout != 0)
+        context->time_is_fresh = FALSE;
+    }
+
+  TRACE (GLIB_MAIN_CONTEXT_AFTER_QUERY (context, context->timeout,
+                                        fds, n_poll));
+
+  UNLOCK_CONTEXT (context);
+
+  return n_poll;
+}
+
+/* HOLDS: context's lock */
+static void
+poll_set_report_unlocked (GMainContext *context,
+                          gint          max_priority,
+                          GPollFD      *ready)
+{
+  GPollRec *pollrec;
+
+  pollrec = g_hash_table_lookup (context->poll_set_records, GINT_TO_POINTER (ready->fd));
+
+  for (; pollrec; pollrec = pollrec->next)
+    {
+      gushort revents;
+
+      if (pollrec->priority > max_priority)
+        continue;
+
+      revents = ready->revents & (pollrec->fd->events | G_IO_ERR | G_IO_HUP | G_IO_NVAL);
+      if (revents == 0)
+        continue;
+
+      if (pollrec->fd->revents == 0)
+        g_ptr_array_add (context->poll_set_ready, pollrec->fd);
+
+      pollrec->fd->revents |= revents;
+    }
+}
+
+/* HOLDS: context's lock */
+static void
+poll_set_check_unlocked (GMainContext *context,
+                         gboolean      in_use,
+                         gint          max_priority,
+                         GPollFD      *fds,
+                         gint          n_fds)
+{
+  gint n_ready;
+  gint i;
+
+  /* Forget about what was reported during the previous iteration */
+  for (i = 0; i < context->poll_set_ready->len; i++)
+    ((GPollFD *) context->poll_set_ready->pdata[i])->revents = 0;
+  g_ptr_array_set_size (context->poll_set_ready, 0);
+
+  if (!in_use)
+    {
+      /* g_main_context_query() listed each fd separately */
+      for (i = 0; i < n_fds; i++)
+        if (fds[i].revents)
+          poll_set_report_unlocked (context, max_priority, &fds[i]);
+
+      return;
+    }
+
+  /* The poll set fd is appended last by g_main_context_query() */
+  for (i = n_fds - 1; i >= 0; i--)
+    if (fds[i].fd == context->poll_set_rec.fd)
+      break;
+
+  if (i < 0 || !(fds[i].revents & G_IO_IN))
+    return;
+
+  if (context->poll_set_fds == NULL)
+    {
+      context->poll_set_fds_size = 64;
+      context->poll_set_fds = g_new (GPollFD, context->poll_set_fds_size);
+    }
+
+  n_ready = g_poll_set_collect (context->poll_set, context->poll_set_fds,
+                                context->poll_set_fds_size);
+
+  for (i = 0; i < n_ready; i++)
+    poll_set_report_unlocked (context, max_priority, &context->poll_set_fds[i]);
+
+  /* Whatever did not fit is still pending (the poll set is level
+   * triggered) and will be picked up next time; make sure that next
+   * time there is more room.
+   */
+  if (n_ready == context->poll_set_fds_size)
+    {
+      context->poll_set_fds_size *= 2;
+      context->poll_set_fds = g_renew (GPollFD, context->poll_set_fds,
+                                       context->poll_set_fds_size);
+    }
+}
+
+/**
+ * g_main_context_check:
+ * @context: a #GMainContext
  * @max_priority: the maximum numerical priority of sources to check
  * @fds: (array length=n_fds): array of #GPollFD's that was passed to
  *       the last call to g_main_context_query()
@@ -3713,6 +4358,7 @@ g_main_context_check (GMainContext *context,
   GSource *source;
   GSourceIter iter;
   GPollRec *pollrec;
+  gboolean poll_set_in_use;
   gint n_ready = 0;
   gint i;
    
@@ -3728,6 +4374,9 @@ g_main_context_check (GMainContext *context,
 
   TRACE (GLIB_MAIN_CONTEXT_BEFORE_CHECK (context, max_priority, fds, n_fds));
 
+  poll_set_in_use = context->poll_set_in_use;
+  context->poll_set_in_use = FALSE;
+
   for (i = 0; i < n_fds; i++)
     {
       if (fds[i].fd == context->wake_up_rec.fd)
@@ -3752,6 +4401,9 @@ g_main_context_check (GMainContext *context,
       return FALSE;
     }
 
+  if (context->poll_set)
+    poll_set_check_unlocked (context, poll_set_in_use, max_priority, fds, n_fds);
+
   pollrec = context->poll_records;
   i = 0;
   while (pollrec && i < n_fds)
@@ -3769,6 +4421,9 @@ g_main_context_check (GMainContext *context,
       i++;
     }
 
+  /* Time has passed while we were polling */
+  deadline_heap_expire (context);
+
   g_source_iter_init (&iter, context, TRUE);
   while (g_source_iter_next (&iter, &source))
     {
@@ -3820,7 +4475,8 @@ g_main_context_check (GMainContext *context,
                 }
             }
 
-          if (result == FALSE && source->priv->ready_time != -1)
+          if (result == FALSE && source->source_funcs->prepare &&
+              source->priv->ready_time != -1)
             {
               if (!context->time_is_fresh)
                 {
@@ -3846,6 +4502,24 @@ g_main_context_check (GMainContext *context,
 
       if (source->flags & G_SOURCE_READY)
 	{
+          if (G_UNLIKELY (DISPATCH_TIMING (context)))
+            {
+              if (!context->time_is_fresh)
+                {
+                  context->time = g_get_monotonic_time ();
+                  context->time_is_fresh = TRUE;
+                }
+
+              /* For sources that became ready at a known time, count
+               * from then; otherwise from when we noticed.
+               */
+              if (source->priv->ready_time > 0 &&
+                  source->priv->ready_time <= context->time)
+                source->priv->ready_at = source->priv->ready_time;
+              else
+                source->priv->ready_at = context->time;
+            }
+
 	  source->ref_count++;
 	  g_ptr_array_add (context->pending_dispatches, source);
 
@@ -3934,6 +4608,9 @@ g_main_context_iterate (GMainContext *context,
 
   allocated_nfds = context->cached_poll_array_size;
   fds = context->cached_poll_array;
+
+  /* A custom poll function gets to see every fd, as it always did */
+  context->poll_set_in_use = context->poll_set && context->poll_func == g_poll;
   
   UNLOCK_CONTEXT (context);
 
@@ -4386,6 +5063,177 @@ g_main_context_add_poll_unlocked (GMainContext *context,
   conditional_wakeup (context);
 }
 
+/* HOLDS: context's lock */
+static gushort
+poll_set_chain_events (GPollRec *chain)
+{
+  gushort events = 0;
+
+  for (; chain; chain = chain->next)
+    events |= chain->fd->events;
+
+  return events;
+}
+
+/* HOLDS: context's lock */
+static void
+g_main_context_add_unix_fd_unlocked (GMainContext *context,
+                                     gint          priority,
+                                     GPollFD      *fd)
+{
+  GPollRec *chain, *newrec;
+  gboolean registered;
+
+  if (!context->poll_set)
+    {
+      g_main_context_add_poll_unlocked (context, priority, fd);
+      return;
+    }
+
+  chain = g_hash_table_lookup (context->poll_set_records, GINT_TO_POINTER (fd->fd));
+
+  if (chain)
+    {
+      gushort events = poll_set_chain_events (chain);
+
+      registered = g_poll_set_modify (context->poll_set, fd->fd,
+                                      events, events | fd->events);
+    }
+  else
+    registered = g_poll_set_add (context->poll_set, fd->fd, fd->events);
+
+  /* Some fds (regular files, for example) can only be handled by poll() */
+  if (!registered)
+    {
+      g_main_context_add_poll_unlocked (context, priority, fd);
+      return;
+    }
+
+  newrec = g_slice_new (GPollRec);
+  fd->revents = 0;
+  newrec->fd = fd;
+  newrec->priority = priority;
+  newrec->prev = NULL;
+  newrec->next = chain;
+
+  if (chain)
+    chain->prev = newrec;
+
+  g_hash_table_insert (context->poll_set_records, GINT_TO_POINTER (fd->fd), newrec);
+
+  /* If the owner is polling the poll set fd, it will become readable by
+   * itself if the new fd is ready; otherwise behave like a normal add.
+   */
+  if (!context->poll_set_in_use)
+    {
+      context->poll_changed = TRUE;
+      conditional_wakeup (context);
+    }
+}
+
+/* HOLDS: context's lock
+ *
+ * Returns %TRUE if @fd was found in the poll set and removed from it.
+ */
+static gboolean
+poll_set_remove_unlocked (GMainContext *context,
+                          GPollFD      *fd)
+{
+  GPollRec *chain, *pollrec;
+  gushort old_events;
+
+  chain = g_hash_table_lookup (context->poll_set_records, GINT_TO_POINTER (fd->fd));
+
+  for (pollrec = chain; pollrec; pollrec = pollrec->next)
+    if (pollrec->fd == fd)
+      break;
+
+  if (pollrec == NULL)
+    return FALSE;
+
+  old_events = poll_set_chain_events (chain);
+
+  if (pollrec->prev)
+    pollrec->prev->next = pollrec->next;
+  else
+    chain = pollrec->next;
+
+  if (pollrec->next)
+    pollrec->next->prev = pollrec->prev;
+
+  g_slice_free (GPollRec, pollrec);
+
+  if (chain)
+    {
+      gushort events = poll_set_chain_events (chain);
+
+      g_hash_table_insert (context->poll_set_records, GINT_TO_POINTER (fd->fd), chain);
+
+      if (events != old_events)
+        g_poll_set_modify (context->poll_set, fd->fd, old_events, events);
+    }
+  else
+    {
+      g_hash_table_remove (context->poll_set_records, GINT_TO_POINTER (fd->fd));
+      g_poll_set_remove (context->poll_set, fd->fd, old_events);
+    }
+
+  /* Only records with revents set are on the ready list */
+  if (fd->revents)
+    g_ptr_array_remove_fast (context->poll_set_ready, fd);
+
+  return TRUE;
+}
+
+/* HOLDS: context's lock
+ *
+ * Returns %TRUE if the change was pushed to a poll set that the owner
+ * is currently waiting on, in which case no wakeup is required.
+ */
+static gboolean
+g_main_context_modify_unix_fd_unlocked (GMainContext *context,
+                                        GPollFD      *fd,
+                                        gushort       events)
+{
+  GPollRec *chain, *pollrec;
+  gushort old_events;
+  gint priority;
+
+  if (!context->poll_set)
+    {
+      fd->events = events;
+      return FALSE;
+    }
+
+  chain = g_hash_table_lookup (context->poll_set_records, GINT_TO_POINTER (fd->fd));
+
+  for (pollrec = chain; pollrec; pollrec = pollrec->next)
+    if (pollrec->fd == fd)
+      break;
+
+  if (pollrec == NULL)
+    {
+      /* Blocked, or handled by poll() */
+      fd->events = events;
+      return FALSE;
+    }
+
+  old_events = poll_set_chain_events (chain);
+  fd->events = events;
+  events = poll_set_chain_events (chain);
+
+  if (events == old_events ||
+      g_poll_set_modify (context->poll_set, fd->fd, old_events, events))
+    return context->poll_set_in_use;
+
+  /* The kernel refused the new mask; let poll() report on it instead */
+  priority = pollrec->priority;
+  poll_set_remove_unlocked (context, fd);
+  g_main_context_add_poll_unlocked (context, priority, fd);
+
+  return FALSE;
+}
+
 /**
  * g_main_context_remove_poll:
  * @context:a #GMainContext 
@@ -4415,6 +5263,9 @@ g_main_context_remove_poll_unlocked (GMainContext *context,
 {
   GPollRec *pollrec, *prevrec, *nextrec;
 
+  if (context->poll_set && poll_set_remove_unlocked (context, fd))
+    return;
+
   prevrec = NULL;
   pollrec = context->poll_records;
 
@@ -4561,6 +5412,193 @@ g_main_context_get_poll_func (GMainContext *context)
   return result;
 }
 
+/**
+ * g_main_context_set_timer_slack:
+ * @context: (nullable): a #GMainContext (if %NULL, the default context will be used)
+ * @slack: the timer slack, in milliseconds, or 0
+ *
+ * Allows @context to delay the dispatch of sources with a ready time,
+ * such as timeouts, by up to @slack milliseconds, so that sources
+ * becoming ready at nearby times are dispatched together.
+ *
+ * With a slack set, @context only wakes up for a ready time at the
+ * next multiple of @slack on the monotonic clock.  All sources
+ * becoming ready in the same interval are dispatched by the same
+ * wakeup; since the intervals are the same for every context, this
+ * also groups wakeups across threads and processes.  This can greatly
+ * cut the number of wakeups per second of a program which runs many
+ * short timeouts, at the expense of their accuracy.
+ *
+ * Sources are never dispatched before their ready time.  The default
+ * slack of 0 wakes @context up as close to each ready time as
+ * possible.
+ *
+ * Since: 2.54
+ **/
+void
+g_main_context_set_timer_slack (GMainContext *context,
+                                guint         slack)
+{
+  if (!context)
+    context = g_main_context_default ();
+
+  LOCK_CONTEXT (context);
+  context->timer_slack = (gint64) slack * 1000;
+  conditional_wakeup (context);
+  UNLOCK_CONTEXT (context);
+}
+
+/**
+ * g_main_context_get_timer_slack:
+ * @context: (nullable): a #GMainContext (if %NULL, the default context will be used)
+ *
+ * Gets the timer slack of @context, as set with
+ * g_main_context_set_timer_slack().
+ *
+ * Returns: the timer slack, in milliseconds
+ *
+ * Since: 2.54
+ **/
+guint
+g_main_context_get_timer_slack (GMainContext *context)
+{
+  guint slack;
+
+  if (!context)
+    context = g_main_context_default ();
+
+  LOCK_CONTEXT (context);
+  slack = context->timer_slack / 1000;
+  UNLOCK_CONTEXT (context);
+
+  return slack;
+}
+
+/**
+ * g_main_context_set_source_stats_enabled:
+ * @context: (nullable): a #GMainContext (if %NULL, the default context will be used)
+ * @enabled: whether to collect statistics
+ *
+ * Enables or disables the collection of dispatch statistics for the
+ * sources of @context, which can be retrieved with
+ * g_main_context_get_source_stats().
+ *
+ * While enabled, @context records for every dispatch how long the
+ * dispatch function ran, and how long the source waited between
+ * becoming ready and being dispatched.  This makes it possible to find
+ * the sources that hold up the main loop.  The figures are accumulated
+ * per source name, as set with g_source_set_name(), so naming sources
+ * makes the statistics more useful.
+ *
+ * Disabling the collection discards the statistics gathered so far.
+ *
+ * The same timings are available through the
+ * `main__source_dispatch_stats` SystemTap and DTrace probe, whether or
+ * not collection is enabled.
+ *
+ * Since: 2.54
+ **/
+void
+g_main_context_set_source_stats_enabled (GMainContext *context,
+                                         gboolean      enabled)
+{
+  if (!context)
+    context = g_main_context_default ();
+
+  LOCK_CONTEXT (context);
+
+  if (enabled && context->source_stats == NULL)
+    context->source_stats = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                   (GDestroyNotify) g_source_stats_free);
+  else if (!enabled && context->source_stats != NULL)
+    g_clear_pointer (&context->source_stats, g_hash_table_unref);
+
+  UNLOCK_CONTEXT (context);
+}
+
+/**
+ * g_main_context_get_source_stats:
+ * @context: (nullable): a #GMainContext (if %NULL, the default context will be used)
+ *
+ * Gets the dispatch statistics gathered for the sources of @context
+ * since g_main_context_set_source_stats_enabled() was called.  There is
+ * one #GSourceStats per source name; all unnamed sources are counted
+ * together, in an entry with a %NULL name.
+ *
+ * Returns: (transfer full) (element-type GSourceStats): a new array
+ *     of #GSourceStats, in no particular order; the array is empty if
+ *     collection is not enabled
+ *
+ * Since: 2.54
+ **/
+GPtrArray *
+g_main_context_get_source_stats (GMainContext *context)
+{
+  GPtrArray *result;
+
+  if (!context)
+    context = g_main_context_default ();
+
+  result = g_ptr_array_new_with_free_func ((GDestroyNotify) g_source_stats_free);
+
+  LOCK_CONTEXT (context);
+
+  if (context->source_stats)
+    {
+      GHashTableIter iter;
+      gpointer value;
+
+      g_hash_table_iter_init (&iter, context->source_stats);
+      while (g_hash_table_iter_next (&iter, NULL, &value))
+        {
+          g_ptr_array_add (result, g_source_stats_copy (value));
+        }
+    }
+
+  UNLOCK_CONTEXT (context);
+
+  return result;
+}
+
+/**
+ * g_source_stats_copy:
+ * @stats: a #GSourceStats
+ *
+ * Makes a copy of @stats.
+ *
+ * Returns: (transfer full): a new #GSourceStats; free it with
+ *     g_source_stats_free()
+ *
+ * Since: 2.54
+ **/
+GSourceStats *
+g_source_stats_copy (const GSourceStats *stats)
+{
+  GSourceStats *copy;
+
+  g_return_val_if_fail (stats != NULL, NULL);
+
+  copy = g_slice_dup (GSourceStats, stats);
+  copy->name = g_strdup (stats->name);
+
+  return copy;
+}
+
+/**
+ * g_source_stats_free:
+ * @stats: a #GSourceStats
+ *
+ * Frees a #GSourceStats obtained from g_main_context_get_source_stats().
+ *
+ * Since: 2.54
+ **/
+void
+g_source_stats_free (GSourceStats *stats)
+{
+  g_free (stats->name);
+  g_slice_free (GSourceStats, stats);
+}
+
 /**
  * g_main_context_wakeup:
  * @context: a #GMainContext
@@ -5804,6 +6842,288 @@ g_main_context_invoke_full (GMainContext   *context,
     }
 }
 
+/* Number of slots in the ring of a #GInvokeBatch; must be a power of two */
+#define INVOKE_BATCH_SIZE 1024
+/* Maximum number of calls made per dispatch of the batch source */
+#define INVOKE_BATCH_MAX_DISPATCH 128
+
+typedef struct
+{
+  /* Equal to the position for a free slot, and to the position + 1 once
+   * the slot has been filled in; see g_invoke_batch_push_ring().
+   */
+  volatile gint sequence;
+
+  GSourceFunc function;
+  gpointer data;
+  GDestroyNotify notify;
+} GInvokeSlot;
+
+typedef struct
+{
+  GSource source;
+
+  GInvokeSlot slots[INVOKE_BATCH_SIZE];
+  volatile gint tail;         /* next position to fill, shared by producers */
+  gint head;                  /* next position to call, owner only */
+
+  /* TRUE while a dispatch of the source has been requested */
+  volatile gint pending;
+
+  /* Calls queued while the ring was full, and any queued after them by
+   * the same producer (so that they are not overtaken).
+   */
+  volatile gint overflowing;
+  GMutex overflow_lock;
+  GQueue overflow;
+} GInvokeBatch;
+
+/* Bounded multiple-producer ring, after Dmitry Vyukov's MPMC queue.
+ * Returns FALSE if the ring is full.
+ */
+static gboolean
+g_invoke_batch_push_ring (GInvokeBatch   *batch,
+                          GSourceFunc     function,
+                          gpointer        data,
+                          GDestroyNotify  notify)
+{
+  GInvokeSlot *slot;
+  guint pos;
+
+  pos = g_atomic_int_get (&batch->tail);
+  for (;;)
+    {
+      gint diff;
+
+      slot = &batch->slots[pos & (INVOKE_BATCH_SIZE - 1)];
+      diff = (gint) ((guint) g_atomic_int_get (&slot->sequence) - pos);
+
+      if (diff == 0)
+        {
+          if (g_atomic_int_compare_and_exchange (&batch->tail, pos, pos + 1))
+            break;
+          pos = g_atomic_int_get (&batch->tail);
+        }
+      else if (diff < 0)
+        return FALSE;
+      else
+        pos = g_atomic_int_get (&batch->tail);
+    }
+
+  slot->function = function;
+  slot->data = data;
+  slot->notify = notify;
+  g_atomic_int_set (&slot->sequence, pos + 1);
+
+  return TRUE;
+}
+
+static gboolean
+g_invoke_batch_pop_ring (GInvokeBatch *batch,
+                         GInvokeSlot  *item)
+{
+  GInvokeSlot *slot;
+  guint pos = batch->head;
+
+  slot = &batch->slots[pos & (INVOKE_BATCH_SIZE - 1)];
+  if ((guint) g_atomic_int_get (&slot->sequence) != pos + 1)
+    return FALSE;
+
+  item->function = slot->function;
+  item->data = slot->data;
+  item->notify = slot->notify;
+  g_atomic_int_set (&slot->sequence, pos + INVOKE_BATCH_SIZE);
+  batch->head = pos + 1;
+
+  return TRUE;
+}
+
+static gboolean
+g_invoke_batch_pop_overflow (GInvokeBatch *batch,
+                             GInvokeSlot  *item)
+{
+  GInvokeSlot *slot;
+
+  if (!g_atomic_int_get (&batch->overflowing))
+    return FALSE;
+
+  g_mutex_lock (&batch->overflow_lock);
+  slot = g_queue_pop_head (&batch->overflow);
+  if (g_queue_is_empty (&batch->overflow))
+    g_atomic_int_set (&batch->overflowing, FALSE);
+  g_mutex_unlock (&batch->overflow_lock);
+
+  if (slot == NULL)
+    return FALSE;
+
+  *item = *slot;
+  g_slice_free (GInvokeSlot, slot);
+
+  return TRUE;
+}
+
+static void
+g_invoke_batch_push (GInvokeBatch   *batch,
+                     GSourceFunc     function,
+                     gpointer        data,
+                     GDestroyNotify  notify)
+{
+  if (g_atomic_int_get (&batch->overflowing) ||
+      !g_invoke_batch_push_ring (batch, function, data, notify))
+    {
+      GInvokeSlot *slot;
+
+      slot = g_slice_new (GInvokeSlot);
+      slot->function = function;
+      slot->data = data;
+      slot->notify = notify;
+
+      g_mutex_lock (&batch->overflow_lock);
+      g_queue_push_tail (&batch->overflow, slot);
+      g_atomic_int_set (&batch->overflowing, TRUE);
+      g_mutex_unlock (&batch->overflow_lock);
+    }
+
+  /* Only the first call queued after a dispatch wakes up the context */
+  if (g_atomic_int_compare_and_exchange (&batch->pending, FALSE, TRUE))
+    g_source_set_ready_time ((GSource *) batch, 0);
+}
+
+static gboolean
+g_invoke_batch_dispatch (GSource     *source,
+                         GSourceFunc  callback,
+                         gpointer     user_data)
+{
+  GInvokeBatch *batch = (GInvokeBatch *) source;
+  GInvokeSlot item;
+  gint i;
+
+  /* This must happen before looking at the queue, so that anything
+   * queued from here on requests another dispatch.
+   */
+  g_source_set_ready_time (source, -1);
+  g_atomic_int_set (&batch->pending, FALSE);
+
+  for (i = 0; i < INVOKE_BATCH_MAX_DISPATCH; i++)
+    {
+      if (!g_invoke_batch_pop_ring (batch, &item) &&
+          !g_invoke_batch_pop_overflow (batch, &item))
+        return G_SOURCE_CONTINUE;
+
+      if (item.function (item.data))
+        g_invoke_batch_push (batch, item.function, item.data, item.notify);
+      else if (item.notify)
+        item.notify (item.data);
+    }
+
+  /* Leave the rest for the next iteration, so other sources get a turn */
+  if (g_atomic_int_compare_and_exchange (&batch->pending, FALSE, TRUE))
+    g_source_set_ready_time (source, 0);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+g_invoke_batch_finalize (GSource *source)
+{
+  GInvokeBatch *batch = (GInvokeBatch *) source;
+  GInvokeSlot item;
+
+  while (g_invoke_batch_pop_ring (batch, &item) ||
+         g_invoke_batch_pop_overflow (batch, &item))
+    if (item.notify)
+      item.notify (item.data);
+
+  g_mutex_clear (&batch->overflow_lock);
+}
+
+static GSourceFuncs g_invoke_batch_funcs = {
+  NULL,
+  NULL,
+  g_invoke_batch_dispatch,
+  g_invoke_batch_finalize
+};
+
+static GInvokeBatch *
+g_main_context_get_invoke_batch (GMainContext *context)
+{
+  GInvokeBatch *batch;
+
+  batch = g_atomic_pointer_get (&context->invoke_batch);
+  if (G_LIKELY (batch))
+    return batch;
+
+  LOCK_CONTEXT (context);
+
+  batch = context->invoke_batch;
+  if (batch == NULL)
+    {
+      GSource *source;
+      gint i;
+
+      source = g_source_new (&g_invoke_batch_funcs, sizeof (GInvokeBatch));
+      g_source_set_name (source, "GMainContext invoke batch");
+      batch = (GInvokeBatch *) source;
+
+      for (i = 0; i < INVOKE_BATCH_SIZE; i++)
+        batch->slots[i].sequence = i;
+      g_mutex_init (&batch->overflow_lock);
+      g_queue_init (&batch->overflow);
+
+      g_source_attach_unlocked (source, context, TRUE);
+      g_source_unref_internal (source, context, TRUE);
+
+      g_atomic_pointer_set (&context->invoke_batch, batch);
+    }
+
+  UNLOCK_CONTEXT (context);
+
+  return batch;
+}
+
+/**
+ * g_main_context_invoke_batched:
+ * @context: (nullable): a #GMainContext, or %NULL
+ * @function: function to call
+ * @data: data to pass to @function
+ * @notify: (nullable): a function to call when @data is no longer in use, or %NULL.
+ *
+ * Queues a call to @function in @context, much like
+ * g_main_context_invoke_full() does when it cannot invoke @function
+ * directly, but without creating a #GSource for each call.
+ *
+ * All calls queued this way are made by a single source attached to
+ * @context at %G_PRIORITY_DEFAULT, in the order in which they were
+ * queued by each thread.  A bounded number of calls is made on each
+ * iteration of @context, so that a steady stream of them does not
+ * starve other sources.  Queueing a call usually takes a single atomic
+ * operation and no memory allocation, which makes this suitable for
+ * posting large numbers of short callbacks to another thread.
+ *
+ * Unlike g_main_context_invoke(), @function is never called from
+ * within this function, even if @context is owned by the calling
+ * thread.  If @function returns %TRUE, it is queued again.
+ *
+ * @notify should not assume that it is called from any particular
+ * thread or with any particular context acquired.
+ *
+ * Since: 2.54
+ **/
+void
+g_main_context_invoke_batched (GMainContext   *context,
+                               GSourceFunc     function,
+                               gpointer        data,
+                               GDestroyNotify  notify)
+{
+  g_return_if_fail (function != NULL);
+
+  if (!context)
+    context = g_main_context_default ();
+
+  g_invoke_batch_push (g_main_context_get_invoke_batch (context),
+                       function, data, notify);
+}
+
 static gpointer
 glib_worker_main (gpointer data)
 {
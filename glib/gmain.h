@@ -22,6 +22,7 @@
 #error "Only <glib.h> can be included directly."
 #endif
 
+#include <glib/garray.h>
 #include <glib/gpoll.h>
 #include <glib/gslist.h>
 #include <glib/gthread.h>
@@ -129,6 +130,25 @@ typedef struct _GSourceCallbackFuncs    GSourceCallbackFuncs;
  */
 typedef struct _GSourceFuncs            GSourceFuncs;
 
+/**
+ * GSourceStats:
+ * @name: the name of the sources, as set with g_source_set_name(), or
+ *     %NULL for sources without a name
+ * @dispatch_count: the number of times the sources were dispatched
+ * @total_dispatch_time: the total time spent in dispatch, in microseconds
+ * @max_dispatch_time: the longest single dispatch, in microseconds
+ * @total_latency: the total time, in microseconds, between the sources
+ *     becoming ready and being dispatched
+ * @max_latency: the longest time between a source becoming ready and
+ *     being dispatched, in microseconds
+ *
+ * Dispatch statistics for the sources of a #GMainContext sharing a
+ * name, as returned by g_main_context_get_source_stats().
+ *
+ * Since: 2.54
+ */
+typedef struct _GSourceStats            GSourceStats;
+
 /**
  * GPid:
  *
@@ -238,6 +258,16 @@ struct _GSourceFuncs
   GSourceDummyMarshal closure_marshal; /* Really is of type GClosureMarshal */
 };
 
+struct _GSourceStats
+{
+  gchar   *name;
+  guint64  dispatch_count;
+  gint64   total_dispatch_time;
+  gint64   max_dispatch_time;
+  gint64   total_latency;
+  gint64   max_latency;
+};
+
 /* Standard priorities */
 
 /**
@@ -379,6 +409,22 @@ void     g_main_context_set_poll_func (GMainContext *context,
 GLIB_AVAILABLE_IN_ALL
 GPollFunc g_main_context_get_poll_func (GMainContext *context);
 
+GLIB_AVAILABLE_IN_2_54
+void     g_main_context_set_timer_slack (GMainContext *context,
+                                         guint         slack);
+GLIB_AVAILABLE_IN_2_54
+guint    g_main_context_get_timer_slack (GMainContext *context);
+
+GLIB_AVAILABLE_IN_2_54
+void       g_main_context_set_source_stats_enabled (GMainContext *context,
+                                                    gboolean      enabled);
+GLIB_AVAILABLE_IN_2_54
+GPtrArray *g_main_context_get_source_stats         (GMainContext *context);
+GLIB_AVAILABLE_IN_2_54
+GSourceStats *g_source_stats_copy                  (const GSourceStats *stats);
+GLIB_AVAILABLE_IN_2_54
+void       g_source_stats_free                     (GSourceStats *stats);
+
 /* Low level functions for use by source implementations
  */
 GLIB_AVAILABLE_IN_ALL
@@ -612,6 +658,11 @@ GLIB_AVAILABLE_IN_ALL
 void     g_main_context_invoke      (GMainContext   *context,
                                      GSourceFunc     function,
                                      gpointer        data);
+GLIB_AVAILABLE_IN_2_54
+void     g_main_context_invoke_batched (GMainContext   *context,
+                                        GSourceFunc     function,
+                                        gpointer        data,
+                                        GDestroyNotify  notify);
 
 /* Hook for GClosure / GSource integration. Don't touch */
 GLIB_VAR GSourceFuncs g_timeout_funcs;
@@ -426,3 +426,74 @@ g_mapped_file_get_bytes (GMappedFile *file)
 				     (GDestroyNotify) g_mapped_file_unref,
 				     g_mapped_file_ref (file));
 }
+
+/**
+ * g_mapped_file_advise:
+ * @file: a #GMappedFile
+ * @advice: how the range will be accessed
+ * @offset: the start of the range, in bytes from the start of @file
+ * @length: the length of the range, or 0 for the rest of @file
+ *
+ * Tells the kernel how a range of @file is going to be accessed, so
+ * that it can tune read-ahead and page caching of the mapping.
+ *
+ * The range is widened to page boundaries and clamped to the length
+ * of @file.  This is only a hint: it never changes the contents of
+ * the mapping, and it does nothing on platforms without
+ * posix_madvise() or for files that were not mapped.
+ *
+ * Since: 2.54
+ */
+void
+g_mapped_file_advise (GMappedFile       *file,
+                      GMappedFileAdvice  advice,
+                      gsize              offset,
+                      gsize              length)
+{
+#if defined (HAVE_MMAP) && defined (POSIX_MADV_NORMAL)
+  gsize page_size;
+  gsize start, end;
+  int posix_advice;
+#endif
+
+  g_return_if_fail (file != NULL);
+  g_return_if_fail (advice <= G_MAPPED_FILE_ADVICE_DONT_NEED);
+
+#if defined (HAVE_MMAP) && defined (POSIX_MADV_NORMAL)
+  /* empty files have no mapping */
+  if (file->contents == NULL || offset >= file->length)
+    return;
+
+  if (length == 0 || length > file->length - offset)
+    length = file->length - offset;
+
+  switch (advice)
+    {
+    case G_MAPPED_FILE_ADVICE_RANDOM:
+      posix_advice = POSIX_MADV_RANDOM;
+      break;
+    case G_MAPPED_FILE_ADVICE_SEQUENTIAL:
+      posix_advice = POSIX_MADV_SEQUENTIAL;
+      break;
+    case G_MAPPED_FILE_ADVICE_WILL_NEED:
+      posix_advice = POSIX_MADV_WILLNEED;
+      break;
+    case G_MAPPED_FILE_ADVICE_DONT_NEED:
+      posix_advice = POSIX_MADV_DONTNEED;
+      break;
+    default:
+      posix_advice = POSIX_MADV_NORMAL;
+      break;
+    }
+
+  /* the mapping itself is page aligned, so offsets into it can be
+   * rounded against the page size directly
+   */
+  page_size = sysconf (_SC_PAGESIZE);
+  start = offset - offset % page_size;
+  end = offset + length;
+
+  /* failure is harmless: the hint is just not applied */
+  posix_madvise (file->contents + start, end - start, posix_advice);
+#endif
+}
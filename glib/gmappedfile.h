@@ -31,6 +31,32 @@ G_BEGIN_DECLS
 
 typedef struct _GMappedFile GMappedFile;
 
+/**
+ * GMappedFileAdvice:
+ * @G_MAPPED_FILE_ADVICE_NORMAL: no particular access pattern; the default
+ * @G_MAPPED_FILE_ADVICE_RANDOM: the range will be accessed in random
+ *     order, so reading ahead is not useful
+ * @G_MAPPED_FILE_ADVICE_SEQUENTIAL: the range will be accessed in
+ *     sequential order, so it is worth reading ahead aggressively
+ * @G_MAPPED_FILE_ADVICE_WILL_NEED: the range will be accessed soon, so
+ *     it is worth starting to read it in now
+ * @G_MAPPED_FILE_ADVICE_DONT_NEED: the range will not be accessed again
+ *     soon, so the pages backing it may be dropped
+ *
+ * Hints about how a range of a #GMappedFile will be accessed, for use
+ * with g_mapped_file_advise().
+ *
+ * Since: 2.54
+ */
+typedef enum
+{
+  G_MAPPED_FILE_ADVICE_NORMAL,
+  G_MAPPED_FILE_ADVICE_RANDOM,
+  G_MAPPED_FILE_ADVICE_SEQUENTIAL,
+  G_MAPPED_FILE_ADVICE_WILL_NEED,
+  G_MAPPED_FILE_ADVICE_DONT_NEED
+} GMappedFileAdvice;
+
 GLIB_AVAILABLE_IN_ALL
 GMappedFile *g_mapped_file_new          (const gchar  *filename,
 				         gboolean      writable,
@@ -45,6 +71,11 @@ GLIB_AVAILABLE_IN_ALL
 gchar       *g_mapped_file_get_contents (GMappedFile  *file);
 GLIB_AVAILABLE_IN_2_34
 GBytes *     g_mapped_file_get_bytes    (GMappedFile  *file);
+GLIB_AVAILABLE_IN_2_54
+void         g_mapped_file_advise       (GMappedFile       *file,
+                                         GMappedFileAdvice  advice,
+                                         gsize              offset,
+                                         gsize              length);
 GLIB_AVAILABLE_IN_ALL
 GMappedFile *g_mapped_file_ref          (GMappedFile  *file);
 GLIB_AVAILABLE_IN_ALL
@@ -798,6 +798,35 @@ advance_char (GMarkupParseContext *context)
   return TRUE;
 }
 
+/* Moves to the first @c from the current position on, or to the end
+ * of the chunk, counting lines and characters as advance_char() does.
+ */
+static void
+advance_to_char (GMarkupParseContext *context,
+                 gchar                c)
+{
+  const gchar *start = context->iter;
+  const gchar *end;
+  const gchar *nl;
+
+  end = memchr (start, c, context->current_text_end - start);
+  if (end == NULL)
+    end = context->current_text_end;
+
+  context->char_number += end - start;
+  for (nl = start + 1; nl < end; nl++)
+    {
+      nl = memchr (nl, '\n', end - nl);
+      if (nl == NULL)
+        break;
+
+      context->line_number++;
+      context->char_number = 1 + (end - nl);
+    }
+
+  context->iter = end;
+}
+
 static inline gboolean
 xml_isspace (char c)
 {
@@ -1089,6 +1118,56 @@ emit_end_element (GMarkupParseContext  *context,
   pop_tag (context);
 }
 
+/* Hands text that starts and ends within the current chunk to the
+ * text callback without copying it, if there is nothing to unescape
+ * or normalize in it.  Returns %FALSE to leave it to the usual path,
+ * which also reports any encoding error.
+ */
+static gboolean
+emit_borrowed_text (GMarkupParseContext  *context,
+                    GError              **error)
+{
+  const gchar *p;
+  gchar mask = 0;
+
+  for (p = context->start; p != context->iter; p++)
+    {
+      if (*p == '&' || *p == '\r')
+        return FALSE;
+      mask |= *p;
+    }
+
+  /* the error message wants the text nul-terminated */
+  if ((mask & 0x80) &&
+      !g_utf8_validate (context->start, context->iter - context->start, NULL))
+    return FALSE;
+
+  if (context->parser->text)
+    {
+      GError *tmp_error = NULL;
+
+      (*context->parser->text) (context,
+                                context->start,
+                                context->iter - context->start,
+                                context->user_data,
+                                &tmp_error);
+
+      if (tmp_error != NULL)
+        {
+          propagate_error (context, error, tmp_error);
+          return TRUE;
+        }
+    }
+
+  /* advance past open angle and set state. */
+  advance_char (context);
+  context->state = STATE_AFTER_OPEN_ANGLE;
+  /* could begin a passthrough */
+  context->start = context->iter;
+
+  return TRUE;
+}
+
 /**
  * g_markup_parse_context_parse:
  * @context: a #GMarkupParseContext
@@ -1440,12 +1519,7 @@ g_markup_parse_context_parse (GMarkupParseContext  *context,
                 delim = '"';
               }
 
-            do
-              {
-                if (*context->iter == delim)
-                  break;
-              }
-            while (advance_char (context));
+            advance_to_char (context, delim);
           }
           if (context->iter == context->current_text_end)
             {
@@ -1483,12 +1557,14 @@ g_markup_parse_context_parse (GMarkupParseContext  *context,
 
         case STATE_INSIDE_TEXT:
           /* Possible next states: AFTER_OPEN_ANGLE */
-          do
-            {
-              if (*context->iter == '<')
-                break;
-            }
-          while (advance_char (context));
+          advance_to_char (context, '<');
+
+          /* nobody can tell the difference without a text callback */
+          if ((context->flags & G_MARKUP_BORROW_TEXT || context->parser->text == NULL) &&
+              context->iter != context->current_text_end &&
+              (context->partial_chunk == NULL || context->partial_chunk->len == 0) &&
+              emit_borrowed_text (context, error))
+            break;
 
           /* The text hasn't necessarily ended. Merge with
            * partial chunk, leave state unchanged.
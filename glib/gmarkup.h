@@ -89,6 +89,11 @@ GQuark g_markup_error_quark (void);
  *     attributes and tags, along with their contents.  A qualified
  *     attribute or tag is one that contains ':' in its name (ie: is in
  *     another namespace).  Since: 2.40.
+ * @G_MARKUP_BORROW_TEXT: Text that needs no unescaping and doesn't
+ *     span several calls to g_markup_parse_context_parse() is passed to
+ *     the @text function as a pointer into the buffer being parsed,
+ *     rather than copied first. The text is then not nul-terminated,
+ *     and only valid for the duration of the callback. Since: 2.54.
  *
  * Flags that affect the behaviour of the parser.
  */
@@ -97,7 +102,8 @@ typedef enum
   G_MARKUP_DO_NOT_USE_THIS_UNSUPPORTED_FLAG = 1 << 0,
   G_MARKUP_TREAT_CDATA_AS_TEXT              = 1 << 1,
   G_MARKUP_PREFIX_ERROR_POSITION            = 1 << 2,
-  G_MARKUP_IGNORE_QUALIFIED                 = 1 << 3
+  G_MARKUP_IGNORE_QUALIFIED                 = 1 << 3,
+  G_MARKUP_BORROW_TEXT                      = 1 << 4
 } GMarkupParseFlags;
 
 /**
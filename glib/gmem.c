@@ -33,8 +33,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <signal.h>
+#ifdef G_OS_WIN32
+#include <malloc.h>             /* _aligned_malloc() */
+#elif !defined (HAVE_POSIX_MEMALIGN) && defined (HAVE_MEMALIGN)
+#include <malloc.h>             /* memalign() */
+#endif
 
 #include "gslice.h"
+#include "gmemprivate.h"
 #include "gbacktrace.h"
 #include "gtestutils.h"
 #include "gthread.h"
@@ -91,6 +97,9 @@ g_malloc (gsize n_bytes)
     {
       gpointer mem;
 
+      if (G_UNLIKELY (g_mem_stats_active))
+        g_mem_stats_malloc (n_bytes);
+
       mem = malloc (n_bytes);
       TRACE (GLIB_MEM_ALLOC((void*) mem, (unsigned int) n_bytes, 0, 0));
       if (mem)
@@ -121,6 +130,9 @@ g_malloc0 (gsize n_bytes)
     {
       gpointer mem;
 
+      if (G_UNLIKELY (g_mem_stats_active))
+        g_mem_stats_malloc (n_bytes);
+
       mem = calloc (1, n_bytes);
       TRACE (GLIB_MEM_ALLOC((void*) mem, (unsigned int) n_bytes, 1, 0));
       if (mem)
@@ -156,6 +168,9 @@ g_realloc (gpointer mem,
 
   if (G_LIKELY (n_bytes))
     {
+      if (G_UNLIKELY (g_mem_stats_active))
+        g_mem_stats_malloc (n_bytes);
+
       newmem = realloc (mem, n_bytes);
       TRACE (GLIB_MEM_REALLOC((void*) newmem, (void*)mem, (unsigned int) n_bytes, 0));
       if (newmem)
@@ -446,6 +461,148 @@ g_try_realloc_n (gpointer mem,
   return g_try_realloc (mem, n_blocks * n_block_bytes);
 }
 
+#if !defined (G_OS_WIN32) && !defined (HAVE_POSIX_MEMALIGN) && !defined (HAVE_MEMALIGN)
+#define ALIGNED_ALLOC_BY_HAND 1
+#endif
+
+/**
+ * g_aligned_alloc:
+ * @n_blocks: the number of blocks to allocate
+ * @n_block_bytes: the size of each block in bytes
+ * @alignment: the alignment to be enforced, which must be a power of 2
+ *
+ * This function is similar to g_malloc_n(), allocating
+ * (@n_blocks * @n_block_bytes) bytes, but the start of the allocated
+ * memory is aligned to a multiple of @alignment bytes, for instance to
+ * the width of the vector registers that will process it.  Alignments
+ * smaller than that of a pointer are rounded up to it.
+ *
+ * If the multiplication overflows, or @alignment is not a power of 2,
+ * the program is terminated.  If the allocated size is 0, %NULL is
+ * returned.
+ *
+ * The memory must be freed with g_aligned_free(), never with g_free().
+ *
+ * Returns: (transfer full): the allocated memory
+ *
+ * Since: 2.54
+ */
+gpointer
+g_aligned_alloc (gsize n_blocks,
+                 gsize n_block_bytes,
+                 gsize alignment)
+{
+  gpointer mem;
+  gsize n_bytes;
+
+  if (G_UNLIKELY (alignment == 0 || (alignment & (alignment - 1)) != 0))
+    g_error ("%s: alignment %"G_GSIZE_FORMAT" is not a power of two",
+             G_STRLOC, alignment);
+
+  if (SIZE_OVERFLOWS (n_blocks, n_block_bytes))
+    {
+      g_error ("%s: overflow allocating %"G_GSIZE_FORMAT"*%"G_GSIZE_FORMAT" bytes",
+               G_STRLOC, n_blocks, n_block_bytes);
+    }
+
+  n_bytes = n_blocks * n_block_bytes;
+  if (G_UNLIKELY (n_bytes == 0))
+    return NULL;
+
+  alignment = MAX (alignment, sizeof (gpointer));
+
+  if (G_UNLIKELY (g_mem_stats_active))
+    g_mem_stats_malloc (n_bytes);
+
+#if defined (G_OS_WIN32)
+  mem = _aligned_malloc (n_bytes, alignment);
+#elif defined (HAVE_POSIX_MEMALIGN)
+  if (posix_memalign (&mem, alignment, n_bytes) != 0)
+    mem = NULL;
+#elif defined (HAVE_MEMALIGN)
+  mem = memalign (alignment, n_bytes);
+#else
+  /* Over-allocate and keep the pointer to free in front of the block */
+  if (n_bytes > G_MAXSIZE - alignment - sizeof (gpointer))
+    mem = NULL;
+  else
+    {
+      gpointer real = malloc (n_bytes + alignment + sizeof (gpointer));
+
+      if (real)
+        {
+          gsize start = GPOINTER_TO_SIZE (real) + sizeof (gpointer);
+
+          mem = GSIZE_TO_POINTER ((start + alignment - 1) & ~(alignment - 1));
+          ((gpointer *) mem)[-1] = real;
+        }
+      else
+        mem = NULL;
+    }
+#endif
+
+  TRACE (GLIB_MEM_ALLOC((void*) mem, (unsigned int) n_bytes, 0, 0));
+  if (mem)
+    return mem;
+
+  g_error ("%s: failed to allocate %"G_GSIZE_FORMAT" bytes aligned to %"G_GSIZE_FORMAT,
+           G_STRLOC, n_bytes, alignment);
+
+  return NULL;
+}
+
+/**
+ * g_aligned_alloc0:
+ * @n_blocks: the number of blocks to allocate
+ * @n_block_bytes: the size of each block in bytes
+ * @alignment: the alignment to be enforced, which must be a power of 2
+ *
+ * This function is similar to g_aligned_alloc(), but the allocated
+ * memory is initialized to 0's.
+ *
+ * Returns: (transfer full): the allocated memory
+ *
+ * Since: 2.54
+ */
+gpointer
+g_aligned_alloc0 (gsize n_blocks,
+                  gsize n_block_bytes,
+                  gsize alignment)
+{
+  gpointer mem;
+
+  mem = g_aligned_alloc (n_blocks, n_block_bytes, alignment);
+  if (mem)
+    memset (mem, 0, n_blocks * n_block_bytes);
+
+  return mem;
+}
+
+/**
+ * g_aligned_free:
+ * @mem: (nullable): the memory to deallocate
+ *
+ * Frees the memory pointed to by @mem, which must have been allocated
+ * with g_aligned_alloc() or g_aligned_alloc0(), or be %NULL.
+ *
+ * Since: 2.54
+ */
+void
+g_aligned_free (gpointer mem)
+{
+  if (G_LIKELY (mem))
+    {
+#if defined (G_OS_WIN32)
+      _aligned_free (mem);
+#elif defined (ALIGNED_ALLOC_BY_HAND)
+      free (((gpointer *) mem)[-1]);
+#else
+      free (mem);
+#endif
+    }
+  TRACE(GLIB_MEM_FREE((void*) mem));
+}
+
 /**
  * g_mem_is_system_malloc:
  * 
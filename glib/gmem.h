@@ -110,6 +110,17 @@ gpointer g_try_realloc_n  (gpointer	 mem,
 			   gsize	 n_blocks,
 			   gsize	 n_block_bytes) G_GNUC_WARN_UNUSED_RESULT;
 
+GLIB_AVAILABLE_IN_2_54
+gpointer g_aligned_alloc  (gsize	 n_blocks,
+			   gsize	 n_block_bytes,
+			   gsize	 alignment) G_GNUC_WARN_UNUSED_RESULT G_GNUC_ALLOC_SIZE2(1,2);
+GLIB_AVAILABLE_IN_2_54
+gpointer g_aligned_alloc0 (gsize	 n_blocks,
+			   gsize	 n_block_bytes,
+			   gsize	 alignment) G_GNUC_WARN_UNUSED_RESULT G_GNUC_ALLOC_SIZE2(1,2);
+GLIB_AVAILABLE_IN_2_54
+void	 g_aligned_free	  (gpointer	 mem);
+
 #define g_clear_pointer(pp, destroy) \
   G_STMT_START {                                                               \
     G_STATIC_ASSERT (sizeof *(pp) == sizeof (gpointer));                       \
@@ -366,6 +377,17 @@ GLIB_VAR GMemVTable	*glib_mem_profiler_table;
 GLIB_DEPRECATED_IN_2_46
 void	g_mem_profile	(void);
 
+/* Allocation statistics for g_malloc() and g_slice_alloc()
+ */
+GLIB_AVAILABLE_IN_2_54
+void	g_mem_stats_set_enabled		(gboolean	 enabled);
+GLIB_AVAILABLE_IN_2_54
+void	g_mem_stats_set_sample_interval	(gsize		 interval);
+GLIB_AVAILABLE_IN_2_54
+void	g_mem_stats_reset		(void);
+GLIB_AVAILABLE_IN_2_54
+gchar  *g_mem_stats_dump		(void);
+
 G_END_DECLS
 
 #endif /* __G_MEM_H__ */
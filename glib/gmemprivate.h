@@ -0,0 +1,41 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_MEM_PRIVATE_H__
+#define __G_MEM_PRIVATE_H__
+
+#include "gtypes.h"
+
+G_BEGIN_DECLS
+
+/* Allocation statistics, see gmemstats.c.  The hooks must only be
+ * called when g_mem_stats_active is set, and directly from the
+ * allocation function the caller called, so that the backtraces they
+ * take start at the right frame.
+ */
+extern gboolean g_mem_stats_active;
+
+void    g_mem_stats_malloc      (gsize    n_bytes);
+void    g_mem_stats_slice_alloc (gsize    chunk_size,
+                                 gboolean sample);
+void    g_mem_stats_slice_free  (gsize    chunk_size,
+                                 guint    n_blocks);
+
+G_END_DECLS
+
+#endif /* __G_MEM_PRIVATE_H__ */
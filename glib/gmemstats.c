@@ -0,0 +1,460 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * gmemstats.c: allocation statistics
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gmem.h"
+#include "gmemprivate.h"
+#include "glib-init.h"
+
+#include "gatomic.h"
+#include "gmessages.h"
+#include "gqsort.h"
+#include "gstrfuncs.h"
+#include "gstring.h"
+#include "gthread.h"
+#include "gutils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_EXECINFO_H
+#include <execinfo.h>
+#endif
+
+/* The hooks run inside g_malloc() and g_slice_alloc(), so nothing in
+ * here may allocate through GLib: the table of call sites is allocated
+ * once with calloc() and protected by a plain spin lock, which is only
+ * taken for sampled allocations.  Counters are updated atomically;
+ * they are pointer-sized since that is what the atomic operations
+ * support.
+ */
+
+#define N_SLICE_CLASSES         64      /* chunk sizes up to 64 * 2 * sizeof (gsize) */
+#define N_SITES                 1024
+#define N_FRAMES                8
+#define N_SKIPPED_FRAMES        2       /* the hook and the allocation function */
+#define DEFAULT_SAMPLE_INTERVAL (512 * 1024)
+
+typedef struct
+{
+  volatile gsize allocs;
+  volatile gsize frees;
+} SliceClass;
+
+typedef enum
+{
+  SITE_MALLOC,
+  SITE_SLICE
+} SiteKind;
+
+typedef struct
+{
+  guint hash;
+  SiteKind kind;
+  gsize samples;
+  gsize n_sampled;              /* allocations that got samples */
+  gsize sampled_bytes;
+  gpointer frames[N_FRAMES];
+  gint n_frames;
+} Site;
+
+gboolean g_mem_stats_active;
+
+static volatile gsize malloc_calls;
+static volatile gsize malloc_bytes;
+static SliceClass slice_classes[N_SLICE_CLASSES + 1];   /* last one: larger blocks */
+
+static volatile gsize sample_interval = DEFAULT_SAMPLE_INTERVAL;
+static volatile gsize sample_accu;
+
+static Site *sites;
+static volatile gint sites_lock;
+static gsize n_dropped_samples;
+
+static void
+sites_lock_acquire (void)
+{
+  while (!g_atomic_int_compare_and_exchange (&sites_lock, 0, 1))
+    g_thread_yield ();
+}
+
+static void
+sites_lock_release (void)
+{
+  g_atomic_int_set (&sites_lock, 0);
+}
+
+static inline guint
+slice_class_index (gsize chunk_size)
+{
+  gsize ix = (chunk_size - 1) / (2 * sizeof (gsize));
+
+  return MIN (ix, N_SLICE_CLASSES);
+}
+
+/* Returns how many samples an allocation of @n_bytes accounts for:
+ * every sample_interval bytes allocated, one of the allocations which
+ * crosses the boundary gets sampled, so the chances of being sampled
+ * are proportional to the size.
+ */
+static inline gsize
+take_samples (gsize n_bytes)
+{
+  gsize interval = sample_interval;
+  gsize before;
+
+  before = (gsize) g_atomic_pointer_add (&sample_accu, n_bytes);
+
+  return (before + n_bytes) / interval - before / interval;
+}
+
+static void
+record_samples (SiteKind  kind,
+                gsize     n_samples,
+                gsize     n_bytes,
+                gpointer *frames,
+                gint      n_frames)
+{
+  guint hash = kind;
+  guint i, start;
+  gint j;
+
+  for (j = 0; j < n_frames; j++)
+    hash = (hash * 31) + (guint) GPOINTER_TO_SIZE (frames[j]);
+
+  sites_lock_acquire ();
+
+  if (sites == NULL)
+    goto out;
+
+  start = hash % N_SITES;
+  for (i = 0; i < N_SITES; i++)
+    {
+      Site *site = &sites[(start + i) % N_SITES];
+
+      if (site->samples == 0)
+        {
+          site->hash = hash;
+          site->kind = kind;
+          memcpy (site->frames, frames, n_frames * sizeof (gpointer));
+          site->n_frames = n_frames;
+        }
+      else if (site->hash != hash || site->kind != kind || site->n_frames != n_frames ||
+               memcmp (site->frames, frames, n_frames * sizeof (gpointer)) != 0)
+        continue;
+
+      site->samples += n_samples;
+      site->n_sampled++;
+      site->sampled_bytes += n_bytes;
+      goto out;
+    }
+
+  n_dropped_samples += n_samples;
+
+ out:
+  sites_lock_release ();
+}
+
+/* Keep the capture in the hooks themselves, so that the number of
+ * frames to skip does not depend on inlining.
+ */
+#ifdef HAVE_EXECINFO_H
+#define CAPTURE_AND_RECORD(kind, n_samples, n_bytes)                    \
+  G_STMT_START {                                                        \
+    gpointer frames_[N_FRAMES + N_SKIPPED_FRAMES];                      \
+    gint n_frames_;                                                     \
+                                                                        \
+    n_frames_ = backtrace (frames_, G_N_ELEMENTS (frames_));            \
+    n_frames_ = MAX (n_frames_ - N_SKIPPED_FRAMES, 0);                  \
+    record_samples ((kind), (n_samples), (n_bytes),                     \
+                    frames_ + N_SKIPPED_FRAMES, n_frames_);             \
+  } G_STMT_END
+#else
+#define CAPTURE_AND_RECORD(kind, n_samples, n_bytes)                    \
+  record_samples ((kind), (n_samples), (n_bytes), NULL, 0)
+#endif
+
+void
+g_mem_stats_malloc (gsize n_bytes)
+{
+  gsize n_samples;
+
+  g_atomic_pointer_add (&malloc_calls, 1);
+  g_atomic_pointer_add (&malloc_bytes, n_bytes);
+
+  n_samples = take_samples (n_bytes);
+  if (G_UNLIKELY (n_samples))
+    CAPTURE_AND_RECORD (SITE_MALLOC, n_samples, n_bytes);
+}
+
+void
+g_mem_stats_slice_alloc (gsize    chunk_size,
+                         gboolean sample)
+{
+  g_atomic_pointer_add (&slice_classes[slice_class_index (chunk_size)].allocs, 1);
+
+  /* Blocks that are passed on to g_malloc() are sampled there */
+  if (sample)
+    {
+      gsize n_samples = take_samples (chunk_size);
+
+      if (G_UNLIKELY (n_samples))
+        CAPTURE_AND_RECORD (SITE_SLICE, n_samples, chunk_size);
+    }
+}
+
+void
+g_mem_stats_slice_free (gsize chunk_size,
+                        guint n_blocks)
+{
+  g_atomic_pointer_add (&slice_classes[slice_class_index (chunk_size)].frees, n_blocks);
+}
+
+/**
+ * g_mem_stats_set_enabled:
+ * @enabled: whether to collect allocation statistics
+ *
+ * Turns the collection of allocation statistics on or off.  While it is
+ * on, GLib counts the calls to g_malloc() and friends and the number of
+ * bytes they allocate, and the allocations and releases of each block
+ * size of g_slice_alloc(), and samples the places allocations come
+ * from.  Use g_mem_stats_dump() to see the result.
+ *
+ * Sampling takes a backtrace for one allocation out of every
+ * 512 kilobytes allocated (see g_mem_stats_set_sample_interval()), so
+ * allocation sites show up according to the amount of memory they
+ * allocate.  The counters are updated for every allocation, which makes
+ * allocations a little slower while this is on; when it is off, they
+ * cost a single test.
+ *
+ * Only allocations made while this is on are counted, so the number of
+ * blocks in use for each size is only meaningful if it is turned on
+ * before the program allocates them.  The `G_SLICE` environment
+ * variable can contain `stats` to turn this on at startup; a report is
+ * then also printed to stderr when the program exits.
+ *
+ * Since: 2.54
+ */
+void
+g_mem_stats_set_enabled (gboolean enabled)
+{
+  if (enabled)
+    {
+      sites_lock_acquire ();
+      if (sites == NULL)
+        sites = calloc (N_SITES, sizeof (Site));
+      sites_lock_release ();
+    }
+
+  g_mem_stats_active = enabled != FALSE;
+}
+
+/**
+ * g_mem_stats_set_sample_interval:
+ * @interval: the average number of bytes allocated between two samples
+ *
+ * Sets how often allocations are sampled for their call site, see
+ * g_mem_stats_set_enabled().  A smaller interval gives a more precise
+ * picture at a higher cost; with an interval of 1, every allocation is
+ * sampled.
+ *
+ * Since: 2.54
+ */
+void
+g_mem_stats_set_sample_interval (gsize interval)
+{
+  g_return_if_fail (interval > 0);
+
+  sample_interval = interval;
+}
+
+/**
+ * g_mem_stats_reset:
+ *
+ * Sets all allocation counters back to 0 and forgets all samples.
+ *
+ * Since: 2.54
+ */
+void
+g_mem_stats_reset (void)
+{
+  guint i;
+
+  malloc_calls = 0;
+  malloc_bytes = 0;
+  for (i = 0; i < G_N_ELEMENTS (slice_classes); i++)
+    slice_classes[i].allocs = slice_classes[i].frees = 0;
+
+  sites_lock_acquire ();
+  if (sites)
+    memset (sites, 0, N_SITES * sizeof (Site));
+  n_dropped_samples = 0;
+  sample_accu = 0;
+  sites_lock_release ();
+}
+
+static gint
+compare_sites (gconstpointer a,
+               gconstpointer b,
+               gpointer      user_data)
+{
+  const Site *site_a = a, *site_b = b;
+
+  return site_a->samples > site_b->samples ? -1 : site_a->samples < site_b->samples;
+}
+
+/**
+ * g_mem_stats_dump:
+ *
+ * Produces a report of the statistics collected since they were turned
+ * on with g_mem_stats_set_enabled() or last reset: the counts for
+ * g_malloc() and for every size of g_slice_alloc() that was used, and
+ * the sampled call sites, the ones allocating the most memory first.
+ *
+ * The memory attributed to a call site is estimated from the number of
+ * samples it got, and is the more precise the more samples there are.
+ * Call sites are given as backtraces, symbolized as well as the system
+ * allows.
+ *
+ * The format is meant for humans and may change.
+ *
+ * Returns: (transfer full): the report, free it with g_free()
+ *
+ * Since: 2.54
+ */
+gchar *
+g_mem_stats_dump (void)
+{
+  Site *snapshot;
+  GString *string;
+  gsize interval = sample_interval;
+  gsize dropped;
+  guint n_snapshot = 0;
+  guint i;
+  gint j;
+
+  /* Copy first, since formatting allocates */
+  snapshot = calloc (N_SITES, sizeof (Site));
+  if (snapshot == NULL)
+    return g_strdup ("");
+
+  sites_lock_acquire ();
+  if (sites)
+    for (i = 0; i < N_SITES; i++)
+      if (sites[i].samples)
+        snapshot[n_snapshot++] = sites[i];
+  dropped = n_dropped_samples;
+  sites_lock_release ();
+
+  g_qsort_with_data (snapshot, n_snapshot, sizeof (Site), compare_sites, NULL);
+
+  string = g_string_new (NULL);
+
+  g_string_append_printf (string, "g_malloc: %" G_GSIZE_FORMAT " calls, %" G_GSIZE_FORMAT " bytes\n",
+                          malloc_calls, malloc_bytes);
+
+  g_string_append (string, "g_slice:\n");
+  for (i = 0; i < G_N_ELEMENTS (slice_classes); i++)
+    {
+      gsize allocs = slice_classes[i].allocs;
+      gsize frees = slice_classes[i].frees;
+
+      if (allocs == 0 && frees == 0)
+        continue;
+
+      if (i < N_SLICE_CLASSES)
+        g_string_append_printf (string, "  %5" G_GSIZE_FORMAT " bytes: ",
+                                (gsize) (i + 1) * 2 * sizeof (gsize));
+      else
+        g_string_append (string, "   larger: ");
+
+      g_string_append_printf (string, "%" G_GSIZE_FORMAT " allocated, %" G_GSIZE_FORMAT " freed, "
+                              "%" G_GSSIZE_FORMAT " in use\n",
+                              allocs, frees, (gssize) (allocs - frees));
+    }
+
+  g_string_append_printf (string, "%u call sites, one sample every %" G_GSIZE_FORMAT " bytes",
+                          n_snapshot, interval);
+  if (dropped)
+    g_string_append_printf (string, " (%" G_GSIZE_FORMAT " samples on further sites not recorded)", dropped);
+  g_string_append (string, "\n");
+
+  for (i = 0; i < n_snapshot; i++)
+    {
+      Site *site = &snapshot[i];
+      gchar **symbols = NULL;
+
+      g_string_append_printf (string, "%s: ~%" G_GSIZE_FORMAT " bytes, %" G_GSIZE_FORMAT " samples, "
+                              "%" G_GSIZE_FORMAT " bytes per sampled allocation\n",
+                              site->kind == SITE_SLICE ? "g_slice_alloc" : "g_malloc",
+                              site->samples * interval, site->samples,
+                              site->sampled_bytes / site->n_sampled);
+
+#ifdef HAVE_EXECINFO_H
+      if (site->n_frames)
+        symbols = backtrace_symbols (site->frames, site->n_frames);
+#endif
+
+      for (j = 0; j < site->n_frames; j++)
+        {
+          if (symbols)
+            g_string_append_printf (string, "    %s\n", symbols[j]);
+          else
+            g_string_append_printf (string, "    %p\n", site->frames[j]);
+        }
+
+      free (symbols);
+    }
+
+  free (snapshot);
+
+  return g_string_free (string, FALSE);
+}
+
+static void
+g_mem_stats_print_at_exit (void)
+{
+  gchar *report;
+
+  g_mem_stats_active = FALSE;
+  report = g_mem_stats_dump ();
+  fputs (report, stderr);
+  g_free (report);
+}
+
+void
+g_mem_stats_init (void)
+{
+  const GDebugKey keys[] = {
+    { "stats", 1 },
+  };
+  const gchar *val;
+
+  /* "help" is answered by GSlice, which knows all the keys */
+  val = getenv ("G_SLICE");
+  if (val == NULL || g_ascii_strcasecmp (val, "help") == 0 ||
+      !g_parse_debug_string (val, keys, G_N_ELEMENTS (keys)))
+    return;
+
+  g_mem_stats_set_enabled (TRUE);
+  atexit (g_mem_stats_print_at_exit);
+}
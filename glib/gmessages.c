@@ -451,6 +451,11 @@ myInvalidParameterHandler(const wchar_t *expression,
  * g_log_writer_default() unless the `G_MESSAGES_DEBUG` environment variable is
  * set appropriately.
  *
+ * When g_log_level_is_enabled() reports that such a message would be
+ * suppressed, it is not formatted and its parameters are not evaluated, so
+ * they should not have side effects. This applies to code built with
+ * `GLIB_VERSION_MIN_REQUIRED` set to 2.54 or later.
+ *
  * If structured logging is enabled, this will use g_log_structured();
  * otherwise it will use g_log(). See
  * [Using Structured Logging][using-structured-logging].
@@ -473,6 +478,11 @@ myInvalidParameterHandler(const wchar_t *expression,
  * g_log_writer_default() unless the `G_MESSAGES_DEBUG` environment variable is
  * set appropriately.
  *
+ * When g_log_level_is_enabled() reports that such a message would be
+ * suppressed, it is not formatted and its parameters are not evaluated, so
+ * they should not have side effects. This applies to code built with
+ * `GLIB_VERSION_MIN_REQUIRED` set to 2.54 or later.
+ *
  * If structured logging is enabled, this will use g_log_structured();
  * otherwise it will use g_log(). See
  * [Using Structured Logging][using-structured-logging].
@@ -480,6 +490,11 @@ myInvalidParameterHandler(const wchar_t *expression,
  * Since: 2.6
  */
 
+/* these are emitted by the default log handler */
+#define DEFAULT_LEVELS (G_LOG_LEVEL_ERROR | G_LOG_LEVEL_CRITICAL | G_LOG_LEVEL_WARNING | G_LOG_LEVEL_MESSAGE)
+/* these are filtered by G_MESSAGES_DEBUG by the default log handler */
+#define INFO_LEVELS (G_LOG_LEVEL_INFO | G_LOG_LEVEL_DEBUG)
+
 /* --- structures --- */
 typedef struct _GLogDomain	GLogDomain;
 typedef struct _GLogHandler	GLogHandler;
@@ -515,9 +530,39 @@ static gpointer          fatal_log_data;
 static GLogWriterFunc log_writer_func = g_log_writer_default;
 static gpointer       log_writer_user_data = NULL;
 static GDestroyNotify log_writer_user_data_free = NULL;
+/* whether only the default handler and writer see INFO_LEVELS messages,
+ * and they are never fatal, so that G_MESSAGES_DEBUG alone decides if
+ * they are output; read without the lock by g_log_level_is_enabled()
+ */
+static gint           g_log_info_filtered = TRUE;
 
 /* --- functions --- */
 
+static void
+g_log_update_info_filtered_L (void)
+{
+  GLogDomain *domain;
+  gboolean filtered;
+
+  filtered = (default_log_func == g_log_default_handler &&
+              log_writer_func == g_log_writer_default &&
+              !(g_log_always_fatal & INFO_LEVELS));
+
+  for (domain = g_log_domains; filtered && domain; domain = domain->next)
+    {
+      GLogHandler *handler;
+
+      if (domain->fatal_mask & INFO_LEVELS)
+        filtered = FALSE;
+
+      for (handler = domain->handlers; handler; handler = handler->next)
+        if (handler->log_level & INFO_LEVELS)
+          filtered = FALSE;
+    }
+
+  g_atomic_int_set (&g_log_info_filtered, filtered);
+}
+
 static void _g_log_abort (gboolean breakpoint);
 
 static void
@@ -725,6 +770,7 @@ g_log_set_always_fatal (GLogLevelFlags fatal_mask)
   g_mutex_lock (&g_messages_lock);
   old_mask = g_log_always_fatal;
   g_log_always_fatal = fatal_mask;
+  g_log_update_info_filtered_L ();
   g_mutex_unlock (&g_messages_lock);
 
   return old_mask;
@@ -770,6 +816,7 @@ g_log_set_fatal_mask (const gchar   *log_domain,
   
   domain->fatal_mask = fatal_mask;
   g_log_domain_check_free_L (domain);
+  g_log_update_info_filtered_L ();
 
   g_mutex_unlock (&g_messages_lock);
 
@@ -882,6 +929,7 @@ g_log_set_handler_full (const gchar    *log_domain,
   handler->destroy = destroy;
   handler->next = domain->handlers;
   domain->handlers = handler;
+  g_log_update_info_filtered_L ();
 
   g_mutex_unlock (&g_messages_lock);
   
@@ -915,6 +963,7 @@ g_log_set_default_handler (GLogFunc log_func,
   old_log_func = default_log_func;
   default_log_func = log_func;
   default_log_data = user_data;
+  g_log_update_info_filtered_L ();
   g_mutex_unlock (&g_messages_lock);
   
   return old_log_func;
@@ -998,6 +1047,7 @@ g_log_remove_handler (const gchar *log_domain,
 	      else
 		domain->handlers = work->next;
 	      g_log_domain_check_free_L (domain); 
+	      g_log_update_info_filtered_L ();
 	      g_mutex_unlock (&g_messages_lock);
               if (work->destroy)
                 work->destroy (work->data);
@@ -1138,10 +1188,6 @@ format_unsigned (gchar  *buf,
 
 #define	ALERT_LEVELS		(G_LOG_LEVEL_ERROR | G_LOG_LEVEL_CRITICAL | G_LOG_LEVEL_WARNING)
 
-/* these are emitted by the default log handler */
-#define DEFAULT_LEVELS (G_LOG_LEVEL_ERROR | G_LOG_LEVEL_CRITICAL | G_LOG_LEVEL_WARNING | G_LOG_LEVEL_MESSAGE)
-/* these are filtered by G_MESSAGES_DEBUG by the default log handler */
-#define INFO_LEVELS (G_LOG_LEVEL_INFO | G_LOG_LEVEL_DEBUG)
 
 static const gchar *log_level_to_color (GLogLevelFlags log_level,
                                         gboolean       use_color);
@@ -1250,6 +1296,11 @@ g_logv (const gchar   *log_domain,
   if (!log_level)
     return;
 
+  /* don't format messages that nobody will see */
+  if (!was_fatal && !was_recursion &&
+      !g_log_level_is_enabled (log_domain, log_level))
+    return;
+
   if (log_level & G_LOG_FLAG_RECURSION)
     {
       /* we use a stack buffer of fixed size, since we're likely
@@ -1402,6 +1453,60 @@ g_log (const gchar   *log_domain,
 /* Return value must be 1 byte long (plus nul byte).
  * Reference: http://man7.org/linux/man-pages/man3/syslog.3.html#DESCRIPTION
  */
+/**
+ * g_log_level_is_enabled:
+ * @log_domain: (nullable): the log domain, usually #G_LOG_DOMAIN, or %NULL
+ *    for the default
+ * @log_level: the log level, either from #GLogLevelFlags or a user-defined
+ *    level
+ *
+ * Checks whether a message logged at @log_level in @log_domain, using
+ * g_log() or g_log_structured(), could be output.
+ *
+ * This returns %FALSE only for informational and debug messages which are
+ * certain to be dropped: GLib’s default log handler and writer are in use,
+ * no handler has been installed for these levels, they are not fatal, and
+ * @log_domain is not listed in the `G_MESSAGES_DEBUG` environment variable.
+ * Everything else is reported as enabled.
+ *
+ * The check does not take any locks or allocate, so it is cheap enough to
+ * skip formatting a message that is only for debugging. g_debug() and
+ * g_info() use it to avoid evaluating their arguments.
+ *
+ * Returns: %FALSE if the message would certainly be dropped, %TRUE otherwise
+ * Since: 2.54
+ */
+gboolean
+g_log_level_is_enabled (const gchar    *log_domain,
+                        GLogLevelFlags  log_level)
+{
+  const gchar *domains;
+
+  if ((log_level & ~INFO_LEVELS) || !(log_level & INFO_LEVELS))
+    return TRUE;
+
+  /* handlers, writers, fatal masks or g_test_expect_message() could
+   * all want to see the message
+   */
+  if (!g_atomic_int_get (&g_log_info_filtered) || expected_messages != NULL)
+    return TRUE;
+
+  /* messages logged from within the logging machinery go to the
+   * fallback handler, which doesn't filter
+   */
+  if (g_private_get (&g_log_depth) != NULL ||
+      g_private_get (&g_log_structured_depth) != NULL)
+    return TRUE;
+
+  /* this is the check g_log_writer_default() makes */
+  domains = g_getenv ("G_MESSAGES_DEBUG");
+  if (domains == NULL)
+    return FALSE;
+
+  return (strcmp (domains, "all") == 0 ||
+          (log_domain != NULL && strstr (domains, log_domain) != NULL));
+}
+
 static const gchar *
 log_level_to_priority (GLogLevelFlags log_level)
 {
@@ -1677,6 +1782,10 @@ g_log_structured (const gchar    *log_domain,
   GLogField *fields_allocated = NULL;
   GArray *array = NULL;
 
+  /* don't format messages that nobody will see */
+  if (!g_log_level_is_enabled (log_domain, log_level))
+    return;
+
   va_start (args, log_level);
 
   /* MESSAGE and PRIORITY are a given */
@@ -1969,6 +2078,7 @@ g_log_set_writer_func (GLogWriterFunc func,
   log_writer_func = func;
   log_writer_user_data = user_data;
   log_writer_user_data_free = user_data_free;
+  g_log_update_info_filtered_L ();
   g_mutex_unlock (&g_messages_lock);
 }
 
@@ -2616,6 +2726,365 @@ handled:
   return G_LOG_WRITER_HANDLED;
 }
 
+/* A log entry waiting in a #GLogAsyncWriter. The fields, their keys and
+ * their values are all in the one allocation @fields points to.
+ */
+typedef struct
+{
+  GLogLevelFlags log_level;
+  GLogField *fields;
+  gsize n_fields;
+} GLogAsyncRecord;
+
+/**
+ * GLogAsyncWriter:
+ *
+ * An opaque structure which queues log entries for a #GLogWriterFunc
+ * running in a thread of its own. See g_log_async_writer_new().
+ *
+ * Since: 2.54
+ */
+struct _GLogAsyncWriter
+{
+  GLogWriterFunc writer_func;
+  gpointer writer_user_data;
+  GDestroyNotify writer_user_data_free;
+  GLogAsyncOverflow overflow;
+
+  GMutex lock;
+  GCond cond;  /* broadcast whenever queued or n_writing change */
+  GLogAsyncRecord *queued;  /* ring buffer of max_queued entries */
+  gsize max_queued;
+  gsize head;
+  gsize n_queued;
+  gsize n_writing;
+  guint n_dropped;
+  gboolean stopping;
+
+  GThread *thread;
+};
+
+static GLogAsyncRecord
+log_async_record_new (GLogLevelFlags   log_level,
+                      const GLogField *fields,
+                      gsize            n_fields)
+{
+  GLogAsyncRecord record;
+  gsize i, size;
+  gchar *p;
+
+  size = n_fields * sizeof (GLogField);
+  for (i = 0; i < n_fields; i++)
+    {
+      size += strlen (fields[i].key) + 1;
+      if (fields[i].length < 0)
+        size += strlen (fields[i].value) + 1;
+      else
+        size += fields[i].length;
+    }
+
+  record.log_level = log_level;
+  record.fields = g_malloc (size);
+  record.n_fields = n_fields;
+
+  p = (gchar *) (record.fields + n_fields);
+  for (i = 0; i < n_fields; i++)
+    {
+      gsize len;
+
+      len = strlen (fields[i].key) + 1;
+      record.fields[i].key = memcpy (p, fields[i].key, len);
+      p += len;
+
+      if (fields[i].length < 0)
+        len = strlen (fields[i].value) + 1;
+      else
+        len = fields[i].length;
+      record.fields[i].value = len > 0 ? memcpy (p, fields[i].value, len) : p;
+      record.fields[i].length = fields[i].length;
+      p += len;
+    }
+
+  return record;
+}
+
+static void
+log_async_writer_report_dropped (GLogAsyncWriter *writer,
+                                 guint            n_dropped)
+{
+  GLogField fields[3];
+  gchar *message;
+
+  message = g_strdup_printf ("%u log messages were dropped because the queue was full",
+                             n_dropped);
+
+  fields[0].key = "GLIB_DOMAIN";
+  fields[0].value = "GLib";
+  fields[0].length = -1;
+  fields[1].key = "PRIORITY";
+  fields[1].value = log_level_to_priority (G_LOG_LEVEL_WARNING);
+  fields[1].length = -1;
+  fields[2].key = "MESSAGE";
+  fields[2].value = message;
+  fields[2].length = -1;
+
+  writer->writer_func (G_LOG_LEVEL_WARNING, fields, G_N_ELEMENTS (fields),
+                       writer->writer_user_data);
+  g_free (message);
+}
+
+static gpointer
+log_async_writer_thread (gpointer data)
+{
+  GLogAsyncWriter *writer = data;
+  GLogAsyncRecord *batch;
+  gsize i, n;
+  guint n_dropped;
+
+  /* As in g_log_structured_array(), messages logged by the writer itself
+   * go to the fallback writer rather than back into the queue.
+   */
+  g_private_set (&g_log_structured_depth, GUINT_TO_POINTER (1));
+
+  batch = g_new (GLogAsyncRecord, writer->max_queued);
+
+  g_mutex_lock (&writer->lock);
+
+  while (TRUE)
+    {
+      while (writer->n_queued == 0 && writer->n_dropped == 0 && !writer->stopping)
+        g_cond_wait (&writer->cond, &writer->lock);
+
+      if (writer->n_queued == 0 && writer->n_dropped == 0)
+        break;
+
+      /* Take everything that is queued at once, so that producers
+       * only ever wait for the lock while records are copied.
+       */
+      n = writer->n_queued;
+      for (i = 0; i < n; i++)
+        batch[i] = writer->queued[(writer->head + i) % writer->max_queued];
+      writer->head = (writer->head + n) % writer->max_queued;
+      writer->n_queued = 0;
+      writer->n_writing = n;
+      n_dropped = writer->n_dropped;
+      writer->n_dropped = 0;
+      g_cond_broadcast (&writer->cond);
+
+      g_mutex_unlock (&writer->lock);
+
+      for (i = 0; i < n; i++)
+        {
+          writer->writer_func (batch[i].log_level, batch[i].fields, batch[i].n_fields,
+                               writer->writer_user_data);
+          g_free (batch[i].fields);
+        }
+
+      if (n_dropped > 0)
+        log_async_writer_report_dropped (writer, n_dropped);
+
+      g_mutex_lock (&writer->lock);
+      writer->n_writing = 0;
+      g_cond_broadcast (&writer->cond);
+    }
+
+  g_mutex_unlock (&writer->lock);
+
+  g_free (batch);
+
+  return NULL;
+}
+
+/**
+ * g_log_async_writer_new:
+ * @writer_func: log writer function to pass the log entries to
+ * @user_data: (closure writer_func): user data to pass to @writer_func
+ * @user_data_free: (destroy writer_func): function to free @user_data once
+ *    it’s finished with, if non-%NULL
+ * @max_queued: the number of log entries that may be waiting to be written,
+ *    which must be positive
+ * @overflow: what to do with log entries once @max_queued are waiting
+ *
+ * Creates a #GLogAsyncWriter, which passes log entries to @writer_func in a
+ * thread of its own, so that logging does not wait for the destination of the
+ * entries (for example, a busy systemd journal) to accept them.
+ *
+ * Install the returned writer using g_log_writer_async():
+ * |[<!-- language="C" -->
+ *   writer = g_log_async_writer_new (g_log_writer_default, NULL, NULL,
+ *                                    1024, G_LOG_ASYNC_OVERFLOW_DROP);
+ *   g_log_set_writer_func (g_log_writer_async, writer, NULL);
+ *   …
+ *   g_log_async_writer_free (writer);
+ * ]|
+ *
+ * Log entries are written in the order they were queued. Entries with a fatal
+ * log level are written synchronously, after those still queued, so that they
+ * are not lost when the program aborts.
+ *
+ * If @overflow is %G_LOG_ASYNC_OVERFLOW_DROP, the number of dropped entries
+ * is reported to @writer_func in a warning of its own once there is room
+ * again.
+ *
+ * Returns: (transfer full): a new #GLogAsyncWriter; free it with
+ *    g_log_async_writer_free()
+ * Since: 2.54
+ */
+GLogAsyncWriter *
+g_log_async_writer_new (GLogWriterFunc    writer_func,
+                        gpointer          user_data,
+                        GDestroyNotify    user_data_free,
+                        gsize             max_queued,
+                        GLogAsyncOverflow overflow)
+{
+  GLogAsyncWriter *writer;
+
+  g_return_val_if_fail (writer_func != NULL, NULL);
+  g_return_val_if_fail (max_queued > 0, NULL);
+
+  writer = g_new0 (GLogAsyncWriter, 1);
+  writer->writer_func = writer_func;
+  writer->writer_user_data = user_data;
+  writer->writer_user_data_free = user_data_free;
+  writer->overflow = overflow;
+  g_mutex_init (&writer->lock);
+  g_cond_init (&writer->cond);
+  writer->queued = g_new (GLogAsyncRecord, max_queued);
+  writer->max_queued = max_queued;
+
+  writer->thread = g_thread_new ("log-writer", log_async_writer_thread, writer);
+
+  return writer;
+}
+
+/**
+ * g_log_async_writer_flush:
+ * @writer: a #GLogAsyncWriter
+ *
+ * Waits until all the log entries queued in @writer when this is called
+ * have been written.
+ *
+ * Since: 2.54
+ */
+void
+g_log_async_writer_flush (GLogAsyncWriter *writer)
+{
+  g_return_if_fail (writer != NULL);
+
+  /* the writer thread may well log something itself */
+  if (g_thread_self () == writer->thread)
+    return;
+
+  g_mutex_lock (&writer->lock);
+  while (writer->n_queued > 0 || writer->n_writing > 0 || writer->n_dropped > 0)
+    g_cond_wait (&writer->cond, &writer->lock);
+  g_mutex_unlock (&writer->lock);
+}
+
+/**
+ * g_log_async_writer_free:
+ * @writer: (transfer full): a #GLogAsyncWriter
+ *
+ * Writes out the log entries still queued in @writer, stops its thread and
+ * frees it.
+ *
+ * @writer must no longer be in use; in particular, if it was installed with
+ * g_log_set_writer_func(), another writer must have been installed first,
+ * or the program must be about to exit.
+ *
+ * Since: 2.54
+ */
+void
+g_log_async_writer_free (GLogAsyncWriter *writer)
+{
+  g_return_if_fail (writer != NULL);
+
+  g_mutex_lock (&writer->lock);
+  writer->stopping = TRUE;
+  g_cond_broadcast (&writer->cond);
+  g_mutex_unlock (&writer->lock);
+
+  g_thread_join (writer->thread);
+
+  if (writer->writer_user_data_free != NULL)
+    writer->writer_user_data_free (writer->writer_user_data);
+
+  g_mutex_clear (&writer->lock);
+  g_cond_clear (&writer->cond);
+  g_free (writer->queued);
+  g_free (writer);
+}
+
+/**
+ * g_log_writer_async:
+ * @log_level: log level, either from #GLogLevelFlags, or a user-defined
+ *    level
+ * @fields: (array length=n_fields): key–value pairs of structured data forming
+ *    the log message
+ * @n_fields: number of elements in the @fields array
+ * @user_data: a #GLogAsyncWriter
+ *
+ * Queue a copy of a structured log message in the #GLogAsyncWriter passed as
+ * @user_data, to be written by its thread. If the queue is full, this waits
+ * for room or drops the message, depending on how the writer was created.
+ *
+ * This is suitable for use as a #GLogWriterFunc.
+ *
+ * Returns: %G_LOG_WRITER_HANDLED if the message was queued or written,
+ *    %G_LOG_WRITER_UNHANDLED if it was dropped
+ * Since: 2.54
+ */
+GLogWriterOutput
+g_log_writer_async (GLogLevelFlags   log_level,
+                    const GLogField *fields,
+                    gsize            n_fields,
+                    gpointer         user_data)
+{
+  GLogAsyncWriter *writer = user_data;
+  GLogAsyncRecord record;
+
+  g_return_val_if_fail (writer != NULL, G_LOG_WRITER_UNHANDLED);
+  g_return_val_if_fail (fields != NULL, G_LOG_WRITER_UNHANDLED);
+  g_return_val_if_fail (n_fields > 0, G_LOG_WRITER_UNHANDLED);
+
+  /* Write fatal messages before aborting, and never let the writer
+   * thread wait for itself.
+   */
+  if ((log_level & (G_LOG_FLAG_FATAL | g_log_always_fatal)) ||
+      g_thread_self () == writer->thread)
+    {
+      g_log_async_writer_flush (writer);
+      return writer->writer_func (log_level, fields, n_fields,
+                                  writer->writer_user_data);
+    }
+
+  record = log_async_record_new (log_level, fields, n_fields);
+
+  g_mutex_lock (&writer->lock);
+
+  if (writer->overflow == G_LOG_ASYNC_OVERFLOW_BLOCK)
+    {
+      while (writer->n_queued == writer->max_queued)
+        g_cond_wait (&writer->cond, &writer->lock);
+    }
+  else if (writer->n_queued == writer->max_queued)
+    {
+      writer->n_dropped++;
+      g_mutex_unlock (&writer->lock);
+
+      g_free (record.fields);
+      return G_LOG_WRITER_UNHANDLED;
+    }
+
+  writer->queued[(writer->head + writer->n_queued) % writer->max_queued] = record;
+  writer->n_queued++;
+  g_cond_broadcast (&writer->cond);
+
+  g_mutex_unlock (&writer->lock);
+
+  return G_LOG_WRITER_HANDLED;
+}
+
 static GLogWriterOutput
 _g_log_writer_fallback (GLogLevelFlags   log_level,
                         const GLogField *fields,
@@ -113,6 +113,9 @@ GLogLevelFlags  g_log_set_fatal_mask    (const gchar    *log_domain,
                                          GLogLevelFlags  fatal_mask);
 GLIB_AVAILABLE_IN_ALL
 GLogLevelFlags  g_log_set_always_fatal  (GLogLevelFlags  fatal_mask);
+GLIB_AVAILABLE_IN_2_54
+gboolean        g_log_level_is_enabled  (const gchar    *log_domain,
+                                         GLogLevelFlags  log_level);
 
 /* Structured logging mechanism. */
 
@@ -234,6 +237,39 @@ GLogWriterOutput g_log_writer_default          (GLogLevelFlags   log_level,
                                                 gsize            n_fields,
                                                 gpointer         user_data);
 
+/**
+ * GLogAsyncOverflow:
+ * @G_LOG_ASYNC_OVERFLOW_DROP: drop the log entry
+ * @G_LOG_ASYNC_OVERFLOW_BLOCK: wait until the entry can be queued
+ *
+ * What a #GLogAsyncWriter does with a log entry when its queue is full.
+ *
+ * Since: 2.54
+ */
+typedef enum
+{
+  G_LOG_ASYNC_OVERFLOW_DROP,
+  G_LOG_ASYNC_OVERFLOW_BLOCK
+} GLogAsyncOverflow;
+
+typedef struct _GLogAsyncWriter GLogAsyncWriter;
+
+GLIB_AVAILABLE_IN_2_54
+GLogAsyncWriter *g_log_async_writer_new        (GLogWriterFunc    writer_func,
+                                                gpointer          user_data,
+                                                GDestroyNotify    user_data_free,
+                                                gsize             max_queued,
+                                                GLogAsyncOverflow overflow);
+GLIB_AVAILABLE_IN_2_54
+void             g_log_async_writer_flush      (GLogAsyncWriter  *writer);
+GLIB_AVAILABLE_IN_2_54
+void             g_log_async_writer_free       (GLogAsyncWriter  *writer);
+GLIB_AVAILABLE_IN_2_54
+GLogWriterOutput g_log_writer_async            (GLogLevelFlags   log_level,
+                                                const GLogField *fields,
+                                                gsize            n_fields,
+                                                gpointer         user_data);
+
 /**
  * G_DEBUG_HERE:
  *
@@ -280,6 +316,16 @@ void g_assert_warning         (const char *log_domain,
 #define G_LOG_DOMAIN    ((gchar*) 0)
 #endif  /* G_LOG_DOMAIN */
 
+/* g_info() and g_debug() skip formatting, and evaluating their arguments,
+ * for messages which would be dropped anyway
+ */
+#if GLIB_VERSION_MIN_REQUIRED >= GLIB_VERSION_2_54
+#define _G_LOG_IF_ENABLED(log_level, expr) \
+  (g_log_level_is_enabled (G_LOG_DOMAIN, (log_level)) ? (expr) : (void) 0)
+#else
+#define _G_LOG_IF_ENABLED(log_level, expr) (expr)
+#endif
+
 #if defined(G_HAVE_ISO_VARARGS) && !G_ANALYZER_ANALYZING
 #ifdef G_LOG_USE_STRUCTURED
 #define g_error(...)  G_STMT_START {                                            \
@@ -305,16 +351,18 @@ void g_assert_warning         (const char *log_domain,
                                           "CODE_LINE", G_STRINGIFY (__LINE__),  \
                                           "CODE_FUNC", G_STRFUNC,                \
                                           "MESSAGE", __VA_ARGS__)
-#define g_info(...)     g_log_structured (G_LOG_DOMAIN, G_LOG_LEVEL_INFO,       \
-                                          "CODE_FILE", __FILE__,                \
-                                          "CODE_LINE", G_STRINGIFY (__LINE__),  \
-                                          "CODE_FUNC", G_STRFUNC,                \
-                                          "MESSAGE", __VA_ARGS__)
-#define g_debug(...)    g_log_structured (G_LOG_DOMAIN, G_LOG_LEVEL_DEBUG,      \
-                                          "CODE_FILE", __FILE__,                \
-                                          "CODE_LINE", G_STRINGIFY (__LINE__),  \
-                                          "CODE_FUNC", G_STRFUNC,                \
-                                          "MESSAGE", __VA_ARGS__)
+#define g_info(...)     _G_LOG_IF_ENABLED (G_LOG_LEVEL_INFO,                    \
+                          g_log_structured (G_LOG_DOMAIN, G_LOG_LEVEL_INFO,     \
+                                            "CODE_FILE", __FILE__,              \
+                                            "CODE_LINE", G_STRINGIFY (__LINE__), \
+                                            "CODE_FUNC", G_STRFUNC,              \
+                                            "MESSAGE", __VA_ARGS__))
+#define g_debug(...)    _G_LOG_IF_ENABLED (G_LOG_LEVEL_DEBUG,                   \
+                          g_log_structured (G_LOG_DOMAIN, G_LOG_LEVEL_DEBUG,    \
+                                            "CODE_FILE", __FILE__,              \
+                                            "CODE_LINE", G_STRINGIFY (__LINE__), \
+                                            "CODE_FUNC", G_STRFUNC,              \
+                                            "MESSAGE", __VA_ARGS__))
 #else
 /* for(;;) ; so that GCC knows that control doesn't go past g_error().
  * Put space before ending semicolon to avoid C++ build warnings.
@@ -334,12 +382,14 @@ void g_assert_warning         (const char *log_domain,
 #define g_warning(...)  g_log (G_LOG_DOMAIN,         \
                                G_LOG_LEVEL_WARNING,  \
                                __VA_ARGS__)
-#define g_info(...)     g_log (G_LOG_DOMAIN,         \
-                               G_LOG_LEVEL_INFO,     \
-                               __VA_ARGS__)
-#define g_debug(...)    g_log (G_LOG_DOMAIN,         \
-                               G_LOG_LEVEL_DEBUG,    \
-                               __VA_ARGS__)
+#define g_info(...)     _G_LOG_IF_ENABLED (G_LOG_LEVEL_INFO,   \
+                                 g_log (G_LOG_DOMAIN,         \
+                                        G_LOG_LEVEL_INFO,     \
+                                        __VA_ARGS__))
+#define g_debug(...)    _G_LOG_IF_ENABLED (G_LOG_LEVEL_DEBUG,  \
+                                 g_log (G_LOG_DOMAIN,         \
+                                        G_LOG_LEVEL_DEBUG,    \
+                                        __VA_ARGS__))
 #endif
 #elif defined(G_HAVE_GNUC_VARARGS)  && !G_ANALYZER_ANALYZING
 #ifdef G_LOG_USE_STRUCTURED
@@ -366,16 +416,18 @@ void g_assert_warning         (const char *log_domain,
                                                 "CODE_LINE", G_STRINGIFY (__LINE__), \
                                                 "CODE_FUNC", G_STRFUNC,               \
                                                 "MESSAGE", format)
-#define g_info(format...)     g_log_structured (G_LOG_DOMAIN, G_LOG_LEVEL_INFO,      \
-                                                "CODE_FILE", __FILE__,               \
-                                                "CODE_LINE", G_STRINGIFY (__LINE__), \
-                                                "CODE_FUNC", G_STRFUNC,               \
-                                                "MESSAGE", format)
-#define g_debug(format...)    g_log_structured (G_LOG_DOMAIN, G_LOG_LEVEL_DEBUG,     \
-                                                "CODE_FILE", __FILE__,               \
-                                                "CODE_LINE", G_STRINGIFY (__LINE__), \
-                                                "CODE_FUNC", G_STRFUNC,               \
-                                                "MESSAGE", format)
+#define g_info(format...)     _G_LOG_IF_ENABLED (G_LOG_LEVEL_INFO,                    \
+                                g_log_structured (G_LOG_DOMAIN, G_LOG_LEVEL_INFO,     \
+                                                  "CODE_FILE", __FILE__,              \
+                                                  "CODE_LINE", G_STRINGIFY (__LINE__), \
+                                                  "CODE_FUNC", G_STRFUNC,              \
+                                                  "MESSAGE", format))
+#define g_debug(format...)    _G_LOG_IF_ENABLED (G_LOG_LEVEL_DEBUG,                   \
+                                g_log_structured (G_LOG_DOMAIN, G_LOG_LEVEL_DEBUG,    \
+                                                  "CODE_FILE", __FILE__,              \
+                                                  "CODE_LINE", G_STRINGIFY (__LINE__), \
+                                                  "CODE_FUNC", G_STRFUNC,              \
+                                                  "MESSAGE", format))
 #else
 #define g_error(format...)    G_STMT_START {                 \
                                 g_log (G_LOG_DOMAIN,         \
@@ -393,12 +445,14 @@ void g_assert_warning         (const char *log_domain,
 #define g_warning(format...)    g_log (G_LOG_DOMAIN,         \
                                        G_LOG_LEVEL_WARNING,  \
                                        format)
-#define g_info(format...)       g_log (G_LOG_DOMAIN,         \
-                                       G_LOG_LEVEL_INFO,     \
-                                       format)
-#define g_debug(format...)      g_log (G_LOG_DOMAIN,         \
-                                       G_LOG_LEVEL_DEBUG,    \
-                                       format)
+#define g_info(format...)       _G_LOG_IF_ENABLED (G_LOG_LEVEL_INFO,   \
+                                         g_log (G_LOG_DOMAIN,         \
+                                                G_LOG_LEVEL_INFO,     \
+                                                format))
+#define g_debug(format...)      _G_LOG_IF_ENABLED (G_LOG_LEVEL_DEBUG,  \
+                                         g_log (G_LOG_DOMAIN,         \
+                                                G_LOG_LEVEL_DEBUG,    \
+                                                format))
 #endif
 #else   /* no varargs macros */
 static void g_error (const gchar *format, ...) G_GNUC_NORETURN G_ANALYZER_NORETURN;
@@ -447,6 +501,10 @@ g_info (const gchar *format,
         ...)
 {
   va_list args;
+#if GLIB_VERSION_MIN_REQUIRED >= GLIB_VERSION_2_54
+  if (!g_log_level_is_enabled (G_LOG_DOMAIN, G_LOG_LEVEL_INFO))
+    return;
+#endif
   va_start (args, format);
   g_logv (G_LOG_DOMAIN, G_LOG_LEVEL_INFO, format, args);
   va_end (args);
@@ -456,6 +514,10 @@ g_debug (const gchar *format,
          ...)
 {
   va_list args;
+#if GLIB_VERSION_MIN_REQUIRED >= GLIB_VERSION_2_54
+  if (!g_log_level_is_enabled (G_LOG_DOMAIN, G_LOG_LEVEL_DEBUG))
+    return;
+#endif
   va_start (args, format);
   g_logv (G_LOG_DOMAIN, G_LOG_LEVEL_DEBUG, format, args);
   va_end (args);
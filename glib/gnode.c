@@ -31,6 +31,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "gnode.h"
 
 #include "gslice.h"
@@ -110,17 +112,39 @@ g_node_new (gpointer data)
   return node;
 }
 
+/* Frees @root and everything below it.  Rather than recursing, this
+ * frees the leftmost leaf, moves on to its next sibling, and turns the
+ * parent into a leaf once its last child is gone.
+ */
 static void
-g_nodes_free (GNode *node)
+g_nodes_free (GNode *root)
 {
-  while (node)
+  GNode *node = root;
+  
+  while (TRUE)
     {
-      GNode *next = node->next;
-      if (node->children)
-        g_nodes_free (node->children);
+      GNode *parent, *next;
+      
+      while (node->children)
+	node = node->children;
+      
+      if (node == root)
+	break;
+      
+      parent = node->parent;
+      next = node->next;
       g_node_free (node);
-      node = next;
+      
+      if (next)
+	node = next;
+      else
+	{
+	  parent->children = NULL;
+	  node = parent;
+	}
     }
+  
+  g_node_free (root);
 }
 
 /**
@@ -498,282 +522,223 @@ g_node_reverse_children (GNode *node)
 guint
 g_node_max_height (GNode *root)
 {
-  GNode *child;
-  guint max_height = 0;
+  GNode *node;
+  guint height, max_height;
   
   if (!root)
     return 0;
   
-  child = root->children;
-  while (child)
+  /* Walk the tree using the parent pointers, so that deep trees
+   * don't need a deep stack.
+   */
+  node = root;
+  height = max_height = 1;
+  while (TRUE)
     {
-      guint tmp_height;
+      if (height > max_height)
+	max_height = height;
       
-      tmp_height = g_node_max_height (child);
-      if (tmp_height > max_height)
-	max_height = tmp_height;
-      child = child->next;
-    }
-  
-  return max_height + 1;
-}
-
-static gboolean
-g_node_traverse_pre_order (GNode	    *node,
-			   GTraverseFlags    flags,
-			   GNodeTraverseFunc func,
-			   gpointer	     data)
-{
-  if (node->children)
-    {
-      GNode *child;
-      
-      if ((flags & G_TRAVERSE_NON_LEAFS) &&
-	  func (node, data))
-	return TRUE;
-      
-      child = node->children;
-      while (child)
+      if (node->children)
 	{
-	  GNode *current;
-	  
-	  current = child;
-	  child = current->next;
-	  if (g_node_traverse_pre_order (current, flags, func, data))
-	    return TRUE;
+	  node = node->children;
+	  height++;
+	  continue;
 	}
-    }
-  else if ((flags & G_TRAVERSE_LEAFS) &&
-	   func (node, data))
-    return TRUE;
-  
-  return FALSE;
-}
-
-static gboolean
-g_node_depth_traverse_pre_order (GNode		  *node,
-				 GTraverseFlags	   flags,
-				 guint		   depth,
-				 GNodeTraverseFunc func,
-				 gpointer	   data)
-{
-  if (node->children)
-    {
-      GNode *child;
-      
-      if ((flags & G_TRAVERSE_NON_LEAFS) &&
-	  func (node, data))
-	return TRUE;
-      
-      depth--;
-      if (!depth)
-	return FALSE;
       
-      child = node->children;
-      while (child)
+      while (node != root && !node->next)
 	{
-	  GNode *current;
-	  
-	  current = child;
-	  child = current->next;
-	  if (g_node_depth_traverse_pre_order (current, flags, depth, func, data))
-	    return TRUE;
+	  node = node->parent;
+	  height--;
 	}
+      if (node == root)
+	break;
+      node = node->next;
     }
-  else if ((flags & G_TRAVERSE_LEAFS) &&
-	   func (node, data))
-    return TRUE;
   
-  return FALSE;
+  return max_height;
 }
 
-static gboolean
-g_node_traverse_post_order (GNode	     *node,
-			    GTraverseFlags    flags,
-			    GNodeTraverseFunc func,
-			    gpointer	      data)
+/* The depth-first traversals below keep their own stack instead of
+ * recursing, so that they work on arbitrarily deep trees.  Each frame
+ * corresponds to one level of the old recursive implementation: it
+ * holds the node being visited and its next sibling, which is read
+ * before the node's subtree is visited, so that @func may unlink or
+ * destroy the node it is called for.
+ */
+typedef struct
 {
-  if (node->children)
+  GNode    *node;
+  GNode    *next;
+  gboolean  visited;
+} TraverseFrame;
+
+#define TRAVERSE_STACK_PREALLOC 32
+
+typedef struct
+{
+  TraverseFrame *frames;
+  guint          len;
+  guint          alloc;
+  TraverseFrame  prealloc[TRAVERSE_STACK_PREALLOC];
+} TraverseStack;
+
+static void
+traverse_stack_push (TraverseStack *stack,
+		     GNode         *node,
+		     GNode         *next)
+{
+  TraverseFrame *frame;
+  
+  if (stack->len == stack->alloc)
     {
-      GNode *child;
-      
-      child = node->children;
-      while (child)
+      stack->alloc *= 2;
+      if (stack->frames == stack->prealloc)
 	{
-	  GNode *current;
-	  
-	  current = child;
-	  child = current->next;
-	  if (g_node_traverse_post_order (current, flags, func, data))
-	    return TRUE;
+	  stack->frames = g_new (TraverseFrame, stack->alloc);
+	  memcpy (stack->frames, stack->prealloc, sizeof stack->prealloc);
 	}
-      
-      if ((flags & G_TRAVERSE_NON_LEAFS) &&
-	  func (node, data))
-	return TRUE;
-      
+      else
+	stack->frames = g_renew (TraverseFrame, stack->frames, stack->alloc);
     }
-  else if ((flags & G_TRAVERSE_LEAFS) &&
-	   func (node, data))
-    return TRUE;
   
-  return FALSE;
+  frame = &stack->frames[stack->len++];
+  frame->node = node;
+  frame->next = next;
+  frame->visited = FALSE;
 }
 
-static gboolean
-g_node_depth_traverse_post_order (GNode		   *node,
-				  GTraverseFlags    flags,
-				  guint		    depth,
-				  GNodeTraverseFunc func,
-				  gpointer	    data)
+static void
+g_node_traverse_depth_first (GNode	       *root,
+			     GTraverseType      order,
+			     GTraverseFlags     flags,
+			     gint	        depth,
+			     GNodeTraverseFunc  func,
+			     gpointer	        data)
 {
-  if (node->children)
+  TraverseStack stack;
+  TraverseFrame *parent;
+  GNode *node, *child, *next;
+  
+  stack.frames = stack.prealloc;
+  stack.len = 0;
+  stack.alloc = TRAVERSE_STACK_PREALLOC;
+  
+  /* The siblings of @root are never visited */
+  traverse_stack_push (&stack, root, NULL);
+  node = root;
+  
+  while (TRUE)
     {
-      depth--;
-      if (depth)
+      /* Visit @node, and find out whether to descend into its children.
+       * stack.len is the depth of @node, with @root at depth 1.
+       */
+      child = NULL;
+      if (node->children)
 	{
-	  GNode *child;
+	  if (order == G_PRE_ORDER &&
+	      (flags & G_TRAVERSE_NON_LEAFS) &&
+	      func (node, data))
+	    goto out;
 	  
-	  child = node->children;
-	  while (child)
-	    {
-	      GNode *current;
-	      
-	      current = child;
-	      child = current->next;
-	      if (g_node_depth_traverse_post_order (current, flags, depth, func, data))
-		return TRUE;
-	    }
+	  if (depth < 0 || stack.len < (guint) depth)
+	    child = node->children;
+	  else if (order != G_PRE_ORDER &&
+		   (flags & G_TRAVERSE_NON_LEAFS) &&
+		   func (node, data))
+	    goto out;
 	}
+      else if ((flags & G_TRAVERSE_LEAFS) &&
+	       func (node, data))
+	goto out;
       
-      if ((flags & G_TRAVERSE_NON_LEAFS) &&
-	  func (node, data))
-	return TRUE;
-      
-    }
-  else if ((flags & G_TRAVERSE_LEAFS) &&
-	   func (node, data))
-    return TRUE;
-  
-  return FALSE;
-}
-
-static gboolean
-g_node_traverse_in_order (GNode		   *node,
-			  GTraverseFlags    flags,
-			  GNodeTraverseFunc func,
-			  gpointer	    data)
-{
-  if (node->children)
-    {
-      GNode *child;
-      GNode *current;
-      
-      child = node->children;
-      current = child;
-      child = current->next;
-      
-      if (g_node_traverse_in_order (current, flags, func, data))
-	return TRUE;
-      
-      if ((flags & G_TRAVERSE_NON_LEAFS) &&
-	  func (node, data))
-	return TRUE;
-      
-      while (child)
+      if (child)
 	{
-	  current = child;
-	  child = current->next;
-	  if (g_node_traverse_in_order (current, flags, func, data))
-	    return TRUE;
+	  traverse_stack_push (&stack, child, child->next);
+	  node = child;
+	  continue;
 	}
-    }
-  else if ((flags & G_TRAVERSE_LEAFS) &&
-	   func (node, data))
-    return TRUE;
-  
-  return FALSE;
-}
-
-static gboolean
-g_node_depth_traverse_in_order (GNode		 *node,
-				GTraverseFlags	  flags,
-				guint		  depth,
-				GNodeTraverseFunc func,
-				gpointer	  data)
-{
-  if (node->children)
-    {
-      depth--;
-      if (depth)
+      
+      /* The subtree of @node is done: move on to the next sibling,
+       * finishing off the parents whose children are all done.
+       */
+      while (TRUE)
 	{
-	  GNode *child;
-	  GNode *current;
-	  
-	  child = node->children;
-	  current = child;
-	  child = current->next;
-	  
-	  if (g_node_depth_traverse_in_order (current, flags, depth, func, data))
-	    return TRUE;
-	  
-	  if ((flags & G_TRAVERSE_NON_LEAFS) &&
-	      func (node, data))
-	    return TRUE;
+	  next = stack.frames[--stack.len].next;
+	  if (stack.len == 0)
+	    goto out;
 	  
-	  while (child)
+	  parent = &stack.frames[stack.len - 1];
+	  if (order == G_IN_ORDER && !parent->visited)
 	    {
-	      current = child;
-	      child = current->next;
-	      if (g_node_depth_traverse_in_order (current, flags, depth, func, data))
-		return TRUE;
+	      /* in-order visits a node after its first child */
+	      parent->visited = TRUE;
+	      if ((flags & G_TRAVERSE_NON_LEAFS) &&
+		  func (parent->node, data))
+		goto out;
 	    }
+	  
+	  if (next)
+	    break;
+	  
+	  if (order == G_POST_ORDER &&
+	      (flags & G_TRAVERSE_NON_LEAFS) &&
+	      func (parent->node, data))
+	    goto out;
 	}
-      else if ((flags & G_TRAVERSE_NON_LEAFS) &&
-	       func (node, data))
-	return TRUE;
+      
+      traverse_stack_push (&stack, next, next->next);
+      node = next;
     }
-  else if ((flags & G_TRAVERSE_LEAFS) &&
-	   func (node, data))
-    return TRUE;
   
-  return FALSE;
+ out:
+  if (stack.frames != stack.prealloc)
+    g_free (stack.frames);
 }
 
+/* Visits the nodes at @level below @root, walking the tree through
+ * the parent pointers.  Like the other traversals, this does not
+ * recurse.
+ */
 static gboolean
-g_node_traverse_level (GNode		 *node,
+g_node_traverse_level (GNode		 *root,
 		       GTraverseFlags	  flags,
 		       guint		  level,
 		       GNodeTraverseFunc  func,
 		       gpointer	          data,
 		       gboolean          *more_levels)
 {
-  if (level == 0) 
+  GNode *node = root;
+  guint node_level = 0;
+  
+  while (TRUE)
     {
-      if (node->children)
+      if (node_level == level)
 	{
-	  *more_levels = TRUE;
-	  return (flags & G_TRAVERSE_NON_LEAFS) && func (node, data);
+	  if (node->children)
+	    {
+	      *more_levels = TRUE;
+	      if ((flags & G_TRAVERSE_NON_LEAFS) && func (node, data))
+		return TRUE;
+	    }
+	  else if ((flags & G_TRAVERSE_LEAFS) && func (node, data))
+	    return TRUE;
 	}
-      else
+      else if (node->children)
 	{
-	  return (flags & G_TRAVERSE_LEAFS) && func (node, data);
+	  node = node->children;
+	  node_level++;
+	  continue;
 	}
-    }
-  else 
-    {
-      node = node->children;
       
-      while (node)
+      while (node_level > 0 && !node->next)
 	{
-	  if (g_node_traverse_level (node, flags, level - 1, func, data, more_levels))
-	    return TRUE;
-
-	  node = node->next;
+	  node = node->parent;
+	  node_level--;
 	}
+      if (node_level == 0)
+	return FALSE;
+      node = node->next;
     }
-
-  return FALSE;
 }
 
 static gboolean
@@ -891,22 +856,9 @@ g_node_traverse (GNode		  *root,
   switch (order)
     {
     case G_PRE_ORDER:
-      if (depth < 0)
-	g_node_traverse_pre_order (root, flags, func, data);
-      else
-	g_node_depth_traverse_pre_order (root, flags, depth, func, data);
-      break;
     case G_POST_ORDER:
-      if (depth < 0)
-	g_node_traverse_post_order (root, flags, func, data);
-      else
-	g_node_depth_traverse_post_order (root, flags, depth, func, data);
-      break;
     case G_IN_ORDER:
-      if (depth < 0)
-	g_node_traverse_in_order (root, flags, func, data);
-      else
-	g_node_depth_traverse_in_order (root, flags, depth, func, data);
+      g_node_traverse_depth_first (root, order, flags, depth, func, data);
       break;
     case G_LEVEL_ORDER:
       g_node_depth_traverse_level (root, flags, depth, func, data);
@@ -961,29 +913,6 @@ g_node_find (GNode	    *root,
   return d[1];
 }
 
-static void
-g_node_count_func (GNode	 *node,
-		   GTraverseFlags flags,
-		   guint	 *n)
-{
-  if (node->children)
-    {
-      GNode *child;
-      
-      if (flags & G_TRAVERSE_NON_LEAFS)
-	(*n)++;
-      
-      child = node->children;
-      while (child)
-	{
-	  g_node_count_func (child, flags, n);
-	  child = child->next;
-	}
-    }
-  else if (flags & G_TRAVERSE_LEAFS)
-    (*n)++;
-}
-
 /**
  * g_node_n_nodes:
  * @root: a #GNode
@@ -998,12 +927,32 @@ guint
 g_node_n_nodes (GNode	       *root,
 		GTraverseFlags  flags)
 {
+  GNode *node;
   guint n = 0;
   
   g_return_val_if_fail (root != NULL, 0);
   g_return_val_if_fail (flags <= G_TRAVERSE_MASK, 0);
   
-  g_node_count_func (root, flags, &n);
+  node = root;
+  while (TRUE)
+    {
+      if (node->children)
+	{
+	  if (flags & G_TRAVERSE_NON_LEAFS)
+	    n++;
+	  node = node->children;
+	  continue;
+	}
+      
+      if (flags & G_TRAVERSE_LEAFS)
+	n++;
+      
+      while (node != root && !node->next)
+	node = node->parent;
+      if (node == root)
+	break;
+      node = node->next;
+    }
   
   return n;
 }
@@ -252,15 +252,29 @@ struct _GOptionContext
 
   GOptionGroup    *main_group;
 
-  /* We keep a list of change so we can revert them */
-  GList           *changes;
+  /* We keep the changes, indexed by arg_data, so we can revert them */
+  GHashTable      *changes;
 
   /* We also keep track of all argv elements
-   * that should be NULLed or modified.
+   * that should be NULLed or modified, in an array of PendingNull.
    */
-  GList           *pending_nulls;
+  GArray          *pending_nulls;
 };
 
+/* Lets the parser find the entries for an option name without
+ * scanning all entries of a group.  The lists are chained through
+ * next_long and next_short; all indices are entry index + 1, so that
+ * 0 ends a list.
+ */
+typedef struct
+{
+  GHashTable *long_names;       /* long name -> first entry */
+  gint        short_names[128]; /* short name -> first entry */
+  gint       *next_long;
+  gint       *next_short;
+  gboolean    linear;           /* a long name contains '=' */
+} EntryIndex;
+
 struct _GOptionGroup
 {
   gchar           *name;
@@ -278,6 +292,7 @@ struct _GOptionGroup
 
   GOptionEntry    *entries;
   gint             n_entries;
+  EntryIndex      *index;
 
   GOptionParseFunc pre_parse_func;
   GOptionParseFunc post_parse_func;
@@ -774,19 +789,137 @@ group_list_has_visible_entries (GOptionContext *context,
   return FALSE;
 }
 
+static void
+entry_index_free (EntryIndex *index)
+{
+  if (index == NULL)
+    return;
+
+  if (index->long_names)
+    g_hash_table_unref (index->long_names);
+  g_free (index->next_long);
+  g_free (index->next_short);
+  g_free (index);
+}
+
+static EntryIndex *
+group_get_index (GOptionGroup *group)
+{
+  EntryIndex *index;
+  gint *last_short;
+  gint i, first;
+
+  if (group->index)
+    return group->index;
+
+  index = g_new0 (EntryIndex, 1);
+  index->long_names = g_hash_table_new (g_str_hash, g_str_equal);
+  index->next_long = g_new0 (gint, group->n_entries);
+  index->next_short = g_new0 (gint, group->n_entries);
+  last_short = g_newa (gint, G_N_ELEMENTS (index->short_names));
+  memset (last_short, 0, sizeof index->short_names);
+
+  /* Build the lists back to front, so that they are in entry order */
+  for (i = group->n_entries - 1; i >= 0; i--)
+    {
+      const GOptionEntry *entry = &group->entries[i];
+
+      if (strchr (entry->long_name, '=') != NULL)
+        index->linear = TRUE;
+
+      first = GPOINTER_TO_INT (g_hash_table_lookup (index->long_names, entry->long_name));
+      index->next_long[i] = first;
+      g_hash_table_insert (index->long_names, (gchar *) entry->long_name, GINT_TO_POINTER (i + 1));
+
+      /* g_option_group_add_entries() only allows printable ASCII */
+      if (entry->short_name > 0)
+        {
+          index->next_short[i] = index->short_names[(guchar) entry->short_name];
+          index->short_names[(guchar) entry->short_name] = i + 1;
+        }
+    }
+
+  group->index = index;
+
+  return index;
+}
+
+/* Returns the index of the first entry of @group that can match the
+ * long option @arg, or -1.  Callers still compare the names, this only
+ * skips the entries that can't match.
+ */
+static gint
+group_first_long_entry (GOptionGroup *group,
+                        const gchar  *arg)
+{
+  EntryIndex *index = group_get_index (group);
+  const gchar *equals;
+  gchar buf[64];
+  gchar *name;
+  gpointer first;
+
+  if (index->linear)
+    return group->n_entries > 0 ? 0 : -1;
+
+  equals = strchr (arg, '=');
+  if (equals == NULL)
+    return GPOINTER_TO_INT (g_hash_table_lookup (index->long_names, arg)) - 1;
+
+  if (equals - arg < sizeof buf)
+    {
+      memcpy (buf, arg, equals - arg);
+      buf[equals - arg] = '\0';
+      name = buf;
+    }
+  else
+    name = g_strndup (arg, equals - arg);
+
+  first = g_hash_table_lookup (index->long_names, name);
+
+  if (name != buf)
+    g_free (name);
+
+  return GPOINTER_TO_INT (first) - 1;
+}
+
+static gint
+group_next_long_entry (GOptionGroup *group,
+                       gint          j)
+{
+  if (group->index->linear)
+    return j + 1 < group->n_entries ? j + 1 : -1;
+
+  return group->index->next_long[j] - 1;
+}
+
+static gint
+group_first_short_entry (GOptionGroup *group,
+                         gchar         arg)
+{
+  EntryIndex *index = group_get_index (group);
+
+  if (arg <= 0)
+    return -1;
+
+  return index->short_names[(guchar) arg] - 1;
+}
+
+static gint
+group_next_short_entry (GOptionGroup *group,
+                        gint          j)
+{
+  return group->index->next_short[j] - 1;
+}
+
 static gboolean
 context_has_h_entry (GOptionContext *context)
 {
-  gsize i;
   GList *list;
 
   if (context->main_group)
     {
-      for (i = 0; i < context->main_group->n_entries; i++)
-        {
-          if (context->main_group->entries[i].short_name == 'h')
-            return TRUE;
-        }
+      if (group_first_short_entry (context->main_group, 'h') >= 0)
+        return TRUE;
     }
 
   for (list = context->groups; list != NULL; list = g_list_next (list))
@@ -794,11 +927,8 @@ context_has_h_entry (GOptionContext *context)
      GOptionGroup *group;
 
       group = (GOptionGroup*)list->data;
-      for (i = 0; i < group->n_entries; i++)
-        {
-          if (group->entries[i].short_name == 'h')
-            return TRUE;
-        }
+      if (group_first_short_entry (group, 'h') >= 0)
+        return TRUE;
     }
   return FALSE;
 }
@@ -1204,24 +1334,20 @@ get_change (GOptionContext *context,
             GOptionArg      arg_type,
             gpointer        arg_data)
 {
-  GList *list;
-  Change *change = NULL;
+  Change *change;
 
-  for (list = context->changes; list != NULL; list = list->next)
-    {
-      change = list->data;
+  if (context->changes == NULL)
+    context->changes = g_hash_table_new_full (NULL, NULL, NULL, g_free);
 
-      if (change->arg_data == arg_data)
-        goto found;
-    }
+  change = g_hash_table_lookup (context->changes, arg_data);
+  if (change != NULL)
+    return change;
 
   change = g_new0 (Change, 1);
   change->arg_type = arg_type;
   change->arg_data = arg_data;
 
-  context->changes = g_list_prepend (context->changes, change);
-
- found:
+  g_hash_table_insert (context->changes, arg_data, change);
 
   return change;
 }
@@ -1231,13 +1357,15 @@ add_pending_null (GOptionContext *context,
                   gchar         **ptr,
                   gchar          *value)
 {
-  PendingNull *n;
+  PendingNull n;
+
+  if (context->pending_nulls == NULL)
+    context->pending_nulls = g_array_new (FALSE, FALSE, sizeof (PendingNull));
 
-  n = g_new0 (PendingNull, 1);
-  n->ptr = ptr;
-  n->value = value;
+  n.ptr = ptr;
+  n.value = value;
 
-  context->pending_nulls = g_list_prepend (context->pending_nulls, n);
+  g_array_append_val (context->pending_nulls, n);
 }
 
 static gboolean
@@ -1507,15 +1635,13 @@ parse_short_option (GOptionContext *context,
 {
   gint j;
 
-  for (j = 0; j < group->n_entries; j++)
+  for (j = group_first_short_entry (group, arg); j >= 0; j = group_next_short_entry (group, j))
     {
       if (arg == group->entries[j].short_name)
         {
-          gchar *option_name;
+          gchar option_name[3] = { '-', arg, '\0' };
           gchar *value = NULL;
 
-          option_name = g_strdup_printf ("-%c", group->entries[j].short_name);
-
           if (NO_ARG (&group->entries[j]))
             value = NULL;
           else
@@ -1525,7 +1651,6 @@ parse_short_option (GOptionContext *context,
                   g_set_error (error,
                                G_OPTION_ERROR, G_OPTION_ERROR_FAILED,
                                _("Error parsing option %s"), option_name);
-                  g_free (option_name);
                   return FALSE;
                 }
 
@@ -1556,7 +1681,6 @@ parse_short_option (GOptionContext *context,
                   g_set_error (error,
                                G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
                                _("Missing argument for %s"), option_name);
-                  g_free (option_name);
                   return FALSE;
                 }
             }
@@ -1564,11 +1688,9 @@ parse_short_option (GOptionContext *context,
           if (!parse_arg (context, group, &group->entries[j],
                           value, option_name, error))
             {
-              g_free (option_name);
               return FALSE;
             }
 
-          g_free (option_name);
           *parsed = TRUE;
         }
     }
@@ -1589,7 +1711,7 @@ parse_long_option (GOptionContext *context,
 {
   gint j;
 
-  for (j = 0; j < group->n_entries; j++)
+  for (j = group_first_long_entry (group, arg); j >= 0; j = group_next_long_entry (group, j))
     {
       if (*idx >= *argc)
         return TRUE;
@@ -1728,12 +1850,15 @@ static void
 free_changes_list (GOptionContext *context,
                    gboolean        revert)
 {
-  GList *list;
+  GHashTableIter iter;
+  Change *change;
 
-  for (list = context->changes; list != NULL; list = list->next)
-    {
-      Change *change = list->data;
+  if (context->changes == NULL)
+    return;
 
+  g_hash_table_iter_init (&iter, context->changes);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &change))
+    {
       if (revert)
         {
           switch (change->arg_type)
@@ -1764,11 +1889,9 @@ free_changes_list (GOptionContext *context,
               g_assert_not_reached ();
             }
         }
-
-      g_free (change);
     }
 
-  g_list_free (context->changes);
+  g_hash_table_unref (context->changes);
   context->changes = NULL;
 }
 
@@ -1776,11 +1899,15 @@ static void
 free_pending_nulls (GOptionContext *context,
                     gboolean        perform_nulls)
 {
-  GList *list;
+  guint i;
 
-  for (list = context->pending_nulls; list != NULL; list = list->next)
+  if (context->pending_nulls == NULL)
+    return;
+
+  /* Newest first, like the list this used to be */
+  for (i = context->pending_nulls->len; i > 0; i--)
     {
-      PendingNull *n = list->data;
+      PendingNull *n = &g_array_index (context->pending_nulls, PendingNull, i - 1);
 
       if (perform_nulls)
         {
@@ -1800,10 +1927,9 @@ free_pending_nulls (GOptionContext *context,
         }
 
       g_free (n->value);
-      g_free (n);
     }
 
-  g_list_free (context->pending_nulls);
+  g_array_unref (context->pending_nulls);
   context->pending_nulls = NULL;
 }
 
@@ -2329,6 +2455,7 @@ g_option_group_unref (GOptionGroup *group)
       g_free (group->help_description);
 
       g_free (group->entries);
+      entry_index_free (group->index);
 
       if (group->destroy_notify)
         (* group->destroy_notify) (group->user_data);
@@ -2397,6 +2524,9 @@ g_option_group_add_entries (GOptionGroup       *group,
     }
 
   group->n_entries += n_entries;
+
+  entry_index_free (group->index);
+  group->index = NULL;
 }
 
 /**
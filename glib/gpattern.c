@@ -21,9 +21,12 @@
 
 #include "gpattern.h"
 
+#include "garray.h"
+#include "ghash.h"
 #include "gmacros.h"
 #include "gmessages.h"
 #include "gmem.h"
+#include "gstrfuncs.h"
 #include "gunicode.h"
 #include "gutils.h" 
 
@@ -74,86 +77,81 @@ struct _GPatternSpec
   guint      min_length;
   guint      max_length;
   gchar     *pattern;
+  gchar     *forward_pattern;   /* G_MATCH_ALL_TAIL only */
 };
 
 
 /* --- functions --- */
-static inline gboolean
-g_pattern_ph_match (const gchar *match_pattern,
-		    const gchar *match_string,
-		    gboolean    *wildcard_reached_p)
+static inline const gchar *
+next_char (const gchar *string,
+           const gchar *string_end)
 {
-  const gchar *pattern, *string;
-  gchar ch;
+  string = g_utf8_next_char (string);
 
-  pattern = match_pattern;
-  string = match_string;
+  return MIN (string, string_end);
+}
 
-  ch = *pattern;
-  pattern++;
-  while (ch)
+/* Matches the remains of the pattern after the last '*' tried so far
+ * and, on a mismatch, lets that '*' take one more character and tries
+ * again.  A later '*' supersedes an earlier one, since anything the
+ * earlier one could still consume can just as well be consumed by the
+ * later one, so there is never more than one position to go back to.
+ */
+static gboolean
+g_pattern_ph_match (const gchar *pattern,
+		    const gchar *string,
+		    const gchar *string_end)
+{
+  const gchar *star_pattern = NULL;
+  const gchar *star_string = NULL;
+
+  while (TRUE)
     {
-      switch (ch)
+      if (*pattern == '*')
 	{
-	case '?':
-	  if (!*string)
-	    return FALSE;
-	  string = g_utf8_next_char (string);
-	  break;
-
-	case '*':
-	  *wildcard_reached_p = TRUE;
-	  do
-	    {
-	      ch = *pattern;
-	      pattern++;
-	      if (ch == '?')
-		{
-		  if (!*string)
-		    return FALSE;
-		  string = g_utf8_next_char (string);
-		}
-	    }
-	  while (ch == '*' || ch == '?');
-	  if (!ch)
+	  star_pattern = ++pattern;
+	  star_string = string;
+	  if (*pattern == 0)
 	    return TRUE;
-	  do
-	    {
-              gboolean next_wildcard_reached = FALSE;
-	      while (ch != *string)
-		{
-		  if (!*string)
-		    return FALSE;
-		  string = g_utf8_next_char (string);
-		}
-	      string++;
-	      if (g_pattern_ph_match (pattern, string, &next_wildcard_reached))
-		return TRUE;
-              if (next_wildcard_reached)
-                /* the forthcoming pattern substring up to the next wildcard has
-                 * been matched, but a mismatch occoured for the rest of the
-                 * pattern, following the next wildcard.
-                 * there's no need to advance the current match position any
-                 * further if the rest pattern will not match.
-                 */
-		return FALSE;
-	    }
-	  while (*string);
-	  break;
+	  continue;
+	}
 
-	default:
-	  if (ch == *string)
-	    string++;
-	  else
+      if (string == string_end)
+	return *pattern == 0;
+
+      if (*pattern == '?')
+	{
+	  pattern++;
+	  string = next_char (string, string_end);
+	  continue;
+	}
+
+      if (*pattern != 0 && *pattern == *string)
+	{
+	  pattern++;
+	  string++;
+	  continue;
+	}
+
+      if (star_pattern == NULL)
+	return FALSE;
+
+      star_string = next_char (star_string, string_end);
+
+      /* a literal after the '*' has to start the next attempt; being
+       * the first byte of a character it can't be found in the middle
+       * of one
+       */
+      if (*star_pattern != '?')
+	{
+	  star_string = memchr (star_string, *star_pattern, string_end - star_string);
+	  if (star_string == NULL)
 	    return FALSE;
-	  break;
 	}
 
-      ch = *pattern;
-      pattern++;
+      pattern = star_pattern;
+      string = star_string;
     }
-
-  return *string == 0;
 }
 
 /**
@@ -165,22 +163,10 @@ g_pattern_ph_match (const gchar *match_pattern,
  * @string_reversed: (nullable): the reverse of @string or %NULL
  *
  * Matches a string against a compiled pattern. Passing the correct
- * length of the string given is mandatory. The reversed string can be
- * omitted by passing %NULL, this is more efficient if the reversed
- * version of the string to be matched is not at hand, as
- * g_pattern_match() will only construct it if the compiled pattern
- * requires reverse matches.
- *
- * Note that, if the user code will (possibly) match a string against a
- * multitude of patterns containing wildcards, chances are high that
- * some patterns will require a reversed string. In this case, it's
- * more efficient to provide the reversed string to avoid multiple
- * constructions thereof in the various calls to g_pattern_match().
- *
- * Note also that the reverse of a UTF-8 encoded string can in general
- * not be obtained by g_strreverse(). This works only if the string
- * does not contain any multibyte characters. GLib offers the
- * g_utf8_strreverse() function to reverse UTF-8 encoded strings.
+ * length of the string given is mandatory.
+ *
+ * Since 2.54 the reversed string is not needed for any kind of
+ * pattern and @string_reversed is ignored; pass %NULL.
  *
  * Returns: %TRUE if @string matches @pspec
  **/
@@ -199,21 +185,10 @@ g_pattern_match (GPatternSpec *pspec,
 
   switch (pspec->match_type)
     {
-      gboolean dummy;
     case G_MATCH_ALL:
-      return g_pattern_ph_match (pspec->pattern, string, &dummy);
+      return g_pattern_ph_match (pspec->pattern, string, string + string_length);
     case G_MATCH_ALL_TAIL:
-      if (string_reversed)
-	return g_pattern_ph_match (pspec->pattern, string_reversed, &dummy);
-      else
-	{
-          gboolean result;
-          gchar *tmp;
-	  tmp = g_utf8_strreverse (string, string_length);
-	  result = g_pattern_ph_match (pspec->pattern, tmp, &dummy);
-	  g_free (tmp);
-	  return result;
-	}
+      return g_pattern_ph_match (pspec->forward_pattern, string, string + string_length);
     case G_MATCH_HEAD:
       if (pspec->pattern_length == string_length)
 	return strcmp (pspec->pattern, string) == 0;
@@ -265,6 +240,7 @@ g_pattern_spec_new (const gchar *pattern)
   pspec->min_length = 0;
   pspec->max_length = 0;
   pspec->pattern = g_new (gchar, pspec->pattern_length + 1);
+  pspec->forward_pattern = NULL;
   d = pspec->pattern;
   for (i = 0, s = pattern; *s != 0; s++)
     {
@@ -346,9 +322,8 @@ g_pattern_spec_new (const gchar *pattern)
   else /* seen_joker */
     pspec->match_type = tj_pos > hj_pos ? G_MATCH_ALL_TAIL : G_MATCH_ALL;
   if (pspec->match_type == G_MATCH_ALL_TAIL) {
-    gchar *tmp = pspec->pattern;
+    pspec->forward_pattern = pspec->pattern;
     pspec->pattern = g_utf8_strreverse (pspec->pattern, pspec->pattern_length);
-    g_free (tmp);
   }
   return pspec;
 }
@@ -365,6 +340,7 @@ g_pattern_spec_free (GPatternSpec *pspec)
   g_return_if_fail (pspec != NULL);
 
   g_free (pspec->pattern);
+  g_free (pspec->forward_pattern);
   g_free (pspec);
 }
 
@@ -395,9 +371,8 @@ g_pattern_spec_equal (GPatternSpec *pspec1,
  * @pspec: a #GPatternSpec
  * @string: the UTF-8 encoded string to match
  *
- * Matches a string against a compiled pattern. If the string is to be
- * matched against more than one pattern, consider using
- * g_pattern_match() instead while supplying the reversed string.
+ * Matches a string against a compiled pattern. If the length of the
+ * string is at hand, g_pattern_match() saves measuring it again.
  *
  * Returns: %TRUE if @string matches @pspec
  **/
@@ -439,3 +414,235 @@ g_pattern_match_simple (const gchar *pattern,
 
   return ergo;
 }
+
+/**
+ * GPatternSet:
+ *
+ * A collection of patterns that a string can be matched against all at
+ * once with g_pattern_set_match(). This structure is opaque and its
+ * fields cannot be accessed directly.
+ *
+ * Since: 2.54
+ */
+
+typedef struct
+{
+  guint       length;
+  GHashTable *suffixes;   /* suffix -> index + 1 */
+} TailBucket;
+
+struct _GPatternSet
+{
+  guint       n_patterns;
+  GHashTable *exact;      /* string -> index + 1 */
+  GArray     *tails;      /* TailBucket, for "*literal" patterns */
+  GPtrArray  *others;     /* GPatternSpec *, in order of addition */
+  GArray     *other_indices;
+};
+
+/**
+ * g_pattern_set_new:
+ *
+ * Creates an empty #GPatternSet.
+ *
+ * Patterns without wildcards and patterns that are a single '*'
+ * followed by literal text, like "*.txt", are kept in hash tables, so
+ * adding many of them costs little when matching. All others are
+ * tried one after the other.
+ *
+ * Returns: a newly-allocated #GPatternSet
+ *
+ * Since: 2.54
+ **/
+GPatternSet *
+g_pattern_set_new (void)
+{
+  GPatternSet *set;
+
+  set = g_new (GPatternSet, 1);
+  set->n_patterns = 0;
+  set->exact = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  set->tails = g_array_new (FALSE, FALSE, sizeof (TailBucket));
+  set->others = g_ptr_array_new_with_free_func ((GDestroyNotify) g_pattern_spec_free);
+  set->other_indices = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  return set;
+}
+
+/**
+ * g_pattern_set_free:
+ * @set: a #GPatternSet
+ *
+ * Frees the memory allocated for @set and its patterns.
+ *
+ * Since: 2.54
+ **/
+void
+g_pattern_set_free (GPatternSet *set)
+{
+  guint i;
+
+  g_return_if_fail (set != NULL);
+
+  for (i = 0; i < set->tails->len; i++)
+    g_hash_table_unref (g_array_index (set->tails, TailBucket, i).suffixes);
+
+  g_hash_table_unref (set->exact);
+  g_array_unref (set->tails);
+  g_ptr_array_unref (set->others);
+  g_array_unref (set->other_indices);
+  g_free (set);
+}
+
+/* keeps the first index a key was added with */
+static void
+add_literal (GHashTable  *table,
+             const gchar *literal,
+             guint        index_)
+{
+  if (!g_hash_table_contains (table, literal))
+    g_hash_table_insert (table, g_strdup (literal), GUINT_TO_POINTER (index_ + 1));
+}
+
+/**
+ * g_pattern_set_add:
+ * @set: a #GPatternSet
+ * @pattern: a zero-terminated UTF-8 encoded pattern
+ *
+ * Adds @pattern to @set. Patterns are numbered from 0 in the order
+ * they are added.
+ *
+ * Returns: the number of @pattern within @set
+ *
+ * Since: 2.54
+ **/
+guint
+g_pattern_set_add (GPatternSet *set,
+                   const gchar *pattern)
+{
+  GPatternSpec *pspec;
+  guint index_;
+  guint i;
+
+  g_return_val_if_fail (set != NULL, 0);
+  g_return_val_if_fail (pattern != NULL, 0);
+
+  index_ = set->n_patterns++;
+  pspec = g_pattern_spec_new (pattern);
+
+  switch (pspec->match_type)
+    {
+    case G_MATCH_EXACT:
+      add_literal (set->exact, pspec->pattern, index_);
+      break;
+
+    case G_MATCH_TAIL:
+      for (i = 0; i < set->tails->len; i++)
+        if (g_array_index (set->tails, TailBucket, i).length == pspec->pattern_length)
+          break;
+
+      if (i == set->tails->len)
+        {
+          TailBucket bucket;
+
+          bucket.length = pspec->pattern_length;
+          bucket.suffixes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+          g_array_append_val (set->tails, bucket);
+        }
+
+      add_literal (g_array_index (set->tails, TailBucket, i).suffixes, pspec->pattern, index_);
+      break;
+
+    default:
+      g_ptr_array_add (set->others, pspec);
+      g_array_append_val (set->other_indices, index_);
+      return index_;
+    }
+
+  g_pattern_spec_free (pspec);
+
+  return index_;
+}
+
+/**
+ * g_pattern_set_match:
+ * @set: a #GPatternSet
+ * @string_length: the length of @string (in bytes, i.e. strlen(),
+ *     not g_utf8_strlen())
+ * @string: the UTF-8 encoded string to match
+ *
+ * Matches a string against all the patterns in @set.
+ *
+ * Returns: the number of the first pattern added to @set that matches
+ *     @string, or -1 if none does
+ *
+ * Since: 2.54
+ **/
+gint
+g_pattern_set_match (GPatternSet *set,
+                     guint        string_length,
+                     const gchar *string)
+{
+  guint best = G_MAXUINT;
+  gpointer found;
+  guint i;
+
+  g_return_val_if_fail (set != NULL, -1);
+  g_return_val_if_fail (string != NULL, -1);
+
+  found = g_hash_table_lookup (set->exact, string);
+  if (found != NULL)
+    best = GPOINTER_TO_UINT (found) - 1;
+
+  for (i = 0; i < set->tails->len; i++)
+    {
+      const TailBucket *bucket = &g_array_index (set->tails, TailBucket, i);
+
+      if (bucket->length > string_length)
+        continue;
+
+      found = g_hash_table_lookup (bucket->suffixes, string + string_length - bucket->length);
+      if (found != NULL)
+        best = MIN (best, GPOINTER_TO_UINT (found) - 1);
+    }
+
+  /* the rest are in order, so stop at the first that couldn't win */
+  for (i = 0; i < set->others->len; i++)
+    {
+      guint index_ = g_array_index (set->other_indices, guint, i);
+
+      if (index_ > best)
+        break;
+
+      if (g_pattern_match (set->others->pdata[i], string_length, string, NULL))
+        {
+          best = index_;
+          break;
+        }
+    }
+
+  return best == G_MAXUINT ? -1 : (gint) best;
+}
+
+/**
+ * g_pattern_set_match_string:
+ * @set: a #GPatternSet
+ * @string: the UTF-8 encoded string to match
+ *
+ * Matches a string against all the patterns in @set, like
+ * g_pattern_set_match().
+ *
+ * Returns: the number of the first pattern added to @set that matches
+ *     @string, or -1 if none does
+ *
+ * Since: 2.54
+ **/
+gint
+g_pattern_set_match_string (GPatternSet *set,
+                            const gchar *string)
+{
+  g_return_val_if_fail (set != NULL, -1);
+  g_return_val_if_fail (string != NULL, -1);
+
+  return g_pattern_set_match (set, strlen (string), string);
+}
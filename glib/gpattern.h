@@ -28,6 +28,7 @@ G_BEGIN_DECLS
 
 
 typedef struct _GPatternSpec    GPatternSpec;
+typedef struct _GPatternSet     GPatternSet;
 
 GLIB_AVAILABLE_IN_ALL
 GPatternSpec* g_pattern_spec_new       (const gchar  *pattern);
@@ -48,6 +49,21 @@ GLIB_AVAILABLE_IN_ALL
 gboolean      g_pattern_match_simple   (const gchar  *pattern,
 					const gchar  *string);
 
+GLIB_AVAILABLE_IN_2_54
+GPatternSet * g_pattern_set_new          (void);
+GLIB_AVAILABLE_IN_2_54
+void          g_pattern_set_free         (GPatternSet  *set);
+GLIB_AVAILABLE_IN_2_54
+guint         g_pattern_set_add          (GPatternSet  *set,
+                                          const gchar  *pattern);
+GLIB_AVAILABLE_IN_2_54
+gint          g_pattern_set_match        (GPatternSet  *set,
+                                          guint         string_length,
+                                          const gchar  *string);
+GLIB_AVAILABLE_IN_2_54
+gint          g_pattern_set_match_string (GPatternSet  *set,
+                                          const gchar  *string);
+
 G_END_DECLS
 
 #endif /* __G_PATTERN_H__ */
@@ -0,0 +1,460 @@
+/*
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the licence, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gpollset.h"
+
+#include "giochannel.h"
+#include "gmem.h"
+#include "gmessages.h"
+#include "gslice.h"
+#include "gstrfuncs.h"
+#include "gtestutils.h"
+
+/*< private >
+ * SECTION:gpollset
+ * @title: GPollSet
+ * @short_description: persistent kernel-side file descriptor set
+ *
+ * #GPollSet wraps the native "register once, wait many times" polling
+ * facility of the operating system (epoll on Linux, kqueue on the BSDs
+ * and macOS).  File descriptors are added to the set once with
+ * g_poll_set_add() and stay registered until g_poll_set_remove() is
+ * called, so the cost of waiting does not depend on the number of file
+ * descriptors being watched.
+ *
+ * The set itself is represented by a single file descriptor which
+ * polls as readable whenever one of the registered file descriptors is
+ * ready.  This means that it can be handed to g_poll() (or any custom
+ * #GPollFunc) along with other #GPollFD records; once it reports
+ * %G_IO_IN, g_poll_set_collect() retrieves the ready file descriptors
+ * without blocking.
+ *
+ * #GMainContext uses this for the file descriptors added with
+ * g_source_add_unix_fd().  On systems without a native facility,
+ * g_poll_set_new() returns %NULL and the caller is expected to fall
+ * back to passing every file descriptor to g_poll().
+ */
+
+#if defined (HAVE_EPOLL_CREATE1)
+
+#include <sys/epoll.h>
+#include <errno.h>
+#include <unistd.h>
+
+struct _GPollSet
+{
+  gint fd;
+
+  struct epoll_event *buffer;
+  gint buffer_size;
+};
+
+static guint32
+events_to_epoll (gushort events)
+{
+  guint32 result = 0;
+
+  if (events & G_IO_IN)
+    result |= EPOLLIN;
+  if (events & G_IO_OUT)
+    result |= EPOLLOUT;
+  if (events & G_IO_PRI)
+    result |= EPOLLPRI;
+
+  /* EPOLLERR and EPOLLHUP are always reported, just like with poll() */
+
+  return result;
+}
+
+static gushort
+epoll_to_events (guint32 events)
+{
+  gushort result = 0;
+
+  if (events & EPOLLIN)
+    result |= G_IO_IN;
+  if (events & EPOLLOUT)
+    result |= G_IO_OUT;
+  if (events & EPOLLPRI)
+    result |= G_IO_PRI;
+  if (events & EPOLLERR)
+    result |= G_IO_ERR;
+  if (events & EPOLLHUP)
+    result |= G_IO_HUP;
+
+  return result;
+}
+
+GPollSet *
+g_poll_set_new (void)
+{
+  GPollSet *set;
+  gint fd;
+
+  fd = epoll_create1 (EPOLL_CLOEXEC);
+  if (fd < 0)
+    return NULL;
+
+  set = g_slice_new0 (GPollSet);
+  set->fd = fd;
+
+  return set;
+}
+
+void
+g_poll_set_free (GPollSet *set)
+{
+  close (set->fd);
+  g_free (set->buffer);
+  g_slice_free (GPollSet, set);
+}
+
+void
+g_poll_set_get_pollfd (GPollSet *set,
+                       GPollFD  *poll_fd)
+{
+  poll_fd->fd = set->fd;
+  poll_fd->events = G_IO_IN;
+  poll_fd->revents = 0;
+}
+
+static gint
+poll_set_ctl (GPollSet *set,
+              gint      op,
+              gint      fd,
+              gushort   events)
+{
+  struct epoll_event ev = { 0, };
+  gint res;
+
+  ev.events = events_to_epoll (events);
+  ev.data.fd = fd;
+
+  do
+    res = epoll_ctl (set->fd, op, fd, &ev);
+  while (G_UNLIKELY (res == -1 && errno == EINTR));
+
+  return res == -1 ? errno : 0;
+}
+
+gboolean
+g_poll_set_add (GPollSet *set,
+                gint      fd,
+                gushort   events)
+{
+  gint err;
+
+  err = poll_set_ctl (set, EPOLL_CTL_ADD, fd, events);
+
+  /* The fd may still be registered if it was closed and reopened (or
+   * dup()ed) without being removed first.
+   */
+  if (err == EEXIST)
+    err = poll_set_ctl (set, EPOLL_CTL_MOD, fd, events);
+
+  /* EPERM is what we get for regular files and other things that
+   * epoll cannot watch; the caller must fall back to poll() for them.
+   */
+  return err == 0;
+}
+
+gboolean
+g_poll_set_modify (GPollSet *set,
+                   gint      fd,
+                   gushort   old_events,
+                   gushort   new_events)
+{
+  gint err;
+
+  err = poll_set_ctl (set, EPOLL_CTL_MOD, fd, new_events);
+
+  /* Closing the fd drops the registration behind our back */
+  if (err == ENOENT)
+    err = poll_set_ctl (set, EPOLL_CTL_ADD, fd, new_events);
+
+  return err == 0;
+}
+
+void
+g_poll_set_remove (GPollSet *set,
+                   gint      fd,
+                   gushort   old_events)
+{
+  /* Errors are expected here if the fd was already closed */
+  poll_set_ctl (set, EPOLL_CTL_DEL, fd, 0);
+}
+
+gint
+g_poll_set_collect (GPollSet *set,
+                    GPollFD  *fds,
+                    gint      n_fds)
+{
+  gint n_ready;
+  gint i;
+
+  if (n_fds > set->buffer_size)
+    {
+      g_free (set->buffer);
+      set->buffer = g_new (struct epoll_event, n_fds);
+      set->buffer_size = n_fds;
+    }
+
+  do
+    n_ready = epoll_wait (set->fd, set->buffer, n_fds, 0);
+  while (G_UNLIKELY (n_ready == -1 && errno == EINTR));
+
+  if (n_ready < 0)
+    {
+      g_warning ("epoll_wait(2) failed due to: %s.", g_strerror (errno));
+      return 0;
+    }
+
+  for (i = 0; i < n_ready; i++)
+    {
+      fds[i].fd = set->buffer[i].data.fd;
+      fds[i].events = 0;
+      fds[i].revents = epoll_to_events (set->buffer[i].events);
+    }
+
+  return n_ready;
+}
+
+#elif defined (HAVE_KQUEUE) && defined (HAVE_KEVENT)
+
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+struct _GPollSet
+{
+  gint fd;
+
+  struct kevent *buffer;
+  gint buffer_size;
+};
+
+GPollSet *
+g_poll_set_new (void)
+{
+  GPollSet *set;
+  gint fd;
+
+  fd = kqueue ();
+  if (fd < 0)
+    return NULL;
+
+  fcntl (fd, F_SETFD, FD_CLOEXEC);
+
+  set = g_slice_new0 (GPollSet);
+  set->fd = fd;
+
+  return set;
+}
+
+void
+g_poll_set_free (GPollSet *set)
+{
+  close (set->fd);
+  g_free (set->buffer);
+  g_slice_free (GPollSet, set);
+}
+
+void
+g_poll_set_get_pollfd (GPollSet *set,
+                       GPollFD  *poll_fd)
+{
+  poll_fd->fd = set->fd;
+  poll_fd->events = G_IO_IN;
+  poll_fd->revents = 0;
+}
+
+/* kqueue has one filter per direction, so a change of the event mask
+ * translates to adding the filters for the newly-set bits and deleting
+ * the ones for the bits that went away.
+ */
+static gboolean
+poll_set_change (GPollSet *set,
+                 gint      fd,
+                 gushort   old_events,
+                 gushort   new_events)
+{
+  struct kevent changes[4];
+  gboolean old_read, new_read, old_write, new_write;
+  gint n_changes = 0;
+  gint res;
+
+  old_read = (old_events & (G_IO_IN | G_IO_PRI)) != 0;
+  new_read = (new_events & (G_IO_IN | G_IO_PRI)) != 0;
+  old_write = (old_events & G_IO_OUT) != 0;
+  new_write = (new_events & G_IO_OUT) != 0;
+
+  if (new_read && !old_read)
+    EV_SET (&changes[n_changes++], fd, EVFILT_READ, EV_ADD, 0, 0, NULL);
+  else if (old_read && !new_read)
+    EV_SET (&changes[n_changes++], fd, EVFILT_READ, EV_DELETE, 0, 0, NULL);
+
+  if (new_write && !old_write)
+    EV_SET (&changes[n_changes++], fd, EVFILT_WRITE, EV_ADD, 0, 0, NULL);
+  else if (old_write && !new_write)
+    EV_SET (&changes[n_changes++], fd, EVFILT_WRITE, EV_DELETE, 0, 0, NULL);
+
+  if (n_changes == 0)
+    return TRUE;
+
+  do
+    res = kevent (set->fd, changes, n_changes, NULL, 0, NULL);
+  while (G_UNLIKELY (res == -1 && errno == EINTR));
+
+  return res != -1;
+}
+
+gboolean
+g_poll_set_add (GPollSet *set,
+                gint      fd,
+                gushort   events)
+{
+  return poll_set_change (set, fd, 0, events);
+}
+
+gboolean
+g_poll_set_modify (GPollSet *set,
+                   gint      fd,
+                   gushort   old_events,
+                   gushort   new_events)
+{
+  return poll_set_change (set, fd, old_events, new_events);
+}
+
+void
+g_poll_set_remove (GPollSet *set,
+                   gint      fd,
+                   gushort   old_events)
+{
+  /* Errors are expected here if the fd was already closed */
+  poll_set_change (set, fd, old_events, 0);
+}
+
+gint
+g_poll_set_collect (GPollSet *set,
+                    GPollFD  *fds,
+                    gint      n_fds)
+{
+  struct timespec zero = { 0, 0 };
+  gint n_ready;
+  gint i;
+
+  if (n_fds > set->buffer_size)
+    {
+      g_free (set->buffer);
+      set->buffer = g_new (struct kevent, n_fds);
+      set->buffer_size = n_fds;
+    }
+
+  do
+    n_ready = kevent (set->fd, NULL, 0, set->buffer, n_fds, &zero);
+  while (G_UNLIKELY (n_ready == -1 && errno == EINTR));
+
+  if (n_ready < 0)
+    {
+      g_warning ("kevent(2) failed due to: %s.", g_strerror (errno));
+      return 0;
+    }
+
+  for (i = 0; i < n_ready; i++)
+    {
+      struct kevent *kev = &set->buffer[i];
+
+      fds[i].fd = kev->ident;
+      fds[i].events = 0;
+      fds[i].revents = 0;
+
+      if (kev->flags & EV_ERROR)
+        fds[i].revents |= G_IO_ERR;
+      else if (kev->filter == EVFILT_READ)
+        fds[i].revents |= G_IO_IN;
+      else if (kev->filter == EVFILT_WRITE)
+        fds[i].revents |= G_IO_OUT;
+
+      if (kev->flags & EV_EOF)
+        fds[i].revents |= G_IO_HUP;
+    }
+
+  return n_ready;
+}
+
+#else
+
+/* No native facility: the main context will poll every fd itself */
+
+GPollSet *
+g_poll_set_new (void)
+{
+  return NULL;
+}
+
+void
+g_poll_set_free (GPollSet *set)
+{
+  g_assert_not_reached ();
+}
+
+void
+g_poll_set_get_pollfd (GPollSet *set,
+                       GPollFD  *poll_fd)
+{
+  g_assert_not_reached ();
+}
+
+gboolean
+g_poll_set_add (GPollSet *set,
+                gint      fd,
+                gushort   events)
+{
+  g_assert_not_reached ();
+}
+
+gboolean
+g_poll_set_modify (GPollSet *set,
+                   gint      fd,
+                   gushort   old_events,
+                   gushort   new_events)
+{
+  g_assert_not_reached ();
+}
+
+void
+g_poll_set_remove (GPollSet *set,
+                   gint      fd,
+                   gushort   old_events)
+{
+  g_assert_not_reached ();
+}
+
+gint
+g_poll_set_collect (GPollSet *set,
+                    GPollFD  *fds,
+                    gint      n_fds)
+{
+  g_assert_not_reached ();
+}
+
+#endif
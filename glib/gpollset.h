@@ -0,0 +1,46 @@
+/*
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the licence, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_POLL_SET_H__
+#define __G_POLL_SET_H__
+
+#include <glib/gpoll.h>
+
+typedef struct _GPollSet GPollSet;
+
+GPollSet *      g_poll_set_new          (void);
+void            g_poll_set_free         (GPollSet *set);
+
+void            g_poll_set_get_pollfd   (GPollSet *set,
+                                         GPollFD  *poll_fd);
+
+gboolean        g_poll_set_add          (GPollSet *set,
+                                         gint      fd,
+                                         gushort   events);
+gboolean        g_poll_set_modify       (GPollSet *set,
+                                         gint      fd,
+                                         gushort   old_events,
+                                         gushort   new_events);
+void            g_poll_set_remove       (GPollSet *set,
+                                         gint      fd,
+                                         gushort   old_events);
+
+gint            g_poll_set_collect      (GPollSet *set,
+                                         GPollFD  *fds,
+                                         gint      n_fds);
+
+#endif
@@ -28,6 +28,8 @@
 #include "gqsort.h"
 
 #include "gtestutils.h"
+#include "gthread.h"
+#include "gthreadpool.h"
 
 /* This file was originally from stdlib/msort.c in gnu libc, just changed
    to build inside glib and to not fall back to an unstable quicksort
@@ -302,3 +304,320 @@ g_qsort_with_data (gconstpointer    pbase,
 {
   msort_r ((gpointer)pbase, total_elems, size, compare_func, user_data);
 }
+
+/* Parallel sorting: the array is cut into one run per thread, the runs
+ * are sorted with msort_r() from a thread pool, and then merged pairwise,
+ * level by level, each merge of a level in a thread of its own.  Merges
+ * take from the left run on ties, so the result stays stable.
+ */
+#define PARALLEL_MIN_RUN 16384
+
+typedef struct
+{
+  GMutex           lock;
+  GCond            cond;
+  guint            pending;
+
+  gsize            s;
+  GCompareDataFunc cmp;
+  gpointer         arg;
+} ParallelSort;
+
+typedef struct
+{
+  ParallelSort *sort;
+  char         *src;
+  char         *dst;            /* NULL to sort src in place */
+  gsize         n1;
+  gsize         n2;
+} ParallelTask;
+
+static void
+parallel_merge (ParallelSort *sort,
+                const char   *b1,
+                gsize         n1,
+                const char   *b2,
+                gsize         n2,
+                char         *dst)
+{
+  const gsize s = sort->s;
+
+  while (n1 > 0 && n2 > 0)
+    {
+      if (sort->cmp (b1, b2, sort->arg) <= 0)
+        {
+          memcpy (dst, b1, s);
+          b1 += s;
+          --n1;
+        }
+      else
+        {
+          memcpy (dst, b2, s);
+          b2 += s;
+          --n2;
+        }
+      dst += s;
+    }
+
+  memcpy (dst, b1, n1 * s);
+  memcpy (dst + n1 * s, b2, n2 * s);
+}
+
+static void
+parallel_sort_task (gpointer data,
+                    gpointer user_data)
+{
+  ParallelTask *task = data;
+  ParallelSort *sort = task->sort;
+
+  if (task->dst == NULL)
+    msort_r (task->src, task->n1, sort->s, sort->cmp, sort->arg);
+  else
+    parallel_merge (sort, task->src, task->n1,
+                    task->src + task->n1 * sort->s, task->n2, task->dst);
+
+  g_mutex_lock (&sort->lock);
+  if (--sort->pending == 0)
+    g_cond_signal (&sort->cond);
+  g_mutex_unlock (&sort->lock);
+}
+
+static void
+parallel_sort_wait (ParallelSort *sort)
+{
+  g_mutex_lock (&sort->lock);
+  while (sort->pending > 0)
+    g_cond_wait (&sort->cond, &sort->lock);
+  g_mutex_unlock (&sort->lock);
+}
+
+/**
+ * g_qsort_with_data_parallel:
+ * @pbase: (not nullable): start of array to sort
+ * @total_elems: elements in the array
+ * @size: size of each element
+ * @compare_func: function to compare elements
+ * @user_data: data to pass to @compare_func
+ *
+ * Sorts an array like g_qsort_with_data(), but uses a thread for each
+ * processor to do so.  The sort is stable too.
+ *
+ * The array is cut into one part for each thread; the parts are sorted
+ * at the same time and then merged.  This needs memory for a copy of
+ * the array.  Arrays of fewer than some ten thousand elements are just
+ * sorted in the calling thread as splitting them up would not pay off.
+ *
+ * @compare_func is called from several threads at the same time, so it
+ * must be thread-safe, as must anything it does with @user_data.
+ *
+ * Since: 2.54
+ */
+void
+g_qsort_with_data_parallel (gconstpointer    pbase,
+                            gsize            total_elems,
+                            gsize            size,
+                            GCompareDataFunc compare_func,
+                            gpointer         user_data)
+{
+  ParallelSort sort;
+  ParallelTask *tasks;
+  GThreadPool *pool;
+  char *buf, *src, *dst;
+  gsize *starts;
+  guint n_runs, n_threads;
+  guint width, i;
+
+  g_return_if_fail (pbase != NULL || total_elems == 0);
+  g_return_if_fail (size > 0);
+  g_return_if_fail (total_elems <= G_MAXSIZE / size);
+
+  n_threads = g_get_num_processors ();
+  for (n_runs = 1; n_runs * 2 <= n_threads && total_elems / (n_runs * 2) >= PARALLEL_MIN_RUN; n_runs *= 2)
+    ;
+
+  if (n_runs == 1)
+    {
+      msort_r ((gpointer) pbase, total_elems, size, compare_func, user_data);
+      return;
+    }
+
+  g_mutex_init (&sort.lock);
+  g_cond_init (&sort.cond);
+  sort.s = size;
+  sort.cmp = compare_func;
+  sort.arg = user_data;
+
+  pool = g_thread_pool_new (parallel_sort_task, NULL, n_runs, FALSE, NULL);
+  tasks = g_new (ParallelTask, n_runs);
+  starts = g_new (gsize, n_runs + 1);
+
+  for (i = 0; i <= n_runs; i++)
+    starts[i] = total_elems * i / n_runs;
+
+  /* sort the runs in place */
+  sort.pending = n_runs;
+  for (i = 0; i < n_runs; i++)
+    {
+      tasks[i].sort = &sort;
+      tasks[i].src = (char *) pbase + starts[i] * size;
+      tasks[i].dst = NULL;
+      tasks[i].n1 = starts[i + 1] - starts[i];
+      tasks[i].n2 = 0;
+      g_thread_pool_push (pool, &tasks[i], NULL);
+    }
+  parallel_sort_wait (&sort);
+
+  /* merge pairs of runs back and forth */
+  buf = g_malloc (total_elems * size);
+  src = (char *) pbase;
+  dst = buf;
+
+  for (width = 1; width < n_runs; width *= 2)
+    {
+      guint n_merges = n_runs / (width * 2);
+      char *swap;
+
+      sort.pending = n_merges;
+      for (i = 0; i < n_merges; i++)
+        {
+          gsize start = starts[i * width * 2];
+          gsize mid = starts[i * width * 2 + width];
+          gsize end = starts[(i + 1) * width * 2];
+
+          tasks[i].src = src + start * size;
+          tasks[i].dst = dst + start * size;
+          tasks[i].n1 = mid - start;
+          tasks[i].n2 = end - mid;
+          g_thread_pool_push (pool, &tasks[i], NULL);
+        }
+      parallel_sort_wait (&sort);
+
+      swap = src;
+      src = dst;
+      dst = swap;
+    }
+
+  if (src != pbase)
+    memcpy ((gpointer) pbase, src, total_elems * size);
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+  g_free (buf);
+  g_free (starts);
+  g_free (tasks);
+  g_cond_clear (&sort.cond);
+  g_mutex_clear (&sort.lock);
+}
+
+/* Least significant digit radix sort, a byte at a time.  The counts for
+ * all the bytes are taken in one pass; bytes that are the same in all
+ * keys are skipped, which leaves just a few passes for keys that only
+ * use a part of their range.
+ */
+#define RADIX_MIN 64
+
+#define DEFINE_RADIX_SORT(type)                                               \
+static void                                                                   \
+radix_sort_##type (type  *array,                                              \
+                   gsize  n)                                                  \
+{                                                                             \
+  gsize (*counts)[256];                                                       \
+  type *src = array, *dst, *tmp;                                              \
+  gsize i;                                                                    \
+  guint byte;                                                                 \
+                                                                              \
+  if (n < RADIX_MIN)                                                          \
+    {                                                                         \
+      /* insertion sort */                                                    \
+      for (i = 1; i < n; i++)                                                 \
+        {                                                                     \
+          type v = array[i];                                                  \
+          gsize j = i;                                                        \
+                                                                              \
+          for (; j > 0 && array[j - 1] > v; j--)                              \
+            array[j] = array[j - 1];                                          \
+          array[j] = v;                                                       \
+        }                                                                     \
+      return;                                                                 \
+    }                                                                         \
+                                                                              \
+  counts = g_malloc0 (sizeof (gsize[256]) * sizeof (type));                   \
+  for (i = 0; i < n; i++)                                                     \
+    for (byte = 0; byte < sizeof (type); byte++)                              \
+      counts[byte][(array[i] >> (byte * 8)) & 0xff]++;                        \
+                                                                              \
+  tmp = dst = g_new (type, n);                                                \
+                                                                              \
+  for (byte = 0; byte < sizeof (type); byte++)                                \
+    {                                                                         \
+      gsize offsets[256];                                                     \
+      gsize pos = 0;                                                          \
+      guint shift = byte * 8;                                                 \
+      type *swap;                                                             \
+                                                                              \
+      if (counts[byte][(src[0] >> shift) & 0xff] == n)                        \
+        continue;                                                             \
+                                                                              \
+      for (i = 0; i < 256; i++)                                               \
+        {                                                                     \
+          offsets[i] = pos;                                                   \
+          pos += counts[byte][i];                                             \
+        }                                                                     \
+                                                                              \
+      for (i = 0; i < n; i++)                                                 \
+        dst[offsets[(src[i] >> shift) & 0xff]++] = src[i];                    \
+                                                                              \
+      swap = src;                                                             \
+      src = dst;                                                              \
+      dst = swap;                                                             \
+    }                                                                         \
+                                                                              \
+  if (src != array)                                                           \
+    memcpy (array, src, n * sizeof (type));                                   \
+                                                                              \
+  g_free (tmp);                                                               \
+  g_free (counts);                                                            \
+}
+
+DEFINE_RADIX_SORT (guint32)
+DEFINE_RADIX_SORT (guint64)
+
+/**
+ * g_sort_uint32:
+ * @array: (array length=n_elements): an array of #guint32
+ * @n_elements: the number of elements in @array
+ *
+ * Sorts an array of unsigned 32-bit integers in ascending order.
+ *
+ * This is much faster than sorting them with g_qsort_with_data() and a
+ * comparison function, since it uses a radix sort that never compares
+ * two elements at all.  It needs memory for a copy of @array.
+ *
+ * Since: 2.54
+ */
+void
+g_sort_uint32 (guint32 *array,
+               gsize    n_elements)
+{
+  g_return_if_fail (array != NULL || n_elements == 0);
+
+  radix_sort_guint32 (array, n_elements);
+}
+
+/**
+ * g_sort_uint64:
+ * @array: (array length=n_elements): an array of #guint64
+ * @n_elements: the number of elements in @array
+ *
+ * Sorts an array of unsigned 64-bit integers in ascending order, like
+ * g_sort_uint32() does for 32-bit integers.
+ *
+ * Since: 2.54
+ */
+void
+g_sort_uint64 (guint64 *array,
+               gsize    n_elements)
+{
+  g_return_if_fail (array != NULL || n_elements == 0);
+
+  radix_sort_guint64 (array, n_elements);
+}
@@ -40,6 +40,20 @@ void g_qsort_with_data (gconstpointer    pbase,
 			GCompareDataFunc compare_func,
 			gpointer         user_data);
 
+GLIB_AVAILABLE_IN_2_54
+void g_qsort_with_data_parallel (gconstpointer    pbase,
+                                 gsize            total_elems,
+                                 gsize            size,
+                                 GCompareDataFunc compare_func,
+                                 gpointer         user_data);
+
+GLIB_AVAILABLE_IN_2_54
+void g_sort_uint32 (guint32 *array,
+                    gsize    n_elements);
+GLIB_AVAILABLE_IN_2_54
+void g_sort_uint64 (guint64 *array,
+                    gsize    n_elements);
+
 G_END_DECLS
 
 #endif /* __G_QSORT_H__ */
@@ -45,20 +45,93 @@
 #define QUARK_BLOCK_SIZE         2048
 #define QUARK_STRING_BLOCK_SIZE (4096 - sizeof (gsize))
 
-static inline GQuark  quark_new (gchar *string);
+static inline GQuark  quark_new (gchar *string,
+                                 guint  hash);
+
+/* The table mapping strings to quarks is read without taking
+ * quark_global.  Quarks are never removed, so a slot only ever goes
+ * from empty to holding a quark, and a bigger table is only published
+ * once it holds all quarks.  Old tables are leaked, like old quarks
+ * arrays, since a reader may still be looking at them.
+ */
+typedef struct
+{
+  guint     hash;
+  gint      quark;      /* atomic, 0 for an empty slot */
+} QuarkSlot;
+
+typedef struct
+{
+  gsize     mask;
+  QuarkSlot slots[1];
+} QuarkTable;
 
 G_LOCK_DEFINE_STATIC (quark_global);
-static GHashTable    *quark_ht = NULL;
+static QuarkTable    *quark_table = NULL;
 static gchar        **quarks = NULL;
 static gint           quark_seq_id = 0;
 static gchar         *quark_block = NULL;
 static gint           quark_block_offset = 0;
 
+static QuarkTable *
+quark_table_new (gsize n_slots)
+{
+  QuarkTable *table;
+
+  table = g_malloc0 (sizeof (QuarkTable) + (n_slots - 1) * sizeof (QuarkSlot));
+  table->mask = n_slots - 1;
+
+  return table;
+}
+
+/* HOLDS: quark_global_lock */
+static void
+quark_table_add (QuarkTable *table,
+                 guint       hash,
+                 GQuark      quark)
+{
+  gsize i = hash & table->mask;
+
+  while (table->slots[i].quark != 0)
+    i = (i + 1) & table->mask;
+
+  /* the hash must be there before a reader can see the quark */
+  table->slots[i].hash = hash;
+  g_atomic_int_set (&table->slots[i].quark, quark);
+}
+
+/* Does not need quark_global */
+static GQuark
+quark_table_lookup (const gchar *string,
+                    guint        hash)
+{
+  QuarkTable *table = g_atomic_pointer_get (&quark_table);
+  gsize i = hash & table->mask;
+
+  for (;;)
+    {
+      GQuark quark = g_atomic_int_get (&table->slots[i].quark);
+
+      if (quark == 0)
+        return 0;
+
+      if (table->slots[i].hash == hash)
+        {
+          gchar **strings = g_atomic_pointer_get (&quarks);
+
+          if (strcmp (strings[quark], string) == 0)
+            return quark;
+        }
+
+      i = (i + 1) & table->mask;
+    }
+}
+
 void
 g_quark_init (void)
 {
   g_assert (quark_seq_id == 0);
-  quark_ht = g_hash_table_new (g_str_hash, g_str_equal);
+  quark_table = quark_table_new (2 * QUARK_BLOCK_SIZE);
   quarks = g_new (gchar*, QUARK_BLOCK_SIZE);
   quarks[0] = NULL;
   quark_seq_id = 1;
@@ -86,6 +159,10 @@ g_quark_init (void)
  * To find the #GQuark corresponding to a given string, use
  * g_quark_try_string().
  *
+ * All of these functions can be called from any thread.  Looking up
+ * a string that already has a #GQuark does not take any lock, so
+ * threads that look up the same strings do not wait for each other.
+ *
  * Another use for the string pool maintained for the quark functions
  * is string interning, using g_intern_string() or
  * g_intern_static_string(). An interned string is a canonical
@@ -132,16 +209,10 @@ g_quark_init (void)
 GQuark
 g_quark_try_string (const gchar *string)
 {
-  GQuark quark = 0;
-
   if (string == NULL)
     return 0;
 
-  G_LOCK (quark_global);
-  quark = GPOINTER_TO_UINT (g_hash_table_lookup (quark_ht, string));
-  G_UNLOCK (quark_global);
-
-  return quark;
+  return quark_table_lookup (string, g_str_hash (string));
 }
 
 /* HOLDS: quark_global_lock */
@@ -172,21 +243,30 @@ quark_strdup (const gchar *string)
   return copy;
 }
 
-/* HOLDS: quark_global_lock */
 static inline GQuark
 quark_from_string (const gchar *string,
                    gboolean     duplicate)
 {
-  GQuark quark = 0;
+  GQuark quark;
+  guint hash;
 
-  quark = GPOINTER_TO_UINT (g_hash_table_lookup (quark_ht, string));
+  /* existing quarks are found without taking the lock */
+  hash = g_str_hash (string);
+  quark = quark_table_lookup (string, hash);
+  if (quark)
+    return quark;
 
+  G_LOCK (quark_global);
+
+  quark = quark_table_lookup (string, hash);
   if (!quark)
     {
-      quark = quark_new (duplicate ? quark_strdup (string) : (gchar *)string);
+      quark = quark_new (duplicate ? quark_strdup (string) : (gchar *)string, hash);
       TRACE(GLIB_QUARK_NEW(string, quark));
     }
 
+  G_UNLOCK (quark_global);
+
   return quark;
 }
 
@@ -208,9 +288,7 @@ g_quark_from_string (const gchar *string)
   if (!string)
     return 0;
 
-  G_LOCK (quark_global);
   quark = quark_from_string (string, TRUE);
-  G_UNLOCK (quark_global);
 
   return quark;
 }
@@ -242,9 +320,7 @@ g_quark_from_static_string (const gchar *string)
   if (!string)
     return 0;
 
-  G_LOCK (quark_global);
   quark = quark_from_string (string, FALSE);
-  G_UNLOCK (quark_global);
 
   return quark;
 }
@@ -275,7 +351,8 @@ g_quark_to_string (GQuark quark)
 
 /* HOLDS: g_quark_global_lock */
 static inline GQuark
-quark_new (gchar *string)
+quark_new (gchar *string,
+           guint  hash)
 {
   GQuark quark;
   gchar **quarks_new;
@@ -295,8 +372,25 @@ quark_new (gchar *string)
 
   quark = quark_seq_id;
   g_atomic_pointer_set (&quarks[quark], string);
-  g_hash_table_insert (quark_ht, string, GUINT_TO_POINTER (quark));
+
+  /* keep the table at most half full */
+  if ((gsize) quark >= (quark_table->mask + 1) / 2)
+    {
+      QuarkTable *table = quark_table_new (2 * (quark_table->mask + 1));
+      gsize i;
+
+      for (i = 0; i <= quark_table->mask; i++)
+        if (quark_table->slots[i].quark != 0)
+          quark_table_add (table, quark_table->slots[i].hash, quark_table->slots[i].quark);
+
+      g_atomic_pointer_set (&quark_table, table);
+    }
+
+  /* publish the quark last, so that g_quark_to_string() works for
+   * anyone who can find it
+   */
   g_atomic_int_inc (&quark_seq_id);
+  quark_table_add (quark_table, hash, quark);
 
   return quark;
 }
@@ -322,10 +416,8 @@ g_intern_string (const gchar *string)
   if (!string)
     return NULL;
 
-  G_LOCK (quark_global);
   quark = quark_from_string (string, TRUE);
-  result = quarks[quark];
-  G_UNLOCK (quark_global);
+  result = g_quark_to_string (quark);
 
   return result;
 }
@@ -352,10 +444,8 @@ g_intern_static_string (const gchar *string)
   if (!string)
     return NULL;
 
-  G_LOCK (quark_global);
   quark = quark_from_string (string, FALSE);
-  result = quarks[quark];
-  G_UNLOCK (quark_global);
+  result = g_quark_to_string (quark);
 
   return result;
 }
@@ -108,6 +108,28 @@
  * environment variable `G_RANDOM_VERSION` to the value of '2.0'.
  * Use the GLib-2.0 algorithms only if you have sequences of numbers
  * generated with Glib-2.0 that you need to reproduce exactly.
+ *
+ * Since GLib 2.54, a #GRand can also use the xoshiro256** generator
+ * instead, see g_rand_new_with_algorithm().  It is considerably faster
+ * and its state is much smaller, but it produces different sequences
+ * for the same seed.
+ *
+ * The g_random_* functions use a separate #GRand for each thread, so
+ * they can be called from many threads at once without contention.
+ * Each of these is seeded from a shared generator the first time it
+ * is used, and again after g_random_set_seed().
+ */
+
+/**
+ * GRandAlgorithm:
+ * @G_RAND_ALGORITHM_MT19937: the Mersenne Twister, as used by
+ *     g_rand_new()
+ * @G_RAND_ALGORITHM_XOSHIRO256: xoshiro256** by David Blackman and
+ *     Sebastiano Vigna, seeded with SplitMix64
+ *
+ * The algorithm used by a #GRand.
+ *
+ * Since: 2.54
  */
 
 /**
@@ -162,10 +184,70 @@ get_random_version (void)
 
 struct _GRand
 {
+  GRandAlgorithm algorithm;
+
+  guint64 xs[4]; /* the xoshiro256** state */
+
   guint32 mt[N]; /* the array for the state vector  */
   guint mti; 
 };
 
+static inline guint64
+rotl64 (guint64 x,
+        gint    k)
+{
+  return (x << k) | (x >> (64 - k));
+}
+
+static guint64
+splitmix64 (guint64 *x)
+{
+  guint64 z = (*x += G_GUINT64_CONSTANT (0x9e3779b97f4a7c15));
+
+  z = (z ^ (z >> 30)) * G_GUINT64_CONSTANT (0xbf58476d1ce4e5b9);
+  z = (z ^ (z >> 27)) * G_GUINT64_CONSTANT (0x94d049bb133111eb);
+
+  return z ^ (z >> 31);
+}
+
+static void
+xoshiro_set_seed_array (GRand         *rand,
+                        const guint32 *seed,
+                        guint          seed_length)
+{
+  guint64 x = 0;
+  guint i;
+
+  /* Fold the whole seed into one word, then expand it; this never
+   * produces the all-zero state in practice.
+   */
+  for (i = 0; i < seed_length; i++)
+    {
+      x ^= seed[i];
+      x = splitmix64 (&x);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (rand->xs); i++)
+    rand->xs[i] = splitmix64 (&x);
+}
+
+static inline guint64
+xoshiro_next (GRand *rand)
+{
+  guint64 *s = rand->xs;
+  guint64 result = rotl64 (s[1] * 5, 7) * 9;
+  guint64 t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl64 (s[3], 45);
+
+  return result;
+}
+
 /**
  * g_rand_new_with_seed:
  * @seed: a value to initialize the random number generator
@@ -203,21 +285,9 @@ g_rand_new_with_seed_array (const guint32 *seed,
   return rand;
 }
 
-/**
- * g_rand_new:
- * 
- * Creates a new random number generator initialized with a seed taken
- * either from `/dev/urandom` (if existing) or from the current time
- * (as a fallback).
- *
- * On Windows, the seed is taken from rand_s().
- * 
- * Returns: the new #GRand
- */
-GRand* 
-g_rand_new (void)
+static void
+get_random_seed (guint32 seed[4])
 {
-  guint32 seed[4];
 #ifdef G_OS_UNIX
   static gboolean dev_urandom_exists = TRUE;
   GTimeVal now;
@@ -240,7 +310,7 @@ g_rand_new (void)
 	  do
 	    {
 	      errno = 0;
-	      r = fread (seed, sizeof (seed), 1, dev_urandom);
+	      r = fread (seed, 4 * sizeof (guint32), 1, dev_urandom);
 	    }
 	  while G_UNLIKELY (errno == EINTR);
 
@@ -268,7 +338,7 @@ g_rand_new (void)
 #if (defined(_MSC_VER) && _MSC_VER >= 1400) || defined(__MINGW64_VERSION_MAJOR)
   gint i;
 
-  for (i = 0; i < G_N_ELEMENTS (seed); i++)
+  for (i = 0; i < 4; i++)
     rand_s (&seed[i]);
 #else
 #warning Using insecure seed for random number generation because of missing rand_s() in Windows XP
@@ -282,8 +352,56 @@ g_rand_new (void)
 #endif
 
 #endif
+}
 
-  return g_rand_new_with_seed_array (seed, 4);
+/**
+ * g_rand_new:
+ * 
+ * Creates a new random number generator initialized with a seed taken
+ * either from `/dev/urandom` (if existing) or from the current time
+ * (as a fallback).
+ *
+ * On Windows, the seed is taken from rand_s().
+ * 
+ * Returns: the new #GRand
+ */
+GRand* 
+g_rand_new (void)
+{
+  return g_rand_new_with_algorithm (G_RAND_ALGORITHM_MT19937);
+}
+
+/**
+ * g_rand_new_with_algorithm:
+ * @algorithm: the #GRandAlgorithm to use
+ *
+ * Creates a new random number generator using @algorithm, initialized
+ * with a seed taken from the same sources as g_rand_new().
+ *
+ * All the other g_rand_* functions, including the ones that set the
+ * seed, work with either algorithm.  The same seed gives a different
+ * sequence with each algorithm.
+ *
+ * Returns: the new #GRand
+ *
+ * Since: 2.54
+ */
+GRand*
+g_rand_new_with_algorithm (GRandAlgorithm algorithm)
+{
+  GRand *rand;
+  guint32 seed[4];
+
+  g_return_val_if_fail (algorithm == G_RAND_ALGORITHM_MT19937 ||
+                        algorithm == G_RAND_ALGORITHM_XOSHIRO256, NULL);
+
+  get_random_seed (seed);
+
+  rand = g_new0 (GRand, 1);
+  rand->algorithm = algorithm;
+  g_rand_set_seed_array (rand, seed, 4);
+
+  return rand;
 }
 
 /**
@@ -338,6 +456,12 @@ g_rand_set_seed (GRand   *rand,
 {
   g_return_if_fail (rand != NULL);
 
+  if (rand->algorithm == G_RAND_ALGORITHM_XOSHIRO256)
+    {
+      xoshiro_set_seed_array (rand, &seed, 1);
+      return;
+    }
+
   switch (get_random_version ())
     {
     case 20:
@@ -393,6 +517,12 @@ g_rand_set_seed_array (GRand         *rand,
   g_return_if_fail (rand != NULL);
   g_return_if_fail (seed_length >= 1);
 
+  if (rand->algorithm == G_RAND_ALGORITHM_XOSHIRO256)
+    {
+      xoshiro_set_seed_array (rand, seed, seed_length);
+      return;
+    }
+
   g_rand_set_seed (rand, 19650218UL);
 
   i=1; j=0;
@@ -456,6 +586,9 @@ g_rand_int (GRand *rand)
 
   g_return_val_if_fail (rand != NULL, 0);
 
+  if (rand->algorithm == G_RAND_ALGORITHM_XOSHIRO256)
+    return xoshiro_next (rand) >> 32;
+
   if (rand->mti >= N) { /* generate N words at one time */
     int kk;
     
@@ -582,9 +715,17 @@ g_rand_int_range (GRand  *rand,
 gdouble 
 g_rand_double (GRand *rand)
 {    
+  gdouble retval;
+
+  if (rand->algorithm == G_RAND_ALGORITHM_XOSHIRO256)
+    {
+      /* 53 bits from a single step; this is always < 1 */
+      return (xoshiro_next (rand) >> 11) * (1.0 / G_GUINT64_CONSTANT (9007199254740992));
+    }
+
   /* We set all 52 bits after the point for this, not only the first
      32. Thats why we need two calls to g_rand_int */
-  gdouble retval = g_rand_int (rand) * G_RAND_DOUBLE_TRANSFORM;
+  retval = g_rand_int (rand) * G_RAND_DOUBLE_TRANSFORM;
   retval = (retval + g_rand_int (rand)) * G_RAND_DOUBLE_TRANSFORM;
 
   /* The following might happen due to very bad rounding luck, but
@@ -618,16 +759,126 @@ g_rand_double_range (GRand   *rand,
   return r * end - (r - 1) * begin;
 }
 
-static GRand *
-get_global_random (void)
+/**
+ * g_rand_fill:
+ * @rand_: a #GRand
+ * @buffer: (out caller-allocates) (array length=length) (element-type guint8):
+ *     the buffer to fill
+ * @length: the size of @buffer, in bytes
+ *
+ * Fills @buffer with random bytes from @rand_.
+ *
+ * This is much faster than filling it with repeated calls to
+ * g_rand_int(), and produces the same bytes on all platforms for a
+ * given seed.
+ *
+ * Since: 2.54
+ */
+void
+g_rand_fill (GRand    *rand,
+             gpointer  buffer,
+             gsize     length)
+{
+  guint8 *dest = buffer;
+
+  g_return_if_fail (rand != NULL);
+  g_return_if_fail (buffer != NULL || length == 0);
+
+  if (rand->algorithm == G_RAND_ALGORITHM_XOSHIRO256)
+    {
+      guint64 r;
+
+      for (; length >= sizeof r; length -= sizeof r, dest += sizeof r)
+        {
+          r = GUINT64_TO_LE (xoshiro_next (rand));
+          memcpy (dest, &r, sizeof r);
+        }
+
+      if (length > 0)
+        {
+          r = GUINT64_TO_LE (xoshiro_next (rand));
+          memcpy (dest, &r, length);
+        }
+    }
+  else
+    {
+      guint32 r;
+
+      for (; length >= sizeof r; length -= sizeof r, dest += sizeof r)
+        {
+          r = GUINT32_TO_LE (g_rand_int (rand));
+          memcpy (dest, &r, sizeof r);
+        }
+
+      if (length > 0)
+        {
+          r = GUINT32_TO_LE (g_rand_int (rand));
+          memcpy (dest, &r, length);
+        }
+    }
+}
+
+/* The generator that seeds the per-thread ones; protected by the lock */
+static GRand *global_random;
+/* Bumped by g_random_set_seed(), to make every thread reseed */
+static gint global_random_generation;
+
+typedef struct
+{
+  GRand *rand;
+  gint   generation;
+} ThreadRandom;
+
+static void
+thread_random_free (gpointer data)
+{
+  ThreadRandom *thread_random = data;
+
+  g_rand_free (thread_random->rand);
+  g_free (thread_random);
+}
+
+static GPrivate thread_random_private = G_PRIVATE_INIT (thread_random_free);
+
+static ThreadRandom *
+get_thread_random (void)
 {
-  static GRand *global_random;
+  ThreadRandom *thread_random = g_private_get (&thread_random_private);
+
+  if G_UNLIKELY (thread_random == NULL ||
+                 thread_random->generation != g_atomic_int_get (&global_random_generation))
+    {
+      guint32 seed[4];
+      gint generation;
+      guint i;
+
+      G_LOCK (global_random);
+      if (!global_random)
+        global_random = g_rand_new ();
+      for (i = 0; i < G_N_ELEMENTS (seed); i++)
+        seed[i] = g_rand_int (global_random);
+      generation = global_random_generation;
+      G_UNLOCK (global_random);
+
+      if (thread_random == NULL)
+        {
+          thread_random = g_new (ThreadRandom, 1);
+          thread_random->rand = g_rand_new_with_seed_array (seed, G_N_ELEMENTS (seed));
+          g_private_set (&thread_random_private, thread_random);
+        }
+      else
+        g_rand_set_seed_array (thread_random->rand, seed, G_N_ELEMENTS (seed));
 
-  /* called while locked */
-  if (!global_random)
-    global_random = g_rand_new ();
+      thread_random->generation = generation;
+    }
+
+  return thread_random;
+}
 
-  return global_random;
+static GRand *
+get_global_random (void)
+{
+  return get_thread_random ()->rand;
 }
 
 /**
@@ -649,11 +900,7 @@ get_global_random (void)
 guint32
 g_random_int (void)
 {
-  guint32 result;
-  G_LOCK (global_random);
-  result = g_rand_int (get_global_random ());
-  G_UNLOCK (global_random);
-  return result;
+  return g_rand_int (get_global_random ());
 }
 
 /**
@@ -670,11 +917,7 @@ gint32
 g_random_int_range (gint32 begin,
                     gint32 end)
 {
-  gint32 result;
-  G_LOCK (global_random);
-  result = g_rand_int_range (get_global_random (), begin, end);
-  G_UNLOCK (global_random);
-  return result;
+  return g_rand_int_range (get_global_random (), begin, end);
 }
 
 /**
@@ -687,11 +930,7 @@ g_random_int_range (gint32 begin,
 gdouble 
 g_random_double (void)
 {
-  double result;
-  G_LOCK (global_random);
-  result = g_rand_double (get_global_random ());
-  G_UNLOCK (global_random);
-  return result;
+  return g_rand_double (get_global_random ());
 }
 
 /**
@@ -708,11 +947,24 @@ gdouble
 g_random_double_range (gdouble begin,
                        gdouble end)
 {
-  double result;
-  G_LOCK (global_random);
-  result = g_rand_double_range (get_global_random (), begin, end);
-  G_UNLOCK (global_random);
-  return result;
+  return g_rand_double_range (get_global_random (), begin, end);
+}
+
+/**
+ * g_random_fill:
+ * @buffer: (out caller-allocates) (array length=length) (element-type guint8):
+ *     the buffer to fill
+ * @length: the size of @buffer, in bytes
+ *
+ * Fills @buffer with random bytes, see g_rand_fill().
+ *
+ * Since: 2.54
+ */
+void
+g_random_fill (gpointer buffer,
+               gsize    length)
+{
+  g_rand_fill (get_global_random (), buffer, length);
 }
 
 /**
@@ -725,7 +977,18 @@ g_random_double_range (gdouble begin,
 void
 g_random_set_seed (guint32 seed)
 {
+  ThreadRandom *thread_random = get_thread_random ();
+  gint generation;
+
+  /* Other threads reseed from the shared generator the next time they
+   * use theirs; this thread gets exactly the sequence for @seed.
+   */
   G_LOCK (global_random);
-  g_rand_set_seed (get_global_random (), seed);
+  g_rand_set_seed_array (global_random, &seed, 1);
+  generation = global_random_generation + 1;
+  g_atomic_int_set (&global_random_generation, generation);
   G_UNLOCK (global_random);
+
+  g_rand_set_seed (thread_random->rand, seed);
+  thread_random->generation = generation;
 }
@@ -35,6 +35,12 @@ G_BEGIN_DECLS
 
 typedef struct _GRand           GRand;
 
+typedef enum
+{
+  G_RAND_ALGORITHM_MT19937,
+  G_RAND_ALGORITHM_XOSHIRO256
+} GRandAlgorithm;
+
 /* GRand - a good and fast random number generator: Mersenne Twister
  * see http://www.math.sci.hiroshima-u.ac.jp/~m-mat/MT/emt.html for more info.
  * The range functions return a value in the intervall [begin, end).
@@ -51,6 +57,8 @@ GRand*  g_rand_new_with_seed_array (const guint32 *seed,
 				    guint seed_length);
 GLIB_AVAILABLE_IN_ALL
 GRand*  g_rand_new            (void);
+GLIB_AVAILABLE_IN_2_54
+GRand*  g_rand_new_with_algorithm (GRandAlgorithm algorithm);
 GLIB_AVAILABLE_IN_ALL
 void    g_rand_free           (GRand   *rand_);
 GLIB_AVAILABLE_IN_ALL
@@ -77,6 +85,10 @@ GLIB_AVAILABLE_IN_ALL
 gdouble g_rand_double_range   (GRand   *rand_,
 			       gdouble  begin,
 			       gdouble  end);
+GLIB_AVAILABLE_IN_2_54
+void    g_rand_fill           (GRand   *rand_,
+			       gpointer buffer,
+			       gsize    length);
 GLIB_AVAILABLE_IN_ALL
 void    g_random_set_seed     (guint32  seed);
 
@@ -92,6 +104,9 @@ gdouble g_random_double       (void);
 GLIB_AVAILABLE_IN_ALL
 gdouble g_random_double_range (gdouble  begin,
 			       gdouble  end);
+GLIB_AVAILABLE_IN_2_54
+void    g_random_fill         (gpointer buffer,
+			       gsize    length);
 
 
 G_END_DECLS
@@ -0,0 +1,425 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "grefstring.h"
+
+#include "gatomic.h"
+#include "ghash.h"
+#include "ghashprivate.h"
+#include "gmem.h"
+#include "gmessages.h"
+#include "gtestutils.h"
+#include "gthread.h"
+
+#include <string.h>
+
+/**
+ * SECTION:refstring
+ * @title: Reference counted strings
+ * @short_description: strings with reference counting, and interned
+ *     strings that are freed when no longer used
+ * @see_also: g_intern_string()
+ *
+ * Reference counted strings are normal C strings that have been
+ * augmented with a reference counter, their length and their hash
+ * value.  They can be passed to any function that takes a C string,
+ * but must be released with g_ref_string_release() instead of g_free().
+ *
+ * g_ref_string_new_intern() returns the same string for equal
+ * contents for as long as some reference to it is held, so interned
+ * strings can be compared by their address.  Unlike the strings
+ * returned by g_intern_string(), they are freed when the last
+ * reference is released, so interning a large number of short-lived
+ * strings does not leak.  Interning is safe to do from any number of
+ * threads: the table of interned strings is split into shards with a
+ * lock of their own, and looking up a string that is already interned
+ * only takes a read lock.
+ *
+ * g_ref_string_hash() and g_ref_string_equal() can be used as the
+ * hash and equality functions of a #GHashTable whose keys are
+ * reference counted strings.  The hash is computed only once, when
+ * the string is created, and interned strings are compared by their
+ * address.
+ *
+ * Since: 2.54
+ */
+
+/**
+ * GRefString:
+ *
+ * A typedef for a reference counted string.  A pointer to a #GRefString
+ * can be treated like a standard `char*` array by all code, but can
+ * additionally have `g_ref_string_*()` methods called on it.  This type
+ * exists so that g_autoptr() can be used on it.
+ *
+ * Since: 2.54
+ */
+
+typedef struct
+{
+  gsize    len;
+  guint    hash;
+  gint     ref_count;   /* atomic */
+  gboolean interned;
+} GRefStringHeader;
+
+#define REF_STRING_HEADER(str) ((GRefStringHeader *) (str) - 1)
+
+/* Each shard has a cache line of its own, so that threads interning
+ * different strings don't fight over the locks.
+ */
+#define N_INTERN_SHARDS_SHIFT 5
+#define N_INTERN_SHARDS       (1 << N_INTERN_SHARDS_SHIFT)
+
+typedef union
+{
+  struct
+  {
+    GRWLock     lock;
+    GHashTable *table;
+  } s;
+  gchar padding[64];
+} InternShard;
+
+static InternShard intern_shards[N_INTERN_SHARDS];
+
+static InternShard *
+get_intern_shard (guint hash)
+{
+  static gsize initialised;
+
+  if (g_once_init_enter (&initialised))
+    {
+      gint i;
+
+      for (i = 0; i < N_INTERN_SHARDS; i++)
+        intern_shards[i].s.table = g_hash_table_new (g_str_hash, g_str_equal);
+
+      g_once_init_leave (&initialised, 1);
+    }
+
+  return &intern_shards[(hash * 0x9e3779b1u) >> (32 - N_INTERN_SHARDS_SHIFT)];
+}
+
+static char *
+ref_string_new (const char *str,
+                gsize       len,
+                guint       hash,
+                gboolean    interned)
+{
+  GRefStringHeader *header;
+  char *res;
+
+  header = g_malloc (sizeof (GRefStringHeader) + len + 1);
+  header->len = len;
+  header->hash = hash;
+  header->ref_count = 1;
+  header->interned = interned;
+
+  res = (char *) (header + 1);
+  memcpy (res, str, len);
+  res[len] = '\0';
+
+  return res;
+}
+
+/* Takes a reference to an interned string found in the table, unless
+ * its last reference is being released right now.
+ */
+static gboolean
+ref_string_acquire_if_alive (char *str)
+{
+  GRefStringHeader *header = REF_STRING_HEADER (str);
+  gint old;
+
+  do
+    {
+      old = g_atomic_int_get (&header->ref_count);
+      if (old == 0)
+        return FALSE;
+    }
+  while (!g_atomic_int_compare_and_exchange (&header->ref_count, old, old + 1));
+
+  return TRUE;
+}
+
+/**
+ * g_ref_string_new:
+ * @str: (not nullable): a NUL-terminated string
+ *
+ * Creates a new reference counted string and copies the contents of
+ * @str into it.
+ *
+ * Returns: (transfer full) (not nullable): the newly created reference
+ *     counted string
+ *
+ * Since: 2.54
+ */
+char *
+g_ref_string_new (const char *str)
+{
+  g_return_val_if_fail (str != NULL, NULL);
+
+  return g_ref_string_new_len (str, -1);
+}
+
+/**
+ * g_ref_string_new_len:
+ * @str: (not nullable): a string
+ * @len: length of @str to use, or -1 if @str is nul-terminated
+ *
+ * Creates a new reference counted string and copies the contents of
+ * @str into it, up to @len bytes.
+ *
+ * Since this function does not stop at nul bytes, it is the caller's
+ * responsibility to ensure that @str has at least @len addressable
+ * bytes.
+ *
+ * Returns: (transfer full) (not nullable): the newly created reference
+ *     counted string
+ *
+ * Since: 2.54
+ */
+char *
+g_ref_string_new_len (const char *str,
+                      gssize      len)
+{
+  const char *p;
+  guint32 hash = 5381;
+  gsize i;
+
+  g_return_val_if_fail (str != NULL, NULL);
+
+  if (len < 0)
+    len = strlen (str);
+
+  /* the same hash as g_str_hash(), over all @len bytes */
+  for (p = str, i = 0; i < (gsize) len; p++, i++)
+    hash = (hash << 5) + hash + (signed char) *p;
+
+  return ref_string_new (str, len, hash, FALSE);
+}
+
+/**
+ * g_ref_string_new_intern:
+ * @str: (not nullable): a NUL-terminated string
+ *
+ * Creates a new reference counted string and copies the content of
+ * @str into it.
+ *
+ * If you call this function multiple times with the same @str, or
+ * with the same contents of @str, it will return a new reference,
+ * instead of creating a new string, for as long as the string is
+ * alive.  Interned strings can therefore be compared with `==`.
+ *
+ * This function can be called from any thread.
+ *
+ * Returns: (transfer full) (not nullable): the newly created reference
+ *     counted string, or a new reference to an existing string
+ *
+ * Since: 2.54
+ */
+char *
+g_ref_string_new_intern (const char *str)
+{
+  InternShard *shard;
+  guint hash;
+  char *res;
+
+  g_return_val_if_fail (str != NULL, NULL);
+
+  hash = g_str_hash (str);
+  shard = get_intern_shard (hash);
+
+  g_rw_lock_reader_lock (&shard->s.lock);
+  res = g_hash_table_lookup_hashed (shard->s.table, str, hash);
+  if (res != NULL && !ref_string_acquire_if_alive (res))
+    res = NULL;
+  g_rw_lock_reader_unlock (&shard->s.lock);
+
+  if (res != NULL)
+    return res;
+
+  g_rw_lock_writer_lock (&shard->s.lock);
+
+  res = g_hash_table_lookup_hashed (shard->s.table, str, hash);
+  if (res == NULL || !ref_string_acquire_if_alive (res))
+    {
+      /* This replaces a string whose last reference is being released;
+       * g_ref_string_release() only removes the string it frees.
+       */
+      res = ref_string_new (str, strlen (str), hash, TRUE);
+      g_hash_table_replace_hashed (shard->s.table, res, res, hash);
+    }
+
+  g_rw_lock_writer_unlock (&shard->s.lock);
+
+  return res;
+}
+
+/**
+ * g_ref_string_acquire:
+ * @str: a reference counted string
+ *
+ * Acquires a reference on a string.
+ *
+ * Returns: the given string, with its reference count increased
+ *
+ * Since: 2.54
+ */
+char *
+g_ref_string_acquire (char *str)
+{
+  g_return_val_if_fail (str != NULL, NULL);
+
+  g_atomic_int_inc (&REF_STRING_HEADER (str)->ref_count);
+
+  return str;
+}
+
+/**
+ * g_ref_string_release:
+ * @str: a reference counted string
+ *
+ * Releases a reference on a string; if it was the last reference, the
+ * resources allocated by the string are freed as well.
+ *
+ * Since: 2.54
+ */
+void
+g_ref_string_release (char *str)
+{
+  GRefStringHeader *header;
+  InternShard *shard;
+  gpointer orig_key, value;
+
+  g_return_if_fail (str != NULL);
+
+  header = REF_STRING_HEADER (str);
+
+  if (!g_atomic_int_dec_and_test (&header->ref_count))
+    return;
+
+  if (header->interned)
+    {
+      shard = get_intern_shard (header->hash);
+
+      g_rw_lock_writer_lock (&shard->s.lock);
+      if (g_hash_table_lookup_hashed (shard->s.table, str, header->hash) == str)
+        g_hash_table_steal_hashed (shard->s.table, str, header->hash, &orig_key, &value);
+      g_rw_lock_writer_unlock (&shard->s.lock);
+    }
+
+  g_free (header);
+}
+
+/**
+ * g_ref_string_length:
+ * @str: a reference counted string
+ *
+ * Retrieves the length of @str.  This does not need to scan the
+ * string.
+ *
+ * Returns: the length of the given string, in bytes
+ *
+ * Since: 2.54
+ */
+gsize
+g_ref_string_length (char *str)
+{
+  g_return_val_if_fail (str != NULL, 0);
+
+  return REF_STRING_HEADER (str)->len;
+}
+
+/**
+ * g_ref_string_is_interned:
+ * @str: a reference counted string
+ *
+ * Checks whether @str was created with g_ref_string_new_intern().
+ *
+ * Returns: %TRUE if @str is interned
+ *
+ * Since: 2.54
+ */
+gboolean
+g_ref_string_is_interned (char *str)
+{
+  g_return_val_if_fail (str != NULL, FALSE);
+
+  return REF_STRING_HEADER (str)->interned;
+}
+
+/**
+ * g_ref_string_hash:
+ * @str: (type utf8): a reference counted string
+ *
+ * Returns the hash value of a reference counted string, for use as
+ * the #GHashFunc of a #GHashTable whose keys are reference counted
+ * strings.
+ *
+ * The value is computed once, when the string is created.  It is the
+ * same value that g_str_hash() returns for the string, as long as the
+ * string contains no nul bytes.
+ *
+ * Returns: the hash value of @str
+ *
+ * Since: 2.54
+ */
+guint
+g_ref_string_hash (gconstpointer str)
+{
+  return REF_STRING_HEADER (str)->hash;
+}
+
+/**
+ * g_ref_string_equal:
+ * @str1: (type utf8): a reference counted string
+ * @str2: (type utf8): another reference counted string
+ *
+ * Compares two reference counted strings for byte-by-byte equality,
+ * for use as the #GEqualFunc of a #GHashTable whose keys are
+ * reference counted strings.
+ *
+ * Two interned strings are compared by their address only.  Other
+ * strings are compared by length and hash value before their
+ * contents are.
+ *
+ * Returns: %TRUE if the two strings match
+ *
+ * Since: 2.54
+ */
+gboolean
+g_ref_string_equal (gconstpointer str1,
+                    gconstpointer str2)
+{
+  GRefStringHeader *h1 = REF_STRING_HEADER (str1);
+  GRefStringHeader *h2 = REF_STRING_HEADER (str2);
+
+  if (str1 == str2)
+    return TRUE;
+
+  if (h1->interned && h2->interned)
+    return FALSE;
+
+  return h1->len == h2->len &&
+         h1->hash == h2->hash &&
+         memcmp (str1, str2, h1->len) == 0;
+}
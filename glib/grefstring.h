@@ -0,0 +1,57 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_REF_STRING_H__
+#define __G_REF_STRING_H__
+
+#if !defined (__GLIB_H_INSIDE__) && !defined (GLIB_COMPILATION)
+#error "Only <glib.h> can be included directly."
+#endif
+
+#include <glib/gtypes.h>
+
+G_BEGIN_DECLS
+
+typedef char GRefString;
+
+GLIB_AVAILABLE_IN_2_54
+char *   g_ref_string_new         (const char    *str);
+GLIB_AVAILABLE_IN_2_54
+char *   g_ref_string_new_len     (const char    *str,
+                                   gssize         len);
+GLIB_AVAILABLE_IN_2_54
+char *   g_ref_string_new_intern  (const char    *str);
+
+GLIB_AVAILABLE_IN_2_54
+char *   g_ref_string_acquire     (char          *str);
+GLIB_AVAILABLE_IN_2_54
+void     g_ref_string_release     (char          *str);
+
+GLIB_AVAILABLE_IN_2_54
+gsize    g_ref_string_length      (char          *str);
+GLIB_AVAILABLE_IN_2_54
+gboolean g_ref_string_is_interned (char          *str);
+GLIB_AVAILABLE_IN_2_54
+guint    g_ref_string_hash        (gconstpointer  str);
+GLIB_AVAILABLE_IN_2_54
+gboolean g_ref_string_equal       (gconstpointer  str1,
+                                   gconstpointer  str2);
+
+G_END_DECLS
+
+#endif /* __G_REF_STRING_H__ */
@@ -31,8 +31,10 @@
 #include "gtypes.h"
 #include "gregex.h"
 #include "glibintl.h"
+#include "ghash.h"
 #include "glist.h"
 #include "gmessages.h"
+#include "gqueue.h"
 #include "gstrfuncs.h"
 #include "gatomic.h"
 #include "gthread.h"
@@ -226,6 +228,18 @@ struct _GRegex
   pcre_extra *extra;            /* data stored when G_REGEX_OPTIMIZE is used */
 };
 
+/* JIT stacks grow up to this size before matching fails with
+ * PCRE_ERROR_JIT_STACKLIMIT; the default 32k one is too small for
+ * patterns that backtrack over long lines.
+ */
+#define JIT_STACK_MIN (32 * 1024)
+#define JIT_STACK_MAX (512 * 1024)
+
+/* Number of patterns g_regex_match_simple() and g_regex_split_simple()
+ * keep compiled.
+ */
+#define REGEX_CACHE_SIZE 64
+
 /* TRUE if ret is an error code, FALSE otherwise. */
 #define IS_PCRE_ERROR(ret) ((ret) < PCRE_ERROR_NOMATCH && (ret) != PCRE_ERROR_PARTIAL)
 
@@ -1261,7 +1275,11 @@ g_regex_unref (GRegex *regex)
       if (regex->pcre_re != NULL)
         pcre_free (regex->pcre_re);
       if (regex->extra != NULL)
+#ifdef PCRE_STUDY_JIT_COMPILE
+        pcre_free_study (regex->extra);
+#else
         pcre_free (regex->extra);
+#endif
       g_free (regex);
     }
 }
@@ -1275,6 +1293,58 @@ static pcre *regex_compile (const gchar         *pattern,
                             GRegexMatchFlags    *match_options,
                             GError             **error);
 
+#ifdef PCRE_STUDY_JIT_COMPILE
+static void
+jit_stack_free (gpointer data)
+{
+  pcre_jit_stack_free (data);
+}
+
+static GPrivate jit_stack_private = G_PRIVATE_INIT (jit_stack_free);
+
+/* A GRegex is shared between threads, but a JIT stack can only be used
+ * by one match at a time, so every thread gets its own.
+ */
+static pcre_jit_stack *
+regex_get_jit_stack (void *data)
+{
+  pcre_jit_stack *stack;
+
+  stack = g_private_get (&jit_stack_private);
+  if (stack == NULL)
+    {
+      stack = pcre_jit_stack_alloc (JIT_STACK_MIN, JIT_STACK_MAX);
+      g_private_set (&jit_stack_private, stack);
+    }
+
+  return stack;
+}
+#endif
+
+/* Compiles G_REGEX_OPTIMIZE patterns to machine code when the PCRE
+ * library supports it.  Matches that the JIT can't do, like partial
+ * ones, silently go through the interpreter instead.
+ */
+static gint
+regex_study_options (void)
+{
+#ifdef PCRE_STUDY_JIT_COMPILE
+  static gsize options = 0;
+
+  if (g_once_init_enter (&options))
+    {
+      gint have_jit = 0;
+
+      pcre_config (PCRE_CONFIG_JIT, &have_jit);
+      g_once_init_leave (&options, have_jit ? PCRE_STUDY_JIT_COMPILE + 1 : 1);
+    }
+
+  return options - 1;
+#else
+  return 0;
+#endif
+}
+
 /**
  * g_regex_new:
  * @pattern: the regular expression
@@ -1349,7 +1419,7 @@ g_regex_new (const gchar         *pattern,
 
   if (optimize)
     {
-      regex->extra = pcre_study (regex->pcre_re, 0, &errmsg);
+      regex->extra = pcre_study (regex->pcre_re, regex_study_options (), &errmsg);
       if (errmsg != NULL)
         {
           GError *tmp_error = g_error_new (G_REGEX_ERROR,
@@ -1363,6 +1433,11 @@ g_regex_new (const gchar         *pattern,
           g_regex_unref (regex);
           return NULL;
         }
+
+#ifdef PCRE_STUDY_JIT_COMPILE
+      if (regex->extra != NULL && (regex->extra->flags & PCRE_EXTRA_EXECUTABLE_JIT))
+        pcre_assign_jit_stack (regex->extra, regex_get_jit_stack, NULL);
+#endif
     }
 
   return regex;
@@ -1615,6 +1690,100 @@ g_regex_get_match_flags (const GRegex *regex)
   return regex->match_opts & G_REGEX_MATCH_MASK;
 }
 
+typedef struct
+{
+  gchar *pattern;
+  GRegexCompileFlags compile_options;
+  GRegex *regex;
+  GList link;
+} RegexCacheEntry;
+
+static GMutex regex_cache_lock;
+static GHashTable *regex_cache;         /* RegexCacheEntry * -> itself */
+static GQueue regex_cache_lru = G_QUEUE_INIT;
+
+static guint
+regex_cache_entry_hash (gconstpointer key)
+{
+  const RegexCacheEntry *entry = key;
+
+  return g_str_hash (entry->pattern) ^ entry->compile_options;
+}
+
+static gboolean
+regex_cache_entry_equal (gconstpointer a,
+                         gconstpointer b)
+{
+  const RegexCacheEntry *entry_a = a;
+  const RegexCacheEntry *entry_b = b;
+
+  return entry_a->compile_options == entry_b->compile_options &&
+         strcmp (entry_a->pattern, entry_b->pattern) == 0;
+}
+
+/* The one-shot functions below look the compiled pattern up here
+ * first, since they tend to be called over and over with the same few
+ * patterns.  A GRegex is immutable, so handing out a reference to the
+ * cached one is safe from any thread.
+ */
+static GRegex *
+regex_new_cached (const gchar        *pattern,
+                  GRegexCompileFlags  compile_options)
+{
+  RegexCacheEntry key, *entry;
+  GRegex *regex;
+
+  key.pattern = (gchar *) pattern;
+  key.compile_options = compile_options;
+
+  g_mutex_lock (&regex_cache_lock);
+  if (regex_cache != NULL &&
+      (entry = g_hash_table_lookup (regex_cache, &key)) != NULL)
+    {
+      g_queue_unlink (&regex_cache_lru, &entry->link);
+      g_queue_push_head_link (&regex_cache_lru, &entry->link);
+      regex = g_regex_ref (entry->regex);
+      g_mutex_unlock (&regex_cache_lock);
+
+      return regex;
+    }
+  g_mutex_unlock (&regex_cache_lock);
+
+  regex = g_regex_new (pattern, compile_options, 0, NULL);
+  if (regex == NULL)
+    return NULL;
+
+  g_mutex_lock (&regex_cache_lock);
+  if (regex_cache == NULL)
+    regex_cache = g_hash_table_new (regex_cache_entry_hash, regex_cache_entry_equal);
+
+  /* another thread may have added it in the meantime */
+  if (!g_hash_table_contains (regex_cache, &key))
+    {
+      entry = g_new (RegexCacheEntry, 1);
+      entry->pattern = g_strdup (pattern);
+      entry->compile_options = compile_options;
+      entry->regex = g_regex_ref (regex);
+      entry->link.data = entry;
+      entry->link.prev = entry->link.next = NULL;
+      g_hash_table_add (regex_cache, entry);
+      g_queue_push_head_link (&regex_cache_lru, &entry->link);
+
+      if (regex_cache_lru.length > REGEX_CACHE_SIZE)
+        {
+          RegexCacheEntry *oldest = g_queue_pop_tail_link (&regex_cache_lru)->data;
+
+          g_hash_table_remove (regex_cache, oldest);
+          g_regex_unref (oldest->regex);
+          g_free (oldest->pattern);
+          g_free (oldest);
+        }
+    }
+  g_mutex_unlock (&regex_cache_lock);
+
+  return regex;
+}
+
 /**
  * g_regex_match_simple:
  * @pattern: the regular expression
@@ -1629,9 +1798,10 @@ g_regex_get_match_flags (const GRegex *regex)
  * lines of code when you need just to do a match without extracting
  * substrings, capture counts, and so on.
  *
- * If this function is to be called on the same @pattern more than
- * once, it's more efficient to compile the pattern once with
- * g_regex_new() and then use g_regex_match().
+ * The most recently used patterns are kept compiled, but if this
+ * function is to be called on the same @pattern more than once, it's
+ * still more efficient to compile the pattern once with g_regex_new()
+ * and then use g_regex_match().
  *
  * Returns: %TRUE if the string matched, %FALSE otherwise
  *
@@ -1646,7 +1816,7 @@ g_regex_match_simple (const gchar        *pattern,
   GRegex *regex;
   gboolean result;
 
-  regex = g_regex_new (pattern, compile_options, 0, NULL);
+  regex = regex_new_cached (pattern, compile_options);
   if (!regex)
     return FALSE;
   result = g_regex_match_full (regex, string, -1, 0, match_options, NULL, NULL);
@@ -2041,9 +2211,10 @@ g_regex_get_string_number (const GRegex *regex,
  * some lines of code when you need just to do a split without
  * extracting substrings, capture counts, and so on.
  *
- * If this function is to be called on the same @pattern more than
- * once, it's more efficient to compile the pattern once with
- * g_regex_new() and then use g_regex_split().
+ * The most recently used patterns are kept compiled, but if this
+ * function is to be called on the same @pattern more than once, it's
+ * still more efficient to compile the pattern once with g_regex_new()
+ * and then use g_regex_split().
  *
  * As a special case, the result of splitting the empty string ""
  * is an empty vector, not a vector containing a single string.
@@ -2072,7 +2243,7 @@ g_regex_split_simple (const gchar        *pattern,
   GRegex *regex;
   gchar **result;
 
-  regex = g_regex_new (pattern, compile_options, 0, NULL);
+  regex = regex_new_cached (pattern, compile_options);
   if (!regex)
     return NULL;
 
@@ -261,7 +261,8 @@ GQuark g_regex_error_quark (void);
  *     in the usual way).
  * @G_REGEX_OPTIMIZE: Optimize the regular expression. If the pattern will
  *     be used many times, then it may be worth the effort to optimize it
- *     to improve the speed of matches.
+ *     to improve the speed of matches. Since 2.54 this compiles the
+ *     pattern to machine code if PCRE was built with JIT support.
  * @G_REGEX_FIRSTLINE: Limits an unanchored pattern to match before (or at) the
  *     first newline. Since: 2.34
  * @G_REGEX_DUPNAMES: Names used to identify capturing subpatterns need not
@@ -0,0 +1,660 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gringqueue.h"
+
+#include "gmem.h"
+#include "gmessages.h"
+#include "gqsort.h"
+#include "gtestutils.h"
+
+#include <string.h>
+
+/**
+ * SECTION:ring_queues
+ * @title: Ring Buffer Queues
+ * @short_description: double-ended queues stored in a growable array
+ * @see_also: #GQueue
+ *
+ * A #GRingQueue is a double-ended queue of pointers, like #GQueue, that
+ * keeps its elements in a single circular buffer instead of a linked
+ * list.
+ *
+ * Pushing and popping at either end takes constant time, and once the
+ * buffer has grown to the largest size the queue reaches, it does not
+ * allocate memory at all.  Elements can be accessed by their position
+ * in constant time with g_ring_queue_peek_nth().  Inserting or removing
+ * elements in the middle moves the elements on the shorter side of the
+ * position, so it is linear like for #GQueue, but without following
+ * pointers.
+ *
+ * As there are no links, a #GRingQueue cannot be used where the
+ * position of an element needs to stay valid while others are added
+ * or removed; use #GQueue for that.
+ *
+ * To create a new #GRingQueue, use g_ring_queue_new().
+ */
+
+/**
+ * GRingQueue:
+ *
+ * An opaque data structure which represents a ring buffer queue.
+ *
+ * It should only be accessed through the g_ring_queue_*() functions.
+ *
+ * Since: 2.54
+ */
+
+struct _GRingQueue
+{
+  gpointer *data;
+  guint head;       /* index of the first element in @data */
+  guint length;
+  guint size;       /* 0 or a power of two */
+};
+
+#define MIN_SIZE 8
+
+/* the index in @data of the @n'th element */
+#define RING_INDEX(queue, n) (((queue)->head + (n)) & ((queue)->size - 1))
+
+/* Reallocates the buffer to @size elements, putting the first element
+ * at the start.
+ */
+static void
+g_ring_queue_resize (GRingQueue *queue,
+                     guint       size)
+{
+  gpointer *data;
+  guint first;
+
+  g_assert (size >= queue->length);
+
+  data = g_new (gpointer, size);
+
+  if (queue->length > 0)
+    {
+      /* the elements up to the end of the buffer, then the ones that
+       * wrapped around to the start */
+      first = MIN (queue->length, queue->size - queue->head);
+      memcpy (data, queue->data + queue->head, first * sizeof (gpointer));
+      memcpy (data + first, queue->data, (queue->length - first) * sizeof (gpointer));
+    }
+
+  g_free (queue->data);
+  queue->data = data;
+  queue->head = 0;
+  queue->size = size;
+}
+
+static inline void
+g_ring_queue_maybe_grow (GRingQueue *queue)
+{
+  if (G_UNLIKELY (queue->length == queue->size))
+    {
+      if (queue->size > G_MAXUINT / 2)
+        g_error ("%s: queue of %u elements is full", G_STRLOC, queue->length);
+
+      g_ring_queue_resize (queue, MAX (queue->size * 2, MIN_SIZE));
+    }
+}
+
+/**
+ * g_ring_queue_new:
+ *
+ * Creates a new, empty #GRingQueue.  No memory is allocated for the
+ * elements until the first one is pushed.
+ *
+ * Returns: a newly allocated #GRingQueue. Free with g_ring_queue_free()
+ *
+ * Since: 2.54
+ */
+GRingQueue *
+g_ring_queue_new (void)
+{
+  return g_new0 (GRingQueue, 1);
+}
+
+/**
+ * g_ring_queue_free:
+ * @queue: a #GRingQueue
+ *
+ * Frees the memory allocated for @queue.
+ *
+ * If queue elements contain dynamically-allocated memory, you should
+ * either free them first or use g_ring_queue_free_full().
+ *
+ * Since: 2.54
+ */
+void
+g_ring_queue_free (GRingQueue *queue)
+{
+  g_return_if_fail (queue != NULL);
+
+  g_free (queue->data);
+  g_free (queue);
+}
+
+/**
+ * g_ring_queue_free_full:
+ * @queue: a #GRingQueue
+ * @free_func: the function to be called to free each element's data
+ *
+ * Convenience method, which frees all the memory used by @queue,
+ * and calls the specified destroy function on every element's data.
+ *
+ * Since: 2.54
+ */
+void
+g_ring_queue_free_full (GRingQueue     *queue,
+                        GDestroyNotify  free_func)
+{
+  g_return_if_fail (queue != NULL);
+
+  g_ring_queue_foreach (queue, (GFunc) free_func, NULL);
+  g_ring_queue_free (queue);
+}
+
+/**
+ * g_ring_queue_clear:
+ * @queue: a #GRingQueue
+ *
+ * Removes all the elements in @queue.  The buffer is kept, so that
+ * refilling the queue doesn't allocate memory.
+ *
+ * Since: 2.54
+ */
+void
+g_ring_queue_clear (GRingQueue *queue)
+{
+  g_return_if_fail (queue != NULL);
+
+  queue->head = 0;
+  queue->length = 0;
+}
+
+/**
+ * g_ring_queue_is_empty:
+ * @queue: a #GRingQueue
+ *
+ * Returns %TRUE if the queue is empty.
+ *
+ * Returns: %TRUE if the queue is empty
+ *
+ * Since: 2.54
+ */
+gboolean
+g_ring_queue_is_empty (GRingQueue *queue)
+{
+  g_return_val_if_fail (queue != NULL, TRUE);
+
+  return queue->length == 0;
+}
+
+/**
+ * g_ring_queue_get_length:
+ * @queue: a #GRingQueue
+ *
+ * Returns the number of items in @queue.
+ *
+ * Returns: the number of items in @queue
+ *
+ * Since: 2.54
+ */
+guint
+g_ring_queue_get_length (GRingQueue *queue)
+{
+  g_return_val_if_fail (queue != NULL, 0);
+
+  return queue->length;
+}
+
+/**
+ * g_ring_queue_foreach:
+ * @queue: a #GRingQueue
+ * @func: the function to call for each element's data
+ * @user_data: user data to pass to @func
+ *
+ * Calls @func for each element in the queue, from the head to the
+ * tail, passing @user_data to the function.
+ *
+ * It is safe for @func to remove the element from @queue, but it must
+ * not modify any part of the queue after that element.
+ *
+ * Since: 2.54
+ */
+void
+g_ring_queue_foreach (GRingQueue *queue,
+                      GFunc       func,
+                      gpointer    user_data)
+{
+  guint i, length;
+
+  g_return_if_fail (queue != NULL);
+  g_return_if_fail (func != NULL);
+
+  for (i = 0; i < queue->length; i++)
+    {
+      length = queue->length;
+      func (queue->data[RING_INDEX (queue, i)], user_data);
+
+      /* the element was removed, the next one moved to its position */
+      if (queue->length < length)
+        i--;
+    }
+}
+
+typedef struct
+{
+  GCompareDataFunc func;
+  gpointer         user_data;
+} SortData;
+
+static gint
+compare_elements (gconstpointer a,
+                  gconstpointer b,
+                  gpointer      user_data)
+{
+  SortData *sd = user_data;
+
+  return sd->func (*(gconstpointer *) a, *(gconstpointer *) b, sd->user_data);
+}
+
+/**
+ * g_ring_queue_sort:
+ * @queue: a #GRingQueue
+ * @compare_func: the #GCompareDataFunc used to sort @queue. This function
+ *     is passed two elements of the queue and should return 0 if they are
+ *     equal, a negative value if the first comes before the second, and
+ *     a positive value if the second comes before the first.
+ * @user_data: user data passed to @compare_func
+ *
+ * Sorts @queue using @compare_func.  The sort is stable.
+ *
+ * Since: 2.54
+ */
+void
+g_ring_queue_sort (GRingQueue       *queue,
+                   GCompareDataFunc  compare_func,
+                   gpointer          user_data)
+{
+  SortData sd;
+
+  g_return_if_fail (queue != NULL);
+  g_return_if_fail (compare_func != NULL);
+
+  if (queue->length < 2)
+    return;
+
+  /* the elements need to be contiguous for g_qsort_with_data() */
+  if (queue->head + queue->length > queue->size)
+    g_ring_queue_resize (queue, queue->size);
+
+  sd.func = compare_func;
+  sd.user_data = user_data;
+
+  g_qsort_with_data (queue->data + queue->head, queue->length,
+                     sizeof (gpointer), compare_elements, &sd);
+}
+
+/**
+ * g_ring_queue_push_head:
+ * @queue: a #GRingQueue
+ * @data: the data for the new element
+ *
+ * Adds a new element at the head of the queue.
+ *
+ * Since: 2.54
+ */
+void
+g_ring_queue_push_head (GRingQueue *queue,
+                        gpointer    data)
+{
+  g_return_if_fail (queue != NULL);
+
+  g_ring_queue_maybe_grow (queue);
+
+  queue->head = (queue->head - 1) & (queue->size - 1);
+  queue->data[queue->head] = data;
+  queue->length++;
+}
+
+/**
+ * g_ring_queue_push_tail:
+ * @queue: a #GRingQueue
+ * @data: the data for the new element
+ *
+ * Adds a new element at the tail of the queue.
+ *
+ * Since: 2.54
+ */
+void
+g_ring_queue_push_tail (GRingQueue *queue,
+                        gpointer    data)
+{
+  g_return_if_fail (queue != NULL);
+
+  g_ring_queue_maybe_grow (queue);
+
+  queue->data[RING_INDEX (queue, queue->length)] = data;
+  queue->length++;
+}
+
+/**
+ * g_ring_queue_push_nth:
+ * @queue: a #GRingQueue
+ * @data: the data for the new element
+ * @n: the position to insert the new element. If @n is negative or
+ *     larger than the number of elements in the @queue, the element is
+ *     added to the end of the queue.
+ *
+ * Inserts a new element into @queue at the given position.
+ *
+ * Since: 2.54
+ */
+void
+g_ring_queue_push_nth (GRingQueue *queue,
+                       gpointer    data,
+                       gint        n)
+{
+  guint mask, i;
+
+  g_return_if_fail (queue != NULL);
+
+  if (n < 0 || (guint) n >= queue->length)
+    {
+      g_ring_queue_push_tail (queue, data);
+      return;
+    }
+
+  g_ring_queue_maybe_grow (queue);
+  mask = queue->size - 1;
+
+  if ((guint) n < queue->length / 2)
+    {
+      /* move the first @n elements one step towards the head */
+      queue->head = (queue->head - 1) & mask;
+      for (i = 0; i < (guint) n; i++)
+        queue->data[RING_INDEX (queue, i)] = queue->data[RING_INDEX (queue, i + 1)];
+    }
+  else
+    {
+      /* move the elements from @n on one step towards the tail */
+      for (i = queue->length; i > (guint) n; i--)
+        queue->data[RING_INDEX (queue, i)] = queue->data[RING_INDEX (queue, i - 1)];
+    }
+
+  queue->data[RING_INDEX (queue, n)] = data;
+  queue->length++;
+}
+
+/**
+ * g_ring_queue_pop_head:
+ * @queue: a #GRingQueue
+ *
+ * Removes the first element of the queue and returns its data.
+ *
+ * Returns: the data of the first element in the queue, or %NULL
+ *     if the queue is empty
+ *
+ * Since: 2.54
+ */
+gpointer
+g_ring_queue_pop_head (GRingQueue *queue)
+{
+  gpointer data;
+
+  g_return_val_if_fail (queue != NULL, NULL);
+
+  if (queue->length == 0)
+    return NULL;
+
+  data = queue->data[queue->head];
+  queue->head = RING_INDEX (queue, 1);
+  queue->length--;
+
+  return data;
+}
+
+/**
+ * g_ring_queue_pop_tail:
+ * @queue: a #GRingQueue
+ *
+ * Removes the last element of the queue and returns its data.
+ *
+ * Returns: the data of the last element in the queue, or %NULL
+ *     if the queue is empty
+ *
+ * Since: 2.54
+ */
+gpointer
+g_ring_queue_pop_tail (GRingQueue *queue)
+{
+  g_return_val_if_fail (queue != NULL, NULL);
+
+  if (queue->length == 0)
+    return NULL;
+
+  queue->length--;
+
+  return queue->data[RING_INDEX (queue, queue->length)];
+}
+
+/**
+ * g_ring_queue_pop_nth:
+ * @queue: a #GRingQueue
+ * @n: the position of the element
+ *
+ * Removes the @n'th element of @queue and returns its data.
+ *
+ * Returns: the element's data, or %NULL if @n is off the end of @queue
+ *
+ * Since: 2.54
+ */
+gpointer
+g_ring_queue_pop_nth (GRingQueue *queue,
+                      guint       n)
+{
+  gpointer data;
+  guint i;
+
+  g_return_val_if_fail (queue != NULL, NULL);
+
+  if (n >= queue->length)
+    return NULL;
+
+  data = queue->data[RING_INDEX (queue, n)];
+
+  if (n < queue->length / 2)
+    {
+      /* move the first @n elements one step towards the tail */
+      for (i = n; i > 0; i--)
+        queue->data[RING_INDEX (queue, i)] = queue->data[RING_INDEX (queue, i - 1)];
+      queue->head = RING_INDEX (queue, 1);
+    }
+  else
+    {
+      /* move the elements after @n one step towards the head */
+      for (i = n; i + 1 < queue->length; i++)
+        queue->data[RING_INDEX (queue, i)] = queue->data[RING_INDEX (queue, i + 1)];
+    }
+
+  queue->length--;
+
+  return data;
+}
+
+/**
+ * g_ring_queue_peek_head:
+ * @queue: a #GRingQueue
+ *
+ * Returns the first element of the queue.
+ *
+ * Returns: the data of the first element in the queue, or %NULL
+ *     if the queue is empty
+ *
+ * Since: 2.54
+ */
+gpointer
+g_ring_queue_peek_head (GRingQueue *queue)
+{
+  g_return_val_if_fail (queue != NULL, NULL);
+
+  return queue->length > 0 ? queue->data[queue->head] : NULL;
+}
+
+/**
+ * g_ring_queue_peek_tail:
+ * @queue: a #GRingQueue
+ *
+ * Returns the last element of the queue.
+ *
+ * Returns: the data of the last element in the queue, or %NULL
+ *     if the queue is empty
+ *
+ * Since: 2.54
+ */
+gpointer
+g_ring_queue_peek_tail (GRingQueue *queue)
+{
+  g_return_val_if_fail (queue != NULL, NULL);
+
+  return queue->length > 0 ? queue->data[RING_INDEX (queue, queue->length - 1)] : NULL;
+}
+
+/**
+ * g_ring_queue_peek_nth:
+ * @queue: a #GRingQueue
+ * @n: the position of the element
+ *
+ * Returns the @n'th element of @queue.  Unlike g_queue_peek_nth(),
+ * this takes constant time.
+ *
+ * Returns: the data for the @n'th element of @queue,
+ *     or %NULL if @n is off the end of @queue
+ *
+ * Since: 2.54
+ */
+gpointer
+g_ring_queue_peek_nth (GRingQueue *queue,
+                       guint       n)
+{
+  g_return_val_if_fail (queue != NULL, NULL);
+
+  if (n >= queue->length)
+    return NULL;
+
+  return queue->data[RING_INDEX (queue, n)];
+}
+
+/**
+ * g_ring_queue_index:
+ * @queue: a #GRingQueue
+ * @data: the data to find
+ *
+ * Returns the position of the first element in @queue which contains
+ * @data.
+ *
+ * Returns: the position of the first element in @queue which
+ *     contains @data, or -1 if no element in @queue contains @data
+ *
+ * Since: 2.54
+ */
+gint
+g_ring_queue_index (GRingQueue    *queue,
+                    gconstpointer  data)
+{
+  guint i;
+
+  g_return_val_if_fail (queue != NULL, -1);
+
+  for (i = 0; i < queue->length; i++)
+    {
+      if (queue->data[RING_INDEX (queue, i)] == data)
+        return i;
+    }
+
+  return -1;
+}
+
+/**
+ * g_ring_queue_remove:
+ * @queue: a #GRingQueue
+ * @data: the data to remove
+ *
+ * Removes the first element in @queue that contains @data.
+ *
+ * Returns: %TRUE if @data was found and removed from @queue
+ *
+ * Since: 2.54
+ */
+gboolean
+g_ring_queue_remove (GRingQueue    *queue,
+                     gconstpointer  data)
+{
+  gint i;
+
+  g_return_val_if_fail (queue != NULL, FALSE);
+
+  i = g_ring_queue_index (queue, data);
+  if (i < 0)
+    return FALSE;
+
+  g_ring_queue_pop_nth (queue, i);
+
+  return TRUE;
+}
+
+/**
+ * g_ring_queue_insert_sorted:
+ * @queue: a #GRingQueue
+ * @data: the data to insert
+ * @func: the #GCompareDataFunc used to compare elements in the queue. It is
+ *     called with two elements of the @queue and @user_data. It should
+ *     return 0 if the elements are equal, a negative value if the first
+ *     element comes before the second, and a positive value if the second
+ *     element comes before the first.
+ * @user_data: user data passed to @func
+ *
+ * Inserts @data into @queue using @func to determine the new position,
+ * in front of the first element which doesn't come before it, like
+ * g_queue_insert_sorted().
+ *
+ * Since: 2.54
+ */
+void
+g_ring_queue_insert_sorted (GRingQueue       *queue,
+                            gpointer          data,
+                            GCompareDataFunc  func,
+                            gpointer          user_data)
+{
+  guint i;
+
+  g_return_if_fail (queue != NULL);
+  g_return_if_fail (func != NULL);
+
+  for (i = 0; i < queue->length; i++)
+    {
+      if (func (queue->data[RING_INDEX (queue, i)], data, user_data) >= 0)
+        break;
+    }
+
+  g_ring_queue_push_nth (queue, data, i < queue->length ? (gint) i : -1);
+}
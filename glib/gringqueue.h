@@ -0,0 +1,91 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright © 2017 GLib contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_RING_QUEUE_H__
+#define __G_RING_QUEUE_H__
+
+#if !defined (__GLIB_H_INSIDE__) && !defined (GLIB_COMPILATION)
+#error "Only <glib.h> can be included directly."
+#endif
+
+#include <glib/gtypes.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GRingQueue GRingQueue;
+
+GLIB_AVAILABLE_IN_2_54
+GRingQueue *g_ring_queue_new           (void);
+GLIB_AVAILABLE_IN_2_54
+void        g_ring_queue_free          (GRingQueue       *queue);
+GLIB_AVAILABLE_IN_2_54
+void        g_ring_queue_free_full     (GRingQueue       *queue,
+                                        GDestroyNotify    free_func);
+GLIB_AVAILABLE_IN_2_54
+void        g_ring_queue_clear         (GRingQueue       *queue);
+GLIB_AVAILABLE_IN_2_54
+gboolean    g_ring_queue_is_empty      (GRingQueue       *queue);
+GLIB_AVAILABLE_IN_2_54
+guint       g_ring_queue_get_length    (GRingQueue       *queue);
+GLIB_AVAILABLE_IN_2_54
+void        g_ring_queue_foreach       (GRingQueue       *queue,
+                                        GFunc             func,
+                                        gpointer          user_data);
+GLIB_AVAILABLE_IN_2_54
+void        g_ring_queue_sort          (GRingQueue       *queue,
+                                        GCompareDataFunc  compare_func,
+                                        gpointer          user_data);
+GLIB_AVAILABLE_IN_2_54
+void        g_ring_queue_push_head     (GRingQueue       *queue,
+                                        gpointer          data);
+GLIB_AVAILABLE_IN_2_54
+void        g_ring_queue_push_tail     (GRingQueue       *queue,
+                                        gpointer          data);
+GLIB_AVAILABLE_IN_2_54
+void        g_ring_queue_push_nth      (GRingQueue       *queue,
+                                        gpointer          data,
+                                        gint              n);
+GLIB_AVAILABLE_IN_2_54
+gpointer    g_ring_queue_pop_head      (GRingQueue       *queue);
+GLIB_AVAILABLE_IN_2_54
+gpointer    g_ring_queue_pop_tail      (GRingQueue       *queue);
+GLIB_AVAILABLE_IN_2_54
+gpointer    g_ring_queue_pop_nth       (GRingQueue       *queue,
+                                        guint             n);
+GLIB_AVAILABLE_IN_2_54
+gpointer    g_ring_queue_peek_head     (GRingQueue       *queue);
+GLIB_AVAILABLE_IN_2_54
+gpointer    g_ring_queue_peek_tail     (GRingQueue       *queue);
+GLIB_AVAILABLE_IN_2_54
+gpointer    g_ring_queue_peek_nth      (GRingQueue       *queue,
+                                        guint             n);
+GLIB_AVAILABLE_IN_2_54
+gint        g_ring_queue_index         (GRingQueue       *queue,
+                                        gconstpointer     data);
+GLIB_AVAILABLE_IN_2_54
+gboolean    g_ring_queue_remove        (GRingQueue       *queue,
+                                        gconstpointer     data);
+GLIB_AVAILABLE_IN_2_54
+void        g_ring_queue_insert_sorted (GRingQueue       *queue,
+                                        gpointer          data,
+                                        GCompareDataFunc  func,
+                                        gpointer          user_data);
+
+G_END_DECLS
+
+#endif /* __G_RING_QUEUE_H__ */
@@ -283,7 +283,7 @@
 	  ((guchar)(c))							\
 	)								\
 )
-#define	READ_BUFFER_SIZE	(4000)
+#define	READ_BUFFER_SIZE	(64 * 1024)
 
 
 /* --- typedefs --- */
@@ -293,6 +293,7 @@ struct	_GScannerKey
 {
   guint		 scope_id;
   gchar		*symbol;
+  gsize		 length;	/* symbol need not be nul-terminated in lookup keys */
   gpointer	 value;
 };
 
@@ -349,6 +350,11 @@ static inline
 GScannerKey*	g_scanner_lookup_internal (GScanner	*scanner,
 					   guint	 scope_id,
 					   const gchar	*symbol);
+static GScannerKey*
+		g_scanner_lookup_internal_len (GScanner	*scanner,
+					   guint	 scope_id,
+					   const gchar	*symbol,
+					   gsize	 length);
 static gboolean	g_scanner_key_equal	  (gconstpointer v1,
 					   gconstpointer v2);
 static guint	g_scanner_key_hash	  (gconstpointer v);
@@ -614,44 +620,52 @@ g_scanner_key_equal (gconstpointer v1,
   const GScannerKey *key1 = v1;
   const GScannerKey *key2 = v2;
   
-  return (key1->scope_id == key2->scope_id) && (strcmp (key1->symbol, key2->symbol) == 0);
+  return (key1->scope_id == key2->scope_id) &&
+         (key1->length == key2->length) &&
+         (memcmp (key1->symbol, key2->symbol, key1->length) == 0);
 }
 
 static guint
 g_scanner_key_hash (gconstpointer v)
 {
   const GScannerKey *key = v;
-  gchar *c;
+  const gchar *c, *end;
   guint h;
   
   h = key->scope_id;
-  for (c = key->symbol; *c; c++)
+  for (c = key->symbol, end = c + key->length; c < end; c++)
     h = (h << 5) - h + *c;
   
   return h;
 }
 
-static inline GScannerKey*
-g_scanner_lookup_internal (GScanner	*scanner,
-			   guint	 scope_id,
-			   const gchar	*symbol)
+/* looks up the first @length bytes of @symbol, which need not be
+ * nul-terminated, so that identifiers can be looked up right in the
+ * input buffer
+ */
+static GScannerKey*
+g_scanner_lookup_internal_len (GScanner	*scanner,
+			       guint	 scope_id,
+			       const gchar	*symbol,
+			       gsize	 length)
 {
   GScannerKey	*key_p;
   GScannerKey key;
   
   key.scope_id = scope_id;
+  key.length = length;
   
   if (!scanner->config->case_sensitive)
     {
-      gchar *d;
-      const gchar *c;
+      gchar buffer[64];
+      gsize i;
       
-      key.symbol = g_new (gchar, strlen (symbol) + 1);
-      for (d = key.symbol, c = symbol; *c; c++, d++)
-	*d = to_lower (*c);
-      *d = 0;
+      key.symbol = length < sizeof (buffer) ? buffer : g_new (gchar, length);
+      for (i = 0; i < length; i++)
+	key.symbol[i] = to_lower (symbol[i]);
       key_p = g_hash_table_lookup (scanner->symbol_table, &key);
-      g_free (key.symbol);
+      if (key.symbol != buffer)
+        g_free (key.symbol);
     }
   else
     {
@@ -662,6 +676,14 @@ g_scanner_lookup_internal (GScanner	*scanner,
   return key_p;
 }
 
+static inline GScannerKey*
+g_scanner_lookup_internal (GScanner	*scanner,
+			   guint	 scope_id,
+			   const gchar	*symbol)
+{
+  return g_scanner_lookup_internal_len (scanner, scope_id, symbol, strlen (symbol));
+}
+
 /**
  * g_scanner_add_symbol:
  * @scanner: a #GScanner
@@ -700,6 +722,7 @@ g_scanner_scope_add_symbol (GScanner	*scanner,
       key = g_new (GScannerKey, 1);
       key->scope_id = scope_id;
       key->symbol = g_strdup (symbol);
+      key->length = strlen (symbol);
       key->value = value;
       if (!scanner->config->case_sensitive)
 	{
@@ -1724,6 +1747,7 @@ g_scanner_get_token_ll	(GScanner	*scanner,
   gboolean	   in_comment_single;
   gboolean	   in_string_sq;
   gboolean	   in_string_dq;
+  gboolean	   symbol_checked;
   GString	  *gstring;
   GTokenValue	   value;
   guchar	   ch;
@@ -1742,6 +1766,7 @@ g_scanner_get_token_ll	(GScanner	*scanner,
   in_comment_single = FALSE;
   in_string_sq = FALSE;
   in_string_dq = FALSE;
+  symbol_checked = FALSE;
   gstring = NULL;
   
   do /* while (ch != 0) */
@@ -2149,16 +2174,75 @@ g_scanner_get_token_ll	(GScanner	*scanner,
 		  strchr (config->cset_identifier_nth,
 			  g_scanner_peek_next_char (scanner)))
 		{
+		  const gchar *start, *end;
+
 		  token = G_TOKEN_IDENTIFIER;
-		  gstring = g_string_new (NULL);
-		  gstring = g_string_append_c (gstring, ch);
-		  do
+
+		  /* If the identifier is entirely within the input
+		   * buffer, @ch is still right in front of it, unless
+		   * peeking had to read a new file buffer.
+		   */
+		  start = end = NULL;
+		  if (scanner->input_fd < 0 || scanner->text != scanner->buffer)
 		    {
-		      ch = g_scanner_get_char (scanner, line_p, position_p);
+		      start = scanner->text - 1;
+		      for (end = scanner->text;
+			   end < scanner->text_end && *end &&
+			   strchr (config->cset_identifier_nth, *end);
+			   end++)
+			;
+		      /* fall back for identifiers that may continue in
+		       * the next file buffer, and for nul characters */
+		      if ((end == scanner->text_end && scanner->input_fd >= 0) ||
+			  (end < scanner->text_end && *end == '\0'))
+			start = end = NULL;
+		    }
+
+		  if (start)
+		    {
+		      GScannerKey *key = NULL;
+
+		      for (; scanner->text < end; scanner->text++)
+			{
+			  if (*scanner->text == '\n')
+			    {
+			      (*position_p) = 0;
+			      (*line_p)++;
+			    }
+			  else
+			    (*position_p)++;
+			}
+
+		      /* look symbols up in place, without copying them */
+		      if (config->scan_symbols)
+			{
+			  key = g_scanner_lookup_internal_len (scanner, scanner->scope_id,
+							       start, end - start);
+			  if (!key && scanner->scope_id && config->scope_0_fallback)
+			    key = g_scanner_lookup_internal_len (scanner, 0, start, end - start);
+			  symbol_checked = TRUE;
+			}
+
+		      if (key)
+			{
+			  token = G_TOKEN_SYMBOL;
+			  value.v_symbol = key->value;
+			}
+		      else
+			value.v_identifier = g_strndup (start, end - start);
+		    }
+		  else
+		    {
+		      gstring = g_string_new (NULL);
 		      gstring = g_string_append_c (gstring, ch);
-		      ch = g_scanner_peek_next_char (scanner);
+		      do
+			{
+			  ch = g_scanner_get_char (scanner, line_p, position_p);
+			  gstring = g_string_append_c (gstring, ch);
+			  ch = g_scanner_peek_next_char (scanner);
+			}
+		      while (ch && strchr (config->cset_identifier_nth, ch));
 		    }
-		  while (ch && strchr (config->cset_identifier_nth, ch));
 		  ch = 0;
 		}
 	      else if (config->scan_identifier_1char)
@@ -2211,7 +2295,7 @@ g_scanner_get_token_ll	(GScanner	*scanner,
   
   if (token == G_TOKEN_IDENTIFIER)
     {
-      if (config->scan_symbols)
+      if (config->scan_symbols && !symbol_checked)
 	{
 	  GScannerKey *key;
 	  guint scope_id;
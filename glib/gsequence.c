@@ -21,6 +21,7 @@
 #include "gsequence.h"
 
 #include "gmem.h"
+#include "gqsort.h"
 #include "gtestutils.h"
 #include "gslice.h"
 /**
@@ -154,6 +155,8 @@ static void           node_insert_sorted (GSequenceNode            *node,
                                           GSequenceNode            *end,
                                           GSequenceIterCompareFunc  cmp_func,
                                           gpointer                  cmp_data);
+static void           node_build         (GSequenceNode           **nodes,
+                                          gint                      n_nodes);
 
 
 /*
@@ -211,6 +214,25 @@ typedef struct
   GSequenceNode    *end_node;
 } SortInfo;
 
+typedef struct
+{
+  GSequenceIterCompareFunc  cmp_func;
+  gpointer                  cmp_data;
+} IterSortInfo;
+
+/* This function compares two elements of an array of nodes using
+ * the iter compare function passed in in an IterSortInfo struct
+ */
+static gint
+node_ptr_compare (gconstpointer a,
+                  gconstpointer b,
+                  gpointer      data)
+{
+  const IterSortInfo *info = data;
+
+  return info->cmp_func (*(GSequenceNode **) a, *(GSequenceNode **) b, info->cmp_data);
+}
+
 /* This function compares two iters using a normal compare
  * function and user_data passed in in a SortInfo struct
  */
@@ -868,37 +890,45 @@ g_sequence_sort_iter (GSequence                *seq,
                       GSequenceIterCompareFunc  cmp_func,
                       gpointer                  cmp_data)
 {
-  GSequence *tmp;
-  GSequenceNode *begin, *end;
+  IterSortInfo info;
+  GSequenceNode **nodes;
+  GSequenceNode *node;
+  gint n_nodes, i;
 
   g_return_if_fail (seq != NULL);
   g_return_if_fail (cmp_func != NULL);
 
   check_seq_access (seq);
 
-  begin = g_sequence_get_begin_iter (seq);
-  end   = g_sequence_get_end_iter (seq);
-
-  tmp = g_sequence_new (NULL);
-  tmp->real_sequence = seq;
-
-  g_sequence_move_range (g_sequence_get_begin_iter (tmp), begin, end);
+  n_nodes = g_sequence_get_length (seq);
+  if (n_nodes < 2)
+    return;
 
-  seq->access_prohibited = TRUE;
-  tmp->access_prohibited = TRUE;
+  /* Sort an array of the nodes and build a new tree from it, rather
+   * than inserting the nodes one by one, which would do a lot of
+   * rotations and cache misses.  The sort is stable, like the
+   * insertions were.
+   */
+  nodes = g_new (GSequenceNode *, n_nodes + 1);
 
-  while (!g_sequence_is_empty (tmp))
+  node = node_get_first (seq->end_node);
+  for (i = 0; i < n_nodes; i++)
     {
-      GSequenceNode *node = g_sequence_get_begin_iter (tmp);
-
-      node_insert_sorted (seq->end_node, node, seq->end_node,
-                          cmp_func, cmp_data);
+      nodes[i] = node;
+      node = node_get_next (node);
     }
+  nodes[n_nodes] = seq->end_node;
+
+  info.cmp_func = cmp_func;
+  info.cmp_data = cmp_data;
 
-  tmp->access_prohibited = FALSE;
+  seq->access_prohibited = TRUE;
+  g_qsort_with_data (nodes, n_nodes, sizeof (GSequenceNode *), node_ptr_compare, &info);
   seq->access_prohibited = FALSE;
 
-  g_sequence_free (tmp);
+  node_build (nodes, n_nodes + 1);
+
+  g_free (nodes);
 }
 
 /**
@@ -2005,6 +2035,62 @@ node_unlink (GSequenceNode *node)
   node->parent = NULL;
 }
 
+static void
+node_update_fields_all (GSequenceNode *node)
+{
+  if (node)
+    {
+      node_update_fields_all (node->left);
+      node_update_fields_all (node->right);
+      node_update_fields (node);
+    }
+}
+
+/* Links @nodes, which must be all the nodes of a tree, into a new tree
+ * in the order they are in the array.  Since the shape of a treap is
+ * fixed by the order and priorities of its nodes, this can be done in
+ * linear time by keeping the right spine of the tree built so far on
+ * a stack.
+ */
+static void
+node_build (GSequenceNode **nodes,
+            gint            n_nodes)
+{
+  GSequenceNode **spine;
+  gint i, top = 0;
+
+  spine = g_new (GSequenceNode *, n_nodes);
+
+  for (i = 0; i < n_nodes; i++)
+    {
+      GSequenceNode *node = nodes[i];
+      GSequenceNode *last = NULL;
+      guint priority = get_priority (node);
+
+      while (top > 0 && get_priority (spine[top - 1]) < priority)
+        last = spine[--top];
+
+      node->left = last;
+      node->right = NULL;
+      if (last)
+        last->parent = node;
+
+      if (top > 0)
+        {
+          spine[top - 1]->right = node;
+          node->parent = spine[top - 1];
+        }
+      else
+        node->parent = NULL;
+
+      spine[top++] = node;
+    }
+
+  node_update_fields_all (spine[0]);
+
+  g_free (spine);
+}
+
 static void
 node_insert_sorted (GSequenceNode            *node,
                     GSequenceNode            *new,
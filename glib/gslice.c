@@ -44,6 +44,7 @@
 
 #include "gmain.h"
 #include "gmem.h"               /* gslice.h */
+#include "gmemprivate.h"
 #include "gstrfuncs.h"
 #include "gutils.h"
 #include "gtrashstack.h"
@@ -146,9 +147,14 @@
  *   free lists which only require one g_private_get() call to retrive the
  *   thread handle.
  * - the magazine cache. allocating and freeing chunks to/from threads only
- *   occours at magazine sizes from a global depot of magazines. the depot
- *   maintaines a 15 second working set of allocated magazines, so full
- *   magazines are not allocated and released too often.
+ *   occours at magazine sizes from a global depot of magazines. for each chunk
+ *   size, a handful of full magazines are exchanged between threads through
+ *   lock-free slots; only once those are all taken (or all empty) does the
+ *   depot fall back to its mutex protected list. that list maintaines a 15
+ *   second working set of allocated magazines, so full magazines are not
+ *   allocated and released too often.
+ *   the magazines of a thread are returned to the slab allocator right away
+ *   when the thread exits, and g_slice_trim() empties the depot on demand.
  *   the chunk size dependent magazine sizes automatically adapt (within limits,
  *   see [3]) to lock contention to properly scale performance across a variety
  *   of SMP systems.
@@ -195,6 +201,7 @@
 #define SLAB_INFO_SIZE          P2ALIGN (sizeof (SlabInfo) + NATIVE_MALLOC_PADDING)
 #define MAX_MAGAZINE_SIZE       (256)                                           /* see [3] and allocator_get_magazine_threshold() for this */
 #define MIN_MAGAZINE_SIZE       (4)
+#define N_DEPOT_SLOTS           (8)                                             /* lock-free magazine exchange slots per chunk size */
 #define MAX_STAMP_COUNTER       (7)                                             /* distributes the load of gettimeofday() */
 #define MAX_SLAB_CHUNK_SIZE(al) (((al)->max_page_size - SLAB_INFO_SIZE) / 8)    /* we want at last 8 chunks per page, see [4] */
 #define MAX_SLAB_INDEX(al)      (SLAB_INDEX (al, MAX_SLAB_CHUNK_SIZE (al)) + 1)
@@ -251,6 +258,7 @@ typedef struct {
   /* magazine cache */
   GMutex        magazine_mutex;
   ChunkLink   **magazines;                /* array of MAX_SLAB_INDEX (allocator) */
+  gpointer     *depot_slots;              /* array of MAX_SLAB_INDEX (allocator) * N_DEPOT_SLOTS */
   guint        *contention_counters;      /* array of MAX_SLAB_INDEX (allocator) */
   gint          mutex_counter;
   guint         stamp_counter;
@@ -372,6 +380,7 @@ slice_config_init (SliceConfig *config)
       const GDebugKey keys[] = {
         { "always-malloc", 1 << 0 },
         { "debug-blocks",  1 << 1 },
+        { "stats",         1 << 2 },        /* handled by g_mem_stats_init() */
       };
 
       flags = g_parse_debug_string (val, keys, G_N_ELEMENTS (keys));
@@ -433,12 +442,14 @@ g_slice_init_nomessage (void)
     {
       allocator->contention_counters = NULL;
       allocator->magazines = NULL;
+      allocator->depot_slots = NULL;
       allocator->slab_stack = NULL;
     }
   else
     {
       allocator->contention_counters = g_new0 (guint, MAX_SLAB_INDEX (allocator));
       allocator->magazines = g_new0 (ChunkLink*, MAX_SLAB_INDEX (allocator));
+      allocator->depot_slots = g_new0 (gpointer, MAX_SLAB_INDEX (allocator) * N_DEPOT_SLOTS);
       allocator->slab_stack = g_new0 (SlabInfo*, MAX_SLAB_INDEX (allocator));
     }
 
@@ -683,6 +694,63 @@ magazine_cache_trim (Allocator *allocator,
     }
 }
 
+/* the depot slots are only ever swapped between NULL and a full, prepared
+ * magazine, so a successful compare-and-exchange always hands over a
+ * magazine whose fields were completely written before it was published.
+ */
+static gboolean
+magazine_depot_slots_put (guint      ix,
+                          ChunkLink *magazine)
+{
+  gpointer *slots = &allocator->depot_slots[ix * N_DEPOT_SLOTS];
+  guint i;
+  for (i = 0; i < N_DEPOT_SLOTS; i++)
+    if (g_atomic_pointer_get (&slots[i]) == NULL &&
+        g_atomic_pointer_compare_and_exchange (&slots[i], NULL, magazine))
+      return TRUE;
+  return FALSE;
+}
+
+static ChunkLink*
+magazine_depot_slots_take (guint ix)
+{
+  gpointer *slots = &allocator->depot_slots[ix * N_DEPOT_SLOTS];
+  guint i;
+  for (i = 0; i < N_DEPOT_SLOTS; i++)
+    {
+      ChunkLink *magazine = g_atomic_pointer_get (&slots[i]);
+      if (magazine && g_atomic_pointer_compare_and_exchange (&slots[i], magazine, NULL))
+        return magazine;
+    }
+  return NULL;
+}
+
+static inline ChunkLink*
+magazine_chain_hand_out (ChunkLink *current,
+                         gsize     *countp)
+{
+  /* clear special fields and hand out */
+  *countp = (gsize) magazine_chain_count (current);
+  magazine_chain_prev (current) = NULL;
+  magazine_chain_next (current) = NULL;
+  magazine_chain_count (current) = NULL;
+  magazine_chain_stamp (current) = NULL;
+  return current;
+}
+
+/* g_mutex_lock (&allocator->slab_mutex); done by caller */
+static void
+magazine_chain_free (guint      ix,
+                     ChunkLink *chunks)
+{
+  const gsize chunk_size = SLAB_CHUNK_SIZE (allocator, ix);
+  while (chunks)
+    {
+      ChunkLink *chunk = magazine_chain_pop_head (&chunks);
+      slab_allocator_free_chunk (chunk_size, chunk);
+    }
+}
+
 static void
 magazine_cache_push_magazine (guint      ix,
                               ChunkLink *magazine_chunks,
@@ -690,6 +758,9 @@ magazine_cache_push_magazine (guint      ix,
 {
   ChunkLink *current = magazine_chain_prepare_fields (magazine_chunks);
   ChunkLink *next, *prev;
+  magazine_chain_count (current) = (gpointer) count;
+  if (magazine_depot_slots_put (ix, current))
+    return;
   g_mutex_lock (&allocator->magazine_mutex);
   /* add magazine at head */
   next = allocator->magazines[ix];
@@ -701,7 +772,6 @@ magazine_cache_push_magazine (guint      ix,
   magazine_chain_prev (next) = current;
   magazine_chain_prev (current) = prev;
   magazine_chain_next (current) = next;
-  magazine_chain_count (current) = (gpointer) count;
   /* stamp magazine */
   magazine_cache_update_stamp();
   magazine_chain_stamp (current) = GUINT_TO_POINTER (allocator->last_stamp);
@@ -715,6 +785,9 @@ static ChunkLink*
 magazine_cache_pop_magazine (guint  ix,
                              gsize *countp)
 {
+  ChunkLink *magazine = magazine_depot_slots_take (ix);
+  if (magazine)
+    return magazine_chain_hand_out (magazine, countp);
   g_mutex_lock_a (&allocator->magazine_mutex, &allocator->contention_counters[ix]);
   if (!allocator->magazines[ix])
     {
@@ -747,47 +820,37 @@ magazine_cache_pop_magazine (guint  ix,
       magazine_chain_prev (next) = prev;
       allocator->magazines[ix] = next == current ? NULL : next;
       g_mutex_unlock (&allocator->magazine_mutex);
-      /* clear special fields and hand out */
-      *countp = (gsize) magazine_chain_count (current);
-      magazine_chain_prev (current) = NULL;
-      magazine_chain_next (current) = NULL;
-      magazine_chain_count (current) = NULL;
-      magazine_chain_stamp (current) = NULL;
-      return current;
+      return magazine_chain_hand_out (current, countp);
     }
 }
 
 /* --- thread magazines --- */
 static void
-private_thread_memory_cleanup (gpointer data)
+thread_memory_release_magazines (ThreadMemory *tmem)
 {
-  ThreadMemory *tmem = data;
   const guint n_magazines = MAX_SLAB_INDEX (allocator);
   guint ix;
+  /* hand the chunks straight back to the slabs instead of the depot, so
+   * pages that only an exiting (or trimming) thread used can be freed
+   */
+  g_mutex_lock (&allocator->slab_mutex);
   for (ix = 0; ix < n_magazines; ix++)
     {
-      Magazine *mags[2];
-      guint j;
-      mags[0] = &tmem->magazine1[ix];
-      mags[1] = &tmem->magazine2[ix];
-      for (j = 0; j < 2; j++)
-        {
-          Magazine *mag = mags[j];
-          if (mag->count >= MIN_MAGAZINE_SIZE)
-            magazine_cache_push_magazine (ix, mag->chunks, mag->count);
-          else
-            {
-              const gsize chunk_size = SLAB_CHUNK_SIZE (allocator, ix);
-              g_mutex_lock (&allocator->slab_mutex);
-              while (mag->chunks)
-                {
-                  ChunkLink *chunk = magazine_chain_pop_head (&mag->chunks);
-                  slab_allocator_free_chunk (chunk_size, chunk);
-                }
-              g_mutex_unlock (&allocator->slab_mutex);
-            }
-        }
+      magazine_chain_free (ix, tmem->magazine1[ix].chunks);
+      tmem->magazine1[ix].chunks = NULL;
+      tmem->magazine1[ix].count = 0;
+      magazine_chain_free (ix, tmem->magazine2[ix].chunks);
+      tmem->magazine2[ix].chunks = NULL;
+      tmem->magazine2[ix].count = 0;
     }
+  g_mutex_unlock (&allocator->slab_mutex);
+}
+
+static void
+private_thread_memory_cleanup (gpointer data)
+{
+  ThreadMemory *tmem = data;
+  thread_memory_release_magazines (tmem);
   g_free (tmem);
 }
 
@@ -1025,6 +1088,8 @@ g_slice_alloc (gsize mem_size)
     mem = g_malloc (mem_size);
   if (G_UNLIKELY (allocator->config.debug_blocks))
     smc_notify_alloc (mem, mem_size);
+  if (G_UNLIKELY (g_mem_stats_active))
+    g_mem_stats_slice_alloc (chunk_size, acat != 0);
 
   TRACE (GLIB_SLICE_ALLOC((void*)mem, mem_size));
 
@@ -1107,6 +1172,8 @@ g_slice_free1 (gsize    mem_size,
   if (G_UNLIKELY (allocator->config.debug_blocks) &&
       !smc_notify_free (mem_block, mem_size))
     abort();
+  if (G_UNLIKELY (g_mem_stats_active))
+    g_mem_stats_slice_free (chunk_size, 1);
   if (G_LIKELY (acat == 1))             /* allocate through magazine layer */
     {
       ThreadMemory *tmem = thread_memory_from_self();
@@ -1181,6 +1248,14 @@ g_slice_free_chain_with_offset (gsize    mem_size,
    */
   gsize chunk_size = P2ALIGN (mem_size);
   guint acat = allocator_categorize (chunk_size);
+  if (G_UNLIKELY (g_mem_stats_active))
+    {
+      guint n_blocks = 0;
+      for (slice = mem_chain; slice; slice = *(gpointer*) ((guint8*) slice + next_offset))
+        n_blocks++;
+      g_mem_stats_slice_free (chunk_size, n_blocks);
+      slice = mem_chain;
+    }
   if (G_LIKELY (acat == 1))             /* allocate through magazine layer */
     {
       ThreadMemory *tmem = thread_memory_from_self();
@@ -1233,6 +1308,63 @@ g_slice_free_chain_with_offset (gsize    mem_size,
       }
 }
 
+/**
+ * g_slice_trim:
+ *
+ * Returns the memory that the slice allocator keeps cached for future
+ * allocations to the system, as far as possible.
+ *
+ * This empties the caches of the calling thread and the shared cache
+ * that threads exchange blocks through; pages that no longer hold any
+ * allocated blocks are then freed.  The caches of other threads are
+ * left alone; they are emptied when those threads exit.
+ *
+ * Long-running programs can call this after a burst of activity, to
+ * keep the memory used during the burst from staying cached until the
+ * cache expires it on its own.  There is no need to call it otherwise.
+ *
+ * Since: 2.54
+ */
+void
+g_slice_trim (void)
+{
+  ThreadMemory *tmem = thread_memory_from_self ();
+  const guint n_magazines = MAX_SLAB_INDEX (allocator);
+  guint ix;
+
+  if (allocator->max_slab_chunk_size_for_magazine_cache == 0)
+    return;     /* no magazines in use */
+
+  thread_memory_release_magazines (tmem);
+
+  for (ix = 0; ix < n_magazines; ix++)
+    {
+      ChunkLink *magazine, *current;
+      gsize count;
+
+      g_mutex_lock (&allocator->magazine_mutex);
+      current = allocator->magazines[ix];
+      if (current)
+        {
+          /* break up the ring, so that it can be walked to its end */
+          magazine_chain_next (magazine_chain_prev (current)) = NULL;
+          allocator->magazines[ix] = NULL;
+        }
+      g_mutex_unlock (&allocator->magazine_mutex);
+
+      g_mutex_lock (&allocator->slab_mutex);
+      while (current)
+        {
+          ChunkLink *next = magazine_chain_next (current);
+          magazine_chain_free (ix, magazine_chain_hand_out (current, &count));
+          current = next;
+        }
+      while ((magazine = magazine_depot_slots_take (ix)))
+        magazine_chain_free (ix, magazine_chain_hand_out (magazine, &count));
+      g_mutex_unlock (&allocator->slab_mutex);
+    }
+}
+
 /* --- single page allocator --- */
 static void
 allocator_slab_stack_push (Allocator *allocator,
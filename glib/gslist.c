@@ -1011,34 +1011,45 @@ g_slist_sort_merge (GSList   *l1,
   return list.next;
 }
 
+/* A bottom-up merge sort; see g_list_sort_real() */
 static GSList *
 g_slist_sort_real (GSList   *list,
                    GFunc     compare_func,
                    gpointer  user_data)
 {
-  GSList *l1, *l2;
+  /* runs[i] is either %NULL or a run of 2^i elements, all of which
+   * were in the list before those in runs[i - 1] */
+  GSList *runs[GLIB_SIZEOF_SIZE_T * 8] = { NULL, };
+  GSList *l, *next;
+  guint i, n_runs = 0;
 
   if (!list)
     return NULL;
   if (!list->next)
     return list;
 
-  l1 = list;
-  l2 = list->next;
+  for (l = list; l != NULL; l = next)
+    {
+      next = l->next;
+      l->next = NULL;
 
-  while ((l2 = l2->next) != NULL)
+      for (i = 0; runs[i] != NULL; i++)
+        {
+          l = g_slist_sort_merge (runs[i], l, compare_func, user_data);
+          runs[i] = NULL;
+        }
+      runs[i] = l;
+      n_runs = MAX (n_runs, i + 1);
+    }
+
+  list = NULL;
+  for (i = 0; i < n_runs; i++)
     {
-      if ((l2 = l2->next) == NULL)
-        break;
-      l1=l1->next;
+      if (runs[i] != NULL)
+        list = list ? g_slist_sort_merge (runs[i], list, compare_func, user_data) : runs[i];
     }
-  l2 = l1->next;
-  l1->next = NULL;
 
-  return g_slist_sort_merge (g_slist_sort_real (list, compare_func, user_data),
-                             g_slist_sort_real (l2, compare_func, user_data),
-                             compare_func,
-                             user_data);
+  return list;
 }
 
 /**
@@ -39,6 +39,17 @@
 #include <sys/resource.h>
 #endif /* HAVE_SYS_RESOURCE_H */
 
+#ifdef HAVE_POSIX_SPAWN
+#include <spawn.h>
+
+#ifdef HAVE__NSGETENVIRON
+#include <crt_externs.h>
+#define environ (*_NSGetEnviron())
+#else
+extern char **environ;
+#endif
+#endif /* HAVE_POSIX_SPAWN */
+
 #include "gspawn.h"
 #include "gthread.h"
 #include "glib/gstdio.h"
@@ -1151,7 +1162,13 @@ do_exec (gint                  child_err_report_fd,
    */
   if (close_descriptors)
     {
-      fdwalk (set_cloexec, GINT_TO_POINTER(3));
+#if defined (HAVE_CLOSE_RANGE) && defined (CLOSE_RANGE_CLOEXEC)
+      /* One syscall, rather than one per open descriptor; older
+       * kernels fail with ENOSYS or EINVAL.
+       */
+      if (close_range (3, G_MAXUINT, CLOSE_RANGE_CLOEXEC) < 0)
+#endif
+        fdwalk (set_cloexec, GINT_TO_POINTER(3));
     }
   else
     {
@@ -1233,6 +1250,130 @@ do_exec (gint                  child_err_report_fd,
                       CHILD_EXEC_FAILED);
 }
 
+#ifdef HAVE_POSIX_SPAWN
+static gint
+spawn_redirect (posix_spawn_file_actions_t *file_actions,
+                gint                        fd,
+                gint                        target,
+                gboolean                    to_null,
+                gint                        null_mode)
+{
+  gint r;
+
+  if (fd >= 0)
+    {
+      r = posix_spawn_file_actions_adddup2 (file_actions, fd, target);
+      if (r == 0)
+        r = posix_spawn_file_actions_addclose (file_actions, fd);
+      return r;
+    }
+  else if (to_null)
+    return posix_spawn_file_actions_addopen (file_actions, target,
+                                             "/dev/null", null_mode, 0);
+
+  return 0;
+}
+
+/* Launches the child with posix_spawn(), which the C library implements
+ * with vfork() or clone (CLONE_VM), so the cost does not grow with the
+ * size of the parent's address space the way fork() does.  Only used
+ * when do_exec() would not need to run any code in the child beyond
+ * what file actions can express.
+ *
+ * @parent_fds are our ends of the pipes, which the fork() path closes
+ * in the child.  Returns 0 or an errno value; the exec failures
+ * reported by the C library land here too.
+ */
+static gint
+do_posix_spawn (gchar    **argv,
+                gchar    **envp,
+                gboolean   close_descriptors,
+                gboolean   search_path,
+                gboolean   stdout_to_null,
+                gboolean   stderr_to_null,
+                gboolean   child_inherits_stdin,
+                gboolean   file_and_argv_zero,
+                gint       stdin_fd,
+                gint       stdout_fd,
+                gint       stderr_fd,
+                const gint parent_fds[3],
+                GPid      *child_pid)
+{
+  posix_spawnattr_t attr;
+  posix_spawn_file_actions_t file_actions;
+  sigset_t sigdefault;
+  pid_t pid;
+  gint i, r;
+
+  r = posix_spawnattr_init (&attr);
+  if (r != 0)
+    return r;
+
+  r = posix_spawn_file_actions_init (&file_actions);
+  if (r != 0)
+    {
+      posix_spawnattr_destroy (&attr);
+      return r;
+    }
+
+  /* The same signals the fork() path resets */
+  sigemptyset (&sigdefault);
+  sigaddset (&sigdefault, SIGCHLD);
+  sigaddset (&sigdefault, SIGINT);
+  sigaddset (&sigdefault, SIGTERM);
+  sigaddset (&sigdefault, SIGHUP);
+  sigaddset (&sigdefault, SIGPIPE);
+
+  r = posix_spawnattr_setsigdefault (&attr, &sigdefault);
+  if (r == 0)
+    r = posix_spawnattr_setflags (&attr, POSIX_SPAWN_SETSIGDEF);
+
+  for (i = 0; r == 0 && i < 3; i++)
+    if (parent_fds[i] >= 0)
+      r = posix_spawn_file_actions_addclose (&file_actions, parent_fds[i]);
+
+  if (r == 0)
+    r = spawn_redirect (&file_actions, stdin_fd, 0,
+                        !child_inherits_stdin, O_RDONLY);
+  if (r == 0)
+    r = spawn_redirect (&file_actions, stdout_fd, 1,
+                        stdout_to_null, O_WRONLY);
+  if (r == 0)
+    r = spawn_redirect (&file_actions, stderr_fd, 2,
+                        stderr_to_null, O_WRONLY);
+
+#ifdef HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCLOSEFROM_NP
+  if (r == 0 && close_descriptors)
+    r = posix_spawn_file_actions_addclosefrom_np (&file_actions, 3);
+#else
+  g_assert (!close_descriptors);
+#endif
+
+  if (r == 0)
+    {
+      gchar **child_argv = file_and_argv_zero ? argv + 1 : argv;
+
+      if (envp == NULL)
+        envp = environ;
+
+      if (search_path)
+        r = posix_spawnp (&pid, argv[0], &file_actions, &attr,
+                          child_argv, envp);
+      else
+        r = posix_spawn (&pid, argv[0], &file_actions, &attr,
+                         child_argv, envp);
+    }
+
+  if (r == 0)
+    *child_pid = pid;
+
+  posix_spawn_file_actions_destroy (&file_actions);
+  posix_spawnattr_destroy (&attr);
+
+  return r;
+}
+#endif /* HAVE_POSIX_SPAWN */
+
 static gboolean
 read_ints (int      fd,
            gint*    buf,
@@ -1327,6 +1468,69 @@ fork_exec_with_pipes (gboolean              intermediate_child,
   if (standard_error && !g_unix_open_pipe (stderr_pipe, FD_CLOEXEC, error))
     goto cleanup_and_fail;
 
+#ifdef HAVE_POSIX_SPAWN
+  /* Without an intermediate child, a working directory or a child
+   * setup function there is nothing left that needs fork().  The child
+   * ends of the pipes must not already sit on 0, 1 or 2, since dup2()
+   * onto itself would not clear FD_CLOEXEC.
+   */
+  if (!intermediate_child &&
+      working_directory == NULL &&
+      child_setup == NULL &&
+      !search_path_from_envp &&
+#ifndef HAVE_POSIX_SPAWN_FILE_ACTIONS_ADDCLOSEFROM_NP
+      !close_descriptors &&
+#endif
+      (stdin_pipe[0] < 0 || stdin_pipe[0] > 2) &&
+      (stdout_pipe[1] < 0 || stdout_pipe[1] > 2) &&
+      (stderr_pipe[1] < 0 || stderr_pipe[1] > 2))
+    {
+      gint parent_fds[3] = { stdin_pipe[1], stdout_pipe[0], stderr_pipe[0] };
+      gint errsv;
+
+      errsv = do_posix_spawn (argv,
+                              envp,
+                              close_descriptors,
+                              search_path,
+                              stdout_to_null,
+                              stderr_to_null,
+                              child_inherits_stdin,
+                              file_and_argv_zero,
+                              stdin_pipe[0],
+                              stdout_pipe[1],
+                              stderr_pipe[1],
+                              parent_fds,
+                              &pid);
+
+      if (errsv == 0)
+        {
+          close_and_invalidate (&child_err_report_pipe[0]);
+          close_and_invalidate (&child_err_report_pipe[1]);
+          close_and_invalidate (&stdin_pipe[0]);
+          close_and_invalidate (&stdout_pipe[1]);
+          close_and_invalidate (&stderr_pipe[1]);
+
+          goto success;
+        }
+
+      /* g_execute() runs scripts without a #! line through /bin/sh,
+       * which posix_spawn() does not; leave those to the fork() path.
+       */
+      if (errsv != ENOEXEC)
+        {
+          pid = -1;
+          g_set_error (error,
+                       G_SPAWN_ERROR,
+                       exec_err_to_g_error (errsv),
+                       _("Failed to execute child process “%s” (%s)"),
+                       argv[0],
+                       g_strerror (errsv));
+
+          goto cleanup_and_fail;
+        }
+    }
+#endif /* HAVE_POSIX_SPAWN */
+
   pid = fork ();
 
   if (pid < 0)
@@ -1560,7 +1764,8 @@ fork_exec_with_pipes (gboolean              intermediate_child,
       /* Success against all odds! return the information */
       close_and_invalidate (&child_err_report_pipe[0]);
       close_and_invalidate (&child_pid_report_pipe[0]);
- 
+
+    success:
       if (child_pid)
         *child_pid = pid;
 
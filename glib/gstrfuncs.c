@@ -50,10 +50,16 @@
 
 #include "gstrfuncs.h"
 
+#include "garray.h"
 #include "gprintf.h"
 #include "gprintfint.h"
 #include "glibintl.h"
 
+#if defined (__SSE2__) || defined (_M_X64) || defined (_M_AMD64) || \
+    (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define USE_SSE2 1
+#endif
 
 /**
  * SECTION:string_utils
@@ -1491,6 +1497,41 @@ g_strlcat (gchar       *dest,
 }
 #endif /* ! HAVE_STRLCPY */
 
+/* Flips the case of every byte of @str in the range @first to @last,
+ * which must be one of the two ranges of ASCII letters.  Flipping is
+ * an xor with 0x20, so the SSE2 version handles 16 bytes at a time
+ * without any branches.  Bytes with the high bit set compare as
+ * negative and are never in range.
+ */
+static void
+ascii_flip_case (gchar *str,
+                 gsize  len,
+                 gchar  first,
+                 gchar  last)
+{
+  gsize i = 0;
+
+#ifdef USE_SSE2
+  const __m128i below = _mm_set1_epi8 (first - 1);
+  const __m128i above = _mm_set1_epi8 (last + 1);
+  const __m128i bit = _mm_set1_epi8 (0x20);
+
+  for (; i + 16 <= len; i += 16)
+    {
+      __m128i v = _mm_loadu_si128 ((const __m128i *) (str + i));
+      __m128i in_range = _mm_and_si128 (_mm_cmpgt_epi8 (v, below),
+                                        _mm_cmplt_epi8 (v, above));
+
+      v = _mm_xor_si128 (v, _mm_and_si128 (in_range, bit));
+      _mm_storeu_si128 ((__m128i *) (str + i), v);
+    }
+#endif
+
+  for (; i < len; i++)
+    if (str[i] >= first && str[i] <= last)
+      str[i] ^= 0x20;
+}
+
 /**
  * g_ascii_strdown:
  * @str: a string
@@ -1507,7 +1548,7 @@ gchar*
 g_ascii_strdown (const gchar *str,
                  gssize       len)
 {
-  gchar *result, *s;
+  gchar *result;
 
   g_return_val_if_fail (str != NULL, NULL);
 
@@ -1515,8 +1556,8 @@ g_ascii_strdown (const gchar *str,
     len = strlen (str);
 
   result = g_strndup (str, len);
-  for (s = result; *s; s++)
-    *s = g_ascii_tolower (*s);
+  /* g_strndup() pads with nuls after an embedded nul, which is left alone */
+  ascii_flip_case (result, len, 'A', 'Z');
 
   return result;
 }
@@ -1537,7 +1578,7 @@ gchar*
 g_ascii_strup (const gchar *str,
                gssize       len)
 {
-  gchar *result, *s;
+  gchar *result;
 
   g_return_val_if_fail (str != NULL, NULL);
 
@@ -1545,8 +1586,8 @@ g_ascii_strup (const gchar *str,
     len = strlen (str);
 
   result = g_strndup (str, len);
-  for (s = result; *s; s++)
-    *s = g_ascii_toupper (*s);
+  /* g_strndup() pads with nuls after an embedded nul, which is left alone */
+  ascii_flip_case (result, len, 'a', 'z');
 
   return result;
 }
@@ -1798,10 +1839,14 @@ g_ascii_strcasecmp (const gchar *s1,
 
   while (*s1 && *s2)
     {
-      c1 = (gint)(guchar) TOLOWER (*s1);
-      c2 = (gint)(guchar) TOLOWER (*s2);
-      if (c1 != c2)
-        return (c1 - c2);
+      /* Identical bytes are the common case and need no folding */
+      if (*s1 != *s2)
+        {
+          c1 = (gint)(guchar) TOLOWER (*s1);
+          c2 = (gint)(guchar) TOLOWER (*s2);
+          if (c1 != c2)
+            return (c1 - c2);
+        }
       s1++; s2++;
     }
 
@@ -2138,12 +2183,24 @@ g_strescape (const gchar *source,
   gchar *dest;
   gchar *q;
   guchar excmap[256];
+  gsize len;
+#ifdef USE_SSE2
+  const guchar *end;
+  const __m128i space = _mm_set1_epi8 (' ');
+  const __m128i del = _mm_set1_epi8 (0177);
+  const __m128i backslash = _mm_set1_epi8 ('\\');
+  const __m128i quote = _mm_set1_epi8 ('"');
+#endif
 
   g_return_val_if_fail (source != NULL, NULL);
 
   p = (guchar *) source;
+  len = strlen (source);
   /* Each source byte needs maximally four destination chars (\777) */
-  q = dest = g_malloc (strlen (source) * 4 + 1);
+  q = dest = g_malloc (len * 4 + 1);
+#ifdef USE_SSE2
+  end = p + len;
+#endif
 
   memset (excmap, 0, 256);
   if (exceptions)
@@ -2159,6 +2216,33 @@ g_strescape (const gchar *source,
 
   while (*p)
     {
+#ifdef USE_SSE2
+      /* Copy runs of bytes that never need escaping 16 at a time.
+       * Anything else takes the byte-wise path below, even when it is
+       * listed in @exceptions.  Bytes with the high bit set compare as
+       * negative, so they are caught by the test against ' '.
+       */
+      while (p + 16 <= end)
+        {
+          __m128i v = _mm_loadu_si128 ((const __m128i *) p);
+          __m128i special;
+
+          special = _mm_or_si128 (_mm_cmplt_epi8 (v, space),
+                                  _mm_cmpeq_epi8 (v, del));
+          special = _mm_or_si128 (special,
+                                  _mm_or_si128 (_mm_cmpeq_epi8 (v, backslash),
+                                                _mm_cmpeq_epi8 (v, quote)));
+          if (_mm_movemask_epi8 (special) != 0)
+            break;
+
+          _mm_storeu_si128 ((__m128i *) q, v);
+          p += 16;
+          q += 16;
+        }
+      if (!*p)
+        break;
+#endif
+
       if (excmap[*p])
         *q++ = *p;
       else
@@ -2283,6 +2367,18 @@ g_strchomp (gchar *string)
   return string;
 }
 
+/* strchr() is usually much faster than strstr() for a single byte */
+static inline const gchar *
+find_delimiter (const gchar *string,
+                const gchar *delimiter,
+                gsize        delimiter_len)
+{
+  if (delimiter_len == 1)
+    return strchr (string, delimiter[0]);
+
+  return strstr (string, delimiter);
+}
+
 /**
  * g_strsplit:
  * @string: a string to split
@@ -2315,10 +2411,9 @@ g_strsplit (const gchar *string,
             const gchar *delimiter,
             gint         max_tokens)
 {
-  GSList *string_list = NULL, *slist;
-  gchar **str_array, *s;
-  guint n = 0;
-  const gchar *remainder;
+  GPtrArray *tokens;
+  gsize delimiter_len;
+  const gchar *remainder, *s;
 
   g_return_val_if_fail (string != NULL, NULL);
   g_return_val_if_fail (delimiter != NULL, NULL);
@@ -2327,39 +2422,81 @@ g_strsplit (const gchar *string,
   if (max_tokens < 1)
     max_tokens = G_MAXINT;
 
+  tokens = g_ptr_array_new ();
+  delimiter_len = strlen (delimiter);
   remainder = string;
-  s = strstr (remainder, delimiter);
-  if (s)
-    {
-      gsize delimiter_len = strlen (delimiter);
 
-      while (--max_tokens && s)
-        {
-          gsize len;
-
-          len = s - remainder;
-          string_list = g_slist_prepend (string_list,
-                                         g_strndup (remainder, len));
-          n++;
-          remainder = s + delimiter_len;
-          s = strstr (remainder, delimiter);
-        }
-    }
-  if (*string)
+  while (--max_tokens &&
+         (s = find_delimiter (remainder, delimiter, delimiter_len)) != NULL)
     {
-      n++;
-      string_list = g_slist_prepend (string_list, g_strdup (remainder));
+      g_ptr_array_add (tokens, g_strndup (remainder, s - remainder));
+      remainder = s + delimiter_len;
     }
+  if (*string)
+    g_ptr_array_add (tokens, g_strdup (remainder));
+
+  g_ptr_array_add (tokens, NULL);
+
+  return (gchar **) g_ptr_array_free (tokens, FALSE);
+}
+
+/**
+ * g_strsplit_in_place:
+ * @string: a string to split, which is modified
+ * @delimiter: a string which specifies the places at which to split
+ *     the string. The delimiter is not included in any of the resulting
+ *     strings, unless @max_tokens is reached.
+ * @max_tokens: the maximum number of pieces to split @string into.
+ *     If this is less than 1, the string is split completely.
+ *
+ * Splits a string like g_strsplit(), but without copying the tokens:
+ * the first byte of every delimiter occurrence that separates two
+ * tokens is overwritten with a nul byte, and the returned vector points
+ * into @string.
+ *
+ * This avoids one allocation per token, which matters when splitting
+ * many short strings, such as protocol headers, that are going to be
+ * thrown away anyway. The tokens are only valid as long as @string is.
+ *
+ * Returns: (transfer container): a newly-allocated %NULL-terminated
+ *    array of pointers into @string. Free it with g_free(), not
+ *    g_strfreev().
+ *
+ * Since: 2.54
+ */
+gchar **
+g_strsplit_in_place (gchar       *string,
+                     const gchar *delimiter,
+                     gint         max_tokens)
+{
+  GPtrArray *tokens;
+  gsize delimiter_len;
+  gchar *remainder, *s;
 
-  str_array = g_new (gchar*, n + 1);
+  g_return_val_if_fail (string != NULL, NULL);
+  g_return_val_if_fail (delimiter != NULL, NULL);
+  g_return_val_if_fail (delimiter[0] != '\0', NULL);
+
+  if (max_tokens < 1)
+    max_tokens = G_MAXINT;
 
-  str_array[n--] = NULL;
-  for (slist = string_list; slist; slist = slist->next)
-    str_array[n--] = slist->data;
+  tokens = g_ptr_array_new ();
+  delimiter_len = strlen (delimiter);
+  remainder = string;
+
+  while (--max_tokens &&
+         (s = (gchar *) find_delimiter (remainder, delimiter, delimiter_len)) != NULL)
+    {
+      g_ptr_array_add (tokens, remainder);
+      *s = '\0';
+      remainder = s + delimiter_len;
+    }
+  if (*string || tokens->len > 0)
+    g_ptr_array_add (tokens, remainder);
 
-  g_slist_free (string_list);
+  g_ptr_array_add (tokens, NULL);
 
-  return str_array;
+  return (gchar **) g_ptr_array_free (tokens, FALSE);
 }
 
 /**
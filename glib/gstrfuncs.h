@@ -274,6 +274,10 @@ GLIB_AVAILABLE_IN_ALL
 gchar **	      g_strsplit_set   (const gchar *string,
 					const gchar *delimiters,
 					gint         max_tokens) G_GNUC_MALLOC;
+GLIB_AVAILABLE_IN_2_54
+gchar **	      g_strsplit_in_place (gchar       *string,
+					   const gchar *delimiter,
+					   gint         max_tokens) G_GNUC_MALLOC;
 GLIB_AVAILABLE_IN_ALL
 gchar*                g_strjoinv       (const gchar  *separator,
 					gchar       **str_array) G_GNUC_MALLOC;
@@ -36,6 +36,7 @@
 
 #include "gstring.h"
 
+#include "garena.h"
 #include "gprintf.h"
 
 
@@ -72,6 +73,15 @@
  */
 
 
+/* Every GString is allocated as a GRealString; since GString is 24 bytes
+ * on 64-bit systems, the extra pointer fits into the same slice.
+ */
+typedef struct
+{
+  GString  string;
+  GArena  *arena;
+} GRealString;
+
 #define MY_MAXSIZE ((gsize)-1)
 
 static inline gsize
@@ -92,15 +102,27 @@ nearest_power (gsize base, gsize num)
     }
 }
 
+static void
+g_string_set_allocated_len (GString *string,
+                            gsize    allocated_len)
+{
+  GArena *arena = ((GRealString *) string)->arena;
+
+  if (G_UNLIKELY (arena))
+    string->str = g_arena_realloc (arena, string->str,
+                                   string->allocated_len, allocated_len);
+  else
+    string->str = g_realloc (string->str, allocated_len);
+
+  string->allocated_len = allocated_len;
+}
+
 static void
 g_string_maybe_expand (GString *string,
                        gsize    len)
 {
   if (string->len + len >= string->allocated_len)
-    {
-      string->allocated_len = nearest_power (1, string->len + len + 1);
-      string->str = g_realloc (string->str, string->allocated_len);
-    }
+    g_string_set_allocated_len (string, nearest_power (1, string->len + len + 1));
 }
 
 /**
@@ -118,8 +140,10 @@ g_string_maybe_expand (GString *string,
 GString *
 g_string_sized_new (gsize dfl_size)
 {
-  GString *string = g_slice_new (GString);
+  GRealString *rstring = g_slice_new (GRealString);
+  GString *string = &rstring->string;
 
+  rstring->arena = NULL;
   string->allocated_len = 0;
   string->len   = 0;
   string->str   = NULL;
@@ -130,6 +154,56 @@ g_string_sized_new (gsize dfl_size)
   return string;
 }
 
+/**
+ * g_string_new_in_arena:
+ * @arena: a #GArena
+ * @init: (nullable): the initial text to copy into the string, or %NULL to
+ * start with an empty string
+ *
+ * Creates a new #GString inside @arena, initialized with the given
+ * string, like g_string_new().
+ *
+ * The #GString and its character data are allocated from @arena, also
+ * when the string grows; they are released along with @arena and stay
+ * valid until then.  The string may be left for @arena to release, or
+ * be freed with g_string_free() as usual, which then gives no memory
+ * back.  If the character data is kept by passing %FALSE to
+ * g_string_free(), it belongs to @arena and must not be freed with
+ * g_free().
+ *
+ * Returns: (transfer none): the new #GString
+ *
+ * Since: 2.54
+ */
+GString *
+g_string_new_in_arena (GArena      *arena,
+                       const gchar *init)
+{
+  GRealString *rstring;
+  GString *string;
+  gsize len;
+
+  g_return_val_if_fail (arena != NULL, NULL);
+
+  len = init ? strlen (init) : 0;
+
+  rstring = g_arena_alloc (arena, sizeof (GRealString));
+  rstring->arena = arena;
+
+  string = &rstring->string;
+  string->allocated_len = 0;
+  string->len = 0;
+  string->str = NULL;
+
+  g_string_maybe_expand (string, MAX (len, 2));
+  string->str[0] = 0;
+
+  if (len)
+    g_string_append_len (string, init, len);
+
+  return string;
+}
+
 /**
  * g_string_new:
  * @init: (nullable): the initial text to copy into the string, or %NULL to
@@ -210,10 +284,15 @@ gchar *
 g_string_free (GString  *string,
                gboolean  free_segment)
 {
+  GRealString *rstring = (GRealString *) string;
   gchar *segment;
 
   g_return_val_if_fail (string != NULL, NULL);
 
+  /* Everything belongs to the arena */
+  if (rstring->arena)
+    return free_segment ? NULL : string->str;
+
   if (free_segment)
     {
       g_free (string->str);
@@ -222,7 +301,7 @@ g_string_free (GString  *string,
   else
     segment = string->str;
 
-  g_slice_free (GString, string);
+  g_slice_free (GRealString, rstring);
 
   return segment;
 }
@@ -253,6 +332,9 @@ g_string_free_to_bytes (GString *string)
 
   len = string->len;
 
+  if (((GRealString *) string)->arena)
+    return g_bytes_new (string->str, len);
+
   buf = g_string_free (string, FALSE);
 
   return g_bytes_new_take (buf, len);
@@ -401,6 +483,66 @@ g_string_set_size (GString *string,
   return string;
 }
 
+/**
+ * g_string_reserve:
+ * @string: a #GString
+ * @len: the number of bytes to make room for
+ *
+ * Makes sure that @len more bytes can be added to @string without it
+ * being reallocated.
+ *
+ * Unlike the growth that happens as text is added, which rounds up to
+ * the next power of two, this allocates exactly the requested space.
+ * When the final size of a large string is known in advance, this
+ * avoids both the copies made while growing it and the up to twice
+ * as much memory that rounding up can leave unused.
+ *
+ * Returns: (transfer none): @string
+ *
+ * Since: 2.54
+ */
+GString *
+g_string_reserve (GString *string,
+                  gsize    len)
+{
+  g_return_val_if_fail (string != NULL, NULL);
+  g_return_val_if_fail (len < MY_MAXSIZE - string->len, NULL);
+
+  if (string->len + len >= string->allocated_len)
+    g_string_set_allocated_len (string, string->len + len + 1);
+
+  return string;
+}
+
+/**
+ * g_string_shrink_to_fit:
+ * @string: a #GString
+ *
+ * Reallocates the character data of @string to take no more memory
+ * than its contents and the trailing nul byte need.  Adding to @string
+ * afterwards reallocates it again.
+ *
+ * This is useful before keeping a large string around for a long
+ * time, or before handing its data over with g_string_free() or
+ * g_string_free_to_bytes().  It has no effect on strings created with
+ * g_string_new_in_arena(), since arenas do not give memory back.
+ *
+ * Returns: (transfer none): @string
+ *
+ * Since: 2.54
+ */
+GString *
+g_string_shrink_to_fit (GString *string)
+{
+  g_return_val_if_fail (string != NULL, NULL);
+
+  if (((GRealString *) string)->arena == NULL &&
+      string->allocated_len > string->len + 1)
+    g_string_set_allocated_len (string, string->len + 1);
+
+  return string;
+}
+
 /**
  * g_string_insert_len:
  * @string: a #GString
@@ -1133,21 +1275,39 @@ g_string_append_vprintf (GString     *string,
                          const gchar *format,
                          va_list      args)
 {
+  gchar stack_buf[256];
   gchar *buf;
+  va_list args2;
   gint len;
 
   g_return_if_fail (string != NULL);
   g_return_if_fail (format != NULL);
 
-  len = g_vasprintf (&buf, format, args);
+  /* The arguments might point into @string, so the text can't be
+   * formatted in place.  Short pieces, the common case when building
+   * up a large string, go through the stack without any allocation.
+   */
+  G_VA_COPY (args2, args);
+  len = g_vsnprintf (stack_buf, sizeof stack_buf, format, args2);
+  va_end (args2);
 
-  if (len >= 0)
+  if (len < 0)
+    return;
+
+  if ((gsize) len < sizeof stack_buf)
+    buf = stack_buf;
+  else
     {
-      g_string_maybe_expand (string, len);
-      memcpy (string->str + string->len, buf, len + 1);
-      string->len += len;
-      g_free (buf);
+      buf = g_malloc (len + 1);
+      g_vsnprintf (buf, len + 1, format, args);
     }
+
+  g_string_maybe_expand (string, len);
+  memcpy (string->str + string->len, buf, len + 1);
+  string->len += len;
+
+  if (buf != stack_buf)
+    g_free (buf);
 }
 
 /**
@@ -30,6 +30,7 @@
 #endif
 
 #include <glib/gtypes.h>
+#include <glib/garena.h>
 #include <glib/gunicode.h>
 #include <glib/gbytes.h>
 #include <glib/gutils.h>  /* for G_CAN_INLINE */
@@ -52,6 +53,9 @@ GString*     g_string_new_len           (const gchar     *init,
                                          gssize           len);
 GLIB_AVAILABLE_IN_ALL
 GString*     g_string_sized_new         (gsize            dfl_size);
+GLIB_AVAILABLE_IN_2_54
+GString*     g_string_new_in_arena      (GArena          *arena,
+                                         const gchar     *init);
 GLIB_AVAILABLE_IN_ALL
 gchar*       g_string_free              (GString         *string,
                                          gboolean         free_segment);
@@ -71,6 +75,11 @@ GString*     g_string_truncate          (GString         *string,
 GLIB_AVAILABLE_IN_ALL
 GString*     g_string_set_size          (GString         *string,
                                          gsize            len);
+GLIB_AVAILABLE_IN_2_54
+GString*     g_string_reserve           (GString         *string,
+                                         gsize            len);
+GLIB_AVAILABLE_IN_2_54
+GString*     g_string_shrink_to_fit     (GString         *string);
 GLIB_AVAILABLE_IN_ALL
 GString*     g_string_insert_len        (GString         *string,
                                          gssize           pos,
@@ -32,8 +32,8 @@
 
 #include "gstringchunk.h"
 
-#include "ghash.h"
 #include "gslist.h"
+#include "gmem.h"
 #include "gmessages.h"
 
 #include "gutils.h"
@@ -53,7 +53,9 @@
  * needed, and less memory is wasted in memory allocation overheads.
  *
  * By adding strings with g_string_chunk_insert_const() it is also
- * possible to remove duplicates.
+ * possible to remove duplicates. The table used to find duplicates
+ * stores the hash and length of each string next to it, so a lookup
+ * usually compares the bytes of at most one string.
  *
  * To create a new #GStringChunk use g_string_chunk_new().
  *
@@ -73,11 +75,21 @@
  * An opaque data structure representing String Chunks.
  * It should only be accessed by using the following functions.
  */
+typedef struct
+{
+  gchar *string;   /* NULL for an empty slot */
+  gsize  length;
+  guint  hash;
+} ConstEntry;
+
 struct _GStringChunk
 {
-  GHashTable *const_table;
+  ConstEntry *const_table;
+  gsize       const_size;   /* 0 or a power of two */
+  gsize       n_const;
   GSList     *storage_list;
   gsize       storage_next;
+  gsize       storage_size; /* sum of the sizes of the blocks */
   gsize       this_size;
   gsize       default_size;
 };
@@ -123,8 +135,11 @@ g_string_chunk_new (gsize size)
   actual_size = nearest_power (1, size);
 
   new_chunk->const_table  = NULL;
+  new_chunk->const_size   = 0;
+  new_chunk->n_const      = 0;
   new_chunk->storage_list = NULL;
   new_chunk->storage_next = actual_size;
+  new_chunk->storage_size = 0;
   new_chunk->default_size = actual_size;
   new_chunk->this_size    = actual_size;
 
@@ -147,9 +162,7 @@ g_string_chunk_free (GStringChunk *chunk)
   if (chunk->storage_list)
     g_slist_free_full (chunk->storage_list, g_free);
 
-  if (chunk->const_table)
-    g_hash_table_destroy (chunk->const_table);
-
+  g_free (chunk->const_table);
   g_free (chunk);
 }
 
@@ -174,11 +187,15 @@ g_string_chunk_clear (GStringChunk *chunk)
 
       chunk->storage_list = NULL;
       chunk->storage_next = chunk->default_size;
+      chunk->storage_size = 0;
       chunk->this_size    = chunk->default_size;
     }
 
-  if (chunk->const_table)
-      g_hash_table_remove_all (chunk->const_table);
+  if (chunk->n_const > 0)
+    {
+      memset (chunk->const_table, 0, chunk->const_size * sizeof (ConstEntry));
+      chunk->n_const = 0;
+    }
 }
 
 /**
@@ -236,22 +253,112 @@ gchar*
 g_string_chunk_insert_const (GStringChunk *chunk,
                              const gchar  *string)
 {
-  char* lookup;
+  g_return_val_if_fail (chunk != NULL, NULL);
+
+  return g_string_chunk_insert_const_len (chunk, string, -1);
+}
+
+/* the same function as g_str_hash(), over @length bytes */
+static inline guint
+const_hash (const gchar *string,
+            gsize        length)
+{
+  const signed char *p = (const signed char *) string;
+  const signed char *end = p + length;
+  guint32 h = 5381;
+
+  for (; p < end; p++)
+    h = (h << 5) + h + *p;
+
+  return h;
+}
+
+static void
+const_table_resize (GStringChunk *chunk)
+{
+  ConstEntry *old_table = chunk->const_table;
+  gsize old_size = chunk->const_size;
+  gsize mask, i, j;
+
+  chunk->const_size = old_size ? old_size * 2 : 64;
+  chunk->const_table = g_new0 (ConstEntry, chunk->const_size);
+  mask = chunk->const_size - 1;
+
+  for (i = 0; i < old_size; i++)
+    {
+      if (old_table[i].string == NULL)
+        continue;
+
+      for (j = old_table[i].hash & mask;
+           chunk->const_table[j].string != NULL;
+           j = (j + 1) & mask)
+        ;
+
+      chunk->const_table[j] = old_table[i];
+    }
+
+  g_free (old_table);
+}
+
+/**
+ * g_string_chunk_insert_const_len:
+ * @chunk: a #GStringChunk
+ * @string: bytes to insert
+ * @len: number of bytes of @string to insert, or -1 to insert a
+ *     nul-terminated string
+ *
+ * Adds a copy of the first @len bytes of @string to the #GStringChunk,
+ * unless the same bytes have already been added to the #GStringChunk
+ * with g_string_chunk_insert_const() or
+ * g_string_chunk_insert_const_len().  The copy is nul-terminated.
+ *
+ * This is like g_string_chunk_insert_const(), but @string need not be
+ * nul-terminated, which avoids a copy when the strings to be added are
+ * parts of a larger buffer.  Two strings are only considered the same
+ * if they have the same length, so @string may contain nul bytes.
+ *
+ * Returns: a pointer to the new or existing copy of @string
+ *     within the #GStringChunk
+ *
+ * Since: 2.54
+ */
+gchar *
+g_string_chunk_insert_const_len (GStringChunk *chunk,
+                                 const gchar  *string,
+                                 gssize        len)
+{
+  ConstEntry *entry;
+  gsize length, mask, i;
+  guint hash;
 
   g_return_val_if_fail (chunk != NULL, NULL);
+  g_return_val_if_fail (len == 0 || string != NULL, NULL);
+
+  length = len < 0 ? strlen (string) : (gsize) len;
+  hash = const_hash (string, length);
 
-  if (!chunk->const_table)
-    chunk->const_table = g_hash_table_new (g_str_hash, g_str_equal);
+  /* keep the table at most half full, so probe sequences stay short */
+  if (chunk->n_const >= chunk->const_size / 2)
+    const_table_resize (chunk);
 
-  lookup = (char*) g_hash_table_lookup (chunk->const_table, (gchar *)string);
+  mask = chunk->const_size - 1;
 
-  if (!lookup)
+  for (i = hash & mask; chunk->const_table[i].string != NULL; i = (i + 1) & mask)
     {
-      lookup = g_string_chunk_insert (chunk, string);
-      g_hash_table_insert (chunk->const_table, lookup, lookup);
+      entry = &chunk->const_table[i];
+
+      if (entry->hash == hash && entry->length == length &&
+          memcmp (entry->string, string, length) == 0)
+        return entry->string;
     }
 
-  return lookup;
+  entry = &chunk->const_table[i];
+  entry->string = g_string_chunk_insert_len (chunk, string, length);
+  entry->length = length;
+  entry->hash = hash;
+  chunk->n_const++;
+
+  return entry->string;
 }
 
 /**
@@ -299,6 +406,7 @@ g_string_chunk_insert_len (GStringChunk *chunk,
 
       chunk->this_size = new_size;
       chunk->storage_next = 0;
+      chunk->storage_size += new_size;
     }
 
   pos = ((gchar *) chunk->storage_list->data) + chunk->storage_next;
@@ -311,3 +419,28 @@ g_string_chunk_insert_len (GStringChunk *chunk,
 
   return pos;
 }
+
+/**
+ * g_string_chunk_get_memory_size:
+ * @chunk: a #GStringChunk
+ *
+ * Returns the number of bytes of memory that @chunk has allocated,
+ * both for the blocks holding the strings and for the table used by
+ * g_string_chunk_insert_const() to find duplicates.
+ *
+ * This is meant for monitoring memory use; it does not include the
+ * overhead of the memory allocator.
+ *
+ * Returns: the number of bytes allocated by @chunk
+ *
+ * Since: 2.54
+ */
+gsize
+g_string_chunk_get_memory_size (GStringChunk *chunk)
+{
+  g_return_val_if_fail (chunk != NULL, 0);
+
+  return sizeof (GStringChunk) +
+         chunk->storage_size +
+         chunk->const_size * sizeof (ConstEntry);
+}
@@ -51,6 +51,12 @@ gchar*        g_string_chunk_insert_len   (GStringChunk *chunk,
 GLIB_AVAILABLE_IN_ALL
 gchar*        g_string_chunk_insert_const (GStringChunk *chunk,
                                            const gchar  *string);
+GLIB_AVAILABLE_IN_2_54
+gchar*        g_string_chunk_insert_const_len (GStringChunk *chunk,
+                                               const gchar  *string,
+                                               gssize        len);
+GLIB_AVAILABLE_IN_2_54
+gsize         g_string_chunk_get_memory_size  (GStringChunk *chunk);
 
 G_END_DECLS
 
@@ -705,6 +705,8 @@ static char       *test_trap_last_stderr = NULL;
 static char       *test_uri_base = NULL;
 static gboolean    test_debug_log = FALSE;
 static gboolean    test_tap_log = FALSE;
+static gdouble     test_bench_time = 1.0;
+static const char *test_bench_json = NULL;
 static gboolean    test_nonfatal_assertions = FALSE;
 static DestroyEntry *test_destroy_queue = NULL;
 static char       *test_argv0 = NULL;
@@ -1032,6 +1034,32 @@ parse_args (gint    *argc_p,
             g_error ("unknown test mode: -m %s", mode);
           argv[i] = NULL;
         }
+      else if (strcmp ("--bench-time", argv[i]) == 0 || strncmp ("--bench-time=", argv[i], 13) == 0)
+        {
+          gchar *equal = argv[i] + 12;
+          if (*equal == '=')
+            test_bench_time = g_ascii_strtod (equal + 1, NULL);
+          else if (i + 1 < argc)
+            {
+              argv[i++] = NULL;
+              test_bench_time = g_ascii_strtod (argv[i], NULL);
+            }
+          if (!(test_bench_time > 0))
+            g_error ("invalid benchmark time: %s", argv[i]);
+          argv[i] = NULL;
+        }
+      else if (strcmp ("--bench-json", argv[i]) == 0 || strncmp ("--bench-json=", argv[i], 13) == 0)
+        {
+          gchar *equal = argv[i] + 12;
+          if (*equal == '=')
+            test_bench_json = equal + 1;
+          else if (i + 1 < argc)
+            {
+              argv[i++] = NULL;
+              test_bench_json = argv[i];
+            }
+          argv[i] = NULL;
+        }
       else if (strcmp ("-q", argv[i]) == 0 || strcmp ("--quiet", argv[i]) == 0)
         {
           mutable_test_config_vars.test_quiet = TRUE;
@@ -1077,6 +1105,8 @@ parse_args (gint    *argc_p,
                   "  -p TESTPATH                    Only start test cases matching TESTPATH\n"
                   "  -s TESTPATH                    Skip all tests matching TESTPATH\n"
                   "  --seed=SEEDSTRING              Start tests with random seed SEEDSTRING\n"
+                  "  --bench-time=SECONDS           Spend about SECONDS measuring each benchmark\n"
+                  "  --bench-json=FILE              Append benchmark results to FILE as JSON\n"
                   "  --debug-log                    debug test logging output\n"
                   "  -q, --quiet                    Run tests quietly\n"
                   "  --verbose                      Run tests verbosely\n",
@@ -1136,6 +1166,10 @@ parse_args (gint    *argc_p,
  *   `no-undefined`: Avoid tests for undefined behaviour
  *
  * - `--debug-log`: Debug test logging output.
+ * - `--bench-time=SECONDS`: How long to spend measuring each benchmark
+ *   added with g_test_add_bench(), 1 second by default. Since: 2.54
+ * - `--bench-json=FILE`: Append the results of benchmarks to FILE, one
+ *   JSON object per line. Since: 2.54
  *
  * Since: 2.16
  */
@@ -1985,6 +2019,250 @@ g_test_add_data_func_full (const char     *testpath,
                      (GTestFixtureFunc) data_free_func);
 }
 
+/* number of samples a benchmark is measured in, and how few of them
+ * are enough if a single sample takes longer than expected
+ */
+#define TEST_BENCH_SAMPLES      100
+#define TEST_BENCH_MIN_SAMPLES  5
+
+typedef struct {
+  GTestBenchFunc bench_func;
+  gconstpointer  bench_data;
+} TestBench;
+
+#if defined (__GNUC__) && (defined (__i386__) || defined (__x86_64__))
+#define TEST_BENCH_HAVE_CYCLES 1
+
+/* the time stamp counter, which ticks at a constant rate close to the
+ * nominal frequency of the CPU
+ */
+static inline guint64
+test_bench_cycles (void)
+{
+  guint32 lo, hi;
+
+  __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+
+  return ((guint64) hi << 32) | lo;
+}
+#else
+#define TEST_BENCH_HAVE_CYCLES 0
+#define test_bench_cycles() ((guint64) 0)
+#endif
+
+static int
+test_bench_compare (const void *a,
+                    const void *b)
+{
+  gdouble da = *(const gdouble *) a;
+  gdouble db = *(const gdouble *) b;
+
+  return (da > db) - (da < db);
+}
+
+static void
+test_bench_append_json (guint64  n_iterations,
+                        guint    n_samples,
+                        gdouble  min,
+                        gdouble  median,
+                        gdouble  p99,
+                        gdouble  mean,
+                        gdouble  median_cycles)
+{
+  gchar buf[4][G_ASCII_DTOSTR_BUF_SIZE];
+  GString *line;
+  const gchar *p;
+  FILE *file;
+
+  line = g_string_new ("{\"test\": \"");
+  for (p = test_run_name; *p; p++)
+    {
+      if (*p == '"' || *p == '\\')
+        g_string_append_c (line, '\\');
+      if ((guchar) *p < 0x20)
+        g_string_append_printf (line, "\\u%04x", (guint) *p);
+      else
+        g_string_append_c (line, *p);
+    }
+  g_string_append_printf (line, "\", \"iterations\": %" G_GUINT64_FORMAT ", \"samples\": %u, "
+                          "\"min_ns\": %s, \"median_ns\": %s, \"p99_ns\": %s, \"mean_ns\": %s",
+                          n_iterations, n_samples,
+                          g_ascii_formatd (buf[0], sizeof buf[0], "%.3f", min),
+                          g_ascii_formatd (buf[1], sizeof buf[1], "%.3f", median),
+                          g_ascii_formatd (buf[2], sizeof buf[2], "%.3f", p99),
+                          g_ascii_formatd (buf[3], sizeof buf[3], "%.3f", mean));
+  if (TEST_BENCH_HAVE_CYCLES)
+    g_string_append_printf (line, ", \"median_cycles\": %s",
+                            g_ascii_formatd (buf[0], sizeof buf[0], "%.3f", median_cycles));
+  g_string_append (line, "}\n");
+
+  file = g_fopen (test_bench_json, "a");
+  if (file == NULL || fputs (line->str, file) < 0)
+    g_test_message ("Failed to write benchmark results to %s", test_bench_json);
+  if (file != NULL)
+    fclose (file);
+
+  g_string_free (line, TRUE);
+}
+
+static void
+test_bench_run (gconstpointer data)
+{
+  const TestBench *bench = data;
+  gdouble samples[TEST_BENCH_SAMPLES];
+  gdouble cycles[TEST_BENCH_SAMPLES];
+  gint64 sample_time, start, elapsed;
+  guint64 n_iterations;
+  gdouble mean;
+  guint i, n_samples;
+
+  /* outside of perf mode, a benchmark is just a test of the code */
+  if (!g_test_perf ())
+    {
+      bench->bench_func (bench->bench_data, 1);
+      return;
+    }
+
+  /* the first call may do setup that later calls reuse */
+  bench->bench_func (bench->bench_data, 1);
+
+  /* Find how many iterations take one sample's share of the time; this
+   * also warms up caches and branch predictors
+   */
+  sample_time = MAX (test_bench_time * G_USEC_PER_SEC / TEST_BENCH_SAMPLES, 1);
+  n_iterations = 1;
+  while (TRUE)
+    {
+      start = g_get_monotonic_time ();
+      bench->bench_func (bench->bench_data, n_iterations);
+      elapsed = g_get_monotonic_time () - start;
+
+      if (elapsed >= sample_time || n_iterations >= G_MAXUINT64 / 100)
+        break;
+
+      if (elapsed <= 0)
+        n_iterations *= 100;
+      else
+        n_iterations = CLAMP (n_iterations * 1.2 * sample_time / elapsed,
+                              n_iterations * 2, n_iterations * 100);
+    }
+
+  start = g_get_monotonic_time ();
+  for (n_samples = 0; n_samples < TEST_BENCH_SAMPLES; n_samples++)
+    {
+      gint64 sample_start;
+      guint64 cycles_start;
+
+      /* don't let slow benchmarks take much longer than asked for */
+      if (n_samples >= TEST_BENCH_MIN_SAMPLES &&
+          g_get_monotonic_time () - start > 2 * test_bench_time * G_USEC_PER_SEC)
+        break;
+
+      sample_start = g_get_monotonic_time ();
+      cycles_start = test_bench_cycles ();
+      bench->bench_func (bench->bench_data, n_iterations);
+      cycles[n_samples] = (gdouble) (test_bench_cycles () - cycles_start) / n_iterations;
+      samples[n_samples] = (g_get_monotonic_time () - sample_start) * 1000.0 / n_iterations;
+    }
+
+  mean = 0;
+  for (i = 0; i < n_samples; i++)
+    mean += samples[i] / n_samples;
+
+  qsort (samples, n_samples, sizeof (gdouble), test_bench_compare);
+  qsort (cycles, n_samples, sizeof (gdouble), test_bench_compare);
+
+#define PERCENTILE(array, p) ((array)[MIN ((guint) ((p) * n_samples), n_samples - 1)])
+  if (TEST_BENCH_HAVE_CYCLES)
+    g_test_minimized_result (PERCENTILE (samples, 0.5) / 1e9,
+                             "%s: %.2f ns per iteration (min %.2f, p99 %.2f), "
+                             "%.1f cycles, %u samples of %" G_GUINT64_FORMAT " iterations",
+                             test_run_name, PERCENTILE (samples, 0.5), samples[0],
+                             PERCENTILE (samples, 0.99), PERCENTILE (cycles, 0.5),
+                             n_samples, n_iterations);
+  else
+    g_test_minimized_result (PERCENTILE (samples, 0.5) / 1e9,
+                             "%s: %.2f ns per iteration (min %.2f, p99 %.2f), "
+                             "%u samples of %" G_GUINT64_FORMAT " iterations",
+                             test_run_name, PERCENTILE (samples, 0.5), samples[0],
+                             PERCENTILE (samples, 0.99), n_samples, n_iterations);
+
+  if (test_bench_json != NULL)
+    test_bench_append_json (n_iterations, n_samples, samples[0],
+                            PERCENTILE (samples, 0.5), PERCENTILE (samples, 0.99),
+                            mean, PERCENTILE (cycles, 0.5));
+#undef PERCENTILE
+}
+
+/**
+ * GTestBenchFunc:
+ * @user_data: the data provided when registering the benchmark
+ * @n_iterations: how many times to run the code being measured
+ *
+ * The type used for benchmark functions. A benchmark function runs the code
+ * it measures @n_iterations times in a loop; anything else it does is
+ * measured along with it, so it should be cheap in comparison. Expensive
+ * setup, such as filling a large container, can be done on the first call
+ * and kept for later ones, since in `perf` mode the first call is an
+ * untimed warm-up with a single iteration.
+ *
+ * Since: 2.54
+ */
+
+/**
+ * g_test_add_bench:
+ * @testpath: /-separated test case path name for the benchmark.
+ * @test_data: Data argument for the benchmark function.
+ * @bench_func: (scope async): The benchmark function to invoke.
+ *
+ * Create a new test case which measures the performance of @bench_func,
+ * in the same way as g_test_add_data_func() adds a test.
+ *
+ * When running in `perf` mode (see g_test_perf()), the number of iterations
+ * is first calibrated so that each call to @bench_func takes a good
+ * fraction of the time set by the `--bench-time` option. Then a series of
+ * such calls is timed, and the median time per iteration is reported with
+ * g_test_minimized_result(), together with the minimum, the 99th percentile
+ * and, where the CPU has a cycle counter, the median number of cycles.
+ * With `--bench-json=FILE`, the results are also appended to FILE.
+ *
+ * Otherwise @bench_func is called once with a single iteration, so that the
+ * benchmark works as a quick test of the code it measures.
+ *
+ * |[<!-- language="C" -->
+ * static void
+ * bench_strdup (gconstpointer data,
+ *               guint64       n_iterations)
+ * {
+ *   guint64 i;
+ *
+ *   for (i = 0; i < n_iterations; i++)
+ *     g_free (g_strdup (data));
+ * }
+ *
+ * g_test_add_bench ("/strfuncs/strdup/bench", "some string", bench_strdup);
+ * ]|
+ *
+ * Since: 2.54
+ */
+void
+g_test_add_bench (const char     *testpath,
+                  gconstpointer   test_data,
+                  GTestBenchFunc  bench_func)
+{
+  TestBench *bench;
+
+  g_return_if_fail (testpath != NULL);
+  g_return_if_fail (testpath[0] == '/');
+  g_return_if_fail (bench_func != NULL);
+
+  bench = g_new (TestBench, 1);
+  bench->bench_func = bench_func;
+  bench->bench_data = test_data;
+
+  g_test_add_data_func_full (testpath, bench, test_bench_run, g_free);
+}
+
 static gboolean
 g_test_suite_case_exists (GTestSuite *suite,
                           const char *test_path)
@@ -209,10 +209,21 @@ g_mutex_clear (GMutex *mutex)
 void
 g_mutex_lock (GMutex *mutex)
 {
+  gint64 wait_start = 0;
   gint status;
 
+  if (g_lock_profile_wanted ())
+    {
+      if (pthread_mutex_trylock (g_mutex_get_impl (mutex)) == 0)
+        return;
+      wait_start = g_get_monotonic_time ();
+    }
+
   if G_UNLIKELY ((status = pthread_mutex_lock (g_mutex_get_impl (mutex))) != 0)
     g_thread_abort (status, "pthread_mutex_lock");
+
+  if G_UNLIKELY (wait_start)
+    g_lock_profile_contended (mutex, G_LOCK_PROFILE_MUTEX, wait_start);
 }
 
 /**
@@ -263,8 +274,6 @@ g_mutex_trylock (GMutex *mutex)
   return FALSE;
 }
 
-#endif /* !defined(USE_NATIVE_MUTEX) */
-
 /* {{{1 GRecMutex */
 
 static pthread_mutex_t *
@@ -384,7 +393,20 @@ g_rec_mutex_clear (GRecMutex *rec_mutex)
 void
 g_rec_mutex_lock (GRecMutex *mutex)
 {
+  gint64 wait_start;
+
+  if (!g_lock_profile_wanted ())
+    {
+      pthread_mutex_lock (g_rec_mutex_get_impl (mutex));
+      return;
+    }
+
+  if (pthread_mutex_trylock (g_rec_mutex_get_impl (mutex)) == 0)
+    return;
+
+  wait_start = g_get_monotonic_time ();
   pthread_mutex_lock (g_rec_mutex_get_impl (mutex));
+  g_lock_profile_contended (mutex, G_LOCK_PROFILE_REC_MUTEX, wait_start);
 }
 
 /**
@@ -538,7 +560,20 @@ g_rw_lock_clear (GRWLock *rw_lock)
 void
 g_rw_lock_writer_lock (GRWLock *rw_lock)
 {
+  gint64 wait_start;
+
+  if (!g_lock_profile_wanted ())
+    {
+      pthread_rwlock_wrlock (g_rw_lock_get_impl (rw_lock));
+      return;
+    }
+
+  if (pthread_rwlock_trywrlock (g_rw_lock_get_impl (rw_lock)) == 0)
+    return;
+
+  wait_start = g_get_monotonic_time ();
   pthread_rwlock_wrlock (g_rw_lock_get_impl (rw_lock));
+  g_lock_profile_contended (rw_lock, G_LOCK_PROFILE_RW_LOCK, wait_start);
 }
 
 /**
@@ -595,7 +630,20 @@ g_rw_lock_writer_unlock (GRWLock *rw_lock)
 void
 g_rw_lock_reader_lock (GRWLock *rw_lock)
 {
+  gint64 wait_start;
+
+  if (!g_lock_profile_wanted ())
+    {
+      pthread_rwlock_rdlock (g_rw_lock_get_impl (rw_lock));
+      return;
+    }
+
+  if (pthread_rwlock_tryrdlock (g_rw_lock_get_impl (rw_lock)) == 0)
+    return;
+
+  wait_start = g_get_monotonic_time ();
   pthread_rwlock_rdlock (g_rw_lock_get_impl (rw_lock));
+  g_lock_profile_contended (rw_lock, G_LOCK_PROFILE_RW_LOCK, wait_start);
 }
 
 /**
@@ -636,6 +684,8 @@ g_rw_lock_reader_unlock (GRWLock *rw_lock)
   pthread_rwlock_unlock (g_rw_lock_get_impl (rw_lock));
 }
 
+#endif /* !defined(USE_NATIVE_MUTEX) */
+
 /* {{{1 GCond */
 
 #if !defined(USE_NATIVE_MUTEX)
@@ -1232,7 +1282,57 @@ g_system_thread_set_name (const gchar *name)
 #endif
 }
 
-/* {{{1 GMutex and GCond futex implementation */
+#if defined(HAVE_PTHREAD_SETAFFINITY_NP)
+/* The affinity a thread had when it was first bound to CPUs, which is
+ * usually the one of the process (as set by taskset and the like).
+ */
+static GPrivate original_affinity = G_PRIVATE_INIT (g_free);
+#endif
+
+gboolean
+g_system_thread_set_affinity (const guint *cpus,
+                              guint        n_cpus)
+{
+#if defined(HAVE_PTHREAD_SETAFFINITY_NP)
+  cpu_set_t *original;
+  cpu_set_t set;
+  guint i;
+
+  original = g_private_get (&original_affinity);
+  if (original == NULL)
+    {
+      original = g_new (cpu_set_t, 1);
+      if (pthread_getaffinity_np (pthread_self (), sizeof *original, original) != 0)
+        {
+          g_free (original);
+          return FALSE;
+        }
+      g_private_set (&original_affinity, original);
+    }
+
+  /* pthread_setaffinity_np() accepts any online CPU, so going back to
+   * "all CPUs" restores the original mask instead, and the requested
+   * CPUs are limited to it.  Otherwise threads could escape the CPUs
+   * the process was restricted to.
+   */
+  if (n_cpus == 0)
+    return pthread_setaffinity_np (pthread_self (), sizeof *original, original) == 0;
+
+  CPU_ZERO (&set);
+  for (i = 0; i < n_cpus; i++)
+    if (cpus[i] < CPU_SETSIZE && CPU_ISSET (cpus[i], original))
+      CPU_SET (cpus[i], &set);
+
+  if (CPU_COUNT (&set) == 0)
+    return FALSE;
+
+  return pthread_setaffinity_np (pthread_self (), sizeof set, &set) == 0;
+#else
+  return FALSE;
+#endif
+}
+
+/* {{{1 GMutex, GRecMutex, GRWLock and GCond futex implementation */
 
 #if defined(USE_NATIVE_MUTEX)
 
@@ -1255,11 +1355,80 @@ g_system_thread_set_name (const gchar *name)
   __atomic_exchange_4((ptr), (new), __ATOMIC_ACQUIRE)
 #define compare_exchange_acquire(ptr, old, new) \
   __atomic_compare_exchange_4((ptr), (old), (new), 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)
+#define compare_exchange_release(ptr, old, new) \
+  __atomic_compare_exchange_4((ptr), (old), (new), 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)
 
 #define exchange_release(ptr, new) \
   __atomic_exchange_4((ptr), (new), __ATOMIC_RELEASE)
 #define store_release(ptr, new) \
   __atomic_store_4((ptr), (new), __ATOMIC_RELEASE)
+#define load_relaxed(ptr) \
+  __atomic_load_4((ptr), __ATOMIC_RELAXED)
+
+#if defined(__i386__) || defined(__x86_64__)
+#define spin_pause() __asm__ __volatile__ ("pause" ::: "memory")
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_ARCH_7A__))
+#define spin_pause() __asm__ __volatile__ ("yield" ::: "memory")
+#else
+#define spin_pause() __asm__ __volatile__ ("" ::: "memory")
+#endif
+
+/* Locks are usually held for a very short time, so a thread finding
+ * one taken spins for a little while before paying for a futex() sleep
+ * and the wakeup that goes with it.  This is only done when the holder
+ * can be running on another CPU at the same time.
+ */
+#define SPIN_COUNT 100
+
+static guint
+get_spin_count (void)
+{
+  static gint spin_count = -1;
+  gint count;
+
+  count = g_atomic_int_get (&spin_count);
+  if G_UNLIKELY (count < 0)
+    {
+      count = g_get_num_processors () > 1 ? SPIN_COUNT : 0;
+      g_atomic_int_set (&spin_count, count);
+    }
+
+  return count;
+}
+
+/* Spins until none of @mask is set in *@word, or the spin count is up.
+ * Returns the last value seen.
+ */
+static guint
+spin_while_set (guint *word,
+                guint  mask)
+{
+  guint spins = get_spin_count ();
+  guint value;
+
+  value = load_relaxed (word);
+  while ((value & mask) != 0 && spins-- > 0)
+    {
+      spin_pause ();
+      value = load_relaxed (word);
+    }
+
+  return value;
+}
+
+static inline void
+futex_wait (guint *word,
+            guint  value)
+{
+  syscall (__NR_futex, word, (gsize) FUTEX_WAIT_PRIVATE, (gsize) value, NULL);
+}
+
+static inline void
+futex_wake (guint *word,
+            gint   n_waiters)
+{
+  syscall (__NR_futex, word, (gsize) FUTEX_WAKE_PRIVATE, (gsize) n_waiters, NULL);
+}
 
 /* Our strategy for the mutex is pretty simple:
  *
@@ -1283,8 +1452,93 @@ g_system_thread_set_name (const gchar *name)
  * wait.  We must always ensure that we mark a value >1 while we are
  * waiting in order to instruct the holder to do a wake operation on
  * unlock.
+ *
+ * The same lock word is used for GRecMutex, which adds an owner and a
+ * recursion depth on top of it.
  */
 
+static void __attribute__((noinline))
+lock_word_slowpath (guint            *word,
+                    gconstpointer     lock,
+                    GLockProfileKind  kind)
+{
+  gint64 wait_start = 0;
+
+  if (g_lock_profile_wanted ())
+    wait_start = g_get_monotonic_time ();
+
+  /* Give the holder a chance to release the lock before sleeping */
+  if (spin_while_set (word, ~0u) != 0 || exchange_acquire (word, 2) != 0)
+    {
+      /* Set to 2 to indicate contention.  If it was zero before then we
+       * just acquired the lock.
+       *
+       * Otherwise, sleep for as long as the 2 remains...
+       */
+      while (exchange_acquire (word, 2) != 0)
+        futex_wait (word, 2);
+    }
+
+  if G_UNLIKELY (wait_start)
+    g_lock_profile_contended (lock, kind, wait_start);
+}
+
+static void __attribute__((noinline))
+unlock_word_slowpath (guint            *word,
+                      guint             prev,
+                      gconstpointer     lock,
+                      GLockProfileKind  kind)
+{
+  /* We seem to get better code for the uncontended case by splitting
+   * this out...
+   */
+  if G_UNLIKELY (prev == 0)
+    {
+      fprintf (stderr, "Attempt to unlock mutex that was not locked\n");
+      g_abort ();
+    }
+
+  if G_UNLIKELY (g_lock_profile_active)
+    g_lock_profile_released (lock, kind);
+
+  futex_wake (word, 1);
+}
+
+static inline void
+lock_word (guint            *word,
+           gconstpointer     lock,
+           GLockProfileKind  kind)
+{
+  /* 0 -> 1 and we're done.  Anything else, and we need to wait... */
+  if G_UNLIKELY (g_atomic_int_add (word, 1) != 0)
+    lock_word_slowpath (word, lock, kind);
+}
+
+static inline void
+unlock_word (guint            *word,
+             gconstpointer     lock,
+             GLockProfileKind  kind)
+{
+  guint prev;
+
+  prev = exchange_release (word, 0);
+
+  /* 1-> 0 and we're done.  Anything else and we need to signal... */
+  if G_UNLIKELY (prev != 1)
+    unlock_word_slowpath (word, prev, lock, kind);
+}
+
+static inline gboolean
+trylock_word (guint *word)
+{
+  guint zero = 0;
+
+  /* We don't want to touch the value at all unless we can move it from
+   * exactly 0 to 1.
+   */
+  return compare_exchange_acquire (word, &zero, 1);
+}
+
 void
 g_mutex_init (GMutex *mutex)
 {
@@ -1301,63 +1555,276 @@ g_mutex_clear (GMutex *mutex)
     }
 }
 
-static void __attribute__((noinline))
-g_mutex_lock_slowpath (GMutex *mutex)
+void
+g_mutex_lock (GMutex *mutex)
 {
-  /* Set to 2 to indicate contention.  If it was zero before then we
-   * just acquired the lock.
-   *
-   * Otherwise, sleep for as long as the 2 remains...
-   */
-  while (exchange_acquire (&mutex->i[0], 2) != 0)
-    syscall (__NR_futex, &mutex->i[0], (gsize) FUTEX_WAIT_PRIVATE, (gsize) 2, NULL);
+  lock_word (&mutex->i[0], mutex, G_LOCK_PROFILE_MUTEX);
 }
 
-static void __attribute__((noinline))
-g_mutex_unlock_slowpath (GMutex *mutex,
-                         guint   prev)
+void
+g_mutex_unlock (GMutex *mutex)
 {
-  /* We seem to get better code for the uncontended case by splitting
-   * this out...
-   */
-  if G_UNLIKELY (prev == 0)
+  unlock_word (&mutex->i[0], mutex, G_LOCK_PROFILE_MUTEX);
+}
+
+gboolean
+g_mutex_trylock (GMutex *mutex)
+{
+  return trylock_word (&mutex->i[0]);
+}
+
+/* A recursive mutex is a mutex lock word in i[0], plus the owning
+ * thread in p and the recursion depth in i[1], both only written by
+ * the owner.  A thread can only ever find its own identity in p if it
+ * put it there itself, so no stronger ordering is needed for checking
+ * it.
+ */
+
+void
+g_rec_mutex_init (GRecMutex *rec_mutex)
+{
+  rec_mutex->p = NULL;
+  rec_mutex->i[0] = 0;
+  rec_mutex->i[1] = 0;
+}
+
+void
+g_rec_mutex_clear (GRecMutex *rec_mutex)
+{
+  if G_UNLIKELY (rec_mutex->i[0] != 0)
     {
-      fprintf (stderr, "Attempt to unlock mutex that was not locked\n");
+      fprintf (stderr, "g_rec_mutex_clear() called on uninitialised or locked mutex\n");
       g_abort ();
     }
+}
 
-  syscall (__NR_futex, &mutex->i[0], (gsize) FUTEX_WAKE_PRIVATE, (gsize) 1, NULL);
+void
+g_rec_mutex_lock (GRecMutex *rec_mutex)
+{
+  gpointer self = (gpointer) pthread_self ();
+
+  if (g_atomic_pointer_get (&rec_mutex->p) == self)
+    {
+      rec_mutex->i[1]++;
+      return;
+    }
+
+  lock_word (&rec_mutex->i[0], rec_mutex, G_LOCK_PROFILE_REC_MUTEX);
+  g_atomic_pointer_set (&rec_mutex->p, self);
+  rec_mutex->i[1] = 1;
 }
 
 void
-g_mutex_lock (GMutex *mutex)
+g_rec_mutex_unlock (GRecMutex *rec_mutex)
 {
-  /* 0 -> 1 and we're done.  Anything else, and we need to wait... */
-  if G_UNLIKELY (g_atomic_int_add (&mutex->i[0], 1) != 0)
-    g_mutex_lock_slowpath (mutex);
+  if (--rec_mutex->i[1] > 0)
+    return;
+
+  g_atomic_pointer_set (&rec_mutex->p, NULL);
+  unlock_word (&rec_mutex->i[0], rec_mutex, G_LOCK_PROFILE_REC_MUTEX);
+}
+
+gboolean
+g_rec_mutex_trylock (GRecMutex *rec_mutex)
+{
+  gpointer self = (gpointer) pthread_self ();
+
+  if (g_atomic_pointer_get (&rec_mutex->p) == self)
+    {
+      rec_mutex->i[1]++;
+      return TRUE;
+    }
+
+  if (!trylock_word (&rec_mutex->i[0]))
+    return FALSE;
+
+  g_atomic_pointer_set (&rec_mutex->p, self);
+  rec_mutex->i[1] = 1;
+
+  return TRUE;
+}
+
+/* The read-write lock keeps all of its state in i[0]: the number of
+ * readers in the low bits, a bit for the writer, and a bit telling
+ * that somebody is sleeping on the lock, which makes the last thread
+ * out wake everybody up to try again.
+ *
+ * Readers only wait for a writer that actually holds the lock, not
+ * for writers waiting for it, like with the default pthread rwlock.
+ * That is what makes it safe to take read locks recursively.
+ */
+
+#define RW_LOCK_READERS 0x3fffffffu
+#define RW_LOCK_WRITER  0x40000000u
+#define RW_LOCK_WAITING 0x80000000u
+
+/* Marks @word as having a sleeper and sleeps, unless it changed from
+ * @value in the meantime.
+ */
+static void
+rw_lock_wait (guint *word,
+              guint  value)
+{
+  if (!(value & RW_LOCK_WAITING) &&
+      !compare_exchange_acquire (word, &value, value | RW_LOCK_WAITING))
+    return;
+
+  futex_wait (word, value | RW_LOCK_WAITING);
 }
 
 void
-g_mutex_unlock (GMutex *mutex)
+g_rw_lock_init (GRWLock *rw_lock)
+{
+  rw_lock->i[0] = 0;
+}
+
+void
+g_rw_lock_clear (GRWLock *rw_lock)
+{
+  if G_UNLIKELY ((rw_lock->i[0] & ~RW_LOCK_WAITING) != 0)
+    {
+      fprintf (stderr, "g_rw_lock_clear() called on uninitialised or locked lock\n");
+      g_abort ();
+    }
+}
+
+void
+g_rw_lock_writer_lock (GRWLock *rw_lock)
+{
+  guint *word = &rw_lock->i[0];
+  guint value = 0;
+  gint64 wait_start = 0;
+
+  if G_LIKELY (compare_exchange_acquire (word, &value, RW_LOCK_WRITER))
+    return;
+
+  if (g_lock_profile_wanted ())
+    wait_start = g_get_monotonic_time ();
+
+  while (TRUE)
+    {
+      if (value & ~RW_LOCK_WAITING)
+        value = spin_while_set (word, ~RW_LOCK_WAITING);
+
+      if ((value & ~RW_LOCK_WAITING) == 0)
+        {
+          /* Keep the waiting bit, so that our unlock wakes the others */
+          if (compare_exchange_acquire (word, &value, value | RW_LOCK_WRITER))
+            break;
+          continue;
+        }
+
+      rw_lock_wait (word, value);
+      value = load_relaxed (word);
+    }
+
+  if G_UNLIKELY (wait_start)
+    g_lock_profile_contended (rw_lock, G_LOCK_PROFILE_RW_LOCK, wait_start);
+}
+
+gboolean
+g_rw_lock_writer_trylock (GRWLock *rw_lock)
+{
+  guint value = 0;
+
+  return compare_exchange_acquire (&rw_lock->i[0], &value, RW_LOCK_WRITER);
+}
+
+void
+g_rw_lock_writer_unlock (GRWLock *rw_lock)
 {
   guint prev;
 
-  prev = exchange_release (&mutex->i[0], 0);
+  prev = exchange_release (&rw_lock->i[0], 0);
 
-  /* 1-> 0 and we're done.  Anything else and we need to signal... */
-  if G_UNLIKELY (prev != 1)
-    g_mutex_unlock_slowpath (mutex, prev);
+  if G_UNLIKELY (prev & RW_LOCK_WAITING)
+    {
+      if G_UNLIKELY (g_lock_profile_active)
+        g_lock_profile_released (rw_lock, G_LOCK_PROFILE_RW_LOCK);
+
+      futex_wake (&rw_lock->i[0], INT_MAX);
+    }
+}
+
+void
+g_rw_lock_reader_lock (GRWLock *rw_lock)
+{
+  guint *word = &rw_lock->i[0];
+  guint value;
+  gint64 wait_start = 0;
+
+  value = load_relaxed (word);
+
+  while (TRUE)
+    {
+      if (value & RW_LOCK_WRITER)
+        {
+          if (wait_start == 0 && g_lock_profile_wanted ())
+            wait_start = g_get_monotonic_time ();
+
+          value = spin_while_set (word, RW_LOCK_WRITER);
+        }
+
+      if (!(value & RW_LOCK_WRITER))
+        {
+          if G_UNLIKELY ((value & RW_LOCK_READERS) == RW_LOCK_READERS)
+            {
+              fprintf (stderr, "Too many readers on GRWLock\n");
+              g_abort ();
+            }
+
+          if (compare_exchange_acquire (word, &value, value + 1))
+            break;
+          continue;
+        }
+
+      rw_lock_wait (word, value);
+      value = load_relaxed (word);
+    }
+
+  if G_UNLIKELY (wait_start)
+    g_lock_profile_contended (rw_lock, G_LOCK_PROFILE_RW_LOCK, wait_start);
 }
 
 gboolean
-g_mutex_trylock (GMutex *mutex)
+g_rw_lock_reader_trylock (GRWLock *rw_lock)
 {
-  guint zero = 0;
+  guint *word = &rw_lock->i[0];
+  guint value;
 
-  /* We don't want to touch the value at all unless we can move it from
-   * exactly 0 to 1.
+  value = load_relaxed (word);
+
+  while (!(value & RW_LOCK_WRITER) && (value & RW_LOCK_READERS) != RW_LOCK_READERS)
+    if (compare_exchange_acquire (word, &value, value + 1))
+      return TRUE;
+
+  return FALSE;
+}
+
+void
+g_rw_lock_reader_unlock (GRWLock *rw_lock)
+{
+  guint *word = &rw_lock->i[0];
+  guint prev;
+
+  prev = __atomic_fetch_sub (word, 1, __ATOMIC_RELEASE);
+
+  /* The last reader out wakes up the sleepers.  If somebody took the
+   * lock again before we could clear the waiting bit, it becomes their
+   * job.
    */
-  return compare_exchange_acquire (&mutex->i[0], &zero, 1);
+  if G_UNLIKELY (prev == (RW_LOCK_WAITING | 1))
+    {
+      guint value = RW_LOCK_WAITING;
+
+      if (compare_exchange_release (word, &value, 0))
+        {
+          if G_UNLIKELY (g_lock_profile_active)
+            g_lock_profile_released (rw_lock, G_LOCK_PROFILE_RW_LOCK);
+
+          futex_wake (word, INT_MAX);
+        }
+    }
 }
 
 /* Condition variables are implemented in a rather simple way as well.
@@ -1392,7 +1859,7 @@ g_cond_wait (GCond  *cond,
   guint sampled = g_atomic_int_get (&cond->i[0]);
 
   g_mutex_unlock (mutex);
-  syscall (__NR_futex, &cond->i[0], (gsize) FUTEX_WAIT_PRIVATE, (gsize) sampled, NULL);
+  futex_wait (&cond->i[0], sampled);
   g_mutex_lock (mutex);
 }
 
@@ -1401,7 +1868,7 @@ g_cond_signal (GCond *cond)
 {
   g_atomic_int_inc (&cond->i[0]);
 
-  syscall (__NR_futex, &cond->i[0], (gsize) FUTEX_WAKE_PRIVATE, (gsize) 1, NULL);
+  futex_wake (&cond->i[0], 1);
 }
 
 void
@@ -1409,7 +1876,7 @@ g_cond_broadcast (GCond *cond)
 {
   g_atomic_int_inc (&cond->i[0]);
 
-  syscall (__NR_futex, &cond->i[0], (gsize) FUTEX_WAKE_PRIVATE, (gsize) INT_MAX, NULL);
+  futex_wake (&cond->i[0], INT_MAX);
 }
 
 gboolean
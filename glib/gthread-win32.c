@@ -559,6 +559,33 @@ g_system_thread_set_name (const gchar *name)
   SetThreadName ((DWORD) -1, name);
 }
 
+gboolean
+g_system_thread_set_affinity (const guint *cpus,
+                              guint        n_cpus)
+{
+  DWORD_PTR process_mask, system_mask, mask = 0;
+  guint i;
+
+  if (!GetProcessAffinityMask (GetCurrentProcess (), &process_mask, &system_mask))
+    return FALSE;
+
+  if (n_cpus == 0)
+    mask = process_mask;
+  else
+    {
+      /* Only the processors of the current processor group */
+      for (i = 0; i < n_cpus; i++)
+        if (cpus[i] < sizeof (DWORD_PTR) * 8)
+          mask |= ((DWORD_PTR) 1) << cpus[i];
+      mask &= process_mask;
+    }
+
+  if (mask == 0)
+    return FALSE;
+
+  return SetThreadAffinityMask (GetCurrentThread (), mask) != 0;
+}
+
 /* {{{1 SRWLock and CONDITION_VARIABLE emulation (for Windows XP) */
 
 static CRITICAL_SECTION g_thread_xp_lock;
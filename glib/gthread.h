@@ -267,6 +267,13 @@ void            g_once_init_leave               (volatile void  *location,
 GLIB_AVAILABLE_IN_2_36
 guint          g_get_num_processors (void);
 
+GLIB_AVAILABLE_IN_2_54
+void           g_lock_profile_set_enabled (gboolean enabled);
+GLIB_AVAILABLE_IN_2_54
+void           g_lock_profile_reset       (void);
+GLIB_AVAILABLE_IN_2_54
+gchar *        g_lock_profile_dump        (void);
+
 /**
  * GMutexLocker:
  *
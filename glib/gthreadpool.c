@@ -28,9 +28,18 @@
 
 #include "gasyncqueue.h"
 #include "gasyncqueueprivate.h"
+#include "gfileutils.h"
 #include "gmain.h"
+#include "gmem.h"
+#include "gqsort.h"
+#include "gqueue.h"
+#include "gstrfuncs.h"
 #include "gtestutils.h"
+#include "gthreadprivate.h"
 #include "gtimer.h"
+#include "gutils.h"
+
+#include <string.h>
 
 /**
  * SECTION:thread_pools
@@ -73,6 +82,7 @@
 /* #define DEBUG_MSG(args) g_printerr args ; g_printerr ("\n");    */
 
 typedef struct _GRealThreadPool GRealThreadPool;
+typedef struct _GThreadPoolWorker GThreadPoolWorker;
 
 /**
  * GThreadPool:
@@ -96,6 +106,30 @@ struct _GRealThreadPool
   gboolean waiting;
   GCompareDataFunc sort_func;
   gpointer sort_user_data;
+  GThreadPoolBatchFunc batch_func;
+  guint max_batch;
+
+  /* Only for pools created with %G_THREAD_POOL_WORK_STEALING; @queue
+   * then holds no tasks, but its lock protects the fields above and
+   * idle workers wait on @worker_cond.
+   */
+  GThreadPoolWorker *workers;
+  gint n_workers;
+  volatile gint unprocessed;
+  volatile gint next_worker;
+  volatile gint sleeping;
+  GCond worker_cond;
+
+  /* Settings for the threads, see g_thread_pool_apply_settings() */
+  gchar *thread_name;
+  gsize stack_size;
+  guint *cpus;
+  guint *node_starts;
+  guint n_cpus;
+  guint n_nodes;
+  GThreadPoolPlacement placement;
+  guint next_slot;
+  volatile gint settings_serial;
 };
 
 /* The following is just an address to mark the wakeup order for a
@@ -105,6 +139,24 @@ struct _GRealThreadPool
 static const gpointer wakeup_thread_marker = (gpointer) &g_thread_pool_new;
 static gint wakeup_thread_serial = 0;
 
+/* A thread of a work-stealing pool, with its own queue of tasks */
+struct _GThreadPoolWorker
+{
+  GMutex lock;
+  GQueue tasks;
+  volatile gint length;
+  GRealThreadPool *pool;
+};
+
+/* The worker running in the current thread, if any */
+static GPrivate current_worker;
+
+/* The settings_serial of the pool whose settings were last applied to
+ * the current thread; 0 if the thread has its original settings.
+ */
+static GPrivate applied_settings;
+static volatile gint settings_serial = 0;
+
 /* Here all unused threads are waiting  */
 static GAsyncQueue *unused_thread_queue = NULL;
 static gint unused_threads = 0;
@@ -121,6 +173,7 @@ static gboolean         g_thread_pool_start_thread        (GRealThreadPool  *poo
 static void             g_thread_pool_wakeup_and_stop_all (GRealThreadPool  *pool);
 static GRealThreadPool* g_thread_pool_wait_for_new_pool   (void);
 static gpointer         g_thread_pool_wait_for_new_task   (GRealThreadPool  *pool);
+static gpointer         g_thread_pool_worker_proxy        (gpointer          data);
 
 static void
 g_thread_pool_queue_push_unlocked (GRealThreadPool *pool,
@@ -135,6 +188,143 @@ g_thread_pool_queue_push_unlocked (GRealThreadPool *pool,
     g_async_queue_push_unlocked (pool->queue, data);
 }
 
+/* NUMA node of every CPU, as far as the system tells us; CPUs not
+ * listed are on node 0.
+ */
+static guint *cpu_nodes = NULL;
+static guint n_cpu_nodes = 0;
+
+static void
+g_thread_pool_load_topology (void)
+{
+  static gsize initialised;
+
+  if (g_once_init_enter (&initialised))
+    {
+#ifdef __linux__
+      guint node;
+
+      /* Node numbers are dense in practice, so we stop at the first gap */
+      for (node = 0; ; node++)
+        {
+          gchar *path, *contents;
+          gchar **ranges;
+          gint i;
+
+          path = g_strdup_printf ("/sys/devices/system/node/node%u/cpulist", node);
+          if (!g_file_get_contents (path, &contents, NULL, NULL))
+            {
+              g_free (path);
+              break;
+            }
+          g_free (path);
+
+          ranges = g_strsplit (g_strstrip (contents), ",", 0);
+          for (i = 0; ranges[i]; i++)
+            {
+              gchar *end;
+              guint64 first, last, cpu;
+
+              first = g_ascii_strtoull (ranges[i], &end, 10);
+              if (end == ranges[i])
+                continue;
+              last = (*end == '-') ? g_ascii_strtoull (end + 1, NULL, 10) : first;
+              if (last < first || last >= 4096)
+                continue;
+
+              if (last >= n_cpu_nodes)
+                {
+                  cpu_nodes = g_renew (guint, cpu_nodes, last + 1);
+                  memset (cpu_nodes + n_cpu_nodes, 0,
+                          (last + 1 - n_cpu_nodes) * sizeof (guint));
+                  n_cpu_nodes = last + 1;
+                }
+
+              for (cpu = first; cpu <= last; cpu++)
+                cpu_nodes[cpu] = node;
+            }
+
+          g_strfreev (ranges);
+          g_free (contents);
+        }
+#endif
+
+      g_once_init_leave (&initialised, 1);
+    }
+}
+
+static guint
+g_thread_pool_cpu_node (guint cpu)
+{
+  return cpu < n_cpu_nodes ? cpu_nodes[cpu] : 0;
+}
+
+static gint
+g_thread_pool_cpu_compare (gconstpointer a,
+                           gconstpointer b,
+                           gpointer      user_data)
+{
+  const guint *cpu_a = a, *cpu_b = b;
+  guint node_a, node_b;
+
+  node_a = g_thread_pool_cpu_node (*cpu_a);
+  node_b = g_thread_pool_cpu_node (*cpu_b);
+
+  if (node_a != node_b)
+    return node_a < node_b ? -1 : 1;
+
+  return *cpu_a < *cpu_b ? -1 : (*cpu_a > *cpu_b);
+}
+
+static inline gboolean
+g_thread_pool_settings_changed_for_thread (GRealThreadPool *pool)
+{
+  return (guint) g_atomic_int_get (&pool->settings_serial) !=
+         GPOINTER_TO_UINT (g_private_get (&applied_settings));
+}
+
+/* Brings the current thread in line with the thread settings of @pool;
+ * called with the queue of @pool locked, whenever its settings_serial
+ * differs from the one applied to this thread.  Threads of
+ * non-exclusive pools move between pools, so a pool without settings
+ * of its own resets whatever the previous one changed.
+ */
+static void
+g_thread_pool_apply_settings (GRealThreadPool *pool)
+{
+  guint serial;
+
+  serial = g_atomic_int_get (&pool->settings_serial);
+
+  g_system_thread_set_name (pool->thread_name ? pool->thread_name : "pool");
+
+  if (pool->n_cpus == 0)
+    g_system_thread_set_affinity (NULL, 0);
+  else if (pool->placement == G_THREAD_POOL_PLACEMENT_ANY)
+    g_system_thread_set_affinity (pool->cpus, pool->n_cpus);
+  else
+    {
+      guint slot, node;
+
+      slot = pool->next_slot++;
+
+      if (pool->placement == G_THREAD_POOL_PLACEMENT_SPREAD)
+        node = slot % pool->n_nodes;
+      else
+        {
+          /* Fill up the CPUs of a node before going to the next one */
+          slot %= pool->n_cpus;
+          for (node = 0; slot >= pool->node_starts[node + 1]; node++)
+            ;
+        }
+
+      g_system_thread_set_affinity (pool->cpus + pool->node_starts[node],
+                                    pool->node_starts[node + 1] - pool->node_starts[node]);
+    }
+
+  g_private_set (&applied_settings, GUINT_TO_POINTER (serial));
+}
+
 static GRealThreadPool*
 g_thread_pool_wait_for_new_pool (void)
 {
@@ -282,6 +472,8 @@ static gpointer
 g_thread_pool_thread_proxy (gpointer data)
 {
   GRealThreadPool *pool;
+  gpointer *batch = NULL;
+  guint batch_size = 0;
 
   pool = data;
 
@@ -301,11 +493,44 @@ g_thread_pool_thread_proxy (gpointer data)
               /* A task was received and the thread pool is active,
                * so execute the function.
                */
-              g_async_queue_unlock (pool->queue);
-              DEBUG_MSG (("thread %p in pool %p calling func.",
-                          g_thread_self (), pool));
-              pool->pool.func (task, pool->pool.user_data);
-              g_async_queue_lock (pool->queue);
+              if (G_UNLIKELY (g_thread_pool_settings_changed_for_thread (pool)))
+                g_thread_pool_apply_settings (pool);
+
+              if (pool->batch_func)
+                {
+                  guint n_batch = 1;
+
+                  /* The batch array lives as long as the thread, and
+                   * grows to the largest batch size it has seen.
+                   */
+                  if (batch_size < pool->max_batch)
+                    {
+                      batch_size = pool->max_batch;
+                      batch = g_renew (gpointer, batch, batch_size);
+                    }
+
+                  /* Take whatever else is already queued, up to the
+                   * batch size, without waiting for more.
+                   */
+                  batch[0] = task;
+                  while (n_batch < pool->max_batch &&
+                         (task = g_async_queue_try_pop_unlocked (pool->queue)))
+                    batch[n_batch++] = task;
+
+                  g_async_queue_unlock (pool->queue);
+                  DEBUG_MSG (("thread %p in pool %p calling batch func with %u tasks.",
+                              g_thread_self (), pool, n_batch));
+                  pool->batch_func (batch, n_batch, pool->pool.user_data);
+                  g_async_queue_lock (pool->queue);
+                }
+              else
+                {
+                  g_async_queue_unlock (pool->queue);
+                  DEBUG_MSG (("thread %p in pool %p calling func.",
+                              g_thread_self (), pool));
+                  pool->pool.func (task, pool->pool.user_data);
+                  g_async_queue_lock (pool->queue);
+                }
             }
         }
       else
@@ -376,6 +601,139 @@ g_thread_pool_thread_proxy (gpointer data)
         }
     }
 
+  g_free (batch);
+
+  return NULL;
+}
+
+static void
+g_thread_pool_worker_push (GThreadPoolWorker *worker,
+                           gpointer           data)
+{
+  g_mutex_lock (&worker->lock);
+  g_queue_push_tail (&worker->tasks, data);
+  g_atomic_int_inc (&worker->length);
+  g_mutex_unlock (&worker->lock);
+}
+
+/* Workers take tasks from the head of their own queue and steal them
+ * from the tail of the others', so that they mostly do not meet.
+ */
+static gpointer
+g_thread_pool_worker_pop (GThreadPoolWorker *worker,
+                          gboolean           steal)
+{
+  gpointer task;
+
+  if (g_atomic_int_get (&worker->length) == 0)
+    return NULL;
+
+  g_mutex_lock (&worker->lock);
+  if (steal)
+    task = g_queue_pop_tail (&worker->tasks);
+  else
+    task = g_queue_pop_head (&worker->tasks);
+  if (task)
+    g_atomic_int_add (&worker->length, -1);
+  g_mutex_unlock (&worker->lock);
+
+  if (task)
+    g_atomic_int_add (&worker->pool->unprocessed, -1);
+
+  return task;
+}
+
+static gpointer
+g_thread_pool_worker_next_task (GThreadPoolWorker *worker)
+{
+  GRealThreadPool *pool = worker->pool;
+  gpointer task;
+  gint self, i;
+
+  task = g_thread_pool_worker_pop (worker, FALSE);
+  if (task)
+    return task;
+
+  self = worker - pool->workers;
+  for (i = 1; i < pool->n_workers; i++)
+    {
+      task = g_thread_pool_worker_pop (&pool->workers[(self + i) % pool->n_workers], TRUE);
+      if (task)
+        return task;
+    }
+
+  return NULL;
+}
+
+static gpointer
+g_thread_pool_worker_proxy (gpointer data)
+{
+  GThreadPoolWorker *worker = data;
+  GRealThreadPool *pool = worker->pool;
+  gboolean free_pool = FALSE;
+
+  DEBUG_MSG (("thread %p started for work-stealing pool %p.", g_thread_self (), pool));
+
+  g_private_set (&current_worker, worker);
+
+  while (TRUE)
+    {
+      gpointer task;
+
+      task = g_thread_pool_worker_next_task (worker);
+      if (task)
+        {
+          if (G_UNLIKELY (g_thread_pool_settings_changed_for_thread (pool)))
+            {
+              g_async_queue_lock (pool->queue);
+              g_thread_pool_apply_settings (pool);
+              g_async_queue_unlock (pool->queue);
+            }
+
+          if (!g_atomic_int_get (&pool->immediate))
+            pool->pool.func (task, pool->pool.user_data);
+          continue;
+        }
+
+      g_async_queue_lock (pool->queue);
+
+      if (pool->immediate ||
+          (!pool->running && g_atomic_int_get (&pool->unprocessed) == 0))
+        break;
+
+      /* Counting ourselves as sleeping before looking at @unprocessed
+       * pairs with g_thread_pool_push() doing the opposite, so that
+       * either we see the new task or the pusher sees us sleeping.
+       * Once the pool is freed, nobody will wake us up when the last
+       * task is taken by another thread, so we go back to check for
+       * that instead.
+       */
+      g_atomic_int_inc (&pool->sleeping);
+      if (pool->running && g_atomic_int_get (&pool->unprocessed) == 0)
+        g_cond_wait (&pool->worker_cond, _g_async_queue_get_mutex (pool->queue));
+      g_atomic_int_add (&pool->sleeping, -1);
+
+      g_async_queue_unlock (pool->queue);
+    }
+
+  g_private_set (&current_worker, NULL);
+
+  DEBUG_MSG (("thread %p leaving work-stealing pool %p.", g_thread_self (), pool));
+
+  pool->num_threads--;
+  if (pool->num_threads == 0)
+    {
+      if (pool->waiting)
+        g_cond_broadcast (&pool->cond);
+      else
+        free_pool = TRUE;
+    }
+
+  g_async_queue_unlock (pool->queue);
+
+  if (free_pool)
+    g_thread_pool_free_internal (pool);
+
   return NULL;
 }
 
@@ -391,7 +749,9 @@ g_thread_pool_start_thread (GRealThreadPool  *pool,
 
   g_async_queue_lock (unused_thread_queue);
 
-  if (g_async_queue_length_unlocked (unused_thread_queue) < 0)
+  /* Unused threads have the default stack size */
+  if (pool->stack_size == 0 &&
+      g_async_queue_length_unlocked (unused_thread_queue) < 0)
     {
       g_async_queue_push_unlocked (unused_thread_queue, pool);
       success = TRUE;
@@ -404,7 +764,9 @@ g_thread_pool_start_thread (GRealThreadPool  *pool,
       GThread *thread;
 
       /* No thread was found, we have to start a new one */
-      thread = g_thread_try_new ("pool", g_thread_pool_thread_proxy, pool, error);
+      thread = g_thread_new_internal ("pool", g_thread_proxy,
+                                      g_thread_pool_thread_proxy, pool,
+                                      pool->stack_size, error);
 
       if (thread == NULL)
         return FALSE;
@@ -466,10 +828,73 @@ g_thread_pool_new (GFunc      func,
                    gint       max_threads,
                    gboolean   exclusive,
                    GError   **error)
+{
+  return g_thread_pool_new_full (func, user_data, max_threads,
+                                 exclusive ? G_THREAD_POOL_EXCLUSIVE : G_THREAD_POOL_FLAGS_NONE,
+                                 error);
+}
+
+/**
+ * GThreadPoolFlags:
+ * @G_THREAD_POOL_FLAGS_NONE: No flags.
+ * @G_THREAD_POOL_EXCLUSIVE: The threads of the pool are exclusive to
+ *     it, as with the @exclusive argument of g_thread_pool_new().
+ * @G_THREAD_POOL_WORK_STEALING: Every thread of the pool has its own
+ *     queue of tasks, and takes tasks from the queues of the other
+ *     threads when its own is empty.  Implies %G_THREAD_POOL_EXCLUSIVE.
+ *
+ * Flags passed to g_thread_pool_new_full().
+ *
+ * Since: 2.54
+ */
+
+/**
+ * g_thread_pool_new_full:
+ * @func: a function to execute in the threads of the new thread pool
+ * @user_data: user data that is handed over to @func every time it
+ *     is called
+ * @max_threads: the maximal number of threads to execute concurrently
+ *     in  the new thread pool, -1 means no limit
+ * @flags: flags for the new thread pool
+ * @error: return location for error, or %NULL
+ *
+ * This function creates a new thread pool, like g_thread_pool_new()
+ * with @exclusive set according to %G_THREAD_POOL_EXCLUSIVE.
+ *
+ * If @flags contains %G_THREAD_POOL_WORK_STEALING, the tasks are not
+ * kept in a single queue shared by all the threads of the pool, which
+ * stops scaling once many threads compete for it.  Instead, every
+ * thread has its own queue: g_thread_pool_push() spreads the tasks
+ * over the queues (or, when called from a thread of the pool, uses
+ * the queue of that thread), and a thread whose queue is empty takes
+ * tasks from the others.  This makes pools with many threads running
+ * short tasks much faster.
+ *
+ * A work-stealing pool is exclusive, so @max_threads must not be -1.
+ * Its tasks are not processed in any particular order, so
+ * g_thread_pool_set_sort_function() cannot be used with it, and its
+ * number of threads is fixed: g_thread_pool_set_max_threads() cannot
+ * be used either.  Other than that, it behaves like any other pool.
+ *
+ * Returns: the new #GThreadPool
+ *
+ * Since: 2.54
+ */
+GThreadPool *
+g_thread_pool_new_full (GFunc              func,
+                        gpointer           user_data,
+                        gint               max_threads,
+                        GThreadPoolFlags   flags,
+                        GError           **error)
 {
   GRealThreadPool *retval;
+  gboolean exclusive;
   G_LOCK_DEFINE_STATIC (init);
 
+  if (flags & G_THREAD_POOL_WORK_STEALING)
+    flags |= G_THREAD_POOL_EXCLUSIVE;
+  exclusive = (flags & G_THREAD_POOL_EXCLUSIVE) != 0;
+
   g_return_val_if_fail (func, NULL);
   g_return_val_if_fail (!exclusive || max_threads != -1, NULL);
   g_return_val_if_fail (max_threads >= -1, NULL);
@@ -488,6 +913,58 @@ g_thread_pool_new (GFunc      func,
   retval->waiting = FALSE;
   retval->sort_func = NULL;
   retval->sort_user_data = NULL;
+  retval->batch_func = NULL;
+  retval->max_batch = 0;
+  retval->workers = NULL;
+  retval->n_workers = 0;
+  retval->unprocessed = 0;
+  retval->next_worker = 0;
+  retval->sleeping = 0;
+  retval->thread_name = NULL;
+  retval->stack_size = 0;
+  retval->cpus = NULL;
+  retval->node_starts = NULL;
+  retval->n_cpus = 0;
+  retval->n_nodes = 0;
+  retval->placement = G_THREAD_POOL_PLACEMENT_ANY;
+  retval->next_slot = 0;
+  retval->settings_serial = 0;
+
+  if (flags & G_THREAD_POOL_WORK_STEALING)
+    {
+      gint i;
+
+      g_cond_init (&retval->worker_cond);
+
+      retval->n_workers = MAX (max_threads, 1);
+      retval->workers = g_new0 (GThreadPoolWorker, retval->n_workers);
+
+      g_async_queue_lock (retval->queue);
+
+      for (i = 0; i < retval->n_workers; i++)
+        {
+          g_mutex_init (&retval->workers[i].lock);
+          g_queue_init (&retval->workers[i].tasks);
+          retval->workers[i].pool = retval;
+        }
+
+      for (i = 0; i < max_threads; i++)
+        {
+          GThread *thread;
+
+          thread = g_thread_try_new ("pool", g_thread_pool_worker_proxy,
+                                     &retval->workers[i], error);
+          if (thread == NULL)
+            break;
+
+          g_thread_unref (thread);
+          retval->num_threads++;
+        }
+
+      g_async_queue_unlock (retval->queue);
+
+      return (GThreadPool*) retval;
+    }
 
   G_LOCK (init);
   if (!unused_thread_queue)
@@ -551,6 +1028,28 @@ g_thread_pool_push (GThreadPool  *pool,
   g_return_val_if_fail (real, FALSE);
   g_return_val_if_fail (real->running, FALSE);
 
+  if (real->workers)
+    {
+      GThreadPoolWorker *worker;
+
+      worker = g_private_get (&current_worker);
+      if (worker == NULL || worker->pool != real)
+        worker = &real->workers[(guint) g_atomic_int_add (&real->next_worker, 1) % real->n_workers];
+
+      /* Counted before it is queued, so that it is never negative */
+      g_atomic_int_inc (&real->unprocessed);
+      g_thread_pool_worker_push (worker, data);
+
+      if (g_atomic_int_get (&real->sleeping) > 0)
+        {
+          g_async_queue_lock (real->queue);
+          g_cond_signal (&real->worker_cond);
+          g_async_queue_unlock (real->queue);
+        }
+
+      return TRUE;
+    }
+
   result = TRUE;
 
   g_async_queue_lock (real->queue);
@@ -573,6 +1072,355 @@ g_thread_pool_push (GThreadPool  *pool,
   return result;
 }
 
+/**
+ * g_thread_pool_push_many:
+ * @pool: a #GThreadPool
+ * @data: (array length=n_data): new tasks for @pool
+ * @n_data: the number of tasks in @data
+ * @error: return location for error, or %NULL
+ *
+ * Inserts the @n_data tasks of @data into the list of tasks to be
+ * executed by @pool, as if g_thread_pool_push() had been called for
+ * each of them, but taking the lock of the pool only once.
+ *
+ * As many threads are started (or reused) as needed for the new tasks,
+ * within the limits given by g_thread_pool_set_max_threads(); at most
+ * @n_data of the threads waiting for work are woken up.
+ *
+ * @error can be %NULL to ignore errors, or non-%NULL to report
+ * errors. An error can only occur when a new thread couldn't be
+ * created. In that case all the tasks are still queued.
+ *
+ * Returns: %TRUE on success, %FALSE if an error occurred
+ *
+ * Since: 2.54
+ */
+gboolean
+g_thread_pool_push_many (GThreadPool  *pool,
+                         gpointer     *data,
+                         guint         n_data,
+                         GError      **error)
+{
+  GRealThreadPool *real;
+  gboolean result;
+  gint length;
+  guint to_start, i;
+
+  real = (GRealThreadPool*) pool;
+
+  g_return_val_if_fail (real, FALSE);
+  g_return_val_if_fail (real->running, FALSE);
+  g_return_val_if_fail (data || n_data == 0, FALSE);
+
+  if (n_data == 0)
+    return TRUE;
+
+  if (real->workers)
+    {
+      GThreadPoolWorker *worker;
+      gint sleeping;
+
+      worker = g_private_get (&current_worker);
+      if (worker == NULL || worker->pool != real)
+        worker = &real->workers[(guint) g_atomic_int_add (&real->next_worker, 1) % real->n_workers];
+
+      /* All in one queue; the other threads steal their share */
+      g_atomic_int_add (&real->unprocessed, n_data);
+      g_mutex_lock (&worker->lock);
+      for (i = 0; i < n_data; i++)
+        g_queue_push_tail (&worker->tasks, data[i]);
+      g_atomic_int_add (&worker->length, n_data);
+      g_mutex_unlock (&worker->lock);
+
+      sleeping = g_atomic_int_get (&real->sleeping);
+      if (sleeping > 0)
+        {
+          g_async_queue_lock (real->queue);
+          if (n_data >= (guint) sleeping)
+            g_cond_broadcast (&real->worker_cond);
+          else
+            for (i = 0; i < n_data; i++)
+              g_cond_signal (&real->worker_cond);
+          g_async_queue_unlock (real->queue);
+        }
+
+      return TRUE;
+    }
+
+  result = TRUE;
+
+  g_async_queue_lock (real->queue);
+
+  /* Threads waiting in the queue take the first tasks */
+  length = g_async_queue_length_unlocked (real->queue);
+  to_start = n_data;
+  if (length < 0)
+    to_start -= MIN ((guint) -length, n_data);
+
+  for (i = 0; i < to_start; i++)
+    {
+      GError *local_error = NULL;
+
+      if (real->max_threads != -1 && real->num_threads >= real->max_threads)
+        break;
+
+      if (!g_thread_pool_start_thread (real, &local_error))
+        {
+          g_propagate_error (error, local_error);
+          result = FALSE;
+          break;
+        }
+    }
+
+  if (real->sort_func)
+    {
+      for (i = 0; i < n_data; i++)
+        g_thread_pool_queue_push_unlocked (real, data[i]);
+    }
+  else
+    g_async_queue_push_many_unlocked (real->queue, data, n_data);
+
+  g_async_queue_unlock (real->queue);
+
+  return result;
+}
+
+/**
+ * GThreadPoolBatchFunc:
+ * @tasks: (array length=n_tasks): the tasks
+ * @n_tasks: the number of tasks in @tasks, at least 1
+ * @user_data: the user data of the pool
+ *
+ * Specifies the type of the function passed to
+ * g_thread_pool_set_batch_func(), which processes several tasks of a
+ * #GThreadPool in one call.
+ *
+ * Since: 2.54
+ */
+
+/**
+ * g_thread_pool_set_batch_func:
+ * @pool: a #GThreadPool
+ * @func: (nullable): the function processing batches of tasks, or
+ *     %NULL to go back to calling the function of @pool for every task
+ * @max_batch: the maximum number of tasks passed to @func at once
+ *
+ * Makes the threads of @pool process the tasks in batches.  A thread
+ * getting a task also takes the tasks that are queued behind it, up to
+ * @max_batch tasks in total, and passes them all to @func instead of
+ * calling the function given to g_thread_pool_new() for each one.  A
+ * thread never waits for a batch to fill up.
+ *
+ * This is useful when the cost of processing tasks has a large
+ * per-call part, and to make the threads touch the pool's queue less
+ * often.  The tasks of a batch count as being processed as soon as
+ * they are taken, for g_thread_pool_unprocessed() and
+ * g_thread_pool_free().
+ *
+ * This cannot be used with pools created with
+ * %G_THREAD_POOL_WORK_STEALING.
+ *
+ * Since: 2.54
+ */
+void
+g_thread_pool_set_batch_func (GThreadPool          *pool,
+                              GThreadPoolBatchFunc  func,
+                              guint                 max_batch)
+{
+  GRealThreadPool *real;
+
+  real = (GRealThreadPool*) pool;
+
+  g_return_if_fail (real);
+  g_return_if_fail (real->running);
+  g_return_if_fail (real->workers == NULL);
+  g_return_if_fail (func == NULL || (max_batch > 0 && max_batch <= 1024));
+
+  g_async_queue_lock (real->queue);
+  real->batch_func = func;
+  real->max_batch = max_batch;
+  g_async_queue_unlock (real->queue);
+}
+
+/* Called with the queue of @pool locked, after changing a setting */
+static void
+g_thread_pool_settings_changed (GRealThreadPool *pool)
+{
+  g_atomic_int_set (&pool->settings_serial,
+                    g_atomic_int_add (&settings_serial, 1) + 1);
+}
+
+/**
+ * g_thread_pool_set_thread_name:
+ * @pool: a #GThreadPool
+ * @name: (nullable): the name for the threads of @pool, or %NULL
+ *
+ * Sets the name that the threads of @pool are given, as far as the
+ * system supports naming threads.  This makes it easier to tell the
+ * threads of the different pools of a program apart in debuggers and
+ * system tools.  Some systems only keep the first 15 bytes of @name.
+ *
+ * Threads take the name when they run their next task; the threads of
+ * a non-exclusive pool go back to being called "pool" when they are
+ * used by another pool.
+ *
+ * Since: 2.54
+ */
+void
+g_thread_pool_set_thread_name (GThreadPool *pool,
+                               const gchar *name)
+{
+  GRealThreadPool *real;
+
+  real = (GRealThreadPool*) pool;
+
+  g_return_if_fail (real);
+  g_return_if_fail (real->running);
+
+  g_async_queue_lock (real->queue);
+  g_free (real->thread_name);
+  real->thread_name = g_strdup (name);
+  g_thread_pool_settings_changed (real);
+  g_async_queue_unlock (real->queue);
+}
+
+/**
+ * g_thread_pool_set_stack_size:
+ * @pool: a #GThreadPool
+ * @stack_size: the stack size for new threads of @pool, in bytes, or
+ *     0 for the default of the system
+ *
+ * Sets the size of the stack of the threads that @pool starts from now
+ * on.  The threads that are already running keep their stack.
+ *
+ * Unused threads kept for the non-exclusive pools have the default
+ * stack size, so a non-exclusive pool with a stack size of its own
+ * always starts new threads.  The threads of an exclusive pool are
+ * started by g_thread_pool_new() and g_thread_pool_set_max_threads(),
+ * so create it with a @max_threads of 0 and raise it after calling
+ * this function.  Work-stealing pools start all their threads on
+ * creation, so this has no effect on them.
+ *
+ * Since: 2.54
+ */
+void
+g_thread_pool_set_stack_size (GThreadPool *pool,
+                              gsize        stack_size)
+{
+  GRealThreadPool *real;
+
+  real = (GRealThreadPool*) pool;
+
+  g_return_if_fail (real);
+  g_return_if_fail (real->running);
+
+  g_async_queue_lock (real->queue);
+  real->stack_size = stack_size;
+  g_async_queue_unlock (real->queue);
+}
+
+/**
+ * GThreadPoolPlacement:
+ * @G_THREAD_POOL_PLACEMENT_ANY: Every thread may run on any of the
+ *     CPUs of the pool.
+ * @G_THREAD_POOL_PLACEMENT_SPREAD: The threads are distributed over
+ *     the NUMA nodes of the CPUs of the pool, one after the other, and
+ *     every thread may only run on the CPUs of its node.  This gives
+ *     the threads the most memory bandwidth.
+ * @G_THREAD_POOL_PLACEMENT_PACK: The threads are put on the first NUMA
+ *     node of the CPUs of the pool until there is one for each of its
+ *     CPUs, then on the next one, and so on.  Every thread may only run
+ *     on the CPUs of its node.  This keeps threads sharing data close
+ *     to each other.
+ *
+ * Specifies how g_thread_pool_set_cpu_affinity() places the threads
+ * of a pool on its CPUs.
+ *
+ * Since: 2.54
+ */
+
+/**
+ * g_thread_pool_set_cpu_affinity:
+ * @pool: a #GThreadPool
+ * @cpus: (array length=n_cpus) (nullable): the numbers of the CPUs the
+ *     threads of @pool may run on, or %NULL for all of them
+ * @n_cpus: the number of elements in @cpus
+ * @placement: how to place the threads on the CPUs
+ *
+ * Restricts the threads of @pool to run on the given CPUs, numbered
+ * like the operating system does.  With a @placement other than
+ * %G_THREAD_POOL_PLACEMENT_ANY, every thread is bound to the CPUs of a
+ * single NUMA node, so that the memory it allocates stays local to
+ * it.  Systems without NUMA are treated as having a single node.
+ *
+ * Passing %NULL for @cpus and %G_THREAD_POOL_PLACEMENT_ANY lets the
+ * threads run anywhere again.
+ *
+ * Threads move to their CPUs when they run their next task; the
+ * threads of a non-exclusive pool are free to run anywhere again when
+ * they are used by another pool.  This is only a request: on systems
+ * that do not support binding threads to CPUs, or for CPUs that the
+ * process may not use, it has no effect.
+ *
+ * Since: 2.54
+ */
+void
+g_thread_pool_set_cpu_affinity (GThreadPool          *pool,
+                                const guint          *cpus,
+                                guint                 n_cpus,
+                                GThreadPoolPlacement  placement)
+{
+  GRealThreadPool *real;
+  guint *sorted = NULL;
+  guint *node_starts = NULL;
+  guint n_nodes = 0;
+  guint i;
+
+  real = (GRealThreadPool*) pool;
+
+  g_return_if_fail (real);
+  g_return_if_fail (real->running);
+  g_return_if_fail (cpus != NULL || n_cpus == 0);
+  g_return_if_fail (placement <= G_THREAD_POOL_PLACEMENT_PACK);
+
+  if (cpus == NULL && placement != G_THREAD_POOL_PLACEMENT_ANY)
+    {
+      n_cpus = g_get_num_processors ();
+      sorted = g_new (guint, n_cpus);
+      for (i = 0; i < n_cpus; i++)
+        sorted[i] = i;
+    }
+  else if (n_cpus > 0)
+    sorted = g_memdup (cpus, n_cpus * sizeof (guint));
+
+  if (n_cpus > 0)
+    {
+      g_thread_pool_load_topology ();
+      g_qsort_with_data (sorted, n_cpus, sizeof (guint),
+                         g_thread_pool_cpu_compare, NULL);
+
+      /* A node starts wherever the node number changes */
+      node_starts = g_new (guint, n_cpus + 1);
+      for (i = 0; i < n_cpus; i++)
+        if (i == 0 ||
+            g_thread_pool_cpu_node (sorted[i]) != g_thread_pool_cpu_node (sorted[i - 1]))
+          node_starts[n_nodes++] = i;
+      node_starts[n_nodes] = n_cpus;
+    }
+
+  g_async_queue_lock (real->queue);
+  g_free (real->cpus);
+  g_free (real->node_starts);
+  real->cpus = sorted;
+  real->node_starts = node_starts;
+  real->n_cpus = n_cpus;
+  real->n_nodes = n_nodes;
+  real->placement = placement;
+  real->next_slot = 0;
+  g_thread_pool_settings_changed (real);
+  g_async_queue_unlock (real->queue);
+}
+
 /**
  * g_thread_pool_set_max_threads:
  * @pool: a #GThreadPool
@@ -618,6 +1466,7 @@ g_thread_pool_set_max_threads (GThreadPool  *pool,
   g_return_val_if_fail (real->running, FALSE);
   g_return_val_if_fail (!real->pool.exclusive || max_threads != -1, FALSE);
   g_return_val_if_fail (max_threads >= -1, FALSE);
+  g_return_val_if_fail (real->workers == NULL, FALSE);
 
   result = TRUE;
 
@@ -718,7 +1567,10 @@ g_thread_pool_unprocessed (GThreadPool *pool)
   g_return_val_if_fail (real, 0);
   g_return_val_if_fail (real->running, 0);
 
-  unprocessed = g_async_queue_length (real->queue);
+  if (real->workers)
+    unprocessed = g_atomic_int_get (&real->unprocessed);
+  else
+    unprocessed = g_async_queue_length (real->queue);
 
   return MAX (unprocessed, 0);
 }
@@ -765,6 +1617,29 @@ g_thread_pool_free (GThreadPool *pool,
 
   g_async_queue_lock (real->queue);
 
+  if (real->workers)
+    {
+      real->running = FALSE;
+      real->immediate = immediate;
+      real->waiting = wait_;
+
+      g_cond_broadcast (&real->worker_cond);
+
+      if (wait_ || real->num_threads == 0)
+        {
+          /* The last thread leaves the pool to us */
+          while (real->num_threads > 0)
+            g_cond_wait (&real->cond, _g_async_queue_get_mutex (real->queue));
+
+          g_async_queue_unlock (real->queue);
+          g_thread_pool_free_internal (real);
+          return;
+        }
+
+      g_async_queue_unlock (real->queue);
+      return;
+    }
+
   real->running = FALSE;
   real->immediate = immediate;
   real->waiting = wait_;
@@ -804,9 +1679,26 @@ g_thread_pool_free_internal (GRealThreadPool* pool)
   g_return_if_fail (pool->running == FALSE);
   g_return_if_fail (pool->num_threads == 0);
 
+  if (pool->workers)
+    {
+      gint i;
+
+      for (i = 0; i < pool->n_workers; i++)
+        {
+          g_mutex_clear (&pool->workers[i].lock);
+          g_queue_clear (&pool->workers[i].tasks);
+        }
+
+      g_free (pool->workers);
+      g_cond_clear (&pool->worker_cond);
+    }
+
   g_async_queue_unref (pool->queue);
   g_cond_clear (&pool->cond);
 
+  g_free (pool->thread_name);
+  g_free (pool->cpus);
+  g_free (pool->node_starts);
   g_free (pool);
 }
 
@@ -948,6 +1840,7 @@ g_thread_pool_set_sort_function (GThreadPool      *pool,
 
   g_return_if_fail (real);
   g_return_if_fail (real->running);
+  g_return_if_fail (real->workers == NULL);
 
   g_async_queue_lock (real->queue);
 
@@ -981,6 +1874,28 @@ g_thread_pool_move_to_front (GThreadPool *pool,
   GRealThreadPool *real = (GRealThreadPool*) pool;
   gboolean found;
 
+  if (real->workers)
+    {
+      gint i;
+
+      /* The best we can do is to make it the next task of its thread */
+      for (i = 0; i < real->n_workers; i++)
+        {
+          GThreadPoolWorker *worker = &real->workers[i];
+
+          g_mutex_lock (&worker->lock);
+          found = g_queue_remove (&worker->tasks, data);
+          if (found)
+            g_queue_push_head (&worker->tasks, data);
+          g_mutex_unlock (&worker->lock);
+
+          if (found)
+            return TRUE;
+        }
+
+      return FALSE;
+    }
+
   g_async_queue_lock (real->queue);
 
   found = g_async_queue_remove_unlocked (real->queue, data);
@@ -35,6 +35,24 @@ G_BEGIN_DECLS
 
 typedef struct _GThreadPool GThreadPool;
 
+typedef enum
+{
+  G_THREAD_POOL_FLAGS_NONE     = 0,
+  G_THREAD_POOL_EXCLUSIVE      = 1 << 0,
+  G_THREAD_POOL_WORK_STEALING  = 1 << 1
+} GThreadPoolFlags;
+
+typedef enum
+{
+  G_THREAD_POOL_PLACEMENT_ANY,
+  G_THREAD_POOL_PLACEMENT_SPREAD,
+  G_THREAD_POOL_PLACEMENT_PACK
+} GThreadPoolPlacement;
+
+typedef void (*GThreadPoolBatchFunc) (gpointer *tasks,
+                                      guint     n_tasks,
+                                      gpointer  user_data);
+
 /* Thread Pools
  */
 
@@ -51,6 +69,12 @@ GThreadPool *   g_thread_pool_new               (GFunc            func,
                                                  gint             max_threads,
                                                  gboolean         exclusive,
                                                  GError         **error);
+GLIB_AVAILABLE_IN_2_54
+GThreadPool *   g_thread_pool_new_full          (GFunc            func,
+                                                 gpointer         user_data,
+                                                 gint             max_threads,
+                                                 GThreadPoolFlags flags,
+                                                 GError         **error);
 GLIB_AVAILABLE_IN_ALL
 void            g_thread_pool_free              (GThreadPool     *pool,
                                                  gboolean         immediate,
@@ -59,8 +83,28 @@ GLIB_AVAILABLE_IN_ALL
 gboolean        g_thread_pool_push              (GThreadPool     *pool,
                                                  gpointer         data,
                                                  GError         **error);
+GLIB_AVAILABLE_IN_2_54
+gboolean        g_thread_pool_push_many         (GThreadPool     *pool,
+                                                 gpointer        *data,
+                                                 guint            n_data,
+                                                 GError         **error);
 GLIB_AVAILABLE_IN_ALL
 guint           g_thread_pool_unprocessed       (GThreadPool     *pool);
+GLIB_AVAILABLE_IN_2_54
+void            g_thread_pool_set_batch_func    (GThreadPool          *pool,
+                                                 GThreadPoolBatchFunc  func,
+                                                 guint                 max_batch);
+GLIB_AVAILABLE_IN_2_54
+void            g_thread_pool_set_thread_name   (GThreadPool          *pool,
+                                                 const gchar          *name);
+GLIB_AVAILABLE_IN_2_54
+void            g_thread_pool_set_stack_size    (GThreadPool          *pool,
+                                                 gsize                 stack_size);
+GLIB_AVAILABLE_IN_2_54
+void            g_thread_pool_set_cpu_affinity  (GThreadPool          *pool,
+                                                 const guint          *cpus,
+                                                 guint                 n_cpus,
+                                                 GThreadPoolPlacement  placement);
 GLIB_AVAILABLE_IN_ALL
 void            g_thread_pool_set_sort_function (GThreadPool      *pool,
                                                  GCompareDataFunc  func,
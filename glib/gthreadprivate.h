@@ -22,6 +22,7 @@
 #define __G_THREADPRIVATE_H__
 
 #include "deprecated/gthread.h"
+#include "glib_trace.h"
 
 typedef struct _GRealThread GRealThread;
 struct  _GRealThread
@@ -44,6 +45,8 @@ void            g_system_thread_free            (GRealThread  *thread);
 
 void            g_system_thread_exit            (void);
 void            g_system_thread_set_name        (const gchar  *name);
+gboolean        g_system_thread_set_affinity    (const guint  *cpus,
+                                                 guint         n_cpus);
 
 
 /* gthread.c */
@@ -56,4 +59,33 @@ GThread *       g_thread_new_internal           (const gchar  *name,
 
 gpointer        g_thread_proxy                  (gpointer      thread);
 
+/* glockprofile.c */
+typedef enum
+{
+  G_LOCK_PROFILE_MUTEX,
+  G_LOCK_PROFILE_REC_MUTEX,
+  G_LOCK_PROFILE_RW_LOCK,
+  G_LOCK_PROFILE_BIT_LOCK,
+  G_LOCK_PROFILE_POINTER_BIT_LOCK
+} GLockProfileKind;
+
+extern gboolean g_lock_profile_active;
+
+/* Whether the contended paths of the locks should measure how long
+ * they wait and report it with g_lock_profile_contended().
+ */
+#define g_lock_profile_wanted() \
+  G_UNLIKELY (g_lock_profile_active || TRACE_ENABLED (GLIB_LOCK_CONTENDED))
+
+void            g_lock_profile_contended        (gconstpointer     lock,
+                                                 GLockProfileKind  kind,
+                                                 gint64            wait_start);
+void            g_lock_profile_released         (gconstpointer     lock,
+                                                 GLockProfileKind  kind);
+
+/* gbitlock.c */
+void            g_futex_wait                    (const volatile gint *address,
+                                                 gint                 value);
+void            g_futex_wake                    (const volatile gint *address);
+
 #endif /* __G_THREADPRIVATE_H__ */
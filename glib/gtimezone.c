@@ -37,6 +37,8 @@
 #include "gslice.h"
 #include "gdatetime.h"
 #include "gdate.h"
+#include "gmain.h"
+#include "gstdio.h"
 
 #ifdef G_OS_WIN32
 #define STRICT
@@ -183,11 +185,33 @@ struct _GTimeZone
   GArray  *t_info;         /* Array of TransitionInfo */
   GArray  *transitions;    /* Array of Transition */
   gint     ref_count;
+  guint    last_interval;  /* hint: the last interval found, see find_interval_utc() */
 };
 
 G_LOCK_DEFINE_STATIC (time_zones);
 static GHashTable/*<string?, GTimeZone>*/ *time_zones;
 
+/* The zone g_time_zone_new_local() made for a value of TZ, which is
+ * looked up without taking a lock. A replaced LocalZone is never
+ * freed, since another thread may still be taking a reference on its
+ * zone.
+ */
+typedef struct
+{
+  GTimeZone *tz;
+  gchar     *tzenv;
+  gint       checked;    /* second of monotonic time it was last checked */
+#ifdef G_OS_UNIX
+  GStatBuf   localtime;  /* /etc/localtime, if TZ is unset */
+#elif defined (G_OS_WIN32)
+  TIME_ZONE_INFORMATION tzi; /* the system's zone, if TZ is unset */
+#endif
+} LocalZone;
+
+G_LOCK_DEFINE_STATIC (local_zone);
+static LocalZone *local_zone;
+static GSList/*<LocalZone>*/ *retired_local_zones;
+
 #define MIN_TZYEAR 1916 /* Daylight Savings started in WWI */
 #define MAX_TZYEAR 2999 /* And it's not likely ever to go away, but
                            there's no point in getting carried
@@ -1463,6 +1487,54 @@ g_time_zone_new_utc (void)
   return g_time_zone_new ("UTC");
 }
 
+static void
+local_zone_stat (LocalZone *local)
+{
+#ifdef G_OS_UNIX
+  if (local->tzenv == NULL &&
+      g_stat ("/etc/localtime", &local->localtime) != 0)
+    memset (&local->localtime, 0, sizeof local->localtime);
+#elif defined (G_OS_WIN32)
+  if (local->tzenv == NULL &&
+      GetTimeZoneInformation (&local->tzi) == TIME_ZONE_ID_INVALID)
+    memset (&local->tzi, 0, sizeof local->tzi);
+#endif
+}
+
+/* Whether @local still describes the local time zone, for zones that
+ * may change under the same value of TZ
+ */
+static gboolean
+local_zone_is_current (LocalZone *local)
+{
+#ifdef G_OS_UNIX
+  LocalZone now;
+
+  if (local->tzenv != NULL)
+    return TRUE;
+
+  now.tzenv = NULL;
+  local_zone_stat (&now);
+
+  return now.localtime.st_dev == local->localtime.st_dev &&
+         now.localtime.st_ino == local->localtime.st_ino &&
+         now.localtime.st_size == local->localtime.st_size &&
+         now.localtime.st_mtime == local->localtime.st_mtime;
+#elif defined (G_OS_WIN32)
+  LocalZone now;
+
+  if (local->tzenv != NULL)
+    return TRUE;
+
+  now.tzenv = NULL;
+  local_zone_stat (&now);
+
+  return memcmp (&now.tzi, &local->tzi, sizeof now.tzi) == 0;
+#else
+  return TRUE;
+#endif
+}
+
 /**
  * g_time_zone_new_local:
  *
@@ -1470,6 +1542,10 @@ g_time_zone_new_utc (void)
  * zone may change between invocations to this function; for example,
  * if the system administrator changes it.
  *
+ * The local time zone is cached, so that this function is cheap to call
+ * often. Changes of the `TZ` environment variable are seen at once, but
+ * changes to the system's time zone may take up to a second to be seen.
+ *
  * This is equivalent to calling g_time_zone_new() with the value of
  * the `TZ` environment variable (including the possibility of %NULL).
  *
@@ -1483,7 +1559,40 @@ g_time_zone_new_utc (void)
 GTimeZone *
 g_time_zone_new_local (void)
 {
-  return g_time_zone_new (getenv ("TZ"));
+  const gchar *tzenv = getenv ("TZ");
+  gint now = g_get_monotonic_time () / G_USEC_PER_SEC;
+  LocalZone *local;
+  GTimeZone *tz;
+
+  /* The zone is checked for changes at most once a second */
+  local = g_atomic_pointer_get (&local_zone);
+  if (local != NULL && g_strcmp0 (local->tzenv, tzenv) == 0 &&
+      g_atomic_int_get (&local->checked) == now)
+    return g_time_zone_ref (local->tz);
+
+  G_LOCK (local_zone);
+
+  local = local_zone;
+  if (local != NULL && g_strcmp0 (local->tzenv, tzenv) == 0 &&
+      local_zone_is_current (local))
+    g_atomic_int_set (&local->checked, now);
+  else
+    {
+      if (local != NULL)
+        retired_local_zones = g_slist_prepend (retired_local_zones, local);
+
+      local = g_new0 (LocalZone, 1);
+      local->tzenv = g_strdup (tzenv);
+      local_zone_stat (local);
+      local->tz = g_time_zone_new (tzenv);
+      local->checked = now;
+      g_atomic_pointer_set (&local_zone, local);
+    }
+
+  tz = g_time_zone_ref (local->tz);
+  G_UNLOCK (local_zone);
+
+  return tz;
 }
 
 #define TRANSITION(n)         g_array_index (tz->transitions, Transition, n)
@@ -1596,6 +1705,39 @@ interval_valid (GTimeZone *tz,
 
 /* g_time_zone_find_interval() {{{1 */
 
+/* Finds the interval containing @time_ UTC: that is the number of
+ * transitions at or before @time_.  Conversions of nearby times tend to
+ * hit the same interval, so the last result is tried first.  The hint is
+ * shared by all users of @tz, but it is only ever checked before use, so
+ * racing updates are harmless.
+ */
+static guint
+find_interval_utc (GTimeZone *tz,
+                   gint64     time_)
+{
+  guint lo, hi;
+
+  lo = g_atomic_int_get (&tz->last_interval);
+  if (interval_start (tz, lo) <= time_ && time_ <= interval_end (tz, lo))
+    return lo;
+
+  lo = 0;
+  hi = tz->transitions->len;
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (TRANSITION(mid).time <= time_)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  g_atomic_int_set (&tz->last_interval, lo);
+
+  return lo;
+}
+
 /**
  * g_time_zone_adjust_time:
  * @tz: a #GTimeZone
@@ -1636,11 +1778,8 @@ g_time_zone_adjust_time (GTimeZone *tz,
 
   intervals = tz->transitions->len;
 
-  /* find the interval containing *time UTC
-   * TODO: this could be binary searched (or better) */
-  for (i = 0; i <= intervals; i++)
-    if (*time_ <= interval_end (tz, i))
-      break;
+  /* find the interval containing *time UTC */
+  i = find_interval_utc (tz, *time_);
 
   g_assert (interval_start (tz, i) <= *time_ && *time_ <= interval_end (tz, i));
 
@@ -1727,9 +1866,7 @@ g_time_zone_find_interval (GTimeZone *tz,
   if (tz->transitions == NULL)
     return 0;
   intervals = tz->transitions->len;
-  for (i = 0; i <= intervals; i++)
-    if (time_ <= interval_end (tz, i))
-      break;
+  i = find_interval_utc (tz, time_);
 
   if (type == G_TIME_TYPE_UNIVERSAL)
     return i;
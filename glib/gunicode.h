@@ -871,6 +871,12 @@ GLIB_AVAILABLE_IN_ALL
 gchar *g_utf8_normalize (const gchar   *str,
                          gssize         len,
                          GNormalizeMode mode) G_GNUC_MALLOC;
+GLIB_AVAILABLE_IN_2_54
+gssize g_utf8_normalize_to_buffer (const gchar    *str,
+                                   gssize          len,
+                                   GNormalizeMode  mode,
+                                   gchar          *buffer,
+                                   gsize           buffer_size);
 
 GLIB_AVAILABLE_IN_ALL
 gint   g_utf8_collate     (const gchar *str1,
@@ -886,6 +892,31 @@ GLIB_AVAILABLE_IN_2_52
 gchar *g_utf8_make_valid (const gchar *str,
                           gssize       len) G_GNUC_MALLOC;
 
+typedef struct _GUtf8Index GUtf8Index;
+
+GLIB_AVAILABLE_IN_2_54
+GUtf8Index  *g_utf8_index_new               (const gchar *str,
+                                             gssize       len);
+GLIB_AVAILABLE_IN_2_54
+void         g_utf8_index_free              (GUtf8Index  *index_);
+GLIB_AVAILABLE_IN_2_54
+void         g_utf8_index_update            (GUtf8Index  *index_,
+                                             const gchar *str,
+                                             gssize       len,
+                                             gsize        changed_from);
+GLIB_AVAILABLE_IN_2_54
+glong        g_utf8_index_get_length        (GUtf8Index  *index_);
+GLIB_AVAILABLE_IN_2_54
+const gchar *g_utf8_index_offset_to_pointer (GUtf8Index  *index_,
+                                             glong        offset);
+GLIB_AVAILABLE_IN_2_54
+glong        g_utf8_index_pointer_to_offset (GUtf8Index  *index_,
+                                             const gchar *pos);
+GLIB_AVAILABLE_IN_2_54
+gchar       *g_utf8_index_substring         (GUtf8Index  *index_,
+                                             glong        start_pos,
+                                             glong        end_pos) G_GNUC_MALLOC;
+
 G_END_DECLS
 
 #endif /* __G_UNICODE_H__ */
@@ -206,6 +206,43 @@ utf8_encode (char *buf, wchar_t val)
 
   return retval;
 }
+
+/* Appends the collation key of @str to @result.  Most keys fit into
+ * the stack buffer, so wcsxfrm() normally only has to run once.
+ */
+static void
+collate_key_append_wc (GString     *result,
+                       const gchar *str,
+                       gssize       len)
+{
+  wchar_t stack_xfrm[256];
+  wchar_t *xfrm = stack_xfrm;
+  gsize xfrm_len, key_len, i;
+  gunichar *str_norm;
+  gchar *p;
+
+  str_norm = _g_utf8_normalize_wc (str, len, G_NORMALIZE_ALL_COMPOSE);
+
+  xfrm_len = wcsxfrm (xfrm, (wchar_t *)str_norm, G_N_ELEMENTS (stack_xfrm));
+  if (xfrm_len >= G_N_ELEMENTS (stack_xfrm))
+    {
+      xfrm = g_new (wchar_t, xfrm_len + 1);
+      wcsxfrm (xfrm, (wchar_t *)str_norm, xfrm_len + 1);
+    }
+
+  key_len = 0;
+  for (i = 0; i < xfrm_len; i++)
+    key_len += utf8_encode (NULL, xfrm[i]);
+
+  g_string_set_size (result, result->len + key_len);
+  p = result->str + result->len - key_len;
+  for (i = 0; i < xfrm_len; i++)
+    p += utf8_encode (p, xfrm[i]);
+
+  if (xfrm != stack_xfrm)
+    g_free (xfrm);
+  g_free (str_norm);
+}
 #endif /* __STDC_ISO_10646__ */
 
 #ifdef HAVE_CARBON
@@ -384,34 +421,13 @@ g_utf8_collate_key (const gchar *str,
 
 #elif defined(__STDC_ISO_10646__)
 
-  gsize xfrm_len;
-  gunichar *str_norm;
-  wchar_t *result_wc;
-  gsize i;
-  gsize result_len = 0;
+  GString *key;
 
   g_return_val_if_fail (str != NULL, NULL);
 
-  str_norm = _g_utf8_normalize_wc (str, len, G_NORMALIZE_ALL_COMPOSE);
-
-  xfrm_len = wcsxfrm (NULL, (wchar_t *)str_norm, 0);
-  result_wc = g_new (wchar_t, xfrm_len + 1);
-  wcsxfrm (result_wc, (wchar_t *)str_norm, xfrm_len + 1);
-
-  for (i = 0; i < xfrm_len; i++)
-    result_len += utf8_encode (NULL, result_wc[i]);
-
-  result = g_malloc (result_len + 1);
-  result_len = 0;
-  for (i = 0; i < xfrm_len; i++)
-    result_len += utf8_encode (result + result_len, result_wc[i]);
-
-  result[result_len] = '\0';
-
-  g_free (result_wc);
-  g_free (str_norm);
-
-  return result;
+  key = g_string_sized_new (0);
+  collate_key_append_wc (key, str, len);
+  result = g_string_free (key, FALSE);
 #else /* !__STDC_ISO_10646__ */
 
   gsize xfrm_len;
@@ -478,6 +494,24 @@ g_utf8_collate_key (const gchar *str,
  */
 #define COLLATION_SENTINEL "\1\1\1"
 
+#ifndef HAVE_CARBON
+static void
+collate_key_append (GString     *result,
+                    const gchar *str,
+                    gssize       len)
+{
+#ifdef __STDC_ISO_10646__
+  collate_key_append_wc (result, str, len);
+#else
+  gchar *collate_key;
+
+  collate_key = g_utf8_collate_key (str, len);
+  g_string_append (result, collate_key);
+  g_free (collate_key);
+#endif
+}
+#endif
+
 /**
  * g_utf8_collate_key_for_filename:
  * @str: a UTF-8 encoded string.
@@ -510,7 +544,6 @@ g_utf8_collate_key_for_filename (const gchar *str,
   const gchar *p;
   const gchar *prev;
   const gchar *end;
-  gchar *collate_key;
   gint digits;
   gint leading_zeros;
 
@@ -576,9 +609,7 @@ g_utf8_collate_key_for_filename (const gchar *str,
 	case '.':
 	  if (prev != p) 
 	    {
-	      collate_key = g_utf8_collate_key (prev, p - prev);
-	      g_string_append (result, collate_key);
-	      g_free (collate_key);
+	      collate_key_append (result, prev, p - prev);
 	    }
 	  
 	  g_string_append (result, COLLATION_SENTINEL "\1");
@@ -599,9 +630,7 @@ g_utf8_collate_key_for_filename (const gchar *str,
 	case '9':
 	  if (prev != p) 
 	    {
-	      collate_key = g_utf8_collate_key (prev, p - prev);
-	      g_string_append (result, collate_key);
-	      g_free (collate_key);
+	      collate_key_append (result, prev, p - prev);
 	    }
 	  
 	  g_string_append (result, COLLATION_SENTINEL "\2");
@@ -667,9 +696,7 @@ g_utf8_collate_key_for_filename (const gchar *str,
   
   if (prev != p) 
     {
-      collate_key = g_utf8_collate_key (prev, p - prev);
-      g_string_append (result, collate_key);
-      g_free (collate_key);
+      collate_key_append (result, prev, p - prev);
     }
   
   g_string_append (result, append->str);
@@ -43,10 +43,13 @@
 #include "config.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "gunicode.h"
 #include "gunidecomp.h"
 #include "gmem.h"
+#include "gstrfuncs.h"
+#include "gtestutils.h"
 #include "gunicomp.h"
 #include "gunicodeprivate.h"
 
@@ -353,6 +356,74 @@ combine (gunichar  a,
   return FALSE;
 }
 
+/* Characters which no normalization mode changes, and which neither
+ * reorder nor compose with the characters around them, so that text up
+ * to the last of them before anything else can be copied unchanged.
+ * There are no composition exclusions and no combining marks below
+ * U+0300, and nothing there is the second half of a composition, so
+ * canonical decompositions there compose back to the same character.
+ */
+static inline gboolean
+normalize_is_stable (gunichar ch,
+                     gboolean do_compat,
+                     gboolean do_compose)
+{
+  const gchar *decomp;
+
+  if (ch < 0x80)
+    return TRUE;
+  if (ch >= 0x300)
+    return FALSE;
+
+  decomp = find_decomposition (ch, do_compat);
+  if (decomp == NULL)
+    return TRUE;
+
+  /* a compatibility decomposition, if any, comes from another offset */
+  return do_compose && (!do_compat || decomp == find_decomposition (ch, FALSE));
+}
+
+/* Returns the length of the start of @str which normalizes to itself,
+ * setting @complete if that is all of @str.
+ */
+static gsize
+normalize_stable_prefix (const gchar    *str,
+                         gssize          max_len,
+                         GNormalizeMode  mode,
+                         gboolean       *complete)
+{
+  gboolean do_compat = (mode == G_NORMALIZE_NFKC ||
+			mode == G_NORMALIZE_NFKD);
+  gboolean do_compose = (mode == G_NORMALIZE_NFC ||
+			 mode == G_NORMALIZE_NFKC);
+  const gchar *p, *last;
+
+  p = last = str;
+  while ((max_len < 0 || p < str + max_len) && *p)
+    {
+      if (*(guchar *) p < 0x80)
+        {
+          last = p++;
+          continue;
+        }
+
+      if ((max_len >= 0 && g_utf8_skip[*(guchar *) p] > str + max_len - p) ||
+          !normalize_is_stable (g_utf8_get_char (p), do_compat, do_compose))
+        {
+          /* the last stable character may still compose with this one */
+          *complete = FALSE;
+          return last - str;
+        }
+
+      last = p;
+      p = g_utf8_next_char (p);
+    }
+
+  *complete = TRUE;
+
+  return p - str;
+}
+
 gunichar *
 _g_utf8_normalize_wc (const gchar    *str,
 		      gssize          max_len,
@@ -366,6 +437,21 @@ _g_utf8_normalize_wc (const gchar    *str,
 			mode == G_NORMALIZE_NFKD);
   gboolean do_compose = (mode == G_NORMALIZE_NFC ||
 			 mode == G_NORMALIZE_NFKC);
+  gboolean complete;
+  gsize prefix;
+
+  /* Already normalized text only needs decoding */
+  prefix = normalize_stable_prefix (str, max_len, mode, &complete);
+  if (complete)
+    {
+      wc_buffer = g_new (gunichar, prefix + 1);
+      n_wc = 0;
+      for (p = str; p < str + prefix; p = g_utf8_next_char (p))
+        wc_buffer[n_wc++] = g_utf8_get_char (p);
+      wc_buffer[n_wc] = 0;
+
+      return wc_buffer;
+    }
 
   n_wc = 0;
   p = str;
@@ -530,15 +616,110 @@ g_utf8_normalize (const gchar    *str,
 		  gssize          len,
 		  GNormalizeMode  mode)
 {
-  gunichar *result_wc = _g_utf8_normalize_wc (str, len, mode);
-  gchar *result;
+  gunichar *result_wc;
+  gchar *result, *tail;
+  gboolean complete;
+  gsize prefix, tail_len;
+
+  prefix = normalize_stable_prefix (str, len, mode, &complete);
+  if (complete)
+    return g_strndup (str, prefix);
 
-  result = g_ucs4_to_utf8 (result_wc, -1, NULL, NULL, NULL);
+  result_wc = _g_utf8_normalize_wc (str + prefix, len < 0 ? -1 : len - prefix, mode);
+  tail = g_ucs4_to_utf8 (result_wc, -1, NULL, NULL, NULL);
   g_free (result_wc);
 
+  if (tail == NULL || prefix == 0)
+    return tail;
+
+  tail_len = strlen (tail);
+  result = g_malloc (prefix + tail_len + 1);
+  memcpy (result, str, prefix);
+  memcpy (result + prefix, tail, tail_len + 1);
+  g_free (tail);
+
   return result;
 }
 
+/**
+ * g_utf8_normalize_to_buffer:
+ * @str: a UTF-8 encoded string
+ * @len: length of @str, in bytes, or -1 if @str is nul-terminated
+ * @mode: the type of normalization to perform
+ * @buffer: (out caller-allocates) (array length=buffer_size) (nullable):
+ *   a buffer to write the normalized string to
+ * @buffer_size: the size of @buffer in bytes
+ *
+ * Like g_utf8_normalize(), but writes the nul-terminated result to
+ * @buffer instead of allocating it.  @buffer is only written to when
+ * the result fits, so to size a buffer, call this function with a
+ * @buffer_size of 0 first.
+ *
+ * Text which is already normalized, such as plain ASCII, is copied
+ * without further processing.
+ *
+ * Returns: the length in bytes of the normalized form of @str, not
+ *   including the nul terminator; if this is not smaller than
+ *   @buffer_size, nothing was written.  If @str is not valid UTF-8,
+ *   -1 is returned.
+ *
+ * Since: 2.54
+ */
+gssize
+g_utf8_normalize_to_buffer (const gchar    *str,
+                            gssize          len,
+                            GNormalizeMode  mode,
+                            gchar          *buffer,
+                            gsize           buffer_size)
+{
+  gunichar *result_wc;
+  gboolean complete;
+  gsize prefix, n_bytes, i;
+
+  g_return_val_if_fail (str != NULL, -1);
+  g_return_val_if_fail (buffer != NULL || buffer_size == 0, -1);
+
+  prefix = normalize_stable_prefix (str, len, mode, &complete);
+  if (complete)
+    {
+      if (prefix < buffer_size)
+        {
+          memcpy (buffer, str, prefix);
+          buffer[prefix] = '\0';
+        }
+
+      return prefix;
+    }
+
+  result_wc = _g_utf8_normalize_wc (str + prefix, len < 0 ? -1 : len - prefix, mode);
+
+  n_bytes = prefix;
+  for (i = 0; result_wc[i]; i++)
+    {
+      /* what g_utf8_get_char() makes of invalid input */
+      if (result_wc[i] & 0x80000000)
+        {
+          g_free (result_wc);
+          return -1;
+        }
+      n_bytes += g_unichar_to_utf8 (result_wc[i], NULL);
+    }
+
+  if (n_bytes < buffer_size)
+    {
+      gchar *p = buffer + prefix;
+
+      memcpy (buffer, str, prefix);
+      for (i = 0; result_wc[i]; i++)
+        p += g_unichar_to_utf8 (result_wc[i], p);
+      *p = '\0';
+    }
+
+  g_free (result_wc);
+
+  return n_bytes;
+}
+
 static gboolean
 decompose_hangul_step (gunichar  ch,
                        gunichar *a,
@@ -25,6 +25,7 @@
 #include <locale.h>
 
 #include "gmem.h"
+#include "gstrfuncs.h"
 #include "gstring.h"
 #include "gtestutils.h"
 #include "gtypes.h"
@@ -1144,15 +1145,24 @@ g_utf8_casefold (const gchar *str,
 
   g_return_val_if_fail (str != NULL, NULL);
 
-  result = g_string_new (NULL);
+  result = g_string_sized_new (len < 0 ? 0 : len);
   p = str;
   while ((len < 0 || p < str + len) && *p)
     {
-      gunichar ch = g_utf8_get_char (p);
-
+      gunichar ch;
       int start = 0;
       int end = G_N_ELEMENTS (casefold_table);
 
+      /* ASCII has no special casings */
+      if (*(guchar *) p < 0x80)
+        {
+          g_string_append_c (result, g_ascii_tolower (*p));
+          p++;
+          continue;
+        }
+
+      ch = g_utf8_get_char (p);
+
       if (ch >= casefold_table[start].ch &&
           ch <= casefold_table[end - 1].ch)
 	{
@@ -60,6 +60,85 @@ unescape_character (const char *scanner)
   return (first_digit << 4) | second_digit;
 }
 
+/**
+ * g_uri_unescape_segment_to_buffer:
+ * @escaped_string: an escaped string
+ * @escaped_string_end: (nullable): Pointer to end of @escaped_string, may be %NULL
+ * @illegal_characters: (nullable): An optional string of illegal characters not to be allowed, may be %NULL
+ * @buffer: a buffer of at least @escaped_string_end - @escaped_string + 1
+ *     bytes to store the result in, which may be @escaped_string itself
+ *
+ * Like g_uri_unescape_segment(), but writes the unescaped, nul-terminated
+ * segment to @buffer instead of allocating a new string.  As unescaping
+ * never makes a string longer, @buffer can be the same as
+ * @escaped_string to unescape a segment in place.
+ *
+ * The unescaped parts of @escaped_string are copied in runs, so this is
+ * considerably faster than looking at each character for long segments
+ * with few escapes.
+ *
+ * On error, the contents of @buffer are undefined.
+ *
+ * Returns: the length of the unescaped segment, not including the
+ *     nul terminator, or -1 on error
+ *
+ * Since: 2.54
+ **/
+gssize
+g_uri_unescape_segment_to_buffer (const char *escaped_string,
+                                  const char *escaped_string_end,
+                                  const char *illegal_characters,
+                                  char       *buffer)
+{
+  const char *in, *escape;
+  char *out;
+  gint character;
+
+  g_return_val_if_fail (escaped_string != NULL, -1);
+  g_return_val_if_fail (buffer != NULL, -1);
+
+  if (escaped_string_end == NULL)
+    escaped_string_end = escaped_string + strlen (escaped_string);
+
+  in = escaped_string;
+  out = buffer;
+  while (in < escaped_string_end)
+    {
+      escape = memchr (in, '%', escaped_string_end - in);
+      if (escape == NULL)
+        escape = escaped_string_end;
+
+      if (out != in)
+        memmove (out, in, escape - in);
+      out += escape - in;
+      in = escape;
+
+      if (in == escaped_string_end)
+        break;
+
+      if (escaped_string_end - in < 3)
+        {
+          /* Invalid escaped char (to short) */
+          return -1;
+        }
+
+      character = unescape_character (in + 1);
+
+      /* Check for an illegal character. We consider '\0' illegal here. */
+      if (character <= 0 ||
+          (illegal_characters != NULL &&
+           strchr (illegal_characters, (char)character) != NULL))
+        return -1;
+
+      *out++ = (char)character;
+      in += 3;
+    }
+
+  *out = '\0';
+
+  return out - buffer;
+}
+
 /**
  * g_uri_unescape_segment:
  * @escaped_string: (nullable): A string, may be %NULL
@@ -74,6 +153,8 @@ unescape_character (const char *scanner)
  * slash being expanded in an escaped path element, which might confuse pathname
  * handling.
  *
+ * See g_uri_unescape_segment_to_buffer() to avoid allocating the result.
+ *
  * Returns: an unescaped version of @escaped_string or %NULL on error.
  * The returned string should be freed when no longer needed.  As a
  * special case if %NULL is given for @escaped_string, this function
@@ -86,9 +167,7 @@ g_uri_unescape_segment (const char *escaped_string,
 			const char *escaped_string_end,
 			const char *illegal_characters)
 {
-  const char *in;
-  char *out, *result;
-  gint character;
+  char *result;
   
   if (escaped_string == NULL)
     return NULL;
@@ -98,40 +177,13 @@ g_uri_unescape_segment (const char *escaped_string,
   
   result = g_malloc (escaped_string_end - escaped_string + 1);
   
-  out = result;
-  for (in = escaped_string; in < escaped_string_end; in++)
+  if (g_uri_unescape_segment_to_buffer (escaped_string, escaped_string_end,
+                                        illegal_characters, result) < 0)
     {
-      character = *in;
-      
-      if (*in == '%')
-	{
-	  in++;
-	  
-	  if (escaped_string_end - in < 2)
-	    {
-	      /* Invalid escaped char (to short) */
-	      g_free (result);
-	      return NULL;
-	    }
-	  
-	  character = unescape_character (in);
-	  
-	  /* Check for an illegal character. We consider '\0' illegal here. */
-	  if (character <= 0 ||
-	      (illegal_characters != NULL &&
-	       strchr (illegal_characters, (char)character) != NULL))
-	    {
-	      g_free (result);
-	      return NULL;
-	    }
-	  
-	  in++; /* The other char will be eaten in the loop header */
-	}
-      *out++ = (char)character;
+      g_free (result);
+      return NULL;
     }
   
-  *out = '\0';
-  
   return result;
 }
 
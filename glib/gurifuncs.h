@@ -71,6 +71,11 @@ GLIB_AVAILABLE_IN_ALL
 char *   g_uri_unescape_segment      (const char *escaped_string,
 				      const char *escaped_string_end,
 				      const char *illegal_characters);
+GLIB_AVAILABLE_IN_2_54
+gssize   g_uri_unescape_segment_to_buffer (const char *escaped_string,
+                                           const char *escaped_string_end,
+                                           const char *illegal_characters,
+                                           char       *buffer);
 GLIB_AVAILABLE_IN_ALL
 char *   g_uri_parse_scheme          (const char *uri);
 GLIB_AVAILABLE_IN_ALL
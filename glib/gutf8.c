@@ -32,14 +32,22 @@
 #undef STRICT
 #endif
 
+#include "garray.h"
 #include "gconvert.h"
 #include "ghash.h"
+#include "gslice.h"
 #include "gstrfuncs.h"
 #include "gtestutils.h"
 #include "gtypes.h"
 #include "gthread.h"
 #include "glibintl.h"
 
+#if defined (__SSE2__) || defined (_M_X64) || defined (_M_AMD64) || \
+    (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define UTF8_ASCII_SSE2 1
+#endif
+
 #define UTF8_COMPUTE(Char, Mask, Len)					      \
   if (Char < 128)							      \
     {									      \
@@ -123,6 +131,48 @@ static const gchar utf8_skip_data[256] = {
 
 const gchar * const g_utf8_skip = utf8_skip_data;
 
+#define ASCII_LSBS G_GUINT64_CONSTANT (0x0101010101010101)
+#define ASCII_MSBS G_GUINT64_CONSTANT (0x8080808080808080)
+
+/* Returns the length of the run of non-nul ASCII bytes at the start of
+ * the @len bytes at @str, rounded down to a whole number of blocks, so
+ * the callers still look at the last few bytes one by one.  Never reads
+ * beyond @str + @len.
+ */
+static inline gsize
+utf8_ascii_prefix (const gchar *str,
+                   gsize        len)
+{
+  gsize i = 0;
+
+#ifdef UTF8_ASCII_SSE2
+  const __m128i zero = _mm_setzero_si128 ();
+
+  for (; i + 16 <= len; i += 16)
+    {
+      __m128i block = _mm_loadu_si128 ((const __m128i *) (str + i));
+
+      /* top bit set, or a nul */
+      if (_mm_movemask_epi8 (_mm_or_si128 (block, _mm_cmpeq_epi8 (block, zero))))
+        break;
+    }
+#endif
+
+  for (; i + 8 <= len; i += 8)
+    {
+      guint64 block;
+
+      memcpy (&block, str + i, sizeof block);
+
+      /* With all top bits clear, this is an exact test for a nul byte */
+      if ((block & ASCII_MSBS) != 0 ||
+          ((block - ASCII_LSBS) & ~block & ASCII_MSBS) != 0)
+        break;
+    }
+
+  return i;
+}
+
 /**
  * g_utf8_find_prev_char:
  * @str: pointer to the beginning of a UTF-8 encoded string
@@ -724,8 +774,21 @@ g_utf8_to_ucs4_fast (const gchar *str,
     {
       while (p < str + len && *p)
 	{
-	  p = g_utf8_next_char (p);
-	  ++n_chars;
+	  gsize run = utf8_ascii_prefix (p, str + len - p);
+
+	  p += run;
+	  n_chars += run;
+	  while (p < str + len && *p != 0 && (guchar) *p < 0x80)
+	    {
+	      p++;
+	      ++n_chars;
+	    }
+
+	  if (p < str + len && *p)
+	    {
+	      p = g_utf8_next_char (p);
+	      ++n_chars;
+	    }
 	}
     }
   
@@ -1284,7 +1347,7 @@ g_utf8_to_utf16 (const gchar *str,
 {
   gunichar2 *result = NULL;
   gint n16;
-  const gchar *in;
+  const gchar *in, *end;
   gint i;
 
   g_return_val_if_fail (str != NULL, NULL);
@@ -1293,7 +1356,16 @@ g_utf8_to_utf16 (const gchar *str,
   n16 = 0;
   while ((len < 0 || str + len - in > 0) && *in)
     {
-      gunichar wc = g_utf8_get_char_extended (in, len < 0 ? 6 : str + len - in);
+      gunichar wc;
+
+      if ((guchar) *in < 0x80)
+        {
+          in++;
+          n16++;
+          continue;
+        }
+
+      wc = g_utf8_get_char_extended (in, len < 0 ? 6 : str + len - in);
       if (wc & 0x80000000)
 	{
 	  if (wc == (gunichar)-2)
@@ -1339,10 +1411,23 @@ g_utf8_to_utf16 (const gchar *str,
   if (result == NULL)
       goto err_out;
 
+  end = in;
   in = str;
   for (i = 0; i < n16;)
     {
-      gunichar wc = g_utf8_get_char (in);
+      const gchar *run_end;
+      gunichar wc;
+
+      /* the input is known to be valid up to @end by now */
+      run_end = in + utf8_ascii_prefix (in, end - in);
+      while (in < run_end)
+        result[i++] = (guchar) *in++;
+      while (in < end && (guchar) *in < 0x80)
+        result[i++] = (guchar) *in++;
+      if (in == end)
+        break;
+
+      wc = g_utf8_get_char (in);
 
       if (wc < 0x10000)
 	{
@@ -1553,7 +1638,15 @@ fast_validate_len (const char *str,
   for (p = str; ((p - str) < max_len) && *p; p++)
     {
       if (*(guchar *)p < 128)
-	/* done */;
+	{
+	  gsize run = utf8_ascii_prefix (p, max_len - (p - str));
+
+	  /* move to the last byte of this run of ASCII */
+	  if (run > 0)
+	    p += run - 1;
+	  while ((p + 1 - str) < max_len && p[1] != 0 && *(guchar *)(p + 1) < 128)
+	    p++;
+	}
       else 
 	{
 	  const gchar *last;
@@ -1800,3 +1893,306 @@ g_utf8_make_valid (const gchar *str,
 
   return g_string_free (string, FALSE);
 }
+
+/* A checkpoint every UTF8_INDEX_STRIDE characters: lookups walk at most
+ * that many characters, and the index costs one gsize per checkpoint.
+ */
+#define UTF8_INDEX_STRIDE 512
+
+struct _GUtf8Index
+{
+  const gchar *str;
+  gsize len;
+  glong n_chars;
+  GArray *checkpoints;  /* byte offset of the character at n * STRIDE */
+};
+
+static inline guint
+utf8_count_continuations (guint64 block)
+{
+  /* top bit set and the next one clear: 10xxxxxx */
+  block &= ~(block << 1) & ASCII_MSBS;
+
+#if defined (__GNUC__) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4))
+  return __builtin_popcountll (block);
+#else
+  {
+    guint n = 0;
+
+    for (; block != 0; block &= block - 1)
+      n++;
+
+    return n;
+  }
+#endif
+}
+
+/* Drops all checkpoints after @from and scans the rest of the string */
+static void
+utf8_index_build (GUtf8Index *index_,
+                  guint       from)
+{
+  const gchar *p, *end;
+  guint count = 0;
+
+  g_array_set_size (index_->checkpoints, from + 1);
+  p = index_->str + g_array_index (index_->checkpoints, gsize, from);
+  end = index_->str + index_->len;
+
+  while (p < end)
+    {
+      /* Count whole blocks as long as they can't complete a stride,
+       * the character starting the next stride is found bytewise.
+       */
+      if (count + 8 <= UTF8_INDEX_STRIDE && end - p >= 8)
+        {
+          guint64 block;
+
+          memcpy (&block, p, sizeof block);
+          count += 8 - utf8_count_continuations (block);
+          p += 8;
+          continue;
+        }
+
+      if ((*(guchar *) p & 0xc0) != 0x80)
+        {
+          if (count == UTF8_INDEX_STRIDE)
+            {
+              gsize offset = p - index_->str;
+
+              g_array_append_val (index_->checkpoints, offset);
+              count = 0;
+            }
+          count++;
+        }
+      p++;
+    }
+
+  index_->n_chars = (glong) (index_->checkpoints->len - 1) * UTF8_INDEX_STRIDE + count;
+}
+
+/* Returns the last checkpoint at or before the byte offset @offset */
+static guint
+utf8_index_find_checkpoint (GUtf8Index *index_,
+                            gsize       offset)
+{
+  const gsize *checkpoints = (const gsize *) index_->checkpoints->data;
+  guint lower = 0, upper = index_->checkpoints->len;
+
+  while (upper - lower > 1)
+    {
+      guint middle = lower + (upper - lower) / 2;
+
+      if (checkpoints[middle] <= offset)
+        lower = middle;
+      else
+        upper = middle;
+    }
+
+  return lower;
+}
+
+/**
+ * GUtf8Index:
+ *
+ * An opaque structure which maps between character offsets and
+ * positions in a long UTF-8 string in constant time, see
+ * g_utf8_index_new().
+ *
+ * Since: 2.54
+ */
+
+/**
+ * g_utf8_index_new:
+ * @str: a UTF-8 encoded string
+ * @len: the length of @str in bytes, or -1 if it is nul-terminated
+ *
+ * Creates an index for @str which makes g_utf8_index_offset_to_pointer(),
+ * g_utf8_index_pointer_to_offset() and g_utf8_index_substring() take
+ * constant time, instead of time proportional to the offset like
+ * g_utf8_offset_to_pointer() and friends.  The index stores a position
+ * for every few hundred characters, and is built with a single pass
+ * over @str.
+ *
+ * @str is not copied, it must stay valid as long as the index is used.
+ * When @str is modified, call g_utf8_index_update().  Like the other
+ * functions working on characters, the index expects valid UTF-8.
+ *
+ * Returns: (transfer full): a new #GUtf8Index, free it with
+ *   g_utf8_index_free()
+ *
+ * Since: 2.54
+ */
+GUtf8Index *
+g_utf8_index_new (const gchar *str,
+                  gssize       len)
+{
+  GUtf8Index *index_;
+  gsize first = 0;
+
+  g_return_val_if_fail (str != NULL || len == 0, NULL);
+
+  index_ = g_slice_new (GUtf8Index);
+  index_->str = str;
+  index_->len = len < 0 ? strlen (str) : (gsize) len;
+  index_->checkpoints = g_array_new (FALSE, FALSE, sizeof (gsize));
+  g_array_append_val (index_->checkpoints, first);
+
+  utf8_index_build (index_, 0);
+
+  return index_;
+}
+
+/**
+ * g_utf8_index_free:
+ * @index_: a #GUtf8Index
+ *
+ * Frees @index_.  The string it was created for is not affected.
+ *
+ * Since: 2.54
+ */
+void
+g_utf8_index_free (GUtf8Index *index_)
+{
+  g_return_if_fail (index_ != NULL);
+
+  g_array_unref (index_->checkpoints);
+  g_slice_free (GUtf8Index, index_);
+}
+
+/**
+ * g_utf8_index_update:
+ * @index_: a #GUtf8Index
+ * @str: the modified string, which may have moved in memory
+ * @len: the new length of @str in bytes, or -1 if it is nul-terminated
+ * @changed_from: the byte offset of the first byte which may have changed
+ *
+ * Updates @index_ after the string it was created for has been modified,
+ * for example by inserting or deleting text at @changed_from.  Only the
+ * part of the index after @changed_from is rebuilt, so edits near the
+ * end of a long string are cheap.
+ *
+ * Since: 2.54
+ */
+void
+g_utf8_index_update (GUtf8Index  *index_,
+                     const gchar *str,
+                     gssize       len,
+                     gsize        changed_from)
+{
+  g_return_if_fail (index_ != NULL);
+  g_return_if_fail (str != NULL || len == 0);
+
+  index_->str = str;
+  index_->len = len < 0 ? strlen (str) : (gsize) len;
+
+  utf8_index_build (index_, utf8_index_find_checkpoint (index_, changed_from));
+}
+
+/**
+ * g_utf8_index_get_length:
+ * @index_: a #GUtf8Index
+ *
+ * Gets the number of characters in the indexed string, the same as
+ * g_utf8_strlen() would return.
+ *
+ * Returns: the length of the string in characters
+ *
+ * Since: 2.54
+ */
+glong
+g_utf8_index_get_length (GUtf8Index *index_)
+{
+  g_return_val_if_fail (index_ != NULL, 0);
+
+  return index_->n_chars;
+}
+
+/**
+ * g_utf8_index_offset_to_pointer:
+ * @index_: a #GUtf8Index
+ * @offset: a character offset, between 0 and the length of the string
+ *
+ * Converts a character offset into a pointer into the indexed string,
+ * like g_utf8_offset_to_pointer().
+ *
+ * Returns: the character at @offset, or the end of the string if
+ *   @offset is its length
+ *
+ * Since: 2.54
+ */
+const gchar *
+g_utf8_index_offset_to_pointer (GUtf8Index *index_,
+                                glong       offset)
+{
+  const gchar *p;
+
+  g_return_val_if_fail (index_ != NULL, NULL);
+  g_return_val_if_fail (offset >= 0 && offset <= index_->n_chars, NULL);
+
+  p = index_->str + g_array_index (index_->checkpoints, gsize, offset / UTF8_INDEX_STRIDE);
+
+  return g_utf8_offset_to_pointer (p, offset % UTF8_INDEX_STRIDE);
+}
+
+/**
+ * g_utf8_index_pointer_to_offset:
+ * @index_: a #GUtf8Index
+ * @pos: a pointer to a position within the indexed string
+ *
+ * Converts a position in the indexed string into a character offset,
+ * like g_utf8_pointer_to_offset().
+ *
+ * Returns: the character offset of @pos
+ *
+ * Since: 2.54
+ */
+glong
+g_utf8_index_pointer_to_offset (GUtf8Index  *index_,
+                                const gchar *pos)
+{
+  guint checkpoint;
+
+  g_return_val_if_fail (index_ != NULL, 0);
+  g_return_val_if_fail (pos >= index_->str && pos <= index_->str + index_->len, 0);
+
+  checkpoint = utf8_index_find_checkpoint (index_, pos - index_->str);
+
+  return (glong) checkpoint * UTF8_INDEX_STRIDE +
+         g_utf8_pointer_to_offset (index_->str + g_array_index (index_->checkpoints, gsize, checkpoint), pos);
+}
+
+/**
+ * g_utf8_index_substring:
+ * @index_: a #GUtf8Index
+ * @start_pos: a character offset within the indexed string
+ * @end_pos: another character offset, not smaller than @start_pos
+ *
+ * Copies a substring out of the indexed string, like g_utf8_substring().
+ *
+ * Returns: a newly allocated copy of the requested substring.
+ *   Free with g_free() when no longer needed.
+ *
+ * Since: 2.54
+ */
+gchar *
+g_utf8_index_substring (GUtf8Index *index_,
+                        glong       start_pos,
+                        glong       end_pos)
+{
+  const gchar *start, *end;
+  gchar *out;
+
+  g_return_val_if_fail (index_ != NULL, NULL);
+  g_return_val_if_fail (start_pos <= end_pos, NULL);
+
+  start = g_utf8_index_offset_to_pointer (index_, start_pos);
+  end = g_utf8_index_offset_to_pointer (index_, end_pos);
+  g_return_val_if_fail (start != NULL && end != NULL, NULL);
+
+  out = g_malloc (end - start + 1);
+  memcpy (out, start, end - start);
+  out[end - start] = 0;
+
+  return out;
+}
@@ -25,6 +25,7 @@
 #include <glib/gbitlock.h>
 #include <glib/gatomic.h>
 #include <glib/gbytes.h>
+#include <glib/ghash.h>
 #include <glib/gslice.h>
 #include <glib/gmem.h>
 #include <string.h>
@@ -63,6 +64,7 @@ struct _GVariant
     {
       GBytes *bytes;
       gconstpointer data;
+      GHashTable *index;
     } serialised;
 
     struct
@@ -159,6 +161,12 @@ struct _GVariant
  *                if .data pointed to the appropriate number of nul
  *                bytes.
  *
+ *     .index: for big dictionaries with string or object path keys
+ *             that g_variant_lookup_value() was used on, a hash table
+ *             mapping each key to the position of its first entry.
+ *             It is built on the first lookup and set atomically, and
+ *             is otherwise %NULL.
+ *
  *   .tree: Only valid when the instance is in tree form.
  *
  *          Note that accesses from other threads could result in
@@ -450,6 +458,7 @@ g_variant_ensure_serialised (GVariant *value)
       bytes = g_bytes_new_take (data, value->size);
       value->contents.serialised.data = g_bytes_get_data (bytes, NULL);
       value->contents.serialised.bytes = bytes;
+      value->contents.serialised.index = NULL;
       value->state |= STATE_SERIALISED;
     }
 }
@@ -512,6 +521,7 @@ g_variant_new_from_bytes (const GVariantType *type,
   value = g_variant_alloc (type, TRUE, trusted);
 
   value->contents.serialised.bytes = g_bytes_ref (bytes);
+  value->contents.serialised.index = NULL;
 
   g_variant_type_info_query (value->type_info,
                              &alignment, &size);
@@ -635,7 +645,11 @@ g_variant_unref (GVariant *value)
       g_variant_type_info_unref (value->type_info);
 
       if (value->state & STATE_SERIALISED)
-        g_bytes_unref (value->contents.serialised.bytes);
+        {
+          g_bytes_unref (value->contents.serialised.bytes);
+          if (value->contents.serialised.index)
+            g_hash_table_unref (value->contents.serialised.index);
+        }
       else
         g_variant_release_children (value);
 
@@ -1015,11 +1029,192 @@ g_variant_get_child_value (GVariant *value,
     child->contents.serialised.bytes =
       g_bytes_ref (value->contents.serialised.bytes);
     child->contents.serialised.data = s_child.data;
+    child->contents.serialised.index = NULL;
 
     return child;
   }
 }
 
+G_STATIC_ASSERT (sizeof (struct _GVariant) <= sizeof (GVariantView));
+
+/* < internal >
+ * g_variant_view_init:
+ * @view: an uninitialised #GVariantView
+ * @value: a container #GVariant
+ * @index_: the index of the child to fetch
+ *
+ * Sets up @view as the child of @value at @index_, without allocating
+ * a new instance the way g_variant_get_child_value() does.
+ *
+ * The view shares the serialised data of @value without holding a
+ * reference on it, so it is only valid for as long as @value is.  It
+ * must not be given to g_variant_ref(), g_variant_unref() or anything
+ * else that might keep it.  Children fetched from the view are normal
+ * instances.
+ *
+ * This is only possible if @value is in serialised form.  Otherwise,
+ * %NULL is returned and @view is left untouched.
+ *
+ * Free the view with g_variant_view_clear().
+ *
+ * Returns: (transfer none) (nullable): the child, or %NULL
+ */
+GVariant *
+g_variant_view_init (GVariantView *view,
+                     GVariant     *value,
+                     gsize         index_)
+{
+  GVariant *child = (GVariant *) view;
+
+  if (~g_atomic_int_get (&value->state) & STATE_SERIALISED)
+    return NULL;
+
+  {
+    GVariantSerialised serialised = {
+      value->type_info,
+      (gpointer) value->contents.serialised.data,
+      value->size
+    };
+    GVariantSerialised s_child;
+
+    s_child = g_variant_serialised_get_child (serialised, index_);
+
+    child->type_info = s_child.type_info;
+    child->state = (value->state & STATE_TRUSTED) |
+                   STATE_SERIALISED;
+    child->size = s_child.size;
+    child->ref_count = 1;
+    child->contents.serialised.bytes = value->contents.serialised.bytes;
+    child->contents.serialised.data = s_child.data;
+    child->contents.serialised.index = NULL;
+  }
+
+  return child;
+}
+
+/* < internal >
+ * g_variant_view_clear:
+ * @view: a #GVariantView set up by g_variant_view_init()
+ *
+ * Releases the type information held by @view.
+ */
+void
+g_variant_view_clear (GVariantView *view)
+{
+  GVariant *child = (GVariant *) view;
+
+  g_assert (child->ref_count == 1);
+  g_assert (child->contents.serialised.index == NULL);
+
+  g_variant_type_info_unref (child->type_info);
+}
+
+/* Dictionaries with fewer entries are scanned, see g_variant_lookup_value() */
+#define DICT_INDEX_MIN_ENTRIES 32
+
+static GHashTable *
+g_variant_build_dict_index (GVariant *dictionary)
+{
+  GVariantSerialised serialised = {
+    dictionary->type_info,
+    (gpointer) dictionary->contents.serialised.data,
+    dictionary->size
+  };
+  gboolean object_path_keys;
+  GHashTable *index;
+  gsize n, i;
+
+  object_path_keys = g_variant_type_info_get_type_string (dictionary->type_info)[2] == 'o';
+  n = g_variant_serialised_n_children (serialised);
+  index = g_hash_table_new (g_str_hash, g_str_equal);
+
+  for (i = 0; i < n; i++)
+    {
+      GVariantSerialised entry, key;
+      const gchar *string;
+
+      entry = g_variant_serialised_get_child (serialised, i);
+      key = g_variant_serialised_get_child (entry, 0);
+      string = (const gchar *) key.data;
+
+      /* the same substitutes as g_variant_get_string() */
+      if (~dictionary->state & STATE_TRUSTED)
+        {
+          if (object_path_keys && !g_variant_serialiser_is_object_path (key.data, key.size))
+            string = "/";
+          else if (!object_path_keys && !g_variant_serialiser_is_string (key.data, key.size))
+            string = "";
+        }
+
+      /* a linear scan finds the first one */
+      if (!g_hash_table_contains (index, string))
+        g_hash_table_insert (index, (gpointer) string, GSIZE_TO_POINTER (i));
+
+      g_variant_type_info_unref (key.type_info);
+      g_variant_type_info_unref (entry.type_info);
+    }
+
+  return index;
+}
+
+/* < private >
+ * g_variant_lookup_dict_index:
+ * @dictionary: a dictionary with string or object path keys
+ * @key: the key to look up
+ * @position: (out): the position of the entry for @key
+ *
+ * Looks up @key in an index of the keys of @dictionary, which is built
+ * the first time this is called on it.  Only dictionaries in serialised
+ * form, and with enough entries to be worth it, are indexed.
+ *
+ * Returns: %FALSE if @dictionary is not indexed, in which case
+ *     @position is not set.  Otherwise %TRUE, with @position set to the
+ *     position of the first entry for @key, or to %G_MAXSIZE if there is
+ *     none.
+ */
+gboolean
+g_variant_lookup_dict_index (GVariant    *dictionary,
+                             const gchar *key,
+                             gsize       *position)
+{
+  GHashTable *index;
+  gpointer found;
+
+  if (~g_atomic_int_get (&dictionary->state) & STATE_SERIALISED)
+    return FALSE;
+
+  index = g_atomic_pointer_get (&dictionary->contents.serialised.index);
+
+  if (index == NULL)
+    {
+      GVariantSerialised serialised = {
+        dictionary->type_info,
+        (gpointer) dictionary->contents.serialised.data,
+        dictionary->size
+      };
+
+      if (g_variant_serialised_n_children (serialised) < DICT_INDEX_MIN_ENTRIES)
+        return FALSE;
+
+      index = g_variant_build_dict_index (dictionary);
+
+      /* another thread may have beaten us to it */
+      if (!g_atomic_pointer_compare_and_exchange (&dictionary->contents.serialised.index,
+                                                  NULL, index))
+        {
+          g_hash_table_unref (index);
+          index = g_atomic_pointer_get (&dictionary->contents.serialised.index);
+        }
+    }
+
+  if (g_hash_table_lookup_extended (index, key, NULL, &found))
+    *position = GPOINTER_TO_SIZE (found);
+  else
+    *position = G_MAXSIZE;
+
+  return TRUE;
+}
+
 /**
  * g_variant_store:
  * @value: the #GVariant to store
@@ -1113,3 +1308,86 @@ g_variant_is_normal_form (GVariant *value)
 
   return (value->state & STATE_TRUSTED) != 0;
 }
+
+/**
+ * g_variant_validate_children:
+ * @value: a container #GVariant
+ * @index_: the index of the first child to check
+ * @n_children: the number of children to check
+ *
+ * Checks if the children of @value from @index_ up to, but not
+ * including, @index_ + @n_children are in normal form.
+ *
+ * This is a cheaper version of g_variant_is_normal_form() for large
+ * untrusted containers, such as those loaded with
+ * g_variant_new_from_file(): only the serialised data of the given
+ * children (and the framing needed to find them) is read, so the rest
+ * of the container is never touched.  Nothing is checked about the
+ * other children or about the framing of @value itself.
+ *
+ * Unlike g_variant_is_normal_form(), this does not mark @value as
+ * trusted, even if all of its children turn out to be in normal form.
+ *
+ * Returns: %TRUE if all of the given children are in normal form
+ *
+ * Since: 2.54
+ **/
+gboolean
+g_variant_validate_children (GVariant *value,
+                             gsize     index_,
+                             gsize     n_children)
+{
+  gsize i;
+
+  g_return_val_if_fail (g_variant_is_container (value), FALSE);
+  g_return_val_if_fail (index_ <= g_variant_n_children (value) &&
+                        n_children <= g_variant_n_children (value) - index_,
+                        FALSE);
+
+  if (value->state & STATE_TRUSTED)
+    return TRUE;
+
+  if (~g_atomic_int_get (&value->state) & STATE_SERIALISED)
+    {
+      gboolean tree_form = FALSE;
+      gboolean normal = TRUE;
+
+      g_variant_lock (value);
+
+      if (~value->state & STATE_SERIALISED)
+        {
+          tree_form = TRUE;
+
+          for (i = index_; normal && i < index_ + n_children; i++)
+            normal = g_variant_is_normal_form (value->contents.tree.children[i]);
+        }
+
+      g_variant_unlock (value);
+
+      if (tree_form)
+        return normal;
+    }
+
+  {
+    GVariantSerialised serialised = {
+      value->type_info,
+      (gpointer) value->contents.serialised.data,
+      value->size
+    };
+
+    for (i = index_; i < index_ + n_children; i++)
+      {
+        GVariantSerialised child;
+        gboolean normal;
+
+        child = g_variant_serialised_get_child (serialised, i);
+        normal = g_variant_serialised_is_normal (child);
+        g_variant_type_info_unref (child.type_info);
+
+        if (!normal)
+          return FALSE;
+      }
+  }
+
+  return TRUE;
+}
@@ -25,6 +25,12 @@
 
 /* gvariant-core.c */
 
+/* storage for a borrowed child instance, see g_variant_view_init() */
+typedef struct
+{
+  gsize x[8];
+} GVariantView;
+
 GVariant *              g_variant_new_from_children                     (const GVariantType  *type,
                                                                          GVariant           **children,
                                                                          gsize                n_children,
@@ -34,4 +40,14 @@ gboolean                g_variant_is_trusted                            (GVarian
 
 GVariantTypeInfo *      g_variant_get_type_info                         (GVariant            *value);
 
+gboolean                g_variant_lookup_dict_index                     (GVariant            *dictionary,
+                                                                         const gchar         *key,
+                                                                         gsize               *position);
+
+GVariant *              g_variant_view_init                             (GVariantView        *view,
+                                                                         GVariant            *value,
+                                                                         gsize                index_);
+
+void                    g_variant_view_clear                            (GVariantView        *view);
+
 #endif /* __G_VARIANT_CORE_H__ */
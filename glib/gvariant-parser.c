@@ -23,6 +23,7 @@
 #include <string.h>
 #include <errno.h>
 
+#include "garray.h"
 #include "gerror.h"
 #include "gquark.h"
 #include "gstring.h"
@@ -1812,12 +1813,29 @@ number_overflow (AST                 *ast,
   return NULL;
 }
 
-static GVariant *
-number_get_value (AST                 *ast,
-                  const GVariantType  *type,
-                  GError             **error)
+typedef union
+{
+  guint8  y;
+  gint16  n;
+  guint16 q;
+  gint32  i;
+  guint32 u;
+  gint64  x;
+  guint64 t;
+  gdouble d;
+} NumberValue;
+
+/* Converts @text, the token of @ast, to a number of type @type and
+ * stores it in the member of @value named after the type character.
+ * Handles are stored in @value->i.
+ */
+static gboolean
+number_convert (AST                 *ast,
+                const gchar         *text,
+                const GVariantType  *type,
+                NumberValue         *value,
+                GError             **error)
 {
-  Number *number = (Number *) ast;
   const gchar *token;
   gboolean negative;
   gboolean floating;
@@ -1825,7 +1843,7 @@ number_get_value (AST                 *ast,
   gdouble dbl_val;
   gchar *end;
 
-  token = number->token;
+  token = text;
 
   if (g_variant_type_equal (type, G_VARIANT_TYPE_DOUBLE))
     {
@@ -1838,7 +1856,7 @@ number_get_value (AST                 *ast,
           ast_set_error (ast, error, NULL,
                          G_VARIANT_PARSE_ERROR_NUMBER_TOO_BIG,
                          "number too big for any type");
-          return NULL;
+          return FALSE;
         }
 
       /* silence uninitialised warnings... */
@@ -1859,7 +1877,7 @@ number_get_value (AST                 *ast,
           ast_set_error (ast, error, NULL,
                          G_VARIANT_PARSE_ERROR_NUMBER_TOO_BIG,
                          "integer too big for any type");
-          return NULL;
+          return FALSE;
         }
 
       if (abs_val == 0)
@@ -1874,65 +1892,125 @@ number_get_value (AST                 *ast,
       SourceRef ref;
 
       ref = ast->source_ref;
-      ref.start += end - number->token;
+      ref.start += end - text;
       ref.end = ref.start + 1;
 
       parser_set_error (error, &ref, NULL,
                         G_VARIANT_PARSE_ERROR_INVALID_CHARACTER,
                         "invalid character in number");
-      return NULL;
+      return FALSE;
      }
 
   if (floating)
-    return g_variant_new_double (dbl_val);
+    {
+      value->d = dbl_val;
+      return TRUE;
+    }
 
   switch (*g_variant_type_peek_string (type))
     {
     case 'y':
       if (negative || abs_val > G_MAXUINT8)
-        return number_overflow (ast, type, error);
-      return g_variant_new_byte (abs_val);
+        break;
+      value->y = abs_val;
+      return TRUE;
 
     case 'n':
       if (abs_val - negative > G_MAXINT16)
-        return number_overflow (ast, type, error);
-      return g_variant_new_int16 (negative ? -abs_val : abs_val);
+        break;
+      value->n = negative ? -abs_val : abs_val;
+      return TRUE;
 
     case 'q':
       if (negative || abs_val > G_MAXUINT16)
-        return number_overflow (ast, type, error);
-      return g_variant_new_uint16 (abs_val);
+        break;
+      value->q = abs_val;
+      return TRUE;
 
     case 'i':
+    case 'h':
       if (abs_val - negative > G_MAXINT32)
-        return number_overflow (ast, type, error);
-      return g_variant_new_int32 (negative ? -abs_val : abs_val);
+        break;
+      value->i = negative ? -abs_val : abs_val;
+      return TRUE;
 
     case 'u':
       if (negative || abs_val > G_MAXUINT32)
-        return number_overflow (ast, type, error);
-      return g_variant_new_uint32 (abs_val);
+        break;
+      value->u = abs_val;
+      return TRUE;
 
     case 'x':
       if (abs_val - negative > G_MAXINT64)
-        return number_overflow (ast, type, error);
-      return g_variant_new_int64 (negative ? -abs_val : abs_val);
+        break;
+      value->x = negative ? -abs_val : abs_val;
+      return TRUE;
 
     case 't':
       if (negative)
-        return number_overflow (ast, type, error);
-      return g_variant_new_uint64 (abs_val);
+        break;
+      value->t = abs_val;
+      return TRUE;
+
+    default:
+      ast_type_error (ast, type, error);
+      return FALSE;
+    }
+
+  number_overflow (ast, type, error);
+  return FALSE;
+}
+
+static GVariant *
+number_value_new (const GVariantType *type,
+                  const NumberValue  *value)
+{
+  switch (*g_variant_type_peek_string (type))
+    {
+    case 'y':
+      return g_variant_new_byte (value->y);
+
+    case 'n':
+      return g_variant_new_int16 (value->n);
+
+    case 'q':
+      return g_variant_new_uint16 (value->q);
+
+    case 'i':
+      return g_variant_new_int32 (value->i);
+
+    case 'u':
+      return g_variant_new_uint32 (value->u);
+
+    case 'x':
+      return g_variant_new_int64 (value->x);
+
+    case 't':
+      return g_variant_new_uint64 (value->t);
 
     case 'h':
-      if (abs_val - negative > G_MAXINT32)
-        return number_overflow (ast, type, error);
-      return g_variant_new_handle (negative ? -abs_val : abs_val);
+      return g_variant_new_handle (value->i);
 
     default:
-      return ast_type_error (ast, type, error);
+      g_assert (g_variant_type_equal (type, G_VARIANT_TYPE_DOUBLE));
+      return g_variant_new_double (value->d);
     }
 }
 
+static GVariant *
+number_get_value (AST                 *ast,
+                  const GVariantType  *type,
+                  GError             **error)
+{
+  Number *number = (Number *) ast;
+  NumberValue value;
+
+  if (!number_convert (ast, number->token, type, &value, error))
+    return NULL;
+
+  return number_value_new (type, &value);
+}
+
 static void
 number_free (AST *ast)
 {
@@ -2318,6 +2396,360 @@ parse (TokenStream  *stream,
   return result;
 }
 
+/* Single-pass parsing for the case that the type is known up front.
+ *
+ * When the caller gives a definite type, there is nothing to infer, so
+ * the common containers (arrays, tuples, dictionaries and dictionary
+ * entries) can be built directly while reading the text, without first
+ * building an AST for the whole input.  Arrays of numbers or booleans
+ * are collected straight into their serialised form.
+ *
+ * Anything else (keywords, type annotations, maybes, variants, strings,
+ * ...) is handed to the usual two-pass parser one subtree at a time.
+ *
+ * No errors are reported from here: a NULL return just means that the
+ * text could not be parsed this way, and the caller starts again with
+ * the general parser so that the error is reported exactly as before.
+ */
+static GVariant *typed_parse (TokenStream        *stream,
+                              const GVariantType *type);
+
+static GVariant *
+typed_parse_subtree (TokenStream        *stream,
+                     const GVariantType *type)
+{
+  GVariant *value = NULL;
+  AST *ast;
+
+  if ((ast = parse (stream, NULL, NULL)))
+    {
+      value = ast_get_value (ast, type, NULL);
+      ast_free (ast);
+    }
+
+  return value;
+}
+
+static gboolean
+typed_parse_number (TokenStream        *stream,
+                    const GVariantType *type,
+                    NumberValue        *value)
+{
+  AST ast = { NULL, { 0, 0 } };
+  gchar token[64];
+  gsize length;
+
+  if (!token_stream_is_numeric (stream) &&
+      !token_stream_peek_string (stream, "inf") &&
+      !token_stream_peek_string (stream, "nan"))
+    return FALSE;
+
+  length = stream->stream - stream->this;
+  if (length >= sizeof token)
+    return FALSE;
+
+  memcpy (token, stream->this, length);
+  token[length] = '\0';
+  token_stream_next (stream);
+
+  return number_convert (&ast, token, type, value, NULL);
+}
+
+static gboolean
+typed_parse_boolean (TokenStream *stream,
+                     guint8      *value)
+{
+  if (token_stream_consume (stream, "true"))
+    *value = TRUE;
+  else if (token_stream_consume (stream, "false"))
+    *value = FALSE;
+  else
+    return FALSE;
+
+  return TRUE;
+}
+
+static GVariant *
+typed_parse_fixed_array (TokenStream        *stream,
+                         const GVariantType *type)
+{
+  const GVariantType *element;
+  gboolean need_comma = FALSE;
+  GByteArray *array;
+  GVariant *value;
+  gsize size;
+
+  element = g_variant_type_element (type);
+
+  switch (*g_variant_type_peek_string (element))
+    {
+    case 'b': case 'y':
+      size = 1;
+      break;
+
+    case 'n': case 'q':
+      size = 2;
+      break;
+
+    case 'i': case 'u': case 'h':
+      size = 4;
+      break;
+
+    default:
+      size = 8;
+      break;
+    }
+
+  array = g_byte_array_new ();
+
+  token_stream_assert (stream, "[");
+  while (!token_stream_consume (stream, "]"))
+    {
+      NumberValue number;
+
+      if (need_comma && !token_stream_consume (stream, ","))
+        goto error;
+
+      if (g_variant_type_equal (element, G_VARIANT_TYPE_BOOLEAN))
+        {
+          if (!typed_parse_boolean (stream, &number.y))
+            goto error;
+        }
+      else if (!typed_parse_number (stream, element, &number))
+        goto error;
+
+      g_byte_array_append (array, (guint8 *) &number, size);
+      need_comma = TRUE;
+    }
+
+  value = g_variant_new_fixed_array (element, array->data,
+                                     array->len / size, size);
+  g_byte_array_unref (array);
+
+  return value;
+
+ error:
+  g_byte_array_unref (array);
+
+  return NULL;
+}
+
+static GVariant *
+typed_parse_array (TokenStream        *stream,
+                   const GVariantType *type)
+{
+  const GVariantType *element;
+  gboolean need_comma = FALSE;
+  GVariantBuilder builder;
+
+  element = g_variant_type_element (type);
+
+  if (strchr ("bynqiuxthd", *g_variant_type_peek_string (element)))
+    return typed_parse_fixed_array (stream, type);
+
+  g_variant_builder_init (&builder, type);
+
+  token_stream_assert (stream, "[");
+  while (!token_stream_consume (stream, "]"))
+    {
+      GVariant *child;
+
+      if (need_comma && !token_stream_consume (stream, ","))
+        goto error;
+
+      if (!(child = typed_parse (stream, element)))
+        goto error;
+
+      g_variant_builder_add_value (&builder, child);
+      need_comma = TRUE;
+    }
+
+  return g_variant_builder_end (&builder);
+
+ error:
+  g_variant_builder_clear (&builder);
+
+  return NULL;
+}
+
+static GVariant *
+typed_parse_tuple (TokenStream        *stream,
+                   const GVariantType *type)
+{
+  const GVariantType *childtype;
+  gboolean need_comma = FALSE;
+  gboolean first = TRUE;
+  GVariantBuilder builder;
+
+  g_variant_builder_init (&builder, type);
+  childtype = g_variant_type_first (type);
+
+  token_stream_assert (stream, "(");
+  while (!token_stream_consume (stream, ")"))
+    {
+      GVariant *child;
+
+      if (childtype == NULL)
+        goto error;
+
+      if (need_comma && !token_stream_consume (stream, ","))
+        goto error;
+
+      if (!(child = typed_parse (stream, childtype)))
+        goto error;
+
+      g_variant_builder_add_value (&builder, child);
+      childtype = g_variant_type_next (childtype);
+
+      /* as in tuple_parse(), the first element must have a comma */
+      if (first)
+        {
+          if (!token_stream_consume (stream, ","))
+            goto error;
+
+          first = FALSE;
+        }
+      else
+        need_comma = TRUE;
+    }
+
+  if (childtype != NULL)
+    goto error;
+
+  return g_variant_builder_end (&builder);
+
+ error:
+  g_variant_builder_clear (&builder);
+
+  return NULL;
+}
+
+static GVariant *
+typed_parse_dictionary (TokenStream        *stream,
+                        const GVariantType *type)
+{
+  const GVariantType *entry, *key, *val;
+  GVariantBuilder builder;
+  gboolean first = TRUE;
+
+  entry = g_variant_type_element (type);
+  key = g_variant_type_key (entry);
+  val = g_variant_type_value (entry);
+
+  g_variant_builder_init (&builder, type);
+
+  token_stream_assert (stream, "{");
+  while (!token_stream_consume (stream, "}"))
+    {
+      GVariant *child;
+
+      if (!first && !token_stream_consume (stream, ","))
+        goto error;
+
+      g_variant_builder_open (&builder, entry);
+
+      if (!(child = typed_parse (stream, key)))
+        goto error;
+      g_variant_builder_add_value (&builder, child);
+
+      /* '{key, value}' would be a single dictionary entry */
+      if (!token_stream_consume (stream, ":"))
+        goto error;
+
+      if (!(child = typed_parse (stream, val)))
+        goto error;
+      g_variant_builder_add_value (&builder, child);
+
+      g_variant_builder_close (&builder);
+      first = FALSE;
+    }
+
+  return g_variant_builder_end (&builder);
+
+ error:
+  g_variant_builder_clear (&builder);
+
+  return NULL;
+}
+
+static GVariant *
+typed_parse_dict_entry (TokenStream        *stream,
+                        const GVariantType *type)
+{
+  GVariantBuilder builder;
+  GVariant *child;
+
+  g_variant_builder_init (&builder, type);
+
+  token_stream_assert (stream, "{");
+
+  if (!(child = typed_parse (stream, g_variant_type_key (type))))
+    goto error;
+  g_variant_builder_add_value (&builder, child);
+
+  if (!token_stream_consume (stream, ","))
+    goto error;
+
+  if (!(child = typed_parse (stream, g_variant_type_value (type))))
+    goto error;
+  g_variant_builder_add_value (&builder, child);
+
+  if (!token_stream_consume (stream, "}"))
+    goto error;
+
+  return g_variant_builder_end (&builder);
+
+ error:
+  g_variant_builder_clear (&builder);
+
+  return NULL;
+}
+
+static GVariant *
+typed_parse (TokenStream        *stream,
+             const GVariantType *type)
+{
+  if (!token_stream_prepare (stream))
+    return NULL;
+
+  switch (*g_variant_type_peek_string (type))
+    {
+    case 'y': case 'n': case 'q': case 'i': case 'u':
+    case 'x': case 't': case 'h': case 'd':
+      if (token_stream_is_numeric (stream))
+        {
+          NumberValue value;
+
+          if (!typed_parse_number (stream, type, &value))
+            return NULL;
+
+          return number_value_new (type, &value);
+        }
+      break;
+
+    case 'a':
+      if (token_stream_peek (stream, '['))
+        return typed_parse_array (stream, type);
+
+      if (token_stream_peek (stream, '{') &&
+          g_variant_type_is_dict_entry (g_variant_type_element (type)))
+        return typed_parse_dictionary (stream, type);
+      break;
+
+    case '(':
+      if (token_stream_peek (stream, '('))
+        return typed_parse_tuple (stream, type);
+      break;
+
+    case '{':
+      if (token_stream_peek (stream, '{'))
+        return typed_parse_dict_entry (stream, type);
+      break;
+    }
+
+  return typed_parse_subtree (stream, type);
+}
+
 /**
  * g_variant_parse:
  * @type: (nullable): a #GVariantType, or %NULL
@@ -2378,41 +2810,51 @@ g_variant_parse (const GVariantType  *type,
   stream.stream = text;
   stream.end = limit;
 
-  if ((ast = parse (&stream, NULL, error)))
+  if (type != NULL && g_variant_type_is_definite (type))
+    result = typed_parse (&stream, type);
+
+  if (result == NULL)
     {
-      if (type == NULL)
-        result = ast_resolve (ast, error);
-      else
-        result = ast_get_value (ast, type, error);
+      /* start from scratch, so that any errors get reported */
+      stream.stream = text;
+      stream.this = NULL;
 
-      if (result != NULL)
+      if ((ast = parse (&stream, NULL, error)))
         {
-          g_variant_ref_sink (result);
+          if (type == NULL)
+            result = ast_resolve (ast, error);
+          else
+            result = ast_get_value (ast, type, error);
 
-          if (endptr == NULL)
-            {
-              while (stream.stream != limit &&
-                     g_ascii_isspace (*stream.stream))
-                stream.stream++;
+          ast_free (ast);
+        }
+    }
 
-              if (stream.stream != limit && *stream.stream != '\0')
-                {
-                  SourceRef ref = { stream.stream - text,
-                                    stream.stream - text };
+  if (result != NULL)
+    {
+      g_variant_ref_sink (result);
 
-                  parser_set_error (error, &ref, NULL,
-                                    G_VARIANT_PARSE_ERROR_INPUT_NOT_AT_END,
-                                    "expected end of input");
-                  g_variant_unref (result);
+      if (endptr == NULL)
+        {
+          while (stream.stream != limit &&
+                 g_ascii_isspace (*stream.stream))
+            stream.stream++;
 
-                  result = NULL;
-                }
+          if (stream.stream != limit && *stream.stream != '\0')
+            {
+              SourceRef ref = { stream.stream - text,
+                                stream.stream - text };
+
+              parser_set_error (error, &ref, NULL,
+                                G_VARIANT_PARSE_ERROR_INPUT_NOT_AT_END,
+                                "expected end of input");
+              g_variant_unref (result);
+
+              result = NULL;
             }
-          else
-            *endptr = stream.stream;
         }
-
-      ast_free (ast);
+      else
+        *endptr = stream.stream;
     }
 
   return result;
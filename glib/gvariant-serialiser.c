@@ -29,6 +29,12 @@
 
 #include <string.h>
 
+#if defined (__SSE2__) || defined (_M_X64) || defined (_M_AMD64) || \
+    (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define USE_SSE2 1
+#endif
+
 
 /* GVariantSerialiser
  *
@@ -1412,6 +1418,39 @@ g_variant_serialiser_serialise (GVariantSerialised        serialised,
   g_assert_not_reached ();
 }
 
+/* < private >
+ * g_variant_serialiser_write_offsets:
+ * @data: where to write the framing offsets
+ * @body_size: the size of the children of the container, including
+ *     padding
+ * @offsets: the framing offsets, in the order they are to be written
+ * @n_offsets: the size of @offsets
+ *
+ * Writes the framing offsets of a container whose children have
+ * already been serialised, for writing a container out incrementally.
+ *
+ * If @data is %NULL, nothing is written.  Either way, the space that the
+ * offsets take is returned, so @body_size plus that is the size of the
+ * container.
+ */
+gsize
+g_variant_serialiser_write_offsets (guchar      *data,
+                                    gsize        body_size,
+                                    const gsize *offsets,
+                                    gsize        n_offsets)
+{
+  gsize offset_size;
+  gsize i;
+
+  offset_size = gvs_get_offset_size (gvs_calculate_total_size (body_size, n_offsets));
+
+  if (data != NULL)
+    for (i = 0; i < n_offsets; i++)
+      gvs_write_unaligned_le (data + i * offset_size, offsets[i], offset_size);
+
+  return offset_size * n_offsets;
+}
+
 /* < private >
  * g_variant_serialiser_needed_size:
  * @type_info: the type to serialise for
@@ -1442,6 +1481,117 @@ g_variant_serialiser_needed_size (GVariantTypeInfo         *type_info,
 
 /* Byteswapping {{{2 */
 
+/* If every byte of the fixed-sized type @type_string belongs to a
+ * numeric member of the same width, its serialised form is just a
+ * sequence of words of that width and can be swapped without looking
+ * at its structure.  Returns that width, or 0 if the members differ
+ * (which implies padding or single bytes that must stay put).
+ */
+static gsize
+gvs_uniform_word_size (const gchar *type_string)
+{
+  gsize word_size = 0;
+  const gchar *c;
+
+  for (c = type_string; *c; c++)
+    {
+      gsize size;
+
+      switch (*c)
+        {
+        case '(': case ')': case '{': case '}':
+          continue;
+
+        case 'n': case 'q':
+          size = 2;
+          break;
+
+        case 'i': case 'u': case 'h':
+          size = 4;
+          break;
+
+        case 'x': case 't': case 'd':
+          size = 8;
+          break;
+
+        default:
+          return 0;
+        }
+
+      if (word_size != 0 && word_size != size)
+        return 0;
+
+      word_size = size;
+    }
+
+  return word_size;
+}
+
+/* Swaps @n_words words of @word_size bytes each, in place */
+static void
+gvs_byteswap_words (guchar *data,
+                    gsize   word_size,
+                    gsize   n_words)
+{
+  gsize i = 0;
+
+#ifdef USE_SSE2
+  /* SSE2 has no byte shuffle, so build each swap out of shuffles of
+   * 32-bit and 16-bit lanes plus a final byte swap within 16 bits
+   */
+  gsize n_vectors = (n_words * word_size) / 16;
+  gsize v;
+
+  for (v = 0; v < n_vectors; v++)
+    {
+      __m128i x = _mm_loadu_si128 ((const __m128i *) (data + v * 16));
+
+      if (word_size == 8)
+        x = _mm_shuffle_epi32 (x, _MM_SHUFFLE (2, 3, 0, 1));
+      if (word_size >= 4)
+        {
+          x = _mm_shufflelo_epi16 (x, _MM_SHUFFLE (2, 3, 0, 1));
+          x = _mm_shufflehi_epi16 (x, _MM_SHUFFLE (2, 3, 0, 1));
+        }
+      x = _mm_or_si128 (_mm_slli_epi16 (x, 8), _mm_srli_epi16 (x, 8));
+
+      _mm_storeu_si128 ((__m128i *) (data + v * 16), x);
+    }
+
+  i = n_vectors * 16 / word_size;
+#endif
+
+  switch (word_size)
+    {
+    case 2:
+      for (; i < n_words; i++)
+        {
+          guint16 *ptr = (guint16 *) (data + i * 2);
+          *ptr = GUINT16_SWAP_LE_BE (*ptr);
+        }
+      break;
+
+    case 4:
+      for (; i < n_words; i++)
+        {
+          guint32 *ptr = (guint32 *) (data + i * 4);
+          *ptr = GUINT32_SWAP_LE_BE (*ptr);
+        }
+      break;
+
+    case 8:
+      for (; i < n_words; i++)
+        {
+          guint64 *ptr = (guint64 *) (data + i * 8);
+          *ptr = GUINT64_SWAP_LE_BE (*ptr);
+        }
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
 /* < private >
  * g_variant_serialised_byteswap:
  * @value: a #GVariantSerialised
@@ -1513,8 +1663,33 @@ g_variant_serialised_byteswap (GVariantSerialised serialised)
    */
   else
     {
+      const gchar *type_string;
+      gsize word_size = 0;
       gsize children, i;
 
+      /* fixed-sized containers of same-width numbers, and arrays of
+       * them, are swapped as one flat run of words: this covers things
+       * like 'au', 'at', 'ad' and 'a(ii)' without visiting each child.
+       */
+      type_string = g_variant_type_info_get_type_string (serialised.type_info);
+
+      if (fixed_size)
+        word_size = gvs_uniform_word_size (type_string);
+      else if (type_string[0] == 'a')
+        {
+          gsize element_size;
+
+          g_variant_type_info_query_element (serialised.type_info, NULL, &element_size);
+          if (element_size)
+            word_size = gvs_uniform_word_size (type_string + 1);
+        }
+
+      if (word_size)
+        {
+          gvs_byteswap_words (serialised.data, word_size, serialised.size / word_size);
+          return;
+        }
+
       children = g_variant_serialised_n_children (serialised);
       for (i = 0; i < children; i++)
         {
@@ -1585,6 +1760,36 @@ g_variant_serialised_is_normal (GVariantSerialised serialised)
  * Checks if strings, object paths and signature strings are valid.
  */
 
+/* Returns the length of the longest prefix of @data, no longer than
+ * @size, made up of non-nul ASCII characters.
+ */
+static gsize
+gvs_ascii_prefix (const gchar *data,
+                  gsize        size)
+{
+  gsize i = 0;
+
+#ifdef USE_SSE2
+  const __m128i zero = _mm_setzero_si128 ();
+
+  for (; i + 16 <= size; i += 16)
+    {
+      __m128i x = _mm_loadu_si128 ((const __m128i *) (data + i));
+      guint stop;
+
+      /* the high bit marks non-ASCII bytes */
+      stop = _mm_movemask_epi8 (_mm_or_si128 (x, _mm_cmpeq_epi8 (x, zero)));
+      if (stop)
+        return i + g_bit_nth_lsf (stop, -1);
+    }
+#endif
+
+  while (i < size && data[i] != '\0' && (guchar) data[i] < 0x80)
+    i++;
+
+  return i;
+}
+
 /* < private >
  * g_variant_serialiser_is_string:
  * @data: a possible string
@@ -1597,20 +1802,22 @@ gboolean
 g_variant_serialiser_is_string (gconstpointer data,
                                 gsize         size)
 {
-  const gchar *expected_end;
-  const gchar *end;
+  const gchar *string = data;
+  gsize ascii;
 
   if (size == 0)
     return FALSE;
 
-  expected_end = ((gchar *) data) + size - 1;
-
-  if (*expected_end != '\0')
+  if (string[size - 1] != '\0')
     return FALSE;
 
-  g_utf8_validate (data, size, &end);
+  /* most strings are plain ASCII; only validate the rest as UTF-8,
+   * which also catches embedded nuls
+   */
+  ascii = gvs_ascii_prefix (string, size - 1);
 
-  return end == expected_end;
+  return ascii == size - 1 ||
+         g_utf8_validate (string + ascii, size - 1 - ascii, NULL);
 }
 
 /* < private >
@@ -1628,16 +1835,56 @@ g_variant_serialiser_is_object_path (gconstpointer data,
                                      gsize         size)
 {
   const gchar *string = data;
-  gsize i;
+  gsize i = 1;
 
-  if (!g_variant_serialiser_is_string (data, size))
+  /* All of the characters allowed below are non-nul ASCII, so checking
+   * them also does the checks for being a valid string.
+   */
+  if (size < 2 || string[size - 1] != '\0')
     return FALSE;
 
   /* The path must begin with an ASCII '/' (integer 47) character */
   if (string[0] != '/')
     return FALSE;
 
-  for (i = 1; string[i]; i++)
+#ifdef USE_SSE2
+  {
+    const __m128i slash = _mm_set1_epi8 ('/');
+    guint previous_slash = 1;
+
+    for (; i + 16 <= size - 1; i += 16)
+      {
+        __m128i x = _mm_loadu_si128 ((const __m128i *) (string + i));
+        __m128i lower, valid;
+        guint slashes;
+
+        /* Each element must only contain the ASCII characters
+         * "[A-Z][a-z][0-9]_".  Bytes >= 0x80 compare as negative, so
+         * they fail every range.
+         */
+        lower = _mm_or_si128 (x, _mm_set1_epi8 (0x20));
+        valid = _mm_and_si128 (_mm_cmpgt_epi8 (lower, _mm_set1_epi8 ('a' - 1)),
+                               _mm_cmplt_epi8 (lower, _mm_set1_epi8 ('z' + 1)));
+        valid = _mm_or_si128 (valid,
+                              _mm_and_si128 (_mm_cmpgt_epi8 (x, _mm_set1_epi8 ('0' - 1)),
+                                             _mm_cmplt_epi8 (x, _mm_set1_epi8 ('9' + 1))));
+        valid = _mm_or_si128 (valid, _mm_cmpeq_epi8 (x, _mm_set1_epi8 ('_')));
+        valid = _mm_or_si128 (valid, _mm_cmpeq_epi8 (x, slash));
+
+        if (_mm_movemask_epi8 (valid) != 0xffff)
+          return FALSE;
+
+        /* Multiple '/' characters cannot occur in sequence. */
+        slashes = _mm_movemask_epi8 (_mm_cmpeq_epi8 (x, slash));
+        if (slashes & ((slashes << 1) | previous_slash))
+          return FALSE;
+
+        previous_slash = slashes >> 15;
+      }
+  }
+#endif
+
+  for (; i < size - 1; i++)
     /* Each element must only contain the ASCII characters
      * "[A-Z][a-z][0-9]_"
      */
@@ -53,6 +53,12 @@ void                            g_variant_serialiser_serialise          (GVarian
                                                                          const gpointer           *children,
                                                                          gsize                     n_children);
 
+GLIB_AVAILABLE_IN_ALL
+gsize                           g_variant_serialiser_write_offsets      (guchar                   *data,
+                                                                         gsize                     body_size,
+                                                                         const gsize              *offsets,
+                                                                         gsize                     n_offsets);
+
 /* misc */
 GLIB_AVAILABLE_IN_ALL
 gboolean                        g_variant_serialised_is_normal          (GVariantSerialised        value);
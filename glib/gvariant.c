@@ -29,7 +29,10 @@
 #include <glib/gstrfuncs.h>
 #include <glib/gslice.h>
 #include <glib/ghash.h>
+#include <glib/garray.h>
 #include <glib/gmem.h>
+#include <glib/gatomic.h>
+#include <glib/gmappedfile.h>
 
 #include <string.h>
 
@@ -953,8 +956,8 @@ g_variant_new_dict_entry (GVariant *key,
  * see the section on
  * [GVariant format strings][gvariant-format-strings-pointers].
  *
- * This function is currently implemented with a linear scan.  If you
- * plan to do many lookups then #GVariantDict may be more efficient.
+ * This function is implemented with g_variant_lookup_value(), see
+ * there for how fast it is.
  *
  * Returns: %TRUE if a value was unpacked
  *
@@ -1017,8 +1020,13 @@ g_variant_lookup (GVariant    *dictionary,
  * returned.  If @expected_type was specified then any non-%NULL return
  * value will have this type.
  *
- * This function is currently implemented with a linear scan.  If you
- * plan to do many lookups then #GVariantDict may be more efficient.
+ * The first lookup in a big dictionary in serialised form (for example
+ * one loaded from a file or received over D-Bus) builds an index of its
+ * keys, which is kept with @dictionary, so that later lookups take
+ * constant time. Smaller dictionaries, and those built from child
+ * values that have not been serialised yet, are scanned linearly. If
+ * you plan to do many lookups in those then #GVariantDict may be more
+ * efficient.
  *
  * Returns: (transfer full): the value of the dictionary key, or %NULL
  *
@@ -1032,6 +1040,7 @@ g_variant_lookup_value (GVariant           *dictionary,
   GVariantIter iter;
   GVariant *entry;
   GVariant *value;
+  gsize position;
 
   g_return_val_if_fail (g_variant_is_of_type (dictionary,
                                               G_VARIANT_TYPE ("a{s*}")) ||
@@ -1039,25 +1048,35 @@ g_variant_lookup_value (GVariant           *dictionary,
                                               G_VARIANT_TYPE ("a{o*}")),
                         NULL);
 
-  g_variant_iter_init (&iter, dictionary);
+  if (g_variant_lookup_dict_index (dictionary, key, &position))
+    {
+      if (position == G_MAXSIZE)
+        return NULL;
 
-  while ((entry = g_variant_iter_next_value (&iter)))
+      entry = g_variant_get_child_value (dictionary, position);
+    }
+  else
     {
-      GVariant *entry_key;
-      gboolean matches;
+      g_variant_iter_init (&iter, dictionary);
 
-      entry_key = g_variant_get_child_value (entry, 0);
-      matches = strcmp (g_variant_get_string (entry_key, NULL), key) == 0;
-      g_variant_unref (entry_key);
+      while ((entry = g_variant_iter_next_value (&iter)))
+        {
+          GVariant *entry_key;
+          gboolean matches;
 
-      if (matches)
-        break;
+          entry_key = g_variant_get_child_value (entry, 0);
+          matches = strcmp (g_variant_get_string (entry_key, NULL), key) == 0;
+          g_variant_unref (entry_key);
 
-      g_variant_unref (entry);
-    }
+          if (matches)
+            break;
 
-  if (entry == NULL)
-    return NULL;
+          g_variant_unref (entry);
+        }
+
+      if (entry == NULL)
+        return NULL;
+    }
 
   value = g_variant_get_child_value (entry, 1);
   g_variant_unref (entry);
@@ -3159,6 +3178,11 @@ struct stack_builder
   guint trusted : 1;
 
   gsize magic;
+
+  /* non-%NULL for g_variant_builder_init_streaming(), in which case
+   * all of the above except for 'type', 'trusted' and 'magic' is unused
+   */
+  struct stream_builder *stream;
 };
 
 G_STATIC_ASSERT (sizeof (struct stack_builder) <= sizeof (GVariantBuilder));
@@ -3184,6 +3208,302 @@ struct heap_builder
  * didn't accidentally change ABI. */
 G_STATIC_ASSERT (sizeof (GVariantBuilder) == sizeof (gsize[16]));
 
+/* A streaming builder writes every value out as soon as it is added,
+ * in the serialised form of the final value.  That works because the
+ * framing offsets of a container come after its children: they are
+ * collected while the container is open, and appended when it is
+ * closed.  Every container is aligned within the buffer as it would be
+ * within the final value, since the buffer starts at offset 0.
+ */
+struct stream_frame
+{
+  GVariantTypeInfo *type_info;
+
+  /* where the container starts in the buffer */
+  gsize start;
+  gsize n_items;
+
+  /* index of the first framing offset of this container in 'offsets' */
+  gsize first_offset;
+
+  /* for variants: the type of the child, once added */
+  GVariantTypeInfo *child_info;
+};
+
+struct stream_builder
+{
+  GByteArray *buffer;
+  GArray *frames;
+  GArray *offsets;
+};
+
+static struct stream_frame *
+stream_builder_top (struct stream_builder *stream)
+{
+  return &g_array_index (stream->frames, struct stream_frame,
+                         stream->frames->len - 1);
+}
+
+static void
+stream_builder_push (struct stream_builder *stream,
+                     GVariantTypeInfo      *type_info)
+{
+  struct stream_frame frame = { 0, };
+
+  frame.type_info = g_variant_type_info_ref (type_info);
+  frame.start = stream->buffer->len;
+  frame.first_offset = stream->offsets->len;
+
+  g_array_append_val (stream->frames, frame);
+}
+
+static struct stream_builder *
+stream_builder_new (const GVariantType *type)
+{
+  struct stream_builder *stream;
+  GVariantTypeInfo *type_info;
+
+  stream = g_slice_new (struct stream_builder);
+  stream->buffer = g_byte_array_new ();
+  stream->frames = g_array_new (FALSE, FALSE, sizeof (struct stream_frame));
+  stream->offsets = g_array_new (FALSE, FALSE, sizeof (gsize));
+
+  type_info = g_variant_type_info_get (type);
+  stream_builder_push (stream, type_info);
+  g_variant_type_info_unref (type_info);
+
+  return stream;
+}
+
+static void
+stream_builder_free (struct stream_builder *stream)
+{
+  guint i;
+
+  for (i = 0; i < stream->frames->len; i++)
+    {
+      struct stream_frame *frame;
+
+      frame = &g_array_index (stream->frames, struct stream_frame, i);
+      g_variant_type_info_unref (frame->type_info);
+      if (frame->child_info)
+        g_variant_type_info_unref (frame->child_info);
+    }
+
+  if (stream->buffer)
+    g_byte_array_unref (stream->buffer);
+  g_array_unref (stream->frames);
+  g_array_unref (stream->offsets);
+  g_slice_free (struct stream_builder, stream);
+}
+
+/* Whether the innermost open container has room for another item.
+ * If so, @expected is set to the type the item must have, or to %NULL
+ * if that is a variant, which takes any type.
+ */
+static gboolean
+stream_builder_expected (struct stream_builder  *stream,
+                         GVariantTypeInfo      **expected)
+{
+  struct stream_frame *frame = stream_builder_top (stream);
+
+  switch (g_variant_type_info_get_type_char (frame->type_info))
+    {
+    case G_VARIANT_TYPE_INFO_CHAR_VARIANT:
+      *expected = NULL;
+      return frame->n_items == 0;
+
+    case G_VARIANT_TYPE_INFO_CHAR_MAYBE:
+      *expected = g_variant_type_info_element (frame->type_info);
+      return frame->n_items == 0;
+
+    case G_VARIANT_TYPE_INFO_CHAR_ARRAY:
+      *expected = g_variant_type_info_element (frame->type_info);
+      return TRUE;
+
+    default: /* tuples and dict entries */
+      if (frame->n_items >= g_variant_type_info_n_members (frame->type_info))
+        return FALSE;
+      *expected = g_variant_type_info_member_info (frame->type_info,
+                                                   frame->n_items)->type_info;
+      return TRUE;
+    }
+}
+
+/* Whether the innermost open container can take an item of type
+ * @item_info next.
+ */
+static gboolean
+stream_builder_accepts (struct stream_builder *stream,
+                        GVariantTypeInfo      *item_info)
+{
+  GVariantTypeInfo *expected;
+
+  if (!stream_builder_expected (stream, &expected))
+    return FALSE;
+
+  return expected == NULL || expected == item_info ||
+         strcmp (g_variant_type_info_get_type_string (expected),
+                 g_variant_type_info_get_type_string (item_info)) == 0;
+}
+
+/* Pads the buffer for an item of type @item_info, and returns where it
+ * starts.
+ */
+static gsize
+stream_builder_align (struct stream_builder *stream,
+                      GVariantTypeInfo      *item_info)
+{
+  gsize start = stream->buffer->len;
+  guint alignment;
+
+  g_variant_type_info_query (item_info, &alignment, NULL);
+
+  if (start & alignment)
+    {
+      gsize padding = (-start) & alignment;
+
+      g_byte_array_set_size (stream->buffer, start + padding);
+      memset (stream->buffer->data + start, 0, padding);
+      start += padding;
+    }
+
+  return start;
+}
+
+/* Called once an item has been written out to the innermost container */
+static void
+stream_builder_item_done (struct stream_builder *stream,
+                          GVariantTypeInfo      *item_info)
+{
+  struct stream_frame *frame = stream_builder_top (stream);
+  gboolean needs_offset = FALSE;
+  gsize fixed_size;
+
+  switch (g_variant_type_info_get_type_char (frame->type_info))
+    {
+    case G_VARIANT_TYPE_INFO_CHAR_VARIANT:
+      frame->child_info = g_variant_type_info_ref (item_info);
+      break;
+
+    case G_VARIANT_TYPE_INFO_CHAR_ARRAY:
+      g_variant_type_info_query (item_info, NULL, &fixed_size);
+      needs_offset = (fixed_size == 0);
+      break;
+
+    case G_VARIANT_TYPE_INFO_CHAR_MAYBE:
+      break;
+
+    default: /* tuples and dict entries */
+      needs_offset = g_variant_type_info_member_info (frame->type_info,
+                                                      frame->n_items)->ending_type ==
+                     G_VARIANT_MEMBER_ENDING_OFFSET;
+      break;
+    }
+
+  if (needs_offset)
+    {
+      gsize end = stream->buffer->len - frame->start;
+
+      g_array_append_val (stream->offsets, end);
+    }
+
+  frame->n_items++;
+}
+
+static void
+stream_builder_append (struct stream_builder *stream,
+                       gconstpointer          data,
+                       gsize                  size)
+{
+  g_byte_array_append (stream->buffer, data, size);
+}
+
+/* Finishes the innermost container and removes it from the stack */
+static gboolean
+stream_builder_pop (struct stream_builder *stream)
+{
+  struct stream_frame *frame = stream_builder_top (stream);
+  GVariantTypeInfo *type_info = frame->type_info;
+  gsize n_offsets = stream->offsets->len - frame->first_offset;
+  gsize *offsets = &g_array_index (stream->offsets, gsize, frame->first_offset);
+  gsize fixed_size;
+
+  switch (g_variant_type_info_get_type_char (type_info))
+    {
+    case G_VARIANT_TYPE_INFO_CHAR_VARIANT:
+      {
+        const gchar *type_string;
+
+        if (frame->n_items != 1)
+          return FALSE;
+
+        type_string = g_variant_type_info_get_type_string (frame->child_info);
+        stream_builder_append (stream, "", 1);
+        stream_builder_append (stream, type_string, strlen (type_string));
+        g_variant_type_info_unref (frame->child_info);
+      }
+      break;
+
+    case G_VARIANT_TYPE_INFO_CHAR_MAYBE:
+      g_variant_type_info_query_element (type_info, NULL, &fixed_size);
+      if (frame->n_items && !fixed_size)
+        stream_builder_append (stream, "", 1);
+      break;
+
+    case G_VARIANT_TYPE_INFO_CHAR_ARRAY:
+      break;
+
+    default: /* tuples and dict entries */
+      if (frame->n_items != g_variant_type_info_n_members (type_info))
+        return FALSE;
+
+      g_variant_type_info_query (type_info, NULL, &fixed_size);
+      if (fixed_size)
+        {
+          gsize size = stream->buffer->len - frame->start;
+
+          g_byte_array_set_size (stream->buffer, frame->start + fixed_size);
+          memset (stream->buffer->data + frame->start + size, 0,
+                  fixed_size - size);
+        }
+      else
+        {
+          /* tuples store their offsets last to first */
+          gsize i;
+
+          for (i = 0; i < n_offsets / 2; i++)
+            {
+              gsize tmp = offsets[i];
+
+              offsets[i] = offsets[n_offsets - 1 - i];
+              offsets[n_offsets - 1 - i] = tmp;
+            }
+        }
+      break;
+    }
+
+  if (n_offsets)
+    {
+      gsize body_size = stream->buffer->len - frame->start;
+      gsize size;
+
+      size = g_variant_serialiser_write_offsets (NULL, body_size, offsets, n_offsets);
+      g_byte_array_set_size (stream->buffer, stream->buffer->len + size);
+      g_variant_serialiser_write_offsets (stream->buffer->data + frame->start + body_size,
+                                          body_size, offsets, n_offsets);
+      g_array_set_size (stream->offsets, frame->first_offset);
+    }
+
+  g_array_set_size (stream->frames, stream->frames->len - 1);
+
+  if (stream->frames->len > 0)
+    stream_builder_item_done (stream, type_info);
+  g_variant_type_info_unref (type_info);
+
+  return TRUE;
+}
+
 static gboolean
 ensure_valid_builder (GVariantBuilder *builder)
 {
@@ -3320,6 +3640,9 @@ g_variant_builder_clear (GVariantBuilder *builder)
 
   g_variant_type_free (GVSB(builder)->type);
 
+  if (GVSB(builder)->stream)
+    stream_builder_free (GVSB(builder)->stream);
+
   for (i = 0; i < GVSB(builder)->offset; i++)
     g_variant_unref (GVSB(builder)->children[i]);
 
@@ -3446,6 +3769,47 @@ g_variant_builder_init (GVariantBuilder    *builder,
                                    GVSB(builder)->allocated_children);
 }
 
+/**
+ * g_variant_builder_init_streaming: (skip)
+ * @builder: a #GVariantBuilder
+ * @type: a definite container type
+ *
+ * Initialises a #GVariantBuilder structure like g_variant_builder_init(),
+ * but for a builder that writes every value out as soon as it is added,
+ * instead of keeping a tree of #GVariant instances until
+ * g_variant_builder_end() is called.
+ *
+ * The builder is used with the same functions, and produces the same
+ * value.  Each value passed to g_variant_builder_add_value() or created
+ * by g_variant_builder_add() is serialised straight away and released,
+ * and containers opened with g_variant_builder_open() are written out
+ * in place.  The result of g_variant_builder_end() uses the buffer that
+ * was written to, without copying it.  This makes a big difference in
+ * memory use and speed when building large containers, for example
+ * dictionaries with many thousands of entries.
+ *
+ * Unlike with g_variant_builder_init(), @type and the types passed to
+ * g_variant_builder_open() must be definite, since the serialised form
+ * of a container depends on the exact types of its children.
+ *
+ * Since: 2.54
+ **/
+void
+g_variant_builder_init_streaming (GVariantBuilder    *builder,
+                                  const GVariantType *type)
+{
+  g_return_if_fail (type != NULL);
+  g_return_if_fail (g_variant_type_is_container (type));
+  g_return_if_fail (g_variant_type_is_definite (type));
+
+  memset (builder, 0, sizeof (GVariantBuilder));
+
+  GVSB(builder)->type = g_variant_type_copy (type);
+  GVSB(builder)->magic = GVSB_MAGIC;
+  GVSB(builder)->trusted = TRUE;
+  GVSB(builder)->stream = stream_builder_new (type);
+}
+
 static void
 g_variant_builder_make_room (struct stack_builder *builder)
 {
@@ -3480,6 +3844,27 @@ g_variant_builder_add_value (GVariantBuilder *builder,
                              GVariant        *value)
 {
   g_return_if_fail (ensure_valid_builder (builder));
+
+  if (GVSB(builder)->stream)
+    {
+      struct stream_builder *stream = GVSB(builder)->stream;
+      GVariantTypeInfo *type_info = g_variant_get_type_info (value);
+      gsize start;
+
+      g_return_if_fail (stream_builder_accepts (stream, type_info));
+
+      g_variant_ref_sink (value);
+      GVSB(builder)->trusted &= g_variant_is_trusted (value);
+
+      start = stream_builder_align (stream, type_info);
+      g_byte_array_set_size (stream->buffer, start + g_variant_get_size (value));
+      g_variant_store (value, stream->buffer->data + start);
+      stream_builder_item_done (stream, type_info);
+
+      g_variant_unref (value);
+      return;
+    }
+
   g_return_if_fail (GVSB(builder)->offset < GVSB(builder)->max_items);
   g_return_if_fail (!GVSB(builder)->expected_type ||
                     g_variant_is_of_type (value,
@@ -3561,6 +3946,38 @@ g_variant_builder_open (GVariantBuilder    *builder,
   GVariantBuilder *parent;
 
   g_return_if_fail (ensure_valid_builder (builder));
+
+  if (GVSB(builder)->stream)
+    {
+      struct stream_builder *stream = GVSB(builder)->stream;
+      GVariantTypeInfo *type_info;
+      gboolean accepted;
+
+      g_return_if_fail (g_variant_type_is_container (type));
+      g_return_if_fail (g_variant_type_is_definite (type));
+
+      /* Looking up a container type info takes a lock, so avoid that
+       * when the type is known, which it is except inside variants.
+       */
+      if (stream_builder_expected (stream, &type_info) && type_info != NULL &&
+          g_variant_type_equal (type,
+                                G_VARIANT_TYPE (g_variant_type_info_get_type_string (type_info))))
+        type_info = g_variant_type_info_ref (type_info);
+      else
+        type_info = g_variant_type_info_get (type);
+
+      accepted = stream_builder_accepts (stream, type_info);
+      if (accepted)
+        {
+          stream_builder_align (stream, type_info);
+          stream_builder_push (stream, type_info);
+        }
+      g_variant_type_info_unref (type_info);
+
+      g_return_if_fail (accepted);
+      return;
+    }
+
   g_return_if_fail (GVSB(builder)->offset < GVSB(builder)->max_items);
   g_return_if_fail (!GVSB(builder)->expected_type ||
                     g_variant_type_is_subtype_of (type,
@@ -3607,6 +4024,18 @@ g_variant_builder_close (GVariantBuilder *builder)
   GVariantBuilder *parent;
 
   g_return_if_fail (ensure_valid_builder (builder));
+
+  if (GVSB(builder)->stream)
+    {
+      gboolean closed;
+
+      g_return_if_fail (GVSB(builder)->stream->frames->len > 1);
+
+      closed = stream_builder_pop (GVSB(builder)->stream);
+      g_return_if_fail (closed);
+      return;
+    }
+
   g_return_if_fail (GVSB(builder)->parent != NULL);
 
   parent = GVSB(builder)->parent;
@@ -3642,6 +4071,35 @@ g_variant_make_array_type (GVariant *element)
   return g_variant_type_new_array (g_variant_get_type (element));
 }
 
+static GVariant *
+stream_builder_end (GVariantBuilder *builder)
+{
+  struct stream_builder *stream = GVSB(builder)->stream;
+  GVariant *value;
+  gboolean closed;
+  GBytes *bytes;
+  gsize size;
+
+  g_return_val_if_fail (stream->frames->len == 1, NULL);
+
+  closed = stream_builder_pop (stream);
+  g_return_val_if_fail (closed, NULL);
+
+  /* the buffer may be up to twice as big as needed */
+  size = stream->buffer->len;
+  bytes = g_bytes_new_take (g_realloc (g_byte_array_free (stream->buffer, FALSE), size),
+                            size);
+  stream->buffer = NULL;
+
+  value = g_variant_new_from_bytes (GVSB(builder)->type, bytes,
+                                    GVSB(builder)->trusted);
+  g_bytes_unref (bytes);
+
+  g_variant_builder_clear (builder);
+
+  return value;
+}
+
 /**
  * g_variant_builder_end:
  * @builder: a #GVariantBuilder
@@ -3675,6 +4133,10 @@ g_variant_builder_end (GVariantBuilder *builder)
   GVariant *value;
 
   g_return_val_if_fail (ensure_valid_builder (builder), NULL);
+
+  if (GVSB(builder)->stream)
+    return stream_builder_end (builder);
+
   g_return_val_if_fail (GVSB(builder)->offset >= GVSB(builder)->min_items,
                         NULL);
   g_return_val_if_fail (!GVSB(builder)->uniform_item_types ||
@@ -4544,6 +5006,85 @@ g_variant_format_string_scan_type (const gchar  *string,
   return (GVariantType *) G_VARIANT_TYPE (new);
 }
 
+/* Format strings that have been checked before, with their types.
+ *
+ * Programs tend to use a handful of format strings over and over, so
+ * valid_format_string() remembers complete format strings that passed
+ * its checks.  The table is keyed on the contents of the format string
+ * (not its address, which may be a reused buffer) and is fixed in size:
+ * entries are only ever added to free slots and are never removed, so
+ * they can be read without any locking.  Once the table is full, new
+ * format strings are simply checked every time, as before.
+ */
+typedef struct
+{
+  gchar        *format_string;
+  GVariantType *type;
+} CheckedFormat;
+
+#define CHECKED_FORMATS_SIZE   256
+#define CHECKED_FORMATS_PROBES 4
+#define CHECKED_FORMAT_MAX_LENGTH 64
+
+static CheckedFormat *checked_formats[CHECKED_FORMATS_SIZE];
+
+static const GVariantType *
+checked_format_lookup (const gchar *format_string,
+                       guint        hash)
+{
+  guint i;
+
+  for (i = 0; i < CHECKED_FORMATS_PROBES; i++)
+    {
+      CheckedFormat *checked;
+
+      checked = g_atomic_pointer_get (&checked_formats[(hash + i) % CHECKED_FORMATS_SIZE]);
+
+      /* slots are filled in order, so the first empty one ends the search */
+      if (checked == NULL)
+        break;
+
+      if (strcmp (checked->format_string, format_string) == 0)
+        return checked->type;
+    }
+
+  return NULL;
+}
+
+static void
+checked_format_insert (const gchar        *format_string,
+                       guint               hash,
+                       const GVariantType *type)
+{
+  CheckedFormat *checked;
+  guint i;
+
+  if (strlen (format_string) > CHECKED_FORMAT_MAX_LENGTH)
+    return;
+
+  checked = g_new (CheckedFormat, 1);
+  checked->format_string = g_strdup (format_string);
+  checked->type = g_variant_type_copy (type);
+
+  for (i = 0; i < CHECKED_FORMATS_PROBES; i++)
+    {
+      gpointer *slot = (gpointer *) &checked_formats[(hash + i) % CHECKED_FORMATS_SIZE];
+      CheckedFormat *other;
+
+      if (g_atomic_pointer_compare_and_exchange (slot, NULL, checked))
+        return;
+
+      /* another thread may just have added the same one */
+      other = g_atomic_pointer_get (slot);
+      if (strcmp (other->format_string, format_string) == 0)
+        break;
+    }
+
+  g_variant_type_free (checked->type);
+  g_free (checked->format_string);
+  g_free (checked);
+}
+
 static gboolean
 valid_format_string (const gchar *format_string,
                      gboolean     single,
@@ -4551,6 +5092,19 @@ valid_format_string (const gchar *format_string,
 {
   const gchar *endptr;
   GVariantType *type;
+  guint hash = 0;
+
+  if (single)
+    {
+      const GVariantType *checked_type;
+
+      hash = g_str_hash (format_string);
+      checked_type = checked_format_lookup (format_string, hash);
+
+      if G_LIKELY (checked_type != NULL &&
+                   (value == NULL || g_variant_is_of_type (value, checked_type)))
+        return TRUE;
+    }
 
   type = g_variant_format_string_scan_type (format_string, NULL, &endptr);
 
@@ -4588,6 +5142,9 @@ valid_format_string (const gchar *format_string,
       return FALSE;
     }
 
+  if (single)
+    checked_format_insert (format_string, hash, type);
+
   g_variant_type_free (type);
 
   return TRUE;
@@ -5201,6 +5758,17 @@ g_variant_valist_new (const gchar **str,
     }
 }
 
+/* Whether unpacking a value with the format string at @str may keep a
+ * reference on the value itself, rather than only on its children.
+ * Values unpacked with any other format string can be borrowed views,
+ * see g_variant_view_init().
+ */
+static gboolean
+g_variant_format_string_refs_value (const gchar *str)
+{
+  return strchr ("a@*?r", *str) != NULL;
+}
+
 static void
 g_variant_valist_get (const gchar **str,
                       GVariant     *value,
@@ -5242,9 +5810,23 @@ g_variant_valist_get (const gchar **str,
         {
           if (value != NULL)
             {
-              GVariant *child = g_variant_get_child_value (value, index++);
-              g_variant_valist_get (str, child, free, app);
-              g_variant_unref (child);
+              GVariantView view;
+              GVariant *child;
+
+              if (!g_variant_format_string_refs_value (*str) &&
+                  (child = g_variant_view_init (&view, value, index)))
+                {
+                  g_variant_valist_get (str, child, free, app);
+                  g_variant_view_clear (&view);
+                }
+              else
+                {
+                  child = g_variant_get_child_value (value, index);
+                  g_variant_valist_get (str, child, free, app);
+                  g_variant_unref (child);
+                }
+
+              index++;
             }
           else
             g_variant_valist_get (str, NULL, free, app);
@@ -5305,7 +5887,7 @@ g_variant_new (const gchar *format_string,
                         NULL);
 
   va_start (ap, format_string);
-  value = g_variant_new_va (format_string, NULL, &ap);
+  value = g_variant_valist_new (&format_string, &ap);
   va_end (ap);
 
   return value;
@@ -5417,7 +5999,7 @@ g_variant_get (GVariant    *value,
     g_variant_get_data (value);
 
   va_start (ap, format_string);
-  g_variant_get_va (value, format_string, NULL, &ap);
+  g_variant_valist_get (&format_string, value, FALSE, &ap);
   va_end (ap);
 }
 
@@ -5478,6 +6060,110 @@ g_variant_get_va (GVariant     *value,
 
 /* Varargs-enabled Utility Functions {{{1 */
 
+/* For a streaming builder and a format string of a single basic type,
+ * writes the value out without creating a #GVariant for it.  Returns
+ * %FALSE, without consuming any arguments, if this does not apply.
+ */
+static gboolean
+stream_builder_add_basic (GVariantBuilder *builder,
+                          const gchar     *format_string,
+                          va_list         *app)
+{
+  struct stream_builder *stream = GVSB(builder)->stream;
+  GVariantTypeInfo *type_info;
+  union
+  {
+    guint8 byte;
+    gint16 int16;
+    gint32 int32;
+    gint64 int64;
+    gdouble floating;
+  } number;
+  gconstpointer data = &number;
+  const gchar *string;
+  gsize size, start;
+
+  if (format_string[0] == '\0' || format_string[1] != '\0' ||
+      strchr ("bynqiuxthdsogv", format_string[0]) == NULL)
+    return FALSE;
+
+  /* basic type infos are static, no need to unref */
+  type_info = g_variant_type_info_get (G_VARIANT_TYPE (format_string));
+  if (!stream_builder_accepts (stream, type_info))
+    return FALSE;
+
+  switch (format_string[0])
+    {
+    case 'v':
+      {
+        GVariant *value = va_arg (*app, GVariant *);
+
+        g_return_val_if_fail (value != NULL, TRUE);
+
+        /* the same as opening a variant and adding @value to it */
+        stream_builder_align (stream, type_info);
+        stream_builder_push (stream, type_info);
+        g_variant_builder_add_value (builder, value);
+        stream_builder_pop (stream);
+      }
+      return TRUE;
+
+    case 'b':
+      number.byte = va_arg (*app, gboolean) != FALSE;
+      size = 1;
+      break;
+
+    case 'y':
+      number.byte = va_arg (*app, guint);
+      size = 1;
+      break;
+
+    case 'n':
+    case 'q':
+      number.int16 = va_arg (*app, gint);
+      size = 2;
+      break;
+
+    case 'i':
+    case 'u':
+    case 'h':
+      number.int32 = va_arg (*app, gint);
+      size = 4;
+      break;
+
+    case 'x':
+    case 't':
+      number.int64 = va_arg (*app, gint64);
+      size = 8;
+      break;
+
+    case 'd':
+      number.floating = va_arg (*app, gdouble);
+      size = 8;
+      break;
+
+    default:
+      string = va_arg (*app, const gchar *);
+      g_return_val_if_fail (string != NULL, TRUE);
+      if (format_string[0] == 's')
+        g_return_val_if_fail (g_utf8_validate (string, -1, NULL), TRUE);
+      else if (format_string[0] == 'o')
+        g_return_val_if_fail (g_variant_is_object_path (string), TRUE);
+      else
+        g_return_val_if_fail (g_variant_is_signature (string), TRUE);
+      data = string;
+      size = strlen (string) + 1;
+      break;
+    }
+
+  start = stream_builder_align (stream, type_info);
+  g_byte_array_set_size (stream->buffer, start + size);
+  memcpy (stream->buffer->data + start, data, size);
+  stream_builder_item_done (stream, type_info);
+
+  return TRUE;
+}
+
 /**
  * g_variant_builder_add: (skip)
  * @builder: a #GVariantBuilder
@@ -5526,6 +6212,14 @@ g_variant_builder_add (GVariantBuilder *builder,
   va_list ap;
 
   va_start (ap, format_string);
+
+  if (is_valid_builder (builder) && GVSB(builder)->stream &&
+      stream_builder_add_basic (builder, format_string, &ap))
+    {
+      va_end (ap);
+      return;
+    }
+
   variant = g_variant_new_va (format_string, NULL, &ap);
   va_end (ap);
 
@@ -5568,7 +6262,7 @@ g_variant_get_child (GVariant    *value,
   g_return_if_fail (valid_format_string (format_string, TRUE, child));
 
   va_start (ap, format_string);
-  g_variant_get_va (child, format_string, NULL, &ap);
+  g_variant_valist_get (&format_string, child, FALSE, &ap);
   va_end (ap);
 
   g_variant_unref (child);
@@ -5631,9 +6325,21 @@ g_variant_iter_next (GVariantIter *iter,
                      const gchar  *format_string,
                      ...)
 {
-  GVariant *value;
+  GVariantView view;
+  GVariant *value = NULL;
+  gboolean borrowed;
 
-  value = g_variant_iter_next_value (iter);
+  /* skip allocating the child if it can not outlive this call */
+  if (is_valid_iter (iter) && GVSI(iter)->i + 1 < GVSI(iter)->n &&
+      format_string != NULL && !g_variant_format_string_refs_value (format_string))
+    value = g_variant_view_init (&view, GVSI(iter)->value, GVSI(iter)->i + 1);
+
+  borrowed = value != NULL;
+
+  if (borrowed)
+    GVSI(iter)->i++;
+  else
+    value = g_variant_iter_next_value (iter);
 
   g_return_val_if_fail (valid_format_string (format_string, TRUE, value),
                         FALSE);
@@ -5646,7 +6352,10 @@ g_variant_iter_next (GVariantIter *iter,
       g_variant_valist_get (&format_string, value, FALSE, &ap);
       va_end (ap);
 
-      g_variant_unref (value);
+      if (borrowed)
+        g_variant_view_clear (&view);
+      else
+        g_variant_unref (value);
     }
 
   return value != NULL;
@@ -5995,5 +6704,76 @@ g_variant_new_from_data (const GVariantType *type,
   return value;
 }
 
+/**
+ * g_variant_new_from_file:
+ * @type: a definite #GVariantType
+ * @filename: (type filename): the file to load
+ * @flags: flags from #GVariantFileFlags
+ * @error: return location for a #GError, or %NULL
+ *
+ * Creates a new #GVariant instance from the serialised data in the
+ * file @filename, as written out by g_variant_get_data() or
+ * g_variant_store().
+ *
+ * The file is mapped into memory with #GMappedFile rather than read,
+ * so the returned value holds the mapping open and only the pages
+ * that are actually used are ever read in.  This makes it possible to
+ * open files much bigger than the memory it would take to copy them.
+ * The file must not be modified while the value is in use.
+ *
+ * Unless %G_VARIANT_FILE_FLAGS_TRUSTED is given, the contents are not
+ * trusted.  As with g_variant_new_from_data(), untrusted data is never
+ * validated as a whole up front: each child is checked as it is
+ * accessed, and only the pages needed to find and read that child are
+ * touched.  Be aware that functions like g_variant_get_normal_form(),
+ * g_variant_is_normal_form() and g_variant_print() walk the entire
+ * value.  Use g_variant_validate_children() to check a range of a
+ * large container explicitly.
+ *
+ * %G_VARIANT_FILE_FLAGS_RANDOM_ACCESS and %G_VARIANT_FILE_FLAGS_PREFETCH
+ * are passed on to the kernel with g_mapped_file_advise(); they do not
+ * change the result.
+ *
+ * If the file could not be opened or mapped, %NULL is returned and
+ * @error is set to a #GFileError.
+ *
+ * Returns: (transfer none): a new floating #GVariant of type @type, or
+ *     %NULL on error
+ *
+ * Since: 2.54
+ **/
+GVariant *
+g_variant_new_from_file (const GVariantType  *type,
+                         const gchar         *filename,
+                         GVariantFileFlags    flags,
+                         GError             **error)
+{
+  GMappedFile *file;
+  GVariant *value;
+  GBytes *bytes;
+
+  g_return_val_if_fail (g_variant_type_is_definite (type), NULL);
+  g_return_val_if_fail (filename != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  file = g_mapped_file_new (filename, FALSE, error);
+  if (file == NULL)
+    return NULL;
+
+  if (flags & G_VARIANT_FILE_FLAGS_RANDOM_ACCESS)
+    g_mapped_file_advise (file, G_MAPPED_FILE_ADVICE_RANDOM, 0, 0);
+  if (flags & G_VARIANT_FILE_FLAGS_PREFETCH)
+    g_mapped_file_advise (file, G_MAPPED_FILE_ADVICE_WILL_NEED, 0, 0);
+
+  bytes = g_mapped_file_get_bytes (file);
+  g_mapped_file_unref (file);
+
+  value = g_variant_new_from_bytes (type, bytes,
+                                    (flags & G_VARIANT_FILE_FLAGS_TRUSTED) != 0);
+  g_bytes_unref (bytes);
+
+  return value;
+}
+
 /* Epilogue {{{1 */
 /* vim:set foldmethod=marker: */
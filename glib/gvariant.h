@@ -250,6 +250,10 @@ GLIB_AVAILABLE_IN_ALL
 GVariant *                      g_variant_get_normal_form               (GVariant             *value);
 GLIB_AVAILABLE_IN_ALL
 gboolean                        g_variant_is_normal_form                (GVariant             *value);
+GLIB_AVAILABLE_IN_2_54
+gboolean                        g_variant_validate_children             (GVariant             *value,
+                                                                         gsize                 index_,
+                                                                         gsize                 n_children);
 GLIB_AVAILABLE_IN_ALL
 GVariant *                      g_variant_byteswap                      (GVariant             *value);
 
@@ -265,6 +269,34 @@ GVariant *                      g_variant_new_from_data                 (const G
                                                                          GDestroyNotify        notify,
                                                                          gpointer              user_data);
 
+/**
+ * GVariantFileFlags:
+ * @G_VARIANT_FILE_FLAGS_NONE: no flags
+ * @G_VARIANT_FILE_FLAGS_TRUSTED: the file is trusted to be in normal
+ *     form, as for the @trusted argument of g_variant_new_from_data()
+ * @G_VARIANT_FILE_FLAGS_RANDOM_ACCESS: values will be looked up in no
+ *     particular order, so the kernel should not read ahead
+ * @G_VARIANT_FILE_FLAGS_PREFETCH: most of the file will be needed, so
+ *     the kernel should start reading all of it in right away
+ *
+ * Flags passed to g_variant_new_from_file().
+ *
+ * Since: 2.54
+ */
+typedef enum
+{
+  G_VARIANT_FILE_FLAGS_NONE          = 0,
+  G_VARIANT_FILE_FLAGS_TRUSTED       = (1 << 0),
+  G_VARIANT_FILE_FLAGS_RANDOM_ACCESS = (1 << 1),
+  G_VARIANT_FILE_FLAGS_PREFETCH      = (1 << 2)
+} GVariantFileFlags;
+
+GLIB_AVAILABLE_IN_2_54
+GVariant *                      g_variant_new_from_file                 (const GVariantType   *type,
+                                                                         const gchar          *filename,
+                                                                         GVariantFileFlags     flags,
+                                                                         GError              **error);
+
 typedef struct _GVariantIter GVariantIter;
 struct _GVariantIter {
   /*< private >*/
@@ -370,6 +402,9 @@ GVariantBuilder *               g_variant_builder_ref                   (GVarian
 GLIB_AVAILABLE_IN_ALL
 void                            g_variant_builder_init                  (GVariantBuilder      *builder,
                                                                          const GVariantType   *type);
+GLIB_AVAILABLE_IN_2_54
+void                            g_variant_builder_init_streaming        (GVariantBuilder      *builder,
+                                                                         const GVariantType   *type);
 GLIB_AVAILABLE_IN_ALL
 GVariant *                      g_variant_builder_end                   (GVariantBuilder      *builder);
 GLIB_AVAILABLE_IN_ALL
@@ -707,9 +707,37 @@ g_variant_type_info_member_info (GVariantTypeInfo *info,
 }
 
 /* == new/ref/unref == */
-static GRecMutex g_variant_type_info_lock;
+
+/* The table is keyed on the type strings of the infos it contains, as
+ * GVariantTypes, so that lookups don't need to copy the type string.
+ *
+ * Lookups only take the lock for reading, so they don't contend with
+ * each other.  The lock is taken for writing to insert a new info, and
+ * to drop the last reference on one, which guarantees that anything a
+ * reader finds in the table still has a reference.  Infos are created
+ * and freed outside of the lock, since doing so recursively gets and
+ * unrefs the infos of their members.
+ */
+static GRWLock g_variant_type_info_lock;
 static GHashTable *g_variant_type_info_table;
 
+static void
+container_info_free (GVariantTypeInfo *info)
+{
+  ContainerInfo *container = (ContainerInfo *) info;
+
+  g_free (container->type_string);
+
+  if (info->container_class == GV_ARRAY_INFO_CLASS)
+    array_info_free (info);
+
+  else if (info->container_class == GV_TUPLE_INFO_CLASS)
+    tuple_info_free (info);
+
+  else
+    g_assert_not_reached ();
+}
+
 /* < private >
  * g_variant_type_info_get:
  * @type: a #GVariantType
@@ -735,45 +763,57 @@ g_variant_type_info_get (const GVariantType *type)
       type_char == G_VARIANT_TYPE_INFO_CHAR_TUPLE ||
       type_char == G_VARIANT_TYPE_INFO_CHAR_DICT_ENTRY)
     {
-      GVariantTypeInfo *info;
-      gchar *type_string;
+      GVariantTypeInfo *info = NULL;
+      GVariantTypeInfo *existing;
+      ContainerInfo *container;
+
+      g_rw_lock_reader_lock (&g_variant_type_info_lock);
+      if (g_variant_type_info_table != NULL)
+        info = g_hash_table_lookup (g_variant_type_info_table, type);
+      if (info != NULL)
+        g_variant_type_info_ref (info);
+      g_rw_lock_reader_unlock (&g_variant_type_info_lock);
 
-      type_string = g_variant_type_dup_string (type);
+      if (info != NULL)
+        return info;
 
-      g_rec_mutex_lock (&g_variant_type_info_lock);
+      if (type_char == G_VARIANT_TYPE_INFO_CHAR_MAYBE ||
+          type_char == G_VARIANT_TYPE_INFO_CHAR_ARRAY)
+        {
+          container = array_info_new (type);
+        }
+      else /* tuple or dict entry */
+        {
+          container = tuple_info_new (type);
+        }
 
-      if (g_variant_type_info_table == NULL)
-        g_variant_type_info_table = g_hash_table_new (g_str_hash,
-                                                      g_str_equal);
-      info = g_hash_table_lookup (g_variant_type_info_table, type_string);
+      info = (GVariantTypeInfo *) container;
+      container->type_string = g_variant_type_dup_string (type);
+      container->ref_count = 1;
 
-      if (info == NULL)
-        {
-          ContainerInfo *container;
+      g_rw_lock_writer_lock (&g_variant_type_info_lock);
 
-          if (type_char == G_VARIANT_TYPE_INFO_CHAR_MAYBE ||
-              type_char == G_VARIANT_TYPE_INFO_CHAR_ARRAY)
-            {
-              container = array_info_new (type);
-            }
-          else /* tuple or dict entry */
-            {
-              container = tuple_info_new (type);
-            }
+      if (g_variant_type_info_table == NULL)
+        g_variant_type_info_table = g_hash_table_new (g_variant_type_hash,
+                                                      g_variant_type_equal);
+
+      /* Another thread may have created the same info meanwhile */
+      existing = g_hash_table_lookup (g_variant_type_info_table, type);
+      if (existing != NULL)
+        g_variant_type_info_ref (existing);
+      else
+        g_hash_table_insert (g_variant_type_info_table,
+                             container->type_string, info);
 
-          info = (GVariantTypeInfo *) container;
-          container->type_string = type_string;
-          container->ref_count = 1;
+      g_rw_lock_writer_unlock (&g_variant_type_info_lock);
 
-          g_hash_table_insert (g_variant_type_info_table, type_string, info);
-          type_string = NULL;
+      if (existing != NULL)
+        {
+          container_info_free (info);
+          info = existing;
         }
-      else
-        g_variant_type_info_ref (info);
 
-      g_rec_mutex_unlock (&g_variant_type_info_lock);
       g_variant_type_info_check (info, 0);
-      g_free (type_string);
 
       return info;
     }
@@ -831,8 +871,17 @@ g_variant_type_info_unref (GVariantTypeInfo *info)
   if (info->container_class)
     {
       ContainerInfo *container = (ContainerInfo *) info;
+      gint old_ref;
+
+      /* Dropping a reference that isn't the last one needs no lock */
+      while ((old_ref = g_atomic_int_get (&container->ref_count)) > 1)
+        {
+          if (g_atomic_int_compare_and_exchange (&container->ref_count,
+                                                 old_ref, old_ref - 1))
+            return;
+        }
 
-      g_rec_mutex_lock (&g_variant_type_info_lock);
+      g_rw_lock_writer_lock (&g_variant_type_info_lock);
       if (g_atomic_int_dec_and_test (&container->ref_count))
         {
           g_hash_table_remove (g_variant_type_info_table,
@@ -842,21 +891,12 @@ g_variant_type_info_unref (GVariantTypeInfo *info)
               g_hash_table_unref (g_variant_type_info_table);
               g_variant_type_info_table = NULL;
             }
-          g_rec_mutex_unlock (&g_variant_type_info_lock);
-
-          g_free (container->type_string);
-
-          if (info->container_class == GV_ARRAY_INFO_CLASS)
-            array_info_free (info);
-
-          else if (info->container_class == GV_TUPLE_INFO_CLASS)
-            tuple_info_free (info);
+          g_rw_lock_writer_unlock (&g_variant_type_info_lock);
 
-          else
-            g_assert_not_reached ();
+          container_info_free (info);
         }
       else
-        g_rec_mutex_unlock (&g_variant_type_info_lock);
+        g_rw_lock_writer_unlock (&g_variant_type_info_lock);
     }
 }
 
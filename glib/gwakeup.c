@@ -101,6 +101,13 @@ g_wakeup_signal (GWakeup *wakeup)
   SetEvent ((HANDLE) wakeup);
 }
 
+void
+g_wakeup_set_coalescing (GWakeup  *wakeup,
+                         gboolean  coalesce)
+{
+  /* SetEvent() on a set event is already cheap */
+}
+
 void
 g_wakeup_free (GWakeup *wakeup)
 {
@@ -112,6 +119,10 @@ g_wakeup_free (GWakeup *wakeup)
 #include "glib-unix.h"
 #include <fcntl.h>
 
+#ifdef GLIB_COMPILATION
+#include "gatomic.h"
+#endif
+
 #if defined (HAVE_EVENTFD)
 #include <sys/eventfd.h>
 #endif
@@ -119,6 +130,14 @@ g_wakeup_free (GWakeup *wakeup)
 struct _GWakeup
 {
   gint fds[2];
+
+  /* With coalescing enabled, set by the first g_wakeup_signal() after
+   * an acknowledgement, so that further signals don't need to touch
+   * the fd.  This is only done when atomic operations are lock-free,
+   * to keep g_wakeup_signal() safe to call from signal handlers.
+   */
+  gboolean coalesce;
+  volatile gint signalled;
 };
 
 /**
@@ -139,6 +158,8 @@ g_wakeup_new (void)
   GWakeup *wakeup;
 
   wakeup = g_slice_new (GWakeup);
+  wakeup->coalesce = FALSE;
+  wakeup->signalled = FALSE;
 
   /* try eventfd first, if we think we can */
 #if defined (HAVE_EVENTFD)
@@ -208,6 +229,37 @@ g_wakeup_acknowledge (GWakeup *wakeup)
 
   /* read until it is empty */
   while (read (wakeup->fds[0], buffer, sizeof buffer) == sizeof buffer);
+
+#ifdef G_ATOMIC_LOCK_FREE
+  /* Only clear the flag after draining: a signal that races with us is
+   * then treated as having happened just before the acknowledgement,
+   * rather than leaving the flag set with nothing in the fd.  See
+   * g_wakeup_set_coalescing() for what that means for the caller.
+   */
+  if (wakeup->coalesce)
+    g_atomic_int_compare_and_exchange (&wakeup->signalled, TRUE, FALSE);
+#endif
+}
+
+/*< private >
+ * g_wakeup_set_coalescing:
+ * @wakeup: a #GWakeup
+ * @coalesce: whether to coalesce signals
+ *
+ * Makes g_wakeup_signal() skip the write to the fd while an earlier
+ * signal has not been acknowledged yet.
+ *
+ * A signal that races with g_wakeup_acknowledge() is then absorbed by
+ * it, without polling as ready afterwards.  This is only correct for
+ * users that look at their state after acknowledging, and before they
+ * poll again, like #GMainContext does.  It must be called before
+ * @wakeup is shared with other threads.
+ */
+void
+g_wakeup_set_coalescing (GWakeup  *wakeup,
+                         gboolean  coalesce)
+{
+  wakeup->coalesce = coalesce;
 }
 
 /**
@@ -229,6 +281,13 @@ g_wakeup_signal (GWakeup *wakeup)
 {
   int res;
 
+#ifdef G_ATOMIC_LOCK_FREE
+  /* Already signalled and not yet acknowledged: nothing to do */
+  if (wakeup->coalesce &&
+      !g_atomic_int_compare_and_exchange (&wakeup->signalled, FALSE, TRUE))
+    return;
+#endif
+
   if (wakeup->fds[1] == -1)
     {
       guint64 one = 1;
@@ -31,5 +31,7 @@ void            g_wakeup_get_pollfd     (GWakeup *wakeup,
                                          GPollFD *poll_fd);
 void            g_wakeup_signal         (GWakeup *wakeup);
 void            g_wakeup_acknowledge    (GWakeup *wakeup);
+void            g_wakeup_set_coalescing (GWakeup *wakeup,
+                                         gboolean coalesce);
 
 #endif
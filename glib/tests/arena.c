@@ -0,0 +1,248 @@
+/* Unit tests for GArena
+ *
+ * This work is provided "as is"; redistribution and modification
+ * in whole or in part, in any medium, physical or electronic is
+ * permitted without restriction.
+ *
+ * This work is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * In no event shall the authors or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ */
+
+#include <glib.h>
+#include <string.h>
+
+static void
+test_alloc (void)
+{
+  GArena *arena;
+  gpointer blocks[1000];
+  gchar *str;
+  guint8 zeros[64] = { 0, };
+  gint i;
+
+  arena = g_arena_new (256);
+
+  for (i = 0; i < G_N_ELEMENTS (blocks); i++)
+    {
+      /* mix small ones with ones that get a block of their own */
+      gsize size = i % 10 == 0 ? 500 : 1 + i % 40;
+
+      blocks[i] = g_arena_alloc (arena, size);
+      g_assert_cmpuint (GPOINTER_TO_SIZE (blocks[i]) % (2 * sizeof (gsize)), ==, 0);
+      memset (blocks[i], i, size);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (blocks); i++)
+    {
+      gsize size = i % 10 == 0 ? 500 : 1 + i % 40;
+
+      g_assert_cmpint (((guint8 *) blocks[i])[size - 1], ==, (guint8) i);
+    }
+
+  g_assert (memcmp (g_arena_alloc0 (arena, 64), zeros, 64) == 0);
+
+  str = g_arena_strdup (arena, "arena");
+  g_assert_cmpstr (str, ==, "arena");
+  g_assert_null (g_arena_strdup (arena, NULL));
+  g_assert_null (g_arena_memdup (arena, NULL, 10));
+
+  g_arena_reset (arena);
+
+  for (i = 0; i < G_N_ELEMENTS (blocks); i++)
+    memset (g_arena_alloc (arena, 24), 0xff, 24);
+
+  g_arena_free (arena);
+}
+
+static void
+test_realloc (void)
+{
+  GArena *arena;
+  gchar *mem, *other;
+
+  arena = g_arena_new (0);
+
+  /* the most recent allocation grows in place */
+  mem = g_arena_alloc (arena, 16);
+  strcpy (mem, "in place");
+  g_assert (g_arena_realloc (arena, mem, 16, 64) == mem);
+  g_assert (g_arena_realloc (arena, mem, 64, 32) == mem);
+
+  /* ... others move */
+  other = g_arena_alloc (arena, 16);
+  mem = g_arena_realloc (arena, mem, 64, 128);
+  g_assert (mem != other);
+  g_assert_cmpstr (mem, ==, "in place");
+
+  /* ... also to a block of their own */
+  mem = g_arena_realloc (arena, mem, 128, 100000);
+  g_assert_cmpstr (mem, ==, "in place");
+  memset (mem + 128, 0, 100000 - 128);
+
+  g_assert_nonnull (g_arena_realloc (arena, NULL, 0, 8));
+
+  g_arena_free (arena);
+}
+
+static void
+test_string (void)
+{
+  GArena *arena;
+  GString *string, *other;
+  gchar *segment;
+  GBytes *bytes;
+  gint i;
+
+  arena = g_arena_new (0);
+
+  string = g_string_new_in_arena (arena, "hello");
+  g_assert_cmpstr (string->str, ==, "hello");
+  other = g_string_new_in_arena (arena, NULL);
+  g_assert_cmpstr (other->str, ==, "");
+
+  for (i = 0; i < 1000; i++)
+    {
+      g_string_append_printf (string, " %d", i);
+      g_string_append_c (other, 'a' + i % 26);
+    }
+
+  g_assert (g_str_has_prefix (string->str, "hello 0 1 2"));
+  g_assert (g_str_has_suffix (string->str, " 998 999"));
+  g_assert_cmpuint (other->len, ==, 1000);
+
+  bytes = g_string_free_to_bytes (other);
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, 1000);
+
+  segment = g_string_free (string, FALSE);
+  g_assert (g_str_has_prefix (segment, "hello"));
+
+  g_arena_free (arena);
+
+  /* it was copied out of the arena */
+  g_assert_cmpint (((const gchar *) g_bytes_get_data (bytes, NULL))[999], ==, 'a' + 999 % 26);
+  g_bytes_unref (bytes);
+}
+
+static void
+count_free (gpointer data)
+{
+  (*(gint *) data)++;
+}
+
+static void
+test_ptr_array (void)
+{
+  GArena *arena;
+  GPtrArray *array;
+  gint n_freed = 0;
+  gint i;
+
+  arena = g_arena_new (0);
+
+  array = g_ptr_array_new_in_arena (arena);
+  for (i = 0; i < 1000; i++)
+    g_ptr_array_add (array, GINT_TO_POINTER (i));
+  g_assert_cmpuint (array->len, ==, 1000);
+  for (i = 0; i < 1000; i++)
+    g_assert_cmpint (GPOINTER_TO_INT (g_ptr_array_index (array, i)), ==, i);
+
+  g_ptr_array_remove_index (array, 0);
+  g_assert_cmpint (GPOINTER_TO_INT (g_ptr_array_index (array, 0)), ==, 1);
+  g_ptr_array_unref (array);
+
+  /* element free functions run when the array is freed explicitly */
+  array = g_ptr_array_new_in_arena (arena);
+  g_ptr_array_set_free_func (array, count_free);
+  g_ptr_array_add (array, &n_freed);
+  g_ptr_array_add (array, &n_freed);
+  g_ptr_array_ref (array);
+  g_assert_null (g_ptr_array_free (array, TRUE));
+  g_assert_cmpint (n_freed, ==, 2);
+  g_ptr_array_add (array, &n_freed);
+  g_ptr_array_unref (array);
+  g_assert_cmpint (n_freed, ==, 3);
+
+  /* ... but not when it is left to the arena */
+  array = g_ptr_array_new_in_arena (arena);
+  g_ptr_array_set_free_func (array, count_free);
+  g_ptr_array_add (array, &n_freed);
+
+  g_arena_free (arena);
+  g_assert_cmpint (n_freed, ==, 3);
+}
+
+static void
+test_hash_table (void)
+{
+  GArena *arena;
+  GHashTable *table;
+  gint i;
+
+  arena = g_arena_new (0);
+
+  table = g_hash_table_new_in_arena (arena, g_str_hash, g_str_equal);
+
+  /* a set first, then a map, so the values get storage of their own */
+  for (i = 0; i < 100; i++)
+    {
+      gchar *key = g_arena_alloc (arena, 16);
+
+      g_snprintf (key, 16, "%d", i);
+      g_hash_table_add (table, key);
+    }
+  for (i = 100; i < 1000; i++)
+    {
+      gchar *key = g_arena_alloc (arena, 16);
+
+      g_snprintf (key, 16, "%d", i);
+      g_hash_table_insert (table, key, GINT_TO_POINTER (i));
+    }
+  g_assert_cmpuint (g_hash_table_size (table), ==, 1000);
+  g_assert (g_hash_table_contains (table, "42"));
+  g_assert_cmpint (GPOINTER_TO_INT (g_hash_table_lookup (table, "420")), ==, 420);
+
+  /* shrink again */
+  for (i = 0; i < 990; i++)
+    {
+      gchar key[16];
+
+      g_snprintf (key, 16, "%d", i);
+      g_assert (g_hash_table_remove (table, key));
+    }
+  g_assert_cmpuint (g_hash_table_size (table), ==, 10);
+  g_assert_cmpint (GPOINTER_TO_INT (g_hash_table_lookup (table, "995")), ==, 995);
+
+  g_hash_table_remove_all (table);
+  g_assert_cmpuint (g_hash_table_size (table), ==, 0);
+  g_hash_table_unref (table);
+
+  /* left to the arena */
+  table = g_hash_table_new_in_arena (arena, NULL, NULL);
+  g_hash_table_insert (table, arena, arena);
+
+  g_arena_free (arena);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/arena/alloc", test_alloc);
+  g_test_add_func ("/arena/realloc", test_realloc);
+  g_test_add_func ("/arena/string", test_string);
+  g_test_add_func ("/arena/ptr-array", test_ptr_array);
+  g_test_add_func ("/arena/hash-table", test_hash_table);
+
+  return g_test_run ();
+}
@@ -523,6 +523,74 @@ pointer_array_sort (void)
   g_ptr_array_free (gparray, TRUE);
 }
 
+static void
+pointer_array_inline (void)
+{
+  GPtrArray *gparray;
+  gpointer *segment;
+  gsize len;
+  gint i;
+
+  num_free_func_invocations = 0;
+  gparray = g_ptr_array_new_inline (4, my_free_func);
+  for (i = 0; i < 4; i++)
+    g_ptr_array_add (gparray, g_strdup_printf ("%d", i));
+  g_assert_cmpstr (g_ptr_array_index (gparray, 3), ==, "3");
+
+  /* spills to the heap */
+  for (i = 4; i < 100; i++)
+    g_ptr_array_add (gparray, g_strdup_printf ("%d", i));
+  for (i = 0; i < 100; i++)
+    g_assert_cmpint (atoi (g_ptr_array_index (gparray, i)), ==, i);
+
+  g_ptr_array_ref (gparray);
+  g_ptr_array_free (gparray, TRUE);
+  g_assert_cmpint (num_free_func_invocations, ==, 100);
+  g_assert_cmpuint (gparray->len, ==, 0);
+
+  /* ...and starts inline again */
+  g_ptr_array_add (gparray, g_strdup ("again"));
+  segment = g_ptr_array_steal (gparray, &len);
+  g_assert_cmpuint (len, ==, 1);
+  g_assert_cmpstr (segment[0], ==, "again");
+  g_assert_cmpuint (gparray->len, ==, 0);
+  g_free (segment[0]);
+  g_free (segment);
+
+  g_ptr_array_add (gparray, g_strdup ("kept"));
+  segment = g_ptr_array_free (gparray, FALSE);
+  g_assert_cmpstr (segment[0], ==, "kept");
+  g_free (segment[0]);
+  g_free (segment);
+  g_assert_cmpint (num_free_func_invocations, ==, 100);
+}
+
+static void
+pointer_array_steal (void)
+{
+  GPtrArray *gparray;
+  gpointer *segment;
+  gsize len;
+
+  num_free_func_invocations = 0;
+  gparray = g_ptr_array_new_with_free_func (my_free_func);
+  g_ptr_array_add (gparray, g_strdup ("foo"));
+  g_ptr_array_add (gparray, g_strdup ("bar"));
+
+  segment = g_ptr_array_steal (gparray, &len);
+  g_assert_cmpuint (len, ==, 2);
+  g_assert_cmpstr (segment[1], ==, "bar");
+  g_assert_cmpuint (gparray->len, ==, 0);
+
+  g_ptr_array_add (gparray, g_strdup ("baz"));
+  g_ptr_array_unref (gparray);
+  g_assert_cmpint (num_free_func_invocations, ==, 1);
+
+  g_free (segment[0]);
+  g_free (segment[1]);
+  g_free (segment);
+}
+
 static void
 pointer_array_sort_with_data (void)
 {
@@ -547,6 +615,34 @@ pointer_array_sort_with_data (void)
   g_ptr_array_free (gparray, TRUE);
 }
 
+static void
+array_steal (void)
+{
+  GArray *garray;
+  gint *segment;
+  gsize len;
+  gint i;
+
+  garray = g_array_new (TRUE, FALSE, sizeof (gint));
+  for (i = 0; i < 100; i++)
+    g_array_append_val (garray, i);
+
+  segment = g_array_steal (garray, &len);
+  g_assert_cmpuint (len, ==, 100);
+  for (i = 0; i < 100; i++)
+    g_assert_cmpint (segment[i], ==, i);
+  g_assert_cmpint (segment[100], ==, 0);
+
+  /* still zero-terminated, and usable */
+  g_assert_cmpuint (garray->len, ==, 0);
+  g_assert_cmpint (g_array_index (garray, gint, 0), ==, 0);
+  g_array_append_val (garray, i);
+  g_assert_cmpint (g_array_index (garray, gint, 0), ==, 100);
+
+  g_array_unref (garray);
+  g_free (segment);
+}
+
 static void
 byte_array_append (void)
 {
@@ -829,6 +925,54 @@ byte_array_free_to_bytes (void)
 
   g_bytes_unref (bytes);
 }
+
+static void
+byte_array_aligned (void)
+{
+  GByteArray *gbarray;
+  GBytes *bytes;
+  guint8 *data;
+  gsize size;
+  gint i;
+
+  data = g_aligned_alloc0 (10, 100, 64);
+  g_assert_cmpuint (GPOINTER_TO_SIZE (data) % 64, ==, 0);
+  for (i = 0; i < 1000; i++)
+    g_assert_cmpint (data[i], ==, 0);
+  g_aligned_free (data);
+
+  g_assert_null (g_aligned_alloc (0, 100, 64));
+  g_aligned_free (NULL);
+
+  gbarray = g_byte_array_sized_new_aligned (16, 32);
+  g_assert_cmpuint (GPOINTER_TO_SIZE (gbarray->data) % 32, ==, 0);
+
+  /* stays aligned as it grows */
+  for (i = 0; i < 10000; i++)
+    {
+      guint8 byte = i % 251;
+
+      g_byte_array_append (gbarray, &byte, 1);
+      g_assert_cmpuint (GPOINTER_TO_SIZE (gbarray->data) % 32, ==, 0);
+    }
+  for (i = 0; i < 10000; i++)
+    g_assert_cmpint (gbarray->data[i], ==, i % 251);
+
+  data = gbarray->data;
+  bytes = g_byte_array_free_to_bytes (gbarray);
+  g_assert (g_bytes_get_data (bytes, &size) == data);
+  g_assert_cmpuint (size, ==, 10000);
+  g_bytes_unref (bytes);
+
+  gbarray = g_byte_array_sized_new_aligned (0, 64);
+  g_byte_array_append (gbarray, (guint8 *)"hello", 5);
+  data = g_byte_array_free (gbarray, FALSE);
+  g_assert_cmpuint (GPOINTER_TO_SIZE (data) % 64, ==, 0);
+  bytes = g_bytes_new_take_aligned (data, 5);
+  g_assert (memcmp (g_bytes_get_data (bytes, NULL), "hello", 5) == 0);
+  g_bytes_unref (bytes);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -846,6 +990,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/array/sort", array_sort);
   g_test_add_func ("/array/sort-with-data", array_sort_with_data);
   g_test_add_func ("/array/clear-func", array_clear_func);
+  g_test_add_func ("/array/steal", array_steal);
 
   /* pointer arrays */
   g_test_add_func ("/pointerarray/add", pointer_array_add);
@@ -854,6 +999,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/pointerarray/free-func", pointer_array_free_func);
   g_test_add_func ("/pointerarray/sort", pointer_array_sort);
   g_test_add_func ("/pointerarray/sort-with-data", pointer_array_sort_with_data);
+  g_test_add_func ("/pointerarray/inline", pointer_array_inline);
+  g_test_add_func ("/pointerarray/steal", pointer_array_steal);
 
   /* byte arrays */
   g_test_add_func ("/bytearray/append", byte_array_append);
@@ -866,6 +1013,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/bytearray/sort-with-data", byte_array_sort_with_data);
   g_test_add_func ("/bytearray/new-take", byte_array_new_take);
   g_test_add_func ("/bytearray/free-to-bytes", byte_array_free_to_bytes);
+  g_test_add_func ("/bytearray/aligned", byte_array_aligned);
 
   return g_test_run ();
 }
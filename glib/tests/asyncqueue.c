@@ -266,6 +266,80 @@ test_async_queue_push_front (void)
   g_async_queue_unref (q);
 }
 
+static void
+test_async_queue_push_many (void)
+{
+  GAsyncQueue *q;
+  gpointer in[5];
+  gpointer out[8];
+  guint n, i;
+
+  q = g_async_queue_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (in); i++)
+    in[i] = GINT_TO_POINTER (i + 1);
+
+  g_async_queue_push (q, GINT_TO_POINTER (100));
+  g_async_queue_push_many (q, in, G_N_ELEMENTS (in));
+  g_assert_cmpint (g_async_queue_length (q), ==, 6);
+
+  n = g_async_queue_pop_many (q, out, 3);
+  g_assert_cmpuint (n, ==, 3);
+  g_assert_cmpint (GPOINTER_TO_INT (out[0]), ==, 100);
+  g_assert_cmpint (GPOINTER_TO_INT (out[1]), ==, 1);
+  g_assert_cmpint (GPOINTER_TO_INT (out[2]), ==, 2);
+
+  /* Only what is there is returned, without waiting for more */
+  n = g_async_queue_pop_many (q, out, G_N_ELEMENTS (out));
+  g_assert_cmpuint (n, ==, 3);
+  g_assert_cmpint (GPOINTER_TO_INT (out[0]), ==, 3);
+  g_assert_cmpint (GPOINTER_TO_INT (out[1]), ==, 4);
+  g_assert_cmpint (GPOINTER_TO_INT (out[2]), ==, 5);
+
+  n = g_async_queue_timeout_pop_many (q, out, G_N_ELEMENTS (out),
+                                      G_USEC_PER_SEC / 100);
+  g_assert_cmpuint (n, ==, 0);
+
+  g_async_queue_unref (q);
+}
+
+static gpointer
+pop_one_thread (gpointer data)
+{
+  return g_async_queue_pop (data);
+}
+
+static void
+test_async_queue_push_many_wakeup (void)
+{
+  GAsyncQueue *q;
+  GThread *threads[4];
+  gpointer in[G_N_ELEMENTS (threads)];
+  gint sum = 0;
+  guint i;
+
+  q = g_async_queue_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("pop", pop_one_thread, q);
+
+  /* Let all of them block, so that the push has to wake them up */
+  while (g_async_queue_length (q) > -(gint) G_N_ELEMENTS (threads))
+    g_usleep (1000);
+
+  for (i = 0; i < G_N_ELEMENTS (in); i++)
+    in[i] = GINT_TO_POINTER (i + 1);
+  g_async_queue_push_many (q, in, G_N_ELEMENTS (in));
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    sum += GPOINTER_TO_INT (g_thread_join (threads[i]));
+
+  g_assert_cmpint (sum, ==, 1 + 2 + 3 + 4);
+  g_assert_cmpint (g_async_queue_length (q), ==, 0);
+
+  g_async_queue_unref (q);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -277,6 +351,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/asyncqueue/timed", test_async_queue_timed);
   g_test_add_func ("/asyncqueue/remove", test_async_queue_remove);
   g_test_add_func ("/asyncqueue/push_front", test_async_queue_push_front);
+  g_test_add_func ("/asyncqueue/push-many", test_async_queue_push_many);
+  g_test_add_func ("/asyncqueue/push-many/wakeup", test_async_queue_push_many_wakeup);
 
   return g_test_run ();
 }
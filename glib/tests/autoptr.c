@@ -27,6 +27,13 @@ test_autofree (void)
     }
 }
 
+static void
+test_g_arena (void)
+{
+  g_autoptr(GArena) val = g_arena_new (0);
+  g_assert (val != NULL);
+}
+
 static void
 test_g_async_queue (void)
 {
@@ -48,6 +55,13 @@ test_g_bytes (void)
   g_assert (val != NULL);
 }
 
+static void
+test_g_bytes_chain (void)
+{
+  g_autoptr(GBytesChain) val = g_bytes_chain_new ();
+  g_assert (val != NULL);
+}
+
 static void
 test_g_checksum (void)
 {
@@ -83,6 +97,13 @@ test_g_hash_table (void)
   g_assert (val != NULL);
 }
 
+static void
+test_g_concurrent_hash_table (void)
+{
+  g_autoptr(GConcurrentHashTable) val = g_concurrent_hash_table_new (NULL, NULL);
+  g_assert (val != NULL);
+}
+
 static void
 test_g_hmac (void)
 {
@@ -235,6 +256,13 @@ test_g_rand (void)
   g_assert (val != NULL);
 }
 
+static void
+test_g_ref_string (void)
+{
+  g_autoptr(GRefString) val = g_ref_string_new ("hello");
+  g_assert (val != NULL);
+}
+
 static void
 test_g_regex (void)
 {
@@ -355,6 +383,13 @@ test_g_tree (void)
   g_assert (val != NULL);
 }
 
+static void
+test_g_btree (void)
+{
+  g_autoptr(GBTree) val = g_btree_new ((GCompareFunc)strcmp);
+  g_assert (val != NULL);
+}
+
 static void
 test_g_variant (void)
 {
@@ -411,14 +446,17 @@ main (int argc, gchar *argv[])
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/autoptr/autofree", test_autofree);
+  g_test_add_func ("/autoptr/g_arena", test_g_arena);
   g_test_add_func ("/autoptr/g_async_queue", test_g_async_queue);
   g_test_add_func ("/autoptr/g_bookmark_file", test_g_bookmark_file);
   g_test_add_func ("/autoptr/g_bytes", test_g_bytes);
+  g_test_add_func ("/autoptr/g_bytes_chain", test_g_bytes_chain);
   g_test_add_func ("/autoptr/g_checksum", test_g_checksum);
   g_test_add_func ("/autoptr/g_date_time", test_g_date_time);
   g_test_add_func ("/autoptr/g_dir", test_g_dir);
   g_test_add_func ("/autoptr/g_error", test_g_error);
   g_test_add_func ("/autoptr/g_hash_table", test_g_hash_table);
+  g_test_add_func ("/autoptr/g_concurrent_hash_table", test_g_concurrent_hash_table);
   g_test_add_func ("/autoptr/g_hmac", test_g_hmac);
   g_test_add_func ("/autoptr/g_io_channel", test_g_io_channel);
   g_test_add_func ("/autoptr/g_key_file", test_g_key_file);
@@ -437,6 +475,7 @@ main (int argc, gchar *argv[])
   g_test_add_func ("/autoptr/g_pattern_spec", test_g_pattern_spec);
   g_test_add_func ("/autoptr/g_queue", test_g_queue);
   g_test_add_func ("/autoptr/g_rand", test_g_rand);
+  g_test_add_func ("/autoptr/g_ref_string", test_g_ref_string);
   g_test_add_func ("/autoptr/g_regex", test_g_regex);
   g_test_add_func ("/autoptr/g_match_info", test_g_match_info);
   g_test_add_func ("/autoptr/g_scanner", test_g_scanner);
@@ -451,6 +490,7 @@ main (int argc, gchar *argv[])
   g_test_add_func ("/autoptr/g_timer", test_g_timer);
   g_test_add_func ("/autoptr/g_time_zone", test_g_time_zone);
   g_test_add_func ("/autoptr/g_tree", test_g_tree);
+  g_test_add_func ("/autoptr/g_btree", test_g_btree);
   g_test_add_func ("/autoptr/g_variant", test_g_variant);
   g_test_add_func ("/autoptr/g_variant_builder", test_g_variant_builder);
   g_test_add_func ("/autoptr/g_variant_iter", test_g_variant_iter);
@@ -406,6 +406,33 @@ test_base64_decode_smallblock (gconstpointer blocksize_p)
     }
 }
 
+static void
+test_base64_decode_skip (void)
+{
+  GString *noisy;
+  gchar *text;
+  guchar *decoded;
+  gsize decoded_len;
+  gsize i;
+
+  /* characters outside the alphabet land in the middle of blocks */
+  text = g_base64_encode (data, DATA_SIZE);
+  noisy = g_string_new (NULL);
+  for (i = 0; text[i]; i++)
+    {
+      g_string_append_c (noisy, text[i]);
+      if (i % 37 == 36)
+        g_string_append (noisy, i % 2 ? " " : "\r\n");
+    }
+
+  decoded = g_base64_decode (noisy->str, &decoded_len);
+  g_assert_cmpmem (decoded, decoded_len, data, DATA_SIZE);
+
+  g_free (decoded);
+  g_string_free (noisy, TRUE);
+  g_free (text);
+}
+
 
 int
 main (int argc, char *argv[])
@@ -445,6 +472,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/base64/decode", test_base64_decode);
   g_test_add_func ("/base64/decode-inplace", test_base64_decode_inplace);
   g_test_add_func ("/base64/encode-decode", test_base64_encode_decode);
+  g_test_add_func ("/base64/decode/skip", test_base64_decode_skip);
 
   g_test_add_data_func ("/base64/incremental/smallblock/1", GINT_TO_POINTER(1),
                         test_base64_decode_smallblock);
@@ -112,6 +112,73 @@ test_move_item (void)
   g_bookmark_file_free (bookmark);
 }
 
+static void
+test_many_applications (void)
+{
+  GBookmarkFile *bookmark, *copy;
+  const gchar *uri = "file:///tmp/a%20&%20b.txt";
+  gchar *data, *name, *exec;
+  gchar **apps;
+  gsize length, n_apps;
+  guint count;
+  gboolean res;
+  GError *error = NULL;
+  gint i;
+
+  bookmark = g_bookmark_file_new ();
+  g_bookmark_file_set_title (bookmark, uri, "Tom & Jerry");
+
+  /* enough applications for the item to index them by name */
+  for (i = 0; i < 20; i++)
+    {
+      name = g_strdup_printf ("app-%d", i);
+      exec = g_strdup_printf ("'%s' <%%u>", name);
+      g_bookmark_file_add_application (bookmark, uri, name, exec);
+      if (i % 2)
+        g_bookmark_file_add_application (bookmark, uri, name, exec);
+      g_free (exec);
+      g_free (name);
+    }
+
+  res = g_bookmark_file_remove_application (bookmark, uri, "app-3", &error);
+  g_assert_no_error (error);
+  g_assert (res);
+  g_assert (!g_bookmark_file_has_application (bookmark, uri, "app-3", NULL));
+  g_assert (g_bookmark_file_has_application (bookmark, uri, "app-4", NULL));
+
+  data = g_bookmark_file_to_data (bookmark, &length, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (length, ==, strlen (data));
+
+  copy = g_bookmark_file_new ();
+  res = g_bookmark_file_load_from_data (copy, data, length, &error);
+  g_assert_no_error (error);
+  g_assert (res);
+  g_free (data);
+
+  name = g_bookmark_file_get_title (copy, uri, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (name, ==, "Tom & Jerry");
+  g_free (name);
+
+  apps = g_bookmark_file_get_applications (copy, uri, &n_apps, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (n_apps, ==, 19);
+  g_assert_cmpstr (apps[0], ==, "app-0");
+  g_assert_cmpstr (apps[18], ==, "app-19");
+  g_strfreev (apps);
+
+  res = g_bookmark_file_get_app_info (copy, uri, "app-7", &exec, &count, NULL, &error);
+  g_assert_no_error (error);
+  g_assert (res);
+  g_assert_cmpstr (exec, ==, "'app-7' <file:///tmp/a%20&%20b.txt>");
+  g_assert_cmpuint (count, ==, 2);
+  g_free (exec);
+
+  g_bookmark_file_free (copy);
+  g_bookmark_file_free (bookmark);
+}
+
 static void
 test_misc (void)
 {
@@ -533,6 +600,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/bookmarks/load-from-data-dirs", test_load_from_data_dirs);
   g_test_add_func ("/bookmarks/to-file", test_to_file);
   g_test_add_func ("/bookmarks/move-item", test_move_item);
+  g_test_add_func ("/bookmarks/many-applications", test_many_applications);
   g_test_add_func ("/bookmarks/misc", test_misc);
 
   error = NULL;
@@ -0,0 +1,155 @@
+/* Unit tests for GBoundedQueue
+ *
+ * This work is provided "as is"; redistribution and modification
+ * in whole or in part, in any medium, physical or electronic is
+ * permitted without restriction.
+ *
+ * This work is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * In no event shall the authors or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ */
+
+#include <glib.h>
+
+static void
+test_basic (void)
+{
+  GBoundedQueue *q;
+  gint i;
+
+  q = g_bounded_queue_new (5);
+  g_assert_cmpuint (g_bounded_queue_get_capacity (q), ==, 8);
+  g_assert_cmpuint (g_bounded_queue_length (q), ==, 0);
+  g_assert_null (g_bounded_queue_try_pop (q));
+
+  for (i = 1; i <= 8; i++)
+    g_assert (g_bounded_queue_try_push (q, GINT_TO_POINTER (i)));
+  g_assert (!g_bounded_queue_try_push (q, GINT_TO_POINTER (9)));
+  g_assert_cmpuint (g_bounded_queue_length (q), ==, 8);
+
+  /* Wrap around the ring a few times */
+  for (i = 1; i <= 100; i++)
+    {
+      g_assert_cmpint (GPOINTER_TO_INT (g_bounded_queue_try_pop (q)), ==, i);
+      g_bounded_queue_push (q, GINT_TO_POINTER (i + 8));
+    }
+
+  for (i = 101; i <= 108; i++)
+    g_assert_cmpint (GPOINTER_TO_INT (g_bounded_queue_pop (q)), ==, i);
+  g_assert_null (g_bounded_queue_try_pop (q));
+  g_assert_cmpuint (g_bounded_queue_length (q), ==, 0);
+
+  g_assert (g_bounded_queue_ref (q) == q);
+  g_bounded_queue_unref (q);
+  g_bounded_queue_unref (q);
+}
+
+static void
+test_free_func (void)
+{
+  GBoundedQueue *q;
+
+  q = g_bounded_queue_new_full (4, g_free);
+  g_bounded_queue_push (q, g_strdup ("a"));
+  g_bounded_queue_push (q, g_strdup ("b"));
+  g_free (g_bounded_queue_pop (q));
+  g_bounded_queue_unref (q);
+}
+
+#define N_THREADS 4
+#define N_ITEMS 50000
+
+static GBoundedQueue *shared;
+static volatile gint producers_left;
+static volatile gint consumed_sum;
+
+static gpointer
+producer (gpointer data)
+{
+  gint base = GPOINTER_TO_INT (data) * N_ITEMS;
+  gint i;
+
+  for (i = 1; i <= N_ITEMS; i++)
+    g_bounded_queue_push (shared, GINT_TO_POINTER (base + i));
+
+  if (g_atomic_int_dec_and_test (&producers_left))
+    for (i = 0; i < N_THREADS; i++)
+      g_bounded_queue_push (shared, GINT_TO_POINTER (-1));
+
+  return NULL;
+}
+
+static gpointer
+consumer (gpointer data)
+{
+  gint last[N_THREADS] = { 0, };
+  gint count = 0;
+
+  while (TRUE)
+    {
+      gint item = GPOINTER_TO_INT (g_bounded_queue_pop (shared));
+      gint from;
+
+      if (item == -1)
+        break;
+
+      /* Items from each producer come out in order */
+      from = (item - 1) / N_ITEMS;
+      g_assert_cmpint (item, >, last[from]);
+      last[from] = item;
+      count++;
+    }
+
+  g_atomic_int_add (&consumed_sum, count);
+
+  return NULL;
+}
+
+static void
+test_threads (void)
+{
+  GThread *producers[N_THREADS];
+  GThread *consumers[N_THREADS];
+  gint i;
+
+  /* Small enough that producers have to wait for consumers */
+  shared = g_bounded_queue_new (16);
+  producers_left = N_THREADS;
+  consumed_sum = 0;
+
+  for (i = 0; i < N_THREADS; i++)
+    consumers[i] = g_thread_new ("consumer", consumer, NULL);
+  for (i = 0; i < N_THREADS; i++)
+    producers[i] = g_thread_new ("producer", producer, GINT_TO_POINTER (i));
+
+  for (i = 0; i < N_THREADS; i++)
+    g_thread_join (producers[i]);
+  for (i = 0; i < N_THREADS; i++)
+    g_thread_join (consumers[i]);
+
+  g_assert_cmpint (consumed_sum, ==, N_THREADS * N_ITEMS);
+  g_assert_cmpuint (g_bounded_queue_length (shared), ==, 0);
+
+  g_bounded_queue_unref (shared);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/boundedqueue/basic", test_basic);
+  g_test_add_func ("/boundedqueue/free-func", test_free_func);
+  g_test_add_func ("/boundedqueue/threads", test_threads);
+
+  return g_test_run ();
+}
@@ -0,0 +1,362 @@
+/* Unit tests for GBTree
+ *
+ * This work is provided "as is"; redistribution and modification
+ * in whole or in part, in any medium, physical or electronic is
+ * permitted without restriction.
+ *
+ * This work is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * In no event shall the authors or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ */
+
+#include <glib.h>
+
+static gint
+compare_int (gconstpointer a,
+             gconstpointer b,
+             gpointer      data)
+{
+  gint ia = GPOINTER_TO_INT (a);
+  gint ib = GPOINTER_TO_INT (b);
+
+  return (ia > ib) - (ia < ib);
+}
+
+static gint n_keys_freed;
+static gint n_values_freed;
+
+static void
+free_key (gpointer key)
+{
+  n_keys_freed++;
+  g_free (key);
+}
+
+static void
+free_value (gpointer value)
+{
+  n_values_freed++;
+  g_free (value);
+}
+
+typedef struct
+{
+  GBTreeIter iter;
+  gboolean   ok;
+} CheckData;
+
+static gboolean
+check_entry (gpointer key,
+             gpointer value,
+             gpointer user_data)
+{
+  CheckData *data = user_data;
+  gpointer k, v;
+
+  if (!g_btree_iter_next (&data->iter, &k, &v) || k != key || v != value)
+    {
+      data->ok = FALSE;
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* checks that @btree holds exactly what @reference does, in order */
+static void
+check_same (GBTree *btree,
+            GTree  *reference)
+{
+  CheckData data;
+
+  g_assert_cmpint (g_btree_nnodes (btree), ==, g_tree_nnodes (reference));
+
+  g_btree_iter_init (&data.iter, btree);
+  data.ok = TRUE;
+  g_tree_foreach (reference, check_entry, &data);
+  g_assert (data.ok);
+  g_assert (!g_btree_iter_next (&data.iter, NULL, NULL));
+}
+
+static void
+test_random (void)
+{
+  GBTree *btree;
+  GTree *reference;
+  gint i;
+
+  btree = g_btree_new_full (compare_int, NULL, NULL, NULL);
+  reference = g_tree_new_full (compare_int, NULL, NULL, NULL);
+
+  g_assert_cmpint (g_btree_height (btree), ==, 0);
+
+  for (i = 0; i < 100000; i++)
+    {
+      gint key = g_test_rand_int_range (0, 5000);
+      gint value = g_test_rand_int ();
+
+      if (g_test_rand_int_range (0, 3) > 0)
+        {
+          g_btree_insert (btree, GINT_TO_POINTER (key), GINT_TO_POINTER (value));
+          g_tree_insert (reference, GINT_TO_POINTER (key), GINT_TO_POINTER (value));
+        }
+      else
+        g_assert (g_btree_remove (btree, GINT_TO_POINTER (key)) ==
+                  g_tree_remove (reference, GINT_TO_POINTER (key)));
+
+      if (i % 10000 == 0)
+        check_same (btree, reference);
+    }
+
+  check_same (btree, reference);
+
+  for (i = -1; i <= 5000; i++)
+    {
+      gpointer orig_key, value;
+      gboolean found;
+
+      found = g_btree_lookup_extended (btree, GINT_TO_POINTER (i), &orig_key, &value);
+      g_assert (found == g_tree_lookup_extended (reference, GINT_TO_POINTER (i), NULL, NULL));
+      if (found)
+        {
+          g_assert_cmpint (GPOINTER_TO_INT (orig_key), ==, i);
+          g_assert (value == g_tree_lookup (reference, GINT_TO_POINTER (i)));
+          g_assert (g_btree_lookup (btree, GINT_TO_POINTER (i)) == value);
+        }
+    }
+
+  /* a few thousand entries need no more than four levels */
+  g_assert_cmpint (g_btree_height (btree), >=, 3);
+  g_assert_cmpint (g_btree_height (btree), <=, 4);
+
+  /* drain it again, in random order */
+  while (g_tree_nnodes (reference) > 0)
+    {
+      gint key = g_test_rand_int_range (0, 5000);
+
+      g_assert (g_btree_remove (btree, GINT_TO_POINTER (key)) ==
+                g_tree_remove (reference, GINT_TO_POINTER (key)));
+    }
+
+  check_same (btree, reference);
+  g_assert_cmpint (g_btree_height (btree), ==, 0);
+
+  g_btree_unref (btree);
+  g_tree_unref (reference);
+}
+
+static void
+test_destroy (void)
+{
+  GBTree *btree;
+  gpointer stolen_key, stolen_value;
+  gint i;
+
+  n_keys_freed = n_values_freed = 0;
+
+  btree = g_btree_new_full ((GCompareDataFunc) g_strcmp0, NULL, free_key, free_value);
+
+  for (i = 0; i < 1000; i++)
+    g_btree_insert (btree, g_strdup_printf ("%04d", i), g_strdup_printf ("%d", i));
+  g_assert_cmpint (g_btree_nnodes (btree), ==, 1000);
+
+  /* insert keeps the old key and frees the new one */
+  g_btree_insert (btree, g_strdup ("0001"), g_strdup ("one"));
+  g_assert_cmpint (n_keys_freed, ==, 1);
+  g_assert_cmpint (n_values_freed, ==, 1);
+  g_assert_cmpstr (g_btree_lookup (btree, "0001"), ==, "one");
+
+  /* replace keeps the new key and frees the old one */
+  for (i = 0; i < 1000; i += 7)
+    {
+      gchar *key = g_strdup_printf ("%04d", i);
+      gpointer orig_key;
+
+      g_btree_replace (btree, key, g_strdup ("replaced"));
+      g_assert (g_btree_lookup_extended (btree, key, &orig_key, NULL));
+      g_assert (orig_key == key);
+    }
+  g_assert_cmpint (n_keys_freed, ==, 144);
+  g_assert_cmpint (n_values_freed, ==, 144);
+
+  /* removing replaced keys must not leave them behind anywhere */
+  for (i = 0; i < 1000; i += 7)
+    {
+      gchar *key = g_strdup_printf ("%04d", i);
+
+      g_assert (g_btree_remove (btree, key));
+      g_assert (!g_btree_remove (btree, key));
+      g_assert_null (g_btree_lookup (btree, key));
+      g_free (key);
+    }
+  g_assert_cmpint (n_keys_freed, ==, 287);
+  g_assert_cmpint (n_values_freed, ==, 287);
+  g_assert_cmpint (g_btree_nnodes (btree), ==, 857);
+
+  for (i = 0; i < 1000; i++)
+    {
+      gchar *key = g_strdup_printf ("%04d", i);
+
+      g_assert ((g_btree_lookup (btree, key) != NULL) == (i % 7 != 0));
+      g_free (key);
+    }
+
+  g_assert (g_btree_lookup_extended (btree, "0002", &stolen_key, &stolen_value));
+  g_assert (g_btree_steal (btree, "0002"));
+  g_assert (!g_btree_steal (btree, "0002"));
+  g_assert_cmpint (n_keys_freed, ==, 287);
+  g_assert_cmpint (n_values_freed, ==, 287);
+  g_free (stolen_key);
+  g_free (stolen_value);
+
+  g_btree_remove_all (btree);
+  g_assert_cmpint (g_btree_nnodes (btree), ==, 0);
+  g_assert_cmpint (n_keys_freed, ==, 287 + 856);
+  g_assert_cmpint (n_values_freed, ==, 287 + 856);
+
+  g_btree_insert (btree, g_strdup ("a"), g_strdup ("b"));
+  g_btree_unref (btree);
+  g_assert_cmpint (n_keys_freed, ==, 287 + 857);
+}
+
+static void
+test_range (void)
+{
+  GBTree *btree;
+  GBTreeIter iter;
+  gpointer key, value;
+  gint i, expected;
+
+  btree = g_btree_new_full (compare_int, NULL, NULL, NULL);
+
+  /* even numbers from 0 to 19998 */
+  for (i = 0; i < 10000; i++)
+    g_btree_insert (btree, GINT_TO_POINTER (i * 2), GINT_TO_POINTER (i));
+
+  g_btree_iter_init_at (&iter, btree, GINT_TO_POINTER (1001));
+  expected = 1002;
+  while (g_btree_iter_next (&iter, &key, &value) && GPOINTER_TO_INT (key) <= 3000)
+    {
+      g_assert_cmpint (GPOINTER_TO_INT (key), ==, expected);
+      g_assert_cmpint (GPOINTER_TO_INT (value), ==, expected / 2);
+      expected += 2;
+    }
+  g_assert_cmpint (expected, ==, 3002);
+
+  g_btree_iter_init_at (&iter, btree, GINT_TO_POINTER (500));
+  g_assert (g_btree_iter_next (&iter, &key, NULL));
+  g_assert_cmpint (GPOINTER_TO_INT (key), ==, 500);
+
+  g_btree_iter_init_at (&iter, btree, GINT_TO_POINTER (-5));
+  g_assert (g_btree_iter_next (&iter, &key, NULL));
+  g_assert_cmpint (GPOINTER_TO_INT (key), ==, 0);
+
+  g_btree_iter_init_at (&iter, btree, GINT_TO_POINTER (19998));
+  g_assert (g_btree_iter_next (&iter, &key, NULL));
+  g_assert_cmpint (GPOINTER_TO_INT (key), ==, 19998);
+  g_assert (!g_btree_iter_next (&iter, &key, NULL));
+
+  g_btree_iter_init_at (&iter, btree, GINT_TO_POINTER (19999));
+  g_assert (!g_btree_iter_next (&iter, &key, NULL));
+
+  g_btree_remove_all (btree);
+  g_btree_iter_init_at (&iter, btree, GINT_TO_POINTER (1));
+  g_assert (!g_btree_iter_next (&iter, &key, NULL));
+  g_btree_iter_init (&iter, btree);
+  g_assert (!g_btree_iter_next (&iter, &key, NULL));
+
+  g_btree_unref (btree);
+}
+
+static void
+test_load_sorted (void)
+{
+  gsize sizes[] = { 0, 1, 15, 16, 17, 240, 241, 1000, 100000 };
+  gsize s;
+
+  for (s = 0; s < G_N_ELEMENTS (sizes); s++)
+    {
+      gsize n = sizes[s];
+      gpointer *keys = g_new (gpointer, n + 1);
+      gpointer *values = g_new (gpointer, n + 1);
+      GBTree *btree;
+      GTree *reference;
+      gsize i;
+
+      btree = g_btree_new_full (compare_int, NULL, NULL, NULL);
+      reference = g_tree_new_full (compare_int, NULL, NULL, NULL);
+
+      for (i = 0; i < n; i++)
+        {
+          keys[i] = GINT_TO_POINTER (i * 3);
+          values[i] = GINT_TO_POINTER (i);
+          g_tree_insert (reference, keys[i], values[i]);
+        }
+
+      g_btree_load_sorted (btree, keys, values, n);
+      check_same (btree, reference);
+
+      for (i = 0; i < n; i++)
+        g_assert (g_btree_lookup (btree, GINT_TO_POINTER (i * 3)) == GINT_TO_POINTER (i));
+
+      /* the tree stays usable afterwards */
+      for (i = 0; i < n; i += 2)
+        {
+          g_btree_insert (btree, GINT_TO_POINTER (i * 3 + 1), NULL);
+          g_tree_insert (reference, GINT_TO_POINTER (i * 3 + 1), NULL);
+        }
+      for (i = 0; i < n; i += 3)
+        {
+          g_assert (g_btree_remove (btree, GINT_TO_POINTER (i * 3)));
+          g_tree_remove (reference, GINT_TO_POINTER (i * 3));
+        }
+      check_same (btree, reference);
+
+      g_btree_unref (btree);
+      g_tree_unref (reference);
+      g_free (keys);
+      g_free (values);
+    }
+}
+
+static void
+test_load_unsorted (void)
+{
+  if (g_test_subprocess ())
+    {
+      gpointer keys[] = { GINT_TO_POINTER (1), GINT_TO_POINTER (3), GINT_TO_POINTER (2) };
+      GBTree *btree = g_btree_new_full (compare_int, NULL, NULL, NULL);
+
+      g_btree_load_sorted (btree, keys, NULL, G_N_ELEMENTS (keys));
+      g_assert_cmpint (g_btree_nnodes (btree), ==, 0);
+      g_btree_unref (btree);
+      return;
+    }
+
+  g_test_trap_subprocess (NULL, 0, 0);
+  g_test_trap_assert_failed ();
+  g_test_trap_assert_stderr ("*not in strictly ascending order*");
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/btree/random", test_random);
+  g_test_add_func ("/btree/destroy", test_destroy);
+  g_test_add_func ("/btree/range", test_range);
+  g_test_add_func ("/btree/load-sorted", test_load_sorted);
+  g_test_add_func ("/btree/load-unsorted", test_load_unsorted);
+
+  return g_test_run ();
+}
@@ -118,6 +118,33 @@ test_new_with_free_func (void)
   g_assert_cmpuint (count, ==, 1);
 }
 
+static void
+test_new_from_bytes_slice (void)
+{
+  const gchar *data = "smile and wave";
+  GBytes *bytes;
+  GBytes *sub;
+  GBytes *subsub;
+  gint count = 0;
+
+  bytes = g_bytes_new_with_free_func (data, 14, on_destroy_increment, &count);
+  sub = g_bytes_new_from_bytes (bytes, 6, 8);
+  subsub = g_bytes_new_from_bytes (sub, 4, 4);
+  g_bytes_unref (bytes);
+  g_bytes_unref (sub);
+  g_assert_cmpint (count, ==, 0);
+
+  g_assert (g_bytes_get_data (subsub, NULL) == data + 10);
+  g_assert_cmpmem (g_bytes_get_data (subsub, NULL), g_bytes_get_size (subsub), "wave", 4);
+
+  sub = g_bytes_new_from_bytes (subsub, 1, 0);
+  g_assert_cmpuint (g_bytes_get_size (sub), ==, 0);
+  g_bytes_unref (sub);
+
+  g_bytes_unref (subsub);
+  g_assert_cmpint (count, ==, 1);
+}
+
 static void
 test_hash (void)
 {
@@ -336,6 +363,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/bytes/new-static", test_new_static);
   g_test_add_func ("/bytes/new-with-free-func", test_new_with_free_func);
   g_test_add_func ("/bytes/new-from-bytes", test_new_from_bytes);
+  g_test_add_func ("/bytes/new-from-bytes-slice", test_new_from_bytes_slice);
   g_test_add_func ("/bytes/hash", test_hash);
   g_test_add_func ("/bytes/equal", test_equal);
   g_test_add_func ("/bytes/compare", test_compare);
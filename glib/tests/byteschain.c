@@ -0,0 +1,237 @@
+/* Unit tests for GBytesChain
+ *
+ * This work is provided "as is"; redistribution and modification
+ * in whole or in part, in any medium, physical or electronic is
+ * permitted without restriction.
+ *
+ * This work is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * In no event shall the authors or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ */
+
+
+#include <glib.h>
+#include <string.h>
+
+/* a chain of "0123456789" split over segments of 1, 2, 3 and 4 bytes */
+static GBytesChain *
+make_chain (void)
+{
+  const gchar *digits = "0123456789";
+  GBytesChain *chain = g_bytes_chain_new ();
+  GBytes *bytes;
+  gint i, offset = 0;
+
+  for (i = 1; i <= 4; i++)
+    {
+      bytes = g_bytes_new (digits + offset, i);
+      g_bytes_chain_append (chain, bytes);
+      g_bytes_unref (bytes);
+      offset += i;
+    }
+
+  /* empty bytes are not kept */
+  bytes = g_bytes_new (NULL, 0);
+  g_bytes_chain_append (chain, bytes);
+  g_bytes_unref (bytes);
+
+  return chain;
+}
+
+static void
+assert_contents (GBytesChain *chain,
+                 const gchar *expected)
+{
+  gsize len = strlen (expected);
+  gchar *buffer = g_malloc0 (len + 1);
+  GBytes *flat;
+
+  g_assert_cmpuint (g_bytes_chain_get_size (chain), ==, len);
+  g_assert_cmpuint (g_bytes_chain_peek (chain, buffer, len + 1), ==, len);
+  g_assert_cmpstr (buffer, ==, expected);
+
+  flat = g_bytes_chain_flatten (chain);
+  g_assert_cmpuint (g_bytes_get_size (flat), ==, len);
+  g_assert (memcmp (g_bytes_get_data (flat, NULL), expected, len) == 0);
+  g_bytes_unref (flat);
+
+  g_free (buffer);
+}
+
+static void
+test_basic (void)
+{
+  GBytesChain *chain = make_chain ();
+  gconstpointer data;
+  gsize size;
+  gchar buffer[4];
+
+  g_assert_cmpuint (g_bytes_chain_get_n_segments (chain), ==, 4);
+  assert_contents (chain, "0123456789");
+
+  data = g_bytes_chain_get_segment (chain, 2, &size);
+  g_assert_cmpuint (size, ==, 3);
+  g_assert (memcmp (data, "345", 3) == 0);
+
+  g_assert_cmpuint (g_bytes_chain_peek (chain, buffer, 4), ==, 4);
+  g_assert (memcmp (buffer, "0123", 4) == 0);
+
+  /* the cursor moves into a segment */
+  g_bytes_chain_skip (chain, 2);
+  g_assert_cmpuint (g_bytes_chain_get_n_segments (chain), ==, 3);
+  data = g_bytes_chain_get_segment (chain, 0, &size);
+  g_assert_cmpuint (size, ==, 1);
+  g_assert (memcmp (data, "2", 1) == 0);
+  assert_contents (chain, "23456789");
+
+  g_bytes_chain_skip (chain, 0);
+  assert_contents (chain, "23456789");
+  g_bytes_chain_skip (chain, 8);
+  g_assert_cmpuint (g_bytes_chain_get_n_segments (chain), ==, 0);
+  assert_contents (chain, "");
+
+  g_bytes_chain_unref (chain);
+}
+
+static void
+test_pop (void)
+{
+  GBytesChain *chain = make_chain ();
+  GBytes *head, *bytes;
+  gconstpointer segment;
+  gsize size;
+
+  /* within the first segment, the data is not copied */
+  g_bytes_chain_skip (chain, 3);
+  segment = g_bytes_chain_get_segment (chain, 0, &size);
+  bytes = g_bytes_chain_pop (chain, 2);
+  g_assert (g_bytes_get_data (bytes, NULL) == segment);
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, 2);
+  assert_contents (chain, "56789");
+
+  /* put it back */
+  g_bytes_chain_prepend (chain, bytes);
+  g_bytes_unref (bytes);
+  assert_contents (chain, "3456789");
+
+  /* spanning segments copies */
+  bytes = g_bytes_chain_pop (chain, 5);
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, 5);
+  g_assert (memcmp (g_bytes_get_data (bytes, NULL), "34567", 5) == 0);
+  g_bytes_unref (bytes);
+  assert_contents (chain, "89");
+
+  bytes = g_bytes_chain_pop (chain, 0);
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, 0);
+  g_bytes_unref (bytes);
+
+  /* a whole segment is handed out as it is */
+  head = g_bytes_new ("ab", 2);
+  g_bytes_chain_prepend (chain, head);
+  bytes = g_bytes_chain_pop (chain, 2);
+  g_assert (bytes == head);
+  g_bytes_unref (bytes);
+  g_bytes_unref (head);
+  assert_contents (chain, "89");
+
+  g_bytes_chain_unref (chain);
+}
+
+static void
+test_split (void)
+{
+  GBytesChain *chain = make_chain ();
+  GBytesChain *front, *other;
+  GBytes *bytes;
+  gsize size;
+
+  front = g_bytes_chain_split (chain, 4);
+  assert_contents (front, "0123");
+  assert_contents (chain, "456789");
+  g_assert_cmpuint (g_bytes_chain_get_n_segments (front), ==, 3);
+  g_assert_cmpuint (g_bytes_chain_get_n_segments (chain), ==, 2);
+
+  /* concatenation shares the segments */
+  g_bytes_chain_append_chain (front, chain);
+  assert_contents (front, "0123456789");
+  assert_contents (chain, "456789");
+
+  other = g_bytes_chain_split (front, 0);
+  assert_contents (other, "");
+  g_bytes_chain_unref (other);
+
+  other = g_bytes_chain_split (front, 10);
+  assert_contents (other, "0123456789");
+  assert_contents (front, "");
+  g_bytes_chain_unref (other);
+
+  /* a single segment flattens without copying */
+  g_bytes_chain_skip (chain, 2);
+  g_assert_cmpuint (g_bytes_chain_get_n_segments (chain), ==, 1);
+  bytes = g_bytes_chain_flatten (chain);
+  g_assert (g_bytes_get_data (bytes, NULL) == g_bytes_chain_get_segment (chain, 0, &size));
+  g_bytes_unref (bytes);
+
+  g_bytes_chain_skip (chain, 1);
+  bytes = g_bytes_chain_flatten (chain);
+  g_assert (g_bytes_get_data (bytes, NULL) == g_bytes_chain_get_segment (chain, 0, &size));
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, 3);
+  g_bytes_unref (bytes);
+
+  g_bytes_chain_unref (front);
+  g_bytes_chain_unref (chain);
+}
+
+static void
+test_many (void)
+{
+  GBytesChain *chain = g_bytes_chain_new ();
+  GString *expected = g_string_new (NULL);
+  gint i;
+
+  /* appending and consuming keeps reusing the same segment slots */
+  for (i = 0; i < 1000; i++)
+    {
+      gchar *str = g_strdup_printf ("%d,", i);
+      GBytes *bytes = g_bytes_new_take (str, strlen (str));
+
+      g_bytes_chain_append (chain, bytes);
+      g_string_append (expected, str);
+      g_bytes_unref (bytes);
+
+      if (i % 3 == 0)
+        {
+          gsize n = MIN (5, expected->len);
+
+          g_bytes_chain_skip (chain, n);
+          g_string_erase (expected, 0, n);
+        }
+    }
+
+  assert_contents (chain, expected->str);
+
+  g_string_free (expected, TRUE);
+  g_bytes_chain_unref (chain);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/bytes-chain/basic", test_basic);
+  g_test_add_func ("/bytes-chain/pop", test_pop);
+  g_test_add_func ("/bytes-chain/split", test_split);
+  g_test_add_func ("/bytes-chain/many", test_many);
+
+  return g_test_run ();
+}
@@ -1176,6 +1176,28 @@ test_unsupported (void)
   g_assert (g_checksum_new (20) == NULL);
 }
 
+/* Many blocks at once take a different path from single blocks */
+static void
+test_sha256_large (void)
+{
+  GChecksum *checksum;
+  guint8 *data;
+  gsize i, offset, chunk;
+
+  data = g_malloc (100000);
+  for (i = 0; i < 100000; i++)
+    data[i] = i * 7 + 3;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  for (offset = 0, chunk = 1; offset < 100000; offset += chunk, chunk = chunk * 3 + 1)
+    g_checksum_update (checksum, data + offset, MIN (chunk, 100000 - offset));
+  g_assert_cmpstr (g_checksum_get_string (checksum), ==,
+                   "d96bab6a55ee326ba206dd4a85a6e95e14360d7fabbf448f03e689c24382b7d0");
+  g_checksum_free (checksum);
+
+  g_free (data);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -1184,6 +1206,7 @@ main (int argc, char *argv[])
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/checksum/unsupported", test_unsupported);
+  g_test_add_func ("/checksum/SHA256/large", test_sha256_large);
 
   for (length = 0; length <= FIXED_LEN; length++)
     add_checksum_test (G_CHECKSUM_MD5, "MD5", MD5_sums[length], length);
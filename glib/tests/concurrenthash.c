@@ -0,0 +1,178 @@
+/* Unit tests for GConcurrentHashTable
+ *
+ * This work is provided "as is"; redistribution and modification
+ * in whole or in part, in any medium, physical or electronic is
+ * permitted without restriction.
+ *
+ * This work is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * In no event shall the authors or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ */
+
+#include <glib.h>
+
+static gint n_keys_freed;
+static gint n_values_freed;
+
+static void
+free_key (gpointer key)
+{
+  g_atomic_int_inc (&n_keys_freed);
+  g_free (key);
+}
+
+static void
+free_value (gpointer value)
+{
+  g_atomic_int_inc (&n_values_freed);
+  g_free (value);
+}
+
+static gpointer
+copy_string (gconstpointer src,
+             gpointer      data)
+{
+  return g_strdup (src);
+}
+
+static void
+count_entry (gpointer key,
+             gpointer value,
+             gpointer user_data)
+{
+  g_assert_cmpstr (key, ==, value);
+  (*(gint *) user_data)++;
+}
+
+static void
+test_basic (void)
+{
+  GConcurrentHashTable *table;
+  GHashTable *snapshot;
+  gchar *value;
+  gint n_visited = 0;
+  gint i;
+
+  n_keys_freed = n_values_freed = 0;
+
+  table = g_concurrent_hash_table_new_full (g_str_hash, g_str_equal, free_key, free_value);
+
+  for (i = 0; i < 1000; i++)
+    g_assert (g_concurrent_hash_table_insert (table, g_strdup_printf ("%d", i), g_strdup_printf ("%d", i)));
+  g_assert_cmpuint (g_concurrent_hash_table_size (table), ==, 1000);
+
+  g_assert_cmpstr (g_concurrent_hash_table_lookup (table, "42"), ==, "42");
+  g_assert_null (g_concurrent_hash_table_lookup (table, "1000"));
+  g_assert (g_concurrent_hash_table_contains (table, "999"));
+  g_assert (!g_concurrent_hash_table_contains (table, "-1"));
+
+  /* insert keeps the old key, replace the new one */
+  g_assert (!g_concurrent_hash_table_insert (table, g_strdup ("1"), g_strdup ("1")));
+  g_assert_cmpint (n_keys_freed, ==, 1);
+  g_assert_cmpint (n_values_freed, ==, 1);
+  g_assert (!g_concurrent_hash_table_replace (table, g_strdup ("2"), g_strdup ("2")));
+  g_assert_cmpint (n_keys_freed, ==, 2);
+  g_assert_cmpint (n_values_freed, ==, 2);
+
+  value = g_concurrent_hash_table_lookup_copy (table, "7", copy_string, NULL);
+  g_assert_cmpstr (value, ==, "7");
+  g_assert (g_concurrent_hash_table_remove (table, "7"));
+  g_assert (!g_concurrent_hash_table_remove (table, "7"));
+  g_assert_cmpint (n_keys_freed, ==, 3);
+  g_assert_cmpstr (value, ==, "7");
+  g_free (value);
+  g_assert_null (g_concurrent_hash_table_lookup_copy (table, "7", copy_string, NULL));
+
+  g_concurrent_hash_table_foreach (table, count_entry, &n_visited);
+  g_assert_cmpint (n_visited, ==, 999);
+
+  snapshot = g_concurrent_hash_table_snapshot (table, copy_string, copy_string, NULL);
+  g_assert_cmpuint (g_hash_table_size (snapshot), ==, 999);
+  g_assert_cmpstr (g_hash_table_lookup (snapshot, "500"), ==, "500");
+
+  g_concurrent_hash_table_remove_all (table);
+  g_assert_cmpuint (g_concurrent_hash_table_size (table), ==, 0);
+  g_assert_cmpint (n_keys_freed, ==, 1002);
+  g_assert_cmpint (n_values_freed, ==, 1002);
+
+  /* the snapshot owns copies */
+  g_assert_cmpstr (g_hash_table_lookup (snapshot, "500"), ==, "500");
+  g_hash_table_unref (snapshot);
+  g_assert_cmpint (n_keys_freed, ==, 2001);
+
+  g_concurrent_hash_table_insert (table, g_strdup ("a"), g_strdup ("a"));
+  g_concurrent_hash_table_unref (table);
+  g_assert_cmpint (n_keys_freed, ==, 2002);
+  g_assert_cmpint (n_values_freed, ==, 2002);
+}
+
+#define N_THREADS 8
+#define N_KEYS 10000
+
+static GConcurrentHashTable *shared_table;
+
+static gpointer
+thread_func (gpointer data)
+{
+  gint id = GPOINTER_TO_INT (data);
+  gint i;
+
+  for (i = 0; i < N_KEYS; i++)
+    {
+      /* private keys, and keys that all threads fight over */
+      gint own = id * N_KEYS + i;
+      gint common = N_THREADS * N_KEYS + i % 100;
+
+      g_concurrent_hash_table_insert (shared_table, GINT_TO_POINTER (own), GINT_TO_POINTER (own));
+      g_assert_cmpint (GPOINTER_TO_INT (g_concurrent_hash_table_lookup (shared_table, GINT_TO_POINTER (own))), ==, own);
+
+      g_concurrent_hash_table_replace (shared_table, GINT_TO_POINTER (common), GINT_TO_POINTER (id));
+      g_assert (g_concurrent_hash_table_contains (shared_table, GINT_TO_POINTER (common)));
+
+      if (i % 2)
+        g_assert (g_concurrent_hash_table_remove (shared_table, GINT_TO_POINTER (own)));
+    }
+
+  return NULL;
+}
+
+static void
+test_threads (void)
+{
+  GThread *threads[N_THREADS];
+  gint i;
+
+  shared_table = g_concurrent_hash_table_new (g_direct_hash, g_direct_equal);
+
+  for (i = 0; i < N_THREADS; i++)
+    threads[i] = g_thread_new ("concurrenthash", thread_func, GINT_TO_POINTER (i));
+  for (i = 0; i < N_THREADS; i++)
+    g_thread_join (threads[i]);
+
+  g_assert_cmpuint (g_concurrent_hash_table_size (shared_table), ==, N_THREADS * N_KEYS / 2 + 100);
+
+  for (i = 0; i < N_THREADS * N_KEYS; i++)
+    g_assert (g_concurrent_hash_table_contains (shared_table, GINT_TO_POINTER (i)) == (i % 2 == 0));
+
+  g_concurrent_hash_table_unref (shared_table);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/concurrent-hash/basic", test_basic);
+  g_test_add_func ("/concurrent-hash/threads", test_threads);
+
+  return g_test_run ();
+}
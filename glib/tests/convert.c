@@ -700,6 +700,92 @@ test_no_conv (void)
   g_error_free (error);
 }
 
+/* Conversions between UTF-8 and a few common codesets don't go
+ * through iconv; check that they behave exactly as iconv does.
+ */
+static void
+check_builtin_conversion (const gchar *str,
+                          gssize       len,
+                          const gchar *to_codeset,
+                          const gchar *from_codeset)
+{
+  GIConv cd;
+  gchar *expected, *out;
+  gsize expected_read, expected_written, bytes_read, bytes_written;
+  GError *expected_error = NULL, *error = NULL;
+  gint pass;
+
+  cd = g_iconv_open (to_codeset, from_codeset);
+  g_assert (cd != (GIConv) -1);
+
+  for (pass = 0; pass < 2; pass++)
+    {
+      /* first with bytes_read, then without */
+      expected_read = bytes_read = 0;
+      expected_written = bytes_written = 0;
+      expected = g_convert_with_iconv (str, len, cd,
+                                       pass == 0 ? &expected_read : NULL,
+                                       &expected_written, &expected_error);
+      out = g_convert (str, len, to_codeset, from_codeset,
+                       pass == 0 ? &bytes_read : NULL,
+                       &bytes_written, &error);
+
+      if (expected_error)
+        {
+          g_assert_error (error, expected_error->domain, expected_error->code);
+          g_assert_null (out);
+        }
+      else
+        {
+          g_assert_no_error (error);
+          g_assert_cmpuint (bytes_written, ==, expected_written);
+          g_assert (memcmp (out, expected, bytes_written + 2) == 0);
+        }
+      g_assert_cmpuint (bytes_read, ==, expected_read);
+
+      g_clear_error (&expected_error);
+      g_clear_error (&error);
+      g_free (expected);
+      g_free (out);
+      g_iconv (cd, NULL, NULL, NULL, NULL);
+    }
+
+  g_iconv_close (cd);
+}
+
+static void
+test_builtin_conversions (void)
+{
+  const struct {
+    const gchar *str;
+    gssize       len;
+    const gchar *to_codeset;
+    const gchar *from_codeset;
+  } tests[] = {
+    { "plain ascii text that is long enough for the word-sized loop", -1, "ISO-8859-1", "UTF-8" },
+    { "caf\xc3\xa9 \xc2\xbd \xc3\xbf", -1, "ISO-8859-1", "UTF-8" },
+    { "caf\xe9 \xbd \xff and more ascii afterwards", -1, "UTF-8", "ISO-8859-1" },
+    { "\xe2\x82\xac", -1, "ISO-8859-1", "UTF-8" },
+    { "\xe2\x82\xac", -1, "ASCII", "UTF-8" },
+    { "abc\xe9", -1, "UTF-8", "US-ASCII" },
+    { "abc\xc3", -1, "ISO-8859-1", "UTF-8" },
+    { "abc\xc0\x80", -1, "UTF-8", "UTF-8" },
+    { "abc\xed\xa0\x80", -1, "UTF-16LE", "UTF-8" },
+    { "a\xc3\xa9\xe2\x82\xac\xf0\x9d\x84\x9e", -1, "UTF-16LE", "UTF-8" },
+    { "a\xc3\xa9\xe2\x82\xac\xf0\x9d\x84\x9e", -1, "UTF-16BE", "UTF-8" },
+    { "a\0\xe9\0\xac\x20\x34\xd8\x1e\xdd", 10, "UTF-8", "UTF-16LE" },
+    { "\0a\0\xe9\x20\xac\xd8\x34\xdd\x1e", 10, "UTF-8", "utf-16be" },
+    { "a\0\x34\xd8", 4, "UTF-8", "UTF-16LE" },
+    { "a\0\x1e\xdd", 4, "UTF-8", "UTF-16LE" },
+    { "a\0b", 3, "UTF-8", "UTF-16LE" },
+  };
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (tests); i++)
+    check_builtin_conversion (tests[i].str, tests[i].len,
+                              tests[i].to_codeset, tests[i].from_codeset);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -709,6 +795,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/conversion/iconv-state", test_iconv_state);
   g_test_add_func ("/conversion/illegal-sequence", test_one_half);
   g_test_add_func ("/conversion/byte-order", test_byte_order);
+  g_test_add_func ("/conversion/builtin", test_builtin_conversions);
   g_test_add_func ("/conversion/unicode", test_unicode_conversions);
   g_test_add_func ("/conversion/filename-utf8", test_filename_utf8);
   g_test_add_func ("/conversion/filename-display", test_filename_display);
@@ -43,6 +43,54 @@ test_quark_string (void)
   g_free (copy);
 }
 
+#define N_QUARK_THREADS 4
+#define N_THREAD_QUARKS 5000
+
+static gint quark_thread_id;
+
+static gpointer
+quark_thread (gpointer data)
+{
+  GQuark *quarks = data;
+  gint id = g_atomic_int_add (&quark_thread_id, 1);
+  gint i;
+
+  /* all threads create the same quarks, in different orders */
+  for (i = 0; i < N_THREAD_QUARKS; i++)
+    {
+      gint n = (i * 7 + id * 1000) % N_THREAD_QUARKS;
+      gchar *name = g_strdup_printf ("quark-thread-%d", n);
+
+      quarks[n] = g_quark_from_string (name);
+      g_assert_cmpstr (g_quark_to_string (quarks[n]), ==, name);
+      g_assert (g_quark_try_string (name) == quarks[n]);
+      g_assert (g_intern_string (name) == g_quark_to_string (quarks[n]));
+      g_free (name);
+    }
+
+  return NULL;
+}
+
+static void
+test_quark_threads (void)
+{
+  GQuark quarks[N_QUARK_THREADS][N_THREAD_QUARKS];
+  GThread *threads[N_QUARK_THREADS];
+  gint i, j;
+
+  for (i = 0; i < N_QUARK_THREADS; i++)
+    threads[i] = g_thread_new ("quark", quark_thread, quarks[i]);
+  for (i = 0; i < N_QUARK_THREADS; i++)
+    g_thread_join (threads[i]);
+
+  for (j = 0; j < N_THREAD_QUARKS; j++)
+    {
+      g_assert (quarks[0][j] != 0);
+      for (i = 1; i < N_QUARK_THREADS; i++)
+        g_assert (quarks[i][j] == quarks[0][j]);
+    }
+}
+
 static void
 test_dataset_basic (void)
 {
@@ -250,6 +298,70 @@ test_datalist_id (void)
   g_datalist_clear (&list);
 }
 
+static void
+count_foreach (GQuark   key_id,
+               gpointer data,
+               gpointer user_data)
+{
+  guint *count = user_data;
+
+  g_assert_cmpint (GPOINTER_TO_UINT (data), ==, key_id);
+  (*count)++;
+}
+
+static void
+test_datalist_many (void)
+{
+  GData *list = NULL;
+  GQuark keys[100];
+  gchar *name;
+  guint i, count = 0;
+  gboolean replaced;
+
+  g_datalist_init (&list);
+
+  /* enough elements for the list to be kept sorted; insert in an order
+   * unrelated to the quark values
+   */
+  for (i = 0; i < G_N_ELEMENTS (keys); i++)
+    {
+      name = g_strdup_printf ("datalist-many-%u", (i * 37) % (guint) G_N_ELEMENTS (keys));
+      keys[i] = g_quark_from_string (name);
+      g_free (name);
+      g_datalist_id_set_data (&list, keys[i], GUINT_TO_POINTER (keys[i]));
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (keys); i++)
+    g_assert_cmpint (GPOINTER_TO_UINT (g_datalist_id_get_data (&list, keys[i])), ==, keys[i]);
+  g_assert (g_datalist_id_get_data (&list, g_quark_from_string ("datalist-many-none")) == NULL);
+
+  g_datalist_foreach (&list, count_foreach, &count);
+  g_assert_cmpuint (count, ==, G_N_ELEMENTS (keys));
+
+  /* remove every other element, shrinking below the sorted threshold */
+  for (i = 0; i < G_N_ELEMENTS (keys); i += 2)
+    g_assert_cmpint (GPOINTER_TO_UINT (g_datalist_id_remove_no_notify (&list, keys[i])), ==, keys[i]);
+
+  replaced = g_datalist_id_replace_data (&list, keys[1], GUINT_TO_POINTER (keys[1]), NULL, NULL, NULL);
+  g_assert (replaced);
+  replaced = g_datalist_id_replace_data (&list, keys[0], NULL, GUINT_TO_POINTER (keys[0]), NULL, NULL);
+  g_assert (replaced);
+
+  for (i = 0; i < G_N_ELEMENTS (keys); i++)
+    {
+      gboolean present = i == 0 || (i % 2 == 1 && i != 1);
+      gpointer expected = present ? GUINT_TO_POINTER (keys[i]) : NULL;
+
+      g_assert (g_datalist_id_get_data (&list, keys[i]) == expected);
+    }
+
+  for (i = 3; i < G_N_ELEMENTS (keys); i += 2)
+    g_datalist_id_set_data (&list, keys[i], NULL);
+  g_assert (g_datalist_id_get_data (&list, keys[0]) == GUINT_TO_POINTER (keys[0]));
+
+  g_datalist_clear (&list);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -257,6 +369,7 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/quark/basic", test_quark_basic);
   g_test_add_func ("/quark/string", test_quark_string);
+  g_test_add_func ("/quark/threads", test_quark_threads);
   g_test_add_func ("/dataset/basic", test_dataset_basic);
   g_test_add_func ("/dataset/id", test_dataset_id);
   g_test_add_func ("/dataset/full", test_dataset_full);
@@ -264,6 +377,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/dataset/destroy", test_dataset_destroy);
   g_test_add_func ("/datalist/basic", test_datalist_basic);
   g_test_add_func ("/datalist/id", test_datalist_id);
+  g_test_add_func ("/datalist/many", test_datalist_many);
   g_test_add_func ("/datalist/recursive-clear", test_datalist_clear);
 
   return g_test_run ();
@@ -0,0 +1,828 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Benchmarks of the core data structures. Without -m perf, every
+ * benchmark runs a single iteration as a quick test; with it, they
+ * report the time per iteration, where an iteration is one insertion,
+ * lookup, removal or step of an iteration, at each container size.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+typedef struct
+{
+  const gchar *name;
+  gpointer (*create) (void);
+  void     (*insert) (gpointer container, guint key);
+  gboolean (*lookup) (gpointer container, guint key);
+  void     (*remove) (gpointer container, guint key);
+  guint    (*iterate) (gpointer container, guint64 n_steps);
+  void     (*destroy) (gpointer container);
+} Container;
+
+typedef enum
+{
+  OP_INSERT,
+  OP_LOOKUP,
+  OP_REMOVE,
+  OP_ITERATE
+} Operation;
+
+typedef struct
+{
+  const Container *container;
+  Operation op;
+  guint size;
+} Bench;
+
+static volatile guint sink;
+
+/* Keys 1 to size, in a shuffled but reproducible order */
+static guint *keys;
+static guint n_keys;
+
+static void
+prepare_keys (guint size)
+{
+  GRand *rand;
+  guint i;
+
+  if (n_keys == size)
+    return;
+
+  g_free (keys);
+  keys = g_new (guint, size);
+  n_keys = size;
+
+  for (i = 0; i < size; i++)
+    keys[i] = i + 1;
+
+  rand = g_rand_new_with_seed (42);
+  for (i = size - 1; i > 0; i--)
+    {
+      guint j = g_rand_int_range (rand, 0, i + 1);
+      guint tmp = keys[i];
+
+      keys[i] = keys[j];
+      keys[j] = tmp;
+    }
+  g_rand_free (rand);
+}
+
+/* What the last benchmark set up, kept from one call of its benchmark
+ * function to the next; the lookup, remove and iterate benchmarks of a
+ * container share a full one of the same size
+ */
+static struct
+{
+  gconstpointer owner;
+  guint tag;
+  gpointer data;
+  GDestroyNotify destroy;
+  guint count;
+} live;
+
+static void
+live_clear (void)
+{
+  if (live.destroy != NULL)
+    live.destroy (live.data);
+  live.owner = NULL;
+  live.data = NULL;
+  live.destroy = NULL;
+}
+
+static gboolean
+live_is (gconstpointer owner,
+         guint         tag)
+{
+  return live.owner == owner && live.tag == tag;
+}
+
+static void
+live_set (gconstpointer  owner,
+          guint          tag,
+          gpointer       data,
+          GDestroyNotify destroy)
+{
+  live_clear ();
+  live.owner = owner;
+  live.tag = tag;
+  live.data = data;
+  live.destroy = destroy;
+  live.count = 0;
+}
+
+static gpointer
+container_prepare (const Container *container,
+                   guint            size,
+                   gboolean         full)
+{
+  gpointer c;
+  guint i;
+
+  if (live_is (container, size * 2 + full))
+    return live.data;
+
+  live_clear ();
+  prepare_keys (size);
+
+  c = container->create ();
+  if (full)
+    for (i = 0; i < size; i++)
+      container->insert (c, keys[i]);
+  live_set (container, size * 2 + full, c, container->destroy);
+
+  return c;
+}
+
+static void
+bench_container (gconstpointer data,
+                 guint64       n_iterations)
+{
+  const Bench *bench = data;
+  const Container *container = bench->container;
+  gpointer c;
+  guint64 i;
+  guint k;
+
+  c = container_prepare (container, bench->size, bench->op != OP_INSERT);
+
+  switch (bench->op)
+    {
+    case OP_INSERT:
+      /* start over once the container is full, so that every size up
+       * to the given one is measured
+       */
+      for (i = 0; i < n_iterations; i++)
+        {
+          if (live.count == bench->size)
+            {
+              container->destroy (c);
+              c = live.data = container->create ();
+              live.count = 0;
+            }
+          container->insert (c, keys[live.count++]);
+        }
+      break;
+
+    case OP_LOOKUP:
+      for (i = 0; i < n_iterations; i++)
+        {
+          k = keys[live.count++ % bench->size];
+          if (!container->lookup (c, k))
+            g_error ("%s: key %u not found", container->name, k);
+        }
+      break;
+
+    case OP_REMOVE:
+      /* put each key back, to keep the size constant */
+      for (i = 0; i < n_iterations; i++)
+        {
+          k = keys[live.count++ % bench->size];
+          container->remove (c, k);
+          container->insert (c, k);
+        }
+      break;
+
+    case OP_ITERATE:
+      sink += container->iterate (c, n_iterations);
+      break;
+    }
+}
+
+/* GHashTable */
+
+static gpointer
+hash_table_create (void)
+{
+  return g_hash_table_new (NULL, NULL);
+}
+
+static void
+hash_table_insert (gpointer container,
+                   guint    key)
+{
+  g_hash_table_insert (container, GUINT_TO_POINTER (key), GUINT_TO_POINTER (key));
+}
+
+static gboolean
+hash_table_lookup (gpointer container,
+                   guint    key)
+{
+  return g_hash_table_lookup (container, GUINT_TO_POINTER (key)) != NULL;
+}
+
+static void
+hash_table_remove (gpointer container,
+                   guint    key)
+{
+  g_hash_table_remove (container, GUINT_TO_POINTER (key));
+}
+
+static guint
+hash_table_iterate (gpointer container,
+                    guint64  n_steps)
+{
+  GHashTableIter iter;
+  gpointer key;
+  guint sum = 0;
+
+  while (n_steps > 0)
+    {
+      g_hash_table_iter_init (&iter, container);
+      while (n_steps > 0 && g_hash_table_iter_next (&iter, &key, NULL))
+        {
+          sum += GPOINTER_TO_UINT (key);
+          n_steps--;
+        }
+    }
+
+  return sum;
+}
+
+static void
+hash_table_destroy (gpointer container)
+{
+  g_hash_table_unref (container);
+}
+
+/* GTree */
+
+static gint
+compare_keys (gconstpointer a,
+              gconstpointer b,
+              gpointer      user_data)
+{
+  guint ka = GPOINTER_TO_UINT (a);
+  guint kb = GPOINTER_TO_UINT (b);
+
+  return (ka > kb) - (ka < kb);
+}
+
+static gpointer
+tree_create (void)
+{
+  return g_tree_new_full (compare_keys, NULL, NULL, NULL);
+}
+
+static void
+tree_insert (gpointer container,
+             guint    key)
+{
+  g_tree_insert (container, GUINT_TO_POINTER (key), GUINT_TO_POINTER (key));
+}
+
+static gboolean
+tree_lookup (gpointer container,
+             guint    key)
+{
+  return g_tree_lookup (container, GUINT_TO_POINTER (key)) != NULL;
+}
+
+static void
+tree_remove (gpointer container,
+             guint    key)
+{
+  g_tree_remove (container, GUINT_TO_POINTER (key));
+}
+
+typedef struct
+{
+  guint64 n_steps;
+  guint sum;
+} TreeWalk;
+
+static gboolean
+tree_step (gpointer key,
+           gpointer value,
+           gpointer data)
+{
+  TreeWalk *walk = data;
+
+  walk->sum += GPOINTER_TO_UINT (key);
+
+  return --walk->n_steps == 0;
+}
+
+static guint
+tree_iterate (gpointer container,
+              guint64  n_steps)
+{
+  TreeWalk walk = { n_steps, 0 };
+
+  while (walk.n_steps > 0)
+    g_tree_foreach (container, tree_step, &walk);
+
+  return walk.sum;
+}
+
+static void
+tree_destroy (gpointer container)
+{
+  g_tree_destroy (container);
+}
+
+/* GSequence */
+
+static gpointer
+sequence_create (void)
+{
+  return g_sequence_new (NULL);
+}
+
+static void
+sequence_insert (gpointer container,
+                 guint    key)
+{
+  g_sequence_insert_sorted (container, GUINT_TO_POINTER (key), compare_keys, NULL);
+}
+
+static gboolean
+sequence_lookup (gpointer container,
+                 guint    key)
+{
+  return g_sequence_lookup (container, GUINT_TO_POINTER (key), compare_keys, NULL) != NULL;
+}
+
+static void
+sequence_remove (gpointer container,
+                 guint    key)
+{
+  g_sequence_remove (g_sequence_lookup (container, GUINT_TO_POINTER (key), compare_keys, NULL));
+}
+
+static guint
+sequence_iterate (gpointer container,
+                  guint64  n_steps)
+{
+  GSequenceIter *iter;
+  guint sum = 0;
+
+  while (n_steps > 0)
+    {
+      for (iter = g_sequence_get_begin_iter (container);
+           n_steps > 0 && !g_sequence_iter_is_end (iter);
+           iter = g_sequence_iter_next (iter))
+        {
+          sum += GPOINTER_TO_UINT (g_sequence_get (iter));
+          n_steps--;
+        }
+    }
+
+  return sum;
+}
+
+static void
+sequence_destroy (gpointer container)
+{
+  g_sequence_free (container);
+}
+
+/* GArray, where keys are used as indices for lookups and removals */
+
+static gpointer
+array_create (void)
+{
+  return g_array_new (FALSE, FALSE, sizeof (guint));
+}
+
+static void
+array_insert (gpointer container,
+              guint    key)
+{
+  g_array_append_val ((GArray *) container, key);
+}
+
+static gboolean
+array_lookup (gpointer container,
+              guint    key)
+{
+  return g_array_index ((GArray *) container, guint, key - 1) != 0;
+}
+
+static void
+array_remove (gpointer container,
+              guint    key)
+{
+  g_array_remove_index_fast (container, key - 1);
+}
+
+static guint
+array_iterate (gpointer container,
+               guint64  n_steps)
+{
+  GArray *array = container;
+  guint sum = 0;
+  guint i;
+
+  while (n_steps > 0)
+    {
+      for (i = 0; n_steps > 0 && i < array->len; i++)
+        {
+          sum += g_array_index (array, guint, i);
+          n_steps--;
+        }
+    }
+
+  return sum;
+}
+
+static void
+array_destroy (gpointer container)
+{
+  g_array_unref (container);
+}
+
+/* GQueue, which has no lookups, and removes from the head */
+
+static gpointer
+queue_create (void)
+{
+  return g_queue_new ();
+}
+
+static void
+queue_insert (gpointer container,
+              guint    key)
+{
+  g_queue_push_tail (container, GUINT_TO_POINTER (key));
+}
+
+static void
+queue_remove (gpointer container,
+              guint    key)
+{
+  g_queue_pop_head (container);
+}
+
+static guint
+queue_iterate (gpointer container,
+               guint64  n_steps)
+{
+  GList *l;
+  guint sum = 0;
+
+  while (n_steps > 0)
+    {
+      for (l = ((GQueue *) container)->head; n_steps > 0 && l != NULL; l = l->next)
+        {
+          sum += GPOINTER_TO_UINT (l->data);
+          n_steps--;
+        }
+    }
+
+  return sum;
+}
+
+static void
+queue_destroy (gpointer container)
+{
+  g_queue_free (container);
+}
+
+static const Container containers[] = {
+  { "hash-table", hash_table_create, hash_table_insert, hash_table_lookup,
+    hash_table_remove, hash_table_iterate, hash_table_destroy },
+  { "tree", tree_create, tree_insert, tree_lookup,
+    tree_remove, tree_iterate, tree_destroy },
+  { "sequence", sequence_create, sequence_insert, sequence_lookup,
+    sequence_remove, sequence_iterate, sequence_destroy },
+  { "array", array_create, array_insert, array_lookup,
+    array_remove, array_iterate, array_destroy },
+  { "queue", queue_create, queue_insert, NULL,
+    queue_remove, queue_iterate, queue_destroy },
+};
+
+/* GString; the size is the length at which the string starts over */
+
+typedef enum
+{
+  STRING_APPEND_C,
+  STRING_APPEND,
+  STRING_APPEND_PRINTF,
+  STRING_PREPEND
+} StringOperation;
+
+typedef struct
+{
+  StringOperation op;
+  guint size;
+} StringBench;
+
+static void
+string_free (gpointer string)
+{
+  g_string_free (string, TRUE);
+}
+
+static void
+bench_string (gconstpointer data,
+              guint64       n_iterations)
+{
+  const StringBench *bench = data;
+  GString *string;
+  guint64 i;
+
+  if (!live_is (bench, 0))
+    live_set (bench, 0, g_string_sized_new (16), string_free);
+  string = live.data;
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      if (string->len >= bench->size)
+        g_string_truncate (string, 0);
+
+      switch (bench->op)
+        {
+        case STRING_APPEND_C:
+          g_string_append_c (string, 'x');
+          break;
+        case STRING_APPEND:
+          g_string_append (string, "sixteen bytes!!!");
+          break;
+        case STRING_APPEND_PRINTF:
+          g_string_append_printf (string, "%d,%s;", (gint) i, "x");
+          break;
+        case STRING_PREPEND:
+          g_string_prepend (string, "sixteen bytes!!!");
+          break;
+        }
+    }
+}
+
+/* GVariant arrays of strings */
+
+typedef enum
+{
+  VARIANT_BUILD,
+  VARIANT_GET_CHILD,
+  VARIANT_ITERATE
+} VariantOperation;
+
+typedef struct
+{
+  VariantOperation op;
+  guint size;
+} VariantBench;
+
+static GVariant *
+variant_new_array (guint size)
+{
+  GVariantBuilder builder;
+  guint i;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE_STRING_ARRAY);
+  for (i = 0; i < size; i++)
+    g_variant_builder_add (&builder, "s", "some string");
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+static void
+bench_variant (gconstpointer data,
+               guint64       n_iterations)
+{
+  const VariantBench *bench = data;
+  GVariantBuilder *builder;
+  GVariantIter iter;
+  GVariant *variant, *child;
+  guint64 i;
+
+  switch (bench->op)
+    {
+    case VARIANT_BUILD:
+      if (!live_is (bench, 0))
+        live_set (bench, 0, g_variant_builder_new (G_VARIANT_TYPE_STRING_ARRAY),
+                  (GDestroyNotify) g_variant_builder_unref);
+      builder = live.data;
+
+      for (i = 0; i < n_iterations; i++)
+        {
+          if (live.count == bench->size)
+            {
+              g_variant_unref (g_variant_ref_sink (g_variant_builder_end (builder)));
+              g_variant_builder_init (builder, G_VARIANT_TYPE_STRING_ARRAY);
+              live.count = 0;
+            }
+          g_variant_builder_add (builder, "s", "some string");
+          live.count++;
+        }
+      break;
+
+    case VARIANT_GET_CHILD:
+      if (!live_is (bench, 0))
+        live_set (bench, 0, variant_new_array (bench->size),
+                  (GDestroyNotify) g_variant_unref);
+      variant = live.data;
+
+      for (i = 0; i < n_iterations; i++)
+        {
+          child = g_variant_get_child_value (variant, live.count++ % bench->size);
+          sink += g_variant_get_size (child);
+          g_variant_unref (child);
+        }
+      break;
+
+    case VARIANT_ITERATE:
+      if (!live_is (bench, 0))
+        live_set (bench, 0, variant_new_array (bench->size),
+                  (GDestroyNotify) g_variant_unref);
+      variant = live.data;
+
+      i = 0;
+      while (i < n_iterations)
+        {
+          g_variant_iter_init (&iter, variant);
+          while (i < n_iterations && (child = g_variant_iter_next_value (&iter)) != NULL)
+            {
+              sink += g_variant_get_size (child);
+              g_variant_unref (child);
+              i++;
+            }
+        }
+      break;
+    }
+}
+
+/* Allocation churn: each iteration frees the oldest of a fixed number
+ * of live blocks, and allocates a new one in its place
+ */
+
+#define N_LIVE_BLOCKS 1024
+
+typedef struct
+{
+  gboolean use_slice;
+  gsize block_size;
+} ChurnBench;
+
+typedef struct
+{
+  const ChurnBench *bench;
+  gpointer blocks[N_LIVE_BLOCKS];
+} ChurnState;
+
+static void
+churn_state_free (gpointer data)
+{
+  ChurnState *state = data;
+  guint j;
+
+  for (j = 0; j < N_LIVE_BLOCKS; j++)
+    {
+      if (state->bench->use_slice)
+        g_slice_free1 (state->bench->block_size, state->blocks[j]);
+      else
+        free (state->blocks[j]);
+    }
+
+  g_free (state);
+}
+
+static void
+bench_churn (gconstpointer data,
+             guint64       n_iterations)
+{
+  const ChurnBench *bench = data;
+  ChurnState *state;
+  guint64 i;
+  guint j;
+
+  if (!live_is (bench, 0))
+    {
+      state = g_new (ChurnState, 1);
+      state->bench = bench;
+      for (j = 0; j < N_LIVE_BLOCKS; j++)
+        state->blocks[j] = bench->use_slice ? g_slice_alloc (bench->block_size) : malloc (bench->block_size);
+      live_set (bench, 0, state, churn_state_free);
+    }
+  state = live.data;
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      j = live.count++ % N_LIVE_BLOCKS;
+      if (bench->use_slice)
+        {
+          g_slice_free1 (bench->block_size, state->blocks[j]);
+          state->blocks[j] = g_slice_alloc (bench->block_size);
+        }
+      else
+        {
+          free (state->blocks[j]);
+          state->blocks[j] = malloc (bench->block_size);
+        }
+      *(volatile gchar *) state->blocks[j] = 0;
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  static const gchar * const op_names[] = { "insert", "lookup", "remove", "iterate" };
+  static const gchar * const string_op_names[] = { "append-c", "append", "append-printf", "prepend" };
+  static const gchar * const variant_op_names[] = { "build", "get-child", "iterate" };
+  static const gsize block_sizes[] = { 16, 64, 256, 1024 };
+  guint sizes[] = { 10, 1000, 100000, 10000000 };
+  guint n_sizes;
+  guint c, s, op;
+  gint ret;
+
+  g_test_init (&argc, &argv, NULL);
+
+  /* the largest containers take a while to build, and a lot of memory */
+  n_sizes = g_test_perf () ? G_N_ELEMENTS (sizes) : G_N_ELEMENTS (sizes) - 1;
+
+  for (c = 0; c < G_N_ELEMENTS (containers); c++)
+    for (s = 0; s < n_sizes; s++)
+      for (op = OP_INSERT; op <= OP_ITERATE; op++)
+        {
+          Bench *bench;
+          gchar *path;
+
+          if (op == OP_LOOKUP && containers[c].lookup == NULL)
+            continue;
+
+          bench = g_new (Bench, 1);
+          bench->container = &containers[c];
+          bench->op = op;
+          bench->size = sizes[s];
+
+          path = g_strdup_printf ("/%s/%s/%u", containers[c].name, op_names[op], sizes[s]);
+          g_test_add_bench (path, bench, bench_container);
+          g_free (path);
+        }
+
+  for (op = STRING_APPEND_C; op <= STRING_PREPEND; op++)
+    for (s = 1; s < n_sizes; s++)
+      {
+        StringBench *bench;
+        gchar *path;
+
+        /* prepending is quadratic in the length */
+        if (op == STRING_PREPEND && sizes[s] > 100000)
+          continue;
+
+        bench = g_new (StringBench, 1);
+        bench->op = op;
+        bench->size = sizes[s];
+
+        path = g_strdup_printf ("/string/%s/%u", string_op_names[op], sizes[s]);
+        g_test_add_bench (path, bench, bench_string);
+        g_free (path);
+      }
+
+  for (op = VARIANT_BUILD; op <= VARIANT_ITERATE; op++)
+    for (s = 0; s < n_sizes; s++)
+      {
+        VariantBench *bench;
+        gchar *path;
+
+        bench = g_new (VariantBench, 1);
+        bench->op = op;
+        bench->size = sizes[s];
+
+        path = g_strdup_printf ("/variant/%s/%u", variant_op_names[op], sizes[s]);
+        g_test_add_bench (path, bench, bench_variant);
+        g_free (path);
+      }
+
+  for (s = 0; s < G_N_ELEMENTS (block_sizes); s++)
+    for (op = 0; op < 2; op++)
+      {
+        ChurnBench *bench;
+        gchar *path;
+
+        bench = g_new (ChurnBench, 1);
+        bench->use_slice = op == 0;
+        bench->block_size = block_sizes[s];
+
+        path = g_strdup_printf ("/alloc-churn/%s/%" G_GSIZE_FORMAT,
+                                bench->use_slice ? "slice" : "malloc", block_sizes[s]);
+        g_test_add_bench (path, bench, bench_churn);
+        g_free (path);
+      }
+
+  ret = g_test_run ();
+
+  live_clear ();
+  g_free (keys);
+
+  return ret;
+}
@@ -0,0 +1,222 @@
+/* Unit tests for epoch-based reclamation
+ *
+ * This work is provided "as is"; redistribution and modification
+ * in whole or in part, in any medium, physical or electronic is
+ * permitted without restriction.
+ *
+ * This work is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * In no event shall the authors or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ */
+
+#include <glib.h>
+
+static gint n_freed;
+
+static void
+count_free (gpointer data)
+{
+  g_atomic_int_inc (&n_freed);
+  g_free (data);
+}
+
+static void
+test_synchronize (void)
+{
+  gint i;
+
+  n_freed = 0;
+
+  for (i = 0; i < 10; i++)
+    g_epoch_retire (g_new0 (gint, 1), count_free);
+
+  g_epoch_synchronize ();
+  g_assert_cmpint (n_freed, ==, 10);
+
+  /* Enough to trigger reclamation from g_epoch_retire() itself */
+  for (i = 0; i < 1000; i++)
+    g_epoch_retire (g_new0 (gint, 1), count_free);
+  g_assert_cmpint (n_freed, >, 10);
+
+  g_epoch_synchronize ();
+  g_assert_cmpint (n_freed, ==, 1010);
+}
+
+static gint reader_inside;
+static gint reader_may_leave;
+
+static gpointer
+reader_thread (gpointer data)
+{
+  g_epoch_enter ();
+  g_epoch_enter ();
+  g_epoch_leave ();
+
+  /* Still inside the outer critical section */
+  g_atomic_int_set (&reader_inside, 1);
+  while (!g_atomic_int_get (&reader_may_leave))
+    g_usleep (1000);
+
+  g_epoch_leave ();
+
+  return NULL;
+}
+
+static void
+test_reader_blocks (void)
+{
+  GThread *thread;
+  gint i;
+
+  n_freed = 0;
+  reader_inside = reader_may_leave = 0;
+
+  thread = g_thread_new ("reader", reader_thread, NULL);
+  while (!g_atomic_int_get (&reader_inside))
+    g_usleep (1000);
+
+  /* None of these can be freed while the reader is inside */
+  for (i = 0; i < 1000; i++)
+    g_epoch_retire (g_new0 (gint, 1), count_free);
+  g_assert_cmpint (g_atomic_int_get (&n_freed), ==, 0);
+
+  g_atomic_int_set (&reader_may_leave, 1);
+  g_epoch_synchronize ();
+  g_assert_cmpint (n_freed, ==, 1000);
+
+  g_thread_join (thread);
+}
+
+static gpointer
+retire_and_exit_thread (gpointer data)
+{
+  gint i;
+
+  for (i = 0; i < 10; i++)
+    g_epoch_retire (g_new0 (gint, 1), count_free);
+
+  return NULL;
+}
+
+static void
+test_thread_exit (void)
+{
+  GThread *thread;
+
+  n_freed = 0;
+
+  thread = g_thread_new ("retire", retire_and_exit_thread, NULL);
+  g_thread_join (thread);
+
+  /* What the exited thread left behind is freed by this one */
+  g_epoch_synchronize ();
+  g_assert_cmpint (n_freed, ==, 10);
+}
+
+#define MAGIC 0x5a5a5a5a
+#define N_READERS 4
+#define N_WRITES 20000
+
+typedef struct
+{
+  gint magic;
+  gint value;
+} Shared;
+
+static Shared *shared;
+static gint writer_done;
+
+static void
+shared_free (gpointer data)
+{
+  Shared *s = data;
+
+  /* Readers would notice this if they could still see it */
+  s->magic = 0;
+  g_free (s);
+  g_atomic_int_inc (&n_freed);
+}
+
+static gpointer
+stress_reader (gpointer data)
+{
+  gint last = 0;
+
+  while (!g_atomic_int_get (&writer_done))
+    {
+      Shared *s;
+
+      g_epoch_enter ();
+      s = g_atomic_pointer_get (&shared);
+      g_assert_cmpint (s->magic, ==, MAGIC);
+      g_assert_cmpint (s->value, >=, last);
+      last = s->value;
+      g_epoch_leave ();
+    }
+
+  return NULL;
+}
+
+static void
+test_stress (void)
+{
+  GThread *readers[N_READERS];
+  gint i;
+
+  n_freed = 0;
+  writer_done = 0;
+
+  shared = g_new (Shared, 1);
+  shared->magic = MAGIC;
+  shared->value = 0;
+
+  for (i = 0; i < N_READERS; i++)
+    readers[i] = g_thread_new ("reader", stress_reader, NULL);
+
+  for (i = 1; i <= N_WRITES; i++)
+    {
+      Shared *old, *s;
+
+      s = g_new (Shared, 1);
+      s->magic = MAGIC;
+      s->value = i;
+
+      old = g_atomic_pointer_get (&shared);
+      g_atomic_pointer_set (&shared, s);
+      g_epoch_retire (old, shared_free);
+
+      if (i % 1000 == 0)
+        g_thread_yield ();
+    }
+
+  g_atomic_int_set (&writer_done, 1);
+  for (i = 0; i < N_READERS; i++)
+    g_thread_join (readers[i]);
+
+  g_epoch_synchronize ();
+  g_assert_cmpint (n_freed, ==, N_WRITES);
+
+  g_free (shared);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/epoch/synchronize", test_synchronize);
+  g_test_add_func ("/epoch/reader-blocks", test_reader_blocks);
+  g_test_add_func ("/epoch/thread-exit", test_thread_exit);
+  g_test_add_func ("/epoch/stress", test_stress);
+
+  return g_test_run ();
+}
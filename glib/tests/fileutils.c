@@ -788,6 +788,194 @@ test_set_contents (void)
   g_free (name);
 }
 
+static void
+test_get_bytes (void)
+{
+  GError *error = NULL;
+  GBytes *bytes;
+  gchar *name;
+  gchar *data;
+  gsize i;
+  gint fd;
+
+  data = g_malloc (10000);
+  for (i = 0; i < 10000; i++)
+    data[i] = i % 251;
+
+  fd = g_file_open_tmp (NULL, &name, &error);
+  g_assert_no_error (error);
+  close (fd);
+
+  g_file_set_contents (name, data, 10000, &error);
+  g_assert_no_error (error);
+
+  /* Mapped */
+  bytes = g_file_get_bytes (name, 1, &error);
+  g_assert_no_error (error);
+  g_assert_cmpmem (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes), data, 10000);
+  g_bytes_unref (bytes);
+
+  /* Read */
+  bytes = g_file_get_bytes (name, G_MAXSIZE, &error);
+  g_assert_no_error (error);
+  g_assert_cmpmem (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes), data, 10000);
+  g_bytes_unref (bytes);
+
+  /* Empty files are never mapped */
+  g_file_set_contents (name, "", 0, &error);
+  g_assert_no_error (error);
+  bytes = g_file_get_bytes (name, 1, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_bytes_get_size (bytes), ==, 0);
+  g_bytes_unref (bytes);
+
+  g_remove (name);
+
+  bytes = g_file_get_bytes (name, 0, &error);
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+  g_assert (bytes == NULL);
+  g_clear_error (&error);
+
+  g_free (name);
+  g_free (data);
+}
+
+#ifdef G_OS_UNIX
+static gpointer
+write_pipe_thread (gpointer data)
+{
+  gint fd = GPOINTER_TO_INT (data);
+  gchar buf[1000];
+  gint i;
+
+  memset (buf, 'x', sizeof buf);
+  for (i = 0; i < 100; i++)
+    g_assert_cmpint (write (fd, buf, sizeof buf), ==, sizeof buf);
+  close (fd);
+
+  return NULL;
+}
+
+static void
+test_get_contents_pipe (void)
+{
+  GError *error = NULL;
+  GThread *thread;
+  gchar *contents;
+  gsize len;
+  gchar *path;
+  gint fds[2];
+  gsize i;
+  gboolean ret;
+
+  /* Not a regular file, so this reads through the growing buffer */
+  g_assert_cmpint (pipe (fds), ==, 0);
+  thread = g_thread_new ("writer", write_pipe_thread, GINT_TO_POINTER (fds[1]));
+
+  path = g_strdup_printf ("/dev/fd/%d", fds[0]);
+  ret = g_file_get_contents (path, &contents, &len, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+  g_assert_cmpuint (len, ==, 100000);
+  g_assert_cmpuint (strlen (contents), ==, 100000);
+  for (i = 0; i < len; i++)
+    g_assert_cmpint (contents[i], ==, 'x');
+
+  g_thread_join (thread);
+  g_free (contents);
+  g_free (path);
+  close (fds[0]);
+}
+#endif
+
+static void
+test_batch_set_contents (gconstpointer data)
+{
+  GFileBatchFlags flags = GPOINTER_TO_UINT (data);
+  GError *error = NULL;
+  GFileBatch *batch;
+  gchar *dir;
+  gchar *existing;
+  gchar *created;
+  gchar *missing;
+  gchar *buf;
+  GDir *d;
+  gint n;
+  gboolean ret;
+
+  dir = g_dir_make_tmp ("batch-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  existing = g_build_filename (dir, "existing", NULL);
+  created = g_build_filename (dir, "created", NULL);
+  missing = g_build_filename (dir, "nodir", "missing", NULL);
+
+  ret = g_file_set_contents (existing, "a", -1, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+
+  batch = g_file_batch_new (flags);
+
+  ret = g_file_batch_set_contents (batch, existing, "b", -1, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+  ret = g_file_batch_set_contents (batch, created, "c", -1, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+
+  ret = g_file_batch_set_contents (batch, missing, "d", -1, &error);
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+  g_assert (!ret);
+  g_clear_error (&error);
+
+  /* Nothing is replaced until the commit */
+  ret = g_file_get_contents (existing, &buf, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (buf, ==, "a");
+  g_free (buf);
+  g_assert (!g_file_test (created, G_FILE_TEST_EXISTS));
+
+  ret = g_file_batch_commit (batch, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+
+  ret = g_file_get_contents (existing, &buf, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (buf, ==, "b");
+  g_free (buf);
+  ret = g_file_get_contents (created, &buf, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (buf, ==, "c");
+  g_free (buf);
+
+  /* The batch can be reused, and freeing it discards what is pending */
+  ret = g_file_batch_set_contents (batch, existing, "e", -1, &error);
+  g_assert_no_error (error);
+  g_assert (ret);
+  g_file_batch_free (batch);
+
+  ret = g_file_get_contents (existing, &buf, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (buf, ==, "b");
+  g_free (buf);
+
+  /* No temporary files are left behind */
+  d = g_dir_open (dir, 0, &error);
+  g_assert_no_error (error);
+  for (n = 0; g_dir_read_name (d) != NULL; n++)
+    ;
+  g_dir_close (d);
+  g_assert_cmpint (n, ==, 2);
+
+  g_remove (existing);
+  g_remove (created);
+  g_rmdir (dir);
+  g_free (existing);
+  g_free (created);
+  g_free (missing);
+  g_free (dir);
+}
+
 static void
 test_read_link (void)
 {
@@ -921,6 +1109,16 @@ main (int   argc,
   g_test_add_func ("/fileutils/mkstemp", test_mkstemp);
   g_test_add_func ("/fileutils/mkdtemp", test_mkdtemp);
   g_test_add_func ("/fileutils/set-contents", test_set_contents);
+  g_test_add_func ("/fileutils/get-bytes", test_get_bytes);
+#ifdef G_OS_UNIX
+  g_test_add_func ("/fileutils/get-contents-pipe", test_get_contents_pipe);
+#endif
+  g_test_add_data_func ("/fileutils/batch-set-contents",
+                        GUINT_TO_POINTER (G_FILE_BATCH_FLAGS_NONE),
+                        test_batch_set_contents);
+  g_test_add_data_func ("/fileutils/batch-set-contents/tmpfile",
+                        GUINT_TO_POINTER (G_FILE_BATCH_FLAGS_TMPFILE),
+                        test_batch_set_contents);
   g_test_add_func ("/fileutils/read-link", test_read_link);
   g_test_add_func ("/fileutils/stdio-wrappers", test_stdio_wrappers);
 
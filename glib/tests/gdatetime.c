@@ -1327,6 +1327,73 @@ test_z (void)
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wformat-y2k"
+static void
+test_formatter (void)
+{
+  static const gchar *formats[] = {
+    "%Y-%m-%d %H:%M:%S %z", "%a %b %e %T %Z %Y", "%c", "%-d/%_m %:::z %%", ""
+  };
+  GDateTimeFormatter *formatter, *other;
+  GTimeZone *tz;
+  GDateTime *dt[4];
+  GString *string;
+  gchar *p, *q;
+  guint i, j;
+
+  g_assert_null (g_date_time_formatter_new ("%Q"));
+  g_assert_null (g_date_time_formatter_new ("%:a"));
+
+  tz = g_time_zone_new ("-08:00");
+  dt[0] = g_date_time_new_utc (2017, 6, 1, 10, 20, 30.25);
+  dt[1] = g_date_time_new_utc (2017, 6, 1, 10, 20, 30.75);
+  dt[2] = g_date_time_new_utc (2017, 6, 1, 10, 20, 31);
+  dt[3] = g_date_time_to_timezone (dt[2], tz);
+
+  /* the same output as g_date_time_format(), whether it comes from the
+   * cache for the same second or not
+   */
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    {
+      formatter = g_date_time_formatter_new (formats[i]);
+      g_assert_nonnull (formatter);
+
+      for (j = 0; j < G_N_ELEMENTS (dt) * 2; j++)
+        {
+          p = g_date_time_format (dt[j % G_N_ELEMENTS (dt)], formats[i]);
+          q = g_date_time_formatter_format (formatter, dt[j % G_N_ELEMENTS (dt)]);
+          g_assert_cmpstr (p, ==, q);
+          g_free (p);
+          g_free (q);
+        }
+
+      g_date_time_formatter_unref (formatter);
+    }
+
+  /* formatters don't share their output */
+  formatter = g_date_time_formatter_new ("%H:%M");
+  other = g_date_time_formatter_new ("%M:%H");
+  p = g_date_time_formatter_format (formatter, dt[0]);
+  q = g_date_time_formatter_format (other, dt[0]);
+  g_assert_cmpstr (p, ==, "10:20");
+  g_assert_cmpstr (q, ==, "20:10");
+  g_free (p);
+  g_free (q);
+
+  string = g_string_new ("at ");
+  g_assert (g_date_time_formatter_append (formatter, dt[3], string));
+  g_assert (g_date_time_formatter_append (other, dt[3], string));
+  g_assert_cmpstr (string->str, ==, "at 02:2020:02");
+  g_string_free (string, TRUE);
+
+  g_date_time_formatter_unref (other);
+  g_date_time_formatter_unref (g_date_time_formatter_ref (formatter));
+  g_date_time_formatter_unref (formatter);
+
+  for (i = 0; i < G_N_ELEMENTS (dt); i++)
+    g_date_time_unref (dt[i]);
+  g_time_zone_unref (tz);
+}
+
 static void
 test_strftime (void)
 {
@@ -1387,6 +1454,81 @@ test_find_interval (void)
   g_time_zone_unref (tz);
 }
 
+/* Lookups must not depend on the interval found by the previous one */
+static void
+test_find_interval_order (void)
+{
+  GTimeZone *tz;
+  gint64 times[200];
+  gint intervals[G_N_ELEMENTS (times)];
+  gint i, i1;
+
+#ifdef G_OS_UNIX
+  tz = g_time_zone_new ("America/Toronto");
+#elif defined G_OS_WIN32
+  tz = g_time_zone_new ("Eastern Standard Time");
+#endif
+
+  /* every 257 days from 1900 to 2040, in order */
+  for (i = 0; i < G_N_ELEMENTS (times); i++)
+    {
+      times[i] = G_GINT64_CONSTANT (-2208988800) + (gint64) i * 257 * 86400;
+      intervals[i] = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL,
+                                                times[i]);
+      if (i > 0)
+        g_assert_cmpint (intervals[i], >=, intervals[i - 1]);
+    }
+
+  /* and again, jumping around */
+  for (i = 0; i < G_N_ELEMENTS (times); i++)
+    {
+      gint j = (i * 67) % G_N_ELEMENTS (times);
+      gint64 u = times[j];
+
+      i1 = g_time_zone_find_interval (tz, G_TIME_TYPE_UNIVERSAL, times[j]);
+      g_assert_cmpint (i1, ==, intervals[j]);
+
+      i1 = g_time_zone_adjust_time (tz, G_TIME_TYPE_UNIVERSAL, &u);
+      g_assert_cmpint (i1, ==, intervals[j]);
+      g_assert_cmpint (u, ==, times[j]);
+    }
+
+  g_time_zone_unref (tz);
+}
+
+static void
+test_local_cache (void)
+{
+  GTimeZone *tz1, *tz2;
+  GDateTime *dt;
+  gchar *saved;
+
+  saved = g_strdup (g_getenv ("TZ"));
+
+  g_setenv ("TZ", "America/Toronto", TRUE);
+  tz1 = g_time_zone_new_local ();
+  tz2 = g_time_zone_new_local ();
+  g_assert (tz1 == tz2);
+  g_time_zone_unref (tz2);
+
+  /* a change of TZ is seen at once */
+  g_setenv ("TZ", "Europe/London", TRUE);
+  tz2 = g_time_zone_new_local ();
+  g_assert (tz1 != tz2);
+  dt = g_date_time_new (tz2, 2017, 1, 1, 12, 0, 0);
+  g_assert_cmpint (g_date_time_get_utc_offset (dt), ==, 0);
+  g_date_time_unref (dt);
+
+  g_time_zone_unref (tz1);
+  g_time_zone_unref (tz2);
+
+  if (saved != NULL)
+    g_setenv ("TZ", saved, TRUE);
+  else
+    g_unsetenv ("TZ");
+  g_free (saved);
+}
+
 static void
 test_adjust_time (void)
 {
@@ -1659,6 +1801,7 @@ main (gint   argc,
   g_test_add_func ("/GDateTime/printf", test_GDateTime_printf);
   g_test_add_func ("/GDateTime/non_utf8_printf", test_non_utf8_printf);
   g_test_add_func ("/GDateTime/strftime", test_strftime);
+  g_test_add_func ("/GDateTime/formatter", test_formatter);
   g_test_add_func ("/GDateTime/modifiers", test_modifiers);
   g_test_add_func ("/GDateTime/to_local", test_GDateTime_to_local);
   g_test_add_func ("/GDateTime/to_unix", test_GDateTime_to_unix);
@@ -1669,7 +1812,9 @@ main (gint   argc,
   g_test_add_func ("/GDateTime/test_z", test_z);
   g_test_add_func ("/GDateTime/test-all-dates", test_all_dates);
   g_test_add_func ("/GTimeZone/find-interval", test_find_interval);
+  g_test_add_func ("/GTimeZone/find-interval-order", test_find_interval_order);
   g_test_add_func ("/GTimeZone/adjust-time", test_adjust_time);
+  g_test_add_func ("/GTimeZone/local-cache", test_local_cache);
   g_test_add_func ("/GTimeZone/no-header", test_no_header);
   g_test_add_func ("/GTimeZone/posix-parse", test_posix_parse);
 
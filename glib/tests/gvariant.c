@@ -17,6 +17,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <glib.h>
+#include <glib/gstdio.h>
 
 #define BASIC "bynqiuxthdsog?"
 #define N_BASIC (G_N_ELEMENTS (BASIC) - 1)
@@ -1039,6 +1040,46 @@ test_gvarianttypeinfo (void)
   g_variant_type_info_assert_no_infos ();
 }
 
+static gpointer
+typeinfo_thread (gpointer data)
+{
+  const gchar * const type_strings[] = { "as", "a{sv}", "(ii)", "m(sa{sv})", "aas" };
+  gint i;
+
+  for (i = 0; i < 10000; i++)
+    {
+      GVariantType *type;
+      GVariantTypeInfo *info, *info2;
+
+      type = g_variant_type_new (type_strings[i % G_N_ELEMENTS (type_strings)]);
+      info = g_variant_type_info_get (type);
+      info2 = g_variant_type_info_get (type);
+      g_assert (info == info2);
+      g_assert_cmpstr (g_variant_type_info_get_type_string (info), ==,
+                       g_variant_type_peek_string (type));
+      g_variant_type_info_unref (info2);
+      g_variant_type_info_unref (info);
+      g_variant_type_free (type);
+    }
+
+  return NULL;
+}
+
+/* Concurrent lookups, creations and frees of the same infos */
+static void
+test_gvarianttypeinfo_threaded (void)
+{
+  GThread *threads[8];
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("typeinfo", typeinfo_thread, NULL);
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  g_variant_type_info_assert_no_infos ();
+}
+
 #define MAX_FIXED_MULTIPLIER    256
 #define MAX_INSTANCE_SIZE       1024
 #define MAX_ARRAY_CHILDREN      128
@@ -1839,6 +1880,21 @@ test_strings (void)
     { is_string,   12, "/some//path" },
     { is_string,   12, "/some-/path" },
 
+    /* long enough for the vectorised checks */
+    { is_string,   41, "this string is longer than sixteen bytes" },
+    { is_string,   42, "this string is longer than sixteen b\xc3\xbftes" },
+    { is_nval,     41, "this string is longer than sixteen b\xfftes" },
+    { is_nval,     41, "this string is longer than sixteen \0ytes" },
+    { is_nval,     41, "this string is longer than sixteen bytes!" },
+    { is_objpath,  41, "/org/freedesktop/DBus/Long_path/Object42" },
+    { is_objpath,  35, "/aaaaaaaaaaaaaaaa/bbbbbbbbbbbbbbbb" },
+    { is_string,   35, "/aaaaaaaaaaaaaaa//bbbbbbbbbbbbbbbb" },
+    { is_string,   35, "/aaaaaaaaaaaaaaaa//bbbbbbbbbbbbbbb" },
+    { is_string,   41, "/org/freedesktop/DBus/Long-path/Object42" },
+    { is_string,   41, "/org/freedesktop/DBus/Long_path/Obj\xc3\xa9" "ct4" },
+    { is_nval,     41, "/org/freedesktop/DBus/Long_path\0Object42" },
+    { is_string,   42, "/org/freedesktop/DBus/Long_path/Object42/" },
+
     { is_sig,       2, "i" },
     { is_sig,       2, "s" },
     { is_sig,       5, "(si)" },
@@ -2785,6 +2841,178 @@ test_containers (void)
   g_variant_type_info_assert_no_infos ();
 }
 
+/* Adds @value to @builder, opening and closing containers for half of
+ * them so that both ways of adding items get covered.
+ */
+static void
+stream_build_value (GVariantBuilder *builder,
+                    GVariant        *value)
+{
+  if (g_variant_is_container (value) && g_test_rand_bit ())
+    {
+      GVariantIter iter;
+      GVariant *child;
+
+      g_variant_builder_open (builder, g_variant_get_type (value));
+      g_variant_iter_init (&iter, value);
+      while ((child = g_variant_iter_next_value (&iter)))
+        {
+          stream_build_value (builder, child);
+          g_variant_unref (child);
+        }
+      g_variant_builder_close (builder);
+    }
+  else
+    g_variant_builder_add_value (builder, value);
+}
+
+static void
+test_streaming_builder (void)
+{
+  gint i;
+
+  for (i = 0; i < 100; i++)
+    {
+      GVariantBuilder builder;
+      TreeInstance *tree;
+      GVariant *value, *expected, *built;
+
+      tree = tree_instance_new (NULL, 3);
+      value = g_variant_ref_sink (tree_instance_get_gvariant (tree));
+      expected = g_variant_ref_sink (g_variant_new_variant (value));
+
+      g_variant_builder_init_streaming (&builder, G_VARIANT_TYPE_VARIANT);
+      stream_build_value (&builder, value);
+      built = g_variant_ref_sink (g_variant_builder_end (&builder));
+
+      g_assert (g_variant_is_normal_form (built));
+      g_assert (g_variant_equal (built, expected));
+      g_assert_cmpuint (g_variant_get_size (built), ==, g_variant_get_size (expected));
+      g_assert (memcmp (g_variant_get_data (built), g_variant_get_data (expected),
+                        g_variant_get_size (built)) == 0);
+
+      g_variant_unref (built);
+      g_variant_unref (expected);
+      g_variant_unref (value);
+      tree_instance_free (tree);
+    }
+
+  g_variant_type_info_assert_no_infos ();
+}
+
+/* Big enough for framing offsets of all sizes up to 4 bytes */
+static void
+test_streaming_builder_large (void)
+{
+  GVariantBuilder sb, tb;
+  GVariant *streamed, *built;
+  gint i;
+
+  g_variant_builder_init_streaming (&sb, G_VARIANT_TYPE ("a{sv}"));
+  g_variant_builder_init (&tb, G_VARIANT_TYPE ("a{sv}"));
+
+  for (i = 0; i < 10000; i++)
+    {
+      gchar key[32];
+
+      g_snprintf (key, sizeof key, "key-%d", i);
+      g_variant_builder_open (&sb, G_VARIANT_TYPE ("{sv}"));
+      g_variant_builder_add (&sb, "s", key);
+      g_variant_builder_add (&sb, "v", g_variant_new_int32 (i));
+      g_variant_builder_close (&sb);
+
+      g_variant_builder_add (&tb, "{sv}", key, g_variant_new_int32 (i));
+    }
+
+  streamed = g_variant_ref_sink (g_variant_builder_end (&sb));
+  built = g_variant_ref_sink (g_variant_builder_end (&tb));
+
+  g_assert_cmpuint (g_variant_get_size (streamed), >, G_MAXUINT16);
+  g_assert (g_variant_equal (streamed, built));
+  g_assert (memcmp (g_variant_get_data (streamed), g_variant_get_data (built),
+                    g_variant_get_size (built)) == 0);
+
+  g_variant_unref (streamed);
+  g_variant_unref (built);
+
+  /* Empty containers, an empty tuple and a fixed-size tuple */
+  g_variant_builder_init_streaming (&sb, G_VARIANT_TYPE ("(asm(s)()(yu))"));
+  g_variant_builder_open (&sb, G_VARIANT_TYPE ("as"));
+  g_variant_builder_close (&sb);
+  g_variant_builder_open (&sb, G_VARIANT_TYPE ("m(s)"));
+  g_variant_builder_close (&sb);
+  g_variant_builder_add (&sb, "()");
+  g_variant_builder_add (&sb, "(yu)", 1, 2);
+  streamed = g_variant_ref_sink (g_variant_builder_end (&sb));
+
+  built = g_variant_ref_sink (g_variant_new_parsed ("(@as [], @m(s) nothing, (), (byte 1, uint32 2))"));
+  g_assert (g_variant_equal (streamed, built));
+  g_assert (memcmp (g_variant_get_data (streamed), g_variant_get_data (built),
+                    g_variant_get_size (built)) == 0);
+
+  g_variant_unref (streamed);
+  g_variant_unref (built);
+
+  /* Every basic type, which takes a shortcut */
+  g_variant_builder_init_streaming (&sb, G_VARIANT_TYPE ("(bynqiuxthdsogv)"));
+  g_variant_builder_add (&sb, "b", TRUE);
+  g_variant_builder_add (&sb, "y", 1);
+  g_variant_builder_add (&sb, "n", -2);
+  g_variant_builder_add (&sb, "q", 3);
+  g_variant_builder_add (&sb, "i", -4);
+  g_variant_builder_add (&sb, "u", 5);
+  g_variant_builder_add (&sb, "x", G_GINT64_CONSTANT (-6));
+  g_variant_builder_add (&sb, "t", G_GUINT64_CONSTANT (7));
+  g_variant_builder_add (&sb, "h", 8);
+  g_variant_builder_add (&sb, "d", 9.5);
+  g_variant_builder_add (&sb, "s", "ten");
+  g_variant_builder_add (&sb, "o", "/eleven");
+  g_variant_builder_add (&sb, "g", "(ii)");
+  g_variant_builder_add (&sb, "v", g_variant_new_int32 (12));
+  streamed = g_variant_ref_sink (g_variant_builder_end (&sb));
+
+  built = g_variant_ref_sink (g_variant_new ("(bynqiuxthdsogv)", TRUE, 1, -2, 3, -4, 5,
+                                             G_GINT64_CONSTANT (-6), G_GUINT64_CONSTANT (7),
+                                             8, 9.5, "ten", "/eleven", "(ii)",
+                                             g_variant_new_int32 (12)));
+  g_assert (g_variant_equal (streamed, built));
+  g_assert (memcmp (g_variant_get_data (streamed), g_variant_get_data (built),
+                    g_variant_get_size (built)) == 0);
+
+  g_variant_unref (streamed);
+  g_variant_unref (built);
+
+  g_variant_type_info_assert_no_infos ();
+}
+
+static void
+test_streaming_builder_errors (void)
+{
+  GVariantBuilder sb;
+
+  if (!g_test_undefined ())
+    return;
+
+  g_variant_builder_init_streaming (&sb, G_VARIANT_TYPE ("(su)"));
+
+  g_test_expect_message (G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL, "*stream_builder_accepts*");
+  g_variant_builder_add (&sb, "u", 1);
+  g_test_assert_expected_messages ();
+
+  g_variant_builder_add (&sb, "s", "foo");
+
+  g_test_expect_message (G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL, "*closed*");
+  g_assert_null (g_variant_builder_end (&sb));
+  g_test_assert_expected_messages ();
+
+  g_test_expect_message (G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL, "*definite*");
+  g_variant_builder_open (&sb, G_VARIANT_TYPE ("a*"));
+  g_test_assert_expected_messages ();
+
+  g_variant_builder_clear (&sb);
+  g_variant_type_info_assert_no_infos ();
+}
+
 static void
 test_format_strings (void)
 {
@@ -2877,6 +3105,131 @@ test_invalid_varargs (void)
   g_variant_unref (value);
 }
 
+/* Children unpacked by g_variant_iter_next() may be borrowed */
+static void
+test_iter_next_borrowed (void)
+{
+  GVariantBuilder builder;
+  GVariant *array, *child, *variant;
+  GVariantIter iter;
+  const gchar *s;
+  gint32 i;
+  guint n;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sia{sv})"));
+  for (n = 0; n < 100; n++)
+    {
+      gchar *name = g_strdup_printf ("item %u", n);
+
+      g_variant_builder_open (&builder, G_VARIANT_TYPE ("(sia{sv})"));
+      g_variant_builder_add (&builder, "s", name);
+      g_variant_builder_add (&builder, "i", n);
+      g_variant_builder_open (&builder, G_VARIANT_TYPE ("a{sv}"));
+      g_variant_builder_add (&builder, "{sv}", "n", g_variant_new_uint32 (n));
+      g_variant_builder_close (&builder);
+      g_variant_builder_close (&builder);
+
+      g_free (name);
+    }
+  array = g_variant_ref_sink (g_variant_builder_end (&builder));
+  g_variant_get_data (array);
+
+  n = 0;
+  g_variant_iter_init (&iter, array);
+  while (g_variant_iter_next (&iter, "(&si@a{sv})", &s, &i, &child))
+    {
+      gchar *name = g_strdup_printf ("item %u", n);
+
+      g_assert_cmpstr (s, ==, name);
+      g_assert_cmpint (i, ==, n);
+
+      /* the dictionary is an ordinary instance */
+      g_assert (g_variant_lookup (child, "n", "u", &i));
+      g_assert_cmpint (i, ==, n);
+      g_variant_unref (child);
+
+      g_free (name);
+      n++;
+    }
+  g_assert_cmpint (n, ==, 100);
+
+  /* children that the caller keeps are never borrowed */
+  g_variant_iter_init (&iter, array);
+  g_assert (g_variant_iter_next (&iter, "@(sia{sv})", &child));
+  g_assert (g_variant_iter_next (&iter, "r", &variant));
+  g_variant_unref (array);
+
+  g_variant_get (child, "(&si*)", &s, &i, NULL);
+  g_assert_cmpstr (s, ==, "item 0");
+  g_variant_get (variant, "(&si*)", &s, &i, NULL);
+  g_assert_cmpstr (s, ==, "item 1");
+  g_variant_unref (variant);
+  g_variant_unref (child);
+}
+
+/* Checked format strings are remembered by their contents */
+static void
+test_varargs_format_cache (void)
+{
+  gchar format[16];
+  GVariant *value;
+  const gchar *s;
+  gint32 i;
+  gint n;
+
+  for (n = 0; n < 3; n++)
+    {
+      strcpy (format, "(si)");
+      value = g_variant_new (format, "abc", n);
+      g_assert_cmpstr (g_variant_get_type_string (value), ==, "(si)");
+
+      strcpy (format, "(&si)");
+      g_variant_get (value, format, &s, &i);
+      g_assert_cmpstr (s, ==, "abc");
+      g_assert_cmpint (i, ==, n);
+
+      /* the same buffer, now with a different format string */
+      strcpy (format, "(&sq)");
+      if (n == 2 && g_test_undefined ())
+        {
+          g_test_expect_message (G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL,
+                                 "*type of '(sq)' but * has a type of '(si)'*");
+          g_test_expect_message (G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL,
+                                 "*valid_format_string*");
+          g_variant_get (value, format, &s, &i);
+          g_test_assert_expected_messages ();
+        }
+
+      g_variant_unref (g_variant_ref_sink (value));
+
+      strcpy (format, "(sq)");
+      value = g_variant_new (format, "abc", n);
+      g_assert_cmpstr (g_variant_get_type_string (value), ==, "(sq)");
+      g_variant_unref (g_variant_ref_sink (value));
+    }
+
+  /* more distinct format strings than fit in the cache, some of them
+   * too long to be remembered at all
+   */
+  for (n = 1; n < 400; n++)
+    {
+      GVariantIter *iter;
+      gchar *array_format;
+
+      array_format = g_strnfill (n + 1, 'a');
+      array_format[n] = 'y';
+
+      value = g_variant_new (array_format, NULL);
+      g_assert_cmpstr (g_variant_get_type_string (value), ==, array_format);
+      g_variant_get (value, array_format, &iter);
+      g_assert_cmpint (g_variant_iter_n_children (iter), ==, 0);
+      g_variant_iter_free (iter);
+      g_variant_unref (g_variant_ref_sink (value));
+
+      g_free (array_format);
+    }
+}
+
 static void
 check_and_free (GVariant    *value,
                 const gchar *str)
@@ -3572,6 +3925,85 @@ test_hashing (void)
   g_variant_type_info_assert_no_infos ();
 }
 
+/* Fixed-width arrays are swapped as flat runs of words */
+static void
+test_gv_byteswap_arrays (void)
+{
+  const struct {
+    const gchar *type;
+    gsize word_size;  /* or 0 if the members differ in width */
+  } cases[] = {
+    { "an", 2 }, { "aq", 2 }, { "ai", 4 }, { "au", 4 }, { "ah", 4 },
+    { "ax", 8 }, { "at", 8 }, { "ad", 8 }, { "a(ii)", 4 }, { "a{tx}", 8 },
+    { "a(nq)", 2 }, { "a((ii)(uu))", 4 }, { "(ii)", 4 }, { "(tdx)", 8 },
+    { "a(iy)", 0 }, { "a(ix)", 0 }
+  };
+  guint i, n;
+
+  for (i = 0; i < G_N_ELEMENTS (cases); i++)
+    for (n = 0; n < 40; n += 7)
+      {
+        const GVariantType *type = G_VARIANT_TYPE (cases[i].type);
+        const GVariantType *element;
+        GVariant *untrusted, *value, *swapped, *twice;
+        const guchar *before, *after;
+        GVariantTypeInfo *info;
+        gsize element_size;
+        guchar *data;
+        gsize size, j;
+
+        element = g_variant_type_is_array (type) ? g_variant_type_element (type) : type;
+        info = g_variant_type_info_get (element);
+        g_variant_type_info_query (info, NULL, &element_size);
+        g_variant_type_info_unref (info);
+
+        size = g_variant_type_is_array (type) ? n * element_size : element_size;
+        data = g_malloc (size);
+        for (j = 0; j < size; j++)
+          data[j] = g_test_rand_int ();
+
+        /* normalising zeroes out any padding */
+        untrusted = g_variant_new_from_data (type, data, size, FALSE, g_free, data);
+        g_variant_ref_sink (untrusted);
+        value = g_variant_get_normal_form (untrusted);
+        g_variant_unref (untrusted);
+
+        swapped = g_variant_byteswap (value);
+        twice = g_variant_byteswap (swapped);
+        g_assert_true (g_variant_equal (value, twice));
+
+        before = g_variant_get_data (value);
+        after = g_variant_get_data (swapped);
+        g_assert_cmpuint (g_variant_get_size (swapped), ==, size);
+
+        if (cases[i].word_size)
+          {
+            gsize w = cases[i].word_size;
+
+            for (j = 0; j < size; j++)
+              g_assert_cmpuint (after[j], ==, before[j - j % w + (w - 1 - j % w)]);
+          }
+
+        /* the same as swapping each element on its own */
+        for (j = 0; j < g_variant_n_children (value); j++)
+          {
+            GVariant *child, *swapped_child, *expected;
+
+            child = g_variant_get_child_value (value, j);
+            swapped_child = g_variant_get_child_value (swapped, j);
+            expected = g_variant_byteswap (child);
+            g_assert_true (g_variant_equal (swapped_child, expected));
+            g_variant_unref (expected);
+            g_variant_unref (swapped_child);
+            g_variant_unref (child);
+          }
+
+        g_variant_unref (twice);
+        g_variant_unref (swapped);
+        g_variant_unref (value);
+      }
+}
+
 static void
 test_gv_byteswap (void)
 {
@@ -3913,6 +4345,96 @@ test_parse_failures (void)
     }
 }
 
+/* Parsing with a definite type given up front takes a separate path */
+static void
+test_parse_typed (void)
+{
+  const gchar *test[] = {
+    "ai",           "[1, 2, -3, 0x10, int32 4]",
+    "ad",           "[1, 2.5, inf, -1e10]",
+    "ab",           "[true, false, true]",
+    "ay",           "[]",
+    "ay",           "b'abc'",
+    "at",           "@at [18446744073709551615]",
+    "as",           "['a', \"b\", string 'c']",
+    "ao",           "['/', '/a/b']",
+    "aas",          "[[], ['x'], ['y', 'z']]",
+    "(i)",          "(5,)",
+    "(isd)",        "(1, 'x', 2)",
+    "((ii)u)",      "((1, 2), uint32 3)",
+    "()",           "()",
+    "a{sv}",        "{'a': <1>, 'b': <['x']>, 'c': <@mi nothing>}",
+    "a{sv}",        "{}",
+    "a{ii}",        "[{1, 2}, {3, 4}]",
+    "{sd}",         "{'pi', 3.14}",
+    "mi",           "just 5",
+    "mai",          "[1, 2]",
+    "v",            "<(1, 'x')>",
+    "a(sa{sv})",    "[('a', {'x': <true>}), ('b', {})]",
+    "x",            "-9223372036854775808",
+    "h",            "handle 1",
+    "d",            "5"
+  };
+  const gchar *failures[] = {
+    "ai",       "[1, 2",                "5:",           "expected ',' or ']'",
+    "ai",       "[1, 2, ]",             "7:",           "expected value",
+    "ay",       "[1, 256]",             "4-7:",         "out of range for type",
+    "ab",       "[true, 0]",            "7-8:",         "can not parse as",
+    "ai",       "[1, 'x']",             "4-7:",         "can not parse as",
+    "(ii)",     "(1, 2, 3)",            "0-9:",         "can not parse as",
+    "(ii)",     "(1 2)",                "3:",           "expected ','",
+    "a{sv}",    "{'a', <1>}",           "0-10:",        "can not parse as",
+    "{sd}",     "{'a': 1}",             "0-8:",         "can not parse as",
+    "a{sv}",    "{'a': 1}",             "6-7:",         "can not parse as",
+    "i",        "1 2",                  "2:",           "expected end of input",
+    "u",        "-1",                   "0-2:",         "out of range for type"
+  };
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (test); i += 2)
+    {
+      GVariant *typed, *annotated;
+      GError *error = NULL;
+      gchar *text;
+
+      typed = g_variant_parse (G_VARIANT_TYPE (test[i]), test[i+1],
+                               NULL, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpstr (g_variant_get_type_string (typed), ==, test[i]);
+
+      /* the type annotation goes through the general parser */
+      text = g_strdup_printf ("@%s %s", test[i], test[i+1]);
+      annotated = g_variant_parse (NULL, text, NULL, NULL, &error);
+      g_assert_no_error (error);
+
+      g_assert (g_variant_equal (typed, annotated));
+
+      g_variant_unref (annotated);
+      g_variant_unref (typed);
+      g_free (text);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (failures); i += 4)
+    {
+      GError *error = NULL;
+      GVariant *value;
+
+      value = g_variant_parse (G_VARIANT_TYPE (failures[i]), failures[i+1],
+                               NULL, NULL, &error);
+      g_assert (value == NULL);
+
+      if (!strstr (error->message, failures[i+3]))
+        g_error ("test %d: Can't find '%s' in '%s'", i / 4,
+                 failures[i+3], error->message);
+
+      if (!g_str_has_prefix (error->message, failures[i+2]))
+        g_error ("test %d: Expected location '%s' in '%s'", i / 4,
+                 failures[i+2], error->message);
+
+      g_error_free (error);
+    }
+}
+
 static void
 test_parse_bad_format_char (void)
 {
@@ -4130,6 +4652,160 @@ test_lookup (void)
   g_variant_unref (dict);
 }
 
+/* Big enough to be looked up through an index */
+static void
+test_lookup_indexed (void)
+{
+  GVariantBuilder builder;
+  GVariant *dict, *broken, *value;
+  const gchar *data;
+  gchar *copy;
+  gsize size, i;
+  gint n;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{si}"));
+  for (n = 0; n < 1000; n++)
+    {
+      gchar key[16];
+
+      g_snprintf (key, sizeof key, "key-%04d", n);
+      g_variant_builder_add (&builder, "{si}", key, n);
+    }
+  /* only the first entry for a key counts */
+  g_variant_builder_add (&builder, "{si}", "key-0500", -1);
+  dict = g_variant_ref_sink (g_variant_builder_end (&builder));
+
+  /* in tree form, this is still a linear scan */
+  value = g_variant_lookup_value (dict, "key-0999", G_VARIANT_TYPE_INT32);
+  g_assert_cmpint (g_variant_get_int32 (value), ==, 999);
+  g_variant_unref (value);
+
+  data = g_variant_get_data (dict);
+  size = g_variant_get_size (dict);
+
+  for (n = 0; n < 1000; n++)
+    {
+      gchar key[16];
+
+      g_snprintf (key, sizeof key, "key-%04d", n);
+      value = g_variant_lookup_value (dict, key, G_VARIANT_TYPE_INT32);
+      g_assert_nonnull (value);
+      g_assert_cmpint (g_variant_get_int32 (value), ==, n);
+      g_variant_unref (value);
+    }
+
+  g_assert_true (g_variant_lookup (dict, "key-0500", "i", &n));
+  g_assert_cmpint (n, ==, 500);
+  g_assert_false (g_variant_lookup (dict, "key-1000", "i", &n));
+  g_assert_false (g_variant_lookup (dict, "", "i", &n));
+
+  /* An invalid key in untrusted data is looked up as "", as with a
+   * linear scan through g_variant_get_string()
+   */
+  copy = g_memdup (data, size);
+  for (i = 0; i + 9 <= size; i++)
+    if (memcmp (copy + i, "key-0042", 9) == 0)
+      copy[i] = '\xff';
+
+  broken = g_variant_ref_sink (g_variant_new_from_data (G_VARIANT_TYPE ("a{si}"),
+                                                        copy, size, FALSE,
+                                                        g_free, copy));
+  g_assert_false (g_variant_lookup (broken, "key-0042", "i", &n));
+  g_assert_true (g_variant_lookup (broken, "", "i", &n));
+  g_assert_cmpint (n, ==, 42);
+  g_assert_true (g_variant_lookup (broken, "key-0043", "i", &n));
+  g_assert_cmpint (n, ==, 43);
+
+  g_variant_unref (broken);
+  g_variant_unref (dict);
+}
+
+static void
+test_new_from_file (void)
+{
+  GVariantBuilder builder;
+  GVariant *array, *loaded, *child;
+  GError *error = NULL;
+  gchar *filename;
+  gchar *data;
+  gchar *item;
+  gsize size;
+  gint fd;
+  gint i;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE_STRING_ARRAY);
+  for (i = 0; i < 1000; i++)
+    {
+      gchar name[16];
+
+      g_snprintf (name, sizeof name, "item-%04d", i);
+      g_variant_builder_add (&builder, "s", name);
+    }
+  array = g_variant_ref_sink (g_variant_builder_end (&builder));
+
+  fd = g_file_open_tmp ("gvariant-XXXXXX", &filename, &error);
+  g_assert_no_error (error);
+  g_close (fd, NULL);
+
+  g_file_set_contents (filename, g_variant_get_data (array),
+                       g_variant_get_size (array), &error);
+  g_assert_no_error (error);
+
+  loaded = g_variant_new_from_file (G_VARIANT_TYPE_STRING_ARRAY, filename,
+                                    G_VARIANT_FILE_FLAGS_TRUSTED |
+                                    G_VARIANT_FILE_FLAGS_PREFETCH,
+                                    &error);
+  g_assert_no_error (error);
+  g_variant_ref_sink (loaded);
+  g_assert_true (g_variant_equal (loaded, array));
+  g_assert_true (g_variant_validate_children (loaded, 0, 1000));
+  g_variant_unref (loaded);
+
+  /* break the termination of one string in the middle */
+  g_file_get_contents (filename, &data, &size, &error);
+  g_assert_no_error (error);
+  for (item = data; memcmp (item, "item-0500", 10) != 0; item++)
+    g_assert_cmpint (item - data, <, size - 10);
+  item[9] = 'x';
+  g_file_set_contents (filename, data, size, &error);
+  g_assert_no_error (error);
+  g_free (data);
+
+  loaded = g_variant_new_from_file (G_VARIANT_TYPE_STRING_ARRAY, filename,
+                                    G_VARIANT_FILE_FLAGS_RANDOM_ACCESS,
+                                    &error);
+  g_assert_no_error (error);
+  g_variant_ref_sink (loaded);
+  g_assert_cmpuint (g_variant_n_children (loaded), ==, 1000);
+
+  g_assert_true (g_variant_validate_children (loaded, 0, 500));
+  g_assert_false (g_variant_validate_children (loaded, 0, 501));
+  g_assert_false (g_variant_validate_children (loaded, 500, 1));
+  g_assert_true (g_variant_validate_children (loaded, 501, 499));
+  g_assert_true (g_variant_validate_children (loaded, 1000, 0));
+
+  child = g_variant_get_child_value (loaded, 499);
+  g_assert_cmpstr (g_variant_get_string (child, NULL), ==, "item-0499");
+  g_variant_unref (child);
+  child = g_variant_get_child_value (loaded, 500);
+  g_assert_cmpstr (g_variant_get_string (child, NULL), ==, "");
+  g_variant_unref (child);
+
+  g_assert_false (g_variant_is_normal_form (loaded));
+  g_variant_unref (loaded);
+
+  g_unlink (filename);
+
+  loaded = g_variant_new_from_file (G_VARIANT_TYPE_STRING_ARRAY, filename,
+                                    G_VARIANT_FILE_FLAGS_NONE, &error);
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+  g_assert_null (loaded);
+  g_clear_error (&error);
+
+  g_free (filename);
+  g_variant_unref (array);
+}
+
 static GVariant *
 untrusted (GVariant *a)
 {
@@ -4608,6 +5284,7 @@ main (int argc, char **argv)
 
   g_test_add_func ("/gvariant/type", test_gvarianttype);
   g_test_add_func ("/gvariant/typeinfo", test_gvarianttypeinfo);
+  g_test_add_func ("/gvariant/typeinfo/threaded", test_gvarianttypeinfo_threaded);
   g_test_add_func ("/gvariant/serialiser/maybe", test_maybes);
   g_test_add_func ("/gvariant/serialiser/array", test_arrays);
   g_test_add_func ("/gvariant/serialiser/tuple", test_tuples);
@@ -4631,13 +5308,20 @@ main (int argc, char **argv)
   g_test_add_func ("/gvariant/format-strings", test_format_strings);
   g_test_add_func ("/gvariant/invalid-varargs", test_invalid_varargs);
   g_test_add_func ("/gvariant/varargs", test_varargs);
+  g_test_add_func ("/gvariant/varargs/format-cache", test_varargs_format_cache);
+  g_test_add_func ("/gvariant/iter/next-borrowed", test_iter_next_borrowed);
   g_test_add_func ("/gvariant/varargs/subprocess/empty-array", test_varargs_empty_array);
   g_test_add_func ("/gvariant/valist", test_valist);
   g_test_add_func ("/gvariant/builder-memory", test_builder_memory);
+  g_test_add_func ("/gvariant/streaming-builder", test_streaming_builder);
+  g_test_add_func ("/gvariant/streaming-builder/large", test_streaming_builder_large);
+  g_test_add_func ("/gvariant/streaming-builder/errors", test_streaming_builder_errors);
   g_test_add_func ("/gvariant/hashing", test_hashing);
   g_test_add_func ("/gvariant/byteswap", test_gv_byteswap);
+  g_test_add_func ("/gvariant/byteswap/arrays", test_gv_byteswap_arrays);
   g_test_add_func ("/gvariant/parser", test_parses);
   g_test_add_func ("/gvariant/parse-failures", test_parse_failures);
+  g_test_add_func ("/gvariant/parse-typed", test_parse_typed);
   g_test_add_func ("/gvariant/parse-positional", test_parse_positional);
   g_test_add_func ("/gvariant/parse/subprocess/bad-format-char", test_parse_bad_format_char);
   g_test_add_func ("/gvariant/parse/subprocess/bad-format-string", test_parse_bad_format_string);
@@ -4646,6 +5330,8 @@ main (int argc, char **argv)
   g_test_add_func ("/gvariant/bytestring", test_bytestring);
   g_test_add_func ("/gvariant/lookup-value", test_lookup_value);
   g_test_add_func ("/gvariant/lookup", test_lookup);
+  g_test_add_func ("/gvariant/lookup-indexed", test_lookup_indexed);
+  g_test_add_func ("/gvariant/new-from-file", test_new_from_file);
   g_test_add_func ("/gvariant/compare", test_compare);
   g_test_add_func ("/gvariant/equal", test_equal);
   g_test_add_func ("/gvariant/fixed-array", test_fixed_array);
@@ -65,6 +65,16 @@ test_semantics (void)
   g_wakeup_acknowledge (wakeup);
   g_assert (!check_signaled (wakeup));
 
+  /* ensure signals after an acknowledgement are not swallowed */
+  for (i = 0; i < 3; i++)
+    {
+      g_wakeup_signal (wakeup);
+      g_wakeup_signal (wakeup);
+      g_assert (check_signaled (wakeup));
+      g_wakeup_acknowledge (wakeup);
+      g_assert (!check_signaled (wakeup));
+    }
+
   g_wakeup_free (wakeup);
 
   /* cancel the alarm */
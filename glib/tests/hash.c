@@ -1194,14 +1194,15 @@ test_foreach_steal (void)
 struct _GHashTable
 {
   gint             size;
-  gint             mod;
-  guint            mask;
+  guint            group_mask;
   gint             nnodes;
   gint             noccupied;  /* nnodes + tombstones */
+  gint             min_size;
 
+  guint8          *ctrl;
   gpointer        *keys;
-  guint           *hashes;
   gpointer        *values;
+  guint            entry_shift;
 
   GHashFunc        hash_func;
   GEqualFunc       key_equal_func;
@@ -1214,6 +1215,12 @@ struct _GHashTable
   GDestroyNotify   value_destroy_func;
 };
 
+#define CTRL_EMPTY      0x80
+#define CTRL_TOMBSTONE  0xfe
+
+#define NODE_KEY(h, i)   ((h)->keys[(gsize) (i) << (h)->entry_shift])
+#define NODE_VALUE(h, i) ((h)->values[(gsize) (i) << (h)->entry_shift])
+
 static void
 count_keys (GHashTable *h, gint *unused, gint *occupied, gint *tombstones)
 {
@@ -1224,12 +1231,15 @@ count_keys (GHashTable *h, gint *unused, gint *occupied, gint *tombstones)
   *tombstones = 0;
   for (i = 0; i < h->size; i++)
     {
-      if (h->hashes[i] == 0)
+      if (h->ctrl[i] == CTRL_EMPTY)
         (*unused)++;
-      else if (h->hashes[i] == 1)
+      else if (h->ctrl[i] == CTRL_TOMBSTONE)
         (*tombstones)++;
       else
-        (*occupied)++;
+        {
+          g_assert_cmpint (h->ctrl[i], <, 0x80);
+          (*occupied)++;
+        }
     }
 }
 
@@ -1238,16 +1248,20 @@ check_data (GHashTable *h)
 {
   gint i;
 
+  g_assert (h->values == h->keys + h->entry_shift);
+
   for (i = 0; i < h->size; i++)
     {
-      if (h->hashes[i] < 2)
+      if (h->ctrl[i] >= 0x80)
         {
-          g_assert (h->keys[i] == NULL);
-          g_assert (h->values[i] == NULL);
+          g_assert (NODE_KEY (h, i) == NULL);
+          g_assert (NODE_VALUE (h, i) == NULL);
         }
       else
         {
-          g_assert_cmpint (h->hashes[i], ==, h->hash_func (h->keys[i]));
+          guint64 scrambled = (guint64) h->hash_func (NODE_KEY (h, i)) * G_GUINT64_CONSTANT (0x9e3779b97f4a7c15);
+
+          g_assert_cmpint (h->ctrl[i], ==, (guint8) (scrambled >> 57));
         }
     }
 }
@@ -1300,20 +1314,21 @@ test_internal_consistency (void)
   check_counts (h, 6, 0);
   check_consistency (h);
 
+  /* Removing from a group with empty slots leaves no tombstone */
   g_hash_table_remove (h, "a");
-  check_counts (h, 5, 1);
+  check_counts (h, 5, 0);
   check_consistency (h);
 
   g_hash_table_remove (h, "b");
-  check_counts (h, 4, 2);
+  check_counts (h, 4, 0);
   check_consistency (h);
 
   g_hash_table_insert (h, "c", "c");
-  check_counts (h, 4, 2);
+  check_counts (h, 4, 0);
   check_consistency (h);
 
   g_hash_table_insert (h, "a", "A");
-  check_counts (h, 5, 1);
+  check_counts (h, 5, 0);
   check_consistency (h);
 
   g_hash_table_remove_all (h);
@@ -1323,6 +1338,60 @@ test_internal_consistency (void)
   g_hash_table_unref (h);
 }
 
+static void
+test_internal_consistency_collisions (void)
+{
+  gchar *keys[20];
+  GHashTable *h;
+  gint unused, occupied, tombstones;
+  gint i;
+
+  /* All keys collide, so the first group they probe fills up, and
+   * removing from it has to leave a tombstone
+   */
+  h = g_hash_table_new_full (one_hash, g_str_equal, g_free, NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (keys); i++)
+    {
+      keys[i] = g_strdup_printf ("%d", i);
+      g_hash_table_insert (h, keys[i], GINT_TO_POINTER (i));
+    }
+  check_counts (h, 20, 0);
+  check_consistency (h);
+
+  for (i = 0; i < G_N_ELEMENTS (keys); i++)
+    {
+      g_assert (g_hash_table_steal (h, keys[i]));
+      check_consistency (h);
+
+      count_keys (h, &unused, &occupied, &tombstones);
+      if (tombstones > 0)
+        break;
+    }
+  g_assert_cmpint (i, <, G_N_ELEMENTS (keys));
+  check_counts (h, 19 - i, 1);
+
+  /* the tombstone is reused first */
+  g_hash_table_insert (h, keys[i], GINT_TO_POINTER (i));
+  check_counts (h, 20 - i, 0);
+  check_consistency (h);
+
+  for (i = 0; i < G_N_ELEMENTS (keys); i++)
+    {
+      gpointer key, value;
+
+      if (g_hash_table_lookup_extended (h, keys[i], &key, &value))
+        {
+          g_assert (key == keys[i]);
+          g_assert_cmpint (GPOINTER_TO_INT (value), ==, i);
+        }
+      else
+        g_free (keys[i]);
+    }
+
+  g_hash_table_unref (h);
+}
+
 static void
 my_key_free (gpointer v)
 {
@@ -1418,6 +1487,103 @@ test_set_insert_corruption (void)
   g_hash_table_unref (hash_table);
 }
 
+static void
+test_str_hash_seeded (void)
+{
+  GHashTable *h;
+  gchar *copy;
+  gchar key[64];
+  gint i;
+
+  copy = g_strdup ("/org/gtk/Application/a/longer/object/path");
+  g_assert_cmpuint (g_str_hash_seeded (copy), ==, g_str_hash_seeded ("/org/gtk/Application/a/longer/object/path"));
+  g_assert_cmpuint (g_str_hash_seeded (copy), !=, g_str_hash_seeded ("/org/gtk/Application/a/longer/object/patH"));
+  g_free (copy);
+
+  h = g_hash_table_new_full (g_str_hash_seeded, g_str_equal, g_free, NULL);
+
+  /* all lengths around the eight byte words */
+  for (i = 0; i < 40; i++)
+    {
+      memset (key, 'a', i);
+      key[i] = '\0';
+      g_assert (g_hash_table_add (h, g_strdup (key)));
+    }
+
+  for (i = 0; i < 40; i++)
+    {
+      memset (key, 'a', i);
+      key[i] = '\0';
+      g_assert (g_hash_table_contains (h, key));
+    }
+  g_assert_cmpuint (g_hash_table_size (h), ==, 40);
+
+  g_hash_table_unref (h);
+}
+
+static void
+test_hashed (void)
+{
+  GHashTable *h;
+  gchar *key;
+  gpointer orig_key, value;
+
+  h = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  key = g_strdup ("abc");
+  g_assert (g_hash_table_insert_hashed (h, key, GINT_TO_POINTER (1), g_str_hash ("abc")));
+  g_assert (!g_hash_table_insert_hashed (h, g_strdup ("abc"), GINT_TO_POINTER (2), g_str_hash ("abc")));
+  g_assert (g_hash_table_lookup_extended_hashed (h, "abc", g_str_hash ("abc"), &orig_key, &value));
+  g_assert (orig_key == key);
+  g_assert_cmpint (GPOINTER_TO_INT (value), ==, 2);
+
+  g_assert (!g_hash_table_replace_hashed (h, g_strdup ("abc"), GINT_TO_POINTER (3), g_str_hash ("abc")));
+  g_assert (g_hash_table_lookup_extended_hashed (h, "abc", g_str_hash ("abc"), &orig_key, NULL));
+  g_assert (orig_key != key);
+
+  /* interchangeable with the plain calls */
+  g_assert_cmpint (GPOINTER_TO_INT (g_hash_table_lookup (h, "abc")), ==, 3);
+  g_hash_table_insert (h, g_strdup ("def"), GINT_TO_POINTER (4));
+  g_assert_cmpint (GPOINTER_TO_INT (g_hash_table_lookup_hashed (h, "def", g_str_hash ("def"))), ==, 4);
+  g_assert_null (g_hash_table_lookup_hashed (h, "ghi", g_str_hash ("ghi")));
+
+  g_hash_table_unref (h);
+}
+
+static void
+test_reserve (void)
+{
+  GHashTable *h;
+  gint size;
+  gint i;
+
+  h = g_hash_table_new (NULL, NULL);
+  g_hash_table_insert (h, GINT_TO_POINTER (-1), GINT_TO_POINTER (-1));
+
+  g_hash_table_reserve (h, 1000);
+  size = h->size;
+  g_assert_cmpint (size, >=, 1000);
+  g_assert_cmpint (GPOINTER_TO_INT (g_hash_table_lookup (h, GINT_TO_POINTER (-1))), ==, -1);
+
+  for (i = 0; i < 1000; i++)
+    g_hash_table_insert (h, GINT_TO_POINTER (i), GINT_TO_POINTER (i));
+  g_assert_cmpint (h->size, ==, size);
+
+  /* it does not shrink below the reserved size either */
+  for (i = 0; i < 1000; i++)
+    g_hash_table_remove (h, GINT_TO_POINTER (i));
+  g_assert_cmpint (h->size, ==, size);
+  g_hash_table_remove_all (h);
+  g_assert_cmpint (h->size, ==, size);
+
+  g_hash_table_reserve (h, 0);
+  g_hash_table_insert (h, GINT_TO_POINTER (1), GINT_TO_POINTER (1));
+  g_assert_cmpint (h->size, <, size);
+  g_assert_cmpint (GPOINTER_TO_INT (g_hash_table_lookup (h, GINT_TO_POINTER (1))), ==, 1);
+
+  g_hash_table_unref (h);
+}
+
 static void
 test_set_to_strv (void)
 {
@@ -1520,9 +1686,13 @@ main (int argc, char *argv[])
   g_test_add_func ("/hash/lookup-null-key", test_lookup_null_key);
   g_test_add_func ("/hash/destroy-modify", test_destroy_modify);
   g_test_add_func ("/hash/consistency", test_internal_consistency);
+  g_test_add_func ("/hash/consistency/collisions", test_internal_consistency_collisions);
   g_test_add_func ("/hash/iter-replace", test_iter_replace);
   g_test_add_func ("/hash/set-insert-corruption", test_set_insert_corruption);
   g_test_add_func ("/hash/set-to-strv", test_set_to_strv);
+  g_test_add_func ("/hash/str-hash-seeded", test_str_hash_seeded);
+  g_test_add_func ("/hash/hashed", test_hashed);
+  g_test_add_func ("/hash/reserve", test_reserve);
   g_test_add_func ("/hash/primes", test_primes);
 
   return g_test_run ();
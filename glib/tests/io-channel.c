@@ -0,0 +1,246 @@
+/* GLib testing framework examples and tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#define N_LINES 5000
+
+static gchar *
+write_temp_file (const gchar *contents,
+                 gsize        length)
+{
+  GError *error = NULL;
+  gchar *filename;
+  gint fd;
+
+  fd = g_file_open_tmp ("io-channel-XXXXXX", &filename, &error);
+  g_assert_no_error (error);
+  g_close (fd, NULL);
+
+  g_file_set_contents (filename, contents, length, &error);
+  g_assert_no_error (error);
+
+  return filename;
+}
+
+static gchar *
+make_line (guint i)
+{
+  return g_strdup_printf ("line %u: caf\xc3\xa9 %*s", i, (gint) (i % 37), "");
+}
+
+static void
+test_read_line_borrowed (gconstpointer data)
+{
+  const gchar *encoding = data;
+  GIOChannel *channel;
+  GError *error = NULL;
+  GString *contents, *line_string;
+  gchar *filename, *expected, *line;
+  const gchar *borrowed;
+  GIOStatus status;
+  gsize length, terminator_pos;
+  gunichar c;
+  guint i;
+
+  contents = g_string_new (NULL);
+  for (i = 0; i < N_LINES; i++)
+    {
+      expected = make_line (i);
+      g_string_append_printf (contents, "%s\n", expected);
+      g_free (expected);
+    }
+  g_string_append (contents, "unterminated");
+
+  if (g_strcmp0 (encoding, "ISO-8859-1") == 0)
+    {
+      gsize converted_len;
+      gchar *converted;
+
+      converted = g_convert (contents->str, contents->len, encoding, "UTF-8",
+                             NULL, &converted_len, &error);
+      g_assert_no_error (error);
+      filename = write_temp_file (converted, converted_len);
+      g_free (converted);
+    }
+  else
+    filename = write_temp_file (contents->str, contents->len);
+
+  channel = g_io_channel_new_file (filename, "r", &error);
+  g_assert_no_error (error);
+  g_io_channel_set_encoding (channel, encoding, &error);
+  g_assert_no_error (error);
+
+  line_string = g_string_new (NULL);
+
+  /* Mix borrowed reads with the other ways of reading, to check that
+   * they all agree on how much of the buffer has been consumed.
+   */
+  for (i = 0; i < N_LINES; i++)
+    {
+      expected = make_line (i);
+
+      switch (i % 4)
+        {
+        case 0:
+        case 1:
+          status = g_io_channel_read_line_borrowed (channel, &borrowed, &length,
+                                                    &terminator_pos, &error);
+          g_assert_no_error (error);
+          g_assert_cmpint (status, ==, G_IO_STATUS_NORMAL);
+          g_assert_cmpuint (length, ==, strlen (expected) + 1);
+          g_assert_cmpuint (terminator_pos, ==, strlen (expected));
+          g_assert (memcmp (borrowed, expected, terminator_pos) == 0);
+          g_assert_cmpint (borrowed[terminator_pos], ==, '\n');
+          break;
+
+        case 2:
+          status = g_io_channel_read_line (channel, &line, NULL, NULL, &error);
+          g_assert_no_error (error);
+          g_assert_cmpint (status, ==, G_IO_STATUS_NORMAL);
+          g_assert (g_str_has_prefix (line, expected));
+          g_free (line);
+          break;
+
+        case 3:
+          if (encoding != NULL)
+            {
+              /* the first character of the line is 'l' */
+              status = g_io_channel_read_unichar (channel, &c, &error);
+              g_assert_no_error (error);
+              g_assert_cmpint (status, ==, G_IO_STATUS_NORMAL);
+              g_assert_cmpuint (c, ==, 'l');
+            }
+          else
+            {
+              gchar ch;
+
+              status = g_io_channel_read_chars (channel, &ch, 1, NULL, &error);
+              g_assert_no_error (error);
+              g_assert_cmpint (status, ==, G_IO_STATUS_NORMAL);
+              g_assert_cmpint (ch, ==, 'l');
+            }
+          status = g_io_channel_read_line_string (channel, line_string, NULL, &error);
+          g_assert_no_error (error);
+          g_assert_cmpint (status, ==, G_IO_STATUS_NORMAL);
+          g_assert (g_str_has_prefix (line_string->str, expected + 1));
+          break;
+        }
+
+      g_free (expected);
+    }
+
+  status = g_io_channel_read_line_borrowed (channel, &borrowed, &length,
+                                            &terminator_pos, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (status, ==, G_IO_STATUS_NORMAL);
+  g_assert_cmpuint (length, ==, strlen ("unterminated"));
+  g_assert (memcmp (borrowed, "unterminated", length) == 0);
+
+  status = g_io_channel_read_line_borrowed (channel, &borrowed, &length,
+                                            NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (status, ==, G_IO_STATUS_EOF);
+  g_assert_cmpuint (length, ==, 0);
+  g_assert_null (borrowed);
+
+  g_io_channel_unref (channel);
+  g_string_free (line_string, TRUE);
+  g_string_free (contents, TRUE);
+  g_unlink (filename);
+  g_free (filename);
+}
+
+static void
+test_read_chars_large (void)
+{
+  GIOChannel *channel;
+  GError *error = NULL;
+  gchar *contents, *buf, *filename;
+  gsize length = 200 * 1024;
+  gsize got, bytes_read;
+  GIOStatus status;
+  gsize i;
+
+  contents = g_malloc (length);
+  for (i = 0; i < length; i++)
+    contents[i] = (i * 7 + i / 251) & 0xff;
+  filename = write_temp_file (contents, length);
+
+  channel = g_io_channel_new_file (filename, "r", &error);
+  g_assert_no_error (error);
+  g_io_channel_set_encoding (channel, NULL, &error);
+  g_assert_no_error (error);
+
+  buf = g_malloc (length + 1);
+  got = 0;
+
+  /* A small read leaves data in the buffer, then large reads go
+   * straight into the caller's buffer.
+   */
+  status = g_io_channel_read_chars (channel, buf, 10, &bytes_read, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (status, ==, G_IO_STATUS_NORMAL);
+  g_assert_cmpuint (bytes_read, ==, 10);
+  got += bytes_read;
+
+  status = g_io_channel_read_chars (channel, buf + got, 100000, &bytes_read, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (status, ==, G_IO_STATUS_NORMAL);
+  g_assert_cmpuint (bytes_read, ==, 100000);
+  got += bytes_read;
+
+  while (TRUE)
+    {
+      status = g_io_channel_read_chars (channel, buf + got,
+                                        MIN (3000, length - got + 1),
+                                        &bytes_read, &error);
+      g_assert_no_error (error);
+      got += bytes_read;
+      if (status == G_IO_STATUS_EOF)
+        break;
+      g_assert_cmpint (status, ==, G_IO_STATUS_NORMAL);
+    }
+
+  g_assert_cmpuint (got, ==, length);
+  g_assert (memcmp (buf, contents, length) == 0);
+
+  g_io_channel_unref (channel);
+  g_free (buf);
+  g_free (contents);
+  g_unlink (filename);
+  g_free (filename);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_data_func ("/io-channel/read-line-borrowed/utf8", "UTF-8",
+                        test_read_line_borrowed);
+  g_test_add_data_func ("/io-channel/read-line-borrowed/latin1", "ISO-8859-1",
+                        test_read_line_borrowed);
+  g_test_add_data_func ("/io-channel/read-line-borrowed/raw", NULL,
+                        test_read_line_borrowed);
+  g_test_add_func ("/io-channel/read-chars-large", test_read_chars_large);
+
+  return g_test_run ();
+}
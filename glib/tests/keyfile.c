@@ -730,9 +730,17 @@ test_locale_string (void)
   check_locale_string_value (keyfile, "valid", "key1", "fr", "v1");
   check_locale_string_value (keyfile, "valid", "key1", "fr_FR", "v1");
   check_locale_string_value (keyfile, "valid", "key1", "en", "v1");
+  g_assert (!g_key_file_has_key (keyfile, "valid", "key1[fr]", NULL));
+  g_assert (!g_key_file_has_key (keyfile, "valid", "key1[sr@Latn]", NULL));
 
   g_key_file_free (keyfile);
 
+  /* translations which are thrown away must still be valid keys */
+  keyfile = g_key_file_new ();
+  g_assert (!g_key_file_load_from_data (keyfile, "[valid]\nkey1[f r]=v1-fr\n", -1, 0, NULL));
+  g_assert (!g_key_file_load_from_data (keyfile, "[valid]\nkey1[fr=v1-fr\n", -1, 0, NULL));
+  g_key_file_free (keyfile);
+
   setlocale (LC_ALL, old_locale);
   g_free (old_locale);
 }
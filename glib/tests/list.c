@@ -46,6 +46,46 @@ test_list_sort (void)
   g_list_free (list);
 }
 
+static gint
+compare_modulo (gconstpointer p1, gconstpointer p2)
+{
+  return GPOINTER_TO_INT (p1) % 1000 - GPOINTER_TO_INT (p2) % 1000;
+}
+
+static void
+test_list_sort_stable (void)
+{
+  GList *list = NULL, *l;
+  gint n, i;
+
+  /* lengths around powers of two, and a large one */
+  for (n = 0; n <= 100000; n = (n < 70 ? n + 1 : n * 4 + 1))
+    {
+      /* the key is in the low digits, the original position above */
+      list = NULL;
+      for (i = n - 1; i >= 0; i--)
+        list = g_list_prepend (list, GINT_TO_POINTER (i * 1000 + (i * 7919) % 997));
+
+      list = g_list_sort (list, compare_modulo);
+      g_assert_cmpuint (g_list_length (list), ==, n);
+      g_assert (list == NULL || list->prev == NULL);
+
+      /* elements with the same key keep their order */
+      for (l = list; l != NULL && l->next != NULL; l = l->next)
+        {
+          gint a = GPOINTER_TO_INT (l->data);
+          gint b = GPOINTER_TO_INT (l->next->data);
+
+          g_assert (l->next->prev == l);
+          g_assert_cmpint (a % 1000, <=, b % 1000);
+          if (a % 1000 == b % 1000)
+            g_assert_cmpint (a / 1000, <, b / 1000);
+        }
+
+      g_list_free (list);
+    }
+}
+
 static void
 test_list_sort_with_data (void)
 {
@@ -528,6 +568,7 @@ main (int argc, char *argv[])
     array[i] = g_test_rand_int_range (NUMBER_MIN, NUMBER_MAX);
 
   g_test_add_func ("/list/sort", test_list_sort);
+  g_test_add_func ("/list/sort-stable", test_list_sort_stable);
   g_test_add_func ("/list/sort-with-data", test_list_sort_with_data);
   g_test_add_func ("/list/insert-sorted", test_list_insert_sorted);
   g_test_add_func ("/list/insert-sorted-with-data", test_list_insert_sorted_with_data);
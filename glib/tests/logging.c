@@ -554,6 +554,199 @@ test_structured_logging_variant2 (void)
   g_assert (expected_messages == NULL);
 }
 
+static gint
+count_evaluation (gint *count)
+{
+  return ++*count;
+}
+
+/* Test that g_log_level_is_enabled() is only FALSE for messages nobody
+ * would see, and that g_debug() doesn't evaluate its arguments for them
+ */
+static void
+test_level_is_enabled (void)
+{
+  gint evaluated = 0;
+  GLogFunc old_handler;
+  guint id;
+
+  /* the test framework's own handler sees everything */
+  g_assert (g_log_level_is_enabled ("bu", G_LOG_LEVEL_DEBUG));
+
+  old_handler = g_log_set_default_handler (g_log_default_handler, NULL);
+  g_log_set_writer_func (g_log_writer_default, NULL, NULL);
+  g_unsetenv ("G_MESSAGES_DEBUG");
+
+  g_assert (g_log_level_is_enabled ("bu", G_LOG_LEVEL_WARNING));
+  g_assert (g_log_level_is_enabled ("bu", G_LOG_LEVEL_MESSAGE));
+  g_assert (g_log_level_is_enabled ("bu", 1 << G_LOG_LEVEL_USER_SHIFT));
+  g_assert (g_log_level_is_enabled ("bu", G_LOG_LEVEL_DEBUG | G_LOG_LEVEL_WARNING));
+  g_assert (g_log_level_is_enabled ("bu", G_LOG_LEVEL_DEBUG | G_LOG_FLAG_FATAL));
+  g_assert (!g_log_level_is_enabled ("bu", G_LOG_LEVEL_DEBUG));
+  g_assert (!g_log_level_is_enabled (NULL, G_LOG_LEVEL_INFO));
+
+  g_debug ("%d", count_evaluation (&evaluated));
+  g_info ("%d", count_evaluation (&evaluated));
+  g_assert_cmpint (evaluated, ==, 0);
+
+  g_setenv ("G_MESSAGES_DEBUG", "bu ba", TRUE);
+  g_assert (g_log_level_is_enabled ("bu", G_LOG_LEVEL_DEBUG));
+  g_assert (!g_log_level_is_enabled ("be", G_LOG_LEVEL_DEBUG));
+  g_assert (!g_log_level_is_enabled (NULL, G_LOG_LEVEL_DEBUG));
+  g_setenv ("G_MESSAGES_DEBUG", "all", TRUE);
+  g_assert (g_log_level_is_enabled (NULL, G_LOG_LEVEL_DEBUG));
+  g_unsetenv ("G_MESSAGES_DEBUG");
+
+  id = g_log_set_handler ("bu", G_LOG_LEVEL_INFO, log_handler, NULL);
+  g_assert (g_log_level_is_enabled ("bu", G_LOG_LEVEL_DEBUG));
+  g_log_remove_handler ("bu", id);
+  g_assert (!g_log_level_is_enabled ("bu", G_LOG_LEVEL_DEBUG));
+
+  g_log_set_fatal_mask ("bu", G_LOG_LEVEL_DEBUG);
+  g_assert (g_log_level_is_enabled ("bu", G_LOG_LEVEL_DEBUG));
+  g_log_set_fatal_mask ("bu", 0);
+
+  g_log_set_writer_func (null_log_writer, NULL, NULL);
+  g_assert (g_log_level_is_enabled ("bu", G_LOG_LEVEL_DEBUG));
+  log_count = 0;
+  g_debug ("%d", count_evaluation (&evaluated));
+  g_assert_cmpint (evaluated, ==, 1);
+  g_assert_cmpint (log_count, ==, 1);
+  g_log_set_writer_func (g_log_writer_default, NULL, NULL);
+
+  g_test_expect_message ("bu", G_LOG_LEVEL_DEBUG, "expected");
+  g_assert (g_log_level_is_enabled ("bu", G_LOG_LEVEL_DEBUG));
+  g_log ("bu", G_LOG_LEVEL_DEBUG, "expected");
+  g_test_assert_expected_messages ();
+
+  g_log_set_default_handler (old_handler, NULL);
+}
+
+typedef struct {
+  GMutex lock;
+  GCond cond;
+  gboolean entered;
+  gboolean held;
+  GPtrArray *messages;
+} AsyncLog;
+
+static GLogWriterOutput
+async_log_writer (GLogLevelFlags   log_level,
+                  const GLogField *fields,
+                  gsize            n_fields,
+                  gpointer         user_data)
+{
+  AsyncLog *log = user_data;
+  gsize i;
+
+  g_mutex_lock (&log->lock);
+  log->entered = TRUE;
+  g_cond_broadcast (&log->cond);
+  while (log->held)
+    g_cond_wait (&log->cond, &log->lock);
+
+  for (i = 0; i < n_fields; i++)
+    if (strcmp (fields[i].key, "MESSAGE") == 0)
+      g_ptr_array_add (log->messages, g_strdup (fields[i].value));
+  g_mutex_unlock (&log->lock);
+
+  return G_LOG_WRITER_HANDLED;
+}
+
+static GLogWriterOutput
+async_log (GLogAsyncWriter *writer,
+           const gchar     *message)
+{
+  const GLogField fields[] = {
+    { "MESSAGE", message, -1 },
+    { "PRIORITY", "5", -1 },
+    { "MY_APPLICATION_CUSTOM_FIELD_BINARY", binary_field, sizeof (binary_field) }
+  };
+
+  return g_log_writer_async (G_LOG_LEVEL_MESSAGE, fields, G_N_ELEMENTS (fields), writer);
+}
+
+static gpointer
+async_log_thread (gpointer data)
+{
+  GLogAsyncWriter *writer = data;
+  gint i;
+
+  for (i = 0; i < 250; i++)
+    g_assert_cmpint (async_log (writer, "threaded"), ==, G_LOG_WRITER_HANDLED);
+
+  return NULL;
+}
+
+static void
+test_structured_logging_async (void)
+{
+  AsyncLog log = { { 0, }, };
+  GLogAsyncWriter *writer;
+  GThread *threads[4];
+  gint i;
+
+  log.messages = g_ptr_array_new_with_free_func (g_free);
+
+  /* messages come out in order, and all of them when blocking */
+  writer = g_log_async_writer_new (async_log_writer, &log, NULL, 4, G_LOG_ASYNC_OVERFLOW_BLOCK);
+  for (i = 0; i < 100; i++)
+    {
+      gchar *message = g_strdup_printf ("message %d", i);
+      g_assert_cmpint (async_log (writer, message), ==, G_LOG_WRITER_HANDLED);
+      g_free (message);
+    }
+  g_log_async_writer_flush (writer);
+  g_assert_cmpuint (log.messages->len, ==, 100);
+  for (i = 0; i < 100; i++)
+    {
+      gchar *message = g_strdup_printf ("message %d", i);
+      g_assert_cmpstr (log.messages->pdata[i], ==, message);
+      g_free (message);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("logger", async_log_thread, writer);
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+  g_log_async_writer_free (writer);
+  g_assert_cmpuint (log.messages->len, ==, 100 + 250 * G_N_ELEMENTS (threads));
+
+  /* with the writer stuck, a full queue drops messages, and says so */
+  g_ptr_array_set_size (log.messages, 0);
+  writer = g_log_async_writer_new (async_log_writer, &log, NULL, 2, G_LOG_ASYNC_OVERFLOW_DROP);
+
+  g_mutex_lock (&log.lock);
+  log.held = TRUE;
+  log.entered = FALSE;
+  g_mutex_unlock (&log.lock);
+  g_assert_cmpint (async_log (writer, "first"), ==, G_LOG_WRITER_HANDLED);
+  g_mutex_lock (&log.lock);
+  while (!log.entered)
+    g_cond_wait (&log.cond, &log.lock);
+  g_mutex_unlock (&log.lock);
+
+  g_assert_cmpint (async_log (writer, "second"), ==, G_LOG_WRITER_HANDLED);
+  g_assert_cmpint (async_log (writer, "third"), ==, G_LOG_WRITER_HANDLED);
+  for (i = 0; i < 3; i++)
+    g_assert_cmpint (async_log (writer, "dropped"), ==, G_LOG_WRITER_UNHANDLED);
+
+  g_mutex_lock (&log.lock);
+  log.held = FALSE;
+  g_cond_broadcast (&log.cond);
+  g_mutex_unlock (&log.lock);
+  g_log_async_writer_flush (writer);
+
+  g_assert_cmpuint (log.messages->len, ==, 4);
+  g_assert_cmpstr (log.messages->pdata[0], ==, "first");
+  g_assert_cmpstr (log.messages->pdata[1], ==, "second");
+  g_assert_cmpstr (log.messages->pdata[2], ==, "third");
+  g_assert (g_str_has_prefix (log.messages->pdata[3], "3 log messages were dropped"));
+
+  g_log_async_writer_free (writer);
+  g_ptr_array_unref (log.messages);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -577,6 +770,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/logging/set-handler", test_set_handler);
   g_test_add_func ("/logging/print-handler", test_print_handler);
   g_test_add_func ("/logging/printerr-handler", test_printerr_handler);
+  g_test_add_func ("/logging/level-is-enabled", test_level_is_enabled);
   g_test_add_func ("/logging/653052", bug653052);
   g_test_add_func ("/logging/gibberish", test_gibberish);
   g_test_add_func ("/structured-logging/no-state", test_structured_logging_no_state);
@@ -587,6 +781,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/structured-logging/roundtrip3", test_structured_logging_roundtrip3);
   g_test_add_func ("/structured-logging/variant1", test_structured_logging_variant1);
   g_test_add_func ("/structured-logging/variant2", test_structured_logging_variant2);
+  g_test_add_func ("/structured-logging/async", test_structured_logging_async);
 
   return g_test_run ();
 }
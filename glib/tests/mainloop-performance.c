@@ -0,0 +1,277 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Benchmarks of GMainContext, which scale the number of sources that
+ * are attached to a context. Without -m perf, every benchmark runs a
+ * single iteration as a quick test.
+ */
+
+#include <glib.h>
+
+typedef enum
+{
+  BENCH_ITERATION,
+  BENCH_TIMEOUT_ADD_REMOVE,
+  BENCH_TIMEOUT_DISPATCH,
+  BENCH_INVOKE
+} BenchKind;
+
+typedef struct
+{
+  BenchKind kind;
+  guint n_sources;
+} Bench;
+
+static gboolean
+count_dispatch (gpointer data)
+{
+  guint *count = data;
+
+  (*count)++;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+never_dispatched (gpointer data)
+{
+  g_assert_not_reached ();
+
+  return G_SOURCE_REMOVE;
+}
+
+/* The context of the last benchmark, kept from one call of its
+ * benchmark function to the next
+ */
+static const Bench *live_bench;
+static GMainContext *live_context;
+static guint live_count;
+
+static void
+live_clear (void)
+{
+  if (live_context != NULL)
+    g_main_context_unref (live_context);
+  live_context = NULL;
+  live_bench = NULL;
+}
+
+static void
+attach_timeout (GMainContext *context,
+                guint         interval,
+                GSourceFunc   func,
+                gpointer      data)
+{
+  GSource *source;
+
+  source = g_timeout_source_new (interval);
+  g_source_set_callback (source, func, data, NULL);
+  g_source_attach (source, context);
+  g_source_unref (source);
+}
+
+static GMainContext *
+prepare_context (const Bench *bench)
+{
+  GMainContext *context;
+  GSource *source;
+  guint i;
+
+  if (live_bench == bench)
+    return live_context;
+
+  live_clear ();
+  context = g_main_context_new ();
+  live_count = 0;
+
+  /* timeouts that are always ready, or never ready but looked at on
+   * every iteration
+   */
+  for (i = 0; i < bench->n_sources; i++)
+    {
+      if (bench->kind == BENCH_TIMEOUT_DISPATCH)
+        attach_timeout (context, 0, count_dispatch, &live_count);
+      else
+        attach_timeout (context, 3600 * 1000 + i, never_dispatched, NULL);
+    }
+
+  if (bench->kind == BENCH_ITERATION)
+    {
+      source = g_idle_source_new ();
+      g_source_set_callback (source, count_dispatch, &live_count, NULL);
+      g_source_attach (source, context);
+      g_source_unref (source);
+    }
+
+  live_bench = bench;
+  live_context = context;
+
+  return context;
+}
+
+/* A thread that runs a context, for g_main_context_invoke() */
+
+static GMutex invoke_mutex;
+static GCond invoke_cond;
+static guint64 invoke_count;
+static guint64 invoke_target;
+static GThread *invoke_thread;
+static gboolean invoke_quit;
+
+static gboolean
+invoked (gpointer data)
+{
+  g_mutex_lock (&invoke_mutex);
+  if (++invoke_count == invoke_target)
+    g_cond_signal (&invoke_cond);
+  g_mutex_unlock (&invoke_mutex);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gpointer
+invoke_thread_func (gpointer data)
+{
+  GMainContext *context = data;
+
+  g_main_context_push_thread_default (context);
+  while (!g_atomic_int_get (&invoke_quit))
+    g_main_context_iteration (context, TRUE);
+  g_main_context_pop_thread_default (context);
+
+  return NULL;
+}
+
+static gboolean
+quit_invoke_thread (gpointer data)
+{
+  g_atomic_int_set (&invoke_quit, TRUE);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+stop_invoke_thread (void)
+{
+  if (invoke_thread == NULL)
+    return;
+
+  g_main_context_invoke (live_context, quit_invoke_thread, NULL);
+  g_thread_join (invoke_thread);
+  invoke_thread = NULL;
+}
+
+static void
+bench_mainloop (gconstpointer data,
+                guint64       n_iterations)
+{
+  const Bench *bench = data;
+  GMainContext *context;
+  GSource *source;
+  guint64 i;
+
+  if (live_bench != bench)
+    stop_invoke_thread ();
+  context = prepare_context (bench);
+
+  switch (bench->kind)
+    {
+    case BENCH_ITERATION:
+    case BENCH_TIMEOUT_DISPATCH:
+      for (i = 0; i < n_iterations; i++)
+        g_main_context_iteration (context, FALSE);
+      break;
+
+    case BENCH_TIMEOUT_ADD_REMOVE:
+      for (i = 0; i < n_iterations; i++)
+        {
+          source = g_timeout_source_new (1000);
+          g_source_set_callback (source, never_dispatched, NULL, NULL);
+          g_source_attach (source, context);
+          g_source_destroy (source);
+          g_source_unref (source);
+        }
+      break;
+
+    case BENCH_INVOKE:
+      if (invoke_thread == NULL)
+        {
+          invoke_quit = FALSE;
+          invoke_thread = g_thread_new ("invoke", invoke_thread_func, context);
+        }
+
+      g_mutex_lock (&invoke_mutex);
+      invoke_count = 0;
+      invoke_target = n_iterations;
+      g_mutex_unlock (&invoke_mutex);
+
+      for (i = 0; i < n_iterations; i++)
+        g_main_context_invoke (context, invoked, NULL);
+
+      g_mutex_lock (&invoke_mutex);
+      while (invoke_count < n_iterations)
+        g_cond_wait (&invoke_cond, &invoke_mutex);
+      g_mutex_unlock (&invoke_mutex);
+      break;
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  static const gchar * const kind_names[] = {
+    "iteration", "timeout/add-remove", "timeout/dispatch", "invoke"
+  };
+  static const guint n_sources[] = { 0, 10, 100, 1000, 10000 };
+  BenchKind kind;
+  guint s;
+  gint ret;
+
+  g_test_init (&argc, &argv, NULL);
+
+  for (kind = BENCH_ITERATION; kind <= BENCH_INVOKE; kind++)
+    for (s = 0; s < G_N_ELEMENTS (n_sources); s++)
+      {
+        Bench *bench;
+        gchar *path;
+
+        /* the thread is the only one looking at the context */
+        if (kind == BENCH_INVOKE && n_sources[s] > 0)
+          continue;
+
+        /* there is nothing to dispatch without sources */
+        if (kind == BENCH_TIMEOUT_DISPATCH && n_sources[s] == 0)
+          continue;
+
+        bench = g_new (Bench, 1);
+        bench->kind = kind;
+        bench->n_sources = n_sources[s];
+
+        if (kind == BENCH_INVOKE)
+          path = g_strdup_printf ("/mainloop/%s", kind_names[kind]);
+        else
+          path = g_strdup_printf ("/mainloop/%s/%u", kind_names[kind], n_sources[s]);
+        g_test_add_bench (path, bench, bench_mainloop);
+        g_free (path);
+      }
+
+  ret = g_test_run ();
+
+  stop_invoke_thread ();
+  live_clear ();
+
+  return ret;
+}
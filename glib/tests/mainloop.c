@@ -1015,6 +1015,456 @@ test_ready_time (void)
   g_source_destroy (source);
 }
 
+typedef struct {
+  GSource source;
+  gint dispatched;
+} CountSource;
+
+static gboolean
+count_dispatch (GSource     *source,
+                GSourceFunc  callback,
+                gpointer     user_data)
+{
+  ((CountSource *) source)->dispatched++;
+
+  g_source_set_ready_time (source, -1);
+
+  return TRUE;
+}
+
+/* Lots of prepare-less sources, whose ready times get shuffled around */
+static void
+test_ready_time_many (void)
+{
+  GSourceFuncs source_funcs = {
+    NULL, NULL, count_dispatch
+  };
+  GMainContext *ctx;
+  CountSource *sources[100];
+  gint64 far_future;
+  gint timeout;
+  gint i;
+
+  ctx = g_main_context_new ();
+  far_future = g_get_monotonic_time () + G_TIME_SPAN_DAY;
+
+  for (i = 0; i < G_N_ELEMENTS (sources); i++)
+    {
+      sources[i] = (CountSource *) g_source_new (&source_funcs, sizeof (CountSource));
+      /* Every tenth source is due now, the others in scrambled order */
+      if (i % 10 == 0)
+        g_source_set_ready_time ((GSource *) sources[i], 0);
+      else
+        g_source_set_ready_time ((GSource *) sources[i],
+                                 far_future + ((i * 37) % 100) * G_TIME_SPAN_MINUTE);
+      g_source_attach ((GSource *) sources[i], ctx);
+    }
+
+  while (g_main_context_iteration (ctx, FALSE));
+
+  for (i = 0; i < G_N_ELEMENTS (sources); i++)
+    g_assert_cmpint (sources[i]->dispatched, ==, (i % 10 == 0) ? 1 : 0);
+
+  /* The next wakeup comes from the earliest remaining ready time */
+  g_assert (g_main_context_acquire (ctx));
+  g_assert (!g_main_context_prepare (ctx, NULL));
+  g_main_context_query (ctx, G_MAXINT, &timeout, NULL, 0);
+  g_main_context_release (ctx);
+  g_assert_cmpint (timeout, >, (G_TIME_SPAN_DAY - G_TIME_SPAN_MINUTE) / 1000);
+  g_assert_cmpint (timeout, <=, (G_TIME_SPAN_DAY + G_TIME_SPAN_MINUTE) / 1000);
+
+  /* Bring some forward, push some back, destroy some */
+  g_source_set_ready_time ((GSource *) sources[55], 0);
+  g_source_set_ready_time ((GSource *) sources[3], g_get_monotonic_time () - 1);
+  g_source_set_ready_time ((GSource *) sources[77], -1);
+  g_source_destroy ((GSource *) sources[41]);
+  g_source_destroy ((GSource *) sources[42]);
+  g_source_set_ready_time ((GSource *) sources[43], 0);
+  g_source_destroy ((GSource *) sources[43]);
+
+  while (g_main_context_iteration (ctx, FALSE));
+
+  for (i = 0; i < G_N_ELEMENTS (sources); i++)
+    {
+      if (i % 10 == 0)
+        g_assert_cmpint (sources[i]->dispatched, ==, 1);
+      else if (i == 55 || i == 3)
+        g_assert_cmpint (sources[i]->dispatched, ==, 1);
+      else
+        g_assert_cmpint (sources[i]->dispatched, ==, 0);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (sources); i++)
+    {
+      g_source_destroy ((GSource *) sources[i]);
+      g_source_unref ((GSource *) sources[i]);
+    }
+
+  g_main_context_unref (ctx);
+}
+
+#define N_ATTACH_THREADS 4
+#define N_ATTACH_SOURCES 5000
+
+static volatile gint attach_dispatched;
+
+static gboolean
+count_idle (gpointer user_data)
+{
+  g_atomic_int_inc (&attach_dispatched);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gpointer
+attach_idles (gpointer user_data)
+{
+  GMainContext *ctx = user_data;
+  gint i;
+
+  for (i = 0; i < N_ATTACH_SOURCES; i++)
+    {
+      GSource *source;
+      guint id;
+
+      source = g_idle_source_new ();
+      g_source_set_callback (source, count_idle, NULL, NULL);
+      id = g_source_attach (source, ctx);
+      g_assert_cmpuint (id, !=, 0);
+      g_source_unref (source);
+
+      /* Sometimes look the source up again straight away */
+      if (i % 100 == 0)
+        {
+          source = g_main_context_find_source_by_id (ctx, id);
+          if (source)
+            g_assert_cmpuint (g_source_get_id (source), ==, id);
+        }
+    }
+
+  return NULL;
+}
+
+/* Sources attached from several threads while the owner is iterating
+ * must all be dispatched exactly once.
+ */
+static void
+test_attach_threads (void)
+{
+  GThread *threads[N_ATTACH_THREADS];
+  GMainContext *ctx;
+  gint i;
+
+  ctx = g_main_context_new ();
+  attach_dispatched = 0;
+
+  for (i = 0; i < N_ATTACH_THREADS; i++)
+    threads[i] = g_thread_new ("attach", attach_idles, ctx);
+
+  while (g_atomic_int_get (&attach_dispatched) < N_ATTACH_THREADS * N_ATTACH_SOURCES)
+    g_main_context_iteration (ctx, TRUE);
+
+  for (i = 0; i < N_ATTACH_THREADS; i++)
+    g_thread_join (threads[i]);
+
+  while (g_main_context_iteration (ctx, FALSE));
+  g_assert_cmpint (attach_dispatched, ==, N_ATTACH_THREADS * N_ATTACH_SOURCES);
+
+  g_main_context_unref (ctx);
+}
+
+#define N_BATCH_THREADS 4
+#define N_BATCH_CALLS 20000
+
+typedef struct
+{
+  gint thread;
+  gint seq;
+} BatchCall;
+
+static gint batch_next_seq[N_BATCH_THREADS];
+static gint batch_calls;
+static volatile gint batch_notified;
+
+static gboolean
+batch_func (gpointer user_data)
+{
+  BatchCall *call = user_data;
+
+  /* Calls from each thread must arrive in order */
+  g_assert_cmpint (call->seq, ==, batch_next_seq[call->thread]);
+  batch_next_seq[call->thread]++;
+  batch_calls++;
+
+  return G_SOURCE_REMOVE;
+}
+
+static gpointer
+batch_thread (gpointer user_data)
+{
+  GMainContext *ctx = user_data;
+  BatchCall *calls;
+  gint thread;
+  gint i;
+
+  /* Claim a thread number */
+  for (thread = 0; thread < N_BATCH_THREADS; thread++)
+    if (g_atomic_int_compare_and_exchange (&batch_next_seq[thread], -1, 0))
+      break;
+  g_assert_cmpint (thread, <, N_BATCH_THREADS);
+
+  calls = g_new (BatchCall, N_BATCH_CALLS);
+  for (i = 0; i < N_BATCH_CALLS; i++)
+    {
+      calls[i].thread = thread;
+      calls[i].seq = i;
+      g_main_context_invoke_batched (ctx, batch_func, &calls[i], NULL);
+    }
+
+  return calls;
+}
+
+static void
+test_invoke_batched (void)
+{
+  GThread *threads[N_BATCH_THREADS];
+  GMainContext *ctx;
+  gint i;
+
+  ctx = g_main_context_new ();
+  batch_calls = 0;
+  for (i = 0; i < N_BATCH_THREADS; i++)
+    batch_next_seq[i] = -1;
+
+  for (i = 0; i < N_BATCH_THREADS; i++)
+    threads[i] = g_thread_new ("batch", batch_thread, ctx);
+
+  while (batch_calls < N_BATCH_THREADS * N_BATCH_CALLS)
+    g_main_context_iteration (ctx, TRUE);
+
+  for (i = 0; i < N_BATCH_THREADS; i++)
+    {
+      g_free (g_thread_join (threads[i]));
+      g_assert_cmpint (batch_next_seq[i], ==, N_BATCH_CALLS);
+    }
+
+  /* A producer may still have woken the context up after its last call
+   * was already dispatched; that must not run anything again.
+   */
+  while (g_main_context_iteration (ctx, FALSE));
+  g_assert_cmpint (batch_calls, ==, N_BATCH_THREADS * N_BATCH_CALLS);
+  g_main_context_unref (ctx);
+}
+
+static gboolean
+batch_count (gpointer user_data)
+{
+  gint *counter = user_data;
+
+  (*counter)++;
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+batch_notify (gpointer user_data)
+{
+  g_atomic_int_inc (&batch_notified);
+}
+
+static void
+test_invoke_batched_bounded (void)
+{
+  GMainContext *ctx;
+  gint counter = 0;
+  gint i;
+
+  ctx = g_main_context_new ();
+  batch_notified = 0;
+
+  /* Calls are never made directly, even by the owner */
+  g_main_context_invoke_batched (ctx, batch_count, &counter, batch_notify);
+  g_assert_cmpint (counter, ==, 0);
+  g_assert (g_main_context_iteration (ctx, FALSE));
+  g_assert_cmpint (counter, ==, 1);
+  g_assert_cmpint (batch_notified, ==, 1);
+
+  /* More than the ring holds, and more than one iteration's worth */
+  counter = 0;
+  for (i = 0; i < 3000; i++)
+    g_main_context_invoke_batched (ctx, batch_count, &counter, batch_notify);
+
+  g_assert (g_main_context_iteration (ctx, FALSE));
+  g_assert_cmpint (counter, >, 0);
+  g_assert_cmpint (counter, <, 3000);
+
+  while (g_main_context_iteration (ctx, FALSE));
+  g_assert_cmpint (counter, ==, 3000);
+  g_assert_cmpint (batch_notified, ==, 3001);
+
+  /* Anything still queued is released with the context */
+  for (i = 0; i < 10; i++)
+    g_main_context_invoke_batched (ctx, batch_count, &counter, batch_notify);
+  g_main_context_unref (ctx);
+  g_assert_cmpint (counter, ==, 3000);
+  g_assert_cmpint (batch_notified, ==, 3011);
+}
+
+static gboolean
+busy_dispatch (gpointer user_data)
+{
+  g_usleep (2000);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+quick_dispatch (gpointer user_data)
+{
+  return G_SOURCE_REMOVE;
+}
+
+static void
+test_source_stats (void)
+{
+  GMainContext *ctx;
+  GPtrArray *stats;
+  GSource *source;
+  gboolean found_busy = FALSE, found_unnamed = FALSE;
+  guint i;
+
+  ctx = g_main_context_new ();
+
+  stats = g_main_context_get_source_stats (ctx);
+  g_assert_cmpuint (stats->len, ==, 0);
+  g_ptr_array_unref (stats);
+
+  g_main_context_set_source_stats_enabled (ctx, TRUE);
+
+  for (i = 0; i < 3; i++)
+    {
+      source = g_idle_source_new ();
+      g_source_set_name (source, "busy");
+      g_source_set_callback (source, busy_dispatch, NULL, NULL);
+      g_source_attach (source, ctx);
+      g_source_unref (source);
+    }
+
+  source = g_idle_source_new ();
+  g_source_set_callback (source, quick_dispatch, NULL, NULL);
+  g_source_attach (source, ctx);
+  g_source_unref (source);
+
+  while (g_main_context_iteration (ctx, FALSE));
+
+  stats = g_main_context_get_source_stats (ctx);
+  g_assert_cmpuint (stats->len, ==, 2);
+  for (i = 0; i < stats->len; i++)
+    {
+      GSourceStats *s = stats->pdata[i];
+
+      if (g_strcmp0 (s->name, "busy") == 0)
+        {
+          found_busy = TRUE;
+          g_assert_cmpuint (s->dispatch_count, ==, 3);
+          g_assert_cmpint (s->max_dispatch_time, >=, 2000);
+          g_assert_cmpint (s->total_dispatch_time, >=, 6000);
+          /* The last one waited for the first two */
+          g_assert_cmpint (s->max_latency, >=, 4000);
+          g_assert_cmpint (s->total_latency, >=, s->max_latency);
+        }
+      else
+        {
+          g_assert_null (s->name);
+          found_unnamed = TRUE;
+          g_assert_cmpuint (s->dispatch_count, ==, 1);
+        }
+    }
+  g_assert (found_busy && found_unnamed);
+  g_ptr_array_unref (stats);
+
+  g_main_context_set_source_stats_enabled (ctx, FALSE);
+  stats = g_main_context_get_source_stats (ctx);
+  g_assert_cmpuint (stats->len, ==, 0);
+  g_ptr_array_unref (stats);
+
+  g_main_context_unref (ctx);
+}
+
+typedef struct
+{
+  gint64 deadline;
+  gint *fired;
+} SlackTimeout;
+
+static gboolean
+slack_timeout (gpointer user_data)
+{
+  SlackTimeout *timeout = user_data;
+
+  g_assert_cmpint (g_get_monotonic_time (), >=, timeout->deadline);
+  (*timeout->fired)++;
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+test_timer_slack (void)
+{
+  GMainContext *ctx;
+  SlackTimeout timeouts[5];
+  gint fired = 0;
+  gint dispatches = 0;
+  gint64 start;
+  gint i;
+
+  ctx = g_main_context_new ();
+  g_assert_cmpuint (g_main_context_get_timer_slack (ctx), ==, 0);
+  g_main_context_set_timer_slack (ctx, 200);
+  g_assert_cmpuint (g_main_context_get_timer_slack (ctx), ==, 200);
+
+  /* Start just after a multiple of the slack, so that all the timeouts
+   * fall in the same slack period
+   */
+  while (g_get_monotonic_time () % 200000 > 20000)
+    g_usleep (5000);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < G_N_ELEMENTS (timeouts); i++)
+    {
+      GSource *source;
+
+      timeouts[i].deadline = start + (i + 1) * 20 * 1000;
+      timeouts[i].fired = &fired;
+
+      source = g_timeout_source_new ((i + 1) * 20);
+      g_source_set_callback (source, slack_timeout, &timeouts[i], NULL);
+      g_source_attach (source, ctx);
+      g_source_unref (source);
+    }
+
+  /* Iterations that only consume the wakeups caused by attaching the
+   * sources don't dispatch anything, so they are not counted.
+   */
+  while (fired < G_N_ELEMENTS (timeouts))
+    {
+      gint fired_before = fired;
+
+      g_main_context_iteration (ctx, TRUE);
+      if (fired > fired_before)
+        dispatches++;
+    }
+
+  /* Without slack, this takes one dispatch per timeout.  The deadlines
+   * span less than the slack, so they fall in at most two slack
+   * periods, even if we were descheduled right after picking the
+   * start time, and the timeouts of a period are dispatched together.
+   */
+  g_assert_cmpint (dispatches, <=, 2);
+
+  g_main_context_unref (ctx);
+}
+
 static void
 test_wakeup(void)
 {
@@ -1097,6 +1547,8 @@ test_unref_while_pending (void)
 #include <glib-unix.h>
 #include <unistd.h>
 
+static guint max_nfds_seen;
+
 static gchar zeros[1024];
 
 static gsize
@@ -1511,6 +1963,95 @@ test_unix_file_poll (void)
   close (fd);
 }
 
+static gboolean
+count_and_drain (gint         fd,
+                 GIOCondition condition,
+                 gpointer     user_data)
+{
+  gint *count = user_data;
+  gchar c;
+
+  g_assert_cmpint (condition, ==, G_IO_IN);
+  g_assert_cmpint (read (fd, &c, 1), ==, 1);
+  (*count)++;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gint
+poll_counting (GPollFD *ufds,
+               guint    nfsd,
+               gint     timeout_)
+{
+  max_nfds_seen = MAX (max_nfds_seen, nfsd);
+
+  return g_poll (ufds, nfsd, timeout_);
+}
+
+/* Many fds watched through g_main_context_iteration(): only the ready
+ * ones may dispatch, whether or not a custom poll function is used.
+ */
+static void
+test_unix_fd_many (void)
+{
+  GMainContext *ctx;
+  GSource *sources[32];
+  gint fds[32][2];
+  gint counts[32] = { 0, };
+  gint pass, i;
+
+  ctx = g_main_context_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (sources); i++)
+    {
+      g_assert_cmpint (pipe (fds[i]), ==, 0);
+      sources[i] = g_unix_fd_source_new (fds[i][0], G_IO_IN);
+      g_source_set_callback (sources[i], (GSourceFunc) count_and_drain, &counts[i], NULL);
+      g_source_attach (sources[i], ctx);
+    }
+
+  for (pass = 0; pass < 2; pass++)
+    {
+      /* The second pass goes through the g_main_context_set_poll_func()
+       * path, which must be handed every fd.
+       */
+      if (pass == 1)
+        {
+          max_nfds_seen = 0;
+          g_main_context_set_poll_func (ctx, poll_counting);
+        }
+
+      g_assert_cmpint (write (fds[7][1], "x", 1), ==, 1);
+      g_assert_cmpint (write (fds[20][1], "x", 1), ==, 1);
+      g_assert_cmpint (write (fds[20][1], "x", 1), ==, 1);
+
+      while (g_main_context_iteration (ctx, FALSE));
+
+      for (i = 0; i < G_N_ELEMENTS (sources); i++)
+        {
+          if (i == 7)
+            g_assert_cmpint (counts[i], ==, pass + 1);
+          else if (i == 20)
+            g_assert_cmpint (counts[i], ==, 2 * (pass + 1));
+          else
+            g_assert_cmpint (counts[i], ==, 0);
+        }
+
+      if (pass == 1)
+        g_assert_cmpint (max_nfds_seen, >=, G_N_ELEMENTS (sources));
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (sources); i++)
+    {
+      g_source_destroy (sources[i]);
+      g_source_unref (sources[i]);
+      close (fds[i][0]);
+      close (fds[i][1]);
+    }
+
+  g_main_context_unref (ctx);
+}
+
 #endif
 
 static gboolean
@@ -1742,7 +2283,13 @@ main (int argc, char *argv[])
   g_test_add_func ("/mainloop/source_time", test_source_time);
   g_test_add_func ("/mainloop/overflow", test_mainloop_overflow);
   g_test_add_func ("/mainloop/ready-time", test_ready_time);
+  g_test_add_func ("/mainloop/ready-time-many", test_ready_time_many);
   g_test_add_func ("/mainloop/wakeup", test_wakeup);
+  g_test_add_func ("/mainloop/attach-threads", test_attach_threads);
+  g_test_add_func ("/mainloop/invoke-batched", test_invoke_batched);
+  g_test_add_func ("/mainloop/invoke-batched-bounded", test_invoke_batched_bounded);
+  g_test_add_func ("/mainloop/source-stats", test_source_stats);
+  g_test_add_func ("/mainloop/timer-slack", test_timer_slack);
   g_test_add_func ("/mainloop/remove-invalid", test_remove_invalid);
   g_test_add_func ("/mainloop/unref-while-pending", test_unref_while_pending);
 #ifdef G_OS_UNIX
@@ -1751,6 +2298,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/mainloop/source-unix-fd-api", test_source_unix_fd_api);
   g_test_add_func ("/mainloop/wait", test_mainloop_wait);
   g_test_add_func ("/mainloop/unix-file-poll", test_unix_file_poll);
+  g_test_add_func ("/mainloop/unix-fd-many", test_unix_fd_many);
 #endif
   g_test_add_func ("/mainloop/nfds", test_nfds);
 
@@ -184,6 +184,38 @@ test_gbytes (void)
   g_bytes_unref (bytes);
 }
 
+static void
+test_advise (void)
+{
+  GMappedFile *file;
+  GError *error;
+  gchar *before;
+  gsize length;
+
+  error = NULL;
+  file = g_mapped_file_new (g_test_get_filename (G_TEST_DIST, "4096-random-bytes", NULL), FALSE, &error);
+  g_assert_no_error (error);
+
+  length = g_mapped_file_get_length (file);
+  before = g_memdup (g_mapped_file_get_contents (file), length);
+
+  /* hints never change the contents, whatever the range */
+  g_mapped_file_advise (file, G_MAPPED_FILE_ADVICE_RANDOM, 0, 0);
+  g_mapped_file_advise (file, G_MAPPED_FILE_ADVICE_SEQUENTIAL, 100, 10);
+  g_mapped_file_advise (file, G_MAPPED_FILE_ADVICE_WILL_NEED, 1000, length);
+  g_mapped_file_advise (file, G_MAPPED_FILE_ADVICE_DONT_NEED, 0, length);
+  g_mapped_file_advise (file, G_MAPPED_FILE_ADVICE_NORMAL, length, 1);
+  g_assert (memcmp (before, g_mapped_file_get_contents (file), length) == 0);
+
+  g_free (before);
+  g_mapped_file_unref (file);
+
+  file = g_mapped_file_new (g_test_get_filename (G_TEST_DIST, "empty", NULL), FALSE, &error);
+  g_assert_no_error (error);
+  g_mapped_file_advise (file, G_MAPPED_FILE_ADVICE_WILL_NEED, 0, 0);
+  g_mapped_file_unref (file);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -198,6 +230,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/mappedfile/writable", test_writable);
   g_test_add_func ("/mappedfile/writable_fd", test_writable_fd);
   g_test_add_func ("/mappedfile/gbytes", test_gbytes);
+  g_test_add_func ("/mappedfile/advise", test_advise);
 
   return g_test_run ();
 }
@@ -21,6 +21,7 @@
  * Author: Matthias Clasen
  */
 
+#include <string.h>
 #include "glib.h"
 
 typedef struct {
@@ -87,12 +88,62 @@ test_markup_stack (void)
   g_markup_parse_context_free (context);
 }
 
+static void
+collect_text (GMarkupParseContext  *context,
+              const gchar          *text,
+              gsize                 text_len,
+              gpointer              user_data,
+              GError              **error)
+{
+  GPtrArray *texts = user_data;
+
+  g_ptr_array_add (texts, g_strndup (text, text_len));
+}
+
+static void
+test_markup_borrow_text (void)
+{
+  const gchar *document = "<a>plain<b>\xc3\xa4 &amp; \xc3\xb6</b>split\r\nline</a>";
+  GMarkupParser parser = { NULL, NULL, collect_text, NULL, NULL };
+  GMarkupParseContext *context;
+  GPtrArray *texts;
+  GError *error = NULL;
+  gsize len = strlen (document);
+
+  /* borrowed or not, every callback sees the same text, also when it
+   * straddles two buffers
+   */
+  texts = g_ptr_array_new_with_free_func (g_free);
+  context = g_markup_parse_context_new (&parser, G_MARKUP_BORROW_TEXT, texts, NULL);
+  g_assert (g_markup_parse_context_parse (context, document, 28, &error));
+  g_assert (g_markup_parse_context_parse (context, document + 28, len - 28, &error));
+  g_assert (g_markup_parse_context_end_parse (context, &error));
+  g_assert_no_error (error);
+  g_markup_parse_context_free (context);
+
+  g_assert_cmpuint (texts->len, ==, 3);
+  g_assert_cmpstr (texts->pdata[0], ==, "plain");
+  g_assert_cmpstr (texts->pdata[1], ==, "\xc3\xa4 & \xc3\xb6");
+  g_assert_cmpstr (texts->pdata[2], ==, "split\nline");
+  g_ptr_array_unref (texts);
+
+  /* invalid text is still caught */
+  texts = g_ptr_array_new_with_free_func (g_free);
+  context = g_markup_parse_context_new (&parser, G_MARKUP_BORROW_TEXT, texts, NULL);
+  g_assert (!g_markup_parse_context_parse (context, "<a>\xff</a>", -1, &error));
+  g_assert_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_BAD_UTF8);
+  g_clear_error (&error);
+  g_markup_parse_context_free (context);
+  g_ptr_array_unref (texts);
+}
+
 int
 main (int argc, char *argv[])
 {
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/markup/stack", test_markup_stack);
+  g_test_add_func ("/markup/borrow-text", test_markup_borrow_text);
 
   return g_test_run ();
 }
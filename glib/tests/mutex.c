@@ -26,6 +26,7 @@
 #include <glib.h>
 
 #include <stdio.h>
+#include <string.h>
 
 static void
 test_mutex1 (void)
@@ -155,6 +156,61 @@ test_mutex5 (void)
     g_assert (owners[i] == NULL);
 }
 
+static GMutex profiled_lock;
+static gint profiled_bits;
+
+static gpointer
+profiled_thread (gpointer data)
+{
+  g_atomic_int_set ((gint *) data, 1);
+
+  g_mutex_lock (&profiled_lock);
+  g_mutex_unlock (&profiled_lock);
+
+  g_bit_lock (&profiled_bits, 0);
+  g_bit_unlock (&profiled_bits, 0);
+
+  return NULL;
+}
+
+static void
+test_mutex_profile (void)
+{
+  GThread *thread;
+  gint started = 0;
+  gchar *report;
+
+  g_lock_profile_set_enabled (TRUE);
+  g_lock_profile_reset ();
+
+  g_mutex_lock (&profiled_lock);
+  g_bit_lock (&profiled_bits, 0);
+
+  thread = g_thread_new ("profiled", profiled_thread, &started);
+  while (!g_atomic_int_get (&started))
+    g_usleep (1000);
+
+  /* Make sure that the thread is really waiting for us */
+  g_usleep (50000);
+  g_mutex_unlock (&profiled_lock);
+  g_usleep (50000);
+  g_bit_unlock (&profiled_bits, 0);
+
+  g_thread_join (thread);
+
+  report = g_lock_profile_dump ();
+  g_assert_nonnull (strstr (report, "GMutex"));
+  g_assert_nonnull (strstr (report, "g_bit_lock"));
+  g_free (report);
+
+  g_lock_profile_reset ();
+  report = g_lock_profile_dump ();
+  g_assert_cmpstr (report, ==, "0 contended locks\n");
+  g_free (report);
+
+  g_lock_profile_set_enabled (FALSE);
+}
+
 #define COUNT_TO 100000000
 
 static gboolean
@@ -218,6 +274,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/thread/mutex3", test_mutex3);
   g_test_add_func ("/thread/mutex4", test_mutex4);
   g_test_add_func ("/thread/mutex5", test_mutex5);
+  g_test_add_func ("/thread/mutex/profile", test_mutex_profile);
 
   if (g_test_perf ())
     {
@@ -498,6 +498,74 @@ copy_test (void)
   g_node_destroy (root);
 }
 
+static gboolean
+count_nodes (GNode    *node,
+             gpointer  data)
+{
+  guint *n = data;
+
+  (*n)++;
+
+  return FALSE;
+}
+
+static gboolean
+destroy_leaf (GNode    *node,
+              gpointer  data)
+{
+  if (G_NODE_IS_LEAF (node) && !G_NODE_IS_ROOT (node))
+    g_node_destroy (node);
+
+  return FALSE;
+}
+
+static void
+deep_test (void)
+{
+  GNode *root, *node;
+  guint i, n;
+  const guint depth = 200000;
+  GTraverseType orders[] = { G_PRE_ORDER, G_POST_ORDER, G_IN_ORDER };
+
+  /* A chain far deeper than a recursive traversal could handle */
+  root = node = g_node_new (NULL);
+  for (i = 1; i < depth; i++)
+    node = g_node_append_data (node, GUINT_TO_POINTER (i));
+
+  g_assert_cmpuint (g_node_max_height (root), ==, depth);
+  g_assert_cmpuint (g_node_n_nodes (root, G_TRAVERSE_ALL), ==, depth);
+  g_assert_cmpuint (g_node_n_nodes (root, G_TRAVERSE_LEAVES), ==, 1);
+  g_assert (g_node_find (root, G_POST_ORDER, G_TRAVERSE_ALL, GUINT_TO_POINTER (depth / 2)) != NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (orders); i++)
+    {
+      n = 0;
+      g_node_traverse (root, orders[i], G_TRAVERSE_ALL, -1, count_nodes, &n);
+      g_assert_cmpuint (n, ==, depth);
+
+      n = 0;
+      g_node_traverse (root, orders[i], G_TRAVERSE_NON_LEAVES, 1000, count_nodes, &n);
+      g_assert_cmpuint (n, ==, 1000);
+    }
+
+  /* Each node gets a few children, so that later siblings are visited
+   * after deep subtrees, and the callback may destroy the leaves.
+   */
+  g_node_append_data (g_node_nth_child (root, 0), NULL);
+  g_node_append_data (g_node_nth_child (root, 0), NULL);
+  g_node_append_data (root, NULL);
+
+  n = 0;
+  g_node_traverse (root, G_POST_ORDER, G_TRAVERSE_ALL, -1, count_nodes, &n);
+  g_assert_cmpuint (n, ==, depth + 3);
+
+  g_node_traverse (root, G_PRE_ORDER, G_TRAVERSE_LEAVES, -1, destroy_leaf, NULL);
+  g_assert_cmpuint (g_node_n_nodes (root, G_TRAVERSE_ALL), ==, depth - 1);
+  g_assert_cmpuint (g_node_max_height (root), ==, depth - 1);
+
+  g_node_destroy (root);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -510,6 +578,7 @@ main (int   argc,
   g_test_add_func ("/node/misc", misc_test);
   g_test_add_func ("/node/unlink", unlink_test);
   g_test_add_func ("/node/copy", copy_test);
+  g_test_add_func ("/node/deep", deep_test);
 
   return g_test_run ();
 }
@@ -2510,6 +2510,93 @@ double_free (void)
 
 }
 
+static void
+test_many_entries (void)
+{
+  GOptionContext *context;
+  GOptionGroup *group;
+  GOptionEntry *entries;
+  GOptionEntry late_entries[] = {
+    { "late", 'l', 0, G_OPTION_ARG_NONE, NULL, NULL, NULL },
+    { NULL }
+  };
+  gboolean flags[500], late = FALSE, twice_a = FALSE, twice_b = FALSE;
+  gint value = 0;
+  GError *error = NULL;
+  gchar **argv, **argv_copy;
+  gint argc, i;
+
+  entries = g_new0 (GOptionEntry, 503);
+  for (i = 0; i < 500; i++)
+    {
+      entries[i].long_name = g_strdup_printf ("option-%d", i);
+      entries[i].arg = G_OPTION_ARG_NONE;
+      entries[i].arg_data = &flags[i];
+      flags[i] = FALSE;
+    }
+  /* two entries with the same short name are both set */
+  entries[500].long_name = "twice-a";
+  entries[500].short_name = 'x';
+  entries[500].arg_data = &twice_a;
+  entries[501].long_name = "twice-b";
+  entries[501].short_name = 'x';
+  entries[501].arg_data = &twice_b;
+  entries[502].long_name = NULL;
+
+  context = g_option_context_new (NULL);
+  group = g_option_group_new ("many", "Many", "Many options", NULL, NULL);
+  g_option_group_add_entries (group, entries);
+  g_option_context_add_group (context, group);
+
+  argv = split_string ("program --option-7 --many-option-42 -x --option-499 rest", &argc);
+  argv_copy = copy_stringv (argv, argc);
+  g_option_context_parse (context, &argc, &argv, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (argc, ==, 2);
+  g_assert_cmpstr (argv[1], ==, "rest");
+
+  for (i = 0; i < 500; i++)
+    g_assert_cmpint (flags[i], ==, (i == 7 || i == 42 || i == 499));
+  g_assert (twice_a && twice_b);
+
+  g_strfreev (argv_copy);
+  g_free (argv);
+
+  /* entries added after a parse are found too */
+  late_entries[0].arg_data = &late;
+  g_option_group_add_entries (group, late_entries);
+  late_entries[0].long_name = "value";
+  late_entries[0].short_name = 0;
+  late_entries[0].arg = G_OPTION_ARG_INT;
+  late_entries[0].arg_data = &value;
+  g_option_context_add_main_entries (context, late_entries, NULL);
+
+  argv = split_string ("program -l --value=17 --option-1", &argc);
+  argv_copy = copy_stringv (argv, argc);
+  g_option_context_parse (context, &argc, &argv, &error);
+  g_assert_no_error (error);
+  g_assert (late);
+  g_assert_cmpint (value, ==, 17);
+  g_assert (flags[1]);
+
+  g_strfreev (argv_copy);
+  g_free (argv);
+
+  argv = split_string ("program --option-500", &argc);
+  argv_copy = copy_stringv (argv, argc);
+  g_option_context_parse (context, &argc, &argv, &error);
+  g_assert_error (error, G_OPTION_ERROR, G_OPTION_ERROR_UNKNOWN_OPTION);
+  g_clear_error (&error);
+
+  g_strfreev (argv_copy);
+  g_free (argv);
+  g_option_context_free (context);
+
+  for (i = 0; i < 500; i++)
+    g_free ((gchar *) entries[i].long_name);
+  g_free (entries);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -2550,6 +2637,7 @@ main (int   argc,
   g_test_add_func ("/option/group/main", test_main_group);
   g_test_add_func ("/option/group/error-hook", test_error_hook);
   g_test_add_func ("/option/group/parse", test_group_parse);
+  g_test_add_func ("/option/group/many-entries", test_many_entries);
   g_test_add_func ("/option/strict-posix", test_strict_posix);
 
   /* Test that restoration on failure works */
@@ -206,6 +206,59 @@ test_equal (gconstpointer d)
   g_pattern_spec_free (p2);
 }
 
+static void
+test_set (void)
+{
+  const gchar *patterns[] = {
+    "Makefile",         /* 0 */
+    "*.c",              /* 1 */
+    "*.tar.gz",         /* 2 */
+    "test-*.c",         /* 3 */
+    "*.gz",             /* 4 */
+    "README*",          /* 5 */
+    "*.c",              /* 6 */
+    "?akefile",         /* 7 */
+    "*\xc3\xa4*x?",      /* 8 */
+  };
+  struct {
+    const gchar *string;
+    gint match;
+  } tests[] = {
+    { "Makefile", 0 },
+    { "makefile", 7 },
+    { "foo.c", 1 },
+    { "test-foo.c", 1 },
+    { "foo.tar.gz", 2 },
+    { "foo.gz", 4 },
+    { "README.md", 5 },
+    { "foo.h", -1 },
+    { "", -1 },
+    { "a\xc3\xa4" "bxy", 8 },
+    { "a\xc3\xa4" "bx", -1 },
+  };
+  GPatternSet *set;
+  guint i;
+
+  set = g_pattern_set_new ();
+  g_assert_cmpint (g_pattern_set_match_string (set, "anything"), ==, -1);
+
+  for (i = 0; i < G_N_ELEMENTS (patterns); i++)
+    g_assert_cmpuint (g_pattern_set_add (set, patterns[i]), ==, i);
+
+  for (i = 0; i < G_N_ELEMENTS (tests); i++)
+    {
+      g_assert_cmpint (g_pattern_set_match_string (set, tests[i].string), ==, tests[i].match);
+      g_assert_cmpint (g_pattern_set_match (set, strlen (tests[i].string), tests[i].string), ==, tests[i].match);
+    }
+
+  /* a catch-all applies whenever nothing earlier does */
+  g_pattern_set_add (set, "*");
+  g_assert_cmpint (g_pattern_set_match_string (set, "foo.h"), ==, G_N_ELEMENTS (patterns));
+  g_assert_cmpint (g_pattern_set_match_string (set, "foo.c"), ==, 1);
+
+  g_pattern_set_free (set);
+}
+
 
 int
 main (int argc, char** argv)
@@ -236,6 +289,8 @@ main (int argc, char** argv)
       g_free (path);
     }
 
+  g_test_add_func ("/pattern/set", test_set);
+
   return g_test_run ();
 }
 
@@ -20,6 +20,7 @@
  */
 
 #include "glib.h"
+#include <string.h>
 
 /* Outputs tested against the reference implementation mt19937ar.c from
  * http://www.math.sci.hiroshima-u.ac.jp/~m-mat/MT/MT2002/emt19937ar.html
@@ -149,6 +150,128 @@ test_rand (void)
   g_rand_free (copy);
 }
 
+/* xoshiro256** outputs for the seed 0x7a7a7a7a, checked against a
+ * separate implementation of SplitMix64 and xoshiro256** */
+const guint32 xoshiro_outputs[] =
+{
+  0x101d1c0d,
+  0x7da49438,
+  0x7cb3295a,
+  0x955b15ba,
+  0xb096d779,
+  0x4bc8c4cb,
+  0xad881236,
+  0x70903cec
+};
+
+static void
+test_xoshiro (void)
+{
+  GRand *rand, *copy;
+  gdouble d;
+  guint i;
+
+  rand = g_rand_new_with_algorithm (G_RAND_ALGORITHM_XOSHIRO256);
+  g_rand_set_seed (rand, first_numbers[0]);
+
+  for (i = 0; i < G_N_ELEMENTS (xoshiro_outputs); i++)
+    g_assert_cmpuint (xoshiro_outputs[i], ==, g_rand_int (rand));
+
+  copy = g_rand_copy (rand);
+  for (i = 0; i < 1000; i++)
+    g_assert_cmpuint (g_rand_int (copy), ==, g_rand_int (rand));
+
+  for (i = 0; i < 1000; i++)
+    {
+      d = g_rand_double (rand);
+      g_assert (0.0 <= d && d < 1.0);
+
+      g_assert_cmpint (g_rand_int_range (rand, 8, 16), >=, 8);
+    }
+
+  g_rand_free (copy);
+  g_rand_free (rand);
+}
+
+static void
+test_fill (gconstpointer data)
+{
+  GRandAlgorithm algorithm = GPOINTER_TO_INT (data);
+  GRand *rand, *copy;
+  guint8 buf[67];
+  guint8 zeroes[sizeof buf] = { 0, };
+  gsize i;
+
+  rand = g_rand_new_with_algorithm (algorithm);
+  copy = g_rand_copy (rand);
+
+  /* Any length works, and the same state gives the same bytes */
+  for (i = 0; i <= sizeof buf; i++)
+    {
+      guint8 other[sizeof buf];
+
+      memset (buf, 0, sizeof buf);
+      g_rand_fill (rand, buf, i);
+      g_rand_fill (copy, other, i);
+      g_assert_cmpmem (buf, i, other, i);
+      g_assert_cmpmem (buf + i, sizeof buf - i, zeroes, sizeof buf - i);
+    }
+
+  g_assert (memcmp (buf, zeroes, sizeof buf) != 0);
+
+  /* With MT, the bytes are those of g_rand_int(), in little endian */
+  if (algorithm == G_RAND_ALGORITHM_MT19937)
+    {
+      g_rand_set_seed (rand, first_numbers[0]);
+      g_rand_fill (rand, buf, 8);
+      for (i = 0; i < 2; i++)
+        g_assert_cmpuint (buf[4 * i] | buf[4 * i + 1] << 8 |
+                          buf[4 * i + 2] << 16 | (guint32) buf[4 * i + 3] << 24,
+                          ==, first_numbers[i + 1]);
+    }
+
+  g_random_fill (buf, sizeof buf);
+
+  g_rand_free (copy);
+  g_rand_free (rand);
+}
+
+static gpointer
+random_thread (gpointer data)
+{
+  guint32 *result = data;
+  guint i;
+
+  for (i = 0; i < 10000; i++)
+    g_random_int ();
+  *result = g_random_int ();
+
+  return NULL;
+}
+
+static void
+test_random_threads (void)
+{
+  GThread *threads[4];
+  guint32 results[G_N_ELEMENTS (threads)];
+  guint i;
+
+  /* Each thread has its own generator, seeded differently */
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("random", random_thread, &results[i]);
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  g_assert_cmpuint (results[0], !=, results[1]);
+  g_assert_cmpuint (results[1], !=, results[2]);
+  g_assert_cmpuint (results[2], !=, results[3]);
+
+  /* The seed still gives the same sequence in the calling thread */
+  g_random_set_seed (first_numbers[0]);
+  for (i = 1; i < G_N_ELEMENTS (first_numbers); i++)
+    g_assert_cmpuint (first_numbers[i], ==, g_random_int ());
+}
+
 static void
 test_double_range (void)
 {
@@ -171,6 +294,12 @@ main (int   argc,
 
   g_test_add_func ("/rand/test-rand", test_rand);
   g_test_add_func ("/rand/double-range", test_double_range);
+  g_test_add_func ("/rand/xoshiro", test_xoshiro);
+  g_test_add_data_func ("/rand/fill/mt19937",
+                        GINT_TO_POINTER (G_RAND_ALGORITHM_MT19937), test_fill);
+  g_test_add_data_func ("/rand/fill/xoshiro",
+                        GINT_TO_POINTER (G_RAND_ALGORITHM_XOSHIRO256), test_fill);
+  g_test_add_func ("/rand/random-threads", test_random_threads);
 
   return g_test_run();
 }
@@ -219,6 +219,46 @@ test_mutex_perf (gconstpointer data)
   g_test_maximized_result (rate, "%f mips", rate);
 }
 
+static GRecMutex other_mutex;
+
+static gpointer
+trylock_func (gpointer data)
+{
+  gboolean ret;
+
+  ret = g_rec_mutex_trylock (&other_mutex);
+  if (ret)
+    g_rec_mutex_unlock (&other_mutex);
+
+  return GINT_TO_POINTER (ret);
+}
+
+/* The lock is only released to other threads on the last unlock */
+static void
+test_rec_mutex5 (void)
+{
+  GThread *thread;
+
+  g_rec_mutex_init (&other_mutex);
+
+  g_rec_mutex_lock (&other_mutex);
+  g_rec_mutex_lock (&other_mutex);
+
+  thread = g_thread_new ("trylock", trylock_func, NULL);
+  g_assert (!GPOINTER_TO_INT (g_thread_join (thread)));
+
+  g_rec_mutex_unlock (&other_mutex);
+
+  thread = g_thread_new ("trylock", trylock_func, NULL);
+  g_assert (!GPOINTER_TO_INT (g_thread_join (thread)));
+
+  g_rec_mutex_unlock (&other_mutex);
+
+  thread = g_thread_new ("trylock", trylock_func, NULL);
+  g_assert (GPOINTER_TO_INT (g_thread_join (thread)));
+
+  g_rec_mutex_clear (&other_mutex);
+}
 
 int
 main (int argc, char *argv[])
@@ -229,6 +269,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/thread/rec-mutex2", test_rec_mutex2);
   g_test_add_func ("/thread/rec-mutex3", test_rec_mutex3);
   g_test_add_func ("/thread/rec-mutex4", test_rec_mutex4);
+  g_test_add_func ("/thread/rec-mutex5", test_rec_mutex5);
 
   if (g_test_perf ())
     {
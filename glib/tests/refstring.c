@@ -0,0 +1,196 @@
+/* Unit tests for reference counted strings
+ *
+ * This work is provided "as is"; redistribution and modification
+ * in whole or in part, in any medium, physical or electronic is
+ * permitted without restriction.
+ *
+ * This work is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * In no event shall the authors or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ */
+
+
+#include <glib.h>
+#include <string.h>
+
+static void
+test_base (void)
+{
+  char *orig = "hello, world";
+  char *s, *t;
+
+  s = g_ref_string_new (orig);
+  g_assert (s != orig);
+  g_assert_cmpstr (s, ==, orig);
+  g_assert_cmpuint (g_ref_string_length (s), ==, strlen (orig));
+  g_assert_cmpuint (g_ref_string_hash (s), ==, g_str_hash (orig));
+  g_assert (!g_ref_string_is_interned (s));
+
+  t = g_ref_string_acquire (s);
+  g_assert (t == s);
+  g_ref_string_release (t);
+  g_assert_cmpstr (s, ==, orig);
+  g_ref_string_release (s);
+
+  /* contents are copied as they are, including nul bytes */
+  s = g_ref_string_new_len ("ab\0cd", 5);
+  g_assert_cmpuint (g_ref_string_length (s), ==, 5);
+  g_assert (memcmp (s, "ab\0cd", 6) == 0);
+  t = g_ref_string_new_len ("ab\0ce", 5);
+  g_assert (!g_ref_string_equal (s, t));
+  g_ref_string_release (t);
+  t = g_ref_string_new_len ("ab\0cd", 5);
+  g_assert (g_ref_string_equal (s, t));
+  g_ref_string_release (t);
+  g_ref_string_release (s);
+
+  s = g_ref_string_new_len ("hello", 3);
+  g_assert_cmpstr (s, ==, "hel");
+  g_assert_cmpuint (g_ref_string_hash (s), ==, g_str_hash ("hel"));
+  g_ref_string_release (s);
+}
+
+static void
+test_intern (void)
+{
+  char *s, *t, *u;
+
+  s = g_ref_string_new_intern ("interned");
+  t = g_ref_string_new_intern ("interned");
+  g_assert (s == t);
+  g_assert (g_ref_string_is_interned (s));
+  g_assert_cmpuint (g_ref_string_length (s), ==, 8);
+
+  u = g_ref_string_new ("interned");
+  g_assert (u != s);
+  g_assert (g_ref_string_equal (s, u));
+  g_ref_string_release (u);
+
+  u = g_ref_string_new_intern ("other");
+  g_assert (!g_ref_string_equal (s, u));
+  g_ref_string_release (u);
+
+  g_ref_string_release (t);
+  g_assert_cmpstr (s, ==, "interned");
+  g_ref_string_release (s);
+
+  /* after the last release, interning starts over */
+  s = g_ref_string_new_intern ("interned");
+  g_assert_cmpstr (s, ==, "interned");
+  g_assert (g_ref_string_new_intern ("interned") == s);
+  g_ref_string_release (s);
+  g_ref_string_release (s);
+}
+
+static void
+test_hash_table (void)
+{
+  GHashTable *table;
+  char *keys[100];
+  gint i;
+
+  table = g_hash_table_new_full (g_ref_string_hash, g_ref_string_equal,
+                                 (GDestroyNotify) g_ref_string_release, NULL);
+
+  for (i = 0; i < 100; i++)
+    {
+      gchar *tmp = g_strdup_printf ("key %d", i);
+
+      keys[i] = g_ref_string_new_intern (tmp);
+      g_hash_table_insert (table, g_ref_string_acquire (keys[i]), GINT_TO_POINTER (i));
+      g_free (tmp);
+    }
+
+  for (i = 0; i < 100; i++)
+    {
+      gchar *tmp = g_strdup_printf ("key %d", i);
+      char *key = g_ref_string_new_intern (tmp);
+      char *copy = g_ref_string_new (tmp);
+
+      g_assert (key == keys[i]);
+      g_assert_cmpint (GPOINTER_TO_INT (g_hash_table_lookup (table, key)), ==, i);
+      g_assert_cmpint (GPOINTER_TO_INT (g_hash_table_lookup (table, copy)), ==, i);
+
+      g_ref_string_release (copy);
+      g_ref_string_release (key);
+      g_ref_string_release (keys[i]);
+      g_free (tmp);
+    }
+
+  g_hash_table_unref (table);
+}
+
+#define N_THREADS 8
+#define N_ITERATIONS 20000
+
+static gpointer
+intern_thread (gpointer data)
+{
+  GRand *rand = g_rand_new_with_seed (GPOINTER_TO_UINT (data));
+  char *held[16] = { NULL, };
+  gint i;
+
+  for (i = 0; i < N_ITERATIONS; i++)
+    {
+      gint n = g_rand_int_range (rand, 0, G_N_ELEMENTS (held));
+      gchar buf[16];
+      char *s;
+
+      /* a few strings, interned and released over and over */
+      g_snprintf (buf, sizeof buf, "string %d", n);
+      s = g_ref_string_new_intern (buf);
+      g_assert_cmpstr (s, ==, buf);
+
+      if (held[n])
+        {
+          g_assert (held[n] == s);
+          g_ref_string_release (held[n]);
+          held[n] = NULL;
+          g_ref_string_release (s);
+        }
+      else
+        held[n] = s;
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (held); i++)
+    if (held[i])
+      g_ref_string_release (held[i]);
+
+  g_rand_free (rand);
+
+  return NULL;
+}
+
+static void
+test_intern_threads (void)
+{
+  GThread *threads[N_THREADS];
+  gint i;
+
+  for (i = 0; i < N_THREADS; i++)
+    threads[i] = g_thread_new ("refstring", intern_thread, GINT_TO_POINTER (i + 1));
+  for (i = 0; i < N_THREADS; i++)
+    g_thread_join (threads[i]);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/refstring/base", test_base);
+  g_test_add_func ("/refstring/intern", test_intern);
+  g_test_add_func ("/refstring/hash-table", test_hash_table);
+  g_test_add_func ("/refstring/intern-threads", test_intern_threads);
+
+  return g_test_run ();
+}
@@ -2165,6 +2165,91 @@ test_max_lookbehind (void)
   g_regex_unref (regex);
 }
 
+static gpointer
+match_simple_thread (gpointer data)
+{
+  gint i;
+
+  for (i = 0; i < 1000; i++)
+    {
+      gchar *pattern = g_strdup_printf ("^key%d=(\\d+)$", i % 100);
+      gchar *line = g_strdup_printf ("key%d=%d", i % 100, i);
+
+      g_assert (g_regex_match_simple (pattern, line, 0, 0));
+      g_assert (!g_regex_match_simple (pattern, "key=", 0, 0));
+      g_assert (g_regex_match_simple (pattern, line, G_REGEX_CASELESS, 0));
+      g_free (line);
+      g_free (pattern);
+    }
+
+  return NULL;
+}
+
+static void
+test_match_simple_cache (void)
+{
+  GThread *threads[4];
+  gchar **split;
+  gint i;
+
+  /* more patterns than are kept compiled, from several threads */
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("match-simple", match_simple_thread, NULL);
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  /* the same pattern with other options is a different regex */
+  g_assert (!g_regex_match_simple ("^abc$", "ABC", 0, 0));
+  g_assert (g_regex_match_simple ("^abc$", "ABC", G_REGEX_CASELESS, 0));
+  g_assert (!g_regex_match_simple ("^abc$", "ABC", 0, 0));
+
+  /* and a pattern that failed to compile is not remembered */
+  g_assert (!g_regex_match_simple ("(", "(", 0, 0));
+  g_assert (!g_regex_match_simple ("(", "(", 0, 0));
+
+  split = g_regex_split_simple ("\\s*,\\s*", "a , b,c", 0, 0);
+  g_assert_cmpint (g_strv_length (split), ==, 3);
+  g_assert_cmpstr (split[2], ==, "c");
+  g_strfreev (split);
+}
+
+static void
+test_optimize_long (void)
+{
+  GRegex *regex;
+  GMatchInfo *match;
+  GString *line;
+  gint i, count;
+
+  regex = g_regex_new ("(\\w+)=(\\d+)", G_REGEX_OPTIMIZE, 0, NULL);
+
+  line = g_string_new (NULL);
+  for (i = 0; i < 10000; i++)
+    g_string_append_printf (line, "field%d=%d; ", i, i * 3);
+
+  count = 0;
+  g_regex_match (regex, line->str, 0, &match);
+  while (g_match_info_matches (match))
+    {
+      gchar *number = g_match_info_fetch (match, 2);
+
+      g_assert_cmpint (g_ascii_strtoll (number, NULL, 10), ==, count * 3);
+      g_free (number);
+      count++;
+      g_match_info_next (match, NULL);
+    }
+  g_assert_cmpint (count, ==, 10000);
+  g_match_info_free (match);
+
+  /* partial matching is done by the interpreter */
+  g_assert (!g_regex_match (regex, "field", G_REGEX_MATCH_PARTIAL, &match));
+  g_assert (g_match_info_is_partial_match (match));
+  g_match_info_free (match);
+
+  g_string_free (line, TRUE);
+  g_regex_unref (regex);
+}
+
 static gboolean
 pcre_ge (guint64 major, guint64 minor)
 {
@@ -2202,6 +2287,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/regex/multiline", test_multiline);
   g_test_add_func ("/regex/explicit-crlf", test_explicit_crlf);
   g_test_add_func ("/regex/max-lookbehind", test_max_lookbehind);
+  g_test_add_func ("/regex/match-simple/cache", test_match_simple_cache);
+  g_test_add_func ("/regex/optimize/long", test_optimize_long);
 
   /* TEST_NEW(pattern, compile_opts, match_opts) */
   TEST_NEW("[A-Z]+", G_REGEX_CASELESS | G_REGEX_EXTENDED | G_REGEX_OPTIMIZE, G_REGEX_MATCH_NOTBOL | G_REGEX_MATCH_PARTIAL);
@@ -0,0 +1,246 @@
+/* Unit tests for GRingQueue
+ *
+ * This work is provided "as is"; redistribution and modification
+ * in whole or in part, in any medium, physical or electronic is
+ * permitted without restriction.
+ *
+ * This work is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * In no event shall the authors or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ */
+
+#include <glib.h>
+
+static void
+check_same (GRingQueue *ring,
+            GQueue     *queue)
+{
+  GList *l;
+  guint i;
+
+  g_assert_cmpuint (g_ring_queue_get_length (ring), ==, g_queue_get_length (queue));
+  g_assert_cmpint (g_ring_queue_is_empty (ring), ==, g_queue_is_empty (queue));
+  g_assert (g_ring_queue_peek_head (ring) == g_queue_peek_head (queue));
+  g_assert (g_ring_queue_peek_tail (ring) == g_queue_peek_tail (queue));
+
+  for (l = queue->head, i = 0; l != NULL; l = l->next, i++)
+    g_assert (g_ring_queue_peek_nth (ring, i) == l->data);
+  g_assert_null (g_ring_queue_peek_nth (ring, i));
+}
+
+static void
+test_basic (void)
+{
+  GRingQueue *q;
+  gint i;
+
+  q = g_ring_queue_new ();
+  g_assert (g_ring_queue_is_empty (q));
+  g_assert_null (g_ring_queue_pop_head (q));
+  g_assert_null (g_ring_queue_pop_tail (q));
+  g_assert_null (g_ring_queue_peek_head (q));
+  g_assert_null (g_ring_queue_peek_tail (q));
+
+  for (i = 1; i <= 5; i++)
+    g_ring_queue_push_tail (q, GINT_TO_POINTER (i));
+  for (i = 0; i > -5; i--)
+    g_ring_queue_push_head (q, GINT_TO_POINTER (i));
+
+  /* -4 -3 -2 -1 0 1 2 3 4 5 */
+  g_assert_cmpuint (g_ring_queue_get_length (q), ==, 10);
+  for (i = 0; i < 10; i++)
+    g_assert_cmpint (GPOINTER_TO_INT (g_ring_queue_peek_nth (q, i)), ==, i - 4);
+  g_assert_cmpint (g_ring_queue_index (q, GINT_TO_POINTER (3)), ==, 7);
+  g_assert_cmpint (g_ring_queue_index (q, GINT_TO_POINTER (42)), ==, -1);
+
+  g_assert (g_ring_queue_remove (q, GINT_TO_POINTER (0)));
+  g_assert (!g_ring_queue_remove (q, GINT_TO_POINTER (0)));
+  g_assert_cmpint (GPOINTER_TO_INT (g_ring_queue_pop_nth (q, 1)), ==, -3);
+  g_assert_null (g_ring_queue_pop_nth (q, 8));
+
+  g_assert_cmpint (GPOINTER_TO_INT (g_ring_queue_pop_head (q)), ==, -4);
+  g_assert_cmpint (GPOINTER_TO_INT (g_ring_queue_pop_tail (q)), ==, 5);
+  g_assert_cmpuint (g_ring_queue_get_length (q), ==, 6);
+
+  g_ring_queue_clear (q);
+  g_assert (g_ring_queue_is_empty (q));
+
+  g_ring_queue_free (q);
+}
+
+/* Applies the same random operations to a GRingQueue and a GQueue,
+ * and checks that they always agree.
+ */
+static void
+test_random (void)
+{
+  GRingQueue *ring;
+  GQueue *queue;
+  gint i, n, len;
+  gpointer data;
+
+  ring = g_ring_queue_new ();
+  queue = g_queue_new ();
+
+  for (i = 0; i < 10000; i++)
+    {
+      data = GINT_TO_POINTER (g_test_rand_int_range (0, 100));
+      len = g_queue_get_length (queue);
+      n = g_test_rand_int_range (-1, len + 2);
+
+      switch (g_test_rand_int_range (0, 8))
+        {
+        case 0:
+          g_ring_queue_push_head (ring, data);
+          g_queue_push_head (queue, data);
+          break;
+        case 1:
+          g_ring_queue_push_tail (ring, data);
+          g_queue_push_tail (queue, data);
+          break;
+        case 2:
+          g_ring_queue_push_nth (ring, data, n);
+          g_queue_push_nth (queue, data, n);
+          break;
+        case 3:
+          g_assert (g_ring_queue_pop_head (ring) == g_queue_pop_head (queue));
+          break;
+        case 4:
+          g_assert (g_ring_queue_pop_tail (ring) == g_queue_pop_tail (queue));
+          break;
+        case 5:
+          n = MAX (n, 0);
+          g_assert (g_ring_queue_pop_nth (ring, n) == g_queue_pop_nth (queue, n));
+          break;
+        case 6:
+          g_assert_cmpint (g_ring_queue_remove (ring, data), ==,
+                           g_queue_remove (queue, data));
+          break;
+        case 7:
+          /* push more often than we pop, so the queue grows */
+          g_ring_queue_push_tail (ring, data);
+          g_queue_push_tail (queue, data);
+          break;
+        }
+
+      check_same (ring, queue);
+    }
+
+  g_ring_queue_free (ring);
+  g_queue_free (queue);
+}
+
+static gint
+compare_keys (gconstpointer a,
+              gconstpointer b,
+              gpointer      user_data)
+{
+  return GPOINTER_TO_INT (a) % 10 - GPOINTER_TO_INT (b) % 10;
+}
+
+static void
+test_sort (void)
+{
+  GRingQueue *ring;
+  GQueue *queue;
+  gint i;
+  gpointer data;
+
+  ring = g_ring_queue_new ();
+  queue = g_queue_new ();
+
+  /* make the contents wrap around the end of the buffer */
+  for (i = 0; i < 20; i++)
+    g_ring_queue_push_tail (ring, NULL);
+  for (i = 0; i < 20; i++)
+    g_ring_queue_pop_head (ring);
+
+  for (i = 0; i < 30; i++)
+    {
+      data = GINT_TO_POINTER (i * 10 + g_test_rand_int_range (0, 10));
+      g_ring_queue_push_tail (ring, data);
+      g_queue_push_tail (queue, data);
+    }
+
+  /* both sorts are stable, so the results must be identical */
+  g_ring_queue_sort (ring, compare_keys, NULL);
+  g_queue_sort (queue, compare_keys, NULL);
+  check_same (ring, queue);
+
+  for (i = 0; i < 30; i++)
+    {
+      data = GINT_TO_POINTER (g_test_rand_int_range (0, 1000));
+      g_ring_queue_insert_sorted (ring, data, compare_keys, NULL);
+      g_queue_insert_sorted (queue, data, compare_keys, NULL);
+      check_same (ring, queue);
+    }
+
+  g_ring_queue_free (ring);
+  g_queue_free (queue);
+}
+
+static void
+remove_odd (gpointer data,
+            gpointer user_data)
+{
+  GRingQueue *q = user_data;
+
+  if (GPOINTER_TO_INT (data) % 2)
+    g_ring_queue_remove (q, data);
+}
+
+static void
+test_foreach_remove (void)
+{
+  GRingQueue *q;
+  gint i;
+
+  q = g_ring_queue_new ();
+  for (i = 1; i <= 10; i++)
+    g_ring_queue_push_tail (q, GINT_TO_POINTER (i));
+
+  g_ring_queue_foreach (q, remove_odd, q);
+
+  g_assert_cmpuint (g_ring_queue_get_length (q), ==, 5);
+  for (i = 0; i < 5; i++)
+    g_assert_cmpint (GPOINTER_TO_INT (g_ring_queue_peek_nth (q, i)), ==, 2 * i + 2);
+
+  g_ring_queue_free (q);
+}
+
+static void
+test_free_full (void)
+{
+  GRingQueue *q;
+  gint i;
+
+  q = g_ring_queue_new ();
+  for (i = 0; i < 20; i++)
+    g_ring_queue_push_head (q, g_strdup_printf ("%d", i));
+
+  /* freeing the strings is checked by valgrind */
+  g_ring_queue_free_full (q, g_free);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/ringqueue/basic", test_basic);
+  g_test_add_func ("/ringqueue/random", test_random);
+  g_test_add_func ("/ringqueue/sort", test_sort);
+  g_test_add_func ("/ringqueue/foreach-remove", test_foreach_remove);
+  g_test_add_func ("/ringqueue/free-full", test_free_full);
+
+  return g_test_run ();
+}
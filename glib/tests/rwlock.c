@@ -269,6 +269,54 @@ test_rwlock8 (void)
   g_rw_lock_clear (&even_lock);
 }
 
+/* A writer blocked on a read-locked lock must not keep the readers
+ * from taking the read lock recursively.
+ */
+static GRWLock recursive_lock;
+static volatile gint writer_started;
+
+static gpointer
+blocked_writer_func (gpointer data)
+{
+  g_atomic_int_set (&writer_started, 1);
+  g_rw_lock_writer_lock (&recursive_lock);
+  g_rw_lock_writer_unlock (&recursive_lock);
+
+  return NULL;
+}
+
+static void
+test_rwlock9 (void)
+{
+  GThread *writer;
+
+  g_rw_lock_init (&recursive_lock);
+  writer_started = 0;
+
+  g_rw_lock_reader_lock (&recursive_lock);
+
+  writer = g_thread_new ("writer", blocked_writer_func, NULL);
+  while (!g_atomic_int_get (&writer_started))
+    g_usleep (1000);
+  g_usleep (10000);
+
+  g_assert (!g_rw_lock_writer_trylock (&recursive_lock));
+  g_rw_lock_reader_lock (&recursive_lock);
+  g_assert (g_rw_lock_reader_trylock (&recursive_lock));
+
+  g_rw_lock_reader_unlock (&recursive_lock);
+  g_rw_lock_reader_unlock (&recursive_lock);
+  g_rw_lock_reader_unlock (&recursive_lock);
+
+  g_thread_join (writer);
+
+  g_assert (g_rw_lock_writer_trylock (&recursive_lock));
+  g_assert (!g_rw_lock_reader_trylock (&recursive_lock));
+  g_rw_lock_writer_unlock (&recursive_lock);
+
+  g_rw_lock_clear (&recursive_lock);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -282,6 +330,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/thread/rwlock6", test_rwlock6);
   g_test_add_func ("/thread/rwlock7", test_rwlock7);
   g_test_add_func ("/thread/rwlock8", test_rwlock8);
+  g_test_add_func ("/thread/rwlock9", test_rwlock9);
 
   return g_test_run ();
 }
@@ -17,8 +17,12 @@
  * License along with this library; if not, see <http://www.gnu.org/licenses/>.
  */
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <string.h>
 #include <stdlib.h>
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#endif
 
 
 /* GScanner fixture */
@@ -127,6 +131,84 @@ test_scanner_tokens (ScannerFixture *fix,
   return;
 }
 
+static void
+check_identifiers (GScanner *scanner,
+                   guint     n_words)
+{
+  gchar *expected;
+  guint i;
+
+  for (i = 0; i < n_words; i++)
+    {
+      GTokenType token;
+
+      token = g_scanner_get_next_token (scanner);
+      g_assert_cmpuint (g_scanner_cur_line (scanner), ==, i / 10 + 1);
+
+      if (i % 7 == 0)
+        {
+          g_assert_cmpint (token, ==, G_TOKEN_SYMBOL);
+          g_assert_cmpint (GPOINTER_TO_INT (g_scanner_cur_value (scanner).v_symbol), ==, 42);
+        }
+      else
+        {
+          g_assert_cmpint (token, ==, G_TOKEN_IDENTIFIER);
+          expected = g_strdup_printf ("word_%u_with_some_length", i);
+          g_assert_cmpstr (g_scanner_cur_value (scanner).v_identifier, ==, expected);
+          g_free (expected);
+        }
+    }
+
+  g_assert_cmpint (g_scanner_get_next_token (scanner), ==, G_TOKEN_EOF);
+}
+
+static void
+test_scanner_identifiers (ScannerFixture *fix,
+                          gconstpointer   test_data)
+{
+  const gchar *long_symbol = "A_Symbol_That_Is_Longer_Than_Sixty_Four_Characters_To_Test_Lookups";
+  GString *text;
+  guint i, n_words = 10000;
+#ifdef G_OS_UNIX
+  GError *error = NULL;
+  gchar *filename;
+  gint fd;
+#endif
+
+  /* symbols are case-insensitive by default */
+  g_scanner_scope_add_symbol (fix->scanner, 0, long_symbol, GINT_TO_POINTER (42));
+
+  text = g_string_new (NULL);
+  for (i = 0; i < n_words; i++)
+    {
+      if (i % 7 == 0)
+        g_string_append (text, i % 2 ? long_symbol : "a_symbol_that_is_longer_than_sixty_four_characters_to_test_lookups");
+      else
+        g_string_append_printf (text, "word_%u_with_some_length", i);
+      g_string_append_c (text, i % 10 == 9 ? '\n' : ' ');
+    }
+
+  g_scanner_input_text (fix->scanner, text->str, text->len);
+  check_identifiers (fix->scanner, n_words);
+
+#ifdef G_OS_UNIX
+  /* the same from a file, with identifiers crossing read buffers */
+  fd = g_file_open_tmp ("scannerapi-XXXXXX", &filename, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (write (fd, text->str, text->len), ==, text->len);
+  g_assert_cmpint (lseek (fd, 0, SEEK_SET), ==, 0);
+
+  g_scanner_input_file (fix->scanner, fd);
+  check_identifiers (fix->scanner, n_words);
+
+  close (fd);
+  g_unlink (filename);
+  g_free (filename);
+#endif
+
+  g_string_free (text, TRUE);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -137,6 +219,7 @@ main (int   argc,
   g_test_add ("/scanner/error", ScannerFixture, 0, scanner_fixture_setup, test_scanner_error, scanner_fixture_teardown);
   g_test_add ("/scanner/symbols", ScannerFixture, 0, scanner_fixture_setup, test_scanner_symbols, scanner_fixture_teardown);
   g_test_add ("/scanner/tokens", ScannerFixture, 0, scanner_fixture_setup, test_scanner_tokens, scanner_fixture_teardown);
+  g_test_add ("/scanner/identifiers", ScannerFixture, 0, scanner_fixture_setup, test_scanner_identifiers, scanner_fixture_teardown);
 
   return g_test_run();
 }
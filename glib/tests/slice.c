@@ -150,6 +150,129 @@ test_allocate (void)
     g_thread_join (threads[i]);
 }
 
+#define N_TRIM_BLOCKS 10000
+
+static gpointer
+thread_trim_producer (gpointer data)
+{
+  GAsyncQueue *queue = data;
+  gint i;
+
+  for (i = 0; i < N_TRIM_BLOCKS; i++)
+    {
+      guint32 *block = g_slice_alloc (8 * sizeof (guint32) * (1 + i % 4));
+
+      block[0] = i;
+      g_async_queue_push (queue, block);
+    }
+
+  return NULL;
+}
+
+static gpointer
+thread_trim_consumer (gpointer data)
+{
+  GAsyncQueue *queue = data;
+  gint i;
+
+  /* blocks are freed in another thread than the one that allocated
+   * them, so magazines travel through the depot
+   */
+  for (i = 0; i < N_TRIM_BLOCKS; i++)
+    {
+      guint32 *block = g_async_queue_pop (queue);
+
+      g_slice_free1 (8 * sizeof (guint32) * (1 + block[0] % 4), block);
+    }
+
+  g_slice_trim ();
+
+  return NULL;
+}
+
+static void
+test_trim (void)
+{
+  GAsyncQueue *queue;
+  GThread *threads[4];
+  gpointer blocks[256];
+  gint round, i;
+
+  /* nothing cached yet */
+  g_slice_trim ();
+
+  queue = g_async_queue_new ();
+
+  for (round = 0; round < 3; round++)
+    {
+      for (i = 0; i < G_N_ELEMENTS (threads); i += 2)
+        {
+          threads[i] = g_thread_new ("producer", thread_trim_producer, queue);
+          threads[i + 1] = g_thread_new ("consumer", thread_trim_consumer, queue);
+        }
+
+      for (i = 0; i < G_N_ELEMENTS (threads); i++)
+        g_thread_join (threads[i]);
+
+      g_slice_trim ();
+
+      /* the allocator keeps working after its caches were dropped */
+      for (i = 0; i < G_N_ELEMENTS (blocks); i++)
+        {
+          blocks[i] = g_slice_alloc (48);
+          memset (blocks[i], i, 48);
+        }
+      for (i = 0; i < G_N_ELEMENTS (blocks); i++)
+        {
+          g_assert_cmpint (((guint8 *) blocks[i])[47], ==, (guint8) i);
+          g_slice_free1 (48, blocks[i]);
+        }
+    }
+
+  g_async_queue_unref (queue);
+}
+
+static void
+test_stats (void)
+{
+  gpointer blocks[7];
+  gpointer mem;
+  gsize chunk_size = (1000 + 2 * sizeof (gsize) - 1) & ~(2 * sizeof (gsize) - 1);
+  gchar *report, *str;
+  gint i;
+
+  g_mem_stats_set_sample_interval (1);
+  g_mem_stats_set_enabled (TRUE);
+  g_mem_stats_reset ();
+
+  for (i = 0; i < G_N_ELEMENTS (blocks); i++)
+    blocks[i] = g_slice_alloc (1000);
+  g_slice_free1 (1000, blocks[0]);
+  g_slice_free1 (1000, blocks[1]);
+  mem = g_malloc (100);
+
+  g_mem_stats_set_enabled (FALSE);
+
+  report = g_mem_stats_dump ();
+  g_assert (g_str_has_prefix (report, "g_malloc: "));
+  g_assert (strstr (report, "\ng_slice:\n") != NULL);
+  g_assert (strstr (report, "7 allocated, 2 freed, 5 in use\n") != NULL);
+  /* with an interval of 1, every byte is a sample */
+  str = g_strdup_printf ("\ng_slice_alloc: ~%" G_GSIZE_FORMAT " bytes, %" G_GSIZE_FORMAT " samples, "
+                         "%" G_GSIZE_FORMAT " bytes per sampled allocation\n",
+                         7 * chunk_size, 7 * chunk_size, chunk_size);
+  g_assert (strstr (report, str) != NULL);
+  g_free (str);
+  g_free (report);
+
+  g_free (mem);
+  for (i = 2; i < G_N_ELEMENTS (blocks); i++)
+    g_slice_free1 (1000, blocks[i]);
+
+  g_mem_stats_reset ();
+  g_mem_stats_set_sample_interval (512 * 1024);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -162,6 +285,8 @@ main (int argc, char **argv)
   g_test_add_func ("/slice/copy", test_slice_copy);
   g_test_add_func ("/slice/chain", test_chain);
   g_test_add_func ("/slice/allocate", test_allocate);
+  g_test_add_func ("/slice/trim", test_trim);
+  g_test_add_func ("/slice/stats", test_stats);
 
   return g_test_run ();
 }
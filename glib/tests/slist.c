@@ -45,6 +45,44 @@ test_slist_sort (void)
   g_slist_free (slist);
 }
 
+static gint
+compare_modulo (gconstpointer p1, gconstpointer p2)
+{
+  return GPOINTER_TO_INT (p1) % 1000 - GPOINTER_TO_INT (p2) % 1000;
+}
+
+static void
+test_slist_sort_stable (void)
+{
+  GSList *list = NULL, *l;
+  gint n, i;
+
+  /* lengths around powers of two, and a large one */
+  for (n = 0; n <= 100000; n = (n < 70 ? n + 1 : n * 4 + 1))
+    {
+      /* the key is in the low digits, the original position above */
+      list = NULL;
+      for (i = n - 1; i >= 0; i--)
+        list = g_slist_prepend (list, GINT_TO_POINTER (i * 1000 + (i * 7919) % 997));
+
+      list = g_slist_sort (list, compare_modulo);
+      g_assert_cmpuint (g_slist_length (list), ==, n);
+
+      /* elements with the same key keep their order */
+      for (l = list; l != NULL && l->next != NULL; l = l->next)
+        {
+          gint a = GPOINTER_TO_INT (l->data);
+          gint b = GPOINTER_TO_INT (l->next->data);
+
+          g_assert_cmpint (a % 1000, <=, b % 1000);
+          if (a % 1000 == b % 1000)
+            g_assert_cmpint (a / 1000, <, b / 1000);
+        }
+
+      g_slist_free (list);
+    }
+}
+
 static void
 test_slist_sort_with_data (void)
 {
@@ -337,6 +375,7 @@ main (int argc, char *argv[])
     array[i] = g_test_rand_int_range (NUMBER_MIN, NUMBER_MAX);
 
   g_test_add_func ("/slist/sort", test_slist_sort);
+  g_test_add_func ("/slist/sort-stable", test_slist_sort_stable);
   g_test_add_func ("/slist/sort-with-data", test_slist_sort_with_data);
   g_test_add_func ("/slist/insert-sorted", test_slist_insert_sorted);
   g_test_add_func ("/slist/insert-sorted-with-data", test_slist_insert_sorted_with_data);
@@ -114,6 +114,74 @@ test_sort_big (void)
   g_free (data);
 }
 
+static void
+test_sort_parallel (void)
+{
+  SortItem *data;
+  gint n = 200000;
+  gint i;
+
+  data = g_malloc (n * sizeof (SortItem));
+  for (i = 0; i < n; i++)
+    {
+      data[i].val = g_random_int_range (0, 10000);
+      data[i].i = i;
+    }
+
+  g_qsort_with_data_parallel (data, n, sizeof (SortItem), item_compare_data, NULL);
+
+  for (i = 1; i < n; i++)
+    {
+      g_assert_cmpint (data[i -1].val, <=, data[i].val);
+      if (data[i -1].val == data[i].val)
+        g_assert_cmpint (data[i -1].i, <, data[i].i);
+    }
+
+  /* too small to be split up */
+  g_qsort_with_data_parallel (data, 1, sizeof (SortItem), item_compare_data, NULL);
+  g_qsort_with_data_parallel (NULL, 0, sizeof (SortItem), item_compare_data, NULL);
+
+  g_free (data);
+}
+
+static void
+test_sort_uint (void)
+{
+  guint32 *data32;
+  guint64 *data64;
+  gint n = 100000;
+  gint i;
+
+  data32 = g_new (guint32, n);
+  data64 = g_new (guint64, n);
+  for (i = 0; i < n; i++)
+    {
+      data32[i] = g_random_int ();
+      /* some bytes the same in all keys */
+      data64[i] = ((guint64) g_random_int () << 40) | g_random_int_range (0, 1000);
+    }
+
+  g_sort_uint32 (data32, n);
+  g_sort_uint64 (data64, n);
+
+  for (i = 1; i < n; i++)
+    {
+      g_assert_cmpuint (data32[i - 1], <=, data32[i]);
+      g_assert_cmpuint (data64[i - 1], <=, data64[i]);
+    }
+
+  /* the short ones */
+  for (i = 0; i < 10; i++)
+    data32[i] = 10 - i;
+  g_sort_uint32 (data32, 10);
+  for (i = 0; i < 10; i++)
+    g_assert_cmpuint (data32[i], ==, i + 1);
+  g_sort_uint64 (NULL, 0);
+
+  g_free (data32);
+  g_free (data64);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -122,6 +190,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/sort/basic", test_sort_basic);
   g_test_add_func ("/sort/stable", test_sort_stable);
   g_test_add_func ("/sort/big", test_sort_big);
+  g_test_add_func ("/sort/parallel", test_sort_parallel);
+  g_test_add_func ("/sort/uint", test_sort_uint);
 
   return g_test_run ();
 }
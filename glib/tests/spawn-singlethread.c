@@ -26,6 +26,11 @@
 #include <glib.h>
 #include <string.h>
 
+#ifdef G_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #ifdef G_OS_WIN32
 #define LINEEND "\r\n"
 #else
@@ -200,6 +205,44 @@ test_spawn_script (void)
   g_ptr_array_free (argv, TRUE);
 }
 
+#ifdef G_OS_UNIX
+/* Descriptors without FD_CLOEXEC must only reach the child with
+ * G_SPAWN_LEAVE_DESCRIPTORS_OPEN, whichever way it is launched.
+ */
+static void
+test_spawn_close_descriptors (void)
+{
+  GError *error = NULL;
+  gchar *argv[] = { "/bin/sh", "-c", NULL, NULL };
+  gint estatus;
+  gint fd;
+
+  fd = open ("/dev/null", O_WRONLY);
+  g_assert_cmpint (fd, >=, 3);
+  if (fd > 9)
+    {
+      g_test_skip ("the shell can only redirect to descriptors 0 to 9");
+      close (fd);
+      return;
+    }
+
+  argv[2] = g_strdup_printf ("true >&%d", fd);
+
+  g_spawn_sync (NULL, argv, NULL, G_SPAWN_STDERR_TO_DEV_NULL,
+                NULL, NULL, NULL, NULL, &estatus, &error);
+  g_assert_no_error (error);
+  g_assert_false (g_spawn_check_exit_status (estatus, NULL));
+
+  g_spawn_sync (NULL, argv, NULL, G_SPAWN_LEAVE_DESCRIPTORS_OPEN,
+                NULL, NULL, NULL, NULL, &estatus, &error);
+  g_assert_no_error (error);
+  g_assert_true (g_spawn_check_exit_status (estatus, NULL));
+
+  g_free (argv[2]);
+  close (fd);
+}
+#endif
+
 int
 main (int   argc,
       char *argv[])
@@ -230,6 +273,9 @@ main (int   argc,
   g_test_add_func ("/gthread/spawn-single-sync", test_spawn_sync);
   g_test_add_func ("/gthread/spawn-single-async", test_spawn_async);
   g_test_add_func ("/gthread/spawn-script", test_spawn_script);
+#ifdef G_OS_UNIX
+  g_test_add_func ("/gthread/spawn-close-descriptors", test_spawn_close_descriptors);
+#endif
 
   ret = g_test_run();
 
@@ -426,6 +426,64 @@ test_strcompress_strescape (void)
   g_free (tmp);
 }
 
+/* Checks the vector paths of g_ascii_strdown(), g_ascii_strup() and
+ * g_strescape() against byte-wise results, at every alignment and with
+ * the interesting byte at every position.
+ */
+static void
+test_ascii_long (void)
+{
+  gchar buf[64], exceptions[2];
+  gchar *lowered;
+  guint offset, pos, c;
+
+  for (offset = 0; offset < 16; offset++)
+    for (pos = 0; pos < 40; pos++)
+      for (c = 1; c < 256; c++)
+        {
+          gchar *str = buf + offset;
+          gchar *down, *up, *escaped, *compressed;
+          guint i;
+
+          memset (str, 'm', 40);
+          str[40] = '\0';
+          str[pos] = c;
+
+          down = g_ascii_strdown (str, -1);
+          up = g_ascii_strup (str, -1);
+          for (i = 0; i < 40; i++)
+            {
+              g_assert_cmpint (down[i], ==, g_ascii_tolower (str[i]));
+              g_assert_cmpint (up[i], ==, g_ascii_toupper (str[i]));
+            }
+          g_assert_cmpint (g_ascii_strcasecmp (down, up), ==, 0);
+          g_free (down);
+          g_free (up);
+
+          escaped = g_strescape (str, NULL);
+          if (c >= ' ' && c < 0177 && c != '\\' && c != '"')
+            g_assert_cmpstr (escaped, ==, str);
+          else
+            g_assert_cmpuint (strlen (escaped), >, 40);
+          compressed = g_strcompress (escaped);
+          g_assert_cmpstr (compressed, ==, str);
+          g_free (compressed);
+          g_free (escaped);
+
+          exceptions[0] = c;
+          exceptions[1] = '\0';
+          escaped = g_strescape (str, exceptions);
+          g_assert_cmpstr (escaped, ==, str);
+          g_free (escaped);
+        }
+
+  /* Only the bytes up to an embedded nul are converted */
+  memcpy (buf, "ABCDEFGHIJKLMNOPQRSTUVWXYZ\0ABCDEFGHIJKLMNOPQRSTUVWXYZ", 53);
+  lowered = g_ascii_strdown (buf, 53);
+  g_assert_cmpstr (lowered, ==, "abcdefghijklmnopqrstuvwxyz");
+  g_free (lowered);
+}
+
 static void
 test_ascii_strcasecmp (void)
 {
@@ -822,6 +880,52 @@ test_strsplit (void)
   strv_check (g_strsplit (",,x,,y,,z,,", ",,", 2), "", "x,,y,,z,,", NULL);
 }
 
+static void
+check_strsplit_in_place (const gchar *string,
+                         const gchar *delimiter,
+                         gint         max_tokens)
+{
+  gchar **expected, **tokens;
+  gchar *copy;
+  guint i;
+
+  expected = g_strsplit (string, delimiter, max_tokens);
+  copy = g_strdup (string);
+  tokens = g_strsplit_in_place (copy, delimiter, max_tokens);
+
+  for (i = 0; expected[i] != NULL; i++)
+    {
+      g_assert_nonnull (tokens[i]);
+      g_assert_true (tokens[i] >= copy && tokens[i] <= copy + strlen (string));
+      g_assert_cmpstr (tokens[i], ==, expected[i]);
+    }
+  g_assert_null (tokens[i]);
+
+  g_free (tokens);
+  g_free (copy);
+  g_strfreev (expected);
+}
+
+static void
+test_strsplit_in_place (void)
+{
+  const gchar *strings[] = {
+    "", "x", "x,y", "x,y,", ",x,y", ",x,y,", "x,y,z", ",,x,,y,,z,,",
+    ",", ",,", ",,,"
+  };
+  gint max_tokens;
+  guint i;
+
+  for (max_tokens = 0; max_tokens < 5; max_tokens++)
+    for (i = 0; i < G_N_ELEMENTS (strings); i++)
+      {
+        check_strsplit_in_place (strings[i], ",", max_tokens);
+        check_strsplit_in_place (strings[i], ",,", max_tokens);
+      }
+
+  check_strsplit_in_place ("Host: example.com\r\nAccept: */*\r\n\r\n", "\r\n", -1);
+}
+
 static void
 test_strsplit_set (void)
 {
@@ -1517,6 +1621,7 @@ main (int   argc,
   g_test_add_func ("/strfuncs/strjoin", test_strjoin);
   g_test_add_func ("/strfuncs/strcanon", test_strcanon);
   g_test_add_func ("/strfuncs/strcompress-strescape", test_strcompress_strescape);
+  g_test_add_func ("/strfuncs/ascii-long", test_ascii_long);
   g_test_add_func ("/strfuncs/ascii-strcasecmp", test_ascii_strcasecmp);
   g_test_add_func ("/strfuncs/strchug", test_strchug);
   g_test_add_func ("/strfuncs/strchomp", test_strchomp);
@@ -1526,6 +1631,7 @@ main (int   argc,
   g_test_add_func ("/strfuncs/has-prefix", test_has_prefix);
   g_test_add_func ("/strfuncs/has-suffix", test_has_suffix);
   g_test_add_func ("/strfuncs/strsplit", test_strsplit);
+  g_test_add_func ("/strfuncs/strsplit-in-place", test_strsplit_in_place);
   g_test_add_func ("/strfuncs/strsplit-set", test_strsplit_set);
   g_test_add_func ("/strfuncs/strv-length", test_strv_length);
   g_test_add_func ("/strfuncs/strtod", test_strtod);
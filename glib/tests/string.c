@@ -75,6 +75,60 @@ test_string_chunk_insert (void)
   g_string_chunk_free (chunk);
 }
 
+static void
+test_string_chunk_insert_const_len (void)
+{
+  const gchar tokens[] = "foo bar foo baz\0bar";
+  GStringChunk *chunk;
+  gchar *str[5], *s;
+  gsize size;
+  gint i;
+
+  chunk = g_string_chunk_new (16);
+  g_assert_cmpuint (g_string_chunk_get_memory_size (chunk), >, 0);
+  size = g_string_chunk_get_memory_size (chunk);
+
+  str[0] = g_string_chunk_insert_const_len (chunk, tokens, 3);
+  str[1] = g_string_chunk_insert_const_len (chunk, tokens + 4, 3);
+  str[2] = g_string_chunk_insert_const_len (chunk, tokens + 8, 3);
+  str[3] = g_string_chunk_insert_const_len (chunk, tokens + 12, 7);
+  str[4] = g_string_chunk_insert_const (chunk, "bar");
+
+  g_assert_cmpstr (str[0], ==, "foo");
+  g_assert_cmpstr (str[1], ==, "bar");
+  g_assert (str[0] == str[2]);
+  g_assert (str[1] == str[4]);
+
+  /* strings with embedded nuls only match with the same length */
+  g_assert (str[3] != g_string_chunk_insert_const (chunk, "baz"));
+  g_assert (memcmp (str[3], "baz\0bar", 8) == 0);
+  g_assert (str[3] == g_string_chunk_insert_const_len (chunk, "baz\0bar", 7));
+
+  /* enough strings to grow the table several times */
+  for (i = 0; i < 10000; i++)
+    {
+      s = g_strdup_printf ("token%d", i);
+      g_assert_cmpstr (g_string_chunk_insert_const (chunk, s), ==, s);
+      g_free (s);
+    }
+  for (i = 0; i < 10000; i++)
+    {
+      s = g_strdup_printf ("token%d", i % 100);
+      g_assert (g_string_chunk_insert_const (chunk, s) ==
+                g_string_chunk_insert_const_len (chunk, s, -1));
+      g_free (s);
+    }
+  g_assert (g_string_chunk_insert_const (chunk, "foo") == str[0]);
+  g_assert_cmpuint (g_string_chunk_get_memory_size (chunk), >, size + 10000 * 8);
+
+  g_string_chunk_clear (chunk);
+  str[0] = g_string_chunk_insert_const (chunk, "foo");
+  g_assert_cmpstr (str[0], ==, "foo");
+  g_assert (g_string_chunk_insert_const_len (chunk, "food", 3) == str[0]);
+
+  g_string_chunk_free (chunk);
+}
+
 static void
 test_string_new (void)
 {
@@ -493,6 +547,66 @@ test_string_to_bytes (void)
   g_bytes_unref (bytes);
 }
 
+static void
+test_string_reserve (void)
+{
+  GString *s;
+  gchar *str;
+
+  s = g_string_new ("foo");
+  g_string_reserve (s, 1000);
+  g_assert_cmpuint (s->allocated_len, ==, 1004);
+  str = s->str;
+  while (s->len < 1003)
+    g_string_append_c (s, 'x');
+  g_assert (s->str == str);
+  g_assert_cmpuint (s->allocated_len, ==, 1004);
+
+  /* nothing to do if there is enough room */
+  g_string_reserve (s, 0);
+  g_assert_cmpuint (s->allocated_len, ==, 1004);
+
+  g_string_truncate (s, 3);
+  g_string_shrink_to_fit (s);
+  g_assert_cmpuint (s->allocated_len, ==, 4);
+  g_assert_cmpstr (s->str, ==, "foo");
+
+  g_string_append (s, "bar");
+  g_assert_cmpstr (s->str, ==, "foobar");
+
+  g_string_free (s, TRUE);
+}
+
+static void
+test_string_append_printf_long (void)
+{
+  GString *s;
+  gchar *long_str;
+  gchar *expected;
+
+  long_str = g_strnfill (1000, 'a');
+
+  s = g_string_new ("x");
+  g_string_append_printf (s, "[%s]", long_str);
+  expected = g_strdup_printf ("x[%s]", long_str);
+  g_assert_cmpstr (s->str, ==, expected);
+  g_assert_cmpuint (s->len, ==, 1003);
+  g_free (expected);
+
+  /* the arguments may be the string itself */
+  g_string_assign (s, "abc");
+  g_string_append_printf (s, "%s-%s", s->str, s->str);
+  g_assert_cmpstr (s->str, ==, "abcabc-abc");
+
+  g_string_assign (s, long_str);
+  g_string_append_printf (s, "%s", s->str);
+  g_assert_cmpuint (s->len, ==, 2000);
+  g_assert (strspn (s->str, "a") == 2000);
+
+  g_string_free (s, TRUE);
+  g_free (long_str);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -501,6 +615,7 @@ main (int   argc,
 
   g_test_add_func ("/string/test-string-chunks", test_string_chunks);
   g_test_add_func ("/string/test-string-chunk-insert", test_string_chunk_insert);
+  g_test_add_func ("/string/test-string-chunk-insert-const-len", test_string_chunk_insert_const_len);
   g_test_add_func ("/string/test-string-new", test_string_new);
   g_test_add_func ("/string/test-string-printf", test_string_printf);
   g_test_add_func ("/string/test-string-assign", test_string_assign);
@@ -517,6 +632,8 @@ main (int   argc,
   g_test_add_func ("/string/test-string-up-down", test_string_up_down);
   g_test_add_func ("/string/test-string-set-size", test_string_set_size);
   g_test_add_func ("/string/test-string-to-bytes", test_string_to_bytes);
+  g_test_add_func ("/string/test-string-reserve", test_string_reserve);
+  g_test_add_func ("/string/test-string-append-printf-long", test_string_append_printf_long);
 
   return g_test_run();
 }
@@ -27,6 +27,7 @@
 #define G_LOG_DOMAIN "testing"
 
 #include <glib.h>
+#include <glib/gstdio.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -724,6 +725,70 @@ test_skip_all (void)
   g_ptr_array_unref (argv);
 }
 
+static void
+bench_loop (gconstpointer data,
+            guint64       n_iterations)
+{
+  volatile guint64 sum = 0;
+  guint64 i;
+
+  g_assert (data == (gconstpointer) 0xbe4c4);
+  g_assert (g_test_perf () || n_iterations == 1);
+
+  for (i = 0; i < n_iterations; i++)
+    sum += i;
+}
+
+static void
+test_bench (void)
+{
+  const gchar *argv[] = { NULL, "--GTestSubprocess", "--verbose", "-p", "/misc/bench/subprocess/loop",
+                          "-m", "perf", "--bench-time=0.05", "--bench-json", NULL, NULL };
+  GError *error = NULL;
+  gchar *output, *json, *json_file;
+  int status;
+
+  argv[0] = argv0;
+
+  /* without -m perf, the benchmark only runs once */
+  argv[5] = NULL;
+  g_spawn_sync (NULL, (char **) argv, NULL, G_SPAWN_STDERR_TO_DEV_NULL,
+                NULL, NULL, &output, NULL, &status, &error);
+  g_assert_no_error (error);
+  g_spawn_check_exit_status (status, &error);
+  g_assert_no_error (error);
+  g_assert (strstr (output, "GTest: result: OK") != NULL);
+  g_assert (strstr (output, "MINPERF") == NULL);
+  g_free (output);
+
+  json_file = g_build_filename (g_get_tmp_dir (), "testing-bench.json", NULL);
+  g_remove (json_file);
+
+  argv[5] = "-m";
+  argv[9] = json_file;
+  g_spawn_sync (NULL, (char **) argv, NULL, G_SPAWN_STDERR_TO_DEV_NULL,
+                NULL, NULL, &output, NULL, &status, &error);
+  g_assert_no_error (error);
+  g_spawn_check_exit_status (status, &error);
+  g_assert_no_error (error);
+  g_assert (strstr (output, "(MINPERF:/misc/bench/subprocess/loop: ") != NULL);
+  g_assert (strstr (output, " ns per iteration (min ") != NULL);
+  g_free (output);
+
+  g_assert (g_file_get_contents (json_file, &json, NULL, &error));
+  g_assert_no_error (error);
+  g_assert (g_str_has_prefix (json, "{\"test\": \"/misc/bench/subprocess/loop\", \"iterations\": "));
+  g_assert (strstr (json, "\"samples\": ") != NULL);
+  g_assert (strstr (json, "\"min_ns\": ") != NULL);
+  g_assert (strstr (json, "\"median_ns\": ") != NULL);
+  g_assert (strstr (json, "\"p99_ns\": ") != NULL);
+  g_assert (g_str_has_suffix (json, "}\n"));
+  g_free (json);
+
+  g_remove (json_file);
+  g_free (json_file);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -794,6 +859,8 @@ main (int   argc,
   g_test_add_func ("/misc/fail", test_fail);
   g_test_add_func ("/misc/incomplete", test_incomplete);
   g_test_add_func ("/misc/timeout", test_subprocess_timed_out);
+  g_test_add_func ("/misc/bench", test_bench);
+  g_test_add_bench ("/misc/bench/subprocess/loop", (gconstpointer) 0xbe4c4, bench_loop);
 
   return g_test_run();
 }
@@ -0,0 +1,595 @@
+/* Unit tests for GThreadPool
+ *
+ * This work is provided "as is"; redistribution and modification
+ * in whole or in part, in any medium, physical or electronic is
+ * permitted without restriction.
+ *
+ * This work is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * In no event shall the authors or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <glib.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#define N_TASKS 100000
+
+static volatile gint processed;
+static GMutex seen_mutex;
+static GHashTable *seen_threads;
+
+static void
+count_task (gpointer data,
+            gpointer user_data)
+{
+  g_atomic_int_inc (&processed);
+
+  g_mutex_lock (&seen_mutex);
+  g_hash_table_add (seen_threads, g_thread_self ());
+  g_mutex_unlock (&seen_mutex);
+}
+
+static void
+test_work_stealing (void)
+{
+  GThreadPool *pool;
+  GError *error = NULL;
+  gint i;
+
+  processed = 0;
+  seen_threads = g_hash_table_new (NULL, NULL);
+
+  pool = g_thread_pool_new_full (count_task, NULL, 4,
+                                 G_THREAD_POOL_WORK_STEALING, &error);
+  g_assert_no_error (error);
+  g_assert (pool->exclusive);
+  g_assert_cmpint (g_thread_pool_get_max_threads (pool), ==, 4);
+  g_assert_cmpuint (g_thread_pool_get_num_threads (pool), ==, 4);
+
+  for (i = 1; i <= N_TASKS; i++)
+    {
+      g_assert (g_thread_pool_push (pool, GINT_TO_POINTER (i), &error));
+      g_assert_no_error (error);
+    }
+
+  g_assert_cmpuint (g_thread_pool_unprocessed (pool), <=, N_TASKS);
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+
+  g_assert_cmpint (processed, ==, N_TASKS);
+  g_assert_cmpuint (g_hash_table_size (seen_threads), <=, 4);
+  g_hash_table_unref (seen_threads);
+}
+
+static GThreadPool *recursive_pool;
+
+static void
+spawn_task (gpointer data,
+            gpointer user_data)
+{
+  gint depth = GPOINTER_TO_INT (data);
+
+  g_atomic_int_inc (&processed);
+
+  /* Tasks pushed from a thread of the pool go to its own queue, and
+   * are stolen from there by the others.
+   */
+  if (depth < 12)
+    {
+      g_thread_pool_push (recursive_pool, GINT_TO_POINTER (depth + 1), NULL);
+      g_thread_pool_push (recursive_pool, GINT_TO_POINTER (depth + 1), NULL);
+    }
+}
+
+static void
+test_work_stealing_recursive (void)
+{
+  processed = 0;
+
+  recursive_pool = g_thread_pool_new_full (spawn_task, NULL, 3,
+                                           G_THREAD_POOL_WORK_STEALING, NULL);
+  g_thread_pool_push (recursive_pool, GINT_TO_POINTER (1), NULL);
+
+  /* Wait for the whole tree of tasks before freeing the pool, since
+   * the tasks keep pushing new ones.
+   */
+  while (g_atomic_int_get (&processed) < (1 << 12) - 1)
+    g_usleep (1000);
+
+  g_thread_pool_free (recursive_pool, FALSE, TRUE);
+  g_assert_cmpint (processed, ==, (1 << 12) - 1);
+}
+
+static GMutex block_mutex;
+
+static void
+blocked_task (gpointer data,
+              gpointer user_data)
+{
+  g_mutex_lock (&block_mutex);
+  g_atomic_int_inc (&processed);
+  g_mutex_unlock (&block_mutex);
+}
+
+static void
+test_work_stealing_unprocessed (void)
+{
+  GThreadPool *pool;
+  gint i;
+
+  processed = 0;
+
+  g_mutex_lock (&block_mutex);
+
+  pool = g_thread_pool_new_full (blocked_task, NULL, 2,
+                                 G_THREAD_POOL_WORK_STEALING, NULL);
+  for (i = 1; i <= 10; i++)
+    g_thread_pool_push (pool, GINT_TO_POINTER (i), NULL);
+
+  /* At most two tasks can have been taken by the blocked threads */
+  while (g_thread_pool_unprocessed (pool) > 8)
+    g_usleep (1000);
+  g_assert_cmpuint (g_thread_pool_unprocessed (pool), >=, 8);
+
+  g_assert (g_thread_pool_move_to_front (pool, GINT_TO_POINTER (10)));
+  g_assert (!g_thread_pool_move_to_front (pool, GINT_TO_POINTER (11)));
+
+  g_mutex_unlock (&block_mutex);
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+  g_assert_cmpint (processed, ==, 10);
+}
+
+static void
+short_task (gpointer data,
+            gpointer user_data)
+{
+  g_atomic_int_inc (&processed);
+}
+
+static void
+test_work_stealing_free_busy (void)
+{
+  GThreadPool *pool;
+  gint i, j;
+
+  /* Freeing while the workers race for the last tasks must neither
+   * hang nor lose any of them.
+   */
+  for (i = 0; i < 200; i++)
+    {
+      processed = 0;
+
+      pool = g_thread_pool_new_full (short_task, NULL, 8,
+                                     G_THREAD_POOL_WORK_STEALING, NULL);
+      for (j = 0; j < 100; j++)
+        g_thread_pool_push (pool, GINT_TO_POINTER (j + 1), NULL);
+
+      g_thread_pool_free (pool, FALSE, TRUE);
+      g_assert_cmpint (processed, ==, 100);
+    }
+}
+
+static gpointer
+free_immediately (gpointer data)
+{
+  g_thread_pool_free (data, TRUE, TRUE);
+
+  return NULL;
+}
+
+static void
+test_work_stealing_immediate (void)
+{
+  GThreadPool *pool;
+  GThread *thread;
+  gint i;
+
+  processed = 0;
+
+  g_mutex_lock (&block_mutex);
+
+  pool = g_thread_pool_new_full (blocked_task, NULL, 2,
+                                 G_THREAD_POOL_WORK_STEALING, NULL);
+  for (i = 1; i <= 10; i++)
+    g_thread_pool_push (pool, GINT_TO_POINTER (i), NULL);
+
+  while (g_thread_pool_unprocessed (pool) > 8)
+    g_usleep (1000);
+
+  /* Only the two tasks already running get to finish */
+  thread = g_thread_new ("free", free_immediately, pool);
+  g_usleep (100000);
+  g_mutex_unlock (&block_mutex);
+  g_thread_join (thread);
+
+  g_assert_cmpint (processed, ==, 2);
+}
+
+static void
+test_push_many (gconstpointer data)
+{
+  GThreadPoolFlags flags = GPOINTER_TO_INT (data);
+  GThreadPool *pool;
+  GError *error = NULL;
+  gpointer *tasks;
+  gint i;
+
+  processed = 0;
+  seen_threads = g_hash_table_new (NULL, NULL);
+
+  pool = g_thread_pool_new_full (count_task, NULL, 4, flags, &error);
+  g_assert_no_error (error);
+
+  tasks = g_new (gpointer, N_TASKS);
+  for (i = 0; i < N_TASKS; i++)
+    tasks[i] = GINT_TO_POINTER (i + 1);
+
+  g_assert (g_thread_pool_push_many (pool, tasks, N_TASKS / 2, &error));
+  g_assert_no_error (error);
+  g_assert (g_thread_pool_push_many (pool, tasks + N_TASKS / 2,
+                                     N_TASKS - N_TASKS / 2, &error));
+  g_assert_no_error (error);
+  g_assert (g_thread_pool_push_many (pool, tasks, 0, &error));
+  g_assert_no_error (error);
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+  g_free (tasks);
+
+  g_assert_cmpint (processed, ==, N_TASKS);
+  g_assert_cmpuint (g_hash_table_size (seen_threads), <=, 4);
+  g_hash_table_unref (seen_threads);
+}
+
+#define MAX_BATCH 16
+
+static volatile gint batches;
+static volatile gint batch_sum;
+
+static void
+batch_task (gpointer *tasks,
+            guint     n_tasks,
+            gpointer  user_data)
+{
+  guint i;
+
+  g_assert_cmpuint (n_tasks, >=, 1);
+  g_assert_cmpuint (n_tasks, <=, MAX_BATCH);
+  g_assert (user_data == GINT_TO_POINTER (42));
+
+  for (i = 0; i < n_tasks; i++)
+    g_atomic_int_add (&batch_sum, GPOINTER_TO_INT (tasks[i]));
+
+  g_atomic_int_add (&processed, n_tasks);
+  g_atomic_int_inc (&batches);
+}
+
+static void
+never_called (gpointer data,
+              gpointer user_data)
+{
+  g_assert_not_reached ();
+}
+
+static void
+test_batch_func (void)
+{
+  GThreadPool *pool;
+  GError *error = NULL;
+  gpointer tasks[1000];
+  gint expected = 0;
+  gint i;
+
+  processed = 0;
+  batches = 0;
+  batch_sum = 0;
+
+  pool = g_thread_pool_new (never_called, GINT_TO_POINTER (42), 2, FALSE, &error);
+  g_assert_no_error (error);
+  g_thread_pool_set_batch_func (pool, batch_task, MAX_BATCH);
+
+  for (i = 0; i < (gint) G_N_ELEMENTS (tasks); i++)
+    {
+      tasks[i] = GINT_TO_POINTER (i + 1);
+      expected += i + 1;
+    }
+
+  g_assert (g_thread_pool_push_many (pool, tasks, G_N_ELEMENTS (tasks), &error));
+  g_assert_no_error (error);
+
+  for (i = 0; i < 10; i++)
+    g_thread_pool_push (pool, GINT_TO_POINTER (1), NULL);
+  expected += 10;
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+
+  g_assert_cmpint (processed, ==, G_N_ELEMENTS (tasks) + 10);
+  g_assert_cmpint (batch_sum, ==, expected);
+  g_assert_cmpint (batches, >=, (G_N_ELEMENTS (tasks) + 10) / MAX_BATCH);
+}
+
+static void
+count_batch (gpointer *tasks,
+             guint     n_tasks,
+             gpointer  user_data)
+{
+  g_atomic_int_add (&processed, n_tasks);
+}
+
+static void
+test_batch_func_many_batches (void)
+{
+  GThreadPool *pool;
+  GError *error = NULL;
+  gint i;
+
+  processed = 0;
+
+  /* A single long-lived worker with a large batch size runs thousands
+   * of batches; they must not use up its stack.
+   */
+  pool = g_thread_pool_new (never_called, NULL, 1, TRUE, &error);
+  g_assert_no_error (error);
+  g_thread_pool_set_batch_func (pool, count_batch, 1024);
+
+  for (i = 1; i <= 5000; i++)
+    {
+      g_thread_pool_push (pool, GINT_TO_POINTER (i), NULL);
+      while (g_atomic_int_get (&processed) < i)
+        g_thread_yield ();
+    }
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+  g_assert_cmpint (processed, ==, 5000);
+}
+
+typedef struct
+{
+  gchar *name;
+  gint cpu;
+} PlacementResult;
+
+static void
+placement_task (gpointer data,
+                gpointer user_data)
+{
+  PlacementResult *result = data;
+
+  result->name = NULL;
+  result->cpu = -1;
+
+#ifdef __linux__
+  {
+    cpu_set_t set;
+    gchar *contents;
+
+    if (g_file_get_contents ("/proc/thread-self/comm", &contents, NULL, NULL))
+      result->name = g_strstrip (contents);
+
+    if (sched_getaffinity (0, sizeof set, &set) == 0 && CPU_COUNT (&set) == 1)
+      {
+        gint i;
+
+        for (i = 0; i < CPU_SETSIZE; i++)
+          if (CPU_ISSET (i, &set))
+            result->cpu = i;
+      }
+  }
+#endif
+}
+
+static void
+test_placement (gconstpointer data)
+{
+  GThreadPoolFlags flags = GPOINTER_TO_INT (data);
+  PlacementResult results[8];
+  GThreadPool *pool;
+  GError *error = NULL;
+  guint cpu = 0;
+  guint i;
+
+#ifndef __linux__
+  g_test_skip ("Thread names and CPU affinity are only checked on Linux");
+  return;
+#endif
+
+  pool = g_thread_pool_new_full (placement_task, NULL, 2, flags, &error);
+  g_assert_no_error (error);
+
+  g_thread_pool_set_thread_name (pool, "placed");
+  g_thread_pool_set_cpu_affinity (pool, &cpu, 1, G_THREAD_POOL_PLACEMENT_PACK);
+
+  for (i = 0; i < G_N_ELEMENTS (results); i++)
+    g_thread_pool_push (pool, &results[i], NULL);
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+
+  for (i = 0; i < G_N_ELEMENTS (results); i++)
+    {
+      if (results[i].name)
+        g_assert_cmpstr (results[i].name, ==, "placed");
+      g_free (results[i].name);
+
+      /* Binding may be refused, but never to the wrong CPU */
+      g_assert (results[i].cpu == -1 || results[i].cpu == 0);
+    }
+}
+
+static void
+test_placement_process_mask (void)
+{
+#ifdef __linux__
+  PlacementResult results[2];
+  GThreadPool *pool;
+  cpu_set_t original, restricted;
+  guint first = 0, other = 0;
+  gint i;
+
+  g_assert (sched_getaffinity (0, sizeof original, &original) == 0);
+  if (CPU_COUNT (&original) < 2)
+    {
+      g_test_skip ("Needs at least two CPUs");
+      return;
+    }
+
+  for (i = CPU_SETSIZE - 1; i >= 0; i--)
+    if (CPU_ISSET (i, &original))
+      {
+        other = first;
+        first = i;
+      }
+
+  /* Restrict this thread, so that the threads of the exclusive pool
+   * start out with a single CPU, like after taskset.
+   */
+  CPU_ZERO (&restricted);
+  CPU_SET (first, &restricted);
+  g_assert (sched_setaffinity (0, sizeof restricted, &restricted) == 0);
+
+  pool = g_thread_pool_new (placement_task, NULL, 1, TRUE, NULL);
+
+  /* Neither CPUs outside of that mask, nor going back to all CPUs,
+   * may widen it.
+   */
+  g_thread_pool_set_cpu_affinity (pool, &other, 1, G_THREAD_POOL_PLACEMENT_ANY);
+  g_thread_pool_push (pool, &results[0], NULL);
+  g_thread_pool_set_cpu_affinity (pool, NULL, 0, G_THREAD_POOL_PLACEMENT_ANY);
+  g_thread_pool_push (pool, &results[1], NULL);
+  g_thread_pool_free (pool, FALSE, TRUE);
+
+  for (i = 0; i < 2; i++)
+    {
+      g_assert_cmpint (results[i].cpu, ==, first);
+      g_free (results[i].name);
+    }
+
+  g_assert (sched_setaffinity (0, sizeof original, &original) == 0);
+#else
+  g_test_skip ("CPU affinity is only checked on Linux");
+#endif
+}
+
+static void
+test_placement_reset (void)
+{
+  PlacementResult result;
+  GThreadPool *pool;
+  guint cpu = 0;
+
+#ifndef __linux__
+  g_test_skip ("Thread names are only checked on Linux");
+  return;
+#endif
+
+  /* Keep the thread around for the second pool */
+  g_thread_pool_set_max_unused_threads (1);
+
+  pool = g_thread_pool_new (placement_task, NULL, 1, FALSE, NULL);
+  g_thread_pool_set_thread_name (pool, "first");
+  g_thread_pool_set_cpu_affinity (pool, &cpu, 1, G_THREAD_POOL_PLACEMENT_ANY);
+  g_thread_pool_push (pool, &result, NULL);
+  g_thread_pool_free (pool, FALSE, TRUE);
+  if (result.name)
+    g_assert_cmpstr (result.name, ==, "first");
+  g_free (result.name);
+
+  /* Whichever thread runs this, it must not look like the first pool's */
+  pool = g_thread_pool_new (placement_task, NULL, 1, FALSE, NULL);
+  g_thread_pool_push (pool, &result, NULL);
+  g_thread_pool_free (pool, FALSE, TRUE);
+  if (result.name)
+    g_assert_cmpstr (result.name, ==, "pool");
+  g_free (result.name);
+
+  g_thread_pool_set_max_unused_threads (2);
+}
+
+static void
+deep_task (gpointer data,
+           gpointer user_data)
+{
+  volatile gchar buffer[256 * 1024];
+
+  buffer[0] = 1;
+  buffer[sizeof buffer - 1] = buffer[0];
+  g_atomic_int_inc (&processed);
+}
+
+static void
+test_stack_size (void)
+{
+  GThreadPool *pool;
+  GError *error = NULL;
+  gint i;
+
+  processed = 0;
+
+  pool = g_thread_pool_new (deep_task, NULL, 0, TRUE, &error);
+  g_assert_no_error (error);
+  g_thread_pool_set_stack_size (pool, 1024 * 1024);
+  g_assert (g_thread_pool_set_max_threads (pool, 2, &error));
+  g_assert_no_error (error);
+
+  for (i = 0; i < 10; i++)
+    g_thread_pool_push (pool, GINT_TO_POINTER (1), NULL);
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+
+  pool = g_thread_pool_new (deep_task, NULL, 2, FALSE, &error);
+  g_assert_no_error (error);
+  g_thread_pool_set_stack_size (pool, 1024 * 1024);
+
+  for (i = 0; i < 10; i++)
+    g_thread_pool_push (pool, GINT_TO_POINTER (1), NULL);
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+
+  g_assert_cmpint (processed, ==, 20);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/thread-pool/work-stealing", test_work_stealing);
+  g_test_add_func ("/thread-pool/work-stealing/free-busy", test_work_stealing_free_busy);
+  g_test_add_func ("/thread-pool/work-stealing/recursive", test_work_stealing_recursive);
+  g_test_add_func ("/thread-pool/work-stealing/unprocessed", test_work_stealing_unprocessed);
+  g_test_add_func ("/thread-pool/work-stealing/immediate", test_work_stealing_immediate);
+  g_test_add_data_func ("/thread-pool/push-many",
+                        GINT_TO_POINTER (G_THREAD_POOL_FLAGS_NONE), test_push_many);
+  g_test_add_data_func ("/thread-pool/push-many/exclusive",
+                        GINT_TO_POINTER (G_THREAD_POOL_EXCLUSIVE), test_push_many);
+  g_test_add_data_func ("/thread-pool/push-many/work-stealing",
+                        GINT_TO_POINTER (G_THREAD_POOL_WORK_STEALING), test_push_many);
+  g_test_add_func ("/thread-pool/batch-func", test_batch_func);
+  g_test_add_func ("/thread-pool/batch-func/many-batches", test_batch_func_many_batches);
+  g_test_add_data_func ("/thread-pool/placement",
+                        GINT_TO_POINTER (G_THREAD_POOL_FLAGS_NONE), test_placement);
+  g_test_add_data_func ("/thread-pool/placement/exclusive",
+                        GINT_TO_POINTER (G_THREAD_POOL_EXCLUSIVE), test_placement);
+  g_test_add_data_func ("/thread-pool/placement/work-stealing",
+                        GINT_TO_POINTER (G_THREAD_POOL_WORK_STEALING), test_placement);
+  g_test_add_func ("/thread-pool/placement/reset", test_placement_reset);
+  g_test_add_func ("/thread-pool/placement/process-mask", test_placement_process_mask);
+  g_test_add_func ("/thread-pool/stack-size", test_stack_size);
+
+  return g_test_run ();
+}
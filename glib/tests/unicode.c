@@ -25,6 +25,8 @@
 /* We are testing some deprecated APIs here */
 #define GLIB_DISABLE_DEPRECATION_WARNINGS
 
+#include <string.h>
+
 #include "glib.h"
 
 static void
@@ -911,6 +913,51 @@ test_iso15924 (void)
 #undef PACK
 }
 
+static void
+test_normalize_to_buffer (void)
+{
+  static const struct {
+    const gchar *str;
+    GNormalizeMode mode;
+    const gchar *expected;
+  } tests[] = {
+    { "plain ascii", G_NORMALIZE_NFC, "plain ascii" },
+    { "caf\xc3\xa9", G_NORMALIZE_NFC, "caf\xc3\xa9" },
+    { "caf\xc3\xa9", G_NORMALIZE_NFD, "cafe\xcc\x81" },
+    { "cafe\xcc\x81s", G_NORMALIZE_NFC, "caf\xc3\xa9s" },
+    { "x\xc2\xb2", G_NORMALIZE_NFC, "x\xc2\xb2" },
+    { "x\xc2\xb2", G_NORMALIZE_NFKC, "x2" },
+    { "\xe1\x84\x80\xe1\x85\xa1", G_NORMALIZE_NFC, "\xea\xb0\x80" },
+  };
+  gchar buffer[32];
+  gchar *normalized;
+  gssize n;
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (tests); i++)
+    {
+      gsize expected_len = strlen (tests[i].expected);
+
+      normalized = g_utf8_normalize (tests[i].str, -1, tests[i].mode);
+      g_assert_cmpstr (normalized, ==, tests[i].expected);
+      g_free (normalized);
+
+      n = g_utf8_normalize_to_buffer (tests[i].str, -1, tests[i].mode, NULL, 0);
+      g_assert_cmpint (n, ==, expected_len);
+
+      /* not written to unless the result and its nul fit */
+      memset (buffer, 'z', sizeof buffer);
+      n = g_utf8_normalize_to_buffer (tests[i].str, -1, tests[i].mode, buffer, expected_len);
+      g_assert_cmpint (n, ==, expected_len);
+      g_assert (buffer[0] == 'z');
+
+      n = g_utf8_normalize_to_buffer (tests[i].str, strlen (tests[i].str), tests[i].mode,
+                                      buffer, expected_len + 1);
+      g_assert_cmpint (n, ==, expected_len);
+      g_assert_cmpstr (buffer, ==, tests[i].expected);
+    }
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -936,6 +983,7 @@ main (int   argc,
   g_test_add_func ("/unicode/fully-decompose-len", test_fully_decompose_len);
   g_test_add_func ("/unicode/iso15924", test_iso15924);
   g_test_add_func ("/unicode/cases", test_cases);
+  g_test_add_func ("/unicode/normalize-to-buffer", test_normalize_to_buffer);
 
   return g_test_run();
 }
@@ -342,6 +342,47 @@ test_uri_unescape (void)
   g_assert_cmpstr (g_uri_unescape_string (NULL,  NULL), ==, NULL);
 }
 
+static void
+test_uri_unescape_to_buffer (void)
+{
+  const gchar *path = "/a%2Fb%20c/d";
+  gchar buf[32];
+  gchar *s;
+  gssize len;
+
+  len = g_uri_unescape_segment_to_buffer ("%2Babc %4F", NULL, NULL, buf);
+  g_assert_cmpint (len, ==, 6);
+  g_assert_cmpstr (buf, ==, "+abc O");
+
+  /* only the given part is unescaped */
+  len = g_uri_unescape_segment_to_buffer (path + 1, strchr (path + 1, '/'), NULL, buf);
+  g_assert_cmpint (len, ==, 5);
+  g_assert_cmpstr (buf, ==, "a/b c");
+
+  len = g_uri_unescape_segment_to_buffer ("no escapes here", NULL, NULL, buf);
+  g_assert_cmpint (len, ==, 15);
+  g_assert_cmpstr (buf, ==, "no escapes here");
+
+  len = g_uri_unescape_segment_to_buffer ("", NULL, NULL, buf);
+  g_assert_cmpint (len, ==, 0);
+  g_assert_cmpstr (buf, ==, "");
+
+  /* in place */
+  s = g_strdup ("%41%42c%2e%2E%64ef%");
+  g_assert_cmpint (g_uri_unescape_segment_to_buffer (s, NULL, NULL, s), ==, -1);
+  g_free (s);
+  s = g_strdup ("%41%42c%2e%2E%64ef%25");
+  len = g_uri_unescape_segment_to_buffer (s, NULL, NULL, s);
+  g_assert_cmpint (len, ==, 9);
+  g_assert_cmpstr (s, ==, "ABc..def%");
+  g_free (s);
+
+  g_assert_cmpint (g_uri_unescape_segment_to_buffer ("a/%2F", NULL, "/", buf), ==, -1);
+  g_assert_cmpint (g_uri_unescape_segment_to_buffer ("%00abc", NULL, NULL, buf), ==, -1);
+  g_assert_cmpint (g_uri_unescape_segment_to_buffer ("abc%2", NULL, NULL, buf), ==, -1);
+  g_assert_cmpint (g_uri_unescape_segment_to_buffer ("%4Fbc%2r", NULL, NULL, buf), ==, -1);
+}
+
 static void
 test_uri_escape (void)
 {
@@ -386,6 +427,7 @@ main (int   argc,
   g_test_add_func ("/uri/roundtrip", run_roundtrip_tests);
   g_test_add_func ("/uri/list", run_uri_list_tests);
   g_test_add_func ("/uri/unescape", test_uri_unescape);
+  g_test_add_func ("/uri/unescape-to-buffer", test_uri_unescape_to_buffer);
   g_test_add_func ("/uri/escape", test_uri_escape);
   g_test_add_func ("/uri/scheme", test_uri_scheme);
 
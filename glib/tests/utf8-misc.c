@@ -151,6 +151,61 @@ test_utf8_make_valid (void)
   g_free (r);
 }
 
+/* Mixes ASCII runs of every length with other characters, so that the
+ * block-wise ASCII handling in the converters meets all alignments.
+ */
+static void
+test_utf8_to_utf16_ascii_runs (void)
+{
+  GString *string;
+  gunichar *ucs4;
+  gunichar2 *utf16;
+  glong n_ucs4, n_utf16, i, j;
+
+  string = g_string_new (NULL);
+  for (i = 0; i < 40; i++)
+    {
+      for (j = 0; j < i; j++)
+        g_string_append_c (string, 'a' + j % 26);
+      g_string_append (string, i % 2 ? "\xc3\xa9" : "\xf0\x9f\x98\x80");
+    }
+
+  ucs4 = g_utf8_to_ucs4 (string->str, -1, NULL, &n_ucs4, NULL);
+  g_assert (ucs4 != NULL);
+
+  for (i = 0; i < 2; i++)
+    {
+      glong k;
+
+      utf16 = g_utf8_to_utf16 (string->str, i ? (glong) string->len : -1,
+                               NULL, &n_utf16, NULL);
+      g_assert (utf16 != NULL);
+      g_assert_cmpint (n_utf16, ==, n_ucs4 + 20);
+
+      for (j = 0, k = 0; j < n_ucs4; j++)
+        {
+          if (ucs4[j] < 0x10000)
+            g_assert_cmpuint (utf16[k++], ==, ucs4[j]);
+          else
+            {
+              g_assert_cmpuint (utf16[k++], ==, (ucs4[j] - 0x10000) / 0x400 + 0xd800);
+              g_assert_cmpuint (utf16[k++], ==, (ucs4[j] - 0x10000) % 0x400 + 0xdc00);
+            }
+        }
+      g_assert_cmpint (k, ==, n_utf16);
+      g_assert_cmpuint (utf16[k], ==, 0);
+      g_free (utf16);
+    }
+
+  g_free (ucs4);
+
+  ucs4 = g_utf8_to_ucs4_fast (string->str, string->len, &i);
+  g_assert_cmpint (i, ==, n_ucs4);
+  g_free (ucs4);
+
+  g_string_free (string, TRUE);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -163,6 +218,7 @@ main (int   argc,
   g_test_add_func ("/utf8/reverse", test_utf8_reverse);
   g_test_add_func ("/utf8/substring", test_utf8_substring);
   g_test_add_func ("/utf8/make-valid", test_utf8_make_valid);
+  g_test_add_func ("/utf8/to-utf16/ascii-runs", test_utf8_to_utf16_ascii_runs);
 
   return g_test_run();
 }
@@ -130,6 +130,68 @@ test_find (void)
   g_assert (q == str + strlen (str) + 1);
 }
 
+static void
+check_index (GUtf8Index  *index,
+             const gchar *str)
+{
+  const gchar *p;
+  glong n_chars, i;
+  gchar *substring, *expected;
+
+  n_chars = g_utf8_strlen (str, -1);
+  g_assert_cmpint (g_utf8_index_get_length (index), ==, n_chars);
+
+  for (p = str, i = 0; i <= n_chars; p = g_utf8_next_char (p), i++)
+    {
+      g_assert (g_utf8_index_offset_to_pointer (index, i) == p);
+      g_assert_cmpint (g_utf8_index_pointer_to_offset (index, p), ==, i);
+    }
+
+  for (i = 0; i + 700 <= n_chars; i += 333)
+    {
+      substring = g_utf8_index_substring (index, i, i + 700);
+      expected = g_utf8_substring (str, i, i + 700);
+      g_assert_cmpstr (substring, ==, expected);
+      g_free (substring);
+      g_free (expected);
+    }
+}
+
+static void
+test_index (void)
+{
+  GUtf8Index *index;
+  GString *string;
+  gint i;
+
+  index = g_utf8_index_new ("", -1);
+  check_index (index, "");
+  g_utf8_index_free (index);
+
+  string = g_string_new (NULL);
+  for (i = 0; i < 3000; i++)
+    g_string_append (string, i % 7 ? "abc" : "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80");
+
+  index = g_utf8_index_new (string->str, string->len);
+  check_index (index, string->str);
+
+  /* edits reallocate the string and invalidate the end of the index */
+  g_string_insert (string, 5004, "\xe2\x82\xac\xe2\x82\xac");
+  g_utf8_index_update (index, string->str, string->len, 5004);
+  check_index (index, string->str);
+
+  g_string_erase (string, 10, 4000);
+  g_utf8_index_update (index, string->str, -1, 10);
+  check_index (index, string->str);
+
+  g_string_append (string, "xyz\xc3\xa9");
+  g_utf8_index_update (index, string->str, string->len, string->len - 5);
+  check_index (index, string->str);
+
+  g_utf8_index_free (index);
+  g_string_free (string, TRUE);
+}
+
 int main (int argc, char *argv[])
 {
   g_test_init (&argc, &argv, NULL);
@@ -137,6 +199,7 @@ int main (int argc, char *argv[])
   g_test_add_data_func ("/utf8/offsets", longline, test_utf8);
   g_test_add_func ("/utf8/lengths", test_length);
   g_test_add_func ("/utf8/find", test_find);
+  g_test_add_func ("/utf8/index", test_index);
 
   return g_test_run ();
 }
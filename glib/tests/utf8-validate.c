@@ -292,6 +292,44 @@ do_test (gconstpointer d)
     }
 }
 
+/* Checks errors and nuls at every position of a long ASCII run, which
+ * is validated in blocks rather than byte by byte.
+ */
+static void
+test_long_ascii (void)
+{
+  static const gchar *bad[] = { "\xff", "\xc3", "\xe2\x82", "\xed\xa0\x80" };
+  gchar buf[80];
+  const gchar *end;
+  gsize i, j;
+
+  memset (buf, 'a', sizeof buf);
+  g_assert (g_utf8_validate (buf, sizeof buf, &end));
+  g_assert (end == buf + sizeof buf);
+
+  for (i = 0; i < sizeof buf - 4; i++)
+    {
+      for (j = 0; j < G_N_ELEMENTS (bad); j++)
+        {
+          memset (buf, 'a', sizeof buf);
+          memcpy (buf + i, bad[j], strlen (bad[j]));
+          g_assert (!g_utf8_validate (buf, sizeof buf, &end));
+          g_assert_cmpint (end - buf, ==, i);
+        }
+
+      memset (buf, 'a', sizeof buf);
+      buf[i] = '\0';
+      g_assert (!g_utf8_validate (buf, sizeof buf, &end));
+      g_assert_cmpint (end - buf, ==, i);
+
+      memset (buf, 'a', sizeof buf);
+      memcpy (buf + i, "\xc3\xa9", 2);
+      g_assert (g_utf8_validate (buf, sizeof buf, &end));
+      g_assert (g_utf8_validate (buf, i + 1, &end) == FALSE);
+      g_assert_cmpint (end - buf, ==, i);
+    }
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -307,5 +345,7 @@ main (int argc, char *argv[])
       g_free (path);
     }
 
+  g_test_add_func ("/utf8/validate/long-ascii", test_long_ascii);
+
   return g_test_run ();
 }
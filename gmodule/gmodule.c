@@ -202,6 +202,7 @@ struct _GModule
   guint ref_count : 31;
   guint is_resident : 1;
   GModuleUnload unload;
+  GHashTable *symbols;  /* symbol name -> address, for found symbols */
   GModule *next;
 };
 
@@ -502,6 +503,7 @@ g_module_open (const gchar    *file_name,
 	      main_module->ref_count = 1;
 	      main_module->is_resident = TRUE;
 	      main_module->unload = NULL;
+	      main_module->symbols = NULL;
 	      main_module->next = NULL;
 	    }
 	}
@@ -618,6 +620,7 @@ g_module_open (const gchar    *file_name,
       module->ref_count = 1;
       module->is_resident = FALSE;
       module->unload = NULL;
+      module->symbols = NULL;
       module->next = modules;
       modules = module;
       
@@ -763,6 +766,8 @@ g_module_close (GModule *module)
       module->next = NULL;
       
       _g_module_close (module->handle, FALSE);
+      if (module->symbols)
+        g_hash_table_unref (module->symbols);
       g_free (module->file_name);
 #if defined (G_OS_WIN32) && !defined(_WIN64)
       g_free (module->cp_file_name);
@@ -830,6 +835,17 @@ g_module_symbol (GModule     *module,
   
   g_rec_mutex_lock (&g_module_global_lock);
 
+  /* Symbols that were found before are remembered, so that looking them
+   * up again doesn't go back to the dynamic linker. Failed lookups are
+   * not cached, since they need to report an error each time.
+   */
+  if (module->symbols &&
+      g_hash_table_lookup_extended (module->symbols, symbol_name, NULL, symbol))
+    {
+      g_rec_mutex_unlock (&g_module_global_lock);
+      return TRUE;
+    }
+
 #ifdef	G_MODULE_NEED_USCORE
   {
     gchar *name;
@@ -852,6 +868,12 @@ g_module_symbol (GModule     *module,
       g_free (error);
       *symbol = NULL;
     }
+  else
+    {
+      if (!module->symbols)
+        module->symbols = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+      g_hash_table_insert (module->symbols, g_strdup (symbol_name), *symbol);
+    }
   
   g_rec_mutex_unlock (&g_module_global_lock);
   return !module_error;
@@ -90,6 +90,11 @@
  * various ways of blocking a signal emission, like g_signal_stop_emission()
  * or g_signal_handler_block().
  *
+ * Since bindings run when #GObject::notify is emitted, wrapping a batch
+ * of changes to a source in g_object_freeze_notify() and
+ * g_object_thaw_notify() makes each binding propagate only once, with
+ * the final value.
+ *
  * A binding will be severed, and the resources it allocates freed, whenever
  * either one of the #GObject instances it refers to are finalized, or when
  * the #GBinding instance loses its last reference.
@@ -165,8 +170,9 @@ struct _GBinding
 
   GBindingFlags flags;
 
-  guint source_notify;
-  guint target_notify;
+  /* whether the binding is registered with the notifiers of the objects */
+  guint source_notify : 1;
+  guint target_notify : 1;
 
   gpointer transform_data;
   GDestroyNotify notify;
@@ -192,9 +198,144 @@ enum
 };
 
 static guint gobject_notify_signal_id;
+static GQuark quark_binding_notifier;
 
 G_DEFINE_TYPE (GBinding, g_binding, G_TYPE_OBJECT);
 
+/* All the bindings on an object share a single ::notify handler, which
+ * looks them up by property name; this way a notification costs one
+ * hash lookup instead of the signal machinery matching the detail of
+ * every binding connected to the object.  The bindings for a property
+ * are kept in the order they were added.
+ */
+typedef struct
+{
+  gulong      handler_id;
+  GHashTable *bindings;         /* property name quark -> GSList<GBinding> */
+} BindingNotifier;
+
+static void on_source_notify (GObject    *gobject,
+                              GParamSpec *pspec,
+                              GBinding   *binding);
+static void on_target_notify (GObject    *gobject,
+                              GParamSpec *pspec,
+                              GBinding   *binding);
+
+static void
+binding_notifier_free (gpointer data)
+{
+  BindingNotifier *notifier = data;
+
+  g_hash_table_destroy (notifier->bindings);
+  g_slice_free (BindingNotifier, notifier);
+}
+
+static void
+binding_notifier_dispatch (GObject         *gobject,
+                           GParamSpec      *pspec,
+                           BindingNotifier *notifier)
+{
+  GQuark property = g_param_spec_get_name_quark (pspec);
+  GBinding *stack_bindings[8], **bindings;
+  GSList *l;
+  guint i, n;
+
+  l = g_hash_table_lookup (notifier->bindings, GUINT_TO_POINTER (property));
+  n = g_slist_length (l);
+  if (n == 0)
+    return;
+
+  /* bindings may be added or removed, and the notifier freed, by the
+   * bindings we run, so work on a copy
+   */
+  bindings = n <= G_N_ELEMENTS (stack_bindings) ? stack_bindings : g_new (GBinding *, n);
+  for (i = 0; l != NULL; l = l->next, i++)
+    bindings[i] = g_object_ref (l->data);
+
+  for (i = 0; i < n; i++)
+    {
+      GBinding *binding = bindings[i];
+
+      /* skip the ones unbound in the meantime */
+      if (binding->source == gobject && binding->source_notify &&
+          g_param_spec_get_name_quark (binding->source_pspec) == property)
+        on_source_notify (gobject, pspec, binding);
+      else if (binding->target == gobject && binding->target_notify &&
+               g_param_spec_get_name_quark (binding->target_pspec) == property)
+        on_target_notify (gobject, pspec, binding);
+
+      g_object_unref (binding);
+    }
+
+  if (bindings != stack_bindings)
+    g_free (bindings);
+}
+
+static void
+binding_notifier_add (GObject    *gobject,
+                      GParamSpec *pspec,
+                      GBinding   *binding)
+{
+  BindingNotifier *notifier;
+  gpointer property;
+  GSList *l;
+
+  notifier = g_object_get_qdata (gobject, quark_binding_notifier);
+  if (notifier == NULL)
+    {
+      GClosure *closure;
+
+      notifier = g_slice_new (BindingNotifier);
+      notifier->bindings = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_slist_free);
+
+      closure = g_cclosure_new (G_CALLBACK (binding_notifier_dispatch), notifier, NULL);
+      notifier->handler_id = g_signal_connect_closure_by_id (gobject,
+                                                             gobject_notify_signal_id,
+                                                             0,
+                                                             closure,
+                                                             FALSE);
+
+      g_object_set_qdata_full (gobject, quark_binding_notifier, notifier, binding_notifier_free);
+    }
+
+  property = GUINT_TO_POINTER (g_param_spec_get_name_quark (pspec));
+  l = g_hash_table_lookup (notifier->bindings, property);
+  if (l == NULL)
+    g_hash_table_insert (notifier->bindings, property, g_slist_prepend (NULL, binding));
+  else
+    l = g_slist_append (l, binding);
+}
+
+static void
+binding_notifier_remove (GObject    *gobject,
+                         GParamSpec *pspec,
+                         GBinding   *binding)
+{
+  BindingNotifier *notifier;
+  gpointer property;
+  GSList *l;
+
+  notifier = g_object_get_qdata (gobject, quark_binding_notifier);
+  if (notifier == NULL)
+    return;
+
+  property = GUINT_TO_POINTER (g_param_spec_get_name_quark (pspec));
+  l = g_hash_table_lookup (notifier->bindings, property);
+  g_hash_table_steal (notifier->bindings, property);
+  l = g_slist_remove (l, binding);
+  if (l != NULL)
+    g_hash_table_insert (notifier->bindings, property, l);
+
+  if (g_hash_table_size (notifier->bindings) == 0)
+    {
+      /* the handler may already be gone if the object is being disposed */
+      if (g_signal_handler_is_connected (gobject, notifier->handler_id))
+        g_signal_handler_disconnect (gobject, notifier->handler_id);
+
+      g_object_set_qdata (gobject, quark_binding_notifier, NULL);
+    }
+}
+
 /* the basic assumption is that if either the source or the target
  * goes away then the binding does not exist any more and it should
  * be reaped as well
@@ -209,30 +350,30 @@ weak_unbind (gpointer  user_data,
    * does not try to access it; otherwise, disconnect everything and remove
    * the GBinding instance from the object's qdata
    */
+  if (binding->source_notify)
+    binding_notifier_remove (binding->source, binding->source_pspec, binding);
+  binding->source_notify = FALSE;
+
   if (binding->source == where_the_object_was)
     binding->source = NULL;
   else
     {
-      if (binding->source_notify != 0)
-        g_signal_handler_disconnect (binding->source, binding->source_notify);
-
       g_object_weak_unref (binding->source, weak_unbind, user_data);
 
-      binding->source_notify = 0;
       binding->source = NULL;
     }
 
   /* as above, but with the target */
+  if (binding->target_notify)
+    binding_notifier_remove (binding->target, binding->target_pspec, binding);
+  binding->target_notify = FALSE;
+
   if (binding->target == where_the_object_was)
     binding->target = NULL;
   else
     {
-      if (binding->target_notify != 0)
-        g_signal_handler_disconnect (binding->target, binding->target_notify);
-
       g_object_weak_unref (binding->target, weak_unbind, user_data);
 
-      binding->target_notify = 0;
       binding->target = NULL;
     }
 
@@ -313,7 +454,7 @@ on_source_notify (GObject    *gobject,
   g_value_init (&from_value, G_PARAM_SPEC_VALUE_TYPE (binding->source_pspec));
   g_value_init (&to_value, G_PARAM_SPEC_VALUE_TYPE (binding->target_pspec));
 
-  g_object_get_property (binding->source, binding->source_pspec->name, &from_value);
+  g_object_get_property_by_pspec (binding->source, binding->source_pspec, &from_value);
 
   res = binding->transform_s2t (binding,
                                 &from_value,
@@ -324,7 +465,7 @@ on_source_notify (GObject    *gobject,
       binding->is_frozen = TRUE;
 
       g_param_value_validate (binding->target_pspec, &to_value);
-      g_object_set_property (binding->target, binding->target_pspec->name, &to_value);
+      g_object_set_property_by_pspec (binding->target, binding->target_pspec, &to_value);
 
       binding->is_frozen = FALSE;
     }
@@ -348,7 +489,7 @@ on_target_notify (GObject    *gobject,
   g_value_init (&from_value, G_PARAM_SPEC_VALUE_TYPE (binding->target_pspec));
   g_value_init (&to_value, G_PARAM_SPEC_VALUE_TYPE (binding->source_pspec));
 
-  g_object_get_property (binding->target, binding->target_pspec->name, &from_value);
+  g_object_get_property_by_pspec (binding->target, binding->target_pspec, &from_value);
 
   res = binding->transform_t2s (binding,
                                 &from_value,
@@ -359,7 +500,7 @@ on_target_notify (GObject    *gobject,
       binding->is_frozen = TRUE;
 
       g_param_value_validate (binding->source_pspec, &to_value);
-      g_object_set_property (binding->source, binding->source_pspec->name, &to_value);
+      g_object_set_property_by_pspec (binding->source, binding->source_pspec, &to_value);
 
       binding->is_frozen = FALSE;
     }
@@ -385,24 +526,24 @@ g_binding_unbind_internal (GBinding *binding,
 
   if (binding->source != NULL)
     {
-      if (binding->source_notify != 0)
-        g_signal_handler_disconnect (binding->source, binding->source_notify);
+      if (binding->source_notify)
+        binding_notifier_remove (binding->source, binding->source_pspec, binding);
 
       g_object_weak_unref (binding->source, weak_unbind, binding);
 
-      binding->source_notify = 0;
+      binding->source_notify = FALSE;
       binding->source = NULL;
     }
 
   if (binding->target != NULL)
     {
-      if (binding->target_notify != 0)
-        g_signal_handler_disconnect (binding->target, binding->target_notify);
+      if (binding->target_notify)
+        binding_notifier_remove (binding->target, binding->target_pspec, binding);
 
       if (!source_is_target)
         g_object_weak_unref (binding->target, weak_unbind, binding);
 
-      binding->target_notify = 0;
+      binding->target_notify = FALSE;
       binding->target = NULL;
     }
 
@@ -497,8 +638,6 @@ g_binding_constructed (GObject *gobject)
 {
   GBinding *binding = G_BINDING (gobject);
   GBindingTransformFunc transform_func = default_transform;
-  GQuark source_property_detail;
-  GClosure *source_notify_closure;
 
   /* assert that we were constructed correctly */
   g_assert (binding->source != NULL);
@@ -526,30 +665,15 @@ g_binding_constructed (GObject *gobject)
   binding->transform_data = NULL;
   binding->notify = NULL;
 
-  source_property_detail = g_quark_from_string (binding->source_property);
-  source_notify_closure = g_cclosure_new (G_CALLBACK (on_source_notify),
-                                          binding, NULL);
-  binding->source_notify = g_signal_connect_closure_by_id (binding->source,
-                                                           gobject_notify_signal_id,
-                                                           source_property_detail,
-                                                           source_notify_closure,
-                                                           FALSE);
+  binding_notifier_add (binding->source, binding->source_pspec, binding);
+  binding->source_notify = TRUE;
 
   g_object_weak_ref (binding->source, weak_unbind, binding);
 
   if (binding->flags & G_BINDING_BIDIRECTIONAL)
     {
-      GQuark target_property_detail;
-      GClosure *target_notify_closure;
-
-      target_property_detail = g_quark_from_string (binding->target_property);
-      target_notify_closure = g_cclosure_new (G_CALLBACK (on_target_notify),
-                                              binding, NULL);
-      binding->target_notify = g_signal_connect_closure_by_id (binding->target,
-                                                               gobject_notify_signal_id,
-                                                               target_property_detail,
-                                                               target_notify_closure,
-                                                               FALSE);
+      binding_notifier_add (binding->target, binding->target_pspec, binding);
+      binding->target_notify = TRUE;
     }
 
   if (binding->target != binding->source)
@@ -564,6 +688,8 @@ g_binding_class_init (GBindingClass *klass)
   gobject_notify_signal_id = g_signal_lookup ("notify", G_TYPE_OBJECT);
   g_assert (gobject_notify_signal_id != 0);
 
+  quark_binding_notifier = g_quark_from_static_string ("g-binding-notifier");
+
   gobject_class->constructed = g_binding_constructed;
   gobject_class->set_property = g_binding_set_property;
   gobject_class->get_property = g_binding_get_property;
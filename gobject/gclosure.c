@@ -1394,6 +1394,55 @@ va_to_ffi_type (GType gtype,
   return rettype;
 }
 
+/* Take ownership of a pointer argument collected from a va_list for the
+ * duration of the call, the same way g_signal_emit() does for GValues.
+ * Only scalar-looking storage is touched, so this is a no-op for
+ * non-pointer fundamentals.
+ */
+static void
+va_arg_box (GType     param_type,
+            gpointer *arg)
+{
+  GType type = param_type & ~G_SIGNAL_TYPE_STATIC_SCOPE;
+  GType fundamental = G_TYPE_FUNDAMENTAL (type);
+
+  if ((param_type & G_SIGNAL_TYPE_STATIC_SCOPE) == 0)
+    {
+      if (fundamental == G_TYPE_STRING && *arg != NULL)
+        *arg = g_strdup (*arg);
+      else if (fundamental == G_TYPE_PARAM && *arg != NULL)
+        *arg = g_param_spec_ref (*arg);
+      else if (fundamental == G_TYPE_BOXED && *arg != NULL)
+        *arg = g_boxed_copy (type, *arg);
+      else if (fundamental == G_TYPE_VARIANT && *arg != NULL)
+        *arg = g_variant_ref_sink (*arg);
+    }
+  if (fundamental == G_TYPE_OBJECT && *arg != NULL)
+    *arg = g_object_ref (*arg);
+}
+
+static void
+va_arg_unbox (GType    param_type,
+              gpointer arg)
+{
+  GType type = param_type & ~G_SIGNAL_TYPE_STATIC_SCOPE;
+  GType fundamental = G_TYPE_FUNDAMENTAL (type);
+
+  if ((param_type & G_SIGNAL_TYPE_STATIC_SCOPE) == 0)
+    {
+      if (fundamental == G_TYPE_STRING && arg != NULL)
+        g_free (arg);
+      else if (fundamental == G_TYPE_PARAM && arg != NULL)
+        g_param_spec_unref (arg);
+      else if (fundamental == G_TYPE_BOXED && arg != NULL)
+        g_boxed_free (type, arg);
+      else if (fundamental == G_TYPE_VARIANT && arg != NULL)
+        g_variant_unref (arg);
+    }
+  if (fundamental == G_TYPE_OBJECT && arg != NULL)
+    g_object_unref (arg);
+}
+
 /**
  * g_cclosure_marshal_generic:
  * @closure: A #GClosure.
@@ -1574,26 +1623,13 @@ g_cclosure_marshal_generic_va (GClosure *closure,
   for (i = 0; i < n_params; i++)
     {
       GType type = param_types[i]  & ~G_SIGNAL_TYPE_STATIC_SCOPE;
-      GType fundamental = G_TYPE_FUNDAMENTAL (type);
 
       atypes[i+1] = va_to_ffi_type (type,
 				    &args_copy,
 				    &storage[i]);
       args[i+1] = &storage[i];
 
-      if ((param_types[i]  & G_SIGNAL_TYPE_STATIC_SCOPE) == 0)
-	{
-	  if (fundamental == G_TYPE_STRING && storage[i]._gpointer != NULL)
-	    storage[i]._gpointer = g_strdup (storage[i]._gpointer);
-	  else if (fundamental == G_TYPE_PARAM && storage[i]._gpointer != NULL)
-	    storage[i]._gpointer = g_param_spec_ref (storage[i]._gpointer);
-	  else if (fundamental == G_TYPE_BOXED && storage[i]._gpointer != NULL)
-	    storage[i]._gpointer = g_boxed_copy (type, storage[i]._gpointer);
-	  else if (fundamental == G_TYPE_VARIANT && storage[i]._gpointer != NULL)
-	    storage[i]._gpointer = g_variant_ref_sink (storage[i]._gpointer);
-	}
-      if (fundamental == G_TYPE_OBJECT && storage[i]._gpointer != NULL)
-	storage[i]._gpointer = g_object_ref (storage[i]._gpointer);
+      va_arg_box (param_types[i], &storage[i]._gpointer);
     }
 
   va_end (args_copy);
@@ -1605,27 +1641,211 @@ g_cclosure_marshal_generic_va (GClosure *closure,
 
   /* Unbox non-primitive arguments */
   for (i = 0; i < n_params; i++)
+    va_arg_unbox (param_types[i], storage[i]._gpointer);
+  
+  if (return_value && G_VALUE_TYPE (return_value))
+    value_from_ffi_type (return_value, rvalue);
+}
+
+/* Most signals only take arguments that are either pointers or get
+ * promoted to int when passed through varargs, and return nothing or a
+ * plain int.  For those there are only two ways to pass each argument,
+ * so a small table of casted calls covers every such signature without
+ * going through libffi.
+ */
+#define DIRECT_VA_MAX_PARAMS 3
+
+typedef union
+{
+  gint     v_int;
+  gpointer v_pointer;
+} DirectVaArg;
+
+#define DIRECT_VA_TYPE_I gint
+#define DIRECT_VA_TYPE_P gpointer
+#define DIRECT_VA_ARG_I(n) args[n].v_int
+#define DIRECT_VA_ARG_P(n) args[n].v_pointer
+
+#define DIRECT_VA_CALL0(R) \
+  ((R (*) (gpointer, gpointer)) callback) (data1, data2)
+#define DIRECT_VA_CALL1(R, a) \
+  ((R (*) (gpointer, DIRECT_VA_TYPE_##a, gpointer)) callback) \
+    (data1, DIRECT_VA_ARG_##a (0), data2)
+#define DIRECT_VA_CALL2(R, a, b) \
+  ((R (*) (gpointer, DIRECT_VA_TYPE_##a, DIRECT_VA_TYPE_##b, gpointer)) callback) \
+    (data1, DIRECT_VA_ARG_##a (0), DIRECT_VA_ARG_##b (1), data2)
+#define DIRECT_VA_CALL3(R, a, b, c) \
+  ((R (*) (gpointer, DIRECT_VA_TYPE_##a, DIRECT_VA_TYPE_##b, DIRECT_VA_TYPE_##c, gpointer)) callback) \
+    (data1, DIRECT_VA_ARG_##a (0), DIRECT_VA_ARG_##b (1), DIRECT_VA_ARG_##c (2), data2)
+
+/* The switch key is the number of arguments in the upper bits and one
+ * bit per argument, set for pointers, in the lower ones.
+ */
+#define DIRECT_VA_DISPATCH(R, assign) \
+  switch ((n_params << DIRECT_VA_MAX_PARAMS) | pointer_mask) \
+    { \
+    case 0x00: assign DIRECT_VA_CALL0 (R); break; \
+    case 0x08: assign DIRECT_VA_CALL1 (R, I); break; \
+    case 0x09: assign DIRECT_VA_CALL1 (R, P); break; \
+    case 0x10: assign DIRECT_VA_CALL2 (R, I, I); break; \
+    case 0x11: assign DIRECT_VA_CALL2 (R, P, I); break; \
+    case 0x12: assign DIRECT_VA_CALL2 (R, I, P); break; \
+    case 0x13: assign DIRECT_VA_CALL2 (R, P, P); break; \
+    case 0x18: assign DIRECT_VA_CALL3 (R, I, I, I); break; \
+    case 0x19: assign DIRECT_VA_CALL3 (R, P, I, I); break; \
+    case 0x1a: assign DIRECT_VA_CALL3 (R, I, P, I); break; \
+    case 0x1b: assign DIRECT_VA_CALL3 (R, P, P, I); break; \
+    case 0x1c: assign DIRECT_VA_CALL3 (R, I, I, P); break; \
+    case 0x1d: assign DIRECT_VA_CALL3 (R, P, I, P); break; \
+    case 0x1e: assign DIRECT_VA_CALL3 (R, I, P, P); break; \
+    case 0x1f: assign DIRECT_VA_CALL3 (R, P, P, P); break; \
+    default: g_assert_not_reached (); \
+    }
+
+typedef enum
+{
+  DIRECT_VA_CLASS_NONE,
+  DIRECT_VA_CLASS_INT,
+  DIRECT_VA_CLASS_POINTER
+} DirectVaClass;
+
+static DirectVaClass
+direct_va_classify (GType type)
+{
+  switch (G_TYPE_FUNDAMENTAL (type & ~G_SIGNAL_TYPE_STATIC_SCOPE))
     {
-      GType type = param_types[i]  & ~G_SIGNAL_TYPE_STATIC_SCOPE;
-      GType fundamental = G_TYPE_FUNDAMENTAL (type);
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_UCHAR:
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_ENUM:
+    case G_TYPE_FLAGS:
+      return DIRECT_VA_CLASS_INT;
+    case G_TYPE_STRING:
+    case G_TYPE_OBJECT:
+    case G_TYPE_BOXED:
+    case G_TYPE_PARAM:
+    case G_TYPE_POINTER:
+    case G_TYPE_INTERFACE:
+    case G_TYPE_VARIANT:
+      return DIRECT_VA_CLASS_POINTER;
+    default:
+      return DIRECT_VA_CLASS_NONE;
+    }
+}
 
-      if ((param_types[i]  & G_SIGNAL_TYPE_STATIC_SCOPE) == 0)
-	{
-	  if (fundamental == G_TYPE_STRING && storage[i]._gpointer != NULL)
-	    g_free (storage[i]._gpointer);
-	  else if (fundamental == G_TYPE_PARAM && storage[i]._gpointer != NULL)
-	    g_param_spec_unref (storage[i]._gpointer);
-	  else if (fundamental == G_TYPE_BOXED && storage[i]._gpointer != NULL)
-	    g_boxed_free (type, storage[i]._gpointer);
-	  else if (fundamental == G_TYPE_VARIANT && storage[i]._gpointer != NULL)
-	    g_variant_unref (storage[i]._gpointer);
-	}
-      if (fundamental == G_TYPE_OBJECT && storage[i]._gpointer != NULL)
-	g_object_unref (storage[i]._gpointer);
+static void
+g_cclosure_marshal_direct_va (GClosure *closure,
+                              GValue   *return_value,
+                              gpointer  instance,
+                              va_list   args_list,
+                              gpointer  marshal_data,
+                              int       n_params,
+                              GType    *param_types)
+{
+  GCClosure *cc = (GCClosure *) closure;
+  DirectVaArg args[DIRECT_VA_MAX_PARAMS];
+  gpointer data1, data2, callback;
+  guint pointer_mask = 0;
+  gint v_return;
+  va_list args_copy;
+  int i;
+
+  G_VA_COPY (args_copy, args_list);
+  for (i = 0; i < n_params; i++)
+    {
+      if (direct_va_classify (param_types[i]) == DIRECT_VA_CLASS_INT)
+        args[i].v_int = va_arg (args_copy, gint);
+      else
+        {
+          args[i].v_pointer = va_arg (args_copy, gpointer);
+          va_arg_box (param_types[i], &args[i].v_pointer);
+          pointer_mask |= 1 << i;
+        }
     }
-  
+  va_end (args_copy);
+
+  if (G_CCLOSURE_SWAP_DATA (closure))
+    {
+      data1 = closure->data;
+      data2 = instance;
+    }
+  else
+    {
+      data1 = instance;
+      data2 = closure->data;
+    }
+  callback = marshal_data ? marshal_data : cc->callback;
+
   if (return_value && G_VALUE_TYPE (return_value))
-    value_from_ffi_type (return_value, rvalue);
+    {
+      DIRECT_VA_DISPATCH (gint, v_return =)
+
+      switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (return_value)))
+        {
+        case G_TYPE_BOOLEAN:
+          g_value_set_boolean (return_value, v_return);
+          break;
+        case G_TYPE_INT:
+          g_value_set_int (return_value, v_return);
+          break;
+        case G_TYPE_UINT:
+          g_value_set_uint (return_value, v_return);
+          break;
+        case G_TYPE_ENUM:
+          g_value_set_enum (return_value, v_return);
+          break;
+        case G_TYPE_FLAGS:
+          g_value_set_flags (return_value, v_return);
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+    }
+  else
+    {
+      DIRECT_VA_DISPATCH (void, )
+    }
+
+  for (i = 0; i < n_params; i++)
+    if (pointer_mask & (1 << i))
+      va_arg_unbox (param_types[i], args[i].v_pointer);
+}
+
+/* Returns the libffi-free va marshaller if it can handle a signal with
+ * the given signature, %NULL otherwise.  Only int-sized scalars are
+ * accepted as return values; smaller ones are not guaranteed to be
+ * widened by the callee.
+ */
+GVaClosureMarshal
+_g_cclosure_get_direct_va_marshaller (GType        return_type,
+                                      guint        n_params,
+                                      const GType *param_types)
+{
+  guint i;
+
+  if (n_params > DIRECT_VA_MAX_PARAMS)
+    return NULL;
+
+  switch (G_TYPE_FUNDAMENTAL (return_type & ~G_SIGNAL_TYPE_STATIC_SCOPE))
+    {
+    case G_TYPE_NONE:
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_ENUM:
+    case G_TYPE_FLAGS:
+      break;
+    default:
+      return NULL;
+    }
+
+  for (i = 0; i < n_params; i++)
+    if (direct_va_classify (param_types[i]) == DIRECT_VA_CLASS_NONE)
+      return NULL;
+
+  return g_cclosure_marshal_direct_va;
 }
 
 /**
@@ -83,6 +83,9 @@ static gchar*	value_flags_enum_lcopy_value	(const GValue	*value,
 						 GTypeCValue    *collect_values,
 						 guint           collect_flags);
 
+/* --- variables --- */
+static GQuark quark_value_index = 0;
+
 /* --- functions --- */
 void
 _g_enum_types_init (void)
@@ -131,6 +134,8 @@ _g_enum_types_init (void)
   type = g_type_register_fundamental (G_TYPE_FLAGS, g_intern_static_string ("GFlags"), &info, &finfo,
 				      G_TYPE_FLAG_ABSTRACT | G_TYPE_FLAG_VALUE_ABSTRACT);
   g_assert (type == G_TYPE_FLAGS);
+
+  quark_value_index = g_quark_from_static_string ("GEnumValueIndex");
 }
 
 static void
@@ -383,6 +388,97 @@ g_flags_class_init (GFlagsClass *class,
     }
 }
 
+/* --- name and nick index --- */
+
+/* Looking values up by name or nick is a linear scan, which is fine for
+ * most enumerations. For big ones, a hash table index of the names and
+ * nicks is built the first time it's needed, and attached to the type.
+ *
+ * GEnumValue and GFlagsValue have the same layout, so the same code
+ * handles both.
+ */
+#define VALUE_INDEX_MIN_VALUES 16
+
+typedef struct
+{
+  gconstpointer  values;  /* the array the index was built from */
+  GHashTable    *names;
+  GHashTable    *nicks;
+} ValueIndex;
+
+G_STATIC_ASSERT (G_STRUCT_OFFSET (GEnumValue, value_name) == G_STRUCT_OFFSET (GFlagsValue, value_name));
+G_STATIC_ASSERT (G_STRUCT_OFFSET (GEnumValue, value_nick) == G_STRUCT_OFFSET (GFlagsValue, value_nick));
+G_STATIC_ASSERT (sizeof (GEnumValue) == sizeof (GFlagsValue));
+
+static GMutex value_index_lock;
+
+static ValueIndex *
+value_index_new (const GEnumValue *values,
+                 gboolean          nicks_end_at_null)
+{
+  const GEnumValue *value;
+  ValueIndex *index;
+
+  index = g_new (ValueIndex, 1);
+  index->values = values;
+  index->names = g_hash_table_new (g_str_hash, g_str_equal);
+  index->nicks = g_hash_table_new (g_str_hash, g_str_equal);
+
+  /* Match the linear scans: the first of any duplicates wins */
+  for (value = values; value->value_name; value++)
+    if (!g_hash_table_contains (index->names, value->value_name))
+      g_hash_table_insert (index->names, (gpointer) value->value_name, (gpointer) value);
+
+  for (value = values; value->value_name; value++)
+    {
+      if (!value->value_nick)
+        {
+          if (nicks_end_at_null)
+            break;
+          continue;
+        }
+      if (!g_hash_table_contains (index->nicks, value->value_nick))
+        g_hash_table_insert (index->nicks, (gpointer) value->value_nick, (gpointer) value);
+    }
+
+  return index;
+}
+
+/* Returns the index for a class, or %NULL if it's too small to need one */
+static ValueIndex *
+get_value_index (GType             type,
+                 const GEnumValue *values,
+                 guint             n_values,
+                 gboolean          nicks_end_at_null)
+{
+  ValueIndex *index;
+
+  if (n_values < VALUE_INDEX_MIN_VALUES)
+    return NULL;
+
+  index = g_type_get_qdata (type, quark_value_index);
+  if (index != NULL && index->values == values)
+    return index;
+
+  g_mutex_lock (&value_index_lock);
+
+  index = g_type_get_qdata (type, quark_value_index);
+
+  /* The class of a dynamic type may have been reloaded with a new
+   * value array. Other threads may still be using the old index, so
+   * it is leaked rather than freed; this is rare.
+   */
+  if (index == NULL || index->values != values)
+    {
+      index = value_index_new (values, nicks_end_at_null);
+      g_type_set_qdata (type, quark_value_index, index);
+    }
+
+  g_mutex_unlock (&value_index_lock);
+
+  return index;
+}
+
 /**
  * g_enum_get_value_by_name:
  * @enum_class: a #GEnumClass
@@ -398,9 +494,16 @@ GEnumValue*
 g_enum_get_value_by_name (GEnumClass  *enum_class,
 			  const gchar *name)
 {
+  ValueIndex *index;
+
   g_return_val_if_fail (G_IS_ENUM_CLASS (enum_class), NULL);
   g_return_val_if_fail (name != NULL, NULL);
-  
+
+  index = get_value_index (G_ENUM_CLASS_TYPE (enum_class), enum_class->values,
+                           enum_class->n_values, FALSE);
+  if (index)
+    return g_hash_table_lookup (index->names, name);
+
   if (enum_class->n_values)
     {
       GEnumValue *enum_value;
@@ -427,9 +530,17 @@ GFlagsValue*
 g_flags_get_value_by_name (GFlagsClass *flags_class,
 			   const gchar *name)
 {
+  ValueIndex *index;
+
   g_return_val_if_fail (G_IS_FLAGS_CLASS (flags_class), NULL);
   g_return_val_if_fail (name != NULL, NULL);
-  
+
+  index = get_value_index (G_FLAGS_CLASS_TYPE (flags_class),
+                           (const GEnumValue *) flags_class->values,
+                           flags_class->n_values, TRUE);
+  if (index)
+    return g_hash_table_lookup (index->names, name);
+
   if (flags_class->n_values)
     {
       GFlagsValue *flags_value;
@@ -457,9 +568,16 @@ GEnumValue*
 g_enum_get_value_by_nick (GEnumClass  *enum_class,
 			  const gchar *nick)
 {
+  ValueIndex *index;
+
   g_return_val_if_fail (G_IS_ENUM_CLASS (enum_class), NULL);
   g_return_val_if_fail (nick != NULL, NULL);
-  
+
+  index = get_value_index (G_ENUM_CLASS_TYPE (enum_class), enum_class->values,
+                           enum_class->n_values, FALSE);
+  if (index)
+    return g_hash_table_lookup (index->nicks, nick);
+
   if (enum_class->n_values)
     {
       GEnumValue *enum_value;
@@ -486,9 +604,17 @@ GFlagsValue*
 g_flags_get_value_by_nick (GFlagsClass *flags_class,
 			   const gchar *nick)
 {
+  ValueIndex *index;
+
   g_return_val_if_fail (G_IS_FLAGS_CLASS (flags_class), NULL);
   g_return_val_if_fail (nick != NULL, NULL);
-  
+
+  index = get_value_index (G_FLAGS_CLASS_TYPE (flags_class),
+                           (const GEnumValue *) flags_class->values,
+                           flags_class->n_values, TRUE);
+  if (index)
+    return g_hash_table_lookup (index->nicks, nick);
+
   if (flags_class->n_values)
     {
       GFlagsValue *flags_value;
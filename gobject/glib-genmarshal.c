@@ -131,6 +131,7 @@ static gboolean		 gen_cheader = FALSE;
 static gboolean		 gen_cbody = FALSE;
 static gboolean          gen_internal = FALSE;
 static gboolean		 gen_valist = FALSE;
+static gboolean		 report_generic = FALSE;
 static gboolean		 skip_ploc = FALSE;
 static gboolean		 std_includes = TRUE;
 static gint              exit_status = 0;
@@ -644,6 +645,63 @@ generate_marshal (const gchar *signame,
     }
 }
 
+static gboolean
+keyword_in_list (const gchar        *keyword,
+                 const gchar * const *list)
+{
+  for (; *list; list++)
+    if (strcmp (keyword, *list) == 0)
+      return TRUE;
+
+  return FALSE;
+}
+
+/* Whether g_signal_new() picks a marshaller for this signature on its
+ * own that does not go through libffi, when given a %NULL marshaller.
+ * This has to be kept in sync with g_signal_newv() and gclosure.c.
+ */
+static gboolean
+signature_has_direct_marshaller (Signature *sig)
+{
+  static const gchar * const direct_returns[] = {
+    "VOID", "BOOLEAN", "INT", "UINT", "ENUM", "FLAGS", NULL
+  };
+  static const gchar * const direct_args[] = {
+    "BOOLEAN", "CHAR", "UCHAR", "INT", "UINT", "ENUM", "FLAGS",
+    "STRING", "PARAM", "BOXED", "POINTER", "OBJECT", "VARIANT", NULL
+  };
+  static const gchar * const builtin_void_args[] = {
+    "LONG", "ULONG", "FLOAT", "DOUBLE", NULL
+  };
+  guint n_args = 0;
+  gboolean direct = TRUE;
+  GList *node;
+
+  for (node = sig->args; node; node = node->next)
+    {
+      InArgument *iarg = node->data;
+
+      if (!iarg->getter)
+        continue;
+
+      n_args++;
+      if (!keyword_in_list (iarg->sig_name, direct_args))
+        direct = FALSE;
+    }
+
+  /* the built-in VOID:<type> marshallers only miss out on 64 bit ints */
+  if (n_args == 1 && strcmp (sig->rarg->sig_name, "VOID") == 0)
+    {
+      InArgument *iarg = sig->args->data;
+
+      if (keyword_in_list (iarg->sig_name, builtin_void_args))
+        return TRUE;
+    }
+
+  return direct && n_args <= 3 &&
+    keyword_in_list (sig->rarg->sig_name, direct_returns);
+}
+
 static void
 process_signature (Signature *sig)
 {
@@ -685,6 +743,20 @@ process_signature (Signature *sig)
       g_free (tmp);
     }
 
+  if (report_generic && !signature_has_direct_marshaller (sig))
+    {
+      GString *str = g_string_new (sig->rarg->keyword);
+
+      for (node = sig->args; node; node = node->next)
+        {
+          InArgument *iarg = node->data;
+
+          g_string_append_printf (str, "%c%s", node->prev ? ',' : ':', iarg->keyword);
+        }
+      g_printerr ("%s: %s would use the generic libffi marshaller\n", sig->ploc, str->str);
+      g_string_free (str, TRUE);
+    }
+
   /* introductionary comment */
   g_fprintf (fout, "\n/* %s", sig->rarg->keyword);
   for (node = sig->args; node; node = node->next)
@@ -1017,6 +1089,11 @@ parse_args (gint    *argc_p,
 	  gen_valist = TRUE;
 	  argv[i] = NULL;
 	}
+      else if (strcmp ("--report-generic", argv[i]) == 0)
+	{
+	  report_generic = TRUE;
+	  argv[i] = NULL;
+	}
       else if ((strcmp ("--prefix", argv[i]) == 0) ||
 	       (strncmp ("--prefix=", argv[i], 9) == 0))
 	{
@@ -1122,6 +1199,7 @@ print_blurb (FILE    *bout,
       g_fprintf (bout, "  --stdinc, --nostdinc       Include/use standard marshallers\n");
       g_fprintf (bout, "  --internal                 Mark generated functions as internal\n");
       g_fprintf (bout, "  --valist-marshallers       Generate va_list marshallers\n");
+      g_fprintf (bout, "  --report-generic           Report signatures that need libffi by default\n");
       g_fprintf (bout, "  -v, --version              Print version informations\n");
       g_fprintf (bout, "  --g-fatal-warnings         Make warnings fatal (abort)\n");
     }
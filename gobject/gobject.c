@@ -122,6 +122,8 @@
     ((class)->constructor != g_object_constructor)
 #define CLASS_HAS_CUSTOM_CONSTRUCTED(class) \
     ((class)->constructed != g_object_constructed)
+#define CLASS_HAS_CUSTOM_DISPATCH(class) \
+    ((class)->dispatch_properties_changed != g_object_dispatch_properties_changed)
 
 #define CLASS_HAS_DERIVED_CLASS_FLAG 0x2
 #define CLASS_HAS_DERIVED_CLASS(class) \
@@ -152,6 +154,7 @@ static GObject*	g_object_constructor			(GType                  type,
 static void     g_object_constructed                    (GObject        *object);
 static void	g_object_real_dispose			(GObject	*object);
 static void	g_object_finalize			(GObject	*object);
+static void	weak_refs_notify			(GObject	*object);
 static void	g_object_do_set_property		(GObject        *object,
 							 guint           property_id,
 							 const GValue   *value,
@@ -187,38 +190,146 @@ static void object_interface_check_properties           (gpointer        check_d
 /* --- typedefs --- */
 typedef struct _GObjectNotifyQueue            GObjectNotifyQueue;
 
+/* @pspecs holds the queued notifications in the order they were added,
+ * using @pspecs_mem until that is full.  @filter has one bit set per
+ * queued pspec (by address), so most duplicate checks don't need to
+ * scan @pspecs.
+ */
+#define NOTIFY_QUEUE_PREALLOC 8
+
 struct _GObjectNotifyQueue
 {
-  GSList  *pspecs;
-  guint16  n_pspecs;
-  guint16  freeze_count;
+  GParamSpec **pspecs;
+  guint64      filter;
+  guint16      n_pspecs;
+  guint16      n_allocated;
+  guint16      freeze_count;
+  GParamSpec  *pspecs_mem[NOTIFY_QUEUE_PREALLOC];
 };
 
+typedef struct {
+  GObject *object;
+  guint n_weak_refs;
+  struct {
+    GWeakNotify notify;
+    gpointer    data;
+  } weak_refs[1];  /* flexible array */
+} WeakRefStack;
+
+typedef struct {
+  GObject *object;
+  guint n_toggle_refs;
+  struct {
+    GToggleNotify notify;
+    gpointer    data;
+  } toggle_refs[1];  /* flexible array */
+} ToggleRefStack;
+
+/* Instance private data of GObject itself, holding the object's own
+ * bookkeeping that is touched on every construction and property change
+ * and would otherwise be looked up in the object's qdata each time.
+ */
+typedef struct
+{
+  WeakRefStack   *weak_refs;        /* protected by the shard mutex */
+  ToggleRefStack *toggle_refs;      /* protected by the shard mutex */
+  GSList         *weak_locations;   /* of GWeakRef*, protected by the
+                                     * shard weak_locations_lock */
+} ObjectRefs;
+
+typedef struct
+{
+  GObjectNotifyQueue *notify_queue;     /* protected by notify_lock */
+  gboolean            in_construction;
+  ObjectRefs         *refs;             /* allocated on first use */
+} GObjectPrivate;
+
+/* The weak and toggle reference state in ObjectRefs is protected by one of a
+ * fixed set of locks picked by the object's address instead of by
+ * global locks, so that threads working on unrelated objects don't
+ * contend.  Since the locks don't live in the object itself,
+ * g_weak_ref_get() can take one before knowing whether the object is
+ * still alive: an object can't be freed while a GWeakRef pointing to it
+ * is read under its shard's weak_locations_lock.
+ */
+typedef struct
+{
+  GMutex  mutex;
+  GRWLock weak_locations_lock;
+} ObjectRefsShard;
+
+#define OBJECT_REFS_SHARD_COUNT 32
+
+/* Per-class cache of recently resolved properties, so that the property
+ * APIs don't have to take the pspec pool lock and walk the type ancestry
+ * on every call.  @pspecs is indexed by name hash, @handles by the
+ * address of the pspec passed to the *_by_pspec() functions.  Slots only
+ * ever hold the pspec the class resolves that name to, which lives at
+ * least as long as the class itself; a slot is a hit if it matches the
+ * key, so racing writers can only cause misses.
+ */
+#define PROPERTY_CACHE_SIZE 32
+
+typedef struct
+{
+  GParamSpec *pspecs[PROPERTY_CACHE_SIZE];
+  GParamSpec *handles[PROPERTY_CACHE_SIZE];
+} PropertyCache;
+
 /* --- variables --- */
 G_LOCK_DEFINE_STATIC (closure_array_mutex);
-G_LOCK_DEFINE_STATIC (weak_refs_mutex);
-G_LOCK_DEFINE_STATIC (toggle_refs_mutex);
 static GQuark	            quark_closure_array = 0;
-static GQuark	            quark_weak_refs = 0;
-static GQuark	            quark_toggle_refs = 0;
-static GQuark               quark_notify_queue;
-static GQuark               quark_in_construction;
+static ObjectRefsShard      object_refs_shards[OBJECT_REFS_SHARD_COUNT];
+static gint                 GObject_private_offset;
+static GQuark               quark_property_cache;
 static GParamSpecPool      *pspec_pool = NULL;
 static gulong	            gobject_signals[LAST_SIGNAL] = { 0, };
 static guint (*floating_flag_handler) (GObject*, gint) = object_floating_flag_handler;
-/* qdata pointing to GSList<GWeakRef *>, protected by weak_locations_lock */
-static GQuark	            quark_weak_locations = 0;
-static GRWLock              weak_locations_lock;
 
 G_LOCK_DEFINE_STATIC(notify_lock);
 
 /* --- functions --- */
-static void
-g_object_notify_queue_free (gpointer data)
+static inline GObjectPrivate *
+g_object_get_instance_private (GObject *object)
 {
-  GObjectNotifyQueue *nqueue = data;
+  return G_STRUCT_MEMBER_P (object, GObject_private_offset);
+}
 
-  g_slist_free (nqueue->pspecs);
+static ObjectRefs *
+object_get_refs (GObject  *object,
+                 gboolean  create)
+{
+  GObjectPrivate *priv = g_object_get_instance_private (object);
+  ObjectRefs *refs = g_atomic_pointer_get (&priv->refs);
+
+  if (refs == NULL && create)
+    {
+      refs = g_new0 (ObjectRefs, 1);
+      if (!g_atomic_pointer_compare_and_exchange (&priv->refs, NULL, refs))
+        {
+          g_free (refs);
+          refs = g_atomic_pointer_get (&priv->refs);
+        }
+    }
+
+  return refs;
+}
+
+static inline ObjectRefsShard *
+object_refs_shard (gconstpointer object)
+{
+  gsize h = GPOINTER_TO_SIZE (object);
+
+  h ^= h >> 12;
+
+  return &object_refs_shards[(h >> 4) % OBJECT_REFS_SHARD_COUNT];
+}
+
+static void
+g_object_notify_queue_free (GObjectNotifyQueue *nqueue)
+{
+  if (nqueue->pspecs != nqueue->pspecs_mem)
+    g_free (nqueue->pspecs);
   g_slice_free (GObjectNotifyQueue, nqueue);
 }
 
@@ -229,7 +340,7 @@ g_object_notify_queue_freeze (GObject  *object,
   GObjectNotifyQueue *nqueue;
 
   G_LOCK(notify_lock);
-  nqueue = g_datalist_id_get_data (&object->qdata, quark_notify_queue);
+  nqueue = g_object_get_instance_private (object)->notify_queue;
   if (!nqueue)
     {
       if (conditional)
@@ -239,8 +350,9 @@ g_object_notify_queue_freeze (GObject  *object,
         }
 
       nqueue = g_slice_new0 (GObjectNotifyQueue);
-      g_datalist_id_set_data_full (&object->qdata, quark_notify_queue,
-                                   nqueue, g_object_notify_queue_free);
+      nqueue->pspecs = nqueue->pspecs_mem;
+      nqueue->n_allocated = NOTIFY_QUEUE_PREALLOC;
+      g_object_get_instance_private (object)->notify_queue = nqueue;
     }
 
   if (nqueue->freeze_count >= 65535)
@@ -260,8 +372,7 @@ g_object_notify_queue_thaw (GObject            *object,
                             GObjectNotifyQueue *nqueue)
 {
   GParamSpec *pspecs_mem[16], **pspecs, **free_me = NULL;
-  GSList *slist;
-  guint n_pspecs = 0;
+  guint n_pspecs = 0, i;
 
   g_return_if_fail (nqueue->freeze_count > 0);
   g_return_if_fail (g_atomic_int_get(&object->ref_count) > 0);
@@ -284,11 +395,11 @@ g_object_notify_queue_thaw (GObject            *object,
 
   pspecs = nqueue->n_pspecs > 16 ? free_me = g_new (GParamSpec*, nqueue->n_pspecs) : pspecs_mem;
 
-  for (slist = nqueue->pspecs; slist; slist = slist->next)
-    {
-      pspecs[n_pspecs++] = slist->data;
-    }
-  g_datalist_id_set_data (&object->qdata, quark_notify_queue, NULL);
+  /* notifications are dispatched in reverse order */
+  for (i = nqueue->n_pspecs; i > 0; i--)
+    pspecs[n_pspecs++] = nqueue->pspecs[i - 1];
+  g_object_get_instance_private (object)->notify_queue = NULL;
+  g_object_notify_queue_free (nqueue);
 
   G_UNLOCK(notify_lock);
 
@@ -297,24 +408,83 @@ g_object_notify_queue_thaw (GObject            *object,
   g_free (free_me);
 }
 
+/* Drops the notifications queued so far, if @nqueue is only frozen once
+ * (by the caller) so nobody else is waiting for them.
+ */
+static void
+g_object_notify_queue_clear (GObject            *object,
+                             GObjectNotifyQueue *nqueue)
+{
+  G_LOCK(notify_lock);
+
+  if (nqueue->freeze_count == 1)
+    {
+      nqueue->n_pspecs = 0;
+      nqueue->filter = 0;
+    }
+
+  G_UNLOCK(notify_lock);
+}
+
 static void
 g_object_notify_queue_add (GObject            *object,
                            GObjectNotifyQueue *nqueue,
                            GParamSpec         *pspec)
 {
+  guint64 bit;
+
+  /* nobody is interested, see object_freeze_for_set() */
+  if (nqueue == NULL)
+    return;
+
+  bit = G_GUINT64_CONSTANT (1) << ((GPOINTER_TO_SIZE (pspec) * 2654435761u) >> 26 & 63);
+
   G_LOCK(notify_lock);
 
   g_assert (nqueue->n_pspecs < 65535);
 
-  if (g_slist_find (nqueue->pspecs, pspec) == NULL)
+  if (nqueue->filter & bit)
+    {
+      guint i;
+
+      for (i = 0; i < nqueue->n_pspecs; i++)
+        if (nqueue->pspecs[i] == pspec)
+          {
+            G_UNLOCK(notify_lock);
+            return;
+          }
+    }
+
+  if (nqueue->n_pspecs == nqueue->n_allocated)
     {
-      nqueue->pspecs = g_slist_prepend (nqueue->pspecs, pspec);
-      nqueue->n_pspecs++;
+      nqueue->n_allocated = MIN (nqueue->n_allocated * 2, 65535);
+      if (nqueue->pspecs == nqueue->pspecs_mem)
+        nqueue->pspecs = g_memdup (nqueue->pspecs_mem, sizeof nqueue->pspecs_mem);
+      nqueue->pspecs = g_renew (GParamSpec *, nqueue->pspecs, nqueue->n_allocated);
     }
 
+  nqueue->pspecs[nqueue->n_pspecs++] = pspec;
+  nqueue->filter |= bit;
+
   G_UNLOCK(notify_lock);
 }
 
+/* Freezes @object's notify queue around setting properties.  If nothing
+ * would observe the ::notify emissions for those properties, no queue is
+ * created just for them: an already frozen one is still used, otherwise
+ * %NULL is returned and the notifications are skipped.
+ */
+static GObjectNotifyQueue *
+object_freeze_for_set (GObject *object)
+{
+  gboolean unobserved;
+
+  unobserved = !CLASS_HAS_CUSTOM_DISPATCH (G_OBJECT_GET_CLASS (object)) &&
+               _g_signal_emission_is_void (object, gobject_signals[NOTIFY]);
+
+  return g_object_notify_queue_freeze (object, unobserved);
+}
+
 #ifdef	G_ENABLE_DEBUG
 G_LOCK_DEFINE_STATIC     (debug_objects);
 static guint		 debug_objects_count = 0;
@@ -386,12 +556,15 @@ _g_object_type_init (void)
   
   g_return_if_fail (initialized == FALSE);
   initialized = TRUE;
+
+  quark_property_cache = g_quark_from_static_string ("GObject-property-cache");
   
   /* G_TYPE_OBJECT
    */
   info.value_table = &value_table;
   type = g_type_register_fundamental (G_TYPE_OBJECT, g_intern_static_string ("GObject"), &info, &finfo, 0);
   g_assert (type == G_TYPE_OBJECT);
+  GObject_private_offset = g_type_add_instance_private (G_TYPE_OBJECT, sizeof (GObjectPrivate));
   g_value_register_transform_func (G_TYPE_OBJECT, G_TYPE_OBJECT, g_value_object_transform_value);
 
 #if G_ENABLE_DEBUG
@@ -427,6 +600,8 @@ g_object_base_class_init (GObjectClass *class)
   class->construct_properties = pclass ? g_slist_copy (pclass->construct_properties) : NULL;
   class->get_property = NULL;
   class->set_property = NULL;
+
+  g_type_set_qdata (G_OBJECT_CLASS_TYPE (class), quark_property_cache, g_new0 (PropertyCache, 1));
 }
 
 static void
@@ -438,6 +613,8 @@ g_object_base_class_finalize (GObjectClass *class)
 
   g_slist_free (class->construct_properties);
   class->construct_properties = NULL;
+  g_free (g_type_get_qdata (G_OBJECT_CLASS_TYPE (class), quark_property_cache));
+  g_type_set_qdata (G_OBJECT_CLASS_TYPE (class), quark_property_cache, NULL);
   list = g_param_spec_pool_list_owned (pspec_pool, G_OBJECT_CLASS_TYPE (class));
   for (node = list; node; node = node->next)
     {
@@ -456,11 +633,7 @@ g_object_do_class_init (GObjectClass *class)
   /* read the comment about typedef struct CArray; on why not to change this quark */
   quark_closure_array = g_quark_from_static_string ("GObject-closure-array");
 
-  quark_weak_refs = g_quark_from_static_string ("GObject-weak-references");
-  quark_weak_locations = g_quark_from_static_string ("GObject-weak-locations");
-  quark_toggle_refs = g_quark_from_static_string ("GObject-toggle-references");
-  quark_notify_queue = g_quark_from_static_string ("GObject-notify-queue");
-  quark_in_construction = g_quark_from_static_string ("GObject-in-construction");
+  g_type_class_adjust_private_offset (class, &GObject_private_offset);
   pspec_pool = g_param_spec_pool_new (TRUE);
 
   class->constructor = g_object_constructor;
@@ -516,6 +689,8 @@ install_property_internal (GType       g_type,
 			   guint       property_id,
 			   GParamSpec *pspec)
 {
+  PropertyCache *cache;
+
   if (g_param_spec_pool_lookup (pspec_pool, pspec->name, g_type, FALSE))
     {
       g_warning ("When installing property: type '%s' already has a property named '%s'",
@@ -527,6 +702,21 @@ install_property_internal (GType       g_type,
   g_param_spec_ref_sink (pspec);
   PARAM_SPEC_SET_PARAM_ID (pspec, property_id);
   g_param_spec_pool_insert (pspec_pool, pspec, g_type);
+
+  /* the new pspec may shadow an ancestor's one that was cached for this
+   * class during class_init; derived classes can't exist yet
+   */
+  cache = g_type_get_qdata (g_type, quark_property_cache);
+  if (cache)
+    {
+      guint i;
+
+      for (i = 0; i < PROPERTY_CACHE_SIZE; i++)
+        {
+          g_atomic_pointer_set (&cache->pspecs[i], NULL);
+          g_atomic_pointer_set (&cache->handles[i], NULL);
+        }
+    }
 }
 
 /**
@@ -750,6 +940,39 @@ g_object_interface_install_property (gpointer      g_iface,
   install_property_internal (iface_class->g_type, 0, pspec);
 }
 
+/* Same as g_param_spec_pool_lookup() for the class and its ancestors,
+ * but consults the class' property cache first.  The cache is read and
+ * updated without any locking.
+ */
+static GParamSpec *
+find_pspec (GObjectClass *class,
+            const gchar  *property_name)
+{
+  GType class_type = G_OBJECT_CLASS_TYPE (class);
+  PropertyCache *cache;
+  GParamSpec *pspec;
+  guint slot = 0;
+
+  cache = g_type_get_qdata (class_type, quark_property_cache);
+  if (cache)
+    {
+      slot = g_str_hash (property_name) % PROPERTY_CACHE_SIZE;
+      pspec = g_atomic_pointer_get (&cache->pspecs[slot]);
+      if (pspec && strcmp (pspec->name, property_name) == 0)
+        return pspec;
+    }
+
+  pspec = g_param_spec_pool_lookup (pspec_pool, property_name, class_type, TRUE);
+
+  /* Only names that match the pspec verbatim are cached, anything else
+   * (non-canonical or type-prefixed names) keeps taking the slow path.
+   */
+  if (cache && pspec && strcmp (pspec->name, property_name) == 0)
+    g_atomic_pointer_set (&cache->pspecs[slot], pspec);
+
+  return pspec;
+}
+
 /**
  * g_object_class_find_property:
  * @oclass: a #GObjectClass
@@ -770,10 +993,7 @@ g_object_class_find_property (GObjectClass *class,
   g_return_val_if_fail (G_IS_OBJECT_CLASS (class), NULL);
   g_return_val_if_fail (property_name != NULL, NULL);
   
-  pspec = g_param_spec_pool_lookup (pspec_pool,
-				    property_name,
-				    G_OBJECT_CLASS_TYPE (class),
-				    TRUE);
+  pspec = find_pspec (class, property_name);
   if (pspec)
     {
       redirect = g_param_spec_get_redirect_target (pspec);
@@ -965,7 +1185,7 @@ g_object_interface_list_properties (gpointer      g_iface,
 static inline gboolean
 object_in_construction (GObject *object)
 {
-  return g_datalist_id_get_data (&object->qdata, quark_in_construction) != NULL;
+  return g_object_get_instance_private (object)->in_construction;
 }
 
 static void
@@ -984,7 +1204,7 @@ g_object_init (GObject		*object,
   if (CLASS_HAS_CUSTOM_CONSTRUCTOR (class))
     {
       /* mark object in-construction for notify_queue_thaw() and to allow construct-only properties */
-      g_datalist_id_set_data (&object->qdata, quark_in_construction, object);
+      g_object_get_instance_private (object)->in_construction = TRUE;
     }
 
   GOBJECT_IF_DEBUG (OBJECTS,
@@ -1029,7 +1249,7 @@ g_object_real_dispose (GObject *object)
 {
   g_signal_handlers_destroy (object);
   g_datalist_id_set_data (&object->qdata, quark_closure_array, NULL);
-  g_datalist_id_set_data (&object->qdata, quark_weak_refs, NULL);
+  weak_refs_notify (object);
 }
 
 static void
@@ -1041,7 +1261,18 @@ g_object_finalize (GObject *object)
                   G_OBJECT_TYPE_NAME (object), object);
     }
 
+  /* weak refs added after dispose still get notified */
+  weak_refs_notify (object);
+  if (g_object_get_instance_private (object)->refs != NULL)
+    {
+      g_free (g_object_get_instance_private (object)->refs->toggle_refs);
+      g_clear_pointer (&g_object_get_instance_private (object)->refs, g_free);
+    }
   g_datalist_clear (&object->qdata);
+
+  /* left frozen by g_object_freeze_notify() without a thaw */
+  g_clear_pointer (&g_object_get_instance_private (object)->notify_queue,
+                   g_object_notify_queue_free);
   
   GOBJECT_IF_DEBUG (OBJECTS,
     {
@@ -1191,10 +1422,7 @@ g_object_notify (GObject     *object,
    * (by, e.g. calling g_object_class_find_property())
    * because g_object_notify_queue_add() does that
    */
-  pspec = g_param_spec_pool_lookup (pspec_pool,
-				    property_name,
-				    G_OBJECT_TYPE (object),
-				    TRUE);
+  pspec = find_pspec (G_OBJECT_GET_CLASS (object), property_name);
 
   if (!pspec)
     g_warning ("%s: object class '%s' has no property named '%s'",
@@ -1407,7 +1635,7 @@ object_set_property (GObject             *object,
 	       pspec->name,
 	       g_type_name (pspec->value_type),
 	       G_VALUE_TYPE_NAME (value));
-  else if (g_param_value_validate (pspec, &tmp_value) && !(pspec->flags & G_PARAM_LAX_VALIDATION))
+  else if (_g_param_value_validate (pspec, &tmp_value) && !(pspec->flags & G_PARAM_LAX_VALIDATION))
     {
       gchar *contents = g_strdup_value_contents (value);
 
@@ -1435,6 +1663,42 @@ object_set_property (GObject             *object,
   g_value_unset (&tmp_value);
 }
 
+/* Same as object_set_property() with @pspec's default value, which
+ * already has the property's type and is valid, so doesn't need to be
+ * copied and validated first.
+ */
+static inline void
+object_set_default_property (GObject            *object,
+                             GParamSpec         *pspec,
+                             GObjectNotifyQueue *nqueue)
+{
+  GObjectClass *class = g_type_class_peek (pspec->owner_type);
+  guint param_id = PARAM_SPEC_PARAM_ID (pspec);
+  GParamSpec *redirect;
+
+  if (class == NULL)
+    {
+      object_set_property (object, pspec, g_param_spec_get_default_value (pspec), nqueue);
+      return;
+    }
+
+  redirect = g_param_spec_get_redirect_target (pspec);
+  if (redirect)
+    pspec = redirect;
+
+  class->set_property (object, param_id, g_param_spec_get_default_value (pspec), pspec);
+
+  if (~pspec->flags & G_PARAM_EXPLICIT_NOTIFY)
+    {
+      GParamSpec *notify_pspec;
+
+      notify_pspec = get_notify_pspec (pspec);
+
+      if (notify_pspec != NULL)
+        g_object_notify_queue_add (object, nqueue, notify_pspec);
+    }
+}
+
 static void
 object_interface_check_properties (gpointer check_data,
 				   gpointer g_iface)
@@ -1722,7 +1986,7 @@ g_object_new_with_custom_constructor (GObjectClass          *class,
    */
   newly_constructed = object_in_construction (object);
   if (newly_constructed)
-    g_datalist_id_set_data (&object->qdata, quark_in_construction, NULL);
+    g_object_get_instance_private (object)->in_construction = FALSE;
 
   if (CLASS_HAS_PROPS (class))
     {
@@ -1787,7 +2051,7 @@ g_object_new_internal (GObjectClass          *class,
       GSList *node;
 
       /* This will have been setup in g_object_init() */
-      nqueue = g_datalist_id_get_data (&object->qdata, quark_notify_queue);
+      nqueue = g_object_get_instance_private (object)->notify_queue;
       g_assert (nqueue != NULL);
 
       /* We will set exactly n_construct_properties construct
@@ -1796,25 +2060,21 @@ g_object_new_internal (GObjectClass          *class,
        */
       for (node = class->construct_properties; node; node = node->next)
         {
-          const GValue *value;
           GParamSpec *pspec;
           gint j;
 
           pspec = node->data;
-          value = NULL; /* to silence gcc... */
 
           for (j = 0; j < n_params; j++)
             if (params[j].pspec == pspec)
               {
                 consider_issuing_property_deprecation_warning (pspec);
-                value = params[j].value;
+                object_set_property (object, pspec, params[j].value, nqueue);
                 break;
               }
 
           if (j == n_params)
-            value = g_param_spec_get_default_value (pspec);
-
-          object_set_property (object, pspec, value, nqueue);
+            object_set_default_property (object, pspec, nqueue);
         }
     }
 
@@ -1837,6 +2097,14 @@ g_object_new_internal (GObjectClass          *class,
             object_set_property (object, params[i].pspec, params[i].value, nqueue);
           }
 
+      /* The new object's notifications are normally only dispatched
+       * here, one ::notify emission each; skip them if nothing would
+       * observe those emissions.
+       */
+      if (!CLASS_HAS_CUSTOM_DISPATCH (class) &&
+          _g_signal_emission_is_void (object, gobject_signals[NOTIFY]))
+        g_object_notify_queue_clear (object, nqueue);
+
       g_object_notify_queue_thaw (object, nqueue);
     }
 
@@ -1889,7 +2157,7 @@ g_object_newv (GType       object_type,
           GParamSpec *pspec;
           gint k;
 
-          pspec = g_param_spec_pool_lookup (pspec_pool, parameters[i].name, object_type, TRUE);
+          pspec = find_pspec (class, parameters[i].name);
 
           if G_UNLIKELY (!pspec)
             {
@@ -1983,7 +2251,7 @@ g_object_new_valist (GType        object_type,
           GParamSpec *pspec;
           gint i;
 
-          pspec = g_param_spec_pool_lookup (pspec_pool, name, object_type, TRUE);
+          pspec = find_pspec (class, name);
 
           if G_UNLIKELY (!pspec)
             {
@@ -2117,7 +2385,7 @@ g_object_set_valist (GObject	 *object,
   g_return_if_fail (G_IS_OBJECT (object));
   
   g_object_ref (object);
-  nqueue = g_object_notify_queue_freeze (object, FALSE);
+  nqueue = object_freeze_for_set (object);
   
   name = first_property_name;
   while (name)
@@ -2126,10 +2394,7 @@ g_object_set_valist (GObject	 *object,
       GParamSpec *pspec;
       gchar *error = NULL;
       
-      pspec = g_param_spec_pool_lookup (pspec_pool,
-					name,
-					G_OBJECT_TYPE (object),
-					TRUE);
+      pspec = find_pspec (G_OBJECT_GET_CLASS (object), name);
       if (!pspec)
 	{
 	  g_warning ("%s: object class '%s' has no property named '%s'",
@@ -2170,7 +2435,8 @@ g_object_set_valist (GObject	 *object,
       name = va_arg (var_args, gchar*);
     }
 
-  g_object_notify_queue_thaw (object, nqueue);
+  if (nqueue)
+    g_object_notify_queue_thaw (object, nqueue);
   g_object_unref (object);
 }
 
@@ -2208,10 +2474,7 @@ g_object_get_valist (GObject	 *object,
       GParamSpec *pspec;
       gchar *error;
       
-      pspec = g_param_spec_pool_lookup (pspec_pool,
-					name,
-					G_OBJECT_TYPE (object),
-					TRUE);
+      pspec = find_pspec (G_OBJECT_GET_CLASS (object), name);
       if (!pspec)
 	{
 	  g_warning ("%s: object class '%s' has no property named '%s'",
@@ -2325,6 +2588,41 @@ g_object_get (gpointer     _object,
   va_end (var_args);
 }
 
+/* Maps @pspec, as returned by g_object_class_find_property(), to the
+ * pspec that @object's class resolves its name to.  That is either
+ * @pspec itself or an override redirecting to it; anything else means
+ * @pspec isn't a property of @object.
+ */
+static GParamSpec *
+object_resolve_pspec (GObject    *object,
+                      GParamSpec *pspec)
+{
+  GObjectClass *class = G_OBJECT_GET_CLASS (object);
+  PropertyCache *cache;
+  GParamSpec *class_pspec;
+  guint slot = 0;
+
+  cache = g_type_get_qdata (G_OBJECT_CLASS_TYPE (class), quark_property_cache);
+  if (cache)
+    {
+      slot = (GPOINTER_TO_SIZE (pspec) >> 4) % PROPERTY_CACHE_SIZE;
+      class_pspec = g_atomic_pointer_get (&cache->handles[slot]);
+      if (class_pspec &&
+          (class_pspec == pspec || g_param_spec_get_redirect_target (class_pspec) == pspec))
+        return class_pspec;
+    }
+
+  class_pspec = find_pspec (class, pspec->name);
+  if (class_pspec != pspec &&
+      (!class_pspec || g_param_spec_get_redirect_target (class_pspec) != pspec))
+    return NULL;
+
+  if (cache)
+    g_atomic_pointer_set (&cache->handles[slot], class_pspec);
+
+  return class_pspec;
+}
+
 /**
  * g_object_set_property:
  * @object: a #GObject
@@ -2338,26 +2636,63 @@ g_object_set_property (GObject	    *object,
 		       const gchar  *property_name,
 		       const GValue *value)
 {
-  GObjectNotifyQueue *nqueue;
   GParamSpec *pspec;
   
   g_return_if_fail (G_IS_OBJECT (object));
   g_return_if_fail (property_name != NULL);
   g_return_if_fail (G_IS_VALUE (value));
   
-  g_object_ref (object);
-  nqueue = g_object_notify_queue_freeze (object, FALSE);
-  
-  pspec = g_param_spec_pool_lookup (pspec_pool,
-				    property_name,
-				    G_OBJECT_TYPE (object),
-				    TRUE);
+  pspec = find_pspec (G_OBJECT_GET_CLASS (object), property_name);
   if (!pspec)
     g_warning ("%s: object class '%s' has no property named '%s'",
 	       G_STRFUNC,
 	       G_OBJECT_TYPE_NAME (object),
 	       property_name);
-  else if (!(pspec->flags & G_PARAM_WRITABLE))
+  else
+    g_object_set_property_by_pspec (object, pspec, value);
+}
+
+/**
+ * g_object_set_property_by_pspec:
+ * @object: a #GObject
+ * @pspec: the #GParamSpec of the property to set
+ * @value: the value
+ *
+ * Sets a property on an object, like g_object_set_property(), but
+ * without looking up the property by name.
+ *
+ * @pspec can be resolved once, with g_object_class_find_property(),
+ * and then used for any instance of that class or its subclasses.
+ *
+ * Since: 2.54
+ */
+void
+g_object_set_property_by_pspec (GObject      *object,
+                                GParamSpec   *pspec,
+                                const GValue *value)
+{
+  GObjectNotifyQueue *nqueue;
+  GParamSpec *class_pspec;
+
+  g_return_if_fail (G_IS_OBJECT (object));
+  g_return_if_fail (G_IS_PARAM_SPEC (pspec));
+  g_return_if_fail (G_IS_VALUE (value));
+
+  class_pspec = object_resolve_pspec (object, pspec);
+  if (!class_pspec)
+    {
+      g_warning ("%s: object class '%s' has no property named '%s'",
+                 G_STRFUNC,
+                 G_OBJECT_TYPE_NAME (object),
+                 pspec->name);
+      return;
+    }
+  pspec = class_pspec;
+
+  g_object_ref (object);
+  nqueue = object_freeze_for_set (object);
+
+  if (!(pspec->flags & G_PARAM_WRITABLE))
     g_warning ("%s: property '%s' of object class '%s' is not writable",
                G_STRFUNC,
                pspec->name,
@@ -2371,7 +2706,8 @@ g_object_set_property (GObject	    *object,
       object_set_property (object, pspec, value, nqueue);
     }
 
-  g_object_notify_queue_thaw (object, nqueue);
+  if (nqueue)
+    g_object_notify_queue_thaw (object, nqueue);
   g_object_unref (object);
 }
 
@@ -2402,18 +2738,55 @@ g_object_get_property (GObject	   *object,
   g_return_if_fail (property_name != NULL);
   g_return_if_fail (G_IS_VALUE (value));
   
-  g_object_ref (object);
-  
-  pspec = g_param_spec_pool_lookup (pspec_pool,
-				    property_name,
-				    G_OBJECT_TYPE (object),
-				    TRUE);
+  pspec = find_pspec (G_OBJECT_GET_CLASS (object), property_name);
   if (!pspec)
     g_warning ("%s: object class '%s' has no property named '%s'",
 	       G_STRFUNC,
 	       G_OBJECT_TYPE_NAME (object),
 	       property_name);
-  else if (!(pspec->flags & G_PARAM_READABLE))
+  else
+    g_object_get_property_by_pspec (object, pspec, value);
+}
+
+/**
+ * g_object_get_property_by_pspec:
+ * @object: a #GObject
+ * @pspec: the #GParamSpec of the property to get
+ * @value: return location for the property value
+ *
+ * Gets a property of an object, like g_object_get_property(), but
+ * without looking up the property by name.
+ *
+ * @pspec can be resolved once, with g_object_class_find_property(),
+ * and then used for any instance of that class or its subclasses.
+ *
+ * Since: 2.54
+ */
+void
+g_object_get_property_by_pspec (GObject    *object,
+                                GParamSpec *pspec,
+                                GValue     *value)
+{
+  GParamSpec *class_pspec;
+
+  g_return_if_fail (G_IS_OBJECT (object));
+  g_return_if_fail (G_IS_PARAM_SPEC (pspec));
+  g_return_if_fail (G_IS_VALUE (value));
+
+  class_pspec = object_resolve_pspec (object, pspec);
+  if (!class_pspec)
+    {
+      g_warning ("%s: object class '%s' has no property named '%s'",
+                 G_STRFUNC,
+                 G_OBJECT_TYPE_NAME (object),
+                 pspec->name);
+      return;
+    }
+  pspec = class_pspec;
+
+  g_object_ref (object);
+
+  if (!(pspec->flags & G_PARAM_READABLE))
     g_warning ("%s: property '%s' of object class '%s' is not readable",
                G_STRFUNC,
                pspec->name,
@@ -2619,21 +2992,25 @@ g_object_disconnect (gpointer     _object,
   va_end (var_args);
 }
 
-typedef struct {
-  GObject *object;
-  guint n_weak_refs;
-  struct {
-    GWeakNotify notify;
-    gpointer    data;
-  } weak_refs[1];  /* flexible array */
-} WeakRefStack;
-
 static void
-weak_refs_notify (gpointer data)
+weak_refs_notify (GObject *object)
 {
-  WeakRefStack *wstack = data;
+  ObjectRefs *refs = object_get_refs (object, FALSE);
+  ObjectRefsShard *shard = object_refs_shard (object);
+  WeakRefStack *wstack;
   guint i;
 
+  if (refs == NULL)
+    return;
+
+  g_mutex_lock (&shard->mutex);
+  wstack = refs->weak_refs;
+  refs->weak_refs = NULL;
+  g_mutex_unlock (&shard->mutex);
+
+  if (wstack == NULL)
+    return;
+
   for (i = 0; i < wstack->n_weak_refs; i++)
     wstack->weak_refs[i].notify (wstack->weak_refs[i].data, wstack->object);
   g_free (wstack);
@@ -2661,6 +3038,8 @@ g_object_weak_ref (GObject    *object,
 		   GWeakNotify notify,
 		   gpointer    data)
 {
+  ObjectRefsShard *shard;
+  ObjectRefs *refs;
   WeakRefStack *wstack;
   guint i;
   
@@ -2668,8 +3047,10 @@ g_object_weak_ref (GObject    *object,
   g_return_if_fail (notify != NULL);
   g_return_if_fail (object->ref_count >= 1);
 
-  G_LOCK (weak_refs_mutex);
-  wstack = g_datalist_id_remove_no_notify (&object->qdata, quark_weak_refs);
+  refs = object_get_refs (object, TRUE);
+  shard = object_refs_shard (object);
+  g_mutex_lock (&shard->mutex);
+  wstack = refs->weak_refs;
   if (wstack)
     {
       i = wstack->n_weak_refs++;
@@ -2684,8 +3065,8 @@ g_object_weak_ref (GObject    *object,
     }
   wstack->weak_refs[i].notify = notify;
   wstack->weak_refs[i].data = data;
-  g_datalist_id_set_data_full (&object->qdata, quark_weak_refs, wstack, weak_refs_notify);
-  G_UNLOCK (weak_refs_mutex);
+  refs->weak_refs = wstack;
+  g_mutex_unlock (&shard->mutex);
 }
 
 /**
@@ -2701,14 +3082,18 @@ g_object_weak_unref (GObject    *object,
 		     GWeakNotify notify,
 		     gpointer    data)
 {
+  ObjectRefsShard *shard;
+  ObjectRefs *refs;
   WeakRefStack *wstack;
   gboolean found_one = FALSE;
 
   g_return_if_fail (G_IS_OBJECT (object));
   g_return_if_fail (notify != NULL);
 
-  G_LOCK (weak_refs_mutex);
-  wstack = g_datalist_id_get_data (&object->qdata, quark_weak_refs);
+  refs = object_get_refs (object, FALSE);
+  shard = object_refs_shard (object);
+  g_mutex_lock (&shard->mutex);
+  wstack = refs ? refs->weak_refs : NULL;
   if (wstack)
     {
       guint i;
@@ -2725,7 +3110,7 @@ g_object_weak_unref (GObject    *object,
 	    break;
 	  }
     }
-  G_UNLOCK (weak_refs_mutex);
+  g_mutex_unlock (&shard->mutex);
   if (!found_one)
     g_warning ("%s: couldn't find weak ref %p(%p)", G_STRFUNC, notify, data);
 }
@@ -2873,25 +3258,16 @@ g_object_force_floating (GObject *object)
   floating_flag_handler (object, +1);
 }
 
-typedef struct {
-  GObject *object;
-  guint n_toggle_refs;
-  struct {
-    GToggleNotify notify;
-    gpointer    data;
-  } toggle_refs[1];  /* flexible array */
-} ToggleRefStack;
-
 static void
 toggle_refs_notify (GObject *object,
 		    gboolean is_last_ref)
 {
-  ToggleRefStack tstack, *tstackptr;
+  ObjectRefsShard *shard = object_refs_shard (object);
+  ToggleRefStack tstack;
 
-  G_LOCK (toggle_refs_mutex);
-  tstackptr = g_datalist_id_get_data (&object->qdata, quark_toggle_refs);
-  tstack = *tstackptr;
-  G_UNLOCK (toggle_refs_mutex);
+  g_mutex_lock (&shard->mutex);
+  tstack = *object_get_refs (object, FALSE)->toggle_refs;
+  g_mutex_unlock (&shard->mutex);
 
   /* Reentrancy here is not as tricky as it seems, because a toggle reference
    * will only be notified when there is exactly one of them.
@@ -2944,6 +3320,8 @@ g_object_add_toggle_ref (GObject       *object,
 			 GToggleNotify  notify,
 			 gpointer       data)
 {
+  ObjectRefsShard *shard;
+  ObjectRefs *refs;
   ToggleRefStack *tstack;
   guint i;
   
@@ -2953,8 +3331,10 @@ g_object_add_toggle_ref (GObject       *object,
 
   g_object_ref (object);
 
-  G_LOCK (toggle_refs_mutex);
-  tstack = g_datalist_id_remove_no_notify (&object->qdata, quark_toggle_refs);
+  refs = object_get_refs (object, TRUE);
+  shard = object_refs_shard (object);
+  g_mutex_lock (&shard->mutex);
+  tstack = refs->toggle_refs;
   if (tstack)
     {
       i = tstack->n_toggle_refs++;
@@ -2976,9 +3356,8 @@ g_object_add_toggle_ref (GObject       *object,
   
   tstack->toggle_refs[i].notify = notify;
   tstack->toggle_refs[i].data = data;
-  g_datalist_id_set_data_full (&object->qdata, quark_toggle_refs, tstack,
-			       (GDestroyNotify)g_free);
-  G_UNLOCK (toggle_refs_mutex);
+  refs->toggle_refs = tstack;
+  g_mutex_unlock (&shard->mutex);
 }
 
 /**
@@ -2999,14 +3378,18 @@ g_object_remove_toggle_ref (GObject       *object,
 			    GToggleNotify  notify,
 			    gpointer       data)
 {
+  ObjectRefsShard *shard;
+  ObjectRefs *refs;
   ToggleRefStack *tstack;
   gboolean found_one = FALSE;
 
   g_return_if_fail (G_IS_OBJECT (object));
   g_return_if_fail (notify != NULL);
 
-  G_LOCK (toggle_refs_mutex);
-  tstack = g_datalist_id_get_data (&object->qdata, quark_toggle_refs);
+  refs = object_get_refs (object, FALSE);
+  shard = object_refs_shard (object);
+  g_mutex_lock (&shard->mutex);
+  tstack = refs ? refs->toggle_refs : NULL;
   if (tstack)
     {
       guint i;
@@ -3026,7 +3409,7 @@ g_object_remove_toggle_ref (GObject       *object,
 	    break;
 	  }
     }
-  G_UNLOCK (toggle_refs_mutex);
+  g_mutex_unlock (&shard->mutex);
 
   if (found_one)
     g_object_unref (object);
@@ -3101,7 +3484,7 @@ g_object_unref (gpointer _object)
     }
   else
     {
-      GSList **weak_locations;
+      ObjectRefs *refs = object_get_refs (object, FALSE);
 
       /* The only way that this object can live at this point is if
        * there are outstanding weak references already established
@@ -3112,11 +3495,11 @@ g_object_unref (gpointer _object)
        * to hold a strong ref in order to call
        * g_object_add_weak_pointer() and then we wouldn't be here.
        */
-      weak_locations = g_datalist_id_get_data (&object->qdata, quark_weak_locations);
-
-      if (weak_locations != NULL)
+      if (refs != NULL && g_atomic_pointer_get (&refs->weak_locations) != NULL)
         {
-          g_rw_lock_writer_lock (&weak_locations_lock);
+          ObjectRefsShard *shard = object_refs_shard (object);
+
+          g_rw_lock_writer_lock (&shard->weak_locations_lock);
 
           /* It is possible that one of the weak references beat us to
            * the lock. Make sure the refcount is still what we expected
@@ -3125,22 +3508,22 @@ g_object_unref (gpointer _object)
           old_ref = g_atomic_int_get (&object->ref_count);
           if (old_ref != 1)
             {
-              g_rw_lock_writer_unlock (&weak_locations_lock);
+              g_rw_lock_writer_unlock (&shard->weak_locations_lock);
               goto retry_atomic_decrement1;
             }
 
           /* We got the lock first, so the object will definitely die
            * now. Clear out all the weak references.
            */
-          while (*weak_locations)
+          while (refs->weak_locations)
             {
-              GWeakRef *weak_ref_location = (*weak_locations)->data;
+              GWeakRef *weak_ref_location = refs->weak_locations->data;
 
               weak_ref_location->priv.p = NULL;
-              *weak_locations = g_slist_delete_link (*weak_locations, *weak_locations);
+              refs->weak_locations = g_slist_delete_link (refs->weak_locations, refs->weak_locations);
             }
 
-          g_rw_lock_writer_unlock (&weak_locations_lock);
+          g_rw_lock_writer_unlock (&shard->weak_locations_lock);
         }
 
       /* we are about to remove the last reference */
@@ -3171,7 +3554,7 @@ g_object_unref (gpointer _object)
       /* we are still in the process of taking away the last ref */
       g_datalist_id_set_data (&object->qdata, quark_closure_array, NULL);
       g_signal_handlers_destroy (object);
-      g_datalist_id_set_data (&object->qdata, quark_weak_refs, NULL);
+      weak_refs_notify (object);
       
       /* decrement the last reference */
       old_ref = g_atomic_int_add (&object->ref_count, -1);
@@ -4216,18 +4599,67 @@ g_weak_ref_get (GWeakRef *weak_ref)
 
   g_return_val_if_fail (weak_ref!= NULL, NULL);
 
-  g_rw_lock_reader_lock (&weak_locations_lock);
+  object_or_null = g_atomic_pointer_get (&weak_ref->priv.p);
+
+  while (object_or_null != NULL)
+    {
+      ObjectRefsShard *shard = object_refs_shard (object_or_null);
+      gboolean found;
+
+      g_rw_lock_reader_lock (&shard->weak_locations_lock);
 
-  object_or_null = weak_ref->priv.p;
+      /* Still pointing to it under the lock means it is still alive */
+      found = weak_ref->priv.p == object_or_null;
+      if (found)
+        g_object_ref (object_or_null);
 
-  if (object_or_null != NULL)
-    g_object_ref (object_or_null);
+      g_rw_lock_reader_unlock (&shard->weak_locations_lock);
 
-  g_rw_lock_reader_unlock (&weak_locations_lock);
+      if (found)
+        break;
+
+      object_or_null = g_atomic_pointer_get (&weak_ref->priv.p);
+    }
 
   return object_or_null;
 }
 
+/* Takes the weak_locations_lock of the shards of both objects, either
+ * of which may be %NULL, in a fixed order.
+ */
+static void
+weak_locations_lock_two (GObject *a,
+                         GObject *b)
+{
+  ObjectRefsShard *shard_a = a ? object_refs_shard (a) : NULL;
+  ObjectRefsShard *shard_b = b ? object_refs_shard (b) : NULL;
+
+  if (shard_a > shard_b)
+    {
+      ObjectRefsShard *tmp = shard_a;
+      shard_a = shard_b;
+      shard_b = tmp;
+    }
+
+  if (shard_a != NULL && shard_a != shard_b)
+    g_rw_lock_writer_lock (&shard_a->weak_locations_lock);
+  if (shard_b != NULL)
+    g_rw_lock_writer_lock (&shard_b->weak_locations_lock);
+}
+
+static void
+weak_locations_unlock_two (GObject *a,
+                           GObject *b)
+{
+  ObjectRefsShard *shard_a = a ? object_refs_shard (a) : NULL;
+  ObjectRefsShard *shard_b = b ? object_refs_shard (b) : NULL;
+
+  if (shard_a != NULL)
+    g_rw_lock_writer_unlock (&shard_a->weak_locations_lock);
+  if (shard_b != NULL && shard_b != shard_a)
+    g_rw_lock_writer_unlock (&shard_b->weak_locations_lock);
+}
+
 /**
  * g_weak_ref_set: (skip)
  * @weak_ref: location for a weak reference
@@ -4245,7 +4677,7 @@ void
 g_weak_ref_set (GWeakRef *weak_ref,
                 gpointer  object)
 {
-  GSList **weak_locations;
+  ObjectRefs *refs;
   GObject *new_object;
   GObject *old_object;
 
@@ -4254,52 +4686,44 @@ g_weak_ref_set (GWeakRef *weak_ref,
 
   new_object = object;
 
-  g_rw_lock_writer_lock (&weak_locations_lock);
-
-  /* We use the extra level of indirection here so that if we have ever
-   * had a weak pointer installed at any point in time on this object,
-   * we can see that there is a non-NULL value associated with the
-   * weak-pointer quark and know that this value will not change at any
-   * point in the object's lifetime.
-   *
-   * Both properties are important for reducing the amount of times we
-   * need to acquire locks and for decreasing the duration of time the
-   * lock is held while avoiding some rather tricky races.
-   *
-   * Specifically: we can avoid having to do an extra unconditional lock
-   * in g_object_unref() without worrying about some extremely tricky
-   * races.
+  /* The old object may be finalized concurrently, which clears
+   * @weak_ref under the lock of its shard; check again once we hold it.
    */
+ retry:
+  old_object = g_atomic_pointer_get (&weak_ref->priv.p);
+  if (new_object == old_object)
+    return;
 
-  old_object = weak_ref->priv.p;
-  if (new_object != old_object)
-    {
-      weak_ref->priv.p = new_object;
+  /* set up before taking the locks, we own a reference on it */
+  if (new_object != NULL)
+    object_get_refs (new_object, TRUE);
 
-      /* Remove the weak ref from the old object */
-      if (old_object != NULL)
-        {
-          weak_locations = g_datalist_id_get_data (&old_object->qdata, quark_weak_locations);
-          /* for it to point to an object, the object must have had it added once */
-          g_assert (weak_locations != NULL);
+  weak_locations_lock_two (old_object, new_object);
 
-          *weak_locations = g_slist_remove (*weak_locations, weak_ref);
-        }
+  if (weak_ref->priv.p != old_object)
+    {
+      weak_locations_unlock_two (old_object, new_object);
+      goto retry;
+    }
 
-      /* Add the weak ref to the new object */
-      if (new_object != NULL)
-        {
-          weak_locations = g_datalist_id_get_data (&new_object->qdata, quark_weak_locations);
+  weak_ref->priv.p = new_object;
 
-          if (weak_locations == NULL)
-            {
-              weak_locations = g_new0 (GSList *, 1);
-              g_datalist_id_set_data_full (&new_object->qdata, quark_weak_locations, weak_locations, g_free);
-            }
+  /* Remove the weak ref from the old object */
+  if (old_object != NULL)
+    {
+      refs = object_get_refs (old_object, FALSE);
+      /* for it to point to an object, the object must have had it added */
+      g_assert (refs != NULL && refs->weak_locations != NULL);
 
-          *weak_locations = g_slist_prepend (*weak_locations, weak_ref);
-        }
+      refs->weak_locations = g_slist_remove (refs->weak_locations, weak_ref);
+    }
+
+  /* Add the weak ref to the new object */
+  if (new_object != NULL)
+    {
+      refs = object_get_refs (new_object, FALSE);
+      refs->weak_locations = g_slist_prepend (refs->weak_locations, weak_ref);
     }
 
-  g_rw_lock_writer_unlock (&weak_locations_lock);
+  weak_locations_unlock_two (old_object, new_object);
 }
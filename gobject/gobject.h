@@ -460,6 +460,14 @@ GLIB_AVAILABLE_IN_ALL
 void        g_object_get_property             (GObject        *object,
 					       const gchar    *property_name,
 					       GValue         *value);
+GLIB_AVAILABLE_IN_2_54
+void        g_object_set_property_by_pspec    (GObject        *object,
+					       GParamSpec     *pspec,
+					       const GValue   *value);
+GLIB_AVAILABLE_IN_2_54
+void        g_object_get_property_by_pspec    (GObject        *object,
+					       GParamSpec     *pspec,
+					       GValue         *value);
 GLIB_AVAILABLE_IN_ALL
 void        g_object_freeze_notify            (GObject        *object);
 GLIB_AVAILABLE_IN_ALL
@@ -639,6 +639,165 @@ g_param_value_defaults (GParamSpec *pspec,
   return defaults;
 }
 
+/* Fast paths for the pspec types of the fundamental numeric types,
+ * which skip the class vfuncs and the type checks on the pspec.  They
+ * must give the same results as the param_*_validate() and
+ * param_*_values_cmp() functions in gparamspecs.c.  Pspec subtypes
+ * don't match the exact type checks below, and go through their class.
+ */
+#define VALIDATE_RANGE(SpecType, field)                                 \
+  G_STMT_START {                                                        \
+    SpecType *spec = (SpecType *) pspec;                                \
+                                                                        \
+    if (value->data[0].field < spec->minimum)                           \
+      value->data[0].field = spec->minimum;                             \
+    else if (value->data[0].field > spec->maximum)                      \
+      value->data[0].field = spec->maximum;                             \
+    else                                                                \
+      return FALSE;                                                     \
+    return TRUE;                                                        \
+  } G_STMT_END
+
+/* For the types where no value can lie outside the full range */
+#define VALIDATE_FULL_RANGE(SpecType, field, type_min, type_max)        \
+  G_STMT_START {                                                        \
+    SpecType *spec = (SpecType *) pspec;                                \
+                                                                        \
+    if (spec->minimum == (type_min) && spec->maximum == (type_max))     \
+      return FALSE;                                                     \
+    VALIDATE_RANGE (SpecType, field);                                   \
+  } G_STMT_END
+
+/* Floating point values are checked the same way as in gparamspecs.c,
+ * so that NaN is still reported as invalid.
+ */
+#define VALIDATE_FLOAT(SpecType, ftype, field)                          \
+  G_STMT_START {                                                        \
+    SpecType *spec = (SpecType *) pspec;                                \
+    ftype oval = value->data[0].field;                                  \
+                                                                        \
+    value->data[0].field = CLAMP (oval, spec->minimum, spec->maximum);  \
+    return value->data[0].field != oval;                                \
+  } G_STMT_END
+
+static inline gboolean
+param_spec_is_fast_numeric (GParamSpec *pspec)
+{
+  GType type = G_TYPE_FROM_INSTANCE (pspec);
+
+  /* The fundamental numeric types are numbered consecutively */
+  if (pspec->value_type < G_TYPE_CHAR || pspec->value_type > G_TYPE_DOUBLE)
+    return FALSE;
+
+  switch (pspec->value_type)
+    {
+    case G_TYPE_CHAR:
+      return type == G_TYPE_PARAM_CHAR;
+    case G_TYPE_UCHAR:
+      return type == G_TYPE_PARAM_UCHAR;
+    case G_TYPE_BOOLEAN:
+      return type == G_TYPE_PARAM_BOOLEAN;
+    case G_TYPE_INT:
+      return type == G_TYPE_PARAM_INT;
+    case G_TYPE_UINT:
+      return type == G_TYPE_PARAM_UINT;
+    case G_TYPE_LONG:
+      return type == G_TYPE_PARAM_LONG;
+    case G_TYPE_ULONG:
+      return type == G_TYPE_PARAM_ULONG;
+    case G_TYPE_INT64:
+      return type == G_TYPE_PARAM_INT64;
+    case G_TYPE_UINT64:
+      return type == G_TYPE_PARAM_UINT64;
+    case G_TYPE_FLOAT:
+      return type == G_TYPE_PARAM_FLOAT;
+    case G_TYPE_DOUBLE:
+      return type == G_TYPE_PARAM_DOUBLE;
+    default:
+      return FALSE;
+    }
+}
+
+/* Must only be called if param_spec_is_fast_numeric() */
+static inline gboolean
+param_value_validate_numeric (GParamSpec *pspec,
+                              GValue     *value)
+{
+  switch (pspec->value_type)
+    {
+    case G_TYPE_CHAR:
+      VALIDATE_RANGE (GParamSpecChar, v_int);
+    case G_TYPE_UCHAR:
+      VALIDATE_RANGE (GParamSpecUChar, v_uint);
+    case G_TYPE_BOOLEAN:
+      if (value->data[0].v_int == FALSE || value->data[0].v_int == TRUE)
+        return FALSE;
+      value->data[0].v_int = TRUE;
+      return TRUE;
+    case G_TYPE_INT:
+      VALIDATE_FULL_RANGE (GParamSpecInt, v_int, G_MININT, G_MAXINT);
+    case G_TYPE_UINT:
+      VALIDATE_FULL_RANGE (GParamSpecUInt, v_uint, 0, G_MAXUINT);
+    case G_TYPE_LONG:
+      VALIDATE_FULL_RANGE (GParamSpecLong, v_long, G_MINLONG, G_MAXLONG);
+    case G_TYPE_ULONG:
+      VALIDATE_FULL_RANGE (GParamSpecULong, v_ulong, 0, G_MAXULONG);
+    case G_TYPE_INT64:
+      VALIDATE_FULL_RANGE (GParamSpecInt64, v_int64, G_MININT64, G_MAXINT64);
+    case G_TYPE_UINT64:
+      VALIDATE_FULL_RANGE (GParamSpecUInt64, v_uint64, 0, G_MAXUINT64);
+    case G_TYPE_FLOAT:
+      VALIDATE_FLOAT (GParamSpecFloat, gfloat, v_float);
+    case G_TYPE_DOUBLE:
+      VALIDATE_FLOAT (GParamSpecDouble, gdouble, v_double);
+    default:
+      g_assert_not_reached ();
+      return FALSE;
+    }
+}
+
+#define COMPARE(field) \
+  (value1->data[0].field < value2->data[0].field ? -1 : \
+   value1->data[0].field > value2->data[0].field)
+
+#define COMPARE_EPSILON(SpecType, field)                                \
+  (value1->data[0].field < value2->data[0].field ?                      \
+   - (value2->data[0].field - value1->data[0].field > ((SpecType *) pspec)->epsilon) : \
+   value1->data[0].field - value2->data[0].field > ((SpecType *) pspec)->epsilon)
+
+/* Must only be called if param_spec_is_fast_numeric() */
+static inline gint
+param_values_cmp_numeric (GParamSpec   *pspec,
+                          const GValue *value1,
+                          const GValue *value2)
+{
+  switch (pspec->value_type)
+    {
+    case G_TYPE_CHAR:
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_INT:
+      return COMPARE (v_int);
+    case G_TYPE_UCHAR:
+    case G_TYPE_UINT:
+      return COMPARE (v_uint);
+    case G_TYPE_LONG:
+      return COMPARE (v_long);
+    case G_TYPE_ULONG:
+      return COMPARE (v_ulong);
+    case G_TYPE_INT64:
+      return COMPARE (v_int64);
+    case G_TYPE_UINT64:
+      return COMPARE (v_uint64);
+    case G_TYPE_FLOAT:
+      return COMPARE_EPSILON (GParamSpecFloat, v_float);
+    case G_TYPE_DOUBLE:
+      return COMPARE_EPSILON (GParamSpecDouble, v_double);
+    default:
+      g_assert_not_reached ();
+      return 0;
+    }
+}
+
 /**
  * g_param_value_validate:
  * @pspec: a valid #GParamSpec
@@ -661,6 +820,19 @@ g_param_value_validate (GParamSpec *pspec,
   g_return_val_if_fail (G_IS_VALUE (value), FALSE);
   g_return_val_if_fail (PSPEC_APPLIES_TO_VALUE (pspec, value), FALSE);
 
+  return _g_param_value_validate (pspec, value);
+}
+
+/* g_param_value_validate() without the argument checks, for callers
+ * which already know that @value holds a value of @pspec's type.
+ */
+gboolean
+_g_param_value_validate (GParamSpec *pspec,
+                         GValue     *value)
+{
+  if (param_spec_is_fast_numeric (pspec))
+    return param_value_validate_numeric (pspec, value);
+
   if (G_PARAM_SPEC_GET_CLASS (pspec)->value_validate)
     {
       GValue oval = *value;
@@ -757,6 +929,9 @@ g_param_values_cmp (GParamSpec   *pspec,
   g_return_val_if_fail (PSPEC_APPLIES_TO_VALUE (pspec, value1), 0);
   g_return_val_if_fail (PSPEC_APPLIES_TO_VALUE (pspec, value2), 0);
 
+  if (param_spec_is_fast_numeric (pspec))
+    return param_values_cmp_numeric (pspec, value1, value2);
+
   cmp = G_PARAM_SPEC_GET_CLASS (pspec)->values_cmp (pspec, value1, value2);
 
   return CLAMP (cmp, -1, 1);
@@ -134,8 +134,16 @@ typedef struct _SignalKey    SignalKey;
 typedef struct _Emission     Emission;
 typedef struct _Handler      Handler;
 typedef struct _HandlerList  HandlerList;
+typedef struct _HandlerLink  HandlerLink;
+typedef struct _HandlerIndex HandlerIndex;
 typedef struct _HandlerMatch HandlerMatch;
 typedef enum
+{
+  HANDLER_VA_PLAN_UNKNOWN,
+  HANDLER_VA_PLAN_SUPPORTED,
+  HANDLER_VA_PLAN_UNSUPPORTED
+} HandlerVaPlan;
+typedef enum
 {
   EMISSION_STOP,
   EMISSION_RUN,
@@ -232,6 +240,7 @@ struct _SignalNode
   guint              n_params : 8;
   guint              single_va_closure_is_valid : 1;
   guint              single_va_closure_is_after : 1;
+  guint              multi_va_closures_ok : 1;
   GType		    *param_types; /* mangled with G_SIGNAL_TYPE_STATIC_SCOPE flag */
   GType		     return_type; /* mangled with G_SIGNAL_TYPE_STATIC_SCOPE flag */
   GBSearchArray     *class_closure_bsa;
@@ -241,8 +250,14 @@ struct _SignalNode
   GHookList         *emission_hooks;
 
   GClosure *single_va_closure;
+
+  /* atomic: number of handlers connected on any instance, or
+   * NODE_SKIP_EMISSION if there are none and emissions are no-ops */
+  guint handler_count;
 };
 
+#define NODE_SKIP_EMISSION (1u << 31)
+
 #define	SINGLE_VA_CLOSURE_EMPTY_MAGIC GINT_TO_POINTER(1)	/* indicates single_va_closure is valid but empty */
 
 struct _SignalKey
@@ -267,8 +282,29 @@ struct _HandlerList
   Handler *handlers;
   Handler *tail_before;  /* normal signal handlers are appended here  */
   Handler *tail_after;   /* CONNECT_AFTER handlers are appended here  */
+  guint    va_plan;      /* HandlerVaPlan, cached for g_signal_emit_valist() */
+};
+
+struct _HandlerLink
+{
+  Handler *prev;
+  Handler *next;
+};
+
+/* Per-instance lookup of handlers by closure and by closure data, only
+ * built for instances with more than HANDLER_INDEX_MIN_HANDLERS
+ * handlers.  Each table maps to the first handler of a chain linked
+ * through the handlers' closure_link or data_link.
+ */
+struct _HandlerIndex
+{
+  guint       n_handlers;
+  GHashTable *closures;
+  GHashTable *data;
 };
 
+#define HANDLER_INDEX_MIN_HANDLERS 8
+
 struct _Handler
 {
   gulong        sequential_number;
@@ -281,8 +317,11 @@ struct _Handler
 #define HANDLER_MAX_BLOCK_COUNT (1 << 16)
   guint         after : 1;
   guint         has_invalid_closure_notify : 1;
+  guint         in_index : 1;
   GClosure     *closure;
   gpointer      instance;
+  HandlerLink   closure_link;
+  HandlerLink   data_link;
 };
 struct _HandlerMatch
 {
@@ -315,19 +354,72 @@ static GBSearchConfig g_class_closure_bconfig = {
   class_closures_cmp,
   0,
 };
-static GHashTable    *g_handler_list_bsa_ht = NULL;
-static Emission      *g_emissions = NULL;
-static gulong         g_handler_sequential_number = 1;
-static GHashTable    *g_handlers = NULL;
+static volatile gsize  g_handler_sequential_number = 1;
 
 G_LOCK_DEFINE_STATIC (g_signal_mutex);
 #define	SIGNAL_LOCK()		G_LOCK (g_signal_mutex)
 #define	SIGNAL_UNLOCK()		G_UNLOCK (g_signal_mutex)
 
+/* Handlers and emissions are kept per instance, in shards that each
+ * have their own lock, so that threads connecting to and emitting on
+ * unrelated instances don't contend.  g_signal_mutex keeps protecting
+ * the signal nodes; code needing both always takes it first.
+ */
+typedef struct
+{
+  GMutex      mutex;
+  gboolean    signal_locked;    /* the holder also holds g_signal_mutex */
+  GHashTable *handler_lists;    /* instance -> GBSearchArray of HandlerList */
+  GHashTable *handler_indexes;  /* instance -> HandlerIndex */
+  GHashTable *handlers;         /* Handler by instance and sequential number */
+  Emission   *emissions;
+} HandlerShard;
+
+#define HANDLER_SHARD_COUNT 32
+
+static HandlerShard   g_handler_shards[HANDLER_SHARD_COUNT];
+
+static inline HandlerShard*
+handler_shard (gconstpointer instance)
+{
+  gsize h = GPOINTER_TO_SIZE (instance);
+
+  h ^= h >> 12;
+
+  return &g_handler_shards[(h >> 4) % HANDLER_SHARD_COUNT];
+}
+
+#define	HANDLERS_LOCK(instance)		g_mutex_lock (&handler_shard (instance)->mutex)
+#define	HANDLERS_UNLOCK(instance)	g_mutex_unlock (&handler_shard (instance)->mutex)
+#define	EMISSION_LOCK(instance)		emission_lock (instance)
+#define	EMISSION_UNLOCK(instance)	emission_unlock (instance)
+
+static inline void
+emission_lock (gconstpointer instance)
+{
+  HandlerShard *shard = handler_shard (instance);
+
+  SIGNAL_LOCK ();
+  g_mutex_lock (&shard->mutex);
+  shard->signal_locked = TRUE;
+}
+
+static inline void
+emission_unlock (gconstpointer instance)
+{
+  HandlerShard *shard = handler_shard (instance);
+
+  shard->signal_locked = FALSE;
+  g_mutex_unlock (&shard->mutex);
+  SIGNAL_UNLOCK ();
+}
+
 
 /* --- signal nodes --- */
 static guint          g_n_signal_nodes = 0;
+static guint          g_n_signal_nodes_alloced = 0;
 static SignalNode   **g_signal_nodes = NULL;
+static GSList        *g_retired_signal_nodes = NULL;
 
 static inline SignalNode*
 LOOKUP_SIGNAL_NODE (guint signal_id)
@@ -338,6 +430,44 @@ LOOKUP_SIGNAL_NODE (guint signal_id)
     return NULL;
 }
 
+/* Signal nodes are never freed and the node array is only ever grown,
+ * with retired arrays kept alive, so the lookup is safe without the
+ * signal lock.  The count is published after the array.
+ */
+static inline SignalNode*
+LOOKUP_SIGNAL_NODE_UNLOCKED (guint signal_id)
+{
+  SignalNode **nodes;
+
+  if (signal_id >= (guint) g_atomic_int_get (&g_n_signal_nodes))
+    return NULL;
+
+  nodes = g_atomic_pointer_get (&g_signal_nodes);
+
+  return nodes[signal_id];
+}
+
+static void
+signal_nodes_append (SignalNode *node)
+{
+  if (g_n_signal_nodes == g_n_signal_nodes_alloced)
+    {
+      SignalNode **nodes;
+
+      g_n_signal_nodes_alloced = MAX (g_n_signal_nodes_alloced * 2, 64);
+      nodes = g_new (SignalNode*, g_n_signal_nodes_alloced);
+      if (g_signal_nodes)
+        {
+          memcpy (nodes, g_signal_nodes, sizeof (SignalNode*) * g_n_signal_nodes);
+          g_retired_signal_nodes = g_slist_prepend (g_retired_signal_nodes, g_signal_nodes);
+        }
+      g_atomic_pointer_set (&g_signal_nodes, nodes);
+    }
+
+  g_signal_nodes[g_n_signal_nodes] = node;
+  g_atomic_int_set (&g_n_signal_nodes, g_n_signal_nodes + 1);
+}
+
 
 /* --- functions --- */
 static inline guint
@@ -407,18 +537,20 @@ static inline HandlerList*
 handler_list_ensure (guint    signal_id,
 		     gpointer instance)
 {
-  GBSearchArray *hlbsa = g_hash_table_lookup (g_handler_list_bsa_ht, instance);
+  HandlerShard *shard = handler_shard (instance);
+  GBSearchArray *hlbsa = g_hash_table_lookup (shard->handler_lists, instance);
   HandlerList key;
   
   key.signal_id = signal_id;
   key.handlers    = NULL;
   key.tail_before = NULL;
   key.tail_after  = NULL;
+  key.va_plan     = HANDLER_VA_PLAN_UNKNOWN;
   if (!hlbsa)
     {
       hlbsa = g_bsearch_array_create (&g_signal_hlbsa_bconfig);
       hlbsa = g_bsearch_array_insert (hlbsa, &g_signal_hlbsa_bconfig, &key);
-      g_hash_table_insert (g_handler_list_bsa_ht, instance, hlbsa);
+      g_hash_table_insert (shard->handler_lists, instance, hlbsa);
     }
   else
     {
@@ -426,7 +558,7 @@ handler_list_ensure (guint    signal_id,
 
       hlbsa = g_bsearch_array_insert (o, &g_signal_hlbsa_bconfig, &key);
       if (hlbsa != o)
-	g_hash_table_insert (g_handler_list_bsa_ht, instance, hlbsa);
+	g_hash_table_insert (shard->handler_lists, instance, hlbsa);
     }
   return g_bsearch_array_lookup (hlbsa, &g_signal_hlbsa_bconfig, &key);
 }
@@ -435,7 +567,7 @@ static inline HandlerList*
 handler_list_lookup (guint    signal_id,
 		     gpointer instance)
 {
-  GBSearchArray *hlbsa = g_hash_table_lookup (g_handler_list_bsa_ht, instance);
+  GBSearchArray *hlbsa = g_hash_table_lookup (handler_shard (instance)->handler_lists, instance);
   HandlerList key;
   
   key.signal_id = signal_id;
@@ -443,6 +575,123 @@ handler_list_lookup (guint    signal_id,
   return hlbsa ? g_bsearch_array_lookup (hlbsa, &g_signal_hlbsa_bconfig, &key) : NULL;
 }
 
+#define HANDLER_LINK(handler, link_offset) \
+  ((HandlerLink*) G_STRUCT_MEMBER_P ((handler), (link_offset)))
+
+static void
+handler_chain_insert (GHashTable *table,
+                      gpointer    key,
+                      Handler    *handler,
+                      glong       link_offset)
+{
+  Handler *head = g_hash_table_lookup (table, key);
+  HandlerLink *link = HANDLER_LINK (handler, link_offset);
+
+  link->prev = NULL;
+  link->next = head;
+  if (head)
+    HANDLER_LINK (head, link_offset)->prev = handler;
+  g_hash_table_insert (table, key, handler);
+}
+
+static void
+handler_chain_remove (GHashTable *table,
+                      gpointer    key,
+                      Handler    *handler,
+                      glong       link_offset)
+{
+  HandlerLink *link = HANDLER_LINK (handler, link_offset);
+
+  if (link->next)
+    HANDLER_LINK (link->next, link_offset)->prev = link->prev;
+  if (link->prev)
+    HANDLER_LINK (link->prev, link_offset)->next = link->next;
+  else if (link->next)
+    g_hash_table_insert (table, key, link->next);
+  else
+    g_hash_table_remove (table, key);
+}
+
+static void
+handler_index_link (HandlerIndex *hindex,
+                    Handler      *handler)
+{
+  handler_chain_insert (hindex->closures, handler->closure, handler,
+                        G_STRUCT_OFFSET (Handler, closure_link));
+  handler_chain_insert (hindex->data, handler->closure->data, handler,
+                        G_STRUCT_OFFSET (Handler, data_link));
+}
+
+static void
+handler_index_add (Handler *handler)
+{
+  HandlerShard *shard = handler_shard (handler->instance);
+  HandlerIndex *hindex = g_hash_table_lookup (shard->handler_indexes, handler->instance);
+
+  if (!hindex)
+    {
+      hindex = g_slice_new0 (HandlerIndex);
+      g_hash_table_insert (shard->handler_indexes, handler->instance, hindex);
+    }
+
+  handler->in_index = TRUE;
+  hindex->n_handlers++;
+
+  if (hindex->closures)
+    handler_index_link (hindex, handler);
+  else if (hindex->n_handlers > HANDLER_INDEX_MIN_HANDLERS)
+    {
+      GBSearchArray *hlbsa = g_hash_table_lookup (shard->handler_lists, handler->instance);
+      guint i;
+
+      hindex->closures = g_hash_table_new (g_direct_hash, NULL);
+      hindex->data = g_hash_table_new (g_direct_hash, NULL);
+
+      for (i = 0; i < hlbsa->n_nodes; i++)
+        {
+          HandlerList *hlist = g_bsearch_array_get_nth (hlbsa, &g_signal_hlbsa_bconfig, i);
+          Handler *l;
+
+          for (l = hlist->handlers; l; l = l->next)
+            handler_index_link (hindex, l);
+        }
+    }
+}
+
+static void
+handler_index_free (HandlerIndex *hindex)
+{
+  if (hindex->closures)
+    {
+      g_hash_table_unref (hindex->closures);
+      g_hash_table_unref (hindex->data);
+    }
+  g_slice_free (HandlerIndex, hindex);
+}
+
+static void
+handler_index_remove (Handler *handler)
+{
+  HandlerShard *shard = handler_shard (handler->instance);
+  HandlerIndex *hindex = g_hash_table_lookup (shard->handler_indexes, handler->instance);
+
+  handler->in_index = FALSE;
+
+  if (hindex->closures)
+    {
+      handler_chain_remove (hindex->closures, handler->closure, handler,
+                            G_STRUCT_OFFSET (Handler, closure_link));
+      handler_chain_remove (hindex->data, handler->closure->data, handler,
+                            G_STRUCT_OFFSET (Handler, data_link));
+    }
+
+  if (--hindex->n_handlers == 0)
+    {
+      g_hash_table_remove (shard->handler_indexes, handler->instance);
+      handler_index_free (hindex);
+    }
+}
+
 static guint
 handler_hash (gconstpointer key)
 {
@@ -464,6 +713,7 @@ handler_lookup (gpointer  instance,
 		GClosure *closure,
 		guint    *signal_id_p)
 {
+  HandlerShard *shard = handler_shard (instance);
   GBSearchArray *hlbsa;
 
   if (handler_id)
@@ -471,11 +721,26 @@ handler_lookup (gpointer  instance,
       Handler key;
       key.sequential_number = handler_id;
       key.instance = instance;
-      return g_hash_table_lookup (g_handlers, &key);
+      return g_hash_table_lookup (shard->handlers, &key);
+
+    }
 
+  if (closure)
+    {
+      HandlerIndex *hindex = g_hash_table_lookup (shard->handler_indexes, instance);
+
+      if (hindex && hindex->closures)
+        {
+          Handler *handler = g_hash_table_lookup (hindex->closures, closure);
+
+          if (handler && signal_id_p)
+            *signal_id_p = handler->signal_id;
+
+          return handler;
+        }
     }
 
-  hlbsa = g_hash_table_lookup (g_handler_list_bsa_ht, instance);
+  hlbsa = g_hash_table_lookup (shard->handler_lists, instance);
   
   if (hlbsa)
     {
@@ -537,9 +802,59 @@ handlers_find (gpointer         instance,
 	       gpointer         data,
 	       gboolean         one_and_only)
 {
+  HandlerShard *shard = handler_shard (instance);
   HandlerMatch *mlist = NULL;
+  HandlerIndex *hindex = NULL;
+
+  if (mask & (G_SIGNAL_MATCH_CLOSURE | G_SIGNAL_MATCH_DATA))
+    hindex = g_hash_table_lookup (shard->handler_indexes, instance);
   
-  if (mask & G_SIGNAL_MATCH_ID)
+  if (hindex && hindex->closures)
+    {
+      Handler *handler;
+      glong link_offset;
+
+      /* only walk the handlers sharing the closure or data */
+      if (mask & G_SIGNAL_MATCH_CLOSURE)
+        {
+          handler = g_hash_table_lookup (hindex->closures, closure);
+          link_offset = G_STRUCT_OFFSET (Handler, closure_link);
+        }
+      else
+        {
+          handler = g_hash_table_lookup (hindex->data, data);
+          link_offset = G_STRUCT_OFFSET (Handler, data_link);
+        }
+
+      mask = ~mask;
+      for (; handler; handler = HANDLER_LINK (handler, link_offset)->next)
+        {
+          SignalNode *node = NULL;
+
+          if (!(mask & G_SIGNAL_MATCH_FUNC))
+            {
+              node = LOOKUP_SIGNAL_NODE_UNLOCKED (handler->signal_id);
+              if (!node->c_marshaller)
+                continue;
+            }
+
+          if (handler->sequential_number &&
+              ((mask & G_SIGNAL_MATCH_ID) || handler->signal_id == signal_id) &&
+              ((mask & G_SIGNAL_MATCH_DETAIL) || handler->detail == detail) &&
+              ((mask & G_SIGNAL_MATCH_CLOSURE) || handler->closure == closure) &&
+              ((mask & G_SIGNAL_MATCH_DATA) || handler->closure->data == data) &&
+              ((mask & G_SIGNAL_MATCH_UNBLOCKED) || handler->block_count == 0) &&
+              ((mask & G_SIGNAL_MATCH_FUNC) || (handler->closure->marshal == node->c_marshaller &&
+                                                G_REAL_CLOSURE (handler->closure)->meta_marshal == NULL &&
+                                                ((GCClosure*) handler->closure)->callback == func)))
+            {
+              mlist = handler_match_prepend (mlist, handler, handler->signal_id);
+              if (one_and_only)
+                return mlist;
+            }
+        }
+    }
+  else if (mask & G_SIGNAL_MATCH_ID)
     {
       HandlerList *hlist = handler_list_lookup (signal_id, instance);
       Handler *handler;
@@ -547,7 +862,7 @@ handlers_find (gpointer         instance,
       
       if (mask & G_SIGNAL_MATCH_FUNC)
 	{
-	  node = LOOKUP_SIGNAL_NODE (signal_id);
+	  node = LOOKUP_SIGNAL_NODE_UNLOCKED (signal_id);
 	  if (!node || !node->c_marshaller)
 	    return NULL;
 	}
@@ -570,7 +885,7 @@ handlers_find (gpointer         instance,
     }
   else
     {
-      GBSearchArray *hlbsa = g_hash_table_lookup (g_handler_list_bsa_ht, instance);
+      GBSearchArray *hlbsa = g_hash_table_lookup (shard->handler_lists, instance);
       
       mask = ~mask;
       if (hlbsa)
@@ -585,7 +900,7 @@ handlers_find (gpointer         instance,
               
 	      if (!(mask & G_SIGNAL_MATCH_FUNC))
 		{
-		  node = LOOKUP_SIGNAL_NODE (hlist->signal_id);
+		  node = LOOKUP_SIGNAL_NODE_UNLOCKED (hlist->signal_id);
 		  if (!node->c_marshaller)
 		    continue;
 		}
@@ -611,16 +926,29 @@ handlers_find (gpointer         instance,
   return mlist;
 }
 
+static inline void
+node_handler_count_inc (SignalNode *node)
+{
+  guint count;
+
+  /* clears NODE_SKIP_EMISSION along with counting the handler */
+  do
+    count = g_atomic_int_get (&node->handler_count);
+  while (!g_atomic_int_compare_and_exchange (&node->handler_count, count,
+                                             (count & ~NODE_SKIP_EMISSION) + 1));
+}
+
 static inline Handler*
 handler_new (guint signal_id, gpointer instance, gboolean after)
 {
   Handler *handler = g_slice_new (Handler);
+
+  handler->sequential_number = (gulong) g_atomic_pointer_add (&g_handler_sequential_number, 1);
 #ifndef G_DISABLE_CHECKS
-  if (g_handler_sequential_number < 1)
+  if (handler->sequential_number < 1)
     g_error (G_STRLOC ": handler id overflow, %s", REPORT_BUG);
 #endif
   
-  handler->sequential_number = g_handler_sequential_number++;
   handler->prev = NULL;
   handler->next = NULL;
   handler->detail = 0;
@@ -631,8 +959,9 @@ handler_new (guint signal_id, gpointer instance, gboolean after)
   handler->after = after != FALSE;
   handler->closure = NULL;
   handler->has_invalid_closure_notify = 0;
+  handler->in_index = 0;
 
-  g_hash_table_add (g_handlers, handler);
+  g_hash_table_add (handler_shard (instance)->handlers, handler);
   
   return handler;
 }
@@ -656,7 +985,13 @@ handler_unref_R (guint    signal_id,
 
   if (G_UNLIKELY (handler->ref_count == 0))
     {
+      SignalNode *node = LOOKUP_SIGNAL_NODE_UNLOCKED (handler->signal_id);
+      HandlerShard *shard = handler_shard (handler->instance);
       HandlerList *hlist = NULL;
+      gboolean signal_locked;
+
+      /* the skip flag is only ever set while no handlers are connected */
+      g_atomic_int_add (&node->handler_count, -1);
 
       if (handler->next)
         handler->next->prev = handler->prev;
@@ -669,6 +1004,9 @@ handler_unref_R (guint    signal_id,
           hlist->handlers = handler->next;
         }
 
+      if (handler->in_index)
+        handler_index_remove (handler);
+
       if (instance)
         {
           /*  check if we are removing the handler pointed to by tail_before  */
@@ -696,9 +1034,17 @@ handler_unref_R (guint    signal_id,
             }
         }
 
-      SIGNAL_UNLOCK ();
+      /* drop whatever signal locks our caller holds */
+      signal_locked = shard->signal_locked;
+      if (signal_locked)
+        EMISSION_UNLOCK (handler->instance);
+      else
+        HANDLERS_UNLOCK (handler->instance);
       g_closure_unref (handler->closure);
-      SIGNAL_LOCK ();
+      if (signal_locked)
+        EMISSION_LOCK (handler->instance);
+      else
+        HANDLERS_LOCK (handler->instance);
       g_slice_free (Handler, handler);
     }
 }
@@ -708,11 +1054,15 @@ handler_insert (guint    signal_id,
 		gpointer instance,
 		Handler  *handler)
 {
+  SignalNode *node = LOOKUP_SIGNAL_NODE_UNLOCKED (signal_id);
   HandlerList *hlist;
   
   g_assert (handler->prev == NULL && handler->next == NULL); /* paranoid */
+
+  node_handler_count_inc (node);
   
   hlist = handler_list_ensure (signal_id, instance);
+  hlist->va_plan = HANDLER_VA_PLAN_UNKNOWN;
   if (!hlist->handlers)
     {
       hlist->handlers = handler;
@@ -746,6 +1096,60 @@ handler_insert (guint    signal_id,
 
   if (!handler->next)
     hlist->tail_after = handler;
+
+  handler_index_add (handler);
+}
+
+static inline void
+node_invalidate_single_va_closure (SignalNode *node)
+{
+  node->single_va_closure_is_valid = FALSE;
+  g_atomic_int_and (&node->handler_count, ~NODE_SKIP_EMISSION);
+}
+
+/* Called with the signal lock held once an emission found nothing to
+ * run; later emissions skip the locks until a handler is connected or
+ * the node changes.
+ */
+static inline void
+node_try_skip_emission (SignalNode *node)
+{
+  if (node->single_va_closure == SINGLE_VA_CLOSURE_EMPTY_MAGIC &&
+      node->return_type == G_TYPE_NONE)
+    g_atomic_int_compare_and_exchange (&node->handler_count, 0, NODE_SKIP_EMISSION);
+}
+
+/* Whether a parameter can be passed to several va closures in a row
+ * without holding a reference to it the way a collected GValue would;
+ * objects are referenced explicitly for the duration of the emission.
+ */
+static gboolean
+va_param_is_simple (GType param_type)
+{
+  if (param_type & G_SIGNAL_TYPE_STATIC_SCOPE)
+    return TRUE;
+
+  switch (G_TYPE_FUNDAMENTAL (param_type))
+    {
+    case G_TYPE_CHAR:
+    case G_TYPE_UCHAR:
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_LONG:
+    case G_TYPE_ULONG:
+    case G_TYPE_INT64:
+    case G_TYPE_UINT64:
+    case G_TYPE_ENUM:
+    case G_TYPE_FLAGS:
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+    case G_TYPE_POINTER:
+    case G_TYPE_OBJECT:
+      return TRUE;
+    default:
+      return FALSE;
+    }
 }
 
 static void
@@ -787,27 +1191,49 @@ node_update_single_va_closure (SignalNode *node)
   node->single_va_closure_is_valid = TRUE;
   node->single_va_closure = closure;
   node->single_va_closure_is_after = is_after;
+
+  /* Running several va closures for one emission (see
+   * g_signal_emit_valist()) additionally needs the arguments to stay
+   * valid without GValue copies, and no accumulator or restarts.
+   */
+  node->multi_va_closures_ok = FALSE;
+  if (closure != NULL &&
+      node->accumulator == NULL &&
+      (node->flags & G_SIGNAL_NO_RECURSE) == 0)
+    {
+      guint i;
+
+      for (i = 0; i < node->n_params; i++)
+        if (!va_param_is_simple (node->param_types[i]))
+          break;
+      node->multi_va_closures_ok = i == node->n_params;
+    }
+
+  node_try_skip_emission (node);
 }
 
 static inline void
 emission_push (Emission  *emission)
 {
-  emission->next = g_emissions;
-  g_emissions = emission;
+  HandlerShard *shard = handler_shard (emission->instance);
+
+  emission->next = shard->emissions;
+  shard->emissions = emission;
 }
 
 static inline void
 emission_pop (Emission  *emission)
 {
+  HandlerShard *shard = handler_shard (emission->instance);
   Emission *node, *last = NULL;
 
-  for (node = g_emissions; node; last = node, node = last->next)
+  for (node = shard->emissions; node; last = node, node = last->next)
     if (node == emission)
       {
 	if (last)
 	  last->next = node->next;
 	else
-	  g_emissions = node->next;
+	  shard->emissions = node->next;
 	return;
       }
   g_assert_not_reached ();
@@ -820,7 +1246,7 @@ emission_find (guint     signal_id,
 {
   Emission *emission;
   
-  for (emission = g_emissions; emission; emission = emission->next)
+  for (emission = handler_shard (instance)->emissions; emission; emission = emission->next)
     if (emission->instance == instance &&
 	emission->ihint.signal_id == signal_id &&
 	emission->ihint.detail == detail)
@@ -833,7 +1259,7 @@ emission_find_innermost (gpointer instance)
 {
   Emission *emission;
   
-  for (emission = g_emissions; emission; emission = emission->next)
+  for (emission = handler_shard (instance)->emissions; emission; emission = emission->next)
     if (emission->instance == instance)
       return emission;
 
@@ -858,15 +1284,22 @@ _g_signal_init (void)
   SIGNAL_LOCK ();
   if (!g_n_signal_nodes)
     {
+      guint i;
+
       /* setup handler list binary searchable array hash table (in german, that'd be one word ;) */
-      g_handler_list_bsa_ht = g_hash_table_new (g_direct_hash, NULL);
+      for (i = 0; i < HANDLER_SHARD_COUNT; i++)
+        {
+          HandlerShard *shard = &g_handler_shards[i];
+
+          g_mutex_init (&shard->mutex);
+          shard->handler_lists = g_hash_table_new (g_direct_hash, NULL);
+          shard->handler_indexes = g_hash_table_new (g_direct_hash, NULL);
+          shard->handlers = g_hash_table_new (handler_hash, handler_equal);
+        }
       g_signal_key_bsa = g_bsearch_array_create (&g_signal_key_bconfig);
       
       /* invalid (0) signal_id */
-      g_n_signal_nodes = 1;
-      g_signal_nodes = g_renew (SignalNode*, g_signal_nodes, g_n_signal_nodes);
-      g_signal_nodes[0] = NULL;
-      g_handlers = g_hash_table_new (handler_hash, handler_equal);
+      signal_nodes_append (NULL);
     }
   SIGNAL_UNLOCK ();
 }
@@ -918,12 +1351,12 @@ g_signal_stop_emission (gpointer instance,
   g_return_if_fail (G_TYPE_CHECK_INSTANCE (instance));
   g_return_if_fail (signal_id > 0);
   
-  SIGNAL_LOCK ();
+  EMISSION_LOCK (instance);
   node = LOOKUP_SIGNAL_NODE (signal_id);
   if (node && detail && !(node->flags & G_SIGNAL_DETAILED))
     {
       g_warning ("%s: signal id '%u' does not support detail (%u)", G_STRLOC, signal_id, detail);
-      SIGNAL_UNLOCK ();
+      EMISSION_UNLOCK (instance);
       return;
     }
   if (node && g_type_is_a (G_TYPE_FROM_INSTANCE (instance), node->itype))
@@ -944,7 +1377,7 @@ g_signal_stop_emission (gpointer instance,
     }
   else
     g_warning ("%s: signal id '%u' is invalid for instance '%p'", G_STRLOC, signal_id, instance);
-  SIGNAL_UNLOCK ();
+  EMISSION_UNLOCK (instance);
 }
 
 static void
@@ -1011,7 +1444,7 @@ g_signal_add_emission_hook (guint               signal_id,
       SIGNAL_UNLOCK ();
       return 0;
     }
-    node->single_va_closure_is_valid = FALSE;
+    node_invalidate_single_va_closure (node);
   if (!node->emission_hooks)
     {
       node->emission_hooks = g_new (GHookList, 1);
@@ -1063,7 +1496,7 @@ g_signal_remove_emission_hook (guint  signal_id,
   else if (!node->emission_hooks || !g_hook_destroy (node->emission_hooks, hook_id))
     g_warning ("%s: signal \"%s\" had no hook (%lu) to remove", G_STRLOC, node->name, hook_id);
 
-  node->single_va_closure_is_valid = FALSE;
+  node_invalidate_single_va_closure (node);
 
  out:
   SIGNAL_UNLOCK ();
@@ -1178,7 +1611,7 @@ g_signal_stop_emission_by_name (gpointer     instance,
   g_return_if_fail (G_TYPE_CHECK_INSTANCE (instance));
   g_return_if_fail (detailed_signal != NULL);
   
-  SIGNAL_LOCK ();
+  EMISSION_LOCK (instance);
   itype = G_TYPE_FROM_INSTANCE (instance);
   signal_id = signal_parse_name (detailed_signal, itype, &detail, TRUE);
   if (signal_id)
@@ -1210,7 +1643,7 @@ g_signal_stop_emission_by_name (gpointer     instance,
   else
     g_warning ("%s: signal '%s' is invalid for instance '%p' of type '%s'",
                G_STRLOC, detailed_signal, instance, g_type_name (itype));
-  SIGNAL_UNLOCK ();
+  EMISSION_UNLOCK (instance);
 }
 
 /**
@@ -1564,7 +1997,7 @@ signal_add_class_closure (SignalNode *node,
 {
   ClassClosure key;
 
-  node->single_va_closure_is_valid = FALSE;
+  node_invalidate_single_va_closure (node);
 
   if (!node->class_closure_bsa)
     node->class_closure_bsa = g_bsearch_array_create (&g_class_closure_bconfig);
@@ -1700,11 +2133,10 @@ g_signal_newv (const gchar       *signal_name,
     {
       SignalKey key;
       
-      signal_id = g_n_signal_nodes++;
-      node = g_new (SignalNode, 1);
+      signal_id = g_n_signal_nodes;
+      node = g_new0 (SignalNode, 1);
       node->signal_id = signal_id;
-      g_signal_nodes = g_renew (SignalNode*, g_signal_nodes, g_n_signal_nodes);
-      g_signal_nodes[signal_id] = node;
+      signal_nodes_append (node);
       node->itype = itype;
       node->name = name;
       key.itype = itype;
@@ -1721,7 +2153,7 @@ g_signal_newv (const gchar       *signal_name,
   node->destroyed = FALSE;
 
   /* setup reinitializable portion */
-  node->single_va_closure_is_valid = FALSE;
+  node_invalidate_single_va_closure (node);
   node->flags = signal_flags & G_SIGNAL_FLAGS_MASK;
   node->n_params = n_params;
   node->param_types = g_memdup (param_types, sizeof (GType) * n_params);
@@ -1785,7 +2217,9 @@ g_signal_newv (const gchar       *signal_name,
       else
 	{
 	  c_marshaller = g_cclosure_marshal_generic;
-	  va_marshaller = g_cclosure_marshal_generic_va;
+	  va_marshaller = _g_cclosure_get_direct_va_marshaller (return_type, n_params, param_types);
+	  if (va_marshaller == NULL)
+	    va_marshaller = g_cclosure_marshal_generic_va;
 	}
     }
   else
@@ -1839,7 +2273,7 @@ g_signal_set_va_marshaller (guint              signal_id,
 	    _g_closure_set_va_marshal (cc->closure, va_marshaller);
 	}
 
-      node->single_va_closure_is_valid = FALSE;
+      node_invalidate_single_va_closure (node);
     }
 
   SIGNAL_UNLOCK ();
@@ -1915,7 +2349,7 @@ signal_destroy_R (SignalNode *signal_node)
   signal_node->destroyed = TRUE;
   
   /* reentrancy caution, zero out real contents first */
-  signal_node->single_va_closure_is_valid = FALSE;
+  node_invalidate_single_va_closure (signal_node);
   signal_node->n_params = 0;
   signal_node->param_types = NULL;
   signal_node->return_type = 0;
@@ -1929,11 +2363,17 @@ signal_destroy_R (SignalNode *signal_node)
   /* check current emissions */
   {
     Emission *emission;
+    guint i;
     
-    for (emission = g_emissions; emission; emission = emission->next)
-      if (emission->ihint.signal_id == node.signal_id)
-        g_critical (G_STRLOC ": signal \"%s\" being destroyed is currently in emission (instance '%p')",
-                    node.name, emission->instance);
+    for (i = 0; i < HANDLER_SHARD_COUNT; i++)
+      {
+        g_mutex_lock (&g_handler_shards[i].mutex);
+        for (emission = g_handler_shards[i].emissions; emission; emission = emission->next)
+          if (emission->ihint.signal_id == node.signal_id)
+            g_critical (G_STRLOC ": signal \"%s\" being destroyed is currently in emission (instance '%p')",
+                        node.name, emission->instance);
+        g_mutex_unlock (&g_handler_shards[i].mutex);
+      }
   }
 #endif
   
@@ -2070,7 +2510,7 @@ g_signal_chain_from_overridden (const GValue *instance_and_params,
   instance = g_value_peek_pointer (instance_and_params);
   g_return_if_fail (G_TYPE_CHECK_INSTANCE (instance));
   
-  SIGNAL_LOCK ();
+  EMISSION_LOCK (instance);
   emission = emission_find_innermost (instance);
   if (emission)
     {
@@ -2104,16 +2544,16 @@ g_signal_chain_from_overridden (const GValue *instance_and_params,
   if (closure)
     {
       emission->chain_type = chain_type;
-      SIGNAL_UNLOCK ();
+      EMISSION_UNLOCK (instance);
       g_closure_invoke (closure,
 			return_value,
 			n_params + 1,
 			instance_and_params,
 			&emission->ihint);
-      SIGNAL_LOCK ();
+      EMISSION_LOCK (instance);
       emission->chain_type = restore_type;
     }
-  SIGNAL_UNLOCK ();
+  EMISSION_UNLOCK (instance);
 }
 
 /**
@@ -2143,7 +2583,7 @@ g_signal_chain_from_overridden_handler (gpointer instance,
 
   g_return_if_fail (G_TYPE_CHECK_INSTANCE (instance));
 
-  SIGNAL_LOCK ();
+  EMISSION_LOCK (instance);
   emission = emission_find_innermost (instance);
   if (emission)
     {
@@ -2195,7 +2635,7 @@ g_signal_chain_from_overridden_handler (gpointer instance,
           GType ptype = node->param_types[i] & ~G_SIGNAL_TYPE_STATIC_SCOPE;
           gboolean static_scope = node->param_types[i] & G_SIGNAL_TYPE_STATIC_SCOPE;
 
-          SIGNAL_UNLOCK ();
+          EMISSION_UNLOCK (instance);
           G_VALUE_COLLECT_INIT (param_values + i, ptype,
 				var_args,
 				static_scope ? G_VALUE_NOCOPY_CONTENTS : 0,
@@ -2214,16 +2654,16 @@ g_signal_chain_from_overridden_handler (gpointer instance,
               va_end (var_args);
               return;
             }
-          SIGNAL_LOCK ();
+          EMISSION_LOCK (instance);
         }
 
-      SIGNAL_UNLOCK ();
+      EMISSION_UNLOCK (instance);
       instance_and_params->g_type = 0;
       g_value_init_from_instance (instance_and_params, instance);
-      SIGNAL_LOCK ();
+      EMISSION_LOCK (instance);
 
       emission->chain_type = chain_type;
-      SIGNAL_UNLOCK ();
+      EMISSION_UNLOCK (instance);
 
       if (signal_return_type == G_TYPE_NONE)
         {
@@ -2273,10 +2713,10 @@ g_signal_chain_from_overridden_handler (gpointer instance,
 
       va_end (var_args);
 
-      SIGNAL_LOCK ();
+      EMISSION_LOCK (instance);
       emission->chain_type = restore_type;
     }
-  SIGNAL_UNLOCK ();
+  EMISSION_UNLOCK (instance);
 }
 
 /**
@@ -2294,13 +2734,53 @@ g_signal_get_invocation_hint (gpointer instance)
   
   g_return_val_if_fail (G_TYPE_CHECK_INSTANCE (instance), NULL);
 
-  SIGNAL_LOCK ();
+  HANDLERS_LOCK (instance);
   emission = emission_find_innermost (instance);
-  SIGNAL_UNLOCK ();
+  HANDLERS_UNLOCK (instance);
   
   return emission ? &emission->ihint : NULL;
 }
 
+static void
+node_set_closure_marshal (SignalNode *node,
+                          GClosure   *closure)
+{
+  if (node->c_marshaller && G_CLOSURE_NEEDS_MARSHAL (closure))
+    {
+      g_closure_set_marshal (closure, node->c_marshaller);
+      if (node->va_marshaller)
+	_g_closure_set_va_marshal (closure, node->va_marshaller);
+    }
+}
+
+/* Called without the signal lock, once the signal has been checked;
+ * only the instance's handler shard is locked.
+ */
+static gulong
+handler_connect (guint     signal_id,
+                 gpointer  instance,
+                 GQuark    detail,
+                 GClosure *closure,
+                 gboolean  after,
+                 gboolean  notify_invalid)
+{
+  Handler *handler;
+  gulong handler_seq_no;
+
+  HANDLERS_LOCK (instance);
+  handler = handler_new (signal_id, instance, after);
+  handler_seq_no = handler->sequential_number;
+  handler->detail = detail;
+  handler->closure = g_closure_ref (closure);
+  g_closure_sink (closure);
+  if (notify_invalid)
+    add_invalid_closure_notify (handler, instance);
+  handler_insert (signal_id, instance, handler);
+  HANDLERS_UNLOCK (instance);
+
+  return handler_seq_no;
+}
+
 /**
  * g_signal_connect_closure_by_id:
  * @instance: (type GObject.Object): the instance to connect to.
@@ -2338,20 +2818,10 @@ g_signal_connect_closure_by_id (gpointer  instance,
 	g_warning ("%s: signal id '%u' is invalid for instance '%p'", G_STRLOC, signal_id, instance);
       else
 	{
-	  Handler *handler = handler_new (signal_id, instance, after);
-	  
-	  handler_seq_no = handler->sequential_number;
-	  handler->detail = detail;
-	  handler->closure = g_closure_ref (closure);
-	  g_closure_sink (closure);
-	  add_invalid_closure_notify (handler, instance);
-	  handler_insert (signal_id, instance, handler);
-	  if (node->c_marshaller && G_CLOSURE_NEEDS_MARSHAL (closure))
-	    {
-	      g_closure_set_marshal (closure, node->c_marshaller);
-	      if (node->va_marshaller)
-		_g_closure_set_va_marshal (closure, node->va_marshaller);
-	    }
+	  node_set_closure_marshal (node, closure);
+	  SIGNAL_UNLOCK ();
+
+	  return handler_connect (signal_id, instance, detail, closure, after, TRUE);
 	}
     }
   else
@@ -2402,20 +2872,10 @@ g_signal_connect_closure (gpointer     instance,
                    G_STRLOC, detailed_signal, instance, g_type_name (itype));
       else
 	{
-	  Handler *handler = handler_new (signal_id, instance, after);
-
-	  handler_seq_no = handler->sequential_number;
-	  handler->detail = detail;
-	  handler->closure = g_closure_ref (closure);
-	  g_closure_sink (closure);
-	  add_invalid_closure_notify (handler, instance);
-	  handler_insert (signal_id, instance, handler);
-	  if (node->c_marshaller && G_CLOSURE_NEEDS_MARSHAL (handler->closure))
-	    {
-	      g_closure_set_marshal (handler->closure, node->c_marshaller);
-	      if (node->va_marshaller)
-		_g_closure_set_va_marshal (handler->closure, node->va_marshaller);
-	    }
+	  node_set_closure_marshal (node, closure);
+	  SIGNAL_UNLOCK ();
+
+	  return handler_connect (signal_id, instance, detail, closure, after, TRUE);
 	}
     }
   else
@@ -2503,19 +2963,12 @@ g_signal_connect_data (gpointer       instance,
                    G_STRLOC, detailed_signal, instance, g_type_name (itype));
       else
 	{
-	  Handler *handler = handler_new (signal_id, instance, after);
-
-	  handler_seq_no = handler->sequential_number;
-	  handler->detail = detail;
-	  handler->closure = g_closure_ref ((swapped ? g_cclosure_new_swap : g_cclosure_new) (c_handler, data, destroy_data));
-	  g_closure_sink (handler->closure);
-	  handler_insert (signal_id, instance, handler);
-	  if (node->c_marshaller && G_CLOSURE_NEEDS_MARSHAL (handler->closure))
-	    {
-	      g_closure_set_marshal (handler->closure, node->c_marshaller);
-	      if (node->va_marshaller)
-		_g_closure_set_va_marshal (handler->closure, node->va_marshaller);
-	    }
+	  GClosure *closure = (swapped ? g_cclosure_new_swap : g_cclosure_new) (c_handler, data, destroy_data);
+
+	  node_set_closure_marshal (node, closure);
+	  SIGNAL_UNLOCK ();
+
+	  return handler_connect (signal_id, instance, detail, closure, after, FALSE);
         }
     }
   else
@@ -2549,7 +3002,7 @@ g_signal_handler_block (gpointer instance,
   g_return_if_fail (G_TYPE_CHECK_INSTANCE (instance));
   g_return_if_fail (handler_id > 0);
   
-  SIGNAL_LOCK ();
+  HANDLERS_LOCK (instance);
   handler = handler_lookup (instance, handler_id, NULL, NULL);
   if (handler)
     {
@@ -2561,7 +3014,7 @@ g_signal_handler_block (gpointer instance,
     }
   else
     g_warning ("%s: instance '%p' has no handler with id '%lu'", G_STRLOC, instance, handler_id);
-  SIGNAL_UNLOCK ();
+  HANDLERS_UNLOCK (instance);
 }
 
 /**
@@ -2592,7 +3045,7 @@ g_signal_handler_unblock (gpointer instance,
   g_return_if_fail (G_TYPE_CHECK_INSTANCE (instance));
   g_return_if_fail (handler_id > 0);
   
-  SIGNAL_LOCK ();
+  HANDLERS_LOCK (instance);
   handler = handler_lookup (instance, handler_id, NULL, NULL);
   if (handler)
     {
@@ -2603,7 +3056,7 @@ g_signal_handler_unblock (gpointer instance,
     }
   else
     g_warning ("%s: instance '%p' has no handler with id '%lu'", G_STRLOC, instance, handler_id);
-  SIGNAL_UNLOCK ();
+  HANDLERS_UNLOCK (instance);
 }
 
 /**
@@ -2627,11 +3080,11 @@ g_signal_handler_disconnect (gpointer instance,
   g_return_if_fail (G_TYPE_CHECK_INSTANCE (instance));
   g_return_if_fail (handler_id > 0);
   
-  SIGNAL_LOCK ();
+  HANDLERS_LOCK (instance);
   handler = handler_lookup (instance, handler_id, 0, 0);
   if (handler)
     {
-      g_hash_table_remove (g_handlers, handler);
+      g_hash_table_remove (handler_shard (instance)->handlers, handler);
       handler->sequential_number = 0;
       handler->block_count = 1;
       remove_invalid_closure_notify (handler, instance);
@@ -2639,7 +3092,7 @@ g_signal_handler_disconnect (gpointer instance,
     }
   else
     g_warning ("%s: instance '%p' has no handler with id '%lu'", G_STRLOC, instance, handler_id);
-  SIGNAL_UNLOCK ();
+  HANDLERS_UNLOCK (instance);
 }
 
 /**
@@ -2660,10 +3113,10 @@ g_signal_handler_is_connected (gpointer instance,
 
   g_return_val_if_fail (G_TYPE_CHECK_INSTANCE (instance), FALSE);
 
-  SIGNAL_LOCK ();
+  HANDLERS_LOCK (instance);
   handler = handler_lookup (instance, handler_id, NULL, NULL);
   connected = handler != NULL;
-  SIGNAL_UNLOCK ();
+  HANDLERS_UNLOCK (instance);
 
   return connected;
 }
@@ -2679,18 +3132,23 @@ g_signal_handler_is_connected (gpointer instance,
 void
 g_signal_handlers_destroy (gpointer instance)
 {
+  HandlerShard *shard;
   GBSearchArray *hlbsa;
+  HandlerIndex *hindex;
   
   g_return_if_fail (G_TYPE_CHECK_INSTANCE (instance));
   
-  SIGNAL_LOCK ();
-  hlbsa = g_hash_table_lookup (g_handler_list_bsa_ht, instance);
+  shard = handler_shard (instance);
+  HANDLERS_LOCK (instance);
+  hlbsa = g_hash_table_lookup (shard->handler_lists, instance);
+  hindex = g_hash_table_lookup (shard->handler_indexes, instance);
   if (hlbsa)
     {
       guint i;
       
       /* reentrancy caution, delete instance trace first */
-      g_hash_table_remove (g_handler_list_bsa_ht, instance);
+      g_hash_table_remove (shard->handler_lists, instance);
+      g_hash_table_remove (shard->handler_indexes, instance);
       
       for (i = 0; i < hlbsa->n_nodes; i++)
         {
@@ -2703,12 +3161,13 @@ g_signal_handlers_destroy (gpointer instance)
 	      
               handler = tmp->next;
               tmp->block_count = 1;
+              tmp->in_index = FALSE;
               /* cruel unlink, this works because _all_ handlers vanish */
               tmp->next = NULL;
               tmp->prev = tmp;
               if (tmp->sequential_number)
 		{
-                  g_hash_table_remove (g_handlers, tmp);
+                  g_hash_table_remove (shard->handlers, tmp);
 		  remove_invalid_closure_notify (tmp, instance);
 		  tmp->sequential_number = 0;
 		  handler_unref_R (0, NULL, tmp);
@@ -2716,8 +3175,10 @@ g_signal_handlers_destroy (gpointer instance)
             }
         }
       g_bsearch_array_free (hlbsa, &g_signal_hlbsa_bconfig);
+      if (hindex)
+        handler_index_free (hindex);
     }
-  SIGNAL_UNLOCK ();
+  HANDLERS_UNLOCK (instance);
 }
 
 /**
@@ -2757,14 +3218,14 @@ g_signal_handler_find (gpointer         instance,
     {
       HandlerMatch *mlist;
       
-      SIGNAL_LOCK ();
+      HANDLERS_LOCK (instance);
       mlist = handlers_find (instance, mask, signal_id, detail, closure, func, data, TRUE);
       if (mlist)
 	{
 	  handler_seq_no = mlist->handler->sequential_number;
 	  handler_match_free1_R (mlist, instance);
 	}
-      SIGNAL_UNLOCK ();
+      HANDLERS_UNLOCK (instance);
     }
   
   return handler_seq_no;
@@ -2790,9 +3251,9 @@ signal_handlers_foreach_matched_R (gpointer         instance,
       n_handlers++;
       if (mlist->handler->sequential_number)
 	{
-	  SIGNAL_UNLOCK ();
+	  HANDLERS_UNLOCK (instance);
 	  callback (instance, mlist->handler->sequential_number);
-	  SIGNAL_LOCK ();
+	  HANDLERS_LOCK (instance);
 	}
       mlist = handler_match_free1_R (mlist, instance);
     }
@@ -2837,11 +3298,11 @@ g_signal_handlers_block_matched (gpointer         instance,
   
   if (mask & (G_SIGNAL_MATCH_CLOSURE | G_SIGNAL_MATCH_FUNC | G_SIGNAL_MATCH_DATA))
     {
-      SIGNAL_LOCK ();
+      HANDLERS_LOCK (instance);
       n_handlers = signal_handlers_foreach_matched_R (instance, mask, signal_id, detail,
 						      closure, func, data,
 						      g_signal_handler_block);
-      SIGNAL_UNLOCK ();
+      HANDLERS_UNLOCK (instance);
     }
   
   return n_handlers;
@@ -2885,11 +3346,11 @@ g_signal_handlers_unblock_matched (gpointer         instance,
   
   if (mask & (G_SIGNAL_MATCH_CLOSURE | G_SIGNAL_MATCH_FUNC | G_SIGNAL_MATCH_DATA))
     {
-      SIGNAL_LOCK ();
+      HANDLERS_LOCK (instance);
       n_handlers = signal_handlers_foreach_matched_R (instance, mask, signal_id, detail,
 						      closure, func, data,
 						      g_signal_handler_unblock);
-      SIGNAL_UNLOCK ();
+      HANDLERS_UNLOCK (instance);
     }
   
   return n_handlers;
@@ -2933,11 +3394,11 @@ g_signal_handlers_disconnect_matched (gpointer         instance,
   
   if (mask & (G_SIGNAL_MATCH_CLOSURE | G_SIGNAL_MATCH_FUNC | G_SIGNAL_MATCH_DATA))
     {
-      SIGNAL_LOCK ();
+      HANDLERS_LOCK (instance);
       n_handlers = signal_handlers_foreach_matched_R (instance, mask, signal_id, detail,
 						      closure, func, data,
 						      g_signal_handler_disconnect);
-      SIGNAL_UNLOCK ();
+      HANDLERS_UNLOCK (instance);
     }
   
   return n_handlers;
@@ -2983,7 +3444,7 @@ g_signal_has_handler_pending (gpointer instance,
   g_return_val_if_fail (G_TYPE_CHECK_INSTANCE (instance), FALSE);
   g_return_val_if_fail (signal_id > 0, FALSE);
   
-  SIGNAL_LOCK ();
+  EMISSION_LOCK (instance);
 
   node = LOOKUP_SIGNAL_NODE (signal_id);
   if (detail)
@@ -2991,7 +3452,7 @@ g_signal_has_handler_pending (gpointer instance,
       if (!(node->flags & G_SIGNAL_DETAILED))
 	{
 	  g_warning ("%s: signal id '%u' does not support detail (%u)", G_STRLOC, signal_id, detail);
-	  SIGNAL_UNLOCK ();
+	  EMISSION_UNLOCK (instance);
 	  return FALSE;
 	}
     }
@@ -3011,11 +3472,41 @@ g_signal_has_handler_pending (gpointer instance,
       else
         has_pending = FALSE;
     }
-  SIGNAL_UNLOCK ();
+  EMISSION_UNLOCK (instance);
 
   return has_pending;
 }
 
+/* Returns TRUE if emitting @signal_id on @instance currently can't have
+ * any effect: there are no handlers or emission hooks, and the class
+ * closure doesn't run anything for @instance's class.
+ */
+gboolean
+_g_signal_emission_is_void (gpointer instance,
+                            guint    signal_id)
+{
+  SignalNode *node;
+  gboolean is_void = FALSE;
+
+  EMISSION_LOCK (instance);
+  node = LOOKUP_SIGNAL_NODE (signal_id);
+
+  if (!node->single_va_closure_is_valid)
+    node_update_single_va_closure (node);
+
+  if (node->single_va_closure != NULL &&
+      (node->single_va_closure == SINGLE_VA_CLOSURE_EMPTY_MAGIC ||
+       _g_closure_is_void (node->single_va_closure, instance)))
+    {
+      HandlerList *hlist = handler_list_lookup (signal_id, instance);
+
+      is_void = hlist == NULL || hlist->handlers == NULL;
+    }
+  EMISSION_UNLOCK (instance);
+
+  return is_void;
+}
+
 /**
  * g_signal_emitv:
  * @instance_and_params: (array): argument list for the signal emission.
@@ -3054,19 +3545,22 @@ g_signal_emitv (const GValue *instance_and_params,
   param_values = instance_and_params + 1;
 #endif
 
-  SIGNAL_LOCK ();
+  if (G_UNLIKELY (_g_type_statistics_enabled))
+    _g_type_statistics_add_emission (G_TYPE_FROM_INSTANCE (instance));
+
+  EMISSION_LOCK (instance);
   node = LOOKUP_SIGNAL_NODE (signal_id);
   if (!node || !g_type_is_a (G_TYPE_FROM_INSTANCE (instance), node->itype))
     {
       g_warning ("%s: signal id '%u' is invalid for instance '%p'", G_STRLOC, signal_id, instance);
-      SIGNAL_UNLOCK ();
+      EMISSION_UNLOCK (instance);
       return;
     }
 #ifdef G_ENABLE_DEBUG
   if (detail && !(node->flags & G_SIGNAL_DETAILED))
     {
       g_warning ("%s: signal id '%u' does not support detail (%u)", G_STRLOC, signal_id, detail);
-      SIGNAL_UNLOCK ();
+      EMISSION_UNLOCK (instance);
       return;
     }
   for (i = 0; i < node->n_params; i++)
@@ -3078,7 +3572,7 @@ g_signal_emitv (const GValue *instance_and_params,
 		    i,
 		    node->name,
 		    G_VALUE_TYPE_NAME (param_values + i));
-	SIGNAL_UNLOCK ();
+	EMISSION_UNLOCK (instance);
 	return;
       }
   if (node->return_type != G_TYPE_NONE)
@@ -3089,7 +3583,7 @@ g_signal_emitv (const GValue *instance_and_params,
 		      G_STRLOC,
 		      type_debug_name (node->return_type),
 		      node->name);
-	  SIGNAL_UNLOCK ();
+	  EMISSION_UNLOCK (instance);
 	  return;
 	}
       else if (!node->accumulator && !G_TYPE_CHECK_VALUE_TYPE (return_value, node->return_type & ~G_SIGNAL_TYPE_STATIC_SCOPE))
@@ -3099,7 +3593,7 @@ g_signal_emitv (const GValue *instance_and_params,
 		      type_debug_name (node->return_type),
 		      node->name,
 		      G_VALUE_TYPE_NAME (return_value));
-	  SIGNAL_UNLOCK ();
+	  EMISSION_UNLOCK (instance);
 	  return;
 	}
     }
@@ -3119,13 +3613,13 @@ g_signal_emitv (const GValue *instance_and_params,
       if (hlist == NULL || hlist->handlers == NULL)
 	{
 	  /* nothing to do to emit this signal */
-	  SIGNAL_UNLOCK ();
+	  EMISSION_UNLOCK (instance);
 	  /* g_printerr ("omitting emission of \"%s\"\n", node->name); */
 	  return;
 	}
     }
 
-  SIGNAL_UNLOCK ();
+  EMISSION_UNLOCK (instance);
   signal_emit_unlocked_R (node, detail, instance, return_value, instance_and_params);
 }
 
@@ -3146,6 +3640,80 @@ accumulate (GSignalInvocationHint *ihint,
   return continue_emission;
 }
 
+#define VA_FASTPATH_MAX_HANDLERS 8
+
+static inline HandlerVaPlan
+handler_list_va_plan (HandlerList *hlist)
+{
+  if (hlist->va_plan == HANDLER_VA_PLAN_UNKNOWN)
+    {
+      Handler *l;
+
+      hlist->va_plan = HANDLER_VA_PLAN_SUPPORTED;
+      for (l = hlist->handlers; l != NULL; l = l->next)
+        if (!_g_closure_supports_invoke_va (l->closure))
+          {
+            hlist->va_plan = HANDLER_VA_PLAN_UNSUPPORTED;
+            break;
+          }
+    }
+
+  return hlist->va_plan;
+}
+
+/* Holds a reference on each object argument, as collecting the
+ * arguments into GValues would.
+ */
+static guint
+va_params_ref_objects (SignalNode *node,
+                       va_list     var_args,
+                       GObject   **objects)
+{
+  va_list args;
+  guint i, n_objects = 0;
+
+  G_VA_COPY (args, var_args);
+  for (i = 0; i < node->n_params; i++)
+    {
+      GType ptype = node->param_types[i] & ~G_SIGNAL_TYPE_STATIC_SCOPE;
+
+      if (G_TYPE_FUNDAMENTAL (ptype) == G_TYPE_OBJECT &&
+          (node->param_types[i] & G_SIGNAL_TYPE_STATIC_SCOPE) == 0)
+        {
+          GObject *object = va_arg (args, GObject *);
+
+          if (object != NULL)
+            objects[n_objects++] = g_object_ref (object);
+        }
+      else
+        G_VALUE_COLLECT_SKIP (ptype, args);
+    }
+  va_end (args);
+
+  return n_objects;
+}
+
+/* Called before each closure of a multi-closure va emission, checks
+ * whether the emission was stopped or the handler blocked meanwhile.
+ */
+static gboolean
+va_emission_continue (Emission *emission,
+                      Handler  *handler,
+                      gboolean  after,
+                      GType     instance_type)
+{
+  gboolean run;
+
+  HANDLERS_LOCK (emission->instance);
+  run = emission->state != EMISSION_STOP &&
+        (handler == NULL || handler->block_count == 0);
+  emission->ihint.run_type = after ? G_SIGNAL_RUN_LAST : G_SIGNAL_RUN_FIRST;
+  emission->chain_type = handler == NULL ? instance_type : G_TYPE_NONE;
+  HANDLERS_UNLOCK (emission->instance);
+
+  return run;
+}
+
 /**
  * g_signal_emit_valist: (skip)
  * @instance: (type GObject.TypeInstance): the instance the signal is being
@@ -3176,19 +3744,30 @@ g_signal_emit_valist (gpointer instance,
   g_return_if_fail (G_TYPE_CHECK_INSTANCE (instance));
   g_return_if_fail (signal_id > 0);
 
-  SIGNAL_LOCK ();
+  if (G_UNLIKELY (_g_type_statistics_enabled))
+    _g_type_statistics_add_emission (G_TYPE_FROM_INSTANCE (instance));
+
+  /* No handlers, hooks or class closure anywhere: nothing to lock for */
+  node = LOOKUP_SIGNAL_NODE_UNLOCKED (signal_id);
+  if (node != NULL &&
+      g_atomic_int_get (&node->handler_count) == NODE_SKIP_EMISSION &&
+      (!detail || (node->flags & G_SIGNAL_DETAILED)) &&
+      g_type_is_a (G_TYPE_FROM_INSTANCE (instance), node->itype))
+    return;
+
+  EMISSION_LOCK (instance);
   node = LOOKUP_SIGNAL_NODE (signal_id);
   if (!node || !g_type_is_a (G_TYPE_FROM_INSTANCE (instance), node->itype))
     {
       g_warning ("%s: signal id '%u' is invalid for instance '%p'", G_STRLOC, signal_id, instance);
-      SIGNAL_UNLOCK ();
+      EMISSION_UNLOCK (instance);
       return;
     }
 #ifndef G_DISABLE_CHECKS
   if (detail && !(node->flags & G_SIGNAL_DETAILED))
     {
       g_warning ("%s: signal id '%u' does not support detail (%u)", G_STRLOC, signal_id, detail);
-      SIGNAL_UNLOCK ();
+      EMISSION_UNLOCK (instance);
       return;
     }
 #endif  /* !G_DISABLE_CHECKS */
@@ -3199,58 +3778,60 @@ g_signal_emit_valist (gpointer instance,
   if (node->single_va_closure != NULL)
     {
       HandlerList* hlist = handler_list_lookup (node->signal_id, instance);
-      Handler *fastpath_handler = NULL;
+      Handler *handlers[VA_FASTPATH_MAX_HANDLERS];
+      HandlerVaPlan va_plan = HANDLER_VA_PLAN_SUPPORTED;
+      guint n_handlers = 0, n_closures;
       Handler *l;
-      GClosure *closure = NULL;
+      GClosure *class_closure = NULL;
+      gboolean class_closure_is_after = node->single_va_closure_is_after;
       gboolean fastpath = TRUE;
-      GSignalFlags run_type = G_SIGNAL_RUN_FIRST;
 
       if (node->single_va_closure != SINGLE_VA_CLOSURE_EMPTY_MAGIC &&
 	  !_g_closure_is_void (node->single_va_closure, instance))
 	{
 	  if (_g_closure_supports_invoke_va (node->single_va_closure))
-	    {
-	      closure = node->single_va_closure;
-	      if (node->single_va_closure_is_after)
-		run_type = G_SIGNAL_RUN_LAST;
-	      else
-		run_type = G_SIGNAL_RUN_FIRST;
-	    }
+	    class_closure = node->single_va_closure;
 	  else
 	    fastpath = FALSE;
 	}
 
+      if (hlist)
+        va_plan = handler_list_va_plan (hlist);
+
       for (l = hlist ? hlist->handlers : NULL; fastpath && l != NULL; l = l->next)
 	{
 	  if (!l->block_count &&
 	      (!l->detail || l->detail == detail))
 	    {
-	      if (closure != NULL || !_g_closure_supports_invoke_va (l->closure))
+	      if (n_handlers == VA_FASTPATH_MAX_HANDLERS ||
+		  (va_plan != HANDLER_VA_PLAN_SUPPORTED &&
+		   !_g_closure_supports_invoke_va (l->closure)))
 		{
 		  fastpath = FALSE;
 		  break;
 		}
 	      else
-		{
-                  fastpath_handler = l;
-		  closure = l->closure;
-		  if (l->after)
-		    run_type = G_SIGNAL_RUN_LAST;
-		  else
-		    run_type = G_SIGNAL_RUN_FIRST;
-		}
+		handlers[n_handlers++] = l;
 	    }
 	}
 
-      if (fastpath && closure == NULL && node->return_type == G_TYPE_NONE)
+      n_closures = n_handlers + (class_closure != NULL ? 1 : 0);
+
+      if (fastpath && n_closures == 0 && node->return_type == G_TYPE_NONE)
 	{
-	  SIGNAL_UNLOCK ();
+	  node_try_skip_emission (node);
+	  EMISSION_UNLOCK (instance);
 	  return;
 	}
 
       /* Don't allow no-recurse emission as we might have to restart, which means
 	 we will run multiple handlers and thus must ref all arguments */
-      if (closure != NULL && (node->flags & (G_SIGNAL_NO_RECURSE)) != 0)
+      if (n_closures > 0 && (node->flags & (G_SIGNAL_NO_RECURSE)) != 0)
+	fastpath = FALSE;
+
+      /* Running several closures needs the arguments to stay valid
+       * throughout and must not involve an accumulator */
+      if (n_closures > 1 && !node->multi_va_closures_ok)
 	fastpath = FALSE;
       
       if (fastpath)
@@ -3263,6 +3844,9 @@ g_signal_emit_valist (gpointer instance,
 	  GValue emission_return = G_VALUE_INIT;
           GType rtype = node->return_type & ~G_SIGNAL_TYPE_STATIC_SCOPE;
 	  gboolean static_scope = node->return_type & G_SIGNAL_TYPE_STATIC_SCOPE;
+	  GSignalFlags run_type = G_SIGNAL_RUN_FIRST;
+	  GObject **param_objects = NULL;
+	  guint n_param_objects = 0;
 
 	  signal_id = node->signal_id;
 	  accumulator = node->accumulator;
@@ -3273,6 +3857,12 @@ g_signal_emit_valist (gpointer instance,
 	  else
 	    return_accu = &emission_return;
 
+	  /* handlers are sorted with the after handlers last */
+	  if ((class_closure == NULL || class_closure_is_after) &&
+	      (n_handlers == 0 || handlers[0]->after) &&
+	      n_closures > 0)
+	    run_type = G_SIGNAL_RUN_LAST;
+
 	  emission.instance = instance;
 	  emission.ihint.signal_id = signal_id;
 	  emission.ihint.detail = detail;
@@ -3281,10 +3871,10 @@ g_signal_emit_valist (gpointer instance,
 	  emission.chain_type = instance_type;
 	  emission_push (&emission);
 
-          if (fastpath_handler)
-            handler_ref (fastpath_handler);
+	  for (i = 0; i < n_handlers; i++)
+	    handler_ref (handlers[i]);
 
-	  SIGNAL_UNLOCK ();
+	  EMISSION_UNLOCK (instance);
 
 	  TRACE(GOBJECT_SIGNAL_EMIT(signal_id, detail, instance, instance_type));
 
@@ -3294,10 +3884,12 @@ g_signal_emit_valist (gpointer instance,
 	  if (accumulator)
 	    g_value_init (&accu, rtype);
 
-	  if (closure != NULL)
+	  if (n_closures > 0)
+	    g_object_ref (instance);
+
+	  if (n_closures == 1)
 	    {
-	      g_object_ref (instance);
-	      _g_closure_invoke_va (closure,
+	      _g_closure_invoke_va (class_closure ? class_closure : handlers[0]->closure,
 				    return_accu,
 				    instance,
 				    var_args,
@@ -3305,16 +3897,51 @@ g_signal_emit_valist (gpointer instance,
 				    node->param_types);
 	      accumulate (&emission.ihint, &emission_return, &accu, accumulator);
 	    }
+	  else if (n_closures > 1)
+	    {
+	      guint stage;
 
-	  SIGNAL_LOCK ();
+	      param_objects = g_newa (GObject *, node->n_params);
+	      n_param_objects = va_params_ref_objects (node, var_args, param_objects);
+
+	      /* same order as signal_emit_unlocked_R(), minus cleanup */
+	      for (stage = 0; stage < 2; stage++)
+		{
+		  gboolean after = stage == 1;
+
+		  if (class_closure != NULL && class_closure_is_after == after &&
+		      va_emission_continue (&emission, NULL, after, instance_type))
+		    _g_closure_invoke_va (class_closure,
+					  return_accu,
+					  instance,
+					  var_args,
+					  node->n_params,
+					  node->param_types);
+
+		  for (i = 0; i < n_handlers; i++)
+		    if (handlers[i]->after == after &&
+			va_emission_continue (&emission, handlers[i], after, instance_type))
+		      _g_closure_invoke_va (handlers[i]->closure,
+					    return_accu,
+					    instance,
+					    var_args,
+					    node->n_params,
+					    node->param_types);
+		}
+	    }
+
+	  EMISSION_LOCK (instance);
 
 	  emission.chain_type = G_TYPE_NONE;
 	  emission_pop (&emission);
 
-          if (fastpath_handler)
-            handler_unref_R (signal_id, instance, fastpath_handler);
+	  for (i = 0; i < n_handlers; i++)
+	    handler_unref_R (signal_id, instance, handlers[i]);
 
-	  SIGNAL_UNLOCK ();
+	  EMISSION_UNLOCK (instance);
+
+	  for (i = 0; i < n_param_objects; i++)
+	    g_object_unref (param_objects[i]);
 
 	  if (accumulator)
 	    g_value_unset (&accu);
@@ -3346,13 +3973,13 @@ g_signal_emit_valist (gpointer instance,
 	  
 	  TRACE(GOBJECT_SIGNAL_EMIT_END(signal_id, detail, instance, instance_type));
 
-          if (closure != NULL)
+          if (n_closures > 0)
             g_object_unref (instance);
 
 	  return;
 	}
     }
-  SIGNAL_UNLOCK ();
+  EMISSION_UNLOCK (instance);
 
   n_params = node->n_params;
   signal_return_type = node->return_type;
@@ -3511,7 +4138,7 @@ signal_emit_unlocked_R (SignalNode   *node,
   
   TRACE(GOBJECT_SIGNAL_EMIT(node->signal_id, detail, instance, G_TYPE_FROM_INSTANCE (instance)));
 
-  SIGNAL_LOCK ();
+  EMISSION_LOCK (instance);
   signal_id = node->signal_id;
 
   if (node->flags & G_SIGNAL_NO_RECURSE)
@@ -3521,17 +4148,17 @@ signal_emit_unlocked_R (SignalNode   *node,
       if (node)
 	{
 	  node->state = EMISSION_RESTART;
-	  SIGNAL_UNLOCK ();
+	  EMISSION_UNLOCK (instance);
 	  return return_value_altered;
 	}
     }
   accumulator = node->accumulator;
   if (accumulator)
     {
-      SIGNAL_UNLOCK ();
+      EMISSION_UNLOCK (instance);
       g_value_init (&accu, node->return_type & ~G_SIGNAL_TYPE_STATIC_SCOPE);
       return_accu = &accu;
-      SIGNAL_LOCK ();
+      EMISSION_LOCK (instance);
     }
   else
     return_accu = emission_return;
@@ -3548,7 +4175,7 @@ signal_emit_unlocked_R (SignalNode   *node,
   
   if (handler_list)
     handler_unref_R (signal_id, instance, handler_list);
-  max_sequential_handler_number = g_handler_sequential_number;
+  max_sequential_handler_number = (gulong) g_atomic_pointer_get (&g_handler_sequential_number);
   hlist = handler_list_lookup (signal_id, instance);
   handler_list = hlist ? hlist->handlers : NULL;
   if (handler_list)
@@ -3561,7 +4188,7 @@ signal_emit_unlocked_R (SignalNode   *node,
       emission.state = EMISSION_RUN;
 
       emission.chain_type = G_TYPE_FROM_INSTANCE (instance);
-      SIGNAL_UNLOCK ();
+      EMISSION_UNLOCK (instance);
       g_closure_invoke (class_closure,
 			return_accu,
 			node->n_params + 1,
@@ -3570,7 +4197,7 @@ signal_emit_unlocked_R (SignalNode   *node,
       if (!accumulate (&emission.ihint, emission_return, &accu, accumulator) &&
 	  emission.state == EMISSION_RUN)
 	emission.state = EMISSION_STOP;
-      SIGNAL_LOCK ();
+      EMISSION_LOCK (instance);
       emission.chain_type = G_TYPE_NONE;
       return_value_altered = TRUE;
       
@@ -3597,13 +4224,21 @@ signal_emit_unlocked_R (SignalNode   *node,
 	      
 	      was_in_call = G_HOOK_IN_CALL (hook);
 	      hook->flags |= G_HOOK_FLAG_IN_CALL;
-              SIGNAL_UNLOCK ();
+              EMISSION_UNLOCK (instance);
 	      need_destroy = !hook_func (&emission.ihint, node->n_params + 1, instance_and_params, hook->data);
-	      SIGNAL_LOCK ();
+	      EMISSION_LOCK (instance);
 	      if (!was_in_call)
 		hook->flags &= ~G_HOOK_FLAG_IN_CALL;
 	      if (need_destroy)
-		g_hook_destroy_link (node->emission_hooks, hook);
+		{
+		  /* signal_finalize_hook() retakes the signal lock, which
+		   * must not happen while holding the handler shard */
+		  handler_shard (instance)->signal_locked = FALSE;
+		  HANDLERS_UNLOCK (instance);
+		  g_hook_destroy_link (node->emission_hooks, hook);
+		  HANDLERS_LOCK (instance);
+		  handler_shard (instance)->signal_locked = TRUE;
+		}
 	    }
 	  hook = g_hook_next_valid (node->emission_hooks, hook, may_recurse);
 	}
@@ -3631,7 +4266,7 @@ signal_emit_unlocked_R (SignalNode   *node,
 	  else if (!handler->block_count && (!handler->detail || handler->detail == detail) &&
 		   handler->sequential_number < max_sequential_handler_number)
 	    {
-	      SIGNAL_UNLOCK ();
+	      EMISSION_UNLOCK (instance);
 	      g_closure_invoke (handler->closure,
 				return_accu,
 				node->n_params + 1,
@@ -3640,7 +4275,7 @@ signal_emit_unlocked_R (SignalNode   *node,
 	      if (!accumulate (&emission.ihint, emission_return, &accu, accumulator) &&
 		  emission.state == EMISSION_RUN)
 		emission.state = EMISSION_STOP;
-	      SIGNAL_LOCK ();
+	      EMISSION_LOCK (instance);
 	      return_value_altered = TRUE;
 	      
 	      tmp = emission.state == EMISSION_RUN ? handler->next : NULL;
@@ -3669,7 +4304,7 @@ signal_emit_unlocked_R (SignalNode   *node,
       emission.state = EMISSION_RUN;
       
       emission.chain_type = G_TYPE_FROM_INSTANCE (instance);
-      SIGNAL_UNLOCK ();
+      EMISSION_UNLOCK (instance);
       g_closure_invoke (class_closure,
 			return_accu,
 			node->n_params + 1,
@@ -3678,7 +4313,7 @@ signal_emit_unlocked_R (SignalNode   *node,
       if (!accumulate (&emission.ihint, emission_return, &accu, accumulator) &&
 	  emission.state == EMISSION_RUN)
 	emission.state = EMISSION_STOP;
-      SIGNAL_LOCK ();
+      EMISSION_LOCK (instance);
       emission.chain_type = G_TYPE_NONE;
       return_value_altered = TRUE;
       
@@ -3701,7 +4336,7 @@ signal_emit_unlocked_R (SignalNode   *node,
 	  if (handler->after && !handler->block_count && (!handler->detail || handler->detail == detail) &&
 	      handler->sequential_number < max_sequential_handler_number)
 	    {
-	      SIGNAL_UNLOCK ();
+	      EMISSION_UNLOCK (instance);
 	      g_closure_invoke (handler->closure,
 				return_accu,
 				node->n_params + 1,
@@ -3710,7 +4345,7 @@ signal_emit_unlocked_R (SignalNode   *node,
 	      if (!accumulate (&emission.ihint, emission_return, &accu, accumulator) &&
 		  emission.state == EMISSION_RUN)
 		emission.state = EMISSION_STOP;
-	      SIGNAL_LOCK ();
+	      EMISSION_LOCK (instance);
 	      return_value_altered = TRUE;
 	      
 	      tmp = emission.state == EMISSION_RUN ? handler->next : NULL;
@@ -3742,7 +4377,7 @@ signal_emit_unlocked_R (SignalNode   *node,
       emission.state = EMISSION_STOP;
       
       emission.chain_type = G_TYPE_FROM_INSTANCE (instance);
-      SIGNAL_UNLOCK ();
+      EMISSION_UNLOCK (instance);
       if (node->return_type != G_TYPE_NONE && !accumulator)
 	{
 	  g_value_init (&accu, node->return_type & ~G_SIGNAL_TYPE_STATIC_SCOPE);
@@ -3755,7 +4390,7 @@ signal_emit_unlocked_R (SignalNode   *node,
 			&emission.ihint);
       if (need_unset)
 	g_value_unset (&accu);
-      SIGNAL_LOCK ();
+      EMISSION_LOCK (instance);
       emission.chain_type = G_TYPE_NONE;
       
       if (emission.state == EMISSION_RESTART)
@@ -3766,7 +4401,7 @@ signal_emit_unlocked_R (SignalNode   *node,
     handler_unref_R (signal_id, instance, handler_list);
   
   emission_pop (&emission);
-  SIGNAL_UNLOCK ();
+  EMISSION_UNLOCK (instance);
   if (accumulator)
     g_value_unset (&accu);
 
@@ -3801,7 +4436,7 @@ invalid_closure_notify (gpointer  instance,
   Handler *handler;
   guint signal_id;
 
-  SIGNAL_LOCK ();
+  HANDLERS_LOCK (instance);
 
   handler = handler_lookup (instance, 0, closure, &signal_id);
   g_assert (handler->closure == closure);
@@ -3810,7 +4445,7 @@ invalid_closure_notify (gpointer  instance,
   handler->block_count = 1;
   handler_unref_R (signal_id, instance, handler);
 
-  SIGNAL_UNLOCK ();
+  HANDLERS_UNLOCK (instance);
 }
 
 static const gchar*
@@ -23,6 +23,7 @@
 
 #include "gboxed.h"
 #include "gclosure.h"
+#include "gparam.h"
 
 /*< private >
  * GOBJECT_IF_DEBUG:
@@ -45,6 +46,7 @@ G_STMT_START { \
 G_BEGIN_DECLS
 
 extern GTypeDebugFlags _g_type_debug_flags;
+extern gboolean        _g_type_statistics_enabled;
 
 typedef struct _GRealClosure  GRealClosure;
 struct _GRealClosure
@@ -89,7 +91,18 @@ void        _g_closure_invoke_va (GClosure       *closure,
 				  va_list         args,
 				  int             n_params,
 				  GType          *param_types);
+GVaClosureMarshal _g_cclosure_get_direct_va_marshaller (GType        return_type,
+                                                        guint        n_params,
+                                                        const GType *param_types);
 
+/* for gobject.c */
+gboolean    _g_signal_emission_is_void (gpointer        instance,
+                                        guint           signal_id);
+gboolean    _g_param_value_validate    (GParamSpec     *pspec,
+                                        GValue         *value);
+
+/* for gsignal.c */
+void        _g_type_statistics_add_emission (GType      type);
 
 G_END_DECLS
 
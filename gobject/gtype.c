@@ -186,7 +186,7 @@ static inline void			type_data_unref_U               (TypeNode		*node,
 									 gboolean		 uncached);
 static void				type_data_last_unref_Wm		(TypeNode *              node,
 									 gboolean		 uncached);
-static inline gpointer			type_get_qdata_L		(TypeNode		*node,
+static inline gpointer			type_get_qdata_I		(TypeNode		*node,
 									 GQuark			 quark);
 static inline void			type_set_qdata_W		(TypeNode		*node,
 									 GQuark			 quark,
@@ -218,6 +218,37 @@ typedef enum
   INITIALIZED
 } InitState;
 
+/* Instantiatable types remember the interfaces they were recently found
+ * to conform to, so that repeated instance checks and casts to the same
+ * interfaces don't need to look at the interface entries.  Since types
+ * never stop implementing an interface, entries don't need to be
+ * invalidated.
+ */
+#define TYPE_NODE_IFACE_CACHE_BITS 2
+#define TYPE_NODE_IFACE_CACHE_SIZE (1 << TYPE_NODE_IFACE_CACHE_BITS)
+
+/* Non-fundamental GTypes are TypeNode pointers, so their low bits are
+ * always the same; use a multiplicative hash to pick from the high ones.
+ */
+#if GLIB_SIZEOF_SIZE_T == 8
+#define TYPE_NODE_IFACE_CACHE_SLOT(iface_type) \
+  ((guint) (((guint64) (iface_type) * G_GUINT64_CONSTANT (0x9e3779b97f4a7c15)) >> (64 - TYPE_NODE_IFACE_CACHE_BITS)))
+#else
+#define TYPE_NODE_IFACE_CACHE_SLOT(iface_type) \
+  ((guint) (((guint32) (iface_type) * 0x9e3779b9U) >> (32 - TYPE_NODE_IFACE_CACHE_BITS)))
+#endif
+
+/* Usage counters of an instantiatable type, allocated on first use once
+ * statistics are enabled and only ever updated atomically.
+ */
+typedef struct
+{
+  gsize n_allocations;
+  gsize n_frees;
+  gsize n_emissions;
+  gsize n_iface_cache_misses;
+} TypeStats;
+
 /* --- structures --- */
 struct _TypeNode
 {
@@ -225,6 +256,7 @@ struct _TypeNode
 #ifdef G_ENABLE_DEBUG
   guint volatile instance_count;
 #endif
+  TypeStats * volatile stats;
   GTypePlugin *plugin;
   guint        n_children; /* writable with lock */
   guint        n_supers : 8;
@@ -235,12 +267,13 @@ struct _TypeNode
   GType       *children; /* writable with lock */
   TypeData * volatile data;
   GQuark       qname;
-  GData       *global_gdata;
+  GAtomicArray qdata; /* sorted QData, readable without lock */
   union {
     GAtomicArray iface_entries;		/* for !iface types */
     GAtomicArray offsets;
   } _prot;
   GType       *prerequisites;
+  GType        iface_cache[TYPE_NODE_IFACE_CACHE_SIZE]; /* atomic, for instantiatable types */
   GType        supers[1]; /* flexible array */
 };
 
@@ -260,9 +293,9 @@ struct _TypeNode
 #define	CLASSED_NODE_IFACES_ENTRIES_LOCKED(node)(G_ATOMIC_ARRAY_GET_LOCKED(CLASSED_NODE_IFACES_ENTRIES((node)), IFaceEntries))
 #define	IFACE_NODE_N_PREREQUISITES(node)	((node)->n_prerequisites)
 #define	IFACE_NODE_PREREQUISITES(node)		((node)->prerequisites)
-#define	iface_node_get_holders_L(node)		((IFaceHolder*) type_get_qdata_L ((node), static_quark_iface_holder))
+#define	iface_node_get_holders_L(node)		((IFaceHolder*) type_get_qdata_I ((node), static_quark_iface_holder))
 #define	iface_node_set_holders_W(node, holders)	(type_set_qdata_W ((node), static_quark_iface_holder, (holders)))
-#define	iface_node_get_dependants_array_L(n)	((GType*) type_get_qdata_L ((n), static_quark_dependants_array))
+#define	iface_node_get_dependants_array_L(n)	((GType*) type_get_qdata_I ((n), static_quark_dependants_array))
 #define	iface_node_set_dependants_array_W(n,d)	(type_set_qdata_W ((n), static_quark_dependants_array, (d)))
 #define	TYPE_ID_MASK				((GType) ((1 << G_TYPE_FUNDAMENTAL_SHIFT) - 1))
 
@@ -381,6 +414,7 @@ static GQuark          static_quark_iface_holder = 0;
 static GQuark          static_quark_dependants_array = 0;
 static guint           type_registration_serial = 0;
 GTypeDebugFlags	       _g_type_debug_flags = 0;
+gboolean               _g_type_statistics_enabled = FALSE;
 
 /* --- type nodes --- */
 static GHashTable       *static_type_nodes_ht = NULL;
@@ -507,7 +541,7 @@ type_node_any_new_W (TypeNode             *pnode,
   node->children = NULL;
   node->data = NULL;
   node->qname = g_quark_from_string (name);
-  node->global_gdata = NULL;
+  _g_atomic_array_init (&node->qdata);
   g_hash_table_insert (static_type_nodes_ht,
 		       (gpointer) g_quark_to_string (node->qname),
 		       (gpointer) type);
@@ -1212,7 +1246,7 @@ type_data_make_W (TypeNode              *node,
   node->data->common.value_table = vtable;
   node->mutatable_check_cache = (node->data->common.value_table->value_init != NULL &&
 				 !((G_TYPE_FLAG_VALUE_ABSTRACT | G_TYPE_FLAG_ABSTRACT) &
-				   GPOINTER_TO_UINT (type_get_qdata_L (node, static_quark_type_flags))));
+				   GPOINTER_TO_UINT (type_get_qdata_I (node, static_quark_type_flags))));
   
   g_assert (node->data->common.value_table != NULL); /* paranoid */
 
@@ -1761,6 +1795,24 @@ type_iface_blow_holder_info_Wm (TypeNode *iface,
     }
 }
 
+static TypeStats *
+type_node_ensure_stats (TypeNode *node)
+{
+  TypeStats *stats = g_atomic_pointer_get (&node->stats);
+
+  if (G_UNLIKELY (stats == NULL))
+    {
+      stats = g_new0 (TypeStats, 1);
+      if (!g_atomic_pointer_compare_and_exchange (&node->stats, NULL, stats))
+        {
+          g_free (stats);
+          stats = g_atomic_pointer_get (&node->stats);
+        }
+    }
+
+  return stats;
+}
+
 /**
  * g_type_create_instance: (skip)
  * @type: an instantiatable type to create an instance for
@@ -1872,6 +1924,9 @@ g_type_create_instance (GType type)
     }
 #endif
 
+  if (G_UNLIKELY (_g_type_statistics_enabled))
+    g_atomic_pointer_add (&type_node_ensure_stats (node)->n_allocations, 1);
+
   TRACE(GOBJECT_OBJECT_NEW(instance, type));
 
   return instance;
@@ -1921,6 +1976,10 @@ g_type_free_instance (GTypeInstance *instance)
 
 #ifdef G_ENABLE_DEBUG
   memset (allocated, 0xaa, ivar_size + private_size);
+  /* keep type checks on a freed instance failing rather than crashing,
+   * even when the slice allocator's link lands in the private data
+   */
+  instance->g_class = NULL;
 #endif
 
   /* See comment in g_type_create_instance() about what's going on here.
@@ -1949,6 +2008,9 @@ g_type_free_instance (GTypeInstance *instance)
     }
 #endif
 
+  if (G_UNLIKELY (_g_type_statistics_enabled))
+    g_atomic_pointer_add (&type_node_ensure_stats (node)->n_frees, 1);
+
   g_type_class_unref (class);
 }
 
@@ -3480,6 +3542,53 @@ type_node_check_conformities_UorL (TypeNode *node,
   return match;
 }
 
+/* Same as type_node_conforms_to_U (node, iface_node, TRUE, FALSE) for
+ * an instantiatable @node, using the interface cache.
+ */
+static inline gboolean
+type_node_instance_conforms_to_U (TypeNode *node,
+                                  TypeNode *iface_node)
+{
+  GType iface_type = NODE_TYPE (iface_node);
+  guint first, i;
+  GType *slot;
+
+  if (NODE_IS_ANCESTOR (iface_node, node))
+    return TRUE;
+
+  if (!NODE_IS_IFACE (iface_node))
+    return FALSE;
+
+  /* look at the hashed slot first, then at the others, so that as many
+   * interfaces as there are slots can be cached even if they collide
+   */
+  first = TYPE_NODE_IFACE_CACHE_SLOT (iface_type);
+  slot = NULL;
+  for (i = 0; i < TYPE_NODE_IFACE_CACHE_SIZE; i++)
+    {
+      GType *entry = &node->iface_cache[(first + i) % TYPE_NODE_IFACE_CACHE_SIZE];
+      GType cached = (GType) g_atomic_pointer_get (entry);
+
+      if (cached == iface_type)
+        return TRUE;
+      if (cached == 0 && slot == NULL)
+        slot = entry;
+    }
+
+  if (G_UNLIKELY (_g_type_statistics_enabled))
+    g_atomic_pointer_add (&type_node_ensure_stats (node)->n_iface_cache_misses, 1);
+
+  if (!type_lookup_iface_vtable_I (node, iface_node, NULL))
+    return FALSE;
+
+  /* all slots taken, replace the hashed one */
+  if (slot == NULL)
+    slot = &node->iface_cache[first];
+  g_atomic_pointer_set (slot, iface_type);
+
+  return TRUE;
+}
+
 static gboolean
 type_node_is_a_L (TypeNode *node,
 		  TypeNode *iface_node)
@@ -3625,48 +3734,53 @@ g_type_interfaces (GType  type,
 }
 
 typedef struct _QData QData;
-struct _GData
-{
-  guint  n_qdatas;
-  QData *qdatas;
-};
 struct _QData
 {
   GQuark   quark;
   gpointer data;
 };
 
+/* The qdata of a node only ever grows, and is replaced as a whole
+ * through the atomic array when an entry is added, so it can be read
+ * without holding type_rw_lock.
+ */
 static inline gpointer
-type_get_qdata_L (TypeNode *node,
+type_get_qdata_I (TypeNode *node,
 		  GQuark    quark)
 {
-  GData *gdata = node->global_gdata;
-  
-  if (quark && gdata && gdata->n_qdatas)
-    {
-      QData *qdatas = gdata->qdatas - 1;
-      guint n_qdatas = gdata->n_qdatas;
-      
-      do
-	{
-	  guint i;
-	  QData *check;
-	  
-	  i = (n_qdatas + 1) / 2;
-	  check = qdatas + i;
-	  if (quark == check->quark)
-	    return check->data;
-	  else if (quark > check->quark)
-	    {
-	      n_qdatas -= i;
-	      qdatas = check;
-	    }
-	  else /* if (quark < check->quark) */
-	    n_qdatas = i - 1;
-	}
-      while (n_qdatas);
-    }
-  return NULL;
+  gpointer data = NULL;
+
+  if (!quark)
+    return NULL;
+
+  G_ATOMIC_ARRAY_DO_TRANSACTION
+    (&node->qdata, QData,
+
+     data = NULL;
+     if (transaction_data != NULL)
+       {
+	 guint lo = 0;
+	 guint hi = G_ATOMIC_ARRAY_DATA_SIZE (transaction_data) / sizeof (QData);
+
+	 while (lo < hi)
+	   {
+	     guint i = (lo + hi) / 2;
+	     QData *check = &transaction_data[i];
+
+	     if (quark == check->quark)
+	       {
+		 data = g_atomic_pointer_get (&check->data);
+		 break;
+	       }
+	     else if (quark > check->quark)
+	       lo = i + 1;
+	     else
+	       hi = i;
+	   }
+       }
+     );
+
+  return data;
 }
 
 /**
@@ -3692,11 +3806,7 @@ g_type_get_qdata (GType  type,
   
   node = lookup_type_node_I (type);
   if (node)
-    {
-      G_READ_LOCK (&type_rw_lock);
-      data = type_get_qdata_L (node, quark);
-      G_READ_UNLOCK (&type_rw_lock);
-    }
+    data = type_get_qdata_I (node, quark);
   else
     {
       g_return_val_if_fail (node != NULL, NULL);
@@ -3710,34 +3820,28 @@ type_set_qdata_W (TypeNode *node,
 		  GQuark    quark,
 		  gpointer  data)
 {
-  GData *gdata;
-  QData *qdata;
-  guint i;
-  
-  /* setup qdata list if necessary */
-  if (!node->global_gdata)
-    node->global_gdata = g_new0 (GData, 1);
-  gdata = node->global_gdata;
-  
+  QData *qdatas;
+  guint n_qdatas, i;
+
   /* try resetting old data */
-  qdata = gdata->qdatas;
-  for (i = 0; i < gdata->n_qdatas; i++)
-    if (qdata[i].quark == quark)
+  qdatas = G_ATOMIC_ARRAY_GET_LOCKED (&node->qdata, QData);
+  n_qdatas = qdatas ? G_ATOMIC_ARRAY_DATA_SIZE (qdatas) / sizeof (QData) : 0;
+  for (i = 0; i < n_qdatas; i++)
+    if (qdatas[i].quark == quark)
       {
-	qdata[i].data = data;
+	g_atomic_pointer_set (&qdatas[i].data, data);
 	return;
       }
-  
+
   /* add new entry */
-  gdata->n_qdatas++;
-  gdata->qdatas = g_renew (QData, gdata->qdatas, gdata->n_qdatas);
-  qdata = gdata->qdatas;
-  for (i = 0; i < gdata->n_qdatas - 1; i++)
-    if (qdata[i].quark > quark)
+  qdatas = _g_atomic_array_copy (&node->qdata, 0, sizeof (QData));
+  for (i = 0; i < n_qdatas; i++)
+    if (qdatas[i].quark > quark)
       break;
-  memmove (qdata + i + 1, qdata + i, sizeof (qdata[0]) * (gdata->n_qdatas - i - 1));
-  qdata[i].quark = quark;
-  qdata[i].data = data;
+  memmove (qdatas + i + 1, qdatas + i, sizeof (qdatas[0]) * (n_qdatas - i));
+  qdatas[i].quark = quark;
+  qdatas[i].data = data;
+  _g_atomic_array_update (&node->qdata, qdatas);
 }
 
 /**
@@ -3779,7 +3883,7 @@ type_add_flags_W (TypeNode  *node,
   
   if ((flags & TYPE_FLAG_MASK) && node->is_classed && node->data && node->data->class.class)
     g_warning ("tagging type '%s' as abstract after class initialization", NODE_NAME (node));
-  dflags = GPOINTER_TO_UINT (type_get_qdata_L (node, static_quark_type_flags));
+  dflags = GPOINTER_TO_UINT (type_get_qdata_I (node, static_quark_type_flags));
   dflags |= flags;
   type_set_qdata_W (node, static_quark_type_flags, GUINT_TO_POINTER (dflags));
 }
@@ -3852,6 +3956,134 @@ g_type_get_instance_count (GType type)
 #endif
 }
 
+/**
+ * g_type_enable_statistics:
+ *
+ * Starts keeping usage statistics for all instantiatable types, which
+ * can then be retrieved with g_type_get_statistics() and
+ * g_type_list_statistics().  Unlike g_type_get_instance_count(), this
+ * works in all builds; the cost is a few atomic operations per instance
+ * creation, destruction and signal emission.
+ *
+ * Statistics can't be turned off again.  They can also be enabled from
+ * the start by setting the GOBJECT_DEBUG environment variable to
+ * include `instance-stats`, which makes the live instance counts
+ * derived from them exact.
+ *
+ * Since: 2.54
+ */
+void
+g_type_enable_statistics (void)
+{
+  _g_type_statistics_enabled = TRUE;
+}
+
+static void
+type_node_get_statistics (TypeNode        *node,
+                          GTypeStatistics *stats)
+{
+  TypeStats *node_stats = g_atomic_pointer_get (&node->stats);
+
+  memset (stats, 0, sizeof (GTypeStatistics));
+  stats->type = NODE_TYPE (node);
+  if (node->data)
+    stats->instance_size = node->data->instance.instance_size + node->data->instance.private_size;
+
+  if (node_stats)
+    {
+      stats->n_allocations = (gsize) g_atomic_pointer_get (&node_stats->n_allocations);
+      stats->n_frees = (gsize) g_atomic_pointer_get (&node_stats->n_frees);
+      stats->n_emissions = (gsize) g_atomic_pointer_get (&node_stats->n_emissions);
+      stats->n_iface_cache_misses = (gsize) g_atomic_pointer_get (&node_stats->n_iface_cache_misses);
+    }
+}
+
+/**
+ * g_type_get_statistics:
+ * @type: an instantiatable #GType
+ * @stats: (out caller-allocates): return location for the statistics
+ *
+ * Retrieves the usage statistics of @type, see g_type_enable_statistics().
+ * The counts only include instances of exactly @type, not of types
+ * derived from it.
+ *
+ * Returns: %TRUE if @stats was filled in, %FALSE if statistics are not
+ *   enabled or @type is not instantiatable
+ *
+ * Since: 2.54
+ */
+gboolean
+g_type_get_statistics (GType            type,
+                       GTypeStatistics *stats)
+{
+  TypeNode *node;
+
+  g_return_val_if_fail (stats != NULL, FALSE);
+
+  node = lookup_type_node_I (type);
+  if (!_g_type_statistics_enabled || node == NULL || !node->is_instantiatable)
+    return FALSE;
+
+  G_READ_LOCK (&type_rw_lock);
+  type_node_get_statistics (node, stats);
+  G_READ_UNLOCK (&type_rw_lock);
+
+  return TRUE;
+}
+
+/**
+ * g_type_list_statistics:
+ * @n_stats: (out): return location for the number of entries
+ *
+ * Retrieves the usage statistics of all types which had instances
+ * created, freed or signals emitted on them since statistics were
+ * enabled with g_type_enable_statistics().
+ *
+ * Returns: (array length=n_stats) (transfer full): a newly allocated
+ *   array of #GTypeStatistics, free it with g_free()
+ *
+ * Since: 2.54
+ */
+GTypeStatistics *
+g_type_list_statistics (guint *n_stats)
+{
+  GArray *array;
+  GHashTableIter iter;
+  gpointer value;
+
+  g_return_val_if_fail (n_stats != NULL, NULL);
+
+  array = g_array_new (FALSE, FALSE, sizeof (GTypeStatistics));
+
+  G_READ_LOCK (&type_rw_lock);
+  g_hash_table_iter_init (&iter, static_type_nodes_ht);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      TypeNode *node = lookup_type_node_I ((GType) value);
+      GTypeStatistics stats;
+
+      if (g_atomic_pointer_get (&node->stats) == NULL)
+        continue;
+
+      type_node_get_statistics (node, &stats);
+      g_array_append_val (array, stats);
+    }
+  G_READ_UNLOCK (&type_rw_lock);
+
+  *n_stats = array->len;
+
+  return (GTypeStatistics *) g_array_free (array, FALSE);
+}
+
+void
+_g_type_statistics_add_emission (GType type)
+{
+  TypeNode *node = lookup_type_node_I (type);
+
+  if (node != NULL && node->is_instantiatable)
+    g_atomic_pointer_add (&type_node_ensure_stats (node)->n_emissions, 1);
+}
+
 /* --- implementation details --- */
 gboolean
 g_type_test_flags (GType type,
@@ -3876,11 +4108,7 @@ g_type_test_flags (GType type,
 	fflags = TRUE;
       
       if (tflags)
-	{
-	  G_READ_LOCK (&type_rw_lock);
-	  tflags = (tflags & GPOINTER_TO_UINT (type_get_qdata_L (node, static_quark_type_flags))) == tflags;
-	  G_READ_UNLOCK (&type_rw_lock);
-	}
+	tflags = (tflags & GPOINTER_TO_UINT (type_get_qdata_I (node, static_quark_type_flags))) == tflags;
       else
 	tflags = TRUE;
       
@@ -4009,8 +4237,11 @@ g_type_check_instance_is_a (GTypeInstance *type_instance,
     return FALSE;
   
   node = lookup_type_node_I (type_instance->g_class->g_type);
+  if (node && node->is_instantiatable && NODE_TYPE (node) == iface_type)
+    return TRUE;
+
   iface = lookup_type_node_I (iface_type);
-  check = node && node->is_instantiatable && iface && type_node_conforms_to_U (node, iface, TRUE, FALSE);
+  check = node && node->is_instantiatable && iface && type_node_instance_conforms_to_U (node, iface);
   
   return check;
 }
@@ -4056,8 +4287,11 @@ g_type_check_instance_cast (GTypeInstance *type_instance,
 	  
 	  node = lookup_type_node_I (type_instance->g_class->g_type);
 	  is_instantiatable = node && node->is_instantiatable;
+	  if (is_instantiatable && NODE_TYPE (node) == iface_type)
+	    return type_instance;
+
 	  iface = lookup_type_node_I (iface_type);
-	  check = is_instantiatable && iface && type_node_conforms_to_U (node, iface, TRUE, FALSE);
+	  check = is_instantiatable && iface && type_node_instance_conforms_to_U (node, iface);
 	  if (check)
 	    return type_instance;
 	  
@@ -4162,7 +4396,7 @@ type_check_is_value_type_U (GType type)
     {
       if (node->data && NODE_REFCOUNT (node) > 0 &&
 	  node->data->common.value_table->value_init)
-	tflags = GPOINTER_TO_UINT (type_get_qdata_L (node, static_quark_type_flags));
+	tflags = GPOINTER_TO_UINT (type_get_qdata_I (node, static_quark_type_flags));
       else if (NODE_IS_IFACE (node))
 	{
 	  guint i;
@@ -4379,9 +4613,13 @@ gobject_init (void)
         { "objects", G_TYPE_DEBUG_OBJECTS },
         { "instance-count", G_TYPE_DEBUG_INSTANCE_COUNT },
         { "signals", G_TYPE_DEBUG_SIGNALS },
+        { "instance-stats", G_TYPE_DEBUG_MASK + 1 },
       };
 
       _g_type_debug_flags = g_parse_debug_string (env_string, debug_keys, G_N_ELEMENTS (debug_keys));
+      if (_g_type_debug_flags & (G_TYPE_DEBUG_MASK + 1))
+        _g_type_statistics_enabled = TRUE;
+      _g_type_debug_flags &= G_TYPE_DEBUG_MASK;
     }
 
   /* quarks */
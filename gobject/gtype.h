@@ -394,6 +394,7 @@ typedef struct _GTypeFundamentalInfo    GTypeFundamentalInfo;
 typedef struct _GInterfaceInfo          GInterfaceInfo;
 typedef struct _GTypeValueTable         GTypeValueTable;
 typedef struct _GTypeQuery		GTypeQuery;
+typedef struct _GTypeStatistics		GTypeStatistics;
 
 
 /* Basic Type Structures
@@ -446,6 +447,37 @@ struct _GTypeQuery
   guint		class_size;
   guint		instance_size;
 };
+/**
+ * GTypeStatistics:
+ * @type: the #GType value of the type
+ * @instance_size: the number of bytes allocated for each instance,
+ *   including private data
+ * @n_allocations: the number of instances created
+ * @n_frees: the number of instances freed
+ * @n_emissions: the number of signal emissions on instances
+ * @n_iface_cache_misses: the number of instance checks and casts to an
+ *   interface that could not be answered from the type's interface cache
+ *
+ * Usage statistics for an instantiatable type, filled in by
+ * g_type_get_statistics() once g_type_enable_statistics() was called.
+ * All counts start from the time statistics were enabled, so the number
+ * of live instances is @n_allocations minus @n_frees only for types
+ * that had no instances at that time.
+ *
+ * Since: 2.54
+ */
+struct _GTypeStatistics
+{
+  GType		type;
+  gsize		instance_size;
+  gsize		n_allocations;
+  gsize		n_frees;
+  gsize		n_emissions;
+  gsize		n_iface_cache_misses;
+
+  /*< private >*/
+  gpointer	padding[3];
+};
 
 
 /* Casts, checks and accessors for structured types
@@ -748,6 +780,14 @@ void		      g_type_query		     (GType	       type,
 GLIB_AVAILABLE_IN_2_44
 int                   g_type_get_instance_count      (GType            type);
 
+GLIB_AVAILABLE_IN_2_54
+void                  g_type_enable_statistics       (void);
+GLIB_AVAILABLE_IN_2_54
+gboolean              g_type_get_statistics          (GType            type,
+						      GTypeStatistics *stats);
+GLIB_AVAILABLE_IN_2_54
+GTypeStatistics      *g_type_list_statistics         (guint           *n_stats);
+
 /* --- type registration --- */
 /**
  * GBaseInitFunc:
@@ -2207,7 +2247,21 @@ const gchar *    g_type_name_from_class         (GTypeClass	*g_class);
 
 
 /* --- implementation bits --- */
-#ifndef G_DISABLE_CAST_CHECKS
+#if !defined (G_DISABLE_CAST_CHECKS) && defined (__GNUC__)
+/* casts to the exact type of the instance or class don't need a call */
+#  define _G_TYPE_CIC(ip, gt, ct)       ((ct*) (G_GNUC_EXTENSION ({ \
+  GTypeInstance *__inst = (GTypeInstance*) ip; GType __t = gt; \
+  if (!__inst || !__inst->g_class || __inst->g_class->g_type != __t) \
+    __inst = g_type_check_instance_cast (__inst, __t); \
+  __inst; \
+})))
+#  define _G_TYPE_CCC(cp, gt, ct)       ((ct*) (G_GNUC_EXTENSION ({ \
+  GTypeClass *__class = (GTypeClass*) cp; GType __t = gt; \
+  if (!__class || __class->g_type != __t) \
+    __class = g_type_check_class_cast (__class, __t); \
+  __class; \
+})))
+#elif !defined (G_DISABLE_CAST_CHECKS)
 #  define _G_TYPE_CIC(ip, gt, ct) \
     ((ct*) g_type_check_instance_cast ((GTypeInstance*) ip, gt))
 #  define _G_TYPE_CCC(cp, gt, ct) \
@@ -119,6 +119,20 @@ typedef struct {
   GValueTransform func;
 } TransformEntry;
 
+/* Result of transform_func_lookup() for one (src, dest) pair, which may
+ * be a NULL @func.  Entries are immutable and owned by
+ * transform_cache_ht; a registration bumps transform_cache_generation,
+ * after which older entries are ignored and looked up again.
+ */
+typedef struct {
+  GType src_type;
+  GType dest_type;
+  GValueTransform func;
+  guint generation;
+} TransformCacheEntry;
+
+#define TRANSFORM_CACHE_SIZE 64
+
 
 /* --- prototypes --- */
 static gint	transform_entries_cmp	(gconstpointer bsearch_node1,
@@ -132,6 +146,14 @@ static GBSearchConfig transform_bconfig = {
   transform_entries_cmp,
   G_BSEARCH_ARRAY_ALIGN_POWER2,
 };
+/* lock-free, direct-mapped cache of TransformCacheEntry pointers */
+static TransformCacheEntry *transform_cache[TRANSFORM_CACHE_SIZE];
+static volatile guint transform_cache_generation = 0;
+/* all cache entries ever created, so slots never own memory, protected
+ * by transform_cache_lock
+ */
+static GHashTable *transform_cache_ht = NULL;
+static GMutex transform_cache_lock;
 
 
 /* --- functions --- */
@@ -141,6 +163,32 @@ _g_value_c_init (void)
   transform_array = g_bsearch_array_create (&transform_bconfig);
 }
 
+/* Whether values of @value_type are stored entirely in data[0] and
+ * copied as is, which is true for the scalar fundamental types.
+ */
+static inline gboolean
+value_type_is_plain (GType value_type)
+{
+  switch (value_type)
+    {
+    case G_TYPE_CHAR:
+    case G_TYPE_UCHAR:
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_LONG:
+    case G_TYPE_ULONG:
+    case G_TYPE_INT64:
+    case G_TYPE_UINT64:
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+    case G_TYPE_POINTER:
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
 static inline void		/* keep this function in sync with gvaluecollector.h and gboxed.c */
 value_meminit (GValue *value,
 	       GType   value_type)
@@ -204,7 +252,16 @@ g_value_copy (const GValue *src_value,
   g_return_if_fail (G_IS_VALUE (dest_value));
   g_return_if_fail (g_value_type_compatible (G_VALUE_TYPE (src_value), G_VALUE_TYPE (dest_value)));
   
-  if (src_value != dest_value)
+  if (src_value == dest_value)
+    return;
+
+  if (G_VALUE_TYPE (src_value) == G_VALUE_TYPE (dest_value) &&
+      value_type_is_plain (G_VALUE_TYPE (src_value)))
+    {
+      /* nothing to free or reference, just the data itself */
+      dest_value->data[0] = src_value->data[0];
+    }
+  else
     {
       GType dest_type = G_VALUE_TYPE (dest_value);
       GTypeValueTable *value_table = g_type_value_table_peek (dest_type);
@@ -474,6 +531,67 @@ transform_func_lookup (GType src_type,
   return NULL;
 }
 
+static guint
+transform_cache_hash (gconstpointer key)
+{
+  const TransformCacheEntry *entry = key;
+
+  return (guint) (entry->src_type * 31 + entry->dest_type) * 2654435761u;
+}
+
+static gboolean
+transform_cache_equal (gconstpointer a,
+                       gconstpointer b)
+{
+  const TransformCacheEntry *e1 = a, *e2 = b;
+
+  return e1->src_type == e2->src_type && e1->dest_type == e2->dest_type;
+}
+
+/* Same as transform_func_lookup(), memoized. */
+static GValueTransform
+transform_func_lookup_cached (GType src_type,
+                              GType dest_type)
+{
+  TransformCacheEntry key, *entry;
+  guint generation, slot;
+
+  key.src_type = src_type;
+  key.dest_type = dest_type;
+  slot = (transform_cache_hash (&key) >> 26) % TRANSFORM_CACHE_SIZE;
+  generation = g_atomic_int_get (&transform_cache_generation);
+
+  entry = g_atomic_pointer_get (&transform_cache[slot]);
+  if (entry &&
+      entry->src_type == src_type &&
+      entry->dest_type == dest_type &&
+      entry->generation == generation)
+    return entry->func;
+
+  g_mutex_lock (&transform_cache_lock);
+
+  if (transform_cache_ht == NULL)
+    transform_cache_ht = g_hash_table_new (transform_cache_hash, transform_cache_equal);
+
+  entry = g_hash_table_lookup (transform_cache_ht, &key);
+  if (entry == NULL || entry->generation != generation)
+    {
+      /* a stale entry may still be read from a slot, so it is kept */
+      entry = g_new (TransformCacheEntry, 1);
+      entry->src_type = src_type;
+      entry->dest_type = dest_type;
+      entry->func = transform_func_lookup (src_type, dest_type);
+      entry->generation = generation;
+      g_hash_table_replace (transform_cache_ht, entry, entry);
+    }
+
+  g_mutex_unlock (&transform_cache_lock);
+
+  g_atomic_pointer_set (&transform_cache[slot], entry);
+
+  return entry->func;
+}
+
 static gint
 transform_entries_cmp (gconstpointer bsearch_node1,
 		       gconstpointer bsearch_node2)
@@ -525,6 +643,8 @@ g_value_register_transform_func (GType           src_type,
 
   entry.func = transform_func;
   transform_array = g_bsearch_array_replace (transform_array, &transform_bconfig, &entry);
+
+  g_atomic_int_inc (&transform_cache_generation);
 }
 
 /**
@@ -547,7 +667,7 @@ g_value_type_transformable (GType src_type,
   g_return_val_if_fail (G_TYPE_IS_VALUE (dest_type), FALSE);
 
   return (g_value_type_compatible (src_type, dest_type) ||
-	  transform_func_lookup (src_type, dest_type) != NULL);
+	  transform_func_lookup_cached (src_type, dest_type) != NULL);
 }
 
 /**
@@ -567,6 +687,9 @@ g_value_type_compatible (GType src_type,
   g_return_val_if_fail (G_TYPE_IS_VALUE (src_type), FALSE);
   g_return_val_if_fail (G_TYPE_IS_VALUE (dest_type), FALSE);
 
+  if (src_type == dest_type)
+    return TRUE;
+
   return (g_type_is_a (src_type, dest_type) &&
 	  g_type_value_table_peek (dest_type) == g_type_value_table_peek (src_type));
 }
@@ -605,7 +728,7 @@ g_value_transform (const GValue *src_value,
     }
   else
     {
-      GValueTransform transform = transform_func_lookup (G_VALUE_TYPE (src_value), dest_type);
+      GValueTransform transform = transform_func_lookup_cached (G_VALUE_TYPE (src_value), dest_type);
 
       if (transform)
 	{
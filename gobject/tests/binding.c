@@ -625,6 +625,75 @@ binding_unbind (void)
   g_object_unref (source);
 }
 
+static gboolean
+unbind_other_transform (GBinding     *binding,
+                        const GValue *from_value,
+                        GValue       *to_value,
+                        gpointer      user_data)
+{
+  GBinding **other = user_data;
+
+  if (*other != NULL)
+    g_binding_unbind (*other);
+
+  g_value_copy (from_value, to_value);
+
+  return TRUE;
+}
+
+static void
+binding_many (void)
+{
+  BindingSource *source = g_object_new (binding_source_get_type (), NULL);
+  BindingTarget *targets[10], *last;
+  GBinding *other;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (targets); i++)
+    {
+      targets[i] = g_object_new (binding_target_get_type (), NULL);
+      g_object_bind_property (source, "foo", targets[i], "bar", G_BINDING_DEFAULT);
+      g_object_bind_property (source, "value", targets[i], "value", G_BINDING_BIDIRECTIONAL);
+    }
+
+  g_object_set (source, "foo", 42, "value", 1.5, NULL);
+  for (i = 0; i < G_N_ELEMENTS (targets); i++)
+    {
+      g_assert_cmpint (targets[i]->bar, ==, 42);
+      g_assert_cmpfloat (targets[i]->value, ==, 1.5);
+    }
+
+  g_object_set (targets[3], "value", 2.5, NULL);
+  g_assert_cmpfloat (source->value, ==, 2.5);
+  for (i = 0; i < G_N_ELEMENTS (targets); i++)
+    g_assert_cmpfloat (targets[i]->value, ==, 2.5);
+
+  /* a target going away takes its bindings with it */
+  g_object_unref (targets[0]);
+  targets[0] = g_object_new (binding_target_get_type (), NULL);
+
+  /* bindings removed while the notification is being dispatched don't run */
+  last = g_object_new (binding_target_get_type (), NULL);
+  g_object_bind_property_full (source, "foo", targets[0], "bar",
+                               G_BINDING_DEFAULT,
+                               unbind_other_transform, NULL,
+                               &other, NULL);
+  other = g_object_bind_property (source, "foo", last, "bar", G_BINDING_DEFAULT);
+  g_object_add_weak_pointer (G_OBJECT (other), (gpointer *) &other);
+
+  g_object_set (source, "foo", 7, NULL);
+  for (i = 0; i < G_N_ELEMENTS (targets); i++)
+    g_assert_cmpint (targets[i]->bar, ==, 7);
+  g_assert_cmpint (last->bar, ==, 0);
+  g_assert (other == NULL);
+
+  g_object_unref (source);
+
+  for (i = 0; i < G_N_ELEMENTS (targets); i++)
+    g_object_unref (targets[i]);
+  g_object_unref (last);
+}
+
 static void
 binding_fail (void)
 {
@@ -665,6 +734,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/binding/invert-boolean", binding_invert_boolean);
   g_test_add_func ("/binding/same-object", binding_same_object);
   g_test_add_func ("/binding/unbind", binding_unbind);
+  g_test_add_func ("/binding/many", binding_many);
   g_test_add_func ("/binding/fail", binding_fail);
 
   return g_test_run ();
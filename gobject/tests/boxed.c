@@ -615,6 +615,54 @@ test_boxed_checksum (void)
   g_value_unset (&value);
 }
 
+static gboolean
+idle_once (gpointer user_data)
+{
+  return G_SOURCE_REMOVE;
+}
+
+static void
+test_boxed_source_stats (void)
+{
+  GMainContext *ctx;
+  GPtrArray *stats;
+  GSource *source;
+  GSourceStats *s, *s2;
+  GValue value = G_VALUE_INIT;
+
+  ctx = g_main_context_new ();
+  g_main_context_set_source_stats_enabled (ctx, TRUE);
+  source = g_idle_source_new ();
+  g_source_set_name (source, "idle");
+  g_source_set_callback (source, idle_once, NULL, NULL);
+  g_source_attach (source, ctx);
+  g_source_unref (source);
+  g_main_context_iteration (ctx, FALSE);
+
+  stats = g_main_context_get_source_stats (ctx);
+  g_assert_cmpuint (stats->len, ==, 1);
+
+  g_value_init (&value, G_TYPE_SOURCE_STATS);
+  g_assert (G_VALUE_HOLDS_BOXED (&value));
+
+  s = g_source_stats_copy (stats->pdata[0]);
+  g_value_take_boxed (&value, s);
+
+  s2 = g_value_get_boxed (&value);
+  g_assert (s == s2);
+
+  s2 = g_value_dup_boxed (&value);
+  g_assert (s != s2);
+  g_assert_cmpstr (s2->name, ==, "idle");
+  g_assert (s2->name != s->name);
+  g_assert_cmpuint (s2->dispatch_count, ==, s->dispatch_count);
+  g_source_stats_free (s2);
+
+  g_value_unset (&value);
+  g_ptr_array_unref (stats);
+  g_main_context_unref (ctx);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -644,6 +692,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/boxed/markup", test_boxed_markup);
   g_test_add_func ("/boxed/thread", test_boxed_thread);
   g_test_add_func ("/boxed/checksum", test_boxed_checksum);
+  g_test_add_func ("/boxed/source-stats", test_boxed_source_stats);
 
   return g_test_run ();
 }
@@ -116,6 +116,98 @@ test_flags_basic (void)
   g_type_class_unref (class);
 }
 
+/* Big enough for the lookups to use the name and nick index */
+#define N_LARGE_VALUES 40
+
+static void
+test_enum_large (void)
+{
+  GEnumValue *values;
+  GEnumClass *class;
+  GEnumValue *val;
+  GType type;
+  gint i;
+
+  values = g_new0 (GEnumValue, N_LARGE_VALUES + 2);
+  for (i = 0; i < N_LARGE_VALUES; i++)
+    {
+      values[i].value = i * 3;
+      values[i].value_name = g_strdup_printf ("LARGE_ENUM_VALUE_%d", i);
+      values[i].value_nick = g_strdup_printf ("value-%d", i);
+    }
+  /* a duplicate name: lookups find the first one */
+  values[i].value = 1000;
+  values[i].value_name = values[0].value_name;
+  values[i].value_nick = values[0].value_nick;
+
+  type = g_enum_register_static ("MyLargeEnum", values);
+  class = g_type_class_ref (type);
+
+  for (i = 0; i < N_LARGE_VALUES; i++)
+    {
+      gchar *name = g_strdup_printf ("LARGE_ENUM_VALUE_%d", i);
+      gchar *nick = g_strdup_printf ("value-%d", i);
+
+      val = g_enum_get_value_by_name (class, name);
+      g_assert (val == &values[i]);
+      val = g_enum_get_value_by_nick (class, nick);
+      g_assert (val == &values[i]);
+
+      g_free (name);
+      g_free (nick);
+    }
+
+  g_assert_null (g_enum_get_value_by_name (class, "LARGE_ENUM_VALUE_40"));
+  g_assert_null (g_enum_get_value_by_nick (class, "value-40"));
+  g_assert_null (g_enum_get_value_by_nick (class, "LARGE_ENUM_VALUE_0"));
+
+  g_type_class_unref (class);
+}
+
+static void
+test_flags_large (void)
+{
+  GFlagsValue *values;
+  GFlagsClass *class;
+  GFlagsValue *val;
+  GType type;
+  gint i;
+
+  values = g_new0 (GFlagsValue, N_LARGE_VALUES + 1);
+  for (i = 0; i < N_LARGE_VALUES; i++)
+    {
+      values[i].value = 1u << (i % 32);
+      values[i].value_name = g_strdup_printf ("LARGE_FLAGS_VALUE_%d", i);
+      /* flag nick lookups stop at the first value without a nick */
+      if (i != N_LARGE_VALUES / 2)
+        values[i].value_nick = g_strdup_printf ("flag-%d", i);
+    }
+
+  type = g_flags_register_static ("MyLargeFlags", values);
+  class = g_type_class_ref (type);
+
+  for (i = 0; i < N_LARGE_VALUES; i++)
+    {
+      gchar *name = g_strdup_printf ("LARGE_FLAGS_VALUE_%d", i);
+      gchar *nick = g_strdup_printf ("flag-%d", i);
+
+      val = g_flags_get_value_by_name (class, name);
+      g_assert (val == &values[i]);
+      val = g_flags_get_value_by_nick (class, nick);
+      if (i < N_LARGE_VALUES / 2)
+        g_assert (val == &values[i]);
+      else
+        g_assert_null (val);
+
+      g_free (name);
+      g_free (nick);
+    }
+
+  g_assert_null (g_flags_get_value_by_name (class, "LARGE_FLAGS_VALUE_40"));
+
+  g_type_class_unref (class);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -123,6 +215,8 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/enum/basic", test_enum_basic);
   g_test_add_func ("/flags/basic", test_flags_basic);
+  g_test_add_func ("/enum/large", test_enum_large);
+  g_test_add_func ("/flags/large", test_flags_large);
 
   return g_test_run ();
 }
@@ -438,6 +438,59 @@ test_set (void)
   g_object_unref (object);
 }
 
+/* Test setting and getting the properties through pre-resolved pspecs */
+static void
+test_set_by_pspec (void)
+{
+  GObjectClass *object_class;
+  BaseObject *object;
+  GParamSpec *pspecs[4], *other;
+  GValue value = G_VALUE_INIT;
+  gint i, round;
+
+  object_class = g_type_class_ref (DERIVED_TYPE_OBJECT);
+  pspecs[0] = g_object_class_find_property (object_class, "prop1");
+  pspecs[1] = g_object_class_find_property (object_class, "prop2");
+  pspecs[2] = g_object_class_find_property (object_class, "prop3");
+  pspecs[3] = g_object_class_find_property (object_class, "prop4");
+
+  object = g_object_new (DERIVED_TYPE_OBJECT, NULL);
+  g_value_init (&value, G_TYPE_INT);
+
+  /* the second round is served from the class' cache */
+  for (round = 0; round < 2; round++)
+    {
+      for (i = 0; i < 4; i++)
+        {
+          g_value_set_int (&value, (i + 1) * 0x0101 + round);
+          g_object_set_property_by_pspec (G_OBJECT (object), pspecs[i], &value);
+        }
+
+      g_assert_cmpint (object->val1, ==, 0x0101 + round);
+      g_assert_cmpint (object->val2, ==, 0x0202 + round);
+      g_assert_cmpint (object->val3, ==, 0x0303 + round);
+      g_assert_cmpint (object->val4, ==, 0x0404 + round);
+
+      for (i = 0; i < 4; i++)
+        {
+          g_object_get_property_by_pspec (G_OBJECT (object), pspecs[i], &value);
+          g_assert_cmpint (g_value_get_int (&value), ==, (i + 1) * 0x0101 + round);
+        }
+    }
+
+  /* a pspec with a matching name that doesn't belong to the class */
+  other = g_param_spec_int ("prop1", "Prop1", "Property 1", G_MININT, G_MAXINT, 0, G_PARAM_READWRITE);
+  g_param_spec_ref_sink (other);
+  g_test_expect_message (G_LOG_DOMAIN, G_LOG_LEVEL_WARNING, "*has no property named 'prop1'*");
+  g_object_get_property_by_pspec (G_OBJECT (object), other, &value);
+  g_test_assert_expected_messages ();
+  g_param_spec_unref (other);
+
+  g_value_unset (&value);
+  g_object_unref (object);
+  g_type_class_unref (object_class);
+}
+
 /* Test that the right spec is passed on explicit notifications */
 static void
 test_notify (void)
@@ -635,6 +688,7 @@ main (int argc, char *argv[])
   g_test_bug_base ("http://bugzilla.gnome.org/");
 
   g_test_add_func ("/interface/properties/set", test_set);
+  g_test_add_func ("/interface/properties/set-by-pspec", test_set_by_pspec);
   g_test_add_func ("/interface/properties/notify", test_notify);
   g_test_add_func ("/interface/properties/find-overridden", test_find_overridden);
   g_test_add_func ("/interface/properties/list-overridden", test_list_overridden);
@@ -1,6 +1,7 @@
 #define GLIB_DISABLE_DEPRECATION_WARNINGS
 #include <glib-object.h>
 #include <stdlib.h>
+#include <math.h>
 
 static void
 test_param_value (void)
@@ -85,6 +86,91 @@ test_param_validate (void)
   g_param_spec_unref (p);
 }
 
+static void
+test_param_validate_numeric (void)
+{
+  GParamSpec *p, *o;
+  GValue value = G_VALUE_INIT;
+  GValue value2 = G_VALUE_INIT;
+
+  p = g_param_spec_char ("my-char", NULL, NULL, -10, 10, 0, G_PARAM_READWRITE);
+  g_value_init (&value, G_TYPE_CHAR);
+  g_value_set_schar (&value, -100);
+  g_assert (g_param_value_validate (p, &value));
+  g_assert_cmpint (g_value_get_schar (&value), ==, -10);
+  g_assert (!g_param_value_validate (p, &value));
+  g_value_unset (&value);
+  g_param_spec_unref (p);
+
+  p = g_param_spec_boolean ("my-boolean", NULL, NULL, FALSE, G_PARAM_READWRITE);
+  g_value_init (&value, G_TYPE_BOOLEAN);
+  value.data[0].v_int = 42;
+  g_assert (g_param_value_validate (p, &value));
+  g_assert_cmpint (value.data[0].v_int, ==, TRUE);
+  g_assert (!g_param_value_validate (p, &value));
+  g_value_unset (&value);
+  g_param_spec_unref (p);
+
+  /* full range */
+  p = g_param_spec_int ("my-int", NULL, NULL, G_MININT, G_MAXINT, 0, G_PARAM_READWRITE);
+  g_value_init (&value, G_TYPE_INT);
+  g_value_set_int (&value, G_MININT);
+  g_assert (!g_param_value_validate (p, &value));
+  g_value_set_int (&value, G_MAXINT);
+  g_assert (!g_param_value_validate (p, &value));
+  g_value_unset (&value);
+  g_param_spec_unref (p);
+
+  p = g_param_spec_uint64 ("my-uint64", NULL, NULL, 5, 10, 5, G_PARAM_READWRITE);
+  g_value_init (&value, G_TYPE_UINT64);
+  g_value_set_uint64 (&value, G_MAXUINT64);
+  g_assert (g_param_value_validate (p, &value));
+  g_assert_cmpuint (g_value_get_uint64 (&value), ==, 10);
+  g_value_set_uint64 (&value, 0);
+  g_assert (g_param_value_validate (p, &value));
+  g_assert_cmpuint (g_value_get_uint64 (&value), ==, 5);
+  g_value_unset (&value);
+  g_param_spec_unref (p);
+
+  p = g_param_spec_double ("my-double", NULL, NULL, -G_MAXDOUBLE, G_MAXDOUBLE, 0, G_PARAM_READWRITE);
+  g_value_init (&value, G_TYPE_DOUBLE);
+  g_value_init (&value2, G_TYPE_DOUBLE);
+  g_value_set_double (&value, 1.5);
+  g_assert (!g_param_value_validate (p, &value));
+  g_value_set_double (&value, NAN);
+  g_assert (g_param_value_validate (p, &value));
+  g_value_set_double (&value, 1.0);
+  g_value_set_double (&value2, 1.0 + G_PARAM_SPEC_DOUBLE (p)->epsilon / 2);
+  g_assert_cmpint (g_param_values_cmp (p, &value, &value2), ==, 0);
+  g_value_set_double (&value2, 2.0);
+  g_assert_cmpint (g_param_values_cmp (p, &value, &value2), ==, -1);
+  g_assert_cmpint (g_param_values_cmp (p, &value2, &value), ==, 1);
+  g_value_unset (&value);
+  g_value_unset (&value2);
+  g_param_spec_unref (p);
+
+  /* these share their value types with the numeric pspecs, but
+   * must still be validated by their own class
+   */
+  p = g_param_spec_unichar ("my-unichar", NULL, NULL, 'a', G_PARAM_READWRITE);
+  g_value_init (&value, G_TYPE_UINT);
+  g_value_set_uint (&value, 0x110000);
+  g_assert (g_param_value_validate (p, &value));
+  g_assert_cmpuint (g_value_get_uint (&value), ==, 0);
+  g_value_unset (&value);
+  g_param_spec_unref (p);
+
+  p = g_param_spec_int ("my-int", NULL, NULL, 0, 20, 10, G_PARAM_READWRITE);
+  o = g_param_spec_override ("my-int", p);
+  g_value_init (&value, G_TYPE_INT);
+  g_value_set_int (&value, -5);
+  g_assert (g_param_value_validate (o, &value));
+  g_assert_cmpint (g_value_get_int (&value), ==, 0);
+  g_value_unset (&value);
+  g_param_spec_unref (o);
+  g_param_spec_unref (p);
+}
+
 static void
 test_param_strings (void)
 {
@@ -838,6 +924,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/param/strings", test_param_strings);
   g_test_add_func ("/param/qdata", test_param_qdata);
   g_test_add_func ("/param/validate", test_param_validate);
+  g_test_add_func ("/param/validate-numeric", test_param_validate_numeric);
   g_test_add_func ("/param/convert", test_param_convert);
 
   if (g_test_slow ())
@@ -356,6 +356,169 @@ properties_construct (void)
   g_object_unref (obj);
 }
 
+typedef struct {
+  TestObject parent_instance;
+  guint n_notify;
+} NotifyObject;
+
+typedef struct {
+  TestObjectClass parent_class;
+} NotifyObjectClass;
+
+static GType notify_object_get_type (void);
+G_DEFINE_TYPE (NotifyObject, notify_object, test_object_get_type ())
+
+static void
+notify_object_notify (GObject    *gobject,
+                      GParamSpec *pspec)
+{
+  ((NotifyObject *) gobject)->n_notify++;
+}
+
+static void
+notify_object_class_init (NotifyObjectClass *klass)
+{
+  G_OBJECT_CLASS (klass)->notify = notify_object_notify;
+}
+
+static void
+notify_object_init (NotifyObject *self)
+{
+}
+
+static void
+count_notify (GObject    *object,
+              GParamSpec *pspec,
+              guint      *count)
+{
+  (*count)++;
+}
+
+static void
+properties_construct_notify (void)
+{
+  NotifyObject *nobj;
+  TestObject *obj;
+  guint count = 0;
+  gint val;
+
+  /* notifications queued during construction are only dropped when
+   * nothing would observe them; a notify vfunc does
+   */
+  nobj = g_object_new (notify_object_get_type (), "foo", 1, "bar", FALSE, NULL);
+  g_assert_cmpuint (nobj->n_notify, ==, 2);
+  g_object_unref (nobj);
+
+  obj = g_object_new (test_object_get_type (), "foo", 2, NULL);
+  g_object_get (obj, "foo", &val, NULL);
+  g_assert_cmpint (val, ==, 2);
+
+  /* the dropped notifications don't leak into later ones */
+  g_signal_connect (obj, "notify::foo", G_CALLBACK (count_notify), &count);
+  g_object_set (obj, "bar", FALSE, NULL);
+  g_assert_cmpuint (count, ==, 0);
+  g_object_set (obj, "foo", 3, NULL);
+  g_assert_cmpuint (count, ==, 1);
+  g_object_unref (obj);
+}
+
+#define N_MANY_PROPERTIES 20
+
+typedef struct {
+  GObject parent_instance;
+  gint values[N_MANY_PROPERTIES + 1];
+} ManyObject;
+
+typedef GObjectClass ManyObjectClass;
+
+static GType many_object_get_type (void);
+G_DEFINE_TYPE (ManyObject, many_object, G_TYPE_OBJECT)
+
+static void
+many_object_set_property (GObject      *gobject,
+                          guint         prop_id,
+                          const GValue *value,
+                          GParamSpec   *pspec)
+{
+  ((ManyObject *) gobject)->values[prop_id] = g_value_get_int (value);
+}
+
+static void
+many_object_get_property (GObject    *gobject,
+                          guint       prop_id,
+                          GValue     *value,
+                          GParamSpec *pspec)
+{
+  g_value_set_int (value, ((ManyObject *) gobject)->values[prop_id]);
+}
+
+static void
+many_object_class_init (ManyObjectClass *klass)
+{
+  guint i;
+
+  klass->set_property = many_object_set_property;
+  klass->get_property = many_object_get_property;
+
+  for (i = 1; i <= N_MANY_PROPERTIES; i++)
+    {
+      gchar *name = g_strdup_printf ("p%u", i);
+
+      g_object_class_install_property (klass, i,
+                                       g_param_spec_int (name, name, name,
+                                                         0, G_MAXINT, 0,
+                                                         G_PARAM_READWRITE));
+      g_free (name);
+    }
+}
+
+static void
+many_object_init (ManyObject *self)
+{
+}
+
+static void
+on_notify_many (GObject    *gobject,
+                GParamSpec *pspec,
+                GString    *order)
+{
+  g_string_append_printf (order, "%s ", pspec->name);
+}
+
+static void
+properties_notify_queue_many (void)
+{
+  ManyObject *obj = g_object_new (many_object_get_type (), NULL);
+  GString *order = g_string_new (NULL);
+  GString *expected = g_string_new (NULL);
+  guint i, round;
+
+  g_signal_connect (obj, "notify", G_CALLBACK (on_notify_many), order);
+
+  /* more properties than the queue has preallocated, each set twice */
+  g_object_freeze_notify (G_OBJECT (obj));
+  for (round = 0; round < 2; round++)
+    for (i = 1; i <= N_MANY_PROPERTIES; i++)
+      {
+        gchar *name = g_strdup_printf ("p%u", i);
+
+        g_object_set (obj, name, i + round, NULL);
+        g_free (name);
+      }
+  g_assert_cmpstr (order->str, ==, "");
+  g_object_thaw_notify (G_OBJECT (obj));
+
+  /* one notification each, in reverse order */
+  for (i = N_MANY_PROPERTIES; i > 0; i--)
+    g_string_append_printf (expected, "p%u ", i);
+  g_assert_cmpstr (order->str, ==, expected->str);
+  g_assert_cmpint (obj->values[N_MANY_PROPERTIES], ==, N_MANY_PROPERTIES + 1);
+
+  g_string_free (expected, TRUE);
+  g_string_free (order, TRUE);
+  g_object_unref (obj);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -366,7 +529,9 @@ main (int argc, char *argv[])
   g_test_add_func ("/properties/install", properties_install);
   g_test_add_func ("/properties/notify", properties_notify);
   g_test_add_func ("/properties/notify-queue", properties_notify_queue);
+  g_test_add_func ("/properties/notify-queue-many", properties_notify_queue_many);
   g_test_add_func ("/properties/construct", properties_construct);
+  g_test_add_func ("/properties/construct-notify", properties_construct_notify);
 
   return g_test_run ();
 }
@@ -258,6 +258,24 @@ test_class_init (TestClass *klass)
                 0);
   g_signal_set_va_marshaller (s, G_TYPE_FROM_CLASS (klass),
 			      test_UINT__VOIDv);
+  g_signal_new ("object-arg",
+                G_TYPE_FROM_CLASS (klass),
+                G_SIGNAL_RUN_LAST,
+                0,
+                NULL, NULL,
+                NULL,
+                G_TYPE_NONE,
+                1,
+                G_TYPE_OBJECT);
+  g_signal_new ("direct-marshaller",
+                G_TYPE_FROM_CLASS (klass),
+                G_SIGNAL_RUN_LAST,
+                0,
+                NULL, NULL,
+                NULL,
+                G_TYPE_BOOLEAN,
+                3,
+                G_TYPE_STRING, G_TYPE_CHAR, G_TYPE_OBJECT);
   g_signal_new ("custom-marshaller",
                 G_TYPE_FROM_CLASS (klass),
                 G_SIGNAL_RUN_LAST,
@@ -1081,6 +1099,8 @@ test_introspection (void)
     "all-types-null",
     "all-types-empty",
     "custom-marshaller",
+    "direct-marshaller",
+    "object-arg",
     NULL
   };
   GSignalQuery query;
@@ -1209,6 +1229,283 @@ test_stop_emission (void)
   g_object_unref (test1);
 }
 
+typedef struct
+{
+  GString *order;
+  gulong blocked;
+  gulong disconnected;
+} MultiData;
+
+static void
+multi_handler (gpointer instance, gpointer data)
+{
+  MultiData *multi = data;
+  GSignalInvocationHint *ihint;
+
+  ihint = g_signal_get_invocation_hint (instance);
+  g_string_append_c (multi->order, ihint->run_type == G_SIGNAL_RUN_FIRST ? 'F' : 'L');
+}
+
+static void
+multi_block_handler (gpointer instance, gpointer data)
+{
+  MultiData *multi = data;
+
+  g_string_append_c (multi->order, 'b');
+  if (multi->blocked)
+    {
+      g_signal_handler_block (instance, multi->blocked);
+      g_signal_handler_disconnect (instance, multi->disconnected);
+      multi->blocked = multi->disconnected = 0;
+    }
+}
+
+static void
+test_multiple_handlers (void)
+{
+  MultiData multi;
+  GObject *test;
+  gulong handler;
+
+  multi.order = g_string_new (NULL);
+  test = g_object_new (test_get_type (), NULL);
+
+  /* nothing connected anywhere */
+  g_signal_emit (test, simple_id, 0);
+
+  g_signal_connect_after (test, "simple", G_CALLBACK (multi_handler), &multi);
+  g_signal_connect (test, "simple", G_CALLBACK (multi_handler), &multi);
+  handler = g_signal_connect (test, "simple", G_CALLBACK (multi_handler), &multi);
+
+  g_signal_emit (test, simple_id, 0);
+  g_assert_cmpstr (multi.order->str, ==, "FFL");
+
+  /* handlers blocked or disconnected during the emission are skipped */
+  g_string_truncate (multi.order, 0);
+  g_signal_handler_disconnect (test, handler);
+  g_signal_connect (test, "simple", G_CALLBACK (multi_block_handler), &multi);
+  multi.blocked = g_signal_connect (test, "simple", G_CALLBACK (multi_handler), &multi);
+  multi.disconnected = g_signal_connect_after (test, "simple", G_CALLBACK (multi_handler), &multi);
+  g_signal_emit (test, simple_id, 0);
+  g_assert_cmpstr (multi.order->str, ==, "FbL");
+
+  g_string_truncate (multi.order, 0);
+  g_signal_emit (test, simple_id, 0);
+  g_assert_cmpstr (multi.order->str, ==, "FbL");
+
+  g_object_unref (test);
+
+  /* and once all handlers are gone, the emission does nothing again */
+  test = g_object_new (test_get_type (), NULL);
+  g_signal_emit (test, simple_id, 0);
+  g_signal_connect (test, "simple", G_CALLBACK (multi_handler), &multi);
+  g_string_truncate (multi.order, 0);
+  g_signal_emit (test, simple_id, 0);
+  g_assert_cmpstr (multi.order->str, ==, "F");
+  g_object_unref (test);
+
+  g_string_free (multi.order, TRUE);
+}
+
+static void
+object_arg_unref (gpointer instance, GObject *object, gpointer data)
+{
+  GObject **owned = data;
+
+  g_assert (object == *owned);
+  g_clear_object (owned);
+}
+
+static void
+object_arg_check (gpointer instance, GObject *object, gpointer data)
+{
+  g_assert (G_IS_OBJECT (object));
+}
+
+static void
+test_multiple_handlers_object_arg (void)
+{
+  GObject *test, *arg, *owned;
+
+  test = g_object_new (test_get_type (), NULL);
+  arg = owned = g_object_new (test_get_type (), NULL);
+  g_object_add_weak_pointer (arg, (gpointer *) &arg);
+
+  g_signal_connect (test, "object-arg", G_CALLBACK (object_arg_unref), &owned);
+  g_signal_connect (test, "object-arg", G_CALLBACK (object_arg_check), NULL);
+
+  /* the emission holds a reference on the argument throughout */
+  g_signal_emit_by_name (test, "object-arg", arg);
+  g_assert (owned == NULL);
+  g_assert (arg == NULL);
+
+  g_object_unref (test);
+}
+
+static gboolean
+direct_marshaller_handler (Test        *test,
+                           const gchar *str,
+                           gchar        c,
+                           GObject     *object,
+                           gpointer     data)
+{
+  const gchar *orig = data;
+
+  /* the string is copied for the emission, the object kept alive */
+  g_assert (str != orig);
+  g_assert_cmpstr (str, ==, orig);
+  g_assert_cmpint (c, ==, -5);
+  g_assert (G_IS_OBJECT (object));
+  g_assert_cmpint (object->ref_count, ==, 2);
+
+  return TRUE;
+}
+
+static void
+test_direct_marshaller (void)
+{
+  GSignalQuery query;
+  GObject *test, *arg;
+  const gchar *str = "hello";
+  gboolean retval = FALSE;
+
+  test = g_object_new (test_get_type (), NULL);
+  arg = g_object_new (test_get_type (), NULL);
+
+  g_signal_query (g_signal_lookup ("direct-marshaller", test_get_type ()), &query);
+  g_assert_cmpuint (query.n_params, ==, 3);
+
+  g_signal_connect (test, "direct-marshaller", G_CALLBACK (direct_marshaller_handler), (gpointer) str);
+  g_signal_emit_by_name (test, "direct-marshaller", str, -5, arg, &retval);
+  g_assert (retval);
+  g_assert_cmpint (arg->ref_count, ==, 1);
+
+  g_object_unref (arg);
+  g_object_unref (test);
+}
+
+static void
+target_handler (GObject *sender,
+                GObject *target)
+{
+  g_assert (G_IS_OBJECT (target));
+}
+
+static void
+test_many_handlers (void)
+{
+  GObject *test, *targets[16];
+  GClosure *closure;
+  gint counts[64] = { 0, };
+  gulong handler;
+  gint count = 0;
+  guint i;
+
+  test = g_object_new (test_get_type (), NULL);
+
+  /* enough handlers for the instance to get a handler index */
+  for (i = 0; i < G_N_ELEMENTS (counts); i++)
+    {
+      g_signal_connect (test, "simple", G_CALLBACK (test_handler), &counts[i]);
+      g_signal_connect_after (test, "simple-2", G_CALLBACK (test_handler), &counts[i]);
+    }
+  for (i = 0; i < G_N_ELEMENTS (targets); i++)
+    {
+      targets[i] = g_object_new (test_get_type (), NULL);
+      g_signal_connect_object (test, "simple", G_CALLBACK (target_handler), targets[i], 0);
+    }
+
+  closure = g_cclosure_new (G_CALLBACK (test_handler), &count, NULL);
+  g_signal_connect_closure (test, "simple", closure, FALSE);
+  handler = g_signal_handler_find (test, G_SIGNAL_MATCH_CLOSURE, 0, 0, closure, NULL, NULL);
+  g_assert_cmpuint (handler, !=, 0);
+  g_assert_cmpuint (handler, ==, g_signal_handler_find (test, G_SIGNAL_MATCH_ID | G_SIGNAL_MATCH_DATA,
+                                                        simple_id, 0, NULL, NULL, &count));
+  g_assert_cmpuint (g_signal_handler_find (test, G_SIGNAL_MATCH_ID | G_SIGNAL_MATCH_DATA,
+                                           simple2_id, 0, NULL, NULL, &count), ==, 0);
+
+  g_signal_emit (test, simple_id, 0);
+  g_signal_emit (test, simple2_id, 0);
+  for (i = 0; i < G_N_ELEMENTS (counts); i++)
+    g_assert_cmpint (counts[i], ==, 2);
+  g_assert_cmpint (count, ==, 1);
+
+  /* disconnecting by data only touches the matching handlers */
+  for (i = 0; i < G_N_ELEMENTS (counts); i += 2)
+    g_assert_cmpuint (g_signal_handlers_disconnect_by_data (test, &counts[i]), ==, 2);
+  g_assert_cmpuint (g_signal_handlers_disconnect_matched (test, G_SIGNAL_MATCH_ID | G_SIGNAL_MATCH_DATA,
+                                                          simple2_id, 0, NULL, NULL, &counts[1]), ==, 1);
+  g_assert_cmpuint (g_signal_handlers_disconnect_by_func (test, test_handler, &counts[3]), ==, 2);
+
+  /* finalizing the targets disconnects their handlers by closure */
+  for (i = 0; i < G_N_ELEMENTS (targets); i++)
+    g_object_unref (targets[i]);
+
+  g_signal_handler_disconnect (test, handler);
+  g_assert_cmpuint (g_signal_handler_find (test, G_SIGNAL_MATCH_CLOSURE, 0, 0, closure, NULL, NULL), ==, 0);
+
+  g_signal_emit (test, simple_id, 0);
+  g_signal_emit (test, simple2_id, 0);
+  for (i = 0; i < G_N_ELEMENTS (counts); i++)
+    if (i % 2 == 0 || i == 3)
+      g_assert_cmpint (counts[i], ==, 2);
+    else if (i == 1)
+      g_assert_cmpint (counts[i], ==, 3);
+    else
+      g_assert_cmpint (counts[i], ==, 4);
+  g_assert_cmpint (count, ==, 1);
+
+  g_object_unref (test);
+}
+
+static GObject *shared_object;
+
+static gpointer
+connect_thread (gpointer data)
+{
+  GObject *test = g_object_new (test_get_type (), NULL);
+  gint count = 0, shared_count = 0;
+  guint i;
+
+  for (i = 0; i < 1000; i++)
+    {
+      gulong handler, shared_handler;
+
+      handler = g_signal_connect (test, "simple", G_CALLBACK (test_handler), &count);
+      shared_handler = g_signal_connect (shared_object, "simple-2", G_CALLBACK (test_handler), &shared_count);
+      g_signal_emit (test, simple_id, 0);
+      g_signal_handler_disconnect (test, handler);
+      g_signal_emit (test, simple_id, 0);
+      g_signal_handler_disconnect (shared_object, shared_handler);
+    }
+
+  g_assert_cmpint (count, ==, 1000);
+  g_object_unref (test);
+
+  return NULL;
+}
+
+static void
+test_threaded_connect (void)
+{
+  GThread *threads[8];
+  guint i;
+
+  shared_object = g_object_new (test_get_type (), NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("connect", connect_thread, NULL);
+
+  for (i = 0; i < 1000; i++)
+    g_signal_emit (shared_object, simple2_id, 0);
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  g_assert_cmpuint (g_signal_handler_find (shared_object, G_SIGNAL_MATCH_ID, simple2_id, 0, NULL, NULL, NULL), ==, 0);
+  g_object_unref (shared_object);
+}
+
 static void
 test_signal_disconnect_wrong_object (void)
 {
@@ -1263,12 +1560,17 @@ main (int argc,
   g_test_add_func ("/gobject/signals/generic-marshaller-int-return", test_generic_marshaller_signal_int_return);
   g_test_add_func ("/gobject/signals/generic-marshaller-uint-return", test_generic_marshaller_signal_uint_return);
   g_test_add_func ("/gobject/signals/custom-marshaller", test_custom_marshaller);
+  g_test_add_func ("/gobject/signals/direct-marshaller", test_direct_marshaller);
   g_test_add_func ("/gobject/signals/connect", test_connect);
   g_test_add_func ("/gobject/signals/emission-hook", test_emission_hook);
   g_test_add_func ("/gobject/signals/introspection", test_introspection);
   g_test_add_func ("/gobject/signals/block-handler", test_block_handler);
   g_test_add_func ("/gobject/signals/stop-emission", test_stop_emission);
   g_test_add_func ("/gobject/signals/invocation-hint", test_invocation_hint);
+  g_test_add_func ("/gobject/signals/multiple-handlers", test_multiple_handlers);
+  g_test_add_func ("/gobject/signals/multiple-handlers-object-arg", test_multiple_handlers_object_arg);
+  g_test_add_func ("/gobject/signals/many-handlers", test_many_handlers);
+  g_test_add_func ("/gobject/signals/threaded-connect", test_threaded_connect);
   g_test_add_func ("/gobject/signals/test-disconnection-wrong-object", test_signal_disconnect_wrong_object);
 
   return g_test_run ();
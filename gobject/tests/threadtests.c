@@ -336,6 +336,91 @@ test_threaded_weak_ref (void)
              get_wins, unref_wins);
 }
 
+typedef struct
+{
+  GWeakRef *shared;
+  guint     n_iterations;
+} RefsThreadData;
+
+static void
+count_weak_notify (gpointer  data,
+                   GObject  *where_the_object_was)
+{
+  (*(guint *) data)++;
+}
+
+static void
+nop_toggle_notify (gpointer  data,
+                   GObject  *object,
+                   gboolean  is_last_ref)
+{
+}
+
+static gpointer
+refs_thread (gpointer user_data)
+{
+  RefsThreadData *data = user_data;
+  guint notified = 0;
+  guint i;
+
+  for (i = 0; i < data->n_iterations; i++)
+    {
+      GObject *object, *strengthened;
+      GWeakRef weak;
+
+      object = g_object_new (my_tester0_get_type (), NULL);
+      g_weak_ref_init (&weak, object);
+      g_object_weak_ref (object, count_weak_notify, &notified);
+
+      /* from here on the toggle ref holds the only reference */
+      g_object_add_toggle_ref (object, nop_toggle_notify, NULL);
+      g_object_unref (object);
+
+      /* move the shared weak ref over, racing the other threads */
+      g_weak_ref_set (data->shared, object);
+      strengthened = g_weak_ref_get (data->shared);
+      if (strengthened != NULL)
+        {
+          g_assert (G_IS_OBJECT (strengthened));
+          g_object_unref (strengthened);
+        }
+
+      strengthened = g_weak_ref_get (&weak);
+      g_assert (strengthened == object);
+      g_object_unref (strengthened);
+
+      g_object_remove_toggle_ref (object, nop_toggle_notify, NULL);
+      g_assert (g_weak_ref_get (&weak) == NULL);
+      g_weak_ref_clear (&weak);
+    }
+
+  g_assert_cmpuint (notified, ==, data->n_iterations);
+
+  return NULL;
+}
+
+static void
+test_threaded_weak_and_toggle_refs (void)
+{
+  GThread *threads[4];
+  RefsThreadData data;
+  GWeakRef shared;
+  guint i;
+
+  g_weak_ref_init (&shared, NULL);
+  data.shared = &shared;
+  data.n_iterations = g_test_thorough () ? 100000 : 10000;
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("refs", refs_thread, &data);
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  /* all the objects are gone, so the shared weak ref must be too */
+  g_assert (g_weak_ref_get (&shared) == NULL);
+  g_weak_ref_clear (&shared);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -345,6 +430,7 @@ main (int   argc,
   /* g_test_add_func ("/GObject/threaded-class-init", test_threaded_class_init); */
   g_test_add_func ("/GObject/threaded-object-init", test_threaded_object_init);
   g_test_add_func ("/GObject/threaded-weak-ref", test_threaded_weak_ref);
+  g_test_add_func ("/GObject/threaded-weak-and-toggle-refs", test_threaded_weak_and_toggle_refs);
 
   return g_test_run();
 }
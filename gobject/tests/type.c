@@ -128,6 +128,38 @@ test_interface_check (void)
   g_type_remove_interface_check (&check_called, check_func);
 }
 
+static void
+test_instance_check (void)
+{
+  GObject *o;
+  gint i;
+
+  o = g_object_new (bazo_get_type (), NULL);
+
+  /* the second round is answered from the interface cache */
+  for (i = 0; i < 2; i++)
+    {
+      g_assert (G_TYPE_CHECK_INSTANCE_TYPE (o, bazo_get_type ()));
+      g_assert (G_TYPE_CHECK_INSTANCE_TYPE (o, G_TYPE_INITIALLY_UNOWNED));
+      g_assert (G_TYPE_CHECK_INSTANCE_TYPE (o, G_TYPE_OBJECT));
+      g_assert (G_TYPE_CHECK_INSTANCE_TYPE (o, baz_get_type ()));
+      g_assert (!G_TYPE_CHECK_INSTANCE_TYPE (o, foo_get_type ()));
+      g_assert (!G_TYPE_CHECK_INSTANCE_TYPE (o, bar_get_type ()));
+      g_assert (!G_TYPE_CHECK_INSTANCE_TYPE (o, G_TYPE_BINDING));
+
+      g_assert (G_TYPE_CHECK_INSTANCE_CAST (o, bazo_get_type (), Bazo) == (Bazo *) o);
+      g_assert (G_TYPE_CHECK_INSTANCE_CAST (o, baz_get_type (), BazInterface) == (BazInterface *) o);
+      g_assert (G_TYPE_CHECK_CLASS_CAST (G_OBJECT_GET_CLASS (o), bazo_get_type (), BazoClass) ==
+                (BazoClass *) G_OBJECT_GET_CLASS (o));
+      g_assert (G_TYPE_CHECK_CLASS_CAST (G_OBJECT_GET_CLASS (o), G_TYPE_OBJECT, GObjectClass) ==
+                G_OBJECT_GET_CLASS (o));
+    }
+
+  g_assert (G_TYPE_CHECK_INSTANCE_CAST (NULL, bazo_get_type (), Bazo) == NULL);
+
+  g_object_unref (o);
+}
+
 static void
 test_next_base (void)
 {
@@ -138,6 +170,207 @@ test_next_base (void)
   g_assert (type == G_TYPE_INITIALLY_UNOWNED);
 }
 
+static GType qdata_type;
+static GQuark qdata_quark;
+static volatile gint qdata_done;
+
+static gpointer
+qdata_reader (gpointer data)
+{
+  while (!g_atomic_int_get (&qdata_done))
+    g_assert (g_type_get_qdata (qdata_type, qdata_quark) == &qdata_quark);
+
+  return NULL;
+}
+
+static void
+test_qdata (void)
+{
+  GThread *threads[4];
+  gint i;
+
+  qdata_type = g_pointer_type_register_static ("my+qdata+pointer");
+  qdata_quark = g_quark_from_static_string ("qdata-test");
+
+  g_assert (g_type_get_qdata (qdata_type, qdata_quark) == NULL);
+  g_type_set_qdata (qdata_type, qdata_quark, &qdata_type);
+  g_assert (g_type_get_qdata (qdata_type, qdata_quark) == &qdata_type);
+  g_type_set_qdata (qdata_type, qdata_quark, &qdata_quark);
+  g_assert (g_type_get_qdata (qdata_type, qdata_quark) == &qdata_quark);
+
+  /* readers don't take a lock, so check them against concurrent additions */
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("reader", qdata_reader, NULL);
+
+  for (i = 0; i < 200; i++)
+    {
+      gchar *name = g_strdup_printf ("qdata-test-%d", i);
+      GQuark quark = g_quark_from_string (name);
+
+      g_type_set_qdata (qdata_type, quark, GINT_TO_POINTER (i + 1));
+      g_assert (g_type_get_qdata (qdata_type, quark) == GINT_TO_POINTER (i + 1));
+      g_free (name);
+    }
+
+  g_atomic_int_set (&qdata_done, 1);
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  for (i = 0; i < 200; i++)
+    {
+      gchar *name = g_strdup_printf ("qdata-test-%d", i);
+
+      g_assert (g_type_get_qdata (qdata_type, g_quark_from_string (name)) == GINT_TO_POINTER (i + 1));
+      g_free (name);
+    }
+  g_assert (g_type_get_qdata (qdata_type, g_quark_from_static_string ("qdata-unset")) == NULL);
+}
+
+typedef GObject StatsObject;
+typedef GObjectClass StatsObjectClass;
+
+static GType stats_object_get_type (void);
+G_DEFINE_TYPE (StatsObject, stats_object, G_TYPE_OBJECT)
+
+static void
+stats_object_init (StatsObject *object)
+{
+}
+
+static void
+stats_object_class_init (StatsObjectClass *klass)
+{
+  g_signal_new ("ping", G_TYPE_FROM_CLASS (klass), G_SIGNAL_RUN_LAST,
+                0, NULL, NULL, NULL, G_TYPE_NONE, 0);
+}
+
+static void
+test_statistics (void)
+{
+  GTypeStatistics stats, *list;
+  GObject *objects[10];
+  gboolean found;
+  guint i, n_stats;
+
+  g_type_enable_statistics ();
+
+  g_assert (g_type_get_statistics (stats_object_get_type (), &stats));
+  g_assert_cmpuint (stats.type, ==, stats_object_get_type ());
+  g_assert_cmpuint (stats.n_allocations, ==, 0);
+  g_assert_cmpuint (stats.n_frees, ==, 0);
+  g_assert (!g_type_get_statistics (G_TYPE_INT, &stats));
+
+  for (i = 0; i < G_N_ELEMENTS (objects); i++)
+    objects[i] = g_object_new (stats_object_get_type (), NULL);
+  for (i = 0; i < 3; i++)
+    g_object_unref (objects[i]);
+  for (i = 0; i < 5; i++)
+    g_signal_emit_by_name (objects[9], "ping");
+
+  g_assert (g_type_get_statistics (stats_object_get_type (), &stats));
+  g_assert_cmpuint (stats.instance_size, >=, sizeof (GObject));
+  g_assert_cmpuint (stats.n_allocations, ==, 10);
+  g_assert_cmpuint (stats.n_frees, ==, 3);
+  g_assert_cmpuint (stats.n_emissions, ==, 5);
+
+  list = g_type_list_statistics (&n_stats);
+  found = FALSE;
+  for (i = 0; i < n_stats; i++)
+    if (list[i].type == stats_object_get_type ())
+      {
+        g_assert_cmpuint (list[i].n_allocations - list[i].n_frees, ==, 7);
+        found = TRUE;
+      }
+  g_assert (found);
+  g_free (list);
+
+  for (i = 3; i < G_N_ELEMENTS (objects); i++)
+    g_object_unref (objects[i]);
+
+  g_assert (g_type_get_statistics (stats_object_get_type (), &stats));
+  g_assert_cmpuint (stats.n_frees, ==, 10);
+}
+
+typedef struct {
+  GTypeInterface g_iface;
+} QuxInterface;
+
+GType qux_get_type (void);
+
+G_DEFINE_INTERFACE (Qux, qux, G_TYPE_OBJECT)
+
+static void
+qux_default_init (QuxInterface *iface)
+{
+}
+
+typedef GObject Multo;
+typedef GObjectClass MultoClass;
+
+GType multo_get_type (void);
+
+static void
+multo_iface_init (gpointer g_iface)
+{
+}
+
+G_DEFINE_TYPE_WITH_CODE (Multo, multo, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (bar_get_type (), multo_iface_init)
+                         G_IMPLEMENT_INTERFACE (foo_get_type (), multo_iface_init)
+                         G_IMPLEMENT_INTERFACE (baz_get_type (), multo_iface_init)
+                         G_IMPLEMENT_INTERFACE (qux_get_type (), multo_iface_init))
+
+static void
+multo_init (Multo *m)
+{
+}
+
+static void
+multo_class_init (MultoClass *c)
+{
+}
+
+static void
+test_iface_cache (void)
+{
+  GType ifaces[4];
+  GTypeStatistics stats;
+  GObject *o;
+  gsize misses;
+  guint i, round;
+
+  g_type_enable_statistics ();
+
+  ifaces[0] = bar_get_type ();
+  ifaces[1] = foo_get_type ();
+  ifaces[2] = baz_get_type ();
+  ifaces[3] = qux_get_type ();
+
+  o = g_object_new (multo_get_type (), NULL);
+  g_assert (g_type_get_statistics (multo_get_type (), &stats));
+  misses = stats.n_iface_cache_misses;
+
+  for (i = 0; i < G_N_ELEMENTS (ifaces); i++)
+    g_assert (G_TYPE_CHECK_INSTANCE_TYPE (o, ifaces[i]));
+
+  g_assert (g_type_get_statistics (multo_get_type (), &stats));
+  g_assert_cmpuint (stats.n_iface_cache_misses, ==, misses + G_N_ELEMENTS (ifaces));
+  misses = stats.n_iface_cache_misses;
+
+  /* all of them fit in the cache, whatever their addresses */
+  for (round = 0; round < 3; round++)
+    for (i = 0; i < G_N_ELEMENTS (ifaces); i++)
+      {
+        g_assert (G_TYPE_CHECK_INSTANCE_TYPE (o, ifaces[i]));
+        g_assert (G_TYPE_CHECK_INSTANCE_CAST (o, ifaces[i], GObject) == o);
+      }
+
+  g_assert (g_type_get_statistics (multo_get_type (), &stats));
+  g_assert_cmpuint (stats.n_iface_cache_misses, ==, misses);
+
+  g_object_unref (o);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -146,7 +379,11 @@ main (int argc, char *argv[])
   g_test_add_func ("/type/registration-serial", test_registration_serial);
   g_test_add_func ("/type/interface-prerequisite", test_interface_prerequisite);
   g_test_add_func ("/type/interface-check", test_interface_check);
+  g_test_add_func ("/type/instance-check", test_instance_check);
   g_test_add_func ("/type/next-base", test_next_base);
+  g_test_add_func ("/type/qdata", test_qdata);
+  g_test_add_func ("/type/statistics", test_statistics);
+  g_test_add_func ("/type/iface-cache", test_iface_cache);
 
   return g_test_run ();
 }
@@ -83,12 +83,57 @@ test_valuearray_basic (void)
   g_value_array_free (a2);
 }
 
+static void
+int2string (const GValue *src_value,
+            GValue       *dest_value)
+{
+  g_value_set_static_string (dest_value, "custom");
+}
+
+static void
+test_value_transform (void)
+{
+  GValue src = G_VALUE_INIT, dest = G_VALUE_INIT;
+  gint i;
+
+  g_value_init (&src, G_TYPE_INT);
+  g_value_set_int (&src, 42);
+
+  /* plain copies between identical fundamental types */
+  g_value_init (&dest, G_TYPE_INT);
+  g_value_copy (&src, &dest);
+  g_assert_cmpint (g_value_get_int (&dest), ==, 42);
+  g_value_unset (&dest);
+
+  g_value_init (&dest, G_TYPE_STRING);
+  for (i = 0; i < 2; i++)
+    {
+      /* the second round is served from the lookup cache */
+      g_assert_true (g_value_type_transformable (G_TYPE_INT, G_TYPE_STRING));
+      g_assert_true (g_value_transform (&src, &dest));
+      g_assert_cmpstr (g_value_get_string (&dest), ==, "42");
+    }
+
+  /* replacing a transform function invalidates cached lookups */
+  g_value_register_transform_func (G_TYPE_INT, G_TYPE_STRING, int2string);
+  g_assert_true (g_value_transform (&src, &dest));
+  g_assert_cmpstr (g_value_get_string (&dest), ==, "custom");
+  g_value_unset (&dest);
+
+  /* missing transforms are cached too */
+  for (i = 0; i < 2; i++)
+    g_assert_false (g_value_type_transformable (G_TYPE_STRING, G_TYPE_POINTER));
+
+  g_value_unset (&src);
+}
+
 int
 main (int argc, char *argv[])
 {
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/value/basic", test_value_basic);
+  g_test_add_func ("/value/transform", test_value_transform);
   g_test_add_func ("/value/array/basic", test_valuearray_basic);
 
   return g_test_run ();
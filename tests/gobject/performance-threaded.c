@@ -136,6 +136,197 @@ liststore_interface_peek_same_run (gpointer klass)
     }
 }
 
+/* tests where all threads work on the same object */
+
+typedef struct {
+  GObject parent_instance;
+  gint value;
+} SharedObject;
+
+typedef GObjectClass SharedObjectClass;
+
+static GType shared_object_get_type (void);
+
+G_DEFINE_TYPE (SharedObject, shared_object, G_TYPE_OBJECT)
+
+enum {
+  PROP_0,
+  PROP_VALUE
+};
+
+static GParamSpec *shared_value_pspec;
+static guint shared_changed_signal;
+
+static void
+shared_object_set_property (GObject      *object,
+                            guint         prop_id,
+                            const GValue *value,
+                            GParamSpec   *pspec)
+{
+  ((SharedObject *) object)->value = g_value_get_int (value);
+}
+
+static void
+shared_object_get_property (GObject    *object,
+                            guint       prop_id,
+                            GValue     *value,
+                            GParamSpec *pspec)
+{
+  g_value_set_int (value, ((SharedObject *) object)->value);
+}
+
+static void
+shared_object_class_init (SharedObjectClass *class)
+{
+  class->set_property = shared_object_set_property;
+  class->get_property = shared_object_get_property;
+
+  shared_value_pspec = g_param_spec_int ("value", "value", "value",
+                                         0, G_MAXINT, 0, G_PARAM_READWRITE);
+  g_object_class_install_property (class, PROP_VALUE, shared_value_pspec);
+
+  shared_changed_signal = g_signal_new ("changed", G_TYPE_FROM_CLASS (class),
+                                        G_SIGNAL_RUN_LAST, 0, NULL, NULL,
+                                        NULL, G_TYPE_NONE, 0);
+}
+
+static void
+shared_object_init (SharedObject *object)
+{
+}
+
+static void
+shared_changed_handler (GObject  *object,
+                        gpointer  data)
+{
+}
+
+static gpointer
+shared_object_setup (void)
+{
+  static volatile gsize object = 0;
+
+  if (g_once_init_enter (&object))
+    {
+      GObject *shared = g_object_new (shared_object_get_type (), NULL);
+
+      g_signal_connect (shared, "changed", G_CALLBACK (shared_changed_handler), NULL);
+      g_once_init_leave (&object, (gsize) shared);
+    }
+
+  return g_object_ref ((GObject *) object);
+}
+
+static void 
+shared_emit_run (gpointer object)
+{
+  guint i;
+
+  for (i = 0; i < 1000; i++)
+    g_signal_emit (object, shared_changed_signal, 0);
+}
+
+static void 
+shared_property_set_run (gpointer object)
+{
+  guint i;
+
+  for (i = 0; i < 1000; i++)
+    g_object_set (object, "value", i, NULL);
+}
+
+static void 
+shared_property_get_run (gpointer object)
+{
+  guint i;
+  gint value;
+
+  for (i = 0; i < 1000; i++)
+    g_object_get (object, "value", &value, NULL);
+}
+
+static void 
+shared_notify_run (gpointer object)
+{
+  guint i;
+
+  for (i = 0; i < 1000; i++)
+    g_object_notify_by_pspec (object, shared_value_pspec);
+}
+
+static void 
+shared_refcount_run (gpointer object)
+{
+  guint i;
+
+  for (i = 0; i < 1000; i++)
+    {
+      g_object_ref (object);
+      g_object_unref (object);
+    }
+}
+
+static void
+shared_weak_notify (gpointer  data,
+                    GObject  *where_the_object_was)
+{
+}
+
+static void 
+shared_weak_ref_run (gpointer object)
+{
+  guint i;
+  gint key;
+
+  /* a distinct data pointer per thread, so each removes its own */
+  for (i = 0; i < 1000; i++)
+    {
+      g_object_weak_ref (object, shared_weak_notify, &key);
+      g_object_weak_unref (object, shared_weak_notify, &key);
+    }
+}
+
+static void 
+shared_weak_ref_get_run (gpointer object)
+{
+  GWeakRef weak_ref;
+  guint i;
+
+  g_weak_ref_init (&weak_ref, object);
+  for (i = 0; i < 1000; i++)
+    g_object_unref (g_weak_ref_get (&weak_ref));
+  g_weak_ref_clear (&weak_ref);
+}
+
+static gpointer
+liststore_instance_setup (void)
+{
+  register_types ();
+  return g_object_new (liststore, NULL);
+}
+
+static void 
+liststore_instance_cast_run (gpointer object)
+{
+  guint i, j;
+  volatile gpointer iface;
+
+  for (i = 0; i < 1000; i++)
+    for (j = 0; j < 5; j++)
+      iface = G_TYPE_CHECK_INSTANCE_CAST (object, liststore_interfaces[j], GObject);
+
+  g_assert (iface == object);
+}
+
+static void 
+construction_run (gpointer data)
+{
+  guint i;
+
+  for (i = 0; i < 1000; i++)
+    g_object_unref (g_object_new (shared_object_get_type (), NULL));
+}
+
 #if 0
 /* DUMB test doing nothing */
 
@@ -161,6 +352,12 @@ no_teardown (gpointer data)
 {
 }
 
+static gpointer
+shared_type_setup (void)
+{
+  return g_type_class_ref (shared_object_get_type ());
+}
+
 typedef struct _PerformanceTest PerformanceTest;
 struct _PerformanceTest {
   const char *name;
@@ -187,6 +384,51 @@ static const PerformanceTest tests[] = {
     liststore_interface_peek_same_run,
     no_reset,
     g_type_class_unref },
+  { "liststore-instance-cast",
+    liststore_instance_setup,
+    liststore_instance_cast_run,
+    no_reset,
+    g_object_unref },
+  { "construction",
+    shared_type_setup,
+    construction_run,
+    no_reset,
+    g_type_class_unref },
+  { "shared-emit",
+    shared_object_setup,
+    shared_emit_run,
+    no_reset,
+    g_object_unref },
+  { "shared-property-set",
+    shared_object_setup,
+    shared_property_set_run,
+    no_reset,
+    g_object_unref },
+  { "shared-property-get",
+    shared_object_setup,
+    shared_property_get_run,
+    no_reset,
+    g_object_unref },
+  { "shared-notify-by-pspec",
+    shared_object_setup,
+    shared_notify_run,
+    no_reset,
+    g_object_unref },
+  { "shared-refcount",
+    shared_object_setup,
+    shared_refcount_run,
+    no_reset,
+    g_object_unref },
+  { "shared-weak-ref",
+    shared_object_setup,
+    shared_weak_ref_run,
+    no_reset,
+    g_object_unref },
+  { "shared-weak-ref-get",
+    shared_object_setup,
+    shared_weak_ref_get_run,
+    no_reset,
+    g_object_unref },
 #if 0
   { "nothing",
     no_setup,
@@ -198,6 +440,8 @@ static const PerformanceTest tests[] = {
 
 static gboolean verbose = FALSE;
 static int n_threads = 0;
+static int max_threads = 0;
+static gboolean json = FALSE;
 static gboolean list = FALSE;
 static int test_length = DEFAULT_TEST_TIME;
 
@@ -206,6 +450,10 @@ static GOptionEntry cmd_entries[] = {
    "Print extra information", NULL},
   {"threads", 't', 0, G_OPTION_ARG_INT, &n_threads,
    "number of threads to run in parrallel", NULL},
+  {"max-threads", 'm', 0, G_OPTION_ARG_INT, &max_threads,
+   "Run with 1, 2, 4 and so on up to this number of threads", NULL},
+  {"json", 'j', 0, G_OPTION_ARG_NONE, &json,
+   "Print results as one JSON object per line", NULL},
   {"seconds", 's', 0, G_OPTION_ARG_INT, &test_length,
    "Time to run each test in seconds", NULL},
   {"list", 'l', 0, G_OPTION_ARG_NONE, &list, 
@@ -263,7 +511,9 @@ compare_doubles (gconstpointer a, gconstpointer b)
 }
 
 static void
-print_results (GArray *array)
+print_results (const PerformanceTest *test,
+               int                    threads,
+               GArray                *array)
 {
   double min, max, avg;
   guint i;
@@ -281,15 +531,26 @@ print_results (GArray *array)
     }
   avg = avg / array->len * 1000;
 
-  g_print ("  %u runs, min/avg/max = %.3f/%.3f/%.3f ms\n", array->len, min, avg, max);
+  if (json)
+    g_print ("{\"test\": \"%s\", \"threads\": %d, \"runs\": %u, "
+             "\"min_ms\": %.6f, \"avg_ms\": %.6f, \"max_ms\": %.6f}\n",
+             test->name, MAX (threads, 1), array->len, min, avg, max);
+  else
+    g_print ("  %u runs, min/avg/max = %.3f/%.3f/%.3f ms\n", array->len, min, avg, max);
 }
 
 static void
-run_test (const PerformanceTest *test)
+run_test_with_threads (const PerformanceTest *test,
+                       int                    n_threads)
 {
   GArray *results;
 
-  g_print ("Running test \"%s\"\n", test->name);
+  if (json)
+    ;
+  else if (n_threads == 0)
+    g_print ("Running test \"%s\"\n", test->name);
+  else
+    g_print ("Running test \"%s\" in %d threads\n", test->name, n_threads);
 
   if (n_threads == 0) {
     results = run_test_thread ((gpointer) test);
@@ -313,10 +574,25 @@ run_test (const PerformanceTest *test)
     g_free (threads);
   }
 
-  print_results (results);
+  print_results (test, n_threads, results);
   g_array_free (results, TRUE);
 }
 
+static void
+run_test (const PerformanceTest *test)
+{
+  int threads;
+
+  if (max_threads == 0)
+    {
+      run_test_with_threads (test, n_threads);
+      return;
+    }
+
+  for (threads = 1; threads <= max_threads; threads *= 2)
+    run_test_with_threads (test, threads);
+}
+
 static const PerformanceTest *
 find_test (const char *name)
 {
@@ -30,6 +30,7 @@
 #define TARGET_ROUND_TIME 0.008
 
 static gboolean verbose = FALSE;
+static gboolean json = FALSE;
 static int test_length = DEFAULT_TEST_TIME;
 
 static GOptionEntry cmd_entries[] = {
@@ -37,6 +38,8 @@ static GOptionEntry cmd_entries[] = {
    "Print extra information", NULL},
   {"seconds", 's', 0, G_OPTION_ARG_INT, &test_length,
    "Time to run each test in seconds", NULL},
+  {"json", 'j', 0, G_OPTION_ARG_NONE, &json,
+   "Print results as one JSON object per line", NULL},
   {NULL}
 };
 
@@ -60,6 +63,19 @@ struct _PerformanceTest {
 			double time);
 };
 
+static void
+report_result (PerformanceTest *test,
+               const char      *description,
+               int              precision,
+               double           value)
+{
+  if (json)
+    g_print ("{\"test\": \"%s\", \"threads\": 1, \"result\": \"%s\", \"value\": %.*f}\n",
+             test->name, description, precision, value);
+  else
+    g_print ("%s: %.*f\n", description, precision, value);
+}
+
 static void
 run_test (PerformanceTest *test)
 {
@@ -68,7 +84,8 @@ run_test (PerformanceTest *test)
   double elapsed, min_elapsed, max_elapsed, avg_elapsed, factor;
   GTimer *timer;
 
-  g_print ("Running test %s\n", test->name);
+  if (!json)
+    g_print ("Running test %s\n", test->name);
 
   /* Set up test */
   timer = g_timer_new ();
@@ -529,8 +546,8 @@ test_construction_print_result (PerformanceTest *test,
 {
   struct ConstructionTest *data = _data;
 
-  g_print ("Millions of constructed objects per second: %.3f\n",
-	   data->n_objects / (time * 1000000));
+  report_result (test, "Millions of constructed objects per second", 3,
+		 data->n_objects / (time * 1000000));
 }
 
 /*************************************************************
@@ -609,8 +626,8 @@ test_type_check_print_result (PerformanceTest *test,
 			      double time)
 {
   struct TypeCheckTest *data = _data;
-  g_print ("Million type checks per second: %.2f\n",
-	   data->n_checks / (1000*time));
+  report_result (test, "Million type checks per second", 2,
+		 data->n_checks / (1000*time));
 }
 
 static void
@@ -697,8 +714,8 @@ test_emission_unhandled_print_result (PerformanceTest *test,
 {
   struct EmissionTest *data = _data;
 
-  g_print ("Emissions per second: %.0f\n",
-	   data->n_checks / time);
+  report_result (test, "Emissions per second", 0,
+		 data->n_checks / time);
 }
 
 static void
@@ -770,8 +787,8 @@ test_emission_handled_print_result (PerformanceTest *test,
 {
   struct EmissionTest *data = _data;
 
-  g_print ("Emissions per second: %.0f\n",
-	   data->n_checks / time);
+  report_result (test, "Emissions per second", 0,
+		 data->n_checks / time);
 }
 
 static void
@@ -852,8 +869,8 @@ test_refcount_print_result (PerformanceTest *test,
 			      double time)
 {
   struct RefcountTest *data = _data;
-  g_print ("Million refs+unref per second: %.2f\n",
-	   data->n_checks * 5 / (time * 1000000 ));
+  report_result (test, "Million refs+unref per second", 2,
+		 data->n_checks * 5 / (time * 1000000 ));
 }
 
 static void
@@ -866,6 +883,341 @@ test_refcount_teardown (PerformanceTest *test,
   g_free (data);
 }
 
+/*************************************************************
+ * Test signal emissions performance with many handlers
+ *************************************************************/
+
+static gpointer
+test_emission_many_handlers_setup (PerformanceTest *test)
+{
+  struct EmissionTest *data;
+  int i;
+
+  data = g_new0 (struct EmissionTest, 1);
+  data->object = g_object_new (COMPLEX_TYPE_OBJECT, NULL);
+  data->signal_id = complex_signals[COMPLEX_SIGNAL];
+  for (i = 0; i < GPOINTER_TO_INT (test->extra_data); i++)
+    g_signal_connect (data->object, "signal",
+                      G_CALLBACK (test_emission_handled_handler),
+                      NULL);
+
+  return data;
+}
+
+/*************************************************************
+ * Test interface cast performance
+ *************************************************************/
+
+static void
+test_interface_cast_run (PerformanceTest *test,
+			 gpointer _data)
+{
+  struct TypeCheckTest *data = _data;
+  GObject *object = data->object;
+  GType types[5];
+  volatile gpointer iface;
+  int i, j;
+
+  types[0] = test_iface1_get_type ();
+  types[1] = test_iface2_get_type ();
+  types[2] = test_iface3_get_type ();
+  types[3] = test_iface4_get_type ();
+  types[4] = test_iface5_get_type ();
+
+  for (i = 0; i < data->n_checks; i++)
+    {
+      GType type = types[i%5];
+
+      for (j = 0; j < 1000; j++)
+	{
+	  iface = G_TYPE_CHECK_INSTANCE_CAST (object, type, TestIface);
+	  iface = G_TYPE_INSTANCE_GET_INTERFACE (iface, type, TestIfaceClass);
+	}
+    }
+}
+
+static void
+test_interface_cast_print_result (PerformanceTest *test,
+				  gpointer _data,
+				  double time)
+{
+  struct TypeCheckTest *data = _data;
+  report_result (test, "Million interface casts and lookups per second", 2,
+		 data->n_checks / (1000*time));
+}
+
+/*************************************************************
+ * Test property access performance
+ *************************************************************/
+
+#define NUM_PROPERTY_OPS_PER_ROUND 10000
+
+enum {
+  PROPERTY_SET,
+  PROPERTY_SET_VALUE,
+  PROPERTY_GET,
+  PROPERTY_NOTIFY,
+  PROPERTY_NOTIFY_BY_PSPEC
+};
+
+struct PropertyTest {
+  GObject *object;
+  GParamSpec *pspec;
+  int n_ops;
+};
+
+static gpointer
+test_property_setup (PerformanceTest *test)
+{
+  struct PropertyTest *data;
+
+  data = g_new0 (struct PropertyTest, 1);
+  data->object = g_object_new (COMPLEX_TYPE_OBJECT, NULL);
+  data->pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (data->object), "val2");
+
+  return data;
+}
+
+static void
+test_property_init (PerformanceTest *test,
+		    gpointer _data,
+		    double factor)
+{
+  struct PropertyTest *data = _data;
+
+  data->n_ops = factor * NUM_PROPERTY_OPS_PER_ROUND;
+}
+
+static void
+test_property_run (PerformanceTest *test,
+		   gpointer _data)
+{
+  struct PropertyTest *data = _data;
+  GObject *object = data->object;
+  GValue value = G_VALUE_INIT;
+  int i, val;
+
+  g_value_init (&value, G_TYPE_INT);
+
+  for (i = 0; i < data->n_ops; i++)
+    {
+      switch (GPOINTER_TO_INT (test->extra_data))
+	{
+	case PROPERTY_SET:
+	  g_object_set (object, "val2", i, NULL);
+	  break;
+	case PROPERTY_SET_VALUE:
+	  g_value_set_int (&value, i);
+	  g_object_set_property (object, "val2", &value);
+	  break;
+	case PROPERTY_GET:
+	  g_object_get (object, "val2", &val, NULL);
+	  break;
+	case PROPERTY_NOTIFY:
+	  g_object_notify (object, "val2");
+	  break;
+	case PROPERTY_NOTIFY_BY_PSPEC:
+	  g_object_notify_by_pspec (object, data->pspec);
+	  break;
+	}
+    }
+
+  g_value_unset (&value);
+}
+
+static void
+test_property_finish (PerformanceTest *test,
+		      gpointer data)
+{
+}
+
+static void
+test_property_print_result (PerformanceTest *test,
+			    gpointer _data,
+			    double time)
+{
+  struct PropertyTest *data = _data;
+  report_result (test, "Million property operations per second", 3,
+		 data->n_ops / (time * 1000000));
+}
+
+static void
+test_property_teardown (PerformanceTest *test,
+			gpointer _data)
+{
+  struct PropertyTest *data = _data;
+
+  g_object_unref (data->object);
+  g_free (data);
+}
+
+/*************************************************************
+ * Test property binding performance
+ *************************************************************/
+
+struct BindingTest {
+  GObject *source;
+  GObject *target;
+  int n_ops;
+};
+
+static gpointer
+test_binding_setup (PerformanceTest *test)
+{
+  struct BindingTest *data;
+
+  data = g_new0 (struct BindingTest, 1);
+  data->source = g_object_new (COMPLEX_TYPE_OBJECT, NULL);
+  data->target = g_object_new (COMPLEX_TYPE_OBJECT, NULL);
+  g_object_bind_property (data->source, "val2", data->target, "val2", 0);
+
+  return data;
+}
+
+static void
+test_binding_init (PerformanceTest *test,
+		   gpointer _data,
+		   double factor)
+{
+  struct BindingTest *data = _data;
+
+  data->n_ops = factor * NUM_PROPERTY_OPS_PER_ROUND;
+}
+
+static void
+test_binding_run (PerformanceTest *test,
+		  gpointer _data)
+{
+  struct BindingTest *data = _data;
+  int i;
+
+  for (i = 0; i < data->n_ops; i++)
+    g_object_set (data->source, "val2", i, NULL);
+}
+
+static void
+test_binding_finish (PerformanceTest *test,
+		     gpointer _data)
+{
+  struct BindingTest *data = _data;
+
+  g_assert_cmpint (COMPLEX_OBJECT (data->target)->val2, ==, data->n_ops - 1);
+}
+
+static void
+test_binding_print_result (PerformanceTest *test,
+			   gpointer _data,
+			   double time)
+{
+  struct BindingTest *data = _data;
+  report_result (test, "Million bound property changes per second", 3,
+		 data->n_ops / (time * 1000000));
+}
+
+static void
+test_binding_teardown (PerformanceTest *test,
+		       gpointer _data)
+{
+  struct BindingTest *data = _data;
+
+  g_object_unref (data->source);
+  g_object_unref (data->target);
+  g_free (data);
+}
+
+/*************************************************************
+ * Test weak reference performance
+ *************************************************************/
+
+#define NUM_WEAK_REF_OPS_PER_ROUND 10000
+
+struct WeakRefTest {
+  GObject *object;
+  GWeakRef weak_ref;
+  int n_ops;
+};
+
+static gpointer
+test_weak_ref_setup (PerformanceTest *test)
+{
+  struct WeakRefTest *data;
+
+  data = g_new0 (struct WeakRefTest, 1);
+  data->object = g_object_new (COMPLEX_TYPE_OBJECT, NULL);
+  g_weak_ref_init (&data->weak_ref, data->object);
+
+  return data;
+}
+
+static void
+test_weak_ref_init (PerformanceTest *test,
+		    gpointer _data,
+		    double factor)
+{
+  struct WeakRefTest *data = _data;
+
+  data->n_ops = factor * NUM_WEAK_REF_OPS_PER_ROUND;
+}
+
+static void
+test_weak_ref_notify (gpointer data,
+		      GObject *where_the_object_was)
+{
+}
+
+static void
+test_weak_ref_run (PerformanceTest *test,
+		   gpointer _data)
+{
+  struct WeakRefTest *data = _data;
+  GObject *object = data->object;
+  int i;
+
+  for (i = 0; i < data->n_ops; i++)
+    {
+      g_object_weak_ref (object, test_weak_ref_notify, data);
+      g_object_weak_unref (object, test_weak_ref_notify, data);
+    }
+}
+
+static void
+test_weak_ref_get_run (PerformanceTest *test,
+		       gpointer _data)
+{
+  struct WeakRefTest *data = _data;
+  int i;
+
+  for (i = 0; i < data->n_ops; i++)
+    g_object_unref (g_weak_ref_get (&data->weak_ref));
+}
+
+static void
+test_weak_ref_finish (PerformanceTest *test,
+		      gpointer data)
+{
+}
+
+static void
+test_weak_ref_print_result (PerformanceTest *test,
+			    gpointer _data,
+			    double time)
+{
+  struct WeakRefTest *data = _data;
+  report_result (test, "Million weak ref operations per second", 3,
+		 data->n_ops / (time * 1000000));
+}
+
+static void
+test_weak_ref_teardown (PerformanceTest *test,
+			gpointer _data)
+{
+  struct WeakRefTest *data = _data;
+
+  g_weak_ref_clear (&data->weak_ref);
+  g_object_unref (data->object);
+  g_free (data);
+}
+
 /*************************************************************
  * Main test code
  *************************************************************/
@@ -901,6 +1253,16 @@ static PerformanceTest tests[] = {
     test_type_check_teardown,
     test_type_check_print_result
   },
+  {
+    "interface-cast",
+    NULL,
+    test_type_check_setup,
+    test_type_check_init,
+    test_interface_cast_run,
+    test_type_check_finish,
+    test_type_check_teardown,
+    test_interface_cast_print_result
+  },
   {
     "emit-unhandled",
     GINT_TO_POINTER (COMPLEX_SIGNAL),
@@ -1001,6 +1363,106 @@ static PerformanceTest tests[] = {
     test_emission_handled_teardown,
     test_emission_handled_print_result
   },
+  {
+    "emit-handled-10",
+    GINT_TO_POINTER (10),
+    test_emission_many_handlers_setup,
+    test_emission_handled_init,
+    test_emission_run,
+    test_emission_handled_finish,
+    test_emission_handled_teardown,
+    test_emission_handled_print_result
+  },
+  {
+    "emit-handled-100",
+    GINT_TO_POINTER (100),
+    test_emission_many_handlers_setup,
+    test_emission_handled_init,
+    test_emission_run,
+    test_emission_handled_finish,
+    test_emission_handled_teardown,
+    test_emission_handled_print_result
+  },
+  {
+    "property-set",
+    GINT_TO_POINTER (PROPERTY_SET),
+    test_property_setup,
+    test_property_init,
+    test_property_run,
+    test_property_finish,
+    test_property_teardown,
+    test_property_print_result
+  },
+  {
+    "property-set-value",
+    GINT_TO_POINTER (PROPERTY_SET_VALUE),
+    test_property_setup,
+    test_property_init,
+    test_property_run,
+    test_property_finish,
+    test_property_teardown,
+    test_property_print_result
+  },
+  {
+    "property-get",
+    GINT_TO_POINTER (PROPERTY_GET),
+    test_property_setup,
+    test_property_init,
+    test_property_run,
+    test_property_finish,
+    test_property_teardown,
+    test_property_print_result
+  },
+  {
+    "notify",
+    GINT_TO_POINTER (PROPERTY_NOTIFY),
+    test_property_setup,
+    test_property_init,
+    test_property_run,
+    test_property_finish,
+    test_property_teardown,
+    test_property_print_result
+  },
+  {
+    "notify-by-pspec",
+    GINT_TO_POINTER (PROPERTY_NOTIFY_BY_PSPEC),
+    test_property_setup,
+    test_property_init,
+    test_property_run,
+    test_property_finish,
+    test_property_teardown,
+    test_property_print_result
+  },
+  {
+    "binding",
+    NULL,
+    test_binding_setup,
+    test_binding_init,
+    test_binding_run,
+    test_binding_finish,
+    test_binding_teardown,
+    test_binding_print_result
+  },
+  {
+    "weak-ref",
+    NULL,
+    test_weak_ref_setup,
+    test_weak_ref_init,
+    test_weak_ref_run,
+    test_weak_ref_finish,
+    test_weak_ref_teardown,
+    test_weak_ref_print_result
+  },
+  {
+    "weak-ref-get",
+    NULL,
+    test_weak_ref_setup,
+    test_weak_ref_init,
+    test_weak_ref_get_run,
+    test_weak_ref_finish,
+    test_weak_ref_teardown,
+    test_weak_ref_print_result
+  },
   {
     "refcount",
     NULL,